@@ -37,6 +37,7 @@
 
 #pragma once
 #include "cinder/gl/Texture.h"
+#include "cinder/gl/TextureStreamer.h"
 #include "ciMsaFluidSolver.h"
 
 #define FLUID_DRAW_COLOR		0
@@ -73,13 +74,13 @@ class ciMsaFluidDrawerGl {
 	
 	float getWidth() {
 #ifdef FLUID_TEXTURE
-		return tex.getWidth();
+		return _streamer.getTexture().getWidth();
 #endif
 	}
 	
 	float getHeight() {
 #ifdef FLUID_TEXTURE
-		return tex.getHeight();
+		return _streamer.getTexture().getHeight();
 #endif
 	}
 	
@@ -93,15 +94,10 @@ class ciMsaFluidDrawerGl {
 	int					drawMode;
 
 protected:	
-	ci::Surface8u		_surface;						// pixels array to be drawn
-	ci::uint8_t			*_pixels;
-	int					_byteCount;						// number of byes in the pixel array (size * 3)
-
 #ifdef FLUID_TEXTURE
 	int					_glType;						// GL_RGB or GL_RGBA
 	bool				_alphaEnabled;
-	int					_bpp;							// 3 or 4
-	ci::gl::Texture		tex;
+	ci::gl::TextureStreamer	_streamer;					// the visualizations are written straight into its mapped pixel buffers
 #endif	
 	
 	ciMsaFluidSolver	*_fluidSolver;
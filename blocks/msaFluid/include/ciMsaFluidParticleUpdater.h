@@ -38,20 +38,26 @@
 
 #include "ciMsaParticleUpdater.h"
 #include "ciMsaFluid.h"
+#include "ciMsaFluidSolverGl.h"
 
 
 class ciMsaFluidParticleUpdater : public ciMsaParticleUpdater {
 public:
     float strength;
 	ciMsaFluidSolver *fluidSolver;
+	ciMsaFluidSolverGl *fluidSolverGl;		// used instead of fluidSolver if set; needs enableVelocityReadback()
 
 	ciMsaFluidParticleUpdater() {
 		fluidSolver = NULL;
+		fluidSolverGl = NULL;
 	}
 
 	void update(ciMsaParticle* p) {
 		ci::Vec2f vel;
-		fluidSolver->getInfoAtPos(p->x * p->getParams()->worldSizeInv.x, p->y * p->getParams()->worldSizeInv.y, &vel, NULL);
+		if(fluidSolverGl)
+			fluidSolverGl->getInfoAtPos(p->x * p->getParams()->worldSizeInv.x, p->y * p->getParams()->worldSizeInv.y, &vel, NULL);
+		else
+			fluidSolver->getInfoAtPos(p->x * p->getParams()->worldSizeInv.x, p->y * p->getParams()->worldSizeInv.y, &vel, NULL);
 		float invMass = p->getInvMass();
 		p->addVelocity(vel.x * invMass * strength, vel.y * invMass * strength, 0);
 	}
@@ -48,6 +48,7 @@
 
 #include "cinder/Vector.h"
 #include "cinder/Color.h"
+#include "cinder/JobSystem.h"
 
 // do not change these values, you can override them using the solver methods
 #define		FLUID_DEFAULT_NX					100
@@ -114,6 +115,11 @@ public:
 	inline void addColorAtCell(int i, int j, float r, float g=0, float b=0 );
 	inline void addColorAtCell(int i, int j, float* rgb );
 	
+	// add \a count forces or colors at normalized positions in one pass. each is spread over the cells within \a radius cells of its position,
+	// weighted by 1 - distance / radius, or added to the single cell containing it if \a radius is 0. runs across rows when enableParallel() is set
+	void addForcesAtPos( const ci::Vec2f *pos, const ci::Vec2f *forces, size_t count, float radius = 0 );
+	void addColorsAtPos( const ci::Vec2f *pos, const ci::Color *colors, size_t count, float radius = 0 );
+	
 	// fill with random color at every cell
 	void randomizeColor();
 		
@@ -142,6 +148,11 @@ public:
 	bool getVorticityConfinement();
 	ciMsaFluidSolver& setWrap( bool bx, bool by );
 	
+	// splits advection, projection and the linear solvers across the rows of the grid using \a jobSystem (JobSystem::getDefault() if NULL)
+	// the linear solvers switch to red-black Gauss-Seidel so that rows can be relaxed concurrently, which converges at much the same rate
+	ciMsaFluidSolver& enableParallel( bool b, ci::JobSystemRef jobSystem = ci::JobSystemRef() );
+	bool getParallel() const;
+	
 	// returns average density of fluid 
 	float getAvgDensity() const;
 	
@@ -165,8 +176,11 @@ public:
 	
 	bool	doRGB;				// for monochrome, only update r
 	bool	doVorticityConfinement;
+	bool	doParallel;
 	int		solverIterations;
 	
+	ci::JobSystemRef	mJobSystem;
+	
 	float	colorDiffusion;
 	float	viscocity;
 	float	fadeSpeed;
@@ -202,6 +216,9 @@ public:
 	void	advect(int b, float *d, const float *d0, const ci::Vec2f *duv);
 	void	advect2d( ci::Vec2f *uv, const ci::Vec2f *duv );
 	void	advectRGB(int b, const ci::Vec2f *duv);
+	void	advectRows( int32_t jBegin, int32_t jEnd, float *d, const float *d0, const ci::Vec2f *duv );
+	void	advect2dRows( int32_t jBegin, int32_t jEnd, ci::Vec2f *uv, const ci::Vec2f *duv );
+	void	advectRGBRows( int32_t jBegin, int32_t jEnd, const ci::Vec2f *duv );
 	
 	void	diffuse(int b, float *c, float *c0, float diff);
 	void	diffuseRGB(int b, float diff);
@@ -213,6 +230,20 @@ public:
 	void	linearSolverRGB( float a, float c);
 	void	linearSolverUV(float a, float c);
 	
+	// row kernels for the parallel mode; the relax*Rows() variants update only the cells where (i + j) & 1 == parity
+	void	forEachRow( const std::function<void(int32_t,int32_t)> &rowFn );
+	void	divergenceRows( int32_t jBegin, int32_t jEnd, const ci::Vec2f *xy, ci::Vec2f *pDiv );
+	void	gradientRows( int32_t jBegin, int32_t jEnd, ci::Vec2f *xy, const ci::Vec2f *pDiv );
+	void	relaxRows( int32_t jBegin, int32_t jEnd, int parity, float *x, const float *x0, float a, float c );
+	void	relaxProjectRows( int32_t jBegin, int32_t jEnd, int parity, ci::Vec2f *pdiv );
+	void	relaxRGBRows( int32_t jBegin, int32_t jEnd, int parity, float a, float c );
+	void	relaxUVRows( int32_t jBegin, int32_t jEnd, int parity, float a, float c );
+	void	splatForceRows( int32_t jBegin, int32_t jEnd, const ci::Vec2f *pos, const ci::Vec2f *forces, size_t count, float radius );
+	void	splatColorRows( int32_t jBegin, int32_t jEnd, const ci::Vec2f *pos, const ci::Color *colors, size_t count, float radius );
+	// finds the interior cells within rows [jBegin, jEnd) covered by a splat at normalized \a pos, returning false if there are none
+	bool	getSplatBounds( int32_t jBegin, int32_t jEnd, const ci::Vec2f &pos, float radius, ci::Vec2f *center, int *iMin, int *iMax, int *jMin, int *jMax ) const;
+	inline float	getSplatWeight( int i, int j, const ci::Vec2f &center, float radius ) const;
+	
 	void	setBoundary(int b, float *x);
 	void	setBoundary02d(ci::Vec2f* x);
 	void	setBoundary2d(int b, ci::Vec2f *xy );
@@ -0,0 +1,165 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/gl/Fbo.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/gl/Fence.h"
+#include "ciMsaFluidSolver.h"
+
+#include <vector>
+
+/* GPU counterpart of ciMsaFluidSolver for installations where the fluid is only ever rendered.
+ * Velocity and color live in ping-ponged floating point gl::Fbo's and never visit the CPU; forces and colors are queued
+ * and splatted at the start of update(), and the linear solvers use Jacobi iterations. The edges of the grid clamp
+ * (or repeat with setWrap()) rather than reflecting velocity as the CPU solver does.
+ * Velocity can optionally be read back asynchronously through pixel buffer objects for ciMsaFluidParticleUpdater,
+ * in which case getVelocityAtPos() lags the simulation by a frame or two.
+ * Requires GLSL and floating point render targets; every method must be called with the GL context current. */
+class ciMsaFluidSolverGl {
+public:
+	ciMsaFluidSolverGl();
+	
+	ciMsaFluidSolverGl& setup(int NX = FLUID_DEFAULT_NX, int NY = FLUID_DEFAULT_NY);
+	ciMsaFluidSolverGl& setSize(int NX = FLUID_DEFAULT_NX, int NY = FLUID_DEFAULT_NY);
+	
+	// solve one step of the fluid solver
+	void update();
+	
+	// clear all forces in fluid and reset
+	void reset();
+	
+	// add force at normalized (x, y) coordinates
+	void addForceAtPos( const ci::Vec2f &pos, const ci::Vec2f &force );
+	// add force at (i, j) fluid cell coordinates. range: (0..NX-1), (0..NY-1)
+	void addForceAtCell( int i, int j, const ci::Vec2f &force );
+	
+	// add color at normalized (x, y) coordinates
+	void addColorAtPos( float x, float y, float r, float g=0, float b=0 );
+	void addColorAtPos( const ci::Vec2f &pos, const ci::Color &color ) { addColorAtPos( pos.x, pos.y, color.r, color.g, color.b ); }
+	// add color at (i, j) fluid cell coordinates
+	void addColorAtCell( int i, int j, float r, float g=0, float b=0 );
+	
+	// the simulation state, one texel per cell with row 0 at normalized y = 0. velocity is in .xy, color in .rgb
+	ci::gl::Texture&	getVelocityTexture()	{ return _velocity[0].getTexture(); }
+	ci::gl::Texture&	getColorTexture()		{ return _color[0].getTexture(); }
+	
+	// reads the velocity back after every update() through a ring of \a numBuffers pixel buffer objects, without stalling the GPU
+	ciMsaFluidSolverGl& enableVelocityReadback( bool b, int numBuffers = 2 );
+	bool getVelocityReadback() const;
+	
+	// velocity from the most recent readback at normalized (x, y) coordinates, zero until one has completed.
+	// getInfoAtPos() scales it like ciMsaFluidSolver::getInfoAtPos() and leaves \a color untouched, as color isn't read back
+	ci::Vec2f getVelocityAtPos( const ci::Vec2f &pos ) const;
+	void getInfoAtPos( float x, float y, ci::Vec2f *vel, ci::Color *color = NULL ) const;
+	
+	// return number of cells and dimensions. unlike ciMsaFluidSolver there are no border cells, so these are NX and NY
+	int getNumCells() const;
+	int getWidth() const;
+	int getHeight() const;
+	
+	bool isInited() const;
+	
+	ciMsaFluidSolverGl& setVisc( float newVisc );
+	float getVisc() const;
+	
+	// if diff == 0, color diffusion is not performed
+	ciMsaFluidSolverGl& setColorDiffusion( float diff );
+	float getColorDiffusion() const;
+	
+	ciMsaFluidSolverGl& setDeltaT( float dt = FLUID_DEFAULT_DT );
+	ciMsaFluidSolverGl& setFadeSpeed( float fadeSpeed = FLUID_DEFAULT_FADESPEED );
+	ciMsaFluidSolverGl& setSolverIterations( int solverIterations = FLUID_DEFAULT_SOLVER_ITERATIONS );
+	ciMsaFluidSolverGl& setWrap( bool bx, bool by );
+	
+protected:
+	struct Splat {
+		Splat( const ci::Vec2f &pos, const ci::Vec4f &value ) : mPos( pos ), mValue( value ) {}
+		
+		ci::Vec2f	mPos;
+		ci::Vec4f	mValue;
+	};
+	
+	struct ReadbackSlot {
+		ReadbackSlot() : mPending( false ), mSequence( 0 ) {}
+		
+		ci::gl::Vbo			mBuffer;
+		ci::gl::FenceRef	mFence;
+		bool				mPending;
+		uint32_t			mSequence;
+	};
+	
+	void	createBuffers();
+	void	createShaders();
+	
+	// draws a quad covering \a target with the currently bound shader
+	void	runPass( ci::gl::Fbo &target );
+	void	splat( ci::gl::Fbo &target, const std::vector<Splat> &splats );
+	void	advect( ci::gl::Fbo *field, float maxValue, float hold );
+	void	diffuse( ci::gl::Fbo *field, float diff );
+	void	project();
+	void	clear( ci::gl::Fbo &target );
+	
+	void	startReadback();
+	// returns whether \a slot has been copied into, waiting for it if \a wait
+	bool	isReadbackComplete( const ReadbackSlot &slot, bool wait ) const;
+	void	deliverReadback( ReadbackSlot *slot );
+	void	readVelocity( const float *rgba );
+	
+	int		solverIterations;
+	float	colorDiffusion;
+	float	viscocity;
+	float	fadeSpeed;
+	
+	bool	wrap_x;
+	bool	wrap_y;
+	
+	int		_NX, _NY;
+	float	_dt;
+	bool	_isInited;
+	
+	// [0] is the current state and [1] the render target of the next pass
+	ci::gl::Fbo			_velocity[2];
+	ci::gl::Fbo			_color[2];
+	ci::gl::Fbo			_scratch[2];
+	ci::gl::Fbo			_divergence;
+	
+	ci::gl::GlslProg	_splatShader;
+	ci::gl::GlslProg	_advectShader;
+	ci::gl::GlslProg	_jacobiShader;
+	ci::gl::GlslProg	_divergenceShader;
+	ci::gl::GlslProg	_gradientShader;
+	
+	std::vector<Splat>	_forces;
+	std::vector<Splat>	_colors;
+	
+	bool						_doReadback;
+	std::vector<ReadbackSlot>	_readbackSlots;
+	size_t						_nextReadbackSlot;
+	uint32_t					_readbackSequence;
+	std::vector<ci::Vec2f>		_velocities;
+};
@@ -43,8 +43,6 @@ using namespace cinder;
 
 ciMsaFluidDrawerGl::ciMsaFluidDrawerGl() {
 	//	printf("ciMsaFluidDrawerGl::ciMsaFluidDrawer()\n");
-	_pixels				= NULL;
-	_byteCount			= 0;
 	_fluidSolver		= NULL;
 	_didICreateTheFluid	= false;
 	alpha				= 1;
@@ -88,25 +86,19 @@ void ciMsaFluidDrawerGl::enableAlpha(bool b) {
 	_alphaEnabled = b;
 	if(_alphaEnabled) {
 		_glType = GL_RGBA;
-		_bpp = 4;
 	} else {
 		_glType = GL_RGB;
-		_bpp = 3;
 	}
 }
 
 void ciMsaFluidDrawerGl::createTexture() {
-	if(_pixels) delete []_pixels;
 	int texWidth = _fluidSolver->getWidth()-2;
 	int texHeight =_fluidSolver->getHeight()-2;
 
-	_pixels = new unsigned char[texWidth * texHeight * _bpp];
-	_surface = Surface8u( _pixels, texWidth, texHeight, false, SurfaceChannelOrder::RGB );
-
 #ifdef FLUID_TEXTURE
 	gl::Texture::Format format;
 	format.setInternalFormat( _glType );
-	tex = gl::Texture( texWidth, texHeight, format );
+	_streamer = gl::TextureStreamer( texWidth, texHeight, _alphaEnabled, format );
 #endif
 }
 
@@ -187,9 +179,11 @@ void ciMsaFluidDrawerGl::drawColor(float x, float y, float renderWidth, float re
 
 	ci::Vec2f vel;
 	ci::Color color;
-	int index = 0;
+	Surface8u frame = _streamer.map();
+	const uint8_t ro = frame.getRedOffset(), go = frame.getGreenOffset(), bo = frame.getBlueOffset(), ao = frame.getAlphaOffset();
 	for(int j=1; j < fh-1; j++) {
-		for(int i=1; i < fw-1; i++) {
+		uint8_t *pixel = frame.getData( Vec2i( 0, j-1 ) );
+		for(int i=1; i < fw-1; i++, pixel += 4) {
 			_fluidSolver->getInfoAtCell(i, j, &vel, &color);
 			uint8_t r = (uint8_t)math<float>::min(color.r * 255 * alpha, 255);
 			uint8_t g = (uint8_t)math<float>::min(color.g * 255 * alpha, 255);
@@ -199,16 +193,16 @@ void ciMsaFluidDrawerGl::drawColor(float x, float y, float renderWidth, float re
 				g = 255 - g;
 				b = 255 - b;
 			}
-			_pixels[index++] = r;
-			_pixels[index++] = g;
-			_pixels[index++] = b;
-			if(_alphaEnabled) _pixels[index++] = withAlpha ? math<uint8_t>::min(b, math<uint8_t>::max(r, g)) : 255;
+			pixel[ro] = r;
+			pixel[go] = g;
+			pixel[bo] = b;
+			if(_alphaEnabled) pixel[ao] = withAlpha ? math<uint8_t>::min(b, math<uint8_t>::max(r, g)) : 255;
 		}
 	}
 
 #ifdef FLUID_TEXTURE
-	tex.update( _surface );
-	gl::draw( tex, Rectf( x, y, x + renderWidth, y + renderHeight ) );
+	_streamer.upload();
+	gl::draw( _streamer.getTexture(), Rectf( x, y, x + renderWidth, y + renderHeight ) );
 #endif
 }
 
@@ -217,23 +211,25 @@ void ciMsaFluidDrawerGl::drawMotion(float x, float y, float renderWidth, float r
 	int fh = _fluidSolver->getHeight();
 
 	ci::Vec2f vel;
-	int index = 0;
+	Surface8u frame = _streamer.map();
+	const uint8_t ro = frame.getRedOffset(), go = frame.getGreenOffset(), bo = frame.getBlueOffset(), ao = frame.getAlphaOffset();
 	for(int j=1; j < fh-1; j++) {
-		for(int i=1; i < fw-1; i++) {
+		uint8_t *pixel = frame.getData( Vec2i( 0, j-1 ) );
+		for(int i=1; i < fw-1; i++, pixel += 4) {
 			_fluidSolver->getInfoAtCell(i, j, &vel, NULL);
 			float speed2 = fabs(vel.x) * fw + fabs(vel.y) * fh;
 			int speed = (int)math<float>::min(speed2 * 255 * alpha, 255);
-			_pixels[index++] = (uint8_t)math<float>::min(fabs(vel.x) * fw * 255 * alpha, 255);
-			_pixels[index++] = (uint8_t)math<float>::min(fabs(vel.y) * fh * 255 * alpha, 255);
-			_pixels[index++] = (uint8_t)0;
-			if(_alphaEnabled) _pixels[index++] = withAlpha ? speed : 255;
+			pixel[ro] = (uint8_t)math<float>::min(fabs(vel.x) * fw * 255 * alpha, 255);
+			pixel[go] = (uint8_t)math<float>::min(fabs(vel.y) * fh * 255 * alpha, 255);
+			pixel[bo] = (uint8_t)0;
+			if(_alphaEnabled) pixel[ao] = withAlpha ? speed : 255;
 
 		}
 	}
 
 #ifdef FLUID_TEXTURE
-	tex.update( _surface );
-	gl::draw( tex, Rectf( x, y, x + renderWidth, y + renderHeight ) );
+	_streamer.upload();
+	gl::draw( _streamer.getTexture(), Rectf( x, y, x + renderWidth, y + renderHeight ) );
 #endif
 }
 
@@ -243,22 +239,24 @@ void ciMsaFluidDrawerGl::drawSpeed(float x, float y, float renderWidth, float re
 	int fh = _fluidSolver->getHeight();
 
 	ci::Vec2f vel;
-	int index = 0;
+	Surface8u frame = _streamer.map();
+	const uint8_t ro = frame.getRedOffset(), go = frame.getGreenOffset(), bo = frame.getBlueOffset(), ao = frame.getAlphaOffset();
 	for(int j=1; j < fh-1; j++) {
-		for(int i=1; i < fw-1; i++) {
+		uint8_t *pixel = frame.getData( Vec2i( 0, j-1 ) );
+		for(int i=1; i < fw-1; i++, pixel += 4) {
 			_fluidSolver->getInfoAtCell(i, j, &vel, NULL);
 			float speed2 = fabs(vel.x) * fw + fabs(vel.y) * fh;
 			uint8_t speed = (uint8_t)math<float>::min(speed2 * 255 * alpha, 255);
-			_pixels[index++] = speed;
-			_pixels[index++] = speed;
-			_pixels[index++] = speed;
-			if(_alphaEnabled) _pixels[index++] = withAlpha ? speed : 255;
+			pixel[ro] = speed;
+			pixel[go] = speed;
+			pixel[bo] = speed;
+			if(_alphaEnabled) pixel[ao] = withAlpha ? speed : 255;
 		}
 	}
 
 #ifdef FLUID_TEXTURE
-	tex.update( _surface );
-	gl::draw( tex, Rectf( x, y, x + renderWidth, y + renderHeight ) );
+	_streamer.upload();
+	gl::draw( _streamer.getTexture(), Rectf( x, y, x + renderWidth, y + renderHeight ) );
 #endif
 }
 
@@ -312,11 +310,8 @@ void ciMsaFluidDrawerGl::deleteFluidSolver() {
 		delete _fluidSolver;
 		_fluidSolver = NULL;
 
-		if(_pixels) delete []_pixels;
-		_pixels = NULL;
-
 #ifdef FLUID_TEXTURE
-		tex.reset();
+		_streamer.reset();
 #endif
 	}
 }
@@ -57,6 +57,7 @@ ciMsaFluidSolver::ciMsaFluidSolver()
 ,uv(NULL)
 ,uvOld(NULL)
 ,curl(NULL)
+,doParallel(false)
 ,_isInited(false)
 {
 }
@@ -133,6 +134,16 @@ ciMsaFluidSolver& ciMsaFluidSolver::setWrap( bool bx, bool by ) {
 	return *this;
 }
 
+ciMsaFluidSolver& ciMsaFluidSolver::enableParallel( bool b, ci::JobSystemRef jobSystem ) {
+	doParallel = b;
+	mJobSystem = ( b && ! jobSystem ) ? ci::JobSystem::getDefault() : jobSystem;
+	return *this;
+}
+
+bool ciMsaFluidSolver::getParallel() const {
+	return doParallel;
+}
+
 bool ciMsaFluidSolver::isInited() const {
 	return _isInited;
 }
@@ -487,6 +498,11 @@ void ciMsaFluidSolver::addSource(float* x, float* x0) {
 }
 
 void ciMsaFluidSolver::advect( int bound, float* d, const float* d0, const ci::Vec2f* duv) {
+	forEachRow( std::bind( &ciMsaFluidSolver::advectRows, this, std::_1, std::_2, d, d0, duv ) );
+	setBoundary(bound, d);
+}
+
+void ciMsaFluidSolver::advectRows( int32_t jBegin, int32_t jEnd, float* d, const float* d0, const ci::Vec2f* duv ) {
 	int i0, j0, i1, j1;
 	float x, y, s0, t0, s1, t1;
 	int	index;
@@ -494,7 +510,7 @@ void ciMsaFluidSolver::advect( int bound, float* d, const float* d0, const ci::V
 	const float dt0x = _dt * _NX;
 	const float dt0y = _dt * _NY;
 	
-	for (int j = _NY; j > 0; --j)
+	for (int j = jEnd - 1; j >= jBegin; --j)
 	{
 		for (int i = _NX; i > 0; --i)
 		{
@@ -524,13 +540,18 @@ void ciMsaFluidSolver::advect( int bound, float* d, const float* d0, const ci::V
 			
 		}
 	}
-	setBoundary(bound, d);
 }
 
 //          d    d0    du    dv
 // advect(1, u, uOld, uOld, vOld);
 // advect(2, v, vOld, uOld, vOld);
 void ciMsaFluidSolver::advect2d( ci::Vec2f *uv, const ci::Vec2f *duv ) {
+	forEachRow( std::bind( &ciMsaFluidSolver::advect2dRows, this, std::_1, std::_2, uv, duv ) );
+	setBoundary2d(1, uv);
+	setBoundary2d(2, uv);	
+}
+
+void ciMsaFluidSolver::advect2dRows( int32_t jBegin, int32_t jEnd, ci::Vec2f *uv, const ci::Vec2f *duv ) {
 	int i0, j0, i1, j1;
 	float s0, t0, s1, t1;
 	int	index;
@@ -538,7 +559,7 @@ void ciMsaFluidSolver::advect2d( ci::Vec2f *uv, const ci::Vec2f *duv ) {
 	const float dt0x = _dt * _NX;
 	const float dt0y = _dt * _NY;
 	
-	for (int j = _NY; j > 0; --j)
+	for (int j = jEnd - 1; j >= jBegin; --j)
 	{
 		for (int i = _NX; i > 0; --i)
 		{
@@ -570,11 +591,14 @@ void ciMsaFluidSolver::advect2d( ci::Vec2f *uv, const ci::Vec2f *duv ) {
 			
 		}
 	}
-	setBoundary2d(1, uv);
-	setBoundary2d(2, uv);	
 }
 
 void ciMsaFluidSolver::advectRGB(int bound, const ci::Vec2f* duv) {
+	forEachRow( std::bind( &ciMsaFluidSolver::advectRGBRows, this, std::_1, std::_2, duv ) );
+	setBoundaryRGB();
+}
+
+void ciMsaFluidSolver::advectRGBRows( int32_t jBegin, int32_t jEnd, const ci::Vec2f* duv ) {
 	int i0, j0;
 	float x, y, s0, t0, s1, t1, dt0x, dt0y;
 	int	index;
@@ -582,7 +606,7 @@ void ciMsaFluidSolver::advectRGB(int bound, const ci::Vec2f* duv) {
 	dt0x = _dt * _NX;
 	dt0y = _dt * _NY;
 	
-	for (int j = _NY; j > 0; --j)
+	for (int j = jEnd - 1; j >= jBegin; --j)
 	{
 		for (int i = _NX; i > 0; --i)
 		{
@@ -612,7 +636,6 @@ void ciMsaFluidSolver::advectRGB(int bound, const ci::Vec2f* duv) {
 			b[index] = s0 * ( t0 * bOld[i0] + t1 * bOld[j0] ) + s1 * ( t0 * bOld[i0+1] + t1 * bOld[j0+1] );                          
 		}
 	}
-	setBoundaryRGB();
 }
 
 void ciMsaFluidSolver::diffuse( int bound, float* c, float* c0, float diff )
@@ -635,12 +658,25 @@ void ciMsaFluidSolver::diffuseUV( float diff )
 
 void ciMsaFluidSolver::project(ci::Vec2f* xy, ci::Vec2f* pDiv) 
 {
-	float	h;
+	forEachRow( std::bind( &ciMsaFluidSolver::divergenceRows, this, std::_1, std::_2, xy, pDiv ) );
+	
+	setBoundary02d( reinterpret_cast<ci::Vec2f*>( &pDiv[0].x ));
+	setBoundary02d( reinterpret_cast<ci::Vec2f*>( &pDiv[0].y ));
+	
+	linearSolverProject( pDiv );
+	
+	forEachRow( std::bind( &ciMsaFluidSolver::gradientRows, this, std::_1, std::_2, xy, pDiv ) );
+	
+	setBoundary2d(1, xy);
+	setBoundary2d(2, xy);
+}
+
+void ciMsaFluidSolver::divergenceRows( int32_t jBegin, int32_t jEnd, const ci::Vec2f* xy, ci::Vec2f* pDiv )
+{
 	int		index;
 	int		step_x = _NX + 2;
-	
-	h = - 0.5f / _NX;
-	for (int j = _NY; j > 0; --j)
+	float	h = - 0.5f / _NX;
+	for (int j = jEnd - 1; j >= jBegin; --j)
 	{
 		index = FLUID_IX(_NX, j);
 		for (int i = _NX; i > 0; --i)
@@ -650,15 +686,15 @@ void ciMsaFluidSolver::project(ci::Vec2f* xy, ci::Vec2f* pDiv)
 			--index;
 		}
 	}
-	
-	setBoundary02d( reinterpret_cast<ci::Vec2f*>( &pDiv[0].x ));
-	setBoundary02d( reinterpret_cast<ci::Vec2f*>( &pDiv[0].y ));
-	
-	linearSolverProject( pDiv );
-	
+}
+
+void ciMsaFluidSolver::gradientRows( int32_t jBegin, int32_t jEnd, ci::Vec2f* xy, const ci::Vec2f* pDiv )
+{
+	int		index;
+	int		step_x = _NX + 2;
 	float fx = 0.5f * _NX;
 	float fy = 0.5f * _NY;	//maa	change it from _NX to _NY
-	for (int j = _NY; j > 0; --j)
+	for (int j = jEnd - 1; j >= jBegin; --j)
 	{
 		index = FLUID_IX(_NX, j);
 		for (int i = _NX; i > 0; --i)
@@ -668,18 +704,24 @@ void ciMsaFluidSolver::project(ci::Vec2f* xy, ci::Vec2f* pDiv)
 			--index;
 		}
 	}
-	
-	setBoundary2d(1, xy);
-	setBoundary2d(2, xy);
 }
 
-
 //	Gauss-Seidel relaxation
 void ciMsaFluidSolver::linearSolver( int bound, float* __restrict x, const float* __restrict x0, float a, float c )
 {
 	int	step_x = _NX + 2;
 	int index;
 	c = 1. / c;
+	if( doParallel ) {
+		std::function<void(int32_t,int32_t)> red = std::bind( &ciMsaFluidSolver::relaxRows, this, std::_1, std::_2, 0, x, x0, a, c );
+		std::function<void(int32_t,int32_t)> black = std::bind( &ciMsaFluidSolver::relaxRows, this, std::_1, std::_2, 1, x, x0, a, c );
+		for (int k = solverIterations; k > 0; --k) {
+			forEachRow( red );
+			forEachRow( black );
+			setBoundary( bound, x );
+		}
+		return;
+	}
 	for (int k = solverIterations; k > 0; --k)	// MEMO 
 	{
 		for (int j = _NY; j > 0 ; --j)
@@ -699,6 +741,16 @@ void ciMsaFluidSolver::linearSolverProject( ci::Vec2f* __restrict pdiv )
 {
 	int	step_x = _NX + 2;
 	int index;
+	if( doParallel ) {
+		std::function<void(int32_t,int32_t)> red = std::bind( &ciMsaFluidSolver::relaxProjectRows, this, std::_1, std::_2, 0, pdiv );
+		std::function<void(int32_t,int32_t)> black = std::bind( &ciMsaFluidSolver::relaxProjectRows, this, std::_1, std::_2, 1, pdiv );
+		for (int k = solverIterations; k > 0; --k) {
+			forEachRow( red );
+			forEachRow( black );
+			setBoundary02d( reinterpret_cast<ci::Vec2f*>( &pdiv[0].x ) );
+		}
+		return;
+	}
 	for (int k = solverIterations; k > 0; --k) {
 		for (int j = _NY; j > 0 ; --j) {
 			index = FLUID_IX(_NX, j );
@@ -719,6 +771,16 @@ void ciMsaFluidSolver::linearSolverRGB( float a, float c )
 	int index3, index4, index;
 	int	step_x = _NX + 2;
 	c = 1. / c;
+	if( doParallel ) {
+		std::function<void(int32_t,int32_t)> red = std::bind( &ciMsaFluidSolver::relaxRGBRows, this, std::_1, std::_2, 0, a, c );
+		std::function<void(int32_t,int32_t)> black = std::bind( &ciMsaFluidSolver::relaxRGBRows, this, std::_1, std::_2, 1, a, c );
+		for ( int k = solverIterations; k > 0; --k ) {
+			forEachRow( red );
+			forEachRow( black );
+			setBoundaryRGB();
+		}
+		return;
+	}
 	for ( int k = solverIterations; k > 0; --k )	// MEMO
 	{           
 		for (int j = _NY; j > 0 ; --j)
@@ -748,6 +810,16 @@ void ciMsaFluidSolver::linearSolverUV( float a, float c )
 	int index;
 	int	step_x = _NX + 2;
 	c = 1. / c;
+	if( doParallel ) {
+		std::function<void(int32_t,int32_t)> red = std::bind( &ciMsaFluidSolver::relaxUVRows, this, std::_1, std::_2, 0, a, c );
+		std::function<void(int32_t,int32_t)> black = std::bind( &ciMsaFluidSolver::relaxUVRows, this, std::_1, std::_2, 1, a, c );
+		for (int k = solverIterations; k > 0; --k) {
+			forEachRow( red );
+			forEachRow( black );
+			setBoundary2d( 1, uv );
+		}
+		return;
+	}
 	ci::Vec2f* __restrict localUV = uv;
 	const ci::Vec2f* __restrict localOldUV = uvOld;
 
@@ -771,6 +843,141 @@ void ciMsaFluidSolver::linearSolverUV( float a, float c )
 	}
 }
 
+void ciMsaFluidSolver::forEachRow( const std::function<void(int32_t,int32_t)> &rowFn )
+{
+	if( doParallel ) {
+		// a few chunks per thread so that uneven rows don't leave threads idle
+		int32_t grainSize = std::max<int32_t>( 8, _NY / ( mJobSystem->getNumThreads() * 4 ) );
+		mJobSystem->parallelFor( 1, _NY + 1, rowFn, grainSize );
+	}
+	else
+		rowFn( 1, _NY + 1 );
+}
+
+// first column of row j whose cell has the given red-black parity
+#define FLUID_FIRST_I(j, parity)	(1 + ((((j) + 1) & 1) ^ (parity)))
+
+// red-black Gauss-Seidel: cells of one parity only read neighbours of the other, so rows can be relaxed concurrently
+void ciMsaFluidSolver::relaxRows( int32_t jBegin, int32_t jEnd, int parity, float* __restrict x, const float* __restrict x0, float a, float c )
+{
+	int	step_x = _NX + 2;
+	for (int j = jBegin; j < jEnd; ++j)
+	{
+		for (int index = FLUID_IX(FLUID_FIRST_I(j, parity), j), last = FLUID_IX(_NX, j); index <= last; index += 2)
+			x[index] = ( ( x[index-1] + x[index+1] + x[index - step_x] + x[index + step_x] ) * a + x0[index] ) * c;
+	}
+}
+
+void ciMsaFluidSolver::relaxProjectRows( int32_t jBegin, int32_t jEnd, int parity, ci::Vec2f* __restrict pdiv )
+{
+	int	step_x = _NX + 2;
+	for (int j = jBegin; j < jEnd; ++j)
+	{
+		for (int index = FLUID_IX(FLUID_FIRST_I(j, parity), j), last = FLUID_IX(_NX, j); index <= last; index += 2)
+			pdiv[index].x = ( pdiv[index-1].x + pdiv[index+1].x + pdiv[index - step_x].x + pdiv[index + step_x].x + pdiv[index].y ) * .25f;
+	}
+}
+
+void ciMsaFluidSolver::relaxRGBRows( int32_t jBegin, int32_t jEnd, int parity, float a, float c )
+{
+	int	step_x = _NX + 2;
+	for (int j = jBegin; j < jEnd; ++j)
+	{
+		for (int index = FLUID_IX(FLUID_FIRST_I(j, parity), j), last = FLUID_IX(_NX, j); index <= last; index += 2)
+		{
+			r[index] = ( ( r[index-1] + r[index+1] + r[index - step_x] + r[index + step_x] ) * a + rOld[index] ) * c;
+			g[index] = ( ( g[index-1] + g[index+1] + g[index - step_x] + g[index + step_x] ) * a + gOld[index] ) * c;
+			b[index] = ( ( b[index-1] + b[index+1] + b[index - step_x] + b[index + step_x] ) * a + bOld[index] ) * c;
+		}
+	}
+}
+
+void ciMsaFluidSolver::relaxUVRows( int32_t jBegin, int32_t jEnd, int parity, float a, float c )
+{
+	int	step_x = _NX + 2;
+	ci::Vec2f* __restrict localUV = uv;
+	const ci::Vec2f* __restrict localOldUV = uvOld;
+	for (int j = jBegin; j < jEnd; ++j)
+	{
+		for (int index = FLUID_IX(FLUID_FIRST_I(j, parity), j), last = FLUID_IX(_NX, j); index <= last; index += 2)
+		{
+			localUV[index].x = ( ( localUV[index-1].x + localUV[index+1].x + localUV[index - step_x].x + localUV[index + step_x].x ) * a + localOldUV[index].x ) * c;
+			localUV[index].y = ( ( localUV[index-1].y + localUV[index+1].y + localUV[index - step_x].y + localUV[index + step_x].y ) * a + localOldUV[index].y ) * c;
+		}
+	}
+}
+
+void ciMsaFluidSolver::addForcesAtPos( const ci::Vec2f *pos, const ci::Vec2f *forces, size_t count, float radius )
+{
+	if( count )
+		forEachRow( std::bind( &ciMsaFluidSolver::splatForceRows, this, std::_1, std::_2, pos, forces, count, radius ) );
+}
+
+void ciMsaFluidSolver::addColorsAtPos( const ci::Vec2f *pos, const ci::Color *colors, size_t count, float radius )
+{
+	if( count )
+		forEachRow( std::bind( &ciMsaFluidSolver::splatColorRows, this, std::_1, std::_2, pos, colors, count, radius ) );
+}
+
+bool ciMsaFluidSolver::getSplatBounds( int32_t jBegin, int32_t jEnd, const ci::Vec2f &pos, float radius, ci::Vec2f *center, int *iMin, int *iMax, int *jMin, int *jMax ) const
+{
+	// same mapping as addForceAtPos(), in continuous cell coordinates
+	center->set( pos.x * _NX + 1, pos.y * _NY + 1 );
+	*iMin = std::max<int>( 1, (int)floor( center->x - radius ) );
+	*iMax = std::min<int>( _NX, (int)floor( center->x + radius ) );
+	*jMin = std::max<int>( jBegin, (int)floor( center->y - radius ) );
+	*jMax = std::min<int>( jEnd - 1, (int)floor( center->y + radius ) );
+	return ( *iMin <= *iMax ) && ( *jMin <= *jMax );
+}
+
+float ciMsaFluidSolver::getSplatWeight( int i, int j, const ci::Vec2f &center, float radius ) const
+{
+	if( radius <= 0 )
+		return 1;
+	float dx = i + 0.5f - center.x, dy = j + 0.5f - center.y;
+	return std::max( 0.0f, 1 - sqrtf( dx * dx + dy * dy ) / radius );
+}
+
+// each row range only writes its own rows, so concurrent ranges never touch the same cell
+void ciMsaFluidSolver::splatForceRows( int32_t jBegin, int32_t jEnd, const ci::Vec2f *pos, const ci::Vec2f *forces, size_t count, float radius )
+{
+	ci::Vec2f center;
+	int iMin, iMax, jMin, jMax;
+	for( size_t p = 0; p < count; ++p ) {
+		if( ! getSplatBounds( jBegin, jEnd, pos[p], radius, &center, &iMin, &iMax, &jMin, &jMax ) )
+			continue;
+		for( int j = jMin; j <= jMax; ++j ) {
+			int index = FLUID_IX( iMin, j );
+			for( int i = iMin; i <= iMax; ++i, ++index ) {
+				float w = getSplatWeight( i, j, center, radius );
+				uv[index].x += forces[p].x * w;
+				uv[index].y += forces[p].y * w;
+			}
+		}
+	}
+}
+
+void ciMsaFluidSolver::splatColorRows( int32_t jBegin, int32_t jEnd, const ci::Vec2f *pos, const ci::Color *colors, size_t count, float radius )
+{
+	ci::Vec2f center;
+	int iMin, iMax, jMin, jMax;
+	for( size_t p = 0; p < count; ++p ) {
+		if( ! getSplatBounds( jBegin, jEnd, pos[p], radius, &center, &iMin, &iMax, &jMin, &jMax ) )
+			continue;
+		for( int j = jMin; j <= jMax; ++j ) {
+			int index = FLUID_IX( iMin, j );
+			for( int i = iMin; i <= iMax; ++i, ++index ) {
+				float w = getSplatWeight( i, j, center, radius );
+				rOld[index] += colors[p].r * w;
+				if( doRGB ) {
+					gOld[index] += colors[p].g * w;
+					bOld[index] += colors[p].b * w;
+				}
+			}
+		}
+	}
+}
+
 // specifies simple boundry conditions.
 void ciMsaFluidSolver::setBoundary(int bound, float* x)
 {
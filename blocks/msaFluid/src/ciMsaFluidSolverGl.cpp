@@ -0,0 +1,538 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "ciMsaFluidSolverGl.h"
+#include "cinder/gl/gl.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace cinder;
+
+namespace {
+
+const char *sPassVertexShader =
+	"void main() {\n"
+	"	gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+	"	gl_Position = ftransform();\n"
+	"}\n";
+
+// splats are drawn as points carrying their value in the texture coordinate, which isn't clamped like gl_Color
+const char *sSplatFragmentShader =
+	"void main() {\n"
+	"	gl_FragColor = gl_TexCoord[0];\n"
+	"}\n";
+
+const char *sAdvectFragmentShader =
+	"uniform sampler2D uVelocity, uSource;\n"
+	"uniform float uDt, uMax, uHold;\n"
+	"void main() {\n"
+	"	vec2 st = gl_TexCoord[0].st;\n"
+	"	vec2 pos = st - uDt * texture2D( uVelocity, st ).xy;\n"
+	"	gl_FragColor = min( texture2D( uSource, pos ), vec4( uMax ) ) * uHold;\n"
+	"}\n";
+
+const char *sJacobiFragmentShader =
+	"uniform sampler2D uX, uX0;\n"
+	"uniform vec2 uTexel;\n"
+	"uniform float uA, uInvC;\n"
+	"void main() {\n"
+	"	vec2 st = gl_TexCoord[0].st;\n"
+	"	vec4 sum = texture2D( uX, st - vec2( uTexel.x, 0.0 ) ) + texture2D( uX, st + vec2( uTexel.x, 0.0 ) )\n"
+	"			+ texture2D( uX, st - vec2( 0.0, uTexel.y ) ) + texture2D( uX, st + vec2( 0.0, uTexel.y ) );\n"
+	"	gl_FragColor = ( sum * uA + texture2D( uX0, st ) ) * uInvC;\n"
+	"}\n";
+
+const char *sDivergenceFragmentShader =
+	"uniform sampler2D uVelocity;\n"
+	"uniform vec2 uTexel;\n"
+	"void main() {\n"
+	"	vec2 st = gl_TexCoord[0].st;\n"
+	"	float du = texture2D( uVelocity, st + vec2( uTexel.x, 0.0 ) ).x - texture2D( uVelocity, st - vec2( uTexel.x, 0.0 ) ).x;\n"
+	"	float dv = texture2D( uVelocity, st + vec2( 0.0, uTexel.y ) ).y - texture2D( uVelocity, st - vec2( 0.0, uTexel.y ) ).y;\n"
+	"	gl_FragColor = vec4( -0.5 * ( du * uTexel.x + dv * uTexel.y ), 0.0, 0.0, 0.0 );\n"
+	"}\n";
+
+const char *sGradientFragmentShader =
+	"uniform sampler2D uVelocity, uPressure;\n"
+	"uniform vec2 uTexel;\n"
+	"void main() {\n"
+	"	vec2 st = gl_TexCoord[0].st;\n"
+	"	float dpx = texture2D( uPressure, st + vec2( uTexel.x, 0.0 ) ).x - texture2D( uPressure, st - vec2( uTexel.x, 0.0 ) ).x;\n"
+	"	float dpy = texture2D( uPressure, st + vec2( 0.0, uTexel.y ) ).x - texture2D( uPressure, st - vec2( 0.0, uTexel.y ) ).x;\n"
+	"	gl_FragColor = vec4( texture2D( uVelocity, st ).xy - 0.5 * vec2( dpx, dpy ) / uTexel, 0.0, 0.0 );\n"
+	"}\n";
+
+bool supportsPixelBufferObjects()
+{
+#if defined( CINDER_MAC )
+	return gl::isExtensionAvailable( "GL_ARB_pixel_buffer_object" );
+#elif defined( CINDER_MSW )
+	return GLEE_ARB_pixel_buffer_object != 0;
+#else
+	return false;
+#endif
+}
+
+} // anonymous namespace
+
+ciMsaFluidSolverGl::ciMsaFluidSolverGl()
+:_NX(0)
+,_NY(0)
+,_isInited(false)
+,_doReadback(false)
+,_nextReadbackSlot(0)
+,_readbackSequence(0)
+{
+}
+
+ciMsaFluidSolverGl& ciMsaFluidSolverGl::setup(int NX, int NY)
+{
+	setDeltaT();
+	setFadeSpeed();
+	setSolverIterations();
+	wrap_x = wrap_y = false;
+	
+	viscocity = FLUID_DEFAULT_VISC;
+	colorDiffusion = FLUID_DEFAULT_COLOR_DIFFUSION;
+	
+	createShaders();
+	return setSize( NX, NY );
+}
+
+ciMsaFluidSolverGl& ciMsaFluidSolverGl::setSize(int NX, int NY)
+{
+	_NX = NX;
+	_NY = NY;
+	
+	createBuffers();
+	reset();
+	return *this;
+}
+
+void ciMsaFluidSolverGl::createShaders()
+{
+	_splatShader = gl::GlslProg( sPassVertexShader, sSplatFragmentShader );
+	_advectShader = gl::GlslProg( sPassVertexShader, sAdvectFragmentShader );
+	_jacobiShader = gl::GlslProg( sPassVertexShader, sJacobiFragmentShader );
+	_divergenceShader = gl::GlslProg( sPassVertexShader, sDivergenceFragmentShader );
+	_gradientShader = gl::GlslProg( sPassVertexShader, sGradientFragmentShader );
+}
+
+void ciMsaFluidSolverGl::createBuffers()
+{
+	gl::Fbo::Format format;
+	format.setColorInternalFormat( GL_RGBA32F_ARB );
+	format.enableDepthBuffer( false );
+	format.setMinFilter( GL_LINEAR );
+	format.setMagFilter( GL_LINEAR );
+	format.setWrap( wrap_x ? GL_REPEAT : GL_CLAMP_TO_EDGE, wrap_y ? GL_REPEAT : GL_CLAMP_TO_EDGE );
+	
+	// the scratch buffers are swapped into _velocity and _color by diffuse(), so every buffer shares one format
+	for( int i = 0; i < 2; ++i ) {
+		_velocity[i] = gl::Fbo( _NX, _NY, format );
+		_color[i] = gl::Fbo( _NX, _NY, format );
+		_scratch[i] = gl::Fbo( _NX, _NY, format );
+	}
+	_divergence = gl::Fbo( _NX, _NY, format );
+}
+
+void ciMsaFluidSolverGl::reset()
+{
+	gl::SaveFramebufferBinding saveFramebuffer;
+	glPushAttrib( GL_COLOR_BUFFER_BIT );
+	for( int i = 0; i < 2; ++i ) {
+		clear( _velocity[i] );
+		clear( _color[i] );
+	}
+	glPopAttrib();
+	
+	_forces.clear();
+	_colors.clear();
+	
+	// drop reads in flight, as they belong to the old state
+	for( size_t s = 0; s < _readbackSlots.size(); ++s ) {
+		_readbackSlots[s].mPending = false;
+		_readbackSlots[s].mFence.reset();
+	}
+	_velocities.assign( _NX * _NY, Vec2f::zero() );
+	_isInited = true;
+}
+
+void ciMsaFluidSolverGl::clear( gl::Fbo &target )
+{
+	target.bindFramebuffer();
+	glClearColor( 0, 0, 0, 0 );
+	glClear( GL_COLOR_BUFFER_BIT );
+}
+
+void ciMsaFluidSolverGl::update()
+{
+	if( ! _isInited )
+		return;
+	
+	gl::SaveFramebufferBinding saveFramebuffer;
+	glPushAttrib( GL_VIEWPORT_BIT | GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT );
+	gl::pushMatrices();
+	// texel row 0 is normalized y = 0, so that texture coordinates and normalized positions coincide
+	gl::setViewport( Area( 0, 0, _NX, _NY ) );
+	gl::setMatricesWindow( _NX, _NY, false );
+	glDisable( GL_BLEND );
+	glDisable( GL_DEPTH_TEST );
+	
+	splat( _velocity[0], _forces );
+	_forces.clear();
+	if( viscocity != 0 )
+		diffuse( _velocity, viscocity );
+	project();
+	advect( _velocity, std::numeric_limits<float>::max(), 1 );
+	project();
+	
+	splat( _color[0], _colors );
+	_colors.clear();
+	if( colorDiffusion != 0 && _dt != 0 )
+		diffuse( _color, colorDiffusion );
+	advect( _color, 1, 1 - fadeSpeed );
+	
+	gl::GlslProg::unbind();
+	gl::popMatrices();
+	glPopAttrib();
+	
+	if( _doReadback )
+		startReadback();
+}
+
+void ciMsaFluidSolverGl::runPass( gl::Fbo &target )
+{
+	target.bindFramebuffer();
+	gl::drawSolidRect( Rectf( 0, 0, (float)_NX, (float)_NY ) );
+}
+
+void ciMsaFluidSolverGl::splat( gl::Fbo &target, const std::vector<Splat> &splats )
+{
+	if( splats.empty() )
+		return;
+	
+	target.bindFramebuffer();
+	_splatShader.bind();
+	glEnable( GL_BLEND );
+	glBlendFunc( GL_ONE, GL_ONE );
+	glBegin( GL_POINTS );
+	for( std::vector<Splat>::const_iterator splatIt = splats.begin(); splatIt != splats.end(); ++splatIt ) {
+		glTexCoord4f( splatIt->mValue.x, splatIt->mValue.y, splatIt->mValue.z, splatIt->mValue.w );
+		glVertex2f( splatIt->mPos.x, splatIt->mPos.y );
+	}
+	glEnd();
+	glDisable( GL_BLEND );
+}
+
+void ciMsaFluidSolverGl::advect( gl::Fbo *field, float maxValue, float hold )
+{
+	_advectShader.bind();
+	_advectShader.uniform( "uVelocity", 0 );
+	_advectShader.uniform( "uSource", 1 );
+	_advectShader.uniform( "uDt", _dt );
+	_advectShader.uniform( "uMax", maxValue );
+	_advectShader.uniform( "uHold", hold );
+	_velocity[0].getTexture().bind( 0 );
+	field[0].getTexture().bind( 1 );
+	runPass( field[1] );
+	field[0].getTexture().unbind( 1 );
+	_velocity[0].getTexture().unbind( 0 );
+	std::swap( field[0], field[1] );
+}
+
+void ciMsaFluidSolverGl::diffuse( gl::Fbo *field, float diff )
+{
+	float a = _dt * diff * _NX * _NY;
+	_jacobiShader.bind();
+	_jacobiShader.uniform( "uX", 0 );
+	_jacobiShader.uniform( "uX0", 1 );
+	_jacobiShader.uniform( "uTexel", Vec2f( 1.0f / _NX, 1.0f / _NY ) );
+	_jacobiShader.uniform( "uA", a );
+	_jacobiShader.uniform( "uInvC", 1.0f / ( 1 + 4 * a ) );
+	field[0].getTexture().bind( 1 );
+	for( int k = 0; k < solverIterations; ++k ) {
+		gl::Texture &x = ( k == 0 ) ? field[0].getTexture() : _scratch[0].getTexture();
+		x.bind( 0 );
+		runPass( _scratch[1] );
+		x.unbind( 0 );
+		std::swap( _scratch[0], _scratch[1] );
+	}
+	field[0].getTexture().unbind( 1 );
+	if( solverIterations > 0 )
+		std::swap( field[0], _scratch[0] );
+}
+
+void ciMsaFluidSolverGl::project()
+{
+	Vec2f texel( 1.0f / _NX, 1.0f / _NY );
+	
+	_divergenceShader.bind();
+	_divergenceShader.uniform( "uVelocity", 0 );
+	_divergenceShader.uniform( "uTexel", texel );
+	_velocity[0].getTexture().bind( 0 );
+	runPass( _divergence );
+	_velocity[0].getTexture().unbind( 0 );
+	
+	// pressure is solved from zero every frame, as the CPU solver does
+	clear( _scratch[0] );
+	_jacobiShader.bind();
+	_jacobiShader.uniform( "uX", 0 );
+	_jacobiShader.uniform( "uX0", 1 );
+	_jacobiShader.uniform( "uTexel", texel );
+	_jacobiShader.uniform( "uA", 1.0f );
+	_jacobiShader.uniform( "uInvC", 0.25f );
+	_divergence.getTexture().bind( 1 );
+	for( int k = 0; k < solverIterations; ++k ) {
+		_scratch[0].getTexture().bind( 0 );
+		runPass( _scratch[1] );
+		_scratch[0].getTexture().unbind( 0 );
+		std::swap( _scratch[0], _scratch[1] );
+	}
+	_divergence.getTexture().unbind( 1 );
+	
+	_gradientShader.bind();
+	_gradientShader.uniform( "uVelocity", 0 );
+	_gradientShader.uniform( "uPressure", 1 );
+	_gradientShader.uniform( "uTexel", texel );
+	_velocity[0].getTexture().bind( 0 );
+	_scratch[0].getTexture().bind( 1 );
+	runPass( _velocity[1] );
+	_scratch[0].getTexture().unbind( 1 );
+	_velocity[0].getTexture().unbind( 0 );
+	std::swap( _velocity[0], _velocity[1] );
+}
+
+void ciMsaFluidSolverGl::addForceAtPos( const Vec2f &pos, const Vec2f &force )
+{
+	int i = (int)( pos.x * _NX );
+	if( i < 0 || _NX <= i ) return;
+	int j = (int)( pos.y * _NY );
+	if( j < 0 || _NY <= j ) return;
+	addForceAtCell( i, j, force );
+}
+
+void ciMsaFluidSolverGl::addForceAtCell( int i, int j, const Vec2f &force )
+{
+	_forces.push_back( Splat( Vec2f( i + 0.5f, j + 0.5f ), Vec4f( force.x, force.y, 0, 0 ) ) );
+}
+
+void ciMsaFluidSolverGl::addColorAtPos( float x, float y, float r, float g, float b )
+{
+	int i = (int)( x * _NX );
+	if( i < 0 || _NX <= i ) return;
+	int j = (int)( y * _NY );
+	if( j < 0 || _NY <= j ) return;
+	addColorAtCell( i, j, r, g, b );
+}
+
+void ciMsaFluidSolverGl::addColorAtCell( int i, int j, float r, float g, float b )
+{
+	// the CPU solver adds colors as sources scaled by dt
+	_colors.push_back( Splat( Vec2f( i + 0.5f, j + 0.5f ), Vec4f( r, g, b, 0 ) * _dt ) );
+}
+
+ciMsaFluidSolverGl& ciMsaFluidSolverGl::enableVelocityReadback( bool b, int numBuffers )
+{
+	_doReadback = b;
+	_readbackSlots.clear();
+	_nextReadbackSlot = 0;
+	if( b && supportsPixelBufferObjects() ) {
+		_readbackSlots.resize( std::max( numBuffers, 1 ) );
+		for( size_t s = 0; s < _readbackSlots.size(); ++s )
+			_readbackSlots[s].mBuffer = gl::Vbo( GL_PIXEL_PACK_BUFFER_ARB );
+	}
+	return *this;
+}
+
+bool ciMsaFluidSolverGl::getVelocityReadback() const
+{
+	return _doReadback;
+}
+
+void ciMsaFluidSolverGl::startReadback()
+{
+	// deliver completed reads oldest first, so _velocities ends up with the newest
+	for( size_t i = 0; i < _readbackSlots.size(); ++i ) {
+		ReadbackSlot &slot = _readbackSlots[( _nextReadbackSlot + i ) % _readbackSlots.size()];
+		if( ! slot.mPending )
+			continue;
+		if( ! isReadbackComplete( slot, false ) )
+			break;
+		deliverReadback( &slot );
+	}
+	
+	gl::SaveFramebufferBinding saveFramebuffer;
+	_velocity[0].bindFramebuffer();
+	GLint oldPackAlignment;
+	glGetIntegerv( GL_PACK_ALIGNMENT, &oldPackAlignment );
+	glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+	
+	if( _readbackSlots.empty() ) {
+		std::vector<float> rgba( _NX * _NY * 4 );
+		glReadPixels( 0, 0, _NX, _NY, GL_RGBA, GL_FLOAT, &rgba[0] );
+		readVelocity( &rgba[0] );
+	}
+	else {
+		ReadbackSlot &slot = _readbackSlots[_nextReadbackSlot];
+		if( slot.mPending ) {
+			// the ring is full; wait on the oldest read rather than overwrite it
+			isReadbackComplete( slot, true );
+			deliverReadback( &slot );
+		}
+		
+		slot.mBuffer.bufferData( _NX * _NY * 4 * sizeof(float), NULL, GL_STREAM_READ_ARB );
+		// with a pixel pack buffer bound, glReadPixels returns immediately and the copy happens asynchronously
+		glReadPixels( 0, 0, _NX, _NY, GL_RGBA, GL_FLOAT, 0 );
+		slot.mBuffer.unbind();
+		
+		slot.mFence = gl::Fence::isSupported() ? gl::Fence::create() : gl::FenceRef();
+		slot.mPending = true;
+		slot.mSequence = ++_readbackSequence;
+		_nextReadbackSlot = ( _nextReadbackSlot + 1 ) % _readbackSlots.size();
+	}
+	
+	glPixelStorei( GL_PACK_ALIGNMENT, oldPackAlignment );
+}
+
+bool ciMsaFluidSolverGl::isReadbackComplete( const ReadbackSlot &slot, bool wait ) const
+{
+	if( slot.mFence )
+		return ( wait ) ? slot.mFence->wait() : slot.mFence->isSignaled();
+	else // without fences, assume a read is complete once a newer one has been issued after it
+		return wait || ( slot.mSequence != _readbackSequence );
+}
+
+void ciMsaFluidSolverGl::deliverReadback( ReadbackSlot *slot )
+{
+	const uint8_t *data = slot->mBuffer.map( GL_READ_ONLY_ARB );
+	if( data ) {
+		readVelocity( reinterpret_cast<const float*>( data ) );
+		slot->mBuffer.unmap();
+	}
+	slot->mBuffer.unbind();
+	slot->mFence.reset();
+	slot->mPending = false;
+}
+
+void ciMsaFluidSolverGl::readVelocity( const float *rgba )
+{
+	for( int i = 0; i < _NX * _NY; ++i )
+		_velocities[i].set( rgba[i * 4], rgba[i * 4 + 1] );
+}
+
+Vec2f ciMsaFluidSolverGl::getVelocityAtPos( const Vec2f &pos ) const
+{
+	if( _velocities.empty() )
+		return Vec2f::zero();
+	int i = constrain<int>( (int)( pos.x * _NX ), 0, _NX - 1 );
+	int j = constrain<int>( (int)( pos.y * _NY ), 0, _NY - 1 );
+	return _velocities[j * _NX + i];
+}
+
+void ciMsaFluidSolverGl::getInfoAtPos( float x, float y, Vec2f *vel, Color *color ) const
+{
+	if( vel ) {
+		Vec2f v = getVelocityAtPos( Vec2f( x, y ) );
+		vel->set( v.x / _NX, v.y / _NY );
+	}
+}
+
+int ciMsaFluidSolverGl::getNumCells() const
+{
+	return _NX * _NY;
+}
+
+int ciMsaFluidSolverGl::getWidth() const
+{
+	return _NX;
+}
+
+int ciMsaFluidSolverGl::getHeight() const
+{
+	return _NY;
+}
+
+bool ciMsaFluidSolverGl::isInited() const
+{
+	return _isInited;
+}
+
+ciMsaFluidSolverGl& ciMsaFluidSolverGl::setVisc( float newVisc )
+{
+	viscocity = newVisc;
+	return *this;
+}
+
+float ciMsaFluidSolverGl::getVisc() const
+{
+	return viscocity;
+}
+
+ciMsaFluidSolverGl& ciMsaFluidSolverGl::setColorDiffusion( float diff )
+{
+	colorDiffusion = diff;
+	return *this;
+}
+
+float ciMsaFluidSolverGl::getColorDiffusion() const
+{
+	return colorDiffusion;
+}
+
+ciMsaFluidSolverGl& ciMsaFluidSolverGl::setDeltaT( float dt )
+{
+	_dt = dt;
+	return *this;
+}
+
+ciMsaFluidSolverGl& ciMsaFluidSolverGl::setFadeSpeed( float fadeSpeed )
+{
+	this->fadeSpeed = fadeSpeed;
+	return *this;
+}
+
+ciMsaFluidSolverGl& ciMsaFluidSolverGl::setSolverIterations( int solverIterations )
+{
+	this->solverIterations = solverIterations;
+	return *this;
+}
+
+ciMsaFluidSolverGl& ciMsaFluidSolverGl::setWrap( bool bx, bool by )
+{
+	wrap_x = bx;
+	wrap_y = by;
+	if( _isInited ) {
+		GLenum wrapS = wrap_x ? GL_REPEAT : GL_CLAMP_TO_EDGE, wrapT = wrap_y ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+		for( int i = 0; i < 2; ++i ) {
+			_velocity[i].getTexture().setWrap( wrapS, wrapT );
+			_color[i].getTexture().setWrap( wrapS, wrapT );
+			_scratch[i].getTexture().setWrap( wrapS, wrapT );
+		}
+		_divergence.getTexture().setWrap( wrapS, wrapT );
+	}
+	return *this;
+}
@@ -27,6 +27,9 @@
 
 #pragma once
 
+#include "cinder/Cinder.h"
+#include "cinder/Buffer.h"
+
 #include <string>
 
 namespace cinder { namespace osc { 
@@ -40,6 +43,9 @@ typedef enum _ArgType
 	TYPE_STRING,
 	TYPE_BLOB,
 	TYPE_BUNDLE,
+	TYPE_INT64,
+	TYPE_DOUBLE,
+	TYPE_TIMETAG,
 	TYPE_INDEXOUTOFBOUNDS
 } ArgType;
 
@@ -108,5 +114,79 @@ typedef enum _ArgType
 		std::string value;
 	};
 
+	class ArgInt64 : public Arg
+	{
+	public:
+		ArgInt64( int64_t _value ) { value = _value; }
+		
+		/// return the type of this argument
+		ArgType getType() const { return TYPE_INT64; }
+		std::string getTypeName() const { return "int64"; }
+		
+		/// return value
+		int64_t get() const { return value; }
+		/// set value
+		void set( int64_t _value ) { value = _value; }
+		
+	private:
+		int64_t value;
+	};
+
+	class ArgDouble : public Arg
+	{
+	public:
+		ArgDouble( double _value ) { value = _value; }
+		
+		/// return the type of this argument
+		ArgType getType() const { return TYPE_DOUBLE; }
+		std::string getTypeName() const { return "double"; }
+		
+		/// return value
+		double get() const { return value; }
+		/// set value
+		void set( double _value ) { value = _value; }
+		
+	private:
+		double value;
+	};
+
+	/// An OSC time tag: NTP time, with seconds since 1900 in the upper 32 bits and the fraction of a second in the lower 32. A value of 1 means "immediately".
+	class ArgTimeTag : public Arg
+	{
+	public:
+		ArgTimeTag( uint64_t _value ) { value = _value; }
+		
+		/// return the type of this argument
+		ArgType getType() const { return TYPE_TIMETAG; }
+		std::string getTypeName() const { return "timetag"; }
+		
+		/// return value
+		uint64_t get() const { return value; }
+		/// set value
+		void set( uint64_t _value ) { value = _value; }
+		
+	private:
+		uint64_t value;
+	};
+
+	/// Binary data. Copies of the argument share the Buffer's data.
+	class ArgBlob : public Arg
+	{
+	public:
+		ArgBlob( const Buffer &_value ) { value = _value; }
+		
+		/// return the type of this argument
+		ArgType getType() const { return TYPE_BLOB; }
+		std::string getTypeName() const { return "blob"; }
+		
+		/// return value
+		const Buffer& get() const { return value; }
+		/// set value
+		void set( const Buffer &_value ) { value = _value; }
+		
+	private:
+		Buffer value;
+	};
+
 } // namespace osc
 } // namespace cinder
\ No newline at end of file
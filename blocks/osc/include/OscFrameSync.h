@@ -0,0 +1,137 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Buffer.h"
+#include "cinder/Thread.h"
+#include "cinder/Timer.h"
+#include "OscSender.h"
+#include "OscListener.h"
+
+#include <boost/noncopyable.hpp>
+#include <string>
+#include <vector>
+
+namespace cinder { namespace osc {
+	
+	/** \brief Keeps the frames of several machines, typically the parts of a video wall, in lockstep over OSC.
+		One machine is the MASTER and the others are CLIENTs. Each frame, every machine calls beginFrame() at the start of update() and endFrame() at the end of draw():
+		- The master's beginFrame() advances the frame number and sends it along with its elapsed time and an optional state delta set with setStateDelta().
+		- A client's beginFrame() waits for that message, so clients animate from getFrameNumber() and getElapsedSeconds() rather than their own clocks and render the same frame.
+		- endFrame() is a swap barrier: clients report that they've rendered the frame, and the master waits for all of them before telling everyone to swap.
+		This adds about one network round trip per frame. Every wait gives up after getTimeout() seconds, so a lost packet or a missing client costs one late frame rather than
+		stalling the wall; beginFrame() and endFrame() return false when that happens.
+		Messages are sent through Senders and received through a Listener owned by the application, as with ParamSync. **/
+	class FrameSync : private boost::noncopyable {
+	public:
+		enum Role { MASTER, CLIENT };
+		
+		FrameSync( Role role, const std::string &prefix = "/framesync" );
+		~FrameSync();
+		
+		Role	getRole() const { return mRole; }
+		
+		/** Adds a destination: on the master, one per client or a single Sender set up with a broadcast address; on a client, the master.
+			\a sender must outlive this. Several may be added. **/
+		void	addSender( Sender *sender );
+		//! Receives sync messages through \a listener, which must outlive this or be replaced and must not use queued receive
+		void	setListener( Listener *listener );
+		
+		//! Sets the number of clients the master's swap barrier waits for. Ignored by clients.
+		void	setNumClients( int numClients );
+		int		getNumClients() const { return (int)mClientFrames.size(); }
+		//! Sets this client's index, unique in [0, getNumClients()) on the master. Ignored by the master.
+		void	setClientId( int clientId ) { mClientId = clientId; }
+		int		getClientId() const { return mClientId; }
+		
+		//! Sets how long beginFrame() and endFrame() wait before giving up. Defaults to 0.25 seconds.
+		void	setTimeout( double seconds ) { mTimeout = seconds; }
+		double	getTimeout() const { return mTimeout; }
+		//! If \a seconds is positive, the master advances the elapsed time by exactly \a seconds every frame instead of reading its clock, making each frame fully deterministic. Defaults to 0.
+		void	setFixedFrameDuration( double seconds ) { mFixedFrameDuration = seconds; }
+		double	getFixedFrameDuration() const { return mFixedFrameDuration; }
+		
+		//! Sets application state to send to the clients with the next frame, typically only what changed since the last one. Master only.
+		void	setStateDelta( const Buffer &delta ) { mOutgoingDelta = delta; }
+		/** Returns the state deltas received by the last beginFrame(), in frame order. Usually there is one, but there can be none if the master sent no delta,
+			or several if this client fell behind and caught up. Client only. **/
+		const std::vector<Buffer>&	getStateDeltas() const { return mIncomingDeltas; }
+		
+		//! Starts the next frame. Call at the beginning of update(). Returns false if a client timed out waiting for the master.
+		bool	beginFrame();
+		//! Waits at the swap barrier. Call at the end of draw(). Returns false if the barrier timed out.
+		bool	endFrame();
+		
+		//! Returns the frame number shared by the cluster, which starts at 1 with the first beginFrame()
+		uint64_t	getFrameNumber() const { return mFrameNumber; }
+		//! Returns the master's elapsed seconds for the current frame
+		double		getElapsedSeconds() const { return mElapsedSeconds; }
+		//! Returns the number of times beginFrame() or endFrame() has timed out
+		uint32_t	getNumTimeouts() const { return mNumTimeouts; }
+		
+	protected:
+		struct ReceivedFrame {
+			uint64_t	mFrameNumber;
+			double		mElapsedSeconds;
+			Buffer		mDelta;
+		};
+		
+		void	messageReceived( const Message *message );
+		void	send( const Message &message );
+		//! Waits on mCondition until \a done returns true or the timeout passes, returning false in the latter case. \a lock must hold mMutex.
+		bool	waitFor( std::unique_lock<std::mutex> &lock, bool (FrameSync::*done)() const );
+		
+		bool	masterAllClientsReady() const;
+		bool	clientHasFrame() const { return ! mReceivedFrames.empty(); }
+		bool	clientHasSwap() const { return mSwapFrame >= mFrameNumber; }
+		
+		Role					mRole;
+		std::string				mPrefix;
+		std::vector<Sender*>	mSenders;
+		Listener				*mListener;
+		CallbackId				mListenerCallbackId;
+		int						mClientId;
+		double					mTimeout, mFixedFrameDuration;
+		Timer					mTimer;
+		
+		uint64_t				mFrameNumber;
+		double					mElapsedSeconds;
+		uint32_t				mNumTimeouts;
+		Buffer					mOutgoingDelta;
+		std::vector<Buffer>		mIncomingDeltas;
+		
+		// written by the listener's thread
+		std::mutex					mMutex;
+		std::condition_variable		mCondition;
+		std::vector<uint64_t>		mClientFrames; // master: the last frame each client reported ready
+		std::vector<ReceivedFrame>	mReceivedFrames; // client: frames received but not yet begun
+		uint64_t					mSwapFrame; // client: the last frame the master released
+	};
+	
+} // namespace osc
+} // namespace cinder
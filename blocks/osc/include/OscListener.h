@@ -31,6 +31,8 @@
 
 #include "OscMessage.h"
 #include "OscArg.h"
+#include "osc/OscReceivedElements.h"
+#include "ip/IpEndpointName.h"
 
 
 namespace cinder { namespace osc {
@@ -48,6 +50,13 @@ class Listener {
 	//! Registers an asynchronous callback which fires whenever a new message is received.
 	template<typename T>
 	CallbackId	registerMessageReceived( T *obj, void (T::*cb)(const osc::Message*) ) { return registerMessageReceived( std::bind1st( std::mem_fun( cb ), obj ) ); }
+	/** Registers an asynchronous callback which fires whenever a message with an address matching \a addressPattern is received, such as "/tracker/3/pos".
+		Each component of \a addressPattern may use the OSC wildcards '?', '*', "[a-z]", "[!abc]" and "{foo,bar}". Messages are routed through a tree of address
+		components, so the cost of a message depends on its address rather than on how many callbacks are registered. **/
+	CallbackId	registerMessageReceived( const std::string &addressPattern, std::function<void (const osc::Message*)> callback );
+	//! Registers an asynchronous callback which fires whenever a message with an address matching \a addressPattern is received.
+	template<typename T>
+	CallbackId	registerMessageReceived( const std::string &addressPattern, T *obj, void (T::*cb)(const osc::Message*) ) { return registerMessageReceived( addressPattern, std::bind1st( std::mem_fun( cb ), obj ) ); }
 	//! Unregisters an asynchronous callback previously registered with registerMessageReceived()
 	void		unregisterMessageReceived( CallbackId id );
 
@@ -55,6 +64,19 @@ class Listener {
 	bool hasWaitingMessages() const;
 	//! Gets the next message to be processed and puts it in \a resultMessage. Returns whether there was a message to process or not. Always \c false if callbacks have been registered using registerMessageReceived().
 	bool getNextMessage( Message *resultMessage );
+
+	//! Called by processQueuedMessages() with each message, which refers into its received packet and is only valid during the call
+	typedef std::function<void (const ::osc::ReceivedMessage&, const IpEndpointName&)>	ReceivedMessageFn;
+
+	/** Switches to queued receive, which suits high message rates. Must be called before setup(). Incoming packets are copied into a pool of \a numPackets
+		preallocated buffers of \a maxPacketSize bytes and handed to the thread calling processQueuedMessages() through a lock-free queue, so receiving
+		allocates nothing and takes no locks. Packets arriving while every buffer is queued, or larger than \a maxPacketSize, are dropped. Messages are
+		delivered only through processQueuedMessages(); neither registered callbacks nor getNextMessage() see them. **/
+	void	enableQueuedReceive( size_t numPackets = 1024, size_t maxPacketSize = 8192 );
+	//! Parses every queued packet in place and calls \a fn with each of its messages, including those nested in bundles. Returns the number of messages delivered. Typically called from update().
+	size_t	processQueuedMessages( const ReceivedMessageFn &fn );
+	//! Returns the number of packets dropped in queued receive because no buffer was free or the packet was too large
+	uint32_t	getNumDroppedPackets() const;
 	
   private:
 	std::shared_ptr<class OscListener>   oscListener;
@@ -58,10 +58,20 @@ namespace cinder { namespace osc {
 		int32_t getArgAsInt32( int index, bool typeConvert = false ) const;
 		float getArgAsFloat( int index, bool typeConvert = false ) const;
 		std::string getArgAsString( int index, bool typeConvert = false ) const;
+		int64_t getArgAsInt64( int index, bool typeConvert = false ) const;
+		double getArgAsDouble( int index, bool typeConvert = false ) const;
+		uint64_t getArgAsTimeTag( int index ) const;
+		const Buffer& getArgAsBlob( int index ) const;
 		
 		void addIntArg( int32_t argument );
 		void addFloatArg( float argument );
 		void addStringArg( std::string argument );
+		void addInt64Arg( int64_t argument );
+		void addDoubleArg( double argument );
+		//! Adds an OSC time tag, which is NTP time with seconds since 1900 in the upper 32 bits and the fraction of a second in the lower 32
+		void addTimeTagArg( uint64_t argument );
+		//! Adds binary data, which is shared rather than copied
+		void addBlobArg( const Buffer &argument );
 		
 	protected:
 		std::string address;
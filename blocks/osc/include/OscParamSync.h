@@ -0,0 +1,125 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Color.h"
+#include "cinder/Quaternion.h"
+#include "cinder/Thread.h"
+#include "cinder/Timer.h"
+#include "cinder/params/Params.h"
+#include "OscSender.h"
+#include "OscListener.h"
+
+#include <boost/noncopyable.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace cinder { namespace osc {
+	
+	/** \brief Registry of tweakable parameters which keeps them in sync across machines over OSC.
+		Each parameter is addressed as \a prefix followed by its name, e.g. "/params/gain". update() compares every parameter against a snapshot and sends
+		only those which changed, batched into bundles through Sender::queueMessage() and at most setMaxSendRate() times per second. Values received through
+		the Listener are queued and applied by the next update(), on the calling thread, without being echoed back out.
+		Parameters aren't sent when added, only once they change or sendAll() is called, so a machine joining the cluster doesn't overwrite the others with its defaults.
+		The same variables can be edited through a params::InterfaceGl via addToInterface(). **/
+	class ParamSync : private boost::noncopyable {
+	public:
+		ParamSync( const std::string &prefix = "/params" );
+		~ParamSync();
+		
+		void addParam( const std::string &name, bool *param );
+		void addParam( const std::string &name, int32_t *param );
+		void addParam( const std::string &name, float *param );
+		void addParam( const std::string &name, double *param );
+		void addParam( const std::string &name, Vec3f *param );
+		void addParam( const std::string &name, Quatf *param );
+		void addParam( const std::string &name, Color *param );
+		void addParam( const std::string &name, ColorA *param );
+		void addParam( const std::string &name, std::string *param );
+		void removeParam( const std::string &name );
+		
+		//! Adds every registered parameter to \a interface in registration order, with the same name and \a optionsStr
+		void addToInterface( params::InterfaceGl *interface, const std::string &optionsStr = "" ) const;
+		
+		//! Sends changed parameters through \a sender, which must outlive this or be replaced. May be NULL to only receive.
+		void setSender( Sender *sender );
+		//! Receives parameter changes through \a listener, which must outlive this or be replaced and must not use queued receive. May be NULL to only send.
+		void setListener( Listener *listener );
+		//! Caps how often update() sends changes. Changes in between accumulate, so each parameter is sent at most once per interval. Defaults to 30.
+		void setMaxSendRate( float sendsPerSecond );
+		float getMaxSendRate() const { return mMaxSendRate; }
+		
+		//! Applies received changes, then detects local changes and sends them if the send rate allows. Call once per frame from the thread which owns the variables.
+		void update();
+		//! Marks every parameter as changed, so the next send includes all of them, for instance when a machine joins the cluster
+		void sendAll();
+		//! Returns the number of parameters which have changed but not yet been sent
+		size_t getNumDirty() const;
+		
+	protected:
+		enum ParamType { BOOL, INT32, FLOAT, DOUBLE, VEC3F, QUATF, COLOR, COLORA, STRING };
+		
+		struct Param {
+			Param( const std::string &name, const std::string &address, ParamType type, void *ptr );
+			
+			//! Returns whether the value differs from the snapshot, updating the snapshot if so
+			bool	updateSnapshot();
+			
+			std::string				mName, mAddress;
+			ParamType				mType;
+			void					*mPtr;
+			std::vector<uint8_t>	mSnapshot;
+			std::string				mStringSnapshot;
+			bool					mDirty;
+		};
+		
+		static size_t	getParamSize( ParamType type );
+		
+		void	implAddParam( const std::string &name, ParamType type, void *ptr );
+		void	messageReceived( const Message *message );
+		//! Stores \a message's value in \a param, returning false if its arguments don't fit
+		bool	applyMessage( Param *param, const Message &message );
+		void	buildMessage( const Param &param, Message *message ) const;
+		
+		std::string						mPrefix;
+		std::vector<Param>				mParams;
+		std::map<std::string, size_t>	mParamsByAddress;
+		
+		Sender							*mSender;
+		Listener						*mListener;
+		CallbackId						mListenerCallbackId;
+		float							mMaxSendRate;
+		Timer							mTimer;
+		double							mLastSendTime;
+		
+		std::mutex						mReceivedMutex;
+		std::vector<Message>			mReceived;
+	};
+	
+} // namespace osc
+} // namespace cinder
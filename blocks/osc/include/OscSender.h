@@ -40,6 +40,19 @@ namespace cinder  { namespace osc {
 		
 		void sendMessage(Message& message);
 		void sendBundle(Bundle& bundle);
+
+		/** Queues \a message to be sent by the next flush(), coalesced with other queued messages into bundles of at most getMaxPacketSize() bytes.
+			Sending a frame's messages together this way takes one packet and one system call per bundle rather than per message.
+			A bundle is sent early whenever the next message wouldn't fit. **/
+		void queueMessage(const Message& message);
+		//! Sends every message queued by queueMessage(). Typically called once per frame, at the end of update().
+		void flush();
+		//! Returns the number of bytes of queued messages waiting for flush()
+		size_t getNumQueuedBytes() const;
+
+		//! Sets the largest UDP payload queueMessage() bundles up to. Defaults to 1472 bytes, which fits a 1500 byte Ethernet MTU with IPv4 and UDP headers.
+		void setMaxPacketSize(size_t maxPacketSize);
+		size_t getMaxPacketSize() const;
 		
 	private:
 		
@@ -0,0 +1,198 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "OscFrameSync.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+namespace cinder { namespace osc {
+	
+	FrameSync::FrameSync( Role role, const std::string &prefix )
+		: mRole( role ), mPrefix( prefix ), mListener( NULL ), mClientId( 0 ), mTimeout( 0.25 ), mFixedFrameDuration( 0 ), mTimer( true ),
+		mFrameNumber( 0 ), mElapsedSeconds( 0 ), mNumTimeouts( 0 ), mSwapFrame( 0 )
+	{
+	}
+	
+	FrameSync::~FrameSync()
+	{
+		setListener( NULL );
+	}
+	
+	void FrameSync::addSender( Sender *sender )
+	{
+		mSenders.push_back( sender );
+	}
+	
+	void FrameSync::setListener( Listener *listener )
+	{
+		if( mListener )
+			mListener->unregisterMessageReceived( mListenerCallbackId );
+		mListener = listener;
+		if( mListener )
+			mListenerCallbackId = mListener->registerMessageReceived( mPrefix + "/*", this, &FrameSync::messageReceived );
+	}
+	
+	void FrameSync::setNumClients( int numClients )
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mClientFrames.assign( numClients, 0 );
+	}
+	
+	void FrameSync::send( const Message &message )
+	{
+		for( std::vector<Sender*>::iterator senderIt = mSenders.begin(); senderIt != mSenders.end(); ++senderIt ) {
+			(*senderIt)->queueMessage( message );
+			(*senderIt)->flush();
+		}
+	}
+	
+	bool FrameSync::waitFor( std::unique_lock<std::mutex> &lock, bool (FrameSync::*done)() const )
+	{
+		boost::system_time deadline = boost::get_system_time() + boost::posix_time::microseconds( (int64_t)( mTimeout * 1000000 ) );
+		while( ! (this->*done)() ) {
+			if( ! mCondition.timed_wait( lock, deadline ) )
+				return (this->*done)();
+		}
+		return true;
+	}
+	
+	bool FrameSync::masterAllClientsReady() const
+	{
+		for( std::vector<uint64_t>::const_iterator frameIt = mClientFrames.begin(); frameIt != mClientFrames.end(); ++frameIt )
+			if( *frameIt < mFrameNumber )
+				return false;
+		return true;
+	}
+	
+	bool FrameSync::beginFrame()
+	{
+		mIncomingDeltas.clear();
+		
+		if( mRole == MASTER ) {
+			++mFrameNumber;
+			mElapsedSeconds = ( mFixedFrameDuration > 0 ) ? ( mFrameNumber - 1 ) * mFixedFrameDuration : mTimer.getSeconds();
+			
+			Message message;
+			message.setAddress( mPrefix + "/frame" );
+			message.addInt64Arg( (int64_t)mFrameNumber );
+			message.addDoubleArg( mElapsedSeconds );
+			if( mOutgoingDelta ) {
+				message.addBlobArg( mOutgoingDelta );
+				mOutgoingDelta = Buffer();
+			}
+			send( message );
+			return true;
+		}
+		
+		std::vector<ReceivedFrame> received;
+		bool result;
+		{
+			std::unique_lock<std::mutex> lock( mMutex );
+			result = waitFor( lock, &FrameSync::clientHasFrame );
+			received.swap( mReceivedFrames );
+		}
+		
+		for( std::vector<ReceivedFrame>::const_iterator frameIt = received.begin(); frameIt != received.end(); ++frameIt ) {
+			// drop duplicates and stragglers, unless the master has restarted from the first frame
+			if( frameIt->mFrameNumber <= mFrameNumber && frameIt->mFrameNumber != 1 )
+				continue;
+			mFrameNumber = frameIt->mFrameNumber;
+			mElapsedSeconds = frameIt->mElapsedSeconds;
+			if( frameIt->mDelta )
+				mIncomingDeltas.push_back( frameIt->mDelta );
+		}
+		
+		if( ! result )
+			++mNumTimeouts;
+		return result;
+	}
+	
+	bool FrameSync::endFrame()
+	{
+		bool result;
+		if( mRole == MASTER ) {
+			{
+				std::unique_lock<std::mutex> lock( mMutex );
+				result = waitFor( lock, &FrameSync::masterAllClientsReady );
+			}
+			// release the clients even if some are missing, so one machine can't stall the rest
+			Message message;
+			message.setAddress( mPrefix + "/swap" );
+			message.addInt64Arg( (int64_t)mFrameNumber );
+			send( message );
+		}
+		else {
+			Message message;
+			message.setAddress( mPrefix + "/ready" );
+			message.addIntArg( mClientId );
+			message.addInt64Arg( (int64_t)mFrameNumber );
+			send( message );
+			
+			std::unique_lock<std::mutex> lock( mMutex );
+			result = waitFor( lock, &FrameSync::clientHasSwap );
+		}
+		
+		if( ! result )
+			++mNumTimeouts;
+		return result;
+	}
+	
+	void FrameSync::messageReceived( const Message *message )
+	{
+		// called on the listener's thread
+		const std::string &address = message->getAddress();
+		try {
+			std::lock_guard<std::mutex> lock( mMutex );
+			if( mRole == MASTER ) {
+				if( address == mPrefix + "/ready" ) {
+					int32_t clientId = message->getArgAsInt32( 0 );
+					uint64_t frame = (uint64_t)message->getArgAsInt64( 1 );
+					if( clientId >= 0 && clientId < (int32_t)mClientFrames.size() )
+						mClientFrames[clientId] = frame;
+				}
+			}
+			else if( address == mPrefix + "/frame" ) {
+				ReceivedFrame frame;
+				frame.mFrameNumber = (uint64_t)message->getArgAsInt64( 0 );
+				frame.mElapsedSeconds = message->getArgAsDouble( 1 );
+				if( message->getNumArgs() > 2 )
+					frame.mDelta = message->getArgAsBlob( 2 );
+				if( frame.mFrameNumber == 1 )
+					mSwapFrame = 0;
+				mReceivedFrames.push_back( frame );
+			}
+			else if( address == mPrefix + "/swap" ) {
+				mSwapFrame = std::max<uint64_t>( mSwapFrame, (uint64_t)message->getArgAsInt64( 0 ) );
+			}
+		}
+		catch( OscExc & ) {
+			return; // malformed, most likely from another application sharing the port
+		}
+		mCondition.notify_all();
+	}
+	
+} // namespace osc
+} // namespace cinder
@@ -26,6 +26,7 @@
 
 #include "cinder/Thread.h" 
 #include "cinder/Utilities.h"
+#include "cinder/LockFreeCircularBuffer.h"
 #include "OscListener.h"
 #include "osc/OscTypes.h"
 #include "osc/OscPacketListener.h"
@@ -36,9 +37,184 @@
 #include <assert.h>
 #include <deque>
 #include <map>
+#include <boost/unordered_map.hpp>
 using namespace std;
 
 namespace cinder { namespace osc {
+
+namespace {
+
+// Returns whether the address component [s, sEnd) matches the OSC address pattern component [p, pEnd)
+bool matchesPattern( const char *p, const char *pEnd, const char *s, const char *sEnd )
+{
+	while( p != pEnd ) {
+		switch( *p ) {
+			case '?':
+				if( s == sEnd )
+					return false;
+				++p; ++s;
+			break;
+			case '*':
+				// collapse runs of '*', then try every possible length for it
+				while( p != pEnd && *p == '*' )
+					++p;
+				if( p == pEnd )
+					return true;
+				for( ; s != sEnd; ++s )
+					if( matchesPattern( p, pEnd, s, sEnd ) )
+						return true;
+				return matchesPattern( p, pEnd, s, sEnd );
+			case '[': {
+				if( s == sEnd )
+					return false;
+				const char *c = p + 1;
+				bool negate = ( c != pEnd && *c == '!' );
+				if( negate )
+					++c;
+				bool matched = false;
+				for( ; c != pEnd && *c != ']'; ++c ) {
+					if( c + 2 < pEnd && c[1] == '-' && c[2] != ']' ) {
+						matched = matched || ( *s >= c[0] && *s <= c[2] );
+						c += 2;
+					}
+					else
+						matched = matched || ( *s == *c );
+				}
+				if( c == pEnd || matched == negate ) // unterminated, or no match
+					return false;
+				p = c + 1; ++s;
+			}
+			break;
+			case '{': {
+				const char *close = std::find( p, pEnd, '}' );
+				if( close == pEnd )
+					return false;
+				// try each comma-separated alternative followed by the rest of the pattern
+				for( const char *alt = p + 1; alt <= close; ) {
+					const char *altEnd = std::find( alt, close, ',' );
+					size_t altSize = altEnd - alt;
+					if( (size_t)( sEnd - s ) >= altSize && std::equal( alt, altEnd, s ) && matchesPattern( close + 1, pEnd, s + altSize, sEnd ) )
+						return true;
+					alt = altEnd + 1;
+				}
+				return false;
+			}
+			default:
+				if( s == sEnd || *s != *p )
+					return false;
+				++p; ++s;
+		}
+	}
+	return s == sEnd;
+}
+
+bool hasWildcards( const string &component )
+{
+	return component.find_first_of( "?*[]{}" ) != string::npos;
+}
+
+// Routes messages to callbacks by their address, walking a tree of address components.
+// Literal components are found by hashing, so only wildcard components are matched one by one.
+class AddressRouter {
+  public:
+	typedef std::function<void (const Message*)>	Callback;
+
+	AddressRouter() : mRoot( new Node ) {}
+
+	void	add( CallbackId id, const string &addressPattern, const Callback &callback )
+	{
+		Node *node = mRoot.get();
+		vector<string> components = split( addressPattern, '/' );
+		for( vector<string>::const_iterator compIt = components.begin(); compIt != components.end(); ++compIt ) {
+			if( compIt->empty() ) // leading slash
+				continue;
+			shared_ptr<Node> *child;
+			if( hasWildcards( *compIt ) ) {
+				vector<pair<string,shared_ptr<Node> > >::iterator wildIt = node->mWildcardChildren.begin();
+				while( wildIt != node->mWildcardChildren.end() && wildIt->first != *compIt )
+					++wildIt;
+				if( wildIt == node->mWildcardChildren.end() )
+					wildIt = node->mWildcardChildren.insert( wildIt, make_pair( *compIt, shared_ptr<Node>() ) );
+				child = &wildIt->second;
+			}
+			else
+				child = &node->mLiteralChildren[*compIt];
+			if( ! *child )
+				*child = shared_ptr<Node>( new Node );
+			node = child->get();
+		}
+		node->mCallbacks.push_back( make_pair( id, callback ) );
+		mNodes[id] = node;
+	}
+
+	bool	remove( CallbackId id )
+	{
+		boost::unordered_map<CallbackId,Node*>::iterator nodeIt = mNodes.find( id );
+		if( nodeIt == mNodes.end() )
+			return false;
+		vector<pair<CallbackId,Callback> > &callbacks = nodeIt->second->mCallbacks;
+		for( vector<pair<CallbackId,Callback> >::iterator cbIt = callbacks.begin(); cbIt != callbacks.end(); ++cbIt ) {
+			if( cbIt->first == id ) {
+				callbacks.erase( cbIt );
+				break;
+			}
+		}
+		mNodes.erase( nodeIt );
+		return true;
+	}
+
+	bool	empty() const { return mNodes.empty(); }
+
+	//! Appends every callback whose pattern matches \a address to \a result
+	void	match( const char *address, vector<const Callback*> *result ) const
+	{
+		while( *address == '/' )
+			++address;
+		match( mRoot.get(), address, result );
+	}
+
+  private:
+	struct Node {
+		boost::unordered_map<string,shared_ptr<Node> >	mLiteralChildren;
+		vector<pair<string,shared_ptr<Node> > >			mWildcardChildren;
+		vector<pair<CallbackId,Callback> >				mCallbacks;
+	};
+
+	void	match( const Node *node, const char *address, vector<const Callback*> *result ) const
+	{
+		if( ! *address ) {
+			for( vector<pair<CallbackId,Callback> >::const_iterator cbIt = node->mCallbacks.begin(); cbIt != node->mCallbacks.end(); ++cbIt )
+				result->push_back( &cbIt->second );
+			return;
+		}
+
+		const char *componentEnd = address;
+		while( *componentEnd && *componentEnd != '/' )
+			++componentEnd;
+		const char *next = componentEnd;
+		while( *next == '/' )
+			++next;
+
+		if( ! node->mLiteralChildren.empty() ) {
+			boost::unordered_map<string,shared_ptr<Node> >::const_iterator childIt = node->mLiteralChildren.find( string( address, componentEnd ) );
+			if( childIt != node->mLiteralChildren.end() )
+				match( childIt->second.get(), next, result );
+		}
+		for( vector<pair<string,shared_ptr<Node> > >::const_iterator wildIt = node->mWildcardChildren.begin(); wildIt != node->mWildcardChildren.end(); ++wildIt ) {
+			const string &pattern = wildIt->first;
+			if( matchesPattern( pattern.data(), pattern.data() + pattern.size(), address, componentEnd ) )
+				match( wildIt->second.get(), next, result );
+		}
+	}
+
+	shared_ptr<Node>						mRoot;
+	boost::unordered_map<CallbackId,Node*>	mNodes;
+};
+
+// Ids of routed callbacks are kept apart from those CallbackMgr hands out, so that unregisterMessageReceived() can tell them apart
+const CallbackId ROUTED_CALLBACK_ID_BASE = 0x80000000u;
+
+} // anonymous namespace
 	
 class OscListener : public ::osc::OscPacketListener {	
   public:
@@ -51,15 +227,32 @@ class OscListener : public ::osc::OscPacketListener {
 	bool getNextMessage( Message * );
 
 	CallbackId	registerMessageReceived( std::function<void (const osc::Message*)> callback );
+	CallbackId	registerMessageReceived( const std::string &addressPattern, std::function<void (const osc::Message*)> callback );
 	void		unregisterMessageReceived( CallbackId id );
+
+	void		enableQueuedReceive( size_t numPackets, size_t maxPacketSize );
+	size_t		processQueuedMessages( const Listener::ReceivedMessageFn &fn );
+	uint32_t	getNumDroppedPackets() const { return mNumDroppedPackets; }
 	
 	void shutdown();
+
+	virtual void ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint );
 	
   protected:
 	virtual void ProcessMessage( const ::osc::ReceivedMessage &m, const IpEndpointName& remoteEndpoint );
 	
   private:
 	void threadSocket();
+
+	// A preallocated copy of one received packet, for queued receive
+	struct Packet {
+		std::vector<char>	mData;
+		int					mSize;
+		IpEndpointName		mRemoteEndpoint;
+	};
+	typedef SpscCircularBuffer<Packet*>	PacketQueue;
+
+	static size_t	dispatchBundle( const ::osc::ReceivedBundle &bundle, const IpEndpointName &remoteEndpoint, const Listener::ReceivedMessageFn &fn );
 	
 	deque<Message*> mMessages;
 	
@@ -69,14 +262,100 @@ class OscListener : public ::osc::OscPacketListener {
 	std::shared_ptr<std::thread> mThread;
 	
 	CallbackMgr<void (const Message*)>	mMessageReceivedCbs;
+	AddressRouter						mRouter;
+	CallbackId							mNextRoutedCallbackId;
+	vector<const AddressRouter::Callback*>	mMatchedCallbacks; // reused by ProcessMessage() to avoid allocating
 	bool mSocketHasShutdown;
+
+	// queued receive: the socket thread takes Packets from mFreePackets and hands them back full through mQueuedPackets
+	std::vector<Packet>					mPackets;
+	std::shared_ptr<PacketQueue>		mFreePackets, mQueuedPackets;
+	volatile uint32_t					mNumDroppedPackets;
 };
 
 OscListener::OscListener()
+	: mNumDroppedPackets( 0 ), mNextRoutedCallbackId( ROUTED_CALLBACK_ID_BASE )
 {
 	mListen_socket = NULL;
 }
 
+void OscListener::enableQueuedReceive( size_t numPackets, size_t maxPacketSize )
+{
+	assert( ! mListen_socket && "enableQueuedReceive() must be called before setup()" );
+
+	mPackets.resize( std::max<size_t>( numPackets, 1 ) );
+	mFreePackets = std::shared_ptr<PacketQueue>( new PacketQueue( mPackets.size() ) );
+	mQueuedPackets = std::shared_ptr<PacketQueue>( new PacketQueue( mPackets.size() ) );
+	for( vector<Packet>::iterator packetIt = mPackets.begin(); packetIt != mPackets.end(); ++packetIt ) {
+		packetIt->mData.resize( maxPacketSize );
+		packetIt->mSize = 0;
+		mFreePackets->tryPushFront( &*packetIt );
+	}
+}
+
+void OscListener::ProcessPacket( const char *data, int size, const IpEndpointName& remoteEndpoint )
+{
+	if( ! mQueuedPackets ) {
+		::osc::OscPacketListener::ProcessPacket( data, size, remoteEndpoint );
+		return;
+	}
+
+	Packet *packet;
+	if( ! mFreePackets->tryPopBack( &packet ) ) {
+		++mNumDroppedPackets;
+		return;
+	}
+	if( size < 0 || (size_t)size > packet->mData.size() ) {
+		++mNumDroppedPackets;
+		mFreePackets->tryPushFront( packet );
+		return;
+	}
+
+	memcpy( &packet->mData[0], data, size );
+	packet->mSize = size;
+	packet->mRemoteEndpoint = remoteEndpoint;
+	mQueuedPackets->tryPushFront( packet ); // can't fail; the queue holds every Packet
+}
+
+size_t OscListener::processQueuedMessages( const Listener::ReceivedMessageFn &fn )
+{
+	if( ! mQueuedPackets )
+		return 0;
+
+	size_t result = 0;
+	Packet *packet;
+	while( mQueuedPackets->tryPopBack( &packet ) ) {
+		try {
+			::osc::ReceivedPacket p( &packet->mData[0], packet->mSize );
+			if( p.IsBundle() )
+				result += dispatchBundle( ::osc::ReceivedBundle( p ), packet->mRemoteEndpoint, fn );
+			else {
+				fn( ::osc::ReceivedMessage( p ), packet->mRemoteEndpoint );
+				++result;
+			}
+		}
+		catch( ::osc::Exception & ) { // malformed packet; drop the rest of it
+		}
+		mFreePackets->tryPushFront( packet );
+	}
+
+	return result;
+}
+
+size_t OscListener::dispatchBundle( const ::osc::ReceivedBundle &bundle, const IpEndpointName &remoteEndpoint, const Listener::ReceivedMessageFn &fn )
+{
+	size_t result = 0;
+	for( ::osc::ReceivedBundle::const_iterator elementIt = bundle.ElementsBegin(); elementIt != bundle.ElementsEnd(); ++elementIt ) {
+		if( elementIt->IsBundle() )
+			result += dispatchBundle( ::osc::ReceivedBundle( *elementIt ), remoteEndpoint, fn );
+		else {
+			fn( ::osc::ReceivedMessage( *elementIt ), remoteEndpoint );
+			++result;
+		}
+	}
+	return result;
+}
+
 void OscListener::setup(int listen_port)
 {
 	if (mListen_socket) {
@@ -117,6 +396,16 @@ void OscListener::threadSocket() {
 }
 
 void OscListener::ProcessMessage( const ::osc::ReceivedMessage &m, const IpEndpointName& remoteEndpoint ) {
+	lock_guard<mutex> lock(mMutex);
+
+	// routing needs only the address, so messages which nothing handles are never built
+	mMatchedCallbacks.clear();
+	if( ! mRouter.empty() ) {
+		mRouter.match( m.AddressPattern(), &mMatchedCallbacks );
+		if( mMatchedCallbacks.empty() && mMessageReceivedCbs.empty() )
+			return;
+	}
+
 	Message* message = new Message();
 	
 	message->setAddress(m.AddressPattern());
@@ -132,17 +421,31 @@ void OscListener::ProcessMessage( const ::osc::ReceivedMessage &m, const IpEndpo
 			message->addFloatArg(arg->AsFloatUnchecked());
 		else if (arg->IsString())
 			message->addStringArg(arg->AsStringUnchecked());
+		else if (arg->IsInt64())
+			message->addInt64Arg(arg->AsInt64Unchecked());
+		else if (arg->IsDouble())
+			message->addDoubleArg(arg->AsDoubleUnchecked());
+		else if (arg->IsTimeTag())
+			message->addTimeTagArg(arg->AsTimeTagUnchecked());
+		else if (arg->IsBlob()) {
+			const void *data;
+			unsigned long size;
+			arg->AsBlobUnchecked(data, size);
+			Buffer blob( size );
+			memcpy( blob.getData(), data, size );
+			message->addBlobArg( blob );
+		}
 		else {
 			assert(false && "message argument type unknown");
 		}
 	}
 	
-	lock_guard<mutex> lock(mMutex);
-	
-	if( mMessageReceivedCbs.empty() ){
+	if( mMessageReceivedCbs.empty() && mRouter.empty() ){
 		mMessages.push_back( message );
 	}else{
 		mMessageReceivedCbs.call( message );
+		for( vector<const AddressRouter::Callback*>::const_iterator cbIt = mMatchedCallbacks.begin(); cbIt != mMatchedCallbacks.end(); ++cbIt )
+			(**cbIt)( message );
 		delete message;
 	}
 }
@@ -175,10 +478,21 @@ CallbackId OscListener::registerMessageReceived( std::function<void (const osc::
 	return mMessageReceivedCbs.registerCb( callback );
 }
 
+CallbackId OscListener::registerMessageReceived( const std::string &addressPattern, std::function<void (const osc::Message*)> callback )
+{
+	lock_guard<mutex> lock( mMutex );
+	CallbackId id = mNextRoutedCallbackId++;
+	mRouter.add( id, addressPattern, callback );
+	return id;
+}
+
 void OscListener::unregisterMessageReceived( CallbackId id )
 {
 	lock_guard<mutex> lock(mMutex);
-	return mMessageReceivedCbs.unregisterCb( id );
+	if( id >= ROUTED_CALLBACK_ID_BASE )
+		mRouter.remove( id );
+	else
+		mMessageReceivedCbs.unregisterCb( id );
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -208,9 +522,29 @@ CallbackId Listener::registerMessageReceived( std::function<void (const osc::Mes
 	return oscListener->registerMessageReceived( callback );
 }
 
+CallbackId Listener::registerMessageReceived( const std::string &addressPattern, std::function<void (const osc::Message*)> callback )
+{
+	return oscListener->registerMessageReceived( addressPattern, callback );
+}
+
 void Listener::unregisterMessageReceived( CallbackId id )
 {
 	return oscListener->unregisterMessageReceived( id );
 }
+
+void Listener::enableQueuedReceive( size_t numPackets, size_t maxPacketSize )
+{
+	oscListener->enableQueuedReceive( numPackets, maxPacketSize );
+}
+
+size_t Listener::processQueuedMessages( const ReceivedMessageFn &fn )
+{
+	return oscListener->processQueuedMessages( fn );
+}
+
+uint32_t Listener::getNumDroppedPackets() const
+{
+	return oscListener->getNumDroppedPackets();
+}
 	
 } } // namespace cinder::osc
@@ -99,6 +99,46 @@ std::string Message::getArgAsString( int index, bool typeConvert ) const{
         return ((ArgString*)args[index])->get();
 }
 
+int64_t Message::getArgAsInt64( int index, bool typeConvert ) const{
+	if (getArgType(index) != TYPE_INT64){
+		if( typeConvert && (getArgType(index) == TYPE_INT32) )
+			return ((ArgInt32*)args[index])->get();
+		else if( typeConvert && (getArgType(index) == TYPE_FLOAT) )
+			return (int64_t)((ArgFloat*)args[index])->get();
+		else if( typeConvert && (getArgType(index) == TYPE_DOUBLE) )
+			return (int64_t)((ArgDouble*)args[index])->get();
+		else
+			throw OscExcInvalidArgumentType();
+	}else
+		return ((ArgInt64*)args[index])->get();
+}
+
+double Message::getArgAsDouble( int index, bool typeConvert ) const{
+	if (getArgType(index) != TYPE_DOUBLE){
+		if( typeConvert && (getArgType(index) == TYPE_FLOAT) )
+			return ((ArgFloat*)args[index])->get();
+		else if( typeConvert && (getArgType(index) == TYPE_INT32) )
+			return ((ArgInt32*)args[index])->get();
+		else if( typeConvert && (getArgType(index) == TYPE_INT64) )
+			return (double)((ArgInt64*)args[index])->get();
+		else
+			throw OscExcInvalidArgumentType();
+	}else
+		return ((ArgDouble*)args[index])->get();
+}
+
+uint64_t Message::getArgAsTimeTag( int index ) const{
+	if (getArgType(index) != TYPE_TIMETAG)
+		throw OscExcInvalidArgumentType();
+	return ((ArgTimeTag*)args[index])->get();
+}
+
+const Buffer& Message::getArgAsBlob( int index ) const{
+	if (getArgType(index) != TYPE_BLOB)
+		throw OscExcInvalidArgumentType();
+	return ((ArgBlob*)args[index])->get();
+}
+
 void Message::addIntArg( int32_t argument ){
 	args.push_back( new ArgInt32( argument ) );
 }
@@ -110,6 +150,22 @@ void Message::addFloatArg( float argument ){
 void Message::addStringArg( std::string argument ){
 	args.push_back( new ArgString( argument ) );
 }
+
+void Message::addInt64Arg( int64_t argument ){
+	args.push_back( new ArgInt64( argument ) );
+}
+
+void Message::addDoubleArg( double argument ){
+	args.push_back( new ArgDouble( argument ) );
+}
+
+void Message::addTimeTagArg( uint64_t argument ){
+	args.push_back( new ArgTimeTag( argument ) );
+}
+
+void Message::addBlobArg( const Buffer &argument ){
+	args.push_back( new ArgBlob( argument ) );
+}
 	
 Message& Message::copy( const Message& other ){
 
@@ -126,6 +182,14 @@ Message& Message::copy( const Message& other ){
 			args.push_back( new ArgFloat( other.getArgAsFloat( i ) ) );
 		else if ( argType == TYPE_STRING )
 			args.push_back( new ArgString( other.getArgAsString( i ) ) );
+		else if ( argType == TYPE_INT64 )
+			args.push_back( new ArgInt64( other.getArgAsInt64( i ) ) );
+		else if ( argType == TYPE_DOUBLE )
+			args.push_back( new ArgDouble( other.getArgAsDouble( i ) ) );
+		else if ( argType == TYPE_TIMETAG )
+			args.push_back( new ArgTimeTag( other.getArgAsTimeTag( i ) ) );
+		else if ( argType == TYPE_BLOB )
+			args.push_back( new ArgBlob( other.getArgAsBlob( i ) ) );
 		else
 		{
 			throw OscExcInvalidArgumentType();
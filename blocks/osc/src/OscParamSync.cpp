@@ -0,0 +1,274 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "OscParamSync.h"
+
+#include <cstring>
+
+namespace cinder { namespace osc {
+	
+	namespace {
+		
+		// OSC addresses can't contain spaces or the characters used for pattern matching
+		std::string makeAddressComponent( const std::string &name )
+		{
+			std::string result( name );
+			for( size_t i = 0; i < result.size(); ++i )
+				if( result[i] == ' ' || strchr( "#*,/?[]{}", result[i] ) )
+					result[i] = '_';
+			return result;
+		}
+		
+	} // anonymous namespace
+	
+	size_t ParamSync::getParamSize( ParamType type )
+	{
+		switch( type ) {
+			case BOOL: return sizeof(bool);
+			case INT32: return sizeof(int32_t);
+			case FLOAT: return sizeof(float);
+			case DOUBLE: return sizeof(double);
+			case VEC3F: return sizeof(Vec3f);
+			case QUATF: return sizeof(Quatf);
+			case COLOR: return sizeof(Color);
+			case COLORA: return sizeof(ColorA);
+			default: return 0; // strings are compared by value
+		}
+	}
+	
+	ParamSync::Param::Param( const std::string &name, const std::string &address, ParamType type, void *ptr )
+		: mName( name ), mAddress( address ), mType( type ), mPtr( ptr ), mSnapshot( getParamSize( type ) ), mDirty( false )
+	{
+		updateSnapshot();
+	}
+	
+	bool ParamSync::Param::updateSnapshot()
+	{
+		if( mType == STRING ) {
+			const std::string &value = *static_cast<const std::string*>( mPtr );
+			if( value == mStringSnapshot )
+				return false;
+			mStringSnapshot = value;
+		}
+		else {
+			if( memcmp( &mSnapshot[0], mPtr, mSnapshot.size() ) == 0 )
+				return false;
+			memcpy( &mSnapshot[0], mPtr, mSnapshot.size() );
+		}
+		return true;
+	}
+	
+	ParamSync::ParamSync( const std::string &prefix )
+		: mPrefix( prefix ), mSender( NULL ), mListener( NULL ), mMaxSendRate( 30 ), mTimer( true ), mLastSendTime( -1 )
+	{
+	}
+	
+	ParamSync::~ParamSync()
+	{
+		setListener( NULL );
+	}
+	
+	void ParamSync::addParam( const std::string &name, bool *param )			{ implAddParam( name, BOOL, param ); }
+	void ParamSync::addParam( const std::string &name, int32_t *param )			{ implAddParam( name, INT32, param ); }
+	void ParamSync::addParam( const std::string &name, float *param )			{ implAddParam( name, FLOAT, param ); }
+	void ParamSync::addParam( const std::string &name, double *param )			{ implAddParam( name, DOUBLE, param ); }
+	void ParamSync::addParam( const std::string &name, Vec3f *param )			{ implAddParam( name, VEC3F, param ); }
+	void ParamSync::addParam( const std::string &name, Quatf *param )			{ implAddParam( name, QUATF, param ); }
+	void ParamSync::addParam( const std::string &name, Color *param )			{ implAddParam( name, COLOR, param ); }
+	void ParamSync::addParam( const std::string &name, ColorA *param )			{ implAddParam( name, COLORA, param ); }
+	void ParamSync::addParam( const std::string &name, std::string *param )		{ implAddParam( name, STRING, param ); }
+	
+	void ParamSync::implAddParam( const std::string &name, ParamType type, void *ptr )
+	{
+		removeParam( name );
+		std::string address = mPrefix + "/" + makeAddressComponent( name );
+		mParamsByAddress[address] = mParams.size();
+		mParams.push_back( Param( name, address, type, ptr ) );
+	}
+	
+	void ParamSync::removeParam( const std::string &name )
+	{
+		for( std::vector<Param>::iterator paramIt = mParams.begin(); paramIt != mParams.end(); ++paramIt ) {
+			if( paramIt->mName == name ) {
+				mParams.erase( paramIt );
+				mParamsByAddress.clear();
+				for( size_t p = 0; p < mParams.size(); ++p )
+					mParamsByAddress[mParams[p].mAddress] = p;
+				return;
+			}
+		}
+	}
+	
+	void ParamSync::addToInterface( params::InterfaceGl *interface, const std::string &optionsStr ) const
+	{
+		for( std::vector<Param>::const_iterator paramIt = mParams.begin(); paramIt != mParams.end(); ++paramIt ) {
+			switch( paramIt->mType ) {
+				case BOOL: interface->addParam( paramIt->mName, static_cast<bool*>( paramIt->mPtr ), optionsStr ); break;
+				case INT32: interface->addParam( paramIt->mName, static_cast<int32_t*>( paramIt->mPtr ), optionsStr ); break;
+				case FLOAT: interface->addParam( paramIt->mName, static_cast<float*>( paramIt->mPtr ), optionsStr ); break;
+				case DOUBLE: interface->addParam( paramIt->mName, static_cast<double*>( paramIt->mPtr ), optionsStr ); break;
+				case VEC3F: interface->addParam( paramIt->mName, static_cast<Vec3f*>( paramIt->mPtr ), optionsStr ); break;
+				case QUATF: interface->addParam( paramIt->mName, static_cast<Quatf*>( paramIt->mPtr ), optionsStr ); break;
+				case COLOR: interface->addParam( paramIt->mName, static_cast<Color*>( paramIt->mPtr ), optionsStr ); break;
+				case COLORA: interface->addParam( paramIt->mName, static_cast<ColorA*>( paramIt->mPtr ), optionsStr ); break;
+				case STRING: interface->addParam( paramIt->mName, static_cast<std::string*>( paramIt->mPtr ), optionsStr ); break;
+			}
+		}
+	}
+	
+	void ParamSync::setSender( Sender *sender )
+	{
+		mSender = sender;
+	}
+	
+	void ParamSync::setListener( Listener *listener )
+	{
+		if( mListener )
+			mListener->unregisterMessageReceived( mListenerCallbackId );
+		mListener = listener;
+		if( mListener )
+			mListenerCallbackId = mListener->registerMessageReceived( mPrefix + "/*", this, &ParamSync::messageReceived );
+	}
+	
+	void ParamSync::setMaxSendRate( float sendsPerSecond )
+	{
+		mMaxSendRate = sendsPerSecond;
+	}
+	
+	void ParamSync::messageReceived( const Message *message )
+	{
+		// called on the listener's thread; the variables belong to the thread calling update()
+		std::lock_guard<std::mutex> lock( mReceivedMutex );
+		mReceived.push_back( *message );
+	}
+	
+	void ParamSync::update()
+	{
+		std::vector<Message> received;
+		{
+			std::lock_guard<std::mutex> lock( mReceivedMutex );
+			received.swap( mReceived );
+		}
+		for( std::vector<Message>::const_iterator msgIt = received.begin(); msgIt != received.end(); ++msgIt ) {
+			std::map<std::string, size_t>::iterator found = mParamsByAddress.find( msgIt->getAddress() );
+			if( found == mParamsByAddress.end() )
+				continue;
+			Param &param = mParams[found->second];
+			// refreshing the snapshot keeps a received value from being sent back out
+			if( applyMessage( &param, *msgIt ) ) {
+				param.updateSnapshot();
+				param.mDirty = false;
+			}
+		}
+		
+		for( std::vector<Param>::iterator paramIt = mParams.begin(); paramIt != mParams.end(); ++paramIt )
+			if( paramIt->updateSnapshot() )
+				paramIt->mDirty = true;
+		
+		if( ! mSender )
+			return;
+		double now = mTimer.getSeconds();
+		if( mLastSendTime >= 0 && mMaxSendRate > 0 && now - mLastSendTime < 1.0 / mMaxSendRate )
+			return;
+		
+		bool sent = false;
+		for( std::vector<Param>::iterator paramIt = mParams.begin(); paramIt != mParams.end(); ++paramIt ) {
+			if( ! paramIt->mDirty )
+				continue;
+			Message message;
+			buildMessage( *paramIt, &message );
+			mSender->queueMessage( message );
+			paramIt->mDirty = false;
+			sent = true;
+		}
+		if( sent ) {
+			mSender->flush();
+			mLastSendTime = now;
+		}
+	}
+	
+	void ParamSync::sendAll()
+	{
+		for( std::vector<Param>::iterator paramIt = mParams.begin(); paramIt != mParams.end(); ++paramIt )
+			paramIt->mDirty = true;
+	}
+	
+	size_t ParamSync::getNumDirty() const
+	{
+		size_t result = 0;
+		for( std::vector<Param>::const_iterator paramIt = mParams.begin(); paramIt != mParams.end(); ++paramIt )
+			if( paramIt->mDirty )
+				++result;
+		return result;
+	}
+	
+	void ParamSync::buildMessage( const Param &param, Message *message ) const
+	{
+		message->setAddress( param.mAddress );
+		switch( param.mType ) {
+			case BOOL: message->addIntArg( *static_cast<const bool*>( param.mPtr ) ? 1 : 0 ); break;
+			case INT32: message->addIntArg( *static_cast<const int32_t*>( param.mPtr ) ); break;
+			case FLOAT: message->addFloatArg( *static_cast<const float*>( param.mPtr ) ); break;
+			case DOUBLE: message->addDoubleArg( *static_cast<const double*>( param.mPtr ) ); break;
+			case STRING: message->addStringArg( *static_cast<const std::string*>( param.mPtr ) ); break;
+			default: {
+				// the remaining types are packed floats
+				const float *values = static_cast<const float*>( param.mPtr );
+				for( size_t i = 0; i < getParamSize( param.mType ) / sizeof(float); ++i )
+					message->addFloatArg( values[i] );
+			}
+			break;
+		}
+	}
+	
+	bool ParamSync::applyMessage( Param *param, const Message &message )
+	{
+		try {
+			switch( param->mType ) {
+				case BOOL: *static_cast<bool*>( param->mPtr ) = message.getArgAsInt32( 0, true ) != 0; break;
+				case INT32: *static_cast<int32_t*>( param->mPtr ) = message.getArgAsInt32( 0, true ); break;
+				case FLOAT: *static_cast<float*>( param->mPtr ) = message.getArgAsFloat( 0, true ); break;
+				case DOUBLE: *static_cast<double*>( param->mPtr ) = message.getArgAsDouble( 0, true ); break;
+				case STRING: *static_cast<std::string*>( param->mPtr ) = message.getArgAsString( 0 ); break;
+				default: {
+					int numFloats = (int)( getParamSize( param->mType ) / sizeof(float) );
+					if( message.getNumArgs() != numFloats )
+						return false;
+					float values[4];
+					for( int i = 0; i < numFloats; ++i )
+						values[i] = message.getArgAsFloat( i, true );
+					memcpy( param->mPtr, values, numFloats * sizeof(float) );
+				}
+				break;
+			}
+		}
+		catch( OscExc & ) {
+			return false;
+		}
+		return true;
+	}
+	
+} // namespace osc
+} // namespace cinder
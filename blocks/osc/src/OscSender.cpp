@@ -32,6 +32,7 @@
 #include "ip/UdpSocket.h"
 
 #include <assert.h>
+#include <vector>
 namespace cinder { namespace osc {
 	
 	class OscSender  {
@@ -43,20 +44,37 @@ namespace cinder { namespace osc {
 		
 		void sendMessage(Message& message);
 		void sendBundle(Bundle& bundle);
+
+		void queueMessage(const Message& message);
+		void flush();
+		size_t getNumQueuedBytes() const { return mQueuedBundle.size(); }
+
+		void setMaxPacketSize(size_t maxPacketSize);
+		size_t getMaxPacketSize() const { return mMaxPacketSize; }
 		
 		void shutdown();
 	private:
 		
 		void appendBundle(Bundle& bundle, ::osc::OutboundPacketStream& p);
-		void appendMessage(Message& message, ::osc::OutboundPacketStream& p);
+		void appendMessage(const Message& message, ::osc::OutboundPacketStream& p);
 		
 		UdpTransmitSocket* socket;
+
+		// queued messages, already serialized as the elements of a bundle with an immediate time tag
+		std::vector<char>	mQueuedBundle;
+		size_t				mNumQueuedMessages;
+		std::vector<char>	mScratch;
+		size_t				mMaxPacketSize;
 		
 	};
 	
 	
+// "#bundle\0" followed by the time tag 1, meaning immediately
+static const char BUNDLE_HEADER[16] = { '#', 'b', 'u', 'n', 'd', 'l', 'e', 0, 0, 0, 0, 0, 0, 0, 0, 1 };
 
-OscSender::OscSender(){
+OscSender::OscSender()
+	: mNumQueuedMessages( 0 ), mMaxPacketSize( 1472 )
+{
 	socket = NULL;
 }
 
@@ -72,11 +90,57 @@ void OscSender::setup(std::string hostname, int port){
 }
 
 void OscSender::shutdown(){
-	if (socket)
+	if (socket) {
+		flush();
 		delete socket;
+	}
 	socket = NULL;
 }
 
+void OscSender::setMaxPacketSize(size_t maxPacketSize){
+	flush();
+	mMaxPacketSize = std::max<size_t>( maxPacketSize, sizeof(BUNDLE_HEADER) + 4 + 8 );
+}
+
+void OscSender::queueMessage(const Message& message){
+	// serialize on its own first, since OutboundPacketStream can't take back a message which overflows the bundle
+	if( mScratch.size() < std::max<size_t>( mMaxPacketSize, 16384 ) )
+		mScratch.resize( std::max<size_t>( mMaxPacketSize, 16384 ) );
+	::osc::OutboundPacketStream p( &mScratch[0], mScratch.size() );
+	appendMessage( message, p );
+	size_t messageSize = p.Size();
+
+	// a message too large to share a packet goes out by itself
+	if( sizeof(BUNDLE_HEADER) + 4 + messageSize > mMaxPacketSize ) {
+		flush();
+		socket->Send( p.Data(), (int)messageSize );
+		return;
+	}
+
+	if( mQueuedBundle.size() + 4 + messageSize > mMaxPacketSize )
+		flush();
+	if( mQueuedBundle.empty() ) {
+		mQueuedBundle.reserve( mMaxPacketSize );
+		mQueuedBundle.insert( mQueuedBundle.end(), BUNDLE_HEADER, BUNDLE_HEADER + sizeof(BUNDLE_HEADER) );
+	}
+
+	// each bundle element is preceded by its big-endian size
+	char sizeBytes[4] = { (char)( messageSize >> 24 ), (char)( messageSize >> 16 ), (char)( messageSize >> 8 ), (char)messageSize };
+	mQueuedBundle.insert( mQueuedBundle.end(), sizeBytes, sizeBytes + 4 );
+	mQueuedBundle.insert( mQueuedBundle.end(), p.Data(), p.Data() + messageSize );
+	++mNumQueuedMessages;
+}
+
+void OscSender::flush(){
+	if( mNumQueuedMessages == 1 ) // a lone message needs no bundle around it
+		socket->Send( &mQueuedBundle[sizeof(BUNDLE_HEADER) + 4], (int)( mQueuedBundle.size() - sizeof(BUNDLE_HEADER) - 4 ) );
+	else if( mNumQueuedMessages > 1 )
+		socket->Send( &mQueuedBundle[0], (int)mQueuedBundle.size() );
+
+	mQueuedBundle.clear();
+	mNumQueuedMessages = 0;
+}
+
 void OscSender::sendBundle(Bundle& bundle){
 	static const int OUTPUT_BUFFER_SIZE = 32768;
 	char buffer[OUTPUT_BUFFER_SIZE];
@@ -112,7 +176,7 @@ void OscSender::appendBundle(Bundle& bundle, ::osc::OutboundPacketStream& p){
 	p << ::osc::EndBundle;
 }
 
-void OscSender::appendMessage(Message& message, ::osc::OutboundPacketStream& p){
+void OscSender::appendMessage(const Message& message, ::osc::OutboundPacketStream& p){
 	p << ::osc::BeginMessage(message.getAddress().c_str());
 	for (int i = 0; i < message.getNumArgs(); ++i) {
 		if (message.getArgType(i) == TYPE_INT32){
@@ -121,6 +185,15 @@ void OscSender::appendMessage(Message& message, ::osc::OutboundPacketStream& p){
 			p << message.getArgAsFloat(i);
 		}else if (message.getArgType(i) == TYPE_STRING){
 			p << message.getArgAsString(i).c_str();
+		}else if (message.getArgType(i) == TYPE_INT64){
+			p << (::osc::int64)message.getArgAsInt64(i);
+		}else if (message.getArgType(i) == TYPE_DOUBLE){
+			p << message.getArgAsDouble(i);
+		}else if (message.getArgType(i) == TYPE_TIMETAG){
+			p << ::osc::TimeTag( message.getArgAsTimeTag(i) );
+		}else if (message.getArgType(i) == TYPE_BLOB){
+			const Buffer &blob = message.getArgAsBlob(i);
+			p << ::osc::Blob( blob.getData(), (unsigned long)blob.getDataSize() );
 		}else {
 			throw OscExcInvalidArgumentType();
 		}
@@ -144,6 +217,26 @@ void OscSender::appendMessage(Message& message, ::osc::OutboundPacketStream& p){
 	void Sender::sendBundle(Bundle& bundle){
 		oscSender->sendBundle(bundle);
 	}
+
+	void Sender::queueMessage(const Message& message){
+		oscSender->queueMessage(message);
+	}
+
+	void Sender::flush(){
+		oscSender->flush();
+	}
+
+	size_t Sender::getNumQueuedBytes() const{
+		return oscSender->getNumQueuedBytes();
+	}
+
+	void Sender::setMaxPacketSize(size_t maxPacketSize){
+		oscSender->setMaxPacketSize(maxPacketSize);
+	}
+
+	size_t Sender::getMaxPacketSize() const{
+		return oscSender->getMaxPacketSize();
+	}
 	
 }// namespace cinder
 }// namespace osc
\ No newline at end of file
@@ -0,0 +1,89 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Buffer.h"
+#include "cinder/DataSource.h"
+#include "cinder/Exception.h"
+#include "cinder/Filesystem.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class AssetArchive>	AssetArchiveRef;
+
+/** \brief Read-only package of many files in one memory-mapped file, with an index for random access.
+	Each file is stored either as-is or zlib-compressed, whichever is smaller by a worthwhile margin. Stored files are served straight out of the mapping
+	without copying, while compressed ones are inflated upon load(). Names are relative paths using '/' as the separator. Write archives with AssetArchive::write(). **/
+class AssetArchive {
+  public:
+	//! Maps the archive at \a path and reads its index. Throws AssetArchiveExc if the file can't be mapped or isn't a valid archive.
+	static AssetArchiveRef	create( const fs::path &path ) { return AssetArchiveRef( new AssetArchive( path ) ); }
+
+	//! Returns whether the archive contains a file named \a relativePath
+	bool				contains( const fs::path &relativePath ) const;
+	//! Returns a DataSource for the file named \a relativePath, or a NULL DataSourceRef if the archive doesn't contain it. Throws AssetArchiveExc if the file's data is corrupt.
+	DataSourceRef		load( const fs::path &relativePath ) const;
+
+	//! Returns the number of files in the archive
+	size_t				getNumEntries() const { return mEntries.size(); }
+	//! Returns the names of all the files in the archive, sorted
+	std::vector<std::string>	getEntryNames() const;
+	//! Returns the path of the archive on disk
+	const fs::path&		getFilePath() const { return mFilePath; }
+
+	/** Writes every file under \a sourceDirectory, recursively, to a new archive at \a archivePath, named by its path relative to \a sourceDirectory.
+		When \a compress is \c true each file is zlib-compressed at \a compressionLevel, and kept compressed only if that saves at least 1/8th of its size. Throws AssetArchiveExc on failure. **/
+	static void			write( const fs::path &archivePath, const fs::path &sourceDirectory, bool compress = true, int8_t compressionLevel = DEFAULT_COMPRESSION_LEVEL );
+
+  private:
+	explicit AssetArchive( const fs::path &path );
+
+	struct Entry {
+		uint8_t		mCompression;
+		uint64_t	mOffset, mStoredSize, mSize;
+	};
+
+	static std::string	normalizeName( const fs::path &relativePath );
+
+	fs::path						mFilePath;
+	Buffer							mMapping; // the whole file, sliced for stored entries
+	std::map<std::string,Entry>		mEntries;
+};
+
+class AssetArchiveExc : public Exception {
+  public:
+	AssetArchiveExc( const fs::path &path, const std::string &description );
+
+	virtual const char * what() const throw() { return mMessage; }
+
+	char mMessage[4096];
+};
+
+} // namespace cinder
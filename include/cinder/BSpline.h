@@ -76,6 +76,15 @@ class BSplineBasis
 	// evaluate basis functions and their derivatives
 	void compute( float fTime, unsigned int uiOrder, int &riMinIndex, int &riMaxIndex ) const;
 
+	// Returns the knot index i of fTime exactly as compute() would, clamping or
+	// wrapping fTime in place.  iHint is the index returned for a nearby time
+	// (or -1), which makes the search for sorted times constant on average.
+	int getSpan( float &rfTime, int iHint = -1 ) const;
+	// Expands the d+1 basis functions that are nonzero on span i into
+	// polynomials in the local parameter s = (t - knot[i]) / (knot[i+1] - knot[i]).
+	// afCoeff[j*(d+1)+k] receives the coefficient of s^k of basis function i-d+j.
+	void computeSpanPolynomials( int i, float *afCoeff, float &rfSpanStart, float &rfSpanWidth ) const;
+
  protected:
 	int initialize( int iNumCtrlPoints, int iDegree, bool bOpen );
 	float** allocate() const;
@@ -171,6 +180,14 @@ class BSpline
 	// quantities whose values you want.  You may pass 0 in any argument
 	// whose value you do not want.
 	void get( float t, T *position, T *firstDerivative = NULL, T *secondDerivative = NULL, T *thirdDerivative = NULL ) const;
+	// Batch versions of get() for \a count parameters in \a times.  Each
+	// knot span is expanded into a polynomial once and every t inside it is
+	// evaluated with Horner's rule, so sorted times (or runs of times sharing
+	// a span) are much cheaper than repeated calls to get().  Unsorted times
+	// are allowed.  Any of the output arrays may be NULL.
+	void getBatch( const float *times, size_t count, T *positions, T *firstDerivatives = NULL, T *secondDerivatives = NULL, T *thirdDerivatives = NULL ) const;
+	// Same as getBatch() for \a count times equally spaced in [t0,t1], end points included.
+	void getUniform( float t0, float t1, size_t count, T *positions, T *firstDerivatives = NULL, T *secondDerivatives = NULL, T *thirdDerivatives = NULL ) const;
 	//! Returns the time associated with an arc length in the range [0,getLength(0,1)]
 	float getTime( float length ) const;
 
@@ -183,6 +200,8 @@ class BSpline
     // function has bLoop equal to true, in which case the spline curve must
     // be a closed curve.
     void createControl( const T *akCtrlPoint );
+    // Shared by getBatch() and getUniform(); when times is NULL the i'th time is t0 + i * dt
+    void getSamples( const float *times, float t0, float dt, size_t count, T *positions, T *firstDerivatives, T *secondDerivatives, T *thirdDerivatives ) const;
 
     int mNumCtrlPoints;
     T *mCtrlPoints;  // ctrl[n+1]
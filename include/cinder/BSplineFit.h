@@ -32,4 +32,50 @@ namespace cinder {
 template<typename T>
 BSpline<T> fitBSpline( const std::vector<T> &samples, int degree, int outputSamples );
 
+//! Least squares fit of an open uniform BSpline to the most recent samples of a stream, such as live motion capture data.
+//! The oldest sample in the window maps to t = 0 and the newest to t = 1. Since the samples are uniformly spaced, the banded
+//! normal matrix only depends on the window size and is factored once; each refit costs one pass over the window plus two banded solves.
+template<typename T>
+class BSplineWindowFit {
+  public:
+	//! Fits \a numControlPoints control points of a \a degree spline to the last \a windowSize samples. Requires 1 <= \a degree < \a numControlPoints <= \a windowSize
+	BSplineWindowFit( int windowSize, int degree, int numControlPoints );
+
+	//! Appends \a sample, discarding the oldest sample once the window is full
+	void	addSample( const T &sample );
+	//! Appends \a count samples, discarding the oldest samples once the window is full
+	void	addSamples( const T *samples, size_t count );
+	//! Removes all samples
+	void	clear();
+
+	int		getWindowSize() const { return mWindowSize; }
+	int		getNumSamples() const { return mNumSamples; }
+	int		getDegree() const { return mDegree; }
+	int		getNumControlPoints() const { return mNumControlPoints; }
+	//! Returns whether the window holds enough samples for a fit, which is at least getNumControlPoints()
+	bool	canFit() const { return mNumSamples >= mNumControlPoints; }
+
+	//! Returns the control points fitted to the current window, refitting only if samples arrived since the last call. Empty when canFit() is \c false.
+	//! Like fitBSpline(), the first and last control points match the oldest and newest samples.
+	const std::vector<T>&	getControlPoints() const;
+	//! Returns the spline fitted to the current window. Requires canFit()
+	BSpline<T>				getSpline() const;
+
+  private:
+	void	factor() const;
+
+	int					mWindowSize, mDegree, mNumControlPoints;
+	std::vector<T>		mSamples;		// ring buffer of mWindowSize samples
+	int					mFirstSample, mNumSamples;
+
+	// Cholesky factor of the normal matrix and the basis values of each sample, valid for mFactoredSamples samples
+	mutable BandedMatrixd			mFactor;
+	mutable std::vector<double>		mSampleBases;
+	mutable std::vector<int>		mSampleMinIndices;
+	mutable int						mFactoredSamples;
+
+	mutable std::vector<T>			mControlPoints;
+	mutable bool					mDirty;
+};
+
 } // namespace cinder
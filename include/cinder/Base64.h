@@ -25,7 +25,9 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Buffer.h"
+#include "cinder/Stream.h"
 
+#include <boost/noncopyable.hpp>
 #include <string>
 
 namespace cinder {
@@ -44,4 +46,52 @@ Buffer fromBase64( const Buffer &input );
 //! Converts Base64-encoded data \a input into unencoded data.
 Buffer fromBase64( const void *input, size_t inputSize );
 
+//! Encodes everything remaining in \a input as Base64 and writes it to \a output a chunk at a time. If \a charsPerLine > 0, carriage returns (\n) are inserted every \a charsPerLine characters, rounded down to the nearest multiple of 4.
+void toBase64( IStreamRef input, OStreamRef output, int charsPerLine = 0 );
+//! Decodes everything remaining in the Base64-encoded \a input and writes the unencoded data to \a output a chunk at a time.
+void fromBase64( IStreamRef input, OStreamRef output );
+
+/** \brief Encodes data to Base64 as it arrives and writes the result to an OStream in chunks, so a large input never has to be held in memory along with its encoding.
+	The output matches toBase64() for the concatenation of everything written. **/
+class Base64Encoder : private boost::noncopyable {
+  public:
+	//! Creates an encoder writing to \a output. If \a charsPerLine > 0, carriage returns (\n) are inserted every \a charsPerLine characters, rounded down to the nearest multiple of 4.
+	explicit Base64Encoder( OStreamRef output, int charsPerLine = 0 );
+	//! Calls finish()
+	~Base64Encoder();
+
+	//! Encodes \a size bytes of \a data. Up to two trailing bytes are held back until more data arrives or finish() is called.
+	void	write( const void *data, size_t size );
+	//! Encodes any held back bytes with padding and writes all remaining output. Nothing can be written afterwards.
+	void	finish();
+
+  private:
+	OStreamRef		mOutput;
+	Buffer			mOutputBuffer;
+	size_t			mGroupsPerLine, mLineGroups;
+	uint8_t			mPending[2];
+	size_t			mNumPending;
+	bool			mFinished;
+};
+
+/** \brief Decodes Base64 as it arrives and writes the unencoded data to an OStream in chunks.
+	Like fromBase64(), characters outside the Base64 alphabet such as line breaks and padding are skipped. **/
+class Base64Decoder : private boost::noncopyable {
+  public:
+	//! Creates a decoder writing to \a output
+	explicit Base64Decoder( OStreamRef output );
+
+	//! Decodes \a size characters of \a encoded and writes the whole bytes they complete. A group of characters split between calls is completed by the next one.
+	void	write( const void *encoded, size_t size );
+	//! Ends the input, dropping the bits of an incomplete final group like fromBase64() does. Nothing can be written afterwards.
+	void	finish() { mFinished = true; }
+
+  private:
+	OStreamRef		mOutput;
+	Buffer			mOutputBuffer;
+	int				mStep;
+	char			mPartial;
+	bool			mFinished;
+};
+
 } // namespace cinder
\ No newline at end of file
@@ -0,0 +1,177 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Stream.h"
+#include "cinder/DataSource.h"
+#include "cinder/DataTarget.h"
+#include "cinder/Exception.h"
+#include "cinder/Vector.h"
+#include "cinder/Color.h"
+#include "cinder/Matrix.h"
+#include "cinder/PolyLine.h"
+#include "cinder/Surface.h"
+#include "cinder/TriMesh.h"
+
+#include <boost/noncopyable.hpp>
+#include <string>
+#include <vector>
+
+namespace cinder {
+
+//! Describes how a type is stored by BinaryOArchive, as \c NUM_COMPONENTS consecutive values of \c ComponentType with no padding
+template<typename T>
+struct BinaryArchiveTraits;
+
+#define CINDER_BINARY_ARCHIVE_SCALAR( T ) \
+	template<> struct BinaryArchiveTraits<T> { typedef T ComponentType; static const size_t NUM_COMPONENTS = 1; };
+CINDER_BINARY_ARCHIVE_SCALAR( int8_t )
+CINDER_BINARY_ARCHIVE_SCALAR( uint8_t )
+CINDER_BINARY_ARCHIVE_SCALAR( int16_t )
+CINDER_BINARY_ARCHIVE_SCALAR( uint16_t )
+CINDER_BINARY_ARCHIVE_SCALAR( int32_t )
+CINDER_BINARY_ARCHIVE_SCALAR( uint32_t )
+CINDER_BINARY_ARCHIVE_SCALAR( float )
+CINDER_BINARY_ARCHIVE_SCALAR( double )
+#undef CINDER_BINARY_ARCHIVE_SCALAR
+
+#define CINDER_BINARY_ARCHIVE_COMPOUND( TYPE, N ) \
+	template<typename T> struct BinaryArchiveTraits<TYPE<T> > { typedef T ComponentType; static const size_t NUM_COMPONENTS = N; };
+CINDER_BINARY_ARCHIVE_COMPOUND( Vec2, 2 )
+CINDER_BINARY_ARCHIVE_COMPOUND( Vec3, 3 )
+CINDER_BINARY_ARCHIVE_COMPOUND( Vec4, 4 )
+CINDER_BINARY_ARCHIVE_COMPOUND( ColorT, 3 )
+CINDER_BINARY_ARCHIVE_COMPOUND( ColorAT, 4 )
+CINDER_BINARY_ARCHIVE_COMPOUND( Matrix22, 4 )
+CINDER_BINARY_ARCHIVE_COMPOUND( Matrix33, 9 )
+CINDER_BINARY_ARCHIVE_COMPOUND( Matrix44, 16 )
+#undef CINDER_BINARY_ARCHIVE_COMPOUND
+
+/** \brief Writes values to an OStream in a compact binary form, for saving and restoring state much faster than through JsonTree or XmlTree.
+	Everything is stored little endian, so an archive reads back the same on any platform. Arrays of a type with BinaryArchiveTraits,
+	including std::vectors of vectors, colors and matrices, are written with a single OStream::writeData() call on little endian platforms.
+	The archive begins with a header holding an application-defined \a version, which BinaryIArchive::getVersion() returns so that
+	older layouts can still be read. TriMesh, SurfaceT and PolyLine are written with their own layout version as well.
+	<br><tt>BinaryOArchive archive( writeFile( "state.bin" ), 2 );
+	<br>archive.write( mPositions );
+	<br>archive.write( mCamera.getModelViewMatrix() );</tt> **/
+class BinaryOArchive : private boost::noncopyable {
+  public:
+	//! Writes the header of an archive tagged with \a version to \a stream
+	explicit BinaryOArchive( OStreamRef stream, uint32_t version = 0 );
+	//! Writes the header of an archive tagged with \a version to the stream of \a target
+	explicit BinaryOArchive( DataTargetRef target, uint32_t version = 0 );
+
+	//! Writes a single value of a type with BinaryArchiveTraits
+	template<typename T>
+	void	write( const T &t ) { writeArray( &t, 1 ); }
+	void	write( bool b ) { mStream->write<uint8_t>( b ? 1 : 0 ); }
+	void	write( const std::string &s );
+	//! Writes the size of \a v followed by its elements in a single call
+	template<typename T>
+	void	write( const std::vector<T> &v ) { writeCount( v.size() ); if( ! v.empty() ) writeArray( &v[0], v.size() ); }
+	template<typename T>
+	void	write( const PolyLine<T> &polyLine );
+	void	write( const TriMesh &mesh );
+	template<typename T>
+	void	write( const SurfaceT<T> &surface );
+
+	//! Writes the \a count values at \a t, with no count, in a single call
+	template<typename T>
+	void	writeArray( const T *t, size_t count ) { mStream->writeLittle( reinterpret_cast<const typename BinaryArchiveTraits<T>::ComponentType*>( t ), count * BinaryArchiveTraits<T>::NUM_COMPONENTS ); }
+	//! Writes \a size bytes at \a data as they are. Their byte order is up to the caller.
+	void	writeData( const void *data, size_t size ) { mStream->writeData( data, size ); }
+
+	//! Returns the stream the archive writes to
+	const OStreamRef&	getStream() const { return mStream; }
+
+  protected:
+	void		writeHeader( uint32_t version );
+	void		writeCount( size_t count );
+
+	OStreamRef		mStream;
+};
+
+//! Reads an archive written by BinaryOArchive. Every read throws BinaryIArchive::ExcInvalidArchive if the data is truncated or malformed.
+class BinaryIArchive : private boost::noncopyable {
+  public:
+	//! Reads the header of the archive in \a stream. Throws ExcInvalidArchive if it isn't one.
+	explicit BinaryIArchive( IStreamRef stream );
+	//! Reads the header of the archive in \a source. Throws ExcInvalidArchive if it isn't one.
+	explicit BinaryIArchive( DataSourceRef source );
+
+	//! Returns the application-defined version the archive was written with
+	uint32_t	getVersion() const { return mVersion; }
+
+	//! Reads a single value of a type with BinaryArchiveTraits
+	template<typename T>
+	void	read( T *t ) { readArray( t, 1 ); }
+	void	read( bool *b );
+	void	read( std::string *s );
+	//! Reads a std::vector written by BinaryOArchive::write(), replacing the contents of \a v, in a single call
+	template<typename T>
+	void	read( std::vector<T> *v ) { size_t count = readCount( sizeof(T) ); v->resize( count ); if( count ) readArray( &(*v)[0], count ); }
+	template<typename T>
+	void	read( PolyLine<T> *polyLine );
+	void	read( TriMesh *mesh );
+	template<typename T>
+	void	read( SurfaceT<T> *surface );
+	//! Reads and returns a value of type \a T
+	template<typename T>
+	T		read() { T t; read( &t ); return t; }
+
+	//! Reads \a count values written by BinaryOArchive::writeArray() into \a t in a single call
+	template<typename T>
+	void	readArray( T *t, size_t count ) { checkAvailable( count * sizeof(T) ); mStream->readLittle( reinterpret_cast<typename BinaryArchiveTraits<T>::ComponentType*>( t ), count * BinaryArchiveTraits<T>::NUM_COMPONENTS ); }
+	//! Reads \a size bytes written by BinaryOArchive::writeData() into \a data
+	void	readData( void *data, size_t size ) { checkAvailable( size ); mStream->readData( data, size ); }
+
+	//! Returns the stream the archive reads from
+	const IStreamRef&	getStream() const { return mStream; }
+
+	//! Exception thrown when the data isn't an archive, is truncated, or holds a layout newer than this code reads
+	class ExcInvalidArchive : public cinder::Exception {
+	  public:
+		ExcInvalidArchive( const char *description ) throw();
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[2048];
+	};
+
+  protected:
+	void		readHeader();
+	//! Reads a count of elements of \a elementSize bytes each, checking that the stream holds that many
+	size_t		readCount( size_t elementSize );
+	//! Reads the layout version of a \a typeName record, checking it isn't newer than \a currentVersion
+	uint8_t		readRecordVersion( uint8_t currentVersion, const char *typeName );
+	void		checkAvailable( size_t size ) const;
+
+	IStreamRef		mStream;
+	uint32_t		mVersion;
+};
+
+} // namespace cinder
@@ -23,12 +23,17 @@
 #pragma once
 
 #include "cinder/Cinder.h"
+#include "cinder/MemoryTracker.h"
 
 #define DEFAULT_COMPRESSION_LEVEL 6
 
 namespace cinder { 
 
 class Buffer {
+ public:
+	//! Buffers of up to this many bytes are stored along with their bookkeeping in a single allocation
+	static const size_t INLINE_SIZE = 128;
+
  private:
 	struct Obj {
 		Obj( void * aBuffer, size_t aSize, bool aOwnsData );
@@ -38,12 +43,24 @@ class Buffer {
 		size_t	mAllocatedSize;
 		size_t	mDataSize;
 		bool	mOwnsData;
+		bool	mIsInline; // mData points into an InlineObj, until a resize moves it to the heap
+		std::shared_ptr<const void>	mDataOwner; // keeps externally owned data such as a file mapping, or the Obj of a sliced Buffer, alive
+		TrackedMemory	mTrackedMemory; // the heap allocation owned by the Buffer
+	};
+
+	struct InlineObj : public Obj {
+		InlineObj( size_t aSize );
+
+		uint8_t	mStorage[INLINE_SIZE];
 	};
 
  public:
 	Buffer() {}
 	Buffer( void * aBuffer, size_t aSize );
+	//! Allocates a Buffer of \a size bytes. Sizes up to INLINE_SIZE avoid a separate allocation for the data.
 	Buffer( size_t size );
+	//! Creates a Buffer of \a size bytes at \a data without copying, which keeps \a data alive as long as the Buffer or any copy of it exists. The contents must be treated as read-only
+	Buffer( const std::shared_ptr<const void> &data, size_t size );
 	//! Creates a Buffer from a DataSource
 	explicit Buffer( std::shared_ptr<class DataSource> dataSource );
 	
@@ -60,7 +77,10 @@ class Buffer {
 	void resize( size_t newSize );
 	
 	void copyFrom( const void * aData, size_t length );
-	//TODO: copy from region of another buffer
+
+	/** Returns a Buffer of \a length bytes starting at \a offset which shares this Buffer's data rather than copying it, and keeps it alive.
+		The range is clamped to the data size. The parent must not be resized while slices of it exist. **/
+	Buffer	slice( size_t offset, size_t length ) const;
 	
 	//! Writes a Buffer to a DataTarget
 	void	write( std::shared_ptr<class DataTarget> dataTarget );
@@ -77,6 +97,45 @@ class Buffer {
 	//@}
 };
 
+/** \brief Accumulates data in a Buffer whose capacity grows geometrically, then hands it over without copying.
+	<br><tt>BufferBuilder builder;
+	<br>builder.append( header, headerSize );
+	<br>size_t bytesRead = stream->readDataAvailable( builder.prepare( 4096 ), 4096 );
+	<br>builder.commit( bytesRead );
+	<br>Buffer result = builder.release();</tt> **/
+class BufferBuilder {
+  public:
+	//! Creates an empty builder, allocating \a initialCapacity bytes if nonzero
+	explicit BufferBuilder( size_t initialCapacity = 0 );
+
+	//! Appends \a size bytes at \a data
+	void		append( const void *data, size_t size );
+	//! Returns a pointer to at least \a size writable bytes past the end of the data, growing the capacity geometrically when needed. Bytes written there are added by commit(). The pointer is invalidated by anything which grows the builder.
+	void*		prepare( size_t size );
+	//! Adds \a size bytes written at the pointer returned by prepare() to the data
+	void		commit( size_t size ) { mSize += size; }
+	//! Ensures that the capacity is at least \a capacity bytes
+	void		reserve( size_t capacity );
+
+	//! Returns the number of bytes of data
+	size_t		getSize() const { return mSize; }
+	//! Returns the number of bytes which can be held without allocating
+	size_t		getCapacity() const { return ( mBuffer ) ? mBuffer.getAllocatedSize() : 0; }
+	//! Returns a pointer to the data, which is invalidated by anything which grows the builder
+	void*		getData() { return ( mBuffer ) ? mBuffer.getData() : 0; }
+	//! Returns a pointer to the data, which is invalidated by anything which grows the builder
+	const void*	getData() const { return ( mBuffer ) ? mBuffer.getData() : 0; }
+	//! Discards the data but keeps the capacity
+	void		clear() { mSize = 0; }
+
+	//! Returns the data as a Buffer without copying it and leaves the builder empty. The Buffer's allocated size may exceed its data size.
+	Buffer		release();
+
+  private:
+	Buffer		mBuffer;
+	size_t		mSize;
+};
+
 Buffer compressBuffer( const Buffer &aBuffer, int8_t compressionLevel = DEFAULT_COMPRESSION_LEVEL, bool resizeResult = true );
 Buffer decompressBuffer( const Buffer &aBuffer, bool resizeResult = true, bool useGZip = false );
 
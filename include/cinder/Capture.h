@@ -24,6 +24,10 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Surface.h"
+#include "cinder/Channel.h"
+#include "cinder/YuvSurface.h"
+#include "cinder/Function.h"
+#include "cinder/gl/Texture.h"
 #include "cinder/Exception.h"
 
 #if defined( CINDER_MAC )
@@ -57,9 +61,47 @@ class Capture {
  public:
 	class Device;
 	typedef std::shared_ptr<Device> DeviceRef;
+	//! Receives each frame on the capture thread, along with the time it was captured as measured by getHostTime()
+	typedef std::function<void(const Surface8u&, double)>	FrameFn;
+	//! Receives the luminance of each frame on the capture thread, along with the time it was captured as measured by getHostTime()
+	typedef std::function<void(const Channel8u&, double)>	LumaFrameFn;
+	//! Receives each frame as YpCbCr 4:2:0 on the capture thread, along with the time it was captured as measured by getHostTime()
+	typedef std::function<void(const YuvSurface&, double)>	YuvFrameFn;
+
+	//! The pixel formats a device may be asked to deliver before any conversion
+	enum PixelFormat { PIXEL_FORMAT_ANY, PIXEL_FORMAT_RGB, PIXEL_FORMAT_YUV422, PIXEL_FORMAT_YUV420, PIXEL_FORMAT_MJPEG };
+
+	//! Options negotiated with the device when capture starts, in addition to the size requested from the constructor
+	class Format {
+	  public:
+		Format() : mFrameRate( 0 ), mPixelFormat( PIXEL_FORMAT_ANY ), mRegionOfInterest( 0, 0, 0, 0 ) {}
+
+		/** Sets the frame rate requested from the device. Default \c 0, the device's own choice.
+			On Windows DirectShow picks the closest rate the device supports; on Mac OS X and iOS frames arriving faster are dropped before they're delivered. **/
+		Format&			frameRate( float frameRate ) { mFrameRate = frameRate; return *this; }
+		float			getFrameRate() const { return mFrameRate; }
+		/** Sets the pixel format preferred from the device, which avoids decoding or converting formats the device handles poorly. Default \c PIXEL_FORMAT_ANY.
+			Honored on Windows, where DirectShow tries it before the device's other formats. On Mac OS X and iOS the system chooses the device's format. **/
+		Format&			pixelFormat( PixelFormat pixelFormat ) { mPixelFormat = pixelFormat; return *this; }
+		PixelFormat		getPixelFormat() const { return mPixelFormat; }
+		/** Restricts the frames delivered to \a area of the captured image, which getWidth() and getHeight() then report. Default is an empty Area, which delivers whole frames.
+			On Mac OS X and iOS frames refer to the region inside the device's buffer without copying it, and getTexture() still covers the whole frame; on Windows only the region is copied from the device's buffer. **/
+		Format&			regionOfInterest( const Area &area ) { mRegionOfInterest = area; return *this; }
+		const Area&		getRegionOfInterest() const { return mRegionOfInterest; }
+		//! Returns the region of interest clipped to a \a width by \a height frame, or the whole frame if there is no region of interest
+		Area			calcRegion( int32_t width, int32_t height ) const;
+
+	  protected:
+		float			mFrameRate;
+		PixelFormat		mPixelFormat;
+		Area			mRegionOfInterest;
+	};
 	
 	Capture() {}
-	Capture( int32_t width, int32_t height, const DeviceRef device = DeviceRef() );
+	/** Creates a Capture of \a device, or the default device if \a device is NULL, which delivers frames of \a width by \a height pixels, negotiated by \a format.
+		The device is asked for the closest size it supports: DirectShow picks the closest mode of the device, QTKit scales as it decompresses the device's frames,
+		and AVFoundation on iOS uses the smallest session preset which covers the size. **/
+	Capture( int32_t width, int32_t height, const DeviceRef device = DeviceRef(), const Format &format = Format() );
 	~Capture() {}
 
 	//! Begin capturing video
@@ -85,8 +127,30 @@ class Capture {
 	
 	//! Returns a Surface representing the current captured frame.
 	Surface8u	getSurface() const;
+	/** Returns a gl::Texture of the current captured frame, for use with the OpenGL context which is current when it's first called. On Mac OS X and iOS the frame's
+		pixel buffer is bound through a CoreVideo texture cache without copying or uploading it, to \c GL_TEXTURE_RECTANGLE_ARB on Mac OS X and \c GL_TEXTURE_2D on iOS.
+		Elsewhere getSurface() is uploaded into a texture which is reused from frame to frame. **/
+	gl::Texture	getTexture() const;
+	/** Sets a function which is called on the capture thread with each frame as soon as it arrives, so processing can begin without polling checkNewFrame().
+		The Surface shares the platform's recycled frame buffers rather than allocating its own, so it should only be retained as long as it's needed. Pass an empty function to remove it. **/
+	void		setFrameFn( const FrameFn &frameFn );
+	/** Sets a function which is called on the capture thread with the luminance of each frame as soon as it arrives. Takes effect from the next call to start().
+		On Mac OS X and iOS the device then delivers YpCbCr frames whose luminance is handed out in place, without color conversion or copying; getSurface(), getTexture() and setFrameFn() frames are unavailable in this mode.
+		On Windows the luminance is computed from each RGB frame into a recycled Channel. Pass an empty function to remove it. **/
+	void		setLumaFrameFn( const LumaFrameFn &lumaFrameFn );
+	/** Sets a function which is called on the capture thread with each frame as a YuvSurface, suitable for display through gl::YuvTexture. Takes effect from the next call to start(), and may be combined with setLumaFrameFn().
+		On Mac OS X (I420) and iOS (full range NV12) the device delivers YpCbCr, which is handed out in place with the same limitations as setLumaFrameFn().
+		On Windows each RGB frame is converted into an NV12 YuvSurface drawn from a pool. Pass an empty function to remove it. **/
+	void		setYuvFrameFn( const YuvFrameFn &yuvFrameFn );
+
+	/** Returns the current time in seconds on the monotonic host clock which frame timestamps are measured against, so frames from different devices can be compared.
+		On Mac OS X and iOS timestamps come from the capture hardware's host time; on Windows they are taken as each frame reaches the sample grabber. **/
+	static double	getHostTime();
+
 	//! Returns the associated Device for this instace of Capture
 	const Capture::DeviceRef getDevice() const;
+	//! Returns the Format this Capture was created with
+	const Format&	getFormat() const { return mObj->mFormat; }
 
 	//! Returns a vector of all Devices connected to the system. If \a forceRefresh then the system will be polled for connected devices.
 	static const std::vector<DeviceRef>&	getDevices( bool forceRefresh = false );
@@ -120,15 +184,18 @@ class Capture {
 		
  protected: 
 	struct Obj {
-		Obj( int32_t width, int32_t height, const Capture::DeviceRef device );
+		Obj( int32_t width, int32_t height, const Capture::DeviceRef device, const Format &format );
 		virtual ~Obj();
 
+		Format							mFormat;
+
 #if defined( CINDER_MAC ) 
 		CaptureImplQtKit				*mImpl;
 #elif defined( CINDER_COCOA_TOUCH )
 		CaptureImplAvFoundation			*mImpl;
 #elif defined( CINDER_MSW )
 		CaptureImplDirectShow			*mImpl;
+		gl::Texture						mTexture;
 #endif
 	};
 	
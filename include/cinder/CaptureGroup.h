@@ -0,0 +1,128 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Capture.h"
+#include "cinder/Function.h"
+#include "cinder/Thread.h"
+
+#include <boost/noncopyable.hpp>
+#include <deque>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class CaptureGroup>	CaptureGroupRef;
+
+/** \brief Captures from several devices at once and matches their frames by timestamp.
+	Each Capture pushes its frames to the group as they arrive. A worker thread waits until every device has a frame within the group's tolerance
+	of the others and hands the matched set to the FrameSetFn, discarding frames which have no partner. Only a few frames are kept waiting per device,
+	since on Mac OS X and iOS they are the capture hardware's own buffers. **/
+class CaptureGroup : private boost::noncopyable {
+  public:
+	//! One matched frame from each device of a CaptureGroup, in the order the devices were passed to create()
+	class FrameSet {
+	  public:
+		//! Returns the number of frames, which is the number of devices in the group
+		size_t				size() const { return mSurfaces.size(); }
+		//! Returns the frame of device \a index
+		const Surface8u&	getSurface( size_t index ) const { return mSurfaces[index]; }
+		//! Returns the capture time of the frame of device \a index, as measured by Capture::getHostTime()
+		double				getTime( size_t index ) const { return mTimes[index]; }
+		//! Returns the capture time of the latest frame of the set
+		double				getTime() const { return mTime; }
+
+	  private:
+		std::vector<Surface8u>	mSurfaces;
+		std::vector<double>		mTimes;
+		double					mTime;
+
+		friend class CaptureGroup;
+	};
+
+	typedef std::function<void(const FrameSet&)>	FrameSetFn;
+
+	/** Creates a group capturing \a width x \a height frames from each of \a devices, negotiated by \a format. Frames whose timestamps lie within \a tolerance seconds of each other are matched;
+		half the frame interval is a good choice. **/
+	static CaptureGroupRef	create( const std::vector<Capture::DeviceRef> &devices, int32_t width, int32_t height, double tolerance = 1 / 60.0, const Capture::Format &format = Capture::Format() )
+	{ return CaptureGroupRef( new CaptureGroup( devices, width, height, tolerance, format ) ); }
+
+	~CaptureGroup();
+
+	//! Starts all of the devices and the matching thread
+	void		start();
+	//! Stops all of the devices and the matching thread. Frames waiting for a partner are discarded.
+	void		stop();
+	//! Returns whether the group is capturing
+	bool		isCapturing() const { return mIsCapturing; }
+
+	//! Sets the function which is called on the group's worker thread with each matched FrameSet
+	void		setFrameSetFn( const FrameSetFn &frameSetFn );
+
+	//! Returns the number of devices in the group
+	size_t			getNumCaptures() const { return mCaptures.size(); }
+	//! Returns the Capture of device \a index
+	Capture&		getCapture( size_t index ) { return mCaptures[index]; }
+
+	//! Returns the tolerance in seconds within which frames are matched
+	double		getTolerance() const;
+	//! Sets the tolerance in seconds within which frames are matched
+	void		setTolerance( double tolerance );
+
+	//! Returns the number of FrameSets delivered since start()
+	uint32_t	getNumFrameSets() const { return mNumFrameSets; }
+	//! Returns the number of frames discarded since start() because no other device had a frame close enough in time
+	uint32_t	getNumDroppedFrames() const { return mNumDroppedFrames; }
+
+  private:
+	CaptureGroup( const std::vector<Capture::DeviceRef> &devices, int32_t width, int32_t height, double tolerance, const Capture::Format &format );
+
+	struct TimedFrame {
+		TimedFrame( const Surface8u &surface, double time ) : mSurface( surface ), mTime( time ) {}
+
+		Surface8u	mSurface;
+		double		mTime;
+	};
+
+	void		frameArrived( size_t index, const Surface8u &surface, double time );
+	bool		matchFrames( FrameSet *result );
+	void		threadFn();
+
+	std::vector<Capture>					mCaptures;
+	std::vector<std::deque<TimedFrame> >	mPending;
+	double									mTolerance;
+	FrameSetFn								mFrameSetFn;
+
+	mutable std::mutex						mMutex;
+	std::condition_variable					mFrameArrived;
+	std::shared_ptr<std::thread>			mThread;
+	bool									mIsCapturing;
+	volatile bool							mQuit;
+	volatile uint32_t						mNumFrameSets, mNumDroppedFrames;
+};
+
+} // namespace cinder
@@ -23,6 +23,7 @@
 #include "cinder/Cinder.h"
 #include "cinder/Surface.h"
 #include "cinder/Capture.h"
+#include "cinder/gl/Texture.h"
 #import <AVFoundation/AVFoundation.h>
 #include <vector>
 
@@ -53,21 +54,37 @@ class CaptureImplAvFoundationDevice : public Capture::Device {
 	bool							mHasNewFrame;
 	bool							mIsCapturing;
 	int32_t							mWidth, mHeight;
+	cinder::Capture::Format			mFormat;
 	int32_t							mSurfaceChannelOrderCode;
 	int32_t							mExposedFrameBytesPerRow;
 	int32_t							mExposedFrameHeight;
 	int32_t							mExposedFrameWidth;
+	
+	// the newest frame, kept for getCurrentTexture() even after getCurrentFrame() takes mWorkingPixelBuffer
+	CVPixelBufferRef				mLatestPixelBuffer;
+	uint32_t						mFrameCount, mTextureFrameCount;
+	CVOpenGLESTextureCacheRef		mTextureCache;
+	cinder::gl::Texture				mCurrentTexture;
+	
+	cinder::Capture::FrameFn		mFrameFn;
+	cinder::Capture::LumaFrameFn	mLumaFrameFn;
+	cinder::Capture::YuvFrameFn		mYuvFrameFn;
+	bool							mYpCbCr; // whether the running session delivers bi-planar YpCbCr frames for mLumaFrameFn and mYuvFrameFn
 }
 
 + (const std::vector<cinder::Capture::DeviceRef>&)getDevices:(BOOL)forceRefresh;
 
-- (id)initWithDevice:(const cinder::Capture::DeviceRef)device width:(int)width height:(int)height;
+- (id)initWithDevice:(const cinder::Capture::DeviceRef)device width:(int)width height:(int)height format:(const cinder::Capture::Format&)format;
 - (bool)prepareStartCapture;
 - (void)startCapture;
 - (void)stopCapture;
 - (bool)isCapturing;
 - (cinder::Surface8u)getCurrentFrame;
+- (cinder::gl::Texture)getCurrentTexture;
 - (bool)checkNewFrame;
+- (void)setFrameFn:(const cinder::Capture::FrameFn&)frameFn;
+- (void)setLumaFrameFn:(const cinder::Capture::LumaFrameFn&)lumaFrameFn;
+- (void)setYuvFrameFn:(const cinder::Capture::YuvFrameFn&)yuvFrameFn;
 - (const cinder::Capture::DeviceRef)getDevice;
 - (int32_t)getWidth;
 - (int32_t)getHeight;
@@ -25,6 +25,8 @@
 #include "cinder/Cinder.h"
 #include "cinder/Capture.h"
 #include "cinder/Surface.h"
+#include "cinder/SurfacePool.h"
+#include "cinder/Thread.h"
 #include "msw/videoInput/videoInput.h"
 
 namespace cinder {
@@ -33,8 +35,7 @@ class CaptureImplDirectShow {
  public:
 	class Device;
 
-	CaptureImplDirectShow( int32_t width, int32_t height, const Capture::DeviceRef device );
-	CaptureImplDirectShow( int32_t width, int32_t height );
+	CaptureImplDirectShow( int32_t width, int32_t height, const Capture::DeviceRef device, const Capture::Format &format );
 	~CaptureImplDirectShow();
 	
 	void start();
@@ -43,10 +44,16 @@ class CaptureImplDirectShow {
 	bool		isCapturing();
 	bool		checkNewFrame() const;
 
-	int32_t		getWidth() const { return mWidth; }
-	int32_t		getHeight() const { return mHeight; }
+	//! Returns the width of the region of interest, which is the whole frame unless the Format specifies one
+	int32_t		getWidth() const { return mRegion.getWidth(); }
+	//! Returns the height of the region of interest, which is the whole frame unless the Format specifies one
+	int32_t		getHeight() const { return mRegion.getHeight(); }
 	
 	Surface8u	getSurface() const;
+
+	void		setFrameFn( const Capture::FrameFn &frameFn );
+	void		setLumaFrameFn( const Capture::LumaFrameFn &lumaFrameFn );
+	void		setYuvFrameFn( const Capture::YuvFrameFn &yuvFrameFn );
 	
 	const Capture::DeviceRef getDevice() const { return mDevice; }
 	
@@ -63,7 +70,10 @@ class CaptureImplDirectShow {
 		int				mUniqueId;
 	};
  protected:
-	void	init( int32_t width, int32_t height, const Capture::Device &device );
+	void	setupDevice();
+	void	updateFrameCallback();
+
+	static void	frameCallback( unsigned char *pixels, int numBytes, void *refcon );
 
 	int								mDeviceID;
 	// this maintains a reference to the mgr so that we don't destroy it before
@@ -71,8 +81,19 @@ class CaptureImplDirectShow {
 	std::shared_ptr<class CaptureMgr>	mMgrPtr;
 	bool								mIsCapturing;
 	std::shared_ptr<class SurfaceCache>	mSurfaceCache;
-
-	int32_t				mWidth, mHeight;
+	// written only from videoInput's grabber thread
+	std::shared_ptr<class SurfaceCache>	mCallbackSurfaceCache;
+	std::shared_ptr<class ChannelCache>	mCallbackChannelCache;
+	SurfacePoolRef						mCallbackYuvPool;
+
+	std::mutex				mFrameFnMutex;
+	Capture::FrameFn		mFrameFn;
+	Capture::LumaFrameFn	mLumaFrameFn;
+	Capture::YuvFrameFn		mYuvFrameFn;
+
+	Capture::Format		mFormat;
+	int32_t				mWidth, mHeight; // the size of the device's frames
+	Area				mRegion; // the part of each frame which is delivered
 	mutable Surface8u	mCurrentFrame;
 	Capture::DeviceRef	mDevice;
 
@@ -23,6 +23,7 @@
 #include "cinder/Cinder.h"
 #include "cinder/Surface.h"
 #include "cinder/Capture.h"
+#include "cinder/gl/Texture.h"
 #import <QTKit/QTKit.h>
 #include <vector>
 
@@ -52,6 +53,7 @@ class CaptureImplQtKitDevice : public Capture::Device {
 	CVPixelBufferRef				mWorkingPixelBuffer;
 	cinder::Surface8u				mCurrentFrame;
 	int32_t							mWidth, mHeight;
+	cinder::Capture::Format			mFormat;
 	cinder::SurfaceChannelOrder		mSurfaceChannelOrderCode;
 	NSString						* mDeviceUniqueId;
 	int32_t							mExposedFrameBytesPerRow;
@@ -59,17 +61,32 @@ class CaptureImplQtKitDevice : public Capture::Device {
 	int32_t							mExposedFrameWidth;
 	bool							mHasNewFrame;
 	cinder::Capture::DeviceRef		mDevice;
+	
+	// the newest frame, kept for getCurrentTexture() even after getCurrentFrame() takes mWorkingPixelBuffer
+	CVPixelBufferRef				mLatestPixelBuffer;
+	uint32_t						mFrameCount, mTextureFrameCount;
+	CVOpenGLTextureCacheRef		mTextureCache;
+	cinder::gl::Texture				mCurrentTexture;
+	
+	cinder::Capture::FrameFn		mFrameFn;
+	cinder::Capture::LumaFrameFn	mLumaFrameFn;
+	cinder::Capture::YuvFrameFn		mYuvFrameFn;
+	bool							mYpCbCr; // whether the running session delivers planar YpCbCr frames for mLumaFrameFn and mYuvFrameFn
 }
 
 + (const std::vector<cinder::Capture::DeviceRef>&)getDevices:(BOOL)forceRefresh;
 
-- (id)initWithDevice:(const cinder::Capture::DeviceRef)device width:(int)width height:(int)height;
+- (id)initWithDevice:(const cinder::Capture::DeviceRef)device width:(int)width height:(int)height format:(const cinder::Capture::Format&)format;
 - (void)prepareStartCapture;
 - (void)startCapture;
 - (void)stopCapture;
 - (bool)isCapturing;
 - (cinder::Surface8u)getCurrentFrame;
+- (cinder::gl::Texture)getCurrentTexture;
 - (bool)checkNewFrame;
+- (void)setFrameFn:(const cinder::Capture::FrameFn&)frameFn;
+- (void)setLumaFrameFn:(const cinder::Capture::LumaFrameFn&)lumaFrameFn;
+- (void)setYuvFrameFn:(const cinder::Capture::YuvFrameFn&)yuvFrameFn;
 - (const cinder::Capture::DeviceRef)getDevice;
 - (int32_t)getWidth;
 - (int32_t)getHeight;
@@ -60,6 +60,8 @@ struct CHANTRAIT<uint16_t>
 	static uint16_t convert( uint16_t v ) { return v; }	
 	static uint16_t convert( float v ) { return static_cast<uint16_t>( v * 65535 ); }
 	static uint16_t grayscale( uint16_t r, uint16_t g, uint16_t b ) { return ( r * 6966 + g * 23436 + b * 2366 ) >> 15; } // luma coefficients from Rec. 709
+	static uint16_t premultiply( uint16_t c, uint16_t a ) { return (uint32_t)a * c / 65535; }
+	static uint16_t inverse( uint16_t c ) { return ~c; }
 };
 
 template<>
@@ -78,6 +80,6 @@ struct CHANTRAIT<float>
 	static float inverse( float c ) { return 1.0f - c; }	
 };
 
-#define CHANNEL_TYPES (uint8_t)(float)
+#define CHANNEL_TYPES (uint8_t)(uint16_t)(float)
 
 } // namespace cinder
@@ -27,10 +27,12 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Area.h"
+#include "cinder/MemoryTracker.h"
 
 namespace cinder {
 
 typedef std::shared_ptr<class ImageSource> ImageSourceRef;
+typedef std::shared_ptr<class SurfacePool> SurfacePoolRef;
 
 //! A single channel of image data, either a color channel of a Surface or a grayscale image. \ImplShared
 template<typename T>
@@ -49,6 +51,10 @@ class ChannelT {
 		
 		void						(*mDeallocatorFunc)(void *refcon);
 		void						*mDeallocatorRefcon;
+		//! The Obj whose data a sub-Channel references, kept alive for the lifetime of the sub-Channel
+		std::shared_ptr<Obj>		mParent;
+		//! Accounts for the data allocated by the Channel itself
+		TrackedMemory				mTrackedMemory;
 	};
 	/// \endcond
 
@@ -57,6 +63,10 @@ class ChannelT {
 	ChannelT() {}
 	//! Allocates and owns a contiguous block of memory that is sizeof(T) * width * height
 	ChannelT( int32_t width, int32_t height );
+	//! Allocates and owns a planar block of memory whose data and every row begin on a multiple of \a alignment bytes, which must be a power of two. Rows are padded as necessary.
+	ChannelT( int32_t width, int32_t height, int32_t alignment );
+	//! Allocates a contiguous block of memory from \a pool, which is returned to the pool when the Channel and all copies of it are destroyed
+	ChannelT( int32_t width, int32_t height, const SurfacePoolRef &pool );
 	//! Does not allocate or own memory pointed to by \a data
 	ChannelT( int32_t width, int32_t height, int32_t rowBytes, uint8_t increment, T *data );
 	//! Creates a ChannelT by loading from an ImageSource \a imageSource
@@ -68,6 +78,9 @@ class ChannelT {
 	ChannelT			clone( bool copyPixels = true ) const;
 	//! Returns a new Channel which is a duplicate of an Area \a area. If \a copyPixels the pixel values are copied, otherwise the clone's pixels remain uninitialized.
 	ChannelT			clone( const Area &area, bool copyPixels = true ) const;
+	/** Returns a Channel which references the pixels of the Area \a area, clipped to the bounds of \a this, without copying them. The result shares this Channel's data, row bytes and increment,
+		and keeps it alive. A sub-Channel of a Surface's Channel does not keep the Surface alive. **/
+	ChannelT			getSubChannel( const Area &area ) const;
 	
 	//! Returns the width of the Channel in pixels
 	int32_t		getWidth() const { return mObj->mWidth; }
@@ -273,7 +286,7 @@ class ChannelT {
 typedef ChannelT<uint8_t>	Channel;
 //! 8-bit image channel
 typedef ChannelT<uint8_t>	Channel8u;
-//! 16-bit image channel. Suitable as an intermediate representation and ImageIo but not a first-class citizen.	
+//! 16-bit image channel. Supported throughout cinder::ip, ImageIo and gl::Texture.	
 typedef ChannelT<uint16_t>	Channel16u;
 //! 32-bit floating point image channel
 typedef ChannelT<float>		Channel32f;
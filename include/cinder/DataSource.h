@@ -80,7 +80,32 @@ class DataSourcePath : public DataSource {
 	IStreamFileRef	mStream;	
 };
 
+typedef std::shared_ptr<class DataSourceMmap>	DataSourceMmapRef;
+
+//! A local file DataSource which maps the file into memory rather than reading it. getBuffer() returns the mapping itself without copying, and createStream() returns an IStreamMmap over it.
+//! Falls back to the FILE*-based behavior of DataSourcePath when the file can't be mapped.
+class DataSourceMmap : public DataSourcePath {
+  public:
+	static DataSourceMmapRef	create( const fs::path &path );
+
+	virtual IStreamRef	createStream();
+
+  protected:
+	explicit DataSourceMmap( const fs::path &path );
+
+	virtual	void	createBuffer();
+	//! Maps the file on first use. Returns \c false if it can't be mapped
+	bool			map();
+
+	std::shared_ptr<const void>		mMapping;
+	size_t							mMappingSize;
+	bool							mMapFailed;
+};
+
+//! Returns a DataSource for the local file at \a path, which is memory mapped when possible
 DataSourceRef	loadFile( const fs::path &path );
+//! Returns the contents of \a dataSource. Local files are memory mapped rather than read, even if \a dataSource is a plain DataSourcePath. The result must be treated as read-only
+Buffer			loadDataSourceBuffer( DataSourceRef dataSource );
 
 typedef std::shared_ptr<class DataSourceUrl>	DataSourceUrlRef;
 
@@ -63,6 +63,8 @@ typedef std::shared_ptr<class DataTargetPath>	DataTargetPathRef;
 class DataTargetPath : public DataTarget {
   public:
 	static DataTargetPathRef	createRef( const fs::path &path );
+	//! Creates a DataTargetPath whose stream writes to \a path on a background thread, as an OStreamFileAsync of format \a asyncFormat
+	static DataTargetPathRef	createRef( const fs::path &path, const OStreamFileAsync::Format &asyncFormat );
 	
 	virtual bool	providesFilePath() { return true; }
 	virtual bool	providesUrl() { return false; }
@@ -71,8 +73,11 @@ class DataTargetPath : public DataTarget {
 	
   protected:
 	explicit DataTargetPath( const fs::path &path );
+	DataTargetPath( const fs::path &path, const OStreamFileAsync::Format &asyncFormat );
   
-	OStreamFileRef	mStream;  
+	OStreamRef					mStream;
+	bool						mAsync;
+	OStreamFileAsync::Format	mAsyncFormat;
 };
 
 
@@ -95,5 +100,7 @@ class DataTargetStream : public DataTarget {
 
 //! Returns a DataTarget to file path \a path, and optionally creates any necessary directories when \a createParents is \c true.
 DataTargetPathRef writeFile( const fs::path &path, bool createParents = true );
+//! Returns a DataTarget to file path \a path whose stream writes on a background thread, as an OStreamFileAsync of format \a format. Optionally creates any necessary directories when \a createParents is \c true.
+DataTargetPathRef writeFileAsync( const fs::path &path, bool createParents = true, const OStreamFileAsync::Format &format = OStreamFileAsync::Format() );
 
 } // namespace cinder
\ No newline at end of file
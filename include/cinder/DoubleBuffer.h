@@ -0,0 +1,57 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+
+namespace cinder {
+
+/** \brief Pair of values of which one is written while the other is read, for handing state from one thread to another.
+	Typically update() writes back(), draw() reads front(), and App::swapFrameState() calls swap() while neither is running. **/
+template<typename T>
+class DoubleBuffer {
+  public:
+	DoubleBuffer() : mFront( 0 ) {}
+	//! Initializes both buffers to \a value
+	explicit DoubleBuffer( const T &value ) : mFront( 0 ) { mBuffers[0] = mBuffers[1] = value; }
+
+	//! Returns the buffer being read
+	const T&	front() const { return mBuffers[mFront]; }
+	//! Returns the buffer being written
+	T&			back() { return mBuffers[1 - mFront]; }
+	const T&	back() const { return mBuffers[1 - mFront]; }
+
+	//! Exchanges the roles of the buffers, so that what was written is now read. The new back() holds the state before last.
+	void		swap() { mFront = 1 - mFront; }
+	//! Exchanges the roles of the buffers and copies the new front() to back(), for writers which modify the latest state incrementally
+	void		swapAndCopy() { swap(); back() = front(); }
+
+  private:
+	T		mBuffers[2];
+	int		mFront;
+};
+
+} // namespace cinder
@@ -38,8 +38,12 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 */
 
 #pragma once
+#include "cinder/Cinder.h"
 #include "cinder/CinderMath.h"
 
+#include <vector>
+#include <algorithm>
+
 namespace cinder {
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -668,4 +672,59 @@ struct EaseInOutAtan {
 	float mA, mInv2M;
 };
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lookup
+
+/** \brief Bakes any ease function into a table of samples which is evaluated with linear or cubic interpolation, trading a little accuracy for avoiding pow(), sin() and friends per evaluation.
+	Usable anywhere an EaseFn is, and as a compile-time ease type with Timeline::applyEase(). Copies share the same table. Input is clamped to [0,1].
+	Cubic interpolation is smoother at small sizes but may overshoot slightly around the corners of easeOutBounce and similar. \code EaseLookup ease( EaseOutElastic( 1, 0.3f ), 128 ); \endcode **/
+class EaseLookup {
+  public:
+	enum Interpolation { LINEAR, CUBIC };
+
+	//! Creates a lookup equivalent to easeNone
+	EaseLookup()
+		: mTable( new std::vector<float>( 2 ) ), mSize( 1 ), mInterpolation( LINEAR )
+	{
+		(*mTable)[1] = 1;
+	}
+
+	//! Samples \a easeFunction at \a size + 1 evenly spaced points from 0 through 1
+	template<typename EaseT>
+	EaseLookup( EaseT easeFunction, size_t size = 256, Interpolation interpolation = LINEAR )
+		: mTable( new std::vector<float>( std::max<size_t>( size, 1 ) + 1 ) ), mSize( (float)std::max<size_t>( size, 1 ) ), mInterpolation( interpolation )
+	{
+		const size_t last = mTable->size() - 1;
+		for( size_t i = 0; i < last; ++i )
+			(*mTable)[i] = easeFunction( i / mSize );
+		(*mTable)[last] = easeFunction( 1.0f );
+	}
+
+	float operator()( float t ) const
+	{
+		const float *table = &(*mTable)[0];
+		const size_t last = mTable->size() - 1;
+		const float pos = constrain( t, 0.0f, 1.0f ) * mSize;
+		size_t i = (size_t)pos;
+		if( i >= last )
+			i = last - 1;
+		const float f = pos - i;
+		if( mInterpolation == LINEAR )
+			return table[i] + ( table[i+1] - table[i] ) * f;
+
+		// Catmull-Rom through the neighboring samples, repeating the end samples at the boundaries
+		const float p0 = table[( i > 0 ) ? i - 1 : 0], p1 = table[i], p2 = table[i+1], p3 = table[( i + 2 <= last ) ? i + 2 : last];
+		return p1 + 0.5f * f * ( ( p2 - p0 ) + f * ( ( 2 * p0 - 5 * p1 + 4 * p2 - p3 ) + f * ( 3 * ( p1 - p2 ) + p3 - p0 ) ) );
+	}
+
+	//! Returns the number of intervals in the table, which holds getSize() + 1 samples
+	size_t			getSize() const { return mTable->size() - 1; }
+	Interpolation	getInterpolation() const { return mInterpolation; }
+
+  private:
+	std::shared_ptr<std::vector<float> >	mTable;
+	float									mSize;
+	Interpolation							mInterpolation;
+};
+
 } // namespace cinder
\ No newline at end of file
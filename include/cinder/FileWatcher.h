@@ -0,0 +1,70 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Filesystem.h"
+#include "cinder/Function.h"
+
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+namespace cinder {
+
+/** \brief Calls back when files change on disk, so resources can be reloaded while the app keeps running
+	Each directory containing a watched file is monitored with ReadDirectoryChangesW on MSW and FSEvents on the Mac, and polled elsewhere. A notification only
+	triggers a check of the watched files in that directory, so only files whose modification time or size actually changed are reported. Callbacks are never
+	made asynchronously: update() delivers them, and App calls it once per frame, so they can safely reload OpenGL resources. **/
+class FileWatcher : private boost::noncopyable {
+  public:
+	FileWatcher();
+	~FileWatcher();
+
+	//! Returns the global FileWatcher, which App updates once per frame
+	static FileWatcher&	get();
+
+	//! Calls \a callback with \a path each time the file at \a path is modified, created or replaced. Returns an identifier for unwatch().
+	CallbackId	watch( const fs::path &path, const std::function<void (const fs::path &)> &callback );
+	//! Calls \a callback with the changed path each time any of the files at \a paths is modified, created or replaced. Returns an identifier for unwatch().
+	CallbackId	watch( const std::vector<fs::path> &paths, const std::function<void (const fs::path &)> &callback );
+	//! Stops the callbacks registered by watch() under \a id
+	void		unwatch( CallbackId id );
+
+	//! Delivers the callbacks of watched files which have changed since the last call. Called once per frame by App.
+	void		update();
+
+	//! Sets how often directories are checked when no native change notification is available. Defaults to \c 0.5 seconds.
+	void		setPollInterval( double seconds );
+	//! Returns how often directories are checked when no native change notification is available
+	double		getPollInterval() const;
+
+  private:
+	struct Impl;
+	std::shared_ptr<Impl>	mImpl;
+};
+
+} // namespace cinder
@@ -73,10 +73,19 @@ class Font {
 	Glyph					getGlyphIndex( size_t idx ) const;
 	Glyph					getGlyphChar( char utf8Char ) const;
 	std::vector<Glyph>		getGlyphs( const std::string &utf8String ) const;
-	//! Returns a cinder::Shape2d representing the shape of the glyph at \a glyphIndex
+	//! Returns a cinder::Shape2d representing the shape of the glyph at \a glyphIndex. Outlines are cached by the Font, so only the first request for a glyph goes to the system.
 	Shape2d					getGlyphShape( Glyph glyphIndex ) const;
-	//! Returns the bounding box of a Glyph, relative to the baseline as the origin
+	//! Returns the bounding box of a Glyph, relative to the baseline as the origin. Cached along with the glyph's advance.
 	Rectf					getGlyphBoundingBox( Glyph glyph ) const;
+	//! Returns how far the pen moves after drawing \a glyph. Cached along with the glyph's bounding box.
+	Vec2f					getGlyphAdvance( Glyph glyph ) const;
+	/** Replaces the contents of \a shapes with the outline of each of \a glyphs and, when it's non-NULL, \a advances with their advances.
+		The metrics of every uncached glyph are fetched in a single call to the system. **/
+	void					getGlyphShapes( const std::vector<Glyph> &glyphs, std::vector<Shape2d> *shapes, std::vector<Vec2f> *advances = NULL ) const;
+	//! Returns the glyphs of \a utf8String, as getGlyphs() does, filling \a shapes and \a advances for them as getGlyphShapes() does
+	std::vector<Glyph>		getGlyphShapes( const std::string &utf8String, std::vector<Shape2d> *shapes, std::vector<Vec2f> *advances = NULL ) const;
+	//! Frees the glyph outlines and metrics cached by this Font and any copies of it
+	void					clearGlyphCache();
 	
 	static const std::vector<std::string>&		getNames( bool forceRefresh = false );
 	static Font				getDefault();
@@ -92,6 +101,15 @@ class Font {
 #endif
 
  private:
+	class GlyphCache;
+
+	// the uncached platform implementations
+	Shape2d		calcGlyphShape( Glyph glyph ) const;
+	void		calcGlyphMetrics( const Glyph *glyphs, size_t count, Rectf *boundingBoxes, Vec2f *advances ) const;
+	// these expect the glyph cache's mutex to be held
+	const Shape2d&	cacheGlyphShape( Glyph glyph ) const;
+	void			cacheGlyphMetrics( const Glyph *glyphs, size_t count ) const;
+
 	class Obj {
 	 public:
 		Obj( const std::string &aName, float aSize );
@@ -103,6 +121,7 @@ class Font {
 		
 		std::string				mName;
 		float					mSize;
+		std::shared_ptr<GlyphCache>	mGlyphCache;
 #if defined( CINDER_COCOA )
 		CGFontRef				mCGFont;
 		const struct __CTFont*	mCTFont;
@@ -82,6 +82,24 @@ class Frustum
 		return intersects(box); 
 	};
 
+	/** Tests \a count spheres, given as separate arrays of their centers' coordinates and their radii, for partial containment as intersects() does.
+		Bit \c i % 32 of \a visibility[i / 32] is set when sphere \c i is visible; \a visibility must hold ( \a count + 31 ) / 32 words, which are overwritten. Frustumf tests four spheres at a time with SSE or NEON. **/
+	void intersects( const T *centerX, const T *centerY, const T *centerZ, const T *radius, size_t count, uint32_t *visibility ) const;
+	/** Tests \a count boxes, given as separate arrays of the coordinates of their minimum and maximum corners, for partial containment as intersects() does.
+		The results are written to \a visibility as they are for spheres. Frustumf tests four boxes at a time with SSE or NEON. **/
+	void intersects( const T *minX, const T *minY, const T *minZ, const T *maxX, const T *maxY, const T *maxZ, size_t count, uint32_t *visibility ) const;
+
+	//! The result of classify()
+	enum Visibility { OUTSIDE, INTERSECTS, INSIDE };
+	/** Classifies \a box against the planes whose bits (1 << NEAR, 1 << FAR, etc.) are set in \a planeMask, for hierarchical culling. Bits of planes the box is entirely
+		inside are cleared, so that its children can be classified against the remaining \a planeMask alone. The plane \a *cachedPlane is tested first and receives the plane
+		which rejected an OUTSIDE box, so that keeping one per box across frames usually rejects it with a single test. \a cachedPlane may be NULL. **/
+	Visibility classify( const AxisAlignedBox3f &box, uint8_t *planeMask, uint8_t *cachedPlane = NULL ) const;
+	/** Culls a hierarchy of \a count boxes rooted at \a boxes[0], where box \c i has \a numChildren[i] children starting at \a boxes[firstChild[i]]. Sets the bit of each visible box
+		in \a visibility, laid out as for the batch intersects(). Descendants of a box entirely inside the frustum are marked visible without being tested, and children only test
+		the planes their parent straddles. \a planeCache, when non-NULL, holds one classify() \a cachedPlane per box and should be kept from frame to frame. **/
+	void cullHierarchy( const AxisAlignedBox3f *boxes, const uint32_t *firstChild, const uint32_t *numChildren, size_t count, uint32_t *visibility, uint8_t *planeCache = NULL ) const;
+
   protected:
 	Plane<T>	mFrustumPlanes[6];
 };
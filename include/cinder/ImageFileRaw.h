@@ -0,0 +1,85 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/ImageIo.h"
+#include "cinder/Buffer.h"
+
+namespace cinder {
+
+typedef std::shared_ptr<class ImageSourceFileRaw>	ImageSourceFileRawRef;
+
+/** \brief Loads the headered raw image format written by ImageTargetFileRaw, with the extensions \c csurf (uncompressed) and \c csurfz (zlib compressed).
+	Uncompressed files on disk are memory mapped, so their pixels reach the ImageTarget without an intermediate copy. **/
+class ImageSourceFileRaw : public ImageSource {
+  public:
+	static ImageSourceFileRawRef	createRef( DataSourceRef dataSourceRef, ImageSource::Options options = ImageSource::Options() );
+	static ImageSourceRef			createSourceRef( DataSourceRef dataSourceRef, ImageSource::Options options = ImageSource::Options() ) { return createRef( dataSourceRef, options ); }
+
+	virtual void	load( ImageTargetRef target );
+
+	//! Returns the number of bytes between the rows of the stored image
+	int32_t			getRowBytes() const { return mRowBytes; }
+
+	static void		registerSelf();
+
+  protected:
+	ImageSourceFileRaw( DataSourceRef dataSourceRef, ImageSource::Options options );
+
+	std::shared_ptr<const void>	mMapping;	// non-NULL when mData points into a memory mapped file
+	Buffer						mBuffer;	// otherwise mData points into the DataSource's Buffer or a decompressed copy of it
+	const uint8_t				*mData;
+	int32_t						mRowBytes;
+};
+
+REGISTER_IMAGE_IO_FILE_HANDLER( ImageSourceFileRaw )
+
+/** \brief Writes images in a headered raw format which preserves their channel order, data type and premultiplication. Rows are padded to 16 bytes.
+	Registered for the extensions \c csurf, which is uncompressed, and \c csurfz, which is compressed with zlib at its fastest level. **/
+class ImageTargetFileRaw : public ImageTarget {
+  public:
+	static ImageTargetRef	createRef( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const std::string &extensionData );
+
+	virtual void*	getRowPointer( int32_t row );
+	virtual void	finalize();
+
+	static void		registerSelf();
+
+  protected:
+	ImageTargetFileRaw( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const std::string &extensionData );
+
+	DataTargetRef	mDataTarget;
+	Buffer			mData;
+	int32_t			mRowBytes;
+	bool			mPremultiplied, mCompress;
+};
+
+REGISTER_IMAGE_IO_FILE_HANDLER( ImageTargetFileRaw )
+
+class ImageSourceFileRawException : public ImageIoException {
+};
+
+} // namespace cinder
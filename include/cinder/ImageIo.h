@@ -34,6 +34,10 @@
 
 namespace cinder {
 
+namespace ip {
+	class ChannelShuffle;
+}
+
 typedef std::shared_ptr<class ImageSource>		ImageSourceRef;
 typedef std::shared_ptr<class ImageLoader>		ImageLoaderRef;
 typedef std::shared_ptr<class ImageTarget>		ImageTargetRef;
@@ -87,15 +91,22 @@ class ImageSource : public ImageIo {
 
 	class Options {
 	  public:
-		Options() : mIndex( 0 ) {}
+		Options() : mIndex( 0 ), mTargetSize( 0, 0 ) {}
 
 		//! Specifies an image index for multi-part images, like animated GIFs
 		Options& index( int32_t aIndex ) { mIndex = aIndex; return *this; }
+		/** Hints that the image will be reduced to \a size, allowing codecs which support it, such as JPEG, to decode at a reduced resolution no smaller than \a size.
+			The aspect ratio of the image is preserved, and codecs without reduced decoding load at full resolution. Defaults to (0,0), which always decodes at full resolution. **/
+		Options& targetSize( const Vec2i &size ) { mTargetSize = size; return *this; }
 		
 		int32_t				getIndex() const { return mIndex; }
+		const Vec2i&		getTargetSize() const { return mTargetSize; }
+		//! Returns the smallest size covering getTargetSize() with the aspect ratio of \a fullSize, or \a fullSize if there is no target size or it is not smaller
+		Vec2i				calcReducedSize( const Vec2i &fullSize ) const;
 		
 	  protected:
 		int32_t			mIndex;
+		Vec2i			mTargetSize;
 	};
 
 	//! Returns the aspect ratio of individual pixels to accommodate non-square pixels
@@ -123,10 +134,20 @@ class ImageSource : public ImageIo {
 	template<typename SD>
 	RowFunc		setupRowFuncForSourceType( ImageTargetRef target );
 
+	//! Returns whether the source and target pixels have the same channels at the same offsets, so that rows convert value by value
+	bool		isRowLayoutUnchanged( ColorModel targetColorModel ) const;
+	//! Prepares mRowFuncShuffle for rowFuncShuffle8u() from the offsets found by setupRowFuncRgbSource() or setupRowFuncGraySource()
+	void		setupRowFuncShuffle( ColorModel targetColorModel, bool alpha );
+
 	template<typename SD, typename TD, ImageIo::ColorModel TCM, bool ALPHA>
 	void		rowFuncSourceRgb( ImageTargetRef target, int32_t row, const void *data );
 	template<typename SD, typename TD, ColorModel TCM, bool ALPHA>
 	void		rowFuncSourceGray( ImageTargetRef target, int32_t row, const void *data );
+	//! Converts a row whose layout matches the target's as one run of values, which SIMD handles for \c uint8_t to \c float
+	template<typename SD, typename TD>
+	void		rowFuncSameLayout( ImageTargetRef target, int32_t row, const void *data );
+	//! Rearranges the channels of a \c uint8_t row into a \c uint8_t target with mRowFuncShuffle, which uses SIMD
+	void		rowFuncShuffle8u( ImageTargetRef target, int32_t row, const void *data );
 
 	float						mPixelAspectRatio;
 	bool						mIsPremultiplied;
@@ -136,6 +157,7 @@ class ImageSource : public ImageIo {
 	int8_t						mRowFuncTargetRed, mRowFuncTargetGreen, mRowFuncTargetBlue, mRowFuncTargetAlpha;
 	int8_t						mRowFuncSourceGray, mRowFuncTargetGray;
 	int8_t						mRowFuncSourceInc, mRowFuncTargetInc;
+	std::shared_ptr<ip::ChannelShuffle>	mRowFuncShuffle;
 };
 
 class ImageTarget : public ImageIo {
@@ -181,6 +203,36 @@ void			writeImage( const fs::path &path, const ImageSourceRef &imageSource, Imag
 /** \brief Writes \a imageSource to \a imageTarget. **/
 void			writeImage( ImageTargetRef imageTarget, const ImageSourceRef &imageSource );
 
+typedef std::shared_ptr<class AsyncImageWrite>	AsyncImageWriteRef;
+
+//! The eventual result of writeImageAsync(), analogous to a future
+class AsyncImageWrite {
+  public:
+	//! Returns whether the write has finished, successfully or not
+	bool	isReady() const;
+	//! Returns whether the write has finished unsuccessfully
+	bool	hasFailed() const;
+	//! Blocks until the write has finished
+	void	wait() const;
+
+  private:
+	AsyncImageWrite();
+
+	static void		threadFn( AsyncImageWriteRef result, DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, std::string extension );
+
+	struct Obj;
+	std::shared_ptr<Obj>	mObj;
+
+	friend AsyncImageWriteRef writeImageAsync( DataTargetRef dataTarget, const ImageSourceRef &imageSource, ImageTarget::Options options, std::string extension );
+};
+
+/** \brief Writes \a imageSource to \a dataTarget on a new thread and returns immediately. Optional \a extension parameter allows specification of a file type.
+	\a imageSource is read from the writing thread, so a Surface must not be modified until the write is ready. Pass a clone() of a Surface which will keep changing. **/
+AsyncImageWriteRef	writeImageAsync( DataTargetRef dataTarget, const ImageSourceRef &imageSource, ImageTarget::Options options = ImageTarget::Options(), std::string extension = "" );
+/** \brief Writes \a imageSource to file path \a path on a new thread and returns immediately. Optional \a extension parameter allows specification of a file type.
+	\a imageSource is read from the writing thread, so a Surface must not be modified until the write is ready. Pass a clone() of a Surface which will keep changing. **/
+AsyncImageWriteRef	writeImageAsync( const fs::path &path, const ImageSourceRef &imageSource, ImageTarget::Options options = ImageTarget::Options(), std::string extension = "" );
+
 class ImageIoException : public Exception {
 };
 
@@ -214,6 +266,10 @@ struct ImageIoRegistrar {
 	static void		registerSourceGeneric( SourceCreationFunc func, int32_t priority = 2 );
 	
 	static void		registerTargetType( std::string extension, TargetCreationFunc func, int32_t priority, const std::string &extensionData );
+
+	/** Queues \a registerFn, which registers a handler, to run on the registrar's first use rather than now. Used by REGISTER_IMAGE_IO_FILE_HANDLER(),
+		since some handlers enumerate the system's codecs to register themselves, which would otherwise slow down the launch of apps which never load an image. **/
+	static void		deferRegistration( void (*registerFn)() );
 	
   private:
 	
@@ -243,7 +299,7 @@ struct ImageIoRegistrant {
   private:
 	struct exec_register {
 		exec_register() {
-			T::registerSelf();
+			ImageIoRegistrar::deferRegistration( &T::registerSelf );
 		}
 	};
 	
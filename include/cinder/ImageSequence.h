@@ -0,0 +1,153 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Filesystem.h"
+#include "cinder/JobSystem.h"
+#include "cinder/Surface.h"
+#include "cinder/SurfacePool.h"
+#include "cinder/Thread.h"
+#include "cinder/Timer.h"
+#include "cinder/gl/TextureStreamer.h"
+
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class ImageSequence>	ImageSequenceRef;
+
+/** \brief Plays a sequence of image files at a fixed frame rate, decoding frames ahead of playback on a JobSystem.
+	Frames are decoded into BGRA or BGRX Surfaces drawn from a SurfacePool, and getTexture() streams them into a Texture through a gl::TextureStreamer.
+	Any format loadImage() supports can be used; raw \c .csurf files written by ImageTargetFileRaw are memory mapped and make decoding little more than a copy.
+	update() must be called once per frame. All files are expected to share the first frame's size. **/
+class ImageSequence : private boost::noncopyable {
+  public:
+	//! Determines what happens when the next frame hasn't been decoded by the time it's due
+	enum LatePolicy {
+		//! Keeps to the clock, skipping frames which weren't decoded in time
+		LATE_DROP,
+		//! Shows every frame, holding the current one and delaying the clock until the next is ready
+		LATE_HOLD
+	};
+
+	//! Creates an ImageSequence of the files \a paths, played at \a framesPerSecond with up to \a numPrefetchFrames decoded ahead on \a jobSystem
+	static ImageSequenceRef	create( const std::vector<fs::path> &paths, float framesPerSecond = 30, int32_t numPrefetchFrames = 8, const JobSystemRef &jobSystem = JobSystem::getDefault() )
+	{ return ImageSequenceRef( new ImageSequence( paths, framesPerSecond, numPrefetchFrames, jobSystem ) ); }
+	//! Creates an ImageSequence of the files in \a directory, ordered by name. Files beginning with \c '.' are ignored.
+	static ImageSequenceRef	create( const fs::path &directory, float framesPerSecond = 30, int32_t numPrefetchFrames = 8, const JobSystemRef &jobSystem = JobSystem::getDefault() );
+
+	//! Waits for any frames still being decoded
+	~ImageSequence();
+
+	//! Presents the frame due at the current time. Returns \c true if it differs from the previous frame.
+	bool		update();
+
+	//! Returns the current frame, or a null Surface if it hasn't been decoded yet
+	Surface8u	getSurface() const { return mSurface; }
+	//! Returns the current frame as a Texture, streaming it through a gl::TextureStreamer if it has changed since the last call. Must be called from the thread which owns the OpenGL context.
+	gl::Texture	getTexture();
+
+	//! Starts playback from the current frame
+	void		play();
+	//! Pauses playback on the current frame
+	void		stop();
+	//! Returns whether the sequence is playing
+	bool		isPlaying() const { return ! mTimer.isStopped(); }
+	//! Makes \a frame the current frame, which is shown once it has been decoded
+	void		seekToFrame( int32_t frame );
+
+	//! Returns the index of the current frame
+	int32_t		getCurrentFrame() const;
+	//! Returns the number of files in the sequence
+	int32_t		getNumFrames() const { return (int32_t)mPaths.size(); }
+	//! Returns the path of frame \a frame
+	const fs::path&	getPath( int32_t frame ) const { return mPaths[frame]; }
+
+	//! Returns the playback rate in frames per second
+	float		getFramesPerSecond() const { return mFramesPerSecond; }
+	//! Sets the playback rate in frames per second
+	void		setFramesPerSecond( float framesPerSecond );
+	//! Returns whether playback wraps back to the first frame. Defaults to \c true.
+	bool		isLoop() const { return mLoop; }
+	//! Sets whether playback wraps back to the first frame rather than stopping on the last
+	void		setLoop( bool loop = true ) { mLoop = loop; }
+	//! Returns the policy for frames which are decoded late. Defaults to \c LATE_DROP.
+	LatePolicy	getLatePolicy() const { return mLatePolicy; }
+	//! Sets the policy for frames which are decoded late
+	void		setLatePolicy( LatePolicy policy ) { mLatePolicy = policy; }
+
+	//! Returns the number of frames which were skipped under \c LATE_DROP
+	uint32_t	getNumDroppedFrames() const { return mNumDroppedFrames; }
+	//! Returns the number of times playback was held waiting on a frame under \c LATE_HOLD
+	uint32_t	getNumHeldFrames() const { return mNumHeldFrames; }
+
+  private:
+	ImageSequence( const std::vector<fs::path> &paths, float framesPerSecond, int32_t numPrefetchFrames, const JobSystemRef &jobSystem );
+
+	// a decoded frame or one being decoded, keyed by its position; positions keep counting across loops
+	struct Slot {
+		Slot() : mPosition( -1 ), mReady( false ) {}
+
+		int64_t				mPosition;
+		bool				mReady;
+		Surface8u			mSurface;
+		JobSystem::JobRef	mJob;
+	};
+
+	void		decode( Slot *slot, int64_t position );
+	void		prefetch();
+	int64_t		getClockPosition() const;
+	int32_t		positionToFrame( int64_t position ) const;
+	int64_t		getLastPosition() const;
+	void		waitForJobs();
+
+	std::vector<fs::path>	mPaths;
+	JobSystemRef			mJobSystem;
+	SurfacePoolRef			mSurfacePool;
+	std::vector<Slot>		mSlots;
+	std::mutex				mMutex;
+
+	float					mFramesPerSecond;
+	bool					mLoop;
+	LatePolicy				mLatePolicy;
+	Timer					mTimer;
+	int64_t					mClockStart;	// the position at which mTimer was started
+	int64_t					mPosition;		// the position of mSurface, or of the frame awaited after a seek
+	bool					mPresented;
+	int64_t					mHeldPosition;	// the position playback is being held for under LATE_HOLD
+
+	Surface8u				mSurface;
+	bool					mTextureDirty;
+	gl::TextureStreamer		mStreamer;
+	uint32_t				mNumDroppedFrames, mNumHeldFrames;
+};
+
+class ImageSequenceException : public Exception {
+};
+
+} // namespace cinder
@@ -24,8 +24,12 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/ImageIo.h"
+#include "cinder/Buffer.h"
 #include "cinder/Exception.h"
 
+#include <vector>
+#include <utility>
+
 struct png_struct_def;
 struct png_info_struct;
 
@@ -35,6 +39,9 @@ struct ci_png_info;
 
 typedef std::shared_ptr<class ImageSourcePng>	ImageSourcePngRef;
 
+/** \brief Loads PNG images.
+	Files are memory mapped. Non-interlaced 8 and 16 bit gray, gray+alpha, RGB and RGBA images without transparency chunks are inflated and unfiltered directly, using SSE2 or NEON where available.
+	Anything else is decoded by libpng, which reads straight from the mapping. **/
 class ImageSourcePng : public ImageSource {
   public:
 	static ImageSourcePngRef	createRef( DataSourceRef dataSourceRef, ImageSource::Options options = ImageSource::Options() );
@@ -48,10 +55,20 @@ class ImageSourcePng : public ImageSource {
   protected:
 	ImageSourcePng( DataSourceRef dataSourceRef, ImageSource::Options options );
 	bool loadHeader();
+	bool loadHeaderDirect();
+	void loadDirect( ImageTargetRef target );
 	
 	std::shared_ptr<ci_png_info>	mCiInfoPtr;
 	png_struct_def					*mPngPtr;
 	png_info_struct					*mInfoPtr;
+
+	std::shared_ptr<const void>		mMapping;	// the memory mapped file, if the DataSource is one
+	Buffer							mBuffer;	// otherwise the DataSource's Buffer, unless it is a Url
+	const uint8_t					*mFileData;
+	size_t							mFileSize;
+	bool							mDirect;	// whether load() bypasses libpng
+	int8_t							mPixelBytes;
+	std::vector<std::pair<size_t,size_t> >	mIdatChunks;	// offset and size of each IDAT chunk's data in mFileData
 };
 
 REGISTER_IMAGE_IO_FILE_HANDLER( ImageSourcePng )
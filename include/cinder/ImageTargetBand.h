@@ -0,0 +1,107 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/ImageIo.h"
+#include "cinder/Surface.h"
+#include "cinder/Function.h"
+
+#include <vector>
+
+namespace cinder {
+
+/** \brief ImageTarget which collects an ImageSource's rows into a band of \a bandHeight rows and passes each completed band to a callback.
+	Only a single band is held in memory, regardless of the size of the image. Rows must arrive in ascending order, as they do from all of Cinder's ImageSources.
+	The final partial band is passed on by finalize(), which must be called after ImageSource::load(), as writeImage() does. **/
+template<typename T>
+class ImageTargetBandT : public ImageTarget {
+  public:
+	//! Callback receiving the rows of a band, valid only for the duration of the call, and the index of the band's first row in the image
+	typedef std::function<void(const SurfaceT<T>&,int32_t)>	BandFn;
+
+	//! Creates a target for \a imageSource which passes bands of \a bandHeight rows to \a bandFn
+	static std::shared_ptr<ImageTargetBandT<T> >	create( ImageSourceRef imageSource, int32_t bandHeight, const BandFn &bandFn ) { return std::shared_ptr<ImageTargetBandT<T> >( new ImageTargetBandT<T>( imageSource, bandHeight, bandFn ) ); }
+
+	virtual bool	hasAlpha() const { return mBand.hasAlpha(); }
+	virtual void*	getRowPointer( int32_t row );
+	//! Passes the rows received since the last completed band to the callback
+	virtual void	finalize();
+
+  protected:
+	ImageTargetBandT( ImageSourceRef imageSource, int32_t bandHeight, const BandFn &bandFn );
+
+	void		flush();
+
+	SurfaceT<T>		mBand;
+	BandFn			mBandFn;
+	int32_t			mBandStart, mRowsFilled;
+};
+
+typedef ImageTargetBandT<uint8_t>					ImageTargetBand8u;
+typedef std::shared_ptr<ImageTargetBand8u>			ImageTargetBand8uRef;
+typedef ImageTargetBandT<float>						ImageTargetBand32f;
+typedef std::shared_ptr<ImageTargetBand32f>			ImageTargetBand32fRef;
+
+/** \brief ImageTarget which resizes an ImageSource to a Surface of a fixed size as its rows arrive, by averaging the area each destination pixel covers.
+	Besides the result only a single source row is held in memory, making it suitable for loading reduced versions of very large images.
+	For example <tt>Surface8u thumbnail = ImageTargetResize8u::load( loadImage( path ), Vec2i( 1024, 512 ) );</tt> **/
+template<typename T>
+class ImageTargetResizeT : public ImageTarget {
+  public:
+	//! Creates a target which resizes \a imageSource to \a size. The result is complete once ImageSource::load() and finalize() have been called.
+	static std::shared_ptr<ImageTargetResizeT<T> >	create( ImageSourceRef imageSource, const Vec2i &size ) { return std::shared_ptr<ImageTargetResizeT<T> >( new ImageTargetResizeT<T>( imageSource, size ) ); }
+	//! Loads \a imageSource resized to \a size
+	static SurfaceT<T>	load( ImageSourceRef imageSource, const Vec2i &size );
+
+	virtual bool	hasAlpha() const { return mResult.hasAlpha(); }
+	virtual void*	getRowPointer( int32_t row );
+	//! Accumulates the final source row into the result
+	virtual void	finalize();
+
+	//! Returns the resized Surface
+	const SurfaceT<T>&	getSurface() const { return mResult; }
+
+  protected:
+	ImageTargetResizeT( ImageSourceRef imageSource, const Vec2i &size );
+
+	void		accumulateRow( int32_t row );
+
+	SurfaceT<T>				mResult;
+	int32_t					mSrcWidth, mSrcHeight, mPixelInc;
+	std::vector<T>			mSrcRow;
+	int32_t					mPendingRow;
+	// per destination column, the range of mColumnWeights holding its (source column, weight) pairs
+	std::vector<std::pair<int32_t,float> >	mColumnWeights;
+	std::vector<size_t>						mColumnStarts;
+	std::vector<float>						mHorizontal, mAccum;
+};
+
+typedef ImageTargetResizeT<uint8_t>					ImageTargetResize8u;
+typedef std::shared_ptr<ImageTargetResize8u>		ImageTargetResize8uRef;
+typedef ImageTargetResizeT<float>					ImageTargetResize32f;
+typedef std::shared_ptr<ImageTargetResize32f>		ImageTargetResize32fRef;
+
+} // namespace cinder
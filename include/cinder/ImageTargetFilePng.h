@@ -0,0 +1,57 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/ImageIo.h"
+#include "cinder/Buffer.h"
+
+namespace cinder {
+
+/** \brief Writes PNG files, filtering and deflating bands of rows concurrently on the default ip::ExecutionContext.
+	Each band is deflated as its own segment, primed with the preceding 32k of filtered data, and the segments are stitched into a single zlib stream.
+	Registered for the extension \c png ahead of the platform's writers. 8 and 16 bit gray, gray+alpha, RGB and RGBA are written; float sources are written as 16 bit. **/
+class ImageTargetFilePng : public ImageTarget {
+  public:
+	static ImageTargetRef	createRef( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const std::string &extensionData );
+
+	virtual void*	getRowPointer( int32_t row );
+	virtual void	finalize();
+
+	static void		registerSelf();
+
+  protected:
+	ImageTargetFilePng( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const std::string &extensionData );
+
+	DataTargetRef	mDataTarget;
+	Buffer			mData;
+	int32_t			mRowBytes;
+	int8_t			mPixelBytes;
+	bool			mPremultiplied;
+};
+
+REGISTER_IMAGE_IO_FILE_HANDLER( ImageTargetFilePng )
+
+} // namespace cinder
@@ -0,0 +1,107 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Area.h"
+#include "cinder/Function.h"
+#include "cinder/Thread.h"
+
+#include <boost/noncopyable.hpp>
+#include <deque>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class JobSystem>	JobSystemRef;
+
+/** \brief Work-stealing scheduler which runs jobs on a shared pool of worker threads.
+	Each worker has its own queue, running its most recently added job first and stealing the oldest jobs of other queues when its own is empty. Jobs added
+	by a job go to its worker's queue, so nested parallelism stays on one thread unless others are idle. A thread which waits on a job runs other jobs in the
+	meantime, so jobs may safely wait on jobs of their own. Jobs must not throw. The default JobSystem also drives ip::ExecutionContext::getDefault(). **/
+class JobSystem : private boost::noncopyable {
+  public:
+	class Job;
+	//! Handle to a job added to a JobSystem
+	typedef std::shared_ptr<Job>	JobRef;
+
+	//! Creates a JobSystem which uses \a numThreads threads, including a thread which waits on its jobs. A value of \c 0 uses System::getNumCores()
+	static JobSystemRef	create( int32_t numThreads = 0 ) { return JobSystemRef( new JobSystem( numThreads ) ); }
+	//! Returns a shared JobSystem sized to System::getNumCores(), created upon first use
+	static JobSystemRef	getDefault();
+
+	//! Stops the worker threads. Jobs which haven't started are abandoned, so all jobs should be waited on first.
+	~JobSystem();
+
+	//! Returns the number of threads which run jobs, including a thread waiting on them
+	int32_t		getNumThreads() const { return (int32_t)mThreads.size() + 1; }
+
+	//! Adds a job which calls \a fn
+	JobRef		add( const std::function<void()> &fn );
+	//! Adds a job which calls \a fn once \a dependency has finished
+	JobRef		add( const std::function<void()> &fn, const JobRef &dependency );
+	//! Adds a job which calls \a fn once all of \a dependencies have finished
+	JobRef		add( const std::function<void()> &fn, const std::vector<JobRef> &dependencies );
+
+	//! Returns whether \a job has finished
+	bool		isFinished( const JobRef &job );
+	//! Runs other jobs until \a job has finished
+	void		wait( const JobRef &job );
+	//! Runs other jobs until all of \a jobs have finished
+	void		wait( const std::vector<JobRef> &jobs );
+
+	/** Splits [\a begin, \a end) into chunks of at least \a grainSize values and calls \a rangeFn with the bounds of each, blocking until all have completed.
+		The calling thread processes chunks too. \a rangeFn must be safe to call concurrently. **/
+	void		parallelFor( int32_t begin, int32_t end, const std::function<void(int32_t,int32_t)> &rangeFn, int32_t grainSize = 1 );
+	/** Splits \a area into at most getNumThreads() horizontal bands of at least \a minRowsPerBand rows and calls \a bandFn with each, blocking until all have completed.
+		The calling thread processes bands too. \a bandFn must be safe to call concurrently. **/
+	void		parallelFor( const Area &area, const std::function<void(const Area&)> &bandFn, int32_t minRowsPerBand = 16 );
+
+  private:
+	JobSystem( int32_t numThreads );
+
+	struct Queue {
+		std::mutex			mMutex;
+		std::deque<JobRef>	mJobs;
+	};
+
+	//! Returns the index of the calling thread's queue, which is the shared queue for threads other than this JobSystem's workers
+	size_t		getQueueIndex() const;
+	void		schedule( const JobRef &job );
+	void		release( const JobRef &job );
+	bool		runNextJob( size_t queueIndex );
+	void		threadFn( size_t queueIndex );
+
+	std::vector<std::shared_ptr<Queue> >		mQueues; // one per worker followed by the shared queue
+	std::vector<std::shared_ptr<std::thread> >	mThreads;
+	std::mutex									mMutex;
+	std::condition_variable						mWorkCond, mWaitCond;
+	size_t										mNumQueued;
+	int32_t										mNumSleeping, mNumWaiting;
+	bool										mQuit;
+};
+
+} // namespace cinder
@@ -0,0 +1,212 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/DataSource.h"
+#include "cinder/Json.h"
+#include "cinder/StringRef.h"
+
+#include <iterator>
+#include <string>
+
+namespace cinder {
+
+/** \brief A lightweight, read-only alternative to JsonTree.
+	JsonTree parses through JsonCpp into a Json::Value and then copies that into its own tree. JsonView parses in a single pass into nodes allocated
+	in large blocks, decoding strings in place in one copy of the input, and returns keys and values as StringRefs into that copy. Numbers are parsed
+	once while reading. A JsonView is a cheap handle to one node of a shared document, so it can be copied and returned by value.
+	The document is freed along with its last JsonView, which StringRefs must not outlive. **/
+class JsonView {
+  public:
+	class ConstIter;
+
+	typedef enum { NODE_NULL, NODE_BOOL, NODE_NUMBER, NODE_STRING, NODE_ARRAY, NODE_OBJECT } NodeType;
+
+	//! Creates an empty view which refers to no node
+	JsonView() : mNode( 0 ) {}
+	//! Parses the JSON contained in \a dataSource and returns a view of its root value. Throws JsonTree::ExcJsonParserError unless \a parseOptions ignores errors, in which case the result is null.
+	explicit JsonView( DataSourceRef dataSource, JsonTree::ParseOptions parseOptions = JsonTree::ParseOptions() );
+	//! Parses the JSON contained in \a jsonString and returns a view of its root value. Throws JsonTree::ExcJsonParserError unless \a parseOptions ignores errors, in which case the result is null.
+	explicit JsonView( const std::string &jsonString, JsonTree::ParseOptions parseOptions = JsonTree::ParseOptions() );
+
+	//! Returns the type of this node
+	NodeType			getNodeType() const;
+	bool				isNull() const { return getNodeType() == NODE_NULL; }
+	bool				isBool() const { return getNodeType() == NODE_BOOL; }
+	bool				isNumber() const { return getNodeType() == NODE_NUMBER; }
+	bool				isString() const { return getNodeType() == NODE_STRING; }
+	bool				isArray() const { return getNodeType() == NODE_ARRAY; }
+	bool				isObject() const { return getNodeType() == NODE_OBJECT; }
+
+	//! Returns the node's key, which is empty for array elements and the root
+	StringRef			getKey() const;
+	//! Returns the node's value as text: a string's decoded contents, a number as written, \c "true" or \c "false", or an empty string for null, arrays and objects.
+	StringRef			getValue() const;
+	/** \brief Returns the value of the node cast to T. Numbers and booleans are converted from their parsed values without going through text.
+		Throws ExcNonConvertible if the value can't be converted.
+		<br><tt>float value = myNode["key"].getValue<float>();</tt> **/
+	template<typename T>
+	T					getValue() const;
+
+	//! Returns the number of children of an array or object
+	size_t				getNumChildren() const;
+	//! Returns whether this node has children
+	bool				hasChildren() const { return getNumChildren() > 0; }
+	/**! Returns the child at \a relativePath, using the same syntax as JsonTree. Throws ExcChildNotFound if none matches.
+		<br><tt>JsonView node = myNode.getChild( "path.to.child" );</tt> **/
+	JsonView			getChild( const std::string &relativePath, bool caseSensitive = false, char separator = '.' ) const;
+	//! Returns the child at \a index. Throws ExcChildNotFound if none matches.
+	JsonView			getChild( size_t index ) const;
+	//! Returns whether the child at \a relativePath exists.
+	bool				hasChild( const std::string &relativePath, bool caseSensitive = false, char separator = '.' ) const { return getNodePtr( relativePath, caseSensitive, separator ) != 0; }
+	//! Returns the child at \a relativePath. Throws ExcChildNotFound if none matches.
+	JsonView			operator[]( const std::string &relativePath ) const { return getChild( relativePath ); }
+	//! Returns the child at \a index. Throws ExcChildNotFound if none matches.
+	JsonView			operator[]( size_t index ) const { return getChild( index ); }
+
+	//! Returns whether this node has a parent node.
+	bool				hasParent() const;
+	//! Returns the node which is the parent of this node.
+	JsonView			getParent() const;
+	/**! Returns a path to this node, separated by the character \a separator. **/
+	std::string			getPath( char separator = '.' ) const;
+
+	//! Returns a ConstIter to the first child of this node.
+	ConstIter			begin() const;
+	//! Returns a ConstIter which marks the end of the children of this node.
+	ConstIter			end() const;
+
+	//! Returns a deep copy of this node as a JsonTree, for example to modify or write part of a large document. Unlike parsing into a JsonTree, object members keep their order.
+	JsonTree			toJsonTree() const;
+
+	//! Exception expressing the absence of an expected child node.
+	class ExcChildNotFound : public JsonTree::Exception {
+	  public:
+		ExcChildNotFound( const JsonView &node, const std::string &key ) throw();
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[2048];
+	};
+
+	//! Exception expressing the inability to convert a node's value to a requested type.
+	class ExcNonConvertible : public JsonTree::Exception {
+	  public:
+		ExcNonConvertible( const JsonView &node ) throw();
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[2048];
+	};
+
+	//! \cond
+	struct Node;
+	struct Document;
+	//! \endcond
+
+	//! Emulates shared_ptr-like behavior
+	typedef Node* JsonView::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mNode == 0 ) ? 0 : &JsonView::mNode; }
+
+  private:
+	JsonView( const std::shared_ptr<Document> &document, Node *node ) : mDocument( document ), mNode( node ) {}
+
+	void						parse( const char *text, size_t size, const JsonTree::ParseOptions &parseOptions );
+	Node*						getNodePtr( const std::string &relativePath, bool caseSensitive, char separator ) const;
+
+	std::shared_ptr<Document>	mDocument;
+	Node						*mNode;
+
+	friend class ConstIter;
+};
+
+//! A const iterator over the children of a JsonView.
+class JsonView::ConstIter {
+  public:
+	//! \cond
+	ConstIter() {}
+	ConstIter( const JsonView &current ) : mCurrent( current ) {}
+	//! \endcond
+
+	//! Returns the JsonView the iterator currently points to.
+	const JsonView&		operator*() const { return mCurrent; }
+	//! Returns a pointer to the JsonView the iterator currently points to.
+	const JsonView*		operator->() const { return &mCurrent; }
+
+	//! Increments the iterator to the next child.
+	ConstIter& operator++();
+	//! Increments the iterator to the next child.
+	const ConstIter operator++(int) {
+		ConstIter prev( *this );
+		++(*this);
+		return prev;
+	}
+
+	bool operator!=( const ConstIter &rhs ) const { return mCurrent.mNode != rhs.mCurrent.mNode; }
+	bool operator==( const ConstIter &rhs ) const { return mCurrent.mNode == rhs.mCurrent.mNode; }
+
+  private:
+	JsonView	mCurrent;
+};
+
+template<typename T>
+T JsonView::getValue() const
+{
+	try {
+		return getValue().as<T>();
+	}
+	catch( boost::bad_lexical_cast & ) {
+		throw ExcNonConvertible( *this );
+	}
+}
+
+//! \cond
+template<> bool			JsonView::getValue<bool>() const;
+template<> float		JsonView::getValue<float>() const;
+template<> double		JsonView::getValue<double>() const;
+template<> int32_t		JsonView::getValue<int32_t>() const;
+template<> uint32_t		JsonView::getValue<uint32_t>() const;
+template<> int64_t		JsonView::getValue<int64_t>() const;
+template<> uint64_t		JsonView::getValue<uint64_t>() const;
+//! \endcond
+
+} // namespace cinder
+
+namespace std {
+
+//! \cond
+template<>
+struct iterator_traits<cinder::JsonView::ConstIter> {
+	typedef cinder::JsonView		value_type;
+	typedef ptrdiff_t				difference_type;
+	typedef forward_iterator_tag	iterator_category;
+	typedef const cinder::JsonView*	pointer;
+	typedef const cinder::JsonView&	reference;
+};
+//! \endcond
+
+} // namespace std
@@ -0,0 +1,144 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/DataTarget.h"
+#include "cinder/Exception.h"
+#include "cinder/Filesystem.h"
+#include "cinder/Stream.h"
+
+#include <boost/noncopyable.hpp>
+#include <string>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class JsonWriter>	JsonWriterRef;
+
+/** \brief Writes JSON directly to an OStream as values are added, without building a tree.
+	Output is collected in a small buffer which is written to the stream whenever it fills and on flush(), so memory use doesn't grow with the document.
+	Containers are opened and closed explicitly and object members are written as a key() followed by a value:
+	<br><tt>JsonWriter json( writeFile( "out.json" ) );
+	<br>json.beginObject().key( "name" ).value( "Bob" ).key( "scores" ).beginArray().value( 3 ).value( 4.5 ).endArray().endObject();</tt>
+	<br>Any containers still open are closed by close() or the destructor. appendToArray() adds elements to an array stored in a file from a previous run. **/
+class JsonWriter : private boost::noncopyable {
+  public:
+	//! Creates a writer to \a stream. If \a indent the output is formatted like JsonTree's indented output.
+	explicit JsonWriter( OStreamRef stream, bool indent = false );
+	//! Creates a writer to the stream of \a target. If \a indent the output is formatted like JsonTree's indented output.
+	explicit JsonWriter( DataTargetRef target, bool indent = false );
+	//! Closes any open containers and flushes the output
+	~JsonWriter();
+
+	/** Returns a writer which appends elements to the JSON array in the file at \a path, creating the file if it doesn't exist or is empty.
+		The existing contents are not parsed; only the end of the file is read to find the closing bracket.
+		After each flush() the file holds a complete array, so a process which exits without closing the writer loses at most the unflushed elements.
+		Throws ExcInvalidFile if the file doesn't end with an array. **/
+	static JsonWriterRef	appendToArray( const fs::path &path, bool indent = false );
+
+	//! Opens an object, as the next value
+	JsonWriter&		beginObject();
+	//! Closes the innermost open object
+	JsonWriter&		endObject();
+	//! Opens an array, as the next value
+	JsonWriter&		beginArray();
+	//! Closes the innermost open array
+	JsonWriter&		endArray();
+	//! Writes the key of the next member of the innermost open object
+	JsonWriter&		key( const std::string &key );
+
+	JsonWriter&		value( bool value );
+	JsonWriter&		value( int32_t value );
+	JsonWriter&		value( uint32_t value );
+	JsonWriter&		value( int64_t value );
+	JsonWriter&		value( uint64_t value );
+	//! Writes \a value with enough digits to read back the same double. Infinities and NaN, which JSON can't represent, are written as \c null.
+	JsonWriter&		value( double value );
+	JsonWriter&		value( float value ) { return this->value( (double)value ); }
+	JsonWriter&		value( const std::string &value );
+	JsonWriter&		value( const char *value );
+	//! Writes a \c null value
+	JsonWriter&		null();
+	//! Writes \a json, which must be a complete JSON value, as the next value without checking it
+	JsonWriter&		rawValue( const std::string &json );
+
+	//! Writes the buffered output to the stream
+	void			flush();
+	//! Closes any open containers and flushes the output. Nothing more can be written afterwards.
+	void			close();
+
+	//! Returns the number of containers currently open
+	size_t			getDepth() const { return mStack.size(); }
+
+	//! Exception thrown when a call doesn't fit the structure written so far, like a value in an object without a key
+	class ExcInvalidState : public cinder::Exception {
+	  public:
+		ExcInvalidState( const char *description ) throw();
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[2048];
+	};
+
+	//! Exception thrown by appendToArray() when the file can't be opened or doesn't hold an array
+	class ExcInvalidFile : public cinder::Exception {
+	  public:
+		ExcInvalidFile( const fs::path &path ) throw();
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[2048];
+	};
+
+  private:
+	struct Container {
+		Container( bool isObject, bool hasElements ) : mIsObject( isObject ), mHasElements( hasElements ) {}
+
+		bool	mIsObject, mHasElements;
+	};
+
+	void		init( bool indent );
+	void		beginValue();
+	void		endContainer( bool isObject );
+	void		writeNewLine();
+	void		writeString( const char *s, size_t length );
+	void		append( const char *s, size_t length ) { mBuffer.append( s, length ); if( mBuffer.size() >= FLUSH_SIZE ) writeBuffer(); }
+	void		append( char c ) { mBuffer.push_back( c ); }
+	void		writeBuffer();
+
+	static const size_t		FLUSH_SIZE = 16384;
+
+	OStreamRef				mStream;
+	std::string				mBuffer;
+	std::vector<Container>	mStack;
+	bool					mIndent, mAfterKey, mWroteRoot, mClosed;
+	bool					mAppending;	// when set, the closing bracket is written after each flush and overwritten by what follows
+	off_t					mAppendEnd;	// the size of the file being appended to, which is padded with spaces so nothing of it is left past the end
+};
+
+} // namespace cinder
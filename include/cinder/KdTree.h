@@ -24,6 +24,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Vector.h"
+#include "cinder/ip/ExecutionContext.h"
 
 #include <vector>
 #include <float.h>
@@ -34,6 +35,7 @@
 namespace cinder {
 
 // KdTree Declarations
+//! A node of a KdTree. Nodes are stored depth-first in one contiguous array, with the point's coordinates inline
 template<unsigned char K>
 struct KdNode {
 	void init( float p, uint32_t a) {
@@ -52,39 +54,69 @@ struct KdNode {
 	uint32_t splitAxis:2;
 	uint32_t hasLeftChild:1;
 	uint32_t rightChild:29;
+	float pos[K];
+	uint32_t index;
 };
 
 struct NullLookupProc {
  public:
-	void process( uint32_t id, float distSqrd, float &maxDistSqrd ) {}
+	void process( uint32_t id, float distSqrd, float &maxDistSqrd ) const {}
 };
 
+/** \brief Balanced kd-tree over 2D or 3D points, for nearest, k-nearest and radius queries.
+ *  The tree copies the points' coordinates into its nodes, so the source data need not outlive it. Indices returned by
+ *  the queries refer to positions in the container the tree was built from. **/
 template <typename NodeData, unsigned char K=3, class LookupProc = NullLookupProc> class KdTree {
 public:
-	typedef std::pair<const NodeData*, uint32_t> NodeDataIndex;
-	
 	// KdTree Public Methods
+	//! Builds the tree from \a data. Large point sets are built on the threads of \a context when one is supplied
 	template<typename NodeDataVector>
-	KdTree( const NodeDataVector &data );
-	KdTree() {}
+	KdTree( const NodeDataVector &data, const ip::ExecutionContextRef &context = ip::ExecutionContextRef() );
+	KdTree() : nNodes( 0 ) {}
 	template<typename NodeDataVector>
-	void initialize( const NodeDataVector &d );
-	~KdTree() {
-		free( nodes );
-		delete[] mNodeData;
-	}
-	void recursiveBuild( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes );
+	void initialize( const NodeDataVector &d, const ip::ExecutionContextRef &context = ip::ExecutionContextRef() );
+
+	//! Returns the number of points in the tree
+	uint32_t	getSize() const { return nNodes; }
+
 	void lookup( const NodeData &p, const LookupProc &process, float maxDist ) const;
-	void findNearest( float p[K], float result[K], uint32_t *resultIndex ) const;
-	
+	void findNearest( const float p[K], float result[K], uint32_t *resultIndex ) const;
+	/** Replaces the contents of \a resultIndices with the indices of the \a k points nearest to \a p, nearest first. Fewer are returned when the tree holds fewer than \a k points.
+	 *  When \a resultDistancesSquared is non-NULL it receives the matching squared distances. **/
+	void findKNearest( const float p[K], uint32_t k, std::vector<uint32_t> *resultIndices, std::vector<float> *resultDistancesSquared = NULL ) const;
+	/** Replaces the contents of \a resultIndices with the indices of every point closer to \a p than \a radius, in no particular order.
+	 *  When \a resultDistancesSquared is non-NULL it receives the matching squared distances. **/
+	void findInRadius( const float p[K], float radius, std::vector<uint32_t> *resultIndices, std::vector<float> *resultDistancesSquared = NULL ) const;
+
 private:
+	// a point being sorted into the tree, and a subtree whose build has been deferred to a worker thread
+	struct BuildPoint {
+		float		pos[K];
+		uint32_t	index;
+	};
+	struct BuildCompare {
+		BuildCompare( int a ) : axis( a ) {}
+		bool operator()( const BuildPoint &d1, const BuildPoint &d2 ) const {
+			return ( d1.pos[axis] == d2.pos[axis] ) ? ( d1.index < d2.index ) : ( d1.pos[axis] < d2.pos[axis] );
+		}
+		int axis;
+	};
+	struct BuildTask {
+		uint32_t	nodeNum, start, end;
+	};
+	typedef std::pair<float,uint32_t>	DistanceIndex;
+
 	// KdTree Private Methods
-	void privateLookup(uint32_t nodeNum, float p[K], const LookupProc &process, float &maxDistSquared) const;
-	void privateFindNearest( uint32_t nodeNum, float p[K], float &maxDistSquared, float result[K], uint32_t *resultIndex ) const;
+	void recursiveBuild( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<BuildPoint> &buildNodes, std::vector<BuildTask> *deferred, uint32_t maxDeferredSize );
+	void buildBand( std::vector<BuildPoint> *buildNodes, const std::vector<BuildTask> *tasks, const Area &band );
+	float distanceSquared( const KdNode<K> &node, const float p[K] ) const;
+	void privateLookup(uint32_t nodeNum, const float p[K], const LookupProc &process, float &maxDistSquared) const;
+	void privateFindNearest( uint32_t nodeNum, const float p[K], float &maxDistSquared, float result[K], uint32_t *resultIndex ) const;
+	void privateFindKNearest( uint32_t nodeNum, const float p[K], uint32_t k, std::vector<DistanceIndex> &heap, float &maxDistSquared ) const;
+	void privateFindInRadius( uint32_t nodeNum, const float p[K], float maxDistSquared, std::vector<uint32_t> *resultIndices, std::vector<float> *resultDistancesSquared ) const;
 	// KdTree Private Data
-	KdNode<K> *nodes;
-	NodeDataIndex *mNodeData;
-	uint32_t nNodes, nextFreeNode;
+	std::vector<KdNode<K> >	mNodes;
+	uint32_t nNodes;
 };
 
 
@@ -132,47 +164,66 @@ struct NodeDataTraits<Vec2f>
 	}
 };
 
-template<typename NodeData> struct CompareNode {
-	CompareNode( int a ) { axis = a; }
-	int axis;
-	bool operator()(const std::pair<const NodeData*,uint32_t> &d1,
-			const std::pair<const NodeData*,uint32_t> &d2) const {
-		return NodeDataTraits<NodeData>::getAxis( *d1.first, axis ) == NodeDataTraits<NodeData>::getAxis( *d2.first, axis ) ? ( d1.first < d2.first ) :
-			NodeDataTraits<NodeData>::getAxis( *d1.first, axis ) < NodeDataTraits<NodeData>::getAxis( *d2.first, axis );
-	}
-};
+// point sets smaller than this are always built on the calling thread
+const uint32_t KDTREE_MIN_PARALLEL_BUILD = 65536;
 
 // KdTree Method Definitions
 template<typename NodeData, unsigned char K, typename LookupProc>
  template<typename NodeDataVector>
-KdTree<NodeData, K, LookupProc>::KdTree(const NodeDataVector &d)
+KdTree<NodeData, K, LookupProc>::KdTree( const NodeDataVector &d, const ip::ExecutionContextRef &context )
 {
-	initialize( d );
+	initialize( d, context );
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
  template<typename NodeDataVector>
-void KdTree<NodeData, K, LookupProc>::initialize( const NodeDataVector &d )
+void KdTree<NodeData, K, LookupProc>::initialize( const NodeDataVector &d, const ip::ExecutionContextRef &context )
 {
 	nNodes = NodeDataVectorTraits<NodeDataVector>::getSize( d );
-	nextFreeNode = 1;
-	nodes = (KdNode<K> *)malloc(nNodes * sizeof(KdNode<K>));
-	mNodeData = new NodeDataIndex[nNodes];
-	std::vector<NodeDataIndex> buildNodes;
-	buildNodes.reserve( nNodes );
-	for( uint32_t i = 0; i < nNodes; ++i )
-		buildNodes.push_back( std::make_pair( &d[i], i ) );
+	mNodes.resize( nNodes );
+	std::vector<BuildPoint> buildNodes( nNodes );
+	for( uint32_t i = 0; i < nNodes; ++i ) {
+		for( unsigned char k = 0; k < K; ++k )
+			buildNodes[i].pos[k] = NodeDataTraits<NodeData>::getAxis( d[i], k );
+		buildNodes[i].index = i;
+	}
+	if( nNodes == 0 )
+		return;
+
 	// Begin the KdTree building process
-	recursiveBuild( 0, 0, nNodes, buildNodes );
+	if( context && ( nNodes >= KDTREE_MIN_PARALLEL_BUILD ) && ( context->getNumThreads() > 1 ) ) {
+		// split the top of the tree serially until there are enough subtrees to fill every thread's bands, then build those concurrently
+		std::vector<BuildTask> deferred;
+		uint32_t maxDeferredSize = std::max<uint32_t>( 1, nNodes / ( context->getNumThreads() * context->getMinRowsPerBand() * 2 ) );
+		recursiveBuild( 0, 0, nNodes, buildNodes, &deferred, maxDeferredSize );
+		context->run( Area( 0, 0, 1, (int32_t)deferred.size() ), std::bind( &KdTree<NodeData, K, LookupProc>::buildBand, this, &buildNodes, &deferred, std::_1 ) );
+	}
+	else
+		recursiveBuild( 0, 0, nNodes, buildNodes, NULL, 0 );
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::buildBand( std::vector<BuildPoint> *buildNodes, const std::vector<BuildTask> *tasks, const Area &band )
+{
+	for( int32_t t = band.y1; t < band.y2; ++t )
+		recursiveBuild( (*tasks)[t].nodeNum, (*tasks)[t].start, (*tasks)[t].end, *buildNodes, NULL, 0 );
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
-void KdTree<NodeData, K, LookupProc>::recursiveBuild( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<NodeDataIndex> &buildNodes )
+void KdTree<NodeData, K, LookupProc>::recursiveBuild( uint32_t nodeNum, uint32_t start, uint32_t end, std::vector<BuildPoint> &buildNodes, std::vector<BuildTask> *deferred, uint32_t maxDeferredSize )
 {
+	// Hand small enough subtrees off to the worker threads. Nodes are laid out depth-first, so a subtree's node numbers only depend on its range
+	if( deferred && ( end - start <= maxDeferredSize ) ) {
+		BuildTask task = { nodeNum, start, end };
+		deferred->push_back( task );
+		return;
+	}
+	KdNode<K> &node = mNodes[nodeNum];
 	// Create leaf node of kd-tree if we've reached the bottom
 	if( start + 1 == end) {
-		nodes[nodeNum].initLeaf();
-		mNodeData[nodeNum] = buildNodes[start];
+		node.initLeaf();
+		std::copy( buildNodes[start].pos, buildNodes[start].pos + K, node.pos );
+		node.index = buildNodes[start].index;
 		return;
 	}
 	// Choose split direction and partition data
@@ -180,14 +231,14 @@ void KdTree<NodeData, K, LookupProc>::recursiveBuild( uint32_t nodeNum, uint32_t
 	float boundMin[K], boundMax[K];
 	for( unsigned char k = 0; k < K; ++k ) {
 		boundMin[k] = FLT_MAX;
-		boundMax[k] = FLT_MIN;
+		boundMax[k] = -FLT_MAX;
 	}
 	
 	for( uint32_t i = start; i < end; ++i ) {
 		for( uint8_t axis = 0; axis < K; axis++ ) {
 			// NOT Compiling? you should define NOMINMAX
-			boundMin[axis] = std::min( boundMin[axis], NodeDataTraits<NodeData>::getAxis( *buildNodes[i].first, axis ) );
-			boundMax[axis] = std::max( boundMax[axis], NodeDataTraits<NodeData>::getAxis( *buildNodes[i].first, axis ) );
+			boundMin[axis] = std::min( boundMin[axis], buildNodes[i].pos[axis] );
+			boundMax[axis] = std::max( boundMax[axis], buildNodes[i].pos[axis] );
 		}
 	}
 	int splitAxis = 0;
@@ -199,24 +250,37 @@ void KdTree<NodeData, K, LookupProc>::recursiveBuild( uint32_t nodeNum, uint32_t
 		}	
 	}
 	uint32_t splitPos = ( start + end ) / 2;
-	std::nth_element( &buildNodes[start], &buildNodes[splitPos], &buildNodes[end-1] + 1, CompareNode<NodeData>(splitAxis) );
-	// Allocate kd-tree node and continue recursively
-	nodes[nodeNum].init( NodeDataTraits<NodeData>::getAxis( *buildNodes[splitPos].first, splitAxis ), splitAxis );
-	mNodeData[nodeNum] = buildNodes[splitPos];
+	std::nth_element( buildNodes.begin() + start, buildNodes.begin() + splitPos, buildNodes.begin() + end, BuildCompare( splitAxis ) );
+	// Fill in kd-tree node and continue recursively; the left subtree follows immediately, the right one after it
+	node.init( buildNodes[splitPos].pos[splitAxis], splitAxis );
+	std::copy( buildNodes[splitPos].pos, buildNodes[splitPos].pos + K, node.pos );
+	node.index = buildNodes[splitPos].index;
 	if( start < splitPos ) {
-		nodes[nodeNum].hasLeftChild = 1;
-		uint32_t childNum = nextFreeNode++;
-		recursiveBuild( childNum, start, splitPos, buildNodes );
+		node.hasLeftChild = 1;
+		recursiveBuild( nodeNum + 1, start, splitPos, buildNodes, deferred, maxDeferredSize );
 	}
 	if( splitPos + 1 < end ) {
-		nodes[nodeNum].rightChild = nextFreeNode++;
-		recursiveBuild( nodes[nodeNum].rightChild, splitPos + 1, end, buildNodes );
+		node.rightChild = nodeNum + 1 + ( splitPos - start );
+		recursiveBuild( node.rightChild, splitPos + 1, end, buildNodes, deferred, maxDeferredSize );
+	}
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+float KdTree<NodeData, K, LookupProc>::distanceSquared( const KdNode<K> &node, const float p[K] ) const
+{
+	float distSqr = 0.0f;
+	for( unsigned char k = 0; k < K; ++k ) {
+		float v = node.pos[k] - p[k];
+		distSqr += v * v;
 	}
+	return distSqr;
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
 void KdTree<NodeData, K, LookupProc>::lookup( const NodeData &p, const LookupProc &proc, float maxDist ) const 
 {
+	if( nNodes == 0 )
+		return;
 	float maxDistSqrd = maxDist * maxDist;
 	float pt[K];
 	for( unsigned char k = 0; k < K; ++k )
@@ -226,9 +290,9 @@ void KdTree<NodeData, K, LookupProc>::lookup( const NodeData &p, const LookupPro
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
-void KdTree<NodeData, K, LookupProc>::privateLookup( uint32_t nodeNum, float p[K], const LookupProc &process, float &maxDistSquared ) const 
+void KdTree<NodeData, K, LookupProc>::privateLookup( uint32_t nodeNum, const float p[K], const LookupProc &process, float &maxDistSquared ) const 
 {
-	KdNode<K> *node = &nodes[nodeNum];
+	const KdNode<K> *node = &mNodes[nodeNum];
 	// process kd-tree node's children
 	int axis = node->splitAxis;
 	if( axis != K ) {
@@ -247,29 +311,25 @@ void KdTree<NodeData, K, LookupProc>::privateLookup( uint32_t nodeNum, float p[K
 		}
 	}
 	// Hand kd-tree node to processing function
-	float distSqr = 0.0f;
-	for( unsigned char k = 0; k < K; ++k ) {
-		float v = NodeDataTraits<NodeData>::getAxis( *mNodeData[nodeNum].first, k ) - p[k];
-		distSqr += v * v;
-	}
-	
+	float distSqr = distanceSquared( *node, p );
 	if( distSqr < maxDistSquared )
-		process.process( mNodeData[nodeNum].second, distSqr, maxDistSquared );
+		process.process( node->index, distSqr, maxDistSquared );
 }
 
 // Find Nearest
 template<typename NodeData, unsigned char K, typename LookupProc>
-void KdTree<NodeData, K, LookupProc>::findNearest( float p[K], float result[K], uint32_t *resultIndex ) const
+void KdTree<NodeData, K, LookupProc>::findNearest( const float p[K], float result[K], uint32_t *resultIndex ) const
 {
 	float maxDist = FLT_MAX;
 	*resultIndex = -1;
-	privateFindNearest( 0, p, maxDist, result, resultIndex );
+	if( nNodes > 0 )
+		privateFindNearest( 0, p, maxDist, result, resultIndex );
 }
 
 template<typename NodeData, unsigned char K, typename LookupProc>
-void KdTree<NodeData, K, LookupProc>::privateFindNearest( uint32_t nodeNum, float p[K], float &maxDistSquared, float result[K], uint32_t *resultIndex ) const
+void KdTree<NodeData, K, LookupProc>::privateFindNearest( uint32_t nodeNum, const float p[K], float &maxDistSquared, float result[K], uint32_t *resultIndex ) const
 {
-	KdNode<K> *node = &nodes[nodeNum];
+	const KdNode<K> *node = &mNodes[nodeNum];
 	// process kd-tree node's children
 	int axis = node->splitAxis;
 	if( axis != K ) {
@@ -292,12 +352,104 @@ void KdTree<NodeData, K, LookupProc>::privateFindNearest( uint32_t nodeNum, floa
 		}
 	}
 	
-	float distSqr = NodeDataTraits<NodeData>::distanceSquared( *mNodeData[nodeNum].first, p );
+	float distSqr = distanceSquared( *node, p );
 	if( distSqr < maxDistSquared ) {
 		maxDistSquared = distSqr;
 		for( unsigned char k = 0; k < K; ++k )
-			result[k] = NodeDataTraits<NodeData>::getAxis( *mNodeData[nodeNum].first, k );
-		*resultIndex = mNodeData[nodeNum].second;
+			result[k] = node->pos[k];
+		*resultIndex = node->index;
+	}
+}
+
+// Find K Nearest
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::findKNearest( const float p[K], uint32_t k, std::vector<uint32_t> *resultIndices, std::vector<float> *resultDistancesSquared ) const
+{
+	// a max-heap of the best k candidates so far; its front is the farthest of them, which bounds the search once the heap is full
+	std::vector<DistanceIndex> heap;
+	heap.reserve( std::min( k, nNodes ) );
+	float maxDistSquared = FLT_MAX;
+	if( ( nNodes > 0 ) && ( k > 0 ) )
+		privateFindKNearest( 0, p, k, heap, maxDistSquared );
+
+	std::sort_heap( heap.begin(), heap.end() );
+	resultIndices->resize( heap.size() );
+	for( size_t i = 0; i < heap.size(); ++i )
+		(*resultIndices)[i] = heap[i].second;
+	if( resultDistancesSquared ) {
+		resultDistancesSquared->resize( heap.size() );
+		for( size_t i = 0; i < heap.size(); ++i )
+			(*resultDistancesSquared)[i] = heap[i].first;
+	}
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::privateFindKNearest( uint32_t nodeNum, const float p[K], uint32_t k, std::vector<DistanceIndex> &heap, float &maxDistSquared ) const
+{
+	const KdNode<K> *node = &mNodes[nodeNum];
+	// descend into the side containing p first, so the heap tightens before the far side is considered
+	int axis = node->splitAxis;
+	if( axis != K ) {
+		float dist2 = ( p[axis] - node->splitPos ) * ( p[axis] - node->splitPos );
+		if( p[axis] <= node->splitPos ) {
+			if( node->hasLeftChild )
+				privateFindKNearest( nodeNum + 1, p, k, heap, maxDistSquared );
+			if( ( dist2 < maxDistSquared ) && ( node->rightChild < nNodes ) )
+				privateFindKNearest( node->rightChild, p, k, heap, maxDistSquared );
+		}
+		else {
+			if( node->rightChild < nNodes )
+				privateFindKNearest( node->rightChild, p, k, heap, maxDistSquared );
+			if( ( dist2 < maxDistSquared ) && node->hasLeftChild )
+				privateFindKNearest( nodeNum + 1, p, k, heap, maxDistSquared );
+		}
+	}
+
+	float distSqr = distanceSquared( *node, p );
+	if( heap.size() < k ) {
+		heap.push_back( DistanceIndex( distSqr, node->index ) );
+		std::push_heap( heap.begin(), heap.end() );
+		if( heap.size() == k )
+			maxDistSquared = heap.front().first;
+	}
+	else if( distSqr < maxDistSquared ) {
+		std::pop_heap( heap.begin(), heap.end() );
+		heap.back() = DistanceIndex( distSqr, node->index );
+		std::push_heap( heap.begin(), heap.end() );
+		maxDistSquared = heap.front().first;
+	}
+}
+
+// Find In Radius
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::findInRadius( const float p[K], float radius, std::vector<uint32_t> *resultIndices, std::vector<float> *resultDistancesSquared ) const
+{
+	resultIndices->clear();
+	if( resultDistancesSquared )
+		resultDistancesSquared->clear();
+	if( nNodes > 0 )
+		privateFindInRadius( 0, p, radius * radius, resultIndices, resultDistancesSquared );
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void KdTree<NodeData, K, LookupProc>::privateFindInRadius( uint32_t nodeNum, const float p[K], float maxDistSquared, std::vector<uint32_t> *resultIndices, std::vector<float> *resultDistancesSquared ) const
+{
+	const KdNode<K> *node = &mNodes[nodeNum];
+	int axis = node->splitAxis;
+	if( axis != K ) {
+		float dist2 = ( p[axis] - node->splitPos ) * ( p[axis] - node->splitPos );
+		bool nearLeft = p[axis] <= node->splitPos;
+		if( node->hasLeftChild && ( nearLeft || ( dist2 < maxDistSquared ) ) )
+			privateFindInRadius( nodeNum + 1, p, maxDistSquared, resultIndices, resultDistancesSquared );
+		if( ( node->rightChild < nNodes ) && ( ( ! nearLeft ) || ( dist2 < maxDistSquared ) ) )
+			privateFindInRadius( node->rightChild, p, maxDistSquared, resultIndices, resultDistancesSquared );
+	}
+
+	float distSqr = distanceSquared( *node, p );
+	if( distSqr < maxDistSquared ) {
+		resultIndices->push_back( node->index );
+		if( resultDistancesSquared )
+			resultDistancesSquared->push_back( distSqr );
 	}
 }
 
@@ -0,0 +1,267 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Thread.h"
+
+#include <boost/call_traits.hpp>
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+#if defined( CINDER_MSW )
+	#include <intrin.h>
+	#pragma intrinsic( _InterlockedCompareExchange, _ReadWriteBarrier )
+#endif
+
+namespace cinder {
+
+namespace detail {
+
+// Minimal atomic operations on 32-bit counters for the lock-free buffers below
+#if defined( CINDER_MSW )
+	inline void		lockFreeFence() { _ReadWriteBarrier(); } // x86 loads and stores already have acquire / release semantics
+	inline bool		lockFreeCompareAndSwap( volatile uint32_t *value, uint32_t expected, uint32_t desired )
+	{ return (uint32_t)_InterlockedCompareExchange( reinterpret_cast<volatile long*>( value ), (long)desired, (long)expected ) == expected; }
+#else
+	#if defined( __i386__ ) || defined( __x86_64__ )
+	inline void		lockFreeFence() { __asm__ __volatile__( "" ::: "memory" ); }
+	#else
+	inline void		lockFreeFence() { __sync_synchronize(); }
+	#endif
+	inline bool		lockFreeCompareAndSwap( volatile uint32_t *value, uint32_t expected, uint32_t desired )
+	{ return __sync_bool_compare_and_swap( value, expected, desired ); }
+#endif
+
+inline uint32_t	lockFreeLoadAcquire( const volatile uint32_t *value ) { uint32_t result = *value; lockFreeFence(); return result; }
+inline void		lockFreeStoreRelease( volatile uint32_t *value, uint32_t newValue ) { lockFreeFence(); *value = newValue; }
+
+//! Rounds \a capacity up to a power of two between 2 and 2^31
+inline uint32_t	lockFreeCapacity( size_t capacity )
+{
+	uint32_t result = 2;
+	while( ( result < capacity ) && ( result < 0x80000000u ) )
+		result <<= 1;
+	return result;
+}
+
+//! Spins briefly before yielding the thread, for the blocking push and pop of the lock-free buffers
+inline void		lockFreeBackoff( int *numSpins )
+{
+	if( ++*numSpins < 64 )
+		return;
+	std::thread::yield();
+}
+
+} // namespace detail
+
+/** \brief Lock-free FIFO for exactly one producer thread and one consumer thread.
+	Offers the interface of ConcurrentCircularBuffer, without the mutex and condition variables, which suits handing off audio and video between two threads.
+	The capacity is rounded up to a power of two. The blocking pushFront() and popBack() spin and then yield while they wait. **/
+template<typename T>
+class SpscCircularBuffer : public boost::noncopyable {
+  public:
+	typedef size_t size_type;
+	typedef T value_type;
+	typedef typename boost::call_traits<value_type>::param_type param_type;
+
+	explicit SpscCircularBuffer( size_type capacity )
+		: mItems( detail::lockFreeCapacity( capacity ) ), mMask( (uint32_t)mItems.size() - 1 ), mHead( 0 ), mTail( 0 ), mCanceled( 0 )
+	{}
+
+	//! Pushes \a item to the front of the buffer, waiting for space unless cancel() has been called. Only one thread may push.
+	void pushFront( param_type item ) {
+		int numSpins = 0;
+		while( ! tryPushFront( item ) && ! isCanceled() )
+			detail::lockFreeBackoff( &numSpins );
+	}
+
+	//! Pops the oldest item from the back of the buffer, waiting for one unless cancel() has been called. Only one thread may pop.
+	void popBack( value_type *pItem ) {
+		int numSpins = 0;
+		while( ! tryPopBack( pItem ) && ! isCanceled() )
+			detail::lockFreeBackoff( &numSpins );
+	}
+
+	//! Attempts to push \a item to the front of the buffer, but does not wait for an availability. Returns success as true or false.
+	bool tryPushFront( param_type item ) {
+		uint32_t tail = mTail;
+		if( tail - detail::lockFreeLoadAcquire( &mHead ) > mMask )
+			return false;
+		mItems[tail & mMask] = item;
+		detail::lockFreeStoreRelease( &mTail, tail + 1 );
+		return true;
+	}
+
+	//! Attempts to pop an item from the back of the buffer, but does not wait for an availability. Returns success as true or false.
+	bool tryPopBack( value_type *pItem ) {
+		uint32_t head = mHead;
+		if( head == detail::lockFreeLoadAcquire( &mTail ) )
+			return false;
+		*pItem = mItems[head & mMask];
+		detail::lockFreeStoreRelease( &mHead, head + 1 );
+		return true;
+	}
+
+	//! Synonym for tryPushFront()
+	bool tryPush( param_type item ) { return tryPushFront( item ); }
+	//! Synonym for tryPopBack()
+	bool tryPop( value_type *pItem ) { return tryPopBack( pItem ); }
+
+	bool isNotEmpty() const { return detail::lockFreeLoadAcquire( &mHead ) != detail::lockFreeLoadAcquire( &mTail ); }
+	bool isNotFull() const { return detail::lockFreeLoadAcquire( &mTail ) - detail::lockFreeLoadAcquire( &mHead ) <= mMask; }
+
+	//! Releases any thread waiting in pushFront() or popBack(), and makes later calls to them return immediately when they would wait
+	void cancel() { detail::lockFreeStoreRelease( &mCanceled, 1 ); }
+
+	//! Returns the number of items the buffer can hold
+	size_t size() const { return mItems.size(); }
+
+  private:
+	bool isCanceled() const { return detail::lockFreeLoadAcquire( &mCanceled ) != 0; }
+
+	std::vector<T>		mItems;
+	uint32_t			mMask;
+	// the consumer's and producer's positions live on separate cache lines
+	char				mPad0[64];
+	volatile uint32_t	mHead;
+	char				mPad1[64];
+	volatile uint32_t	mTail;
+	char				mPad2[64];
+	volatile uint32_t	mCanceled;
+};
+
+/** \brief Lock-free FIFO for any number of producer and consumer threads, using a sequence number per slot (Dmitry Vyukov's bounded queue).
+	Offers the interface of ConcurrentCircularBuffer. The capacity is rounded up to a power of two. The blocking pushFront() and popBack() spin and then yield while they wait. **/
+template<typename T>
+class MpmcCircularBuffer : public boost::noncopyable {
+  public:
+	typedef size_t size_type;
+	typedef T value_type;
+	typedef typename boost::call_traits<value_type>::param_type param_type;
+
+	explicit MpmcCircularBuffer( size_type capacity )
+		: mCells( detail::lockFreeCapacity( capacity ) ), mMask( (uint32_t)mCells.size() - 1 ), mEnqueuePos( 0 ), mDequeuePos( 0 ), mCanceled( 0 )
+	{
+		for( uint32_t i = 0; i <= mMask; ++i )
+			mCells[i].mSequence = i;
+	}
+
+	//! Pushes \a item to the front of the buffer, waiting for space unless cancel() has been called
+	void pushFront( param_type item ) {
+		int numSpins = 0;
+		while( ! tryPushFront( item ) && ! isCanceled() )
+			detail::lockFreeBackoff( &numSpins );
+	}
+
+	//! Pops the oldest item from the back of the buffer, waiting for one unless cancel() has been called
+	void popBack( value_type *pItem ) {
+		int numSpins = 0;
+		while( ! tryPopBack( pItem ) && ! isCanceled() )
+			detail::lockFreeBackoff( &numSpins );
+	}
+
+	//! Attempts to push \a item to the front of the buffer, but does not wait for an availability. Returns success as true or false.
+	bool tryPushFront( param_type item ) {
+		Cell *cell;
+		uint32_t pos = mEnqueuePos;
+		for(;;) {
+			cell = &mCells[pos & mMask];
+			int32_t diff = (int32_t)( detail::lockFreeLoadAcquire( &cell->mSequence ) - pos );
+			if( diff == 0 ) {
+				if( detail::lockFreeCompareAndSwap( &mEnqueuePos, pos, pos + 1 ) )
+					break;
+			}
+			else if( diff < 0 ) // the slot still holds an item from the previous lap
+				return false;
+			pos = mEnqueuePos;
+		}
+		cell->mItem = item;
+		detail::lockFreeStoreRelease( &cell->mSequence, pos + 1 );
+		return true;
+	}
+
+	//! Attempts to pop an item from the back of the buffer, but does not wait for an availability. Returns success as true or false.
+	bool tryPopBack( value_type *pItem ) {
+		Cell *cell;
+		uint32_t pos = mDequeuePos;
+		for(;;) {
+			cell = &mCells[pos & mMask];
+			int32_t diff = (int32_t)( detail::lockFreeLoadAcquire( &cell->mSequence ) - ( pos + 1 ) );
+			if( diff == 0 ) {
+				if( detail::lockFreeCompareAndSwap( &mDequeuePos, pos, pos + 1 ) )
+					break;
+			}
+			else if( diff < 0 ) // the slot hasn't been written in this lap
+				return false;
+			pos = mDequeuePos;
+		}
+		*pItem = cell->mItem;
+		detail::lockFreeStoreRelease( &cell->mSequence, pos + mMask + 1 );
+		return true;
+	}
+
+	//! Synonym for tryPushFront()
+	bool tryPush( param_type item ) { return tryPushFront( item ); }
+	//! Synonym for tryPopBack()
+	bool tryPop( value_type *pItem ) { return tryPopBack( pItem ); }
+
+	//! Returns whether an item is ready to be popped. With several consumers the answer may be stale by the time it is used.
+	bool isNotEmpty() const {
+		uint32_t pos = detail::lockFreeLoadAcquire( &mDequeuePos );
+		return detail::lockFreeLoadAcquire( &mCells[pos & mMask].mSequence ) == pos + 1;
+	}
+	//! Returns whether there is space to push an item. With several producers the answer may be stale by the time it is used.
+	bool isNotFull() const {
+		uint32_t pos = detail::lockFreeLoadAcquire( &mEnqueuePos );
+		return detail::lockFreeLoadAcquire( &mCells[pos & mMask].mSequence ) == pos;
+	}
+
+	//! Releases any thread waiting in pushFront() or popBack(), and makes later calls to them return immediately when they would wait
+	void cancel() { detail::lockFreeStoreRelease( &mCanceled, 1 ); }
+
+	//! Returns the number of items the buffer can hold
+	size_t size() const { return mCells.size(); }
+
+  private:
+	struct Cell {
+		volatile uint32_t	mSequence;
+		T					mItem;
+	};
+
+	bool isCanceled() const { return detail::lockFreeLoadAcquire( &mCanceled ) != 0; }
+
+	std::vector<Cell>	mCells;
+	uint32_t			mMask;
+	char				mPad0[64];
+	volatile uint32_t	mEnqueuePos;
+	char				mPad1[64];
+	volatile uint32_t	mDequeuePos;
+	char				mPad2[64];
+	volatile uint32_t	mCanceled;
+};
+
+} // namespace cinder
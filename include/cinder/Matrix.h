@@ -33,6 +33,10 @@
 
 namespace cinder { 
 
+namespace ip {
+	typedef std::shared_ptr<class ExecutionContext>	ExecutionContextRef;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 // Parallel Transport Frames
 //
@@ -113,4 +117,22 @@ Matrix44<T> lastFrame(
 	return lastFrame( prevMatrix, prevPoint.xyz(), lastPoint.xyz() );
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+// Batch transforms
+//
+//  These apply one matrix to an array of points, four at a time with SSE or NEON where available,
+//  and produce the same results as calling the per-point equivalent in a loop. \a out may equal \a in
+//  but must not otherwise overlap it. The overloads accepting an ip::ExecutionContextRef split large
+//  arrays across its threads.
+
+//! Transforms the \a count points at \a in by \a matrix as Matrix44::transformPoint() does, including the divide by w, writing the results to \a out
+void transformPoints( const Matrix44f &matrix, const Vec3f *in, Vec3f *out, size_t count );
+void transformPoints( const Matrix44f &matrix, const Vec3f *in, Vec3f *out, size_t count, const ip::ExecutionContextRef &context );
+//! Transforms the \a count points at \a in by \a matrix as Matrix44::transformPointAffine() does, writing the results to \a out
+void transformPointsAffine( const Matrix44f &matrix, const Vec3f *in, Vec3f *out, size_t count );
+void transformPointsAffine( const Matrix44f &matrix, const Vec3f *in, Vec3f *out, size_t count, const ip::ExecutionContextRef &context );
+//! Transforms the \a count points at \a in by \a matrix as MatrixAffine2::transformPoint() does, writing the results to \a out
+void transformPoints( const MatrixAffine2f &matrix, const Vec2f *in, Vec2f *out, size_t count );
+void transformPoints( const MatrixAffine2f &matrix, const Vec2f *in, Vec2f *out, size_t count, const ip::ExecutionContextRef &context );
+
 } // namespace cinder
@@ -1305,6 +1305,132 @@ Matrix44<T> Matrix44<T>::alignZAxisWithTarget( Vec3<T> targetDir, Vec3<T> upDir
     return mat;
 }
 
+#if defined( CINDER_SIMD_MATH )
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+// SIMD Matrix44<float>, which accumulates in the same order as the scalar template and so produces identical results
+//!  \cond
+namespace detail {
+// product of the columns of \a m with x, y, z and w
+inline SimdFloat4 simdTransform44( const float *m, float x, float y, float z, float w )
+{
+	return simdAdd( simdAdd( simdAdd( simdMul( simdLoad( m ), simdSplat( x ) ), simdMul( simdLoad( m + 4 ), simdSplat( y ) ) ), simdMul( simdLoad( m + 8 ), simdSplat( z ) ) ), simdMul( simdLoad( m + 12 ), simdSplat( w ) ) );
+}
+
+// product of the first three columns of \a m with x, y and z
+inline SimdFloat4 simdTransform43( const float *m, float x, float y, float z )
+{
+	return simdAdd( simdAdd( simdMul( simdLoad( m ), simdSplat( x ) ), simdMul( simdLoad( m + 4 ), simdSplat( y ) ) ), simdMul( simdLoad( m + 8 ), simdSplat( z ) ) );
+}
+
+// \a result = \a a * \a b, where \a result may alias either
+inline void simdMultiply44( float *result, const float *a, const float *b )
+{
+	const SimdFloat4 a0 = simdLoad( a ), a1 = simdLoad( a + 4 ), a2 = simdLoad( a + 8 ), a3 = simdLoad( a + 12 );
+	for( int c = 0; c < 16; c += 4 ) {
+		const SimdFloat4 col = simdAdd( simdAdd( simdAdd( simdMul( a0, simdSplat( b[c] ) ), simdMul( a1, simdSplat( b[c+1] ) ) ), simdMul( a2, simdSplat( b[c+2] ) ) ), simdMul( a3, simdSplat( b[c+3] ) ) );
+		simdStore( result + c, col );
+	}
+}
+} // namespace detail
+
+template<>
+inline Matrix44<float>& Matrix44<float>::operator*=( const Matrix44<float> &rhs )
+{
+	detail::simdMultiply44( m, m, rhs.m );
+	return *this;
+}
+
+template<>
+inline const Matrix44<float> Matrix44<float>::operator*( const Matrix44<float> &rhs ) const
+{
+	Matrix44<float> ret;
+	detail::simdMultiply44( ret.m, m, rhs.m );
+	return ret;
+}
+
+template<>
+inline const Vec3<float> Matrix44<float>::operator*( const Vec3<float> &rhs ) const
+{
+	float r[4];
+	detail::simdStore( r, detail::simdTransform44( m, rhs.x, rhs.y, rhs.z, 1 ) );
+	return Vec3<float>( r[0]/r[3], r[1]/r[3], r[2]/r[3] );
+}
+
+template<>
+inline const Vec4<float> Matrix44<float>::operator*( const Vec4<float> &rhs ) const
+{
+	return detail::simdToVec4f( detail::simdTransform44( m, rhs.x, rhs.y, rhs.z, rhs.w ) );
+}
+
+template<>
+inline Vec3<float> Matrix44<float>::transformPoint( const Vec3<float> &rhs ) const
+{
+	float r[4];
+	detail::simdStore( r, detail::simdTransform44( m, rhs.x, rhs.y, rhs.z, 1 ) );
+	return Vec3<float>( r[0] / r[3], r[1] / r[3], r[2] / r[3] );
+}
+
+template<>
+inline Vec3<float> Matrix44<float>::transformPointAffine( const Vec3<float> &rhs ) const
+{
+	float r[4];
+	detail::simdStore( r, detail::simdTransform44( m, rhs.x, rhs.y, rhs.z, 1 ) );
+	return Vec3<float>( r[0], r[1], r[2] );
+}
+
+template<>
+inline Vec3<float> Matrix44<float>::transformVec( const Vec3<float> &rhs ) const
+{
+	float r[4];
+	detail::simdStore( r, detail::simdTransform43( m, rhs.x, rhs.y, rhs.z ) );
+	return Vec3<float>( r[0], r[1], r[2] );
+}
+
+#if defined( CINDER_SIMD_MATH_SSE )
+// Evaluates the cofactor expansion of the scalar inverted() a column at a time, lane by lane in the same order
+template<>
+inline Matrix44<float> Matrix44<float>::inverted( float epsilon ) const
+{
+	const __m128 c0 = _mm_loadu_ps( m ), c1 = _mm_loadu_ps( m + 4 ), c2 = _mm_loadu_ps( m + 8 ), c3 = _mm_loadu_ps( m + 12 );
+
+	// 2x2 determinants of the first two columns (a) and the last two (b), as ( a0 a1 b0 b1 ), ( a2 a3 b2 b3 ) and ( a4 a5 b4 b5 )
+	const __m128 d01 = _mm_sub_ps( _mm_mul_ps( _mm_shuffle_ps( c0, c2, _MM_SHUFFLE( 0, 0, 0, 0 ) ), _mm_shuffle_ps( c1, c3, _MM_SHUFFLE( 2, 1, 2, 1 ) ) ),
+									_mm_mul_ps( _mm_shuffle_ps( c0, c2, _MM_SHUFFLE( 2, 1, 2, 1 ) ), _mm_shuffle_ps( c1, c3, _MM_SHUFFLE( 0, 0, 0, 0 ) ) ) );
+	const __m128 d23 = _mm_sub_ps( _mm_mul_ps( _mm_shuffle_ps( c0, c2, _MM_SHUFFLE( 1, 0, 1, 0 ) ), _mm_shuffle_ps( c1, c3, _MM_SHUFFLE( 2, 3, 2, 3 ) ) ),
+									_mm_mul_ps( _mm_shuffle_ps( c0, c2, _MM_SHUFFLE( 2, 3, 2, 3 ) ), _mm_shuffle_ps( c1, c3, _MM_SHUFFLE( 1, 0, 1, 0 ) ) ) );
+	const __m128 d45 = _mm_sub_ps( _mm_mul_ps( _mm_shuffle_ps( c0, c2, _MM_SHUFFLE( 2, 1, 2, 1 ) ), _mm_shuffle_ps( c1, c3, _MM_SHUFFLE( 3, 3, 3, 3 ) ) ),
+									_mm_mul_ps( _mm_shuffle_ps( c0, c2, _MM_SHUFFLE( 3, 3, 3, 3 ) ), _mm_shuffle_ps( c1, c3, _MM_SHUFFLE( 2, 1, 2, 1 ) ) ) );
+
+	float d[12];
+	_mm_storeu_ps( d, d01 );
+	_mm_storeu_ps( d + 4, d23 );
+	_mm_storeu_ps( d + 8, d45 );
+	const float det = d[0]*d[11] - d[1]*d[10] + d[4]*d[7] + d[5]*d[6] - d[8]*d[3] + d[9]*d[2];
+	if( ! ( fabs( det ) > epsilon ) )
+		return Matrix44<float>( 0.0f );
+
+	// ( bN bN aN aN ) for each determinant
+	const __m128 ab0 = _mm_shuffle_ps( d01, d01, _MM_SHUFFLE( 0, 0, 2, 2 ) ), ab1 = _mm_shuffle_ps( d01, d01, _MM_SHUFFLE( 1, 1, 3, 3 ) );
+	const __m128 ab2 = _mm_shuffle_ps( d23, d23, _MM_SHUFFLE( 0, 0, 2, 2 ) ), ab3 = _mm_shuffle_ps( d23, d23, _MM_SHUFFLE( 1, 1, 3, 3 ) );
+	const __m128 ab4 = _mm_shuffle_ps( d45, d45, _MM_SHUFFLE( 0, 0, 2, 2 ) ), ab5 = _mm_shuffle_ps( d45, d45, _MM_SHUFFLE( 1, 1, 3, 3 ) );
+
+	// rows of the columns reordered as ( c1 c0 c3 c2 ), so that v0 = ( m4 m0 m12 m8 ) and so on
+	__m128 v0 = c1, v1 = c0, v2 = c3, v3 = c2;
+	_MM_TRANSPOSE4_PS( v0, v1, v2, v3 );
+
+	const __m128 signEven = _mm_setr_ps( 0.0f, -0.0f, 0.0f, -0.0f ), signOdd = _mm_setr_ps( -0.0f, 0.0f, -0.0f, 0.0f );
+	const __m128 invDet = _mm_set1_ps( 1.0f / det );
+	Matrix44<float> inv;
+	_mm_storeu_ps( inv.m, _mm_mul_ps( _mm_xor_ps( _mm_add_ps( _mm_sub_ps( _mm_mul_ps( v1, ab5 ), _mm_mul_ps( v2, ab4 ) ), _mm_mul_ps( v3, ab3 ) ), signEven ), invDet ) );
+	_mm_storeu_ps( inv.m + 4, _mm_mul_ps( _mm_xor_ps( _mm_add_ps( _mm_sub_ps( _mm_mul_ps( v0, ab5 ), _mm_mul_ps( v2, ab2 ) ), _mm_mul_ps( v3, ab1 ) ), signOdd ), invDet ) );
+	_mm_storeu_ps( inv.m + 8, _mm_mul_ps( _mm_xor_ps( _mm_add_ps( _mm_sub_ps( _mm_mul_ps( v0, ab4 ), _mm_mul_ps( v1, ab2 ) ), _mm_mul_ps( v3, ab0 ) ), signEven ), invDet ) );
+	_mm_storeu_ps( inv.m + 12, _mm_mul_ps( _mm_xor_ps( _mm_add_ps( _mm_sub_ps( _mm_mul_ps( v0, ab3 ), _mm_mul_ps( v1, ab1 ) ), _mm_mul_ps( v2, ab0 ) ), signOdd ), invDet ) );
+	return inv;
+}
+#endif // defined( CINDER_SIMD_MATH_SSE )
+//! \endcond
+#endif // defined( CINDER_SIMD_MATH )
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 // Typedefs
 typedef Matrix44<float>	 Matrix44f;
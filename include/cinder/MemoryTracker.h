@@ -0,0 +1,104 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+
+namespace cinder {
+
+/** \brief Optional counters of the memory held by Cinder's larger allocations, per subsystem: live and peak bytes, allocation counts and allocations per second.
+	Tracking is disabled by default, in which case a tracked allocation costs a single test of a global flag. Only memory allocated while tracking is enabled is counted,
+	so enable it early, such as in prepareSettings(). Counted memory is still subtracted when freed after tracking is disabled.
+	Profiler::beginFrame() updates the allocation rates, and Profiler::writeChromeTrace() exports the live bytes as counters. **/
+class MemoryTracker {
+  public:
+	enum Category { SURFACE, CHANNEL, BUFFER, AUDIO, TRIMESH, TIMELINE, NUM_CATEGORIES };
+
+	struct Stats {
+		Stats() : mLiveBytes( 0 ), mPeakBytes( 0 ), mNumAllocations( 0 ), mNumFrees( 0 ), mAllocationsPerSecond( 0 ) {}
+
+		int64_t		mLiveBytes, mPeakBytes;
+		uint64_t	mNumAllocations, mNumFrees;
+		//! Allocations per second between the two most recent update() intervals
+		double		mAllocationsPerSecond;
+	};
+
+	//! Enables or disables tracking. Disabled by default.
+	static void			enable( bool enable = true ) { sEnabled = enable; }
+	//! Returns whether new allocations are tracked
+	static bool			isEnabled() { return sEnabled; }
+
+	//! Returns the counters of \a category
+	static Stats		getStats( Category category );
+	//! Returns a human readable name for \a category, such as "Surface"
+	static const char*	getCategoryName( Category category );
+	//! Resets the peak bytes of every category to its live bytes
+	static void			resetPeaks();
+	//! Updates the allocations per second of every category, at most once per second, from the allocations since the previous update. \a seconds is a monotonic clock such as Profiler::getSeconds().
+	static void			update( double seconds );
+
+	//! Counts \a count allocations totaling \a bytes under \a category. Tracked classes test isEnabled() first; prefer TrackedMemory.
+	static void			recordAllocation( Category category, size_t bytes, uint32_t count = 1 );
+	//! Counts \a count frees totaling \a bytes under \a category
+	static void			recordFree( Category category, size_t bytes, uint32_t count = 1 );
+
+  private:
+	static volatile bool	sEnabled;
+};
+
+/** \brief Accounts for the memory held by a single object under a MemoryTracker category and releases it on destruction.
+	Copies account for the same number of bytes as the original, so it can be a member of value types such as TriMesh. **/
+class TrackedMemory {
+  public:
+	explicit TrackedMemory( MemoryTracker::Category category ) : mCategory( category ), mBytes( 0 ) {}
+	TrackedMemory( const TrackedMemory &rhs ) : mCategory( rhs.mCategory ), mBytes( 0 ) { set( rhs.mBytes ); }
+	~TrackedMemory() { if( mBytes ) MemoryTracker::recordFree( mCategory, mBytes ); }
+
+	TrackedMemory&	operator=( const TrackedMemory &rhs ) { set( rhs.mBytes ); return *this; }
+
+	//! Sets the number of bytes held by the object. Growth counts as an allocation and is ignored while tracking is disabled. Shrinking is always accounted for.
+	void		set( size_t bytes )
+	{
+		if( bytes > mBytes ) {
+			if( MemoryTracker::isEnabled() ) {
+				MemoryTracker::recordAllocation( mCategory, bytes - mBytes );
+				mBytes = bytes;
+			}
+		}
+		else if( bytes < mBytes ) {
+			MemoryTracker::recordFree( mCategory, mBytes - bytes, ( bytes == 0 ) ? 1 : 0 );
+			mBytes = bytes;
+		}
+	}
+	//! Returns the number of bytes currently accounted for
+	size_t		get() const { return mBytes; }
+
+  private:
+	MemoryTracker::Category		mCategory;
+	size_t						mBytes;
+};
+
+} // namespace cinder
@@ -24,16 +24,20 @@
 
 #include "cinder/TriMesh.h"
 #include "cinder/Stream.h"
+#include "cinder/Function.h"
 
 #include <boost/logic/tribool.hpp>
-#include <boost/tuple/tuple_comparison.hpp>
-#include <map>
 
 namespace cinder {
 
+namespace ip {
+	typedef std::shared_ptr<class ExecutionContext>	ExecutionContextRef;
+}
+
 /** \brief Loads Alias|Wavefront .OBJ file format
  *
- * Currently does not support anything but polygonal data
+ * Currently does not support anything but polygonal data. The file is memory mapped or read in bulk, and large files are parsed
+ * in chunks on the threads of an ip::ExecutionContext when one is supplied.
  * \n Example usage:
  * \code
  * cinder::TriMesh myCube;
@@ -46,12 +50,14 @@ class ObjLoader {
  public:
 	/**Constructs and does the parsing of the file
 	 * \param includeUVs  if false UV coordinates will be skipped, which can provide a faster load time
+	 * \param context  if supplied, large files are split into chunks which are parsed concurrently on its threads
 	**/
-	ObjLoader( std::shared_ptr<IStream> aStream, bool includeUVs = true );
+	ObjLoader( std::shared_ptr<IStream> aStream, bool includeUVs = true, const ip::ExecutionContextRef &context = ip::ExecutionContextRef() );
 	/**Constructs and does the parsing of the file
 	 * \param includeUVs if false UV coordinates will be skipped, which can provide a faster load time
+	 * \param context  if supplied, large files are split into chunks which are parsed concurrently on its threads
 	**/
-	ObjLoader( DataSourceRef dataSource, bool includeUVs = true );
+	ObjLoader( DataSourceRef dataSource, bool includeUVs = true, const ip::ExecutionContextRef &context = ip::ExecutionContextRef() );
 	~ObjLoader();
 
 	/**Loads all the groups present in the file into a single TriMesh
@@ -66,17 +72,28 @@ class ObjLoader {
 	 * \param optimizeVertices  should the loader minimize the vertices by identifying shared vertices between faces.*/
 	void	load( size_t groupIndex, TriMesh *destTriMesh, boost::tribool loadNormals = boost::logic::indeterminate, boost::tribool loadTexCoords = boost::logic::indeterminate, bool optimizeVertices = true );
 	
+	/**Parses \a dataSource without building the whole mesh, passing its faces to \a chunkFn as a series of TriMeshes with at most \a maxVerticesPerChunk vertices each,
+	 * for instance to create a gl::VboMesh from each one or to write them to a cache. Vertices are shared within each chunk. Apart from the file's v, vt and vn attributes,
+	 * which any later face may refer to, memory use is proportional to the chunk size. A \a maxVerticesPerChunk of 65536 or less keeps each chunk's indices within 16 bits.
+	 * \param loadNormals  should normals be loaded or generated if not present. Default determines from the first face
+	 * \param loadTexCoords  should 2D texture coordinates be loaded or set to zero if not present. Default determines from the first face
+	**/
+	static void		loadChunks( DataSourceRef dataSource, size_t maxVerticesPerChunk, const std::function<void(const TriMesh&)> &chunkFn,
+								boost::tribool loadNormals = boost::logic::indeterminate, boost::tribool loadTexCoords = boost::logic::indeterminate );
+
+	//! A polygon whose corners are the \a mNumVertices entries of its Group's index arrays starting at \a mFirstIndex
 	struct Face {
+		uint32_t			mFirstIndex;
 		int					mNumVertices;
-		std::vector<int>	mVertexIndices;
-		std::vector<int>	mTexCoordIndices;
-		std::vector<int>	mNormalIndices;
+		bool				mHasTexCoords, mHasNormals; // whether every corner has a texture coordinate or normal index
 	};
 
 	struct Group {
 		std::string				mName;
 		int						mBaseVertexOffset, mBaseTexCoordOffset, mBaseNormalOffset;
 		std::vector<Face>		mFaces;
+		//! The corners of all the faces, stored contiguously. Texture coordinate and normal indices are \c -1 for corners which lack them
+		std::vector<int>		mVertexIndices, mTexCoordIndices, mNormalIndices;
 		bool					mHasTexCoords;
 		bool					mHasNormals;
 	};
@@ -85,19 +102,13 @@ class ObjLoader {
 	static void		write( DataTargetRef dataTarget, const TriMesh &mesh, bool writeNormals = true, bool writeUVs = true );
 	
  private:
-	typedef boost::tuple<int,int> VertexPair;
-	typedef boost::tuple<int,int,int> VertexTriple;
+	class VertexMap;
 
-	void	parse( bool includeUVs );
+	void	parse( const char *data, size_t size, bool includeUVs, const ip::ExecutionContextRef &context );
 
- 	void	parseFace( Group *group, const std::string &s, bool includeUVs );
 	void	loadInternalNoOptimize( const Group &group, TriMesh *destTriMesh, bool texCoords, bool normals );
-	void	loadInternalNormalsTextures( const Group &group, std::map<boost::tuple<int,int,int>,int> &uniqueVerts, TriMesh *destTriMesh );
-	void	loadInternalNormals( const Group &group, std::map<boost::tuple<int,int>,int> &uniqueVerts, TriMesh *destTriMesh );
-	void	loadInternalTextures( const Group &group, std::map<boost::tuple<int,int>,int> &uniqueVerts, TriMesh *destTriMesh );
-	void	loadInternal( const Group &group, std::map<int,int> &uniqueVerts, TriMesh *destTriMesh );	
+	void	loadInternal( const Group &group, VertexMap *uniqueVerts, TriMesh *destTriMesh, bool texCoords, bool normals );
  
-	std::shared_ptr<IStream>	mStream;
 	std::vector<Vec3f>			mVertices, mNormals;
 	std::vector<Vec2f>			mTexCoords;
 	std::vector<Group>			mGroups;
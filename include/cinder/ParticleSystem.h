@@ -0,0 +1,112 @@
+/*
+ Copyright (c) 2010, The Barbarian Group
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Vector.h"
+#include "cinder/Color.h"
+#include "cinder/Function.h"
+#include "cinder/JobSystem.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace cinder {
+
+class Perlin;
+
+/** \brief Particles stored as a structure of arrays, one contiguous array per attribute, updated by kernels which split the particles across the threads of a JobSystem.
+ *  Each kernel streams through only the arrays it needs in simple loops the compiler can vectorize, unlike a std::list of particle objects.
+ *  Particles are killed by moving the last particle into their place, so indices aren't stable across kill() and killExpired(), and the arrays are never sparse.
+ *  Draw them with gl::ParticleMesh. **/
+class ParticleSystem {
+  public:
+	//! Creates an empty system with room for \a reserve particles before any reallocation
+	explicit ParticleSystem( size_t reserve = 0 );
+
+	//! Adds a particle and returns its index
+	size_t		emit( const Vec3f &position, const Vec3f &velocity = Vec3f::zero(), float lifetime = 1, const ColorA &color = ColorA::white() );
+	//! Adds \a count particles at the origin, at rest, white and living forever, and returns the index of the first. Fill in their attributes through the arrays.
+	size_t		emit( size_t count );
+	//! Removes the particle \a index by moving the last particle into its place
+	void		kill( size_t index );
+	//! Removes every particle whose age has reached its lifetime, and returns how many were removed
+	size_t		killExpired();
+	//! Removes every particle, keeping the arrays' memory for reuse
+	void		clear();
+
+	//! Returns the number of particles
+	size_t		size() const { return mPositions.size(); }
+	bool		empty() const { return mPositions.empty(); }
+
+	Vec3f*			getPositions() { return data( mPositions ); }
+	const Vec3f*	getPositions() const { return data( mPositions ); }
+	Vec3f*			getVelocities() { return data( mVelocities ); }
+	const Vec3f*	getVelocities() const { return data( mVelocities ); }
+	ColorA*			getColors() { return data( mColors ); }
+	const ColorA*	getColors() const { return data( mColors ); }
+	//! Returns the ages of the particles in seconds, advanced by integrate()
+	float*			getAges() { return data( mAges ); }
+	const float*	getAges() const { return data( mAges ); }
+	//! Returns the lifetimes of the particles in seconds. killExpired() removes particles whose age has reached their lifetime.
+	float*			getLifetimes() { return data( mLifetimes ); }
+	const float*	getLifetimes() const { return data( mLifetimes ); }
+
+	//! Sets the JobSystem which runs the kernels. Defaults to JobSystem::getDefault(), and a NULL JobSystemRef runs them on the calling thread.
+	void				setJobSystem( const JobSystemRef &jobSystem ) { mJobSystem = jobSystem; }
+	const JobSystemRef&	getJobSystem() const { return mJobSystem; }
+	//! Sets the fewest particles a kernel hands to one job. Defaults to \c 4096
+	void				setGrainSize( size_t grainSize ) { mGrainSize = std::max<size_t>( grainSize, 1 ); }
+
+	//! Adds \a acceleration * \a dt to every velocity, as for gravity or wind
+	void		applyForce( const Vec3f &acceleration, float dt );
+	//! Accelerates every particle toward \a center by \a strength divided by its squared distance, which is clamped to \a minDistance squared
+	void		applyAttractor( const Vec3f &center, float strength, float dt, float minDistance = 1 );
+	/** Accelerates every particle along the gradient of \a perlin's fBm at its position * \a frequency + \a offset, scaled by \a strength.
+	 *  Animate \a offset to make the field drift. The noise is evaluated in batches by Perlin::dfBm(), with SSE2 where available. **/
+	void		applyFlowField( const Perlin &perlin, float frequency, float strength, float dt, const Vec3f &offset = Vec3f::zero() );
+	//! Scales every velocity by \a damping per second, so \c 1 preserves velocities and \c 0 stops particles immediately
+	void		applyDamping( float damping, float dt );
+	//! Advances every position by its velocity * \a dt and every age by \a dt
+	void		integrate( float dt );
+	//! Integrates by \a dt and then removes the expired particles
+	void		update( float dt ) { integrate( dt ); killExpired(); }
+
+	//! Calls \a kernel with ranges [begin, end) of particles which together cover them all, concurrently on the JobSystem. \a kernel must be safe to call concurrently.
+	void		parallelFor( const std::function<void(size_t,size_t)> &kernel ) const;
+
+  private:
+	template<typename T>
+	static T*		data( std::vector<T> &v ) { return v.empty() ? 0 : &v[0]; }
+	template<typename T>
+	static const T*	data( const std::vector<T> &v ) { return v.empty() ? 0 : &v[0]; }
+
+	std::vector<Vec3f>		mPositions, mVelocities;
+	std::vector<ColorA>		mColors;
+	std::vector<float>		mAges, mLifetimes;
+
+	JobSystemRef			mJobSystem;
+	size_t					mGrainSize;
+};
+
+} // namespace cinder
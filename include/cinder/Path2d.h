@@ -53,14 +53,14 @@ class Path2d {
 	void	arcTo( float x, float y, float tanX, float tanY, float radius) { arcTo( Vec2f( x, y ), Vec2f( tanX, tanY ), radius ); }
 	
 	//! Closes the path, by drawing a straight line from the first to the last point. This is only legal as the last command.
-	void	close() { mSegments.push_back( CLOSE ); }
+	void	close() { mSegments.push_back( CLOSE ); mFlattenCache.reset(); }
 	bool	isClosed() const { return ( mSegments.size() > 1 ) && mSegments.back() == CLOSE; }
     
 	//! Reverses the order of the path's points, inverting its winding order
     void	reverse();
 	
 	bool	empty() const { return mPoints.empty(); }
-	void	clear() { mSegments.clear(); mPoints.clear(); }
+	void	clear() { mSegments.clear(); mPoints.clear(); mFlattenCache.reset(); }
 	size_t	getNumSegments() const { return mSegments.size(); }
 	size_t	getNumPoints() const { return mPoints.size(); }
 
@@ -70,6 +70,15 @@ class Path2d {
 	Vec2f	getSegmentPosition( size_t segment, float t ) const;
 	
 	std::vector<Vec2f>	subdivide( float approximationScale = 1.0f ) const;
+	//! Returns a cached polyline of points lying on the curve, flattened to within <tt>0.5 / approximationScale</tt>. The cache is rebuilt only after the path is edited or \a approximationScale changes, so concurrent calls on the same Path2d must be synchronized.
+	const std::vector<Vec2f>&	getSubdivided( float approximationScale = 1.0f ) const;
+
+	//! Returns the arc length of the path, measured along its cached subdivision
+	float	calcLength() const;
+	//! Returns the point at \a t of the path's arc length, where \a t lies in the range <tt>[0,1]</tt>. Unlike getPosition(), equal steps in \a t cover equal distances.
+	Vec2f	calcPosition( float t ) const;
+	//! Returns the parameter in the range <tt>[0,1]</tt> which getPosition() maps to the point \a distance along the path
+	float	calcNormalizedTime( float distance ) const;
 	
 	//! Scales the Path2d by \a amount.x on X and \a amount.y on Y around the center \a scaleCenter
 	void		scale( const Vec2f &amount, Vec2f scaleCenter = Vec2f::zero() );
@@ -80,18 +89,19 @@ class Path2d {
 
 
 	const std::vector<Vec2f>&	getPoints() const { return mPoints; }
-	std::vector<Vec2f>&			getPoints() { return mPoints; }
+	//! Invalidates the cached subdivision. Edits made through the returned reference after a later call to getSubdivided() or the arc length functions are not detected.
+	std::vector<Vec2f>&			getPoints() { mFlattenCache.reset(); return mPoints; }
 	const Vec2f&				getPoint( size_t point ) const { return mPoints[point]; }
-	Vec2f&						getPoint( size_t point ) { return mPoints[point]; }
+	Vec2f&						getPoint( size_t point ) { mFlattenCache.reset(); return mPoints[point]; }
 	const Vec2f&				getCurrentPoint() const { return mPoints.back(); }
-	void						setPoint( size_t index, const Vec2f &p ) { mPoints[index] = p; }
+	void						setPoint( size_t index, const Vec2f &p ) { mPoints[index] = p; mFlattenCache.reset(); }
 
 	enum SegmentType { MOVETO, LINETO, QUADTO, CUBICTO, CLOSE };
 	static const int sSegmentTypePointCounts[];
 	SegmentType		getSegmentType( size_t segment ) const { return mSegments[segment]; }
 
 	const std::vector<SegmentType>&	getSegments() const { return mSegments; }
-	std::vector<SegmentType>&		getSegments() { return mSegments; }
+	std::vector<SegmentType>&		getSegments() { mFlattenCache.reset(); return mSegments; }
 
 	void			removeSegment( size_t segment );
 	
@@ -111,8 +121,14 @@ class Path2d {
 	void	subdivideQuadratic( float distanceToleranceSqr, const Vec2f &p1, const Vec2f &p2, const Vec2f &p3, int level, std::vector<Vec2f> *result ) const;
 	void	subdivideCubic( float distanceToleranceSqr, const Vec2f &p1, const Vec2f &p2, const Vec2f &p3, const Vec2f &p4, int level, std::vector<Vec2f> *result ) const;
 
+	struct FlattenCache;
+	const FlattenCache&	getFlattenCache( float approximationScale ) const;
+	static size_t		findArcLengthIndex( const FlattenCache &cache, float distance, float *fraction );
+
 	std::vector<Vec2f>			mPoints;
 	std::vector<SegmentType>	mSegments;
+	// Immutable once built, so copies of a Path2d share it; every edit releases it rather than modifying it
+	mutable std::shared_ptr<const FlattenCache>	mFlattenCache;
 };
 
 inline std::ostream& operator<<( std::ostream &out, const Path2d &p )
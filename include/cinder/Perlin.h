@@ -24,9 +24,14 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Vector.h"
+#include "cinder/Channel.h"
 
 namespace cinder {
 
+namespace ip {
+	typedef std::shared_ptr<class ExecutionContext>	ExecutionContextRef;
+}
+
 class Perlin
 {
  public:
@@ -51,6 +56,14 @@ class Perlin
 	Vec3f	dfBm( const Vec3f &v ) const;
 	Vec3f	dfBm( float x, float y, float z ) const { return dfBm( Vec3f( x, y, z ) ); }
 
+	/// Batch fBm() and dfBm() of \a count positions, evaluated four at a time with SSE2 where available and split across the threads of \a context when one is supplied. Results match the single position versions.
+	void	fBm( const Vec2f *positions, float *results, size_t count, const ip::ExecutionContextRef &context = ip::ExecutionContextRef() ) const;
+	void	fBm( const Vec3f *positions, float *results, size_t count, const ip::ExecutionContextRef &context = ip::ExecutionContextRef() ) const;
+	void	dfBm( const Vec2f *positions, Vec2f *results, size_t count, const ip::ExecutionContextRef &context = ip::ExecutionContextRef() ) const;
+	void	dfBm( const Vec3f *positions, Vec3f *results, size_t count, const ip::ExecutionContextRef &context = ip::ExecutionContextRef() ) const;
+	/// Fills each pixel (x, y) of \a channel with fBm( offset + Vec2f( x, y ) * scale ), splitting its rows across the threads of \a context when one is supplied
+	void	fBm( Channel32f *channel, const Vec2f &offset = Vec2f::zero(), const Vec2f &scale = Vec2f::one(), const ip::ExecutionContextRef &context = ip::ExecutionContextRef() ) const;
+
 	/// Calculates a single octave of noise
 	float	noise( float x ) const;
 	float	noise( float x, float y ) const;
@@ -61,9 +74,20 @@ class Perlin
 	Vec2f	dnoise( float x, float y ) const;
 	Vec3f	dnoise( float x, float y, float z ) const;
 
+	/// Calculates a single octave of simplex noise, which is cheaper than noise() in 3D and scales to 4D. Values are roughly in the range [-1,1].
+	float	simplex( float x, float y ) const;
+	float	simplex( float x, float y, float z ) const;
+	float	simplex( float x, float y, float z, float w ) const;
+
  private:
 	void	initPermutationTable();
 
+	void	fBmBand2( const Vec2f *positions, float *results, const Area &band ) const;
+	void	fBmBand3( const Vec3f *positions, float *results, const Area &band ) const;
+	void	dfBmBand2( const Vec2f *positions, Vec2f *results, const Area &band ) const;
+	void	dfBmBand3( const Vec3f *positions, Vec3f *results, const Area &band ) const;
+	void	fBmChannelBand( Channel32f *channel, const Vec2f &offset, const Vec2f &scale, const Area &band ) const;
+
 	float grad( int32_t hash, float x ) const;
 	float grad( int32_t hash, float x, float y ) const;
 	float grad( int32_t hash, float x, float y, float z ) const;
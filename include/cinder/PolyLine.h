@@ -27,9 +27,14 @@
 
 namespace cinder {
 
+class Shape2d;
+
 template<typename T>
 class PolyLine {
   public:
+	//! Operations supported by calcBoolean()
+	enum BooleanOp { BOOLEAN_UNION, BOOLEAN_INTERSECTION, BOOLEAN_XOR, BOOLEAN_DIFFERENCE };
+
 	PolyLine() : mClosed( false ) {}
 	PolyLine( const std::vector<T> &aPoints ) : mPoints( aPoints ), mClosed( false ) {}
 	
@@ -68,6 +73,14 @@ class PolyLine {
 	static std::vector<PolyLine> 	calcXor( const std::vector<PolyLine> &a, std::vector<PolyLine> &b );
 	//! Calculates the boolean difference of \a a and \a b. Assumes the first PolyLine in the vector is the outermost and the (optional) others are holes.
 	static std::vector<PolyLine> 	calcDifference( const std::vector<PolyLine> &a, std::vector<PolyLine> &b );		
+
+	/** Calculates the boolean operation \a op of \a a and \a b with a single sweep-line pass, in O((n+k) log n) for n vertices and k intersections,
+		which is much faster than the functions above when the inputs intersect many times. Each vector is interpreted with the even-odd rule, so the
+		first-outermost convention of calcUnion() and its siblings works unchanged. Returns closed PolyLines, each outer contour (with a positive
+		signed area) followed by its holes (with a negative signed area). Stretches where more than two edges overlap are not supported. **/
+	static std::vector<PolyLine>	calcBoolean( BooleanOp op, const std::vector<PolyLine> &a, const std::vector<PolyLine> &b );
+	//! Same as calcBoolean(), but returns the result as a Shape2d of closed contours, ready for Triangulator or gl::draw()
+	static Shape2d					calcBooleanShape( BooleanOp op, const std::vector<PolyLine> &a, const std::vector<PolyLine> &b );
 	
   private:
 	std::vector<T>			mPoints;
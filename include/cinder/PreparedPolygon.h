@@ -0,0 +1,81 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Vector.h"
+#include "cinder/Rect.h"
+#include "cinder/PolyLine.h"
+#include "cinder/Path2d.h"
+#include "cinder/Shape2d.h"
+
+#include <vector>
+
+namespace cinder {
+
+/** \brief A polygon prepared for testing many points against it.
+ *  The edges are sorted into vertical slabs, so contains() only tests the few edges which overlap the point's slab, four at a time with SSE where available.
+ *  Results are identical to PolyLine2f::contains(), and for several contours to Shape2d::contains(): the even-odd rule, with every contour implicitly closed.
+ *  Paths are flattened with Path2d::subdivide() first, so their curves are approximated, while Path2d::contains() tests the curves exactly.
+ *  Building costs about as much as a few dozen calls to PolyLine2f::contains(), so prepare shapes which are tested against many points, such as geofences. **/
+class PreparedPolygon {
+  public:
+	PreparedPolygon() : mNumEdges( 0 ), mNumSlabs( 0 ), mSlabScale( 0 ) {}
+	//! Prepares \a polyLine, spreading its edges over \a numSlabs slabs or an automatic number when it's 0
+	explicit PreparedPolygon( const PolyLine2f &polyLine, size_t numSlabs = 0 );
+	//! Prepares the even-odd combination of \a contours
+	explicit PreparedPolygon( const std::vector<PolyLine2f> &contours, size_t numSlabs = 0 );
+	//! Prepares \a path, flattened with Path2d::subdivide( \a approximationScale )
+	explicit PreparedPolygon( const Path2d &path, float approximationScale = 1.0f, size_t numSlabs = 0 );
+	//! Prepares the contours of \a shape, each flattened with Path2d::subdivide( \a approximationScale )
+	explicit PreparedPolygon( const Shape2d &shape, float approximationScale = 1.0f, size_t numSlabs = 0 );
+	
+	//! Returns whether \a pt is inside the polygon
+	bool	contains( const Vec2f &pt ) const;
+	//! Sets \a results[i] to whether \a points[i] is inside the polygon, for \a count points
+	void	contains( const Vec2f *points, size_t count, bool *results ) const;
+	
+	//! Returns the bounding box of the polygon's vertices
+	const Rectf&	getBounds() const { return mBounds; }
+	//! Returns the number of edges, including the closing edge of each contour
+	size_t			getNumEdges() const { return mNumEdges; }
+	size_t			getNumSlabs() const { return mNumSlabs; }
+	
+  private:
+	void	addContour( const std::vector<Vec2f> &points, std::vector<Vec2f> *edges );
+	void	build( const std::vector<Vec2f> &edges, size_t numSlabs );
+	size_t	slabIndex( float x ) const;
+	
+	Rectf					mBounds;
+	size_t					mNumEdges, mNumSlabs;
+	float					mSlabScale;
+	//! Edges of slab \c s are [mSlabStarts[s], mSlabStarts[s+1]) in the arrays below, padded to a multiple of 4 with edges no point crosses
+	std::vector<uint32_t>	mSlabStarts;
+	// per edge: its x extent, its first point and its delta, in the form PolyLine2f::contains() evaluates
+	std::vector<float>		mMinX, mMaxX, mX0, mY0, mDx, mDy;
+};
+
+} // namespace cinder
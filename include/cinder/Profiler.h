@@ -0,0 +1,155 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/DataTarget.h"
+#include "cinder/MemoryTracker.h"
+#include "cinder/Thread.h"
+#include "cinder/Timer.h"
+
+#include <boost/noncopyable.hpp>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//! Records the time spent in the enclosing scope under \a name, which must be a string literal or otherwise outlive the Profiler. Compiled out if CINDER_PROFILE_DISABLE is defined.
+#if defined( CINDER_PROFILE_DISABLE )
+	#define CI_PROFILE_SCOPE( name )
+#else
+	#define CI_PROFILE_SCOPE( name )			CI_PROFILE_SCOPE_IMPL( name, __LINE__ )
+	#define CI_PROFILE_SCOPE_IMPL( name, line )	CI_PROFILE_SCOPE_IMPL2( name, line )
+	#define CI_PROFILE_SCOPE_IMPL2( name, line )	::cinder::ProfileScope ciProfileScope##line( name )
+#endif
+
+namespace cinder {
+
+/** \brief Lightweight instrumentation for catching hitches: scoped CPU markers, a ring of recent frame times with percentiles and a histogram, and export to Chrome's trace format.
+	Markers made with CI_PROFILE_SCOPE() are kept in a ring per thread, so recording never contends between threads and the most recent samples are always available.
+	App calls beginFrame() at the start of every frame. Load a trace written by writeChromeTrace() into chrome://tracing to inspect it. **/
+class Profiler : private boost::noncopyable {
+  public:
+	//! Returns the global Profiler
+	static Profiler&	get();
+
+	//! Sets whether markers are recorded. Defaults to \c true
+	void		enable( bool enable = true ) { mEnabled = enable; }
+	//! Returns whether markers are recorded
+	bool		isEnabled() const { return mEnabled; }
+	//! Returns the Profiler's clock in seconds, which starts when the Profiler is created
+	double		getSeconds() const { return mTimer.getSeconds(); }
+
+	//! Records a marker named \a name on the calling thread spanning \a startSeconds to \a endSeconds on the Profiler's clock
+	void		addSample( const char *name, double startSeconds, double endSeconds );
+	//! Names the calling thread in exported traces
+	void		setThreadName( const std::string &name );
+	//! Sets the number of markers kept per thread. Older ones are overwritten. Defaults to \c 65536
+	void		setNumSamplesPerThread( size_t numSamples );
+
+	//! Marks the start of a frame, recording the previous frame's duration and a "Frame" marker spanning it. While MemoryTracker is enabled, also samples its live bytes per category.
+	void		beginFrame();
+	//! Sets the number of recent frame times, and memory samples, kept. Defaults to \c 1024
+	void		setNumFrames( size_t numFrames );
+	//! Returns the number of frame times currently kept
+	size_t		getNumFrameTimes() const;
+	//! Returns the frame time in seconds below which \a percent percent of the recent frames fall, such as 50, 95 or 99
+	double		getFrameTimePercentile( double percent ) const;
+	//! Returns the longest recent frame time in seconds
+	double		getMaxFrameTime() const { return getFrameTimePercentile( 100 ); }
+	//! Returns the number of recent frames whose time falls into each of \a numBins equal bins between \c 0 and \a maxSeconds. Longer frames count towards the last bin.
+	std::vector<uint32_t>	getFrameTimeHistogram( size_t numBins, double maxSeconds ) const;
+
+	/** Records the one-time initialization \a name, such as a lazily initialized subsystem or the app's launch, spanning \a startSeconds to \a endSeconds.
+		It's also recorded as a marker. \a name must be a string literal or otherwise outlive the Profiler. **/
+	void		addInitialization( const char *name, double startSeconds, double endSeconds );
+	/** Writes every initialization recorded so far to \a os, one per line in the order they were recorded, with their durations and start times in milliseconds.
+		The Profiler's clock starts during static initialization, so the App's launch, setup() and first frame, which it records, read as time since the process started. **/
+	void		writeStartupReport( std::ostream &os ) const;
+
+	//! Writes every marker currently kept, of every thread, and the memory samples as a "Memory" counter to \a dataTarget in Chrome's trace event JSON format
+	void		writeChromeTrace( DataTargetRef dataTarget ) const;
+	//! Writes every marker currently kept, of every thread, and the memory samples as a "Memory" counter to the file at \a path in Chrome's trace event JSON format
+	void		writeChromeTrace( const fs::path &path ) const;
+	//! Discards all markers, frame times and memory samples
+	void		clear();
+
+  private:
+	Profiler();
+
+	struct Sample {
+		const char	*mName;
+		double		mStart, mEnd;
+	};
+
+	struct ThreadSamples {
+		std::mutex				mMutex; // only contended while exporting
+		std::vector<Sample>		mSamples;
+		size_t					mNext, mCount;
+		uint32_t				mThreadIndex;
+		std::string				mThreadName;
+	};
+
+	struct MemorySample {
+		double		mTime;
+		int64_t		mLiveBytes[MemoryTracker::NUM_CATEGORIES];
+	};
+
+	ThreadSamples*	getThreadSamples();
+
+	Timer										mTimer;
+	volatile bool								mEnabled;
+	mutable std::mutex							mMutex;
+	std::vector<std::shared_ptr<ThreadSamples> >	mThreads;
+	size_t										mNumSamplesPerThread;
+
+	std::vector<Sample>							mInitializations;
+
+	mutable std::mutex							mFrameMutex;
+	std::vector<double>							mFrameTimes;
+	size_t										mNextFrame, mNumFrameTimes;
+	double										mFrameStart;
+	std::vector<MemorySample>					mMemorySamples;
+	size_t										mNextMemorySample, mNumMemorySamples;
+};
+
+//! Records the time between its construction and destruction as a marker. Usually created with CI_PROFILE_SCOPE()
+class ProfileScope : private boost::noncopyable {
+  public:
+	explicit ProfileScope( const char *name )
+		: mName( name ), mStart( Profiler::get().isEnabled() ? Profiler::get().getSeconds() : -1 )
+	{}
+	~ProfileScope()
+	{
+		if( mStart >= 0 )
+			Profiler::get().addSample( mName, mStart, Profiler::get().getSeconds() );
+	}
+
+  private:
+	const char	*mName;
+	double		mStart;
+};
+
+} // namespace cinder
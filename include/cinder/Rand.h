@@ -36,6 +36,10 @@
 #include "cinder/Vector.h"
 
 namespace cinder {	
+
+namespace ip {
+	typedef std::shared_ptr<class ExecutionContext>	ExecutionContextRef;
+}
 	
 class Rand {
  public:
@@ -269,6 +273,149 @@ private:
 	static boost::variate_generator<boost::mt19937&, boost::uniform_int<> > sIntGen;
 };
 
+/** \brief Small, fast random generator based on PCG32, for hot loops and parallel simulations
+ *
+ * Unlike Rand, a RandPcg carries only 16 bytes of state and can be copied freely. Each instance is
+ * an independent stream selected by \a stream at seeding time, so a parallel simulation can give each
+ * thread (or better, each fixed work item) RandPcg( seed, index ) and stay reproducible from run to run.
+ * A single RandPcg is not thread-safe; use one per thread. **/
+class RandPcg {
+ public:
+	RandPcg( uint64_t seedValue = 214u, uint64_t stream = 0 )
+	{
+		seed( seedValue, stream );
+	}
+
+	//! Re-seeds the generator with \a seedValue, selecting the independent sequence \a stream
+	void seed( uint64_t seedValue, uint64_t stream = 0 );
+	//! Skips the next \a delta values in O(log delta), as if nextUint32() had been called \a delta times
+	void advance( uint64_t delta );
+
+	//! returns a random integer in the range [0,4294967295]
+	uint32_t nextUint32()
+	{
+		uint64_t oldState = mState;
+		mState = oldState * 6364136223846793005ULL + mInc;
+		uint32_t xorShifted = (uint32_t)( ( ( oldState >> 18u ) ^ oldState ) >> 27u );
+		uint32_t rot = (uint32_t)( oldState >> 59u );
+		return ( xorShifted >> rot ) | ( xorShifted << ( ( 32 - rot ) & 31 ) );
+	}
+
+	//! returns a random boolean value
+	bool nextBool()
+	{
+		return ( nextUint32() >> 31 ) != 0;
+	}
+
+	//! returns a random integer in the range [0,2147483647]
+	int32_t nextInt()
+	{
+		return (int32_t)( nextUint32() >> 1 );
+	}
+
+	//! returns a random integer in the range [0,v), or 0 when \a v is not positive
+	int32_t nextInt( int32_t v )
+	{
+		if( v <= 0 ) return 0;
+		return (int32_t)( ( (uint64_t)nextUint32() * (uint32_t)v ) >> 32 );
+	}
+
+	//! returns a random integer in the range [a,b)
+	int32_t nextInt( int32_t a, int32_t b )
+	{
+		return nextInt( b - a ) + a;
+	}
+
+	//! returns a random float in the range [0.0f,1.0f)
+	float nextFloat()
+	{
+		return ( nextUint32() >> 8 ) * ( 1.0f / 16777216.0f );
+	}
+
+	//! returns a random float in the range [0.0f,v)
+	float nextFloat( float v )
+	{
+		return nextFloat() * v;
+	}
+
+	//! returns a random float in the range [a,b)
+	float nextFloat( float a, float b )
+	{
+		return nextFloat() * ( b - a ) + a;
+	}
+
+	//! returns a random float in the range [a,b) or the range (-b,-a]
+	float posNegFloat( float a, float b )
+	{
+		if( nextBool() )
+			return nextFloat( a, b );
+		else
+			return -nextFloat( a, b );
+	}
+
+	//! returns a random Vec3f that represents a point on the unit sphere
+	Vec3f nextVec3f()
+	{
+		float phi = nextFloat( (float)M_PI * 2.0f );
+		float costheta = nextFloat( -1.0f, 1.0f );
+
+		float rho = math<float>::sqrt( 1.0f - costheta * costheta );
+		return Vec3f( rho * math<float>::cos( phi ), rho * math<float>::sin( phi ), costheta );
+	}
+
+	//! returns a random Vec2f that represents a point on the unit circle
+	Vec2f nextVec2f()
+	{
+		float theta = nextFloat( (float)M_PI * 2.0f );
+		return Vec2f( math<float>::cos( theta ), math<float>::sin( theta ) );
+	}
+
+	//! returns a random float via Gaussian distribution
+	float nextGaussian();
+
+	//! fills \a result with \a count random floats in the range [0.0f,1.0f)
+	void nextFloats( float *result, size_t count )
+	{
+		for( size_t i = 0; i < count; ++i )
+			result[i] = nextFloat();
+	}
+
+	//! fills \a result with \a count random floats in the range [a,b)
+	void nextFloats( float *result, size_t count, float a, float b )
+	{
+		for( size_t i = 0; i < count; ++i )
+			result[i] = nextFloat( a, b );
+	}
+
+	//! fills \a result with \a count random points on the unit sphere
+	void nextVec3fs( Vec3f *result, size_t count )
+	{
+		for( size_t i = 0; i < count; ++i )
+			result[i] = nextVec3f();
+	}
+
+	//! fills \a result with \a count random points on the unit circle
+	void nextVec2fs( Vec2f *result, size_t count )
+	{
+		for( size_t i = 0; i < count; ++i )
+			result[i] = nextVec2f();
+	}
+
+	/** Fills \a result with \a count random floats in the range [a,b), split across the threads of \a context.
+	 *  Each band starts from a copy of this generator advanced to its first element, so the results and the
+	 *  generator's state afterwards are identical to the serial call regardless of the thread count. **/
+	void nextFloats( float *result, size_t count, float a, float b, const ip::ExecutionContextRef &context );
+	//! Fills \a result with \a count random points on the unit sphere, split across the threads of \a context with the same results as the serial call
+	void nextVec3fs( Vec3f *result, size_t count, const ip::ExecutionContextRef &context );
+	//! Fills \a result with \a count random points on the unit circle, split across the threads of \a context with the same results as the serial call
+	void nextVec2fs( Vec2f *result, size_t count, const ip::ExecutionContextRef &context );
+
+ private:
+	uint64_t	mState, mInc;
+	float		mNextNextGaussian;
+	bool		mHaveNextNextGaussian;
+};
+
 //! Resets the static random generator to the specific seed \a seedValue
 inline void randSeed( uint32_t seedValue ) { Rand::randSeed( seedValue ); }
 
@@ -24,6 +24,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Exception.h"
+#include "cinder/Function.h"
 
 #include <string>
 #include <vector>
@@ -90,8 +91,29 @@ class Serial {
 	void	flush( bool input = true, bool output = true );
 	//! Returns the number of bytes available for reading from the device
 	size_t	getNumBytesAvailable() const;
+
+	/** \brief Starts a background thread which reads from the device continuously, so neither reads nor writes wait on it.
+		Incoming bytes go to the line or packet callback when one is set, and otherwise to a ring buffer of \a bufferSize bytes, which readBytes(), readAvailableBytes(), getNumBytesAvailable()
+		and the functions built on them read from instead of the device. When the ring buffer is full the oldest bytes are dropped, which getNumBytesDropped() counts.
+		writeBytes() and the functions built on it queue their data for the thread to write. **/
+	void	startAsync( size_t bufferSize = 262144 );
+	//! Stops the thread started by startAsync() after it has written any queued bytes. Bytes left unread in the ring buffer are discarded.
+	void	stopAsync();
+	//! Returns whether a background thread started by startAsync() is reading from the device
+	bool	isAsync() const;
+	/** Sets a function to be called in async mode with each line of text received, without its terminating \a delimiter, instead of buffering it. The function is called on the background thread.
+		A line which fills the ring buffer's size without a delimiter is passed on as is. An empty function removes the callback. **/
+	void	setLineCallback( const std::function<void (const std::string&)> &lineFn, char delimiter = '\n' );
+	//! Sets a function to be called in async mode with each \a packetSize bytes received instead of buffering them. The function is called on the background thread. An empty function removes the callback.
+	void	setPacketCallback( size_t packetSize, const std::function<void (const uint8_t*, size_t)> &packetFn );
+	//! Returns the number of bytes dropped in async mode because the ring buffer was full
+	size_t	getNumBytesDropped() const;
+	//! Returns the number of bytes queued in async mode which have not been written to the device yet
+	size_t	getNumBytesQueued() const;
 	
   protected:
+	struct Async;
+
 	struct Obj {
 		Obj();
 		Obj( const Serial::Device &device, int baudRate );
@@ -106,6 +128,7 @@ class Serial {
 		int				mFd;
 		::termios		mSavedOptions;
 #endif	
+		std::shared_ptr<Async>	mAsync;
 	};
 	
 	std::shared_ptr<Obj>		mObj;
@@ -0,0 +1,402 @@
+/*
+ Copyright (c) 2009, The Barbarian Group
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Vector.h"
+#include "cinder/KdTree.h"
+
+#include <vector>
+#include <float.h>
+#include <algorithm>
+#include <utility>
+
+namespace cinder {
+
+/** \brief Uniform grid over 2D or 3D points, hashed into a fixed number of buckets, for points which move every frame.
+ *  Unlike KdTree, points can be inserted, moved and removed individually in constant time, so a simulation can call
+ *  update() for each agent as it moves instead of rebuilding. The queries match KdTree's, so the two are interchangeable.
+ *  Each bucket stores its points' coordinates inline and contiguously, so a neighborhood query walks a few short arrays.
+ *  Queries are fastest when \a cellSize is close to the typical query radius. **/
+template <typename NodeData, unsigned char K=3, class LookupProc = NullLookupProc> class SpatialHash {
+  public:
+	//! Creates an empty hash of cells \a cellSize wide on each axis, spread over \a numBuckets buckets (rounded up to a power of two)
+	SpatialHash( float cellSize = 1.0f, uint32_t numBuckets = 4096 );
+	//! Creates a hash holding \a data, where point \c i is inserted with index \c i
+	template<typename NodeDataVector>
+	SpatialHash( const NodeDataVector &data, float cellSize, uint32_t numBuckets = 4096 );
+
+	//! Replaces the contents of the hash with \a d, where point \c i is inserted with index \c i
+	template<typename NodeDataVector>
+	void initialize( const NodeDataVector &d );
+	//! Removes every point, keeping the buckets' memory for reuse
+	void clear();
+
+	//! Adds the point \a p as \a index, or moves it if \a index is already present
+	void insert( uint32_t index, const NodeData &p );
+	//! Moves the point \a index to \a p, inserting it if it isn't present
+	void update( uint32_t index, const NodeData &p ) { insert( index, p ); }
+	//! Removes the point \a index if it is present
+	void remove( uint32_t index );
+	//! Returns whether the point \a index is present
+	bool contains( uint32_t index ) const { return ( index < mLocations.size() ) && ( mLocations[index].bucket != INVALID ); }
+
+	//! Returns the number of points in the hash
+	uint32_t	getSize() const { return mSize; }
+	//! Returns the width of a cell
+	float		getCellSize() const { return mCellSize; }
+
+	void lookup( const NodeData &p, const LookupProc &process, float maxDist ) const;
+	void findNearest( const float p[K], float result[K], uint32_t *resultIndex ) const;
+	/** Replaces the contents of \a resultIndices with the indices of the \a k points nearest to \a p, nearest first. Fewer are returned when the hash holds fewer than \a k points.
+	 *  When \a resultDistancesSquared is non-NULL it receives the matching squared distances. **/
+	void findKNearest( const float p[K], uint32_t k, std::vector<uint32_t> *resultIndices, std::vector<float> *resultDistancesSquared = NULL ) const;
+	/** Replaces the contents of \a resultIndices with the indices of every point closer to \a p than \a radius, in no particular order.
+	 *  When \a resultDistancesSquared is non-NULL it receives the matching squared distances. **/
+	void findInRadius( const float p[K], float radius, std::vector<uint32_t> *resultIndices, std::vector<float> *resultDistancesSquared = NULL ) const;
+
+  private:
+	static const uint32_t INVALID = 0xFFFFFFFF;
+
+	struct Entry {
+		float		pos[K];
+		uint32_t	index;
+	};
+	struct Location {
+		uint32_t	bucket, slot;
+	};
+	typedef std::pair<float,uint32_t>	DistanceIndex;
+
+	int32_t		cellCoord( float v ) const { return (int32_t)math<float>::floor( v * mInvCellSize ); }
+	uint32_t	hashCell( const int32_t cell[K] ) const;
+	bool		isInCell( const Entry &entry, const int32_t cell[K] ) const;
+	float		distanceSquared( const Entry &entry, const float p[K] ) const;
+	void		cellRange( const float p[K], float radius, int32_t lo[K], int32_t hi[K] ) const;
+	bool		nextCell( int32_t cell[K], const int32_t lo[K], const int32_t hi[K] ) const;
+
+	float								mCellSize, mInvCellSize;
+	uint32_t							mBucketMask, mSize;
+	std::vector<std::vector<Entry> >	mBuckets;
+	std::vector<Location>				mLocations;
+	// the range of cells which have held a point since the last clear(), which bounds the nearest neighbor searches
+	int32_t								mCellMin[K], mCellMax[K];
+};
+
+// SpatialHash Method Definitions
+template<typename NodeData, unsigned char K, typename LookupProc>
+SpatialHash<NodeData, K, LookupProc>::SpatialHash( float cellSize, uint32_t numBuckets )
+	: mCellSize( cellSize ), mInvCellSize( 1.0f / cellSize )
+{
+	uint32_t size = 1;
+	while( size < numBuckets )
+		size <<= 1;
+	mBucketMask = size - 1;
+	mBuckets.resize( size );
+	clear();
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+ template<typename NodeDataVector>
+SpatialHash<NodeData, K, LookupProc>::SpatialHash( const NodeDataVector &data, float cellSize, uint32_t numBuckets )
+	: mCellSize( cellSize ), mInvCellSize( 1.0f / cellSize )
+{
+	uint32_t size = 1;
+	while( size < numBuckets )
+		size <<= 1;
+	mBucketMask = size - 1;
+	mBuckets.resize( size );
+	initialize( data );
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+ template<typename NodeDataVector>
+void SpatialHash<NodeData, K, LookupProc>::initialize( const NodeDataVector &d )
+{
+	clear();
+	uint32_t size = NodeDataVectorTraits<NodeDataVector>::getSize( d );
+	mLocations.reserve( size );
+	for( uint32_t i = 0; i < size; ++i )
+		insert( i, d[i] );
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void SpatialHash<NodeData, K, LookupProc>::clear()
+{
+	for( size_t b = 0; b < mBuckets.size(); ++b )
+		mBuckets[b].clear();
+	mLocations.clear();
+	mSize = 0;
+	for( unsigned char k = 0; k < K; ++k ) {
+		mCellMin[k] = std::numeric_limits<int32_t>::max();
+		mCellMax[k] = std::numeric_limits<int32_t>::min();
+	}
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void SpatialHash<NodeData, K, LookupProc>::insert( uint32_t index, const NodeData &p )
+{
+	Entry entry;
+	int32_t cell[K];
+	for( unsigned char k = 0; k < K; ++k ) {
+		entry.pos[k] = NodeDataTraits<NodeData>::getAxis( p, k );
+		cell[k] = cellCoord( entry.pos[k] );
+		mCellMin[k] = std::min( mCellMin[k], cell[k] );
+		mCellMax[k] = std::max( mCellMax[k], cell[k] );
+	}
+	entry.index = index;
+	uint32_t bucket = hashCell( cell );
+
+	if( index >= mLocations.size() ) {
+		Location invalid = { INVALID, INVALID };
+		mLocations.resize( index + 1, invalid );
+	}
+	Location &location = mLocations[index];
+	if( location.bucket == bucket ) {
+		// the common case of a point moving within its cell, or to another cell in the same bucket
+		mBuckets[bucket][location.slot] = entry;
+		return;
+	}
+	if( location.bucket != INVALID )
+		remove( index );
+	++mSize;
+	location.bucket = bucket;
+	location.slot = (uint32_t)mBuckets[bucket].size();
+	mBuckets[bucket].push_back( entry );
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void SpatialHash<NodeData, K, LookupProc>::remove( uint32_t index )
+{
+	if( ! contains( index ) )
+		return;
+	Location &location = mLocations[index];
+	std::vector<Entry> &bucket = mBuckets[location.bucket];
+	// swap the bucket's last entry into the vacated slot
+	bucket[location.slot] = bucket.back();
+	mLocations[bucket.back().index].slot = location.slot;
+	bucket.pop_back();
+	location.bucket = location.slot = INVALID;
+	--mSize;
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+uint32_t SpatialHash<NodeData, K, LookupProc>::hashCell( const int32_t cell[K] ) const
+{
+	static const uint32_t primes[3] = { 73856093u, 19349663u, 83492791u };
+	uint32_t result = 0;
+	for( unsigned char k = 0; k < K; ++k )
+		result ^= (uint32_t)cell[k] * primes[k];
+	return result & mBucketMask;
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+bool SpatialHash<NodeData, K, LookupProc>::isInCell( const Entry &entry, const int32_t cell[K] ) const
+{
+	for( unsigned char k = 0; k < K; ++k ) {
+		if( cellCoord( entry.pos[k] ) != cell[k] )
+			return false;
+	}
+	return true;
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+float SpatialHash<NodeData, K, LookupProc>::distanceSquared( const Entry &entry, const float p[K] ) const
+{
+	float distSqr = 0.0f;
+	for( unsigned char k = 0; k < K; ++k ) {
+		float v = entry.pos[k] - p[k];
+		distSqr += v * v;
+	}
+	return distSqr;
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void SpatialHash<NodeData, K, LookupProc>::cellRange( const float p[K], float radius, int32_t lo[K], int32_t hi[K] ) const
+{
+	// clamp to the occupied cells; a cell outside of them can only hash to a bucket holding other cells' points
+	for( unsigned char k = 0; k < K; ++k ) {
+		lo[k] = std::max( cellCoord( p[k] - radius ), mCellMin[k] );
+		hi[k] = std::min( cellCoord( p[k] + radius ), mCellMax[k] );
+	}
+}
+
+// advances \a cell to the next cell of the box [lo,hi], returning false once the whole box has been visited
+template<typename NodeData, unsigned char K, typename LookupProc>
+bool SpatialHash<NodeData, K, LookupProc>::nextCell( int32_t cell[K], const int32_t lo[K], const int32_t hi[K] ) const
+{
+	for( unsigned char k = 0; k < K; ++k ) {
+		if( ++cell[k] <= hi[k] )
+			return true;
+		cell[k] = lo[k];
+	}
+	return false;
+}
+
+template<typename NodeData, unsigned char K, typename LookupProc>
+void SpatialHash<NodeData, K, LookupProc>::lookup( const NodeData &p, const LookupProc &process, float maxDist ) const
+{
+	float pt[K];
+	for( unsigned char k = 0; k < K; ++k )
+		pt[k] = NodeDataTraits<NodeData>::getAxis( p, k );
+
+	float maxDistSquared = maxDist * maxDist;
+	int32_t lo[K], hi[K], cell[K];
+	cellRange( pt, maxDist, lo, hi );
+	for( unsigned char k = 0; k < K; ++k ) {
+		if( lo[k] > hi[k] )
+			return;
+		cell[k] = lo[k];
+	}
+	do {
+		const std::vector<Entry> &bucket = mBuckets[hashCell( cell )];
+		for( size_t e = 0; e < bucket.size(); ++e ) {
+			float distSqr = distanceSquared( bucket[e], pt );
+			if( ( distSqr < maxDistSquared ) && isInCell( bucket[e], cell ) )
+				process.process( bucket[e].index, distSqr, maxDistSquared );
+		}
+	} while( nextCell( cell, lo, hi ) );
+}
+
+// Find In Radius
+template<typename NodeData, unsigned char K, typename LookupProc>
+void SpatialHash<NodeData, K, LookupProc>::findInRadius( const float p[K], float radius, std::vector<uint32_t> *resultIndices, std::vector<float> *resultDistancesSquared ) const
+{
+	resultIndices->clear();
+	if( resultDistancesSquared )
+		resultDistancesSquared->clear();
+
+	float maxDistSquared = radius * radius;
+	int32_t lo[K], hi[K], cell[K];
+	cellRange( p, radius, lo, hi );
+	for( unsigned char k = 0; k < K; ++k ) {
+		if( lo[k] > hi[k] )
+			return;
+		cell[k] = lo[k];
+	}
+	do {
+		const std::vector<Entry> &bucket = mBuckets[hashCell( cell )];
+		for( size_t e = 0; e < bucket.size(); ++e ) {
+			float distSqr = distanceSquared( bucket[e], p );
+			if( ( distSqr < maxDistSquared ) && isInCell( bucket[e], cell ) ) {
+				resultIndices->push_back( bucket[e].index );
+				if( resultDistancesSquared )
+					resultDistancesSquared->push_back( distSqr );
+			}
+		}
+	} while( nextCell( cell, lo, hi ) );
+}
+
+// Find Nearest
+template<typename NodeData, unsigned char K, typename LookupProc>
+void SpatialHash<NodeData, K, LookupProc>::findNearest( const float p[K], float result[K], uint32_t *resultIndex ) const
+{
+	std::vector<uint32_t> indices;
+	*resultIndex = -1;
+	findKNearest( p, 1, &indices );
+	if( ! indices.empty() ) {
+		*resultIndex = indices[0];
+		const Location &location = mLocations[indices[0]];
+		for( unsigned char k = 0; k < K; ++k )
+			result[k] = mBuckets[location.bucket][location.slot].pos[k];
+	}
+}
+
+// Find K Nearest
+template<typename NodeData, unsigned char K, typename LookupProc>
+void SpatialHash<NodeData, K, LookupProc>::findKNearest( const float p[K], uint32_t k, std::vector<uint32_t> *resultIndices, std::vector<float> *resultDistancesSquared ) const
+{
+	// a max-heap of the best k candidates so far, as in KdTree::findKNearest()
+	std::vector<DistanceIndex> heap;
+	heap.reserve( std::min( k, mSize ) );
+	float maxDistSquared = FLT_MAX;
+
+	if( ( mSize > 0 ) && ( k > 0 ) ) {
+		// search shells of cells at increasing distance from p's cell, starting at the first one which reaches the occupied cells
+		int32_t center[K];
+		int32_t ring = 0;
+		for( unsigned char a = 0; a < K; ++a ) {
+			center[a] = cellCoord( p[a] );
+			ring = std::max( ring, std::max( mCellMin[a] - center[a], center[a] - mCellMax[a] ) );
+		}
+		while( true ) {
+			int32_t lo[K], hi[K], cell[K];
+			bool coversAll = true;
+			for( unsigned char a = 0; a < K; ++a ) {
+				lo[a] = center[a] - ring;
+				hi[a] = center[a] + ring;
+				coversAll = coversAll && ( lo[a] <= mCellMin[a] ) && ( hi[a] >= mCellMax[a] );
+				cell[a] = lo[a];
+			}
+			do {
+				bool onShell = false, occupied = true;
+				for( unsigned char a = 0; a < K; ++a ) {
+					onShell = onShell || ( cell[a] == lo[a] ) || ( cell[a] == hi[a] );
+					occupied = occupied && ( cell[a] >= mCellMin[a] ) && ( cell[a] <= mCellMax[a] );
+				}
+				if( ! ( onShell && occupied ) )
+					continue;
+				const std::vector<Entry> &bucket = mBuckets[hashCell( cell )];
+				for( size_t e = 0; e < bucket.size(); ++e ) {
+					float distSqr = distanceSquared( bucket[e], p );
+					if( ( ( heap.size() < k ) || ( distSqr < maxDistSquared ) ) && isInCell( bucket[e], cell ) ) {
+						if( heap.size() == k ) {
+							std::pop_heap( heap.begin(), heap.end() );
+							heap.back() = DistanceIndex( distSqr, bucket[e].index );
+						}
+						else
+							heap.push_back( DistanceIndex( distSqr, bucket[e].index ) );
+						std::push_heap( heap.begin(), heap.end() );
+						if( heap.size() == k )
+							maxDistSquared = heap.front().first;
+					}
+				}
+			} while( nextCell( cell, lo, hi ) );
+
+			if( coversAll )
+				break;
+			// every point not yet visited lies outside the box of shells searched so far
+			if( heap.size() == k ) {
+				float boxDist = FLT_MAX;
+				for( unsigned char a = 0; a < K; ++a ) {
+					boxDist = std::min( boxDist, p[a] - lo[a] * mCellSize );
+					boxDist = std::min( boxDist, ( hi[a] + 1 ) * mCellSize - p[a] );
+				}
+				if( maxDistSquared <= boxDist * boxDist )
+					break;
+			}
+			++ring;
+		}
+	}
+
+	std::sort_heap( heap.begin(), heap.end() );
+	resultIndices->resize( heap.size() );
+	for( size_t i = 0; i < heap.size(); ++i )
+		(*resultIndices)[i] = heap[i].second;
+	if( resultDistancesSquared ) {
+		resultDistancesSquared->resize( heap.size() );
+		for( size_t i = 0; i < heap.size(); ++i )
+			(*resultDistancesSquared)[i] = heap[i].first;
+	}
+}
+
+} // namespace cinder
@@ -92,6 +92,15 @@ class OStream : public virtual StreamBase {
 	void		writeBig( T t );
 	template<typename T>
 	void		writeLittle( T t );
+	//! Writes the \a count values at \a t in \a endian byte order in one call
+	template<typename T>
+	void		writeEndian( const T *t, size_t count, uint8_t endian ) { if ( endian == STREAM_BIG_ENDIAN ) writeBig( t, count ); else writeLittle( t, count ); }
+	//! Writes the \a count values at \a t in big endian byte order in one call
+	template<typename T>
+	void		writeBig( const T *t, size_t count );
+	//! Writes the \a count values at \a t in little endian byte order in one call
+	template<typename T>
+	void		writeLittle( const T *t, size_t count );
 
 	void		write( const Buffer &buffer );
 	void		writeData( const void *src, size_t size );
@@ -117,6 +126,15 @@ class IStream : public virtual StreamBase {
 	void		readBig( T *t );
 	template<typename T>
 	void		readLittle( T *t );
+	//! Reads \a count values stored in \a endian byte order into \a t with a single read, swapping them in place when necessary
+	template<typename T>
+	void		readEndian( T *t, size_t count, uint8_t endian ) { if ( endian == STREAM_BIG_ENDIAN ) readBig( t, count ); else readLittle( t, count ); }
+	//! Reads \a count big endian values into \a t with a single read, swapping them in place on little endian platforms
+	template<typename T>
+	void		readBig( T *t, size_t count );
+	//! Reads \a count little endian values into \a t with a single read, swapping them in place on big endian platforms
+	template<typename T>
+	void		readLittle( T *t, size_t count );
 
 	//! Reads characters until a null terminator
 	void		read( std::string *s );
@@ -153,8 +171,8 @@ typedef std::shared_ptr<class IStreamFile>	IStreamFileRef;
 
 class IStreamFile : public IStream {
  public:
-	//! Creates a new IStreamFileRef from a C-style file pointer \a FILE as returned by fopen(). If \a ownsFile the returned stream will destroy the stream upon its own destruction.
-	static IStreamFileRef create( FILE *file, bool ownsFile = true, int32_t defaultBufferSize = 2048 );
+	//! Creates a new IStreamFileRef from a C-style file pointer \a FILE as returned by fopen(). If \a ownsFile the returned stream will destroy the stream upon its own destruction. Reads smaller than \a defaultBufferSize bytes are served from a buffer of that size.
+	static IStreamFileRef create( FILE *file, bool ownsFile = true, int32_t defaultBufferSize = 65536 );
 	~IStreamFile();
 
 	size_t		readDataAvailable( void *dest, size_t maxSize );
@@ -168,11 +186,22 @@ class IStreamFile : public IStream {
 	
 	FILE*		getFILE() { return mFile; }
 
+	//! Enables a background thread which reads the next buffer of the file while the current one is consumed, which speeds up large sequential reads of regular files. A seek away from the block read ahead discards it.
+	void		setReadahead( bool enable = true );
+	//! Returns whether the stream reads ahead on a background thread
+	bool		isReadaheadEnabled() const { return mReadahead.get() != 0; }
+
  protected:
-	IStreamFile( FILE *aFile, bool aOwnsFile = true, int32_t aDefaultBufferSize = 2048 );
+	IStreamFile( FILE *aFile, bool aOwnsFile = true, int32_t aDefaultBufferSize = 65536 );
 
 	virtual void		IORead( void *t, size_t size );
 	size_t				readDataImpl( void *dest, size_t maxSize );
+	//! Refills the buffer with the block starting at mBufferOffset
+	void				fillBuffer();
+	//! Waits until the readahead thread is idle, so that \a mFile may be used
+	void				waitForReadahead() const;
+
+	struct Readahead;
  
 	FILE						*mFile;
 	bool						mOwnsFile;
@@ -182,6 +211,7 @@ class IStreamFile : public IStream {
 	off_t						mBufferFileOffset; // beginning of the buffer in the file
 	mutable off_t				mSize;
 	mutable bool				mSizeCached;
+	std::shared_ptr<Readahead>	mReadahead;
 };
 
 
@@ -189,8 +219,8 @@ typedef std::shared_ptr<class OStreamFile>	OStreamFileRef;
 
 class OStreamFile : public OStream {
   public:
-	//! Creates a new OStreamFileRef from a C-style file pointer \a FILE as returned by fopen(). If \a ownsFile the returned stream will destroy the stream upon its own destruction.
-	static OStreamFileRef	create( FILE *file, bool ownsFile = true );
+	//! Creates a new OStreamFileRef from a C-style file pointer \a FILE as returned by fopen(). If \a ownsFile the returned stream will destroy the stream upon its own destruction. A nonzero \a bufferSize replaces the C library's write buffer with one of \a bufferSize bytes, and requires that nothing has been written to \a file yet.
+	static OStreamFileRef	create( FILE *file, bool ownsFile = true, size_t bufferSize = 0 );
 	~OStreamFile();
 
 	virtual off_t		tell() const;
@@ -201,7 +231,7 @@ class OStreamFile : public OStream {
 
 	
   protected:
-	OStreamFile( FILE *aFile, bool aOwnsFile = true );
+	OStreamFile( FILE *aFile, bool aOwnsFile = true, size_t aBufferSize = 0 );
 
 	virtual void		IOWrite( const void *t, size_t size );
 
@@ -210,12 +240,76 @@ class OStreamFile : public OStream {
 };
 
 
+typedef std::shared_ptr<class OStreamFileAsync>	OStreamFileAsyncRef;
+
+/** An OStream to a file which copies writes into a queue of large aligned blocks, written to the file by a background thread.
+	A slow or stalling disk only blocks the writer once the queue is full. Seeking is allowed, and starts a new block. **/
+class OStreamFileAsync : public OStream {
+  public:
+	class Format {
+	  public:
+		Format() : mBlockSize( 1 << 20 ), mMaxBlocks( 8 ), mUnbuffered( false ) {}
+
+		//! Sets the size of the blocks writes are gathered into, rounded up to a multiple of 4096 bytes. Defaults to 1MB
+		Format&		blockSize( size_t size ) { mBlockSize = size; return *this; }
+		size_t		getBlockSize() const { return mBlockSize; }
+		//! Sets the number of blocks which may wait to be written before writes block. Defaults to \c 8
+		Format&		maxBlocks( size_t blocks ) { mMaxBlocks = blocks; return *this; }
+		size_t		getMaxBlocks() const { return mMaxBlocks; }
+		/** Sets whether blocks bypass the operating system's file cache. Default \c false. Uses O_DIRECT on Linux, F_NOCACHE on Mac OS X and FILE_FLAG_NO_BUFFERING on Windows.
+			This keeps long captures from evicting everything else from the cache. Writes that aren't whole blocks at aligned offsets, such as the last one, still go through the cache. **/
+		Format&		unbuffered( bool unbuffered = true ) { mUnbuffered = unbuffered; return *this; }
+		bool		isUnbuffered() const { return mUnbuffered; }
+
+	  protected:
+		size_t		mBlockSize, mMaxBlocks;
+		bool		mUnbuffered;
+	};
+
+	//! Creates the file at \a path, replacing any existing file, and returns a stream writing to it. Returns a NULL OStreamFileAsyncRef if the file can't be created.
+	static OStreamFileAsyncRef	create( const fs::path &path, const Format &format = Format() );
+	//! Closes the stream and ignores errors. Call close() first to learn whether every write succeeded.
+	~OStreamFileAsync();
+
+	//! Returns the offset the next write lands at
+	virtual off_t		tell() const { return mOffset; }
+	virtual void		seekAbsolute( off_t absoluteOffset );
+	virtual void		seekRelative( off_t relativeOffset );
+
+	//! Waits until every write so far has been handed to the operating system. Throws StreamExc if any of them failed.
+	void		flush();
+	//! Flushes, then waits until the operating system has committed the file to disk with fsync() or FlushFileBuffers()
+	void		sync();
+	//! Flushes, syncs and closes the file. Throws StreamExc if any write failed. Writing after close() throws as well.
+	void		close();
+	//! Returns the number of blocks waiting to be written
+	size_t		getBacklog() const;
+	const Format&	getFormat() const { return mFormat; }
+
+  protected:
+	OStreamFileAsync( const Format &format );
+
+	virtual void		IOWrite( const void *t, size_t size );
+	//! Queues the block being filled, if it holds anything
+	void				submitBlock();
+
+	struct Writer;
+
+	Format						mFormat;
+	std::shared_ptr<Writer>		mWriter;
+	uint8_t						*mBlock;		// the block being filled, NULL until the next write
+	size_t						mBlockSize;		// bytes written to mBlock
+	off_t						mBlockOffset;	// offset of mBlock in the file
+	off_t						mOffset, mEnd;	// the stream's position and the end of the file
+};
+
+
 typedef std::shared_ptr<class IoStreamFile>		IoStreamFileRef;
 
 class IoStreamFile : public IoStream {
  public:
 	//! Creates a new IoStreamFileRef from a C-style file pointer \a FILE as returned by fopen(). If \a ownsFile the returned stream will destroy the stream upon its own destruction.
-	static IoStreamFileRef create( FILE *file, bool ownsFile = true, int32_t defaultBufferSize = 2048 );
+	static IoStreamFileRef create( FILE *file, bool ownsFile = true, int32_t defaultBufferSize = 65536 );
 	~IoStreamFile();
 
 	size_t		readDataAvailable( void *dest, size_t maxSize );
@@ -230,7 +324,7 @@ class IoStreamFile : public IoStream {
 	FILE*		getFILE() { return mFile; }
 
  protected:
-	IoStreamFile( FILE *aFile, bool aOwnsFile = true, int32_t aDefaultBufferSize = 2048 );
+	IoStreamFile( FILE *aFile, bool aOwnsFile = true, int32_t aDefaultBufferSize = 65536 );
 	
 	virtual void		IORead( void *t, size_t size );
 	size_t				readDataImpl( void *dest, size_t maxSize );
@@ -280,28 +374,51 @@ class IStreamMem : public IStream {
 };
 
 
+typedef std::shared_ptr<class IStreamMmap>	IStreamMmapRef;
+//! An IStream over a file mapped into memory read-only, using mmap() or MapViewOfFile(). Reads are plain copies out of the mapping with no intermediate buffering.
+class IStreamMmap : public IStreamMem {
+ public:
+	//! Maps the file at \a path and returns a stream over it, or a NULL IStreamMmapRef if the file can't be mapped (for example when it is empty)
+	static IStreamMmapRef	create( const fs::path &path );
+	//! Creates a stream over the \a size bytes of an existing mapping \a mapping, as returned by mapFile(). The stream keeps the mapping alive
+	static IStreamMmapRef	create( const std::shared_ptr<const void> &mapping, size_t size );
+
+	//! Returns the mapping the stream reads from
+	const std::shared_ptr<const void>&	getMapping() const { return mMapping; }
+
+ protected:
+	IStreamMmap( const std::shared_ptr<const void> &mapping, size_t size );
+
+	std::shared_ptr<const void>		mMapping;
+};
+
+
 typedef std::shared_ptr<class OStreamMem>		OStreamMemRef;
 
 class OStreamMem : public OStream {
  public:
 	static OStreamMemRef		create( size_t bufferSizeHint = 4096 ) { return std::shared_ptr<OStreamMem>( new OStreamMem( bufferSizeHint ) ); }
 
-	~OStreamMem();
-
 	virtual off_t		tell() const { return static_cast<off_t>( mOffset ); }
 	virtual void		seekAbsolute( off_t absoluteOffset );
 	virtual void		seekRelative( off_t relativeOffset );
 
 	void*				getBuffer() { return mBuffer; }
+	//! Returns the first tell() bytes written as a Buffer without copying them, and starts the stream over at offset 0 with new storage
+	Buffer				releaseBuffer();
 	
  protected:
 	OStreamMem( size_t bufferSizeHint );
 
 	virtual void		IOWrite( const void *t, size_t size );
+	//! Grows the storage to at least \a size bytes
+	void				reserve( size_t size );
 
-	void			*mBuffer;
-	size_t			mDataSize;
+	Buffer			mStorage;
+	void			*mBuffer;		// the data of mStorage
+	size_t			mDataSize;		// the allocated size of mStorage
 	size_t			mOffset;
+	size_t			mBufferSizeHint;
 };
 
 
@@ -318,10 +435,12 @@ class IStreamStateRestore {
 	off_t		mOffset;
 };
 
-//! Opens the file lcoated at \a path for read access as a stream.
-IStreamFileRef	loadFileStream( const fs::path &path );
-//! Opens the file located at \a path for write access as a stream, and creates it if it does not exist. Optionally creates any intermediate directories when \a createParents is true.
-OStreamFileRef	writeFileStream( const fs::path &path, bool createParents = true );
+//! Opens the file lcoated at \a path for read access as a stream, reading it \a bufferSize bytes at a time.
+IStreamFileRef	loadFileStream( const fs::path &path, int32_t bufferSize = 65536 );
+//! Opens the file located at \a path for write access as a stream, and creates it if it does not exist. Optionally creates any intermediate directories when \a createParents is true. Writes are buffered \a bufferSize bytes at a time.
+OStreamFileRef	writeFileStream( const fs::path &path, bool createParents = true, size_t bufferSize = 65536 );
+//! Creates the file located at \a path, replacing any existing file, and returns a stream which writes to it on a background thread. Optionally creates any intermediate directories when \a createParents is true.
+OStreamFileAsyncRef	writeFileStreamAsync( const fs::path &path, bool createParents = true, const OStreamFileAsync::Format &format = OStreamFileAsync::Format() );
 //! Opens a path for read-write access as a stream.
 IoStreamFileRef readWriteFileStream( const fs::path &path );
 
@@ -0,0 +1,91 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+
+#include <boost/lexical_cast.hpp>
+#include <cctype>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace cinder {
+
+//! A read-only view of a range of characters owned by something else, such as a parsed document. Only valid as long as its owner.
+class StringRef {
+  public:
+	StringRef() : mData( "" ), mSize( 0 ) {}
+	StringRef( const char *data, size_t size ) : mData( data ), mSize( size ) {}
+
+	//! Returns the characters of the string, which aren't necessarily zero-terminated
+	const char*		data() const { return mData; }
+	size_t			size() const { return mSize; }
+	bool			empty() const { return mSize == 0; }
+
+	const char*		begin() const { return mData; }
+	const char*		end() const { return mData + mSize; }
+
+	//! Returns a copy of the string
+	std::string		str() const { return std::string( mData, mSize ); }
+	operator std::string() const { return str(); }
+
+	//! Returns the string parsed as a T. Requires T to support the istream>> operator.
+	template<typename T>
+	T				as() const { return boost::lexical_cast<T>( str() ); }
+
+	//! Returns whether the string equals the \a rhsSize characters at \a rhs, optionally ignoring ASCII case
+	bool			equals( const char *rhs, size_t rhsSize, bool caseSensitive = true ) const
+	{
+		if( mSize != rhsSize )
+			return false;
+		if( caseSensitive )
+			return std::memcmp( mData, rhs, mSize ) == 0;
+		for( size_t c = 0; c < mSize; ++c ) {
+			if( std::tolower( (unsigned char)mData[c] ) != std::tolower( (unsigned char)rhs[c] ) )
+				return false;
+		}
+		return true;
+	}
+	//! Returns whether the string equals \a rhs, optionally ignoring ASCII case
+	bool			equals( const std::string &rhs, bool caseSensitive = true ) const { return equals( rhs.c_str(), rhs.size(), caseSensitive ); }
+
+	bool			operator==( const std::string &rhs ) const { return equals( rhs ); }
+	bool			operator!=( const std::string &rhs ) const { return ! equals( rhs ); }
+	bool			operator==( const char *rhs ) const { return equals( rhs, std::strlen( rhs ) ); }
+	bool			operator!=( const char *rhs ) const { return ! equals( rhs, std::strlen( rhs ) ); }
+
+  private:
+	const char		*mData;
+	size_t			mSize;
+};
+
+inline std::ostream& operator<<( std::ostream &out, const StringRef &str )
+{
+	return out.write( str.data(), str.size() );
+}
+
+} // namespace cinder
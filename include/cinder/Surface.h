@@ -30,8 +30,10 @@
 #include "cinder/Channel.h"
 #include "cinder/ChanTraits.h"
 #include "cinder/Color.h"
+#include "cinder/MemoryTracker.h"
 
 #include <boost/logic/tribool.hpp>
+#include <vector>
 
 namespace cinder {
 
@@ -76,11 +78,28 @@ class SurfaceConstraints {
  
 	virtual SurfaceChannelOrder getChannelOrder( bool alpha ) const { return ( alpha ) ? SurfaceChannelOrder::RGBA : SurfaceChannelOrder::RGB; }
 	virtual int32_t				getRowBytes( int requestedWidth, const SurfaceChannelOrder &sco, int elementSize ) const { return requestedWidth * elementSize * sco.getPixelInc(); }
+	//! Returns the byte alignment required of the address of the Surface's data, or \c 0 for no requirement beyond that of \c new
+	virtual int32_t				getAlignment() const { return 0; }
 };
 
 class SurfaceConstraintsDefault : public SurfaceConstraints {
 };
 
+//! Constrains the data and every row of a Surface to begin on a multiple of \a alignment bytes, which must be a power of two. Suitable for aligned SIMD loads and GPU uploads.
+class SurfaceConstraintsAligned : public SurfaceConstraints {
+ public:
+	SurfaceConstraintsAligned( int32_t alignment = 16 ) : mAlignment( alignment ) {}
+
+	virtual int32_t				getRowBytes( int requestedWidth, const SurfaceChannelOrder &sco, int elementSize ) const
+	{
+		return ( requestedWidth * elementSize * sco.getPixelInc() + mAlignment - 1 ) & ~( mAlignment - 1 );
+	}
+	virtual int32_t				getAlignment() const { return mAlignment; }
+
+ protected:
+	int32_t		mAlignment;
+};
+
 typedef std::shared_ptr<class ImageSource> ImageSourceRef;
 typedef std::shared_ptr<class ImageTarget> ImageTargetRef;
 
@@ -96,6 +115,7 @@ class SurfaceT {
 		void		initChannels();
 		void		setChannelOrder( const SurfaceChannelOrder &aChannelOrder );
 		void		setDeallocator( void(*aDeallocatorFunc)( void * ), void *aDeallocatorRefcon );
+		void		markDirty( const Area &area );
 	
 		int32_t						mWidth, mHeight, mRowBytes;
 		bool						mIsPremultiplied;
@@ -106,6 +126,15 @@ class SurfaceT {
 		
 		void						(*mDeallocatorFunc)(void *refcon);
 		void						*mDeallocatorRefcon;
+		//! The Obj whose data a sub-Surface references, kept alive for the lifetime of the sub-Surface
+		std::shared_ptr<Obj>		mParent;
+		//! Accounts for the pixel data allocated by the Surface itself
+		TrackedMemory				mTrackedMemory;
+		//! The offset of a sub-Surface's data within mParent's, used to forward dirty Areas
+		Vec2i						mParentOffset;
+		bool						mTrackDirty;
+		//! Disjoint modified Areas since the last clearDirty(), when mTrackDirty
+		std::vector<Area>			mDirtyAreas;
 	};
 	/// \endcond
 
@@ -118,7 +147,10 @@ class SurfaceT {
 	 <tt>Surface32f mySurface( 640, 480, true, SurfaceChannelOrder::RGBA );</tt>
 	*/
 	SurfaceT( int32_t width, int32_t height, bool alpha, SurfaceChannelOrder channelOrder = SurfaceChannelOrder::UNSPECIFIED );
+	//! Creates a Surface object that is \a height and \a width pixels, whose channel order, row bytes and data alignment are determined by \a constraints. Use SurfaceConstraintsAligned for aligned rows.
 	SurfaceT( int32_t width, int32_t height, bool alpha, const SurfaceConstraints &constraints );
+	//! Creates a Surface object that is \a height and \a width pixels whose data is allocated from \a pool, and returned to it when the Surface and all copies of it are destroyed
+	SurfaceT( int32_t width, int32_t height, bool alpha, SurfaceChannelOrder channelOrder, const SurfacePoolRef &pool );
 	//! Constructs a surface from the memory pointed to by \a data. Does not assume ownership of the memory in \a data, which consequently should not be freed while the Surface is still in use.
 	SurfaceT( T *data, int32_t width, int32_t height, int32_t rowBytes, SurfaceChannelOrder channelOrder );
 	/*! \brief Creates a Surface object from an ImageSource, for instance from the result of a loadImage() call
@@ -156,6 +188,9 @@ class SurfaceT {
 	SurfaceT			clone( bool copyPixels = true ) const;
 	//! Returns a new Surface which is a duplicate of an Area \a area. If \a copyPixels the pixel values are copied, otherwise the clone's pixels remain uninitialized
 	SurfaceT			clone( const Area &area, bool copyPixels = true ) const;
+	/** Returns a Surface which references the pixels of the Area \a area, clipped to the bounds of \a this, without copying them. The result shares this Surface's data and row bytes,
+		keeps it alive, and reflects any modifications made through either. **/
+	SurfaceT			getSubSurface( const Area &area ) const;
 
 	//! Retuns the raw data of an image as a pointer to either uin8t_t values in the case of a Surface8u or floats in the case of a Surface32f
 	T*					getData() { return mObj->mData; }
@@ -217,9 +252,9 @@ class SurfaceT {
 	//! Convenience method for getting a single pixel. For performance-sensitive code consider \ref SurfaceT::Iter "Surface::Iter" instead.
 	ColorAT<T>	getPixel( Vec2i pos ) const { pos.x = constrain<int32_t>( pos.x, 0, mObj->mWidth - 1); pos.y = constrain<int32_t>( pos.y, 0, mObj->mHeight - 1 ); const T *p = getData( pos ); return ColorAT<T>( p[getRedOffset()], p[getGreenOffset()], p[getBlueOffset()], ( hasAlpha() ) ? p[getAlphaOffset()] : CHANTRAIT<T>::max() ); }
 	//! Convenience method for setting a single pixel. For performance-sensitive code consider \ref SurfaceT::Iter "Surface::Iter" instead.
-	void	setPixel( Vec2i pos, const ColorT<T> &c ) { pos.x = constrain<int32_t>( pos.x, 0, mObj->mWidth - 1); pos.y = constrain<int32_t>( pos.y, 0, mObj->mHeight - 1 ); T *p = getData( pos ); p[getRedOffset()] = c.r; p[getGreenOffset()] = c.g; p[getBlueOffset()] = c.b; }
+	void	setPixel( Vec2i pos, const ColorT<T> &c ) { pos.x = constrain<int32_t>( pos.x, 0, mObj->mWidth - 1); pos.y = constrain<int32_t>( pos.y, 0, mObj->mHeight - 1 ); T *p = getData( pos ); p[getRedOffset()] = c.r; p[getGreenOffset()] = c.g; p[getBlueOffset()] = c.b; markDirty( Area( pos, pos + Vec2i( 1, 1 ) ) ); }
 	//! Convenience method for setting a single pixel. For performance-sensitive code consider \ref SurfaceT::Iter "Surface::Iter" instead.
-	void	setPixel( Vec2i pos, const ColorAT<T> &c ) { pos.x = constrain<int32_t>( pos.x, 0, mObj->mWidth - 1); pos.y = constrain<int32_t>( pos.y, 0, mObj->mHeight - 1 ); T *p = getData( pos ); p[getRedOffset()] = c.r; p[getGreenOffset()] = c.g; p[getBlueOffset()] = c.b; if( hasAlpha() ) p[getAlphaOffset()] = c.a; }
+	void	setPixel( Vec2i pos, const ColorAT<T> &c ) { pos.x = constrain<int32_t>( pos.x, 0, mObj->mWidth - 1); pos.y = constrain<int32_t>( pos.y, 0, mObj->mHeight - 1 ); T *p = getData( pos ); p[getRedOffset()] = c.r; p[getGreenOffset()] = c.g; p[getBlueOffset()] = c.b; if( hasAlpha() ) p[getAlphaOffset()] = c.a; markDirty( Area( pos, pos + Vec2i( 1, 1 ) ) ); }
 
 	//! Copies the Area \a srcArea of the Surface \a srcSurface to \a this Surface. The destination Area is \a srcArea offset by \a relativeOffset.
 	void	copyFrom( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &relativeOffset = Vec2i::zero() );
@@ -227,6 +262,25 @@ class SurfaceT {
 	//! Returns an averaged color for the Area defined by \a area
 	ColorT<T>	areaAverage( const Area &area ) const;
 
+	/** Enables or disables recording which Areas of the Surface are modified, shared by all copies of the Surface. Enabling marks the whole Surface dirty.
+		Iter, setPixel(), copyFrom() and the ip functions mark what they modify; code writing through getData() should call markDirty() itself.
+		gl::Texture::update( const Surface& ) then uploads only the dirty Areas of a tracking Surface and clears them. **/
+	void		setDirtyTracking( bool track = true );
+	//! Returns whether the Surface records its modified Areas
+	bool		isDirtyTracking() const { return mObj->mTrackDirty; }
+	//! Records \a area as modified, clipped to the bounds of the Surface. A sub-Surface also marks the Area in its parent. Does nothing unless dirty tracking is enabled.
+	void		markDirty( const Area &area ) { if( mObj->mTrackDirty || mObj->mParent ) mObj->markDirty( area ); }
+	//! Records the whole Surface as modified
+	void		markDirty() { markDirty( getBounds() ); }
+	//! Returns whether any Area has been modified since the last clearDirty()
+	bool		isDirty() const { return ! mObj->mDirtyAreas.empty(); }
+	//! Returns the disjoint Areas modified since the last clearDirty(). Nearby modifications are merged, so these may cover unmodified pixels too.
+	const std::vector<Area>&	getDirtyAreas() const { return mObj->mDirtyAreas; }
+	//! Returns the bounding Area of every dirty Area, or an empty Area if none are
+	Area		getDirtyBounds() const;
+	//! Forgets the dirty Areas, typically once they've been uploaded. \c const since dirty tracking is bookkeeping rather than pixel data.
+	void		clearDirty() const { mObj->mDirtyAreas.clear(); }
+
 	/// \cond
 	typedef std::shared_ptr<Obj> SurfaceT::*unspecified_bool_type;
 	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &SurfaceT::mObj; }
@@ -254,6 +308,7 @@ class SurfaceT {
 				mInc( SurfaceT.getPixelInc() ), mRowInc( SurfaceT.getRowBytes() )
 		{
 			Area clippedArea( area.getClipBy( SurfaceT.getBounds() ) );
+			SurfaceT.markDirty( clippedArea );
 			mWidth = clippedArea.getWidth();
 			mHeight = clippedArea.getHeight();
 			mLinePtr = reinterpret_cast<uint8_t*>( SurfaceT.getData( clippedArea.getUL() ) );
@@ -481,7 +536,7 @@ class SurfaceConstraintsExc : public SurfaceExc {
 typedef SurfaceT<uint8_t> Surface;
 //! 8-bit image
 typedef SurfaceT<uint8_t> Surface8u;	
-//! 16-bit image. Suitable as an intermediate representation and ImageIo but not a first-class citizen.
+//! 16-bit image. Supported throughout cinder::ip, ImageIo and gl::Texture.
 typedef SurfaceT<uint16_t> Surface16u;
 //! 32-bit floating point image
 typedef SurfaceT<float> Surface32f;
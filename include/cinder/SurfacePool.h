@@ -0,0 +1,77 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Thread.h"
+
+#include <boost/noncopyable.hpp>
+#include <map>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class SurfacePool>	SurfacePoolRef;
+
+/** \brief Thread-safe cache of image buffers, recycled between Surfaces and Channels of similar sizes.
+	Buffers are grouped into size classes, four per power of two, and returned to the pool when the last Surface or Channel referencing them is destroyed.
+	Pass a SurfacePoolRef to the SurfaceT or ChannelT constructors which accept one. **/
+class SurfacePool : public std::enable_shared_from_this<SurfacePool>, private boost::noncopyable {
+  public:
+	//! Creates a SurfacePool which retains up to \a maxCachedBytes of unused buffers
+	static SurfacePoolRef	create( size_t maxCachedBytes = 64 * 1024 * 1024 ) { return SurfacePoolRef( new SurfacePool( maxCachedBytes ) ); }
+
+	~SurfacePool();
+
+	/** Returns a block of at least \a size bytes whose address is a multiple of 16, reusing a cached block of the same size class when possible.
+		\a resultRefcon receives the value to pass to deallocate() once the block is no longer in use. **/
+	void*		allocate( size_t size, void **resultRefcon );
+	//! Returns the block identified by \a refcon, as produced by allocate(), to its pool. Suitable as the deallocator function of a Surface or Channel.
+	static void	deallocate( void *refcon );
+
+	//! Returns the number of bytes currently held by unused buffers
+	size_t		getCachedBytes() const;
+	//! Returns the maximum number of bytes of unused buffers the pool retains
+	size_t		getMaxCachedBytes() const;
+	//! Sets the maximum number of bytes of unused buffers the pool retains, freeing buffers as necessary
+	void		setMaxCachedBytes( size_t maxCachedBytes );
+	//! Frees all unused buffers
+	void		clear();
+
+	//! Returns the size class, the actual number of bytes allocated, for a request of \a size bytes
+	static size_t	calcSizeClass( size_t size );
+
+  private:
+	SurfacePool( size_t maxCachedBytes );
+
+	void		release( void *data, size_t sizeClass );
+	void		trim( size_t maxCachedBytes );
+
+	mutable std::mutex						mMutex;
+	std::map<size_t,std::vector<void*> >	mFreeBuffers;
+	size_t									mCachedBytes, mMaxCachedBytes;
+};
+
+} // namespace cinder
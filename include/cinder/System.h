@@ -27,6 +27,7 @@
 #include <vector>
 #include <string>
 #include <iostream>
+#include <utility>
 
 namespace cinder { 
 
@@ -38,16 +39,36 @@ class System {
 	static bool			hasSse2();
 	//! Returns whether the system supports the SSE3 instruction set.	
 	static bool			hasSse3();
+	//! Returns whether the system supports the SSSE3 (Supplemental SSE3) instruction set.
+	static bool			hasSsse3();
 	//! Returns whether the system supports the SSE4.1 instruction set.	
 	static bool			hasSse4_1();
 	//! Returns whether the system supports the SSE4.2 instruction set.		
 	static bool			hasSse4_2();
 	//! Returns whether the system supports the x86-64 instruction set.		
 	static bool			hasX86_64();
+	//! Returns whether the system supports the F16C half precision conversion instructions.
+	static bool			hasF16c();
+	//! Returns whether the system supports the AVX instruction set, including operating system support for saving the YMM registers.
+	static bool			hasAvx();
+	//! Returns whether the system supports the AVX2 instruction set.
+	static bool			hasAvx2();
+	//! Returns whether the system supports the FMA3 fused multiply-add instructions.
+	static bool			hasFma();
+	//! Returns whether the system supports the ARM NEON instruction set.
+	static bool			hasNeon();
 	//! Returns the number of physical processors in the system. A single processor dual core machine returns 1.
 	static int			getNumCpus();
 	//! Returns the number of cores (or logical processors) in the system. A single processor dual core machine returns 2.	
 	static int			getNumCores();
+	//! Returns the number of physical cores in the system. A single processor dual core machine with hyperthreading returns 2, where getNumCores() returns 4.
+	static int			getNumPhysicalCores();
+	//! Returns the index of the physical core for each logical processor, which is indexed as in getNumCores(). Logical processors which share an index are hyperthreads of the same core.
+	static const std::vector<int>&	getLogicalToPhysicalCoreMap();
+	//! Returns the size in bytes of the level \a level (1 through 3) data cache of a single core, or \c 0 if the system has no such cache. Caches shared between cores report their full size.
+	static int			getCacheSize( int level );
+	//! Returns the size in bytes of a cache line, or \c 0 if it can't be determined.
+	static int			getCacheLineSize();
 	//! Returns the major version of the operating system.
 	//! For version \c 10.5.8, this is \c 10. For Windows Vista this is 6. Refer to the MSDN documentation for the \c OSVERSIONINFOEX struct for Windows meanings
 	static int			getOsMajorVersion();
@@ -58,6 +79,15 @@ class System {
 	//! For version \c 10.5.8, this is \c 8. For Windows this corresponds to the major version of the service pack. So \c Service Pack 2 returns \c 2
 	static int			getOsBugFixVersion();
 
+	//! Instruction set features against which CpuDispatch implementations are registered, ordered from least to most preferred
+	enum CpuFeature { CPU_GENERIC, CPU_SSE2, CPU_SSE3, CPU_SSSE3, CPU_SSE4_1, CPU_SSE4_2, CPU_AVX, CPU_F16C, CPU_FMA, CPU_AVX2, CPU_NEON, CPU_FEATURE_COUNT };
+	//! Returns whether the system supports \a feature and it hasn't been disabled with setCpuFeatureEnabled(). \c CPU_GENERIC is always supported.
+	static bool			hasCpuFeature( CpuFeature feature );
+	//! Enables or disables \a feature for hasCpuFeature() and every CpuDispatch. Primarily useful for benchmarking and testing fallback implementations.
+	static void			setCpuFeatureEnabled( CpuFeature feature, bool enable = true );
+	//! Returns a counter which is incremented by every call to setCpuFeatureEnabled(). Used by CpuDispatch to invalidate its selection.
+	static uint32_t		getCpuFeatureGeneration() { return sCpuFeatureGeneration; }
+
 	//! Returns whether the system supports MultiTouch. Also returns true under Windows 7 in the presence of single touch support. Always returns true on Mac OS X Snow Leopard.
 	static bool			hasMultiTouch();
 	//! Returns the maximum number of simultaneous touches supported by the system's MultiTouch implementation. Only truly accurate on Windows 7.
@@ -81,20 +111,26 @@ class System {
 	static std::string						getIpAddress();
 	
  private:
-	 enum {	HAS_SSE2, HAS_SSE3, HAS_SSE4_1, HAS_SSE4_2, HAS_X86_64, PHYSICAL_CPUS, LOGICAL_CPUS, OS_MAJOR, OS_MINOR, OS_BUGFIX, MULTI_TOUCH, MAX_MULTI_TOUCH_POINTS, TOTAL_CACHE_TYPES };
+	 enum {	HAS_SSE2, HAS_SSE3, HAS_SSSE3, HAS_SSE4_1, HAS_SSE4_2, HAS_X86_64, HAS_F16C, HAS_AVX, HAS_AVX2, HAS_FMA, PHYSICAL_CPUS, LOGICAL_CPUS, CPU_TOPOLOGY, OS_MAJOR, OS_MINOR, OS_BUGFIX, MULTI_TOUCH, MAX_MULTI_TOUCH_POINTS, TOTAL_CACHE_TYPES };
 
 	System();
 	static std::shared_ptr<System>		instance();
 	static std::shared_ptr<System>		sInstance;
+	static uint32_t						sCpuFeatureGeneration;
+
+	static void			cacheCpuTopology();
 
 	bool				mCachedValues[TOTAL_CACHE_TYPES];
-	bool				mHasSSE2, mHasSSE3, mHasSSE4_1, mHasSSE4_2, mHasX86_64;
-	int					mPhysicalCPUs, mLogicalCPUs;
+	bool				mHasSSE2, mHasSSE3, mHasSSSE3, mHasSSE4_1, mHasSSE4_2, mHasX86_64, mHasF16C, mHasAVX, mHasAVX2, mHasFMA;
+	bool				mCpuFeatureDisabled[CPU_FEATURE_COUNT];
+	int					mPhysicalCPUs, mLogicalCPUs, mPhysicalCores;
+	std::vector<int>	mLogicalToPhysicalCore;
+	int					mCacheSizes[3], mCacheLineSize;
 	int32_t				mOSMajorVersion, mOSMinorVersion, mOSBugFixVersion;
 	bool				mHasMultiTouch;
 	uint32_t			mMaxMultiTouchPoints;
 #if defined( CINDER_MSW )
-	uint32_t			mCPUID_EBX, mCPUID_ECX, mCPUID_EDX;
+	uint32_t			mCPUID_EBX, mCPUID_ECX, mCPUID_EDX, mCPUID7_EBX;
 #endif 
 };
 
@@ -104,6 +140,60 @@ inline std::ostream& operator<<( std::ostream &outp, const System::NetworkAdapte
 	return outp;
 }
 
+/** \brief Selects between several implementations of a kernel based on the instruction sets supported by the CPU.
+	The implementation registered against the most preferred supported System::CpuFeature is used, falling back to the implementation passed to the constructor.
+	Implementations should be registered before the first call to get(). The selection is cached and only revisited after System::setCpuFeatureEnabled().
+	\code
+	static CpuDispatch<void(*)( const float*, float*, size_t )> sScale( scaleGeneric );
+	sScale.add( System::CPU_SSE2, scaleSse2 ).add( System::CPU_AVX, scaleAvx );
+	sScale.get()( src, dst, count );
+	\endcode **/
+template<typename FnT>
+class CpuDispatch {
+  public:
+	explicit CpuDispatch( FnT fallback )
+		: mFallback( fallback ), mSelected( fallback ), mSelectedFeature( System::CPU_GENERIC ), mGeneration( 0 )
+	{}
+
+	//! Registers \a fn as an implementation which requires \a feature. Returns a reference to \a this for chaining.
+	CpuDispatch&		add( System::CpuFeature feature, FnT fn )
+	{
+		mImpls.push_back( std::make_pair( feature, fn ) );
+		mGeneration = 0;
+		return *this;
+	}
+
+	//! Returns the best implementation for the system
+	FnT					get() const
+	{
+		if( mGeneration != System::getCpuFeatureGeneration() )
+			select();
+		return mSelected;
+	}
+	//! Returns the feature of the implementation returned by get(), or System::CPU_GENERIC for the fallback
+	System::CpuFeature	getSelectedFeature() const { get(); return mSelectedFeature; }
+
+  private:
+	void	select() const
+	{
+		mSelected = mFallback;
+		mSelectedFeature = System::CPU_GENERIC;
+		for( typename std::vector<std::pair<System::CpuFeature,FnT> >::const_iterator implIt = mImpls.begin(); implIt != mImpls.end(); ++implIt ) {
+			if( implIt->first > mSelectedFeature && System::hasCpuFeature( implIt->first ) ) {
+				mSelected = implIt->second;
+				mSelectedFeature = implIt->first;
+			}
+		}
+		mGeneration = System::getCpuFeatureGeneration();
+	}
+
+	FnT											mFallback;
+	std::vector<std::pair<System::CpuFeature,FnT> >	mImpls;
+	mutable FnT									mSelected;
+	mutable System::CpuFeature					mSelectedFeature;
+	mutable uint32_t							mGeneration;
+};
+
 class SystemExc : public std::exception {
 };
 
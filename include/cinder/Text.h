@@ -27,6 +27,7 @@
 #include "cinder/Surface.h"
 #include "cinder/Font.h"
 #include "cinder/Vector.h"
+#include "cinder/Function.h"
 
 #include <vector>
 #include <deque>
@@ -40,6 +41,33 @@ struct __CTLine;
 
 namespace cinder {
 
+typedef std::shared_ptr<class AsyncTextRender>	AsyncTextRenderRef;
+
+//! The eventual result of TextLayout::renderAsync() or TextBox::renderAsync(), analogous to a future
+class AsyncTextRender {
+  public:
+	//! Returns whether rendering has finished, successfully or not
+	bool	isReady() const;
+	//! Returns whether rendering has finished unsuccessfully
+	bool	hasFailed() const;
+	//! Blocks until rendering has finished
+	void	wait() const;
+	//! Blocks until rendering has finished and returns the result, which is a NULL Surface if rendering failed. Hand it to gl::TextureStreamer::update() to upload it without stalling the main thread.
+	Surface	getSurface() const;
+
+  private:
+	AsyncTextRender();
+
+	static AsyncTextRenderRef	start( const std::function<Surface()> &renderFn );
+	static void					threadFn( AsyncTextRenderRef result, std::function<Surface()> renderFn );
+
+	struct Obj;
+	std::shared_ptr<Obj>	mObj;
+
+	friend class TextLayout;
+	friend class TextBox;
+};
+
 class TextLayout {
  public:
 	/*! \brief This is an abstract line
@@ -76,6 +104,9 @@ class TextLayout {
 
 	//! Returns a Surface into which the TextLayout is rendered. If \a useAlpha the Surface will contain an alpha channel. If \a premultiplied the alpha will be premulitplied.
 	Surface		render( bool useAlpha = false, bool premultiplied = false );
+	/** Renders a copy of the TextLayout on a new thread and returns immediately, so large paragraphs don't stall the main thread. Parameters are the same as render().
+		The TextLayout may be modified or destroyed while rendering is underway. **/
+	AsyncTextRenderRef	renderAsync( bool useAlpha = false, bool premultiplied = false ) const;
 	
  private:
 	ColorA	mBackgroundColor;
@@ -114,7 +145,7 @@ class TextBox {
 
 	TextBox&			color( ColorA color ) { setColor( color ); return *this; }
 	ColorA				getColor() const { return mColor; }
-	void				setColor( ColorA color ) { mColor = color; mInvalid = true; }
+	void				setColor( ColorA color ) { mColor = color; }
 
 	TextBox&			backgroundColor( ColorA bgColor ) { setBackgroundColor( bgColor ); return *this; }
 	ColorA				getBackgroundColor() const { return mBackgroundColor; }
@@ -132,8 +163,20 @@ class TextBox {
 	/** Returns a vector of pairs of glyph indices and the position of their left baselines
 		\warning Does not support word wrapping on Windows. **/
 	std::vector<std::pair<uint16_t,Vec2f> >	measureGlyphs() const;
+	/** Returns the same glyph placements as measureGlyphs() without copying them, for drawing the text directly on the GPU. Valid until the TextBox's text, Font, size, alignment or ligation changes.
+		\warning Does not support word wrapping on Windows. **/
+	const std::vector<std::pair<uint16_t,Vec2f> >&	getGlyphPlacements() const;
 
 	Surface				render( Vec2f offset = Vec2f::zero() );
+	/** Renders a copy of the TextBox on a new thread and returns immediately, so large paragraphs don't stall the main thread.
+		The TextBox may be modified or destroyed while rendering is underway. **/
+	AsyncTextRenderRef	renderAsync( Vec2f offset = Vec2f::zero() ) const;
+
+	/** Sets the maximum number of layouts TextBoxes share, least recently used first out. Default \c 128, and \c 0 disables sharing.
+		TextBoxes with the same text, Font, size, alignment and ligation reuse one layout, so temporary TextBoxes like those gl::TextureFont creates per draw don't repeat it. **/
+	static void			setLayoutCacheSize( size_t maxLayouts );
+	//! Releases all the layouts currently shared between TextBoxes
+	static void			clearLayoutCache();
 
   protected:
 	Alignment		mAlign;
@@ -145,17 +188,10 @@ class TextBox {
 	bool			mLigate;
 	mutable bool	mInvalid;
 
-	mutable Vec2f	mCalculatedSize;
-#if defined( CINDER_COCOA )
-	void			createLines() const;
-
-	mutable std::vector<std::pair<std::shared_ptr<const __CTLine>,Vec2f> >	mLines;
-#elif defined( CINDER_MSW )
-	std::vector<std::string>	calculateLineBreaks() const;
-	void						calculate() const;
+	//! Returns the shared layout matching the TextBox's text, Font, size, alignment and ligation, creating it if necessary. Color changes don't require a new layout.
+	class TextBoxLayout&	getLayout() const;
 
-	mutable std::wstring	mWideText;
-#endif
+	mutable std::shared_ptr<class TextBoxLayout>	mLayout;
 };
 
 /** \brief Renders a single string and returns it as a Surface.
@@ -0,0 +1,96 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Area.h"
+#include "cinder/Exception.h"
+#include "cinder/Filesystem.h"
+#include "cinder/ImageIo.h"
+#include "cinder/Vector.h"
+
+#include <string>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class TiledImage>	TiledImageRef;
+
+/** \brief Describes an image stored on disk as a pyramid of fixed-size tiles, so that any region of it can be loaded at any level of detail without loading the rest.
+	Level 0 is the full image, and each following level is half the size of the one before, rounding down and no smaller than 1 pixel, down to 1x1.
+	The directory holds a descriptor named \c tiledimage.xml, and the tile at column \a col and row \a row of level \a level in the file <tt>level/col_row.extension</tt>.
+	Tiles along the right and bottom edges of a level are smaller when the level isn't a multiple of the tile size. Draw one with gl::TiledImageView. **/
+class TiledImage {
+  public:
+	//! Reads the descriptor of the tiled image in \a directory. Throws TiledImageExc if it is missing or invalid.
+	static TiledImageRef	load( const fs::path &directory );
+
+	/** Writes \a imageSource to \a directory as tiles of \a tileSize pixels, which must be even, in the image format of \a extension, and returns its description.
+		The image is consumed as bands of \a tileSize rows, and each level holds only a band of its own, so images far larger than memory can be tiled. **/
+	static TiledImageRef	write( const fs::path &directory, ImageSourceRef imageSource, int32_t tileSize = 256, const std::string &extension = "png" );
+
+	//! Returns the directory holding the tiles
+	const fs::path&		getDirectory() const { return mDirectory; }
+	//! Returns the size of the full image, which is level 0
+	Vec2i				getSize() const { return mSize; }
+	int32_t				getWidth() const { return mSize.x; }
+	int32_t				getHeight() const { return mSize.y; }
+	//! Returns the width and height of a tile
+	int32_t				getTileSize() const { return mTileSize; }
+	//! Returns the extension of the tile files, such as \c png
+	const std::string&	getExtension() const { return mExtension; }
+
+	//! Returns the number of levels, including the full image
+	int32_t				getNumLevels() const { return (int32_t)mLevelSizes.size(); }
+	//! Returns the size of level \a level in pixels
+	Vec2i				getLevelSize( int32_t level ) const { return mLevelSizes[level]; }
+	//! Returns the number of columns and rows of tiles in level \a level
+	Vec2i				getNumTiles( int32_t level ) const;
+	//! Returns the pixels of level \a level covered by the tile at \a col, \a row
+	Area				getTileArea( int32_t level, int32_t col, int32_t row ) const;
+	//! Returns the path of the file holding the tile at \a col, \a row of level \a level
+	fs::path			getTilePath( int32_t level, int32_t col, int32_t row ) const;
+
+  protected:
+	TiledImage( const fs::path &directory, const Vec2i &size, int32_t tileSize, const std::string &extension );
+
+	fs::path			mDirectory;
+	Vec2i				mSize;
+	int32_t				mTileSize;
+	std::string			mExtension;
+	std::vector<Vec2i>	mLevelSizes;
+};
+
+class TiledImageExc : public Exception {
+  public:
+	TiledImageExc( const fs::path &directory, const std::string &description );
+
+	virtual const char * what() const throw() { return mMessage; }
+
+	char mMessage[4096];
+};
+
+} // namespace cinder
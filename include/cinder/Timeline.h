@@ -29,10 +29,12 @@
 #include "cinder/Easing.h"
 #include "cinder/Tween.h"
 #include "cinder/Function.h"
+#include "cinder/ip/ExecutionContext.h"
 
 #include <vector>
 #include <list>
 #include <map>
+#include <typeinfo>
 
 namespace cinder {
 
@@ -42,7 +44,7 @@ typedef std::shared_ptr<class Timeline>		TimelineRef;
 class Timeline : public TimelineItem {		
   public:
 	//! Creates a new timeline, defaulted to infinite
-	static TimelineRef	create() { TimelineRef result( new Timeline() ); result->setInfinite( true ); return result; }
+	static TimelineRef	create() { TimelineRef result( TimelineItemPool::makeRef( new Timeline() ) ); result->setInfinite( true ); return result; }
 
 	//! Advances time a specified amount and evaluates items
 	void	step( float timestep );
@@ -54,7 +56,7 @@ class Timeline : public TimelineItem {
 	
 	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time
 	template<typename T>
-	typename Tween<T>::Options apply( Anim<T> *target, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
+	typename Tween<T>::Options apply( Anim<T> *target, T endValue, float duration, const EaseFn &easeFunction = easeNone, const typename Tween<T>::LerpFn &lerpFunction = &tweenLerp<T> )
 	{
 		target->setParentTimeline( thisRef() );
 		return applyPtr( target->ptr(), endValue, duration, easeFunction, lerpFunction );
@@ -62,7 +64,7 @@ class Timeline : public TimelineItem {
 
 	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time
 	template<typename T>
-	typename Tween<T>::Options apply( Anim<T> *target, T startValue, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
+	typename Tween<T>::Options apply( Anim<T> *target, T startValue, T endValue, float duration, const EaseFn &easeFunction = easeNone, const typename Tween<T>::LerpFn &lerpFunction = &tweenLerp<T> )
 	{
 		target->setParentTimeline( thisRef() );
 		return applyPtr( target->ptr(), startValue, endValue, duration, easeFunction, lerpFunction );
@@ -70,7 +72,7 @@ class Timeline : public TimelineItem {
 
 	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time.
 	template<typename T>
-	typename Tween<T>::Options appendTo( Anim<T> *target, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
+	typename Tween<T>::Options appendTo( Anim<T> *target, T endValue, float duration, const EaseFn &easeFunction = easeNone, const typename Tween<T>::LerpFn &lerpFunction = &tweenLerp<T> )
 	{
 		target->setParentTimeline( thisRef() );
 		return appendToPtr( target->ptr(), endValue, duration, easeFunction, lerpFunction );
@@ -78,7 +80,7 @@ class Timeline : public TimelineItem {
 
 	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time.
 	template<typename T>
-	typename Tween<T>::Options appendTo( Anim<T> *target, T startValue, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
+	typename Tween<T>::Options appendTo( Anim<T> *target, T startValue, T endValue, float duration, const EaseFn &easeFunction = easeNone, const typename Tween<T>::LerpFn &lerpFunction = &tweenLerp<T> )
 	{
 		target->setParentTimeline( thisRef() );
 		return appendToPtr( target->ptr(), startValue, endValue, duration, easeFunction, lerpFunction );
@@ -86,9 +88,9 @@ class Timeline : public TimelineItem {
 
 	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time. Consider the apply( Anim<T>* ) variant unless you have an advanced use case.
 	template<typename T>
-	typename Tween<T>::Options applyPtr( T *target, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
+	typename Tween<T>::Options applyPtr( T *target, T endValue, float duration, const EaseFn &easeFunction = easeNone, const typename Tween<T>::LerpFn &lerpFunction = &tweenLerp<T> )
 	{
-		TweenRef<T> newTween( new Tween<T>( target, endValue, mCurrentTime, duration, easeFunction, lerpFunction ) );
+		TweenRef<T> newTween( TimelineItemPool::makeRef( new Tween<T>( target, endValue, mCurrentTime, duration, easeFunction, lerpFunction ) ) );
 		newTween->setAutoRemove( mDefaultAutoRemove );
 		apply( newTween );
 		return typename Tween<T>::Options( newTween, thisRef() );
@@ -96,8 +98,8 @@ class Timeline : public TimelineItem {
 	
 	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time. Consider the apply( Anim<T>* ) variant unless you have an advanced use case.
 	template<typename T>
-	typename Tween<T>::Options applyPtr( T *target, T startValue, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> ) {
-		TweenRef<T> newTween( new Tween<T>( target, startValue, endValue, mCurrentTime, duration, easeFunction, lerpFunction ) );
+	typename Tween<T>::Options applyPtr( T *target, T startValue, T endValue, float duration, const EaseFn &easeFunction = easeNone, const typename Tween<T>::LerpFn &lerpFunction = &tweenLerp<T> ) {
+		TweenRef<T> newTween( TimelineItemPool::makeRef( new Tween<T>( target, startValue, endValue, mCurrentTime, duration, easeFunction, lerpFunction ) ) );
 		newTween->setAutoRemove( mDefaultAutoRemove );
 		apply( newTween );
 		return typename Tween<T>::Options( newTween, thisRef() );
@@ -105,9 +107,9 @@ class Timeline : public TimelineItem {
 
 	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time. Consider the appendTo( Anim<T>* ) variant unless you have an advanced use case.
 	template<typename T>
-	typename Tween<T>::Options appendToPtr( T *target, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> ) {
+	typename Tween<T>::Options appendToPtr( T *target, T endValue, float duration, const EaseFn &easeFunction = easeNone, const typename Tween<T>::LerpFn &lerpFunction = &tweenLerp<T> ) {
 		float startTime = findEndTimeOf( target );
-		TweenRef<T> newTween( new Tween<T>( target, endValue, std::max( mCurrentTime, startTime ), duration, easeFunction, lerpFunction ) );
+		TweenRef<T> newTween( TimelineItemPool::makeRef( new Tween<T>( target, endValue, std::max( mCurrentTime, startTime ), duration, easeFunction, lerpFunction ) ) );
 		newTween->setAutoRemove( mDefaultAutoRemove );
 		insert( newTween );
 		return typename Tween<T>::Options( newTween, thisRef() );
@@ -115,9 +117,56 @@ class Timeline : public TimelineItem {
 	
 	//! Creates a new tween and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time. Consider the appendTo( Anim<T>* ) variant unless you have an advanced use case.
 	template<typename T>
-	typename Tween<T>::Options appendToPtr( T *target, T startValue, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> ) {
+	typename Tween<T>::Options appendToPtr( T *target, T startValue, T endValue, float duration, const EaseFn &easeFunction = easeNone, const typename Tween<T>::LerpFn &lerpFunction = &tweenLerp<T> ) {
 		float startTime = findEndTimeOf( target );
-		TweenRef<T> newTween( new Tween<T>( target, startValue, endValue, std::max( mCurrentTime, startTime ), duration, easeFunction, lerpFunction ) );
+		TweenRef<T> newTween( TimelineItemPool::makeRef( new Tween<T>( target, startValue, endValue, std::max( mCurrentTime, startTime ), duration, easeFunction, lerpFunction ) ) );
+		newTween->setAutoRemove( mDefaultAutoRemove );
+		insert( newTween );
+		return typename Tween<T>::Options( newTween, thisRef() );
+	}
+
+	/** Replaces any existing tweens on the \a target with a new tween at the timeline's current time, easing with the type \a EaseT resolved at compile time rather than through an EaseFn.
+		For example, \c timeline().applyEase<EaseOutQuad>( &mPos, Vec2f( 100, 100 ), 2.0f ) **/
+	template<typename EaseT, typename T>
+	typename Tween<T>::Options applyEase( Anim<T> *target, T endValue, float duration, const EaseT &easeFunction = EaseT() )
+	{
+		target->setParentTimeline( thisRef() );
+		TweenRef<T> newTween( TimelineItemPool::makeRef( new TweenT<T,EaseT>( target->ptr(), endValue, mCurrentTime, duration, easeFunction ) ) );
+		newTween->setAutoRemove( mDefaultAutoRemove );
+		apply( newTween );
+		return typename Tween<T>::Options( newTween, thisRef() );
+	}
+
+	//! Replaces any existing tweens on the \a target with a new tween at the timeline's current time, easing with the type \a EaseT resolved at compile time rather than through an EaseFn.
+	template<typename EaseT, typename T>
+	typename Tween<T>::Options applyEase( Anim<T> *target, T startValue, T endValue, float duration, const EaseT &easeFunction = EaseT() )
+	{
+		target->setParentTimeline( thisRef() );
+		TweenRef<T> newTween( TimelineItemPool::makeRef( new TweenT<T,EaseT>( target->ptr(), startValue, endValue, mCurrentTime, duration, easeFunction ) ) );
+		newTween->setAutoRemove( mDefaultAutoRemove );
+		apply( newTween );
+		return typename Tween<T>::Options( newTween, thisRef() );
+	}
+
+	//! Creates a new tween easing with the type \a EaseT resolved at compile time and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time.
+	template<typename EaseT, typename T>
+	typename Tween<T>::Options appendToEase( Anim<T> *target, T endValue, float duration, const EaseT &easeFunction = EaseT() )
+	{
+		target->setParentTimeline( thisRef() );
+		float startTime = findEndTimeOf( target->ptr() );
+		TweenRef<T> newTween( TimelineItemPool::makeRef( new TweenT<T,EaseT>( target->ptr(), endValue, std::max( mCurrentTime, startTime ), duration, easeFunction ) ) );
+		newTween->setAutoRemove( mDefaultAutoRemove );
+		insert( newTween );
+		return typename Tween<T>::Options( newTween, thisRef() );
+	}
+
+	//! Creates a new tween easing with the type \a EaseT resolved at compile time and adds it to the end of the last tween on \a target, or if no existing tween matches the target, the current time.
+	template<typename EaseT, typename T>
+	typename Tween<T>::Options appendToEase( Anim<T> *target, T startValue, T endValue, float duration, const EaseT &easeFunction = EaseT() )
+	{
+		target->setParentTimeline( thisRef() );
+		float startTime = findEndTimeOf( target->ptr() );
+		TweenRef<T> newTween( TimelineItemPool::makeRef( new TweenT<T,EaseT>( target->ptr(), startValue, endValue, std::max( mCurrentTime, startTime ), duration, easeFunction ) ) );
 		newTween->setAutoRemove( mDefaultAutoRemove );
 		insert( newTween );
 		return typename Tween<T>::Options( newTween, thisRef() );
@@ -127,8 +176,8 @@ class Timeline : public TimelineItem {
 	CueRef add( std::function<void ()> action, float atTime );
 
 	template<typename T>
-	FnTweenRef<T> applyFn( std::function<void (T)> fn, T startValue, T endValue, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> ) {
-		FnTweenRef<T> newTween( new FnTween<T>( fn, startValue, endValue, mCurrentTime, duration, easeFunction, lerpFunction ) );
+	FnTweenRef<T> applyFn( std::function<void (T)> fn, T startValue, T endValue, float duration, const EaseFn &easeFunction = easeNone, const typename Tween<T>::LerpFn &lerpFunction = &tweenLerp<T> ) {
+		FnTweenRef<T> newTween( TimelineItemPool::makeRef( new FnTween<T>( fn, startValue, endValue, mCurrentTime, duration, easeFunction, lerpFunction ) ) );
 		newTween->setAutoRemove( mDefaultAutoRemove );
 		apply( newTween );
 		return newTween;
@@ -148,7 +197,9 @@ class Timeline : public TimelineItem {
 	void insert( TimelineItemRef item, float atTime ) { item->mStartTime = atTime; insert( item ); }
 
 	//! Returns the number of items in the Timeline
-	size_t				getNumItems() const { return mItems.size(); }
+	size_t				getNumItems() const { return mTargetIndex.size(); }
+	//! Returns whether any item, including those of nested Timelines, has yet to complete. Items waiting for their start time count as incomplete.
+	bool				hasActiveItems() const;
 	//! Returns the first item in the timeline the target of which matches \a target
 	TimelineItemRef		find( void *target );
 	//! Returns the latest-starting item in the timeline the target of which matches \a target
@@ -174,6 +225,24 @@ class Timeline : public TimelineItem {
 	//! Returns the default \a autoRemove value for all future TimelineItems added to the Timeline
 	bool	getDefaultAutoRemove() const { return mDefaultAutoRemove; }
 
+	/** Sets whether the Timeline steps its items across the threads of an ip::ExecutionContext. Default \c false.
+		Only items which canStepInParallel(), such as Tweens without callbacks, and whose target has no other item on the Timeline are stepped concurrently, and only once there are
+		at least 1024 of them. All other items are stepped afterwards on the calling thread. Ease and lerp functions must be safe to call concurrently. **/
+	void	setParallel( bool parallel = true ) { mParallel = parallel; }
+	//! Returns whether the Timeline steps its items across the threads of an ip::ExecutionContext
+	bool	isParallel() const { return mParallel; }
+	//! Sets the ip::ExecutionContext a parallel Timeline steps its items with. Defaults to ip::ExecutionContext::getDefault()
+	void	setExecutionContext( const ip::ExecutionContextRef &context ) { mExecutionContext = context; }
+
+	/** Sets whether the Timeline keeps an index of its items' start and end times, so that each step only touches the items whose interval overlaps the span between
+		the previous and the new time, along with looping, ping-ponging and infinite items, which are always stepped. Meant for scrubbing long timelines with many items.
+		Items the playhead doesn't reach are left alone: completed items aren't updated with their final values again, and items ahead of the playhead don't get their
+		reverse start and complete callbacks until it passes over them. Call itemTimeChanged() after changing an item's loop, ping-pong or infinite setting.
+		An indexed Timeline doesn't step items in parallel. Default \c false. **/
+	void	setIntervalIndex( bool enable = true );
+	//! Returns whether the Timeline keeps an index of its items' start and end times
+	bool	isIntervalIndexEnabled() const { return mIntervalIndex; }
+
 	//! Call this to notify the Timeline if the \a item's start-time or duration has changed. Advanced use cases only.
 	void	itemTimeChanged( TimelineItem *item );
 
@@ -201,10 +270,58 @@ class Timeline : public TimelineItem {
 	void						eraseMarked();
 	virtual float				calcDuration() const;
 
+	//! Adds \a item to its ItemGroup and the target index, without modifying it
+	void						storeItem( const TimelineItemRef &item );
+	//! Rebuilds mParallelItems from the items whose targets are unique
+	void						updateParallelItems();
+	//! Steps the rows of \a band, which index mParallelItems
+	void						stepParallelItems( const Area &band );
+
+	//! Rebuilds the interval index from the items
+	void						updateIntervalIndex();
+	//! Fills mIndexedMaxEnds for the subtree of mIndexedItems in [\a begin, \a end), returning its latest end time
+	float						buildIntervalIndex( size_t begin, size_t end );
+	//! Appends to mStepItems the items of the subtree in [\a begin, \a end) whose intervals overlap [\a lo, \a hi]
+	void						queryIntervalIndex( size_t begin, size_t end, float lo, float hi );
+	//! Steps the items affected by the playhead moving from mLastStepTime to mCurrentTime
+	void						stepIndexedItems( bool reverse );
+	//! Returns whether \a item is finite and stepped only when the playhead reaches it
+	static bool					isIntervalIndexed( const TimelineItem *item ) { return ! ( item->mLoop || item->mPingPong || item->mInfinite ); }
+	static bool					stepOrderLess( const TimelineItem *a, const TimelineItem *b ) { return a->mStepOrder < b->mStepOrder; }
+
 	bool						mDefaultAutoRemove;
 	float						mCurrentTime;
 	
-	std::multimap<void*,TimelineItemRef>		mItems;
+	//! Items of a single concrete type, stored contiguously so that stepping them runs the same code back to back
+	struct ItemGroup {
+		const std::type_info			*mType;
+		std::vector<TimelineItemRef>	mItems;
+	};
+
+	std::vector<ItemGroup>					mItemGroups;
+	// every item, by target
+	std::multimap<void*,TimelineItem*,std::less<void*>,TimelineItemPool::Allocator<std::pair<void* const,TimelineItem*> > >	mTargetIndex;
+
+	bool									mParallel, mParallelItemsDirty, mStepReverse;
+	std::vector<TimelineItem*>				mParallelItems;
+	ip::ExecutionContextRef					mExecutionContext;
+	bool									mHasMarkedItems; // whether eraseMarked() has anything to erase
+
+	struct IndexedItem {
+		float			mStartTime, mEndTime;
+		TimelineItem	*mItem;
+
+		bool	operator<( const IndexedItem &rhs ) const { return mStartTime < rhs.mStartTime; }
+	};
+
+	bool									mIntervalIndex, mIntervalIndexDirty;
+	float									mLastStepTime; // the time the items were last stepped to
+	// the finite items sorted by start time, forming an implicit binary tree rooted at the middle of each range. mIndexedMaxEnds holds the latest end time in each subtree
+	std::vector<IndexedItem>				mIndexedItems;
+	std::vector<float>						mIndexedMaxEnds;
+	std::vector<TimelineItem*>				mUnindexedItems, mStepItems;
+	// items stepped even when the playhead doesn't reach them, until they have caught up with it
+	std::vector<TimelineItemRef>			mPendingItems;
 	
   private:
 	Timeline( const Timeline &rhs ); // private to prevent copying; use clone() method instead
@@ -215,7 +332,7 @@ class Cue : public TimelineItem {
   public:
 	Cue( std::function<void ()> fn, float atTime = 0 );
 
-	CueRef	create( std::function<void ()> fn, float atTime = 0 ) { return CueRef( new Cue( fn, atTime ) ); }
+	CueRef	create( std::function<void ()> fn, float atTime = 0 ) { return TimelineItemPool::makeRef( new Cue( fn, atTime ) ); }
 
 	void					setFn( std::function<void ()> fn ) { mFunction = fn; }
 	std::function<void ()>	getFn() const { return mFunction; }
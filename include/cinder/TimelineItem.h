@@ -26,10 +26,65 @@
 
 #include "cinder/Cinder.h"
 
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <boost/checked_delete.hpp>
+
 namespace cinder
 {
 typedef std::shared_ptr<class TimelineItem>	TimelineItemRef;
 
+/** \brief Recycles the memory of TimelineItems, their reference counts and the Timeline's index of them.
+	Blocks are grouped into size classes and returned to a free list rather than to the heap, so steadily creating and destroying tweens doesn't touch the general-purpose heap. **/
+class TimelineItemPool {
+  public:
+	//! Returns a block of at least \a size bytes. Sizes beyond the largest class are allocated with \c operator \c new.
+	static void*	allocate( size_t size );
+	//! Returns \a ptr, which was allocated with a \a size of the same size class, to its free list
+	static void		deallocate( void *ptr, size_t size );
+
+	//! Standard allocator which draws from the pool
+	template<typename T>
+	class Allocator {
+	  public:
+		typedef T					value_type;
+		typedef T*					pointer;
+		typedef const T*			const_pointer;
+		typedef T&					reference;
+		typedef const T&			const_reference;
+		typedef size_t				size_type;
+		typedef std::ptrdiff_t		difference_type;
+		template<typename Y> struct rebind { typedef Allocator<Y> other; };
+
+		Allocator() {}
+		template<typename Y> Allocator( const Allocator<Y> & ) {}
+
+		pointer			address( reference x ) const { return &x; }
+		const_pointer	address( const_reference x ) const { return &x; }
+		pointer			allocate( size_type n, const void * = 0 ) { return static_cast<pointer>( TimelineItemPool::allocate( n * sizeof(T) ) ); }
+		void			deallocate( pointer p, size_type n ) { TimelineItemPool::deallocate( p, n * sizeof(T) ); }
+		size_type		max_size() const { return std::numeric_limits<size_type>::max() / sizeof(T); }
+		void			construct( pointer p, const T &val ) { new( p ) T( val ); }
+		void			destroy( pointer p ) { p->~T(); }
+
+		template<typename Y> bool	operator==( const Allocator<Y> & ) const { return true; }
+		template<typename Y> bool	operator!=( const Allocator<Y> & ) const { return false; }
+	};
+
+	//! Returns a shared_ptr which owns \a item, a TimelineItem created with \c new, with its reference count allocated from the pool
+	template<typename T>
+	static std::shared_ptr<T>	makeRef( T *item )
+	{
+#if defined( CINDER_COCOA )
+		// TR1's shared_ptr can't take an allocator, so only the item itself is pooled
+		return std::shared_ptr<T>( item );
+#else
+		return std::shared_ptr<T>( item, boost::checked_deleter<T>(), Allocator<T>() );
+#endif
+	}
+};
+
 //! Base interface for anything that can go on a Timeline
 class TimelineItem : public std::enable_shared_from_this<TimelineItem>
 {
@@ -37,6 +92,10 @@ class TimelineItem : public std::enable_shared_from_this<TimelineItem>
 	TimelineItem( class Timeline *parent = 0 );
 	TimelineItem( class Timeline *parent, void *target, float startTime, float duration );
 	virtual ~TimelineItem() {}
+
+	//! TimelineItems are allocated from the TimelineItemPool
+	static void*	operator new( size_t size ) { return TimelineItemPool::allocate( size ); }
+	static void		operator delete( void *ptr, size_t size ) { TimelineItemPool::deallocate( ptr, size ); }
 	
 	//! Returns the item's target pointer
 	void* getTarget() const { return mTarget; }
@@ -92,6 +151,8 @@ class TimelineItem : public std::enable_shared_from_this<TimelineItem>
 	virtual void complete( bool reverse ) = 0;
 	//! Call update() only at the beginning of each loop (for example Cues exhibit require this behavior)
 	virtual bool 	updateAtLoopStart() { return false; }
+	//! Returns whether stepping the item touches nothing but the item and its target, so that a parallel Timeline may step it concurrently with other items
+	virtual bool	canStepInParallel() const { return false; }
 	virtual float	calcDuration() const { return mDuration; }
 	virtual void	reverse() = 0;
 	//! Creates a clone of the item
@@ -121,6 +182,8 @@ class TimelineItem : public std::enable_shared_from_this<TimelineItem>
 	bool	mLoop, mPingPong;
 	bool	mUseAbsoluteTime;
 	bool	mAutoRemove;
+	bool	mSteppedInParallel; // set by a parallel Timeline for the items it has already stepped
+	uint32_t	mStepOrder; // the item's position in stepping order, set by a Timeline with an interval index
 	int32_t	mLastLoopIteration;
 	
 	friend class Timeline;
@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include <limits>
 #include <vector>
 #include "cinder/Vector.h"
 #include "cinder/AxisAlignedBox.h"
@@ -30,8 +31,14 @@
 #include "cinder/Matrix.h"
 #include "cinder/Color.h"
 #include "cinder/Rect.h"
+#include "cinder/Exception.h"
+#include "cinder/MemoryTracker.h"
 
 namespace cinder {
+
+namespace ip {
+	typedef std::shared_ptr<class ExecutionContext>	ExecutionContextRef;
+}
 	
 	/*! \brief The TriMesh allows you to create a series of vertices linked into a mesh.
 	 
@@ -65,6 +72,7 @@ namespace cinder {
 	 
 class TriMesh {
  public:
+	TriMesh() : mTrackedMemory( MemoryTracker::TRIMESH ) {}
 	
 	void		clear();
 	
@@ -72,6 +80,7 @@ class TriMesh {
 	bool		hasColorsRGB() const { return ! mColorsRGB.empty(); }
 	bool		hasColorsRGBA() const { return ! mColorsRGBA.empty(); }
 	bool		hasTexCoords() const { return ! mTexCoords.empty(); }
+	bool		hasTangents() const { return ! mTangents.empty(); }
 
 	/*! Creates a vertex which can be referred to with appendTriangle() or appendIndices() */
 	void		appendVertex( const Vec3f &v ) { mVertices.push_back( v ); }
@@ -128,6 +137,10 @@ class TriMesh {
 	std::vector<Vec2f>&				getTexCoords() { return mTexCoords; }	
 	//! Returns a std::vector of Texture coordinates as Vec2fs. There will be one texture coord for each vertex in the TriMesh
 	const std::vector<Vec2f>&		getTexCoords() const { return mTexCoords; }	
+	//! Returns a std::vector of tangents as Vec4fs, one per vertex, as produced by recalculateTangents(). The \c w component holds the handedness of the bitangent
+	std::vector<Vec4f>&				getTangents() { return mTangents; }
+	//! Returns a std::vector of tangents as Vec4fs, one per vertex, as produced by recalculateTangents(). The \c w component holds the handedness of the bitangent
+	const std::vector<Vec4f>&		getTangents() const { return mTangents; }
 	//! Trimesh indices are ordered such that the indices of triangle T are { indices[T*3+0], indices[T*3+1], indices[T*3+2] }
 	std::vector<uint32_t>&			getIndices() { return mIndices; }		
 	//! Trimesh indices are ordered such that the indices of triangle T are { indices[T*3+0], indices[T*3+1], indices[T*3+2] }
@@ -137,11 +150,52 @@ class TriMesh {
 	AxisAlignedBox3f	calcBoundingBox() const;
 	//! Calculates the bounding box of all vertices as transformed by \a transform
 	AxisAlignedBox3f	calcBoundingBox( const Matrix44f &transform ) const;
+	//! Calculates the bounding box of all vertices, splitting large meshes across the threads of \a context
+	AxisAlignedBox3f	calcBoundingBox( const ip::ExecutionContextRef &context ) const;
+
+	/*! Replaces the normals with one per vertex, averaging the normals of the triangles which share it. Each triangle is weighted by its area, or when \a angleWeighted is \c true
+		by the angle of its corner at the vertex, which is unaffected by how the surface around the vertex is triangulated. Large meshes are processed on the threads of \a context when one is supplied. */
+	void		recalculateNormals( bool angleWeighted = false, const ip::ExecutionContextRef &context = ip::ExecutionContextRef() );
+	/*! Replaces the tangents with one per vertex, derived from the texture coordinates following Lengyel's method and orthogonalized against the normals. The \c w component is the
+		handedness of the bitangent, which is <tt>normal.cross( tangent.xyz() ) * tangent.w</tt>. Requires one texture coordinate per vertex, and recalculates the normals first
+		unless there is one per vertex. Large meshes are processed on the threads of \a context when one is supplied. */
+	void		recalculateTangents( const ip::ExecutionContextRef &context = ip::ExecutionContextRef() );
+
+	//! Reorders the triangles to make good use of a post-transform vertex cache of \a cacheSize entries, following Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+	void		optimizeVertexCache( size_t cacheSize = 32 );
+	/*! Reorders clusters of triangles so that those facing away from the mesh's center are drawn first, reducing overdraw from most viewpoints.
+		Clusters begin wherever the triangle order jumps to vertices no longer in a \a cacheSize entry cache, so this preserves most of the benefit of optimizeVertexCache(), which should be called first. */
+	void		optimizeOverdraw( size_t cacheSize = 32 );
+	//! Renumbers the vertices in the order the triangles first reference them, so that vertex fetches walk memory sequentially. Unreferenced vertices move to the end.
+	void		optimizeVertexFetch();
+	//! Performs optimizeVertexCache(), optimizeOverdraw() and optimizeVertexFetch() in turn
+	void		optimize( size_t cacheSize = 32 );
+	//! Returns the average number of vertices per triangle which miss a FIFO post-transform vertex cache of \a cacheSize entries. Ranges from about \c 0.5 for an ideal ordering to \c 3.
+	float		calcCacheMissRatio( size_t cacheSize = 32 ) const;
+
+	/*! Reduces the mesh to at most \a targetNumTriangles triangles, or as close to it as collapses within \a maxError allow, by collapsing edges in order of Garland and Heckbert's
+		quadric error. Each collapse merges a vertex into a neighbor which keeps its position and attributes, so normals, texture coordinates and colors are preserved,
+		and vertices split along seams collapse together so seams stay closed. Borders and seams are constrained to keep their shape. Unreferenced vertices are removed.
+		Returns the largest error of the collapses, roughly the distance the surface moved, in the units of the vertices. */
+	float		simplify( size_t targetNumTriangles, float maxError = std::numeric_limits<float>::max() );
+	/*! Performs simplify() on the triangles in \a indices, which refer to this TriMesh's vertices, rather than on the TriMesh itself, which is left untouched.
+		Since no vertices move, meshes simplified this way to several levels of detail can share one vertex buffer. See gl::LodMesh. */
+	float		calcSimplifiedIndices( std::vector<uint32_t> *indices, size_t targetNumTriangles, float maxError = std::numeric_limits<float>::max() ) const;
+
+	//! Flags for write() which store attributes at reduced precision
+	enum { QUANTIZE_NONE = 0, QUANTIZE_POSITIONS = 1, QUANTIZE_NORMALS = 2 };
 
-	//! This allows you read a TriMesh in from a data file, for instance an .obj file. At present .obj and .dat files are supported
+	/*! Reads a TriMesh saved by write(), replacing the current contents. Files on disk are memory mapped and each attribute array is copied in bulk.
+		Also reads the older streamed format. Throws TriMeshExc if the data is truncated or malformed. */
 	void		read( DataSourceRef in );
-	//! This allows to you write a mesh out to a data file. At present .obj and .dat files are supported.
-	void		write( DataTargetRef out ) const;
+	/*! Writes the TriMesh in a versioned binary format: a 64 byte little-endian header followed by each attribute array, stored contiguously at a 16 byte aligned offset.
+		\a quantize may combine QUANTIZE_POSITIONS, which stores positions as 16 bit fractions of the bounding box, and QUANTIZE_NORMALS, which stores normals
+		as 16 bit octahedral coordinates, reducing them from 12 bytes to 6 and 4 respectively. */
+	void		write( DataTargetRef out, uint32_t quantize = QUANTIZE_NONE ) const;
+
+	/*! Updates the memory accounted to the TriMesh by MemoryTracker to the capacity of its arrays. Called by the bulk modifications, such as clear(), read() and ObjLoader::load().
+		Call it after appending attributes one at a time or modifying the arrays directly. Does nothing unless tracking is enabled or the TriMesh is already tracked. */
+	void		updateTrackedMemory();
 	
  private:
 	std::vector<Vec3f>		mVertices;
@@ -149,7 +203,10 @@ class TriMesh {
 	std::vector<Color>		mColorsRGB;
 	std::vector<ColorA>		mColorsRGBA;
 	std::vector<Vec2f>		mTexCoords;
+	std::vector<Vec4f>		mTangents;
 	std::vector<uint32_t>	mIndices;
+
+	TrackedMemory			mTrackedMemory;
 };
 
 class TriMesh2d {
@@ -221,4 +278,7 @@ class TriMesh2d {
 	std::vector<size_t>		mIndices;
 };
 
+class TriMeshExc : public Exception {
+};
+
 } // namespace cinder
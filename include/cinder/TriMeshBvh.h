@@ -0,0 +1,87 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/TriMesh.h"
+#include "cinder/Ray.h"
+#include "cinder/AxisAlignedBox.h"
+#include "cinder/Area.h"
+
+#include <vector>
+#include <float.h>
+
+namespace cinder {
+
+namespace ip {
+	typedef std::shared_ptr<class ExecutionContext>	ExecutionContextRef;
+}
+
+/** \brief Bounding volume hierarchy over the triangles of a TriMesh, for fast ray picking and box queries on large meshes.
+ *  The hierarchy is built with binned surface area heuristic splits and stored as one flat array of nodes. It copies the
+ *  triangles' vertices, so later changes to the TriMesh require a rebuild. Queries are const and may be run concurrently.
+ *  Triangle indices returned by the queries refer to the source TriMesh, as passed to TriMesh::getTriangleVertices(). **/
+class TriMeshBvh {
+  public:
+	TriMeshBvh() {}
+	//! Builds the hierarchy over the triangles of \a mesh. Large meshes are built on the threads of \a context when one is supplied
+	TriMeshBvh( const TriMesh &mesh, const ip::ExecutionContextRef &context = ip::ExecutionContextRef() );
+
+	//! Returns the number of triangles in the hierarchy
+	size_t				getNumTriangles() const { return mTriangleIndices.size(); }
+	//! Returns the number of nodes in the hierarchy
+	size_t				getNumNodes() const { return mNodes.size(); }
+	//! Returns the bounding box of every triangle
+	AxisAlignedBox3f	getBounds() const;
+
+	//! Returns whether \a ray hits any triangle at a distance in [0,\a maxDistance]. Faster than calcIntersection() since it stops at the first hit found
+	bool	intersects( const Ray &ray, float maxDistance = FLT_MAX ) const;
+	/** Finds the nearest triangle hit by \a ray in front of its origin. Returns \c false if there is none. Otherwise sets \a resultDistance to the
+	 *  hit's distance along the ray, suitable for Ray::calcPosition(), and \a resultTriangle (when non-NULL) to the triangle's index. **/
+	bool	calcIntersection( const Ray &ray, float *resultDistance, size_t *resultTriangle = NULL ) const;
+	//! Replaces the contents of \a resultTriangles with the indices of every triangle which overlaps \a box, in no particular order
+	void	findOverlapping( const AxisAlignedBox3f &box, std::vector<size_t> *resultTriangles ) const;
+
+	//! A node of the hierarchy. Interior nodes have \c numTriangles of \c 0 and store their two children at \c offset and \c offset + 1; leaves store their triangles starting at \c offset
+	struct Node {
+		float		mMin[3];
+		uint32_t	offset;
+		float		mMax[3];
+		uint32_t	numTriangles;
+	};
+
+  private:
+	struct BuildTriangle;
+	struct BuildTask;
+
+	void		build( uint32_t nodeIdx, uint32_t start, uint32_t end, uint32_t depth, std::vector<Node> *nodes, std::vector<BuildTriangle> *triangles, std::vector<BuildTask> *deferred, uint32_t maxDeferredSize ) const;
+	void		buildBand( std::vector<BuildTriangle> *triangles, std::vector<BuildTask> *tasks, const Area &band ) const;
+
+	std::vector<Node>		mNodes;
+	//! three vertices per triangle, in the order the leaves reference them
+	std::vector<Vec3f>		mVertices;
+	std::vector<uint32_t>	mTriangleIndices;
+};
+
+} // namespace cinder
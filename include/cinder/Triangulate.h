@@ -28,17 +28,53 @@
 #include "cinder/Shape2d.h"
 #include "cinder/Path2d.h"
 
+#include <map>
+#include <vector>
+
 struct TESStesselator;
 
 namespace cinder {
 
-//! Converts an arbitrary Shape2d into a TriMesh2d
+namespace ip {
+typedef std::shared_ptr<class ExecutionContext>	ExecutionContextRef;
+}
+
+/** \brief Converts an arbitrary Shape2d into a TriMesh2d
+	calcMesh() consumes the contours added so far, so one Triangulator can be reused for any number of inputs without creating a new tesselator for each. **/
 class Triangulator {
   public:
 	typedef enum Winding { WINDING_ODD, WINDING_NONZERO, WINDING_POSITIVE, WINDING_NEGATIVE, WINDING_ABS_GEQ_TWO } Winding;
 
+	//! Supplies the memory the tesselator allocates. A Triangulator calls it from one thread at a time.
+	class Allocator {
+	  public:
+		virtual ~Allocator() {}
+		virtual void*	allocate( size_t size ) = 0;
+		virtual void	deallocate( void *ptr ) = 0;
+	};
+	typedef std::shared_ptr<Allocator>	AllocatorRef;
+
+	//! An Allocator which keeps the blocks it hands out and recycles freed blocks of the same size, so a reused Triangulator stops allocating once it has seen its largest input
+	class PoolAllocator : public Allocator {
+	  public:
+		PoolAllocator() : mNumBytes( 0 ) {}
+		~PoolAllocator();
+
+		void*	allocate( size_t size );
+		void	deallocate( void *ptr );
+
+		//! Returns the total size of the blocks held by the pool, whether in use or free
+		size_t	getNumBytes() const { return mNumBytes; }
+
+	  protected:
+		std::map<size_t,std::vector<void*> >	mFreeBlocks;
+		size_t									mNumBytes;
+	};
+
 	//! Default constructor
 	Triangulator();
+	//! Constructs a Triangulator whose tesselator takes all of its memory from \a allocator
+	explicit Triangulator( const AllocatorRef &allocator );
 	//! Constructs using a Path2d. \a approximationScale represents how smooth the tesselation is, with 1.0 corresponding to 1:1 with screen space
 	Triangulator( const Path2d &path, float approximationScale = 1.0f );
 	//! Constructs using a Shape2d. \a approximationScale represents how smooth the tesselation is, with 1.0 corresponding to 1:1 with screen space
@@ -53,8 +89,15 @@ class Triangulator {
 	//! Adds a PolyLine2f to the tesselation.
 	void		addPolyLine( const PolyLine2f &polyLine );
 
-	//! Performs the tesselation, returning a TriMesh2d
+	//! Performs the tesselation of everything added since the last call, returning a TriMesh2d. Returns an empty TriMesh2d if nothing was added or tesselation fails.
 	TriMesh2d		calcMesh( Winding winding = WINDING_ODD );
+	//! Discards the contours added since the last calcMesh()
+	void			clear();
+
+	//! Tesselates each of \a shapes independently, returning their meshes in the same order. Each thread of \a context reuses a single Triangulator backed by a PoolAllocator.
+	static std::vector<TriMesh2d>	calcMeshes( const std::vector<Shape2d> &shapes, Winding winding = WINDING_ODD, float approximationScale = 1.0f, const ip::ExecutionContextRef &context = ip::ExecutionContextRef() );
+	//! Tesselates each of \a polyLines independently, returning their meshes in the same order. Each thread of \a context reuses a single Triangulator backed by a PoolAllocator.
+	static std::vector<TriMesh2d>	calcMeshes( const std::vector<PolyLine2f> &polyLines, Winding winding = WINDING_ODD, const ip::ExecutionContextRef &context = ip::ExecutionContextRef() );
 	
 	class Exception : public ci::Exception {
 	};
@@ -63,7 +106,69 @@ class Triangulator {
 	void			allocate();
 	
 	int									mAllocated;
+	AllocatorRef						mAllocator;
 	std::shared_ptr<TESStesselator>		mTess;
+	bool								mHasContours;
+};
+
+//! Converts the outlines of Shape2ds, Path2ds and PolyLine2fs into a TriMesh2d of triangles covering a stroke of a given width, joins and caps
+class StrokeTriangulator {
+  public:
+	typedef enum Join { JOIN_MITER, JOIN_ROUND, JOIN_BEVEL } Join;
+	typedef enum Cap { CAP_BUTT, CAP_ROUND, CAP_SQUARE } Cap;
+
+	//! The stroke's appearance. Defaults match SVG's: a width of 1, miter joins limited to 4x the half width, and butt caps.
+	class Format {
+	  public:
+		Format() : mWidth( 1.0f ), mJoin( JOIN_MITER ), mCap( CAP_BUTT ), mMiterLimit( 4.0f ) {}
+
+		Format&		width( float width ) { mWidth = width; return *this; }
+		Format&		join( Join join ) { mJoin = join; return *this; }
+		Format&		cap( Cap cap ) { mCap = cap; return *this; }
+		//! Sets the longest miter allowed, as a multiple of half the stroke width. Longer miters are beveled.
+		Format&		miterLimit( float limit ) { mMiterLimit = limit; return *this; }
+
+		float		getWidth() const { return mWidth; }
+		Join		getJoin() const { return mJoin; }
+		Cap			getCap() const { return mCap; }
+		float		getMiterLimit() const { return mMiterLimit; }
+
+	  protected:
+		float		mWidth;
+		Join		mJoin;
+		Cap			mCap;
+		float		mMiterLimit;
+	};
+
+	StrokeTriangulator( const Format &format = Format() ) : mFormat( format ) {}
+	//! Constructs using a Path2d. \a approximationScale represents how smooth the curves and round joins are, with 1.0 corresponding to 1:1 with screen space
+	StrokeTriangulator( const Path2d &path, const Format &format = Format(), float approximationScale = 1.0f );
+	//! Constructs using a Shape2d. \a approximationScale represents how smooth the curves and round joins are, with 1.0 corresponding to 1:1 with screen space
+	StrokeTriangulator( const Shape2d &shape, const Format &format = Format(), float approximationScale = 1.0f );
+
+	//! Sets the Format used by contours added afterwards
+	void			setFormat( const Format &format ) { mFormat = format; }
+	const Format&	getFormat() const { return mFormat; }
+
+	//! Adds the outline of each of the contours of \a shape
+	void		addShape( const Shape2d &shape, float approximationScale = 1.0f );
+	//! Adds the outline of \a path, joining its ends if it is closed
+	void		addPath( const Path2d &path, float approximationScale = 1.0f );
+	//! Adds the outline of \a polyLine, joining its ends if it is closed
+	void		addPolyLine( const PolyLine2f &polyLine, float approximationScale = 1.0f );
+	//! Adds the outline through the \a numPoints points of \a points, joining its ends if \a closed
+	void		addPoints( const Vec2f *points, size_t numPoints, bool closed, float approximationScale = 1.0f );
+
+	//! Returns the triangles covering everything added so far. Overlaps occur only where the outline crosses itself or a join is tighter than the stroke is wide.
+	const TriMesh2d&	calcMesh() const { return mMesh; }
+	//! Discards everything added so far
+	void				clear() { mMesh.clear(); }
+
+  protected:
+	void		addFan( const Vec2f &center, float radius, float startRadians, float sweepRadians, float maxStepRadians );
+
+	Format		mFormat;
+	TriMesh2d	mMesh;
 };
 
 } // namespace cinder
\ No newline at end of file
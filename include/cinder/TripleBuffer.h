@@ -0,0 +1,83 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/LockFreeCircularBuffer.h"
+
+#include <boost/noncopyable.hpp>
+
+namespace cinder {
+
+/** \brief Lock-free handoff of the latest value from one producer thread to one consumer thread, neither of which ever waits on the other.
+	The producer writes back() and calls publish(). The consumer calls update() and reads front(). Values published faster than the consumer updates
+	are overwritten rather than queued, so the consumer always sees the most recent one, which suits handing audio blocks or sensor state to the app. **/
+template<typename T>
+class TripleBuffer : private boost::noncopyable {
+  public:
+	TripleBuffer() : mBack( 0 ), mMiddle( 1 ), mFront( 2 ) {}
+	//! Initializes all three buffers to \a value
+	explicit TripleBuffer( const T &value ) : mBack( 0 ), mMiddle( 1 ), mFront( 2 ) { mBuffers[0] = mBuffers[1] = mBuffers[2] = value; }
+
+	//! Returns the buffer being written. Producer thread only.
+	T&			back() { return mBuffers[mBack]; }
+	//! Hands back() to the consumer, replacing any value it hasn't picked up yet. back() is then another buffer, holding an older value. Producer thread only.
+	void		publish()
+	{
+		uint32_t middle;
+		do {
+			middle = mMiddle;
+		} while( ! detail::lockFreeCompareAndSwap( &mMiddle, middle, mBack | FRESH ) );
+		mBack = middle & INDEX_MASK;
+	}
+
+	//! Makes the latest published value front(), if one was published since the last call. Returns whether front() changed. Consumer thread only.
+	bool		update()
+	{
+		uint32_t middle = detail::lockFreeLoadAcquire( &mMiddle );
+		if( ! ( middle & FRESH ) )
+			return false;
+		// only the producer can change a fresh middle, and only to another fresh one
+		while( ! detail::lockFreeCompareAndSwap( &mMiddle, middle, mFront ) )
+			middle = detail::lockFreeLoadAcquire( &mMiddle );
+		mFront = middle & INDEX_MASK;
+		return true;
+	}
+	//! Returns whether a value has been published which update() hasn't picked up yet
+	bool		hasUpdate() const { return ( detail::lockFreeLoadAcquire( &mMiddle ) & FRESH ) != 0; }
+
+	//! Returns the buffer being read. Consumer thread only.
+	T&			front() { return mBuffers[mFront]; }
+	const T&	front() const { return mBuffers[mFront]; }
+
+  private:
+	enum { INDEX_MASK = 3, FRESH = 4 };
+
+	T					mBuffers[3];
+	uint32_t			mBack, mFront;
+	volatile uint32_t	mMiddle; // index of the buffer in between, and whether it holds a value the consumer hasn't seen
+};
+
+} // namespace cinder
@@ -57,7 +57,7 @@ class TweenBase : public TimelineItem {
 	typedef std::function<void ()>		FinishFn;
 	typedef std::function<void ()>		UpdateFn;
 
-	TweenBase( void *target, bool copyStartValue, float startTime, float duration, EaseFn easeFunction = easeNone );
+	TweenBase( void *target, bool copyStartValue, float startTime, float duration, const EaseFn &easeFunction = easeNone );
 	virtual ~TweenBase() {}
 
 	//! change how the tween moves through time
@@ -78,6 +78,9 @@ class TweenBase : public TimelineItem {
 
 	void			setReverseFinishFn( FinishFn reverseFinishFn ) { mReverseFinishFunction = reverseFinishFn; }
 	FinishFn		getReverseFinishFn() const { return mReverseFinishFunction; }
+
+	//! Returns \c true when the tween has no callbacks to run, since it then only writes its target
+	virtual bool	canStepInParallel() const { return ! ( mStartFunction || mReverseStartFunction || mUpdateFunction || mFinishFunction || mReverseFinishFunction ); }
 	
 	class Options {
 	  protected:
@@ -136,13 +139,13 @@ class Tween : public TweenBase {
 
 	// build a tween with a target, target value, duration, and optional ease function
 	Tween( T *target, T endValue, float startTime, float duration,
-			EaseFn easeFunction = easeNone, LerpFn lerpFunction = &tweenLerp<T> )
+			const EaseFn &easeFunction = easeNone, const LerpFn &lerpFunction = &tweenLerp<T> )
 		: TweenBase( target, true, startTime, duration, easeFunction ), mStartValue( *target ), mEndValue( endValue ), mLerpFunction( lerpFunction )
 	{
 	}
 	
 	Tween( T *target, T startValue, T endValue, float startTime, float duration,
-			EaseFn easeFunction = easeNone, LerpFn lerpFunction = &tweenLerp<T> )
+			const EaseFn &easeFunction = easeNone, const LerpFn &lerpFunction = &tweenLerp<T> )
 		: TweenBase( target, false, startTime, duration, easeFunction ), mStartValue( startValue ), mEndValue( endValue ), mLerpFunction( lerpFunction )
 	{
 	}
@@ -202,14 +205,14 @@ class Tween : public TweenBase {
 
 	virtual TimelineItemRef	clone() const
 	{
-		std::shared_ptr<Tween<T> > result( new Tween<T>( *this ) );
+		std::shared_ptr<Tween<T> > result( TimelineItemPool::makeRef( new Tween<T>( *this ) ) );
 		result->mCopyStartValue = false;
 		return result;
 	}
 	
 	virtual TimelineItemRef	cloneReverse() const
 	{
-		std::shared_ptr<Tween<T> > result( new Tween<T>( *this ) );
+		std::shared_ptr<Tween<T> > result( TimelineItemPool::makeRef( new Tween<T>( *this ) ) );
 		std::swap( result->mStartValue, result->mEndValue );
 		result->mCopyStartValue = false;
 		return result;
@@ -238,10 +241,62 @@ class Tween : public TweenBase {
 	LerpFn				mLerpFunction;
 };
 
+//! Functor equivalent of tweenLerp(), used to resolve a TweenT's interpolation at compile time
+template<typename T>
+struct TweenLerp {
+	T operator()( const T &start, const T &end, float time ) const { return tweenLerp<T>( start, end, time ); }
+};
+
+/** \brief Tween whose ease function and interpolation are the types \a EaseT and \a LerpT, resolved at compile time rather than called through an EaseFn and a LerpFn.
+	Setting an EaseFn or a LerpFn on it overrides the respective type. Created by Timeline::applyEase() and Timeline::appendToEase(). **/
+template<typename T, typename EaseT, typename LerpT = TweenLerp<T> >
+class TweenT : public Tween<T> {
+  public:
+	TweenT( T *target, T endValue, float startTime, float duration, const EaseT &easeFunction = EaseT(), const LerpT &lerpFunction = LerpT() )
+		: Tween<T>( target, endValue, startTime, duration, EaseFn(), typename Tween<T>::LerpFn() ), mEase( easeFunction ), mLerp( lerpFunction )
+	{
+	}
+
+	TweenT( T *target, T startValue, T endValue, float startTime, float duration, const EaseT &easeFunction = EaseT(), const LerpT &lerpFunction = LerpT() )
+		: Tween<T>( target, startValue, endValue, startTime, duration, EaseFn(), typename Tween<T>::LerpFn() ), mEase( easeFunction ), mLerp( lerpFunction )
+	{
+	}
+
+  protected:
+	virtual TimelineItemRef	clone() const
+	{
+		std::shared_ptr<TweenT> result( TimelineItemPool::makeRef( new TweenT( *this ) ) );
+		result->mCopyStartValue = false;
+		return result;
+	}
+	
+	virtual TimelineItemRef	cloneReverse() const
+	{
+		std::shared_ptr<TweenT> result( TimelineItemPool::makeRef( new TweenT( *this ) ) );
+		std::swap( result->mStartValue, result->mEndValue );
+		result->mCopyStartValue = false;
+		return result;
+	}
+
+	virtual void update( float relativeTime )
+	{
+		const float time = ( this->mEaseFunction ) ? this->mEaseFunction( relativeTime ) : mEase( relativeTime );
+		if( this->mLerpFunction )
+			*reinterpret_cast<T*>( this->mTarget ) = this->mLerpFunction( this->mStartValue, this->mEndValue, time );
+		else
+			*reinterpret_cast<T*>( this->mTarget ) = mLerp( this->mStartValue, this->mEndValue, time );
+		if( this->mUpdateFunction )
+			this->mUpdateFunction();
+	}
+
+	EaseT	mEase;
+	LerpT	mLerp;
+};
+
 template<typename T>
 class FnTween : public Tween<T> {
   public:
-	FnTween( std::function<void (T)> fn, T startValue, T endValue, float startTime, float duration, EaseFn easeFunction = easeNone, typename Tween<T>::LerpFn lerpFunction = &tweenLerp<T> )
+	FnTween( std::function<void (T)> fn, T startValue, T endValue, float startTime, float duration, const EaseFn &easeFunction = easeNone, const typename Tween<T>::LerpFn &lerpFunction = &tweenLerp<T> )
 		: Tween<T>( &mValue, startValue, endValue, startTime, duration, easeFunction, lerpFunction ), mFn( fn ), mValue( startValue )
 	{
 	}
@@ -252,6 +307,8 @@ class FnTween : public Tween<T> {
 		if( mFn )
 			mFn( mValue );
 	}	
+
+	virtual bool	canStepInParallel() const { return false; }
 	
 	std::function<void (T)>		mFn;
 	T							mValue;
@@ -0,0 +1,174 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Tween.h"
+#include "cinder/Vector.h"
+#include "cinder/Color.h"
+
+#include <vector>
+
+namespace cinder {
+
+//! The number of floats which make up a \a T, which lets a TweenBatch<T> interpolate all of its values as a single array of floats. Zero for types which aren't made up of floats alone.
+template<typename T> struct TweenBatchFloats { enum { VALUE = 0 }; };
+template<> struct TweenBatchFloats<float> { enum { VALUE = 1 }; };
+template<> struct TweenBatchFloats<Vec2f> { enum { VALUE = 2 }; };
+template<> struct TweenBatchFloats<Vec3f> { enum { VALUE = 3 }; };
+template<> struct TweenBatchFloats<Vec4f> { enum { VALUE = 4 }; };
+template<> struct TweenBatchFloats<Color> { enum { VALUE = 3 }; };
+template<> struct TweenBatchFloats<ColorA> { enum { VALUE = 4 }; };
+
+namespace detail {
+//! Sets the \a count floats of \a result to <tt>start * ( 1 - time ) + end * time</tt>, using SSE2 or NEON when available
+void tweenLerpFloats( float *result, const float *start, const float *end, size_t count, float time );
+} // namespace detail
+
+/** \brief Tweens \a count values of type \a T toward their own end values along a single shared ease curve, as one TimelineItem.
+	The ease function is evaluated once per step rather than once per value, and packed arrays of float-based types (float, Vec2f, Vec3f, Vec4f, Color, ColorA) are interpolated with SIMD.
+	The values may be \a stride bytes apart, so an array of Anim<T> can be driven in place. Its target is the first value; the values must outlive the batch or it must be removed from its Timeline first.
+	\code timeline().add( TweenBatch<Vec3f>::create( &positions[0], positions.size(), &destinations[0], 2.0f, EaseInOutQuad() ) ); \endcode **/
+template<typename T>
+class TweenBatch : public TimelineItem {
+  public:
+	typedef std::function<T (const T&, const T&, float)>	LerpFn;
+
+	//! Tweens the \a count values at \a values, \a stride bytes apart, from their values when the batch starts to the \a count values at \a endValues
+	TweenBatch( T *values, size_t count, const T *endValues, float startTime, float duration, const EaseFn &easeFunction = easeNone, size_t stride = sizeof(T) )
+		: TimelineItem( 0, values, startTime, duration ), mStride( stride ), mStartValues( count ), mEndValues( endValues, endValues + count ), mEaseFunction( easeFunction ), mCopyStartValues( true )
+	{
+		copyStartValues();
+	}
+
+	//! Tweens the \a count values at \a values, \a stride bytes apart, from the \a count values at \a startValues to the \a count values at \a endValues
+	TweenBatch( T *values, size_t count, const T *startValues, const T *endValues, float startTime, float duration, const EaseFn &easeFunction = easeNone, size_t stride = sizeof(T) )
+		: TimelineItem( 0, values, startTime, duration ), mStride( stride ), mStartValues( startValues, startValues + count ), mEndValues( endValues, endValues + count ), mEaseFunction( easeFunction ), mCopyStartValues( false )
+	{
+	}
+
+	//! Returns a TweenBatch which tweens the \a count values at \a values, \a stride bytes apart, to the \a count values at \a endValues. Add it to a Timeline with Timeline::add() or Timeline::insert().
+	static std::shared_ptr<TweenBatch<T> >	create( T *values, size_t count, const T *endValues, float duration, const EaseFn &easeFunction = easeNone, size_t stride = sizeof(T) )
+	{
+		return TimelineItemPool::makeRef( new TweenBatch<T>( values, count, endValues, 0, duration, easeFunction, stride ) );
+	}
+	//! Returns a TweenBatch which tweens the \a count values at \a values, \a stride bytes apart, from the \a count values at \a startValues to the \a count values at \a endValues
+	static std::shared_ptr<TweenBatch<T> >	create( T *values, size_t count, const T *startValues, const T *endValues, float duration, const EaseFn &easeFunction = easeNone, size_t stride = sizeof(T) )
+	{
+		return TimelineItemPool::makeRef( new TweenBatch<T>( values, count, startValues, endValues, 0, duration, easeFunction, stride ) );
+	}
+	//! Returns a TweenBatch which tweens the values of the \a count Anim<T>'s at \a anims to the \a count values at \a endValues
+	static std::shared_ptr<TweenBatch<T> >	create( Anim<T> *anims, size_t count, const T *endValues, float duration, const EaseFn &easeFunction = easeNone )
+	{
+		return create( anims->ptr(), count, endValues, duration, easeFunction, sizeof(Anim<T>) );
+	}
+
+	//! Returns the number of values the batch tweens
+	size_t		getCount() const { return mEndValues.size(); }
+	//! Returns the \a index'th value the batch tweens
+	T*			getValue( size_t index ) const { return reinterpret_cast<T*>( static_cast<uint8_t*>( mTarget ) + index * mStride ); }
+	//! Returns the number of bytes between successive values
+	size_t		getStride() const { return mStride; }
+
+	//! Returns the starting values. If the batch will copy its values upon starting (isCopyStartValues()) and has not started, these are the values when the batch was created
+	const std::vector<T>&	getStartValues() const { return mStartValues; }
+	//! Returns the end values, which may be modified in place to retarget the batch
+	std::vector<T>&			getEndValues() { return mEndValues; }
+	const std::vector<T>&	getEndValues() const { return mEndValues; }
+
+	//! Returns whether the batch will copy its values upon starting
+	bool	isCopyStartValues() const { return mCopyStartValues; }
+
+	void	setEaseFn( const EaseFn &easeFunction ) { mEaseFunction = easeFunction; }
+	EaseFn	getEaseFn() const { return mEaseFunction; }
+
+	//! Interpolates each value with \a lerpFn rather than tweenLerp(), which disables the SIMD path
+	void	setLerpFn( const LerpFn &lerpFn ) { mLerpFunction = lerpFn; }
+
+	//! A batch only writes its own values, so it may always be stepped in parallel with other items
+	virtual bool	canStepInParallel() const { return true; }
+
+  protected:
+	void copyStartValues()
+	{
+		for( size_t i = 0; i < mStartValues.size(); ++i )
+			mStartValues[i] = *getValue( i );
+	}
+
+	virtual void start( bool reverse )
+	{
+		if( mCopyStartValues )
+			copyStartValues();
+	}
+
+	virtual void update( float relativeTime )
+	{
+		const size_t count = mEndValues.size();
+		if( ! count )
+			return;
+
+		const float time = mEaseFunction( relativeTime );
+		if( ( TweenBatchFloats<T>::VALUE > 0 ) && ( sizeof(T) == TweenBatchFloats<T>::VALUE * sizeof(float) ) && ( mStride == sizeof(T) ) && ( ! mLerpFunction ) )
+			detail::tweenLerpFloats( static_cast<float*>( mTarget ), reinterpret_cast<const float*>( &mStartValues[0] ), reinterpret_cast<const float*>( &mEndValues[0] ),
+										count * TweenBatchFloats<T>::VALUE, time );
+		else if( mLerpFunction ) {
+			for( size_t i = 0; i < count; ++i )
+				*getValue( i ) = mLerpFunction( mStartValues[i], mEndValues[i], time );
+		}
+		else {
+			for( size_t i = 0; i < count; ++i )
+				*getValue( i ) = tweenLerp<T>( mStartValues[i], mEndValues[i], time );
+		}
+	}
+
+	virtual void complete( bool reverse ) {}
+
+	virtual void reverse()
+	{
+		mStartValues.swap( mEndValues );
+	}
+
+	virtual TimelineItemRef	clone() const
+	{
+		std::shared_ptr<TweenBatch<T> > result( TimelineItemPool::makeRef( new TweenBatch<T>( *this ) ) );
+		result->mCopyStartValues = false;
+		return result;
+	}
+
+	virtual TimelineItemRef	cloneReverse() const
+	{
+		std::shared_ptr<TweenBatch<T> > result( TimelineItemPool::makeRef( new TweenBatch<T>( *this ) ) );
+		result->mStartValues.swap( result->mEndValues );
+		result->mCopyStartValues = false;
+		return result;
+	}
+
+	size_t				mStride;
+	std::vector<T>		mStartValues, mEndValues;
+	EaseFn				mEaseFunction;
+	LerpFn				mLerpFunction;
+	bool				mCopyStartValues;
+};
+
+} // namespace cinder
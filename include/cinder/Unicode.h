@@ -3,6 +3,10 @@
 #include "cinder/Cinder.h"
 #include "cinder/Function.h"
 
+#include <map>
+#include <string>
+#include <vector>
+
 namespace cinder {
 
 //! Returns the number of characters (not bytes) in the the UTF-8 string \a str. Optimize operation by supplying a non-default \a lengthInBytes of \a str.
@@ -13,5 +17,35 @@ uint32_t	nextCharUtf8( const char *str, size_t *inOutByte, size_t lengthInBytes
 size_t		advanceCharUtf8( const char *str, size_t numChars, size_t lengthInBytes = 0 );
 
 void		lineBreakUtf8( const char *str, const std::function<bool(const char *, size_t)> &measureFn, std::function<void(const char *,size_t)> lineProcessFn );
+/** Breaks \a str into lines no wider than \a maxWidth, where \a charAdvances holds the advance of each character of \a str as counted by stringLengthUtf8().
+	Uses the same break opportunities as the measuring lineBreakUtf8() in a single linear scan, since no line needs to be measured more than once. **/
+void		lineBreakUtf8( const char *str, const float *charAdvances, float maxWidth, std::function<void(const char *,size_t)> lineProcessFn );
+
+/** \brief Breaks a UTF-8 string whose character advances are known into lines, for wrapping the same text at one or more widths.
+	The break opportunities are found once, on construction, after which calcLines() is a linear scan whose results are cached per width. **/
+class LineBreakerUtf8 {
+  public:
+	struct Line {
+		size_t	mStartByte, mLengthInBytes;
+		//! The sum of the line's advances, including any trailing spaces
+		float	mWidth;
+	};
+
+	//! \a charAdvances holds the advance of each character of \a str as counted by stringLengthUtf8()
+	LineBreakerUtf8( const std::string &str, const std::vector<float> &charAdvances );
+
+	const std::string&	getString() const { return mString; }
+	size_t				getNumChars() const { return mAdvances.size(); }
+
+	//! Returns the lines of the string wrapped at \a maxWidth. The lines for the most recently requested widths are cached.
+	const std::vector<Line>&	calcLines( float maxWidth );
+
+  private:
+	std::string					mString;
+	std::vector<float>			mAdvances;
+	std::vector<size_t>			mCharStartBytes; // one per character plus the end of the string
+	std::vector<char>			mCharBreaks; // the break status after each character
+	std::map<float,std::vector<Line> >	mCache;
+};
 
 }
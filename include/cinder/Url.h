@@ -90,7 +90,8 @@ class IStreamUrlImpl {
 //! A pointer to an instance of an IStreamUrl. Can be created using IStreamUrl::createRef()
 typedef std::shared_ptr<class IStreamUrl>	IStreamUrlRef;
 
-/** \warning IStreamUrl does not currently support proper random access **/
+/** \warning IStreamUrl only supports random access on platforms which use libcurl, where seeking beyond the buffered data issues an HTTP range request
+	and recently read blocks are cached. Elsewhere seeks are limited to the buffered data. **/
 class IStreamUrl : public IStream {
   public:
 	//! Creates a new IStreamUrlRef from the Url \a url with an optional login and password
@@ -0,0 +1,108 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/DataSource.h"
+#include "cinder/Filesystem.h"
+#include "cinder/Thread.h"
+#include "cinder/Url.h"
+#include "cinder/UrlDownloader.h"
+
+#include <boost/noncopyable.hpp>
+#include <ctime>
+#include <list>
+#include <map>
+
+namespace cinder {
+
+typedef std::shared_ptr<class UrlCache>		UrlCacheRef;
+
+/** \brief Caches downloaded URLs on disk across runs.
+	Responses are stored keyed by URL and reused while fresh according to their \c Cache-Control \c max-age. Stale entries are revalidated with a
+	conditional request using the stored \c ETag and \c Last-Modified headers, and \c no-store responses aren't cached. When the total size exceeds
+	the limit the least recently used entries are evicted. If a download fails a stale cached copy is used instead, so previously seen resources keep loading offline.
+	Validation relies on HTTP headers, which only the libcurl backend of UrlDownloader reports; elsewhere every load refetches and the cache only serves as an offline fallback. **/
+class UrlCache : private boost::noncopyable {
+  public:
+	//! Creates a UrlCache storing at most \a maxSize bytes in \a directory, which defaults to a subdirectory of getTemporaryDirectory()
+	static UrlCacheRef	create( const fs::path &directory = fs::path(), uint64_t maxSize = 256 * 1024 * 1024 ) { return UrlCacheRef( new UrlCache( directory, maxSize ) ); }
+	//! Returns a shared UrlCache with the default location and size, created upon first use
+	static UrlCacheRef	getDefault();
+
+	/** Returns a DataSource for the contents of \a url, downloading it through \a downloader (or the default UrlDownloader) only if the cached copy is missing or stale.
+		Blocks until the download finishes. Throws StreamExc if the download fails and nothing is cached. **/
+	DataSourceRef		load( const Url &url, UrlDownloaderRef downloader = UrlDownloaderRef() );
+
+	//! Returns the directory holding the cached files
+	const fs::path&		getDirectory() const { return mDirectory; }
+	//! Returns the limit on the total size of the cached files
+	uint64_t			getMaxSize() const { return mMaxSize; }
+	//! Sets the limit on the total size of the cached files, evicting entries as needed
+	void				setMaxSize( uint64_t maxSize );
+	//! Returns the total size of the cached files
+	uint64_t			getSize() const;
+
+	//! Removes every entry and its file
+	void				clear();
+
+  private:
+	UrlCache( const fs::path &directory, uint64_t maxSize );
+
+	struct Entry {
+		Entry() : mSize( 0 ), mExpires( 0 ) {}
+
+		std::string		mUrl;
+		std::string		mFileName;
+		uint64_t		mSize;
+		std::time_t		mExpires;
+		std::string		mETag, mLastModified;
+	};
+
+	typedef std::list<Entry>								EntryList;
+	typedef std::map<std::string,EntryList::iterator>		EntryMap;
+
+	bool				find( const std::string &url, Entry *entry );
+	void				store( const Entry &entry );
+	void				evict();
+	void				removeFile( const std::string &fileName );
+	std::string			createFileName( const std::string &url );
+	void				readIndex();
+	void				writeIndex() const;
+
+	fs::path			mDirectory;
+	uint64_t			mMaxSize, mSize;
+	uint32_t			mFileCounter;
+	EntryList			mEntries;		// most recently used first
+	EntryMap			mEntryMap;		// keyed by URL
+	mutable std::mutex	mMutex;
+};
+
+//! Returns a DataSource for \a url loaded through the default UrlCache
+DataSourceRef	loadUrlCached( const Url &url );
+inline DataSourceRef	loadUrlCached( const std::string &urlString ) { return loadUrlCached( Url( urlString ) ); }
+
+} // namespace cinder
@@ -0,0 +1,149 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Url.h"
+#include "cinder/Buffer.h"
+#include "cinder/Function.h"
+#include "cinder/Thread.h"
+
+#include <boost/noncopyable.hpp>
+#include <utility>
+#include <vector>
+
+namespace cinder {
+
+typedef std::shared_ptr<class UrlDownload>		UrlDownloadRef;
+typedef std::shared_ptr<class UrlDownloader>	UrlDownloaderRef;
+
+//! The eventual result of an asynchronous URL download, analogous to a future
+class UrlDownload : private boost::noncopyable {
+  public:
+	//! Callback receiving the finished download
+	typedef std::function<void(UrlDownloadRef)>		CompletionFn;
+	//! HTTP headers as name and value pairs
+	typedef std::vector<std::pair<std::string,std::string> >	HeaderList;
+
+	//! Returns the URL being downloaded
+	const Url&	getUrl() const { return mUrl; }
+
+	//! Returns whether the download has finished, successfully or not
+	bool		isReady() const;
+	//! Returns whether the download has finished unsuccessfully, including when it was canceled
+	bool		hasFailed() const;
+	//! Blocks until the download has finished
+	void		wait() const;
+	//! Blocks until the download has finished and returns its contents, which are empty if the download failed
+	Buffer		getBuffer() const;
+	//! Blocks until the download has finished and returns the HTTP response code, or \c 0 if it is not known
+	long		getResponseCode() const;
+	//! Blocks until the download has finished and returns the value of the response header \a name, matched case-insensitively, or an empty string if it wasn't sent or isn't known
+	std::string	getResponseHeader( const std::string &name ) const;
+
+	//! Requests that the download be abandoned. It finishes as failed soon after unless it has already finished.
+	void		cancel();
+	//! Returns whether cancel() has been called
+	bool		isCanceled() const;
+
+  private:
+	UrlDownload( const Url &url, const std::string &user, const std::string &password, const std::vector<std::string> &requestHeaders, const CompletionFn &completionFn );
+
+	void		setResult( const Buffer &buffer, long responseCode, const HeaderList &responseHeaders, bool failed );
+
+	Url								mUrl;
+	std::string						mUser, mPassword;
+	std::vector<std::string>		mRequestHeaders;
+	CompletionFn					mCompletionFn;
+
+	mutable std::mutex				mMutex;
+	mutable std::condition_variable	mReadyCond;
+	bool							mReady, mFailed, mCanceled;
+	long							mResponseCode;
+	HeaderList						mResponseHeaders;
+	Buffer							mBuffer;
+
+	friend class UrlDownloader;
+	friend class UrlDownloaderImpl;
+};
+
+//! \cond
+// This is an abstract base class for implementing UrlDownloader
+class UrlDownloaderImpl {
+  public:
+	virtual ~UrlDownloaderImpl() {}
+
+	//! Starts \a download once fewer than the maximum number of transfers are active
+	virtual void	enqueue( const UrlDownloadRef &download ) = 0;
+	virtual size_t	getNumPending() const = 0;
+
+  protected:
+	static const std::string&	getUser( const UrlDownloadRef &download ) { return download->mUser; }
+	static const std::string&	getPassword( const UrlDownloadRef &download ) { return download->mPassword; }
+	static const std::vector<std::string>&	getRequestHeaders( const UrlDownloadRef &download ) { return download->mRequestHeaders; }
+	//! Publishes the result of \a download and calls its CompletionFn
+	static void					complete( const UrlDownloadRef &download, const Buffer &buffer, long responseCode, bool failed ) { complete( download, buffer, responseCode, UrlDownload::HeaderList(), failed ); }
+	static void					complete( const UrlDownloadRef &download, const Buffer &buffer, long responseCode, const UrlDownload::HeaderList &responseHeaders, bool failed );
+};
+//! \endcond
+
+/** \brief Downloads many URLs concurrently in the background.
+	Where libcurl is the URL backend a single thread drives every transfer through one curl multi handle, which reuses kept-alive connections
+	to the same host across downloads. Elsewhere a pool of threads reads through IStreamUrl.
+	Completion callbacks are called on the background thread; use App::dispatchAsync() from them to get back to the app's thread. **/
+class UrlDownloader : private boost::noncopyable {
+  public:
+	//! Creates a UrlDownloader which runs up to \a maxConcurrent transfers at once
+	static UrlDownloaderRef		create( int32_t maxConcurrent = 8 ) { return UrlDownloaderRef( new UrlDownloader( maxConcurrent ) ); }
+	//! Returns a shared UrlDownloader, created upon first use
+	static UrlDownloaderRef		getDefault();
+
+	//! Abandons active and pending downloads, which finish as failed
+	~UrlDownloader();
+
+	//! Downloads \a url in the background. If \a completionFn is supplied it is called with the result on the background thread.
+	UrlDownloadRef	download( const Url &url, const UrlDownload::CompletionFn &completionFn = UrlDownload::CompletionFn() );
+	//! Downloads \a url in the background with a login and password. If \a completionFn is supplied it is called with the result on the background thread.
+	UrlDownloadRef	download( const Url &url, const std::string &user, const std::string &password, const UrlDownload::CompletionFn &completionFn = UrlDownload::CompletionFn() );
+	/** Downloads \a url in the background, sending the extra HTTP \a requestHeaders, each formatted like <tt>"If-None-Match: \"abc\""</tt>.
+		Request and response headers are only supported by the libcurl backend; elsewhere \a requestHeaders are ignored and no response headers are reported. **/
+	UrlDownloadRef	download( const Url &url, const std::vector<std::string> &requestHeaders, const UrlDownload::CompletionFn &completionFn = UrlDownload::CompletionFn() );
+	//! Returns whether downloads send request headers and report response headers
+	static bool		supportsHeaders();
+
+	//! Returns the number of downloads which haven't started yet
+	size_t			getNumPending() const { return mImpl->getNumPending(); }
+
+  private:
+	UrlDownloader( int32_t maxConcurrent );
+
+	std::shared_ptr<UrlDownloaderImpl>	mImpl;
+};
+
+//! Downloads \a url on the default UrlDownloader. If \a completionFn is supplied it is called with the result on the background thread.
+UrlDownloadRef	loadUrlAsync( const Url &url, const UrlDownload::CompletionFn &completionFn = UrlDownload::CompletionFn() );
+
+} // namespace cinder
@@ -23,9 +23,15 @@
 #pragma once
 
 #include "cinder/Url.h"
+#include "cinder/UrlDownloader.h"
+
+#include <deque>
+#include <map>
+#include <vector>
 
 typedef void CURL;
 typedef void CURLM;
+struct curl_slist;
 
 namespace cinder {
 
@@ -44,8 +50,24 @@ class IStreamUrlImplCurl : public IStreamUrlImpl {
 	virtual void		IORead( void *t, size_t size );
 
   private:
+	struct CachedBlock {
+		std::vector<uint8_t>	mData;
+		uint64_t				mLastUse;
+	};
+
 	int					bufferRemaining() const { return mBufferedBytes - mBufferOffset; }
 	void				fillBuffer( int wantBytes ) const;
+	//! Grows the buffer so that \a bytes more fit after the buffered bytes. Returns false if the allocation fails.
+	bool				reserveBuffer( int bytes ) const;
+	//! Restarts the transfer at \a offset, with a range request if the server supports them, otherwise by reading through from the start
+	void				startTransfer( off_t offset ) const;
+	void				stopTransfer() const;
+	//! Called with the first data of a transfer to learn whether the server honored the range, and the size of the resource
+	void				checkRange() const;
+	//! Copies the complete blocks among the first \a bytes of the buffer into the block cache
+	void				cacheBuffered( int bytes ) const;
+	//! Appends the cached block holding the byte after the buffer, if any, to the buffer
+	bool				appendCachedBlock() const;
 	
 	static size_t		writeCallback( char *buffer, size_t size, size_t nitems, void *userp );   
   
@@ -57,6 +79,15 @@ class IStreamUrlImplCurl : public IStreamUrlImpl {
 	mutable int still_running;				// Is background url fetch still in progress
 	mutable bool			mStartedRead;
 
+	mutable bool			mTransferPending;	// a seek stopped the transfer, which restarts at the end of the buffer on the next read
+	mutable off_t			mTransferOffset;	// where in the file the current transfer starts
+	mutable off_t			mSkipBytes;			// leading bytes of the transfer to discard, when it couldn't start at mTransferOffset
+	mutable bool			mRangeRequested, mCheckedRange;
+	mutable bool			mRangesSupported;	// only HTTP supports ranges, and a server which ignores one clears this
+
+	mutable std::map<off_t,CachedBlock>	mBlockCache;	// keyed by the block's index in the file
+	mutable uint64_t		mBlockCacheUses;
+
 	mutable off_t			mSize;
 	mutable bool			mSizeCached;
 	mutable long			mResponseCode;
@@ -67,6 +98,56 @@ class IStreamUrlImplCurl : public IStreamUrlImpl {
 	mutable int			mBufferOffset, mBufferedBytes;
 	mutable off_t		mBufferFileOffset;	// where in the file the buffer starts
 	static const int	DEFAULT_BUFFER_SIZE = 4096;
+	static const int	BLOCK_SIZE = 65536;
+	static const size_t	MAX_CACHED_BLOCKS = 64;
+	// seeks up to this far past the buffer read through the data rather than issuing a new request
+	static const int	MAX_SKIP_AHEAD = 65536;
+};
+
+//! \cond
+// Drives every transfer of a UrlDownloader from one thread through a single curl multi handle, whose connection cache keeps connections alive between downloads
+class UrlDownloaderImplCurl : public UrlDownloaderImpl {
+  public:
+	UrlDownloaderImplCurl( int32_t maxConcurrent );
+	~UrlDownloaderImplCurl();
+
+	virtual void	enqueue( const UrlDownloadRef &download );
+	virtual size_t	getNumPending() const;
+
+  private:
+	struct Transfer {
+		UrlDownloadRef	mDownload;
+		CURL			*mCurl;
+		std::string		mUserColonPassword;
+		curl_slist		*mRequestHeaders;
+		UrlDownload::HeaderList	mResponseHeaders;
+		Buffer			mBuffer;
+		size_t			mSize;
+	};
+
+	void			threadFn();
+	void			startTransfer( const UrlDownloadRef &download );
+	void			finishTransfer( Transfer *transfer, long responseCode, bool failed );
+	void			waitForActivity();
+
+	static size_t	writeCallback( char *buffer, size_t size, size_t nitems, void *userp );
+	static size_t	headerCallback( char *buffer, size_t size, size_t nitems, void *userp );
+
+	CURLM								*mMulti;
+	int32_t								mMaxConcurrent;
+	std::vector<Transfer*>				mActive;		// only touched by the transfer thread
+	std::vector<CURL*>					mIdleHandles;	// finished easy handles, reset and ready for reuse
+
+	std::shared_ptr<std::thread>		mThread;
+	mutable std::mutex					mMutex;
+	std::condition_variable				mPendingCond;
+	std::deque<UrlDownloadRef>			mPending;
+	bool								mQuit;
+
+	// the longest the thread sleeps in select() before checking for new or canceled downloads
+	static const long	MAX_WAIT_MS = 100;
+	static const size_t	INITIAL_BUFFER_SIZE = 16384;
 };
+//! \endcond
 
 } // namespace cinder
\ No newline at end of file
@@ -55,6 +55,9 @@ void launchWebBrowser( const Url &url );
 	
 //! Delete the file at \a path. Fails quietly if the path does not exist.
 void deleteFile( const fs::path &path );
+/** Maps the file at \a path into memory read-only and returns its contents, which stay mapped for the lifetime of the result. Returns NULL upon failure.
+	\a size receives the size of the file in bytes. **/
+std::shared_ptr<const void> mapFile( const fs::path &path, size_t *size );
 
 //! Returns a vector of substrings split by the separator \a separator. <tt>split( "one two three", ' ' ) -> [ "one", "two", "three" ]</tt> If \a compress is TRUE, it will consider consecutive separators as one.
 std::vector<std::string> split( const std::string &str, char separator, bool compress = true );
@@ -97,7 +100,20 @@ extern uint32_t swapEndian( uint32_t val );
 extern float	swapEndian( float val );
 extern double	swapEndian( double val );
 
+//! Swaps the byte order of every value in the \a blockSizeInBytes bytes at \a blockPtr, 16 bytes at a time where SSE2 is available
+inline void swapEndianBlock( int8_t *blockPtr, size_t blockSizeInBytes ) {}
+inline void swapEndianBlock( uint8_t *blockPtr, size_t blockSizeInBytes ) {}
+extern void swapEndianBlock( int16_t *blockPtr, size_t blockSizeInBytes );
 extern void swapEndianBlock( uint16_t *blockPtr, size_t blockSizeInBytes );
+extern void swapEndianBlock( int32_t *blockPtr, size_t blockSizeInBytes );
+extern void swapEndianBlock( uint32_t *blockPtr, size_t blockSizeInBytes );
 extern void swapEndianBlock( float *blockPtr, size_t blockSizeInBytes );
+extern void swapEndianBlock( double *blockPtr, size_t blockSizeInBytes );
+
+// ALIGNED MEMORY
+//! Allocates \a size bytes whose address is a multiple of \a alignment, which must be a power of two. Free the result with alignedFree()
+void*	alignedMalloc( size_t size, size_t alignment );
+//! Frees memory allocated with alignedMalloc(). Accepts NULL.
+void	alignedFree( void *ptr );
 
 } // namespace cinder
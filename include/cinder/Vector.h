@@ -35,6 +35,19 @@
 
 #include "cinder/CinderMath.h"
 
+// SSE or NEON implementations of Vec4f and Matrix44f arithmetic, which keep the scalar memory layouts. Define CINDER_NO_SIMD_MATH for the whole project to use the scalar templates instead
+#if ! defined( CINDER_NO_SIMD_MATH )
+	#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 1 ) )
+		#define CINDER_SIMD_MATH
+		#define CINDER_SIMD_MATH_SSE
+		#include <xmmintrin.h>
+	#elif defined( __ARM_NEON__ )
+		#define CINDER_SIMD_MATH
+		#define CINDER_SIMD_MATH_NEON
+		#include <arm_neon.h>
+	#endif
+#endif
+
 namespace cinder {
 
 //!  \cond
@@ -1254,6 +1267,54 @@ class Vec4
 	static Vec4<T> NaN()   { return Vec4<T>( math<T>::NaN(), math<T>::NaN(), math<T>::NaN(), math<T>::NaN() ); }
 };
 
+#if defined( CINDER_SIMD_MATH )
+//!  \cond
+namespace detail {
+// Unaligned four float primitives shared by the SSE and NEON paths of Vec4f and Matrix44f. Each operation rounds like its scalar equivalent
+#if defined( CINDER_SIMD_MATH_SSE )
+typedef __m128 SimdFloat4;
+inline SimdFloat4	simdLoad( const float *p ) { return _mm_loadu_ps( p ); }
+inline void			simdStore( float *p, SimdFloat4 v ) { _mm_storeu_ps( p, v ); }
+inline SimdFloat4	simdSplat( float f ) { return _mm_set1_ps( f ); }
+inline SimdFloat4	simdAdd( SimdFloat4 a, SimdFloat4 b ) { return _mm_add_ps( a, b ); }
+inline SimdFloat4	simdSub( SimdFloat4 a, SimdFloat4 b ) { return _mm_sub_ps( a, b ); }
+inline SimdFloat4	simdMul( SimdFloat4 a, SimdFloat4 b ) { return _mm_mul_ps( a, b ); }
+inline SimdFloat4	simdDiv( SimdFloat4 a, SimdFloat4 b ) { return _mm_div_ps( a, b ); }
+inline SimdFloat4	simdNegate( SimdFloat4 a ) { return _mm_xor_ps( a, _mm_set1_ps( -0.0f ) ); }
+#else
+typedef float32x4_t SimdFloat4;
+inline SimdFloat4	simdLoad( const float *p ) { return vld1q_f32( p ); }
+inline void			simdStore( float *p, SimdFloat4 v ) { vst1q_f32( p, v ); }
+inline SimdFloat4	simdSplat( float f ) { return vdupq_n_f32( f ); }
+inline SimdFloat4	simdAdd( SimdFloat4 a, SimdFloat4 b ) { return vaddq_f32( a, b ); }
+inline SimdFloat4	simdSub( SimdFloat4 a, SimdFloat4 b ) { return vsubq_f32( a, b ); }
+inline SimdFloat4	simdMul( SimdFloat4 a, SimdFloat4 b ) { return vmulq_f32( a, b ); }
+inline SimdFloat4	simdNegate( SimdFloat4 a ) { return vnegq_f32( a ); }
+#endif
+
+inline Vec4<float>	simdToVec4f( SimdFloat4 v ) { Vec4<float> result; simdStore( &result.x, v ); return result; }
+} // namespace detail
+
+template<> inline const Vec4<float>	Vec4<float>::operator+( const Vec4<float>& rhs ) const { return detail::simdToVec4f( detail::simdAdd( detail::simdLoad( &x ), detail::simdLoad( &rhs.x ) ) ); }
+template<> inline const Vec4<float>	Vec4<float>::operator-( const Vec4<float>& rhs ) const { return detail::simdToVec4f( detail::simdSub( detail::simdLoad( &x ), detail::simdLoad( &rhs.x ) ) ); }
+template<> inline const Vec4<float>	Vec4<float>::operator*( const Vec4<float>& rhs ) const { return detail::simdToVec4f( detail::simdMul( detail::simdLoad( &x ), detail::simdLoad( &rhs.x ) ) ); }
+template<> inline Vec4<float>&		Vec4<float>::operator+=( const Vec4<float>& rhs ) { detail::simdStore( &x, detail::simdAdd( detail::simdLoad( &x ), detail::simdLoad( &rhs.x ) ) ); return *this; }
+template<> inline Vec4<float>&		Vec4<float>::operator-=( const Vec4<float>& rhs ) { detail::simdStore( &x, detail::simdSub( detail::simdLoad( &x ), detail::simdLoad( &rhs.x ) ) ); return *this; }
+template<> inline Vec4<float>&		Vec4<float>::operator*=( const Vec4<float>& rhs ) { detail::simdStore( &x, detail::simdMul( detail::simdLoad( &x ), detail::simdLoad( &rhs.x ) ) ); return *this; }
+template<> inline Vec4<float>&		Vec4<float>::operator+=( float rhs ) { detail::simdStore( &x, detail::simdAdd( detail::simdLoad( &x ), detail::simdSplat( rhs ) ) ); return *this; }
+template<> inline Vec4<float>&		Vec4<float>::operator-=( float rhs ) { detail::simdStore( &x, detail::simdSub( detail::simdLoad( &x ), detail::simdSplat( rhs ) ) ); return *this; }
+template<> inline Vec4<float>&		Vec4<float>::operator*=( float rhs ) { detail::simdStore( &x, detail::simdMul( detail::simdLoad( &x ), detail::simdSplat( rhs ) ) ); return *this; }
+template<> inline Vec4<float>		Vec4<float>::operator-() const { return detail::simdToVec4f( detail::simdNegate( detail::simdLoad( &x ) ) ); }
+// ARMv7 NEON has no divide, so division stays scalar there
+#if defined( CINDER_SIMD_MATH_SSE )
+template<> inline const Vec4<float>	Vec4<float>::operator/( const Vec4<float>& rhs ) const { return detail::simdToVec4f( detail::simdDiv( detail::simdLoad( &x ), detail::simdLoad( &rhs.x ) ) ); }
+template<> inline Vec4<float>&		Vec4<float>::operator/=( const Vec4<float>& rhs ) { detail::simdStore( &x, detail::simdDiv( detail::simdLoad( &x ), detail::simdLoad( &rhs.x ) ) ); return *this; }
+template<> inline const Vec4<float>	Vec4<float>::operator/( float rhs ) const { return detail::simdToVec4f( detail::simdDiv( detail::simdLoad( &x ), detail::simdSplat( rhs ) ) ); }
+template<> inline Vec4<float>&		Vec4<float>::operator/=( float rhs ) { detail::simdStore( &x, detail::simdDiv( detail::simdLoad( &x ), detail::simdSplat( rhs ) ) ); return *this; }
+#endif
+//! \endcond
+#endif // defined( CINDER_SIMD_MATH )
+
 //! Converts a coordinate from rectangular (Cartesian) coordinates to polar coordinates of the form (radius, theta)
 template<typename T>
 Vec2<T> toPolar( Vec2<T> car )
@@ -1288,6 +1349,10 @@ template<typename T,typename Y> inline Vec3<T> operator *( Y s, const Vec3<T> &v
 template<typename T,typename Y> inline Vec3<T> operator *( const Vec3<T> &v, Y s ) { return Vec3<T>( v.x * s, v.y * s, v.z * s ); }
 template<typename T,typename Y> inline Vec4<T> operator *( Y s, const Vec4<T> &v ) { return Vec4<T>( v.x * s, v.y * s, v.z * s, v.w * s ); }
 template<typename T,typename Y> inline Vec4<T> operator *( const Vec4<T> &v, Y s ) { return Vec4<T>( v.x * s, v.y * s, v.z * s, v.w * s ); }
+#if defined( CINDER_SIMD_MATH )
+inline Vec4<float> operator *( float s, const Vec4<float> &v ) { return detail::simdToVec4f( detail::simdMul( detail::simdLoad( &v.x ), detail::simdSplat( s ) ) ); }
+inline Vec4<float> operator *( const Vec4<float> &v, float s ) { return detail::simdToVec4f( detail::simdMul( detail::simdLoad( &v.x ), detail::simdSplat( s ) ) ); }
+#endif
 
 template <typename T> T dot( const Vec2<T>& a, const Vec2<T>& b ) { return a.dot( b ); }
 template <typename T> T dot( const Vec3<T>& a, const Vec3<T>& b ) { return a.dot( b ); }
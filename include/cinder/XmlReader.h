@@ -0,0 +1,172 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Stream.h"
+#include "cinder/DataSource.h"
+#include "cinder/Function.h"
+#include "cinder/Xml.h"
+
+#include <boost/lexical_cast.hpp>
+#include <boost/noncopyable.hpp>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace cinder {
+
+/** \brief Parses XML incrementally from an IStream, calling back for each element and run of text instead of building a tree.
+	Memory use depends on the nesting depth and the longest tag or text run, not on the size of the document, so arbitrarily large files
+	can be processed while they're read, including from an IStreamUrl as the download progresses.
+	Callbacks can be limited to part of the document with filter(), and onElement() collects each element matching a path into a small XmlTree.
+	DOCTYPE declarations, processing instructions and comments are skipped; CDATA is reported as text. **/
+class XmlReader : private boost::noncopyable {
+  public:
+	//! An element open in the parser, with its attributes
+	class Element {
+	  public:
+		typedef std::vector<std::pair<std::string,std::string> >	AttrList;
+
+		//! Returns the tag or name of the element
+		const std::string&	getTag() const { return mTag; }
+		//! Returns the element's attributes as name and value pairs
+		const AttrList&		getAttributes() const { return mAttributes; }
+		//! Returns whether the element has an attribute named \a attrName
+		bool				hasAttribute( const std::string &attrName ) const;
+		//! Returns the value of the attribute \a attrName, which is an empty string if no attribute exists with that name
+		const std::string&	operator[]( const std::string &attrName ) const;
+		//! Returns the value of the attribute \a attrName parsed as a T. Returns \a defaultValue if no attribute exists with that name or the attribute fails to cast to T.
+		template<typename T>
+		T					getAttributeValue( const std::string &attrName, const T &defaultValue = T() ) const {
+			if( ! hasAttribute( attrName ) )
+				return defaultValue;
+			try {
+				return boost::lexical_cast<T>( (*this)[attrName] );
+			}
+			catch( ... ) {
+				return defaultValue;
+			}
+		}
+
+	  private:
+		std::string		mTag;
+		AttrList		mAttributes;
+
+		friend class XmlReader;
+	};
+
+	typedef std::function<void(const Element&)>						ElementFn;
+	typedef std::function<void(const std::string&,const Element&)>	TextFn;
+	typedef std::function<void(const XmlTree&)>						TreeFn;
+
+	//! Creates a reader parsing \a stream
+	explicit XmlReader( IStreamRef stream );
+	//! Creates a reader parsing the stream of \a dataSource
+	explicit XmlReader( DataSourceRef dataSource );
+
+	//! Sets the callback for the start of each element, after its attributes have been read
+	XmlReader&	onStartElement( const ElementFn &fn ) { mStartElementFn = fn; return *this; }
+	//! Sets the callback for the end of each element
+	XmlReader&	onEndElement( const ElementFn &fn ) { mEndElementFn = fn; return *this; }
+	//! Sets the callback for each run of text, which receives the entity-decoded text and the element containing it. Runs of only whitespace are skipped.
+	XmlReader&	onText( const TextFn &fn ) { mTextFn = fn; return *this; }
+	/** Limits the start, end and text callbacks to elements matching \a path, such as <tt>"feed/entry"</tt>, and their descendants.
+		The path is relative to the document, so its first component is the root element's tag. An empty \a path removes the filter. **/
+	XmlReader&	filter( const std::string &path, bool caseSensitive = false, char separator = '/' );
+	/** Calls \a fn with each element matching \a path, relative to the document, as an XmlTree once its end tag has been read. Only one matching element is held at a time.
+		Text and CDATA is collapsed into the values of the XmlTree nodes. May be called repeatedly to collect different paths. **/
+	XmlReader&	onElement( const std::string &path, const TreeFn &fn, bool caseSensitive = false, char separator = '/' );
+
+	//! Parses the stream to its end, or until stop() is called from a callback. Throws ExcParse if the XML is malformed.
+	void		parse();
+	//! Stops parse() after the current callback returns
+	void		stop() { mStopped = true; }
+
+	//! Returns the currently open elements, outermost first. Useful from callbacks to inspect ancestors.
+	const std::vector<Element>&	getElementStack() const { return mElements; }
+	//! Returns the path of tags to the current element, separated by \a separator
+	std::string					getPath( char separator = '/' ) const;
+
+	//! Exception expressing malformed XML
+	class ExcParse : public XmlTree::Exception {
+	  public:
+		ExcParse( const std::string &message, uint64_t offset ) throw();
+
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[2048];
+	};
+
+  private:
+	struct PathFilter {
+		PathFilter() : mCaseSensitive( false ) {}
+
+		bool	matches( const std::vector<Element> &elements ) const;
+
+		std::vector<std::string>	mComponents;
+		bool						mCaseSensitive;
+	};
+
+	struct Collector {
+		PathFilter					mFilter;
+		TreeFn						mFn;
+		std::shared_ptr<XmlTree>	mTree;
+		std::vector<XmlTree*>		mNodes;		// the open nodes of mTree, outermost first
+	};
+
+	bool		fill();
+	bool		ensure( size_t count );
+	size_t		find( const char *pattern, size_t from );
+	size_t		findTagEnd();
+	void		skip( size_t count );
+	void		throwParseError( const std::string &message ) const;
+
+	void		parseText();
+	void		parseMarkup();
+	void		parseStartTag( size_t length );
+	void		parseEndTag( size_t length );
+
+	void		startElement( bool isEmpty );
+	void		endElement();
+	void		text( const std::string &text );
+
+	IStreamRef				mStream;
+	std::vector<char>		mBuffer;
+	size_t					mPos, mEnd;		// unread data in mBuffer
+	uint64_t				mOffset;		// of mBuffer[mPos] in the stream
+	bool					mEof, mStopped;
+
+	std::vector<Element>	mElements;
+	ElementFn				mStartElementFn, mEndElementFn;
+	TextFn					mTextFn;
+	PathFilter				mFilter;
+	size_t					mFilterDepth;	// depth of the element matching mFilter we're inside of, or 0
+	std::vector<Collector>	mCollectors;
+};
+
+} // namespace cinder
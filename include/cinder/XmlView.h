@@ -0,0 +1,249 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/StringRef.h"
+#include "cinder/Xml.h"
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace cinder {
+
+//! A view of a string owned by an XmlView's document, which is always zero-terminated. Only valid while some XmlView of that document exists.
+typedef StringRef	XmlStringRef;
+
+/** \brief A lightweight, read-only alternative to XmlTree.
+	Where XmlTree copies every node, attribute and string into its own allocations, XmlView keeps the RapidXML document alive and refers into it.
+	Parsing costs one copy of the input, which RapidXML decodes in place, plus RapidXML's pooled nodes. An XmlView is a cheap handle to one node
+	of a shared document, so it can be copied and returned by value. The document is freed along with its last XmlView, which XmlStringRefs must not outlive. **/
+class XmlView {
+  public:
+	class ConstIter;
+
+	//! An attribute of an XmlView node
+	class Attr {
+	  public:
+		//! Returns the name of the attribute
+		XmlStringRef	getName() const { return mName; }
+		//! Returns the value of the attribute
+		XmlStringRef	getValue() const { return mValue; }
+		//! Returns the value of the attribute parsed as a T. Requires T to support the istream>> operator.
+		template<typename T>
+		T				getValue() const { return mValue.as<T>(); }
+
+	  private:
+		Attr( const XmlStringRef &name, const XmlStringRef &value ) : mName( name ), mValue( value ) {}
+
+		XmlStringRef	mName, mValue;
+
+		friend class XmlView;
+	};
+
+	//! Creates an empty view which refers to no node
+	XmlView() : mNode( 0 ) {}
+	//! Parses the XML contained in \a dataSource using the options \a parseOptions and returns a view of the document node
+	explicit XmlView( DataSourceRef dataSource, XmlTree::ParseOptions parseOptions = XmlTree::ParseOptions() );
+	//! Parses the XML contained in the string \a xmlString using the options \a parseOptions and returns a view of the document node
+	explicit XmlView( const std::string &xmlString, XmlTree::ParseOptions parseOptions = XmlTree::ParseOptions() );
+
+	//! Returns the type of this node as a NodeType.
+	XmlTree::NodeType	getNodeType() const;
+	//! Returns whether this node is a document node, meaning it is a root node.
+	bool				isDocument() const { return getNodeType() == XmlTree::NODE_DOCUMENT; }
+	//! Returns whether this node is an element node.
+	bool				isElement() const { return getNodeType() == XmlTree::NODE_ELEMENT; }
+	//! Returns whether this node represents CDATA. Only possible when a document's ParseOptions disabled collapsing CDATA.
+	bool				isCData() const { return getNodeType() == XmlTree::NODE_CDATA; }
+	//! Returns whether this node represents a comment. Only possible when a document's ParseOptions enabled parsing commments.
+	bool				isComment() const { return getNodeType() == XmlTree::NODE_COMMENT; }
+
+	//! Returns the tag or name of the node.
+	XmlStringRef		getTag() const;
+	/** Returns the value of the node. Unlike XmlTree this is only the node's first run of text, or with collapsed CDATA its first CDATA section if it has no text,
+		since concatenating mixed content would require a copy. **/
+	XmlStringRef		getValue() const;
+	//! Returns the value of the node parsed as a T. Requires T to support the istream>> operator.
+	template<typename T>
+	T					getValue() const { return getValue().as<T>(); }
+	//! Returns the value of the node parsed as a T. If the value is empty or fails to parse \a defaultValue is returned. Requires T to support the istream>> operator.
+	template<typename T>
+	T					getValue( const T &defaultValue ) const { try { return getValue().as<T>(); } catch( ... ) { return defaultValue; } }
+
+	//! Returns whether this node has a parent node.
+	bool				hasParent() const;
+	//! Returns the node which is the parent of this node.
+	XmlView				getParent() const;
+
+	//! Returns the first child that matches \a relativePath or end() if none matches
+	ConstIter			find( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const;
+	//! Returns whether at least one child matches \a relativePath
+	bool				hasChild( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const { return getNodePtr( relativePath, caseSensitive, separator ) != 0; }
+	//! Returns the first child that matches \a relativePath. Throws ExcChildNotFound if none matches.
+	XmlView				getChild( const std::string &relativePath, bool caseSensitive = false, char separator = '/' ) const;
+	//! Returns the first child that matches \a childName. Throws ExcChildNotFound if none matches.
+	XmlView				operator/( const std::string &childName ) const { return getChild( childName ); }
+
+	//! Returns the node's attributes.
+	std::vector<Attr>	getAttributes() const;
+	/** Returns whether the node has an attribute named \a attrName. **/
+	bool				hasAttribute( const std::string &attrName ) const;
+	//! Returns the node attribute named \a attrName. Throws ExcAttrNotFound if no attribute exists with that name.
+	Attr				getAttribute( const std::string &attrName ) const;
+	//! Returns the value of the attribute named \a attrName, which is empty if no attribute exists with that name.
+	XmlStringRef		operator[]( const std::string &attrName ) const;
+	/** \brief Returns the value of the attribute \a attrName parsed as a T. Throws ExcAttrNotFound if no attribute exists with that name. Requires T to support the istream>> operator.
+		<br><tt>float size = myNode.getAttributeValue<float>( "size" );</tt> **/
+	template<typename T>
+	T					getAttributeValue( const std::string &attrName ) const { return getAttribute( attrName ).getValue<T>(); }
+	/** \brief Returns the value of the attribute \a attrName parsed as a T. Returns \a defaultValue if no attribute exists with that name or the attribute fails to cast to T. Requires T to support the istream>> operator.
+		<br><tt>float size = myNode.getAttributeValue<float>( "size", 1.0f );</tt> **/
+	template<typename T>
+	T					getAttributeValue( const std::string &attrName, const T &defaultValue ) const {
+		if( hasAttribute( attrName ) ) {
+			try {
+				return getAttribute( attrName ).getValue<T>();
+			}
+			catch( ... ) {
+				return defaultValue;
+			}
+		}
+		else return defaultValue;
+	}
+
+	/** Returns a path to this node, separated by the character \a separator. **/
+	std::string			getPath( char separator = '/' ) const;
+
+	/** Returns a ConstIter to the first child node of this node. **/
+	ConstIter			begin() const;
+	/** Returns a ConstIter to the children node of this node which match the path \a filterPath. **/
+	ConstIter			begin( const std::string &filterPath, bool caseSensitive = false, char separator = '/' ) const;
+	/** Returns a ConstIter which marks the end of the children of this node. **/
+	ConstIter			end() const;
+
+	//! Returns a deep copy of this node as an XmlTree, for example to modify or write part of a large document
+	XmlTree				toXmlTree() const;
+
+	//! Exception expressing the absence of an expected child node.
+	class ExcChildNotFound : public XmlTree::Exception {
+	  public:
+		ExcChildNotFound( const XmlView &node, const std::string &childPath ) throw();
+
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[2048];
+	};
+
+	//! Exception expressing the absence of an expected attribute.
+	class ExcAttrNotFound : public XmlTree::Exception {
+	  public:
+		ExcAttrNotFound( const XmlView &node, const std::string &attrName ) throw();
+
+		virtual const char* what() const throw() { return mMessage; }
+
+	  private:
+		char mMessage[2048];
+	};
+
+	//! Shared state of every XmlView of one document
+	struct Document;
+
+	//! Emulates shared_ptr-like behavior
+	typedef rapidxml::xml_node<char>* XmlView::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mNode == 0 ) ? 0 : &XmlView::mNode; }
+
+  private:
+	XmlView( const std::shared_ptr<Document> &document, rapidxml::xml_node<char> *node ) : mDocument( document ), mNode( node ) {}
+
+	void							parse( char *text, const XmlTree::ParseOptions &parseOptions );
+	rapidxml::xml_node<char>*		getNodePtr( const std::string &relativePath, bool caseSensitive, char separator ) const;
+
+	std::shared_ptr<Document>		mDocument;
+	rapidxml::xml_node<char>		*mNode;
+
+	friend class ConstIter;
+};
+
+//! A const iterator over the children of an XmlView, optionally filtered by a path.
+class XmlView::ConstIter {
+  public:
+	//! \cond
+	ConstIter() {}
+	ConstIter( const XmlView &parent );
+	ConstIter( const XmlView &root, const std::string &filterPath, bool caseSensitive, char separator );
+	//! \endcond
+
+	//! Returns the XmlView the iterator currently points to.
+	const XmlView&		operator*() const { return mCurrent; }
+	//! Returns a pointer to the XmlView the iterator currently points to.
+	const XmlView*		operator->() const { return &mCurrent; }
+
+	//! Increments the iterator to the next child. If using a non-empty filterPath increments to the next child which matches the filterPath.
+	ConstIter& operator++() {
+		increment();
+		return *this;
+	}
+
+	//! Increments the iterator to the next child. If using a non-empty filterPath increments to the next child which matches the filterPath.
+	const ConstIter operator++(int) {
+		ConstIter prev( *this );
+		++(*this);
+		return prev;
+	}
+
+	bool operator!=( const ConstIter &rhs ) const { return mCurrent.mNode != rhs.mCurrent.mNode; }
+	bool operator==( const ConstIter &rhs ) const { return mCurrent.mNode == rhs.mCurrent.mNode; }
+
+  private:
+	void						increment();
+	void						settle();
+	rapidxml::xml_node<char>*	nextMatch( rapidxml::xml_node<char> *candidate, size_t level ) const;
+
+	std::vector<rapidxml::xml_node<char>*>	mStack;		// the current node at each level of the filter
+	std::vector<std::string>				mFilter;
+	bool									mCaseSensitive;
+	XmlView									mCurrent;
+};
+
+} // namespace cinder
+
+namespace std {
+
+//! \cond
+template<>
+struct iterator_traits<cinder::XmlView::ConstIter> {
+	typedef cinder::XmlView			value_type;
+	typedef ptrdiff_t				difference_type;
+	typedef forward_iterator_tag	iterator_category;
+	typedef const cinder::XmlView*	pointer;
+	typedef const cinder::XmlView&	reference;
+};
+//! \endcond
+
+} // namespace std
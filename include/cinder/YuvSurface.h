@@ -0,0 +1,143 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Channel.h"
+#include "cinder/Surface.h"
+#include "cinder/Matrix.h"
+
+namespace cinder {
+
+/** \brief An 8-bit YpCbCr 4:2:0 image, stored as a full resolution luma plane and quarter resolution chroma.
+	This is the native output of most cameras and video decoders. Keeping frames in this form and converting them on the GPU (see gl::YuvTexture) moves half as many bytes as an RGB Surface.
+	The planes are exposed as Channels which share the YuvSurface's pixels; like a Surface's Channels, they don't keep the YuvSurface alive. \ImplShared **/
+class YuvSurface {
+  public:
+	//! The arrangement of the chroma planes
+	typedef enum Layout {
+		//! A Cb plane followed by a Cr plane, also known as YUV420p or 'y420'
+		I420,
+		//! A single plane of interleaved Cb and Cr samples, also known as 420v/420f
+		NV12
+	} Layout;
+	
+	//! The color matrix relating YpCbCr to RGB
+	typedef enum ColorMatrix { BT601, BT709 } ColorMatrix;
+	
+	/*! Constructs an empty YuvSurface, which is the equivalent of NULL and should not be used directly. */
+	YuvSurface() {}
+	//! Allocates and owns a \a width x \a height YuvSurface laid out as \a layout. Odd dimensions round the chroma planes up.
+	YuvSurface( int32_t width, int32_t height, Layout layout = NV12 );
+	//! Allocates a \a width x \a height YuvSurface from \a pool, which is returned to the pool when the YuvSurface and all copies of it are destroyed
+	YuvSurface( int32_t width, int32_t height, Layout layout, const SurfacePoolRef &pool );
+	//! Wraps an NV12 image without allocating or owning its memory
+	YuvSurface( int32_t width, int32_t height, uint8_t *yData, int32_t yRowBytes, uint8_t *cbCrData, int32_t cbCrRowBytes );
+	//! Wraps an I420 image without allocating or owning its memory
+	YuvSurface( int32_t width, int32_t height, uint8_t *yData, int32_t yRowBytes, uint8_t *cbData, int32_t cbRowBytes, uint8_t *crData, int32_t crRowBytes );
+	//! Converts \a surface into a newly allocated YuvSurface laid out as \a layout, averaging each 2x2 block for the chroma
+	explicit YuvSurface( const Surface8u &surface, Layout layout = NV12, ColorMatrix colorMatrix = BT601, bool fullRange = false );
+
+	//! Returns the width of the YuvSurface in pixels
+	int32_t		getWidth() const { return mObj->mWidth; }
+	//! Returns the height of the YuvSurface in pixels
+	int32_t		getHeight() const { return mObj->mHeight; }
+	//! Returns the size of the YuvSurface in pixels
+	Vec2i		getSize() const { return Vec2i( mObj->mWidth, mObj->mHeight ); }
+	//! Returns the bounding Area of the YuvSurface in pixels: [0,0]-(width,height)
+	Area		getBounds() const { return Area( 0, 0, mObj->mWidth, mObj->mHeight ); }
+	//! Returns the arrangement of the chroma planes
+	Layout		getLayout() const { return mObj->mLayout; }
+
+	//! Returns the full resolution luma plane
+	Channel8u&			getY() { return mObj->mY; }
+	const Channel8u&	getY() const { return mObj->mY; }
+	//! Returns the half resolution blue-difference chroma. Its increment is \c 2 for NV12.
+	Channel8u&			getCb() { return mObj->mCb; }
+	const Channel8u&	getCb() const { return mObj->mCb; }
+	//! Returns the half resolution red-difference chroma. Its increment is \c 2 for NV12.
+	Channel8u&			getCr() { return mObj->mCr; }
+	const Channel8u&	getCr() const { return mObj->mCr; }
+
+	//! Returns the color matrix the samples are encoded with. Defaults to \c BT601.
+	ColorMatrix	getColorMatrix() const { return mObj->mColorMatrix; }
+	//! Returns whether the samples span the full 0-255 range rather than video range (16-235 luma, 16-240 chroma). Defaults to \c false.
+	bool		isFullRange() const { return mObj->mFullRange; }
+	//! Sets the color matrix and range the samples are encoded with. This describes the pixels rather than converting them.
+	void		setColorSpace( ColorMatrix colorMatrix, bool fullRange ) { mObj->mColorMatrix = colorMatrix; mObj->mFullRange = fullRange; }
+
+	//! Returns a new RGB Surface converted from this YuvSurface on the CPU. Prefer gl::YuvTexture for display.
+	Surface8u	convertToSurface() const;
+	//! Converts into the RGB \a surface, which must be the same size as the YuvSurface
+	void		convertToSurface( Surface8u *surface ) const;
+	//! Replaces the pixels of the YuvSurface with the conversion of \a surface, which must be the same size
+	void		copyFrom( const Surface8u &surface );
+
+	/** Sets the deallocator, an optional callback which will fire upon the YuvSurface::Obj's destruction. This is useful when a YuvSurface is wrapping another API's image data structure whose lifetime is tied to the YuvSurface's. **/
+	void		setDeallocator( void(*aDeallocatorFunc)( void * ), void *aDeallocatorRefcon );
+
+	/** Returns the matrix and offset which convert normalized [0,1] YpCbCr to RGB for \a colorMatrix and \a fullRange, such that <tt>rgb = matrix * ycbcr + offset</tt>.
+		This is what the gl::YuvTexture shader applies. **/
+	static void	getRgbConversion( ColorMatrix colorMatrix, bool fullRange, Matrix33f *resultMatrix, Vec3f *resultOffset );
+
+  protected:
+	/// \cond
+	struct Obj {
+		Obj( int32_t width, int32_t height, Layout layout );
+		~Obj();
+		
+		int32_t			mWidth, mHeight;
+		Layout			mLayout;
+		ColorMatrix		mColorMatrix;
+		bool			mFullRange;
+		Channel8u		mY, mCb, mCr;
+		uint8_t			*mData; // owned pixels when allocated without a pool, otherwise NULL
+		void			*mPoolRefcon; // identifies pixels allocated from a SurfacePool
+		
+		void			(*mDeallocatorFunc)(void *refcon);
+		void			*mDeallocatorRefcon;
+	};
+	/// \endcond
+
+	void		allocate( int32_t width, int32_t height, Layout layout, const SurfacePoolRef &pool );
+	
+	std::shared_ptr<Obj>	mObj;
+
+  public:
+	/// \cond
+	typedef std::shared_ptr<Obj> YuvSurface::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &YuvSurface::mObj; }
+	void reset() { mObj.reset(); }
+	/// \endcond
+};
+
+class YuvSurfaceExc : public std::exception {
+	virtual const char* what() const throw() {
+		return "YuvSurface exception: dimensions do not match";
+	}
+};
+
+} // namespace cinder
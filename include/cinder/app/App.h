@@ -32,8 +32,10 @@
 #include "cinder/Stream.h"
 #include "cinder/Display.h"
 #include "cinder/DataSource.h"
+#include "cinder/AssetArchive.h"
 #include "cinder/Timer.h"
 #include "cinder/Function.h"
+#include "cinder/app/FramePacer.h"
 #if defined( CINDER_COCOA )
 	#if defined( CINDER_COCOA_TOUCH )
 		#if defined( __OBJC__ )
@@ -130,6 +132,58 @@ class App {
 		//! is power management enabled, allowing screensavers and the system's power management to hide the application
 		bool	getPowerManagement() const { return mPowerManagement; }
 
+		/** Runs update() on a separate simulation thread, in parallel with draw() on the app's thread, which draws the state produced by the previous update().
+			Hand each update()'s results to draw() by overriding App::swapFrameState(), for instance with a DoubleBuffer. Events are still delivered on the app's thread,
+			concurrently with update(), so event handlers must not touch state update() uses without synchronization. Default value is \c false. **/
+		void	enableThreadedUpdate( bool threadedUpdate = true ) { mThreadedUpdate = threadedUpdate; }
+		//! Returns whether update() runs on a separate simulation thread
+		bool	isThreadedUpdateEnabled() const { return mThreadedUpdate; }
+
+		/** Calls update() at a fixed rate of \a updatesPerSecond, independent of the frame rate: each frame calls it as many times as the elapsed time requires,
+			possibly none, and App::getUpdateAlpha() tells draw() how far it is between the last update() and the next. A value of \c 0, the default, calls update() once per frame. **/
+		void	setFixedUpdateRate( float updatesPerSecond ) { mFixedUpdateRate = std::max( 0.0f, updatesPerSecond ); }
+		//! Returns the fixed rate at which update() is called, or \c 0 if it is called once per frame
+		float	getFixedUpdateRate() const { return mFixedUpdateRate; }
+		//! Sets the maximum number of times update() is called in a single frame at a fixed update rate. Time beyond that is dropped, so a slow frame doesn't cascade into slower ones. Default value is \c 5.
+		void	setMaxUpdatesPerFrame( int maxUpdates ) { mMaxUpdatesPerFrame = std::max( 1, maxUpdates ); }
+		//! Returns the maximum number of times update() is called in a single frame at a fixed update rate
+		int		getMaxUpdatesPerFrame() const { return mMaxUpdatesPerFrame; }
+
+		/** Merges the mouseMove(), mouseDrag() and touchesMoved() events arriving during a frame into at most one of each, delivered before update(), so handler and
+			draw time don't scale with the input device's rate. Events of other kinds first deliver any motion merged so far, which preserves ordering.
+			Merged touches keep the positions they passed through in TouchEvent::Touch::getHistory(). Default value is \c false. **/
+		void	enableEventCoalescing( bool coalesce = true ) { mEventCoalescing = coalesce; }
+		//! Returns whether motion events are merged per frame
+		bool	isEventCoalescingEnabled() const { return mEventCoalescing; }
+
+		/** Runs with the window hidden, drawing into an offscreen framebuffer the size of the window, and starts each frame as soon as the previous one has been drawn,
+			ignoring the frame rate and vsync. copyWindowSurface() reads from the offscreen framebuffer. Intended for batch rendering along with setFixedFrameDuration()
+			and setFrameLimit(). Requires RendererGl and is only supported by AppBasic. Default value is \c false. **/
+		void	enableHeadless( bool headless = true ) { mHeadless = headless; }
+		//! Returns whether the app runs without a visible window
+		bool	isHeadless() const { return mHeadless; }
+		/** Advances getElapsedSeconds() by exactly \a seconds each frame rather than following the clock, so animation is reproducible however long frames take
+			to render. A value of \c 0, the default, uses real time. **/
+		void	setFixedFrameDuration( double seconds ) { mFixedFrameDuration = std::max( 0.0, seconds ); }
+		//! Returns the fixed amount getElapsedSeconds() advances each frame, or \c 0 if it follows the clock
+		double	getFixedFrameDuration() const { return mFixedFrameDuration; }
+		//! Quits the app once \a numFrames frames have been drawn. A value of \c 0, the default, runs until quit() is called. Only supported by AppBasic.
+		void		setFrameLimit( uint32_t numFrames ) { mFrameLimit = numFrames; }
+		//! Returns the number of frames after which the app quits, or \c 0 if it runs until quit() is called
+		uint32_t	getFrameLimit() const { return mFrameLimit; }
+
+		/** Runs update() and draw() only when something calls for a frame: an input or resize event, a call to App::requestRedraw() or App::dispatchAsync(),
+			or an incomplete item on the App's Timeline. Otherwise the app blocks waiting for OS events, so a static app uses next to no CPU or GPU.
+			Animation driven by anything else must call App::requestRedraw() each frame. Only supported by AppBasic. Default value is \c false. **/
+		void	enableEventDrivenRedraw( bool eventDriven = true ) { mEventDrivenRedraw = eventDriven; }
+		//! Returns whether frames run only when something calls for them
+		bool	isEventDrivenRedrawEnabled() const { return mEventDrivenRedraw; }
+		/** Writes Profiler::writeStartupReport() to console() once the first frame has been drawn, breaking down the time to the first frame into the launch,
+			setup(), the first frame itself and any subsystems initialized along the way, such as the image and audio handlers. Default value is \c false. **/
+		void	enableStartupReport( bool report = true ) { mStartupReport = report; }
+		//! Returns whether a startup timing report is written after the first frame
+		bool	isStartupReportEnabled() const { return mStartupReport; }
+
 	  protected:
 		Settings();
 		virtual ~Settings() {}	  
@@ -146,6 +200,15 @@ class App {
 		bool			mBorderless; // window is borderless (frameless / chromeless). default: false
 		bool			mAlwaysOnTop; // window is always on top. default: false
 		bool			mPowerManagement; // allow screensavers or power management to hide app. default: false
+		bool			mThreadedUpdate; // update() runs on a simulation thread. default: false
+		float			mFixedUpdateRate; // updates per second, or 0 for one per frame. default: 0
+		int				mMaxUpdatesPerFrame; // catch-up cap at a fixed update rate. default: 5
+		bool			mEventCoalescing; // motion events are merged per frame. default: false
+		bool			mHeadless; // no visible window, offscreen framebuffer, unthrottled. default: false
+		double			mFixedFrameDuration; // seconds getElapsedSeconds() advances per frame, or 0 for real time. default: 0
+		uint32_t		mFrameLimit; // frames drawn before quitting, or 0 for no limit. default: 0
+		bool			mEventDrivenRedraw; // frames run only when requested. default: false
+		bool			mStartupReport; // startup timings are written after the first frame. default: false
 		std::string		mTitle;
 	};
 
@@ -164,6 +227,9 @@ class App {
 	virtual void	update() {}
 	//! Override to perform any rendering once-per-loop or in response to OS-prompted requests for refreshes.
 	virtual void	draw() {}
+	/** Override to hand the state produced by update() to draw() when Settings::enableThreadedUpdate() is in effect, typically by calling DoubleBuffer::swap().
+		Called on the app's thread once per frame, after the latest update() has finished and before the next one starts, while neither update() nor draw() is running. **/
+	virtual void	swapFrameState() {}
 	
 	//! Override to receive mouse-down events.
 	virtual void	mouseDown( MouseEvent event ) {}
@@ -307,6 +373,9 @@ class App {
 	double				getFpsSampleInterval() const { return mFpsSampleInterval; }
 	//! Sets the sampling rate in seconds for measuring the average frame-per-second as returned by getAverageFps()
 	void				setFpsSampleInterval( double sampleInterval ) { mFpsSampleInterval = sampleInterval; }	
+	//! Returns the App's FramePacer, which controls precise frame pacing and GPU waiting and reports per-frame timing statistics
+	FramePacer&			getFramePacer() { return *mFramePacer; }
+	const FramePacer&	getFramePacer() const { return *mFramePacer; }
 
 	//! Returns whether the App is in full-screen mode or not.
 	virtual bool		isFullScreen() const = 0;
@@ -322,10 +391,13 @@ class App {
 	//! Sets whether the window always remains above all other windows
 	virtual void		setAlwaysOnTop( bool alwaysOnTop = true ) { }
 
-	//! Returns the number of seconds which have elapsed since application launch
-	double				getElapsedSeconds() const { return mTimer.getSeconds(); }
+	//! Returns the number of seconds which have elapsed since application launch, or the elapsed frames times the fixed frame duration if one is set. \sa Settings::setFixedFrameDuration()
+	double				getElapsedSeconds() const { return ( mFixedFrameTime >= 0 ) ? mFixedFrameTime : mTimer.getSeconds(); }
 	//! Returns the number of animation frames which have elapsed since application launch
 	uint32_t			getElapsedFrames() const { return mFrameCount; }
+	/** At a fixed update rate, returns the fraction of an update interval in the range [0,1) which has elapsed since the last update(), for draw() to interpolate
+		between the previous and the latest simulation state. Returns \c 1 when update() is called once per frame. \sa Settings::setFixedUpdateRate() **/
+	float				getUpdateAlpha() const { return mUpdateAlpha; }
 	
 	// utilities
 	//! Returns a DataSourceRef to an application resource. On Mac OS X, \a macPath is a path relative to the bundle's resources folder. On Windows, \a mswID and \a mswType identify the resource as defined the application's .rc file(s). Throws ResourceLoadExc on failure. \sa \ref CinderResources
@@ -342,12 +414,15 @@ class App {
 	static DataSourceRef		loadResource( int mswID, const std::string &mswType );
 #endif
 	
-	//! Returns a DataSourceRef to an application asset. Throws a AssetLoadExc on failure.
+	//! Returns a DataSourceRef to an application asset, searching the asset archives before the asset directories. Throws a AssetLoadExc on failure.
 	DataSourceRef			loadAsset( const fs::path &relativePath );
-	//! Returns a fs::path to an application asset. Returns an empty path on failure.
+	//! Returns a fs::path to an application asset. Returns an empty path on failure, including for assets which are only found in an asset archive.
 	fs::path				getAssetPath( const fs::path &relativePath );
 	//! Adds an absolute path 'dirPath' to the list of directories which are searched for assets.
 	void					addAssetDirectory( const fs::path &dirPath );
+	/** Mounts the AssetArchive at \a archivePath, whose files are then served by loadAsset(), and by loadResource() for the \a macPath names, ahead of loose files.
+		Archives are searched in the order they were added. An \c assets.pak found alongside the default assets directory is mounted automatically. Throws AssetArchiveExc on failure. **/
+	void					addAssetArchive( const fs::path &archivePath );
 	
 	//! Returns the path to the application on disk
 	virtual fs::path			getAppPath() = 0;
@@ -370,6 +445,18 @@ class App {
 	//! Returns a reference to the App's Timeline
 	Timeline&		timeline() { return *mTimeline; }
 
+	//! Schedules \a fn to be called on the app's thread immediately before the next call to update(), or a later one if the dispatch budget is exhausted. Safe to call from any thread.
+	void			dispatchAsync( const std::function<void()> &fn );
+	/** Sets the time in seconds the app may spend each frame calling functions passed to dispatchAsync(). Once exceeded, the remaining functions are called
+		in order before later frames, so a burst of them is spread across frames. A value of \c 0, the default, calls all of them every frame. **/
+	void			setDispatchBudget( double seconds );
+	//! Returns the time in seconds the app may spend each frame calling functions passed to dispatchAsync(). \c 0 means no limit.
+	double			getDispatchBudget() const;
+
+	/** With Settings::enableEventDrivenRedraw() in effect, requests that update() and draw() run for another frame, waking the app if it is idle.
+		Requests made during update() or draw() call for the frame after. Safe to call from any thread. Otherwise does nothing, as every frame runs. **/
+	void			requestRedraw();
+
 	/** \return a copy of the window's contents as a Surface8u **/
 	Surface	copyWindowSurface();
 	/** \return a copy of the Area \a area from the window's contents as a Surface8u **/
@@ -392,9 +479,15 @@ class App {
 
 	virtual void	privateSetup__();
 	virtual void	privateResize__( const ResizeEvent &event );	
+	//! Delivers motion events merged by event coalescing
+	virtual void	privateFlushCoalescedEvents__();
 	virtual void	privateUpdate__();
 	virtual void	privateDraw__();
 	virtual void	privateShutdown__();
+	//! Returns whether the next frame should run, which is always the case unless event-driven redraw is enabled
+	bool			privateIsRedrawNeeded__() const;
+	//! Wakes the AppImpl's event loop when it is waiting for a frame to be requested
+	virtual void	privateWakeUp__() {}
 	//! \endcond
 
 #if defined( CINDER_MSW )
@@ -420,6 +513,8 @@ class App {
   private:
 	  void 		prepareAssetLoading();
 	  fs::path	findAssetPath( const fs::path &relativePath );
+	  //! Returns the asset \a relativePath from the first asset archive which contains it, or a NULL DataSourceRef
+	  DataSourceRef	loadArchivedAsset( const fs::path &relativePath );
   
 #if defined( CINDER_MSW )
 	friend class AppImplMsw;
@@ -435,8 +530,31 @@ class App {
 	double					mFpsLastSampleTime;
 	double					mFpsSampleInterval;
 
+	double					mFixedUpdateTime; // time up to which fixed-rate updates have been run, or negative before the first
+	float					mUpdateAlpha, mPendingUpdateAlpha; // the latter is written by stepUpdate(), possibly on the simulation thread
+	double					mPendingUpdateDuration; // likewise
+	double					mFixedFrameTime; // getElapsedSeconds() with a fixed frame duration, otherwise negative
+	double					mLaunchSeconds, mSetupEndSeconds; // on the Profiler's clock for the startup report; negative if unknown or, for the latter, once the first frame is drawn
+
+	volatile uint32_t		mRedrawRequested; // set by requestRedraw() on any thread, cleared as a frame starts
+	bool					mTimelineActive, mPendingTimelineActive; // whether the Timeline had incomplete items after the last update(); the latter is written by stepUpdate()
+	bool					mRedrawFollowUp; // a threaded update() started for a requested frame is drawn by the next frame
+
+	MouseEvent				mCoalescedMouseEvent;
+	bool					mHasCoalescedMouseMove, mHasCoalescedMouseDrag;
+	std::shared_ptr<FramePacer>	mFramePacer;
+
 	std::shared_ptr<Timeline>	mTimeline;
 
+	struct DispatchQueue;
+	std::shared_ptr<DispatchQueue>	mDispatchQueue;
+
+	struct UpdateThread;
+	std::shared_ptr<UpdateThread>	mUpdateThread;
+	void			stepUpdate();
+	void			updateThreadFn();
+	void			stopUpdateThread();
+
 	std::shared_ptr<Renderer>	mRenderer;
 	
 	CallbackMgr<bool (MouseEvent)>		mCallbacksMouseDown, mCallbacksMouseUp, mCallbacksMouseWheel, mCallbacksMouseMove, mCallbacksMouseDrag;
@@ -448,6 +566,8 @@ class App {
 	bool						mAssetDirectoriesInitialized;
 	// Path to directories which contain assets
 	std::vector<fs::path>		mAssetDirectories;
+	// Mounted asset archives, searched before mAssetDirectories
+	std::vector<AssetArchiveRef>	mAssetArchives;
 	
 	static App*		sInstance;
 };
@@ -511,6 +631,8 @@ inline DataSourceRef		loadAsset( const fs::path &relativePath ) { return App::ge
 inline fs::path				getAssetPath( const fs::path &relativePath ) { return App::get()->getAssetPath( relativePath ); }
 //! Adds an absolute path \a dirPath to the active App's list of directories which are searched for assets.
 inline void					addAssetDirectory( const fs::path &dirPath ) { App::get()->addAssetDirectory( dirPath ); }
+//! Mounts the AssetArchive at \a archivePath in the active App, ahead of its asset directories. Throws AssetArchiveExc on failure.
+inline void					addAssetArchive( const fs::path &archivePath ) { App::get()->addAssetArchive( archivePath ); }
 
 //! Returns the path to the active App on disk
 inline fs::path		getAppPath() { return App::get()->getAppPath(); }
@@ -533,6 +655,8 @@ inline std::ostream&	console() { return App::get()->console(); }
 
 //! Returns a reference to the active App's Timeline
 inline Timeline&	timeline() { return App::get()->timeline(); }
+//! Schedules \a fn to be called on the active app's thread immediately before its next call to update(). Safe to call from any thread.
+inline void			dispatchAsync( const std::function<void()> &fn ) { App::get()->dispatchAsync( fn ); }
 
 //! Returns a copy of the window's contents as a Surface8u
 inline Surface	copyWindowSurface() { return App::get()->copyWindowSurface(); }
@@ -36,6 +36,7 @@
 #endif
 
 #include "cinder/app/TouchEvent.h"
+#include "cinder/app/Window.h"
 
 namespace cinder { namespace app {
 
@@ -150,6 +151,14 @@ class AppBasic : public App {
 	virtual void		setAlwaysOnTop( bool alwaysOnTop = true );
 
 
+	/** Creates an additional window according to \a format, typically for another display. Its RendererGl shares OpenGL objects with the app's,
+		so textures, VBOs and GLSL programs created once can be drawn in every window. Override drawWindow() to draw into it. Call from setup() or later. **/
+	WindowRef			createWindow( const Window::Format &format = Window::Format() );
+	//! Returns the additional windows created with createWindow() which haven't been closed
+	const std::vector<WindowRef>&	getWindows() const { return mWindows; }
+	//! Override to draw into \a window. Called once per frame for each additional window after draw(), with its context current and sized by its renderer's defaultResize().
+	virtual void		drawWindow( const WindowRef &window ) {}
+
 	//! Returns the current location of the mouse. Can be called outside the normal event loop.
 	Vec2i				getMousePos() const;
 	//! Hides the mouse cursor
@@ -178,7 +187,10 @@ class AppBasic : public App {
 	void		privateTouchesBegan__( const TouchEvent &event );
 	void		privateTouchesMoved__( const TouchEvent &event );
 	void		privateTouchesEnded__( const TouchEvent &event );
+	virtual void	privateFlushCoalescedEvents__();
 	void		privateSetActiveTouches__( const std::vector<TouchEvent::Touch> &touches ) { mActiveTouches = touches; }
+	void		privateDrawWindows__();
+	virtual void	privateWakeUp__();
 	
 #if defined( CINDER_MSW )
 	virtual bool		getsWindowsPaintEvents() { return true; }
@@ -221,6 +233,10 @@ class AppBasic : public App {
 	std::vector<std::string>	mCommandLineArgs;
 
 	std::vector<TouchEvent::Touch>		mActiveTouches; // list of currently active touches
+	TouchEvent							mCoalescedTouchesMoved;
+	bool								mHasCoalescedTouchesMoved;
+
+	std::vector<WindowRef>				mWindows;
 
 	Settings		mSettings;
 };
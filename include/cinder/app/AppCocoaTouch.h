@@ -158,6 +158,7 @@ class AppCocoaTouch : public App {
 	void		privateTouchesBegan__( const TouchEvent &event );
 	void		privateTouchesMoved__( const TouchEvent &event );
 	void		privateTouchesEnded__( const TouchEvent &event );
+	virtual void	privateFlushCoalescedEvents__();
 	void		privateSetActiveTouches__( const std::vector<TouchEvent::Touch> &touches ) { mActiveTouches = touches; }
 	void		privateAccelerated__( const Vec3f &direction );
 	//! \endcond
@@ -173,6 +174,8 @@ class AppCocoaTouch : public App {
 	Settings				mSettings;
 	
 	std::vector<TouchEvent::Touch>	mActiveTouches;
+	TouchEvent						mCoalescedTouchesMoved;
+	bool							mHasCoalescedTouchesMoved;
 
 	CallbackMgr<bool (TouchEvent)>		mCallbacksTouchesBegan, mCallbacksTouchesMoved, mCallbacksTouchesEnded;
 	CallbackMgr<bool (AccelEvent)>		mCallbacksAccelerated;
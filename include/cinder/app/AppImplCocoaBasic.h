@@ -56,6 +56,7 @@
 - (id)init:(cinder::app::AppBasic*)aApp;
 - (void)setApplicationMenu: (NSString*) applicationName;
 - (void)startAnimationTimer;
+- (void)wakeUp;
 - (void)applicationWillTerminate:(NSNotification *)notification;
 - (void)quit;
 
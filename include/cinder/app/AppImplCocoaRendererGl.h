@@ -35,12 +35,13 @@
 	NSView							*cinderView;
 }
 
-- (id)initWithFrame:(NSRect)frame cinderView:(NSView*)aCinderView app:(cinder::app::App*)aApp renderer:(cinder::app::RendererGl*)aRenderer;
+- (id)initWithFrame:(NSRect)frame cinderView:(NSView*)aCinderView app:(cinder::app::App*)aApp renderer:(cinder::app::RendererGl*)aRenderer sharedRenderer:(AppImplCocoaRendererGl*)aSharedRenderer;
 - (NSOpenGLView*)view;
 
 - (void)makeCurrentContext;
 - (CGLContextObj)getCglContext;
 - (CGLPixelFormatObj)getCglPixelFormat;
+- (NSOpenGLContext*)getNSOpenGLContext;
 - (void)flushBuffer;
 - (void)setFrameSize:(CGSize)newSize;
 - (void)defaultResize;
@@ -44,6 +44,9 @@
 - (void)setFrameSize:(CGSize)newSize;
 - (void)defaultResize;
 
+- (void)invalidateArea:(cinder::Area)area;
+- (void)getAreasBeingDrawn:(std::vector<cinder::Area>*)areas;
+
 - (CGContextRef)getCGContextRef;
 
 @end
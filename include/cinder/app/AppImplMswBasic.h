@@ -42,6 +42,8 @@ class AppImplMswBasic : public AppImplMsw {
 	class AppBasic*		getApp() { return mApp; }
 	
 	void	quit() { mShouldQuit = true; }
+	//! Wakes run() when it is waiting for a frame to be requested. Safe to call from any thread.
+	void	wakeUp();
 
 	void	setWindowPos( const Vec2i &aWindowPos );	
 	void	setWindowWidth( int aWindowWidth );
@@ -45,10 +45,18 @@ class AppImplMswRendererGdi : public AppImplMswRenderer {
 	
 	virtual HDC		getDc() const { return ( mDoubleBuffer ) ? mDoubleBufferDc : mPaintDc; }
 	Surface8u		copyWindowContents( const Area &area );
+
+	//! Limits drawing and presenting to the window's update region rather than the whole window
+	void						enablePartialRedraw( bool enable ) { mPartialRedraw = enable; }
+	//! Returns the rects of the update region makeCurrentContext() clipped to, or an empty vector when drawing the whole window
+	const std::vector<Area>&	getUpdateAreas() const { return mUpdateAreas; }
 	
  protected:
 	::HDC			mPaintDc;
 	::PAINTSTRUCT	mPaintStruct;
+
+	bool				mPartialRedraw;
+	std::vector<Area>	mUpdateAreas;
 	
 	bool			mDoubleBuffer;
 	::HDC			mDoubleBufferDc;
@@ -29,7 +29,7 @@ namespace cinder { namespace app {
 
 class AppImplMswRendererGl : public AppImplMswRenderer {
  public:
-	AppImplMswRendererGl( App *aApp, RendererGl *aRenderer );
+	AppImplMswRendererGl( App *aApp, RendererGl *aRenderer, AppImplMswRendererGl *sharedImpl = 0 );
 	
 	virtual bool	initialize( HWND wnd, HDC dc );
 	virtual void	prepareToggleFullScreen();
@@ -44,6 +44,7 @@ class AppImplMswRendererGl : public AppImplMswRenderer {
 	int		initMultisample( PIXELFORMATDESCRIPTOR pfd, int requestedLevelIdx, HDC dc );
 	
 	RendererGl	*mRenderer;
+	AppImplMswRendererGl	*mSharedImpl; // context whose objects are shared with ours, or NULL
 	bool		mWasFullScreen;
 	HGLRC		mRC, mPrevRC;
 	HDC			mDC;
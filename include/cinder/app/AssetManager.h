@@ -0,0 +1,143 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/TriMesh.h"
+#include "cinder/Function.h"
+#include "cinder/Thread.h"
+#include "cinder/gl/Texture.h"
+
+#include <boost/noncopyable.hpp>
+#include <functional>
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace cinder { namespace app {
+
+typedef std::shared_ptr<class AssetManager>		AssetManagerRef;
+
+/** \brief Loads Surfaces, gl::Textures and OBJ TriMeshes on demand on worker threads, most important first, and caches them within a memory budget.
+	Each get function returns the cached asset for a file, or requests it and returns an empty result. Calling it again every frame keeps the asset recently used,
+	and updates the priority of a pending request, so that an app can simply ask for what it currently shows. Requests with a higher priority are loaded first.
+	Once the cached assets exceed the memory budget, the least recently used ones are evicted. Loaded assets are added to the cache, and ready callbacks called,
+	on the app's thread before its next update(), through App::dispatchAsync(). All functions other than the constructor must be called from the app's thread. **/
+class AssetManager : private boost::noncopyable {
+  public:
+	//! Callback receiving a loaded Surface, which is empty if the load failed
+	typedef std::function<void(Surface8u)>					SurfaceFn;
+	//! Callback receiving a loaded gl::Texture, which is empty if the load failed
+	typedef std::function<void(gl::Texture)>				TextureFn;
+	//! Callback receiving a loaded TriMesh, which is NULL if the load failed
+	typedef std::function<void(std::shared_ptr<TriMesh>)>	TriMeshFn;
+
+	//! Creates an AssetManager which caches up to \a memoryBudget bytes of assets and loads up to \a numThreads at once
+	static AssetManagerRef	create( size_t memoryBudget = 256 * 1024 * 1024, int32_t numThreads = 2 );
+
+	//! Waits for the assets currently being loaded by each thread. Pending requests are abandoned without calling their callbacks.
+	~AssetManager();
+
+	/** Returns the Surface for the image file at \a path if it is cached. Otherwise requests it at \a priority, or updates the priority of its pending request,
+		and returns an empty Surface. \a readyFn is called once the request completes. Images which failed to load aren't requested again until clear(). **/
+	Surface8u					getSurface( const fs::path &path, float priority = 0, const SurfaceFn &readyFn = SurfaceFn() );
+	/** Returns the gl::Texture for the image file at \a path if it is cached. Otherwise requests it at \a priority, or updates the priority of its pending request,
+		and returns an empty gl::Texture. The image is decoded on a worker thread and uploaded using \a format on the app's thread. \a readyFn is called once the request completes. **/
+	gl::Texture					getTexture( const fs::path &path, float priority = 0, const TextureFn &readyFn = TextureFn(), const gl::Texture::Format &format = gl::Texture::Format() );
+	/** Returns the TriMesh for the OBJ file at \a path if it is cached. Otherwise requests it at \a priority, or updates the priority of its pending request,
+		and returns NULL. \a readyFn is called once the request completes. **/
+	std::shared_ptr<TriMesh>	getTriMesh( const fs::path &path, float priority = 0, const TriMeshFn &readyFn = TriMeshFn() );
+
+	//! Abandons the pending requests for \a path which haven't started loading, without calling their callbacks
+	void		cancel( const fs::path &path );
+	//! Abandons all pending requests which haven't started loading, without calling their callbacks
+	void		cancelAll();
+	//! Removes the assets loaded from \a path from the cache
+	void		evict( const fs::path &path );
+	//! Removes all assets from the cache, abandons all pending requests and forgets which loads have failed
+	void		clear();
+
+	//! Sets the number of bytes of assets the cache may hold, evicting the least recently used assets as needed
+	void		setMemoryBudget( size_t memoryBudget );
+	//! Returns the number of bytes of assets the cache may hold
+	size_t		getMemoryBudget() const { return mMemoryBudget; }
+	//! Returns the approximate number of bytes used by the cached assets
+	size_t		getMemoryUsage() const;
+	//! Returns the number of cached assets
+	size_t		getNumCached() const;
+	//! Returns the number of requests which haven't completed, including those currently loading
+	size_t		getNumPending() const;
+
+  private:
+	AssetManager( size_t memoryBudget, int32_t numThreads );
+
+	enum Kind { SURFACE, TEXTURE, TRIMESH };
+	typedef std::pair<Kind,std::string>							Key;
+	typedef std::multimap<float,Key,std::greater<float> >		Queue;
+
+	struct Item {
+		Surface8u					mSurface;
+		gl::Texture					mTexture;
+		std::shared_ptr<TriMesh>	mTriMesh;
+		size_t						mSize;
+		std::list<Key>::iterator	mLruIt;
+	};
+
+	struct Request {
+		fs::path					mPath;
+		gl::Texture::Format			mFormat;
+		Queue::iterator				mQueueIt; // mQueue.end() once loading has started
+		std::vector<SurfaceFn>		mSurfaceFns;
+		std::vector<TextureFn>		mTextureFns;
+		std::vector<TriMeshFn>		mTriMeshFns;
+	};
+
+	struct Completion;
+
+	//! Returns the cached Item for \a key, marking it most recently used, or requests it at \a priority and returns NULL
+	Item*		find( Kind kind, const fs::path &path, float priority, Request **request );
+	void		threadFn();
+	void		complete( const Key &key, Surface8u surface, std::shared_ptr<TriMesh> triMesh, bool failed );
+	//! Evicts the least recently used Items until the cache fits the budget, except for \a keep. Evicted Items are appended to \a evicted so that they can be released outside the lock.
+	void		evictToBudget( const Key *keep, std::vector<Item> *evicted );
+
+	std::weak_ptr<AssetManager>		mWeakThis;
+	size_t							mMemoryBudget, mMemoryUsage;
+
+	std::map<Key,Item>				mItems;
+	std::list<Key>					mLru; // most recently used first
+	std::map<Key,Request>			mRequests;
+	Queue							mQueue;
+	std::set<Key>					mFailed;
+
+	std::vector<std::shared_ptr<std::thread> >	mThreads;
+	mutable std::mutex							mMutex;
+	std::condition_variable						mJobCond;
+	bool										mQuit;
+};
+
+} } // namespace cinder::app
@@ -0,0 +1,50 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#pragma once
+
+#include "cinder/FileWatcher.h"
+#include "cinder/Json.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/svg/Svg.h"
+
+namespace cinder { namespace app {
+
+/** Loads the image asset at \a relativePath into \a *texture, then reloads it whenever the file changes. A failed reload leaves \a *texture as it was and is reported to console().
+	Returns an identifier to pass to FileWatcher::unwatch() before \a texture is destroyed. **/
+CallbackId	watchAsset( const fs::path &relativePath, gl::Texture *texture, const gl::Texture::Format &format = gl::Texture::Format() );
+/** Loads the shader assets at \a vertexRelativePath and \a fragmentRelativePath into \a *glslProg, then rebuilds it whenever either file changes. A reload which fails
+	to compile or link leaves \a *glslProg as it was and reports the log to console(). Returns an identifier to pass to FileWatcher::unwatch() before \a glslProg is destroyed. **/
+CallbackId	watchAsset( const fs::path &vertexRelativePath, const fs::path &fragmentRelativePath, gl::GlslProg *glslProg );
+/** Loads the SVG asset at \a relativePath into \a *doc, then reloads it whenever the file changes. A failed reload leaves \a *doc as it was and is reported to console().
+	Returns an identifier to pass to FileWatcher::unwatch() before \a doc is destroyed. **/
+CallbackId	watchAsset( const fs::path &relativePath, svg::DocRef *doc );
+/** Loads the JSON asset at \a relativePath into \a *jsonTree, then reloads it whenever the file changes. A failed reload leaves \a *jsonTree as it was and is reported to console().
+	Returns an identifier to pass to FileWatcher::unwatch() before \a jsonTree is destroyed. **/
+CallbackId	watchAsset( const fs::path &relativePath, JsonTree *jsonTree );
+
+} } // namespace cinder::app
@@ -0,0 +1,120 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/DataSource.h"
+#include "cinder/Function.h"
+#include "cinder/Thread.h"
+#include "cinder/gl/Texture.h"
+
+#include <boost/noncopyable.hpp>
+#include <deque>
+#include <vector>
+
+namespace cinder { namespace app {
+
+typedef std::shared_ptr<class AsyncSurface>			AsyncSurfaceRef;
+typedef std::shared_ptr<class AsyncImageLoader>		AsyncImageLoaderRef;
+
+//! The eventual result of an asynchronous image load, analogous to a future
+class AsyncSurface : private boost::noncopyable {
+  public:
+	//! Returns whether the load has finished, successfully or not
+	bool		isReady() const;
+	//! Returns whether the load has finished unsuccessfully
+	bool		hasFailed() const;
+	//! Blocks until the load has finished
+	void		wait() const;
+	//! Blocks until the load has finished and returns the loaded Surface, which is empty if the load failed
+	Surface8u	getSurface() const;
+
+  private:
+	AsyncSurface() : mReady( false ), mFailed( false ) {}
+
+	void		setResult( const Surface8u &surface, bool failed );
+
+	mutable std::mutex				mMutex;
+	mutable std::condition_variable	mReadyCond;
+	bool							mReady, mFailed;
+	Surface8u						mSurface;
+
+	friend class AsyncImageLoader;
+};
+
+/** \brief Decodes images on a pool of worker threads.
+	Completion callbacks are called on the app's thread before its next update(), through App::dispatchAsync(). In the absence of an active App they are called on the worker thread. **/
+class AsyncImageLoader : private boost::noncopyable {
+  public:
+	//! Callback receiving the loaded Surface, which is empty if the load failed
+	typedef std::function<void(Surface8u)>		SurfaceFn;
+
+	//! Creates an AsyncImageLoader which decodes up to \a numThreads images at once
+	static AsyncImageLoaderRef	create( int32_t numThreads = 2 ) { return AsyncImageLoaderRef( new AsyncImageLoader( numThreads ) ); }
+	//! Returns a shared AsyncImageLoader, created upon first use
+	static AsyncImageLoaderRef	getDefault();
+
+	//! Waits for the image currently being decoded by each thread. Images which haven't started loading fail without calling their callbacks.
+	~AsyncImageLoader();
+
+	//! Loads the image at \a path on a worker thread. If \a readyFn is supplied it is called with the result on the app's thread.
+	AsyncSurfaceRef		load( const fs::path &path, const SurfaceFn &readyFn = SurfaceFn() );
+	//! Loads the image in \a dataSource on a worker thread. If \a readyFn is supplied it is called with the result on the app's thread.
+	AsyncSurfaceRef		load( DataSourceRef dataSource, const SurfaceFn &readyFn = SurfaceFn() );
+
+	//! Returns the number of images waiting to be decoded, not including those currently being decoded
+	size_t				getNumPending() const;
+
+  private:
+	AsyncImageLoader( int32_t numThreads );
+
+	struct Job {
+		fs::path			mPath;
+		DataSourceRef		mDataSource;
+		AsyncSurfaceRef		mResult;
+		SurfaceFn			mReadyFn;
+	};
+
+	AsyncSurfaceRef		enqueue( const Job &job );
+	void				threadFn();
+	static void			complete( const Job &job, const Surface8u &surface, bool failed );
+
+	std::vector<std::shared_ptr<std::thread> >	mThreads;
+	mutable std::mutex							mMutex;
+	std::condition_variable						mJobCond;
+	std::deque<Job>								mJobs;
+	bool										mQuit;
+};
+
+//! Loads the image at \a path on the default AsyncImageLoader. If \a readyFn is supplied it is called with the result on the app's thread before update().
+AsyncSurfaceRef		loadImageAsync( const fs::path &path, const AsyncImageLoader::SurfaceFn &readyFn = AsyncImageLoader::SurfaceFn() );
+//! Loads the image in \a dataSource on the default AsyncImageLoader. If \a readyFn is supplied it is called with the result on the app's thread before update().
+AsyncSurfaceRef		loadImageAsync( DataSourceRef dataSource, const AsyncImageLoader::SurfaceFn &readyFn = AsyncImageLoader::SurfaceFn() );
+/** Loads the image at \a path on the default AsyncImageLoader and calls \a readyFn on the app's thread with a gl::Texture created from it using \a format.
+	The texture is uploaded on the app's thread, where the GL context is current. \a readyFn receives an empty gl::Texture if the load failed. **/
+void				loadTextureAsync( const fs::path &path, const std::function<void(gl::Texture)> &readyFn, gl::Texture::Format format = gl::Texture::Format() );
+
+} } // namespace cinder::app
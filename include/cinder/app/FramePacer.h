@@ -0,0 +1,108 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Timer.h"
+
+#include <boost/noncopyable.hpp>
+#include <deque>
+
+namespace cinder { namespace gl {
+class Fence;
+} } // namespace cinder::gl
+
+namespace cinder { namespace app {
+
+/** \brief Paces the App's frames precisely and keeps per-frame timing statistics. Accessed through App::getFramePacer().
+	Waits sleep until shortly before their deadline and spin for the remainder, since OS sleeps routinely overshoot by a millisecond or more.
+	With GPU waiting enabled each frame first waits for the GPU to finish drawing the previous one, so the CPU can't queue frames ahead of it,
+	which trades some throughput for lower input latency. **/
+class FramePacer : private boost::noncopyable {
+  public:
+	//! Creates a FramePacer which measures time with \a timer
+	explicit FramePacer( const Timer &timer );
+
+	//! Returns the current time of the timer frames are paced against. Unlike App::getElapsedSeconds() it always follows the clock.
+	double	getSeconds() const { return mTimer->getSeconds(); }
+
+	//! Sets how long before a deadline waitUntil() stops sleeping and starts spinning. Defaults to \c 0.002 seconds
+	void	setSpinDuration( double seconds ) { mSpinDuration = std::max( 0.0, seconds ); }
+	//! Returns how long before a deadline waitUntil() stops sleeping and starts spinning
+	double	getSpinDuration() const { return mSpinDuration; }
+	//! Blocks until the timer reaches \a seconds, sleeping for most of the time and spinning for the last getSpinDuration() seconds
+	void	waitUntil( double seconds ) const;
+	//! Spins until the timer reaches \a seconds
+	void	spinUntil( double seconds ) const;
+	//! Sleeps for \a seconds using the finest timer resolution the OS provides. May still overshoot, which waitUntil() compensates for.
+	static void	sleep( double seconds );
+
+	//! Sets whether each frame waits for the GPU to finish drawing the previous one before update(). Requires gl::Fence support. Defaults to \c false
+	void	enableGpuWait( bool enable = true ) { mGpuWait = enable; }
+	//! Returns whether each frame waits for the GPU to finish drawing the previous one
+	bool	isGpuWaitEnabled() const { return mGpuWait; }
+
+	//! Sets the number of recent frames the statistics are computed over. Defaults to \c 120
+	void	setNumSamples( size_t numFrames );
+	//! Returns the number of recent frames the statistics are computed over
+	size_t	getNumSamples() const { return mNumSamples; }
+	//! Returns the time in seconds between the starts of the two most recent frames
+	double	getLastFrameDuration() const;
+	//! Returns the mean time in seconds between the starts of recent frames
+	double	getAverageFrameDuration() const;
+	//! Returns the shortest time in seconds between the starts of recent frames
+	double	getMinFrameDuration() const;
+	//! Returns the longest time in seconds between the starts of recent frames
+	double	getMaxFrameDuration() const;
+	//! Returns the standard deviation in seconds of the time between the starts of recent frames, a measure of jitter
+	double	getFrameDurationDeviation() const;
+	//! Returns the time in seconds the most recently completed frame spent in update(), including every call at a fixed update rate
+	double	getLastUpdateDuration() const { return mLastUpdateDuration; }
+	//! Returns the time in seconds the most recent frame spent in draw()
+	double	getLastDrawDuration() const { return mLastDrawDuration; }
+	//! Returns the time in seconds the most recent frame spent waiting for the GPU
+	double	getLastGpuWaitDuration() const { return mLastGpuWaitDuration; }
+
+  private:
+	// called by App
+	void	beginFrame();
+	void	beginDraw();
+	void	endDraw();
+
+	const Timer					*mTimer;
+	double						mSpinDuration;
+	bool						mGpuWait;
+	std::shared_ptr<gl::Fence>	mFence;
+
+	size_t				mNumSamples;
+	std::deque<double>	mFrameDurations;
+	double				mFrameStart, mDrawStart;
+	double				mLastUpdateDuration, mLastDrawDuration, mLastGpuWaitDuration;
+
+	friend class App;
+};
+
+} } // namespace cinder::app
@@ -24,6 +24,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/gl/gl.h"  // necessary to give GLee the jump on Cocoa.h
+#include "cinder/gl/Fbo.h"
 #include "cinder/Surface.h"
 #include "cinder/Display.h"
 
@@ -117,6 +118,7 @@ class RendererGl : public Renderer {
 	virtual HWND	getHwnd() { return mWnd; }
 	virtual void	prepareToggleFullScreen();
 	virtual void	finishToggleFullScreen();
+	void			makeCurrentContext();
 #endif
 
 	enum	{ AA_NONE = 0, AA_MSAA_2, AA_MSAA_4, AA_MSAA_6, AA_MSAA_8, AA_MSAA_16, AA_MSAA_32 };
@@ -124,13 +126,60 @@ class RendererGl : public Renderer {
 	void				setAntiAliasing( int aAntiAliasing );
 	int					getAntiAliasing() const { return mAntiAliasing; }
 
+	//! Makes this renderer's context share OpenGL objects (textures, buffers, shaders, display lists) with \a sharedRenderer's. Must be called before setup(), and \a sharedRenderer must already be set up.
+	void				setSharedRenderer( RendererGl *sharedRenderer ) { mSharedRenderer = sharedRenderer; }
+	//! Returns the renderer this one shares OpenGL objects with, or NULL
+	RendererGl*			getSharedRenderer() const { return mSharedRenderer; }
+
+	/** Draws into an internal framebuffer between \a minScale and \a maxScale of the window's resolution, which is upscaled to the window when presented.
+		The scale drops when drawing a frame, including its buffer swap, takes longer than \a targetFrameTime seconds, and rises again once frames have fit for a while.
+		draw() must leave the viewport alone or set it to getDrawSize() rather than the window's size. A \a targetFrameTime of \c 0, the default, draws at full resolution. Ignored by headless apps. **/
+	void				setDynamicResolution( double targetFrameTime, float minScale = 0.5f, float maxScale = 1.0f );
+	//! Returns the frame time dynamic resolution aims for in seconds, or \c 0 if it is disabled
+	double				getDynamicResolutionTargetFrameTime() const { return mTargetFrameTime; }
+	//! Sets the fraction by which the smoothed frame time may exceed the target before the resolution drops. Defaults to \c 0.1
+	void				setDynamicResolutionHysteresis( float hysteresis ) { mResolutionHysteresis = std::max( 0.0f, hysteresis ); }
+	//! Returns the fraction by which the smoothed frame time may exceed the target before the resolution drops
+	float				getDynamicResolutionHysteresis() const { return mResolutionHysteresis; }
+	//! Returns the fraction of the window's resolution the most recent frame was drawn at, which is \c 1 without dynamic resolution
+	float				getResolutionScale() const { return ( mDynamicResolutionDrawing ) ? mResolutionScale : 1.0f; }
+	//! Returns the size in pixels the most recent frame was drawn at, which is smaller than the window's with dynamic resolution
+	Vec2i				getDrawSize() const;
+	//! Returns whether the driver supports dynamic resolution, which requires \c GL_EXT_framebuffer_blit except on OpenGL ES
+	static bool			isDynamicResolutionSupported();
+
 	virtual void	startDraw();
 	virtual void	finishDraw();
 	virtual void	defaultResize();
 	virtual Surface	copyWindowSurface( const Area &area );
 	
  protected:
+	// headless apps draw into an offscreen framebuffer the size of the window rather than the hidden window itself
+	bool		isHeadless() const;
+	void		startHeadlessDraw();
+	Surface		copyHeadlessSurface( const Area &area );
+	//! Returns the number of MSAA samples for an Fbo matching the window's antialiasing
+	int			getFboSamples() const;
+
+	// with dynamic resolution, frames are drawn into mDynamicResolutionFbo at mDrawSize and upscaled to the window's framebuffer at mScreenSize
+	void		initDynamicResolution();
+	void		startDynamicResolutionDraw();
+	void		finishDynamicResolutionDraw();
+	void		updateResolutionScale( double frameTime );
+
 	int			mAntiAliasing;
+	RendererGl	*mSharedRenderer;
+	gl::Fbo		mHeadlessFbo;
+
+	double		mTargetFrameTime;
+	float		mMinResolutionScale, mMaxResolutionScale, mResolutionHysteresis;
+	float		mResolutionScale;
+	double		mSmoothedFrameTime, mDrawStartTime;
+	int			mFramesWithinTarget, mFramesSinceScaleChange, mUpscaleDelay;
+	bool		mLastScaleChangeWasUp, mDynamicResolutionDrawing;
+	gl::Fbo		mDynamicResolutionFbo;
+	Vec2i		mScreenSize, mDrawSize;
+	GLint		mScreenFramebuffer;
 #if defined( CINDER_MAC )
 	AppImplCocoaRendererGl		*mImpl;
 #elif defined( CINDER_COCOA_TOUCH )
@@ -144,6 +193,7 @@ class RendererGl : public Renderer {
 #if defined( CINDER_COCOA )
 class Renderer2d : public Renderer {
  public:
+	Renderer2d();
 	#if defined( CINDER_COCOA_TOUCH )
 		virtual void setup( App *aApp, const Area &frame, UIView *cinderView );
 	#else
@@ -153,6 +203,15 @@ class Renderer2d : public Renderer {
 
 	virtual CGContextRef			getCgContext();
 
+	/** Enables redrawing only the areas of the window passed to invalidate() rather than the whole window each frame. The graphics context is
+		clipped to those areas during draw(), only they are copied to the screen, and a frame with none is not drawn at all. Supported on Mac and Windows. **/
+	void						enablePartialRedraw( bool enable = true );
+	bool						isPartialRedrawEnabled() const { return mPartialRedraw; }
+	//! Marks \a area of the window, in pixels, as needing to be redrawn, and calls App::requestRedraw(). With partial redraw disabled the whole window is redrawn anyway.
+	void						invalidate( const Area &area );
+	//! Returns the areas of the window being redrawn during draw(), which is the whole window unless partial redraw is enabled
+	const std::vector<Area>&	getDrawAreas() const { return mDrawAreas; }
+
 	virtual void startDraw();
 	virtual void finishDraw();
 	virtual void setFrameSize( int width, int height );
@@ -166,6 +225,8 @@ class Renderer2d : public Renderer {
 	AppImplCocoaTouchRendererQuartz		*mImpl;
 #endif
 	CGContextRef					mCGContext;
+	bool							mPartialRedraw;
+	std::vector<Area>				mDrawAreas;
 };
 
 #elif defined( CINDER_MSW )
@@ -183,6 +244,15 @@ class Renderer2d : public Renderer {
 	virtual void	prepareToggleFullScreen();
 	virtual void	finishToggleFullScreen();
 
+	/** Enables redrawing only the areas of the window passed to invalidate() rather than the whole window each frame. The graphics context is
+		clipped to those areas during draw(), only they are copied to the screen, and a frame with none is not drawn at all. Supported on Mac and Windows. **/
+	void						enablePartialRedraw( bool enable = true );
+	bool						isPartialRedrawEnabled() const { return mPartialRedraw; }
+	//! Marks \a area of the window, in pixels, as needing to be redrawn, and calls App::requestRedraw(). With partial redraw disabled the whole window is redrawn anyway.
+	void						invalidate( const Area &area );
+	//! Returns the areas of the window being redrawn during draw(), which is the whole window unless partial redraw is enabled
+	const std::vector<Area>&	getDrawAreas() const { return mDrawAreas; }
+
 	virtual void startDraw();
 	virtual void finishDraw();
 	virtual void defaultResize();
@@ -191,9 +261,11 @@ class Renderer2d : public Renderer {
  protected:
 	class AppImplMswRendererGdi	*mImpl;
 
-	bool			mDoubleBuffer;
-	HWND			mWnd;
-	HDC				mDC;
+	bool				mDoubleBuffer;
+	HWND				mWnd;
+	HDC					mDC;
+	bool				mPartialRedraw;
+	std::vector<Area>	mDrawAreas;
 };
 
 #endif
@@ -56,12 +56,18 @@ class TouchEvent : public Event {
 		double		getTime() const { return mTime; }
 		//! Returns a pointer to the OS-native object. This is a UITouch* on Cocoa Touch and a TOUCHPOINT* on MSW.
 		const void*	getNative() const { return mNative; }
+		/** With event coalescing enabled, returns the positions the touch passed through between getPrevPos() and getPos() whose touchesMoved() events were merged
+			into this one, oldest first. Empty otherwise. \sa App::Settings::enableEventCoalescing() **/
+		const std::vector<Vec2f>&	getHistory() const { return mHistory; }
 		
 	  private:
 		Vec2f		mPos, mPrevPos;
 		uint32_t	mId;
 		double		mTime;
 		void		*mNative;
+		std::vector<Vec2f>	mHistory;
+
+		friend class TouchEvent;
 	};
   
 	TouchEvent() : Event() {}
@@ -71,6 +77,26 @@ class TouchEvent : public Event {
 	
 	//! Returns a std::vector of Touch descriptors associated with this event
 	const std::vector<Touch>&	getTouches() const { return mTouches; }
+
+	/** Merges \a later, a subsequent touchesMoved event, into this one. Touches present in both keep this event's previous position, take \a later's position,
+		time and native object, and record the position they move away from in Touch::getHistory(). Touches only in \a later are appended. **/
+	void	coalesce( const TouchEvent &later )
+	{
+		for( std::vector<Touch>::const_iterator laterIt = later.mTouches.begin(); laterIt != later.mTouches.end(); ++laterIt ) {
+			std::vector<Touch>::iterator touchIt = mTouches.begin();
+			while( ( touchIt != mTouches.end() ) && ( touchIt->mId != laterIt->mId ) )
+				++touchIt;
+			if( touchIt == mTouches.end() ) {
+				mTouches.push_back( *laterIt );
+				continue;
+			}
+			touchIt->mHistory.push_back( touchIt->mPos );
+			touchIt->mHistory.insert( touchIt->mHistory.end(), laterIt->mHistory.begin(), laterIt->mHistory.end() );
+			touchIt->mPos = laterIt->mPos;
+			touchIt->mTime = laterIt->mTime;
+			touchIt->mNative = laterIt->mNative;
+		}
+	}
 	
   private:
 	std::vector<Touch>		mTouches;
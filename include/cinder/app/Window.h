@@ -0,0 +1,117 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Exception.h"
+#include "cinder/Area.h"
+#include "cinder/Display.h"
+#include "cinder/app/Renderer.h"
+
+#include <string>
+
+namespace cinder { namespace app {
+
+typedef std::shared_ptr<class Window>	WindowRef;
+
+/** \brief An additional window of an AppBasic, typically covering another display
+	Created with AppBasic::createWindow(). Each Window owns a RendererGl whose context shares its OpenGL objects (textures, VBOs, GLSL programs, FBOs' attachments)
+	with the app's RendererGl, so resources loaded once in setup() can be drawn on every Window. AppBasic::drawWindow() is called for each Window once per frame after draw().
+	Input events are only delivered for the app's main window. **/
+class Window {
+ public:
+	class Format {
+	  public:
+		Format() : mDisplay( 0 ), mSize( 640, 480 ), mPos( 0, 0 ), mPosSpecified( false ), mFullScreen( false ), mBorderless( false ) {}
+
+		//! Places the Window on \a display. Defaults to the main display.
+		void		setDisplay( Display *display ) { mDisplay = display; }
+		Display*	getDisplay() const { return mDisplay; }
+		//! Sets the size of the Window's drawable area. Ignored when full-screen. Defaults to 640x480.
+		void		setSize( const Vec2i &size ) { mSize = size; }
+		Vec2i		getSize() const { return mSize; }
+		//! Sets the position of the Window's upper-left corner in screen coordinates. Defaults to centered on its display.
+		void		setPos( const Vec2i &pos ) { mPos = pos; mPosSpecified = true; }
+		Vec2i		getPos() const { return mPos; }
+		bool		isPosSpecified() const { return mPosSpecified; }
+		//! Makes the Window borderless and covering its entire display. Defaults to \c false.
+		void		setFullScreen( bool fullScreen = true ) { mFullScreen = fullScreen; }
+		bool		isFullScreen() const { return mFullScreen; }
+		//! Removes the Window's border (chrome/frame). Defaults to \c false.
+		void		setBorderless( bool borderless = true ) { mBorderless = borderless; }
+		bool		isBorderless() const { return mBorderless; }
+		void				setTitle( const std::string &title ) { mTitle = title; }
+		const std::string&	getTitle() const { return mTitle; }
+
+	  private:
+		Display		*mDisplay;
+		Vec2i		mSize, mPos;
+		bool		mPosSpecified, mFullScreen, mBorderless;
+		std::string	mTitle;
+	};
+
+	~Window();
+
+	//! Returns the width of the Window's drawable area measured in pixels
+	int			getWidth() const { return mSize.x; }
+	//! Returns the height of the Window's drawable area measured in pixels
+	int			getHeight() const { return mSize.y; }
+	Vec2i		getSize() const { return mSize; }
+	float		getAspectRatio() const { return mSize.x / (float)mSize.y; }
+	Area		getBounds() const { return Area( 0, 0, mSize.x, mSize.y ); }
+	//! Returns the Display the Window was created on
+	Display*	getDisplay() const { return mDisplay; }
+	//! Returns the Window's renderer, which shares OpenGL objects with the app's RendererGl
+	RendererGl*	getRenderer() const { return mRenderer.get(); }
+
+	//! Closes the Window. It stops receiving drawWindow() and is removed from AppBasic::getWindows() at the next frame.
+	void		close() { mClosed = true; }
+	//! Returns whether the Window has been closed, either by close() or by the user
+	bool		isClosed() const { return mClosed; }
+
+	//! \cond
+	// called by AppBasic once per frame with the Window's context current; applies any change in size to the renderer
+	void		privateUpdateSize__();
+	//! \endcond
+
+ private:
+	Window( class App *app, const Format &format, RendererGl *sharedRenderer );
+
+	struct Impl;
+
+	std::shared_ptr<Impl>		mImpl;
+	std::shared_ptr<RendererGl>	mRenderer;
+	Display						*mDisplay;
+	Vec2i						mSize;
+	bool						mClosed, mNeedsResize;
+
+	friend class AppBasic;
+};
+
+class WindowExc : public cinder::Exception {
+};
+
+} } // namespace cinder::app
@@ -0,0 +1,163 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Function.h"
+#include "cinder/audio/PcmBuffer.h"
+#include "cinder/audio/FftProcessor.h"
+
+#include <vector>
+
+namespace cinder { namespace audio {
+
+/** Level and spectrum measurements for visualizers, using the SSE2 code paths of cinder::ip where they're available. **/
+
+//! Returns the root mean square of the \a count samples at \a samples
+float	calculateRms( const float *samples, size_t count );
+//! Returns the largest absolute value of the \a count samples at \a samples
+float	calculatePeak( const float *samples, size_t count );
+//! Returns the spectral flux between two frames of \a bandCount magnitudes: the sum of the increases from \a previous to \a current, as decreases don't mark onsets
+float	calculateSpectralFlux( const float *current, const float *previous, size_t bandCount );
+
+//! Returns the root mean square of channel \a channelId of \a buffer, which must be non-interleaved
+float	calculateRms( const PcmBuffer32f &buffer, ChannelIdentifier channelId = CHANNEL_FRONT_LEFT );
+//! Returns the largest absolute sample of channel \a channelId of \a buffer, which must be non-interleaved
+float	calculatePeak( const PcmBuffer32f &buffer, ChannelIdentifier channelId = CHANNEL_FRONT_LEFT );
+
+typedef std::shared_ptr<class MelFilterBank> MelFilterBankRef;
+
+/** \brief Sums FFT magnitudes into bands spaced evenly on the mel scale, which follows perceived pitch, so that visualizers get a few meaningful bands rather than hundreds of linear ones.
+	Each mel band is a triangle overlapping its neighbours by half, and its energy is the weighted sum of the squared magnitudes under it. **/
+class MelFilterBank {
+ public:
+	//! Creates a bank of \a melBandCount bands between \a minHz and \a maxHz, or the Nyquist frequency if it's 0, for FFTs of \a fftBandCount bands of audio at \a sampleRate
+	static MelFilterBankRef create( uint16_t fftBandCount, uint32_t sampleRate, uint16_t melBandCount = 40, float minHz = 20.0f, float maxHz = 0 );
+
+	//! Writes the getMelBandCount() band energies of the getFftBandCount() \a magnitudes to \a energiesOut
+	void		process( const float *magnitudes, float *energiesOut ) const;
+
+	uint16_t	getFftBandCount() const { return mFftBandCount; }
+	uint16_t	getMelBandCount() const { return (uint16_t)mBands.size(); }
+	//! Returns the center frequency of mel band \a band in Hz
+	float		getCenterFrequency( uint16_t band ) const { return mBands[band].mCenterHz; }
+
+	static float	hzToMel( float hz );
+	static float	melToHz( float mel );
+ private:
+	MelFilterBank( uint16_t fftBandCount, uint32_t sampleRate, uint16_t melBandCount, float minHz, float maxHz );
+
+	// only the FFT bands under a triangle have non-zero weights, so each band keeps just those
+	struct Band {
+		size_t				mFirstFftBand;
+		std::vector<float>	mWeights;
+		float				mCenterHz;
+	};
+
+	uint16_t			mFftBandCount;
+	std::vector<Band>	mBands;
+};
+
+//! An onset found by an OnsetDetector
+struct Onset {
+	//! The index of the frame at the center of the analysis window the onset was found in, counted from the first sample processed
+	uint64_t	mFrame;
+	//! The time of mFrame in seconds
+	double		mTime;
+	//! How far the spectral flux rose above the threshold
+	float		mStrength;
+};
+
+typedef std::shared_ptr<class OnsetDetector> OnsetDetectorRef;
+
+/** \brief Finds onsets, such as drum hits and note attacks, in a stream of samples that is fed to it block by block.
+	Every hop of the stream is transformed with a Hann-windowed FFT, and the spectral flux of the log-compressed magnitudes is compared to an adaptive threshold,
+	the running mean of the recent flux scaled by the sensitivity plus an offset. A local maximum of the flux above the threshold is an onset, unless it follows the previous one too closely.
+	Each hop costs one FFT and the threshold is updated with a running sum, so nothing is recomputed over the history. The tempo is estimated from the intervals between onsets. **/
+class OnsetDetector {
+ public:
+	typedef std::function<void (const Onset &)>	OnsetFn;
+
+	/** Creates a detector for mono audio at \a sampleRate, analyzing windows of \a bandCount * 2 samples every \a hopSize samples, or every half window if it's 0.
+		The threshold averages the flux over the last \a thresholdSeconds. **/
+	static OnsetDetectorRef create( uint32_t sampleRate, uint16_t bandCount = 512, uint16_t hopSize = 0, float thresholdSeconds = 0.5f );
+
+	//! Feeds \a count samples to the detector, calling the OnsetFn for each onset found. Returns the number of onsets found.
+	size_t		process( const float *samples, size_t count );
+	//! Feeds the samples of \a buffer, which must be non-interleaved, averaging its first two channels
+	size_t		process( const PcmBuffer32f &buffer );
+	//! Forgets all samples and onsets, and starts counting frames from 0 again
+	void		reset();
+
+	//! Sets the function called for each onset, from within process(). The onset times can be handed to Timeline::add() or turned into app events.
+	void		setOnsetFn( const OnsetFn &fn ) { mOnsetFn = fn; }
+	//! Sets the factor applied to the mean flux, 1.5 by default, and the offset added to it, 0.05 by default. Higher values find fewer onsets.
+	void		setThreshold( float multiplier, float offset ) { mThresholdMultiplier = multiplier; mThresholdOffset = offset; }
+	//! Sets the shortest time between two onsets, 0.05 seconds by default
+	void		setMinInterval( float seconds ) { mMinIntervalFrames = (uint64_t)( seconds * mSampleRate ); }
+
+	//! Returns the spectral flux of the latest hop
+	float		getFlux() const { return mFlux[2]; }
+	//! Returns the threshold the latest hop was compared to
+	float		getThreshold() const { return mThreshold; }
+	//! Returns the most recent onset, whose mFrame is 0 before the first
+	const Onset&	getLastOnset() const { return mLastOnset; }
+	//! Returns the tempo in beats per minute estimated from the recent intervals between onsets, or 0 until there are enough
+	float		getTempo() const;
+	//! Returns the magnitudes of the latest hop's FFT, getBandCount() of them
+	const std::vector<float>&	getMagnitudes() const { return mMagnitudes; }
+	uint16_t	getBandCount() const { return mFft->getBandCount(); }
+	uint32_t	getSampleRate() const { return mSampleRate; }
+ private:
+	OnsetDetector( uint32_t sampleRate, uint16_t bandCount, uint16_t hopSize, float thresholdSeconds );
+	// analyzes the full window in mWindow, returning whether an onset was found
+	bool		processHop();
+
+	uint32_t			mSampleRate;
+	size_t				mHopSize;
+	FftProcessorRef		mFft;
+	OnsetFn				mOnsetFn;
+
+	std::vector<float>	mWindow;
+	size_t				mWindowFill;
+	uint64_t			mWindowStartFrame;
+	std::vector<float>	mMagnitudes, mLogMagnitudes, mPrevLogMagnitudes;
+
+	// the flux of the last three hops, oldest first, as a peak is only known once the flux falls again
+	float				mFlux[3];
+	float				mThreshold, mPrevThreshold;
+	std::vector<float>	mFluxHistory;
+	size_t				mFluxHistoryPos, mFluxHistoryFill;
+	double				mFluxSum;
+	float				mThresholdMultiplier, mThresholdOffset;
+	uint64_t			mMinIntervalFrames;
+
+	Onset				mLastOnset;
+	// an exponential average of the intervals between onsets that fall in the range of musical beats
+	double				mBeatInterval;
+};
+
+}} //namespace
@@ -0,0 +1,67 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/audio/PcmBuffer.h"
+
+namespace cinder { namespace audio {
+
+/** Sample conversion between the formats used by audio loaders and outputs. Integers map to floats in [-1,1) by scaling by 1/32768 for int16_t
+	and 1/2^31 for int32_t, and floats are clipped on the way back. The SSE2 code paths of cinder::ip are used where they're available. **/
+
+//! Converts \a count samples from \a src to \a dst
+void	convertSamples( const int16_t *src, float *dst, size_t count );
+void	convertSamples( const float *src, int16_t *dst, size_t count );
+void	convertSamples( const int32_t *src, float *dst, size_t count );
+void	convertSamples( const float *src, int32_t *dst, size_t count );
+void	convertSamples( const int16_t *src, int32_t *dst, size_t count );
+void	convertSamples( const int32_t *src, int16_t *dst, size_t count );
+void	convertSamples( const float *src, float *dst, size_t count );
+void	convertSamples( const int16_t *src, int16_t *dst, size_t count );
+void	convertSamples( const int32_t *src, int32_t *dst, size_t count );
+
+//! Interleaves \a frameCount frames from the \a channelCount planar channels \a src into \a dst
+void	interleave( const float * const *src, size_t channelCount, size_t frameCount, float *dst );
+//! Splits \a frameCount frames of \a channelCount interleaved channels from \a src into the planar channels \a dst
+void	deinterleave( const float *src, size_t channelCount, size_t frameCount, float * const *dst );
+/** Remixes \a frameCount interleaved frames of \a srcChannelCount channels from \a src into \a dstChannelCount channels at \a dst, which must not overlap.
+	Mono is copied to every channel and anything is averaged down to mono. Otherwise channels are copied in order, and extra destination channels are silenced. **/
+void	mixChannels( const float *src, size_t srcChannelCount, float *dst, size_t dstChannelCount, size_t frameCount );
+
+//! Converts \a src to \a dst, which must have the same number of channels and room for \a src->mSampleCount frames
+template<typename T, typename U>
+void	convertBuffer( const BufferT<T> *src, BufferT<U> *dst );
+/** Converts \a src to \a dst, changing the sample format, interleaving and channel count as needed. A BufferList is interleaved when it has
+	a single buffer, and otherwise has one mono buffer per channel. The buffers of \a dst must have room for the mSampleCount of the first buffer of \a src.
+	Throws ConvertException for empty lists and more than 64 channels. **/
+template<typename T, typename U>
+void	convertBufferList( const BufferListT<T> *src, BufferListT<U> *dst );
+
+class ConvertException : public Exception {
+};
+
+}} //namespace
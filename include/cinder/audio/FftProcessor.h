@@ -25,15 +25,30 @@
 #include "cinder/Cinder.h"
 #include "cinder/audio/PcmBuffer.h"
 
+#include <vector>
+
 namespace cinder { namespace audio {
 
-std::shared_ptr<float> calculateFft( Buffer32fRef aBuffer, uint16_t aBandCount );
+//! Window functions which can be applied to the samples before the FFT, trading frequency resolution for less leakage between bands
+enum FftWindow { FFT_WINDOW_RECTANGULAR, FFT_WINDOW_HANN, FFT_WINDOW_HAMMING, FFT_WINDOW_BLACKMAN };
+
+//! Fills \a dest with the \a size coefficients of \a window
+void fillFftWindow( FftWindow window, float *dest, size_t size );
+
+//! Returns the magnitudes of the \a aBandCount bands of the FFT of the last \a aBandCount * 2 samples of \a aBuffer, weighted by \a window
+std::shared_ptr<float> calculateFft( Buffer32fRef aBuffer, uint16_t aBandCount, FftWindow window = FFT_WINDOW_RECTANGULAR );
+/** Writes the magnitudes of the \a aBandCount bands of the FFT of the last \a aBandCount * 2 samples of \a aBuffer, weighted by \a window, to \a magnitudesOut.
+	Reuses a shared FftProcessor for as long as the band count and window stay the same, so it doesn't allocate. Returns \c false if \a aBuffer is too short. **/
+bool calculateFft( Buffer32fRef aBuffer, uint16_t aBandCount, float * magnitudesOut, FftWindow window = FFT_WINDOW_RECTANGULAR );
 
 class FftProcessorImpl {
  public:
 	FftProcessorImpl( uint16_t aBandCount );
 	virtual ~FftProcessorImpl() {}
-	virtual std::shared_ptr<float> process( const float * inBuffer ) = 0;
+	//! Writes the magnitudes of the getBandCount() bands of the FFT of the getBandCount() * 2 samples at \a inBuffer to \a magnitudesOut, without allocating
+	virtual void process( const float * inBuffer, float * magnitudesOut ) = 0;
+	//! Returns the magnitudes of the getBandCount() bands of the FFT of the getBandCount() * 2 samples at \a inBuffer in a newly allocated array
+	std::shared_ptr<float> process( const float * inBuffer );
 	uint16_t getBandCount() const { return mBandCount; }
  protected:
 	uint16_t mBandCount;
@@ -45,13 +60,28 @@ class FftProcessor {
  public:
 	static const uint16_t	DEFAULT_BAND_COUNT = 512;
 	
-	static FftProcessorRef createRef( uint16_t aBandCount = DEFAULT_BAND_COUNT );
+	//! Creates a processor for \a aBandCount bands, which should be a power of 2, weighting its input by \a window
+	static FftProcessorRef createRef( uint16_t aBandCount = DEFAULT_BAND_COUNT, FftWindow window = FFT_WINDOW_RECTANGULAR );
 	
-	std::shared_ptr<float> process( const float * inBuffer ) { return mImpl->process( inBuffer ); }
+	//! Returns the magnitudes of the getBandCount() bands of the FFT of the getBandCount() * 2 samples at \a inBuffer
+	std::shared_ptr<float> process( const float * inBuffer );
+	//! Writes the magnitudes of the getBandCount() bands of the FFT of the getBandCount() * 2 samples at \a inBuffer to \a magnitudesOut, without allocating
+	void process( const float * inBuffer, float * magnitudesOut );
+	/** Computes the short-time Fourier transform of the \a sampleCount samples at \a inBuffer, as a series of frames of getBandCount() * 2 samples starting every \a hopSize samples.
+		Writes getBandCount() magnitudes per frame, one frame after another, to \a magnitudesOut, which must hold getNumFrames( \a sampleCount, \a hopSize ) frames. Returns the number of frames. **/
+	size_t processFrames( const float * inBuffer, size_t sampleCount, size_t hopSize, float * magnitudesOut );
+	//! Returns the number of frames processFrames() computes for \a sampleCount samples and \a hopSize
+	size_t getNumFrames( size_t sampleCount, size_t hopSize ) const;
 	uint16_t getBandCount() const { return mImpl->getBandCount(); }
+	FftWindow getWindow() const { return mWindow; }
  private:
-	FftProcessor( uint16_t aBandCount );
+	FftProcessor( uint16_t aBandCount, FftWindow window );
+	//! Returns \a inBuffer weighted by the window, in mWindowedBuffer
+	const float* applyWindow( const float * inBuffer );
+
 	std::shared_ptr<FftProcessorImpl> mImpl;
+	FftWindow			mWindow;
+	std::vector<float>	mWindowCoeffs, mWindowedBuffer;
 };
 
 }} //namespace
\ No newline at end of file
@@ -32,7 +32,8 @@ class FftProcessorImplAccelerate : public FftProcessorImpl {
 	FftProcessorImplAccelerate( uint16_t aBandCount );
 	~FftProcessorImplAccelerate();
 	
-	std::shared_ptr<float> process( const float * inBuffer );
+	using FftProcessorImpl::process;
+	void process( const float * inBuffer, float * magnitudesOut );
  private:
 	const static vDSP_Stride	sStride = 1;
 	
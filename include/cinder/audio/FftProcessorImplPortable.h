@@ -0,0 +1,52 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/audio/FftProcessor.h"
+
+#include <vector>
+
+namespace cinder { namespace audio {
+
+/** Real FFT in plain C++, vectorized with SSE2 where available, for platforms without the Accelerate framework.
+	The samples are transformed as a half-size complex FFT in split real/imaginary arrays, which is then untangled into the spectrum of the real signal.
+	Magnitudes are scaled to match FftProcessorImplAccelerate, including the DC and Nyquist terms combined in band 0. **/
+class FftProcessorImplPortable : public FftProcessorImpl {
+ public:
+	FftProcessorImplPortable( uint16_t aBandCount );
+
+	using FftProcessorImpl::process;
+	void process( const float * inBuffer, float * magnitudesOut );
+ private:
+	void		transform();
+
+	uint32_t				mSize; // number of complex points, the largest power of 2 not above the band count
+	std::vector<uint32_t>	mBitReverse;
+	std::vector<float>		mReal, mImag;
+	std::vector<float>		mStageTwiddleReal, mStageTwiddleImag; // the twiddles of each stage of the complex FFT, one stage after another
+	std::vector<float>		mTwiddleReal, mTwiddleImag; // the twiddles for untangling the real spectrum
+};
+
+}} //namespace
@@ -0,0 +1,301 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Exception.h"
+#include "cinder/Function.h"
+#include "cinder/TripleBuffer.h"
+#include "cinder/audio/Io.h"
+#include "cinder/audio/PcmBuffer.h"
+#include "cinder/audio/FftProcessor.h"
+
+#include <map>
+#include <vector>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class Node>		NodeRef;
+typedef std::shared_ptr<class Graph>	GraphRef;
+
+//! One block of stereo audio as two planar, 16-byte aligned channels of up to Graph::BLOCK_SIZE frames
+struct NodeBlock {
+	float		*mChannels[2];
+};
+
+//! Describes the block being rendered
+struct RenderContext {
+	uint32_t	mSampleRate;
+	//! Index since the graph started playing of the first frame in the block
+	uint64_t	mFrame;
+	//! Number of frames in the block, at most Graph::BLOCK_SIZE
+	uint32_t	mFrameCount;
+};
+
+/** \brief Base class of the units of processing in an audio Graph.
+	Each node owns a preallocated output block, which process() fills from the output blocks of its inputs once per block. process() runs on the audio thread
+	and so must neither allocate nor lock. Parameters are set from the app thread as single words which process() reads once per block. **/
+class Node {
+  public:
+	virtual ~Node() {}
+
+	//! Returns the maximum number of inputs which can be connected to this node. 0 for sources.
+	virtual size_t		getMaxInputs() const = 0;
+
+  protected:
+	Node();
+
+	//! Fills \a out from the \a numInputs blocks \a inputs, in the order they were connected. Called on the audio thread.
+	virtual void		process( const RenderContext &context, const NodeBlock * const *inputs, size_t numInputs, NodeBlock *out ) = 0;
+
+  private:
+	std::vector<float>	mStorage;
+	NodeBlock			mBlock;
+
+	friend class Graph;
+};
+
+/** \brief A pull-based graph of audio Nodes, rendered on the audio device's thread.
+	Connect sources through effects and mixers to the node passed to setOutput(), then play getSource() with Output::play(). Connections may be changed
+	while playing: each change builds a new render order on the app thread, which the audio thread picks up between blocks without locking.
+	The Graph must outlive playback of its source. **/
+class Graph {
+  public:
+	//! The maximum number of frames rendered per block. Device callbacks are split into blocks of at most this size.
+	enum { BLOCK_SIZE = 256 };
+
+	static GraphRef		create( uint32_t sampleRate = 44100 );
+	~Graph();
+
+	//! Appends \a source to the inputs of \a dest. Throws GraphExceptionTooManyInputs or GraphExceptionCycle if the connection is invalid.
+	void		connect( const NodeRef &source, const NodeRef &dest );
+	//! Removes \a source from the inputs of \a dest, shifting any later inputs down
+	void		disconnect( const NodeRef &source, const NodeRef &dest );
+	//! Removes all of the inputs of \a node
+	void		disconnectInputs( const NodeRef &node );
+	//! Sets the node whose output is sent to the device. Only nodes it depends on are rendered.
+	void		setOutput( const NodeRef &node );
+	const NodeRef&	getOutput() const { return mOutput; }
+
+	//! Returns the Source which renders this graph, for use with Output::play() or Output::addTrack()
+	SourceRef	getSource();
+	uint32_t	getSampleRate() const { return mSampleRate; }
+
+  private:
+	Graph( uint32_t sampleRate );
+
+	struct RenderOp {
+		Node		*mNode;
+		size_t		mFirstInput, mNumInputs;
+	};
+
+	struct RenderList {
+		std::vector<RenderOp>			mOps;
+		std::vector<const NodeBlock*>	mInputs;
+		std::vector<NodeRef>			mNodes; // keeps the nodes alive for as long as the audio thread might render them
+	};
+
+	typedef std::map<Node*,std::vector<NodeRef> >	InputMap;
+
+	void		render( uint64_t inSampleOffset, uint32_t inSampleCount, BufferT<float> *ioBuffer );
+	void		commit();
+	void		appendRenderOps( const NodeRef &node, RenderList *list, std::map<Node*,size_t> *opIndices ) const;
+	bool		dependsOn( Node *node, Node *dependency ) const;
+
+	uint32_t				mSampleRate;
+	InputMap				mInputs;
+	NodeRef					mOutput;
+	SourceRef				mSource;
+	TripleBuffer<RenderList>	mRenderLists;
+	uint64_t				mFrame;
+};
+
+/** \brief Source node which calls a function to generate each block.
+	The function receives the index of the block's first frame, its frame count, and the left and right channels to fill. It runs on the audio thread, so it must neither allocate nor lock. **/
+class CallbackNode : public Node {
+  public:
+	typedef std::function<void (uint64_t, uint32_t, float*, float*)>	RenderFn;
+
+	static std::shared_ptr<CallbackNode>	create( const RenderFn &renderFn ) { return std::shared_ptr<CallbackNode>( new CallbackNode( renderFn ) ); }
+
+	size_t		getMaxInputs() const { return 0; }
+
+  protected:
+	CallbackNode( const RenderFn &renderFn ) : mRenderFn( renderFn ) {}
+	void		process( const RenderContext &context, const NodeBlock * const *inputs, size_t numInputs, NodeBlock *out );
+
+	RenderFn	mRenderFn;
+};
+
+//! Source node which plays back PCM data held in memory. Mono data is played on both channels.
+class BufferPlayerNode : public Node {
+  public:
+	//! Creates a player for a copy of \a buffer, which is assumed to be at the graph's sample rate
+	static std::shared_ptr<BufferPlayerNode>	create( const PcmBuffer32fRef &buffer, bool looping = false ) { return std::shared_ptr<BufferPlayerNode>( new BufferPlayerNode( buffer, looping ) ); }
+
+	size_t		getMaxInputs() const { return 0; }
+
+	//! Starts playing from the beginning at the next block
+	void		start() { ++mStartCount; }
+	//! Stops playing at the next block
+	void		stop() { ++mStopCount; }
+	bool		isPlaying() const { return mIsPlaying; }
+	void		setLooping( bool looping ) { mIsLooping = looping; }
+	bool		isLooping() const { return mIsLooping; }
+	uint32_t	getNumFrames() const { return mNumFrames; }
+
+  protected:
+	BufferPlayerNode( const PcmBuffer32fRef &buffer, bool looping );
+	void		process( const RenderContext &context, const NodeBlock * const *inputs, size_t numInputs, NodeBlock *out );
+
+	std::vector<float>	mChannels[2];
+	uint32_t			mNumFrames, mPosition;
+	uint32_t			mStartsSeen, mStopsSeen;
+	volatile uint32_t	mStartCount, mStopCount;
+	volatile bool		mIsPlaying, mIsLooping;
+};
+
+//! Scales its input by a gain, ramping across a block whenever the gain changes to avoid clicks
+class GainNode : public Node {
+  public:
+	static std::shared_ptr<GainNode>	create( float gain = 1.0f ) { return std::shared_ptr<GainNode>( new GainNode( gain ) ); }
+
+	size_t		getMaxInputs() const { return 1; }
+
+	void		setGain( float gain ) { mGain = gain; }
+	float		getGain() const { return mGain; }
+
+  protected:
+	GainNode( float gain ) : mGain( gain ), mCurrentGain( gain ) {}
+	void		process( const RenderContext &context, const NodeBlock * const *inputs, size_t numInputs, NodeBlock *out );
+
+	volatile float	mGain;
+	float			mCurrentGain;
+};
+
+/** \brief Sums any number of inputs, up to the count given on creation, with a gain and an equal-power pan per input.
+	Inputs are addressed by their index in connection order. Inputs whose gain is 0 are skipped, so idle voices cost nothing. **/
+class MixerNode : public Node {
+  public:
+	static std::shared_ptr<MixerNode>	create( size_t maxInputs = 32 ) { return std::shared_ptr<MixerNode>( new MixerNode( maxInputs ) ); }
+
+	size_t		getMaxInputs() const { return mMaxInputs; }
+
+	//! Sets the gain of input \a index
+	void		setInputGain( size_t index, float gain );
+	float		getInputGain( size_t index ) const;
+	//! Sets the pan of input \a index from -1 (left) through 0 (center) to 1 (right)
+	void		setInputPan( size_t index, float pan );
+	float		getInputPan( size_t index ) const;
+
+  protected:
+	MixerNode( size_t maxInputs );
+	void		process( const RenderContext &context, const NodeBlock * const *inputs, size_t numInputs, NodeBlock *out );
+
+	struct Strip {
+		volatile float	mGain, mPan;
+		float			mCurrentLeft, mCurrentRight;
+	};
+
+	size_t				mMaxInputs;
+	std::vector<Strip>	mStrips;
+	bool				mUseSse2;
+};
+
+//! Second-order IIR filter, using the coefficients of Robert Bristow-Johnson's Audio EQ Cookbook
+class BiquadFilterNode : public Node {
+  public:
+	enum Type { LOWPASS, HIGHPASS, BANDPASS, NOTCH };
+
+	static std::shared_ptr<BiquadFilterNode>	create( Type type, float frequency, float q = 0.7071f ) { return std::shared_ptr<BiquadFilterNode>( new BiquadFilterNode( type, frequency, q ) ); }
+
+	size_t		getMaxInputs() const { return 1; }
+
+	//! Sets the type, cutoff or center \a frequency in Hz and \a q of the filter. The audio thread picks them up together at its next block.
+	void		set( Type type, float frequency, float q );
+	void		setFrequency( float frequency ) { set( mType, frequency, mQ ); }
+	void		setQ( float q ) { set( mType, mFrequency, q ); }
+	Type		getType() const { return mType; }
+	float		getFrequency() const { return mFrequency; }
+	float		getQ() const { return mQ; }
+
+  protected:
+	BiquadFilterNode( Type type, float frequency, float q );
+	void		process( const RenderContext &context, const NodeBlock * const *inputs, size_t numInputs, NodeBlock *out );
+	void		updateCoefficients( uint32_t sampleRate );
+
+	struct Params {
+		Type	mType;
+		float	mFrequency, mQ;
+	};
+
+	Type					mType;
+	float					mFrequency, mQ;
+	TripleBuffer<Params>	mParams;
+	uint32_t				mCoefficientsSampleRate;
+	float					mB0, mB1, mB2, mA1, mA2;
+	float					mState[2][2];
+};
+
+/** \brief Passes its input through unchanged while capturing the most recent samples, mixed to mono, for the app to read.
+	The audio thread publishes the window after every block without locking. The app calls update() once per frame and then reads getWaveform() and getMagnitudes(). **/
+class AnalyzerNode : public Node {
+  public:
+	//! Creates an analyzer of the last \a windowSize samples, which should be a power of 2. The magnitude spectrum has \a windowSize / 2 bands.
+	static std::shared_ptr<AnalyzerNode>	create( uint32_t windowSize = 1024, FftWindow fftWindow = FFT_WINDOW_HANN ) { return std::shared_ptr<AnalyzerNode>( new AnalyzerNode( windowSize, fftWindow ) ); }
+
+	size_t		getMaxInputs() const { return 1; }
+
+	//! Picks up the latest window published by the audio thread. Returns whether there was a new one. App thread only.
+	bool							update();
+	//! Returns the samples of the window picked up by update(), oldest first
+	const std::vector<float>&		getWaveform() const { return mWindows.front(); }
+	//! Returns the magnitude spectrum of getWaveform(), computed on the first call after each update()
+	const std::vector<float>&		getMagnitudes();
+	uint32_t						getWindowSize() const { return mWindowSize; }
+
+  protected:
+	AnalyzerNode( uint32_t windowSize, FftWindow fftWindow );
+	void		process( const RenderContext &context, const NodeBlock * const *inputs, size_t numInputs, NodeBlock *out );
+
+	uint32_t						mWindowSize, mWritePosition;
+	std::vector<float>				mHistory;
+	TripleBuffer<std::vector<float> >	mWindows;
+	FftProcessorRef					mFft;
+	std::vector<float>				mMagnitudes;
+	bool							mMagnitudesValid;
+};
+
+class GraphException : public Exception {
+};
+
+class GraphExceptionTooManyInputs : public GraphException {
+};
+
+class GraphExceptionCycle : public GraphException {
+};
+
+}} //namespace
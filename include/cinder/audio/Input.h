@@ -58,8 +58,20 @@ class InputImpl {
 	
 	virtual uint32_t getSampleRate() const = 0;
 	virtual uint16_t getChannelCount() const = 0;
+	virtual uint32_t getFramesPerBuffer() const = 0;
+	
+	void		enableCapture( float seconds );
+	uint64_t	getCapturePosition() const;
+	uint32_t	readCapture( uint64_t *ioFrame, PcmBuffer32f *buffer, uint32_t *outDroppedFrames );
  protected:
-	InputImpl( InputDeviceRef aDevice ) {}
+	InputImpl( InputDeviceRef aDevice, uint32_t framesPerBuffer ) : mRequestedFramesPerBuffer( framesPerBuffer ), mCaptureSeconds( 0 ) {}
+	
+	// creates the capture ring requested by enableCapture(), once the format is known. Call before the input callback starts.
+	void		prepareCapture();
+	
+	uint32_t							mRequestedFramesPerBuffer;
+	float								mCaptureSeconds;
+	std::shared_ptr<PcmCaptureRing>		mCaptureRing;
 };
 //! \endcond
 
@@ -68,6 +80,8 @@ class Input {
  
 	Input();
 	Input( InputDeviceRef aDevice );
+	//! Captures from \a aDevice, or the default device if it's NULL, asking the device for blocks of \a framesPerBuffer frames
+	Input( InputDeviceRef aDevice, uint32_t framesPerBuffer );
 	~Input() {}
 	
 	//! Starts capturing audio data from the input
@@ -82,6 +96,18 @@ class Input {
 	uint32_t getSampleRate() { return mImpl->getSampleRate(); };
 	//! Returns the number of channels of the captured audio data
 	uint16_t getChannelCount() { return mImpl->getChannelCount(); };
+	//! Returns the number of frames the device delivers per callback
+	uint32_t getFramesPerBuffer() const { return mImpl->getFramesPerBuffer(); }
+	
+	//! Keeps at least the last \a seconds of input in a ring, so that readCapture() can return every captured frame. Must be called while not capturing.
+	void		enableCapture( float seconds = 2.0f ) { mImpl->enableCapture( seconds ); }
+	//! Returns the index one past the newest captured frame, counted from the first frame captured after enableCapture()
+	uint64_t	getCapturePosition() const { return mImpl->getCapturePosition(); }
+	/** Copies the captured frames from \a *ioFrame on into \a buffer, which must be non-interleaved, and advances \a *ioFrame past them, so that repeated calls return the input without gaps.
+		Frames that already fell out of the ring are skipped and counted in \a outDroppedFrames if it's non-NULL. Returns the number of frames copied, which is limited by the buffer's max sample count. **/
+	uint32_t	readCapture( uint64_t *ioFrame, PcmBuffer32f *buffer, uint32_t *outDroppedFrames = 0 ) { return mImpl->readCapture( ioFrame, buffer, outDroppedFrames ); }
+	//! Returns the time of the captured frame \a frame in seconds, relative to the first frame captured
+	double		getCaptureTime( uint64_t frame ) { return frame / (double)getSampleRate(); }
 	
 	//! Returns a vector of all Devices connected to the system. If \a forceRefresh then the system will be polled for connected devices.
 	static const std::vector<InputDeviceRef>&	getDevices( bool forceRefresh = false );
@@ -104,5 +130,6 @@ class Input {
 
 class InputExc : public Exception {};
 class InvalidDeviceInputExc : public InputExc {};
+class CaptureInputExc : public InputExc {};
 
 }} //namespace
\ No newline at end of file
@@ -38,8 +38,6 @@ namespace cinder { namespace audio {
 
 /*
 TODO: 
-add support for specifying buffer size
-
 add support for specifying number of output channels
 */
 
@@ -48,7 +46,7 @@ class InputImplAudioUnit : public InputImpl {
 	class Device;
 	
  
-	InputImplAudioUnit( InputDeviceRef aDevice );
+	InputImplAudioUnit( InputDeviceRef aDevice, uint32_t framesPerBuffer );
 	~InputImplAudioUnit();
 	
 	void start();
@@ -58,6 +56,7 @@ class InputImplAudioUnit : public InputImpl {
 	
 	uint32_t getSampleRate() const { return mSampleRate; };
 	uint16_t getChannelCount() const { return mChannelCount; };
+	uint32_t getFramesPerBuffer() const { return mFramesPerBuffer; }
 	
 	static const std::vector<InputDeviceRef>&	getDevices( bool forceRefresh );
 	static InputDeviceRef getDefaultDevice();
@@ -105,13 +104,17 @@ class InputImplAudioUnit : public InputImpl {
 	AudioBufferList					* mInputBuffer;
 	float							* mInputBufferData;
 	
+	// the recent input of each channel, written and read by the input callback only
 	std::vector<CircularBuffer<float> *>	mCircularBuffers;
-	
-	boost::mutex					mBufferMutex;
+	// the contents of mCircularBuffers after each callback, for getPcmBuffer()
+	std::shared_ptr<PcmBufferHandoff>		mPcmBuffers;
+	// each channel's data in mInputBuffer, for writing to mCaptureRing
+	std::vector<const float *>				mCaptureChannels;
 	
 	AudioStreamBasicDescription		mFormatDescription;
 	uint32_t mSampleRate;
 	uint16_t mChannelCount;
+	uint32_t mFramesPerBuffer;
 	
 	static bool								sDevicesEnumerated;
 	static std::vector<InputDeviceRef>		sDevices;
@@ -155,6 +155,9 @@ struct IoRegistrar {
 	
 	static void		registerSourceType( std::string extension, SourceCreationFunc func, int32_t priority = 2 );
 	static void		registerSourceGeneric( SourceCreationFunc func, int32_t priority = 2 );
+
+	//! Queues \a registerFn, which registers a source, to run on the registrar's first use rather than during static initialization. Used by REGISTER_AUDIOIO().
+	static void		deferRegistration( void (*registerFn)() );
 	
   private:
 	
@@ -186,7 +189,7 @@ struct IoRegistrant {
   private:
 	struct exec_register {
 		exec_register() {
-			T::registerSelf();
+			IoRegistrar::deferRegistration( &T::registerSelf );
 		}
 	};
 	
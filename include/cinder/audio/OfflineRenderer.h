@@ -0,0 +1,114 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/DataTarget.h"
+#include "cinder/Exception.h"
+#include "cinder/Function.h"
+#include "cinder/JobSystem.h"
+#include "cinder/audio/Io.h"
+#include "cinder/audio/FftProcessor.h"
+
+#include <vector>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class OfflineRenderer>	OfflineRendererRef;
+
+/** \brief Renders Sources, such as Callbacks, Graph::getSource() and SampleBank::getSource(), as fast as the CPU allows rather than at the pace of an audio device.
+	Each track is decoded, converted to the renderer's format and mixed as Output would, and the mix is handed block by block to a BlockFn, to FftProcessor
+	analyzers and to a WAV file written by renderWav(). Tracks are rendered concurrently on a JobSystem while the previous block is consumed on the calling
+	thread, so the tracks must be independent: two tracks may not share a Source, and no Source may be playing through Output at the same time. **/
+class OfflineRenderer {
+  public:
+	//! Receives \a frameCount interleaved frames of the mix, in the renderer's format
+	typedef std::function<void (const float *, uint32_t)>	BlockFn;
+	//! Receives the index of the first frame of an analysis window, and the FftProcessor's getBandCount() magnitudes of it
+	typedef std::function<void (uint64_t, const float *)>	SpectrumFn;
+
+	//! Creates a renderer which mixes to interleaved floats at \a sampleRate with \a channelCount channels
+	static OfflineRendererRef	create( uint32_t sampleRate = 44100, uint16_t channelCount = 2 ) { return OfflineRendererRef( new OfflineRenderer( sampleRate, channelCount ) ); }
+
+	/** Adds \a source as a track mixed in at \a volume, and returns the index of the track. The source is resampled and its channels mixed to the renderer's format.
+		Throws IoExceptionUnsupportedDataType if the source's format can't be decoded. **/
+	size_t		addTrack( SourceRef source, float volume = 1.0f );
+	size_t		getNumTracks() const { return mTracks.size(); }
+	void		setTrackVolume( size_t track, float volume );
+	float		getTrackVolume( size_t track ) const;
+
+	//! Sets the function which receives each block of the mix, on the thread calling render()
+	void		setBlockFn( const BlockFn &blockFn ) { mBlockFn = blockFn; }
+	/** Analyzes the mix, averaged to mono, in windows of \a fft's getBandCount() * 2 samples starting every \a hopSize samples, or every half window if it's 0.
+		\a spectrumFn receives the magnitudes of each window on the thread calling render(). **/
+	void		addAnalyzer( const FftProcessorRef &fft, const SpectrumFn &spectrumFn, size_t hopSize = 0 );
+
+	//! Sets the JobSystem which renders the tracks. Defaults to JobSystem::getDefault(), and a NULL JobSystemRef renders them on the calling thread.
+	void				setJobSystem( const JobSystemRef &jobSystem ) { mJobSystem = jobSystem; }
+	const JobSystemRef&	getJobSystem() const { return mJobSystem; }
+
+	/** Renders the next \a seconds of the mix, or, if \a seconds is 0, up to the end of the longest track as reported by Source::getDuration().
+		Tracks which end are mixed as silence. Returns the number of frames rendered. **/
+	uint64_t	render( double seconds = 0 );
+	/** Renders like render() while writing the mix to \a target as a WAV file of 16-bit integer samples, or of 32-bit float samples if \a floatSamples.
+		The length is known before rendering starts, so \a target's stream is only written sequentially. Throws OfflineRendererExceptionWavTooLong if the data would exceed 4GB. **/
+	uint64_t	renderWav( DataTargetRef target, double seconds = 0, bool floatSamples = false );
+
+	//! Returns the index of the next frame to be rendered, which is the number of frames rendered so far
+	uint64_t	getFrame() const { return mFrame; }
+	uint32_t	getSampleRate() const { return mSampleRate; }
+	uint16_t	getChannelCount() const { return mChannelCount; }
+
+  private:
+	OfflineRenderer( uint32_t sampleRate, uint16_t channelCount );
+
+	class Track;
+	struct Analyzer;
+
+	//! Returns the number of frames render() produces for \a seconds
+	uint64_t	getNumFrames( double seconds ) const;
+	//! Renders \a frameCount frames, passing each block to \a writeFn as well as the BlockFn and analyzers
+	uint64_t	render( uint64_t frameCount, const BlockFn &writeFn );
+	//! Hands the first \a frameCount frames of mMix to \a writeFn, the BlockFn and the analyzers
+	void		consume( uint32_t frameCount, const BlockFn &writeFn );
+
+	uint32_t								mSampleRate;
+	uint16_t								mChannelCount;
+	std::vector<std::shared_ptr<Track> >	mTracks;
+	std::vector<std::shared_ptr<Analyzer> >	mAnalyzers;
+	BlockFn									mBlockFn;
+	JobSystemRef							mJobSystem;
+	uint64_t								mFrame;
+	std::vector<float>						mMix, mMono;
+};
+
+class OfflineRendererException : public Exception {
+};
+
+class OfflineRendererExceptionWavTooLong : public OfflineRendererException {
+};
+
+}} //namespace
@@ -79,6 +79,9 @@ class OutputImpl {
 	
 	virtual float getVolume() const = 0;
 	virtual void setVolume( float aVolume ) = 0;
+
+	//! Returns the output latency in seconds as reported by the device, or 0 if the backend can't tell
+	virtual double getLatency() const { return 0; }
 	
 	//virtual TargetRef getTarget() = 0;
   protected:
@@ -103,6 +106,14 @@ class OutputImpl {
 
 class Output {
   public:
+	//! Output backends which can be chosen with setBackend()
+	enum Backend { BACKEND_DEFAULT, BACKEND_WASAPI_SHARED, BACKEND_WASAPI_EXCLUSIVE };
+
+	/** Chooses the backend used for output, and for the WASAPI backends the number of frames rendered per device period. Must be called before anything
+		else uses Output. The WASAPI backends mix all tracks directly in the device's event callback, and are only available on Windows Vista and later;
+		elsewhere this is ignored. BACKEND_WASAPI_EXCLUSIVE falls back to shared mode if the device doesn't allow exclusive access. **/
+	static void setBackend( Backend backend, uint32_t bufferFrames = 256 );
+
 	static void play( SourceRef aSource ) { instance()->play( aSource ); }
 	
 	static TrackRef addTrack( SourceRef aSource, bool autoplay = true ) { return instance()->addTrack( aSource, autoplay ); }
@@ -110,6 +121,9 @@ class Output {
 	
 	static float getVolume() { return instance()->getVolume(); }
 	static void setVolume( float aVolume ) { instance()->setVolume( aVolume ); }
+
+	//! Returns the output latency in seconds as reported by the device, or 0 if the backend can't tell
+	static double getLatency() { return instance()->getLatency(); }
 	
 	//static TargetRef getTarget() { return instance()->getTarget(); }
   private:
@@ -119,9 +119,7 @@ class OutputImplAudioUnit : public OutputImpl {
 		bool			mIsLooping;
 		bool			mIsPcmBuffering;
 		
-		PcmBuffer32fRef	mLoadingPcmBuffer;
-		PcmBuffer32fRef	mLoadedPcmBuffer;
-		boost::mutex	mPcmBufferMutex;
+		std::shared_ptr<PcmBufferHandoff>	mPcmBuffers;
 	};
 	
 	std::map<TrackId,std::shared_ptr<OutputImplAudioUnit::Track> >	mTracks;
@@ -0,0 +1,155 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/audio/Output.h"
+#include "cinder/audio/Resampler.h"
+#include "cinder/msw/CinderMsw.h"
+#include "cinder/CinderMath.h"
+#include "cinder/Thread.h"
+#include "cinder/TripleBuffer.h"
+
+#include <windows.h>
+#undef min
+#undef max
+#include <mmdeviceapi.h>
+#include <audioclient.h>
+#include <map>
+#include <vector>
+
+namespace cinder { namespace audio {
+
+class TargetOutputImplWasapi : public Target {
+  public:
+	static std::shared_ptr<TargetOutputImplWasapi> createRef( const WAVEFORMATEX *aOutDescription, bool isFloat ) { return std::shared_ptr<TargetOutputImplWasapi>( new TargetOutputImplWasapi( aOutDescription, isFloat ) ); }
+	~TargetOutputImplWasapi() {}
+  private:
+	TargetOutputImplWasapi( const WAVEFORMATEX *aOutDescription, bool isFloat );
+};
+
+/** \brief Output backend which renders directly from the event-driven callback of a WASAPI stream, in shared or exclusive mode.
+	Tracks are converted to float, remixed to the device's channel count, resampled to its rate and mixed on the render thread, which never waits on the app.
+	As their loaders run on that thread too, long files are best played through a SourceStream. **/
+class OutputImplWasapi : public OutputImpl {
+  public:
+	OutputImplWasapi( bool exclusive, uint32_t bufferFrames );
+	~OutputImplWasapi();
+
+	TrackRef	addTrack( SourceRef aSource, bool autoplay );
+	void		removeTrack( TrackId trackId );
+
+	void		setVolume( float aVolume ) { mVolume = aVolume; }
+	float		getVolume() const { return mVolume; }
+
+	//! Returns the stream latency reported by the device plus the duration of one buffer, in seconds
+	double		getLatency() const { return mLatency; }
+	//! Returns whether the stream was opened in exclusive mode
+	bool		isExclusive() const { return mIsExclusive; }
+	//! Returns the number of frames in the device buffer
+	uint32_t	getBufferFrames() const { return mBufferFrames; }
+	uint32_t	getSampleRate() const { return mFormat.Format.nSamplesPerSec; }
+	uint16_t	getChannelCount() const { return mFormat.Format.nChannels; }
+
+  protected:
+	class Track : public cinder::audio::Track {
+	  public:
+		Track( SourceRef source, OutputImplWasapi *output );
+		~Track() {}
+
+		void play() { mIsPlaying = true; }
+		void stop() { mIsPlaying = false; }
+		bool isPlaying() const { return mIsPlaying; }
+
+		TrackId	getTrackId() const { return mTrackId; }
+
+		void setVolume( float aVolume ) { mVolume = math<float>::clamp( aVolume, 0, 1 ); }
+		float getVolume() const { return mVolume; }
+
+		double getTime() const { return mLoader->getSampleOffset() / (double)mInputRate; }
+		void setTime( double aTime ) { mLoader->setSampleOffset( static_cast<uint64_t>( aTime * mInputRate ) ); }
+
+		void setLooping( bool isLooping ) { mIsLooping = isLooping; }
+		bool isLooping() const { return mIsLooping; }
+
+		void enablePcmBuffering( bool isBuffering ) { mIsPcmBuffering = isBuffering; }
+		bool isPcmBuffering() { return mIsPcmBuffering; }
+		PcmBuffer32fRef getPcmBuffer() { return mPcmBuffers->getLatest(); }
+
+		//! Adds \a frameCount frames of this track to \a mix. Render thread only.
+		void render( float *mix, uint32_t frameCount );
+
+	  private:
+		//! Loads up to \a frameCount frames, converted to float at the output's channel count, into mInputBuffer. Returns the number loaded.
+		uint32_t loadInput( uint32_t frameCount );
+
+		OutputImplWasapi		*mOutput;
+		TrackId					mTrackId;
+		SourceRef				mSource;
+		std::shared_ptr<TargetOutputImplWasapi>	mTarget;
+		LoaderRef				mLoader;
+		ResamplerRef			mResampler;
+
+		uint32_t				mInputRate;
+		uint16_t				mInputChannels, mOutputChannels;
+		uint32_t				mInputBlockAlign, mMaxInputFrames;
+		Io::DataType			mInputDataType;
+
+		std::vector<uint8_t>	mLoadBuffer;
+		std::vector<float>		mConvertBuffer, mInputBuffer, mOutputBuffer;
+
+		volatile bool			mIsPlaying, mIsLooping;
+		volatile float			mVolume;
+
+		volatile bool			mIsPcmBuffering;
+		std::shared_ptr<PcmBufferHandoff>	mPcmBuffers;
+	};
+
+	typedef std::vector<std::shared_ptr<Track> >	TrackList;
+
+	void		openStream( bool exclusive, uint32_t bufferFrames );
+	bool		findExclusiveFormat( const WAVEFORMATEX *mixFormat );
+	void		commitTracks();
+	void		renderThreadFn();
+
+	std::shared_ptr<IMMDevice>			mDevice;
+	std::shared_ptr<IAudioClient>		mClient;
+	std::shared_ptr<IAudioRenderClient>	mRenderClient;
+	HANDLE								mEvent;
+	WAVEFORMATEXTENSIBLE				mFormat;
+	bool								mIsExclusive, mIsFloat;
+	uint32_t							mBufferFrames;
+	double								mLatency;
+	volatile float						mVolume;
+
+	std::vector<float>					mMixBuffer;
+	std::map<TrackId,std::shared_ptr<Track> >	mTracks;
+	TripleBuffer<TrackList>				mRenderTracks; // the tracks the render thread mixes, handed over without locking
+
+	volatile bool						mIsRunning;
+	std::shared_ptr<std::thread>		mRenderThread;
+};
+
+}} //namespace
@@ -112,9 +112,8 @@ class OutputImplXAudio : public OutputImpl
 		std::shared_ptr<boost::thread>		mQueueThread;
 
 		bool mIsPcmBuffering;
-		PcmBuffer32fRef	mLoadingPcmBuffer;
-		PcmBuffer32fRef	mLoadedPcmBuffer;
-		boost::mutex	mPcmBufferMutex;
+		std::shared_ptr<PcmBufferHandoff>	mPcmBuffers;
+		std::vector<float>					mPcmConversionBuffer; // the voice's 16-bit samples converted to float, for mPcmBuffers
 
 		class SourceCallback : public IXAudio2VoiceCallback
 		{
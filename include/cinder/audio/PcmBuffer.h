@@ -24,6 +24,8 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Exception.h"
+#include "cinder/MemoryTracker.h"
+#include "cinder/TripleBuffer.h"
 #include <vector>
 #include <boost/preprocessor/seq.hpp>
 
@@ -82,7 +84,14 @@ class PcmBufferT {
 	//TODO: add support for an appendData method that just accepts a Buffer or BufferList and interprets interleaving accordingly
 	void		appendInterleavedData( T * aData, uint32_t aSampleCount );
 	void		appendChannelData( T * aData, uint32_t aSampleCount, ChannelIdentifier channelId );
+	//! Empties the buffer without releasing its storage
+	void		clear();
+	//! Replaces the contents with those of \a source, which must have the same max sample count, channel count and interleaving
+	void		copyFrom( const PcmBufferT<T> &source );
  private:
+	PcmBufferT( const PcmBufferT<T> & ); // not copyable, as the sample counts are owned by pointer
+	PcmBufferT<T>& operator=( const PcmBufferT<T> & );
+
 	std::vector<std::shared_ptr<BufferT<T> > > mBuffers;
 	
 	uint16_t		mBufferCount;
@@ -90,12 +99,65 @@ class PcmBufferT {
 	uint32_t		mMaxSampleCount;
 	uint16_t		mChannelCount;
 	bool			mIsInterleaved;
+	TrackedMemory	mTrackedMemory;
 };
 
 typedef PcmBufferT<float> PcmBuffer32f;
 
 typedef std::shared_ptr<PcmBuffer32f> PcmBuffer32fRef;
 
+/** \brief Hands completed blocks of PCM data from an audio callback to the app without locks, so that the audio thread never waits on the app.
+	The audio thread appends to getLoadingBuffer() and calls publish() once it's full, which neither blocks nor allocates. The app calls getLatest(). **/
+class PcmBufferHandoff {
+ public:
+	PcmBufferHandoff( uint32_t aMaxSampleCount, uint16_t aChannelCount, bool isInterleaved );
+
+	//! Returns the buffer the audio thread is filling. Audio thread only.
+	PcmBuffer32f&	getLoadingBuffer() { return *mBuffers.back(); }
+	//! Makes the loading buffer the latest block and starts filling an empty one. Audio thread only.
+	void			publish();
+	//! Returns a copy of the latest published block, or NULL before the first. A new copy is only made when a block was published since the last call. App thread only.
+	PcmBuffer32fRef	getLatest();
+ private:
+	TripleBuffer<PcmBuffer32fRef>	mBuffers;
+	PcmBuffer32fRef					mLatest;
+};
+
+/** \brief Keeps every frame recently written by an audio callback, so that the app can read all of them rather than only the latest block.
+	The audio thread calls write(), which neither blocks nor allocates, overwriting the oldest frames once the ring is full. Frames are addressed by their index since
+	the ring was created, which doubles as a sample-accurate timestamp; the app remembers the index it read up to and passes it to read() to continue without gaps. **/
+class PcmCaptureRing {
+ public:
+	//! Holds at least \a aFrameCapacity frames of \a aChannelCount channels. The capacity is rounded up to a power of two.
+	PcmCaptureRing( uint32_t aFrameCapacity, uint16_t aChannelCount );
+
+	uint32_t	getFrameCapacity() const { return mCapacity; }
+	uint16_t	getChannelCount() const { return mChannelCount; }
+
+	//! Appends \a frameCount frames of non-interleaved data, one pointer per channel. Audio thread only.
+	void		write( const float * const *channels, uint32_t frameCount );
+	//! Returns the index one past the newest frame written so far
+	uint64_t	getWritePosition() const;
+	/** Copies the frames from \a *ioFrame up to the newest frame into \a buffer, which must be non-interleaved, as far as it has room, and advances \a *ioFrame past them.
+		Frames that were already overwritten are skipped, and their number is stored in \a outDroppedFrames if it's non-NULL. Returns the number of frames copied. **/
+	uint32_t	read( uint64_t *ioFrame, PcmBuffer32f *buffer, uint32_t *outDroppedFrames = 0 ) const;
+ private:
+	// reads the write position and the size of the write in progress consistently
+	void		readPosition( uint64_t *position, uint32_t *pending ) const;
+	void		beginPositionUpdate();
+	void		endPositionUpdate();
+
+	std::vector<float>	mData; // each channel's frames in turn
+	uint32_t			mCapacity, mMask;
+	uint16_t			mChannelCount;
+
+	// the write position is 64-bit, so it's published under a sequence lock, which is odd while the writer updates it
+	volatile uint32_t	mSequence;
+	volatile uint32_t	mPositionLow, mPositionHigh;
+	// frames the writer is copying over the oldest ones, which are no longer safe to read
+	volatile uint32_t	mPending;
+};
+
 class PcmBufferException : public Exception {
 };
 
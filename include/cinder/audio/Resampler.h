@@ -0,0 +1,74 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+
+#include <vector>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class Resampler>	ResamplerRef;
+
+/** \brief Streaming polyphase sample rate converter for interleaved float audio.
+	The rate ratio is reduced to a fraction L / M, and each output sample is a single dot product with one of the L phases of a windowed-sinc lowpass,
+	so conversion costs getTapsPerPhase() multiply-adds per output sample and channel. Ratios whose reduced L exceeds 2048 are approximated to that denominator. **/
+class Resampler {
+  public:
+	//! Creates a converter from \a inputRate to \a outputRate for \a channelCount interleaved channels. More \a tapsPerPhase, rounded up to a multiple of 4, give a sharper filter.
+	static ResamplerRef		create( uint32_t inputRate, uint32_t outputRate, uint16_t channelCount, uint32_t tapsPerPhase = 32 ) { return ResamplerRef( new Resampler( inputRate, outputRate, channelCount, tapsPerPhase ) ); }
+
+	/** Consumes \a inputFrameCount frames from \a input and writes up to \a maxOutputFrames frames to \a output, returning the number written.
+		Input which doesn't produce output yet is kept for the next call, so any block sizes can be used. **/
+	size_t		process( const float *input, size_t inputFrameCount, float *output, size_t maxOutputFrames );
+	//! Returns an upper bound on the number of frames process() writes for \a inputFrameCount frames of input
+	size_t		getMaxOutputFrames( size_t inputFrameCount ) const;
+	//! Discards buffered input, as after a seek
+	void		reset();
+
+	uint32_t	getInputRate() const { return mInputRate; }
+	uint32_t	getOutputRate() const { return mOutputRate; }
+	uint16_t	getChannelCount() const { return mChannelCount; }
+	uint32_t	getTapsPerPhase() const { return mTaps; }
+	//! Returns the delay the filter adds, in input frames
+	uint32_t	getLatency() const { return mTaps / 2; }
+
+  private:
+	Resampler( uint32_t inputRate, uint32_t outputRate, uint16_t channelCount, uint32_t tapsPerPhase );
+
+	uint32_t	mInputRate, mOutputRate, mTaps;
+	uint16_t	mChannelCount;
+	uint32_t	mUpFactor, mDownFactor; // L and M
+	bool		mUseSse2;
+
+	std::vector<float>					mCoefficients; // mUpFactor phases of mTaps each, reversed so they line up with ascending input
+	std::vector<std::vector<float> >	mInput; // planar input, starting with the history the next output needs
+	size_t		mInputFrames;
+	size_t		mPosition; // index in mInput of the newest frame under the filter for the next output
+	uint32_t	mPhase;
+};
+
+}} //namespace
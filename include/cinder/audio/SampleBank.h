@@ -0,0 +1,140 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Exception.h"
+#include "cinder/LockFreeCircularBuffer.h"
+#include "cinder/audio/Io.h"
+#include "cinder/audio/PcmBuffer.h"
+
+#include <vector>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class Sample>		SampleRef;
+typedef std::shared_ptr<class SampleBank>	SampleBankRef;
+
+//! Audio decoded into memory as interleaved floats, so that it can be played any number of times without a Loader
+class Sample {
+  public:
+	/** Decodes all of \a source, converting it to \a sampleRate and \a channelCount. Sources without an end, such as Callbacks, are cut off after \a maxSeconds.
+		Throws IoExceptionUnsupportedDataType if the source's format can't be decoded. **/
+	static SampleRef	create( SourceRef source, uint32_t sampleRate, uint16_t channelCount, double maxSeconds = 60.0 );
+
+	uint32_t		getSampleRate() const { return mSampleRate; }
+	uint16_t		getChannelCount() const { return mChannelCount; }
+	uint32_t		getNumFrames() const { return mNumFrames; }
+	double			getDuration() const { return mNumFrames / (double)mSampleRate; }
+	//! Returns the getNumFrames() interleaved frames
+	const float*	getData() const { return mData.empty() ? 0 : &mData[0]; }
+
+  private:
+	Sample( SourceRef source, uint32_t sampleRate, uint16_t channelCount, double maxSeconds );
+
+	uint32_t			mSampleRate, mNumFrames;
+	uint16_t			mChannelCount;
+	std::vector<float>	mData;
+};
+
+//! Identifies a voice started by SampleBank::play(). 0 is never a valid voice.
+typedef uint32_t	VoiceId;
+
+/** \brief Plays one-shot sounds, such as UI clicks, from Samples decoded once at load time, mixing up to a fixed number of voices in a single output track.
+	Play getSource() with Output::play() once, then start voices with play(), which only hands a command to the audio thread, so it neither blocks, decodes nor allocates.
+	When every voice is busy the oldest one is stolen instead of failing. The SampleBank must outlive playback of its source. **/
+class SampleBank {
+  public:
+	static SampleBankRef	create( uint32_t sampleRate = 44100, uint16_t channelCount = 2, size_t maxVoices = 32 );
+
+	//! Decodes \a source into the bank's format, and keeps the result alive for as long as the bank
+	SampleRef	load( SourceRef source, double maxSeconds = 60.0 );
+
+	/** Starts playing \a sample at \a volume, panned by \a pan from -1 (left) to 1 (right) if the bank is stereo. The sample is kept alive for as long as the bank.
+		Returns the voice's id, or 0 if too many commands are waiting for the audio thread. Throws SampleBankExceptionFormat if \a sample isn't in the bank's format. **/
+	VoiceId		play( const SampleRef &sample, float volume = 1.0f, float pan = 0.0f );
+	//! Stops \a voice, if it's still playing
+	void		stop( VoiceId voice );
+	//! Stops every voice
+	void		stopAll();
+
+	//! Returns the number of voices which were playing as of the last block rendered
+	size_t		getNumActiveVoices() const { return detail::lockFreeLoadAcquire( &mNumActiveVoices ); }
+	size_t		getMaxVoices() const { return mVoices.size(); }
+	//! Returns the number of voices stolen so far to make room for new ones
+	uint32_t	getNumStolenVoices() const { return detail::lockFreeLoadAcquire( &mNumStolenVoices ); }
+
+	//! Returns the Source which renders the voices, for use with Output::play() or Output::addTrack()
+	SourceRef	getSource() { return mSource; }
+	uint32_t	getSampleRate() const { return mSampleRate; }
+	uint16_t	getChannelCount() const { return mChannelCount; }
+
+  private:
+	SampleBank( uint32_t sampleRate, uint16_t channelCount, size_t maxVoices );
+
+	struct Command {
+		enum Type { PLAY, STOP, STOP_ALL };
+		Type			mType;
+		VoiceId			mVoice;
+		const Sample	*mSample;
+		float			mGains[2];
+	};
+
+	struct Voice {
+		VoiceId			mId;
+		const Sample	*mSample;
+		uint32_t		mPosition;
+		float			mGains[2];
+	};
+
+	void		render( uint64_t inSampleOffset, uint32_t inSampleCount, BufferT<float> *ioBuffer );
+	void		handleCommands();
+	void		renderVoices( float *mix, uint32_t frameCount );
+
+	uint32_t					mSampleRate;
+	uint16_t					mChannelCount;
+	SourceRef					mSource;
+
+	// app thread only
+	std::vector<SampleRef>		mSamples;
+	VoiceId						mNextVoiceId;
+
+	SpscCircularBuffer<Command>	mCommands;
+	// audio thread only. The first mNumVoices are playing, in the order they were started, so that the first one is the oldest.
+	std::vector<Voice>			mVoices;
+	size_t						mNumVoices;
+	std::vector<float>			mMixBuffer;
+
+	volatile uint32_t			mNumActiveVoices, mNumStolenVoices;
+};
+
+class SampleBankException : public Exception {
+};
+
+class SampleBankExceptionFormat : public SampleBankException {
+};
+
+}} //namespace
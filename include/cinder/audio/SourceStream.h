@@ -0,0 +1,105 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Thread.h"
+#include "cinder/audio/Io.h"
+
+#include <vector>
+
+namespace cinder { namespace audio {
+
+typedef std::shared_ptr<class SourceStream>			SourceStreamRef;
+typedef std::shared_ptr<class LoaderSourceStream>	LoaderSourceStreamRef;
+
+/** \brief Loader which decodes its source on a dedicated I/O thread into a fixed-size ring buffer, from which loadData() only copies.
+	Memory use is bounded by the readahead regardless of the length of the source. If decoding falls behind, loadData() fills the gap with silence rather than waiting. **/
+class LoaderSourceStream : public Loader {
+ public:
+	static LoaderSourceStreamRef	createRef( SourceStream *source, Target *target );
+	~LoaderSourceStream();
+
+	uint32_t getOptimalBufferSize() const { return 0; }
+	void loadData( BufferList *ioData );
+
+	uint64_t getSampleOffset() const { return mSampleOffset; }
+	//! Seeks to sample \a anOffset. loadData() produces silence until the I/O thread has decoded from the new position.
+	void setSampleOffset( uint64_t anOffset );
+
+ protected:
+	LoaderSourceStream( SourceStream *source, Target *target );
+
+	void		decodeThreadFn();
+	//! Returns the number of frames which can be written to the ring without overwriting unread ones
+	uint32_t	getFreeFrames() const;
+
+	LoaderRef						mLoader;
+	uint32_t						mBufferCount, mChannelsPerBuffer, mBytesPerFrame, mCapacity, mChunkFrames;
+	std::vector<std::vector<uint8_t> >	mRings, mChunks;
+
+	// ring positions count frames since the stream was opened, wrapping at 2^32; only the I/O thread writes mWriteFrame and only loadData() writes mReadFrame
+	volatile uint32_t				mWriteFrame, mReadFrame;
+	// each seek starts a new generation. mDataGeneration is the latest one the I/O thread has started decoding, at mDataStartFrame in the ring.
+	volatile uint32_t				mSeekGeneration, mDataGeneration, mEndedGeneration, mDataStartFrame;
+	uint64_t						mDataStartSample;
+	uint32_t						mReadGeneration;
+	uint64_t						mSampleOffset;
+
+	std::mutex						mMutex;
+	std::condition_variable			mWakeCond;
+	uint64_t						mSeekSample;
+	bool							mCanceled;
+	std::shared_ptr<std::thread>	mThread;
+};
+
+/** \brief Wraps another Source so that it is played from a fixed-size readahead buffer filled on a dedicated I/O thread.
+	Suits long files, whose memory use then stays constant, and keeps file access and decoding off the playback thread. **/
+class SourceStream : public Source {
+ public:
+	//! Creates a streaming Source for \a source, decoding up to \a readaheadSeconds ahead of playback
+	static SourceRef			createRef( SourceRef source, double readaheadSeconds = 2.0 ) { return createStreamRef( source, readaheadSeconds ); }
+	static SourceStreamRef		createStreamRef( SourceRef source, double readaheadSeconds = 2.0 );
+
+	LoaderRef createLoader( Target *target ) { return LoaderSourceStream::createRef( this, target ); }
+
+	double getDuration() const { return mSource->getDuration(); }
+	double getReadahead() const { return mReadahead; }
+	SourceRef getSource() const { return mSource; }
+
+ private:
+	SourceStream( SourceRef source, double readaheadSeconds );
+
+	SourceRef	mSource;
+	double		mReadahead;
+
+	friend class LoaderSourceStream;
+};
+
+//! Loads the audio at \a dataSource for streaming playback, decoding up to \a readaheadSeconds ahead on a dedicated I/O thread. Optional \a extension specifies the file type as in load().
+SourceRef	loadStream( DataSourceRef dataSource, double readaheadSeconds = 2.0, std::string extension = "" );
+
+}} //namespace
@@ -32,6 +32,7 @@
 #include "cinder/ImageIo.h"
 #include "cinder/MatrixAffine2.h"
 #include "cinder/Function.h"
+#include "cinder/JobSystem.h"
 
 #if defined( CINDER_COCOA_TOUCH )
 	#include <CoreGraphics/CoreGraphics.h>
@@ -41,6 +42,7 @@
 
 #include <string>
 #include <vector>
+#include <map>
 #include <iomanip>
 
 namespace cinder { namespace svg {
@@ -49,6 +51,11 @@ class Style;
 typedef std::function<bool(const Node&, Style *)> RenderVisitor;
 } } // namespace cinder::svg
 
+namespace cinder { namespace gl {
+class Texture;
+class TextureStreamer;
+} } // namespace cinder::gl
+
 // Forward declarations used by our cairo wrappers 
 struct _cairo_surface;
 typedef struct _cairo_surface cairo_surface_t;
@@ -148,6 +155,50 @@ class SurfaceImage : public SurfaceBase {
 	cinder::Surface		mCinderSurface;
 };
 
+/////////////////////////////////////////////////////////////////////////////
+// SurfaceGlTexture
+/** \brief Draws directly into the pixel buffers of a gl::TextureStreamer, so frames reach a gl::Texture without being copied through a Surface.
+	Call beginFrame() to map the next buffer, draw into it with a Context created afterwards, and call endFrame() to upload it. Since the buffers are recycled, every frame must be drawn completely.
+	The Texture's contents are premultiplied, as Cairo's are. **/
+class SurfaceGlTexture : public SurfaceBase {
+ public:
+	SurfaceGlTexture() : SurfaceBase() {}
+	//! Creates a \a width x \a height Texture which is drawn into through a ring of \a numBuffers pixel buffer objects
+	SurfaceGlTexture( int32_t width, int32_t height, bool hasAlpha = true, int numBuffers = 2 );
+
+	//! Maps the next pixel buffer for drawing. Contexts must be created after this call.
+	void	beginFrame();
+	//! Finishes drawing and starts uploading the frame into getTexture(). Contexts created since beginFrame() can no longer draw.
+	void	endFrame();
+
+	//! Returns the Texture the frames are uploaded into
+	const gl::Texture&	getTexture() const;
+
+ protected:
+	std::shared_ptr<gl::TextureStreamer>	mStreamer;
+	bool									mHasAlpha;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// SurfaceRecording
+/** \brief Records drawing commands rather than rasterizing them, so they can be replayed into other surfaces at any resolution.
+	Pass to renderTiled() to rasterize large images across multiple threads. **/
+class SurfaceRecording : public SurfaceBase {
+ public:
+	SurfaceRecording() : SurfaceBase() {}
+	//! Records drawing within the bounds (0,0)-(\a width,\a height). A \a width or \a height of 0 records without bounds.
+	SurfaceRecording( int32_t width, int32_t height, bool hasAlpha = true );
+	SurfaceRecording( const SurfaceRecording &other );
+
+	//! Returns the bounds of everything drawn so far, which for an unbounded recording is the size to render it at
+	Rectf	calcInkExtents() const;
+};
+
+//! Replays \a recording into \a dest, splitting \a dest into tiles of \a tileSize pixels which are rasterized in parallel by \a jobSystem (JobSystem::getDefault() by default). Tiles draw directly into \a dest's pixels.
+void renderTiled( const SurfaceRecording &recording, SurfaceImage *dest, int32_t tileSize = 512, JobSystemRef jobSystem = JobSystemRef() );
+//! Returns a SurfaceImage of \a recording's size, which must be bounded, with \a recording rendered into it by renderTiled(). Use its getSurface() to access the result as a ci::Surface.
+SurfaceImage renderTiled( const SurfaceRecording &recording, bool hasAlpha = true, int32_t tileSize = 512, JobSystemRef jobSystem = JobSystemRef() );
+
 /////////////////////////////////////////////////////////////////////////////
 // SurfaceSvg
 class SurfaceSvg : public SurfaceBase {
@@ -711,6 +762,64 @@ class Context
 	cairo_surface_t				*mCairoSurface;
 };
 
+/////////////////////////////////////////////////////////////////////////////
+// Picture
+/** \brief Drawing commands which are recorded once and replayed cheaply, such as static overlays.
+	Draw into the Context returned by beginRecording() and call endRecording(). draw() replays the commands as vectors under any transform,
+	while drawCached() blits a rasterization made for the Context's current scale, which is cached until the Picture is recorded again. **/
+class Picture {
+ public:
+	Picture() {}
+
+	//! Starts a new recording, which copies of the Picture don't share, and returns a Context which draws into it
+	Context		beginRecording( bool hasAlpha = true );
+	//! Completes the recording begun by beginRecording()
+	void		endRecording();
+
+	//! Replays the recorded commands into \a ctx under its current transform
+	void		draw( Context &ctx ) const;
+	/** Draws a rasterization of the Picture at \a ctx's current scale, rounded up to the next quarter octave so that nearby scales share it.
+		Suited to Pictures which are drawn repeatedly without rotation or shearing. **/
+	void		drawCached( Context &ctx ) const;
+
+	//! Returns the bounds of everything recorded
+	Rectf		getBounds() const { return mObj ? mObj->mBounds : Rectf( 0, 0, 0, 0 ); }
+	//! Sets the maximum number of rasterizations drawCached() retains, least recently used first out. Default \c 8.
+	void		setMaxCachedScales( size_t maxScales );
+	//! Releases the rasterizations made by drawCached()
+	void		clearCache() const;
+
+ protected:
+	struct CachedImage {
+		SurfaceImage	mImage;
+		double			mScale;
+		uint32_t		mLastUsed;
+	};
+
+	struct Obj {
+		Obj( bool hasAlpha ) : mRecording( 0, 0, hasAlpha ), mHasAlpha( hasAlpha ), mBounds( 0, 0, 0, 0 ), mMaxCachedScales( 8 ), mUseCount( 0 ) {}
+
+		SurfaceRecording					mRecording;
+		bool								mHasAlpha;
+		Rectf								mBounds;
+		std::map<int32_t,CachedImage>		mCache; // keyed by quarter octaves of scale
+		size_t								mMaxCachedScales;
+		uint32_t							mUseCount;
+	};
+
+	void		trimCache( size_t maxScales ) const;
+
+	std::shared_ptr<Obj>	mObj;
+
+  public:
+ 	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<Obj> Picture::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &Picture::mObj; }
+	void reset() { mObj.reset(); }
+	//@}
+};
+
 #if defined( CINDER_COCOA )
 SurfaceQuartz	createWindowSurface();
 #elif defined( CINDER_MSW )
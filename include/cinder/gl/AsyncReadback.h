@@ -0,0 +1,110 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/gl/Fbo.h"
+#include "cinder/gl/Fence.h"
+#include "cinder/Surface.h"
+#include "cinder/Function.h"
+
+#include <vector>
+
+namespace cinder { namespace gl {
+
+/** \brief Reads back the contents of the window or an Fbo through a ring of pixel buffer objects, so that the render thread never waits on glReadPixels.
+	Each read starts an asynchronous copy into the next buffer, and update() hands every copy the GPU has finished to its callback as a Surface8u, typically a frame or two later.
+	Surfaces are BGRA or BGRX, which drivers copy without conversion, and can be passed directly to qtime::MovieWriter::addFrame() or writeImage():
+	\code mReadback.readWindow( getWindowBounds(), std::bind( &MyApp::addFrame, this, std::_1 ) ); \endcode
+	Without \c GL_ARB_pixel_buffer_object each read falls back to a blocking glReadPixels and is delivered immediately. \ImplShared **/
+class AsyncReadback {
+  public:
+	typedef std::function<void (const Surface8u&)>	Callback;
+
+	AsyncReadback() {}
+	//! Creates a reader with a ring of \a numBuffers pixel buffer objects, returning Surfaces with an alpha channel if \a alpha
+	AsyncReadback( int numBuffers, bool alpha = false );
+
+	//! Starts reading \a area of the window, in the same top-left origin coordinates as copyWindowSurface(). \a callback receives the result from a later update().
+	void		readWindow( const Area &area, Callback callback );
+	//! Starts reading color attachment 0 of \a fbo, resolving it first if it is multisampled. Rows are delivered top to bottom, matching readWindow().
+	void		readFbo( Fbo &fbo, Callback callback );
+
+	/** Delivers every read which has completed to its callback, without waiting on those still in flight. Call once per frame.
+		If every buffer is in flight when a new read starts, the oldest is waited on and delivered first. **/
+	void		update();
+	//! Waits for every read in flight and delivers it
+	void		flush();
+
+	//! Returns the number of reads which have not yet been delivered
+	size_t		getNumPending() const;
+	//! Returns the number of buffers in the ring, or \c 0 if pixel buffer objects are unsupported
+	int			getNumBuffers() const { return (int)mObj->mSlots.size(); }
+
+  protected:
+	struct Slot {
+		Slot() : mPending( false ) {}
+
+		Vbo			mBuffer;
+		bool		mPending;
+		Area		mArea;
+		Callback	mCallback;
+		FenceRef	mFence;
+		uint32_t	mSequence;
+	};
+
+	struct Obj {
+		Obj( int numBuffers, bool alpha );
+
+		std::vector<Slot>	mSlots;
+		size_t				mNextSlot;
+		uint32_t			mSequence;
+		bool				mAlpha;
+	};
+
+	//! Reads \a area of the currently bound read framebuffer, whose height is \a framebufferHeight
+	void			read( const Area &area, int framebufferHeight, Callback callback );
+	//! Returns whether \a slot has been copied into, waiting for it if \a wait
+	bool			isComplete( Slot *slot, bool wait );
+	void			deliver( Slot *slot );
+	//! Delivers pending reads oldest first, stopping at the first which is incomplete unless \a wait
+	void			deliverCompleted( bool wait );
+
+	SurfaceChannelOrder		getChannelOrder() const;
+
+	std::shared_ptr<Obj>	mObj;
+
+  public:
+ 	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<Obj> AsyncReadback::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &AsyncReadback::mObj; }
+	void reset() { mObj.reset(); }
+	//@}
+};
+
+} } // namespace cinder::gl
@@ -0,0 +1,175 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/gl/TextureAtlas.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/Color.h"
+#include "cinder/MatrixAffine2.h"
+
+#include <map>
+#include <vector>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class Batch2d>	Batch2dRef;
+
+/** \brief Collects 2D primitives and draws them with as few draw calls as possible.
+	The drawing methods mirror the gl:: immediate-mode helpers, but only record vertices into an interleaved buffer. flush() then issues a single
+	glDrawElements() per combination of primitive type, Texture and BlendMode. Each primitive's color is that of the last call to color(),
+	and its positions are transformed by the last call to setTransform(). The OpenGL matrices in effect at flush() apply to everything. **/
+class Batch2d {
+  public:
+	enum BlendMode { BLEND_NONE, BLEND_ALPHA, BLEND_PREMULTIPLIED, BLEND_ADDITIVE };
+
+	class Format {
+	  public:
+		Format() : mSortByState( true )
+		{}
+
+		/** Sets whether primitives are grouped by state across the whole batch, rather than only while consecutive primitives share a state. Default \c true.
+			Primitives sharing a state keep their order, but primitives with different states may be drawn out of order, so disable this when those overlap. **/
+		Format&		sortByState( bool sort = true ) { mSortByState = sort; return *this; }
+		//! Returns whether primitives are grouped by state across the whole batch. Default \c true
+		bool		getSortByState() const { return mSortByState; }
+
+	  protected:
+		bool		mSortByState;
+	};
+
+	//! Creates a new, empty Batch2dRef with format \a format
+	static Batch2dRef	create( const Format &format = Format() ) { return Batch2dRef( new Batch2d( format ) ); }
+
+	//! Sets the color of subsequent primitives, which modulates their Texture if they have one. Default is opaque white.
+	void				color( const ColorA &color ) { mColor = ColorA8u( color ); }
+	//! Sets the color of subsequent primitives, which modulates their Texture if they have one. Default is opaque white.
+	void				color( float r, float g, float b, float a = 1.0f ) { color( ColorA( r, g, b, a ) ); }
+	//! Returns the color of subsequent primitives
+	ColorA				getColor() const { return ColorA( mColor ); }
+	//! Sets the blending of subsequent primitives. Default is \c BLEND_ALPHA.
+	void				setBlendMode( BlendMode blendMode ) { mBlendMode = blendMode; }
+	//! Returns the blending of subsequent primitives
+	BlendMode			getBlendMode() const { return mBlendMode; }
+	//! Sets the transformation applied to the positions of subsequent primitives. Default is the identity.
+	void				setTransform( const MatrixAffine2f &transform ) { mTransform = transform; }
+	//! Returns the transformation applied to the positions of subsequent primitives
+	const MatrixAffine2f&	getTransform() const { return mTransform; }
+
+	//! Adds a line from \a start to \a end
+	void	drawLine( const Vec2f &start, const Vec2f &end );
+	//! Adds a filled rectangle \a rect
+	void	drawSolidRect( const Rectf &rect );
+	//! Adds a stroked rectangle \a rect
+	void	drawStrokedRect( const Rectf &rect );
+	//! Adds a filled triangle with vertices \a pt1, \a pt2 and \a pt3
+	void	drawSolidTriangle( const Vec2f &pt1, const Vec2f &pt2, const Vec2f &pt3 );
+	//! Adds a filled circle centered at \a center with radius \a radius. \a numSegments of \c 0 determines it from the circumference, as gl::drawSolidCircle() does.
+	void	drawSolidCircle( const Vec2f &center, float radius, int numSegments = 0 );
+	//! Adds a stroked circle centered at \a center with radius \a radius. \a numSegments of \c 0 determines it from the circumference, as gl::drawStrokedCircle() does.
+	void	drawStrokedCircle( const Vec2f &center, float radius, int numSegments = 0 );
+	//! Adds \a texture at its original size with its upper left corner at the origin
+	void	draw( const Texture &texture );
+	//! Adds \a texture at its original size with its upper left corner at \a pos
+	void	draw( const Texture &texture, const Vec2f &pos );
+	//! Adds \a texture in the rectangle defined by \a rect
+	void	draw( const Texture &texture, const Rectf &rect );
+	//! Adds the pixels inside \a srcArea of \a texture in the rectangle defined by \a destRect
+	void	draw( const Texture &texture, const Area &srcArea, const Rectf &destRect );
+	//! Adds \a region of its TextureAtlas in the rectangle defined by \a destRect
+	void	draw( const TextureAtlas::Region &region, const Rectf &destRect );
+	//! Adds \a region of its TextureAtlas at its original size with its upper left corner at \a pos
+	void	draw( const TextureAtlas::Region &region, const Vec2f &pos );
+
+	//! Draws all of the primitives added since the last flush() and empties the batch
+	void	flush();
+	//! Empties the batch without drawing
+	void	clear();
+
+	//! Returns the number of vertices waiting to be drawn
+	size_t	getNumVertices() const { return mNumVertices; }
+	//! Returns the number of draw calls issued by the last flush()
+	size_t	getNumDrawCalls() const { return mNumDrawCalls; }
+
+  protected:
+	Batch2d( const Format &format );
+
+#if defined( CINDER_GLES )
+	typedef uint16_t	IndexT;
+#else
+	typedef uint32_t	IndexT;
+#endif
+
+	struct Vertex {
+		Vec2f		mPosition;
+		Vec2f		mTexCoord;
+		ColorA8u	mColor;
+	};
+
+	struct State {
+		State( GLenum primitive, const Texture &texture, BlendMode blendMode );
+
+		bool		operator==( const State &rhs ) const;
+		bool		operator<( const State &rhs ) const;
+
+		GLenum		mPrimitive;
+		GLenum		mTarget; // 0 when untextured
+		GLuint		mTextureId;
+		BlendMode	mBlendMode;
+	};
+
+	struct Bucket {
+		Bucket( const State &state, const Texture &texture ) : mState( state ), mTexture( texture ) {}
+
+		State				mState;
+		Texture				mTexture; // keeps the Texture alive until flush()
+		std::vector<Vertex>	mVertices;
+		std::vector<IndexT>	mIndices;
+	};
+
+	//! Returns the Bucket for the current state, with room for \a numVertices more vertices. Sets \a *baseIndex to the index of the first of them.
+	Bucket*		prepare( GLenum primitive, const Texture &texture, size_t numVertices, IndexT *baseIndex );
+	void		addVertex( Bucket *bucket, const Vec2f &position, const Vec2f &texCoord = Vec2f::zero() );
+	void		addQuad( const Texture &texture, const Rectf &destRect, const Rectf &texCoords );
+
+	Format					mFormat;
+	ColorA8u				mColor;
+	BlendMode				mBlendMode;
+	MatrixAffine2f			mTransform;
+
+	std::vector<Bucket>		mBuckets;
+	std::map<State,size_t>	mBucketIndices; // only used when sorting by state
+	size_t					mNumVertices, mNumDrawCalls;
+
+	std::vector<Vertex>		mFlushVertices;
+	std::vector<IndexT>		mFlushIndices;
+#if ! defined( CINDER_GLES )
+	Vbo						mVertexVbo, mIndexVbo;
+#endif
+};
+
+} } // namespace cinder::gl
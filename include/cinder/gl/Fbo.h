@@ -73,6 +73,7 @@ class Renderbuffer {
 		GLuint				mId;
 		GLenum				mInternalFormat;
 		int					mSamples, mCoverageSamples;
+		size_t				mAllocatedBytes;	// as accounted in GpuMemory
 	};
  
 	std::shared_ptr<Obj>		mObj;
@@ -115,7 +116,7 @@ class Fbo {
 
 	//! Returns a reference to the color texture of the FBO. \a attachment specifies which attachment in the case of multiple color buffers
 	Texture&		getTexture( int attachment = 0 );
-	//! Returns a reference to the depth texture of the FBO.
+	//! Returns a reference to the depth texture of the FBO. For antialiased FBOs the depth buffer is resolved first when it has been drawn to since the last resolve.
 	Texture&		getDepthTexture();	
 	
 	//! Binds the color texture associated with an Fbo to its target. Optionally binds to a multitexturing unit when \a textureUnit is non-zero. Optionally binds to a multitexturing unit when \a textureUnit is non-zero. \a attachment specifies which color buffer in the case of multiple attachments.
@@ -126,9 +127,21 @@ class Fbo {
 	void 			bindDepthTexture( int textureUnit = 0 );
 	//! Binds the Fbo as the currently active framebuffer, meaning it will receive the results of all subsequent rendering until it is unbound
 	void 			bindFramebuffer();
+	//! Binds the Fbo as the currently active framebuffer with only color buffer \a attachment enabled for drawing. Only that attachment and the depth buffer are marked as needing a resolve.
+	void 			bindFramebuffer( int attachment );
 	//! Unbinds the Fbo as the currently active framebuffer, restoring the primary context as the target for all subsequent rendering
 	static void 	unbindFramebuffer();
 
+	//! Resolves every antialiased color attachment drawn to since its last resolve, and the depth buffer when it is a texture. Called automatically by getTexture() and bindTexture() for the attachment sampled unless auto-resolve is disabled in the Fbo::Format.
+	void			resolveTextures() const;
+	//! Resolves antialiased color attachment \a attachment if it has been drawn to since its last resolve. A no-op for non-antialiased FBOs.
+	void			resolveTexture( int attachment ) const;
+	//! Resolves the antialiased depth buffer into the depth texture if it has been drawn to since its last resolve. A no-op for non-antialiased FBOs.
+	void			resolveDepthTexture() const;
+	/** \brief Hints that the contents of the buffers in \a mask (\c GL_COLOR_BUFFER_BIT and/or \c GL_DEPTH_BUFFER_BIT) are no longer needed, typically after they have been resolved or sampled.
+		Saves the write-back of the render buffers on tile-based GPUs. Uses \c glInvalidateFramebuffer() where \c GL_ARB_invalidate_subdata is available and \c glDiscardFramebufferEXT() on OpenGL ES; otherwise a no-op. **/
+	void			invalidate( GLbitfield mask = GL_DEPTH_BUFFER_BIT );
+
 	//! Returns the ID of the framebuffer itself. For antialiased FBOs this is the ID of the output multisampled FBO
 	GLuint		getId() const { return mObj->mId; }
 
@@ -171,6 +184,8 @@ class Fbo {
 //		void	enableStencilBuffer( bool stencilBuffer = true ) { mStencilBuffer = stencilBuffer; }
 		//! Enables or disables mip-mapping for the FBO's textures
 		void	enableMipmapping( bool enableMipmapping = true ) { mMipmapping = enableMipmapping; }
+		//! Enables or disables resolving antialiased attachments automatically when they are sampled via getTexture() or bindTexture(). Default is enabled. When disabled, resolveTexture() and resolveTextures() must be called explicitly.
+		void	enableAutoResolve( bool autoResolve = true ) { mAutoResolve = autoResolve; }
 
 		//! Sets the wrapping behavior for the FBO's textures. Possible values are \c GL_CLAMP, \c GL_REPEAT and \c GL_CLAMP_TO_EDGE. Default is \c GL_CLAMP_TO_EDGE.
 		void	setWrap( GLenum wrapS, GLenum wrapT ) { setWrapS( wrapS ); setWrapT( wrapT ); }
@@ -208,6 +223,16 @@ class Fbo {
 //		bool	hasStencilBuffer() const { return mStencilBuffer; }
 		//! Returns whether the contents of the FBO textures are mip-mapped.
 		bool	hasMipMapping() const { return mMipmapping; }
+		//! Returns whether antialiased attachments are resolved automatically when sampled. Default is \c true.
+		bool	hasAutoResolve() const { return mAutoResolve; }
+		//! Returns the horizontal wrapping behavior for the FBO's textures. Default is \c GL_CLAMP_TO_EDGE.
+		GLenum	getWrapS() const { return mWrapS; }
+		//! Returns the vertical wrapping behavior for the FBO's textures. Default is \c GL_CLAMP_TO_EDGE.
+		GLenum	getWrapT() const { return mWrapT; }
+		//! Returns the minification filtering behavior for the FBO's textures. Default is \c GL_LINEAR.
+		GLenum	getMinFilter() const { return mMinFilter; }
+		//! Returns the magnification filtering behavior for the FBO's textures. Default is \c GL_LINEAR.
+		GLenum	getMagFilter() const { return mMagFilter; }
 		
 	  protected:
 		GLenum		mTarget;
@@ -215,6 +240,7 @@ class Fbo {
 		int			mSamples;
 		int			mCoverageSamples;
 		bool		mMipmapping;
+		bool		mAutoResolve;
 		bool		mDepthBuffer, mDepthBufferAsTexture, mStencilBuffer;
 		int			mNumColorBuffers;
 		GLenum		mWrapS, mWrapT;
@@ -226,7 +252,9 @@ class Fbo {
  protected:
 	void		init();
 	bool		initMultisample( bool csaa );
-	void		resolveTextures() const;
+	void		initDepthTexture();
+	void		markDirty( int attachment );
+	void		resolve( size_t beginAttachment, size_t endAttachment, bool depth ) const;
 	void		updateMipmaps( bool bindFirst, int attachment ) const;
 	bool		checkStatus( class FboExceptionInvalidSpecification *resultExc );
 
@@ -244,12 +272,17 @@ class Fbo {
 		std::vector<Texture>		mColorTextures;
 		Texture						mDepthTexture;
 		Renderbuffer				mDepthRenderbuffer;
-		mutable bool		mNeedsResolve, mNeedsMipmapUpdate;
+		// per color attachment; only attachments drawn since their last resolve are blitted
+		mutable std::vector<bool>	mNeedsResolve, mNeedsMipmapUpdate;
+		mutable bool				mDepthNeedsResolve;
+		int							mDrawAttachment;	// the only color attachment enabled for drawing, or -1 for all
 	};
  
 	std::shared_ptr<Obj>	mObj;
 	
 	static GLint			sMaxSamples, sMaxAttachments;
+
+	friend class FboPool;
 	
   public:
 	//@{
@@ -0,0 +1,91 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/gl/Fbo.h"
+
+#include <boost/noncopyable.hpp>
+#include <algorithm>
+#include <map>
+#include <vector>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class FboPool>	FboPoolRef;
+
+/** \brief Cache of Fbos, recycled between render targets of the same size and Format.
+	An Fbo returned by acquire() returns to the pool as soon as the last copy of it is destroyed, so a post-processing chain which acquires its targets every frame allocates nothing once the pool is warm.
+	Textures obtained from a pooled Fbo are only meaningful while the Fbo itself is held. Call nextFrame() once per frame to free Fbos which have gone unused for too long. **/
+class FboPool : private boost::noncopyable {
+  public:
+	//! Creates an FboPool which frees unused Fbos after \a maxIdleFrames calls to nextFrame()
+	static FboPoolRef	create( uint32_t maxIdleFrames = 3 ) { return FboPoolRef( new FboPool( maxIdleFrames ) ); }
+
+	//! Returns an Fbo which nothing else holds, reusing an unused one of matching size and Format when possible
+	Fbo			acquire( int width, int height, const Fbo::Format &format = Fbo::Format() );
+	//! Advances the pool's frame counter and frees every unused Fbo which has not been acquired within the last \a maxIdleFrames frames
+	void		nextFrame();
+	//! Frees all unused Fbos
+	void		clear();
+
+	//! Returns the total number of Fbos owned by the pool, whether in use or not
+	size_t		getNumFbos() const;
+	//! Returns the number of pooled Fbos currently held outside of the pool
+	size_t		getNumInUse() const;
+	//! Returns the number of Fbos created by acquire() since the pool was created
+	size_t		getNumCreated() const { return mNumCreated; }
+
+	uint32_t	getMaxIdleFrames() const { return mMaxIdleFrames; }
+	void		setMaxIdleFrames( uint32_t maxIdleFrames ) { mMaxIdleFrames = maxIdleFrames; }
+
+  private:
+	FboPool( uint32_t maxIdleFrames );
+
+	struct Key {
+		Key( int width, int height, const Fbo::Format &format );
+		bool	operator<( const Key &rhs ) const { return std::lexicographical_compare( mValues, mValues + NUM_VALUES, rhs.mValues, rhs.mValues + NUM_VALUES ); }
+
+		static const int	NUM_VALUES = 17;
+		int					mValues[NUM_VALUES];
+	};
+
+	struct Entry {
+		Entry( const Fbo &fbo, uint32_t frame ) : mFbo( fbo ), mLastUsedFrame( frame ) {}
+
+		Fbo			mFbo;
+		uint32_t	mLastUsedFrame;
+	};
+
+	void		trim( uint32_t maxIdleFrames );
+	//! Returns whether a copy of \a entry's Fbo exists outside of the pool
+	static bool	isInUse( const Entry &entry ) { return ! entry.mFbo.mObj.unique(); }
+
+	std::map<Key,std::vector<Entry> >	mEntries;
+	uint32_t							mFrame, mMaxIdleFrames;
+	size_t								mNumCreated;
+};
+
+} } // namespace cinder::gl
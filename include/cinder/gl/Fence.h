@@ -0,0 +1,61 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/gl/gl.h"
+
+#include <boost/noncopyable.hpp>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class Fence>	FenceRef;
+
+/** \brief Marker in the GL command stream which reports when the GPU has executed all the commands issued before it.
+	Uses GL_ARB_sync on Windows and GL_APPLE_fence on Mac OS X. Check isSupported() before creating one. **/
+class Fence : private boost::noncopyable {
+  public:
+	//! Returns whether fences are supported by the current context
+	static bool		isSupported();
+	//! Inserts a fence after the commands issued so far on the current context
+	static FenceRef	create() { return FenceRef( new Fence ); }
+
+	~Fence();
+
+	//! Returns whether the GPU has executed every command issued before the fence, without waiting
+	bool	isSignaled() const;
+	//! Blocks until the GPU has executed every command issued before the fence. Returns \c false if the wait failed.
+	bool	wait() const;
+
+  private:
+	Fence();
+
+	bool	test( bool wait ) const;
+
+	void	*mSync;
+};
+
+} } // namespace cinder::gl
@@ -0,0 +1,133 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/gl/gl.h"
+#include "cinder/Timer.h"
+#include "cinder/Font.h"
+#include "cinder/params/Params.h"
+
+#include <boost/noncopyable.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class FrameProfiler>	FrameProfilerRef;
+
+/** \brief Collects nested CPU and GPU timings for each frame into a hierarchy which can be drawn as an overlay or shown through a params::InterfaceGl.
+	Bracket each frame with beginFrame() and endFrame(), and each region of interest with a FrameProfiler::Scope or pushScope() and popScope().
+	GPU times come from \c GL_TIME_ELAPSED queries which are collected a few frames later without waiting, so getResults() always describes the most recent frame whose GPU work has finished.
+	Because these queries can't nest, each GPU scope is timed as a series of segments around its children. **/
+class FrameProfiler : private boost::noncopyable {
+  public:
+	//! Creates a FrameProfiler which keeps up to \a numFramesInFlight frames of GPU queries outstanding
+	static FrameProfilerRef	create( int numFramesInFlight = 3 ) { return FrameProfilerRef( new FrameProfiler( numFramesInFlight ) ); }
+	~FrameProfiler();
+
+	void		beginFrame();
+	void		endFrame();
+
+	//! Opens a scope named \a name inside the current one. Its GPU time is measured as well if \a gpu and GpuTimer::isSupported().
+	void		pushScope( const std::string &name, bool gpu = true );
+	void		popScope();
+
+	//! Pushes a scope on construction and pops it on destruction
+	class Scope : private boost::noncopyable {
+	  public:
+		Scope( FrameProfilerRef profiler, const std::string &name, bool gpu = true ) : mProfiler( profiler ) { mProfiler->pushScope( name, gpu ); }
+		~Scope() { mProfiler->popScope(); }
+	  private:
+		FrameProfilerRef	mProfiler;
+	};
+
+	struct Node {
+		std::string		mName;
+		int				mDepth;
+		//! Inclusive times, covering the scope's children as well
+		double			mCpuSeconds, mGpuSeconds;
+		bool			mHasGpu;
+	};
+
+	//! Returns every scope of the most recently completed frame, depth first, in the order they were opened
+	const std::vector<Node>&	getResults() const { return mResults; }
+	//! Returns the results formatted as one indented line per scope, followed by GpuMemory::getSummary() if showGpuMemory() is enabled
+	std::string		getResultsString() const;
+	//! Enables or disables a line of GPU memory totals from GpuMemory below the results. Default is disabled.
+	void			showGpuMemory( bool show = true ) { mShowGpuMemory = show; }
+	//! Returns whether GPU memory totals are shown below the results
+	bool			isShowingGpuMemory() const { return mShowGpuMemory; }
+
+	//! Draws the results as text with its upper left corner at \a pos
+	void		draw( const Vec2f &pos, const ColorA &color = ColorA( 1, 1, 1, 1 ), Font font = Font() ) const;
+	//! Adds a read-only entry to \a params for each scope, which keeps updating as new results arrive. New scopes are added the next time this is called.
+	void		addParams( params::InterfaceGl &params );
+
+  private:
+	FrameProfiler( int numFramesInFlight );
+
+	struct Record {
+		std::string		mName;
+		int				mDepth, mParent;
+		double			mCpuStart, mCpuSeconds, mGpuSeconds;
+		bool			mGpu;
+	};
+
+	struct Segment {
+		int			mRecord;
+		GLuint		mQuery;
+	};
+
+	struct Frame {
+		std::vector<Record>		mRecords;
+		std::vector<Segment>	mSegments;
+		std::vector<GLuint>		mQueries; // reused from frame to frame, grown as needed
+		bool					mPending;
+	};
+
+	//! Ends the GPU segment in progress, if any
+	void		endSegment();
+	//! Starts a GPU segment attributed to \a record
+	void		beginSegment( int record );
+	//! Publishes every frame whose GPU results have all arrived, oldest first
+	void		collect();
+	void		publish( Frame *frame );
+
+	std::vector<Frame>		mFrames;
+	size_t					mCurrentFrame;
+	bool					mInFrame, mSegmentOpen;
+	bool					mShowGpuMemory;
+	std::vector<int>		mStack;
+	Timer					mTimer;
+	std::vector<Node>		mResults;
+
+	// keyed by each scope's path, so that the strings' addresses stay valid for params::InterfaceGl
+	std::map<std::string,std::string>	mParamStrings;
+	std::vector<std::string>			mResultPaths;
+};
+
+} } // namespace cinder::gl
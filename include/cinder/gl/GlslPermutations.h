@@ -0,0 +1,108 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/GlslProg.h"
+#include "cinder/Thread.h"
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <boost/unordered_map.hpp>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class GlslPermutations>	GlslPermutationsRef;
+
+/** \brief Compiles the permutations of one set of shader sources which differ only in their \c #defines, each the first time it is requested.
+	Permutations are keyed by their sorted defines, and each is compiled into an ordinary GlslProg, so the GlslProg binary cache applies to them as well.
+	warmup() compiles a list of permutations ahead of time on a worker thread with its own context sharing objects with the current one. **/
+class GlslPermutations {
+  public:
+	//! The preprocessor symbols of a permutation, each either \c "NAME" or \c "NAME VALUE", in any order
+	typedef std::vector<std::string>	Defines;
+
+	static GlslPermutationsRef	create( DataSourceRef vertexShader, DataSourceRef fragmentShader = DataSourceRef(), DataSourceRef geometryShader = DataSourceRef(),
+									GLint geometryInputType = GL_POINTS, GLint geometryOutputType = GL_TRIANGLES, GLint geometryOutputVertices = 0 );
+	static GlslPermutationsRef	create( const char *vertexShader, const char *fragmentShader = 0, const char *geometryShader = 0,
+									GLint geometryInputType = GL_POINTS, GLint geometryOutputType = GL_TRIANGLES, GLint geometryOutputVertices = 0 );
+	//! Waits for a permutation being compiled by warmup() to finish and abandons the rest
+	~GlslPermutations();
+
+	/** Returns the permutation with \a defines, compiling it first unless it has been already. A permutation waiting in warmup()'s queue is compiled right away instead,
+		while one the worker is already compiling is waited for. Throws GlslProgCompileExc if the permutation fails to compile, every time it is requested. **/
+	GlslProg	get( const Defines &defines );
+	/** Queues \a permutations to be compiled on a worker thread, with a context created to share objects with the current one, which must be the one the permutations are drawn with.
+		Where background compilation isn't supported they're compiled right away instead. **/
+	void		warmup( const std::vector<Defines> &permutations );
+	//! Blocks until every permutation queued by warmup() has been compiled
+	void		waitForWarmup();
+
+	//! Returns whether the permutation with \a defines has been compiled, successfully or not
+	bool		isCompiled( const Defines &defines ) const;
+	//! Returns the number of permutations compiled, successfully or not
+	size_t		getNumCompiled() const;
+	//! Returns the number of permutations warmup() has yet to compile
+	size_t		getNumPendingWarmups() const;
+
+	//! Returns \a source with a \c #define line for each of \a defines inserted after its \c #version line, or at its start if it has none
+	static std::string	injectDefines( const std::string &source, const Defines &defines );
+	//! Returns whether warmup() can compile on a worker thread on this platform
+	static bool			supportsBackgroundCompilation();
+
+  protected:
+	GlslPermutations( const std::string *vertexShader, const std::string *fragmentShader, const std::string *geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices );
+
+	enum State { QUEUED, COMPILING_HERE, COMPILING_WORKER, COMPILED };
+
+	struct Permutation {
+		Permutation() : mState( QUEUED ) {}
+
+		State									mState;
+		Defines									mDefines;
+		GlslProg								mProg;
+		std::shared_ptr<GlslProgCompileExc>		mError;
+	};
+
+	//! Compiles the permutation with \a defines into \a prog, or into \a error if it fails
+	void		compile( const Defines &defines, GlslProg *prog, std::shared_ptr<GlslProgCompileExc> *error ) const;
+	//! Stores the result of compile() in the permutation with \a key and wakes anyone waiting on it
+	void		store( const std::string &key, const GlslProg &prog, const std::shared_ptr<GlslProgCompileExc> &error );
+	void		workerThread();
+
+	std::string			mSources[3];
+	bool				mHasSource[3];
+	GLint				mGeometryParams[3];
+
+	mutable std::mutex								mMutex;
+	std::condition_variable							mCompiledCond;
+	boost::unordered_map<std::string,Permutation>	mPermutations;
+	std::deque<std::string>							mWarmupQueue;
+	std::shared_ptr<std::thread>					mThread;
+	void											*mWorkerContext, *mWorkerDevice;	// the platform's context and, on MSW, the device context it's made current with
+	bool											mWorkerBusy, mShutdown;
+};
+
+} } // namespace cinder::gl
@@ -28,12 +28,14 @@
 #include <fstream>
 #include <exception>
 #include <map>
+#include <boost/unordered_map.hpp>
 
 #include "cinder/gl/gl.h"
 #include "cinder/Vector.h"
 #include "cinder/Color.h"
 #include "cinder/Matrix.h"
 #include "cinder/DataSource.h"
+#include "cinder/Filesystem.h"
 
 namespace cinder { namespace gl {
 
@@ -68,14 +70,55 @@ class GlslProg {
 	void	uniform( const std::string &name, const Vec3f *data, int count );
 	void	uniform( const std::string &name, const Vec4f *data, int count );
 
+	//! Variants of uniform() which take a location previously returned by getUniformLocation(), skipping the lookup by name
+	void	uniform( GLint location, int data );
+	void	uniform( GLint location, const Vec2i &data );
+	void	uniform( GLint location, const int *data, int count );
+	void	uniform( GLint location, const Vec2i *data, int count );
+	void	uniform( GLint location, float data );
+	void	uniform( GLint location, const Vec2f &data );
+	void	uniform( GLint location, const Vec3f &data );
+	void	uniform( GLint location, const Vec4f &data );
+	void	uniform( GLint location, const Color &data );
+	void	uniform( GLint location, const ColorA &data );
+	void	uniform( GLint location, const Matrix33f &data, bool transpose = false );
+	void	uniform( GLint location, const Matrix44f &data, bool transpose = false );
+	void	uniform( GLint location, const float *data, int count );
+	void	uniform( GLint location, const Vec2f *data, int count );
+	void	uniform( GLint location, const Vec3f *data, int count );
+	void	uniform( GLint location, const Vec4f *data, int count );
+
+	//! Returns the location of the uniform \a name, which is cached after the first lookup. Returns -1 if the program has no active uniform by that name.
 	GLint	getUniformLocation( const std::string &name );
 	GLint	getAttribLocation( const std::string &name );
 
+	//! Returns whether the driver supports uniform buffer objects (GL_ARB_uniform_buffer_object)
+	static bool		supportsUniformBuffers();
+	//! Returns the index of the uniform block \a name, or GL_INVALID_INDEX if the program has no active block by that name
+	GLuint	getUniformBlockIndex( const std::string &name );
+	//! Associates the uniform block \a name with \a bindingPoint. A Vbo of type GL_UNIFORM_BUFFER bound to the same point with Vbo::bindBase() supplies its data.
+	void	uniformBlock( const std::string &name, GLuint bindingPoint );
+	//! Returns the minimum size in bytes of a buffer backing the uniform block \a name
+	GLint	getUniformBlockSize( const std::string &name );
+	//! Returns the byte offset of the uniform \a name within its uniform block, or -1 if it is not part of a block
+	GLint	getUniformBlockOffset( const std::string &name );
+
 	std::string		getShaderLog( GLuint handle ) const;
 
+	/** Enables an on-disk cache of linked program binaries stored in \a directory, which is created if necessary. An empty path disables the cache, which is the default.
+		Entries are keyed on the shader sources and the GL vendor, renderer and version, so a driver update simply misses the cache and recompiles. **/
+	static void				setBinaryCacheDirectory( const fs::path &directory );
+	static const fs::path&	getBinaryCacheDirectory();
+	//! Returns whether the driver can save and restore program binaries (GL_ARB_get_program_binary)
+	static bool				supportsProgramBinaries();
+
   protected:
+	void			initialize( const char *vertexShader, const char *fragmentShader, const char *geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices );
 	void			loadShader( Buffer shaderSourceBuffer, GLint shaderType );
 	void			loadShader( const char *shaderSource, GLint shaderType );
+	//! Replaces the program with the cached binary for \a key. Returns false if there is no usable entry.
+	bool			loadBinary( const std::string &key );
+	void			saveBinary( const std::string &key );
 	void			attachShaders();
 	void			link();
 
@@ -83,8 +126,9 @@ class GlslProg {
 		Obj() : mHandle( 0 ) {}
 		~Obj();
 		
-		GLuint						mHandle;
-		std::map<std::string,int>	mUniformLocs;
+		GLuint										mHandle;
+		boost::unordered_map<std::string,GLint>		mUniformLocs;
+		boost::unordered_map<std::string,GLuint>	mUniformBlockIndices;
 	};
  
 	std::shared_ptr<Obj>	mObj;
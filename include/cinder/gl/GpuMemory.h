@@ -0,0 +1,74 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/gl/gl.h"
+#include "cinder/Function.h"
+
+#include <string>
+
+namespace cinder { namespace gl {
+
+/** \brief Accounts for the GPU memory held by Cinder's GL objects, so that applications can notice they are running out before the driver starts paging.
+	Texture, Vbo and Renderbuffer report their storage as it is specified and release it on destruction. An Fbo's attachments are accounted as the Textures and Renderbuffers they are.
+	Sizes are estimated from internal formats, since GL doesn't report what it actually allocates, and Textures wrapping GL names they don't own aren't counted. **/
+class GpuMemory {
+  public:
+	enum Category { TEXTURE, BUFFER, RENDERBUFFER, NUM_CATEGORIES };
+
+	//! Callback receiving the total bytes allocated and the budget which they exceed
+	typedef std::function<void(size_t,size_t)>		BudgetFn;
+
+	//! Returns the bytes currently allocated in \a category
+	static size_t		getAllocated( Category category );
+	//! Returns the bytes currently allocated across all categories
+	static size_t		getTotalAllocated();
+	//! Returns the largest total reached since the last call to resetPeak()
+	static size_t		getPeakAllocated();
+	static void			resetPeak();
+	//! Returns the number of objects in \a category which currently hold storage
+	static size_t		getNumObjects( Category category );
+
+	/** Sets a budget of \a bytes, with \a budgetFn called after every allocation which leaves the total above it, such as to evict cached assets.
+		\a budgetFn is called on the allocating thread, and may release GL objects. A budget of \c 0 disables it. **/
+	static void			setBudget( size_t bytes, const BudgetFn &budgetFn = BudgetFn() );
+	//! Returns the budget in bytes, or \c 0 if there is none
+	static size_t		getBudget();
+
+	//! Returns the totals of each category as a single line, such as <tt>GPU textures 96.0 MB (41), buffers 12.5 MB (7), renderbuffers 8.0 MB (2), total 116.5 MB of 256.0 MB</tt>
+	static std::string	getSummary();
+
+	//! Replaces \a oldBytes accounted in \a category with \a newBytes, as when an object's storage is created, respecified or deleted
+	static void			reallocate( Category category, size_t oldBytes, size_t newBytes );
+
+	//! Returns the estimated bits per pixel of \a internalFormat, assuming three component formats are padded to four
+	static size_t		getBitsPerPixel( GLint internalFormat );
+	//! Returns the estimated bytes of a \a width x \a height image of \a internalFormat, including its full mip chain when \a mipmapped
+	static size_t		getImageBytes( GLint internalFormat, int32_t width, int32_t height, bool mipmapped = false );
+};
+
+} } // namespace cinder::gl
@@ -0,0 +1,87 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/gl/gl.h"
+
+#include <vector>
+
+namespace cinder { namespace gl {
+
+/** \brief Measures the GPU time taken by the commands issued between begin() and end(), using \c GL_TIME_ELAPSED queries.
+	Each measurement uses the next query of a ring, and getElapsedSeconds() reports the most recent one the GPU has finished, so reading a result never waits on the GPU.
+	\c GL_TIME_ELAPSED queries can't be nested, so only one GpuTimer may be running at a time. \ImplShared **/
+class GpuTimer {
+  public:
+	GpuTimer() {}
+	//! Creates a timer with a ring of \a numQueries queries. Results lag by roughly \a numQueries - 1 measurements.
+	GpuTimer( int numQueries );
+
+	//! Starts timing the commands which follow
+	void		begin();
+	//! Stops timing
+	void		end();
+
+	//! Returns the duration of the most recent measurement the GPU has finished, or \c 0 if none has finished yet
+	double		getElapsedSeconds();
+	//! Returns the number of measurements which have been started but whose result hasn't been collected
+	int			getNumPending() const;
+
+	//! Returns whether the driver supports \c GL_EXT_timer_query
+	static bool	isSupported();
+
+  protected:
+	struct Obj {
+		Obj( int numQueries );
+		~Obj();
+
+		std::vector<GLuint>		mQueries;
+		std::vector<bool>		mPending;
+		size_t					mNextQuery;
+		bool					mRunning;
+		double					mElapsedSeconds;
+	};
+
+	//! Collects every finished result, oldest first
+	void		collect();
+
+	std::shared_ptr<Obj>	mObj;
+
+  public:
+ 	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<Obj> GpuTimer::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &GpuTimer::mObj; }
+	void reset() { mObj.reset(); }
+	//@}
+};
+
+namespace detail {
+//! Returns the result in seconds of the \c GL_TIME_ELAPSED query \a query if it is available, without waiting. Returns false otherwise.
+bool	getTimeElapsedQueryResult( GLuint query, double *resultSeconds );
+} // namespace detail
+
+} } // namespace cinder::gl
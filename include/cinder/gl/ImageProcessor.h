@@ -0,0 +1,111 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/gl/Fbo.h"
+#include "cinder/gl/FboPool.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/ip/Pipeline.h"
+
+#include <boost/noncopyable.hpp>
+
+#if ! defined( CINDER_GLES )
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class ImageProcessor>	ImageProcessorRef;
+
+/** \brief Runs the common cinder::ip operations on the GPU, reading gl::Textures and writing pooled gl::Fbos.
+	Each function mirrors its ip counterpart and comes in two forms: one returning an Fbo acquired from the ImageProcessor's FboPool, and one rendering into an existing \a dst Fbo.
+	Values are normalized, so threshold() takes \c 0-1, and render() runs an ip::PipelineT unchanged, making it possible to run the same processing graph on either the CPU or the GPU.
+	Output Fbos store the image's top row at \c t = 0, as a Texture uploaded from a Surface does, and match the source's precision (\c GL_RGBA8, \c GL_RGBA16 or \c GL_RGBA32F_ARB).
+	Results approximate the CPU ones: resize() is bilinear with box-filtered halving steps, and all math is done in floating point.
+	Requires a current GL context, and must be used from the thread which owns it. **/
+class ImageProcessor : private boost::noncopyable {
+  public:
+	//! Creates an ImageProcessor which acquires its outputs from \a pool, or from a pool of its own when \a pool is null
+	static ImageProcessorRef	create( const FboPoolRef &pool = FboPoolRef() ) { return ImageProcessorRef( new ImageProcessor( pool ) ); }
+
+	//! Returns the FboPool outputs are acquired from
+	const FboPoolRef&	getFboPool() const { return mFboPool; }
+
+	//! Returns \a srcTexture resized to \a size. Minification by more than 2x is done in halving steps so every source texel contributes, like ip::resize() with a box filter.
+	Fbo		resize( const Texture &srcTexture, const Vec2i &size );
+	//! Renders \a srcTexture resized to the size of \a dst into \a dst
+	void	resize( const Texture &srcTexture, Fbo *dst );
+
+	//! Returns the luminance of \a srcTexture using Rec. 709 weights, like ip::grayscale(), replicated to RGB with an alpha of \c 1
+	Fbo		grayscale( const Texture &srcTexture );
+	//! Renders the luminance of \a srcTexture into \a dst
+	void	grayscale( const Texture &srcTexture, Fbo *dst );
+
+	//! Returns \a srcTexture with each color component set to \c 1 when greater than \a value and \c 0 otherwise, like ip::threshold(). Alpha is preserved.
+	Fbo		threshold( const Texture &srcTexture, float value );
+	//! Renders \a srcTexture thresholded at \a value into \a dst
+	void	threshold( const Texture &srcTexture, float value, Fbo *dst );
+
+	//! Returns \a srcTexture with its color components inverted, like ip::invert(). Alpha is preserved.
+	Fbo		invert( const Texture &srcTexture );
+	//! Renders \a srcTexture inverted into \a dst
+	void	invert( const Texture &srcTexture, Fbo *dst );
+
+	//! Returns the Sobel gradient magnitude of each color component of \a srcTexture, clamped to \c 1, like ip::edgeDetectSobel(). The outermost rows and columns are \c 0 and alpha is preserved.
+	Fbo		edgeDetectSobel( const Texture &srcTexture );
+	//! Renders the Sobel gradient magnitude of \a srcTexture into \a dst
+	void	edgeDetectSobel( const Texture &srcTexture, Fbo *dst );
+
+	//! Blends \a srcArea of \a srcTexture over \a background, displaced by \a dstRelativeOffset, like ip::blend(). \a premultiplied indicates \a srcTexture's colors are premultiplied by alpha.
+	void	blend( Fbo *background, const Texture &srcTexture, const Area &srcArea, const Vec2i &dstRelativeOffset, bool premultiplied = false );
+	//! Blends all of \a srcTexture over \a background with its upper-left corner at \a dstOffset
+	void	blend( Fbo *background, const Texture &srcTexture, const Vec2i &dstOffset = Vec2i::zero(), bool premultiplied = false ) { blend( background, srcTexture, srcTexture.getBounds(), dstOffset, premultiplied ); }
+
+	//! Runs every stage of \a pipeline on the GPU, uploading its source, and returns the result with the gray value replicated to RGB
+	template<typename T>
+	Fbo		render( const ip::PipelineT<T> &pipeline );
+
+  protected:
+	ImageProcessor( const FboPoolRef &pool );
+
+	//! Returns an Fbo from the pool sized \a size whose precision matches \a srcTexture
+	Fbo			acquire( const Vec2i &size, const Texture &srcTexture );
+	//! Draws all of \a srcTexture into \a dst using \a shader, with \a srcTexture bound to unit \c 0
+	void		runPass( GlslProg &shader, const Texture &srcTexture, Fbo *dst );
+	//! Draws \a srcArea of \a srcTexture into \a dstArea of the currently bound framebuffer
+	static void	drawQuad( const Texture &srcTexture, const Area &srcArea, const Area &dstArea );
+
+	//! Returns \a shader, compiling it from \a fragmentShader on first use
+	static GlslProg&	getShader( GlslProg *shader, const char *fragmentShader );
+
+	FboPoolRef	mFboPool;
+	GlslProg	mCopyShader, mGrayscaleShader, mThresholdShader, mInvertShader, mSobelShader;
+};
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
@@ -0,0 +1,115 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/TriMesh.h"
+#include "cinder/Sphere.h"
+#include "cinder/Matrix.h"
+
+#include <limits>
+#include <vector>
+
+namespace cinder {
+
+class Camera;
+
+namespace gl {
+
+typedef std::shared_ptr<class LodMesh>	LodMeshRef;
+
+/** \brief A chain of levels of detail of a TriMesh, each simplified from the one before by TriMesh::calcSimplifiedIndices(), stored in a single VboMesh.
+	Since simplification only drops triangles and merges vertices into their neighbors, every level draws from the same vertices. These are ordered so that
+	the coarsest level uses the fewest at the front, and each level is a range of the index buffer. select() picks the level whose error covers at most
+	a given number of pixels on screen. **/
+class LodMesh {
+  public:
+	class Format {
+	  public:
+		Format() : mMaxLevels( 8 ), mReduction( 0.5f ), mMinTriangles( 64 ), mMaxError( std::numeric_limits<float>::max() ), mOptimize( true )
+		{}
+
+		//! Sets the largest number of levels, including the original mesh. Default \c 8
+		Format&		maxLevels( size_t maxLevels ) { mMaxLevels = maxLevels; return *this; }
+		size_t		getMaxLevels() const { return mMaxLevels; }
+		//! Sets the fraction of its predecessor's triangles each level aims for. Default \c 0.5
+		Format&		reduction( float reduction ) { mReduction = reduction; return *this; }
+		float		getReduction() const { return mReduction; }
+		//! Sets the number of triangles below which no further levels are built. Default \c 64
+		Format&		minTriangles( size_t minTriangles ) { mMinTriangles = minTriangles; return *this; }
+		size_t		getMinTriangles() const { return mMinTriangles; }
+		//! Sets the largest error, in the units of the mesh, of any one collapse. Levels stop short of their target rather than exceed it. Default unlimited
+		Format&		maxError( float maxError ) { mMaxError = maxError; return *this; }
+		float		getMaxError() const { return mMaxError; }
+		//! Sets whether each level's triangles are reordered by TriMesh::optimizeVertexCache(). Default \c true
+		Format&		optimize( bool optimize = true ) { mOptimize = optimize; return *this; }
+		bool		getOptimize() const { return mOptimize; }
+
+	  protected:
+		size_t		mMaxLevels;
+		float		mReduction;
+		size_t		mMinTriangles;
+		float		mMaxError;
+		bool		mOptimize;
+	};
+
+	//! Builds the levels of \a mesh and uploads them with \a layout, whose TriMesh optimization is disabled since it would reorder the levels' vertices
+	static LodMeshRef	create( const TriMesh &mesh, const Format &format = Format(), VboMesh::Layout layout = VboMesh::Layout() ) { return LodMeshRef( new LodMesh( mesh, format, layout ) ); }
+
+	//! Returns the number of levels. Level \c 0 is the original mesh.
+	size_t		getNumLevels() const { return mLevels.size(); }
+	size_t		getNumTriangles( size_t level ) const { return mLevels[level].mNumIndices / 3; }
+	//! Returns the accumulated simplification error of \a level, roughly the farthest its surface lies from the original, in the units of the mesh
+	float		getError( size_t level ) const { return mLevels[level].mError; }
+
+	/** Returns the coarsest level whose error is at most \a maxPixelError pixels when the mesh's bounding sphere covers \a screenRadius pixels,
+		as returned by Camera::getScreenRadius() **/
+	size_t		select( float screenRadius, float maxPixelError = 1.0f ) const;
+	//! Returns the coarsest level whose error is at most \a maxPixelError pixels when drawn by \a cam with the model matrix \a transform to a \a screenWidth by \a screenHeight viewport
+	size_t		select( const Camera &cam, const Matrix44f &transform, float screenWidth, float screenHeight, float maxPixelError = 1.0f ) const;
+
+	//! Draws \a level
+	void		draw( size_t level ) const;
+
+	const VboMesh&	getVboMesh() const { return mVboMesh; }
+	//! Returns the bounding sphere of the original mesh
+	const Sphere&	getBoundingSphere() const { return mBoundingSphere; }
+
+  protected:
+	LodMesh( const TriMesh &mesh, const Format &format, VboMesh::Layout layout );
+
+	struct Level {
+		size_t		mStartIndex, mNumIndices;
+		size_t		mNumVertices; // the level uses vertices [0, mNumVertices)
+		float		mError;
+	};
+
+	std::vector<Level>	mLevels;
+	VboMesh				mVboMesh;
+	Sphere				mBoundingSphere;
+};
+
+} } // namespace cinder::gl
@@ -0,0 +1,167 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/TriMesh.h"
+#include "cinder/Matrix.h"
+
+#include <map>
+#include <vector>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class MeshArena>	MeshArenaRef;
+
+/** \brief Packs many small meshes into one interleaved vertex buffer and one index buffer, so that all of them are drawn with a single \c glMultiDrawElements() call.
+	Each mesh is sub-allocated a range of vertices and of indices, and its indices are rebased onto its first vertex as it is added.
+	Every vertex also carries the number of its mesh, which a shader can use to fetch that mesh's transform from getTransformTexture(), so moving meshes costs no extra draw calls. **/
+class MeshArena {
+  public:
+	//! Identifies a mesh added to a MeshArena
+	typedef uint32_t	MeshId;
+
+	class Format {
+	  public:
+		Format() : mMaxVertices( 1024 * 1024 ), mMaxIndices( 3 * 1024 * 1024 ), mMaxMeshes( 4096 ), mNormals( true ), mTexCoords( false ), mColors( false )
+		{}
+
+		//! Sets the number of vertices the arena can hold. Default \c 1048576
+		Format&		maxVertices( size_t maxVertices ) { mMaxVertices = maxVertices; return *this; }
+		//! Returns the number of vertices the arena can hold. Default \c 1048576
+		size_t		getMaxVertices() const { return mMaxVertices; }
+		//! Sets the number of indices the arena can hold. Default \c 3145728
+		Format&		maxIndices( size_t maxIndices ) { mMaxIndices = maxIndices; return *this; }
+		//! Returns the number of indices the arena can hold. Default \c 3145728
+		size_t		getMaxIndices() const { return mMaxIndices; }
+		//! Sets the number of meshes the arena can hold, which is also the height of the transform texture. Default \c 4096
+		Format&		maxMeshes( size_t maxMeshes ) { mMaxMeshes = maxMeshes; return *this; }
+		//! Returns the number of meshes the arena can hold. Default \c 4096
+		size_t		getMaxMeshes() const { return mMaxMeshes; }
+		//! Sets whether vertices store normals. Default \c true
+		Format&		normals( bool normals = true ) { mNormals = normals; return *this; }
+		bool		hasNormals() const { return mNormals; }
+		//! Sets whether vertices store 2D texture coordinates for unit 0. Default \c false
+		Format&		texCoords( bool texCoords = true ) { mTexCoords = texCoords; return *this; }
+		bool		hasTexCoords() const { return mTexCoords; }
+		//! Sets whether vertices store RGBA colors. Default \c false
+		Format&		colors( bool colors = true ) { mColors = colors; return *this; }
+		bool		hasColors() const { return mColors; }
+
+	  protected:
+		size_t		mMaxVertices, mMaxIndices, mMaxMeshes;
+		bool		mNormals, mTexCoords, mColors;
+	};
+
+	static MeshArenaRef		create( const Format &format = Format() ) { return MeshArenaRef( new MeshArena( format ) ); }
+
+	/** Copies \a mesh into the arena and returns its id. Attributes the Format stores but \a mesh lacks are zeroed.
+		Throws MeshArenaFullExc if there isn't a free range large enough for its vertices or indices, or the arena already holds getMaxMeshes() meshes. **/
+	MeshId		add( const TriMesh &mesh );
+	//! Removes mesh \a id, freeing its ranges for later meshes. Its id may be reused.
+	void		remove( MeshId id );
+	//! Returns whether \a id is a mesh currently in the arena
+	bool		contains( MeshId id ) const { return ( id < mMeshes.size() ) && mMeshes[id].mInUse; }
+
+	//! Sets whether mesh \a id is drawn by draw(). Meshes are visible when added.
+	void		setVisible( MeshId id, bool visible ) { mMeshes[id].mVisible = visible; }
+	bool		isVisible( MeshId id ) const { return mMeshes[id].mVisible; }
+	//! Sets the transform of mesh \a id stored in getTransformTexture(). Meshes have the identity transform when added.
+	void		setTransform( MeshId id, const Matrix44f &transform );
+	const Matrix44f&	getTransform( MeshId id ) const { return mMeshes[id].mTransform; }
+
+	/** Draws every visible mesh with a single \c glMultiDrawElements() call, using the current matrices for all of them.
+		Mesh transforms are applied only by a shader which reads them from getTransformTexture(), after setMeshIdLocation(). **/
+	void		draw();
+	//! Draws only the meshes in \a ids with a single \c glMultiDrawElements() call
+	void		draw( const std::vector<MeshId> &ids );
+	/** Draws every visible mesh with its transform multiplied onto the \c MODELVIEW matrix, for the fixed function pipeline.
+		This still binds the buffers once but issues a draw call per mesh. **/
+	void		drawTransformed();
+
+	/** Sets the location of the shader attribute which receives each vertex's MeshId as a \c float, or \c -1 to disable it. Default \c -1
+		A vertex shader then finds its mesh's transform in the 4 texels of row \c id of getTransformTexture(), which hold the columns of the matrix:
+		\code mat4( texture2DLod( transforms, vec2( 0.125, ( id + 0.5 ) / height ), 0.0 ), ... ) \endcode **/
+	void		setMeshIdLocation( GLint location ) { mMeshIdLocation = location; }
+	GLint		getMeshIdLocation() const { return mMeshIdLocation; }
+	/** Returns the \c GL_RGBA32F_ARB texture, 4 texels wide and getMaxMeshes() tall, holding the transform of each mesh.
+		Transforms changed by setTransform() are uploaded here, created on first use. **/
+	const Texture&	getTransformTexture();
+
+	const Format&	getFormat() const { return mFormat; }
+	//! Returns the number of meshes in the arena
+	size_t		getNumMeshes() const { return mNumMeshes; }
+	//! Returns the number of vertices not allocated to any mesh, possibly fragmented across several ranges
+	size_t		getNumFreeVertices() const;
+	//! Returns the number of indices not allocated to any mesh, possibly fragmented across several ranges
+	size_t		getNumFreeIndices() const;
+
+	const Vbo&	getVertexVbo() const { return mVertexVbo; }
+	const Vbo&	getIndexVbo() const { return mIndexVbo; }
+
+  protected:
+	MeshArena( const Format &format );
+
+	struct Mesh {
+		Mesh() : mInUse( false ), mVisible( false ), mVertexOffset( 0 ), mNumVertices( 0 ), mIndexOffset( 0 ), mNumIndices( 0 ) {}
+
+		bool		mInUse, mVisible;
+		size_t		mVertexOffset, mNumVertices;
+		size_t		mIndexOffset, mNumIndices;
+		Matrix44f	mTransform;
+	};
+
+	void		bind();
+	void		unbind();
+	void		multiDraw( const std::vector<GLsizei> &counts, const std::vector<const GLvoid*> &offsets );
+	void		updateTransformTexture();
+
+	Format						mFormat;
+	size_t						mStride, mNormalOffset, mTexCoordOffset, mColorOffset, mMeshIdOffset;
+	Vbo							mVertexVbo, mIndexVbo;
+	std::map<size_t,size_t>		mFreeVertices, mFreeIndices;	// offset to size of each free range
+	std::vector<Mesh>			mMeshes;
+	std::vector<MeshId>			mFreeIds;
+	size_t						mNumMeshes;
+	GLint						mMeshIdLocation;
+
+	Texture						mTransformTexture;
+	std::vector<float>			mTransformData;
+	size_t						mDirtyBegin, mDirtyEnd;		// the range of rows of mTransformData not yet uploaded
+};
+
+class MeshArenaExc : public std::exception {
+  public:
+	virtual const char* what() const throw() { return "MeshArena exception"; }
+};
+
+class MeshArenaFullExc : public MeshArenaExc {
+  public:
+	virtual const char* what() const throw() { return "MeshArena exception: not enough free space for the mesh"; }
+};
+
+} } // namespace cinder::gl
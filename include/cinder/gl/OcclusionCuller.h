@@ -0,0 +1,110 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/gl/gl.h"
+#include "cinder/AxisAlignedBox.h"
+#include "cinder/Camera.h"
+
+#include <vector>
+
+namespace cinder { namespace gl {
+
+/** \brief Culls boxes hidden behind already drawn geometry with \c GL_SAMPLES_PASSED occlusion queries, combined with Frustum culling.
+	cull() decides visibility from the most recent query results the GPU has finished, so it never waits on the GPU; the price is that a box which comes into view
+	is drawn a frame or so late. After drawing what cull() found visible, call issueQueries() to test the boxes for the frames to come. Visible boxes are only
+	retested every getVisibleQueryInterval() frames, while hidden boxes are tested every frame. Boxes can come from TriMesh::calcBoundingBox(). \ImplShared **/
+class OcclusionCuller {
+  public:
+	OcclusionCuller() {}
+	//! Creates a culler which retests visible boxes every \a visibleQueryInterval frames
+	explicit OcclusionCuller( uint32_t visibleQueryInterval );
+
+	/** Culls a hierarchy of \a count boxes laid out as for Frustum::cullHierarchy(), setting the bit of each visible box in \a visibility.
+		The descendants of a hidden box are hidden without being tested, and a box whose children in view are all hidden is tested in their place from then on.
+		The same hierarchy should be passed every frame, as the culler keeps the state of each box by its index. **/
+	void	cull( const Camera &camera, const AxisAlignedBox3f *boxes, const uint32_t *firstChild, const uint32_t *numChildren, size_t count, uint32_t *visibility );
+	//! Culls \a count independent boxes, setting the bit of each visible box in \a visibility, laid out as for the batch Frustum::intersects()
+	void	cull( const Camera &camera, const AxisAlignedBox3f *boxes, size_t count, uint32_t *visibility );
+	/** Draws the boxes chosen by the last cull() into occlusion queries, with color and depth writes, lighting, texturing and face culling disabled.
+		Call it after drawing the visible geometry, with the same matrices and no shader bound. **/
+	void	issueQueries();
+
+	//! Sets the number of samples a box may pass and still count as hidden. Default \c 0
+	void		setSampleThreshold( GLuint threshold ) { mObj->mSampleThreshold = threshold; }
+	GLuint		getSampleThreshold() const { return mObj->mSampleThreshold; }
+	//! Returns the number of frames between the tests of a visible box
+	uint32_t	getVisibleQueryInterval() const { return mObj->mVisibleQueryInterval; }
+	//! Returns the number of queries the last issueQueries() issued
+	size_t		getNumQueriesIssued() const { return mObj->mNumQueriesIssued; }
+	//! Returns the number of boxes currently considered hidden by their latest query
+	size_t		getNumOccluded() const;
+
+	//! Returns whether the driver supports \c GL_ARB_occlusion_query
+	static bool	isSupported();
+
+  protected:
+	struct Node {
+		Node() : mQuery( 0 ), mPending( false ), mOccluded( false ) {}
+
+		GLuint		mQuery;
+		bool		mPending, mOccluded;
+	};
+
+	struct Obj {
+		Obj( uint32_t visibleQueryInterval );
+		~Obj();
+
+		std::vector<Node>				mNodes;
+		std::vector<uint8_t>			mPlaneCache;
+		std::vector<uint32_t>			mFrustumVisibility;
+		std::vector<uint32_t>			mQueryNodes;	// chosen by cull() for issueQueries()
+		std::vector<AxisAlignedBox3f>	mQueryBoxes;
+		uint32_t						mVisibleQueryInterval, mFrame;
+		GLuint							mSampleThreshold;
+		size_t							mNumQueriesIssued;
+		Vec3f							mEyePoint;
+		float							mNearMargin;
+	};
+
+	void	resize( size_t count );
+	void	collect( const uint32_t *firstChild, const uint32_t *numChildren );
+	void	prepare( const Camera &camera, size_t count, uint32_t *visibility );
+	void	visit( uint32_t node, const AxisAlignedBox3f *boxes, const uint32_t *firstChild, const uint32_t *numChildren, uint32_t *visibility );
+	void	reveal( uint32_t node, const uint32_t *firstChild, const uint32_t *numChildren );
+
+	std::shared_ptr<Obj>	mObj;
+
+  public:
+ 	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<Obj> OcclusionCuller::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &OcclusionCuller::mObj; }
+	void reset() { mObj.reset(); }
+	//@}
+};
+
+} } // namespace cinder::gl
@@ -0,0 +1,64 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/ParticleSystem.h"
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class ParticleMesh>	ParticleMeshRef;
+
+/** \brief Draws a ParticleSystem as points from a VboMesh, streaming the particles' positions and colors into it every frame.
+	The VboMesh cycles through several dynamic buffers, so that filling one never waits on the GPU drawing from another, and the copy
+	is split across the particle system's JobSystem. The buffers grow as the particle count does. **/
+class ParticleMesh {
+  public:
+	//! Creates a mesh with room for \a capacity particles, cycling through \a numBuffers dynamic buffers
+	static ParticleMeshRef	create( size_t capacity = 65536, size_t numBuffers = 3 ) { return ParticleMeshRef( new ParticleMesh( capacity, numBuffers ) ); }
+
+	//! Copies the positions and colors of \a particles into the next dynamic buffer
+	void		update( const ParticleSystem &particles );
+	//! Draws the particles copied by the last update() as \c GL_POINTS
+	void		draw() const;
+
+	//! Returns the number of particles copied by the last update()
+	size_t		getNumParticles() const { return mNumParticles; }
+	//! Returns the number of particles the buffers hold before they have to grow
+	size_t		getCapacity() const { return mVboMesh.getNumVertices(); }
+	const VboMesh&	getVboMesh() const { return mVboMesh; }
+
+  protected:
+	ParticleMesh( size_t capacity, size_t numBuffers );
+
+	//! Replaces the VboMesh with one of \a capacity vertices
+	void		allocate( size_t capacity );
+
+	VboMesh		mVboMesh;
+	size_t		mNumBuffers, mNumParticles;
+};
+
+} } // namespace cinder::gl
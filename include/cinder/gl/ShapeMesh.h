@@ -0,0 +1,83 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Shape2d.h"
+#include "cinder/Triangulate.h"
+#include "cinder/gl/Vbo.h"
+
+namespace cinder { namespace gl {
+
+/** \brief Caches the tessellation of a Shape2d's fill or stroke in a TriMesh2d and a static VboMesh.
+	Unlike gl::drawSolid(), which re-runs the Triangulator on every call, a ShapeMesh tessellates once and re-tessellates only when update() is passed a Shape2d which differs from the one it last tessellated. **/
+class ShapeMesh {
+ protected:
+	struct Obj;
+
+ public:
+	ShapeMesh() {}
+	//! Tessellates the interior of \a shape, as gl::drawSolid() would. \a approximationScale represents how smooth the tesselation is, with 1.0 corresponding to 1:1 with screen space
+	explicit ShapeMesh( const Shape2d &shape, Triangulator::Winding winding = Triangulator::WINDING_ODD, float approximationScale = 1.0f );
+	//! Tessellates the outline of \a shape as a stroke of \a format's width, joins and caps. \a approximationScale represents how smooth the tesselation is, with 1.0 corresponding to 1:1 with screen space
+	ShapeMesh( const Shape2d &shape, const StrokeTriangulator::Format &format, float approximationScale = 1.0f );
+
+	//! Re-tessellates if \a shape differs from the Shape2d last tessellated. Returns whether it did.
+	bool	update( const Shape2d &shape );
+
+	//! Draws the cached tessellation
+	void	draw() const;
+
+	//! Returns whether the ShapeMesh tessellates its Shape2d's outline rather than its interior
+	bool								isStroke() const { return mObj->mStroke; }
+	const Shape2d&						getShape() const { return mObj->mShape; }
+	const TriMesh2d&					getTriMesh() const { return mObj->mTriMesh; }
+	//! Returns the VboMesh holding the tessellation, which is empty if it has no triangles. OpenGL ES builds draw the TriMesh2d instead and leave it empty.
+	const VboMesh&						getVboMesh() const { return mObj->mVboMesh; }
+
+	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<Obj> ShapeMesh::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &ShapeMesh::mObj; }
+	void reset() { mObj.reset(); }
+	//@}
+
+ protected:
+	void	tessellate();
+
+	struct Obj {
+		Shape2d							mShape;
+		bool							mStroke;
+		Triangulator::Winding			mWinding;
+		StrokeTriangulator::Format		mStrokeFormat;
+		float							mApproximationScale;
+		TriMesh2d						mTriMesh;
+		VboMesh							mVboMesh;
+	};
+
+	std::shared_ptr<Obj>		mObj;
+};
+
+} } // namespace cinder::gl
@@ -0,0 +1,103 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/gl/gl.h"
+
+#include <map>
+
+namespace cinder { namespace gl {
+
+/** \brief Remembers the GL state Cinder has set on each context and drops calls which would not change it.
+	Blending, depth, texture, program, framebuffer and buffer bindings issued by Cinder all pass through here. The cache is disabled by default, in which case every call is forwarded to GL unchanged.
+	Once enabled, any of this state changed through raw GL calls must be followed by a call to invalidate(). **/
+class StateCache {
+  public:
+	//! Enables or disables filtering for all contexts. Disabling also invalidates every context's cache.
+	static void		setEnabled( bool enable = true );
+	//! Returns whether redundant calls are being filtered
+	static bool		isEnabled() { return sEnabled; }
+
+	//! Returns the cache for the current GL context, creating it if necessary
+	static StateCache&	current();
+
+	//! Forgets everything known about the current context's state, forcing the next call of each kind through to GL
+	static void		invalidate();
+
+	static void		enable( GLenum cap );
+	static void		disable( GLenum cap );
+	static void		enable( GLenum cap, bool enable ) { if( enable ) StateCache::enable( cap ); else disable( cap ); }
+	static void		blendFunc( GLenum sfactor, GLenum dfactor );
+	static void		depthMask( GLboolean flag );
+	//! Binds \a textureId to \a target on the active texture unit
+	static void		bindTexture( GLenum target, GLuint textureId );
+	//! Binds \a textureId to \a target on \a textureUnit, leaving GL_TEXTURE0 active afterwards
+	static void		bindTexture( GLenum target, GLuint textureId, GLuint textureUnit );
+	static void		activeTexture( GLuint textureUnit );
+	static void		useProgram( GLuint program );
+	//! \a target may be GL_FRAMEBUFFER_EXT, or on the desktop GL_READ_FRAMEBUFFER_EXT or GL_DRAW_FRAMEBUFFER_EXT
+	static void		bindFramebuffer( GLenum target, GLuint framebuffer );
+	static void		bindBuffer( GLenum target, GLuint buffer );
+
+	//! Must be called after deleting GL objects so that a recycled name is not mistaken for a binding which is already in place
+	static void		textureDeleted( GLuint textureId );
+	static void		programDeleted( GLuint program );
+	static void		framebufferDeleted( GLuint framebuffer );
+	static void		bufferDeleted( GLuint buffer );
+
+	//! Returns the number of calls the current context's cache has dropped as redundant
+	uint32_t	getNumFiltered() const { return mNumFiltered; }
+	//! Returns the number of calls the current context's cache has forwarded to GL
+	uint32_t	getNumIssued() const { return mNumIssued; }
+	void		resetCounters() { mNumFiltered = mNumIssued = 0; }
+
+  protected:
+	StateCache();
+
+	void		reset();
+	//! Returns true and counts the call as filtered if \a *cached already equals \a value, otherwise stores \a value and counts the call as issued
+	bool		filter( GLint *cached, GLint value );
+	GLint*		textureSlot( GLuint unit, GLenum target );
+
+	static const GLint		UNKNOWN = -1;
+	static const GLuint		MAX_TEXTURE_UNITS = 16;
+
+	std::map<GLenum,GLint>	mCaps;
+	GLint		mBlendSrc, mBlendDst;
+	GLint		mDepthMask;
+	GLint		mActiveTexture;
+	// bindings for GL_TEXTURE_2D, GL_TEXTURE_RECTANGLE_ARB and GL_TEXTURE_CUBE_MAP on each unit
+	GLint		mTextures[MAX_TEXTURE_UNITS][3];
+	GLint		mProgram;
+	GLint		mReadFramebuffer, mDrawFramebuffer;
+	GLint		mArrayBuffer, mElementArrayBuffer;
+
+	uint32_t	mNumFiltered, mNumIssued;
+
+	static bool		sEnabled;
+};
+
+} } // namespace cinder::gl
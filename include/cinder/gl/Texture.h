@@ -48,10 +48,15 @@ class Texture {
 	/** \brief Constructs a texture based on the contents of \a surface. A default value of -1 for \a internalFormat chooses an appropriate internal format automatically. **/
 	Texture( const Surface8u &surface, Format format = Format() );
 	/** \brief Constructs a texture based on the contents of \a surface. A default value of -1 for \a internalFormat chooses an appropriate internal format automatically. **/
+	Texture( const Surface16u &surface, Format format = Format() );
+	/** \brief Constructs a texture based on the contents of \a surface. A default value of -1 for \a internalFormat chooses an appropriate internal format automatically.
+		Half float internal formats such as \c GL_RGBA16F_ARB are converted to half floats before uploading, which halves the data handed to the driver. **/
 	Texture( const Surface32f &surface, Format format = Format() );
 	/** \brief Constructs a texture based on the contents of \a channel. A default value of -1 for \a internalFormat chooses an appropriate internal format automatically. **/
 	Texture( const Channel8u &channel, Format format = Format() );
 	/** \brief Constructs a texture based on the contents of \a channel. A default value of -1 for \a internalFormat chooses an appropriate internal format automatically. **/
+	Texture( const Channel16u &channel, Format format = Format() );
+	/** \brief Constructs a texture based on the contents of \a channel. A default value of -1 for \a internalFormat chooses an appropriate internal format automatically. **/
 	Texture( const Channel32f &channel, Format format = Format() );
 	/** \brief Constructs a texture based on \a imageSource. A default value of -1 for \a internalFormat chooses an appropriate internal format based on the contents of \a imageSource. **/
 	Texture( ImageSourceRef imageSource, Format format = Format() );
@@ -80,17 +85,30 @@ class Texture {
 	/** Designed to accommodate texture where not all pixels are "clean", meaning the maximum texture coordinate value may not be 1.0 (or the texture's width in \c GL_TEXTURE_RECTANGLE_ARB) **/
 	void			setCleanTexCoords( float maxU, float maxV );
 
-	//! Replaces the pixels of a texture with contents of \a surface. Expects \a surface's size to match the Texture's.
+	/** Replaces the pixels of a texture with contents of \a surface. Expects \a surface's size to match the Texture's.
+		If \a surface is dirty tracking, uploads only its dirty Areas and then clears them. \sa SurfaceT::setDirtyTracking() **/
 	void			update( const Surface &surface );
 	//! Replaces the pixels of a texture with contents of \a surface. Expects \a surface's size to match the Texture's.
+	void			update( const Surface16u &surface );
+	//! Replaces the pixels of a texture with contents of \a surface. Expects \a surface's size to match the Texture's. Converts to half floats first for half float internal formats.
 	void			update( const Surface32f &surface );
-	/** \brief Replaces the pixels of a texture with contents of \a surface. Expects \a area's size to match the Texture's.
+	/** \brief Replaces the pixels of the Area \a area of a texture with the same Area of \a surface.
 		\todo Method for updating a subrectangle with an offset into the source **/
 	void			update( const Surface &surface, const Area &area );
 	//! Replaces the pixels of a texture with contents of \a channel. Expects \a channel's size to match the Texture's.
 	void			update( const Channel32f &channel );
 	//! Replaces the pixels of a texture with contents of \a channel. Expects \a area's size to match the Texture's.
 	void			update( const Channel8u &channel, const Area &area );
+	/** \brief Uploads \a levels, such as the result of ip::buildPyramid(), as the Texture's mip chain starting from level 0, which must match the Texture's size.
+		Each level must be half the size of the one before, rounding down and no smaller than 1. The Texture's maximum mip level is set to the last level uploaded.
+		Sampling the levels requires a mipmapped min filter such as \c GL_LINEAR_MIPMAP_LINEAR. **/
+	void			updateMipmaps( const std::vector<Surface8u> &levels );
+	//! Uploads \a levels as the Texture's mip chain. \sa updateMipmaps( const std::vector<Surface8u>& )
+	void			updateMipmaps( const std::vector<Surface32f> &levels );
+	//! Uploads \a levels, which must be planar, as the Texture's mip chain. \sa updateMipmaps( const std::vector<Surface8u>& )
+	void			updateMipmaps( const std::vector<Channel8u> &levels );
+	//! Uploads \a levels, which must be planar, as the Texture's mip chain. \sa updateMipmaps( const std::vector<Surface8u>& )
+	void			updateMipmaps( const std::vector<Channel32f> &levels );
 	
 	//! the width of the texture in pixels
 	GLint			getWidth() const;
@@ -143,6 +161,9 @@ class Texture {
 
 	//!	Creates a new Texture from raw DirectDraw Stream data
 	static Texture	loadDds( IStreamRef ddsStream, Format format );
+	/**	Creates a new Texture from a Khronos KTX stream, including its mip chain. Compressed formats such as ETC1, ETC2, BC6H and BC7 are uploaded as-is,
+		so they must be supported by the driver. Only 2D textures are supported. Returns an empty Texture if the stream isn't a supported KTX file. **/
+	static Texture	loadKtx( IStreamRef ktxStream, Format format );
 
 	//! Converts a SurfaceChannelOrder into an appropriate OpenGL dataFormat and type
 	static void		SurfaceChannelOrderToDataFormatAndType( const SurfaceChannelOrder &sco, GLint *dataFormat, GLenum *type );
@@ -228,10 +249,13 @@ class Texture {
 	void	init( ImageSourceRef imageSource, const Format &format );	
 		 	
 	struct Obj {
-		Obj() : mWidth( -1 ), mHeight( -1 ), mCleanWidth( -1 ), mCleanHeight( -1 ), mInternalFormat( -1 ), mTextureID( 0 ), mFlipped( false ), mDeallocatorFunc( 0 ) {}
-		Obj( int aWidth, int aHeight ) : mInternalFormat( -1 ), mWidth( aWidth ), mHeight( aHeight ), mCleanWidth( aWidth ), mCleanHeight( aHeight ), mFlipped( false ), mTextureID( 0 ), mDeallocatorFunc( 0 )  {}
+		Obj() : mWidth( -1 ), mHeight( -1 ), mCleanWidth( -1 ), mCleanHeight( -1 ), mInternalFormat( -1 ), mTextureID( 0 ), mFlipped( false ), mDeallocatorFunc( 0 ), mAllocatedBytes( 0 ) {}
+		Obj( int aWidth, int aHeight ) : mInternalFormat( -1 ), mWidth( aWidth ), mHeight( aHeight ), mCleanWidth( aWidth ), mCleanHeight( aHeight ), mFlipped( false ), mTextureID( 0 ), mDeallocatorFunc( 0 ), mAllocatedBytes( 0 )  {}
 		~Obj();
 
+		//! Replaces the storage accounted to the texture in GpuMemory with \a bytes
+		void			setAllocatedBytes( size_t bytes );
+
 		mutable GLint	mWidth, mHeight, mCleanWidth, mCleanHeight;
 		float			mMaxU, mMaxV;
 		mutable GLint	mInternalFormat;
@@ -241,6 +265,7 @@ class Texture {
 		bool			mFlipped;	
 		void			(*mDeallocatorFunc)(void *refcon);
 		void			*mDeallocatorRefcon;			
+		size_t			mAllocatedBytes;
 	};
 	std::shared_ptr<Obj>		mObj;
 
@@ -0,0 +1,150 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/Surface.h"
+
+#include <vector>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class TextureAtlas>	TextureAtlasRef;
+
+/** \brief Packs many small Surfaces into a few large Textures so that they can be drawn without rebinding.
+	Each call to add() places its Surface on the first page with room for it, using a skyline packer, and returns a Region describing where it landed.
+	A new page is created whenever no existing page has room. **/
+class TextureAtlas {
+  public:
+	class Format {
+	  public:
+		Format() : mTextureWidth( 1024 ), mTextureHeight( 1024 ), mPadding( 1 ), mMipmapping( false )
+		{}
+
+		//! Sets the width of the textures created internally for pages. Default \c 1024
+		Format&		textureWidth( int32_t textureWidth ) { mTextureWidth = textureWidth; return *this; }
+		//! Returns the width of the textures created internally for pages. Default \c 1024
+		int32_t		getTextureWidth() const { return mTextureWidth; }
+		//! Sets the height of the textures created internally for pages. Default \c 1024
+		Format&		textureHeight( int32_t textureHeight ) { mTextureHeight = textureHeight; return *this; }
+		//! Returns the height of the textures created internally for pages. Default \c 1024
+		int32_t		getTextureHeight() const { return mTextureHeight; }
+
+		//! Sets the number of pixels around each Region which are filled with its edge pixels, preventing neighbors from bleeding in when filtering. Default \c 1
+		Format&		padding( int32_t padding ) { mPadding = padding; return *this; }
+		//! Returns the number of pixels of padding around each Region. Default \c 1
+		int32_t		getPadding() const { return mPadding; }
+
+		//! Enables or disables mipmapping. Default is disabled.
+		Format&		enableMipmapping( bool enable = true ) { mMipmapping = enable; return *this; }
+		//! Returns whether the page textures have mipmapping enabled
+		bool		hasMipmapping() const { return mMipmapping; }
+
+	  protected:
+		int32_t		mTextureWidth, mTextureHeight;
+		int32_t		mPadding;
+		bool		mMipmapping;
+	};
+
+	//! The location of an image within a TextureAtlas. Holds a reference to its page's Texture, so it remains drawable independently of the atlas.
+	class Region {
+	  public:
+		Region() : mTextureIndex( 0 ) {}
+		Region( const Texture &texture, size_t textureIndex, const Area &area )
+			: mTexture( texture ), mTextureIndex( textureIndex ), mArea( area ), mTexCoords( texture.getAreaTexCoords( area ) )
+		{}
+
+		//! Returns the Texture of the page the Region lives on
+		const Texture&	getTexture() const { return mTexture; }
+		//! Returns the index of the page the Region lives on
+		size_t			getTextureIndex() const { return mTextureIndex; }
+		//! Returns the pixels of the page the Region occupies, excluding padding
+		const Area&		getArea() const { return mArea; }
+		//! Returns the texture coordinates of the Region, suitable for the page's Texture
+		const Rectf&	getTexCoords() const { return mTexCoords; }
+		int32_t			getWidth() const { return mArea.getWidth(); }
+		int32_t			getHeight() const { return mArea.getHeight(); }
+		Vec2i			getSize() const { return mArea.getSize(); }
+
+		//! Emulates shared_ptr-like behavior
+		operator Texture::unspecified_bool_type() const { return mTexture; }
+
+	  protected:
+		Texture		mTexture;
+		size_t		mTextureIndex;
+		Area		mArea;
+		Rectf		mTexCoords;
+	};
+
+	//! Creates a new, empty TextureAtlasRef with format \a format
+	static TextureAtlasRef	create( const Format &format = Format() ) { return TextureAtlasRef( new TextureAtlas( format ) ); }
+
+	/** Copies \a surface into the atlas and returns the Region it occupies. Throws TextureDataExc if \a surface plus its padding is larger than a page.
+		A Surface without an alpha channel is stored opaque. **/
+	Region		add( const Surface8u &surface );
+	//! Returns whether a \a width x \a height image fits on a page, with the atlas' padding
+	bool		fits( int32_t width, int32_t height ) const;
+
+	//! Returns the number of page Textures in the atlas
+	size_t			getNumTextures() const { return mPages.size(); }
+	//! Returns the page Texture at index \a index
+	const Texture&	getTexture( size_t index ) const { return mPages[index].mTexture; }
+	//! Returns the fraction of the pixels across all pages which are occupied, including padding
+	float			getOccupancy() const;
+	const Format&	getFormat() const { return mFormat; }
+
+	/** Draws each of \a regions in the corresponding rectangle of \a destRects, binding each page only once.
+		Regions from other atlases are drawn too, though each of their Textures is bound separately. **/
+	void	draw( const std::vector<Region> &regions, const std::vector<Rectf> &destRects ) const;
+
+  protected:
+	TextureAtlas( const Format &format );
+
+	struct SkylineNode {
+		SkylineNode( int32_t x, int32_t y, int32_t width ) : mX( x ), mY( y ), mWidth( width ) {}
+		int32_t		mX, mY, mWidth;
+	};
+
+	struct Page {
+		Texture						mTexture;
+		std::vector<SkylineNode>	mSkyline;
+		int64_t						mUsedPixels;
+	};
+
+	void	addPage();
+	bool	pack( Page *page, int32_t width, int32_t height, Vec2i *result );
+
+	Format				mFormat;
+	std::vector<Page>	mPages;
+};
+
+//! Draws \a region of its TextureAtlas on the XY-plane in the rectangle defined by \a destRect
+void draw( const TextureAtlas::Region &region, const Rectf &destRect );
+//! Draws \a region of its TextureAtlas on the XY-plane at \a pos, at its original size
+void draw( const TextureAtlas::Region &region, const Vec2f &pos );
+
+} } // namespace cinder::gl
@@ -25,8 +25,13 @@
 #include "cinder/Cinder.h"
 #include "cinder/Text.h"
 #include "cinder/Font.h"
+#include "cinder/Filesystem.h"
 #include "cinder/gl/Texture.h"
+#if ! defined( CINDER_GLES )
+	#include "cinder/gl/GlslProg.h"
+#endif
 
+#include <algorithm>
 #include <map>
 #include <boost/unordered_map.hpp>
 
@@ -38,7 +43,7 @@ class TextureFont {
   public:
 	class Format {
 	  public:
-		Format() : mTextureWidth( 1024 ), mTextureHeight( 1024 ), mPremultiply( false ), mMipmapping( false )
+		Format() : mTextureWidth( 1024 ), mTextureHeight( 1024 ), mPremultiply( false ), mMipmapping( false ), mDynamic( false ), mMaxTextures( 4 ), mSignedDistanceField( false ), mDistanceFieldSpread( 4 ), mCompressCache( true )
 		{}
 		
 		//! Sets the width of the textures created internally for glyphs. Default \c 1024
@@ -59,11 +64,50 @@ class TextureFont {
 		Format&		enableMipmapping( bool enable = true ) { mMipmapping = enable; return *this; }
 		//! Returns whether the TextureFont texture has mipmapping enabled
 		bool		hasMipmapping() const { return mMipmapping; }
+
+		/** Sets whether glyphs are rasterized the first time they are drawn, rather than all of \a supportedChars up front. Default \c false.
+			Suits large character sets such as CJK: creation costs nothing, and when more than getMaxTextures() textures would be needed, the least recently drawn one is emptied and reused.
+			Mipmapping is not supported by dynamic TextureFonts. **/
+		Format&		dynamic( bool dynamic = true ) { mDynamic = dynamic; return *this; }
+		//! Returns whether glyphs are rasterized the first time they are drawn. Default \c false
+		bool		isDynamic() const { return mDynamic; }
+		//! Sets the maximum number of textures a dynamic TextureFont creates before it evicts the least recently drawn one. Default \c 4
+		Format&		maxTextures( size_t maxTextures ) { mMaxTextures = std::min<size_t>( std::max<size_t>( maxTextures, 1 ), 254 ); return *this; }
+		//! Returns the maximum number of textures a dynamic TextureFont creates. Default \c 4
+		size_t		getMaxTextures() const { return mMaxTextures; }
+
+		/** Sets whether glyphs are stored as signed distance fields rather than coverage, so that one TextureFont stays sharp across a wide range of scales. Default \c false.
+			The fields are generated on the CPU from the glyph bitmaps, so the Font should be created large, around 48 points or more. The TextureFont draws
+			with getSignedDistanceFieldShader() unless another GlslProg is bound. Premultiplication and mipmapping have no effect on the textures. **/
+		Format&		signedDistanceField( bool sdf = true ) { mSignedDistanceField = sdf; return *this; }
+		//! Returns whether glyphs are stored as signed distance fields. Default \c false
+		bool		isSignedDistanceField() const { return mSignedDistanceField; }
+		//! Sets the distance in texels from a glyph's edge at which its distance field saturates. Larger values allow wider outlines and glows but need more room. Default \c 4
+		Format&		distanceFieldSpread( int32_t spread ) { mDistanceFieldSpread = std::max<int32_t>( spread, 1 ); return *this; }
+		//! Returns the distance in texels from a glyph's edge at which its distance field saturates. Default \c 4
+		int32_t		getDistanceFieldSpread() const { return mDistanceFieldSpread; }
+
+		/** Sets a directory in which the rasterized glyph textures and metrics are cached, so that later TextureFonts with the same Font, Format and \a supportedChars
+			load them rather than rasterizing every glyph. Each combination has its own file, named for a hash of it. An empty path, the default, disables caching.
+			Ignored by dynamic TextureFonts and under OpenGL ES. **/
+		Format&				cacheDirectory( const fs::path &directory ) { mCacheDirectory = directory; return *this; }
+		//! Returns the directory in which rasterized glyphs are cached, or an empty path if they aren't
+		const fs::path&		getCacheDirectory() const { return mCacheDirectory; }
+		//! Sets whether cached textures are zlib compressed, which shrinks the mostly empty textures many times over for a little more load time. Default \c true
+		Format&				compressCache( bool compress = true ) { mCompressCache = compress; return *this; }
+		//! Returns whether cached textures are zlib compressed. Default \c true
+		bool				getCompressCache() const { return mCompressCache; }
 		
 	  protected:
 		int32_t		mTextureWidth, mTextureHeight;
 		bool		mPremultiply;
 		bool		mMipmapping;
+		bool		mDynamic;
+		size_t		mMaxTextures;
+		bool		mSignedDistanceField;
+		int32_t		mDistanceFieldSpread;
+		fs::path	mCacheDirectory;
+		bool		mCompressCache;
 	};
 
 	struct DrawOptions {
@@ -137,6 +181,15 @@ class TextureFont {
 	float	getDescent() const { return mFont.getDescent(); }
 	//! Returns whether the TextureFont output premultipled output. Default is \c false.
 	bool	isPremultiplied() const { return mFormat.getPremultiply(); }
+	//! Returns the number of times a dynamic TextureFont has emptied a texture to make room, which invalidates glyph texture coordinates cached outside of it
+	uint32_t	getNumEvictions() const { return mNumEvictions; }
+	//! Returns the number of glyphs currently rasterized into the TextureFont's textures
+	size_t		getNumGlyphs() const { return mGlyphMap.size(); }
+#if ! defined( CINDER_GLES )
+	/** Returns the GlslProg which draws the signed distance field glyphs of a TextureFont whose Format requested them, antialiased at any scale.
+		It samples texture unit \c 0 and modulates the current color, premultiplied if the TextureFont is. **/
+	const GlslProg&	getSignedDistanceFieldShader() const;
+#endif
 
 	//! Returns the default set of characters for a TextureFont, suitable for most English text, including some common ligatures and accented vowels.
 	//! \c "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz1234567890().?!,:;'\"&*=+-/\\@#_[]<>%^llflfiphrids"
@@ -145,16 +198,61 @@ class TextureFont {
   protected:
 	TextureFont( const Font &font, const std::string &supportedChars, const Format &format );
 
+	//! The mTextureIndex of a glyph which a dynamic TextureFont could not render, so that it isn't attempted again
+	enum { NO_TEXTURE = 255 };
+
 	struct GlyphInfo {
 		uint8_t		mTextureIndex;
 		Area		mTexCoords;
 		Vec2f		mOriginOffset;
 	};
+
+	// the shelf packing state and recency of one of a dynamic TextureFont's textures
+	struct DynamicTexture {
+		DynamicTexture() : mShelfX( 0 ), mShelfY( 0 ), mShelfHeight( 0 ), mLastUsed( 0 ) {}
+
+		int32_t		mShelfX, mShelfY, mShelfHeight;
+		uint32_t	mLastUsed;
+	};
+
+	//! Rasterizes every glyph necessary to render \a supportedChars into mTextures through the platform's font engine
+	void	bakeGlyphs( const std::string &supportedChars );
+#if ! defined( CINDER_GLES )
+	//! Returns a description of everything which determines the baked glyphs, which identifies a cache file
+	std::string	getCacheKey( const std::string &supportedChars ) const;
+	//! Loads the textures and glyphs cached at \a path, if it was written for \a cacheKey. Returns whether it did.
+	bool	loadCache( const fs::path &path, const std::string &cacheKey );
+	//! Writes the textures and glyphs to \a path, tagged with \a cacheKey. Failures are ignored, since the cache only saves time.
+	void	saveCache( const fs::path &path, const std::string &cacheKey ) const;
+#endif
+	//! Makes sure that every glyph of \a glyphMeasures is rasterized and marks their textures used, for a dynamic TextureFont
+	void	prepareGlyphs( const std::vector<std::pair<uint16_t,Vec2f> > &glyphMeasures ) const;
+	//! Returns the GlyphInfo for \a glyph, rasterizing it first for a dynamic TextureFont. Returns NULL if the glyph can't be rendered.
+	const GlyphInfo*	findGlyph( Font::Glyph glyph ) const;
+	//! Rasterizes \a glyph, as a distance field if requested, and packs it with allocateGlyph(). Used by dynamic and distance field TextureFonts.
+	GlyphInfo&	addGlyph( Font::Glyph glyph ) const;
+	//! Rasterizes \a glyph into \a lumAlpha as \c GL_LUMINANCE_ALPHA pixels of \a size, setting its \a originOffset as the constructor would
+	bool	rasterizeGlyph( Font::Glyph glyph, std::vector<uint8_t> *lumAlpha, Vec2i *size, Vec2f *originOffset ) const;
+#if ! defined( CINDER_GLES )
+	//! Binds getSignedDistanceFieldShader() if the glyphs are distance fields and no other GlslProg is bound. Returns whether it did, so that the caller unbinds it.
+	bool	bindSignedDistanceFieldShader() const;
+#endif
+	//! Finds room for a \a size glyph, creating or, when dynamic, evicting a texture as necessary, and returns its texture index
+	size_t	allocateGlyph( const Vec2i &size, Vec2i *position ) const;
 	
-	boost::unordered_map<Font::Glyph, GlyphInfo>	mGlyphMap;
-	std::vector<gl::Texture>						mTextures;
+	// mutable as a dynamic TextureFont rasterizes glyphs on demand, even when only measuring
+	mutable boost::unordered_map<Font::Glyph, GlyphInfo>	mGlyphMap;
+	mutable std::vector<gl::Texture>						mTextures;
+	mutable std::vector<DynamicTexture>						mDynamicTextures;
+	mutable size_t											mCurrentDynamicTexture; // the only texture with room left
+	mutable uint32_t										mUseCount, mNumEvictions;
+#if ! defined( CINDER_GLES )
+	mutable GlslProg										mSdfShader;
+#endif
 	Font											mFont;
 	Format											mFormat;
+
+	friend class TextureFontBatch;
 };
 
 } } // namespace cinder::gl
\ No newline at end of file
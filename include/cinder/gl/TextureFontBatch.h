@@ -0,0 +1,138 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/gl/TextureFont.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/Color.h"
+#include "cinder/MatrixAffine2.h"
+
+#include <string>
+#include <vector>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class TextureFontBatch>	TextureFontBatchRef;
+
+/** \brief Draws many strings of a TextureFont with one draw call per glyph texture.
+	The drawString() calls made between flush()es are compared in order against those of the previous flush(), and only the strings which differ
+	are laid out again, so a display whose labels mostly stay the same pays only for the ones which change. Changing only the color or the transform of a string
+	regenerates its vertices but not its layout. The glyph quads of every string are kept in one persistent vertex buffer for each glyph texture,
+	of which only the changed range is uploaded. Each string's color is that of the last call to color(), and its positions are transformed by the last call to setTransform(). **/
+class TextureFontBatch {
+  public:
+	//! Creates a new, empty TextureFontBatchRef drawing with \a font
+	static TextureFontBatchRef	create( const TextureFontRef &font ) { return TextureFontBatchRef( new TextureFontBatch( font ) ); }
+
+	//! Returns the TextureFont the batch draws with
+	const TextureFontRef&	getFont() const { return mFont; }
+
+	//! Sets the color of subsequent strings. Default is opaque white.
+	void				color( const ColorA &color ) { mColor = ColorA8u( color ); }
+	//! Sets the color of subsequent strings. Default is opaque white.
+	void				color( float r, float g, float b, float a = 1.0f ) { color( ColorA( r, g, b, a ) ); }
+	//! Returns the color of subsequent strings
+	ColorA				getColor() const { return ColorA( mColor ); }
+	//! Sets the transformation applied to the glyph positions of subsequent strings, after clipping. Default is the identity.
+	void				setTransform( const MatrixAffine2f &transform ) { mTransform = transform; }
+	//! Returns the transformation applied to the glyph positions of subsequent strings
+	const MatrixAffine2f&	getTransform() const { return mTransform; }
+
+	//! Adds string \a str at baseline \a baseline with DrawOptions \a options, as TextureFont::drawString() would draw it
+	void	drawString( const std::string &str, const Vec2f &baseline, const TextureFont::DrawOptions &options = TextureFont::DrawOptions() );
+	//! Adds string \a str fit inside and clipped by \a fitRect, with internal offset \a offset and DrawOptions \a options, as TextureFont::drawString() would draw it
+	void	drawString( const std::string &str, const Rectf &fitRect, const Vec2f &offset = Vec2f::zero(), const TextureFont::DrawOptions &options = TextureFont::DrawOptions() );
+
+	//! Draws the strings added since the last flush(), which are kept to be compared against those of the next
+	void	flush();
+	//! Discards the strings kept from the last flush(), so that every string of the next one is laid out again
+	void	clear();
+
+	//! Returns the number of strings kept from the last flush()
+	size_t	getNumStrings() const { return mStrings.size(); }
+	//! Returns the number of strings the last flush() laid out again
+	size_t	getNumLaidOut() const { return mNumLaidOut; }
+	//! Returns the number of draw calls issued by the last flush()
+	size_t	getNumDrawCalls() const { return mNumDrawCalls; }
+
+  protected:
+	TextureFontBatch( const TextureFontRef &font );
+
+	struct Vertex {
+		Vec2f		mPosition;
+		Vec2f		mTexCoord;
+		ColorA8u	mColor;
+	};
+
+	struct Quad {
+		Rectf		mDestRect, mTexCoords;
+	};
+
+	struct String {
+		String() : mFit( false ), mLayoutChanged( true ), mVerticesChanged( true ) {}
+
+		//! Returns whether \a rhs would be laid out identically
+		bool	isLayoutEqual( const String &rhs ) const;
+
+		std::string					mText;
+		bool						mFit;
+		Rectf						mFitRect;
+		Vec2f						mPosition; // the baseline, or the offset within mFitRect
+		TextureFont::DrawOptions	mOptions;
+		ColorA8u					mColor;
+		MatrixAffine2f				mTransform;
+
+		std::vector<std::vector<Quad> >		mPageQuads; // untransformed glyph quads for each glyph texture
+		std::vector<std::vector<Vertex> >	mPageVertices;
+		std::vector<size_t>					mPageOffsets; // where mPageVertices was last copied into each Page
+		bool								mLayoutChanged, mVerticesChanged;
+	};
+
+	struct Page {
+		Page() : mVboSize( 0 ) {}
+
+		std::vector<Vertex>		mVertices; // every string's vertices for one glyph texture
+		Vbo						mVbo; // unused on OpenGL ES, which draws from mVertices
+		size_t					mVboSize; // in vertices
+	};
+
+	void	add( const String &str );
+	//! Places the glyphs of \a str, rasterizing them first if the font is dynamic
+	void	layout( String *str ) const;
+	void	updateVertices( String *str ) const;
+
+	TextureFontRef			mFont;
+	ColorA8u				mColor;
+	MatrixAffine2f			mTransform;
+
+	std::vector<String>		mStrings;
+	size_t					mNumAdded; // drawString() calls since the last flush(), matched against mStrings in order
+	std::vector<Page>		mPages;
+	uint32_t				mNumEvictions; // the font's evictions as of the last layout, which invalidate it when they change
+	size_t					mNumLaidOut, mNumDrawCalls;
+};
+
+} } // namespace cinder::gl
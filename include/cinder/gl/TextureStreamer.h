@@ -0,0 +1,86 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/Surface.h"
+
+#include <vector>
+
+namespace cinder { namespace gl {
+
+/** \brief Streams frames into a Texture through a ring of pixel buffer objects, so that uploading doesn't stall the CPU.
+	Each frame is written into a mapped buffer through map(), and upload() then lets the driver copy it into the Texture asynchronously.
+	Frames are BGRA or BGRX, which drivers copy without conversion. In the absence of \c GL_ARB_pixel_buffer_object the frames live in client memory instead. \ImplShared **/
+class TextureStreamer {
+  public:
+	TextureStreamer() {}
+	//! Creates a \a width x \a height Texture using \a format, which is updated through a ring of \a numBuffers pixel buffer objects
+	TextureStreamer( int width, int height, bool alpha = false, Texture::Format format = Texture::Format(), int numBuffers = 3 );
+
+	/** Maps the next buffer of the ring and returns a Surface8u which points directly into it. Fill in the Surface and then call upload().
+		The Surface must not be used after upload(). **/
+	Surface8u		map();
+	//! Unmaps the buffer returned by map() and starts copying it into the Texture
+	void			upload();
+	//! Copies \a surface into the next buffer and uploads it. Only the area \a surface shares with the Texture is copied.
+	void			update( const Surface8u &surface );
+
+	//! Returns the Texture being streamed into
+	const Texture&	getTexture() const { return mObj->mTexture; }
+	//! Returns the number of buffers in the ring, or \c 0 if pixel buffer objects are unsupported
+	int				getNumBuffers() const { return (int)mObj->mBuffers.size(); }
+	//! Returns whether a buffer returned by map() is waiting for upload()
+	bool			isMapped() const { return mObj->mMapped; }
+
+  protected:
+	struct Obj {
+		Obj( int width, int height, bool alpha, Texture::Format format, int numBuffers );
+
+		Texture				mTexture;
+		std::vector<Vbo>	mBuffers;
+		size_t				mNextBuffer;
+		int32_t				mRowBytes;
+		bool				mAlpha, mMapped;
+		Surface8u			mClientSurface; // used in place of mBuffers when pixel buffer objects are unsupported
+	};
+
+	SurfaceChannelOrder		getChannelOrder() const;
+
+	std::shared_ptr<Obj>	mObj;
+
+  public:
+ 	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<Obj> TextureStreamer::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &TextureStreamer::mObj; }
+	void reset() { mObj.reset(); }
+	//@}
+};
+
+} } // namespace cinder::gl
@@ -27,20 +27,35 @@
 #include "cinder/Exception.h"
 #include "cinder/Surface.h"
 #include "cinder/Camera.h"
+#include "cinder/Function.h"
+#include "cinder/gl/AsyncReadback.h"
+#include "cinder/ConcurrentCircularBuffer.h"
+#include "cinder/Thread.h"
 
 namespace cinder { namespace gl {
 
+/** \brief Renders an image larger than the window one window-sized tile at a time.
+	Each tile's pixels are read back asynchronously while the next tile renders, and a worker thread composes the finished tiles into getSurface(). **/
 class TileRender {
   public:
+	//! Receives each finished tile's pixels along with the Area of the image it covers. Called on the worker thread.
+	typedef std::function<void (const Surface8u&, const Area&)>	TileCallback;
+
 	TileRender( int32_t imageWidth, int32_t imageHeight, int32_t tileWidth = 512, int32_t tileHeight = 512 );
 	
+	//! Advances to the next tile, returning \c false once every tile has been rendered and the image is complete
 	bool		nextTile();
 	
 	int32_t		getImageWidth() const { return mImageWidth; }
 	int32_t		getImageHeight() const { return mImageHeight; }
 	float		getImageAspectRatio() const { return mImageWidth / (float)mImageHeight; }
 	Area		getCurrentTileArea() const { return mCurrentArea; }
+	//! Returns the finished image. Empty when a TileCallback has been set.
 	Surface		getSurface() const { return mSurface; }
+
+	/** Passes finished tiles to \a callback instead of composing them into getSurface(), so that images too large for memory can be encoded to disk a tile at a time.
+		Tiles arrive in rendering order. **/
+	void		setTileCallback( const TileCallback &callback ) { mTileCallback = callback; }
 	
 	void		setMatricesWindow( int32_t windowWidth, int32_t windowHeight );
 	void		setMatricesWindow( const Vec2i &windowSize ) { setMatricesWindow( windowSize.x, windowSize.y ); }
@@ -53,7 +68,29 @@ class TileRender {
 	void		ortho( float left, float right, float bottom, float top, float nearPlane, float farPlane );
 	
   protected:
+	// Receives tiles from the AsyncReadback on the render thread and composes them on a worker thread
+	struct Composer {
+		Composer( const Surface &surface, const TileCallback &callback );
+		~Composer();
+
+		void	queue( const Surface8u &pixels, const Area &area );
+		//! Waits until every queued tile has been composed
+		void	finish();
+		void	run();
+
+		struct Tile {
+			Surface8u	mPixels;
+			Area		mArea;
+		};
+
+		Surface								mSurface;
+		TileCallback						mCallback;
+		ConcurrentCircularBuffer<Tile>		mTiles;
+		std::shared_ptr<std::thread>		mThread;
+	};
+
 	void		updateFrustum();
+	void		readCurrentTile();
 
 	int32_t		mImageWidth, mImageHeight;
 	int32_t		mTileWidth, mTileHeight;
@@ -67,6 +104,10 @@ class TileRender {
 	
 	Area		mSavedViewport;
 	Surface		mSurface;
+	TileCallback	mTileCallback;
+
+	AsyncReadback					mReadback;
+	std::shared_ptr<Composer>		mComposer;
 };
 
 } } // namespace cinder::gl
\ No newline at end of file
@@ -0,0 +1,142 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/TiledImage.h"
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/app/AsyncImageLoader.h"
+
+#include <list>
+#include <map>
+#include <set>
+#include <vector>
+
+namespace cinder { namespace gl {
+
+typedef std::shared_ptr<class TiledImageView>	TiledImageViewRef;
+
+/** \brief Draws a TiledImage of any size by streaming in only the tiles visible at the level of detail being drawn.
+	Tiles are decoded on an app::AsyncImageLoader and uploaded into the slots of a few cache Textures, evicting the least recently drawn tiles once the cache's memory budget is full.
+	Tiles which haven't arrived yet are drawn from the nearest coarser level which has. The budget must hold at least a screenful of tiles, or the view can't finish loading. **/
+class TiledImageView {
+  public:
+	class Format {
+	  public:
+		Format() : mCacheBytes( 256 * 1024 * 1024 ), mPageSize( 2048 ), mMaxPendingLoads( 16 ), mMaxUploadsPerDraw( 8 ), mLodBias( 0 )
+		{}
+
+		//! Sets the GPU memory budget of the tile cache in bytes, spent in whole pages. Default 256MB
+		Format&		cacheBytes( size_t cacheBytes ) { mCacheBytes = cacheBytes; return *this; }
+		//! Returns the GPU memory budget of the tile cache in bytes. Default 256MB
+		size_t		getCacheBytes() const { return mCacheBytes; }
+		//! Sets the width and height of the cache Textures tiles are packed into. Default \c 2048
+		Format&		pageSize( int32_t pageSize ) { mPageSize = pageSize; return *this; }
+		//! Returns the width and height of the cache Textures. Default \c 2048
+		int32_t		getPageSize() const { return mPageSize; }
+		//! Sets the maximum number of tiles waiting to be decoded at once. Default \c 16
+		Format&		maxPendingLoads( size_t maxPendingLoads ) { mMaxPendingLoads = maxPendingLoads; return *this; }
+		//! Returns the maximum number of tiles waiting to be decoded at once. Default \c 16
+		size_t		getMaxPendingLoads() const { return mMaxPendingLoads; }
+		//! Sets the maximum number of decoded tiles uploaded by each call to draw(), bounding its cost. Default \c 8
+		Format&		maxUploadsPerDraw( size_t maxUploadsPerDraw ) { mMaxUploadsPerDraw = maxUploadsPerDraw; return *this; }
+		//! Returns the maximum number of decoded tiles uploaded by each call to draw(). Default \c 8
+		size_t		getMaxUploadsPerDraw() const { return mMaxUploadsPerDraw; }
+		//! Sets the number of levels added to the level of detail draw() selects. Positive values draw coarser levels. Default \c 0
+		Format&		lodBias( float lodBias ) { mLodBias = lodBias; return *this; }
+		//! Returns the number of levels added to the level of detail draw() selects. Default \c 0
+		float		getLodBias() const { return mLodBias; }
+		//! Sets the loader tiles are decoded on. Defaults to app::AsyncImageLoader::getDefault()
+		Format&		loader( const app::AsyncImageLoaderRef &loader ) { mLoader = loader; return *this; }
+		//! Returns the loader tiles are decoded on, or NULL for the default
+		const app::AsyncImageLoaderRef&	getLoader() const { return mLoader; }
+
+	  protected:
+		size_t						mCacheBytes;
+		int32_t						mPageSize;
+		size_t						mMaxPendingLoads, mMaxUploadsPerDraw;
+		float						mLodBias;
+		app::AsyncImageLoaderRef	mLoader;
+	};
+
+	//! Creates a view of \a image. No tiles are loaded until it is first drawn.
+	static TiledImageViewRef	create( const TiledImageRef &image, const Format &format = Format() ) { return TiledImageViewRef( new TiledImageView( image, format ) ); }
+
+	/** Draws the pixels \a srcArea of the full image in \a destRect, from the level whose pixels are closest to the size they are drawn at.
+		Uploads tiles which have finished loading, and requests the visible tiles which are missing, nearest the center first.
+		Partially visible tiles are clipped to whole pixels of their level, so up to a pixel of it may be drawn outside \a destRect. **/
+	void	draw( const Area &srcArea, const Rectf &destRect );
+	//! Draws the whole image in \a destRect
+	void	draw( const Rectf &destRect ) { draw( Area( Vec2i::zero(), mImage->getSize() ), destRect ); }
+
+	const TiledImageRef&	getTiledImage() const { return mImage; }
+	//! Returns the number of tiles held in the cache
+	size_t		getNumResidentTiles() const { return mResident.size(); }
+	//! Returns the number of tiles waiting to be decoded or uploaded
+	size_t		getNumPendingTiles() const { return mPending.size(); }
+	//! Returns the number of tiles the cache can hold
+	size_t		getCapacity() const { return mCapacity; }
+
+  protected:
+	TiledImageView( const TiledImageRef &image, const Format &format );
+
+	struct Slot {
+		uint64_t					mKey;
+		size_t						mPage;
+		Vec2i						mOrigin;	// the top left of the slot on its page, including padding
+		Area						mArea;		// the tile's pixels on the page, excluding padding
+		uint32_t					mLastDrawn;
+		std::list<size_t>::iterator	mLruPosition;
+	};
+
+	static uint64_t	tileKey( int32_t level, int32_t col, int32_t row ) { return ( (uint64_t)level << 48 ) | ( (uint64_t)row << 24 ) | (uint64_t)col; }
+
+	void		uploadReady();
+	void		upload( uint64_t key, const Surface8u &surface );
+	int32_t		acquireSlot();
+	void		touch( size_t slot );
+	void		request( int32_t level, int32_t col, int32_t row );
+	Area		getLevelArea( const Area &levelArea, int32_t fromLevel, int32_t toLevel ) const;
+	Rectf		getDestRect( const Area &levelArea, int32_t level, const Area &srcArea, const Rectf &destRect ) const;
+	void		drawTile( const Slot &slot, const Area &tileArea, const Area &levelArea, int32_t level, const Area &srcArea, const Rectf &destRect );
+	void		drawFallback( const Area &levelArea, int32_t level, const Area &srcArea, const Rectf &destRect );
+
+	TiledImageRef								mImage;
+	Format										mFormat;
+	app::AsyncImageLoaderRef					mLoader;
+	int32_t										mSlotStride, mSlotsPerRow;
+	size_t										mCapacity;
+	std::vector<Texture>						mPages;
+	std::vector<Slot>							mSlots;
+	std::list<size_t>							mLru;		// slot indices, most recently drawn first
+	std::map<uint64_t,size_t>					mResident;	// tile key to slot index
+	std::map<uint64_t,app::AsyncSurfaceRef>		mPending;
+	std::set<uint64_t>							mFailed;
+	uint32_t									mFrame;
+};
+
+} } // namespace cinder::gl
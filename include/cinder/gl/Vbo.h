@@ -37,6 +37,10 @@ class Vbo {
 	
 	void		bind();
 	void		unbind();
+	//! Binds the whole buffer to the indexed \a index of its target, such as a GL_UNIFORM_BUFFER binding point
+	void		bindBase( GLuint index );
+	//! Binds \a size bytes starting at \a offset to the indexed \a index of its target
+	void		bindRange( GLuint index, ptrdiff_t offset, size_t size );
 	
 	void		bufferData( size_t size, const void *data, GLenum usage );
 	void		bufferSubData( ptrdiff_t offset, size_t size, const void *data );
@@ -54,6 +58,7 @@ class Vbo {
 
 		GLenum			mTarget;
 		GLuint			mId;
+		size_t			mAllocatedBytes;	// as accounted in GpuMemory
 	};
 	
 	std::shared_ptr<Obj>	mObj;
@@ -74,7 +79,7 @@ class VboMesh {
 	enum { ATTR_MAX_TEXTURE_UNIT = 3 };
 
 	struct Layout {
-		Layout() { initAttributes(); }
+		Layout() : mOptimizeTriMesh( false ), mInterleavedStatic( false ), mIndexType( GL_UNSIGNED_INT ) { initAttributes(); }
 
 		//! \return is the Layout unspecified, presumably TBG by a constructor for VboMesh
 		bool	isDefaults() const { for( int a = 0; a < ATTR_TOTAL; ++a ) if( mAttributes[a] != NONE ) return false; return true; }
@@ -135,19 +140,61 @@ class VboMesh {
 		void	addDynamicCustomVec2f() { mCustomDynamic.push_back( std::make_pair( CUSTOM_ATTR_FLOAT2, 0 ) ); }
 		void	addDynamicCustomVec3f() { mCustomDynamic.push_back( std::make_pair( CUSTOM_ATTR_FLOAT3, 0 ) ); }
 		void	addDynamicCustomVec4f() { mCustomDynamic.push_back( std::make_pair( CUSTOM_ATTR_FLOAT4, 0 ) ); }
+		//! Adds a custom attribute which advances once per instance rather than once per vertex. See gl::drawInstanced().
+		void	addInstanceCustomFloat() { mCustomInstance.push_back( std::make_pair( CUSTOM_ATTR_FLOAT, 0 ) ); }
+		//! Adds a custom attribute which advances once per instance rather than once per vertex. See gl::drawInstanced().
+		void	addInstanceCustomVec2f() { mCustomInstance.push_back( std::make_pair( CUSTOM_ATTR_FLOAT2, 0 ) ); }
+		//! Adds a custom attribute which advances once per instance rather than once per vertex. See gl::drawInstanced().
+		void	addInstanceCustomVec3f() { mCustomInstance.push_back( std::make_pair( CUSTOM_ATTR_FLOAT3, 0 ) ); }
+		//! Adds a custom attribute which advances once per instance rather than once per vertex. A Matrix44f can be passed as four of these. See gl::drawInstanced().
+		void	addInstanceCustomVec4f() { mCustomInstance.push_back( std::make_pair( CUSTOM_ATTR_FLOAT4, 0 ) ); }
+		//! \return are there any per-instance attributes
+		bool	hasInstanceAttributes() const { return ! mCustomInstance.empty(); }
+
+		/** Sets whether a VboMesh constructed from a TriMesh uploads a copy reordered by TriMesh::optimize(), with 16-bit indices when there are few enough vertices. Default \c false.
+			Only the ordering of triangles and vertices changes, so this is safe unless the application relies on vertex numbers. **/
+		void	setOptimizeTriMesh( bool optimize = true ) { mOptimizeTriMesh = optimize; }
+		//! \return whether a VboMesh constructed from a TriMesh optimizes it first
+		bool	getOptimizeTriMesh() const { return mOptimizeTriMesh; }
+
+		/** Sets whether a VboMesh constructed from a vertex count stores its static data interleaved, one vertex after another, rather than one attribute after another. Default \c false.
+			Interleaved data is fetched with fewer cache misses; a VboMesh constructed from a TriMesh is always interleaved. **/
+		void	setInterleavedStatic( bool interleaved = true ) { mInterleavedStatic = interleaved; }
+		//! \return whether a VboMesh constructed from a vertex count stores its static data interleaved
+		bool	getInterleavedStatic() const { return mInterleavedStatic; }
+
+		/** Sets the type of the indices to \c GL_UNSIGNED_SHORT or \c GL_UNSIGNED_INT. Default \c GL_UNSIGNED_INT. 16-bit indices halve the index buffer but can only address 65536 vertices,
+			so a VboMesh constructed from a TriMesh with more vertices than that keeps 32-bit indices. **/
+		void	setIndexType( GLenum type ) { mIndexType = type; }
+		//! \return the type of the indices requested by setIndexType()
+		GLenum	getIndexType() const { return mIndexType; }
+
+		/** Sets the type in which static \a attribute, such as \c ATTR_NORMALS, is stored. Default \c GL_FLOAT. Every attribute but the indices can be stored as \c GL_HALF_FLOAT_ARB,
+			normals as normalized \c GL_BYTE and colors as normalized \c GL_UNSIGNED_BYTE. Each vertex's attribute is padded to a multiple of 4 bytes. Dynamic attributes are always \c GL_FLOAT. **/
+		void	setStaticType( int attribute, GLenum type ) { mStaticTypes[attribute] = type; }
+		//! \return the type in which static \a attribute is stored
+		GLenum	getStaticType( int attribute ) const { return mStaticTypes[attribute]; }
 
 		int												mAttributes[ATTR_TOTAL];
+		GLenum											mStaticTypes[ATTR_TOTAL];
 		std::vector<std::pair<CustomAttr,size_t> >		mCustomDynamic, mCustomStatic; // pair of <types,offset>
+		std::vector<std::pair<CustomAttr,size_t> >		mCustomInstance; // interleaved in the instance buffer
+		bool											mOptimizeTriMesh;
+		bool											mInterleavedStatic;
+		GLenum											mIndexType;
 		
 	 private:
-		void initAttributes() { for( int a = 0; a < ATTR_TOTAL; ++a ) mAttributes[a] = NONE; }
+		void initAttributes() { for( int a = 0; a < ATTR_TOTAL; ++a ) { mAttributes[a] = NONE; mStaticTypes[a] = GL_FLOAT; } }
 	};
 
-	enum			{ INDEX_BUFFER = 0, STATIC_BUFFER, DYNAMIC_BUFFER, TOTAL_BUFFERS };
+	enum			{ INDEX_BUFFER = 0, STATIC_BUFFER, DYNAMIC_BUFFER, INSTANCE_BUFFER, TOTAL_BUFFERS };
 	
   protected:
 	struct Obj {
+		Obj() : mIndexType( GL_UNSIGNED_INT ), mInstanceStride( 0 ), mNumInstances( 0 ), mCurrentDynamicBuffer( 0 ) {}
+
 		size_t			mNumIndices, mNumVertices;	
+		GLenum			mIndexType;
 
 		Vbo				mBuffers[TOTAL_BUFFERS];
 		size_t			mPositionOffset;
@@ -155,10 +202,14 @@ class VboMesh {
 		size_t			mColorRGBOffset, mColorRGBAOffset;		
 		size_t			mTexCoordOffset[ATTR_MAX_TEXTURE_UNIT+1];
 		size_t			mStaticStride, mDynamicStride;	
+		size_t			mInstanceStride, mNumInstances;
 		GLenum			mPrimitiveType;
 		Layout			mLayout;
 		std::vector<GLint>		mCustomStaticLocations;
 		std::vector<GLint>		mCustomDynamicLocations;
+		std::vector<GLint>		mCustomInstanceLocations;
+		std::vector<Vbo>		mDynamicBuffers; // the ring cycled through by mapVertexBuffer(), if more than one
+		size_t					mCurrentDynamicBuffer;
 	};
 
   public:
@@ -167,7 +218,7 @@ class VboMesh {
 	VboMesh() {}
 	explicit VboMesh( const TriMesh &triMesh, Layout layout = Layout() );
 	explicit VboMesh( const TriMesh2d &triMesh, Layout layout = Layout() );
-	/*** Creates a VboMesh with \a numVertices vertices and \a numIndices indices. Dynamic data is stored interleaved and static data is planar. **/
+	/*** Creates a VboMesh with \a numVertices vertices and \a numIndices indices. Dynamic data is stored interleaved and static data is planar unless the Layout requests it interleaved. **/
 	VboMesh( size_t numVertices, size_t numIndices, Layout layout, GLenum primitiveType );
 	/*** Creates a VboMesh with \a numVertices vertices and \a numIndices indices. Accepts pointers to preexisting buffers, which may be NULL to request allocation **/
 	VboMesh( size_t numVertices, size_t numIndices, Layout layout, GLenum primitiveType, Vbo *indexBuffer, Vbo *staticBuffer, Vbo *dynamicBuffer );
@@ -175,6 +226,10 @@ class VboMesh {
 	size_t	getNumIndices() const { return mObj->mNumIndices; }
 	size_t	getNumVertices() const { return mObj->mNumVertices; }
 	GLenum	getPrimitiveType() const { return mObj->mPrimitiveType; }
+	//! Returns the type of the indices, which is \c GL_UNSIGNED_SHORT when the Layout requested it, or an optimized TriMesh with few enough vertices, and \c GL_UNSIGNED_INT otherwise
+	GLenum	getIndexType() const { return mObj->mIndexType; }
+	//! Returns the size in bytes of each index
+	size_t	getIndexSize() const { return ( mObj->mIndexType == GL_UNSIGNED_SHORT ) ? sizeof(uint16_t) : sizeof(uint32_t); }
 	
 	const Layout&	getLayout() const { return mObj->mLayout; }
 
@@ -185,6 +240,7 @@ class VboMesh {
 	static void		unbindBuffers();
 
 	void						bufferIndices( const std::vector<uint32_t> &indices );
+	void						bufferIndices( const std::vector<uint16_t> &indices );
 	void						bufferPositions( const std::vector<Vec3f> &positions );
 	void						bufferPositions( const Vec3f *positions, size_t count );
 	void						bufferNormals( const std::vector<Vec3f> &normals );
@@ -192,14 +248,33 @@ class VboMesh {
 	void						bufferTexCoords3d( size_t unit, const std::vector<Vec3f> &texCoords );
 	void						bufferColorsRGB( const std::vector<Color> &colors );
 	void						bufferColorsRGBA( const std::vector<ColorA> &colors );
+	/** Maps the dynamic buffer and returns a VertexIter which writes directly into it. Every vertex must be rewritten, as the previous contents are discarded.
+		With a single dynamic buffer the driver is asked to orphan its storage, and with several the next buffer of the ring is mapped instead. See setNumDynamicBuffers(). **/
 	class VertexIter			mapVertexBuffer();
+	/** Sets the number of dynamic buffers mapVertexBuffer() cycles through. With \a numBuffers greater than \c 1, writing a frame's vertices
+		never waits on the GPU reading those of the previous frames. Where \c GL_ARB_map_buffer_range is available the buffers are then mapped unsynchronized. Default \c 1 **/
+	void						setNumDynamicBuffers( size_t numBuffers );
+	//! Returns the number of dynamic buffers mapVertexBuffer() cycles through
+	size_t						getNumDynamicBuffers() const { return std::max<size_t>( mObj->mDynamicBuffers.size(), 1 ); }
+	/** Replaces the per-instance data with \a numInstances instances read from \a data. Each instance holds the Layout's instance attributes
+		interleaved in the order they were added, getInstanceStride() bytes apart. **/
+	void						bufferInstanceData( const void *data, size_t numInstances, GLenum usage = GL_STREAM_DRAW );
 
 	Vbo&				getIndexVbo() const { return mObj->mBuffers[INDEX_BUFFER]; }
 	Vbo&				getStaticVbo() const { return mObj->mBuffers[STATIC_BUFFER]; }
 	Vbo&				getDynamicVbo() const { return mObj->mBuffers[DYNAMIC_BUFFER]; }
+	Vbo&				getInstanceVbo() const { return mObj->mBuffers[INSTANCE_BUFFER]; }
+
+	//! Returns the number of instances last passed to bufferInstanceData()
+	size_t				getNumInstances() const { return mObj->mNumInstances; }
+	//! Returns the number of bytes of per-instance data for each instance
+	size_t				getInstanceStride() const { return mObj->mInstanceStride; }
+	//! Returns whether the driver supports both \c GL_ARB_instanced_arrays and \c GL_ARB_draw_instanced, which gl::drawInstanced() requires
+	static bool			supportsInstancing();
 
 	void				setCustomStaticLocation( size_t internalIndex, GLuint location ) { mObj->mCustomStaticLocations[internalIndex] = location; }
 	void				setCustomDynamicLocation( size_t internalIndex, GLuint location ) { mObj->mCustomDynamicLocations[internalIndex] = location; }
+	void				setCustomInstanceLocation( size_t internalIndex, GLuint location ) { mObj->mCustomInstanceLocations[internalIndex] = location; }
 
 	size_t						getTexCoordOffset( size_t unit ) const { return mObj->mTexCoordOffset[unit]; }
 	void						setTexCoordOffset( size_t unit, size_t aTexCoordOffset ) { mObj->mTexCoordOffset[unit] = aTexCoordOffset; }	
@@ -242,6 +317,8 @@ class VboMesh {
 		void*		getPointer() const { return reinterpret_cast<void*>( mPtr ); }
 		//! \return pointer where the iterator is currently writing positions
 		Vec3f*		getPositionPointer() const { return reinterpret_cast<Vec3f*>( &mPtr[mPositionOffset] ); }		
+		//! \return pointer where the iterator is currently writing RGBA colors
+		ColorA*		getColorRGBAPointer() const { return reinterpret_cast<ColorA*>( &mPtr[mColorRGBAOffset] ); }
 
 //		VertexIter( const VertexIter &other ) { set( other ); }	
 //		VertexIter& operator=( const VertexIter &other ) { set( other ); return *this; }
@@ -270,6 +347,8 @@ class VboMesh {
 
  protected:
 	void	initializeBuffers( bool staticDataPlanar );
+	//! Writes \a count elements of \a attribute, converted to its type, at \a offset in whichever buffer holds it
+	void	bufferAttribute( int attribute, size_t offset, const float *data, size_t count );
 
 	std::shared_ptr<Obj>		mObj;
 };
@@ -294,4 +373,9 @@ class VboFailedUnmapExc : public VboExc {
 	virtual const char* what() const throw() { return "OpenGL Vbo exception: Unmap failure"; } 
 };
 
+class VboInvalidTypeExc : public VboExc {
+ public:
+	virtual const char* what() const throw() { return "OpenGL Vbo exception: Invalid attribute or index type"; } 
+};
+
 } } // namespace cinder::gl
@@ -0,0 +1,93 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Matrix.h"
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/gl/Material.h"
+
+namespace cinder { namespace gl {
+
+/** \brief Retained geometry recorded like a DisplayList, but stored in static interleaved VboMeshes rather than in a \c glNewList() list.
+	Between newList() and endList() the calls to gl::begin(), gl::vertex(), gl::texCoord(), gl::color() and gl::end() and the gl::draw*() helpers which
+	draw from client arrays are captured instead of drawn, along with any change they had made to the \c MODELVIEW matrix since newList().
+	Strips, fans, loops, quads and polygons are converted to triangles and lines. Only geometry and colors are recorded: textures, enabled states,
+	materials set through OpenGL directly, VboMesh draws and raw \c gl* calls are not, so those should be applied around draw() instead. **/
+class VboList {
+ protected:
+	struct Obj;
+
+ public:
+	//! The kinds of primitive everything recorded is reduced to, each held by its own VboMesh
+	enum { TRIANGLES, LINES, POINTS, TOTAL_PRIMITIVES };
+
+	VboList() {}
+
+	//! Discards any previously recorded geometry and begins capturing. Only one VboList may be recording at a time.
+	void	newList();
+	//! Stops capturing and uploads the recorded geometry
+	void	endList();
+	//! Returns whether the VboList is between newList() and endList()
+	bool	isRecording() const;
+
+	//! Draws the recorded geometry, transformed by getModelMatrix() and with getMaterial() applied if one was set
+	void	draw() const;
+
+	Matrix44f&			getModelMatrix() { return mObj->mModelMatrix; }
+	const Matrix44f&	getModelMatrix() const { return mObj->mModelMatrix; }
+
+	void			setMaterial( const Material &aMaterial ) { mObj->mMaterial = std::shared_ptr<Material>( new Material( aMaterial ) ); }
+	Material&		getMaterial() { return *(mObj->mMaterial); }
+
+	//! Returns the VboMesh holding the recorded triangles, which is empty if none were recorded
+	const VboMesh&	getTriangles() const { return mObj->mMeshes[TRIANGLES]; }
+	//! Returns the VboMesh holding the recorded lines, drawn as \c GL_LINES, which is empty if none were recorded
+	const VboMesh&	getLines() const { return mObj->mMeshes[LINES]; }
+	//! Returns the VboMesh holding the recorded points, drawn as \c GL_POINTS, which is empty if none were recorded
+	const VboMesh&	getPoints() const { return mObj->mMeshes[POINTS]; }
+
+	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<Obj> VboList::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &VboList::mObj; }
+	void reset() { mObj.reset(); }
+	//@}
+
+ protected:
+	struct Obj {
+		Obj() { mModelMatrix.setToIdentity(); }
+		~Obj();
+
+		Matrix44f					mModelMatrix;
+		std::shared_ptr<Material>	mMaterial;
+		VboMesh						mMeshes[TOTAL_PRIMITIVES];
+	};
+
+	std::shared_ptr<Obj>		mObj;
+};
+
+} } // namespace cinder::gl
@@ -0,0 +1,106 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/gl/GlslProg.h"
+#include "cinder/YuvSurface.h"
+
+namespace cinder { namespace gl {
+
+/** \brief The planes of a YuvSurface as GL_TEXTURE_2D textures, converted to RGB by a fragment shader as they're drawn.
+	Uploading YpCbCr 4:2:0 moves half the bytes of RGB (and three eighths of BGRA), and spares the CPU the color conversion.
+	The luma is a \c GL_LUMINANCE texture. NV12 chroma is a single half resolution \c GL_LUMINANCE_ALPHA texture holding Cb and Cr, while I420 chroma is a pair of \c GL_LUMINANCE textures. \ImplShared **/
+class YuvTexture {
+  public:
+	YuvTexture() {}
+	//! Allocates textures for a \a width x \a height YuvSurface laid out as \a layout
+	YuvTexture( int32_t width, int32_t height, YuvSurface::Layout layout = YuvSurface::NV12 );
+	//! Allocates textures matching \a yuvSurface and uploads it
+	explicit YuvTexture( const YuvSurface &yuvSurface );
+
+	//! Uploads \a yuvSurface, which must match the YuvTexture's size and layout, and adopts its color space. Throws TextureDataExc otherwise.
+	void			update( const YuvSurface &yuvSurface );
+
+	//! Returns the width of the image in pixels
+	int32_t			getWidth() const { return mObj->mWidth; }
+	//! Returns the height of the image in pixels
+	int32_t			getHeight() const { return mObj->mHeight; }
+	//! Returns the bounding Area of the image in pixels
+	Area			getBounds() const { return Area( 0, 0, mObj->mWidth, mObj->mHeight ); }
+	//! Returns the arrangement of the chroma planes
+	YuvSurface::Layout	getLayout() const { return mObj->mLayout; }
+
+	//! Returns the luma texture
+	const Texture&	getLumaTexture() const { return mObj->mLuma; }
+	//! Returns a chroma texture. For NV12 \a index \c 0 is the interleaved CbCr texture; for I420 \c 0 is Cb and \c 1 is Cr.
+	const Texture&	getChromaTexture( int index = 0 ) const { return mObj->mChroma[index]; }
+
+#if ! defined( CINDER_GLES )
+	/** Binds the planes to consecutive texture units starting at \a firstTextureUnit, and binds getShader() configured for the last uploaded color space.
+		Anything drawn with texture coordinates on unit \c 0 is then converted to RGB and modulated by the current color. **/
+	void			bind( GLuint firstTextureUnit = 0 ) const;
+	//! Unbinds the planes and the shader bound by bind()
+	void			unbind( GLuint firstTextureUnit = 0 ) const;
+	//! Returns the conversion shader, whose samplers are \c uY, \c uCb and \c uCr (unused for NV12) and whose conversion is given by \c uYuvToRgb and \c uOffset as in YuvSurface::getRgbConversion()
+	const GlslProg&	getShader() const;
+#endif
+
+  protected:
+	struct Obj {
+		Obj( int32_t width, int32_t height, YuvSurface::Layout layout );
+
+		int32_t					mWidth, mHeight;
+		YuvSurface::Layout		mLayout;
+		YuvSurface::ColorMatrix	mColorMatrix;
+		bool					mFullRange;
+		Texture					mLuma, mChroma[2];
+		mutable GlslProg		mShader;
+	};
+
+	static void		uploadPlane( const Texture &texture, const Channel8u &plane, GLenum dataFormat );
+
+	std::shared_ptr<Obj>	mObj;
+
+  public:
+ 	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<Obj> YuvTexture::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &YuvTexture::mObj; }
+	void reset() { mObj.reset(); }
+	//@}
+};
+
+#if ! defined( CINDER_GLES )
+//! Draws \a texture converted to RGB, filling \a rect
+void draw( const YuvTexture &texture, const Rectf &rect );
+//! Draws \a texture converted to RGB with its upper-left corner at \a pos
+void draw( const YuvTexture &texture, const Vec2f &pos = Vec2f::zero() );
+#endif
+
+} } // namespace cinder::gl
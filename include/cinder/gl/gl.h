@@ -146,40 +146,54 @@ void rotate( const Quatf &quat );
 //! Produces a 2D rotation, the equivalent of a rotation around the Z axis by \a degrees.
 inline void rotate( float degrees ) { rotate( Vec3f( 0, 0, degrees ) ); }
 
+namespace detail {
+//! Whether a gl::VboList is between newList() and endList(), in which case the immediate mode functions and the draw helpers are captured by it rather than issued
+extern bool sVboListRecording;
+void	vboListBegin( GLenum mode );
+void	vboListEnd();
+void	vboListVertex( float x, float y, float z );
+void	vboListTexCoord( float x, float y );
+void	vboListColor( float r, float g, float b, float a );
+//! Captures \c glDrawArrays() from the enabled client arrays
+void	vboListDrawArrays( GLenum mode, GLint first, GLsizei count );
+//! Captures \c glDrawElements() from the enabled client arrays
+void	vboListDrawElements( GLenum mode, GLsizei count, GLenum type, const GLvoid *indices );
+} // namespace detail
+
 #if ! defined( CINDER_GLES )
 //! Equivalent to glBegin() in immediate mode
-inline void begin( GLenum mode ) { glBegin( mode ); }
+inline void begin( GLenum mode ) { if( detail::sVboListRecording ) detail::vboListBegin( mode ); else glBegin( mode ); }
 //! Equivalent to glEnd() in immediate mode
-inline void end() { glEnd(); }
+inline void end() { if( detail::sVboListRecording ) detail::vboListEnd(); else glEnd(); }
 //! Used between calls to gl::begin() and \c gl::end(), appends a vertex to the current primitive.
-inline void vertex( const Vec2f &v ) { glVertex2fv( &v.x ); }
+inline void vertex( const Vec2f &v ) { if( detail::sVboListRecording ) detail::vboListVertex( v.x, v.y, 0 ); else glVertex2fv( &v.x ); }
 //! Used between calls to gl::begin() and \c gl::end(), appends a vertex to the current primitive.
-inline void vertex( float x, float y ) { glVertex2f( x, y ); }
+inline void vertex( float x, float y ) { if( detail::sVboListRecording ) detail::vboListVertex( x, y, 0 ); else glVertex2f( x, y ); }
 //! Used between calls to gl::begin() and \c gl::end(), appends a vertex to the current primitive.
-inline void vertex( const Vec3f &v ) { glVertex3fv( &v.x ); }
+inline void vertex( const Vec3f &v ) { if( detail::sVboListRecording ) detail::vboListVertex( v.x, v.y, v.z ); else glVertex3fv( &v.x ); }
 //! Used between calls to gl::begin() and \c gl::end(), appends a vertex to the current primitive.
-inline void vertex( float x, float y, float z ) { glVertex3f( x, y, z ); }
+inline void vertex( float x, float y, float z ) { if( detail::sVboListRecording ) detail::vboListVertex( x, y, z ); else glVertex3f( x, y, z ); }
 //! Used between calls to gl::begin() and gl::end(), sets the 2D texture coordinate for the next vertex.
-inline void texCoord( float x, float y ) { glTexCoord2f( x, y ); }
+inline void texCoord( float x, float y ) { if( detail::sVboListRecording ) detail::vboListTexCoord( x, y ); else glTexCoord2f( x, y ); }
 //! Used between calls to gl::begin() and gl::end(), sets the 2D texture coordinate for the next vertex.
-inline void texCoord( const Vec2f &v ) { glTexCoord2f( v.x, v.y ); }
-//! Used between calls to gl::begin() and gl::end(), sets the 3D texture coordinate for the next vertex.
-inline void texCoord( float x, float y, float z ) { glTexCoord3f( x, y, z ); }
-//! Used between calls to gl::begin() and gl::end(), sets the 3D texture coordinate for the next vertex.
-inline void texCoord( const Vec3f &v ) { glTexCoord3f( v.x, v.y, v.z ); }
+inline void texCoord( const Vec2f &v ) { if( detail::sVboListRecording ) detail::vboListTexCoord( v.x, v.y ); else glTexCoord2f( v.x, v.y ); }
+//! Used between calls to gl::begin() and gl::end(), sets the 3D texture coordinate for the next vertex. A gl::VboList keeps only \a x and \a y.
+inline void texCoord( float x, float y, float z ) { if( detail::sVboListRecording ) detail::vboListTexCoord( x, y ); else glTexCoord3f( x, y, z ); }
+//! Used between calls to gl::begin() and gl::end(), sets the 3D texture coordinate for the next vertex. A gl::VboList keeps only \a v.x and \a v.y.
+inline void texCoord( const Vec3f &v ) { if( detail::sVboListRecording ) detail::vboListTexCoord( v.x, v.y ); else glTexCoord3f( v.x, v.y, v.z ); }
 #endif // ! defined( CINDER_GLES )
 //! Sets the current color and the alpha value to 1.0
-inline void color( float r, float g, float b ) { glColor4f( r, g, b, 1.0f ); }
+inline void color( float r, float g, float b ) { if( detail::sVboListRecording ) detail::vboListColor( r, g, b, 1.0f ); else glColor4f( r, g, b, 1.0f ); }
 //! Sets the current color and alpha value
-inline void color( float r, float g, float b, float a ) { glColor4f( r, g, b, a ); }
+inline void color( float r, float g, float b, float a ) { if( detail::sVboListRecording ) detail::vboListColor( r, g, b, a ); else glColor4f( r, g, b, a ); }
 //! Sets the current color, and the alpha value to 1.0
-inline void color( const Color8u &c ) { glColor4ub( c.r, c.g, c.b, 255 ); }
+inline void color( const Color8u &c ) { if( detail::sVboListRecording ) detail::vboListColor( c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, 1.0f ); else glColor4ub( c.r, c.g, c.b, 255 ); }
 //! Sets the current color and alpha value
-inline void color( const ColorA8u &c ) { glColor4ub( c.r, c.g, c.b, c.a ); }
+inline void color( const ColorA8u &c ) { if( detail::sVboListRecording ) detail::vboListColor( c.r / 255.0f, c.g / 255.0f, c.b / 255.0f, c.a / 255.0f ); else glColor4ub( c.r, c.g, c.b, c.a ); }
 //! Sets the current color, and the alpha value to 1.0
-inline void color( const Color &c ) { glColor4f( c.r, c.g, c.b, 1.0f ); }
+inline void color( const Color &c ) { if( detail::sVboListRecording ) detail::vboListColor( c.r, c.g, c.b, 1.0f ); else glColor4f( c.r, c.g, c.b, 1.0f ); }
 //! Sets the current color and alpha value
-inline void color( const ColorA &c ) { glColor4f( c.r, c.g, c.b, c.a ); }
+inline void color( const ColorA &c ) { if( detail::sVboListRecording ) detail::vboListColor( c.r, c.g, c.b, c.a ); else glColor4f( c.r, c.g, c.b, c.a ); }
 
 //! Enables the OpenGL State \a state. Equivalent to calling to glEnable( state );
 inline void enable( GLenum state ) { glEnable( state ); }
@@ -264,11 +278,11 @@ void draw( const class Path2d &path2d, float approximationScale = 1.0f );
 //! Draws a Shape2d \a shape2d using approximation scale \a approximationScale. 1.0 corresponds to screenspace, 2.0 is double screen resolution, etc
 void draw( const class Shape2d &shape2d, float approximationScale = 1.0f );
 
-//! Draws a solid (filled) Path2d \a path2d using approximation scale \a approximationScale. 1.0 corresponds to screenspace, 2.0 is double screen resolution, etc. Performance warning: This routine tesselates the polygon into triangles. Consider using Triangulator directly.
+//! Draws a solid (filled) Path2d \a path2d using approximation scale \a approximationScale. 1.0 corresponds to screenspace, 2.0 is double screen resolution, etc. Performance warning: This routine tesselates the polygon into triangles on every call. Consider caching it with gl::ShapeMesh.
 void drawSolid( const class Path2d &path2d, float approximationScale = 1.0f );
-//! Draws a solid (filled) Shape2d \a shape2d using approximation scale \a approximationScale. 1.0 corresponds to screenspace, 2.0 is double screen resolution, etc. Performance warning: This routine tesselates the polygon into triangles. Consider using Triangulator directly.
+//! Draws a solid (filled) Shape2d \a shape2d using approximation scale \a approximationScale. 1.0 corresponds to screenspace, 2.0 is double screen resolution, etc. Performance warning: This routine tesselates the polygon into triangles on every call. Consider caching it with gl::ShapeMesh.
 void drawSolid( const class Shape2d &shape2d, float approximationScale = 1.0f );
-//! Draws a solid (filled) PolyLine2f \a polyLine. Performance warning: This routine tesselates the polygon into triangles. Consider using Triangulator directly.
+//! Draws a solid (filled) PolyLine2f \a polyLine. Performance warning: This routine tesselates the polygon into triangles on every call. Consider caching it with gl::ShapeMesh.
 void drawSolid( const PolyLine2f &polyLine );
 
 //! Draws a cinder::TriMesh \a mesh at the origin.
@@ -287,6 +301,9 @@ void draw( const VboMesh &vbo );
 void drawRange( const VboMesh &vbo, size_t startIndex, size_t indexCount, int vertexStart = -1, int vertexEnd = -1 );
 //! Draws a range of elements from a cinder::gl::VboMesh \a vbo.
 void drawArrays( const VboMesh &vbo, GLint first, GLsizei count );
+/** Draws \a instanceCount instances of cinder::gl::VboMesh \a vbo in a single call. The Layout's instance attributes advance once per instance,
+	typically supplying a per-instance transform to a shader. Requires VboMesh::supportsInstancing(). **/
+void drawInstanced( const VboMesh &vbo, size_t instanceCount );
 //!	Draws a textured quad of size \a scale that is aligned with the vectors \a bbRight and \a bbUp at \a pos, rotated by \a rotationDegrees around the vector orthogonal to \a bbRight and \a bbUp.
 #endif
 	
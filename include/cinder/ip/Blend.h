@@ -27,6 +27,7 @@
 #include "cinder/Area.h"
 #include "cinder/Vector.h"
 #include "cinder/Surface.h"
+#include "cinder/ip/ExecutionContext.h"
 
 namespace cinder { namespace ip {
 
@@ -35,5 +36,10 @@ inline void blend( Surface *background, const Surface &foreground ) { blend( bac
 void blend( Surface32f *background, const Surface32f &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset = Vec2i::zero() );
 inline void blend( Surface32f *background, const Surface32f &foreground ) { blend( background, foreground, background->getBounds(), Vec2i::zero() ); }
 
+//! Composites \a srcArea of \a foreground over \a background, processing bands of rows in parallel on \a context
+void blend( Surface *background, const Surface &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset, const ExecutionContextRef &context );
+//! Composites \a srcArea of \a foreground over \a background, processing bands of rows in parallel on \a context
+void blend( Surface32f *background, const Surface32f &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset, const ExecutionContextRef &context );
+
 
 } } // namespace cinder::ip
\ No newline at end of file
@@ -0,0 +1,60 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+
+namespace cinder { namespace ip {
+
+//! Blurs \a srcChannel with a square box filter of size 2 * \a radius + 1 and stores the result in \a dstChannel. The window is clamped at the image borders.
+/** Built on a summed-area table, so the cost per pixel is independent of \a radius. \a srcChannel and \a dstChannel may be the same Channel. **/
+template<typename T>
+void boxBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, int32_t radius );
+//! Blurs \a channel in place with a square box filter of size 2 * \a radius + 1
+template<typename T>
+void boxBlur( ChannelT<T> *channel, int32_t radius );
+//! Blurs every channel of \a srcSurface, including alpha, with a square box filter of size 2 * \a radius + 1 and stores the result in \a dstSurface
+template<typename T>
+void boxBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, int32_t radius );
+//! Blurs every channel of \a surface in place, including alpha, with a square box filter of size 2 * \a radius + 1
+template<typename T>
+void boxBlur( SurfaceT<T> *surface, int32_t radius );
+
+//! Approximates a Gaussian blur of standard deviation \a sigma of \a srcChannel with three successive box blurs and stores the result in \a dstChannel. The cost per pixel is independent of \a sigma.
+template<typename T>
+void gaussianBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, float sigma );
+//! Approximates a Gaussian blur of standard deviation \a sigma of \a channel in place with three successive box blurs
+template<typename T>
+void gaussianBlur( ChannelT<T> *channel, float sigma );
+//! Approximates a Gaussian blur of standard deviation \a sigma of every channel of \a srcSurface, including alpha, and stores the result in \a dstSurface
+template<typename T>
+void gaussianBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, float sigma );
+//! Approximates a Gaussian blur of standard deviation \a sigma of every channel of \a surface in place, including alpha
+template<typename T>
+void gaussianBlur( SurfaceT<T> *surface, float sigma );
+
+} } // namespace cinder::ip
@@ -0,0 +1,75 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+
+namespace cinder { namespace ip {
+
+/** \brief Rearranges the 8 bit channels of a row of pixels from one layout into another, such as BGRA into RGBA, RGB into RGBA or gray into RGB.
+	Each byte of a destination pixel is either copied from a byte of the source pixel, filled with \c 0xFF or left unchanged. Pixels may be 1 to 4 bytes.
+	Rows are converted 16 bytes at a time with SSSE3 or NEON byte shuffles when available. SSE2 handles source pixels of any size and destination pixels of 3 or 4 bytes. **/
+class ChannelShuffle {
+  public:
+	enum AlphaMode { COPY_ALPHA, FILL_ALPHA, NO_ALPHA };
+
+	//! Constructs a ChannelShuffle between pixels of \a srcPixelInc and \a dstPixelInc bytes which leaves every destination byte unchanged until copy() or fill() are called
+	ChannelShuffle( int32_t srcPixelInc, int32_t dstPixelInc );
+	//! Constructs a ChannelShuffle converting the red, green and blue of \a srcOrder to \a dstOrder, with the destination alpha copied, filled with \c 0xFF or left unchanged according to \a alphaMode
+	ChannelShuffle( const SurfaceChannelOrder &srcOrder, const SurfaceChannelOrder &dstOrder, AlphaMode alphaMode );
+
+	//! Copies byte \a srcOffset of each source pixel to byte \a dstOffset of its destination pixel
+	void		copy( int32_t dstOffset, int32_t srcOffset );
+	//! Fills byte \a dstOffset of each destination pixel with \c 0xFF
+	void		fill( int32_t dstOffset );
+
+	//! Converts \a width pixels of \a src into \a dst. The two rows must not overlap.
+	void		apply( const uint8_t *src, uint8_t *dst, int32_t width ) const;
+	//! Converts as many of the leading pixels of a row as possible with SIMD and returns how many were converted; the caller converts the remainder
+	int32_t		applySimd( const uint8_t *src, uint8_t *dst, int32_t width ) const;
+
+	int32_t		getSrcPixelInc() const { return mSrcInc; }
+	int32_t		getDstPixelInc() const { return mDstInc; }
+
+  protected:
+	void		init( int32_t srcPixelInc, int32_t dstPixelInc );
+
+	int32_t		applySsse3( const uint8_t *src, uint8_t *dst, int32_t width ) const;
+	int32_t		applySse2( const uint8_t *src, uint8_t *dst, int32_t width ) const;
+	int32_t		applyNeon( const uint8_t *src, uint8_t *dst, int32_t width ) const;
+
+	static const int8_t	KEEP = -1, FILL = -2;
+
+	// the source byte of each destination byte of a pixel, or KEEP or FILL
+	int8_t		mSrcOffsets[4];
+	// a 16 byte shuffle covering mPixelsPerStep pixels as consumed by pshufb and vtbl, whose indices of 0x80 produce zero. Bytes set in mKeep
+	// preserve the existing destination and bytes set in mFill are forced to 0xFF.
+	uint8_t		mShuffle[16], mKeep[16], mFill[16];
+	int32_t		mSrcInc, mDstInc, mPixelsPerStep, mMinPixels;
+};
+
+} } // namespace cinder::ip
@@ -0,0 +1,75 @@
+/*
+ Copyright (c) 2010, The Barbarian Group
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/YuvSurface.h"
+#include "cinder/ip/ExecutionContext.h"
+
+namespace cinder { namespace ip {
+
+/** Converts the RGB pixels of \a surface to HSV in place, storing hue, saturation and value in the red, green and blue channels, normalized to the channel's range like rgbToHSV().
+	Alpha is left alone. 8 bit RGBA and float RGBA Surfaces convert 4 pixels at a time with SSE2. **/
+template<typename T>
+void rgbToHsv( SurfaceT<T> *surface );
+//! Converts the pixels of \a surface, processing bands of rows in parallel on \a context. See rgbToHsv( SurfaceT<T>* ).
+template<typename T>
+void rgbToHsv( SurfaceT<T> *surface, const ExecutionContextRef &context );
+//! Converts the HSV pixels of \a surface, as stored by rgbToHsv(), back to RGB in place
+template<typename T>
+void hsvToRgb( SurfaceT<T> *surface );
+template<typename T>
+void hsvToRgb( SurfaceT<T> *surface, const ExecutionContextRef &context );
+
+/** Converts the RGB pixels of \a surface to YpCbCr in place, storing Y, Cb and Cr in the red, green and blue channels, encoded with \a colorMatrix in full or video range.
+	Chroma is offset by half the channel's range so that it's never negative. The matrices match YuvSurface's. **/
+template<typename T>
+void rgbToYCbCr( SurfaceT<T> *surface, YuvSurface::ColorMatrix colorMatrix = YuvSurface::BT601, bool fullRange = true );
+template<typename T>
+void rgbToYCbCr( SurfaceT<T> *surface, const ExecutionContextRef &context, YuvSurface::ColorMatrix colorMatrix = YuvSurface::BT601, bool fullRange = true );
+//! Converts the YpCbCr pixels of \a surface, as stored by rgbToYCbCr(), back to RGB in place
+template<typename T>
+void yCbCrToRgb( SurfaceT<T> *surface, YuvSurface::ColorMatrix colorMatrix = YuvSurface::BT601, bool fullRange = true );
+template<typename T>
+void yCbCrToRgb( SurfaceT<T> *surface, const ExecutionContextRef &context, YuvSurface::ColorMatrix colorMatrix = YuvSurface::BT601, bool fullRange = true );
+
+/** Decodes the sRGB pixels of \a surface to linear light in place, leaving alpha alone. 8 bit Surfaces use lookup tables.
+	Blending and filtering linear pixels, then encoding them with linearToSrgb(), is gamma correct. Prefer 16 bit or float Surfaces for the linear pixels,
+	since 8 bits lose most of the precision of the darks. **/
+template<typename T>
+void srgbToLinear( SurfaceT<T> *surface );
+template<typename T>
+void srgbToLinear( SurfaceT<T> *surface, const ExecutionContextRef &context );
+//! Encodes the linear pixels of \a surface to sRGB in place, leaving alpha alone. 8 bit Surfaces use lookup tables.
+template<typename T>
+void linearToSrgb( SurfaceT<T> *surface );
+template<typename T>
+void linearToSrgb( SurfaceT<T> *surface, const ExecutionContextRef &context );
+
+//! Returns the linear value of the sRGB encoded value \a v, both in [0,1]
+float	srgbToLinear( float v );
+//! Returns the sRGB encoding of the linear value \a v, both in [0,1]
+float	linearToSrgb( float v );
+
+} } // namespace cinder::ip
@@ -23,6 +23,7 @@
 #pragma once
 
 #include "cinder/Surface.h"
+#include "cinder/ip/ExecutionContext.h"
 
 namespace cinder { namespace ip {
 
@@ -34,5 +35,11 @@ template<typename T>
 void edgeDetectSobel( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel );
 template<typename T>
 void edgeDetectSobel( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSuface );
+//! Performs Sobel edge detection on \a srcArea of \a srcChannel, processing bands of rows in parallel on \a context
+template<typename T>
+void edgeDetectSobel( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstOffset, ChannelT<T> *dstChannel, const ExecutionContextRef &context );
+//! Performs Sobel edge detection on \a srcArea of \a srcSurface, processing bands of rows in parallel on \a context
+template<typename T>
+void edgeDetectSobel( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstOffset, SurfaceT<T> *dstSuface, const ExecutionContextRef &context );
 
 } } // namespace cinder::ip
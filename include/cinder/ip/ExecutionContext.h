@@ -0,0 +1,69 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Area.h"
+#include "cinder/Function.h"
+#include "cinder/JobSystem.h"
+
+#include <boost/noncopyable.hpp>
+
+namespace cinder { namespace ip {
+
+typedef std::shared_ptr<class ExecutionContext>	ExecutionContextRef;
+
+/** \brief Runs cinder::ip operations in parallel as jobs of a JobSystem.
+	An Area is split into horizontal bands of rows which are processed concurrently by the JobSystem's workers and the calling thread.
+	Pass an ExecutionContextRef as the final parameter of any cinder::ip function which accepts one. **/
+class ExecutionContext : private boost::noncopyable {
+  public:
+	//! Creates an ExecutionContext with its own JobSystem of \a numThreads threads, including the calling thread. A value of \c 0 uses System::getNumCores()
+	static ExecutionContextRef	create( int32_t numThreads = 0 ) { return ExecutionContextRef( new ExecutionContext( JobSystem::create( numThreads ) ) ); }
+	//! Creates an ExecutionContext which runs its bands on \a jobSystem
+	static ExecutionContextRef	create( const JobSystemRef &jobSystem ) { return ExecutionContextRef( new ExecutionContext( jobSystem ) ); }
+	//! Returns a shared ExecutionContext which runs on JobSystem::getDefault(), created upon first use
+	static ExecutionContextRef	getDefault();
+
+	//! Returns the JobSystem which processes the bands
+	const JobSystemRef&	getJobSystem() const { return mJobSystem; }
+	//! Returns the number of threads used to process an Area, including the calling thread
+	int32_t		getNumThreads() const { return mJobSystem->getNumThreads(); }
+	//! Returns the minimum number of rows a band is allowed to contain. Defaults to \c 16
+	int32_t		getMinRowsPerBand() const { return mMinRowsPerBand; }
+	//! Sets the minimum number of rows a band is allowed to contain. Smaller Areas are processed on fewer threads.
+	void		setMinRowsPerBand( int32_t minRows ) { mMinRowsPerBand = std::max<int32_t>( 1, minRows ); }
+
+	//! Splits \a area into horizontal bands and calls \a bandFn once for each of them, blocking until all bands have completed. \a bandFn must be safe to call concurrently.
+	void		run( const Area &area, const std::function<void(const Area&)> &bandFn ) { mJobSystem->parallelFor( area, bandFn, mMinRowsPerBand ); }
+
+  private:
+	ExecutionContext( const JobSystemRef &jobSystem ) : mJobSystem( jobSystem ), mMinRowsPerBand( 16 ) {}
+
+	JobSystemRef	mJobSystem;
+	int32_t			mMinRowsPerBand;
+};
+
+} } // namespace cinder::ip
@@ -26,6 +26,7 @@
 #include "cinder/Channel.h"
 #include "cinder/Area.h"
 #include "cinder/Color.h"
+#include "cinder/ip/ExecutionContext.h"
 
 namespace cinder { namespace ip {
 
@@ -43,4 +44,14 @@ void fill( ChannelT<T> *channel, T value, const Area &area );
 template<typename T>
 void fill( ChannelT<T> *channel, T value );
 
+//! Fills the Area \a area of \a surface with \a color, processing bands of rows in parallel on \a context
+template<typename T, typename Y>
+void fill( SurfaceT<T> *surface, const ColorT<Y> &color, const Area &area, const ExecutionContextRef &context );
+//! Fills the Area \a area of \a surface with \a color, processing bands of rows in parallel on \a context
+template<typename T, typename Y>
+void fill( SurfaceT<T> *surface, const ColorAT<Y> &color, const Area &area, const ExecutionContextRef &context );
+//! Fills the Area \a area of \a channel with \a value, processing bands of rows in parallel on \a context
+template<typename T>
+void fill( ChannelT<T> *channel, T value, const Area &area, const ExecutionContextRef &context );
+
 } } // namespace cinder::ip
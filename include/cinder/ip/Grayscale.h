@@ -24,6 +24,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Surface.h"
+#include "cinder/ip/ExecutionContext.h"
 
 namespace cinder { namespace ip {
 
@@ -33,5 +34,11 @@ void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );
 //! Converts Surface \a srcSurface to grayscale and stores the result in Channel \a dstChannel. Uses primary weights dictated by the Rec. 709 Video Standard
 template<typename T>
 void grayscale( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel );
+//! Converts Surface \a srcSurface to grayscale and stores the result in Surface \a dstSurface, processing bands of rows in parallel on \a context
+template<typename T>
+void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const ExecutionContextRef &context );
+//! Converts Surface \a srcSurface to grayscale and stores the result in Channel \a dstChannel, processing bands of rows in parallel on \a context
+template<typename T>
+void grayscale( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel, const ExecutionContextRef &context );
 
 } } // namespace cinder::ip
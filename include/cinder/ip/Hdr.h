@@ -24,6 +24,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Surface.h"
+#include "cinder/ip/Statistics.h"
 
 namespace cinder { namespace ip {
 
@@ -31,7 +32,5 @@ namespace cinder { namespace ip {
 void hdrNormalize( Surface32f *surface );
 /** Normalizes \a channel by scaling the maximum and minimum values to lie in the range \c [0,1] **/
 void hdrNormalize( Channel32f *channel );
-/** Determines the minimum and maximum values of \a channel **/
-void getMinMax( const Channel32f &channel, float *resultMin, float *resultMax );
 
 } } // namespace cinder::ip
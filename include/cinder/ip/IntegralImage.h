@@ -0,0 +1,58 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Channel.h"
+
+namespace cinder { namespace ip {
+
+//! Fills \a integralImage, which must hold srcChannel.getWidth() * srcChannel.getHeight() values, with the summed-area table of \a srcChannel.
+/** Each value is the sum of every pixel above and to the left of it, inclusive. Unsigned integer sums may wrap on very large images; differences of them still yield exact window sums. **/
+template<typename T, typename SUMT>
+void calculateIntegralImage( const ChannelT<T> &srcChannel, SUMT *integralImage );
+//! Refreshes \a integralImage, previously calculated from \a srcChannel, after the pixels of \a srcChannel inside \a dirtyArea changed.
+/** Only the values below and to the right of the top-left corner of \a dirtyArea depend on those pixels, so only they are recalculated. **/
+template<typename T, typename SUMT>
+void updateIntegralImage( const ChannelT<T> &srcChannel, SUMT *integralImage, const Area &dirtyArea );
+
+//! Returns the sum of the pixels in the inclusive window [\a x1,\a x2] x [\a y1,\a y2] of an integral image \a imageWidth values wide
+template<typename SUMT>
+inline SUMT integralImageSum( const SUMT *integralImage, int32_t imageWidth, int32_t x1, int32_t y1, int32_t x2, int32_t y2 )
+{
+	const SUMT *bottom = integralImage + y2 * imageWidth;
+	SUMT sum = bottom[x2];
+	if( x1 > 0 )
+		sum -= bottom[x1 - 1];
+	if( y1 > 0 ) {
+		const SUMT *top = integralImage + ( y1 - 1 ) * imageWidth;
+		sum -= top[x2];
+		if( x1 > 0 )
+			sum += top[x1 - 1];
+	}
+	return sum;
+}
+
+} } // namespace cinder::ip
@@ -0,0 +1,112 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Filter.h"
+#include "cinder/Exception.h"
+#include "cinder/ip/ExecutionContext.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+template<typename T> class PipelineStage;
+
+/** \brief A lazily evaluated chain of cinder::ip operations on a single channel image
+ *
+ * Each call such as resize() or threshold() returns a new PipelineT with one more stage and does no work. render() then streams the
+ * whole chain a row at a time, so the intermediate images are never allocated: every stage keeps only the few recent rows its successor
+ * reads, and consecutive point-wise stages run fused in a single pass over each row while it is still in cache. Bands of output rows
+ * can be rendered in parallel on an ExecutionContext. Results match the equivalent sequence of ip function calls.
+ * \code Channel8u edges = ip::Pipeline( surface ).resize( Vec2i( 320, 240 ) ).threshold( 128 ).edgeDetectSobel().render( context ); \endcode **/
+template<typename T>
+class PipelineT {
+  public:
+	//! Constructs a null PipelineT
+	PipelineT() {}
+	//! Constructs a PipelineT whose source is \a srcChannel, which must remain unchanged until rendering completes
+	explicit PipelineT( const ChannelT<T> &srcChannel );
+	//! Constructs a PipelineT whose source is the grayscale conversion of \a srcSurface, as computed by ip::grayscale()
+	explicit PipelineT( const SurfaceT<T> &srcSurface );
+
+	//! Returns a PipelineT which additionally resizes the image to \a size using \a filter, like ip::resize()
+	PipelineT	resize( const Vec2i &size, const FilterBase &filter = FilterTriangle() ) const;
+	//! Returns a PipelineT which additionally sets values greater than \a value to the maximum and the rest to \c 0, like ip::threshold(). Point-wise.
+	PipelineT	threshold( T value ) const;
+	//! Returns a PipelineT which additionally inverts each value, mapping \c v to <tt>CHANTRAIT<T>::max() - v</tt>. Point-wise.
+	PipelineT	invert() const;
+	//! Returns a PipelineT which additionally performs Sobel edge detection, like ip::edgeDetectSobel(). The outermost rows and columns, which have no neighbors, are \c 0.
+	PipelineT	edgeDetectSobel() const;
+
+	//! Returns the size of the image the PipelineT renders
+	Vec2i		getSize() const;
+
+	//! Describes one stage of a PipelineT, so that other backends such as gl::ImageProcessor can run the same chain
+	struct StageDesc {
+		enum Type { CHANNEL, GRAYSCALE, RESIZE, THRESHOLD, INVERT, EDGE_DETECT_SOBEL };
+
+		Type			mType;
+		//! The size of the stage's output
+		Vec2i			mSize;
+		//! The value of a THRESHOLD stage
+		T				mValue;
+		//! The source of a CHANNEL stage
+		ChannelT<T>		mChannel;
+		//! The source of a GRAYSCALE stage
+		SurfaceT<T>		mSurface;
+	};
+	//! Returns the stages of the PipelineT, starting with its source
+	std::vector<StageDesc>	getStages() const;
+
+	//! Renders the PipelineT into a newly allocated Channel, optionally processing bands of rows in parallel on \a context
+	ChannelT<T>	render( const ExecutionContextRef &context = ExecutionContextRef() ) const;
+	//! Renders the PipelineT into \a dstChannel, optionally processing bands of rows in parallel on \a context. Throws PipelineExcSizeMismatch if \a dstChannel is not getSize().
+	void		render( ChannelT<T> *dstChannel, const ExecutionContextRef &context = ExecutionContextRef() ) const;
+
+	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<PipelineStage<T> > PipelineT::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mStage.get() == 0 ) ? 0 : &PipelineT::mStage; }
+	void reset() { mStage.reset(); }
+	//@}
+
+  protected:
+	explicit PipelineT( const std::shared_ptr<PipelineStage<T> > &stage ) : mStage( stage ) {}
+
+	std::shared_ptr<PipelineStage<T> >	mStage;
+};
+
+typedef PipelineT<uint8_t>	Pipeline;
+typedef PipelineT<uint8_t>	Pipeline8u;
+typedef PipelineT<uint16_t>	Pipeline16u;
+typedef PipelineT<float>	Pipeline32f;
+
+class PipelineExcSizeMismatch : public cinder::Exception {
+};
+
+} } // namespace cinder::ip
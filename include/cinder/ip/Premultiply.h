@@ -24,6 +24,7 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Surface.h"
+#include "cinder/ip/ExecutionContext.h"
 
 namespace cinder { namespace ip {
 
@@ -35,4 +36,12 @@ void premultiply( SurfaceT<T> *surface );
 template<typename T>
 void unpremultiply( SurfaceT<T> *surface );
 
+/** Premultiplies the contents of a Surface using its own alpha channel, processing bands of rows in parallel on \a context. Marks the Surface as being premultiplied. **/
+template<typename T>
+void premultiply( SurfaceT<T> *surface, const ExecutionContextRef &context );
+
+/** Unpremultiplies the contents of a Surface using its own alpha channel, processing bands of rows in parallel on \a context. Marks the Surface as being unpremultiplied. **/
+template<typename T>
+void unpremultiply( SurfaceT<T> *surface, const ExecutionContextRef &context );
+
 } } // namespace cinder::ip
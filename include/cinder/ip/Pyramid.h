@@ -0,0 +1,66 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/Channel.h"
+#include "cinder/ip/ExecutionContext.h"
+
+#include <vector>
+
+namespace cinder { namespace ip {
+
+//! The filters buildPyramid() can reduce each level with
+enum PyramidFilter {
+	//! Averages each 2x2 block of pixels, as OpenGL mipmap generation does
+	PYRAMID_BOX,
+	//! Weights the 4x4 pixels around each 2x2 block by the binomial ( 1 3 3 1 ), a closer approximation of a Gaussian which keeps levels aligned like PYRAMID_BOX
+	PYRAMID_GAUSSIAN
+};
+
+/*	buildPyramid() returns the source as level 0 followed by levels of half the size of the one before, rounding down and no smaller
+	than 1 pixel, down to 1x1 or until \a maxLevels levels (0 for no limit). These are the sizes OpenGL expects of a mip chain, so the
+	result can be uploaded with gl::Texture::updateMipmaps(). Every level after the first is planar, tightly packed and shares a single
+	allocation, which is freed along with the last of them. Integer levels are rounded to nearest. The 8 bit and float box filters use SSE2. */
+
+//! Returns \a channel and its successively halved levels reduced with \a filter
+template<typename T>
+std::vector<ChannelT<T> > buildPyramid( const ChannelT<T> &channel, PyramidFilter filter = PYRAMID_BOX, int32_t maxLevels = 0 );
+//! Returns \a channel and its successively halved levels, processing bands of rows of each level in parallel on \a context
+template<typename T>
+std::vector<ChannelT<T> > buildPyramid( const ChannelT<T> &channel, PyramidFilter filter, int32_t maxLevels, const ExecutionContextRef &context );
+//! Returns \a surface and its successively halved levels reduced with \a filter, including alpha. The levels share \a surface's channel order.
+template<typename T>
+std::vector<SurfaceT<T> > buildPyramid( const SurfaceT<T> &surface, PyramidFilter filter = PYRAMID_BOX, int32_t maxLevels = 0 );
+//! Returns \a surface and its successively halved levels, processing bands of rows of each level in parallel on \a context
+template<typename T>
+std::vector<SurfaceT<T> > buildPyramid( const SurfaceT<T> &surface, PyramidFilter filter, int32_t maxLevels, const ExecutionContextRef &context );
+
+//! Returns the number of levels in a full pyramid of an image of \a size, including the image itself
+int32_t getNumPyramidLevels( const Vec2i &size );
+
+} } // namespace cinder::ip
@@ -25,6 +25,8 @@
 #include "cinder/Surface.h"
 #include "cinder/Filter.h"
 #include "cinder/Rect.h"
+#include "cinder/ip/ExecutionContext.h"
+#include "cinder/Exception.h"
 
 namespace cinder { namespace ip {
 
@@ -39,5 +41,59 @@ template<typename T>
 SurfaceT<T> resizeCopy( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstSize, const FilterBase &filter = FilterTriangle() );
 template<typename T>
 void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter = FilterTriangle() );
+//! Resizes \a srcArea of \a srcSurface into \a dstArea of \a dstSurface, processing bands of destination rows in parallel on \a context
+template<typename T>
+void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter, const ExecutionContextRef &context );
+//! Resizes \a srcArea of \a srcChannel into \a dstArea of \a dstChannel, processing bands of destination rows in parallel on \a context
+template<typename T>
+void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter, const ExecutionContextRef &context );
+
+template<typename T> struct ResampleParams;
+template<typename T> struct ResizeRowCache;
+
+/** \brief Resizes images of a fixed source size to a fixed destination size, sampling the filter only once
+ *
+ * The horizontal and vertical filter weights are computed at construction and reused by every call to resize(), which makes
+ * a ResizerT well suited to repeatedly scaling video frames or thumbnails between the same sizes. 8 bit images are filtered in fixed point. **/
+template<typename T>
+class ResizerT {
+  public:
+	//! Constructs a null ResizerT
+	ResizerT() {}
+	//! Constructs a ResizerT which scales images of size \a srcSize to images of size \a dstSize using \a filter
+	ResizerT( const Vec2i &srcSize, const Vec2i &dstSize, const FilterBase &filter = FilterTriangle() );
+
+	//! Resizes \a srcSurface into \a dstSurface, optionally processing bands of destination rows in parallel on \a context. Throws ResizerExcSizeMismatch if the sizes differ from the ResizerT's.
+	void	resize( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const ExecutionContextRef &context = ExecutionContextRef() ) const;
+	//! Resizes \a srcChannel into \a dstChannel, optionally processing bands of destination rows in parallel on \a context. Throws ResizerExcSizeMismatch if the sizes differ from the ResizerT's.
+	void	resize( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ExecutionContextRef &context = ExecutionContextRef() ) const;
+
+	//! Returns the scratch state resizeRow() needs. A cache must not be shared between threads.
+	std::shared_ptr<ResizeRowCache<T> >	createRowCache() const;
+	//! Resizes the single destination row \a dstY into the getDstSize().x values of \a dstRow, reading the contiguous source rows it needs from \a srcRows.
+	/** \a cache keeps horizontally filtered source rows, so resizing consecutive rows requests each source row only once. Pointers returned by \a srcRows need only stay valid until it is next called. **/
+	void	resizeRow( int32_t dstY, const std::function<const T*(int32_t)> &srcRows, T *dstRow, ResizeRowCache<T> *cache ) const;
+
+	const Vec2i&	getSrcSize() const { return mSrcSize; }
+	const Vec2i&	getDstSize() const { return mDstSize; }
+
+	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<ResampleParams<T> > ResizerT::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mParams.get() == 0 ) ? 0 : &ResizerT::mParams; }
+	void reset() { mParams.reset(); }
+	//@}
+
+  protected:
+	Vec2i									mSrcSize, mDstSize;
+	std::shared_ptr<ResampleParams<T> >		mParams;
+};
+
+typedef ResizerT<uint8_t>	Resizer;
+typedef ResizerT<uint8_t>	Resizer8u;
+typedef ResizerT<float>		Resizer32f;
+
+class ResizerExcSizeMismatch : public cinder::Exception {
+};
 
 } } // namespace cinder::ip
@@ -0,0 +1,67 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "cinder/Cinder.h"
+
+// SIMD code paths compiled into cinder::ip. SSE2 paths are additionally gated at runtime by System::hasSse2()
+#if defined( _M_IX86 ) || defined( _M_X64 ) || defined( __i386__ ) || defined( __x86_64__ )
+	#define CINDER_IP_SSE2
+#elif defined( __ARM_NEON__ )
+	#define CINDER_IP_NEON
+#endif
+
+// SSSE3 paths additionally require a compiler which accepts SSSE3 intrinsics: Visual C++, or GCC and Clang with -mssse3 or higher. They are gated at runtime by System::hasSsse3()
+#if defined( CINDER_IP_SSE2 ) && ( defined( _MSC_VER ) || defined( __SSSE3__ ) )
+	#define CINDER_IP_SSSE3
+#endif
+
+// F16C paths likewise require Visual C++ 2012 or GCC and Clang with -mf16c or higher, and are gated at runtime by System::hasF16c()
+#if defined( CINDER_IP_SSE2 ) && ( ( defined( _MSC_VER ) && ( _MSC_VER >= 1700 ) ) || defined( __F16C__ ) )
+	#define CINDER_IP_F16C
+#endif
+
+// NEON half precision conversions require a VFP with half precision support, such as -mfpu=neon-fp16 on ARMv7
+#if defined( CINDER_IP_NEON ) && defined( __ARM_FP ) && ( __ARM_FP & 2 )
+	#define CINDER_IP_NEON_FP16
+#endif
+
+namespace cinder { namespace ip {
+
+//! Enables or disables the SIMD code paths of cinder::ip, which are enabled by default. Primarily useful for benchmarking and testing the scalar fallbacks.
+void	setSimdEnabled( bool enable = true );
+//! Returns whether cinder::ip is allowed to use SIMD code paths
+bool	isSimdEnabled();
+
+//! Returns whether the SSE2 code paths of cinder::ip should be used: compiled in, enabled and supported by the CPU
+bool	useSse2();
+//! Returns whether the SSSE3 code paths of cinder::ip should be used: compiled in, enabled and supported by the CPU
+bool	useSsse3();
+//! Returns whether the F16C code paths of cinder::ip should be used: compiled in, enabled and supported by the CPU
+bool	useF16c();
+//! Returns whether the NEON code paths of cinder::ip should be used: compiled in and enabled
+bool	useNeon();
+
+} } // namespace cinder::ip
@@ -0,0 +1,81 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Surface.h"
+#include "cinder/ip/ExecutionContext.h"
+
+namespace cinder { namespace ip {
+
+/*	Every function here returns exactly the same result whether it runs on the scalar or the SIMD code path and however many threads
+	an ExecutionContext splits it across. Floating point sums are accumulated in double precision in a fixed order: each row of a planar
+	Channel is summed as four interleaved partial sums, each Surface channel and each non-planar Channel is summed sequentially, and rows
+	are added top to bottom. Variances are population variances. NaNs are ignored by getMinMax() unless the first value is one. */
+
+//! Determines the minimum and maximum values of \a channel
+template<typename T>
+void getMinMax( const ChannelT<T> &channel, T *resultMin, T *resultMax );
+//! Determines the minimum and maximum values of \a channel, processing bands of rows in parallel on \a context
+template<typename T>
+void getMinMax( const ChannelT<T> &channel, T *resultMin, T *resultMax, const ExecutionContextRef &context );
+//! Determines the minimum and maximum values of each channel of \a surface. The alpha of the results is \c CHANTRAIT<T>::max() when \a surface has no alpha channel.
+template<typename T>
+void getMinMax( const SurfaceT<T> &surface, ColorAT<T> *resultMin, ColorAT<T> *resultMax );
+//! Determines the minimum and maximum values of each channel of \a surface, processing bands of rows in parallel on \a context
+template<typename T>
+void getMinMax( const SurfaceT<T> &surface, ColorAT<T> *resultMin, ColorAT<T> *resultMax, const ExecutionContextRef &context );
+
+//! Returns the sum of the values of \a channel
+template<typename T>
+double getSum( const ChannelT<T> &channel );
+//! Returns the sum of the values of \a channel, processing bands of rows in parallel on \a context
+template<typename T>
+double getSum( const ChannelT<T> &channel, const ExecutionContextRef &context );
+
+//! Determines the mean and variance of the values of \a channel. Either result pointer may be \c NULL.
+template<typename T>
+void getMeanVariance( const ChannelT<T> &channel, double *resultMean, double *resultVariance );
+//! Determines the mean and variance of the values of \a channel, processing bands of rows in parallel on \a context. Either result pointer may be \c NULL.
+template<typename T>
+void getMeanVariance( const ChannelT<T> &channel, double *resultMean, double *resultVariance, const ExecutionContextRef &context );
+//! Determines the mean and variance of each channel of \a surface, in the units of \a T. Either result pointer may be \c NULL. The alpha of the results is \c 0 when \a surface has no alpha channel.
+template<typename T>
+void getMeanVariance( const SurfaceT<T> &surface, ColorAf *resultMean, ColorAf *resultVariance );
+//! Determines the mean and variance of each channel of \a surface, processing bands of rows in parallel on \a context
+template<typename T>
+void getMeanVariance( const SurfaceT<T> &surface, ColorAf *resultMean, ColorAf *resultVariance, const ExecutionContextRef &context );
+
+//! Counts the values of \a channel into the \a numBins equally wide bins of \a resultBins, which span \a minValue through \a maxValue inclusive.
+/** Values outside of that range, and NaNs, are not counted. Integer ranges are split over their <tt>maxValue - minValue + 1</tt> distinct values.
+	Use SurfaceT::getChannelRed() and its siblings to take the histogram of a Surface channel. **/
+template<typename T>
+void calculateHistogram( const ChannelT<T> &channel, int32_t numBins, T minValue, T maxValue, uint32_t *resultBins );
+//! Counts the values of \a channel into the \a numBins bins of \a resultBins, processing bands of rows in parallel on \a context
+template<typename T>
+void calculateHistogram( const ChannelT<T> &channel, int32_t numBins, T minValue, T maxValue, uint32_t *resultBins, const ExecutionContextRef &context );
+
+} } // namespace cinder::ip
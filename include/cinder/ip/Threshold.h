@@ -24,6 +24,8 @@
 
 #include "cinder/Cinder.h"
 #include "cinder/Surface.h"
+#include "cinder/ip/ExecutionContext.h"
+#include "cinder/Exception.h"
 
 namespace cinder { namespace ip {
 
@@ -39,6 +41,15 @@ void threshold( const SurfaceT<T> &srcSurface, T value, SurfaceT<T> *dstSurface
 //! Thresholds \a srcChannel setting any values below \a value to zero and any values above to unity and storing the result in \a dstChannel
 template<typename T>
 void threshold( const ChannelT<T> &srcSurface, T value, ChannelT<T> *dstSurface );
+//! Thresholds \a surface inside the Area \a area, processing bands of rows in parallel on \a context
+template<typename T>
+void threshold( SurfaceT<T> *surface, T value, const Area &area, const ExecutionContextRef &context );
+//! Thresholds \a srcSurface and stores the result in \a dstSurface, processing bands of rows in parallel on \a context
+template<typename T>
+void threshold( const SurfaceT<T> &srcSurface, T value, SurfaceT<T> *dstSurface, const ExecutionContextRef &context );
+//! Thresholds \a srcChannel and stores the result in \a dstChannel, processing bands of rows in parallel on \a context
+template<typename T>
+void threshold( const ChannelT<T> &srcChannel, T value, ChannelT<T> *dstChannel, const ExecutionContextRef &context );
 //! Thresholds \a srcChannel using an adaptive thresholding algorithm which considers a window of size \a windowSize pixels and stores the result in \a dstChannel.
 /** Implements the algorithm described in "Adaptive Thresholding Using the Integral Image" by Bradley & Roth. The srcSurface.getWidth() / 8 is a good default for \a windowSize and 0.15 is for \a percentageDelta **/
 template<typename T>
@@ -73,6 +84,14 @@ class AdaptiveThresholdT {
 	AdaptiveThresholdT() {};
 	AdaptiveThresholdT( ChannelT<T> *channel );
 	void calculate( int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel );
+	//! Thresholds only the pixels of \a dstChannel whose window overlaps \a dirtyArea, leaving the rest of \a dstChannel untouched. Pair with update() for streaming input.
+	void calculate( int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel, const Area &dirtyArea );
+
+	//! Updates the integral image after the pixels of the channel inside \a dirtyArea changed. Only the rows and columns at or past the top-left of \a dirtyArea are recalculated.
+	void update( const Area &dirtyArea );
+	//! Switches to thresholding \a channel, which must match the size of the original channel, and updates the integral image for the pixels inside \a dirtyArea where it differs from the previous channel.
+	/** Allows double-buffering: a camera can fill one Channel while the other is thresholded. Throws AdaptiveThresholdExcSizeMismatch if the sizes differ. **/
+	void update( ChannelT<T> *channel, const Area &dirtyArea );
 	
 	//@{
 	//! Emulates shared_ptr-like behavior
@@ -88,4 +107,7 @@ typedef AdaptiveThresholdT<uint8_t>		AdaptiveThreshold;
 typedef AdaptiveThresholdT<uint8_t>		AdaptiveThreshold8u;
 typedef AdaptiveThresholdT<float>		AdaptiveThreshold32f;
 
+class AdaptiveThresholdExcSizeMismatch : public cinder::Exception {
+};
+
 } } // namespace cinder::ip
@@ -37,8 +37,20 @@ class InterfaceGl {
 	InterfaceGl() {}
 	InterfaceGl( const std::string &title, const Vec2i &size, const ColorA = ColorA( 0.3f, 0.3f, 0.3f, 0.4f ) );
 	
+	//! Draws every bar. With the draw cache enabled this usually just draws a texture.
 	static void		draw();
 
+	/** Caches the drawn bars in a texture which is redrawn only when a parameter's value, a bar's layout or the window size changes, and during the second after any input.
+		AntTweakBar draws every bar in one call, so all bars share a single window-sized cache. Off by default. **/
+	static void		enableDrawCache( bool enable = true );
+	static bool		isDrawCacheEnabled();
+	//! Forces the draw cache to be redrawn on the next draw(), for changes it can't observe such as a parameter variable being reallocated
+	static void		invalidateDrawCache();
+	/** Sets how often, in seconds, the draw cache checks read-only parameters for changes, which throttles redraws caused by live values such as counters.
+		Read-write parameters are checked every frame. Defaults to \c 0.2, AntTweakBar's own refresh interval. **/
+	static void		setReadOnlyRefreshInterval( double seconds );
+	static double	getReadOnlyRefreshInterval();
+
 	void	show( bool visible = true );
 	void	hide();
 	bool	isVisible() const;
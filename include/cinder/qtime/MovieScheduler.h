@@ -0,0 +1,144 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#pragma once
+
+// QuickTime movies are only available in 32 bit builds
+#if ! defined( __LP64__ )
+
+#include "cinder/Cinder.h"
+#include "cinder/qtime/QuickTime.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/Thread.h"
+#include "cinder/Function.h"
+#include "cinder/Timer.h"
+#include "cinder/ConcurrentCircularBuffer.h"
+
+#include <boost/noncopyable.hpp>
+#include <vector>
+
+namespace cinder { namespace qtime {
+
+typedef std::shared_ptr<class MovieScheduler>	MovieSchedulerRef;
+
+/** \brief Plays many MovieSurfaces in sync on a shared pool of decode threads.
+	Each movie is bound to one worker thread, which decodes its frames slightly ahead of a master clock into Surfaces. update(), called once per frame on the main thread,
+	picks the frame due for each movie and uploads it to that movie's texture; the main thread never calls into QuickTime for a scheduled movie.
+	Movies are stepped frame by frame rather than played, so their audio is not heard. A MovieSurface must not be used directly while it belongs to a MovieScheduler. **/
+class MovieScheduler : private boost::noncopyable {
+  public:
+	//! Creates a MovieScheduler with \a numThreads decode threads, or one per core up to four when \c 0, each of which decodes up to \a prefetchFrames frames ahead of the clock
+	static MovieSchedulerRef	create( uint32_t numThreads = 0, uint32_t prefetchFrames = 3 ) { return MovieSchedulerRef( new MovieScheduler( numThreads, prefetchFrames ) ); }
+	~MovieScheduler();
+
+	//! Adds \a movie, which wraps back to its start when \a loop is \c true and otherwise holds its last frame. Returns the movie's index.
+	size_t		addMovie( const MovieSurface &movie, bool loop = true );
+	//! Returns the number of movies added
+	size_t		getNumMovies() const { return mMovies.size(); }
+	//! Removes all movies, returning control of them to the calling thread
+	void		clear();
+
+	//! Picks up the frame due at the current clock time for each movie. Call once per frame from the thread which owns the OpenGL context.
+	void		update();
+	//! Returns the texture holding the current frame of movie \a index, bound to the \c GL_TEXTURE_RECTANGLE_ARB target. Null until its first frame has been decoded.
+	gl::Texture	getTexture( size_t index ) const { return mMovies[index]->mTexture; }
+	//! Returns the Surface holding the current frame of movie \a index
+	Surface8u	getSurface( size_t index ) const { return mMovies[index]->mSurface; }
+
+	//! Starts or resumes the master clock. The clock starts paused.
+	void		play();
+	//! Pauses the master clock
+	void		stop();
+	//! Returns whether the master clock is running
+	bool		isPlaying() const;
+	//! Returns the time of the master clock in seconds
+	double		getTime() const;
+	//! Sets the master clock to \a seconds, discarding any prefetched frames
+	void		seekToTime( double seconds );
+
+	//! Returns the number of frames which were skipped because they were decoded too late to be shown
+	uint32_t	getNumDroppedFrames() const;
+
+  private:
+	MovieScheduler( uint32_t numThreads, uint32_t prefetchFrames );
+
+	struct Frame {
+		Frame() : mEpoch( 0 ), mTime( 0 ) {}
+
+		uint32_t	mEpoch;
+		double		mTime;
+		Surface8u	mSurface;
+	};
+
+	struct Entry {
+		MovieSurface	mMovie;
+		bool			mLoop;
+		double			mDuration, mFrameDuration;
+		// written only by the worker thread
+		uint32_t		mWorkerEpoch;
+		double			mNextTime;
+		bool			mAttached;
+		uint32_t		mNumWorkerDropped;
+
+		ConcurrentCircularBuffer<Frame>		mReady;
+
+		// accessed only by the main thread
+		Frame			mPending;
+		bool			mHasPending;
+		uint32_t		mNumDropped;
+		Surface8u		mSurface;
+		gl::Texture		mTexture;
+		gl::TextureCache	mTextureCache;
+
+		Entry( const MovieSurface &movie, bool loop, uint32_t prefetchFrames );
+	};
+
+	struct Worker {
+		std::mutex						mMutex;
+		std::vector<std::shared_ptr<Entry> >	mEntries;
+		std::shared_ptr<std::thread>	mThread;
+	};
+
+	void		startWorkers();
+	void		stopWorkers();
+	void		reclaimMovies();
+	void		workerThreadFn( Worker *worker );
+	bool		serviceEntry( Entry *entry, uint32_t epoch, double clock );
+	void		getClock( double *resultTime, uint32_t *resultEpoch ) const;
+
+	uint32_t								mPrefetchFrames;
+	std::vector<std::shared_ptr<Worker> >	mWorkers;
+	std::vector<std::shared_ptr<Entry> >	mMovies;
+	volatile bool							mQuit;
+
+	mutable std::mutex		mClockMutex;
+	Timer					mTimer;
+	double					mClockOffset;
+	uint32_t				mEpoch;
+};
+
+} } // namespace cinder::qtime
+
+#endif // ! defined( __LP64__ )
@@ -26,6 +26,10 @@
 #include "cinder/qtime/QuickTime.h"
 #include "cinder/ImageIo.h"
 #include "cinder/Stream.h"
+#include "cinder/Surface.h"
+#include "cinder/SurfacePool.h"
+#include "cinder/Thread.h"
+#include "cinder/ConcurrentCircularBuffer.h"
 
 #include <string>
 
@@ -106,6 +110,11 @@ class MovieWriter {
 		bool		isMultiPass() const { return mEnableMultiPass; }
 		//! Enables multiPass encoding. Defaults to \c false. While multiPass encoding can result in significantly smaller movies, it often takes much longer to compress and requires the creation of two temporary files for storing intermediate results.
 		Format&		enableMultiPass( bool enable = true ) { mEnableMultiPass = enable; return *this; }
+		//! Returns the number of frames which may be queued for encoding on a background thread. Defaults to \c 0, meaning frames are encoded synchronously by addFrame().
+		uint32_t	getAsyncQueueSize() const { return mAsyncQueueSize; }
+		/** Enables asynchronous encoding when \a numFrames is greater than \c 0. Frames are converted and compressed on a background thread, and addFrame() blocks only when \a numFrames frames are already waiting.
+			Defaults to \c 0, which encodes synchronously. A handful of frames is usually enough to absorb the encoder's jitter. **/
+		Format&		setAsyncQueueSize( uint32_t numFrames ) { mAsyncQueueSize = numFrames; return *this; }
 
 	  private:
 		void		initDefaults();
@@ -116,6 +125,7 @@ class MovieWriter {
 		float		mQualityFloat;
 		float		mGamma;
 		bool		mEnableMultiPass;
+		uint32_t	mAsyncQueueSize;
 
 		ICMCompressionSessionOptionsRef		mOptions;
 
@@ -150,9 +160,17 @@ class MovieWriter {
 	/** \brief Appends a frame to the Movie. The optional \a duration parameter allows a frame to be inserted for a time other than the Format's default duration.
 		\note Calling addFrame() after a call to finish() will throw a MovieWriterExcAlreadyFinished exception. **/
 	void addFrame( const ImageSourceRef &imageSource, float duration = -1.0f ) { mObj->addFrame( imageSource, duration ); }
+	/** \brief Appends \a surface to the Movie. When the Format enables asynchronous encoding the MovieWriter takes ownership of \a surface, which must not be modified afterwards, and no copy is made on the calling thread.
+		Allocating frames from getSurfacePool() lets their buffers be recycled once they are encoded. **/
+	void addFrame( const Surface8u &surface, float duration = -1.0f ) { mObj->addFrame( surface, duration ); }
 	
-	//! Returns the number of frames in the movie
-	uint32_t	getNumFrames() const { return mObj->mNumFrames; }
+	//! Returns the pool from which Surfaces passed to addFrame() should be allocated so that their buffers are recycled after encoding
+	SurfacePoolRef	getSurfacePool() const { return mObj->mSurfacePool; }
+	//! Returns whether frames are encoded on a background thread. Set with Format::setAsyncQueueSize().
+	bool		isAsync() const { return mObj->mQueue.get() != 0; }
+
+	//! Returns the number of frames in the movie. In asynchronous mode this includes frames which are still waiting to be encoded.
+	uint32_t	getNumFrames() const { return mObj->mNumFramesAdded; }
 
 	//! Completes the encoding of the movie and closes the file. Calling finish() more than once has no effect.
 	void finish() { mObj->finish(); }
@@ -166,8 +184,14 @@ class MovieWriter {
 		~Obj();
 		
 		void	addFrame( const ImageSourceRef &imageSource, float duration );
+		void	addFrame( const Surface8u &surface, float duration );
+		void	encodeFrame( const ImageSourceRef &imageSource, float duration );
 		void	createCompressionSession();
 		void	finish();
+
+		void	startEncodeThread();
+		void	stopEncodeThread();
+		void	encodeThreadFn();
 		
 		static OSStatus encodedFrameOutputCallback( void *refCon, ::ICMCompressionSessionRef session, OSStatus err, ICMEncodedFrameRef encodedFrame, void *reserved );
 
@@ -178,7 +202,7 @@ class MovieWriter {
 		::ICMCompressionSessionRef		mCompressionSession;
 		::ICMCompressionPassModeFlags 	mMultiPassModeFlags;		
 		fs::path		mPath;
-		uint32_t		mNumFrames;
+		uint32_t		mNumFrames, mNumFramesAdded;
 		int64_t			mCurrentTimeValue;
 		
 		int32_t		mWidth, mHeight;
@@ -188,6 +212,12 @@ class MovieWriter {
 		IoStreamRef		mMultiPassFrameCache;
 
 		std::vector<std::pair<int64_t,int64_t> >	mFrameTimes;
+
+		// asynchronous encoding; an empty Surface in the queue signals the encode thread to exit
+		std::shared_ptr<ConcurrentCircularBuffer<std::pair<Surface8u,float> > >	mQueue;
+		std::shared_ptr<std::thread>	mEncodeThread;
+		SurfacePoolRef					mSurfacePool;
+		volatile bool					mEncodeFailed;
 	};
 	/// \endcond
 	
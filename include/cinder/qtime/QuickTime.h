@@ -28,6 +28,7 @@
 #include "cinder/Cinder.h"
 #include "cinder/gl/gl.h"
 #include "cinder/Surface.h"
+#include "cinder/YuvSurface.h"
 #include "cinder/gl/Texture.h"
 #include "cinder/Display.h"
 #include "cinder/Url.h"
@@ -35,6 +36,7 @@
 #include "cinder/Thread.h"
 
 #include <string>
+#include <vector>
 
 #if defined( CINDER_MAC )
 	#include <QuickTime/QuickTime.h>
@@ -119,6 +121,16 @@ class MovieBase {
 	//! Sets the playback rate, which begins playback immediately for nonzero values. 1.0 represents normal speed. Negative values indicate reverse playback and \c 0 stops.
 	void		setRate( float rate );
 
+	/** Sets the number of decoded frames kept for seeking and stepping while the movie is stopped. Defaults to \c 16, and \c 0 disables the cache.
+		Stepping backward decodes the frames before its target from their keyframe in one pass, so that the following steps back are served from the cache. **/
+	void		setFrameCacheSize( size_t frames );
+	//! Returns the number of decoded frames kept for seeking and stepping while the movie is stopped
+	size_t		getFrameCacheSize() const { return getObj()->mFrameCacheSize; }
+	//! Returns whether the index of frame and keyframe times is complete. It is built a few frames at a time as the movie updates, and as far as needed when seeking.
+	bool		isFrameIndexComplete() const { return getObj()->mFrameIndexComplete; }
+	//! Returns the last keyframe at or before \a frame, the frame decoding has to start from to display \a frame
+	int32_t		findKeyframe( int32_t frame );
+
 	//! Sets the audio playback volume ranging from [0 - 1.0]
 	void		setVolume( float volume );
 	//! Gets the audio playback volume ranging from [0 - 1.0]
@@ -161,6 +173,18 @@ class MovieBase {
 	static int32_t		countFrames( ::Movie theMovie );
 	TimeValue			getStartTimeOfFirstSample() const;
 
+	// the frame index and decoded frame cache, called with the Obj locked
+	void				indexFrames( size_t maxSteps );
+	int32_t				findFrame( TimeValue time, bool extendIndex );
+	int32_t				findKeyframeLocked( int32_t frame );
+	TimeValue			getPlayheadTime() const;
+	void				applyPendingTime();
+	void				seekToMovieTime( TimeValue time, bool task );
+	void				seekToIndexedFrame( int32_t frame, bool fillCache );
+	bool				showCachedFrame( TimeValue frameTime );
+	void				cacheFrame( TimeValue frameTime, CVImageBufferRef image );
+	void				trimFrameCache( size_t frames );
+
  protected:
 	void	initFromPath( const fs::path &filePath );
 	void	initFromLoader( const class MovieLoader &loader );
@@ -197,11 +221,25 @@ class MovieBase {
 		void		(*mNewFrameCallback)(long timeValue, void *refcon);
 		void		*mNewFrameCallbackRefcon;			
 
+		// start times of every video sample and every keyframe, indexed incrementally from mFrameIndexTime and mKeyframeIndexTime, which are -1 when done
+		std::vector<TimeValue>		mFrameTimes, mKeyframeTimes;
+		TimeValue					mFrameIndexTime, mKeyframeIndexTime;
+		bool						mFrameIndexComplete;
+		// decoded frames keyed by their start time, least recently shown first
+		std::vector<std::pair<TimeValue,CVImageBufferRef> >	mFrameCache;
+		size_t						mFrameCacheSize;
+		// the time of a frame shown from the cache which hasn't been set on the movie yet, or -1
+		TimeValue					mPendingTime;
+		// whether a frame shown from the cache has yet to be reported by checkNewFrame()
+		bool						mCachedFrameNew;
+
 		std::mutex					mMutex;	
 		DataSourceRef				mDataSource; // sometimes used to retain a reference to a data source so that it doesn't go away before we do
 	};
 	
 	virtual Obj*		getObj() const = 0;
+
+	friend class MovieScheduler;
 };
 
 class MovieSurface : public MovieBase {
@@ -232,6 +270,8 @@ class MovieSurface : public MovieBase {
 	std::shared_ptr<Obj>		mObj;
 	virtual MovieBase::Obj*		getObj() const { return mObj.get(); }
 
+	friend class MovieScheduler;
+
   public:
  	//@{
 	//! Emulates shared_ptr-like behavior
@@ -241,8 +281,50 @@ class MovieSurface : public MovieBase {
 	//@}
 };
 
+/** \brief QuickTime movie playback as YpCbCr 4:2:0 frames
+ *	Frames are decoded to I420 and handed out as YuvSurfaces which share QuickTime's pixel buffers. Drawing them through gl::YuvTexture converts them to RGB on the GPU,
+ *	uploading half as many bytes per frame as a MovieSurface and skipping the decoder's own conversion to RGB.
+**/
+class MovieYuv : public MovieBase {
+ public:
+	MovieYuv() : MovieBase() {}
+	MovieYuv( const fs::path &path );
+	MovieYuv( const class MovieLoader &loader );
+	//! Constructs a MovieYuv from a block of memory of size \a dataSize pointed to by \a data, which must not be disposed of during the lifetime of the movie.
+	/** \a fileNameHint and \a mimeTypeHint provide important hints to QuickTime about the contents of the file. Omit both of them at your peril. "video/quicktime" is often a good choice for \a mimeTypeHint. **/
+	MovieYuv( const void *data, size_t dataSize, const std::string &fileNameHint, const std::string &mimeTypeHint = "" );
+	MovieYuv( DataSourceRef dataSource, const std::string mimeTypeHint = "" );
+
+	//! Returns the YuvSurface representing the Movie's current frame
+	YuvSurface	getYuvSurface();
+
+ protected:
+	void				allocateVisualContext();
+ 
+ 	struct Obj : public MovieBase::Obj {
+		virtual ~Obj();
+		
+		virtual void		releaseFrame(); 
+		virtual void		newFrame( CVImageBufferRef cvImage );
+	
+		YuvSurface			mYuvSurface;
+	};
+ 	
+	std::shared_ptr<Obj>		mObj;
+	virtual MovieBase::Obj*		getObj() const { return mObj.get(); }
+
+  public:
+ 	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<Obj> MovieYuv::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &MovieYuv::mObj; }
+	void reset() { mObj.reset(); }
+	//@}
+};
+
 /** \brief QuickTime movie playback as OpenGL textures
  *	Textures are always bound to the \c GL_TEXTURE_RECTANGLE_ARB target
+ *	On Mac OS X each frame is decoded into a texture by QuickTime's OpenGL visual context and handed out without copying; on Windows frames are uploaded into a reused texture.
  *	\remarks On Mac OS X, the destination CGLContext must be the current context when the MovieGl is constructed. If that doesn't mean anything to you, you should be fine. A call to app::restoreWindowContext() can be used to force this to be the case.
 **/
 class MovieGl : public MovieBase {
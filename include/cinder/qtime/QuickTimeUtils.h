@@ -25,6 +25,7 @@
 #include "cinder/Cinder.h"
 #include "cinder/Url.h"
 #include "cinder/Surface.h"
+#include "cinder/YuvSurface.h"
 #include "cinder/ImageIo.h"
 
 #include <string>
@@ -58,7 +59,9 @@ bool dictionarySetPixelBufferSize( const unsigned int width, const unsigned int
 bool dictionarySetPixelBufferBytesPerRowAlignment( CFMutableDictionaryRef dict );
 void dictionarySetPixelBufferOpenGLCompatibility( CFMutableDictionaryRef dict );
 bool dictionarySetPixelBufferOptions( unsigned int width, unsigned int height, bool alpha, CFMutableDictionaryRef *pixelBufferOptions );
+bool dictionarySetPixelBufferOptionsForFormat( unsigned int width, unsigned int height, OSType pixelFormat, CFMutableDictionaryRef *pixelBufferOptions );
 CFMutableDictionaryRef initQTVisualContextOptions( int width, int height, bool alpha );
+CFMutableDictionaryRef initQTVisualContextOptionsForFormat( int width, int height, OSType pixelFormat );
 
 ::Movie openMovieFromUrl( const Url &url );
 ::Movie openMovieFromPath( const fs::path &path );
@@ -70,6 +73,8 @@ CFMutableDictionaryRef initQTVisualContextOptions( int width, int height, bool a
 static void CVPixelBufferDealloc( void *refcon );
 //! Makes a cinder::Surface form a CVPixelBufferRef, setting a proper deallocation function to free the CVPixelBufferRef upon the destruction of the Surface::Obj
 Surface8u convertCVPixelBufferToSurface( CVPixelBufferRef pixelBufferRef );
+//! Makes an I420 cinder::YuvSurface from the planes of a \c kYUV420PixelFormat CVPixelBufferRef without copying them, releasing the CVPixelBufferRef upon the destruction of the YuvSurface::Obj
+YuvSurface convertCVPixelBufferToYuvSurface( CVPixelBufferRef pixelBufferRef );
 
 #endif // ! defined( __LP64__ )
 
@@ -25,7 +25,7 @@
 #pragma once
 
 #include "cinder/Cinder.h"
-#include "cinder/Xml.h"
+#include "cinder/XmlView.h"
 #include "cinder/Vector.h"
 #include "cinder/Color.h"
 #include "cinder/Shape2d.h"
@@ -181,7 +181,7 @@ class Paint {
 class Style {
   public:
 	Style();
-	Style( const XmlTree &xml, const Node *parent );
+	Style( const XmlView &xml, const Node *parent );
 
 	//! Returns a Style set appropriately for global defaults
 	static Style	makeGlobalDefaults();
@@ -310,7 +310,7 @@ class Style {
 //! Base class for an element of an SVG Document
 class Node {
   public:
-	Node( const Node *parent ) : mParent( parent ),  mSpecifiesTransform( false ), mBoundingBoxCached( false ) {}
+	Node( const Node *parent ) : mParent( parent ),  mSpecifiesTransform( false ), mBoundingBoxCached( false ), mRevision( 0 ) {}
 	virtual ~Node() {}
 	
 	//! Returns the svg::Doc this Node is an element of
@@ -324,7 +324,7 @@ class Node {
 	//! Returns the style elements defined on this Node but not inherited from ancestors.
 	const Style&		getStyle() const { return mStyle; }
 	//! Sets the style defined on this Node but not inherited from ancestors.
-	void				setStyle( const Style &style ) { mStyle = style; }
+	void				setStyle( const Style &style ) { mStyle = style; invalidate(); }
 	//! Returns the node's Style, including attributes inherited from its ancestors for attributes it does not specify
 	Style				calcInheritedStyle() const;
 
@@ -344,9 +344,9 @@ class Node {
 	//! Returns the local transformation of this node. Returns identity if the Node's transform isn't specified.
 	MatrixAffine2f		getTransform() const { return mTransform; }
 	//! Sets the local transformation of this node.
-	void				setTransform( const MatrixAffine2f &transform ) { mTransform = transform; mSpecifiesTransform = true; }
+	void				setTransform( const MatrixAffine2f &transform ) { mTransform = transform; mSpecifiesTransform = true; invalidate(); }
 	//! Removes the local transformation of this node, effectively making it the identity matrix.
-	void				unspecifyTransform() { mSpecifiesTransform = false; }
+	void				unspecifyTransform() { mSpecifiesTransform = false; invalidate(); }
 	//! Returns the inverse of the local transformation of this node. Returns identity if the Node's transform isn't specified.
 	MatrixAffine2f		getTransformInverse() const { return ( mSpecifiesTransform ) ? mTransform.invertCopy() : MatrixAffine2f::identity(); }
 	//! Returns the absolute transformation of this node, which includes inherited transformations.
@@ -391,9 +391,15 @@ class Node {
 	//! Returns whether the Display property of this Node is set to 'None', preventing rendering of the node and its children
 	bool			isDisplayNone() const { return mStyle.isDisplayNone(); }
 
+	/** Records that the Node has changed, so that anything cached from it or its document, such as an SvgMeshGl, is rebuilt.
+		The Node's setters call this; call it directly after changing a Node through other means. **/
+	void			invalidate();
+	//! Returns a number which changes whenever the Node is invalidated
+	uint32_t		getRevision() const { return mRevision; }
+
 
   protected:
-	Node( const Node *parent, const XmlTree &xml );
+	Node( const Node *parent, const XmlView &xml );
 	// returns whether this type of node directly renders anything. Everything but groups.
 	virtual bool	isDrawable() const { return true; }
 
@@ -418,6 +424,7 @@ class Node {
 	MatrixAffine2f	mTransform;
 	mutable bool	mBoundingBoxCached;
 	mutable Rectf	mBoundingBox;
+	uint32_t		mRevision;
 	
   private:
   	void			firstStartRender( Renderer &renderer ) const;
@@ -429,11 +436,11 @@ class Node {
 //! Base class for SVG Gradients. See SVG Gradients: http://www.w3.org/TR/SVG/pservers.html#Gradients
 class Gradient : public Node {
   public:
-  	Gradient( const Node *parent, const XmlTree &xml );
+  	Gradient( const Node *parent, const XmlView &xml );
 	
 	class Stop {
 	  public:
-	  	Stop( const Node *parent, const XmlTree &xml );
+	  	Stop( const Node *parent, const XmlView &xml );
 		
 		float		mOffset; // normalized 0-1
 		ColorA8u	mColor;
@@ -447,7 +454,7 @@ class Gradient : public Node {
   protected:
 	virtual void	renderSelf( Renderer &renderer ) const {}
 
-	void 		parse( const Node *parent, const XmlTree &xml );
+	void 		parse( const Node *parent, const XmlView &xml );
 	void		copyAttributesFrom( const Gradient &rhs );
 	Paint		asPaint() const;
 
@@ -461,12 +468,12 @@ class Gradient : public Node {
 //! SVG Linear gradient
 class LinearGradient : public Gradient {
   public:
-	LinearGradient( const Node *parent, const XmlTree &xml );
+	LinearGradient( const Node *parent, const XmlView &xml );
 	
 	Paint		asPaint() const;
 	
   protected:
-	void 		parse( const XmlTree &xml );
+	void 		parse( const XmlView &xml );
 	
   	virtual bool	isDrawable() const { return false; }
 };
@@ -474,12 +481,12 @@ class LinearGradient : public Gradient {
 //! SVG Radial gradient
 class RadialGradient : public Gradient {
   public:
-	RadialGradient( const Node *parent, const XmlTree &xml );
+	RadialGradient( const Node *parent, const XmlView &xml );
 	
 	Paint		asPaint() const;
 	
   protected:
-	void 		parse( const XmlTree &xml );
+	void 		parse( const XmlView &xml );
 
 	virtual bool	isDrawable() const { return false; }
 	float			mRadius;
@@ -489,7 +496,7 @@ class RadialGradient : public Gradient {
 class Circle : public Node {
   public:
 	Circle( const Node *parent ) : Node( parent ) {}
-	Circle( const Node *parent, const XmlTree &xml );
+	Circle( const Node *parent, const XmlView &xml );
 	
 	Vec2f		getCenter() const { return mCenter; }
 	float		getRadius() const { return mRadius; }
@@ -510,7 +517,7 @@ class Circle : public Node {
 class Ellipse : public Node {
   public:
 	Ellipse( const Node *parent ) : Node( parent ) {}
-	Ellipse( const Node *parent, const XmlTree &xml );
+	Ellipse( const Node *parent, const XmlView &xml );
 	
 	Vec2f		getCenter() const { return mCenter; }
 	float		getRadiusX() const { return mRadiusX; }
@@ -532,7 +539,7 @@ class Ellipse : public Node {
 class Path : public Node {
   public:
 	Path( const Node *parent ) : Node( parent ) {}
-	Path( const Node *parent, const XmlTree &xml );
+	Path( const Node *parent, const XmlView &xml );
 	
 	const Shape2d&		getShape2d() const { return mPath; }
 	void				appendShape2d( Shape2d *appendTo ) const;
@@ -552,7 +559,7 @@ class Path : public Node {
 class Line : public Node {
   public:
 	Line( const Node *parent ) : Node( parent ) {}
-	Line( const Node *parent, const XmlTree &xml );
+	Line( const Node *parent, const XmlView &xml );
 	
 	const Vec2f&	getPoint1() const { return mPoint1; }
 	const Vec2f&	getPoint2() const { return mPoint2; }
@@ -570,7 +577,7 @@ class Line : public Node {
 class Rect : public Node {
   public:
 	Rect( const Node *parent ) : Node( parent ) {}
-	Rect( const Node *parent, const XmlTree &xml );
+	Rect( const Node *parent, const XmlView &xml );
 	
 	const Rectf&	getRect() const { return mRect; }
 
@@ -589,7 +596,7 @@ class Rect : public Node {
 class Polygon : public Node {
   public:
 	Polygon( const Node *parent ) : Node( parent ) {}
-	Polygon( const Node *parent, const XmlTree &xml );
+	Polygon( const Node *parent, const XmlView &xml );
 
 	const PolyLine2f&	getPolyLine() const { return mPolyLine; }
 	PolyLine2f&			getPolyLine() { return mPolyLine; }
@@ -609,7 +616,7 @@ class Polygon : public Node {
 class Polyline : public Node {
   public:
 	Polyline( const Node *parent ) : Node( parent ) {}
-	Polyline( const Node *parent, const XmlTree &xml );
+	Polyline( const Node *parent, const XmlView &xml );
 
 	const PolyLine2f&	getPolyLine() const { return mPolyLine; }
 	PolyLine2f&			getPolyLine() { return mPolyLine; }
@@ -628,7 +635,7 @@ class Polyline : public Node {
 //! SVG Use Element, which instantiates a different element: http://www.w3.org/TR/SVG/struct.html#UseElement
 class Use : public Node {
   public:
-	Use( const Node *parent, const XmlTree &xml );
+	Use( const Node *parent, const XmlView &xml );
 	
 	virtual bool	isDrawable() const { return false; }
 	
@@ -638,7 +645,7 @@ class Use : public Node {
 	virtual void	renderSelf( Renderer &renderer ) const;  
 	virtual Rectf	calcBoundingBox() const { if( mReferenced ) return mReferenced->getBoundingBox(); else return Rectf(0,0,0,0); }
 	
-	void parse( const XmlTree &xml );
+	void parse( const XmlView &xml );
 	
 	const Node		*mReferenced;
 };
@@ -646,7 +653,7 @@ class Use : public Node {
 //! SVG Image Element. Represents an unpremultiplied bitmap. http://www.w3.org/TR/SVG/struct.html#ImageElement
 class Image : public Node {
   public:
-	Image( const Node *parent, const XmlTree &xml );
+	Image( const Node *parent, const XmlView &xml );
 
 	const Rectf&						getRect() const { return mRect; }
 	const std::shared_ptr<Surface8u>	getSurface() const { return mImage; }
@@ -672,7 +679,7 @@ class TextSpan : public Node {
 	class Attributes {
 	  public:
 		Attributes() {}
-		Attributes( const XmlTree &xml );
+		Attributes( const XmlView &xml );
 
 		void 	startRender( Renderer &renderer ) const;
 		void 	finishRender( Renderer &renderer ) const;
@@ -684,7 +691,7 @@ class TextSpan : public Node {
 		float				mLengthAdjust;
 	};
 
-	TextSpan( const Node *parent, const XmlTree &xml );
+	TextSpan( const Node *parent, const XmlView &xml );
 	TextSpan( const Node *parent, const std::string &spanString );
 	
 	const std::string&							getString() const { return mString; }
@@ -712,7 +719,7 @@ class TextSpan : public Node {
 //! SVG Text element. http://www.w3.org/TR/SVG/text.html#TextElement
 class Text : public Node {
   public:
-  	Text( const Node *parent, const XmlTree &xml );
+  	Text( const Node *parent, const XmlView &xml );
 
 	Vec2f 	getTextPen() const;
 	float	getRotation() const;
@@ -729,7 +736,7 @@ class Text : public Node {
 class Group : public Node {
   public:
 	Group( const Node *parent ) : Node( parent ) {}
-	Group( const Node *parent, const XmlTree &xml );
+	Group( const Node *parent, const XmlView &xml );
 	~Group();
 
 	//! Recursively searches for a child element of type <tt>svg::T</tt> named \a id. Returns NULL on failure to find the object or if it is not of type T.
@@ -762,7 +769,7 @@ class Group : public Node {
 	virtual Rectf	calcBoundingBox() const;
 
 	virtual bool	isDrawable() const { return false; }
-	void 			parse( const XmlTree &xml );
+	void 			parse( const XmlView &xml );
 
 	std::list<Node*>		mChildren;
 	std::shared_ptr<Group>	mDefs;
@@ -773,7 +780,7 @@ typedef std::shared_ptr<Doc>	DocRef;
 //! Represents an SVG Document. See SVG Document Structure http://www.w3.org/TR/SVG/struct.html
 class Doc : public Group {
   public:
-	Doc() : Group( 0 ), mWidth( 0 ), mHeight( 0 ) {}
+	Doc() : Group( 0 ), mWidth( 0 ), mHeight( 0 ), mDocRevision( 0 ), mHitIndexValid( false ), mHitIndexRevision( 0 ) {}
 	Doc( const fs::path &filePath );
 	Doc( DataSourceRef dataSource, const fs::path &filePath = fs::path() );
 
@@ -795,22 +802,54 @@ class Doc : public Group {
 	//! Returns the document's dots-per-inch. Currently hardcoded to 72.
 	float		getDpi() const { return 72.0f; }
 	
-	//! Returns the top-most Node which contains \a pt. Returns NULL if no Node contains the point.
+	/** Returns the top-most Node which contains \a pt. Returns NULL if no Node contains the point.
+		Only the Nodes whose absolute bounding boxes contain \a pt are tested, found through a bounding volume hierarchy which is built on first use
+		and rebuilt after any Node is invalidated. **/
 	Node*		nodeUnderPoint( const Vec2f &pt );
+	//! Appends to \a result every Node other than a Group whose absolute bounding box intersects \a rect, in document order
+	void		nodesInRect( const Rectf &rect, std::vector<Node*> *result );
 	
 	//! Utility function to load an image relative to the document. Caches results.
 	std::shared_ptr<Surface8u>	loadImage( fs::path relativePath );
+
+	//! Returns a number which changes whenever any Node of the document is invalidated
+	uint32_t	getDocRevision() const { return mDocRevision; }
   private:
+	struct HitEntry {
+		Node			*mNode;
+		Rectf			mBounds; // absolute
+		MatrixAffine2f	mInverse; // maps absolute points into mNode's coordinates
+		uint32_t		mOrder; // in document order, so the top-most Node has the highest
+	};
+	
+	struct HitBvhNode {
+		Rectf		mBounds;
+		uint32_t	mFirst, mCount; // range of mHitEntries, when a leaf
+		int32_t		mLeft, mRight; // children, or -1 when a leaf
+	};
+	
   	void 	loadDoc( DataSourceRef source, fs::path filePath );
+	void	updateHitIndex();
+	void	collectHitEntries( const Group *group, const MatrixAffine2f &transform, const MatrixAffine2f &inverse );
+	int32_t	buildHitBvh( uint32_t first, uint32_t count );
 
 	virtual void		renderSelf( Renderer &renderer ) const;
   
-	std::shared_ptr<XmlTree>	mXmlTree;
 	std::map<fs::path,std::shared_ptr<Surface8u> >	mImageCache;
 	
 	fs::path		mFilePath;
 	Area			mViewBox;
 	int32_t			mWidth, mHeight;
+	uint32_t		mDocRevision;
+	
+	std::vector<HitEntry>	mHitEntries;
+	std::vector<uint32_t>	mHitEntryByOrder;
+	std::vector<HitBvhNode>	mHitBvh;
+	std::vector<uint32_t>	mHitCandidates; // scratch, by mOrder
+	bool					mHitIndexValid;
+	uint32_t				mHitIndexRevision;
+
+	friend class Node;
 };
 
 //! SVG Exception base-class
@@ -26,9 +26,13 @@
 #pragma once
 
 #include "cinder/gl/gl.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/gl/Texture.h"
 #include "cinder/svg/Svg.h"
 #include "cinder/Triangulate.h"
 
+#include <map>
+
 namespace cinder {
 
 class SvgRendererGl : public svg::Renderer {
@@ -173,7 +177,78 @@ class SvgRendererGl : public svg::Renderer {
 	std::vector<svg::FillRule>	mFillRuleStack;
 };
 
+/** \brief The fills and strokes of an svg::Doc baked into a single VboMesh, for documents which are drawn every frame but rarely change.
+	Fills are triangulated, strokes are tessellated with StrokeTriangulator rather than drawn as lines, and everything is transformed into document space
+	and colored per vertex, so the whole document draws in one call and in the same order SvgRendererGl would draw it. Images and text are not baked.
+	Each node's tessellation is cached, so update() after a change to the document only re-tessellates the nodes which were invalidated. **/
+class SvgMeshGl {
+  protected:
+	struct Obj;
+
+  public:
+	SvgMeshGl() {}
+	//! Bakes \a doc. \a approximationScale represents how smooth curves are, with 1.0 corresponding to 1:1 with the document's pixels, and is adjusted for any scaling applied within the document.
+	explicit SvgMeshGl( const svg::Doc &doc, float approximationScale = 1.0f );
+
+	/** Rebakes \a doc if it is not the document last baked or if any of its nodes has been invalidated since, reusing the cached tessellation of unchanged nodes.
+		Returns whether the geometry was rebuilt. Cheap enough to call every frame. **/
+	bool	update( const svg::Doc &doc );
+	//! Sets the approximation scale used for curves, invalidating every cached tessellation. Takes effect on the next update().
+	void	setApproximationScale( float approximationScale );
+	float	getApproximationScale() const { return mObj->mApproximationScale; }
+
+	//! Draws the baked geometry
+	void	draw() const;
+
+	const TriMesh2d&	getTriMesh() const { return mObj->mTriMesh; }
+	//! Returns the VboMesh holding the baked geometry, which is empty if the document has no visible fills or strokes. OpenGL ES builds draw the TriMesh2d instead and leave it empty.
+	const gl::VboMesh&	getVboMesh() const { return mObj->mVboMesh; }
+
+	//@{
+	//! Emulates shared_ptr-like behavior
+	typedef std::shared_ptr<Obj> SvgMeshGl::*unspecified_bool_type;
+	operator unspecified_bool_type() const { return ( mObj.get() == 0 ) ? 0 : &SvgMeshGl::mObj; }
+	void reset() { mObj.reset(); }
+	//@}
+
+  protected:
+	//! The tessellation of a single node in its own space, along with everything it depends on besides the node itself
+	struct NodeCache {
+		uint32_t		mRevision;
+		float			mApproximationScale;
+		bool			mFilled, mStroked;
+		int				mWinding;
+		float			mStrokeWidth;
+		int				mStrokeCap, mStrokeJoin;
+		TriMesh2d		mFill, mStroke;
+	};
+	typedef std::map<const svg::Node*,NodeCache>	NodeCacheMap;
+	class Builder;
+
+	struct Obj {
+		Obj( float approximationScale ) : mApproximationScale( approximationScale ), mDoc( 0 ), mDocRevision( 0 ) {}
+
+		void			bake( const svg::Doc &doc );
+
+		TriMesh2d		mTriMesh;
+		gl::VboMesh		mVboMesh;
+
+		float			mApproximationScale;
+		const svg::Doc	*mDoc;
+		uint32_t		mDocRevision;
+		NodeCacheMap	mNodeCache;
+	};
+
+	std::shared_ptr<Obj>	mObj;
+};
+
 namespace gl {
+inline void draw( const SvgMeshGl &svgMesh )
+{
+	svgMesh.draw();
+}
+
+//! Renders \a svg in immediate mode, re-tessellating every shape on each call. Prefer an SvgMeshGl for documents drawn every frame.
 inline void draw( const svg::Doc &svg )
 {
 	SvgRendererGl renderGl;
@@ -214,6 +214,7 @@ class videoDevice{
 		bool sizeSet;
 		bool setupStarted;
 		bool specificFormat;
+		bool specificSubtype; //ie videoType is tried first
 		bool autoReconnect;
 		int  nFramesForReconnect;
 		unsigned long nFramesRunning;
@@ -259,11 +260,19 @@ class videoInput{
 		//directshow will try and get the closest possible framerate to what is requested
 		void setIdealFramerate(int deviceID, int idealFramerate);
 
+		//call before setupDevice
+		//a media subtype such as MEDIASUBTYPE_YUY2 to try before the others when setting up the device with a size
+		void setRequestedMediaSubtype(int deviceID, GUID mediatype);
+
 		//some devices will stop delivering frames after a while - this method gives you the option to try and reconnect
 		//to a device if videoInput detects that a device has stopped delivering frames. 
 		//you MUST CALL isFrameNew every app loop for this to have any effect
 		void setAutoReconnectOnFreeze(int deviceNumber, bool doReconnect, int numMissedFramesBeforeReconnect);
 		
+		//sets a function called from DirectShow's streaming thread with every frame's raw pixels, which are bottom-up BGR
+		//the pixels are only valid during the call - pass NULL to remove the callback
+		void setFrameCallback(int deviceID, void (*callback)(unsigned char * pixels, int numBytes, void * refcon), void * refcon);
+		
 		//Choose one of these four to setup your device
 		bool setupDevice(int deviceID);
 		bool setupDevice(int deviceID, int w, int h);
@@ -291,6 +300,9 @@ class videoInput{
 		
 		//Or pass in a buffer for getPixels to fill returns true if successful.
 		bool getPixels(int id, unsigned char * pixels, bool flipRedAndBlue = true, bool flipImage = false);
+
+		//Or copy just the w by h region at x, y of the top-down image into a tightly packed top-down BGR buffer, returns true if successful.
+		bool getPixels(int id, unsigned char * pixels, int x, int y, int w, int h);
 		
 		//Launches a pop up settings window
 		//For some reason in GLUT you have to call it twice each time. 
@@ -347,6 +359,7 @@ class videoInput{
 		void setAttemptCaptureSize(int deviceID, int w, int h);   
 		bool setup(int deviceID);
 		void processPixels(unsigned char * src, unsigned char * dst, int width, int height, bool bRGB, bool bFlip);
+		void processPixelsRegion(unsigned char * src, unsigned char * dst, int width, int height, int x, int y, int w, int h);
 		int  start(int deviceID, videoDevice * VD);                   
 		int  getDeviceCount();
 		void getMediaSubtypeAsString(GUID type, char * typeAsString);
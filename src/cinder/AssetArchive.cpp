@@ -0,0 +1,230 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/AssetArchive.h"
+#include "cinder/Stream.h"
+#include "cinder/Utilities.h"
+
+#include <zlib.h>
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder {
+
+// An archive is stored little-endian as
+//	char[4] "CPAK", uint32 version, uint32 entryCount, uint64 indexOffset
+// followed by the entries' data, and then the index at indexOffset, which holds for each entry
+//	uint16 nameLength, char[nameLength] name, uint8 compression, uint64 offset, uint64 storedSize, uint64 size
+// where offset and storedSize locate the data in the file and size is its uncompressed size.
+
+namespace { // anonymous namespace
+
+const char		ARCHIVE_MAGIC[4] = { 'C', 'P', 'A', 'K' };
+const uint32_t	ARCHIVE_VERSION = 1;
+const size_t	ARCHIVE_HEADER_SIZE = 4 + 4 + 4 + 8;
+
+enum { COMPRESSION_NONE = 0, COMPRESSION_ZLIB = 1 };
+
+// the streams only handle up to 32-bit integers, so 64-bit values are written as their low and then high halves
+void writeUint64( OStream *stream, uint64_t value )
+{
+	stream->writeLittle( (uint32_t)( value & 0xFFFFFFFF ) );
+	stream->writeLittle( (uint32_t)( value >> 32 ) );
+}
+
+uint64_t readUint64( IStream *stream )
+{
+	uint32_t low, high;
+	stream->readLittle( &low );
+	stream->readLittle( &high );
+	return ( (uint64_t)high << 32 ) | low;
+}
+
+} // anonymous namespace
+
+AssetArchive::AssetArchive( const fs::path &path )
+	: mFilePath( path )
+{
+	size_t size = 0;
+	std::shared_ptr<const void> mapping = mapFile( path, &size );
+	if( ! mapping )
+		throw AssetArchiveExc( path, "can't be mapped" );
+	mMapping = Buffer( mapping, size );
+
+	try {
+		IStreamMemRef stream = IStreamMem::create( mMapping.getData(), size );
+		char magic[4];
+		stream->readData( magic, 4 );
+		uint32_t version, entryCount;
+		stream->readLittle( &version );
+		stream->readLittle( &entryCount );
+		uint64_t indexOffset = readUint64( stream.get() );
+		if( ! std::equal( magic, magic + 4, ARCHIVE_MAGIC ) || ( version != ARCHIVE_VERSION ) || ( indexOffset > size ) )
+			throw AssetArchiveExc( path, "isn't an asset archive" );
+
+		stream->seekAbsolute( (off_t)indexOffset );
+		for( uint32_t e = 0; e < entryCount; ++e ) {
+			uint16_t nameLength;
+			stream->readLittle( &nameLength );
+			string name( nameLength, 0 );
+			if( nameLength )
+				stream->readData( &name[0], nameLength );
+			Entry entry;
+			stream->readLittle( &entry.mCompression );
+			entry.mOffset = readUint64( stream.get() );
+			entry.mStoredSize = readUint64( stream.get() );
+			entry.mSize = readUint64( stream.get() );
+			if( ( entry.mOffset > size ) || ( entry.mStoredSize > size - entry.mOffset ) || ( entry.mCompression > COMPRESSION_ZLIB ) )
+				throw AssetArchiveExc( path, "has a corrupt index" );
+			mEntries[name] = entry;
+		}
+	}
+	catch( StreamExc & ) {
+		throw AssetArchiveExc( path, "is truncated" );
+	}
+}
+
+string AssetArchive::normalizeName( const fs::path &relativePath )
+{
+	string result = relativePath.generic_string();
+	while( result.compare( 0, 2, "./" ) == 0 )
+		result.erase( 0, 2 );
+	return result;
+}
+
+bool AssetArchive::contains( const fs::path &relativePath ) const
+{
+	return mEntries.find( normalizeName( relativePath ) ) != mEntries.end();
+}
+
+DataSourceRef AssetArchive::load( const fs::path &relativePath ) const
+{
+	string name = normalizeName( relativePath );
+	map<string,Entry>::const_iterator entryIt = mEntries.find( name );
+	if( entryIt == mEntries.end() )
+		return DataSourceRef();
+
+	const Entry &entry = entryIt->second;
+	Buffer stored = mMapping.slice( (size_t)entry.mOffset, (size_t)entry.mStoredSize );
+	if( entry.mCompression == COMPRESSION_NONE )
+		return DataSourceBuffer::create( stored, name );
+
+	Buffer inflated( (size_t)entry.mSize );
+	uLongf inflatedSize = (uLongf)entry.mSize;
+	if( ( ::uncompress( (Bytef*)inflated.getData(), &inflatedSize, (const Bytef*)stored.getData(), (uLong)stored.getDataSize() ) != Z_OK ) || ( inflatedSize != entry.mSize ) )
+		throw AssetArchiveExc( mFilePath, "has corrupt data for " + name );
+
+	return DataSourceBuffer::create( inflated, name );
+}
+
+vector<string> AssetArchive::getEntryNames() const
+{
+	vector<string> result;
+	result.reserve( mEntries.size() );
+	for( map<string,Entry>::const_iterator entryIt = mEntries.begin(); entryIt != mEntries.end(); ++entryIt )
+		result.push_back( entryIt->first );
+	return result;
+}
+
+void AssetArchive::write( const fs::path &archivePath, const fs::path &sourceDirectory, bool compress, int8_t compressionLevel )
+{
+	vector<fs::path> files;
+	try {
+		for( fs::recursive_directory_iterator fileIt( sourceDirectory ), end; fileIt != end; ++fileIt ) {
+			if( fs::is_regular_file( fileIt->status() ) )
+				files.push_back( fileIt->path() );
+		}
+	}
+	catch( fs::filesystem_error & ) {
+		throw AssetArchiveExc( sourceDirectory, "can't be read" );
+	}
+	std::sort( files.begin(), files.end() );
+
+	const string sourcePrefix = sourceDirectory.generic_string();
+	vector<pair<string,Entry> > index;
+	index.reserve( files.size() );
+
+	try {
+		OStreamFileRef stream = writeFileStream( archivePath );
+		if( ! stream )
+			throw AssetArchiveExc( archivePath, "can't be written" );
+		// the header is rewritten with the index offset once the data is written
+		stream->writeData( ARCHIVE_MAGIC, 4 );
+		stream->writeLittle( ARCHIVE_VERSION );
+		stream->writeLittle( (uint32_t)files.size() );
+		writeUint64( stream.get(), 0 );
+
+		uint64_t offset = ARCHIVE_HEADER_SIZE;
+		for( vector<fs::path>::const_iterator fileIt = files.begin(); fileIt != files.end(); ++fileIt ) {
+			string name = fileIt->generic_string().substr( sourcePrefix.length() );
+			while( ! name.empty() && name[0] == '/' )
+				name.erase( 0, 1 );
+			if( name.length() > 0xFFFF )
+				throw AssetArchiveExc( *fileIt, "has too long a name" );
+
+			Buffer data = loadDataSourceBuffer( loadFile( *fileIt ) );
+			Entry entry;
+			entry.mCompression = COMPRESSION_NONE;
+			entry.mOffset = offset;
+			entry.mSize = entry.mStoredSize = data.getDataSize();
+			if( compress && data.getDataSize() > 0 ) {
+				Buffer compressed = compressBuffer( data, compressionLevel, false );
+				if( compressed.getDataSize() < data.getDataSize() - data.getDataSize() / 8 ) {
+					data = compressed;
+					entry.mCompression = COMPRESSION_ZLIB;
+					entry.mStoredSize = compressed.getDataSize();
+				}
+			}
+
+			stream->writeData( data.getData(), data.getDataSize() );
+			offset += entry.mStoredSize;
+			index.push_back( make_pair( name, entry ) );
+		}
+
+		for( vector<pair<string,Entry> >::const_iterator entryIt = index.begin(); entryIt != index.end(); ++entryIt ) {
+			stream->writeLittle( (uint16_t)entryIt->first.length() );
+			stream->writeData( entryIt->first.data(), entryIt->first.length() );
+			stream->writeLittle( entryIt->second.mCompression );
+			writeUint64( stream.get(), entryIt->second.mOffset );
+			writeUint64( stream.get(), entryIt->second.mStoredSize );
+			writeUint64( stream.get(), entryIt->second.mSize );
+		}
+
+		stream->seekAbsolute( ARCHIVE_HEADER_SIZE - 8 );
+		writeUint64( stream.get(), offset );
+	}
+	catch( StreamExc & ) {
+		throw AssetArchiveExc( archivePath, "can't be written" );
+	}
+}
+
+AssetArchiveExc::AssetArchiveExc( const fs::path &path, const string &description )
+{
+	string message = path.string() + " " + description;
+	strncpy( mMessage, message.c_str(), sizeof(mMessage) );
+	mMessage[sizeof(mMessage) - 1] = 0;
+}
+
+} // namespace cinder
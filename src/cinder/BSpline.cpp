@@ -32,6 +32,7 @@
 #include <memory.h>
 #include <assert.h>
 #include <limits>
+#include <algorithm>
 
 #include "cinder/Vector.h"
 
@@ -266,6 +267,11 @@ float BSplineBasis::getKnot( int i ) const
 
 
 int BSplineBasis::getKey( float& rfTime ) const
+{
+	return getSpan( rfTime );
+}
+
+int BSplineBasis::getSpan( float &rfTime, int iHint ) const
 {
 	if( mOpen ) {
 		// open splines clamp to [0,1]
@@ -285,10 +291,20 @@ int BSplineBasis::getKey( float& rfTime ) const
 		}
 	}
 
-
 	int i;
 	if( mUniform ) {
 		i = mDegree + (int)( ( mNumCtrlPoints - mDegree ) * rfTime );
+		// rounding can push a time just below 1 onto the end knot
+		if( i > mNumCtrlPoints - 1 )
+			i = mNumCtrlPoints - 1;
+	}
+	else if( iHint >= mDegree && iHint < mNumCtrlPoints ) {
+		// walk from the hint; for sorted times this is usually no step at all
+		i = iHint;
+		while( i < mNumCtrlPoints - 1 && rfTime >= mKnots[i+1] )
+			i++;
+		while( i > mDegree && rfTime < mKnots[i] )
+			i--;
 	}
 	else {
 		for( i = mDegree + 1; i <= mNumCtrlPoints; i++ ) {
@@ -302,6 +318,54 @@ int BSplineBasis::getKey( float& rfTime ) const
 	return i;
 }
 
+void BSplineBasis::computeSpanPolynomials( int i, float *afCoeff, float &rfSpanStart, float &rfSpanWidth ) const
+{
+	// Cox-de Boor recursion carried out on polynomials in s, where
+	// t = knot[i] + h*s.  Row j of the work array holds basis function
+	// i-d+j; lower degrees live at the right end of the array.
+	const int iOrder = mDegree + 1;
+	const double dStart = mKnots[i], dWidth = (double)mKnots[i+1] - dStart;
+	std::vector<double> adPoly( iOrder * iOrder, 0.0 ), adNew( iOrder );
+	adPoly[mDegree*iOrder] = 1.0;
+
+	for( int p = 1; p <= mDegree; p++ ) {
+		// basis functions i-p..i of degree p from i-p+1..i of degree p-1
+		for( int j = i - p; j <= i; j++ ) {
+			double *adResult = &adPoly[(j-i+mDegree)*iOrder];
+			std::fill( adNew.begin(), adNew.end(), 0.0 );
+			// (t - knot[j]) / (knot[j+p] - knot[j]) * N[j,p-1]
+			if( j >= i - p + 1 ) {
+				double dDenom = (double)mKnots[j+p] - mKnots[j];
+				if( dDenom != 0.0 ) {
+					double dA = ( dStart - mKnots[j] ) / dDenom, dB = dWidth / dDenom;
+					for( int k = 0; k < p; k++ ) {
+						adNew[k] += dA * adResult[k];
+						adNew[k+1] += dB * adResult[k];
+					}
+				}
+			}
+			// (knot[j+p+1] - t) / (knot[j+p+1] - knot[j+1]) * N[j+1,p-1]
+			if( j + 1 <= i ) {
+				const double *adNext = &adPoly[(j+1-i+mDegree)*iOrder];
+				double dDenom = (double)mKnots[j+p+1] - mKnots[j+1];
+				if( dDenom != 0.0 ) {
+					double dA = ( mKnots[j+p+1] - dStart ) / dDenom, dB = -dWidth / dDenom;
+					for( int k = 0; k < p; k++ ) {
+						adNew[k] += dA * adNext[k];
+						adNew[k+1] += dB * adNext[k];
+					}
+				}
+			}
+			std::copy( adNew.begin(), adNew.end(), adResult );
+		}
+	}
+
+	for( int k = 0; k < iOrder * iOrder; k++ )
+		afCoeff[k] = (float)adPoly[k];
+	rfSpanStart = (float)dStart;
+	rfSpanWidth = (float)dWidth;
+}
+
 void BSplineBasis::compute( float fTime, unsigned int uiOrder, int &riMinIndex, int &riMaxIndex ) const
 {
     // only derivatives through third order currently supported
@@ -452,6 +516,56 @@ Real rombergIntegral( int iOrder, Real fA, Real fB, Real (*oF)(Real,void*), void
     return fResult;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Span polynomial evaluation for BSpline::getBatch()
+namespace {
+
+// number of local parameters gathered before a span's polynomials are evaluated
+const size_t BATCH_SIZE = 64;
+
+template<typename T>
+void evaluatePolynomial( const T *coeffs, int degree, const float *s, size_t count, T *result )
+{
+	if( degree < 0 ) {
+		std::fill( result, result + count, T::zero() );
+		return;
+	}
+
+	for( size_t i = 0; i < count; ++i ) {
+		T v = coeffs[degree];
+		for( int k = degree - 1; k >= 0; --k )
+			v = v * s[i] + coeffs[k];
+		result[i] = v;
+	}
+}
+
+#if defined( CINDER_SIMD_MATH )
+// four parameters at a time, one lane per parameter
+void evaluatePolynomial( const Vec3f *coeffs, int degree, const float *s, size_t count, Vec3f *result )
+{
+	using namespace detail;
+	size_t i = 0;
+	if( degree >= 0 ) {
+		for( ; i + 4 <= count; i += 4 ) {
+			const SimdFloat4 sv = simdLoad( s + i );
+			SimdFloat4 x = simdSplat( coeffs[degree].x ), y = simdSplat( coeffs[degree].y ), z = simdSplat( coeffs[degree].z );
+			for( int k = degree - 1; k >= 0; --k ) {
+				x = simdAdd( simdMul( x, sv ), simdSplat( coeffs[k].x ) );
+				y = simdAdd( simdMul( y, sv ), simdSplat( coeffs[k].y ) );
+				z = simdAdd( simdMul( z, sv ), simdSplat( coeffs[k].z ) );
+			}
+			float xs[4], ys[4], zs[4];
+			simdStore( xs, x ); simdStore( ys, y ); simdStore( zs, z );
+			for( int l = 0; l < 4; ++l )
+				result[i+l].set( xs[l], ys[l], zs[l] );
+		}
+	}
+	evaluatePolynomial<Vec3f>( coeffs, degree, s + i, count - i, result + i );
+}
+#endif
+
+} // anonymous namespace
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 // BSpline
 template<typename T>
@@ -606,6 +720,77 @@ void BSpline<T>::get( float t, T *position, T *firstDerivative, T *secondDerivat
 	}
 }
 
+template<typename T>
+void BSpline<T>::getBatch( const float *times, size_t count, T *positions, T *firstDerivatives, T *secondDerivatives, T *thirdDerivatives ) const
+{
+	getSamples( times, 0, 0, count, positions, firstDerivatives, secondDerivatives, thirdDerivatives );
+}
+
+template<typename T>
+void BSpline<T>::getUniform( float t0, float t1, size_t count, T *positions, T *firstDerivatives, T *secondDerivatives, T *thirdDerivatives ) const
+{
+	float dt = ( count > 1 ) ? ( t1 - t0 ) / ( count - 1 ) : 0;
+	getSamples( NULL, t0, dt, count, positions, firstDerivatives, secondDerivatives, thirdDerivatives );
+}
+
+template<typename T>
+void BSpline<T>::getSamples( const float *times, float t0, float dt, size_t count, T *positions, T *firstDerivatives, T *secondDerivatives, T *thirdDerivatives ) const
+{
+	T *outputs[4] = { positions, firstDerivatives, secondDerivatives, thirdDerivatives };
+	const int degree = mBasis.getDegree(), order = degree + 1;
+	int maxDerivative = 0;
+	for( int r = 1; r < 4; ++r ) {
+		if( outputs[r] )
+			maxDerivative = r;
+	}
+
+	// coefficients of the position polynomial and each requested derivative, rebuilt whenever the span changes
+	std::vector<float> basis( order * order );
+	std::vector<T> coeffs( 4 * order );
+	float spanStart = 0, invSpanWidth = 0;
+	int curSpan = -1;
+
+	float s[BATCH_SIZE];
+	size_t n = 0;
+	while( n < count ) {
+		float t = times ? times[n] : t0 + dt * n;
+		const int span = mBasis.getSpan( t, curSpan );
+		if( span != curSpan ) {
+			float spanWidth;
+			mBasis.computeSpanPolynomials( span, &basis[0], spanStart, spanWidth );
+			invSpanWidth = ( spanWidth > 0 ) ? 1.0f / spanWidth : 0;
+			for( int k = 0; k < order; ++k ) {
+				T c = T::zero();
+				for( int j = 0; j < order; ++j )
+					c += mCtrlPoints[span-degree+j] * basis[j*order+k];
+				coeffs[k] = c;
+			}
+			// differentiate in s, then scale by ds/dt
+			for( int r = 1; r <= maxDerivative; ++r ) {
+				for( int k = 0; k + r <= degree; ++k )
+					coeffs[r*order+k] = coeffs[(r-1)*order+k+1] * ( (k + 1) * invSpanWidth );
+			}
+			curSpan = span;
+		}
+
+		// gather the following times that share this span
+		size_t m = n;
+		s[0] = ( t - spanStart ) * invSpanWidth;
+		while( ++m < count && m - n < BATCH_SIZE ) {
+			float tm = times ? times[m] : t0 + dt * m;
+			if( mBasis.getSpan( tm, curSpan ) != curSpan )
+				break;
+			s[m-n] = ( tm - spanStart ) * invSpanWidth;
+		}
+
+		for( int r = 0; r < 4; ++r ) {
+			if( outputs[r] )
+				evaluatePolynomial( &coeffs[r*order], degree - r, s, m - n, outputs[r] + n );
+		}
+		n = m;
+	}
+}
+
 template<typename T>
 float BSpline<T>::getTime( float length ) const
 {
@@ -101,12 +101,6 @@ class BSplineFit
 	void getPosition( T fT, T *afPosition ) const;
 
  private:
-	// The matric inversion calculations are performed with double-precision,
-	// even when the type T is 'float'.
-	bool choleskyFactor( BandedMatrixd &rkMatrix ) const;
-	bool solveLower( BandedMatrixd &rkMatrix, double* adControlData ) const;
-	bool solveUpper( BandedMatrixd &rkMatrix, double* adControlData ) const;
-
 	// Input sample information.
 	int m_iDimension;
 	int m_iSampleQuantity;
@@ -240,6 +234,247 @@ T BSplineFitBasis<T>::getValue( int i ) const
     return m_afValue[i];
 }
 
+//----------------------------------------------------------------------------
+// The matrix inversion calculations are performed with double-precision,
+// even when the type T is 'float'.  The normal matrix A^T*A is banded with
+// iDegree bands on either side of the diagonal, so the factorization and
+// both substitutions only touch the bands.
+
+namespace {
+
+// Evaluates the basis functions at the parameters of iSampleQuantity
+// uniformly spaced samples.  Sample i is affected by the control points
+// raiMin[i] through raiMin[i]+iDegree with weights
+// radBases[i*(iDegree+1)] through radBases[i*(iDegree+1)+iDegree].
+void computeSampleBases( int iControlQuantity, int iDegree, int iSampleQuantity, vector<double> &radBases, vector<int> &raiMin )
+{
+    BSplineFitBasisd kDBasis(iControlQuantity,iDegree);
+    double dTMultiplier = 1.0/(double)(iSampleQuantity - 1);
+    radBases.resize(iSampleQuantity*(iDegree+1));
+    raiMin.resize(iSampleQuantity);
+    for (int i = 0; i < iSampleQuantity; i++)
+    {
+        int iMin, iMax;
+        kDBasis.compute(dTMultiplier*(double)i,iMin,iMax);
+        raiMin[i] = iMin;
+        for (int k = 0; k <= iDegree; k++)
+        {
+            radBases[i*(iDegree+1)+k] = kDBasis.getValue(k);
+        }
+    }
+}
+
+// Accumulates the normal matrix A^T*A from the sample bases in one pass.
+void computeNormalMatrix( int iDegree, const vector<double> &rkBases, const vector<int> &rkMin, BandedMatrixd &rkMatrix )
+{
+    rkMatrix.setZero();
+    const int iOrder = iDegree + 1;
+    for (size_t i = 0; i < rkMin.size(); i++)
+    {
+        const double* adB = &rkBases[i*iOrder];
+        const int iMin = rkMin[i];
+        for (int k0 = 0; k0 < iOrder; k0++)
+        {
+            for (int k1 = k0; k1 < iOrder; k1++)
+            {
+                rkMatrix(iMin+k0,iMin+k1) += adB[k0]*adB[k1];
+            }
+        }
+    }
+
+    const int iSize = rkMatrix.getSize();
+    for (int i0 = 0; i0 < iSize; i0++)
+    {
+        for (int i1 = i0 + 1; i1 < iSize && i1 <= i0 + iDegree; i1++)
+        {
+            rkMatrix(i1,i0) = rkMatrix(i0,i1);
+        }
+    }
+}
+
+// Computes A^T*B*SampleData, the samples being iDimension contiguous
+// values each.  pfSample(i) returns the address of sample i.
+template<typename SampleAccess>
+void computeRightHandSide( int iDimension, int iDegree, const vector<double> &rkBases, const vector<int> &rkMin, const SampleAccess &pfSample, double *adControlData, int iControlQuantity )
+{
+    memset( adControlData,0,iDimension*iControlQuantity*sizeof(double) );
+    const int iOrder = iDegree + 1;
+    for (size_t i = 0; i < rkMin.size(); i++)
+    {
+        const double* adB = &rkBases[i*iOrder];
+        double* adTarget = &adControlData[iDimension*rkMin[i]];
+        const typename SampleAccess::Scalar* pfSource = pfSample((int)i);
+        for (int k = 0; k < iOrder; k++)
+        {
+            for (int j = 0; j < iDimension; j++)
+            {
+                adTarget[j] += adB[k]*(double)pfSource[j];
+            }
+            adTarget += iDimension;
+        }
+    }
+}
+
+bool choleskyFactor( BandedMatrixd &rkMatrix )
+{
+    const int iSize = rkMatrix.getSize(), iSizeM1 = iSize - 1;
+    const int iBands = rkMatrix.getLBands();  // == GetUBands()
+
+    int k, kMax;
+    for (int i = 0; i < iSize; i++)
+    {
+        int jMin = i - iBands;
+        if (jMin < 0)
+        {
+            jMin = 0;
+        }
+
+        int j;
+        for (j = jMin; j < i; j++)
+        {
+            kMax = j + iBands;
+            if (kMax > iSizeM1)
+            {
+                kMax = iSizeM1;
+            }
+
+            for (k = i; k <= kMax; k++)
+            {
+                rkMatrix(k,i) -= rkMatrix(i,j)*rkMatrix(k,j);
+            }
+        }
+
+        kMax = j + iBands;
+        if (kMax > iSizeM1)
+        {
+            kMax = iSizeM1;
+        }
+
+        for (k = jMin; k < i; k++)
+        {
+            rkMatrix(k,i) = rkMatrix(i,k);
+        }
+
+        double dDiagonal = rkMatrix(i,i);
+        if (dDiagonal <= 0.0)
+        {
+            return false;
+        }
+        double dInvSqrt = 1.0 / math<double>::sqrt( dDiagonal );
+        for (k = i; k <= kMax; k++)
+        {
+            rkMatrix(k,i) *= dInvSqrt;
+        }
+    }
+
+    return true;
+}
+
+bool solveLower( const BandedMatrixd& rkMatrix, int iDimension, double* adControlData )
+{
+    const int iSize = rkMatrix.getSize();
+    const int iBands = rkMatrix.getLBands();
+    double* pdBaseTarget = adControlData;
+    for (int iRow = 0; iRow < iSize; iRow++)
+    {
+        if( math<double>::abs(rkMatrix(iRow,iRow)) < EPSILON_VALUE )
+        {
+            return false;
+        }
+
+        const int iColMin = ( iRow > iBands ) ? iRow - iBands : 0;
+        const double* pdBaseSource = &adControlData[iDimension*iColMin];
+        double* adTarget = pdBaseTarget;
+        int j;
+        for (int iCol = iColMin; iCol < iRow; iCol++)
+        {
+            const double* pdSource = pdBaseSource;
+            double dMatValue = rkMatrix(iRow,iCol);
+            for (j = 0; j < iDimension; j++)
+            {
+                adTarget[j] -= dMatValue*(*pdSource++);
+            }
+            pdBaseSource += iDimension;
+        }
+
+        double dInverse = 1.0/rkMatrix(iRow,iRow);
+        for (j = 0; j < iDimension; j++)
+        {
+            adTarget[j] *= dInverse;
+        }
+        pdBaseTarget += iDimension;
+    }
+
+    return true;
+}
+
+bool solveUpper( const BandedMatrixd& rkMatrix, int iDimension, double *adControlData )
+{
+    const int iSize = rkMatrix.getSize();
+    const int iBands = rkMatrix.getUBands();
+    double* pdBaseTarget = &adControlData[iDimension*(iSize-1)];
+    for (int iRow = iSize - 1; iRow >= 0; iRow--)
+    {
+        if( math<double>::abs(rkMatrix(iRow,iRow)) < EPSILON_VALUE ) {
+            return false;
+        }
+
+        const int iColMax = ( iRow + iBands < iSize - 1 ) ? iRow + iBands : iSize - 1;
+        const double* pdBaseSource = &adControlData[iDimension*(iRow+1)];
+        double* adTarget = pdBaseTarget;
+        int j;
+        for (int iCol = iRow+1; iCol <= iColMax; iCol++)
+        {
+            const double* pdSource = pdBaseSource;
+            double dMatValue = rkMatrix(iRow,iCol);
+            for (j = 0; j < iDimension; j++)
+            {
+                adTarget[j] -= dMatValue*(*pdSource++);
+            }
+            pdBaseSource += iDimension;
+        }
+
+        double dInverse = 1.0/rkMatrix(iRow,iRow);
+        for (j = 0; j < iDimension; j++)
+        {
+            adTarget[j] *= dInverse;
+        }
+        pdBaseTarget -= iDimension;
+    }
+
+    return true;
+}
+
+// Samples stored contiguously, iDimension values each
+template<typename T>
+struct ContiguousSamples {
+    typedef T Scalar;
+    ContiguousSamples( const T* afData, int iDimension ) : m_afData( afData ), m_iDimension( iDimension ) {}
+    const T* operator()( int i ) const { return &m_afData[m_iDimension*i]; }
+    const T* m_afData;
+    int m_iDimension;
+};
+
+// Samples in a ring buffer of vectors, starting at iFirst
+template<typename T>
+struct RingSamples {
+    typedef typename T::TYPE Scalar;
+    RingSamples( const vector<T> &rkSamples, int iFirst ) : m_rkSamples( rkSamples ), m_iFirst( iFirst ) {}
+    const Scalar* operator()( int i ) const
+    {
+        i += m_iFirst;
+        if (i >= (int)m_rkSamples.size())
+        {
+            i -= (int)m_rkSamples.size();
+        }
+        return &m_rkSamples[i].x;
+    }
+    const vector<T> &m_rkSamples;
+    int m_iFirst;
+};
+
+} // anonymous namespace
+
 //----------------------------------------------------------------------------
 
 template<typename T>
@@ -263,93 +498,29 @@ BSplineFit<T>::BSplineFit( int iDimension, int iSampleQuantity, const T* afSampl
 
 	// Fit the data points with a B-spline curve using a least-squares error
 	// metric.  The problem is of the form A^T*A*X = A^T*B.
-	BSplineFitBasisd kDBasis(m_iControlQuantity,m_iDegree);
-	double dTMultiplier = 1.0/(double)(m_iSampleQuantity - 1);
-	double dT;
-	int i0, i1, i2, iMin, iMax, j;
-
-	// Construct the matrix A (depends only on the output basis function).
-	BandedMatrixd* pkAMat = new BandedMatrixd( m_iControlQuantity, m_iDegree+1, m_iDegree + 1 );
-
-	for (i0 = 0; i0 < m_iControlQuantity; i0++) {
-		for ( i1 = 0; i1 < i0; i1++ ) {
-			(*pkAMat)(i0,i1) = (*pkAMat)(i1,i0);
-		}
-
-		int i1Max = i0 + m_iDegree;
-		if (i1Max >= m_iControlQuantity)
-		{
-			i1Max = m_iControlQuantity - 1;
-		}
-
-		for (i1 = i0; i1 <= i1Max; i1++)
-		{
-			double dValue = 0.0;
-			for (i2 = 0; i2 < m_iSampleQuantity; i2++)
-			{
-				dT = dTMultiplier*(double)i2;
-				kDBasis.compute(dT,iMin,iMax);
-				if (iMin <= i0 && i0 <= iMax && iMin <= i1 && i1 <= iMax)
-				{
-					double dB0 = kDBasis.getValue(i0 - iMin);
-					double dB1 = kDBasis.getValue(i1 - iMin);
-					dValue += dB0*dB1;
-				}
-			}
-			(*pkAMat)(i0,i1) = dValue;
-		}
-	}
+	vector<double> kBases;
+	vector<int> kMin;
+	computeSampleBases(m_iControlQuantity,m_iDegree,m_iSampleQuantity,kBases,kMin);
 
-	// Construct the matrix B.
-	double** aadBMat;
-	aadBMat = new double*[m_iControlQuantity];
-	aadBMat[0] = new double[m_iControlQuantity*m_iSampleQuantity];
-	for( int iRow = 1; iRow < m_iControlQuantity; iRow++ ) {
-		aadBMat[iRow] = &aadBMat[0][m_iSampleQuantity*iRow];
-	}
+	// Construct the matrix A^T*A (depends only on the output basis function).
+	BandedMatrixd kAMat( m_iControlQuantity, m_iDegree, m_iDegree );
+	computeNormalMatrix(m_iDegree,kBases,kMin,kAMat);
 
-	memset( aadBMat[0],0,m_iControlQuantity*m_iSampleQuantity*sizeof(double) );
-	for (i0 = 0; i0 < m_iControlQuantity; i0++)
-	{
-		for (i1 = 0; i1 < m_iSampleQuantity; i1++)
-		{
-			dT = dTMultiplier*(double)i1;
-			kDBasis.compute(dT,iMin,iMax);
-			if (iMin <= i0 && i0 <= iMax)
-			{
-				aadBMat[i0][i1] = kDBasis.getValue(i0 - iMin);
-			}
-		}
-	}
-
-	// Construct the control points for the least-squares curve.
-	double* adControlData = new double[m_iDimension*m_iControlQuantity];
-	memset( adControlData,0,m_iDimension*m_iControlQuantity*sizeof(double) );
-	double* pdBaseTarget = adControlData;
-	for (i0 = 0; i0 < m_iControlQuantity; i0++)
-	{
-		const T* pfSource = m_afSampleData;
-		double* adTarget = pdBaseTarget;
-		for (i1 = 0; i1 < m_iSampleQuantity; i1++)
-		{
-			double dBValue = aadBMat[i0][i1];
-			for (j = 0; j < m_iDimension; j++)
-			{
-				adTarget[j] += dBValue*(double)(*pfSource++);
-			}
-		}
-		pdBaseTarget += m_iDimension;
-	}
+	// Construct A^T*B*SampleData.
+	vector<double> kControlData(m_iDimension*m_iControlQuantity);
+	double* adControlData = &kControlData[0];
+	computeRightHandSide(m_iDimension,m_iDegree,kBases,kMin,ContiguousSamples<T>(m_afSampleData,m_iDimension),adControlData,m_iControlQuantity);
 
 	// Solve A^T*A*ControlData = A^T*B*SampleData.
-	bool bSolved = choleskyFactor(*pkAMat);
+	bool bSolved = choleskyFactor(kAMat);
 	assert(bSolved);
-	bSolved = solveLower(*pkAMat,adControlData);
+	bSolved = solveLower(kAMat,m_iDimension,adControlData);
 	assert(bSolved);
-	bSolved = solveUpper(*pkAMat,adControlData);
+	bSolved = solveUpper(kAMat,m_iDimension,adControlData);
 	assert(bSolved);
 
 	// Set the B-spline control points.
+	int i0, j;
 	T* pfTarget = m_afControlData;
 	const double* pdSource = adControlData;
 	for (i0 = 0; i0 < m_iDimension*m_iControlQuantity; i0++)
@@ -371,14 +542,6 @@ BSplineFit<T>::BSplineFit( int iDimension, int iSampleQuantity, const T* afSampl
 		*pfCEnd0++ = *pfSEnd0++;
 		*pfCEnd1++ = *pfSEnd1++;
 	}
-
-	delete [] adControlData;
-	if( aadBMat ) {
-        delete [] aadBMat[0];
-        delete [] aadBMat;
-        aadBMat = 0;
-    }
-	delete pkAMat;
 }
 
 template<typename T>
@@ -456,144 +619,116 @@ void BSplineFit<T>::getPosition( T fT, T* afPosition ) const
 }
 
 template<typename T>
-bool BSplineFit<T>::choleskyFactor( BandedMatrixd &rkMatrix ) const
+BSpline<T> fitBSpline( const std::vector<T> &samples, int degree, int outputSamples )
 {
-    const int iSize = rkMatrix.getSize(), iSizeM1 = iSize - 1;
-    const int iBands = rkMatrix.getLBands();  // == GetUBands()
-
-    int k, kMax;
-    for (int i = 0; i < iSize; i++)
-    {
-        int jMin = i - iBands;
-        if (jMin < 0)
-        {
-            jMin = 0;
-        }
-
-        int j;
-        for (j = jMin; j < i; j++)
-        {
-            kMax = j + iBands;
-            if (kMax > iSizeM1)
-            {
-                kMax = iSizeM1;
-            }
-
-            for (k = i; k <= kMax; k++)
-            {
-                rkMatrix(k,i) -= rkMatrix(i,j)*rkMatrix(k,j);
-            }
-        }
-
-        kMax = j + iBands;
-        if (kMax > iSizeM1)
-        {
-            kMax = iSizeM1;
-        }
-
-        for (k = 0; k < i; k++)
-        {
-            rkMatrix(k,i) = rkMatrix(i,k);
-        }
+	BSplineFit<typename T::TYPE> fit( T::DIM, (int)samples.size(), &(samples[0].x), degree, outputSamples );
 
-        double dDiagonal = rkMatrix(i,i);
-        if (dDiagonal <= 0.0)
-        {
-            return false;
-        }
-        double dInvSqrt = 1.0 / math<double>::sqrt( dDiagonal );
-        for (k = i; k <= kMax; k++)
-        {
-            rkMatrix(k,i) *= dInvSqrt;
-        }
-    }
+	vector<T> points;
+	for( int c = 0; c < fit.getControlQuantity(); ++c ) {
+		points.push_back( ( T( &fit.getControlData()[c * T::DIM] ) ) );
+	}
+	return BSpline<T>( points, fit.getDegree(), false, true );
+}
 
-    return true;
+///////////////////////////////////////////////////////////////////////////////////////////////////
+// BSplineWindowFit
+template<typename T>
+BSplineWindowFit<T>::BSplineWindowFit( int windowSize, int degree, int numControlPoints )
+	: mWindowSize( windowSize ), mDegree( degree ), mNumControlPoints( numControlPoints ), mSamples( windowSize ),
+	mFirstSample( 0 ), mNumSamples( 0 ), mFactor( numControlPoints, degree, degree ), mFactoredSamples( 0 ), mDirty( false )
+{
+	assert( 1 <= degree && degree < numControlPoints );
+	assert( numControlPoints <= windowSize );
 }
 
 template<typename T>
-bool BSplineFit<T>::solveLower( BandedMatrixd& rkMatrix, double* adControlData ) const
+void BSplineWindowFit<T>::addSample( const T &sample )
 {
-    const int iSize = rkMatrix.getSize();
-    double* pdBaseTarget = adControlData;
-    for (int iRow = 0; iRow < iSize; iRow++)
-    {
-        if( math<double>::abs(rkMatrix(iRow,iRow)) < EPSILON_VALUE )
-        {
-            return false;
-        }
+	if( mNumSamples < mWindowSize ) {
+		int index = mFirstSample + mNumSamples;
+		mSamples[( index < mWindowSize ) ? index : index - mWindowSize] = sample;
+		++mNumSamples;
+	}
+	else {
+		// overwrite the oldest sample
+		mSamples[mFirstSample] = sample;
+		if( ++mFirstSample == mWindowSize )
+			mFirstSample = 0;
+	}
+	mDirty = true;
+}
 
-        const double* pdBaseSource = adControlData;
-        double* adTarget = pdBaseTarget;
-        int j;
-        for (int iCol = 0; iCol < iRow; iCol++)
-        {
-            const double* pdSource = pdBaseSource;
-            double dMatValue = rkMatrix(iRow,iCol);
-            for (j = 0; j < m_iDimension; j++)
-            {
-                adTarget[j] -= dMatValue*(*pdSource++);
-            }
-            pdBaseSource += m_iDimension;
-        }
+template<typename T>
+void BSplineWindowFit<T>::addSamples( const T *samples, size_t count )
+{
+	// only the last mWindowSize samples survive
+	if( count > (size_t)mWindowSize ) {
+		samples += count - mWindowSize;
+		count = mWindowSize;
+	}
+	for( size_t i = 0; i < count; ++i )
+		addSample( samples[i] );
+}
 
-        double dInverse = 1.0/rkMatrix(iRow,iRow);
-        for (j = 0; j < m_iDimension; j++)
-        {
-            adTarget[j] *= dInverse;
-        }
-        pdBaseTarget += m_iDimension;
-    }
+template<typename T>
+void BSplineWindowFit<T>::clear()
+{
+	mFirstSample = mNumSamples = 0;
+	mControlPoints.clear();
+	mDirty = false;
+}
 
-    return true;
+template<typename T>
+void BSplineWindowFit<T>::factor() const
+{
+	// the normal matrix only depends on the number of samples, so this runs while the window fills and never again
+	computeSampleBases( mNumControlPoints, mDegree, mNumSamples, mSampleBases, mSampleMinIndices );
+	computeNormalMatrix( mDegree, mSampleBases, mSampleMinIndices, mFactor );
+	bool solved = choleskyFactor( mFactor );
+	assert( solved );
+	mFactoredSamples = mNumSamples;
 }
 
 template<typename T>
-bool BSplineFit<T>::solveUpper( BandedMatrixd& rkMatrix, double *adControlData ) const
+const std::vector<T>& BSplineWindowFit<T>::getControlPoints() const
 {
-    const int iSize = rkMatrix.getSize();
-    double* pdBaseTarget = &adControlData[m_iDimension*(iSize-1)];
-    for (int iRow = iSize - 1; iRow >= 0; iRow--)
-    {
-        if( math<double>::abs(rkMatrix(iRow,iRow)) < EPSILON_VALUE ) {
-            return false;
-        }
+	if( ! mDirty )
+		return mControlPoints;
+	mDirty = false;
 
-        const double* pdBaseSource = &adControlData[m_iDimension*(iRow+1)];
-        double* adTarget = pdBaseTarget;
-        int j;
-        for (int iCol = iRow+1; iCol < iSize; iCol++)
-        {
-            const double* pdSource = pdBaseSource;
-            double dMatValue = rkMatrix(iRow,iCol);
-            for (j = 0; j < m_iDimension; j++)
-            {
-                adTarget[j] -= dMatValue*(*pdSource++);
-            }
-            pdBaseSource += m_iDimension;
-        }
+	if( ! canFit() ) {
+		mControlPoints.clear();
+		return mControlPoints;
+	}
 
-        double dInverse = 1.0/rkMatrix(iRow,iRow);
-        for (j = 0; j < m_iDimension; j++)
-        {
-            adTarget[j] *= dInverse;
-        }
-        pdBaseTarget -= m_iDimension;
-    }
+	if( mFactoredSamples != mNumSamples )
+		factor();
 
-    return true;
+	vector<double> controlData( T::DIM * mNumControlPoints );
+	computeRightHandSide( T::DIM, mDegree, mSampleBases, mSampleMinIndices, RingSamples<T>( mSamples, mFirstSample ), &controlData[0], mNumControlPoints );
+	bool solved = solveLower( mFactor, T::DIM, &controlData[0] );
+	assert( solved );
+	solved = solveUpper( mFactor, T::DIM, &controlData[0] );
+	assert( solved );
+
+	mControlPoints.resize( mNumControlPoints );
+	for( int c = 0; c < mNumControlPoints; ++c ) {
+		for( int j = 0; j < T::DIM; ++j )
+			mControlPoints[c][j] = (typename T::TYPE)controlData[c * T::DIM + j];
+	}
+
+	// pin the ends to the oldest and newest samples, like fitBSpline()
+	int last = mFirstSample + mNumSamples - 1;
+	mControlPoints.front() = mSamples[mFirstSample];
+	mControlPoints.back() = mSamples[( last < mWindowSize ) ? last : last - mWindowSize];
+
+	return mControlPoints;
 }
 
 template<typename T>
-BSpline<T> fitBSpline( const std::vector<T> &samples, int degree, int outputSamples )
+BSpline<T> BSplineWindowFit<T>::getSpline() const
 {
-	BSplineFit<typename T::TYPE> fit( T::DIM, (int)samples.size(), &(samples[0].x), degree, outputSamples );
-
-	vector<T> points;
-	for( int c = 0; c < fit.getControlQuantity(); ++c ) {
-		points.push_back( ( T( &fit.getControlData()[c * T::DIM] ) ) );
-	}
-	return BSpline<T>( points, fit.getDegree(), false, true );
+	return BSpline<T>( getControlPoints(), mDegree, false, true );
 }
 
 template class BSplineFit<float>;
@@ -605,5 +740,9 @@ template BSpline<Vec2f> fitBSpline( const std::vector<Vec2f> &samples, int degre
 template BSpline<Vec3f> fitBSpline( const std::vector<Vec3f> &samples, int degree, int outputSamples );
 template BSpline<Vec4f> fitBSpline( const std::vector<Vec4f> &samples, int degree, int outputSamples );
 
+template class BSplineWindowFit<Vec2f>;
+template class BSplineWindowFit<Vec3f>;
+template class BSplineWindowFit<Vec4f>;
+
 
 } // namespace cinder
\ No newline at end of file
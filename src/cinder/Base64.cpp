@@ -21,208 +21,261 @@
  POSSIBILITY OF SUCH DAMAGE.
 */
 
-/* Significant portions of this code come from the public domain libb64 project. For details, see http://sourceforge.net/projects/libb64 */
-
 #include "cinder/Base64.h"
+#include "cinder/ip/Simd.h"
+
+#include <algorithm>
+
+#if defined( CINDER_IP_SSSE3 )
+	#include <tmmintrin.h>
+#elif defined( CINDER_IP_NEON )
+	#include <arm_neon.h>
+#endif
+
+namespace cinder {
 
 namespace {
 
-typedef enum { step_a, step_b, step_c, step_d } base64_decodestep;
+const char sEncodingTable[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-typedef struct {
-	base64_decodestep step;
-	char plainchar;
-} base64_decodestate;
+// the 6-bit value of each character of the alphabet, and -1 for everything else
+const int8_t sDecodingTable[256] = {
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,62,-1,-1,-1,63,52,53,54,55,56,57,58,59,60,61,-1,-1,-1,-1,-1,-1,
+	-1,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,-1,-1,-1,-1,-1,
+	-1,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47,48,49,50,51,-1,-1,-1,-1,-1,
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,
+	-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1
+};
 
-int base64_decode_value( char value_in ) {
-	static const char decoding[] = {62,-1,-1,-1,63,52,53,54,55,56,57,58,59,60,61,-1,-1,-1,-2,-1,-1,-1,0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,-1,-1,-1,-1,-1,-1,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47,48,49,50,51};
-	static const char decoding_size = sizeof(decoding);
-	value_in -= 43;
-	if (value_in < 0 || value_in > decoding_size) return -1;
-	return decoding[(int)value_in];
+// input is processed in chunks of this many bytes by the streaming functions
+const size_t CHUNK_SIZE = 49152;
+
+#if defined( CINDER_IP_NEON )
+// maps 6-bit values to the alphabet by adding the offset of the range each one falls in
+inline uint8x16_t encodeNeon( uint8x16_t values )
+{
+	uint8x16_t result = vaddq_u8( values, vdupq_n_u8( 'A' ) );
+	result = vaddq_u8( result, vandq_u8( vcgeq_u8( values, vdupq_n_u8( 26 ) ), vdupq_n_u8( 'a' - 26 - 'A' ) ) );
+	result = vaddq_u8( result, vandq_u8( vcgeq_u8( values, vdupq_n_u8( 52 ) ), vdupq_n_u8( (uint8_t)( ( '0' - 52 ) - ( 'a' - 26 ) ) ) ) );
+	result = vaddq_u8( result, vandq_u8( vcgeq_u8( values, vdupq_n_u8( 62 ) ), vdupq_n_u8( (uint8_t)( ( '+' - 62 ) - ( '0' - 52 ) ) ) ) );
+	result = vaddq_u8( result, vandq_u8( vcgeq_u8( values, vdupq_n_u8( 63 ) ), vdupq_n_u8( (uint8_t)( ( '/' - 63 ) - ( '+' - 62 ) ) ) ) );
+	return result;
 }
 
-void base64_init_decodestate( base64_decodestate* state_in )
+// maps characters to their 6-bit values, accumulating lanes which aren't in the alphabet in \a invalid
+inline uint8x16_t decodeNeon( uint8x16_t chars, uint8x16_t *invalid )
 {
-	state_in->step = step_a;
-	state_in->plainchar = 0;
+	uint8x16_t upper = vsubq_u8( chars, vdupq_n_u8( 'A' ) );
+	uint8x16_t lower = vsubq_u8( chars, vdupq_n_u8( 'a' ) );
+	uint8x16_t digit = vsubq_u8( chars, vdupq_n_u8( '0' ) );
+	uint8x16_t isUpper = vcltq_u8( upper, vdupq_n_u8( 26 ) );
+	uint8x16_t isLower = vcltq_u8( lower, vdupq_n_u8( 26 ) );
+	uint8x16_t isDigit = vcltq_u8( digit, vdupq_n_u8( 10 ) );
+	uint8x16_t isPlus = vceqq_u8( chars, vdupq_n_u8( '+' ) );
+	uint8x16_t isSlash = vceqq_u8( chars, vdupq_n_u8( '/' ) );
+
+	uint8x16_t result = vandq_u8( isUpper, upper );
+	result = vorrq_u8( result, vandq_u8( isLower, vaddq_u8( lower, vdupq_n_u8( 26 ) ) ) );
+	result = vorrq_u8( result, vandq_u8( isDigit, vaddq_u8( digit, vdupq_n_u8( 52 ) ) ) );
+	result = vorrq_u8( result, vandq_u8( isPlus, vdupq_n_u8( 62 ) ) );
+	result = vorrq_u8( result, vandq_u8( isSlash, vdupq_n_u8( 63 ) ) );
+
+	uint8x16_t valid = vorrq_u8( vorrq_u8( vorrq_u8( isUpper, isLower ), vorrq_u8( isDigit, isPlus ) ), isSlash );
+	*invalid = vorrq_u8( *invalid, vmvnq_u8( valid ) );
+	return result;
 }
+#endif
 
-int base64_decode_block( const char* code_in, const int length_in, char* plaintext_out, base64_decodestate* state_in )
+// Encodes \a groups groups of 3 bytes from \a src as 4 characters each
+void encodeRun( const uint8_t *src, size_t groups, char *dst )
 {
-	const char* codechar = code_in;
-	char* plainchar = plaintext_out;
-	char fragment;
-	
-	*plainchar = state_in->plainchar;
-	
-	switch (state_in->step)
-	{
-		while (1)
-		{
-	case step_a:
-			do {
-				if (codechar == code_in+length_in)
-				{
-					state_in->step = step_a;
-					state_in->plainchar = *plainchar;
-					return plainchar - plaintext_out;
-				}
-				fragment = (char)base64_decode_value(*codechar++);
-			} while (fragment < 0);
-			*plainchar    = (fragment & 0x03f) << 2;
-	case step_b:
-			do {
-				if (codechar == code_in+length_in)
-				{
-					state_in->step = step_b;
-					state_in->plainchar = *plainchar;
-					return plainchar - plaintext_out;
-				}
-				fragment = (char)base64_decode_value(*codechar++);
-			} while (fragment < 0);
-			*plainchar++ |= (fragment & 0x030) >> 4;
-			*plainchar    = (fragment & 0x00f) << 4;
-	case step_c:
-			do {
-				if (codechar == code_in+length_in)
-				{
-					state_in->step = step_c;
-					state_in->plainchar = *plainchar;
-					return plainchar - plaintext_out;
-				}
-				fragment = (char)base64_decode_value(*codechar++);
-			} while (fragment < 0);
-			*plainchar++ |= (fragment & 0x03c) >> 2;
-			*plainchar    = (fragment & 0x003) << 6;
-	case step_d:
-			do {
-				if (codechar == code_in+length_in)
-				{
-					state_in->step = step_d;
-					state_in->plainchar = *plainchar;
-					return plainchar - plaintext_out;
-				}
-				fragment = (char)base64_decode_value(*codechar++);
-			} while (fragment < 0);
-			*plainchar++   |= (fragment & 0x03f);
+#if defined( CINDER_IP_SSSE3 )
+	// 4 groups at a time: spread 12 bytes over 16 lanes of 6 bits, then map each range of the alphabet with a single shuffle. Loads read 4 bytes past the 12 consumed.
+	if( ip::useSsse3() ) {
+		const __m128i shuffle = _mm_setr_epi8( 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10 );
+		const __m128i offsets = _mm_setr_epi8( 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'+' - 62, '/' - 63, 'A', 0, 0 );
+		for( ; groups >= 6; groups -= 4, src += 12, dst += 16 ) {
+			__m128i in = _mm_shuffle_epi8( _mm_loadu_si128( (const __m128i*)src ), shuffle );
+			__m128i hi = _mm_mulhi_epu16( _mm_and_si128( in, _mm_set1_epi32( 0x0fc0fc00 ) ), _mm_set1_epi32( 0x04000040 ) );
+			__m128i lo = _mm_mullo_epi16( _mm_and_si128( in, _mm_set1_epi32( 0x003f03f0 ) ), _mm_set1_epi32( 0x01000010 ) );
+			__m128i values = _mm_or_si128( hi, lo );
+			// 0 for values < 26 ('A'), 1 for < 52 ('a' - 26), 2..11 for digits, 12 for '+', 13 for '/'
+			__m128i range = _mm_subs_epu8( values, _mm_set1_epi8( 51 ) );
+			range = _mm_or_si128( range, _mm_and_si128( _mm_cmpgt_epi8( _mm_set1_epi8( 26 ), values ), _mm_set1_epi8( 13 ) ) );
+			_mm_storeu_si128( (__m128i*)dst, _mm_add_epi8( values, _mm_shuffle_epi8( offsets, range ) ) );
 		}
 	}
-	/* control should not reach here */
-	return plainchar - plaintext_out;
-}
+#elif defined( CINDER_IP_NEON )
+	if( ip::useNeon() ) {
+		for( ; groups >= 16; groups -= 16, src += 48, dst += 64 ) {
+			uint8x16x3_t in = vld3q_u8( src );
+			uint8x16x4_t out;
+			out.val[0] = encodeNeon( vshrq_n_u8( in.val[0], 2 ) );
+			out.val[1] = encodeNeon( vandq_u8( vorrq_u8( vshlq_n_u8( in.val[0], 4 ), vshrq_n_u8( in.val[1], 4 ) ), vdupq_n_u8( 0x3f ) ) );
+			out.val[2] = encodeNeon( vandq_u8( vorrq_u8( vshlq_n_u8( in.val[1], 2 ), vshrq_n_u8( in.val[2], 6 ) ), vdupq_n_u8( 0x3f ) ) );
+			out.val[3] = encodeNeon( vandq_u8( in.val[2], vdupq_n_u8( 0x3f ) ) );
+			vst4q_u8( (uint8_t*)dst, out );
+		}
+	}
+#endif
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-// encode
-typedef enum { step_A, step_B, step_C } base64_encodestep;
+	for( ; groups; --groups, src += 3, dst += 4 ) {
+		dst[0] = sEncodingTable[src[0] >> 2];
+		dst[1] = sEncodingTable[( ( src[0] & 0x03 ) << 4 ) | ( src[1] >> 4 )];
+		dst[2] = sEncodingTable[( ( src[1] & 0x0f ) << 2 ) | ( src[2] >> 6 )];
+		dst[3] = sEncodingTable[src[2] & 0x3f];
+	}
+}
 
-typedef struct {
-	base64_encodestep step;
-	char result;
-	int stepcount;
-} base64_encodestate;
+// Encodes \a groups groups of 3 bytes, inserting a newline after every \a groupsPerLine groups unless it's 0. \a lineGroups carries the number of groups on the current line between calls. Returns the number of characters written.
+size_t encodeGroups( const uint8_t *src, size_t groups, char *dst, size_t groupsPerLine, size_t *lineGroups )
+{
+	char *start = dst;
+	while( groups ) {
+		size_t run = ( groupsPerLine ) ? std::min( groups, groupsPerLine - *lineGroups ) : groups;
+		encodeRun( src, run, dst );
+		src += run * 3;
+		dst += run * 4;
+		groups -= run;
+		if( groupsPerLine ) {
+			*lineGroups += run;
+			if( *lineGroups == groupsPerLine ) {
+				*dst++ = '\n';
+				*lineGroups = 0;
+			}
+		}
+	}
+	return dst - start;
+}
 
-void base64_init_encodestate( base64_encodestate* state_in )
+// Encodes the final 1 or 2 bytes of the input with padding
+size_t encodeTail( const uint8_t *src, size_t size, char *dst )
 {
-	state_in->step = step_A;
-	state_in->result = 0;
-	state_in->stepcount = 0;
+	if( size == 0 )
+		return 0;
+	dst[0] = sEncodingTable[src[0] >> 2];
+	if( size == 1 ) {
+		dst[1] = sEncodingTable[( src[0] & 0x03 ) << 4];
+		dst[2] = '=';
+	}
+	else {
+		dst[1] = sEncodingTable[( ( src[0] & 0x03 ) << 4 ) | ( src[1] >> 4 )];
+		dst[2] = sEncodingTable[( src[1] & 0x0f ) << 2];
+	}
+	dst[3] = '=';
+	return 4;
 }
 
-char base64_encode_value(char value_in)
+// Returns the most characters encoding \a groups groups can produce, including line breaks
+size_t getEncodedSize( size_t groups, size_t groupsPerLine )
 {
-	static const char* encoding = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-	if (value_in > 63) return '=';
-	return encoding[(int)value_in];
+	return groups * 4 + ( ( groupsPerLine ) ? groups / groupsPerLine + 1 : 0 );
 }
 
-int base64_encode_block(const char* plaintext_in, int length_in, char* code_out, base64_encodestate* state_in, int charsPerLine )
+// Decodes whole groups of 4 alphabet characters, stopping at the first group which contains anything else, like a line break or padding, or when
+// fewer than 4 characters or less than 3 bytes of \a dstCapacity remain. Stores the number of characters read in \a consumed and returns the number of bytes written.
+size_t decodeGroups( const uint8_t *src, size_t size, uint8_t *dst, size_t dstCapacity, size_t *consumed )
 {
-	const char* plainchar = plaintext_in;
-	const char* const plaintextend = plaintext_in + length_in;
-	char* codechar = code_out;
-	char result;
-	char fragment;
-	
-	result = state_in->result;
-	
-	switch (state_in->step)
-	{
-		while (1)
-		{
-	case step_A:
-			if (plainchar == plaintextend)
-			{
-				state_in->result = result;
-				state_in->step = step_A;
-				return codechar - code_out;
-			}
-			fragment = *plainchar++;
-			result = (fragment & 0x0fc) >> 2;
-			*codechar++ = base64_encode_value(result);
-			result = (fragment & 0x003) << 4;
-	case step_B:
-			if (plainchar == plaintextend)
-			{
-				state_in->result = result;
-				state_in->step = step_B;
-				return codechar - code_out;
-			}
-			fragment = *plainchar++;
-			result |= (fragment & 0x0f0) >> 4;
-			*codechar++ = base64_encode_value(result);
-			result = (fragment & 0x00f) << 2;
-	case step_C:
-			if (plainchar == plaintextend)
-			{
-				state_in->result = result;
-				state_in->step = step_C;
-				return codechar - code_out;
-			}
-			fragment = *plainchar++;
-			result |= (fragment & 0x0c0) >> 6;
-			*codechar++ = base64_encode_value(result);
-			result  = (fragment & 0x03f) >> 0;
-			*codechar++ = base64_encode_value(result);
-			
-			++(state_in->stepcount);
-			if ( ( charsPerLine != 0 ) && ( state_in->stepcount == charsPerLine/4 ) )
-			{
-				*codechar++ = '\n';
-				state_in->stepcount = 0;
-			}
+	const uint8_t *srcStart = src, *srcEnd = src + size;
+	uint8_t *dstStart = dst, *dstEnd = dst + dstCapacity;
+
+#if defined( CINDER_IP_SSSE3 )
+	// 16 characters at a time: classify each one by its nibbles to validate it and find the offset of its range, then pack the 6-bit values. Stores write 4 bytes past the 12 produced.
+	if( ip::useSsse3() ) {
+		const __m128i lutLo = _mm_setr_epi8( 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A );
+		const __m128i lutHi = _mm_setr_epi8( 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10 );
+		const __m128i lutRoll = _mm_setr_epi8( 0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0 );
+		const __m128i mask2F = _mm_set1_epi8( 0x2f );
+		const __m128i pack = _mm_setr_epi8( 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1 );
+		while( ( srcEnd - src >= 16 ) && ( dstEnd - dst >= 16 ) ) {
+			__m128i chars = _mm_loadu_si128( (const __m128i*)src );
+			__m128i hiNibbles = _mm_and_si128( _mm_srli_epi32( chars, 4 ), mask2F );
+			__m128i lo = _mm_shuffle_epi8( lutLo, _mm_and_si128( chars, mask2F ) );
+			__m128i hi = _mm_shuffle_epi8( lutHi, hiNibbles );
+			if( _mm_movemask_epi8( _mm_cmpeq_epi8( _mm_and_si128( lo, hi ), _mm_setzero_si128() ) ) != 0xFFFF )
+				break;
+			__m128i roll = _mm_shuffle_epi8( lutRoll, _mm_add_epi8( _mm_cmpeq_epi8( chars, mask2F ), hiNibbles ) );
+			__m128i values = _mm_add_epi8( chars, roll );
+			__m128i merged = _mm_madd_epi16( _mm_maddubs_epi16( values, _mm_set1_epi32( 0x01400140 ) ), _mm_set1_epi32( 0x00011000 ) );
+			_mm_storeu_si128( (__m128i*)dst, _mm_shuffle_epi8( merged, pack ) );
+			src += 16;
+			dst += 12;
+		}
+	}
+#elif defined( CINDER_IP_NEON )
+	if( ip::useNeon() ) {
+		while( ( srcEnd - src >= 64 ) && ( dstEnd - dst >= 48 ) ) {
+			uint8x16x4_t chars = vld4q_u8( src );
+			uint8x16_t invalid = vdupq_n_u8( 0 );
+			uint8x16_t a = decodeNeon( chars.val[0], &invalid );
+			uint8x16_t b = decodeNeon( chars.val[1], &invalid );
+			uint8x16_t c = decodeNeon( chars.val[2], &invalid );
+			uint8x16_t d = decodeNeon( chars.val[3], &invalid );
+			uint64x2_t invalid64 = vreinterpretq_u64_u8( invalid );
+			if( vgetq_lane_u64( invalid64, 0 ) | vgetq_lane_u64( invalid64, 1 ) )
+				break;
+			uint8x16x3_t bytes;
+			bytes.val[0] = vorrq_u8( vshlq_n_u8( a, 2 ), vshrq_n_u8( b, 4 ) );
+			bytes.val[1] = vorrq_u8( vshlq_n_u8( b, 4 ), vshrq_n_u8( c, 2 ) );
+			bytes.val[2] = vorrq_u8( vshlq_n_u8( c, 6 ), d );
+			vst3q_u8( dst, bytes );
+			src += 64;
+			dst += 48;
 		}
 	}
-	/* control should not reach here */
-	return codechar - code_out;
+#endif
+
+	while( ( srcEnd - src >= 4 ) && ( dstEnd - dst >= 3 ) ) {
+		int a = sDecodingTable[src[0]], b = sDecodingTable[src[1]], c = sDecodingTable[src[2]], d = sDecodingTable[src[3]];
+		if( ( a | b | c | d ) < 0 )
+			break;
+		dst[0] = (uint8_t)( ( a << 2 ) | ( b >> 4 ) );
+		dst[1] = (uint8_t)( ( b << 4 ) | ( c >> 2 ) );
+		dst[2] = (uint8_t)( ( c << 6 ) | d );
+		src += 4;
+		dst += 3;
+	}
+
+	*consumed = src - srcStart;
+	return dst - dstStart;
 }
 
-int base64_encode_blockend( char* code_out, base64_encodestate* state_in )
+// Decodes \a size characters, skipping anything outside the alphabet. \a step and \a partial carry an incomplete group between calls.
+// \a dst needs room for size / 4 * 3 + 3 bytes. Returns the number of bytes written.
+size_t decode( const uint8_t *src, size_t size, uint8_t *dst, int *step, char *partial )
 {
-	char* codechar = code_out;
-	
-	switch (state_in->step) {
-	case step_B:
-		*codechar++ = base64_encode_value(state_in->result);
-		*codechar++ = '=';
-		*codechar++ = '=';
-		break;
-	case step_C:
-		*codechar++ = base64_encode_value(state_in->result);
-		*codechar++ = '=';
-		break;
-	case step_A:
-		break;
+	const uint8_t *srcEnd = src + size;
+	uint8_t *dstStart = dst, *dstEnd = dst + size / 4 * 3 + 3;
+	while( src < srcEnd ) {
+		// whole groups take the fast path; line breaks, padding and groups split between calls go through one character at a time
+		if( *step == 0 ) {
+			size_t consumed;
+			dst += decodeGroups( src, srcEnd - src, dst, dstEnd - dst, &consumed );
+			src += consumed;
+			if( src == srcEnd )
+				break;
+		}
+
+		int value = sDecodingTable[*src++];
+		if( value < 0 )
+			continue;
+		switch( *step ) {
+			case 0: *partial = (char)( value << 2 ); break;
+			case 1: *dst++ = (uint8_t)( *partial | ( value >> 4 ) ); *partial = (char)( value << 4 ); break;
+			case 2: *dst++ = (uint8_t)( *partial | ( value >> 2 ) ); *partial = (char)( value << 6 ); break;
+			case 3: *dst++ = (uint8_t)( *partial | value ); break;
+		}
+		*step = ( *step + 1 ) & 3;
 	}
-	
-	return codechar - code_out;
+	return dst - dstStart;
 }
 
 } // anonymous namespace
 
-////////////////////////////////////////////////////////////////////////////////////////////////////
-namespace cinder {
-
 std::string toBase64( const std::string &input, int charsPerLine )
 {
 	return toBase64( input.c_str(), input.size(), charsPerLine );
@@ -237,19 +290,13 @@ std::string toBase64( const void *input, size_t inputSize, int charsPerLine )
 {
 	if( inputSize == 0 ) return std::string();
 
-	if( charsPerLine != 0 )
-		charsPerLine -= charsPerLine % 4;
-	size_t lines = ( charsPerLine == 0 ) ? 0 : ( inputSize * 4 / 3 / charsPerLine + 1 ); // account for inserted carriage returns
-	char *buffer = new char[inputSize * 4 / 3 + 4 + lines];
-
-	base64_encodestate encs;
-	base64_init_encodestate( &encs );
-	size_t resultSize = base64_encode_block( reinterpret_cast<const char*>(input), inputSize, &buffer[0], &encs, charsPerLine );
-	resultSize += base64_encode_blockend( &buffer[resultSize], &encs );
-	buffer[resultSize] = 0; // null terminate the string
-	
-	std::string result( buffer );
-	delete [] buffer;
+	size_t groupsPerLine = ( charsPerLine > 0 ) ? charsPerLine / 4 : 0;
+	size_t groups = inputSize / 3, lineGroups = 0;
+	std::string result( getEncodedSize( groups, groupsPerLine ) + 4, 0 );
+	const uint8_t *src = reinterpret_cast<const uint8_t*>( input );
+	size_t resultSize = encodeGroups( src, groups, &result[0], groupsPerLine, &lineGroups );
+	resultSize += encodeTail( src + groups * 3, inputSize - groups * 3, &result[resultSize] );
+	result.resize( resultSize );
 	return result;
 }
 
@@ -266,15 +313,116 @@ Buffer fromBase64( const Buffer &input )
 Buffer fromBase64( const void *input, size_t inputSize )
 {
 	size_t outputSize = inputSize / 4 * 3;
-	Buffer result( outputSize );
-	if( inputSize >= 4 ) {
-		base64_decodestate decs;
-		base64_init_decodestate( &decs );
-		int actualSize = base64_decode_block( reinterpret_cast<const char*>(input), inputSize, (char*)result.getData(), &decs );
-		result.setDataSize( actualSize );
-	}
+	Buffer result( outputSize + 3 );
+	int step = 0;
+	char partial = 0;
+	result.setDataSize( decode( reinterpret_cast<const uint8_t*>( input ), inputSize, (uint8_t*)result.getData(), &step, &partial ) );
 	return result;
 }
 
+void toBase64( IStreamRef input, OStreamRef output, int charsPerLine )
+{
+	Base64Encoder encoder( output, charsPerLine );
+	Buffer chunk( CHUNK_SIZE );
+	while( ! input->isEof() ) {
+		size_t size = input->readDataAvailable( chunk.getData(), CHUNK_SIZE );
+		if( size == 0 )
+			break;
+		encoder.write( chunk.getData(), size );
+	}
+	encoder.finish();
+}
+
+void fromBase64( IStreamRef input, OStreamRef output )
+{
+	Base64Decoder decoder( output );
+	Buffer chunk( CHUNK_SIZE );
+	while( ! input->isEof() ) {
+		size_t size = input->readDataAvailable( chunk.getData(), CHUNK_SIZE );
+		if( size == 0 )
+			break;
+		decoder.write( chunk.getData(), size );
+	}
+	decoder.finish();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Base64Encoder
+Base64Encoder::Base64Encoder( OStreamRef output, int charsPerLine )
+	: mOutput( output ), mGroupsPerLine( ( charsPerLine > 0 ) ? charsPerLine / 4 : 0 ), mLineGroups( 0 ), mNumPending( 0 ), mFinished( false )
+{
+	mOutputBuffer = Buffer( getEncodedSize( CHUNK_SIZE / 3, mGroupsPerLine ) + 4 );
+}
+
+Base64Encoder::~Base64Encoder()
+{
+	try {
+		finish();
+	}
+	catch( ... ) {
+	}
+}
+
+void Base64Encoder::write( const void *data, size_t size )
+{
+	if( mFinished )
+		return;
+
+	const uint8_t *src = reinterpret_cast<const uint8_t*>( data );
+	char *dst = reinterpret_cast<char*>( mOutputBuffer.getData() );
+	// complete a group held back from the previous call
+	if( mNumPending ) {
+		while( ( mNumPending < 3 ) && size ) {
+			mPending[mNumPending++] = *src++;
+			--size;
+		}
+		if( mNumPending < 3 )
+			return;
+		mOutput->writeData( dst, encodeGroups( mPending, 1, dst, mGroupsPerLine, &mLineGroups ) );
+		mNumPending = 0;
+	}
+
+	while( size >= 3 ) {
+		size_t groups = std::min( size / 3, CHUNK_SIZE / 3 );
+		mOutput->writeData( dst, encodeGroups( src, groups, dst, mGroupsPerLine, &mLineGroups ) );
+		src += groups * 3;
+		size -= groups * 3;
+	}
+
+	while( size-- )
+		mPending[mNumPending++] = *src++;
+}
+
+void Base64Encoder::finish()
+{
+	if( mFinished )
+		return;
+
+	mFinished = true;
+	char *dst = reinterpret_cast<char*>( mOutputBuffer.getData() );
+	mOutput->writeData( dst, encodeTail( mPending, mNumPending, dst ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Base64Decoder
+Base64Decoder::Base64Decoder( OStreamRef output )
+	: mOutput( output ), mOutputBuffer( CHUNK_SIZE / 4 * 3 + 3 ), mStep( 0 ), mPartial( 0 ), mFinished( false )
+{
+}
+
+void Base64Decoder::write( const void *encoded, size_t size )
+{
+	if( mFinished )
+		return;
+
+	const uint8_t *src = reinterpret_cast<const uint8_t*>( encoded );
+	while( size ) {
+		size_t chunkSize = std::min( size, CHUNK_SIZE );
+		size_t decodedSize = decode( src, chunkSize, (uint8_t*)mOutputBuffer.getData(), &mStep, &mPartial );
+		mOutput->writeData( mOutputBuffer.getData(), decodedSize );
+		src += chunkSize;
+		size -= chunkSize;
+	}
+}
 
 } // namespace cinder
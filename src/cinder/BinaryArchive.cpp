@@ -0,0 +1,246 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/BinaryArchive.h"
+
+#include <cstdio>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+const char		BINARY_ARCHIVE_MAGIC[4] = { 'C', 'I', 'B', 'A' };
+const uint32_t	BINARY_ARCHIVE_FORMAT_VERSION = 1;
+
+// the layout versions of the records written for compound types; bump one when its layout changes and keep reading the older ones
+const uint8_t	POLYLINE_RECORD_VERSION = 1;
+const uint8_t	TRIMESH_RECORD_VERSION = 1;
+const uint8_t	SURFACE_RECORD_VERSION = 1;
+
+} // anonymous namespace
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// BinaryOArchive
+BinaryOArchive::BinaryOArchive( OStreamRef stream, uint32_t version )
+	: mStream( stream )
+{
+	writeHeader( version );
+}
+
+BinaryOArchive::BinaryOArchive( DataTargetRef target, uint32_t version )
+	: mStream( target->getStream() )
+{
+	writeHeader( version );
+}
+
+void BinaryOArchive::writeHeader( uint32_t version )
+{
+	mStream->writeData( BINARY_ARCHIVE_MAGIC, sizeof(BINARY_ARCHIVE_MAGIC) );
+	mStream->writeLittle( BINARY_ARCHIVE_FORMAT_VERSION );
+	mStream->writeLittle( version );
+}
+
+void BinaryOArchive::writeCount( size_t count )
+{
+	mStream->writeLittle( static_cast<uint32_t>( count ) );
+}
+
+void BinaryOArchive::write( const std::string &s )
+{
+	writeCount( s.size() );
+	if( ! s.empty() )
+		mStream->writeData( s.data(), s.size() );
+}
+
+template<typename T>
+void BinaryOArchive::write( const PolyLine<T> &polyLine )
+{
+	write( POLYLINE_RECORD_VERSION );
+	write( polyLine.isClosed() );
+	write( polyLine.getPoints() );
+}
+
+void BinaryOArchive::write( const TriMesh &mesh )
+{
+	write( TRIMESH_RECORD_VERSION );
+	write( mesh.getVertices() );
+	write( mesh.getNormals() );
+	write( mesh.getColorsRGB() );
+	write( mesh.getColorsRGBA() );
+	write( mesh.getTexCoords() );
+	write( mesh.getTangents() );
+	write( mesh.getIndices() );
+}
+
+template<typename T>
+void BinaryOArchive::write( const SurfaceT<T> &surface )
+{
+	write( SURFACE_RECORD_VERSION );
+	write( surface.getWidth() );
+	write( surface.getHeight() );
+	write( static_cast<int32_t>( surface.getChannelOrder().getCode() ) );
+	write( surface.isPremultiplied() );
+
+	// the rows are contiguous unless the Surface pads them, in which case they go one at a time
+	const size_t rowValues = surface.getWidth() * surface.getPixelInc();
+	if( surface.getRowBytes() == (int32_t)( rowValues * sizeof(T) ) )
+		writeArray( surface.getData(), rowValues * surface.getHeight() );
+	else {
+		for( int32_t y = 0; y < surface.getHeight(); ++y )
+			writeArray( surface.getData( Vec2i( 0, y ) ), rowValues );
+	}
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// BinaryIArchive
+BinaryIArchive::BinaryIArchive( IStreamRef stream )
+	: mStream( stream )
+{
+	readHeader();
+}
+
+BinaryIArchive::BinaryIArchive( DataSourceRef source )
+	: mStream( source->createStream() )
+{
+	readHeader();
+}
+
+void BinaryIArchive::readHeader()
+{
+	char magic[sizeof(BINARY_ARCHIVE_MAGIC)];
+	readData( magic, sizeof(magic) );
+	if( memcmp( magic, BINARY_ARCHIVE_MAGIC, sizeof(magic) ) )
+		throw ExcInvalidArchive( "not a binary archive" );
+	uint32_t formatVersion;
+	read( &formatVersion );
+	if( formatVersion > BINARY_ARCHIVE_FORMAT_VERSION )
+		throw ExcInvalidArchive( "archive format is newer than this version of Cinder reads" );
+	read( &mVersion );
+}
+
+void BinaryIArchive::checkAvailable( size_t size ) const
+{
+	if( (uint64_t)size > (uint64_t)( mStream->size() - mStream->tell() ) )
+		throw ExcInvalidArchive( "archive is truncated" );
+}
+
+size_t BinaryIArchive::readCount( size_t elementSize )
+{
+	uint32_t count;
+	read( &count );
+	if( (uint64_t)count * elementSize > (uint64_t)( mStream->size() - mStream->tell() ) )
+		throw ExcInvalidArchive( "archive is truncated" );
+	return count;
+}
+
+uint8_t BinaryIArchive::readRecordVersion( uint8_t currentVersion, const char *typeName )
+{
+	uint8_t version;
+	read( &version );
+	if( ( version == 0 ) || ( version > currentVersion ) ) {
+		char description[256];
+		sprintf( description, "unsupported %s layout version %d", typeName, (int)version );
+		throw ExcInvalidArchive( description );
+	}
+	return version;
+}
+
+void BinaryIArchive::read( bool *b )
+{
+	uint8_t value;
+	read( &value );
+	*b = ( value != 0 );
+}
+
+void BinaryIArchive::read( std::string *s )
+{
+	size_t size = readCount( 1 );
+	s->resize( size );
+	if( size )
+		mStream->readData( &(*s)[0], size );
+}
+
+template<typename T>
+void BinaryIArchive::read( PolyLine<T> *polyLine )
+{
+	readRecordVersion( POLYLINE_RECORD_VERSION, "PolyLine" );
+	polyLine->setClosed( read<bool>() );
+	read( &polyLine->getPoints() );
+}
+
+void BinaryIArchive::read( TriMesh *mesh )
+{
+	readRecordVersion( TRIMESH_RECORD_VERSION, "TriMesh" );
+	read( &mesh->getVertices() );
+	read( &mesh->getNormals() );
+	read( &mesh->getColorsRGB() );
+	read( &mesh->getColorsRGBA() );
+	read( &mesh->getTexCoords() );
+	read( &mesh->getTangents() );
+	read( &mesh->getIndices() );
+}
+
+template<typename T>
+void BinaryIArchive::read( SurfaceT<T> *surface )
+{
+	readRecordVersion( SURFACE_RECORD_VERSION, "Surface" );
+	int32_t width = read<int32_t>(), height = read<int32_t>(), code = read<int32_t>();
+	bool premultiplied = read<bool>();
+	if( ( width <= 0 ) || ( height <= 0 ) || ( code < 0 ) || ( code >= SurfaceChannelOrder::UNSPECIFIED ) )
+		throw ExcInvalidArchive( "invalid Surface" );
+
+	SurfaceChannelOrder channelOrder( code );
+	const size_t rowValues = width * channelOrder.getPixelInc();
+	if( (uint64_t)rowValues * height * sizeof(T) > (uint64_t)( mStream->size() - mStream->tell() ) )
+		throw ExcInvalidArchive( "archive is truncated" );
+	*surface = SurfaceT<T>( width, height, channelOrder.hasAlpha(), channelOrder );
+	surface->setPremultiplied( premultiplied );
+
+	if( surface->getRowBytes() == (int32_t)( rowValues * sizeof(T) ) )
+		readArray( surface->getData(), rowValues * height );
+	else {
+		for( int32_t y = 0; y < height; ++y )
+			readArray( surface->getData( Vec2i( 0, y ) ), rowValues );
+	}
+}
+
+BinaryIArchive::ExcInvalidArchive::ExcInvalidArchive( const char *description ) throw()
+{
+	sprintf( mMessage, "Invalid binary archive: %s", description );
+}
+
+template void BinaryOArchive::write<Vec2f>( const PolyLine<Vec2f> &polyLine );
+template void BinaryOArchive::write<Vec2d>( const PolyLine<Vec2d> &polyLine );
+template void BinaryIArchive::read<Vec2f>( PolyLine<Vec2f> *polyLine );
+template void BinaryIArchive::read<Vec2d>( PolyLine<Vec2d> *polyLine );
+template void BinaryOArchive::write<uint8_t>( const SurfaceT<uint8_t> &surface );
+template void BinaryOArchive::write<uint16_t>( const SurfaceT<uint16_t> &surface );
+template void BinaryOArchive::write<float>( const SurfaceT<float> &surface );
+template void BinaryIArchive::read<uint8_t>( SurfaceT<uint8_t> *surface );
+template void BinaryIArchive::read<uint16_t>( SurfaceT<uint16_t> *surface );
+template void BinaryIArchive::read<float>( SurfaceT<float> *surface );
+
+} // namespace cinder
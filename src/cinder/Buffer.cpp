@@ -25,14 +25,25 @@
 #include "cinder/DataSource.h"
 #include "cinder/DataTarget.h"
 #include <zlib.h>
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <iostream>
 
 namespace cinder {
 
 Buffer::Obj::Obj( void * aData, size_t aSize, bool aOwnsData ) 
-	: mData( aData ), mAllocatedSize( aSize ), mDataSize( aSize ), mOwnsData( aOwnsData ) 
+	: mData( aData ), mAllocatedSize( aSize ), mDataSize( aSize ), mOwnsData( aOwnsData ), mIsInline( false ), mTrackedMemory( MemoryTracker::BUFFER )
 {
+	if( mOwnsData )
+		mTrackedMemory.set( aSize );
+}
+
+Buffer::InlineObj::InlineObj( size_t aSize )
+	: Obj( mStorage, aSize, false )
+{
+	mAllocatedSize = INLINE_SIZE;
+	mIsInline = true;
 }
 
 Buffer::Obj::~Obj()
@@ -45,9 +56,8 @@ Buffer::Obj::~Obj()
 Buffer::Buffer( std::shared_ptr<DataSource> dataSource )
 {
 	Buffer &otherBuffer = dataSource->getBuffer();
-	char *data = reinterpret_cast<char*>( malloc( otherBuffer.getDataSize() ) );
-	memcpy( data, otherBuffer.getData(), otherBuffer.getDataSize() );
-	mObj = std::shared_ptr<Obj>( new Obj( data, otherBuffer.getDataSize(), true ) );
+	*this = Buffer( otherBuffer.getDataSize() );
+	memcpy( getData(), otherBuffer.getData(), otherBuffer.getDataSize() );
 }
 
 Buffer::Buffer( void * aData, size_t aSize ) 
@@ -56,17 +66,41 @@ Buffer::Buffer( void * aData, size_t aSize )
 }
 
 Buffer::Buffer( size_t aSize ) 
-	: mObj( new Obj( malloc( aSize ), aSize, true ) )
 {
+	// reset() takes the derived type, so an InlineObj is deleted as such
+	if( aSize <= INLINE_SIZE )
+		mObj.reset( new InlineObj( aSize ) );
+	else
+		mObj.reset( new Obj( malloc( aSize ), aSize, true ) );
+}
+
+Buffer::Buffer( const std::shared_ptr<const void> &data, size_t size )
+	: mObj( new Obj( const_cast<void*>( data.get() ), size, false ) )
+{
+	mObj->mDataOwner = data;
 }
 
 void Buffer::resize( size_t newSize )
 {
+	if( mObj->mIsInline ) {
+		if( newSize > mObj->mAllocatedSize ) { // move the data to the heap
+			void *data = malloc( newSize );
+			memcpy( data, mObj->mData, std::min( mObj->mDataSize, newSize ) );
+			mObj->mData = data;
+			mObj->mAllocatedSize = newSize;
+			mObj->mOwnsData = true;
+			mObj->mIsInline = false;
+			mObj->mTrackedMemory.set( newSize );
+		}
+		mObj->mDataSize = newSize;
+		return;
+	}
 	if( ! mObj->mOwnsData ) return;
 	
 	mObj->mData = realloc( mObj->mData, newSize );
 	mObj->mDataSize = newSize;
 	mObj->mAllocatedSize = newSize;
+	mObj->mTrackedMemory.set( newSize );
 }
 
 void Buffer::copyFrom( const void * aData, size_t length )
@@ -74,6 +108,17 @@ void Buffer::copyFrom( const void * aData, size_t length )
 	memcpy( mObj->mData, aData, length );
 }
 
+Buffer Buffer::slice( size_t offset, size_t length ) const
+{
+	offset = std::min( offset, mObj->mDataSize );
+	length = std::min( length, mObj->mDataSize - offset );
+
+	Buffer result;
+	result.mObj = std::shared_ptr<Obj>( new Obj( reinterpret_cast<uint8_t*>( mObj->mData ) + offset, length, false ) );
+	result.mObj->mDataOwner = mObj;
+	return result;
+}
+
 void Buffer::write( std::shared_ptr<class DataTarget> dataTarget )
 {
 	OStreamRef os = dataTarget->getStream();
@@ -82,10 +127,57 @@ void Buffer::write( std::shared_ptr<class DataTarget> dataTarget )
 
 std::shared_ptr<uint8_t>	Buffer::convertToSharedPtr()
 {
+	if( mObj->mIsInline ) { // the result is freed with free()
+		void *data = malloc( mObj->mAllocatedSize );
+		memcpy( data, mObj->mData, mObj->mDataSize );
+		mObj->mData = data;
+		mObj->mIsInline = false;
+	}
 	mObj->mOwnsData = false;
+	mObj->mTrackedMemory.set( 0 );
 	return std::shared_ptr<uint8_t>( reinterpret_cast<uint8_t*>( mObj->mData ), free );
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// BufferBuilder
+BufferBuilder::BufferBuilder( size_t initialCapacity )
+	: mSize( 0 )
+{
+	if( initialCapacity )
+		mBuffer = Buffer( initialCapacity );
+}
+
+void BufferBuilder::append( const void *data, size_t size )
+{
+	memcpy( prepare( size ), data, size );
+	mSize += size;
+}
+
+void* BufferBuilder::prepare( size_t size )
+{
+	if( mSize + size > getCapacity() )
+		reserve( std::max( mSize + size, getCapacity() * 2 ) );
+	return reinterpret_cast<uint8_t*>( mBuffer.getData() ) + mSize;
+}
+
+void BufferBuilder::reserve( size_t capacity )
+{
+	if( ! mBuffer )
+		mBuffer = Buffer( capacity );
+	else if( capacity > mBuffer.getAllocatedSize() )
+		mBuffer.resize( capacity );
+}
+
+Buffer BufferBuilder::release()
+{
+	Buffer result = mBuffer;
+	if( result )
+		result.setDataSize( mSize );
+	mBuffer.reset();
+	mSize = 0;
+	return result;
+}
+
 Buffer compressBuffer( const Buffer &aBuffer, int8_t compressionLevel, bool resizeResult )
 {
 	/*Initial output buffer size needs to be 0.1% larger than source buffer + 12 bytes*/
@@ -33,6 +33,12 @@
 	typedef cinder::CaptureImplDirectShow	CapturePlatformImpl;
 #endif
 
+#if defined( CINDER_COCOA )
+	#include <mach/mach_time.h>
+#elif defined( CINDER_MSW )
+	#include <windows.h>
+#endif
+
 #include <set>
 using namespace std;
 
@@ -47,6 +53,29 @@ const vector<Capture::DeviceRef>& Capture::getDevices( bool forceRefresh )
 #endif
 }
 
+double Capture::getHostTime()
+{
+#if defined( CINDER_COCOA )
+	static double sSecondsPerTick = 0;
+	if( sSecondsPerTick == 0 ) {
+		::mach_timebase_info_data_t timebase;
+		::mach_timebase_info( &timebase );
+		sSecondsPerTick = timebase.numer / ( timebase.denom * 1.0e9 );
+	}
+	return ::mach_absolute_time() * sSecondsPerTick;
+#elif defined( CINDER_MSW )
+	static double sSecondsPerTick = 0;
+	if( sSecondsPerTick == 0 ) {
+		::LARGE_INTEGER frequency;
+		::QueryPerformanceFrequency( &frequency );
+		sSecondsPerTick = 1.0 / frequency.QuadPart;
+	}
+	::LARGE_INTEGER counter;
+	::QueryPerformanceCounter( &counter );
+	return counter.QuadPart * sSecondsPerTick;
+#endif
+}
+
 Capture::DeviceRef Capture::findDeviceByName( const string &name )
 {
 	const vector<DeviceRef> &devices = getDevices();
@@ -69,14 +98,27 @@ Capture::DeviceRef Capture::findDeviceByNameContains( const string &nameFragment
 	return DeviceRef();
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Capture::Format
+Area Capture::Format::calcRegion( int32_t width, int32_t height ) const
+{
+	const Area bounds( 0, 0, width, height );
+	if( mRegionOfInterest.calcArea() <= 0 )
+		return bounds;
+
+	Area result = mRegionOfInterest.getClipBy( bounds );
+	return ( result.calcArea() > 0 ) ? result : bounds;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Capture::Obj
-Capture::Obj::Obj( int32_t width, int32_t height, const DeviceRef device )
+Capture::Obj::Obj( int32_t width, int32_t height, const DeviceRef device, const Format &format )
+	: mFormat( format )
 {
 #if defined( CINDER_COCOA )
-	mImpl = [[::CapturePlatformImpl alloc] initWithDevice:device width:width height:height];
+	mImpl = [[::CapturePlatformImpl alloc] initWithDevice:device width:width height:height format:format];
 #else
-	mImpl = new CapturePlatformImpl( width, height, device );
+	mImpl = new CapturePlatformImpl( width, height, device, format );
 #endif	
 }
 
@@ -89,9 +131,9 @@ Capture::Obj::~Obj()
 #endif
 }
 
-Capture::Capture( int32_t width, int32_t height, const DeviceRef device ) 
+Capture::Capture( int32_t width, int32_t height, const DeviceRef device, const Format &format )
 {
-	mObj = shared_ptr<Obj>( new Obj( width, height, device ) );
+	mObj = shared_ptr<Obj>( new Obj( width, height, device, format ) );
 }
 
 void Capture::start()
@@ -139,6 +181,53 @@ Surface8u Capture::getSurface() const
 #endif
 }
 
+gl::Texture Capture::getTexture() const
+{
+#if defined( CINDER_COCOA )
+	return [((::CapturePlatformImpl*)mObj->mImpl) getCurrentTexture];
+#else
+	// without a way to share the frame with OpenGL, upload it into the same texture each time
+	Surface8u surface = mObj->mImpl->getSurface();
+	if( ! surface ) {
+		return mObj->mTexture;
+	}
+	if( mObj->mTexture && ( mObj->mTexture.getWidth() == surface.getWidth() ) && ( mObj->mTexture.getHeight() == surface.getHeight() ) ) {
+		mObj->mTexture.update( surface );
+	}
+	else {
+		mObj->mTexture = gl::Texture( surface );
+	}
+	return mObj->mTexture;
+#endif
+}
+
+void Capture::setFrameFn( const FrameFn &frameFn )
+{
+#if defined( CINDER_COCOA )
+	[((::CapturePlatformImpl*)mObj->mImpl) setFrameFn:frameFn];
+#else
+	mObj->mImpl->setFrameFn( frameFn );
+#endif
+}
+
+void Capture::setLumaFrameFn( const LumaFrameFn &lumaFrameFn )
+{
+#if defined( CINDER_COCOA )
+	[((::CapturePlatformImpl*)mObj->mImpl) setLumaFrameFn:lumaFrameFn];
+#else
+	mObj->mImpl->setLumaFrameFn( lumaFrameFn );
+#endif
+}
+
+void Capture::setYuvFrameFn( const YuvFrameFn &yuvFrameFn )
+{
+#if defined( CINDER_COCOA )
+	[((::CapturePlatformImpl*)mObj->mImpl) setYuvFrameFn:yuvFrameFn];
+#else
+	mObj->mImpl->setYuvFrameFn( yuvFrameFn );
+#endif
+}
+
 int32_t	Capture::getWidth() const { 
 #if defined( CINDER_COCOA )
 	return [((::CapturePlatformImpl*)mObj->mImpl) getWidth];
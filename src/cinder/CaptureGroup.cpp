@@ -0,0 +1,181 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/CaptureGroup.h"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace cinder {
+
+// frames held waiting for a partner, per device; more would starve the capture hardware's buffer pool
+static const size_t MAX_PENDING_FRAMES = 3;
+
+CaptureGroup::CaptureGroup( const vector<Capture::DeviceRef> &devices, int32_t width, int32_t height, double tolerance, const Capture::Format &format )
+	: mPending( devices.size() ), mTolerance( tolerance ), mIsCapturing( false ), mQuit( false ), mNumFrameSets( 0 ), mNumDroppedFrames( 0 )
+{
+	for( size_t d = 0; d < devices.size(); ++d ) {
+		mCaptures.push_back( Capture( width, height, devices[d], format ) );
+		mCaptures.back().setFrameFn( std::bind( &CaptureGroup::frameArrived, this, d, std::_1, std::_2 ) );
+	}
+}
+
+CaptureGroup::~CaptureGroup()
+{
+	stop();
+	// the Captures may outlive the group if the app holds onto them
+	for( vector<Capture>::iterator captureIt = mCaptures.begin(); captureIt != mCaptures.end(); ++captureIt )
+		captureIt->setFrameFn( Capture::FrameFn() );
+}
+
+void CaptureGroup::start()
+{
+	if( mIsCapturing )
+		return;
+
+	mQuit = false;
+	mNumFrameSets = mNumDroppedFrames = 0;
+	mThread = std::shared_ptr<std::thread>( new std::thread( std::bind( &CaptureGroup::threadFn, this ) ) );
+	for( vector<Capture>::iterator captureIt = mCaptures.begin(); captureIt != mCaptures.end(); ++captureIt )
+		captureIt->start();
+	mIsCapturing = true;
+}
+
+void CaptureGroup::stop()
+{
+	if( ! mIsCapturing )
+		return;
+
+	for( vector<Capture>::iterator captureIt = mCaptures.begin(); captureIt != mCaptures.end(); ++captureIt )
+		captureIt->stop();
+
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mQuit = true;
+	}
+	mFrameArrived.notify_all();
+	mThread->join();
+	mThread.reset();
+
+	std::lock_guard<std::mutex> lock( mMutex );
+	for( size_t d = 0; d < mPending.size(); ++d )
+		mPending[d].clear();
+	mIsCapturing = false;
+}
+
+void CaptureGroup::setFrameSetFn( const FrameSetFn &frameSetFn )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mFrameSetFn = frameSetFn;
+}
+
+double CaptureGroup::getTolerance() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mTolerance;
+}
+
+void CaptureGroup::setTolerance( double tolerance )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mTolerance = tolerance;
+}
+
+// Called on each device's capture thread
+void CaptureGroup::frameArrived( size_t index, const Surface8u &surface, double time )
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		deque<TimedFrame> &pending = mPending[index];
+		if( pending.size() >= MAX_PENDING_FRAMES ) {
+			pending.pop_front();
+			++mNumDroppedFrames;
+		}
+		pending.push_back( TimedFrame( surface, time ) );
+	}
+	mFrameArrived.notify_one();
+}
+
+/* Matches against the latest of the devices' oldest frames: anything more than the tolerance older than it can't be matched any more and is dropped.
+	Once every device's oldest frame survives, they all lie within the tolerance of each other and form a set. Called with mMutex locked. */
+bool CaptureGroup::matchFrames( FrameSet *result )
+{
+	while( true ) {
+		double latest = 0;
+		for( size_t d = 0; d < mPending.size(); ++d ) {
+			if( mPending[d].empty() )
+				return false;
+			latest = std::max( latest, mPending[d].front().mTime );
+		}
+
+		bool dropped = false;
+		for( size_t d = 0; d < mPending.size(); ++d ) {
+			if( mPending[d].front().mTime < latest - mTolerance ) {
+				mPending[d].pop_front();
+				++mNumDroppedFrames;
+				dropped = true;
+			}
+		}
+		if( dropped )
+			continue;
+
+		result->mSurfaces.resize( mPending.size() );
+		result->mTimes.resize( mPending.size() );
+		result->mTime = latest;
+		for( size_t d = 0; d < mPending.size(); ++d ) {
+			result->mSurfaces[d] = mPending[d].front().mSurface;
+			result->mTimes[d] = mPending[d].front().mTime;
+			mPending[d].pop_front();
+		}
+		return true;
+	}
+}
+
+void CaptureGroup::threadFn()
+{
+	ThreadSetup threadSetup;
+
+	FrameSet frameSet;
+	while( true ) {
+		FrameSetFn frameSetFn;
+		{
+			std::unique_lock<std::mutex> lock( mMutex );
+			while( ( ! mQuit ) && ( ! matchFrames( &frameSet ) ) )
+				mFrameArrived.wait( lock );
+			if( mQuit )
+				return;
+			frameSetFn = mFrameSetFn;
+		}
+
+		++mNumFrameSets;
+		if( frameSetFn )
+			frameSetFn( frameSet );
+		// release the frames before waiting, so their buffers go back to the devices
+		frameSet.mSurfaces.clear();
+	}
+}
+
+} // namespace cinder
@@ -23,6 +23,8 @@
 #import "cinder/CaptureImplAvFoundation.h"
 #include "cinder/cocoa/CinderCocoa.h"
 #include <dlfcn.h>
+#import <OpenGLES/EAGL.h>
+#include <CoreVideo/CVOpenGLESTextureCache.h>
 
 namespace cinder {
 
@@ -58,6 +60,80 @@ void frameDeallocator( void *refcon )
 	CVBufferRelease( pixelBuffer );
 }
 
+// returns the region of interest of \a pixelBuffer, moved onto even coordinates so that it begins on a whole chroma sample
+static cinder::Area calcFrameRegion( const cinder::Capture::Format &format, CVPixelBufferRef pixelBuffer )
+{
+	cinder::Area region = format.calcRegion( CVPixelBufferGetWidth( pixelBuffer ), CVPixelBufferGetHeight( pixelBuffer ) );
+	region.x1 &= ~1;
+	region.y1 &= ~1;
+	return region;
+}
+
+// wraps \a region of a BGRA \a pixelBuffer without copying it; the Surface keeps it retained, which holds it out of the capture's buffer pool until the Surface is destroyed
+static cinder::Surface8u wrapPixelBuffer( CVPixelBufferRef pixelBuffer, const cinder::Area &region )
+{
+	CVBufferRetain( pixelBuffer );
+	CVPixelBufferLockBaseAddress( pixelBuffer, 0 );
+	const size_t rowBytes = CVPixelBufferGetBytesPerRow( pixelBuffer );
+	cinder::Surface8u result( (uint8_t *)CVPixelBufferGetBaseAddress( pixelBuffer ) + region.y1 * rowBytes + region.x1 * 4, region.getWidth(), region.getHeight(),
+								rowBytes, cinder::SurfaceChannelOrder::BGRA );
+	result.setDeallocator( frameDeallocator, pixelBuffer );
+	return result;
+}
+
+// wraps \a region of the luminance plane of a bi-planar YpCbCr \a pixelBuffer without copying it
+static cinder::Channel8u wrapLumaPlane( CVPixelBufferRef pixelBuffer, const cinder::Area &region )
+{
+	CVBufferRetain( pixelBuffer );
+	CVPixelBufferLockBaseAddress( pixelBuffer, 0 );
+	const size_t rowBytes = CVPixelBufferGetBytesPerRowOfPlane( pixelBuffer, 0 );
+	cinder::Channel8u result( region.getWidth(), region.getHeight(), rowBytes,
+								1, (uint8_t *)CVPixelBufferGetBaseAddressOfPlane( pixelBuffer, 0 ) + region.y1 * rowBytes + region.x1 );
+	result.setDeallocator( frameDeallocator, pixelBuffer );
+	return result;
+}
+
+// wraps \a region of both planes of a bi-planar YpCbCr \a pixelBuffer as an NV12 YuvSurface without copying them
+static cinder::YuvSurface wrapYuvPlanes( CVPixelBufferRef pixelBuffer, const cinder::Area &region )
+{
+	CVBufferRetain( pixelBuffer );
+	CVPixelBufferLockBaseAddress( pixelBuffer, 0 );
+	const size_t lumaRowBytes = CVPixelBufferGetBytesPerRowOfPlane( pixelBuffer, 0 ), chromaRowBytes = CVPixelBufferGetBytesPerRowOfPlane( pixelBuffer, 1 );
+	// the chroma plane interleaves Cb and Cr at half resolution, so a pixel's column in it is x / 2 * 2 bytes
+	cinder::YuvSurface result( region.getWidth(), region.getHeight(),
+								(uint8_t *)CVPixelBufferGetBaseAddressOfPlane( pixelBuffer, 0 ) + region.y1 * lumaRowBytes + region.x1, lumaRowBytes,
+								(uint8_t *)CVPixelBufferGetBaseAddressOfPlane( pixelBuffer, 1 ) + region.y1 / 2 * chromaRowBytes + region.x1, chromaRowBytes );
+	result.setColorSpace( cinder::YuvSurface::BT601, true );
+	result.setDeallocator( frameDeallocator, pixelBuffer );
+	return result;
+}
+
+static void textureDeallocator( void *refcon )
+{
+	CFRelease( reinterpret_cast<CVOpenGLESTextureRef>( refcon ) );
+}
+
+
+// returns the smallest session preset whose frames cover \a width by \a height, or the largest one \a session supports, so the camera scales rather than the CPU
+static NSString* findSessionPreset( AVCaptureSession *session, int32_t width, int32_t height )
+{
+	// the 352x288 and 1920x1080 presets are weak-linked from iOS 5
+	NSString *presets[] = { &AVCaptureSessionPreset352x288 ? AVCaptureSessionPreset352x288 : nil, AVCaptureSessionPreset640x480, AVCaptureSessionPreset1280x720,
+							&AVCaptureSessionPreset1920x1080 ? AVCaptureSessionPreset1920x1080 : nil };
+	const int32_t presetSizes[][2] = { { 352, 288 }, { 640, 480 }, { 1280, 720 }, { 1920, 1080 } };
+	// camera frames are landscape whichever way the device is held
+	const int32_t longSide = std::max( width, height ), shortSide = std::min( width, height );
+
+	NSString *result = AVCaptureSessionPresetMedium;
+	for( size_t p = 0; p < sizeof(presetSizes) / sizeof(presetSizes[0]); ++p ) {
+		if( ( ! presets[p] ) || ( ! [session canSetSessionPreset:presets[p]] ) )
+			continue;
+		result = presets[p];
+		if( ( presetSizes[p][0] >= longSide ) && ( presetSizes[p][1] >= shortSide ) )
+			break;
+	}
+	return result;
+}
 
 static std::vector<cinder::Capture::DeviceRef> sDevices;
 static BOOL sDevicesEnumerated = false;
@@ -84,11 +160,12 @@ static BOOL sDevicesEnumerated = false;
 	return sDevices;
 }
 
-- (id)initWithDevice:(const cinder::Capture::DeviceRef)device width:(int)width height:(int)height
+- (id)initWithDevice:(const cinder::Capture::DeviceRef)device width:(int)width height:(int)height format:(const cinder::Capture::Format&)format
 {
 	if( ( self = [super init] ) ) {
 
 		mDevice = device;
+		mFormat = format;
 		if( mDevice ) {
 			mDeviceUniqueId = [NSString stringWithUTF8String:device->getUniqueId().c_str()];
 			[mDeviceUniqueId retain];
@@ -101,6 +178,11 @@ static BOOL sDevicesEnumerated = false;
 		mExposedFrameBytesPerRow = 0;
 		mExposedFrameWidth = 0;
 		mExposedFrameHeight = 0;
+		mLatestPixelBuffer = 0;
+		mFrameCount = 0;
+		mTextureFrameCount = 0;
+		mTextureCache = 0;
+		mYpCbCr = false;
 	}
 	return self;
 }
@@ -113,6 +195,11 @@ static BOOL sDevicesEnumerated = false;
 	
 	[mDeviceUniqueId release];
 	
+	mCurrentTexture.reset();
+	if( mTextureCache ) {
+		CFRelease( mTextureCache );
+	}
+	
 	[super dealloc];
 }
 
@@ -138,11 +225,6 @@ static BOOL sDevicesEnumerated = false;
 
     mSession = [[clsAVCaptureSession alloc] init];
 
-    // Configure the session to produce lower resolution video frames, if your 
-    // processing algorithm can cope. We'll specify medium quality for the
-    // chosen device.
-	mSession.sessionPreset = AVCaptureSessionPresetMedium;
-
     // Find a suitable AVCaptureDevice
     AVCaptureDevice * device = nil;
 	if( ! mDeviceUniqueId ) {
@@ -162,6 +244,9 @@ static BOOL sDevicesEnumerated = false;
     }
     [mSession addInput:input];
 
+	// presets depend on the input, so this follows adding it
+	mSession.sessionPreset = findSessionPreset( mSession, mWidth, mHeight );
+
     // Create a VideoDataOutput and add it to the session
     AVCaptureVideoDataOutput * output = [[[clsAVCaptureVideoDataOutput alloc] init] autorelease];
     [mSession addOutput:output];
@@ -183,13 +268,21 @@ static BOOL sDevicesEnumerated = false;
     [output setSampleBufferDelegate:self queue:queue];
     dispatch_release(queue);
 
-    // Specify the pixel format
-    output.videoSettings = [NSDictionary dictionaryWithObject:[NSNumber numberWithInt:kCVPixelFormatType_32BGRA] forKey:(id)kCVPixelBufferPixelFormatTypeKey];
+    // Specify the pixel format; luma and YUV frame functions take the camera's native YpCbCr so that nothing needs converting
+	mYpCbCr = ( mLumaFrameFn || mYuvFrameFn ) ? true : false;
+	int pixelFormat = mYpCbCr ? kCVPixelFormatType_420YpCbCr8BiPlanarFullRange : kCVPixelFormatType_32BGRA;
+    output.videoSettings = [NSDictionary dictionaryWithObject:[NSNumber numberWithInt:pixelFormat] forKey:(id)kCVPixelBufferPixelFormatTypeKey];
 
 
-    // If you wish to cap the frame rate to a known value, such as 15 fps, set 
-    // minFrameDuration.
-    // output.minFrameDuration = CMTimeMake(1, 15);
+	// iOS 5 asks the camera itself for the frame rate through the connection; before that the output drops the extra frames
+	if( mFormat.getFrameRate() > 0 ) {
+		CMTime frameDuration = CMTimeMakeWithSeconds( 1.0 / mFormat.getFrameRate(), 1000000 );
+		AVCaptureConnection *connection = [output connectionWithMediaType:AVMediaTypeVideo];
+		if( [connection respondsToSelector:@selector(setVideoMinFrameDuration:)] && connection.supportsVideoMinFrameDuration )
+			connection.videoMinFrameDuration = frameDuration;
+		else
+			output.minFrameDuration = frameDuration;
+	}
 	return true;
 }
 
@@ -223,11 +316,16 @@ static BOOL sDevicesEnumerated = false;
 		mHasNewFrame = false;
 		
 		mCurrentFrame.reset();
+		mCurrentTexture.reset();
 		
 		if( mWorkingPixelBuffer ) {
 			CVBufferRelease( mWorkingPixelBuffer );
 			mWorkingPixelBuffer = 0;
-		}		
+		}
+		if( mLatestPixelBuffer ) {
+			CVBufferRelease( mLatestPixelBuffer );
+			mLatestPixelBuffer = 0;
+		}
 	}
 }
 
@@ -239,8 +337,18 @@ static BOOL sDevicesEnumerated = false;
 // Delegate routine that is called when a sample buffer was written
 - (void)captureOutput:(AVCaptureOutput *)captureOutput didOutputSampleBuffer:(CMSampleBufferRef)sampleBuffer fromConnection:(AVCaptureConnection *)connection
 { 
+	cinder::Capture::FrameFn frameFn;
+	cinder::Capture::LumaFrameFn lumaFrameFn;
+	cinder::Capture::YuvFrameFn yuvFrameFn;
     @synchronized( self ) {
 		if( mIsCapturing ) {
+			if( mYpCbCr ) {
+				lumaFrameFn = mLumaFrameFn;
+				yuvFrameFn = mYuvFrameFn;
+			}
+			else
+				frameFn = mFrameFn;
+
 			// if the last pixel buffer went unclaimed, we'll need to release it
 			if( mWorkingPixelBuffer ) {
 				CVBufferRelease( mWorkingPixelBuffer );
@@ -254,24 +362,42 @@ static BOOL sDevicesEnumerated = false;
 			CVBufferRetain( videoFrame );
 		
 			mWorkingPixelBuffer = (CVPixelBufferRef)videoFrame;
-			mHasNewFrame = true;			
+			mHasNewFrame = true;
+			
+			if( mLatestPixelBuffer ) {
+				CVBufferRelease( mLatestPixelBuffer );
+			}
+			mLatestPixelBuffer = (CVPixelBufferRef)CVBufferRetain( videoFrame );
+			++mFrameCount;
 		}
-	}	
+	}
+	
+	// called outside of the lock so that a slow consumer doesn't hold up getCurrentFrame()
+	// capture sessions stamp their samples against the host time clock, which Capture::getHostTime() also reads
+	const double hostTime = CMTimeGetSeconds( CMSampleBufferGetPresentationTimeStamp( sampleBuffer ) );
+	const cinder::Area region = calcFrameRegion( mFormat, CMSampleBufferGetImageBuffer( sampleBuffer ) );
+	if( frameFn )
+		frameFn( wrapPixelBuffer( CMSampleBufferGetImageBuffer( sampleBuffer ), region ), hostTime );
+	if( lumaFrameFn )
+		lumaFrameFn( wrapLumaPlane( CMSampleBufferGetImageBuffer( sampleBuffer ), region ), hostTime );
+	if( yuvFrameFn )
+		yuvFrameFn( wrapYuvPlanes( CMSampleBufferGetImageBuffer( sampleBuffer ), region ), hostTime );
 }
 
 - (cinder::Surface8u)getCurrentFrame
 {
-	if( ( ! mIsCapturing ) || ( ! mWorkingPixelBuffer ) ) {
+	if( ( ! mIsCapturing ) || ( ! mWorkingPixelBuffer ) || mYpCbCr ) {
 		return mCurrentFrame;
 	}
 	
 	@synchronized (self) {
 		CVPixelBufferLockBaseAddress( mWorkingPixelBuffer, 0 );
 		
-		uint8_t *data = (uint8_t *)CVPixelBufferGetBaseAddress( mWorkingPixelBuffer );
+		const cinder::Area region = calcFrameRegion( mFormat, mWorkingPixelBuffer );
 		mExposedFrameBytesPerRow = CVPixelBufferGetBytesPerRow( mWorkingPixelBuffer );
-		mExposedFrameWidth = CVPixelBufferGetWidth( mWorkingPixelBuffer );
-		mExposedFrameHeight = CVPixelBufferGetHeight( mWorkingPixelBuffer );
+		mExposedFrameWidth = region.getWidth();
+		mExposedFrameHeight = region.getHeight();
+		uint8_t *data = (uint8_t *)CVPixelBufferGetBaseAddress( mWorkingPixelBuffer ) + region.y1 * mExposedFrameBytesPerRow + region.x1 * 4;
 
 		mCurrentFrame = cinder::Surface8u( data, mExposedFrameWidth, mExposedFrameHeight, mExposedFrameBytesPerRow, cinder::SurfaceChannelOrder::BGRA );
 		mCurrentFrame.setDeallocator( frameDeallocator, mWorkingPixelBuffer );
@@ -283,6 +409,55 @@ static BOOL sDevicesEnumerated = false;
 	return mCurrentFrame;
 }
 
+- (cinder::gl::Texture)getCurrentTexture
+{
+	@synchronized( self ) {
+		if( ( ! mIsCapturing ) || ( ! mLatestPixelBuffer ) || ( mTextureFrameCount == mFrameCount ) || mYpCbCr ) {
+			return mCurrentTexture;
+		}
+		mTextureFrameCount = mFrameCount;
+		
+		int32_t width = CVPixelBufferGetWidth( mLatestPixelBuffer );
+		int32_t height = CVPixelBufferGetHeight( mLatestPixelBuffer );
+		
+		// CVOpenGLESTextureCache is weak-linked, as it's only available from iOS 5, so older systems upload the frame instead
+		if( ( &CVOpenGLESTextureCacheCreate == NULL ) || ( ! [EAGLContext currentContext] ) ) {
+			mCurrentTexture = cinder::gl::Texture( [self getCurrentFrame] );
+			return mCurrentTexture;
+		}
+		
+		if( ! mTextureCache ) {
+			if( CVOpenGLESTextureCacheCreate( kCFAllocatorDefault, NULL, [EAGLContext currentContext], NULL, &mTextureCache ) != kCVReturnSuccess ) {
+				mTextureCache = 0;
+				return mCurrentTexture;
+			}
+		}
+		
+		// the texture refers to the pixel buffer's own storage, so nothing is copied
+		CVOpenGLESTextureRef textureRef = 0;
+		if( CVOpenGLESTextureCacheCreateTextureFromImage( kCFAllocatorDefault, mTextureCache, mLatestPixelBuffer, NULL, GL_TEXTURE_2D, GL_RGBA,
+				width, height, GL_BGRA_EXT, GL_UNSIGNED_BYTE, 0, &textureRef ) == kCVReturnSuccess ) {
+			GLenum target = CVOpenGLESTextureGetTarget( textureRef );
+			GLuint name = CVOpenGLESTextureGetName( textureRef );
+			// camera frames are rarely a power of two in size, which OpenGL ES only samples with clamping and without mipmaps
+			glBindTexture( target, name );
+			glTexParameteri( target, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+			glTexParameteri( target, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+			glTexParameteri( target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+			glTexParameteri( target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+			glBindTexture( target, 0 );
+			
+			mCurrentTexture = cinder::gl::Texture( target, name, width, height, true );
+			mCurrentTexture.setFlipped( ! CVOpenGLESTextureIsFlipped( textureRef ) );
+			mCurrentTexture.setDeallocator( textureDeallocator, textureRef );
+		}
+		// lets the cache recycle the textures of frames which are no longer referenced
+		CVOpenGLESTextureCacheFlush( mTextureCache, 0 );
+	}
+	
+	return mCurrentTexture;
+}
+
 - (bool)checkNewFrame
 {
 	bool result;
@@ -293,18 +468,39 @@ static BOOL sDevicesEnumerated = false;
 	return result;
 }
 
+- (void)setFrameFn:(const cinder::Capture::FrameFn&)frameFn
+{
+	@synchronized( self ) {
+		mFrameFn = frameFn;
+	}
+}
+
+- (void)setLumaFrameFn:(const cinder::Capture::LumaFrameFn&)lumaFrameFn
+{
+	@synchronized( self ) {
+		mLumaFrameFn = lumaFrameFn;
+	}
+}
+
+- (void)setYuvFrameFn:(const cinder::Capture::YuvFrameFn&)yuvFrameFn
+{
+	@synchronized( self ) {
+		mYuvFrameFn = yuvFrameFn;
+	}
+}
+
 - (const cinder::Capture::DeviceRef)getDevice {
 	return mDevice;
 }
 
 - (int32_t)getWidth
 {
-	return mWidth;
+	return mFormat.calcRegion( mWidth, mHeight ).getWidth();
 }
 
 - (int32_t)getHeight
 {
-	return mHeight;
+	return mFormat.calcRegion( mWidth, mHeight ).getHeight();
 }
 
 - (int32_t)getCurrentFrameBytesPerRow
@@ -69,6 +69,7 @@ std::shared_ptr<CaptureMgr> CaptureMgr::instance()
 	return sInstance;
 }
 
+// Recycles a fixed set of pixel buffers; the deallocator returns a buffer to the cache, possibly from another thread
 class SurfaceCache {
  public:
 	SurfaceCache( int32_t width, int32_t height, SurfaceChannelOrder sco, int numSurfaces )
@@ -83,6 +84,7 @@ class SurfaceCache {
 	
 	Surface8u getNewSurface()
 	{
+		std::lock_guard<std::mutex> lock( mMutex );
 		// try to find an available block of pixel data to wrap a surface around	
 		for( size_t i = 0; i < mSurfaceData.size(); ++i ) {
 			if( ! mSurfaceUsed[i] ) {
@@ -100,6 +102,7 @@ class SurfaceCache {
 	static void surfaceDeallocator( void *refcon )
 	{
 		pair<SurfaceCache*,int> *info = reinterpret_cast<pair<SurfaceCache*,int>*>( refcon );
+		std::lock_guard<std::mutex> lock( info->first->mMutex );
 		info->first->mSurfaceUsed[info->second] = false;
 	}
 
@@ -109,6 +112,50 @@ class SurfaceCache {
 	vector<pair<SurfaceCache*,int> >	mDeallocatorRefcon;
 	int32_t				mWidth, mHeight;
 	SurfaceChannelOrder	mSCO;
+	std::mutex			mMutex;
+};
+
+// The Channel8u counterpart of SurfaceCache, used for luma frames
+class ChannelCache {
+ public:
+	ChannelCache( int32_t width, int32_t height, int numChannels )
+		: mWidth( width ), mHeight( height )
+	{
+		for( int i = 0; i < numChannels; ++i ) {
+			mChannelData.push_back( std::shared_ptr<uint8_t>( new uint8_t[width*height], checked_array_deleter<uint8_t>() ) );
+			mDeallocatorRefcon.push_back( make_pair( this, i ) );
+			mChannelUsed.push_back( false );
+		}
+	}
+	
+	Channel8u getNewChannel()
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		for( size_t i = 0; i < mChannelData.size(); ++i ) {
+			if( ! mChannelUsed[i] ) {
+				mChannelUsed[i] = true;
+				Channel8u result( mWidth, mHeight, mWidth, 1, mChannelData[i].get() );
+				result.setDeallocator( channelDeallocator, &mDeallocatorRefcon[i] );
+				return result;
+			}
+		}
+
+		return Channel8u( mWidth, mHeight );
+	}
+	
+	static void channelDeallocator( void *refcon )
+	{
+		pair<ChannelCache*,int> *info = reinterpret_cast<pair<ChannelCache*,int>*>( refcon );
+		std::lock_guard<std::mutex> lock( info->first->mMutex );
+		info->first->mChannelUsed[info->second] = false;
+	}
+
+ private:
+	vector<std::shared_ptr<uint8_t> >	mChannelData;
+	vector<bool>					mChannelUsed;
+	vector<pair<ChannelCache*,int> >	mDeallocatorRefcon;
+	int32_t				mWidth, mHeight;
+	std::mutex			mMutex;
 };
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -140,45 +187,70 @@ const vector<Capture::DeviceRef>& CaptureImplDirectShow::getDevices( bool forceR
 	return sDevices;
 }
 
-CaptureImplDirectShow::CaptureImplDirectShow( int32_t width, int32_t height, const Capture::DeviceRef device )
-	: mWidth( width ), mHeight( height ), mCurrentFrame( width, height, false, SurfaceChannelOrder::BGR ), mDeviceID( 0 )
+CaptureImplDirectShow::CaptureImplDirectShow( int32_t width, int32_t height, const Capture::DeviceRef device, const Capture::Format &format )
+	: mWidth( width ), mHeight( height ), mFormat( format ), mDeviceID( 0 )
 {
 	mDevice = device;
 	if( mDevice ) {
 		mDeviceID = device->getUniqueId();
 	}
-	if( ! CaptureMgr::instanceVI()->setupDevice( mDeviceID, mWidth, mHeight ) )
-		throw CaptureExcInitFail();
-	mWidth = CaptureMgr::instanceVI()->getWidth( mDeviceID );
-	mHeight = CaptureMgr::instanceVI()->getHeight( mDeviceID );
+	setupDevice();
 	mIsCapturing = true;
-	mSurfaceCache = std::shared_ptr<SurfaceCache>( new SurfaceCache( mWidth, mHeight, SurfaceChannelOrder::BGR, 4 ) );
+	mCurrentFrame = Surface8u( getWidth(), getHeight(), false, SurfaceChannelOrder::BGR );
+	mSurfaceCache = std::shared_ptr<SurfaceCache>( new SurfaceCache( getWidth(), getHeight(), SurfaceChannelOrder::BGR, 4 ) );
 
 	mMgrPtr = CaptureMgr::instance();
 }
 
 CaptureImplDirectShow::~CaptureImplDirectShow()
 {
+	CaptureMgr::instanceVI()->setFrameCallback( mDeviceID, NULL, NULL );
 	CaptureMgr::instanceVI()->stopDevice( mDeviceID );
 }
 
+// Negotiates the size, frame rate and format with the device, which videoInput forgets whenever the device is stopped
+void CaptureImplDirectShow::setupDevice()
+{
+	videoInput *vi = CaptureMgr::instanceVI();
+	if( mFormat.getFrameRate() > 0 )
+		vi->setIdealFramerate( mDeviceID, (int)( mFormat.getFrameRate() + 0.5f ) );
+	switch( mFormat.getPixelFormat() ) {
+		case Capture::PIXEL_FORMAT_RGB: vi->setRequestedMediaSubtype( mDeviceID, MEDIASUBTYPE_RGB24 ); break;
+		case Capture::PIXEL_FORMAT_YUV422: vi->setRequestedMediaSubtype( mDeviceID, MEDIASUBTYPE_YUY2 ); break;
+		case Capture::PIXEL_FORMAT_YUV420: vi->setRequestedMediaSubtype( mDeviceID, MEDIASUBTYPE_IYUV ); break;
+		case Capture::PIXEL_FORMAT_MJPEG: vi->setRequestedMediaSubtype( mDeviceID, MEDIASUBTYPE_MJPG ); break;
+		default: break;
+	}
+
+	if( ! vi->setupDevice( mDeviceID, mWidth, mHeight ) )
+		throw CaptureExcInitFail();
+	if( ! vi->isDeviceSetup( mDeviceID ) )
+		throw CaptureExcInitFail();
+	mWidth = vi->getWidth( mDeviceID );
+	mHeight = vi->getHeight( mDeviceID );
+	mRegion = mFormat.calcRegion( mWidth, mHeight );
+}
+
 void CaptureImplDirectShow::start()
 {
 	if( mIsCapturing ) return;
 	
-	if( ! CaptureMgr::instanceVI()->setupDevice( mDeviceID, mWidth, mHeight ) )
-		throw CaptureExcInitFail();
-	if( ! CaptureMgr::instanceVI()->isDeviceSetup( mDeviceID ) )
-		throw CaptureExcInitFail();
-	mWidth = CaptureMgr::instanceVI()->getWidth( mDeviceID );
-	mHeight = CaptureMgr::instanceVI()->getHeight( mDeviceID );
+	const Vec2i regionSize = mRegion.getSize();
+	setupDevice();
+	// the device may have settled on a different size this time
+	if( mRegion.getSize() != regionSize ) {
+		mSurfaceCache = std::shared_ptr<SurfaceCache>( new SurfaceCache( getWidth(), getHeight(), SurfaceChannelOrder::BGR, 4 ) );
+		mCallbackSurfaceCache.reset();
+	}
 	mIsCapturing = true;
+	updateFrameCallback();
 }
 
 void CaptureImplDirectShow::stop()
 {
 	if( ! mIsCapturing ) return;
 
+	CaptureMgr::instanceVI()->setFrameCallback( mDeviceID, NULL, NULL );
 	CaptureMgr::instanceVI()->stopDevice( mDeviceID );
 	mIsCapturing = false;
 }
@@ -197,10 +269,113 @@ Surface8u CaptureImplDirectShow::getSurface() const
 {
 	if( CaptureMgr::instanceVI()->isFrameNew( mDeviceID ) ) {
 		mCurrentFrame = mSurfaceCache->getNewSurface();
-		CaptureMgr::instanceVI()->getPixels( mDeviceID, mCurrentFrame.getData(), false, true );
+		// only the region of interest is copied out of the device's buffer
+		CaptureMgr::instanceVI()->getPixels( mDeviceID, mCurrentFrame.getData(), mRegion.x1, mRegion.y1, mRegion.getWidth(), mRegion.getHeight() );
 	}
 	
 	return mCurrentFrame;
 }
 
+void CaptureImplDirectShow::setFrameFn( const Capture::FrameFn &frameFn )
+{
+	{
+		std::lock_guard<std::mutex> lock( mFrameFnMutex );
+		mFrameFn = frameFn;
+	}
+	updateFrameCallback();
+}
+
+void CaptureImplDirectShow::setLumaFrameFn( const Capture::LumaFrameFn &lumaFrameFn )
+{
+	{
+		std::lock_guard<std::mutex> lock( mFrameFnMutex );
+		mLumaFrameFn = lumaFrameFn;
+	}
+	updateFrameCallback();
+}
+
+void CaptureImplDirectShow::setYuvFrameFn( const Capture::YuvFrameFn &yuvFrameFn )
+{
+	{
+		std::lock_guard<std::mutex> lock( mFrameFnMutex );
+		mYuvFrameFn = yuvFrameFn;
+	}
+	updateFrameCallback();
+}
+
+// (re)installs the grabber callback, which is only worth paying for while someone is listening
+void CaptureImplDirectShow::updateFrameCallback()
+{
+	if( ! mIsCapturing )
+		return;
+
+	bool listening;
+	{
+		std::lock_guard<std::mutex> lock( mFrameFnMutex );
+		listening = mFrameFn || mLumaFrameFn || mYuvFrameFn;
+		if( listening && ( ! mCallbackSurfaceCache ) ) {
+			mCallbackSurfaceCache = std::shared_ptr<SurfaceCache>( new SurfaceCache( getWidth(), getHeight(), SurfaceChannelOrder::BGR, 4 ) );
+			mCallbackChannelCache = std::shared_ptr<ChannelCache>( new ChannelCache( getWidth(), getHeight(), 4 ) );
+			// enough for a handful of frames in flight
+			mCallbackYuvPool = SurfacePool::create( getWidth() * getHeight() * 3 / 2 * 4 );
+		}
+	}
+	
+	if( listening )
+		CaptureMgr::instanceVI()->setFrameCallback( mDeviceID, frameCallback, this );
+	else
+		CaptureMgr::instanceVI()->setFrameCallback( mDeviceID, NULL, NULL );
+}
+
+// Called on videoInput's grabber thread with the sample's bottom-up BGR rows. Only the region of interest is read.
+void CaptureImplDirectShow::frameCallback( unsigned char *pixels, int numBytes, void *refcon )
+{
+	// DirectShow's sample times are relative to the graph's start, so the frame is stamped on arrival instead
+	const double hostTime = Capture::getHostTime();
+	CaptureImplDirectShow *capture = reinterpret_cast<CaptureImplDirectShow*>( refcon );
+	const int32_t srcRowBytes = capture->mWidth * 3;
+	if( numBytes < srcRowBytes * capture->mHeight )
+		return;
+	// point at the region's first pixel of the bottom-up rows, so that row y of the region is at -y rows from there
+	const Area &region = capture->mRegion;
+	pixels += ( capture->mHeight - 1 - region.y1 ) * srcRowBytes + region.x1 * 3;
+	const int32_t width = region.getWidth(), height = region.getHeight();
+
+	Capture::FrameFn frameFn;
+	Capture::LumaFrameFn lumaFrameFn;
+	Capture::YuvFrameFn yuvFrameFn;
+	{
+		std::lock_guard<std::mutex> lock( capture->mFrameFnMutex );
+		frameFn = capture->mFrameFn;
+		lumaFrameFn = capture->mLumaFrameFn;
+		yuvFrameFn = capture->mYuvFrameFn;
+	}
+
+	if( frameFn ) {
+		Surface8u frame = capture->mCallbackSurfaceCache->getNewSurface();
+		for( int32_t y = 0; y < height; ++y )
+			memcpy( frame.getData( Vec2i( 0, y ) ), pixels - y * srcRowBytes, width * 3 );
+		frameFn( frame, hostTime );
+	}
+	
+	if( lumaFrameFn ) {
+		Channel8u luma = capture->mCallbackChannelCache->getNewChannel();
+		for( int32_t y = 0; y < height; ++y ) {
+			const uint8_t *src = pixels - y * srcRowBytes;
+			uint8_t *dst = luma.getData( Vec2i( 0, y ) );
+			for( int32_t x = 0; x < width; ++x, src += 3 )
+				dst[x] = ( 29 * src[0] + 150 * src[1] + 77 * src[2] ) >> 8;
+		}
+		lumaFrameFn( luma, hostTime );
+	}
+	
+	if( yuvFrameFn ) {
+		// a negative row stride reads the bottom-up rows top-down without copying them
+		const Surface8u bgr( pixels, width, height, -srcRowBytes, SurfaceChannelOrder::BGR );
+		YuvSurface yuv( width, height, YuvSurface::NV12, capture->mCallbackYuvPool );
+		yuv.copyFrom( bgr );
+		yuvFrameFn( yuv, hostTime );
+	}
+}
+
 } //namespace
\ No newline at end of file
@@ -23,6 +23,9 @@
 #import "cinder/CaptureImplQtKit.h"
 #include "cinder/cocoa/CinderCocoa.h"
 
+#include <algorithm>
+#include <mach/mach_time.h>
+
 namespace cinder {
 
 CaptureImplQtKitDevice::CaptureImplQtKitDevice( QTCaptureDevice* device )
@@ -59,6 +62,58 @@ bool CaptureImplQtKitDevice::isConnected() const
 
 static void frameDeallocator( void *refcon );
 
+// returns the region of interest of \a pixelBuffer, moved onto even coordinates so that it begins on a whole chroma sample
+static cinder::Area calcFrameRegion( const cinder::Capture::Format &format, CVPixelBufferRef pixelBuffer )
+{
+	cinder::Area region = format.calcRegion( CVPixelBufferGetWidth( pixelBuffer ), CVPixelBufferGetHeight( pixelBuffer ) );
+	region.x1 &= ~1;
+	region.y1 &= ~1;
+	return region;
+}
+
+// wraps \a region of an RGB \a pixelBuffer without copying it; the Surface keeps it retained, which holds it out of the capture's buffer pool until the Surface is destroyed
+static cinder::Surface8u wrapPixelBuffer( CVPixelBufferRef pixelBuffer, const cinder::Area &region )
+{
+	CVBufferRetain( pixelBuffer );
+	CVPixelBufferLockBaseAddress( pixelBuffer, 0 );
+	const size_t rowBytes = CVPixelBufferGetBytesPerRow( pixelBuffer );
+	cinder::Surface8u result( (uint8_t *)CVPixelBufferGetBaseAddress( pixelBuffer ) + region.y1 * rowBytes + region.x1 * 3, region.getWidth(), region.getHeight(),
+								rowBytes, cinder::SurfaceChannelOrder::RGB );
+	result.setDeallocator( frameDeallocator, pixelBuffer );
+	return result;
+}
+
+// wraps \a region of the luminance plane of a planar YpCbCr \a pixelBuffer without copying it
+static cinder::Channel8u wrapLumaPlane( CVPixelBufferRef pixelBuffer, const cinder::Area &region )
+{
+	CVBufferRetain( pixelBuffer );
+	CVPixelBufferLockBaseAddress( pixelBuffer, 0 );
+	const size_t rowBytes = CVPixelBufferGetBytesPerRowOfPlane( pixelBuffer, 0 );
+	cinder::Channel8u result( region.getWidth(), region.getHeight(), rowBytes,
+								1, (uint8_t *)CVPixelBufferGetBaseAddressOfPlane( pixelBuffer, 0 ) + region.y1 * rowBytes + region.x1 );
+	result.setDeallocator( frameDeallocator, pixelBuffer );
+	return result;
+}
+
+// wraps \a region of the three planes of a planar YpCbCr \a pixelBuffer as an I420 YuvSurface without copying them
+static cinder::YuvSurface wrapYuvPlanes( CVPixelBufferRef pixelBuffer, const cinder::Area &region )
+{
+	CVBufferRetain( pixelBuffer );
+	CVPixelBufferLockBaseAddress( pixelBuffer, 0 );
+	const size_t rowBytes[3] = { CVPixelBufferGetBytesPerRowOfPlane( pixelBuffer, 0 ), CVPixelBufferGetBytesPerRowOfPlane( pixelBuffer, 1 ), CVPixelBufferGetBytesPerRowOfPlane( pixelBuffer, 2 ) };
+	cinder::YuvSurface result( region.getWidth(), region.getHeight(),
+								(uint8_t *)CVPixelBufferGetBaseAddressOfPlane( pixelBuffer, 0 ) + region.y1 * rowBytes[0] + region.x1, rowBytes[0],
+								(uint8_t *)CVPixelBufferGetBaseAddressOfPlane( pixelBuffer, 1 ) + region.y1 / 2 * rowBytes[1] + region.x1 / 2, rowBytes[1],
+								(uint8_t *)CVPixelBufferGetBaseAddressOfPlane( pixelBuffer, 2 ) + region.y1 / 2 * rowBytes[2] + region.x1 / 2, rowBytes[2] );
+	result.setDeallocator( frameDeallocator, pixelBuffer );
+	return result;
+}
+
+static void textureDeallocator( void *refcon )
+{
+	CVOpenGLTextureRelease( reinterpret_cast<CVOpenGLTextureRef>( refcon ) );
+}
+
 /*- (void)attributes
 {
 	NSLog( @"--------Device Attributes--------" );
@@ -123,11 +178,12 @@ static BOOL sDevicesEnumerated = false;
 	return sDevices;
 }
 
-- (id)initWithDevice:(const cinder::Capture::DeviceRef)device width:(int)width height:(int)height 
+- (id)initWithDevice:(const cinder::Capture::DeviceRef)device width:(int)width height:(int)height format:(const cinder::Capture::Format&)format
 {
 	if( ( self = [super init] ) ) {
 
 		mDevice = device;
+		mFormat = format;
 		if( mDevice ) {
 			mDeviceUniqueId = [NSString stringWithUTF8String:device->getUniqueId().c_str()];
 			[mDeviceUniqueId retain];
@@ -140,6 +196,11 @@ static BOOL sDevicesEnumerated = false;
 		mExposedFrameBytesPerRow = 0;
 		mExposedFrameWidth = 0;
 		mExposedFrameHeight = 0;
+		mLatestPixelBuffer = 0;
+		mFrameCount = 0;
+		mTextureFrameCount = 0;
+		mTextureCache = 0;
+		mYpCbCr = false;
 	}
 	return self;
 }
@@ -152,6 +213,11 @@ static BOOL sDevicesEnumerated = false;
 	
 	[mDeviceUniqueId release];
 	
+	mCurrentTexture.reset();
+	if( mTextureCache ) {
+		CVOpenGLTextureCacheRelease( mTextureCache );
+	}
+	
 	[super dealloc];
 }
 
@@ -208,17 +274,29 @@ static BOOL sDevicesEnumerated = false;
 	if( pixelBufferFormat < 0 ) 
 		throw cinder::CaptureExcInvalidChannelOrder(); 	*/
 	
+	// luma and YUV frame functions take YpCbCr so that nothing needs converting to RGB
+	mYpCbCr = ( mLumaFrameFn || mYuvFrameFn ) ? true : false;
 	NSDictionary *attributes = [NSDictionary dictionaryWithObjectsAndKeys:
 								[NSNumber numberWithDouble:mWidth], (id)kCVPixelBufferWidthKey,
 								[NSNumber numberWithDouble:mHeight], (id)kCVPixelBufferHeightKey,
 								//10.4: k32ARGBPixelFormat
 								//10.5: kCVPixelFormatType_32ARGB
 								//[NSNumber numberWithUnsignedInt:pixelBufferFormat], (id)kCVPixelBufferPixelFormatTypeKey,
-								[NSNumber numberWithUnsignedInt:kCVPixelFormatType_24RGB], (id)kCVPixelBufferPixelFormatTypeKey,
+								[NSNumber numberWithUnsignedInt:( mYpCbCr ? kCVPixelFormatType_420YpCbCr8Planar : kCVPixelFormatType_24RGB )], (id)kCVPixelBufferPixelFormatTypeKey,
+								// lets getCurrentTexture() bind the frames to OpenGL instead of uploading them
+								[NSNumber numberWithBool:YES], (id)kCVPixelBufferOpenGLCompatibilityKey,
+#if defined( MAC_OS_X_VERSION_10_6 ) && ( MAC_OS_X_VERSION_MAX_ALLOWED >= MAC_OS_X_VERSION_10_6 )
+								[NSDictionary dictionary], (id)kCVPixelBufferIOSurfacePropertiesKey,
+#endif
 								nil
 								];
 	
+	// the decompressor scales the device's frames to the requested size as it converts them, so they never reach the CPU at full resolution
 	[mCaptureDecompressedOutput setPixelBufferAttributes: attributes];
+	
+	// QTKit can't ask the device itself for a frame rate, but frames beyond it are dropped before they're decompressed
+	if( ( mFormat.getFrameRate() > 0 ) && [mCaptureDecompressedOutput respondsToSelector:@selector(setMinimumVideoFrameInterval:)] )
+		[mCaptureDecompressedOutput setMinimumVideoFrameInterval:1.0 / mFormat.getFrameRate()];
 }
 
 - (void)startCapture 
@@ -256,11 +334,16 @@ static BOOL sDevicesEnumerated = false;
 		mHasNewFrame = false;
 		
 		mCurrentFrame.reset();
+		mCurrentTexture.reset();
 		
 		if( mWorkingPixelBuffer ) {
 			CVBufferRelease( mWorkingPixelBuffer );
 			mWorkingPixelBuffer = 0;
-		}		
+		}
+		if( mLatestPixelBuffer ) {
+			CVBufferRelease( mLatestPixelBuffer );
+			mLatestPixelBuffer = 0;
+		}
 	}
 }
 
@@ -271,17 +354,18 @@ static BOOL sDevicesEnumerated = false;
 
 - (cinder::Surface8u)getCurrentFrame
 {
-	if( ( ! mIsCapturing ) || ( ! mWorkingPixelBuffer ) ) {
+	if( ( ! mIsCapturing ) || ( ! mWorkingPixelBuffer ) || mYpCbCr ) {
 		return mCurrentFrame;
 	}
 	
 	@synchronized (self) {
 		CVPixelBufferLockBaseAddress( mWorkingPixelBuffer, 0 );
 		
-		uint8_t *data = (uint8_t *)CVPixelBufferGetBaseAddress( mWorkingPixelBuffer );
+		const cinder::Area region = calcFrameRegion( mFormat, mWorkingPixelBuffer );
 		mExposedFrameBytesPerRow = CVPixelBufferGetBytesPerRow( mWorkingPixelBuffer );
-		mExposedFrameWidth = CVPixelBufferGetWidth( mWorkingPixelBuffer );
-		mExposedFrameHeight = CVPixelBufferGetHeight( mWorkingPixelBuffer );
+		mExposedFrameWidth = region.getWidth();
+		mExposedFrameHeight = region.getHeight();
+		uint8_t *data = (uint8_t *)CVPixelBufferGetBaseAddress( mWorkingPixelBuffer ) + region.y1 * mExposedFrameBytesPerRow + region.x1 * 3;
 
 		mCurrentFrame = cinder::Surface8u( data, mExposedFrameWidth, mExposedFrameHeight, mExposedFrameBytesPerRow, cinder::SurfaceChannelOrder::RGB );
 		mCurrentFrame.setDeallocator( frameDeallocator, mWorkingPixelBuffer );
@@ -293,6 +377,41 @@ static BOOL sDevicesEnumerated = false;
 	return mCurrentFrame;
 }
 
+- (cinder::gl::Texture)getCurrentTexture
+{
+	@synchronized( self ) {
+		if( ( ! mIsCapturing ) || ( ! mLatestPixelBuffer ) || ( mTextureFrameCount == mFrameCount ) || mYpCbCr ) {
+			return mCurrentTexture;
+		}
+		
+		if( ! mTextureCache ) {
+			CGLContextObj cglContext = ::CGLGetCurrentContext();
+			if( ::CVOpenGLTextureCacheCreate( kCFAllocatorDefault, NULL, cglContext, ::CGLGetPixelFormat( cglContext ), NULL, &mTextureCache ) != kCVReturnSuccess ) {
+				mTextureCache = 0;
+				return mCurrentTexture;
+			}
+		}
+		
+		// the texture refers to the pixel buffer's own storage, so nothing is copied
+		CVOpenGLTextureRef textureRef = 0;
+		if( ::CVOpenGLTextureCacheCreateTextureFromImage( kCFAllocatorDefault, mTextureCache, mLatestPixelBuffer, NULL, &textureRef ) == kCVReturnSuccess ) {
+			int32_t width = CVPixelBufferGetWidth( mLatestPixelBuffer );
+			int32_t height = CVPixelBufferGetHeight( mLatestPixelBuffer );
+			mCurrentTexture = cinder::gl::Texture( ::CVOpenGLTextureGetTarget( textureRef ), ::CVOpenGLTextureGetName( textureRef ), width, height, true );
+			cinder::Vec2f t0, lowerRight, t2, upperLeft;
+			::CVOpenGLTextureGetCleanTexCoords( textureRef, &t0.x, &lowerRight.x, &t2.x, &upperLeft.x );
+			mCurrentTexture.setCleanTexCoords( std::max( upperLeft.x, lowerRight.x ), std::max( upperLeft.y, lowerRight.y ) );
+			mCurrentTexture.setFlipped( ! ::CVOpenGLTextureIsFlipped( textureRef ) );
+			mCurrentTexture.setDeallocator( textureDeallocator, textureRef );
+		}
+		mTextureFrameCount = mFrameCount;
+		// lets the cache recycle the textures of frames which are no longer referenced
+		::CVOpenGLTextureCacheFlush( mTextureCache, 0 );
+	}
+	
+	return mCurrentTexture;
+}
+
 - (bool)checkNewFrame
 {
 	bool result;
@@ -303,6 +422,27 @@ static BOOL sDevicesEnumerated = false;
 	return result;
 }
 
+- (void)setFrameFn:(const cinder::Capture::FrameFn&)frameFn
+{
+	@synchronized( self ) {
+		mFrameFn = frameFn;
+	}
+}
+
+- (void)setLumaFrameFn:(const cinder::Capture::LumaFrameFn&)lumaFrameFn
+{
+	@synchronized( self ) {
+		mLumaFrameFn = lumaFrameFn;
+	}
+}
+
+- (void)setYuvFrameFn:(const cinder::Capture::YuvFrameFn&)yuvFrameFn
+{
+	@synchronized( self ) {
+		mYuvFrameFn = yuvFrameFn;
+	}
+}
+
 void frameDeallocator( void *refcon )
 {
 	CVPixelBufferRef pixelBuffer = reinterpret_cast<CVPixelBufferRef>( refcon );
@@ -317,12 +457,12 @@ void frameDeallocator( void *refcon )
 
 - (int32_t)getWidth
 {
-	return mWidth;
+	return mFormat.calcRegion( mWidth, mHeight ).getWidth();
 }
 
 - (int32_t)getHeight
 {
-	return mHeight;
+	return mFormat.calcRegion( mWidth, mHeight ).getHeight();
 }
 
 - (int32_t)getCurrentFrameBytesPerRow
@@ -342,8 +482,18 @@ void frameDeallocator( void *refcon )
 
 - (void)captureOutput:(QTCaptureOutput *)captureOutput didOutputVideoFrame:(CVImageBufferRef)videoFrame withSampleBuffer:(QTSampleBuffer *)sampleBuffer fromConnection:(QTCaptureConnection *)connection
 {
+	cinder::Capture::FrameFn frameFn;
+	cinder::Capture::LumaFrameFn lumaFrameFn;
+	cinder::Capture::YuvFrameFn yuvFrameFn;
 	@synchronized( self ) {
 		if( mIsCapturing ) {
+			if( mYpCbCr ) {
+				lumaFrameFn = mLumaFrameFn;
+				yuvFrameFn = mYuvFrameFn;
+			}
+			else
+				frameFn = mFrameFn;
+
 			// if the last pixel buffer went unclaimed, we'll need to release it
 			if( mWorkingPixelBuffer ) {
 				CVBufferRelease( mWorkingPixelBuffer );
@@ -352,9 +502,42 @@ void frameDeallocator( void *refcon )
 			CVBufferRetain( videoFrame );
 		
 			mWorkingPixelBuffer = (CVPixelBufferRef)videoFrame;
-			mHasNewFrame = true;			
+			mHasNewFrame = true;
+			
+			if( mLatestPixelBuffer ) {
+				CVBufferRelease( mLatestPixelBuffer );
+			}
+			mLatestPixelBuffer = (CVPixelBufferRef)CVBufferRetain( videoFrame );
+			++mFrameCount;
 		}
-	}	
+	}
+	
+	if( ( ! frameFn ) && ( ! lumaFrameFn ) && ( ! yuvFrameFn ) )
+		return;
+
+	// the hardware's host time stamp, which shares mach_absolute_time()'s clock with Capture::getHostTime()
+	double hostTime;
+	NSNumber *hostTimeNumber = [sampleBuffer attributeForKey:QTSampleBufferHostTimeAttribute];
+	if( hostTimeNumber ) {
+		static double sSecondsPerTick = 0;
+		if( sSecondsPerTick == 0 ) {
+			mach_timebase_info_data_t timebase;
+			mach_timebase_info( &timebase );
+			sSecondsPerTick = timebase.numer / ( timebase.denom * 1.0e9 );
+		}
+		hostTime = [hostTimeNumber unsignedLongLongValue] * sSecondsPerTick;
+	}
+	else
+		hostTime = cinder::Capture::getHostTime();
+
+	// called outside of the lock so that a slow consumer doesn't hold up getCurrentFrame()
+	const cinder::Area region = calcFrameRegion( mFormat, (CVPixelBufferRef)videoFrame );
+	if( frameFn )
+		frameFn( wrapPixelBuffer( (CVPixelBufferRef)videoFrame, region ), hostTime );
+	if( lumaFrameFn )
+		lumaFrameFn( wrapLumaPlane( (CVPixelBufferRef)videoFrame, region ), hostTime );
+	if( yuvFrameFn )
+		yuvFrameFn( wrapYuvPlanes( (CVPixelBufferRef)videoFrame, region ), hostTime );
 }
 
 @end
@@ -23,6 +23,8 @@
 #include "cinder/Channel.h"
 #include "cinder/ChanTraits.h"
 #include "cinder/ImageIo.h"
+#include "cinder/Utilities.h"
+#include "cinder/SurfacePool.h"
 
 #include <boost/type_traits/is_same.hpp>
 
@@ -110,7 +112,7 @@ class ImageSourceChannel : public ImageSource {
 
 template<typename T>
 ChannelT<T>::Obj::Obj( int32_t aWidth, int32_t aHeight )
-	: mWidth( aWidth ), mHeight( aHeight )
+	: mWidth( aWidth ), mHeight( aHeight ), mTrackedMemory( MemoryTracker::CHANNEL )
 {
 	mRowBytes = mWidth * sizeof(T);
 	mIncrement = 1;
@@ -118,11 +120,12 @@ ChannelT<T>::Obj::Obj( int32_t aWidth, int32_t aHeight )
 	mOwnsData = true;
 	mData = new T[mWidth * mHeight];
 	mDeallocatorFunc = 0;
+	mTrackedMemory.set( mWidth * mHeight * sizeof(T) );
 }
 
 template<typename T>
 ChannelT<T>::Obj::Obj( int32_t aWidth, int32_t aHeight, int32_t aRowBytes, uint8_t aIncrement, bool aOwnsData, T *aData )
-	: mWidth( aWidth ), mHeight( aHeight ), mRowBytes( aRowBytes ), mIncrement( aIncrement ), mOwnsData( aOwnsData ), mData( aData )
+	: mWidth( aWidth ), mHeight( aHeight ), mRowBytes( aRowBytes ), mIncrement( aIncrement ), mOwnsData( aOwnsData ), mData( aData ), mTrackedMemory( MemoryTracker::CHANNEL )
 {
 	mDeallocatorFunc = 0;
 }
@@ -142,6 +145,28 @@ ChannelT<T>::ChannelT( int32_t width, int32_t height )
 {
 }
 
+template<typename T>
+ChannelT<T>::ChannelT( int32_t width, int32_t height, int32_t alignment )
+{
+	int32_t rowBytes = ( width * sizeof(T) + alignment - 1 ) & ~( alignment - 1 );
+	T *data = reinterpret_cast<T*>( alignedMalloc( height * rowBytes, alignment ) );
+	mObj = shared_ptr<Obj>( new Obj( width, height, rowBytes, 1, false, data ) );
+	mObj->mDeallocatorFunc = alignedFree;
+	mObj->mDeallocatorRefcon = data;
+	mObj->mTrackedMemory.set( height * rowBytes );
+}
+
+template<typename T>
+ChannelT<T>::ChannelT( int32_t width, int32_t height, const SurfacePoolRef &pool )
+{
+	void *refcon;
+	T *data = reinterpret_cast<T*>( pool->allocate( width * height * sizeof(T), &refcon ) );
+	mObj = shared_ptr<Obj>( new Obj( width, height, width * sizeof(T), 1, false, data ) );
+	mObj->mDeallocatorFunc = SurfacePool::deallocate;
+	mObj->mDeallocatorRefcon = refcon;
+	mObj->mTrackedMemory.set( width * height * sizeof(T) );
+}
+
 template<typename T>
 ChannelT<T>::ChannelT( int32_t width, int32_t height, int32_t rowBytes, uint8_t increment, T *data )
 	: mObj( new Obj( width, height, rowBytes, increment, false, data ) )
@@ -159,6 +184,7 @@ ChannelT<T>::ChannelT( ImageSourceRef imageSource )
 
 	mObj = shared_ptr<Obj>( new Obj( width, height, rowBytes, 1, true, data ) );
 	mObj->mOwnsData = true;
+	mObj->mTrackedMemory.set( height * rowBytes );
 	
 	shared_ptr<ImageTargetChannel<T> > target = ImageTargetChannel<T>::createRef( this );
 	imageSource->load( target );	
@@ -198,6 +224,16 @@ ChannelT<T> ChannelT<T>::clone( const Area &area, bool copyPixels ) const
 	return result;
 }
 
+template<typename T>
+ChannelT<T> ChannelT<T>::getSubChannel( const Area &area ) const
+{
+	Area clipped = area.getClipBy( getBounds() );
+	T *data = const_cast<T*>( getData( clipped.getUL() ) );
+	ChannelT result;
+	result.mObj = shared_ptr<Obj>( new Obj( clipped.getWidth(), clipped.getHeight(), mObj->mRowBytes, mObj->mIncrement, false, data ) );
+	result.mObj->mParent = mObj;
+	return result;
+}
 
 template<typename T>
 void ChannelT<T>::copyFrom( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &relativeOffset )
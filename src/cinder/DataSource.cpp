@@ -21,6 +21,7 @@
 */
 
 #include "cinder/DataSource.h"
+#include "cinder/Utilities.h"
 
 namespace cinder {
 
@@ -80,9 +81,58 @@ IStreamRef DataSourcePath::createStream()
 	return loadFileStream( mFilePath );
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// DataSourceMmap
+DataSourceMmapRef DataSourceMmap::create( const fs::path &path )
+{
+	return DataSourceMmapRef( new DataSourceMmap( path ) );
+}
+
+DataSourceMmap::DataSourceMmap( const fs::path &path )
+	: DataSourcePath( path ), mMappingSize( 0 ), mMapFailed( false )
+{
+}
+
+bool DataSourceMmap::map()
+{
+	if( ! mMapping && ! mMapFailed ) {
+		mMapping = mapFile( mFilePath, &mMappingSize );
+		mMapFailed = ! mMapping;
+	}
+	return mMapping;
+}
+
+void DataSourceMmap::createBuffer()
+{
+	if( map() )
+		mBuffer = Buffer( mMapping, mMappingSize );
+	else
+		DataSourcePath::createBuffer();
+}
+
+IStreamRef DataSourceMmap::createStream()
+{
+	if( map() )
+		return IStreamMmap::create( mMapping, mMappingSize );
+	else
+		return DataSourcePath::createStream();
+}
+
 DataSourceRef loadFile( const fs::path &path )
 {
-	return DataSourcePath::create( path );
+	return DataSourceMmap::create( path );
+}
+
+Buffer loadDataSourceBuffer( DataSourceRef dataSource )
+{
+	if( dataSource->isFilePath() && ! std::dynamic_pointer_cast<DataSourceMmap>( dataSource ) ) {
+		size_t size = 0;
+		std::shared_ptr<const void> mapping = mapFile( dataSource->getFilePath(), &size );
+		if( mapping )
+			return Buffer( mapping, size );
+	}
+
+	return dataSource->getBuffer();
 }
 
 /////////////////////////////////////////////////////////////////////////////
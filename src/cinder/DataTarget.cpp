@@ -54,16 +54,31 @@ DataTargetPathRef DataTargetPath::createRef( const fs::path &path )
 	return DataTargetPathRef( new DataTargetPath( path ) );
 }
 
+DataTargetPathRef DataTargetPath::createRef( const fs::path &path, const OStreamFileAsync::Format &asyncFormat )
+{
+	return DataTargetPathRef( new DataTargetPath( path, asyncFormat ) );
+}
+
 DataTargetPath::DataTargetPath( const fs::path &path )
-	: DataTarget( path, Url() )
+	: DataTarget( path, Url() ), mAsync( false )
+{
+	setFilePathHint( path.string() );
+}
+
+DataTargetPath::DataTargetPath( const fs::path &path, const OStreamFileAsync::Format &asyncFormat )
+	: DataTarget( path, Url() ), mAsync( true ), mAsyncFormat( asyncFormat )
 {
 	setFilePathHint( path.string() );
 }
 
 OStreamRef DataTargetPath::getStream()
 {
-	if( ! mStream )
-		mStream = writeFileStream( mFilePath );
+	if( ! mStream ) {
+		if( mAsync )
+			mStream = writeFileStreamAsync( mFilePath, true, mAsyncFormat );
+		else
+			mStream = writeFileStream( mFilePath );
+	}
 		
 	return mStream;
 }
@@ -91,4 +106,12 @@ DataTargetPathRef writeFile( const fs::path &path, bool createParents )
  	return DataTargetPath::createRef( path );
 }
 
+DataTargetPathRef writeFileAsync( const fs::path &path, bool createParents, const OStreamFileAsync::Format &format )
+{
+	if( createParents )
+		createDirectories( path ); 
+	
+ 	return DataTargetPath::createRef( path, format );
+}
+
 } // namespace cinder
\ No newline at end of file
@@ -0,0 +1,366 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "cinder/FileWatcher.h"
+#include "cinder/Thread.h"
+#include "cinder/Timer.h"
+
+#if defined( CINDER_MSW )
+	#include "cinder/Utilities.h"
+	#include <windows.h>
+	#undef min
+	#undef max
+#elif defined( CINDER_MAC )
+	#include <CoreServices/CoreServices.h>
+#endif
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+struct FileState {
+	FileState() : mExists( false ), mWriteTime( 0 ), mSize( 0 ) {}
+
+	bool operator==( const FileState &rhs ) const { return ( mExists == rhs.mExists ) && ( mWriteTime == rhs.mWriteTime ) && ( mSize == rhs.mSize ); }
+	bool operator!=( const FileState &rhs ) const { return ! ( *this == rhs ); }
+
+	bool		mExists;
+	std::time_t	mWriteTime;
+	uintmax_t	mSize;
+};
+
+FileState queryFileState( const fs::path &path )
+{
+	FileState result;
+	try {
+		if( fs::exists( path ) ) {
+			result.mWriteTime = fs::last_write_time( path );
+			result.mSize = fs::file_size( path );
+			result.mExists = true;
+		}
+	}
+	catch( fs::filesystem_error & ) {
+		// the file is likely mid-replacement; it'll be checked again on the next notification
+	}
+	return result;
+}
+
+fs::path directoryOf( const fs::path &path )
+{
+	fs::path dir = path.parent_path();
+	return dir.empty() ? fs::path( "." ) : dir;
+}
+
+} // anonymous namespace
+
+struct FileWatcher::Impl {
+	// receives notifications for a single directory and marks it dirty; without a native implementation isNative() is false and the directory is polled
+	class DirectoryMonitor;
+
+	Impl() : mPollInterval( 0.5 ), mNextPollTime( 0 ), mTimer( true ) {}
+
+	void	markDirty( const fs::path &dir )
+	{
+		std::lock_guard<std::mutex> lock( mDirtyMutex );
+		mDirtyDirs.insert( dir );
+	}
+
+	void	updateMonitors();
+
+	struct Watch {
+		CallbackId								mId;
+		vector<fs::path>						mPaths;
+		std::function<void (const fs::path &)>	mCallback;
+	};
+
+	std::mutex			mDirtyMutex;
+	set<fs::path>		mDirtyDirs; // guarded by mDirtyMutex; written by monitors, possibly on their threads
+
+	vector<Watch>				mWatches;
+	map<fs::path,FileState>		mFileStates;
+	double						mPollInterval, mNextPollTime;
+	Timer						mTimer;
+
+	// declared last so that monitors are stopped before what they write to is destroyed
+	map<fs::path,std::shared_ptr<DirectoryMonitor> >	mMonitors;
+};
+
+#if defined( CINDER_MSW )
+class FileWatcher::Impl::DirectoryMonitor {
+  public:
+	DirectoryMonitor( FileWatcher::Impl *impl, const fs::path &dir )
+		: mImpl( impl ), mDir( dir ), mStopEvent( 0 ), mDirHandle( INVALID_HANDLE_VALUE )
+	{
+		mDirHandle = ::CreateFileW( toUtf16( dir.string() ).c_str(), FILE_LIST_DIRECTORY, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+			NULL, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL );
+		if( mDirHandle == INVALID_HANDLE_VALUE )
+			return;
+		mStopEvent = ::CreateEvent( NULL, TRUE, FALSE, NULL );
+		mThread = shared_ptr<thread>( new thread( std::bind( &DirectoryMonitor::threadFn, this ) ) );
+	}
+
+	~DirectoryMonitor()
+	{
+		if( mThread ) {
+			::SetEvent( mStopEvent );
+			mThread->join();
+			::CloseHandle( mStopEvent );
+		}
+		if( mDirHandle != INVALID_HANDLE_VALUE )
+			::CloseHandle( mDirHandle );
+	}
+
+	bool	isNative() const { return mThread.get() != 0; }
+
+  private:
+	void	threadFn()
+	{
+		ThreadSetup threadSetup;
+
+		// the notifications themselves aren't parsed; they only tell us which directory's watched files to check
+		DWORD buffer[1024];
+		OVERLAPPED overlapped;
+		::ZeroMemory( &overlapped, sizeof(overlapped) );
+		overlapped.hEvent = ::CreateEvent( NULL, FALSE, FALSE, NULL );
+		HANDLE events[2] = { overlapped.hEvent, mStopEvent };
+
+		while( ::ReadDirectoryChangesW( mDirHandle, buffer, sizeof(buffer), FALSE, FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE | FILE_NOTIFY_CHANGE_LAST_WRITE,
+				NULL, &overlapped, NULL ) ) {
+			if( ::WaitForMultipleObjects( 2, events, FALSE, INFINITE ) != WAIT_OBJECT_0 ) {
+				::CancelIo( mDirHandle );
+				break;
+			}
+			mImpl->markDirty( mDir );
+		}
+
+		::CloseHandle( overlapped.hEvent );
+	}
+
+	FileWatcher::Impl	*mImpl;
+	fs::path			mDir;
+	HANDLE				mStopEvent, mDirHandle;
+	shared_ptr<thread>	mThread;
+};
+
+#elif defined( CINDER_MAC )
+class FileWatcher::Impl::DirectoryMonitor {
+  public:
+	DirectoryMonitor( FileWatcher::Impl *impl, const fs::path &dir )
+		: mImpl( impl ), mDir( dir ), mStream( 0 )
+	{
+		CFStringRef dirString = ::CFStringCreateWithCString( kCFAllocatorDefault, dir.string().c_str(), kCFStringEncodingUTF8 );
+		CFArrayRef paths = ::CFArrayCreate( kCFAllocatorDefault, (const void **)&dirString, 1, &kCFTypeArrayCallBacks );
+		FSEventStreamContext context = { 0, this, NULL, NULL, NULL };
+		// events are delivered on the main run loop, so markDirty() is called on the app's thread
+		mStream = ::FSEventStreamCreate( kCFAllocatorDefault, &DirectoryMonitor::callback, &context, paths, kFSEventStreamEventIdSinceNow, 0.05, kFSEventStreamCreateFlagNone );
+		::CFRelease( paths );
+		::CFRelease( dirString );
+		if( ! mStream )
+			return;
+
+		::FSEventStreamScheduleWithRunLoop( mStream, ::CFRunLoopGetMain(), kCFRunLoopDefaultMode );
+		if( ! ::FSEventStreamStart( mStream ) ) {
+			::FSEventStreamInvalidate( mStream );
+			::FSEventStreamRelease( mStream );
+			mStream = 0;
+		}
+	}
+
+	~DirectoryMonitor()
+	{
+		if( mStream ) {
+			::FSEventStreamStop( mStream );
+			::FSEventStreamInvalidate( mStream );
+			::FSEventStreamRelease( mStream );
+		}
+	}
+
+	bool	isNative() const { return mStream != 0; }
+
+  private:
+	static void callback( ConstFSEventStreamRef stream, void *info, size_t numEvents, void *eventPaths, const FSEventStreamEventFlags eventFlags[], const FSEventStreamEventId eventIds[] )
+	{
+		DirectoryMonitor *monitor = reinterpret_cast<DirectoryMonitor*>( info );
+		monitor->mImpl->markDirty( monitor->mDir );
+	}
+
+	FileWatcher::Impl	*mImpl;
+	fs::path			mDir;
+	FSEventStreamRef	mStream;
+};
+
+#else
+class FileWatcher::Impl::DirectoryMonitor {
+  public:
+	DirectoryMonitor( FileWatcher::Impl *impl, const fs::path &dir ) {}
+
+	bool	isNative() const { return false; }
+};
+
+#endif
+
+void FileWatcher::Impl::updateMonitors()
+{
+	set<fs::path> dirs;
+	for( map<fs::path,FileState>::const_iterator stateIt = mFileStates.begin(); stateIt != mFileStates.end(); ++stateIt )
+		dirs.insert( directoryOf( stateIt->first ) );
+
+	for( map<fs::path,std::shared_ptr<DirectoryMonitor> >::iterator monIt = mMonitors.begin(); monIt != mMonitors.end(); ) {
+		if( dirs.count( monIt->first ) )
+			++monIt;
+		else
+			mMonitors.erase( monIt++ );
+	}
+
+	for( set<fs::path>::const_iterator dirIt = dirs.begin(); dirIt != dirs.end(); ++dirIt ) {
+		if( ! mMonitors.count( *dirIt ) )
+			mMonitors[*dirIt] = std::shared_ptr<DirectoryMonitor>( new DirectoryMonitor( this, *dirIt ) );
+	}
+}
+
+FileWatcher::FileWatcher()
+	: mImpl( new Impl )
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+}
+
+FileWatcher& FileWatcher::get()
+{
+	static FileWatcher sInstance;
+	return sInstance;
+}
+
+CallbackId FileWatcher::watch( const fs::path &path, const std::function<void (const fs::path &)> &callback )
+{
+	return watch( vector<fs::path>( 1, path ), callback );
+}
+
+CallbackId FileWatcher::watch( const vector<fs::path> &paths, const std::function<void (const fs::path &)> &callback )
+{
+	Impl::Watch watch;
+	watch.mId = ( mImpl->mWatches.empty() ) ? 0 : mImpl->mWatches.back().mId + 1;
+	watch.mPaths = paths;
+	watch.mCallback = callback;
+	mImpl->mWatches.push_back( watch );
+
+	for( vector<fs::path>::const_iterator pathIt = paths.begin(); pathIt != paths.end(); ++pathIt ) {
+		if( ! mImpl->mFileStates.count( *pathIt ) )
+			mImpl->mFileStates[*pathIt] = queryFileState( *pathIt );
+	}
+	mImpl->updateMonitors();
+
+	return watch.mId;
+}
+
+void FileWatcher::unwatch( CallbackId id )
+{
+	for( vector<Impl::Watch>::iterator watchIt = mImpl->mWatches.begin(); watchIt != mImpl->mWatches.end(); ++watchIt ) {
+		if( watchIt->mId == id ) {
+			mImpl->mWatches.erase( watchIt );
+			break;
+		}
+	}
+
+	// forget the files no other watch refers to
+	set<fs::path> watched;
+	for( vector<Impl::Watch>::const_iterator watchIt = mImpl->mWatches.begin(); watchIt != mImpl->mWatches.end(); ++watchIt )
+		watched.insert( watchIt->mPaths.begin(), watchIt->mPaths.end() );
+	for( map<fs::path,FileState>::iterator stateIt = mImpl->mFileStates.begin(); stateIt != mImpl->mFileStates.end(); ) {
+		if( watched.count( stateIt->first ) )
+			++stateIt;
+		else
+			mImpl->mFileStates.erase( stateIt++ );
+	}
+	mImpl->updateMonitors();
+}
+
+void FileWatcher::update()
+{
+	if( mImpl->mWatches.empty() )
+		return;
+
+	set<fs::path> dirtyDirs;
+	{
+		std::lock_guard<std::mutex> lock( mImpl->mDirtyMutex );
+		dirtyDirs.swap( mImpl->mDirtyDirs );
+	}
+
+	double now = mImpl->mTimer.getSeconds();
+	if( now >= mImpl->mNextPollTime ) {
+		for( map<fs::path,std::shared_ptr<Impl::DirectoryMonitor> >::const_iterator monIt = mImpl->mMonitors.begin(); monIt != mImpl->mMonitors.end(); ++monIt ) {
+			if( ! monIt->second->isNative() )
+				dirtyDirs.insert( monIt->first );
+		}
+		mImpl->mNextPollTime = now + mImpl->mPollInterval;
+	}
+
+	if( dirtyDirs.empty() )
+		return;
+
+	vector<fs::path> changed;
+	for( map<fs::path,FileState>::iterator stateIt = mImpl->mFileStates.begin(); stateIt != mImpl->mFileStates.end(); ++stateIt ) {
+		if( ! dirtyDirs.count( directoryOf( stateIt->first ) ) )
+			continue;
+		FileState state = queryFileState( stateIt->first );
+		// a file which has been deleted is reported once it's been recreated
+		if( state.mExists && ( state != stateIt->second ) )
+			changed.push_back( stateIt->first );
+		stateIt->second = state;
+	}
+
+	if( changed.empty() )
+		return;
+
+	// callbacks may watch or unwatch, so iterate a copy
+	vector<Impl::Watch> watches( mImpl->mWatches );
+	for( vector<fs::path>::const_iterator pathIt = changed.begin(); pathIt != changed.end(); ++pathIt ) {
+		for( vector<Impl::Watch>::const_iterator watchIt = watches.begin(); watchIt != watches.end(); ++watchIt ) {
+			if( find( watchIt->mPaths.begin(), watchIt->mPaths.end(), *pathIt ) != watchIt->mPaths.end() )
+				watchIt->mCallback( *pathIt );
+		}
+	}
+}
+
+void FileWatcher::setPollInterval( double seconds )
+{
+	mImpl->mPollInterval = std::max( 0.0, seconds );
+}
+
+double FileWatcher::getPollInterval() const
+{
+	return mImpl->mPollInterval;
+}
+
+} // namespace cinder
@@ -42,6 +42,11 @@
 	#pragma comment(lib, "gdiplus")
 #endif
 #include "cinder/Utilities.h"
+#include "cinder/Thread.h"
+
+#include <boost/thread/tss.hpp>
+#include <algorithm>
+#include <map>
 
 using std::vector;
 using std::string;
@@ -79,7 +84,8 @@ class FontManager
 	vector<string>		mFontNames;
 	mutable Font		mDefault;
 #if defined( CINDER_MSW )
-	HDC					getFontDc() const { return mFontDc; }
+	//! Returns the calling thread's DC for measuring, since a DC's selected font can't be shared between threads
+	HDC					getFontDc() const;
 	Gdiplus::Graphics*	getGraphics() const { return mGraphics; }
 	LONG				convertSizeToLogfontHeight( float size ) { return ::MulDiv( (long)size, -::GetDeviceCaps( mFontDc, LOGPIXELSY ), 96 ); }
 #endif
@@ -96,6 +102,17 @@ class FontManager
 
 FontManager *FontManager::sInstance = 0;
 
+#if defined( CINDER_MSW )
+struct ThreadFontDc {
+	ThreadFontDc() : mDc( ::CreateCompatibleDC( NULL ) ) {}
+	~ThreadFontDc() { ::DeleteDC( mDc ); }
+
+	HDC		mDc;
+};
+
+static boost::thread_specific_ptr<ThreadFontDc> sThreadFontDc;
+#endif
+
 FontManager::FontManager()
 {
 	mFontsEnumerated = false;
@@ -123,6 +140,19 @@ FontManager* FontManager::instance()
 	return sInstance;
 }
 
+#if defined( CINDER_MSW )
+HDC FontManager::getFontDc() const
+{
+	ThreadFontDc *threadDc = sThreadFontDc.get();
+	if( ! threadDc ) {
+		threadDc = new ThreadFontDc;
+		sThreadFontDc.reset( threadDc );
+	}
+
+	return threadDc->mDc;
+}
+#endif
+
 #if defined( CINDER_MSW )
 int CALLBACK EnumFontFamiliesExProc( ENUMLOGFONTEX *lpelfe, NEWTEXTMETRICEX *lpntme, int FontType, LPARAM lParam )
 {
@@ -165,6 +195,24 @@ const vector<string>& FontManager::getNames( bool forceRefresh )
 	return mFontNames;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Font::GlyphCache
+// Outlines and metrics of the glyphs requested so far, shared by every copy of a Font
+class Font::GlyphCache {
+  public:
+	struct Entry {
+		Entry() : mHasShape( false ), mHasMetrics( false ) {}
+		
+		bool		mHasShape, mHasMetrics;
+		Shape2d		mShape;
+		Rectf		mBoundingBox;
+		Vec2f		mAdvance;
+	};
+	
+	std::mutex				mMutex;
+	std::map<Glyph,Entry>	mEntries;
+};
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Font
 Font::Font( const string &name, float size )
@@ -263,7 +311,7 @@ vector<Font::Glyph> Font::getGlyphs( const string &s ) const
 	return result;
 }
 
-Shape2d Font::getGlyphShape( Glyph glyphIndex ) const
+Shape2d Font::calcGlyphShape( Glyph glyphIndex ) const
 {
 	CGPathRef path = CTFontCreatePathForGlyph( mObj->mCTFont, static_cast<CGGlyph>( glyphIndex ), NULL );
 	Shape2d resultShape;
@@ -272,11 +320,17 @@ Shape2d Font::getGlyphShape( Glyph glyphIndex ) const
 	return resultShape;
 }
 
-Rectf Font::getGlyphBoundingBox( Glyph glyph ) const
+void Font::calcGlyphMetrics( const Glyph *glyphs, size_t count, Rectf *boundingBoxes, Vec2f *advances ) const
 {
-	CGGlyph glyphs[1] = { glyph };
-	CGRect bounds = ::CTFontGetBoundingRectsForGlyphs( mObj->mCTFont, kCTFontDefaultOrientation, glyphs, NULL, 1 );
-	return Rectf( bounds.origin.x, bounds.origin.y, bounds.origin.x + bounds.size.width, bounds.origin.y + bounds.size.height );
+	vector<CGGlyph> cgGlyphs( glyphs, glyphs + count );
+	vector<CGRect> bounds( count );
+	vector<CGSize> cgAdvances( count );
+	::CTFontGetBoundingRectsForGlyphs( mObj->mCTFont, kCTFontDefaultOrientation, &cgGlyphs[0], &bounds[0], count );
+	::CTFontGetAdvancesForGlyphs( mObj->mCTFont, kCTFontDefaultOrientation, &cgGlyphs[0], &cgAdvances[0], count );
+	for( size_t g = 0; g < count; ++g ) {
+		boundingBoxes[g] = Rectf( bounds[g].origin.x, bounds[g].origin.y, bounds[g].origin.x + bounds[g].size.width, bounds[g].origin.y + bounds[g].size.height );
+		advances[g] = Vec2f( cgAdvances[g].width, cgAdvances[g].height );
+	}
 }
 
 CGFontRef Font::getCgFontRef() const
@@ -364,11 +418,12 @@ vector<Font::Glyph> Font::getGlyphs( const string &utf8String ) const
 	return result;
 }
 
-Shape2d Font::getGlyphShape( Glyph glyphIndex ) const
+Shape2d Font::calcGlyphShape( Glyph glyphIndex ) const
 {
 	Shape2d resultShape;
 	static const MAT2 matrix = { { 0, 1 }, { 0, 0 }, { 0, 0 }, { 0, -1 } };
 	GLYPHMETRICS metrics;
+	::SelectObject( FontManager::instance()->getFontDc(), mObj->mHfont );
 	DWORD bytesGlyph = ::GetGlyphOutlineW( FontManager::instance()->getFontDc(), glyphIndex,
 							GGO_NATIVE | GGO_GLYPH_INDEX, &metrics, 0, NULL, &matrix);
 
@@ -436,25 +491,112 @@ Shape2d Font::getGlyphShape( Glyph glyphIndex ) const
 	return resultShape;
 }
 
-Rectf Font::getGlyphBoundingBox( Glyph glyphIndex ) const
+void Font::calcGlyphMetrics( const Glyph *glyphs, size_t count, Rectf *boundingBoxes, Vec2f *advances ) const
 {
+	// GDI has no batched equivalent, but GGO_METRICS is cheap and provides the advance too
 	static const MAT2 matrix = { { 0, 1 }, { 0, 0 }, { 0, 0 }, { 0, -1 } };
-	GLYPHMETRICS metrics;
 	::SelectObject( FontManager::instance()->getFontDc(), mObj->mHfont );
-	DWORD bytesGlyph = ::GetGlyphOutlineW( FontManager::instance()->getFontDc(), glyphIndex,
-							GGO_METRICS | GGO_GLYPH_INDEX, &metrics, 0, NULL, &matrix);
+	for( size_t g = 0; g < count; ++g ) {
+		GLYPHMETRICS metrics;
+		DWORD bytesGlyph = ::GetGlyphOutlineW( FontManager::instance()->getFontDc(), glyphs[g],
+								GGO_METRICS | GGO_GLYPH_INDEX, &metrics, 0, NULL, &matrix);
 
-    if( bytesGlyph == GDI_ERROR )
-		throw FontGlyphFailureExc();
+		if( bytesGlyph == GDI_ERROR )
+			throw FontGlyphFailureExc();
 
-	return Rectf( metrics.gmptGlyphOrigin.x, metrics.gmptGlyphOrigin.y,
-			metrics.gmptGlyphOrigin.x + metrics.gmBlackBoxX, metrics.gmptGlyphOrigin.y + (int)metrics.gmBlackBoxY );
+		boundingBoxes[g] = Rectf( metrics.gmptGlyphOrigin.x, metrics.gmptGlyphOrigin.y,
+				metrics.gmptGlyphOrigin.x + metrics.gmBlackBoxX, metrics.gmptGlyphOrigin.y + (int)metrics.gmBlackBoxY );
+		advances[g] = Vec2f( metrics.gmCellIncX, metrics.gmCellIncY );
+	}
 }
 
 #endif
 
+Shape2d Font::getGlyphShape( Glyph glyphIndex ) const
+{
+	std::lock_guard<std::mutex> lock( mObj->mGlyphCache->mMutex );
+	return cacheGlyphShape( glyphIndex );
+}
+
+Rectf Font::getGlyphBoundingBox( Glyph glyph ) const
+{
+	std::lock_guard<std::mutex> lock( mObj->mGlyphCache->mMutex );
+	cacheGlyphMetrics( &glyph, 1 );
+	return mObj->mGlyphCache->mEntries[glyph].mBoundingBox;
+}
+
+Vec2f Font::getGlyphAdvance( Glyph glyph ) const
+{
+	std::lock_guard<std::mutex> lock( mObj->mGlyphCache->mMutex );
+	cacheGlyphMetrics( &glyph, 1 );
+	return mObj->mGlyphCache->mEntries[glyph].mAdvance;
+}
+
+void Font::getGlyphShapes( const vector<Glyph> &glyphs, vector<Shape2d> *shapes, vector<Vec2f> *advances ) const
+{
+	shapes->clear();
+	if( advances )
+		advances->clear();
+	if( glyphs.empty() )
+		return;
+	
+	std::lock_guard<std::mutex> lock( mObj->mGlyphCache->mMutex );
+	if( advances ) {
+		cacheGlyphMetrics( &glyphs[0], glyphs.size() );
+		for( vector<Glyph>::const_iterator glyphIt = glyphs.begin(); glyphIt != glyphs.end(); ++glyphIt )
+			advances->push_back( mObj->mGlyphCache->mEntries[*glyphIt].mAdvance );
+	}
+	for( vector<Glyph>::const_iterator glyphIt = glyphs.begin(); glyphIt != glyphs.end(); ++glyphIt )
+		shapes->push_back( cacheGlyphShape( *glyphIt ) );
+}
+
+vector<Font::Glyph> Font::getGlyphShapes( const string &utf8String, vector<Shape2d> *shapes, vector<Vec2f> *advances ) const
+{
+	vector<Glyph> result = getGlyphs( utf8String );
+	getGlyphShapes( result, shapes, advances );
+	return result;
+}
+
+void Font::clearGlyphCache()
+{
+	std::lock_guard<std::mutex> lock( mObj->mGlyphCache->mMutex );
+	mObj->mGlyphCache->mEntries.clear();
+}
+
+const Shape2d& Font::cacheGlyphShape( Glyph glyph ) const
+{
+	GlyphCache::Entry &entry = mObj->mGlyphCache->mEntries[glyph];
+	if( ! entry.mHasShape ) {
+		entry.mShape = calcGlyphShape( glyph );
+		entry.mHasShape = true;
+	}
+	return entry.mShape;
+}
+
+void Font::cacheGlyphMetrics( const Glyph *glyphs, size_t count ) const
+{
+	vector<Glyph> missing;
+	for( size_t g = 0; g < count; ++g )
+		if( ! mObj->mGlyphCache->mEntries[glyphs[g]].mHasMetrics )
+			missing.push_back( glyphs[g] );
+	if( missing.empty() )
+		return;
+	
+	std::sort( missing.begin(), missing.end() );
+	missing.erase( std::unique( missing.begin(), missing.end() ), missing.end() );
+	vector<Rectf> boundingBoxes( missing.size() );
+	vector<Vec2f> advances( missing.size() );
+	calcGlyphMetrics( &missing[0], missing.size(), &boundingBoxes[0], &advances[0] );
+	for( size_t g = 0; g < missing.size(); ++g ) {
+		GlyphCache::Entry &entry = mObj->mGlyphCache->mEntries[missing[g]];
+		entry.mBoundingBox = boundingBoxes[g];
+		entry.mAdvance = advances[g];
+		entry.mHasMetrics = true;
+	}
+}
+
 Font::Obj::Obj( const string &aName, float aSize )
-	: mName( aName ), mSize( aSize )
+	: mName( aName ), mSize( aSize ), mGlyphCache( new GlyphCache )
 #if defined( CINDER_MSW )
 	, mHfont( 0 )
 #endif
@@ -488,7 +630,7 @@ Font::Obj::Obj( const string &aName, float aSize )
 }
 
 Font::Obj::Obj( DataSourceRef dataSource, float size )
-	: mSize( size )
+	: mSize( size ), mGlyphCache( new GlyphCache )
 #if defined( CINDER_MSW )
 	, mHfont( 0 )
 #endif
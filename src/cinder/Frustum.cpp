@@ -25,6 +25,9 @@
 
 #include "cinder/Frustum.h"
 
+#include <algorithm>
+#include <vector>
+
 #if defined( CINDER_MSW )
 	#undef NEAR
 	#undef FAR
@@ -32,6 +35,63 @@
 
 namespace cinder {
 
+namespace {
+
+inline void clearVisibility( uint32_t *visibility, size_t count )
+{
+	std::fill( visibility, visibility + ( count + 31 ) / 32, 0u );
+}
+
+inline void setVisible( uint32_t *visibility, size_t i )
+{
+	visibility[i / 32] |= 1u << ( i % 32 );
+}
+
+// evaluates the planes in the same order as Plane::distance() and Frustum::intersects(), so that the batch tests agree with them
+template<typename T>
+bool isSphereVisible( const Plane<T> planes[6], T x, T y, T z, T radius )
+{
+	for( int p = 0; p < 6; ++p ) {
+		const Vec3<T> &n = planes[p].getNormal();
+		if( n.x * x + n.y * y + n.z * z - planes[p].mDistance < -radius )
+			return false;
+	}
+	return true;
+}
+
+// tests the corner of the box farthest along each plane's normal, as AxisAlignedBox3f::getPositive() does
+template<typename T>
+bool isBoxVisible( const Plane<T> planes[6], const T *minX, const T *minY, const T *minZ, const T *maxX, const T *maxY, const T *maxZ, size_t i )
+{
+	for( int p = 0; p < 6; ++p ) {
+		const Vec3<T> &n = planes[p].getNormal();
+		T x = ( n.x > 0 ) ? maxX[i] : minX[i];
+		T y = ( n.y > 0 ) ? maxY[i] : minY[i];
+		T z = ( n.z > 0 ) ? maxZ[i] : minZ[i];
+		if( n.x * x + n.y * y + n.z * z - planes[p].mDistance < 0 )
+			return false;
+	}
+	return true;
+}
+
+#if defined( CINDER_SIMD_MATH_SSE )
+// returns a 4 bit mask of the lanes in which \a a is less than \a b
+inline uint32_t lessMask( __m128 a, __m128 b )
+{
+	return (uint32_t)_mm_movemask_ps( _mm_cmplt_ps( a, b ) );
+}
+#elif defined( CINDER_SIMD_MATH_NEON )
+inline uint32_t lessMask( float32x4_t a, float32x4_t b )
+{
+	static const uint32_t laneBits[4] = { 1, 2, 4, 8 };
+	uint32x4_t bits = vandq_u32( vcltq_f32( a, b ), vld1q_u32( laneBits ) );
+	uint32x2_t sum = vpadd_u32( vget_low_u32( bits ), vget_high_u32( bits ) );
+	return vget_lane_u32( vpadd_u32( sum, sum ), 0 );
+}
+#endif
+
+} // anonymous namespace
+
 template<typename T>
 Frustum<T>::Frustum( const Camera &cam )
 {
@@ -138,6 +198,144 @@ bool Frustum<T>::intersects( const AxisAlignedBox3f &box ) const
 	return true;
 }
 
+template<typename T>
+void Frustum<T>::intersects( const T *centerX, const T *centerY, const T *centerZ, const T *radius, size_t count, uint32_t *visibility ) const
+{
+	clearVisibility( visibility, count );
+	for( size_t i = 0; i < count; ++i ) {
+		if( isSphereVisible( mFrustumPlanes, centerX[i], centerY[i], centerZ[i], radius[i] ) )
+			setVisible( visibility, i );
+	}
+}
+
+template<typename T>
+void Frustum<T>::intersects( const T *minX, const T *minY, const T *minZ, const T *maxX, const T *maxY, const T *maxZ, size_t count, uint32_t *visibility ) const
+{
+	clearVisibility( visibility, count );
+	for( size_t i = 0; i < count; ++i ) {
+		if( isBoxVisible( mFrustumPlanes, minX, minY, minZ, maxX, maxY, maxZ, i ) )
+			setVisible( visibility, i );
+	}
+}
+
+template<>
+void Frustum<float>::intersects( const float *centerX, const float *centerY, const float *centerZ, const float *radius, size_t count, uint32_t *visibility ) const
+{
+	clearVisibility( visibility, count );
+	size_t i = 0;
+#if defined( CINDER_SIMD_MATH )
+	using namespace detail;
+	SimdFloat4 nx[6], ny[6], nz[6], d[6];
+	for( int p = 0; p < 6; ++p ) {
+		nx[p] = simdSplat( mFrustumPlanes[p].mNormal.x );
+		ny[p] = simdSplat( mFrustumPlanes[p].mNormal.y );
+		nz[p] = simdSplat( mFrustumPlanes[p].mNormal.z );
+		d[p] = simdSplat( mFrustumPlanes[p].mDistance );
+	}
+	for( ; i + 4 <= count; i += 4 ) {
+		const SimdFloat4 x = simdLoad( centerX + i ), y = simdLoad( centerY + i ), z = simdLoad( centerZ + i );
+		const SimdFloat4 negRadius = simdNegate( simdLoad( radius + i ) );
+		uint32_t outside = 0;
+		for( int p = 0; p < 6; ++p ) {
+			const SimdFloat4 dist = simdSub( simdAdd( simdAdd( simdMul( nx[p], x ), simdMul( ny[p], y ) ), simdMul( nz[p], z ) ), d[p] );
+			outside |= lessMask( dist, negRadius );
+		}
+		// i is a multiple of 4, so the four bits never straddle two words
+		visibility[i / 32] |= ( ~outside & 0xF ) << ( i % 32 );
+	}
+#endif
+	for( ; i < count; ++i ) {
+		if( isSphereVisible( mFrustumPlanes, centerX[i], centerY[i], centerZ[i], radius[i] ) )
+			setVisible( visibility, i );
+	}
+}
+
+template<>
+void Frustum<float>::intersects( const float *minX, const float *minY, const float *minZ, const float *maxX, const float *maxY, const float *maxZ, size_t count, uint32_t *visibility ) const
+{
+	clearVisibility( visibility, count );
+	size_t i = 0;
+#if defined( CINDER_SIMD_MATH )
+	using namespace detail;
+	SimdFloat4 nx[6], ny[6], nz[6], d[6];
+	const float *cornerX[6], *cornerY[6], *cornerZ[6];
+	for( int p = 0; p < 6; ++p ) {
+		const Vec3f &n = mFrustumPlanes[p].mNormal;
+		nx[p] = simdSplat( n.x );
+		ny[p] = simdSplat( n.y );
+		nz[p] = simdSplat( n.z );
+		d[p] = simdSplat( mFrustumPlanes[p].mDistance );
+		// the farthest corner along a plane's normal is the same for every box
+		cornerX[p] = ( n.x > 0 ) ? maxX : minX;
+		cornerY[p] = ( n.y > 0 ) ? maxY : minY;
+		cornerZ[p] = ( n.z > 0 ) ? maxZ : minZ;
+	}
+	const SimdFloat4 zero = simdSplat( 0 );
+	for( ; i + 4 <= count; i += 4 ) {
+		uint32_t outside = 0;
+		for( int p = 0; p < 6; ++p ) {
+			const SimdFloat4 dist = simdSub( simdAdd( simdAdd( simdMul( nx[p], simdLoad( cornerX[p] + i ) ), simdMul( ny[p], simdLoad( cornerY[p] + i ) ) ), simdMul( nz[p], simdLoad( cornerZ[p] + i ) ) ), d[p] );
+			outside |= lessMask( dist, zero );
+		}
+		visibility[i / 32] |= ( ~outside & 0xF ) << ( i % 32 );
+	}
+#endif
+	for( ; i < count; ++i ) {
+		if( isBoxVisible( mFrustumPlanes, minX, minY, minZ, maxX, maxY, maxZ, i ) )
+			setVisible( visibility, i );
+	}
+}
+
+template<typename T>
+typename Frustum<T>::Visibility Frustum<T>::classify( const AxisAlignedBox3f &box, uint8_t *planeMask, uint8_t *cachedPlane ) const
+{
+	const Vec3f &boxMin = box.getMin(), &boxMax = box.getMax();
+	const int first = ( cachedPlane && ( *cachedPlane < 6 ) ) ? *cachedPlane : 0;
+	for( int k = 0; k < 6; ++k ) {
+		const int p = ( first + k ) % 6;
+		if( ! ( *planeMask & ( 1 << p ) ) )
+			continue;
+
+		// the corners farthest along and against the plane's normal
+		const Vec3<T> &n = mFrustumPlanes[p].getNormal();
+		const Vec3f positive( ( n.x > 0 ) ? boxMax.x : boxMin.x, ( n.y > 0 ) ? boxMax.y : boxMin.y, ( n.z > 0 ) ? boxMax.z : boxMin.z );
+		const Vec3f negative( ( n.x > 0 ) ? boxMin.x : boxMax.x, ( n.y > 0 ) ? boxMin.y : boxMax.y, ( n.z > 0 ) ? boxMin.z : boxMax.z );
+		if( mFrustumPlanes[p].distance( positive ) < 0 ) {
+			if( cachedPlane )
+				*cachedPlane = (uint8_t)p;
+			return OUTSIDE;
+		}
+		if( mFrustumPlanes[p].distance( negative ) >= 0 )
+			*planeMask &= ~( 1 << p );
+	}
+
+	return ( *planeMask == 0 ) ? INSIDE : INTERSECTS;
+}
+
+template<typename T>
+void Frustum<T>::cullHierarchy( const AxisAlignedBox3f *boxes, const uint32_t *firstChild, const uint32_t *numChildren, size_t count, uint32_t *visibility, uint8_t *planeCache ) const
+{
+	clearVisibility( visibility, count );
+	if( count == 0 )
+		return;
+
+	// depth-first, carrying the planes each box's parent straddles
+	std::vector<std::pair<uint32_t,uint8_t> > stack;
+	stack.push_back( std::make_pair( 0u, (uint8_t)0x3F ) );
+	while( ! stack.empty() ) {
+		const uint32_t box = stack.back().first;
+		uint8_t planeMask = stack.back().second;
+		stack.pop_back();
+
+		// an empty mask means the parent was entirely inside
+		if( ( planeMask != 0 ) && ( classify( boxes[box], &planeMask, ( planeCache ) ? &planeCache[box] : NULL ) == OUTSIDE ) )
+			continue;
+		setVisible( visibility, box );
+		for( uint32_t c = 0; c < numChildren[box]; ++c )
+			stack.push_back( std::make_pair( firstChild[box] + c, planeMask ) );
+	}
+}
+
 template class Frustum<float>;
 template class Frustum<double>;
 
@@ -0,0 +1,264 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ImageFileRaw.h"
+#include "cinder/DataSource.h"
+#include "cinder/DataTarget.h"
+#include "cinder/Stream.h"
+#include "cinder/Utilities.h"
+
+#include <zlib.h>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder {
+
+namespace { // anonymous namespace
+
+const uint32_t	RAW_VERSION = 1;
+const size_t	RAW_HEADER_SIZE = 64;
+
+typedef enum { COMPRESSION_NONE = 0, COMPRESSION_ZLIB = 1 } Compression;
+
+// The header is stored little-endian and is followed by dataSize bytes which are either the rows, rowBytes apart, or their zlib stream
+struct RawHeader {
+	RawHeader() : mWidth( 0 ), mHeight( 0 ), mRowBytes( 0 ), mDataType( ImageIo::UINT8 ), mColorModel( ImageIo::CM_RGB ), mChannelOrder( ImageIo::RGB ),
+		mPremultiplied( false ), mCompression( COMPRESSION_NONE ), mDataSize( 0 ) {}
+
+	void	write( uint8_t *dest ) const;
+	bool	read( const uint8_t *src, size_t size );
+
+	int32_t				mWidth, mHeight, mRowBytes;
+	ImageIo::DataType		mDataType;
+	ImageIo::ColorModel		mColorModel;
+	ImageIo::ChannelOrder	mChannelOrder;
+	bool				mPremultiplied;
+	Compression			mCompression;
+	uint64_t			mDataSize;
+};
+
+void writeLe( uint8_t *dest, uint64_t value, int bytes )
+{
+	for( int b = 0; b < bytes; ++b )
+		dest[b] = (uint8_t)( value >> ( b * 8 ) );
+}
+
+uint64_t readLe( const uint8_t *src, int bytes )
+{
+	uint64_t result = 0;
+	for( int b = 0; b < bytes; ++b )
+		result |= (uint64_t)src[b] << ( b * 8 );
+	return result;
+}
+
+void RawHeader::write( uint8_t *dest ) const
+{
+	memset( dest, 0, RAW_HEADER_SIZE );
+	memcpy( dest, "CIRW", 4 );
+	writeLe( dest + 4, RAW_VERSION, 4 );
+	writeLe( dest + 8, (uint32_t)mWidth, 4 );
+	writeLe( dest + 12, (uint32_t)mHeight, 4 );
+	writeLe( dest + 16, (uint32_t)mRowBytes, 4 );
+	dest[20] = (uint8_t)mDataType;
+	dest[21] = (uint8_t)mColorModel;
+	dest[22] = (uint8_t)mChannelOrder;
+	dest[23] = mPremultiplied ? 1 : 0;
+	dest[24] = (uint8_t)mCompression;
+	writeLe( dest + 32, mDataSize, 8 );
+}
+
+bool RawHeader::read( const uint8_t *src, size_t size )
+{
+	if( size < RAW_HEADER_SIZE || memcmp( src, "CIRW", 4 ) || readLe( src + 4, 4 ) != RAW_VERSION )
+		return false;
+	mWidth = (int32_t)readLe( src + 8, 4 );
+	mHeight = (int32_t)readLe( src + 12, 4 );
+	mRowBytes = (int32_t)readLe( src + 16, 4 );
+	if( src[20] >= ImageIo::DATA_UNKNOWN || src[21] >= ImageIo::CM_UNKNOWN || src[22] >= ImageIo::CUSTOM || src[24] > COMPRESSION_ZLIB )
+		return false;
+	mDataType = (ImageIo::DataType)src[20];
+	mColorModel = (ImageIo::ColorModel)src[21];
+	mChannelOrder = (ImageIo::ChannelOrder)src[22];
+	mPremultiplied = src[23] != 0;
+	mCompression = (Compression)src[24];
+	mDataSize = readLe( src + 32, 8 );
+
+	if( mWidth <= 0 || mHeight <= 0 || mRowBytes < mWidth * ImageIo::channelOrderNumChannels( mChannelOrder ) * ImageIo::dataTypeBytes( mDataType ) )
+		return false;
+	if( mCompression == COMPRESSION_NONE && mDataSize != (uint64_t)mRowBytes * mHeight )
+		return false;
+	return mDataSize <= size - RAW_HEADER_SIZE;
+}
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// ImageSourceFileRaw
+void ImageSourceFileRaw::registerSelf()
+{
+	const int32_t SOURCE_PRIORITY = 2;
+
+	ImageIoRegistrar::SourceCreationFunc sourceFunc = ImageSourceFileRaw::createSourceRef;
+	ImageIoRegistrar::registerSourceType( "csurf", sourceFunc, SOURCE_PRIORITY );
+	ImageIoRegistrar::registerSourceType( "csurfz", sourceFunc, SOURCE_PRIORITY );
+}
+
+ImageSourceFileRawRef ImageSourceFileRaw::createRef( DataSourceRef dataSourceRef, ImageSource::Options options )
+{
+	return ImageSourceFileRawRef( new ImageSourceFileRaw( dataSourceRef, options ) );
+}
+
+ImageSourceFileRaw::ImageSourceFileRaw( DataSourceRef dataSourceRef, ImageSource::Options /*options*/ )
+	: ImageSource(), mData( 0 ), mRowBytes( 0 )
+{
+	const uint8_t *fileData = 0;
+	size_t fileSize = 0;
+	if( dataSourceRef->isFilePath() )
+		mMapping = mapFile( dataSourceRef->getFilePath(), &fileSize );
+	if( mMapping )
+		fileData = reinterpret_cast<const uint8_t*>( mMapping.get() );
+	else {
+		mBuffer = dataSourceRef->getBuffer();
+		fileData = reinterpret_cast<const uint8_t*>( mBuffer.getData() );
+		fileSize = mBuffer.getDataSize();
+	}
+
+	RawHeader header;
+	if( ! header.read( fileData, fileSize ) )
+		throw ImageSourceFileRawException();
+
+	setSize( header.mWidth, header.mHeight );
+	setDataType( header.mDataType );
+	setColorModel( header.mColorModel );
+	setChannelOrder( header.mChannelOrder );
+	setPremultiplied( header.mPremultiplied );
+	mRowBytes = header.mRowBytes;
+
+	if( header.mCompression == COMPRESSION_NONE )
+		mData = fileData + RAW_HEADER_SIZE;
+	else {
+		Buffer decompressed( (size_t)mRowBytes * mHeight );
+		uLongf destSize = (uLongf)decompressed.getDataSize();
+		if( ( ::uncompress( (Bytef*)decompressed.getData(), &destSize, (const Bytef*)( fileData + RAW_HEADER_SIZE ), (uLong)header.mDataSize ) != Z_OK )
+				|| ( destSize != decompressed.getDataSize() ) )
+			throw ImageSourceFileRawException();
+		// the decompressed copy replaces the mapping or the DataSource's buffer as our storage
+		mMapping.reset();
+		mBuffer = decompressed;
+		mData = reinterpret_cast<const uint8_t*>( mBuffer.getData() );
+	}
+}
+
+void ImageSourceFileRaw::load( ImageTargetRef target )
+{
+	// get a pointer to the ImageSource function appropriate for handling our data configuration
+	ImageSource::RowFunc func = setupRowFunc( target );
+
+	const uint8_t *data = mData;
+	for( int32_t row = 0; row < mHeight; ++row ) {
+		((*this).*func)( target, row, data );
+		data += mRowBytes;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ImageTargetFileRaw
+void ImageTargetFileRaw::registerSelf()
+{
+	const int32_t TARGET_PRIORITY = 2;
+
+	ImageIoRegistrar::TargetCreationFunc targetFunc = ImageTargetFileRaw::createRef;
+	ImageIoRegistrar::registerTargetType( "csurf", targetFunc, TARGET_PRIORITY, "raw" );
+	ImageIoRegistrar::registerTargetType( "csurfz", targetFunc, TARGET_PRIORITY, "zlib" );
+}
+
+ImageTargetRef ImageTargetFileRaw::createRef( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const string &extensionData )
+{
+	return ImageTargetRef( new ImageTargetFileRaw( dataTarget, imageSource, options, extensionData ) );
+}
+
+ImageTargetFileRaw::ImageTargetFileRaw( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const string &extensionData )
+	: ImageTarget(), mDataTarget( dataTarget ), mPremultiplied( imageSource->isPremultiplied() ), mCompress( extensionData == "zlib" )
+{
+	setSize( imageSource->getWidth(), imageSource->getHeight() );
+
+	// store the source's own layout wherever it is one we can describe so that loading is a straight copy
+	ImageIo::ColorModel cm = options.isColorModelDefault() ? imageSource->getColorModel() : options.getColorModel();
+	if( cm == ImageIo::CM_UNKNOWN )
+		cm = ImageIo::CM_RGB;
+	setColorModel( cm );
+	setDataType( ( imageSource->getDataType() == ImageIo::DATA_UNKNOWN ) ? ImageIo::UINT8 : imageSource->getDataType() );
+
+	ImageIo::ChannelOrder order = imageSource->getChannelOrder();
+	bool orderIsGray = ( order == ImageIo::Y ) || ( order == ImageIo::YA );
+	if( ( order == ImageIo::CUSTOM ) || ( orderIsGray != ( cm == ImageIo::CM_GRAY ) ) ) {
+		if( cm == ImageIo::CM_GRAY )
+			order = imageSource->hasAlpha() ? ImageIo::YA : ImageIo::Y;
+		else
+			order = imageSource->hasAlpha() ? ImageIo::RGBA : ImageIo::RGB;
+	}
+	setChannelOrder( order );
+
+	// pad rows to 16 bytes so they can be handed straight to SIMD code once loaded
+	mRowBytes = ( mWidth * ImageIo::channelOrderNumChannels( order ) * ImageIo::dataTypeBytes( getDataType() ) + 15 ) & ~15;
+	mData = Buffer( (size_t)mRowBytes * mHeight );
+	memset( mData.getData(), 0, mData.getDataSize() );
+}
+
+void* ImageTargetFileRaw::getRowPointer( int32_t row )
+{
+	return reinterpret_cast<uint8_t*>( mData.getData() ) + row * mRowBytes;
+}
+
+void ImageTargetFileRaw::finalize()
+{
+	RawHeader header;
+	header.mWidth = mWidth;
+	header.mHeight = mHeight;
+	header.mRowBytes = mRowBytes;
+	header.mDataType = getDataType();
+	header.mColorModel = getColorModel();
+	header.mChannelOrder = getChannelOrder();
+	header.mPremultiplied = mPremultiplied;
+
+	Buffer payload = mData;
+	if( mCompress ) {
+		uLongf compressedSize = ::compressBound( (uLong)mData.getDataSize() );
+		payload = Buffer( (size_t)compressedSize );
+		if( ::compress2( (Bytef*)payload.getData(), &compressedSize, (const Bytef*)mData.getData(), (uLong)mData.getDataSize(), Z_BEST_SPEED ) != Z_OK )
+			throw ImageIoExceptionFailedWrite();
+		payload.setDataSize( (size_t)compressedSize );
+		header.mCompression = COMPRESSION_ZLIB;
+	}
+	header.mDataSize = payload.getDataSize();
+
+	uint8_t headerBytes[RAW_HEADER_SIZE];
+	header.write( headerBytes );
+	OStreamRef stream = mDataTarget->getStream();
+	stream->writeData( headerBytes, RAW_HEADER_SIZE );
+	stream->writeData( payload.getData(), payload.getDataSize() );
+}
+
+} // namespace cinder
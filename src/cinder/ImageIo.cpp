@@ -21,11 +21,25 @@
 */
 
 #include "cinder/ImageIo.h"
+#include "cinder/Profiler.h"
 #include "cinder/Utilities.h"
+#include "cinder/Thread.h"
+#include "cinder/Function.h"
+#include "cinder/ip/ChannelShuffle.h"
+#include "cinder/ip/Simd.h"
 
 #include <boost/type_traits/is_same.hpp>
 #include <cctype>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
 
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#endif
+
+#include "cinder/ImageFileRaw.h" // this is necessary to force the instantiation of the IMAGEIO_REGISTER macro
+#include "cinder/ImageTargetFilePng.h" // this is necessary to force the instantiation of the IMAGEIO_REGISTER macro
 #if defined( CINDER_MSW )
 	#include "cinder/ImageSourceFileWic.h" // this is necessary to force the instantiation of the IMAGEIO_REGISTER macro
 	#include "cinder/ImageTargetFileWic.h" // this is necessary to force the instantiation of the IMAGEIO_REGISTER macro
@@ -150,6 +164,58 @@ bool ImageSource::isPremultiplied() const
 	return mIsPremultiplied;
 }
 
+Vec2i ImageSource::Options::calcReducedSize( const Vec2i &fullSize ) const
+{
+	if( ( mTargetSize.x <= 0 && mTargetSize.y <= 0 ) || ( fullSize.x <= 0 ) || ( fullSize.y <= 0 ) )
+		return fullSize;
+
+	// the larger of the two scales ensures both dimensions cover the target
+	double scale = std::max( mTargetSize.x / (double)fullSize.x, mTargetSize.y / (double)fullSize.y );
+	if( scale >= 1 )
+		return fullSize;
+	return Vec2i( std::max<int32_t>( 1, (int32_t)ceil( fullSize.x * scale ) ), std::max<int32_t>( 1, (int32_t)ceil( fullSize.y * scale ) ) );
+}
+
+namespace {
+
+// Converts \a count values of a row whose source and target layouts match
+template<typename SD, typename TD>
+void convertRow( const SD *src, TD *dst, int32_t count )
+{
+	for( int32_t i = 0; i < count; ++i )
+		dst[i] = CHANTRAIT<TD>::convert( src[i] );
+}
+
+template<typename T>
+void convertRow( const T *src, T *dst, int32_t count )
+{
+	memcpy( dst, src, count * sizeof(T) );
+}
+
+void convertRow( const uint8_t *src, float *dst, int32_t count )
+{
+	int32_t i = 0;
+#if defined( CINDER_IP_SSE2 )
+	if( ip::useSse2() ) {
+		// dividing rather than multiplying by the reciprocal matches CHANTRAIT<float>::convert() exactly
+		const __m128i zero = _mm_setzero_si128();
+		const __m128 maxValue = _mm_set1_ps( 255.0f );
+		for( ; i + 16 <= count; i += 16 ) {
+			const __m128i bytes = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+			const __m128i lo = _mm_unpacklo_epi8( bytes, zero ), hi = _mm_unpackhi_epi8( bytes, zero );
+			_mm_storeu_ps( dst + i, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( lo, zero ) ), maxValue ) );
+			_mm_storeu_ps( dst + i + 4, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( lo, zero ) ), maxValue ) );
+			_mm_storeu_ps( dst + i + 8, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpacklo_epi16( hi, zero ) ), maxValue ) );
+			_mm_storeu_ps( dst + i + 12, _mm_div_ps( _mm_cvtepi32_ps( _mm_unpackhi_epi16( hi, zero ) ), maxValue ) );
+		}
+	}
+#endif
+	for( ; i < count; ++i )
+		dst[i] = CHANTRAIT<float>::convert( src[i] );
+}
+
+} // anonymous namespace
+
 /* SD - source data type, TD - target data type, TCM - target color model */
 template<typename SD, typename TD, ImageIo::ColorModel TCM, bool ALPHA>
 void ImageSource::rowFuncSourceRgb( ImageTargetRef target, int32_t row, const void *data )
@@ -254,6 +320,54 @@ void ImageSource::rowFuncSourceGray( ImageTargetRef target, int32_t row, const v
 	}
 }
 
+template<typename SD, typename TD>
+void ImageSource::rowFuncSameLayout( ImageTargetRef target, int32_t row, const void *data )
+{
+	convertRow( reinterpret_cast<const SD*>( data ), reinterpret_cast<TD*>( target->getRowPointer( row ) ), getWidth() * mRowFuncSourceInc );
+}
+
+void ImageSource::rowFuncShuffle8u( ImageTargetRef target, int32_t row, const void *data )
+{
+	mRowFuncShuffle->apply( reinterpret_cast<const uint8_t*>( data ), reinterpret_cast<uint8_t*>( target->getRowPointer( row ) ), getWidth() );
+}
+
+bool ImageSource::isRowLayoutUnchanged( ColorModel targetColorModel ) const
+{
+	if( ( mColorModel != targetColorModel ) || ( mRowFuncSourceInc != mRowFuncTargetInc ) || ( mRowFuncSourceAlpha != mRowFuncTargetAlpha ) )
+		return false;
+
+	// every value of a pixel has to be a channel, or the padding byte of an order like RGBX, or it would overwrite something in the target
+	if( mColorModel == CM_RGB ) {
+		if( ( mRowFuncSourceRed != mRowFuncTargetRed ) || ( mRowFuncSourceGreen != mRowFuncTargetGreen ) || ( mRowFuncSourceBlue != mRowFuncTargetBlue ) )
+			return false;
+		return ( mRowFuncSourceInc == ( ( mRowFuncSourceAlpha == -1 ) ? 3 : 4 ) ) || ( ( mRowFuncSourceInc == 4 ) && ( mCustomPixelInc == 0 ) );
+	}
+	else {
+		if( mRowFuncSourceGray != mRowFuncTargetGray )
+			return false;
+		return mRowFuncSourceInc == ( ( mRowFuncSourceAlpha == -1 ) ? 1 : 2 );
+	}
+}
+
+void ImageSource::setupRowFuncShuffle( ColorModel targetColorModel, bool alpha )
+{
+	mRowFuncShuffle = std::shared_ptr<ip::ChannelShuffle>( new ip::ChannelShuffle( mRowFuncSourceInc, mRowFuncTargetInc ) );
+	if( mColorModel == CM_RGB ) {
+		mRowFuncShuffle->copy( mRowFuncTargetRed, mRowFuncSourceRed );
+		mRowFuncShuffle->copy( mRowFuncTargetGreen, mRowFuncSourceGreen );
+		mRowFuncShuffle->copy( mRowFuncTargetBlue, mRowFuncSourceBlue );
+	}
+	else if( targetColorModel == CM_RGB ) {
+		mRowFuncShuffle->copy( mRowFuncTargetRed, mRowFuncSourceGray );
+		mRowFuncShuffle->copy( mRowFuncTargetGreen, mRowFuncSourceGray );
+		mRowFuncShuffle->copy( mRowFuncTargetBlue, mRowFuncSourceGray );
+	}
+	else
+		mRowFuncShuffle->copy( mRowFuncTargetGray, mRowFuncSourceGray );
+	if( alpha )
+		mRowFuncShuffle->copy( mRowFuncTargetAlpha, mRowFuncSourceAlpha );
+}
+
 void ImageSource::setupRowFuncRgbSource( ImageTargetRef target )
 {
 	translateRgbColorModelToOffsets( mChannelOrder, &mRowFuncSourceRed, &mRowFuncSourceGreen, &mRowFuncSourceBlue, &mRowFuncSourceAlpha, &mRowFuncSourceInc );
@@ -281,7 +395,14 @@ ImageSource::RowFunc ImageSource::setupRowFuncForTypesAndTargetColorModel( Image
 			if( mCustomPixelInc != 0 )
 				mRowFuncSourceInc = mCustomPixelInc;
 			bool alpha = ( mRowFuncSourceAlpha != -1 ) && ( mRowFuncTargetAlpha != -1 );
-			if( alpha )
+			// the common 8 bit conversions skip the per channel offsets in favor of SIMD; RGB to gray still needs the luma math
+			if( isRowLayoutUnchanged( TCM ) )
+				return &ImageSource::rowFuncSameLayout<SD,TD>;
+			else if( boost::is_same<SD,uint8_t>::value && boost::is_same<TD,uint8_t>::value && ( TCM == CM_RGB ) && ( mRowFuncSourceInc <= 4 ) ) {
+				setupRowFuncShuffle( TCM, alpha );
+				return &ImageSource::rowFuncShuffle8u;
+			}
+			else if( alpha )
 				return &ImageSource::rowFuncSourceRgb<SD,TD,TCM,true>;
 			else
 				return &ImageSource::rowFuncSourceRgb<SD,TD,TCM,false>;
@@ -292,7 +413,13 @@ ImageSource::RowFunc ImageSource::setupRowFuncForTypesAndTargetColorModel( Image
 			if( mCustomPixelInc != 0 )
 				mRowFuncSourceInc = mCustomPixelInc;
 			bool alpha = ( mRowFuncSourceAlpha != -1 ) && ( mRowFuncTargetAlpha != -1 );
-			if( alpha )
+			if( isRowLayoutUnchanged( TCM ) )
+				return &ImageSource::rowFuncSameLayout<SD,TD>;
+			else if( boost::is_same<SD,uint8_t>::value && boost::is_same<TD,uint8_t>::value && ( mRowFuncSourceInc <= 4 ) ) {
+				setupRowFuncShuffle( TCM, alpha );
+				return &ImageSource::rowFuncShuffle8u;
+			}
+			else if( alpha )
 				return &ImageSource::rowFuncSourceGray<SD,TD,TCM,true>;
 			else
 				return &ImageSource::rowFuncSourceGray<SD,TD,TCM,false>;
@@ -360,7 +487,7 @@ ImageSource::RowFunc ImageSource::setupRowFunc( ImageTargetRef target )
 ///////////////////////////////////////////////////////////////////////////////
 ImageSourceRef loadImage( const fs::path &path, ImageSource::Options options, string extension )
 {
-	return loadImage( (DataSourceRef)DataSourcePath::create( path ), options, extension );
+	return loadImage( (DataSourceRef)DataSourceMmap::create( path ), options, extension );
 }
 
 ImageSourceRef loadImage( DataSourceRef dataSource, ImageSource::Options options, string extension )
@@ -404,12 +531,112 @@ void writeImage( ImageTargetRef imageTarget, const ImageSourceRef &imageSource )
 }
 
 ///////////////////////////////////////////////////////////////////////////////
+// AsyncImageWrite
+struct AsyncImageWrite::Obj {
+	Obj() : mReady( false ), mFailed( false ) {}
+
+	std::mutex				mMutex;
+	std::condition_variable	mReadyCond;
+	bool					mReady, mFailed;
+};
+
+AsyncImageWrite::AsyncImageWrite()
+	: mObj( new Obj )
+{
+}
+
+bool AsyncImageWrite::isReady() const
+{
+	std::lock_guard<std::mutex> lock( mObj->mMutex );
+	return mObj->mReady;
+}
+
+bool AsyncImageWrite::hasFailed() const
+{
+	std::lock_guard<std::mutex> lock( mObj->mMutex );
+	return mObj->mReady && mObj->mFailed;
+}
+
+void AsyncImageWrite::wait() const
+{
+	std::unique_lock<std::mutex> lock( mObj->mMutex );
+	while( ! mObj->mReady )
+		mObj->mReadyCond.wait( lock );
+}
+
+void AsyncImageWrite::threadFn( AsyncImageWriteRef result, DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, string extension )
+{
+	ThreadSetup threadSetup;
+
+	bool failed = false;
+	try {
+		writeImage( dataTarget, imageSource, options, extension );
+	}
+	catch( ... ) {
+		failed = true;
+	}
+
+	std::lock_guard<std::mutex> lock( result->mObj->mMutex );
+	result->mObj->mReady = true;
+	result->mObj->mFailed = failed;
+	result->mObj->mReadyCond.notify_all();
+}
+
+AsyncImageWriteRef writeImageAsync( DataTargetRef dataTarget, const ImageSourceRef &imageSource, ImageTarget::Options options, string extension )
+{
+	AsyncImageWriteRef result( new AsyncImageWrite );
+	std::thread writeThread( std::bind( &AsyncImageWrite::threadFn, result, dataTarget, imageSource, options, extension ) );
+	writeThread.detach();
+	return result;
+}
+
+AsyncImageWriteRef writeImageAsync( const fs::path &path, const ImageSourceRef &imageSource, ImageTarget::Options options, string extension )
+{
+	return writeImageAsync( (DataTargetRef)writeFile( path ), imageSource, options, extension );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+namespace {
+
+// pointers to navigate around static init issues, since handlers are deferred during static initialization
+vector<void(*)()>& getDeferredRegistrations()
+{
+	static vector<void(*)()> *sRegistrations = new vector<void(*)()>;
+	return *sRegistrations;
+}
+
+std::recursive_mutex& getRegistrarMutex()
+{
+	static std::recursive_mutex *sMutex = new std::recursive_mutex;
+	return *sMutex;
+}
+
+} // anonymous namespace
+
+void ImageIoRegistrar::deferRegistration( void (*registerFn)() )
+{
+	std::lock_guard<std::recursive_mutex> lock( getRegistrarMutex() );
+	getDeferredRegistrations().push_back( registerFn );
+}
+
 ImageIoRegistrar::Inst* ImageIoRegistrar::instance()
 {
 	static shared_ptr<Inst> sInst;
+	std::lock_guard<std::recursive_mutex> lock( getRegistrarMutex() );
 	if( ! sInst ) {
 		sInst = shared_ptr<Inst>( new ImageIoRegistrar::Inst );
 	}
+
+	// the deferred handlers register themselves through instance(), which the recursive mutex allows
+	if( ! getDeferredRegistrations().empty() ) {
+		double start = Profiler::get().getSeconds();
+		vector<void(*)()> registrations;
+		registrations.swap( getDeferredRegistrations() );
+		for( vector<void(*)()>::const_iterator regIt = registrations.begin(); regIt != registrations.end(); ++regIt )
+			(**regIt)();
+		Profiler::get().addInitialization( "ImageIo handlers", start, Profiler::get().getSeconds() );
+	}
+
 	return sInst.get();
 }
 
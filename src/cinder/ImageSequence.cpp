@@ -0,0 +1,251 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/ImageSequence.h"
+#include "cinder/ImageIo.h"
+
+#include <algorithm>
+
+namespace cinder {
+
+ImageSequenceRef ImageSequence::create( const fs::path &directory, float framesPerSecond, int32_t numPrefetchFrames, const JobSystemRef &jobSystem )
+{
+	if( ! fs::is_directory( directory ) )
+		throw ImageSequenceException();
+
+	std::vector<fs::path> paths;
+	for( fs::directory_iterator fileIt( directory ); fileIt != fs::directory_iterator(); ++fileIt ) {
+		if( ( ! fs::is_regular_file( fileIt->path() ) ) || ( fileIt->path().filename().string()[0] == '.' ) )
+			continue;
+		paths.push_back( fileIt->path() );
+	}
+	std::sort( paths.begin(), paths.end() );
+
+	return create( paths, framesPerSecond, numPrefetchFrames, jobSystem );
+}
+
+ImageSequence::ImageSequence( const std::vector<fs::path> &paths, float framesPerSecond, int32_t numPrefetchFrames, const JobSystemRef &jobSystem )
+	: mPaths( paths ), mJobSystem( jobSystem ), mSlots( std::max<int32_t>( numPrefetchFrames, 1 ) ), mFramesPerSecond( framesPerSecond ), mLoop( true ), mLatePolicy( LATE_DROP ),
+	mTimer( false ), mClockStart( 0 ), mPosition( 0 ), mPresented( false ), mHeldPosition( -1 ), mTextureDirty( false ), mNumDroppedFrames( 0 ), mNumHeldFrames( 0 )
+{
+	if( mPaths.empty() || ( ! mJobSystem ) )
+		throw ImageSequenceException();
+
+	// resized once the first frame's dimensions are known
+	mSurfacePool = SurfacePool::create();
+
+	prefetch();
+}
+
+ImageSequence::~ImageSequence()
+{
+	waitForJobs();
+}
+
+void ImageSequence::waitForJobs()
+{
+	std::vector<JobSystem::JobRef> jobs;
+	mMutex.lock();
+		for( std::vector<Slot>::const_iterator slotIt = mSlots.begin(); slotIt != mSlots.end(); ++slotIt ) {
+			if( slotIt->mJob )
+				jobs.push_back( slotIt->mJob );
+		}
+	mMutex.unlock();
+
+	mJobSystem->wait( jobs );
+}
+
+bool ImageSequence::update()
+{
+	bool playing = ! mTimer.isStopped();
+	int64_t first = mPresented ? ( mPosition + 1 ) : mPosition;
+	int64_t target = playing ? getClockPosition() : mPosition;
+	if( ! mLoop )
+		target = std::min( target, getLastPosition() );
+	// LATE_HOLD never skips ahead of the frame after the current one
+	if( mLatePolicy == LATE_HOLD )
+		target = std::min( target, first );
+
+	bool changed = false;
+	mMutex.lock();
+		// the latest decoded frame which is due
+		Slot *due = 0;
+		for( std::vector<Slot>::iterator slotIt = mSlots.begin(); slotIt != mSlots.end(); ++slotIt ) {
+			if( slotIt->mReady && ( slotIt->mPosition >= first ) && ( slotIt->mPosition <= target ) && ( ( ! due ) || ( slotIt->mPosition > due->mPosition ) ) )
+				due = &*slotIt;
+		}
+
+		if( due ) {
+			mNumDroppedFrames += (uint32_t)( due->mPosition - first );
+			// a frame which failed to decode leaves the previous one showing
+			if( due->mSurface ) {
+				if( ! mSurface )
+					mSurfacePool->setMaxCachedBytes( ( mSlots.size() + 2 ) * due->mSurface.getRowBytes() * due->mSurface.getHeight() );
+				mSurface = due->mSurface;
+				mTextureDirty = true;
+				changed = true;
+			}
+			mPosition = due->mPosition;
+			mPresented = true;
+			due->mPosition = -1;
+			due->mReady = false;
+			due->mSurface.reset();
+		}
+		else if( playing && ( mLatePolicy == LATE_HOLD ) && ( target >= first ) ) {
+			// the next frame is late, so the clock is held back to make it due as soon as it arrives
+			if( mHeldPosition != first ) {
+				mHeldPosition = first;
+				++mNumHeldFrames;
+			}
+			mClockStart = first;
+			mTimer.start();
+		}
+	mMutex.unlock();
+
+	prefetch();
+
+	return changed;
+}
+
+gl::Texture ImageSequence::getTexture()
+{
+	if( mTextureDirty && mSurface ) {
+		if( ( ! mStreamer ) || ( mStreamer.getTexture().getWidth() != mSurface.getWidth() ) || ( mStreamer.getTexture().getHeight() != mSurface.getHeight() ) )
+			mStreamer = gl::TextureStreamer( mSurface.getWidth(), mSurface.getHeight(), mSurface.hasAlpha() );
+		mStreamer.update( mSurface );
+		mTextureDirty = false;
+	}
+
+	return mStreamer ? mStreamer.getTexture() : gl::Texture();
+}
+
+// queues decodes for the positions following the current frame which aren't already decoded or decoding
+void ImageSequence::prefetch()
+{
+	int64_t first = mPresented ? ( mPosition + 1 ) : mPosition;
+	// under LATE_DROP there's no point decoding frames which are already late
+	if( ( mLatePolicy == LATE_DROP ) && ( ! mTimer.isStopped() ) )
+		first = std::max( first, getClockPosition() );
+	int64_t last = first + (int64_t)mSlots.size() - 1;
+	if( ! mLoop )
+		last = std::min( last, getLastPosition() );
+
+	std::lock_guard<std::mutex> lock( mMutex );
+	for( int64_t position = first; position <= last; ++position ) {
+		Slot *slot = &mSlots[(size_t)( position % (int64_t)mSlots.size() )];
+		if( slot->mPosition == position )
+			continue;
+		// a slot is only reused once its decode has finished
+		if( slot->mJob && ( ! mJobSystem->isFinished( slot->mJob ) ) )
+			continue;
+
+		slot->mPosition = position;
+		slot->mReady = false;
+		slot->mSurface.reset();
+		slot->mJob = mJobSystem->add( std::bind( &ImageSequence::decode, this, slot, position ) );
+	}
+}
+
+void ImageSequence::decode( Slot *slot, int64_t position )
+{
+	Surface8u surface;
+	try {
+		ImageSourceRef source = loadImage( mPaths[positionToFrame( position )] );
+		// BGRA and BGRX are what gl::TextureStreamer uploads without conversion
+		surface = Surface8u( source->getWidth(), source->getHeight(), source->hasAlpha(), source->hasAlpha() ? SurfaceChannelOrder::BGRA : SurfaceChannelOrder::BGRX, mSurfacePool );
+		source->load( (ImageTargetRef)surface );
+	}
+	catch( ... ) { // jobs must not throw; an unreadable frame is skipped
+		surface.reset();
+	}
+
+	std::lock_guard<std::mutex> lock( mMutex );
+	if( slot->mPosition == position ) {
+		slot->mSurface = surface;
+		slot->mReady = true;
+	}
+}
+
+void ImageSequence::play()
+{
+	if( ! mTimer.isStopped() )
+		return;
+
+	if( ( ! mLoop ) && ( mPosition >= getLastPosition() ) )
+		seekToFrame( 0 );
+
+	mClockStart = mPosition;
+	mTimer.start();
+}
+
+void ImageSequence::stop()
+{
+	mTimer.stop();
+}
+
+void ImageSequence::seekToFrame( int32_t frame )
+{
+	mPosition = constrain<int32_t>( frame, 0, getNumFrames() - 1 );
+	mPresented = false;
+	mClockStart = mPosition;
+	if( ! mTimer.isStopped() )
+		mTimer.start();
+
+	prefetch();
+}
+
+int32_t ImageSequence::getCurrentFrame() const
+{
+	return positionToFrame( mPosition );
+}
+
+void ImageSequence::setFramesPerSecond( float framesPerSecond )
+{
+	if( ! mTimer.isStopped() ) {
+		mClockStart = getClockPosition();
+		mTimer.start();
+	}
+	mFramesPerSecond = framesPerSecond;
+}
+
+int64_t ImageSequence::getClockPosition() const
+{
+	return mClockStart + (int64_t)( mTimer.getSeconds() * mFramesPerSecond );
+}
+
+int32_t ImageSequence::positionToFrame( int64_t position ) const
+{
+	if( mLoop )
+		return (int32_t)( position % (int64_t)mPaths.size() );
+	else
+		return (int32_t)std::min<int64_t>( position, getLastPosition() );
+}
+
+int64_t ImageSequence::getLastPosition() const
+{
+	return (int64_t)mPaths.size() - 1;
+}
+
+} // namespace cinder
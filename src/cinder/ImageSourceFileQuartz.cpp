@@ -28,6 +28,24 @@
 
 namespace cinder {
 
+namespace {
+
+Vec2i getPixelSize( CFDictionaryRef properties )
+{
+	int32_t width = 0, height = 0;
+	if( properties ) {
+		::CFNumberRef widthNumber = (::CFNumberRef)::CFDictionaryGetValue( properties, kCGImagePropertyPixelWidth );
+		::CFNumberRef heightNumber = (::CFNumberRef)::CFDictionaryGetValue( properties, kCGImagePropertyPixelHeight );
+		if( widthNumber && heightNumber ) {
+			::CFNumberGetValue( widthNumber, kCFNumberSInt32Type, &width );
+			::CFNumberGetValue( heightNumber, kCFNumberSInt32Type, &height );
+		}
+	}
+	return Vec2i( width, height );
+}
+
+} // anonymous namespace
+
 ///////////////////////////////////////////////////////////////////////////////
 // Registrar
 void ImageSourceFileQuartz::registerSelf()
@@ -106,17 +124,29 @@ ImageSourceFileQuartzRef ImageSourceFileQuartz::createFileQuartzRef( DataSourceR
 		::CFRelease( dataRef );
 	}
 	
-	if( sourceRef ) {
-		imageRef = std::shared_ptr<CGImage>( ::CGImageSourceCreateImageAtIndex( sourceRef.get(), options.getIndex(), optionsDict.get() ), CGImageRelease );
-		if( ! imageRef )
-			throw ImageIoExceptionFailedLoad();
+	if( ! sourceRef )
+		throw ImageIoExceptionFailedLoad();
+
+	std::shared_ptr<const __CFDictionary> imageProperties( ::CGImageSourceCopyProperties( sourceRef.get(), NULL ), cocoa::safeCfRelease );
+	std::shared_ptr<const __CFDictionary> imageIndexProperties( ::CGImageSourceCopyPropertiesAtIndex( sourceRef.get(), options.getIndex(), NULL ), cocoa::safeCfRelease );
+
+	// decode at a reduced resolution through ImageIO's thumbnailing, which lets codecs like JPEG scale while decoding
+	Vec2i fullSize = getPixelSize( imageIndexProperties.get() );
+	Vec2i reducedSize = options.calcReducedSize( fullSize );
+	if( reducedSize != fullSize ) {
+		int32_t maxPixelSize = std::max( reducedSize.x, reducedSize.y );
+		::CFNumberRef maxPixelSizeNumber = ::CFNumberCreate( kCFAllocatorDefault, kCFNumberSInt32Type, &maxPixelSize );
+		::CFStringRef thumbnailKeys[3] = { kCGImageSourceShouldAllowFloat, kCGImageSourceCreateThumbnailFromImageAlways, kCGImageSourceThumbnailMaxPixelSize };
+		::CFTypeRef thumbnailValues[3] = { kCFBooleanTrue, kCFBooleanTrue, maxPixelSizeNumber };
+		std::shared_ptr<const __CFDictionary> thumbnailDict( ::CFDictionaryCreate( kCFAllocatorDefault, (const void **)&thumbnailKeys, (const void **)&thumbnailValues, 3, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks ), cocoa::safeCfRelease );
+		::CFRelease( maxPixelSizeNumber );
+		imageRef = std::shared_ptr<CGImage>( ::CGImageSourceCreateThumbnailAtIndex( sourceRef.get(), options.getIndex(), thumbnailDict.get() ), CGImageRelease );
 	}
 	else
+		imageRef = std::shared_ptr<CGImage>( ::CGImageSourceCreateImageAtIndex( sourceRef.get(), options.getIndex(), optionsDict.get() ), CGImageRelease );
+	if( ! imageRef )
 		throw ImageIoExceptionFailedLoad();
 
-	std::shared_ptr<const __CFDictionary> imageProperties( ::CGImageSourceCopyProperties( sourceRef.get(), NULL ), ::CFRelease );
-	std::shared_ptr<const __CFDictionary> imageIndexProperties( ::CGImageSourceCopyPropertiesAtIndex( sourceRef.get(), options.getIndex(), NULL ), ::CFRelease );
-
 	return ImageSourceFileQuartzRef( new ImageSourceFileQuartz( imageRef.get(), options, imageProperties, imageIndexProperties ) );
 }
 
@@ -98,6 +98,29 @@ ImageSourceFileWic::ImageSourceFileWic( DataSourceRef dataSourceRef, ImageSource
 	frame->GetPixelFormat( &pixelFormat );
 	
 	bool requiresConversion = processFormat( pixelFormat, &convertPixelFormat );
+
+	// decode at a reduced resolution if the codec can do so natively, as the JPEG codec does by scaling its DCT
+	std::shared_ptr<IWICBitmapSourceTransform> transform;
+	Vec2i reducedSize = options.calcReducedSize( Vec2i( mWidth, mHeight ) );
+	if( ( reducedSize != Vec2i( mWidth, mHeight ) ) && ( ! requiresConversion ) ) {
+		IWICBitmapSourceTransform *transformP = NULL;
+		if( SUCCEEDED( frame->QueryInterface( IID_IWICBitmapSourceTransform, (void**)&transformP ) ) ) {
+			transform = msw::makeComShared( transformP );
+			UINT closestWidth = reducedSize.x, closestHeight = reducedSize.y;
+			BOOL supportsTransform = FALSE;
+			hr = transform->GetClosestSize( &closestWidth, &closestHeight );
+			if( SUCCEEDED( hr ) )
+				hr = transform->DoesSupportTransform( WICBitmapTransformRotate0, &supportsTransform );
+			// the closest size may round down, in which case we decode at full resolution rather than fall short of the target
+			if( SUCCEEDED( hr ) && supportsTransform && ( closestWidth >= (UINT)reducedSize.x ) && ( closestHeight >= (UINT)reducedSize.y ) && ( closestWidth < width ) ) {
+				mWidth = closestWidth;
+				mHeight = closestHeight;
+			}
+			else
+				transform.reset();
+		}
+	}
+
 	mRowBytes = mWidth * ImageIo::dataTypeBytes( mDataType ) * channelOrderNumChannels( mChannelOrder );
 
 	mData = std::shared_ptr<uint8_t>( new uint8_t[mRowBytes * mHeight], boost::checked_array_delete<uint8_t> );
@@ -114,6 +137,8 @@ ImageSourceFileWic::ImageSourceFileWic( DataSourceRef dataSourceRef, ImageSource
 			throw ImageIoExceptionFailedLoad();
 		hr = formatConverter->CopyPixels( NULL, (UINT)mRowBytes, mRowBytes * mHeight, mData.get() );
 	}
+	else if( transform )
+		hr = transform->CopyPixels( NULL, mWidth, mHeight, &pixelFormat, WICBitmapTransformRotate0, (UINT)mRowBytes, mRowBytes * mHeight, mData.get() );
 	else
 		hr = frame->CopyPixels( NULL, (UINT)mRowBytes, mRowBytes * mHeight, mData.get() );
 }
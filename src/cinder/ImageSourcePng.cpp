@@ -21,7 +21,18 @@
 */
 
 #include "cinder/ImageSourcePng.h"
+#include "cinder/Utilities.h"
+#include "cinder/ip/Simd.h"
 #include <png.h>
+#include <zlib.h>
+#include <cstring>
+#include <cstdlib>
+
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#elif defined( CINDER_IP_NEON )
+	#include <arm_neon.h>
+#endif
 
 using namespace std;
 
@@ -30,6 +41,9 @@ namespace cinder {
 struct ci_png_info
 {
 	ci::IStreamRef		srcStreamRef;
+	// used instead of srcStreamRef when the whole file is in memory
+	const uint8_t		*mData;
+	size_t				mSize, mOffset;
 };
 
 extern "C" {
@@ -44,6 +58,15 @@ static void ci_PNG_stream_reader( png_structp mPngPtr, png_bytep data, png_size_
 	}
 }
 
+static void ci_PNG_memory_reader( png_structp mPngPtr, png_bytep data, png_size_t length )
+{
+	ci_png_info *info = (ci_png_info*)png_get_io_ptr(mPngPtr);
+	if( (size_t)length > info->mSize - info->mOffset )
+		longjmp( mPngPtr->jmpbuf, 1 );
+	memcpy( data, info->mData + info->mOffset, (size_t)length );
+	info->mOffset += (size_t)length;
+}
+
 static void ci_png_warning( png_structp mPngPtr, png_const_charp message )
 {
 //    fli_png_info_struct *info = mPngPtr ? (fli_png_info_struct*)png_get_io_ptr(mPngPtr) : NULL;
@@ -59,6 +82,219 @@ static void ci_png_error( png_structp mPngPtr, png_const_charp message )
 
 } // extern "C"
 
+namespace { // anonymous namespace
+
+uint32_t readBigEndian32( const uint8_t *src )
+{
+	return ( (uint32_t)src[0] << 24 ) | ( (uint32_t)src[1] << 16 ) | ( (uint32_t)src[2] << 8 ) | src[3];
+}
+
+inline uint8_t paethPredictor( int a, int b, int c )
+{
+	int p = a + b - c;
+	int pa = abs( p - a ), pb = abs( p - b ), pc = abs( p - c );
+	if( ( pa <= pb ) && ( pa <= pc ) )
+		return (uint8_t)a;
+	else if( pb <= pc )
+		return (uint8_t)b;
+	else
+		return (uint8_t)c;
+}
+
+void unfilterSub( uint8_t *row, size_t size, int bpp )
+{
+	for( size_t i = bpp; i < size; ++i )
+		row[i] += row[i-bpp];
+}
+
+void unfilterUp( uint8_t *row, const uint8_t *prev, size_t size )
+{
+	size_t i = 0;
+#if defined( CINDER_IP_SSE2 )
+	if( ip::useSse2() ) {
+		for( ; i + 16 <= size; i += 16 ) {
+			__m128i r = _mm_loadu_si128( reinterpret_cast<const __m128i*>( row + i ) );
+			__m128i p = _mm_loadu_si128( reinterpret_cast<const __m128i*>( prev + i ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( row + i ), _mm_add_epi8( r, p ) );
+		}
+	}
+#elif defined( CINDER_IP_NEON )
+	if( ip::useNeon() ) {
+		for( ; i + 16 <= size; i += 16 )
+			vst1q_u8( row + i, vaddq_u8( vld1q_u8( row + i ), vld1q_u8( prev + i ) ) );
+	}
+#endif
+	for( ; i < size; ++i )
+		row[i] += prev[i];
+}
+
+void unfilterAverage( uint8_t *row, const uint8_t *prev, size_t size, int bpp )
+{
+	for( int i = 0; i < bpp; ++i )
+		row[i] += prev[i] >> 1;
+	for( size_t i = bpp; i < size; ++i )
+		row[i] += (uint8_t)( ( row[i-bpp] + prev[i] ) >> 1 );
+}
+
+void unfilterPaeth( uint8_t *row, const uint8_t *prev, size_t size, int bpp )
+{
+	for( int i = 0; i < bpp; ++i )
+		row[i] += prev[i];
+	for( size_t i = bpp; i < size; ++i )
+		row[i] += paethPredictor( row[i-bpp], prev[i], prev[i-bpp] );
+}
+
+#if defined( CINDER_IP_SSE2 )
+// Sub, Average and Paeth depend on the previous pixel, so these process one 3 or 4 byte pixel per step, as libpng's own SSE2 filters do
+template<int BPP>
+inline __m128i loadPixel( const uint8_t *p )
+{
+	int32_t v = 0;
+	memcpy( &v, p, BPP );
+	return _mm_cvtsi32_si128( v );
+}
+
+template<int BPP>
+inline void storePixel( uint8_t *p, __m128i v )
+{
+	int32_t i = _mm_cvtsi128_si32( v );
+	memcpy( p, &i, BPP );
+}
+
+template<int BPP>
+void unfilterSubSse2( uint8_t *row, size_t size )
+{
+	__m128i a = _mm_setzero_si128();
+	for( size_t i = 0; i < size; i += BPP ) {
+		a = _mm_add_epi8( a, loadPixel<BPP>( row + i ) );
+		storePixel<BPP>( row + i, a );
+	}
+}
+
+template<int BPP>
+void unfilterAverageSse2( uint8_t *row, const uint8_t *prev, size_t size )
+{
+	const __m128i one = _mm_set1_epi8( 1 );
+	__m128i a = _mm_setzero_si128();
+	for( size_t i = 0; i < size; i += BPP ) {
+		__m128i b = loadPixel<BPP>( prev + i );
+		// _mm_avg_epu8 rounds up, but PNG's average rounds down
+		__m128i avg = _mm_sub_epi8( _mm_avg_epu8( a, b ), _mm_and_si128( _mm_xor_si128( a, b ), one ) );
+		a = _mm_add_epi8( loadPixel<BPP>( row + i ), avg );
+		storePixel<BPP>( row + i, a );
+	}
+}
+
+inline __m128i selectEpi16( __m128i mask, __m128i a, __m128i b )
+{
+	return _mm_or_si128( _mm_and_si128( mask, a ), _mm_andnot_si128( mask, b ) );
+}
+
+inline __m128i absEpi16( __m128i x )
+{
+	return _mm_max_epi16( x, _mm_sub_epi16( _mm_setzero_si128(), x ) );
+}
+
+template<int BPP>
+void unfilterPaethSse2( uint8_t *row, const uint8_t *prev, size_t size )
+{
+	// a is the previous pixel of this row, b the pixel above and c the pixel above a, each widened to 16 bits
+	const __m128i zero = _mm_setzero_si128();
+	__m128i a = zero, b = zero, c;
+	for( size_t i = 0; i < size; i += BPP ) {
+		c = b;
+		b = _mm_unpacklo_epi8( loadPixel<BPP>( prev + i ), zero );
+		__m128i d = _mm_unpacklo_epi8( loadPixel<BPP>( row + i ), zero );
+
+		// pa = |b - c|, pb = |a - c| and pc = |a + b - 2c| are the distances of p = a + b - c from a, b and c
+		__m128i pa = _mm_sub_epi16( b, c );
+		__m128i pb = _mm_sub_epi16( a, c );
+		__m128i pc = absEpi16( _mm_add_epi16( pa, pb ) );
+		pa = absEpi16( pa );
+		pb = absEpi16( pb );
+		__m128i smallest = _mm_min_epi16( pc, _mm_min_epi16( pa, pb ) );
+		// ties prefer a, then b
+		__m128i nearest = selectEpi16( _mm_cmpeq_epi16( smallest, pa ), a, selectEpi16( _mm_cmpeq_epi16( smallest, pb ), b, c ) );
+
+		// adding bytes leaves the zero high byte of each lane alone, so a stays widened
+		a = _mm_add_epi8( d, nearest );
+		storePixel<BPP>( row + i, _mm_packus_epi16( a, a ) );
+	}
+}
+#endif
+
+// Reverses PNG filter \a filter on \a row in place, given the already unfiltered \a prev. Returns false for an unknown filter type.
+bool unfilterRow( uint8_t filter, uint8_t *row, const uint8_t *prev, size_t size, int bpp )
+{
+#if defined( CINDER_IP_SSE2 )
+	bool sse2 = ( ( bpp == 3 ) || ( bpp == 4 ) ) && ip::useSse2();
+#endif
+	switch( filter ) {
+		case 0:
+		break;
+		case 1:
+#if defined( CINDER_IP_SSE2 )
+			if( sse2 ) {
+				if( bpp == 4 )
+					unfilterSubSse2<4>( row, size );
+				else
+					unfilterSubSse2<3>( row, size );
+				break;
+			}
+#endif
+			unfilterSub( row, size, bpp );
+		break;
+		case 2:
+			unfilterUp( row, prev, size );
+		break;
+		case 3:
+#if defined( CINDER_IP_SSE2 )
+			if( sse2 ) {
+				if( bpp == 4 )
+					unfilterAverageSse2<4>( row, prev, size );
+				else
+					unfilterAverageSse2<3>( row, prev, size );
+				break;
+			}
+#endif
+			unfilterAverage( row, prev, size, bpp );
+		break;
+		case 4:
+#if defined( CINDER_IP_SSE2 )
+			if( sse2 ) {
+				if( bpp == 4 )
+					unfilterPaethSse2<4>( row, prev, size );
+				else
+					unfilterPaethSse2<3>( row, prev, size );
+				break;
+			}
+#endif
+			unfilterPaeth( row, prev, size, bpp );
+		break;
+		default:
+			return false;
+	}
+	return true;
+}
+
+struct InflateStream {
+	InflateStream() : mInitialized( false )
+	{
+		memset( &mStream, 0, sizeof( mStream ) );
+		mInitialized = ::inflateInit( &mStream ) == Z_OK;
+	}
+	~InflateStream()
+	{
+		if( mInitialized )
+			::inflateEnd( &mStream );
+	}
+
+	z_stream	mStream;
+	bool		mInitialized;
+};
+
+} // anonymous namespace
+
 ///////////////////////////////////////////////////////////////////////////////
 // Registrar
 void ImageSourcePng::registerSelf()
@@ -75,17 +311,40 @@ ImageSourcePngRef ImageSourcePng::createRef( DataSourceRef dataSourceRef, ImageS
 }
 
 ImageSourcePng::ImageSourcePng( DataSourceRef dataSourceRef, ImageSource::Options /*options*/ )
-	: ImageSource(), mInfoPtr( 0 ), mPngPtr( 0 )
+	: ImageSource(), mInfoPtr( 0 ), mPngPtr( 0 ), mFileData( 0 ), mFileSize( 0 ), mDirect( false ), mPixelBytes( 0 )
 {
+	// get the whole file into memory without copying it if at all possible
+	if( dataSourceRef->isFilePath() )
+		mMapping = mapFile( dataSourceRef->getFilePath(), &mFileSize );
+	if( mMapping )
+		mFileData = reinterpret_cast<const uint8_t*>( mMapping.get() );
+	else if( ! dataSourceRef->isUrl() ) {
+		mBuffer = dataSourceRef->getBuffer();
+		mFileData = reinterpret_cast<const uint8_t*>( mBuffer.getData() );
+		mFileSize = mBuffer.getDataSize();
+	}
+
+	if( mFileData && loadHeaderDirect() ) {
+		mDirect = true;
+		return;
+	}
+
 	mPngPtr = png_create_read_struct( PNG_LIBPNG_VER_STRING, (png_voidp)NULL, NULL, NULL );
 	if( ! mPngPtr ) {
 		throw ImageSourcePngException(); 
 	}
 
 	mCiInfoPtr = shared_ptr<ci_png_info>( new ci_png_info );
-	mCiInfoPtr->srcStreamRef = dataSourceRef->createStream();
-
-	png_set_read_fn( mPngPtr, reinterpret_cast<void*>( mCiInfoPtr.get() ), ci_PNG_stream_reader );
+	if( mFileData ) {
+		mCiInfoPtr->mData = mFileData;
+		mCiInfoPtr->mSize = mFileSize;
+		mCiInfoPtr->mOffset = 0;
+		png_set_read_fn( mPngPtr, reinterpret_cast<void*>( mCiInfoPtr.get() ), ci_PNG_memory_reader );
+	}
+	else {
+		mCiInfoPtr->srcStreamRef = dataSourceRef->createStream();
+		png_set_read_fn( mPngPtr, reinterpret_cast<void*>( mCiInfoPtr.get() ), ci_PNG_stream_reader );
+	}
 	mInfoPtr = png_create_info_struct( mPngPtr );
 
 	if( ! mInfoPtr ) {
@@ -157,6 +416,127 @@ bool ImageSourcePng::loadHeader()
 	return success;
 }
 
+// Parses the chunks of an in-memory file, returning false if it needs any of libpng's transformations or isn't well formed
+bool ImageSourcePng::loadHeaderDirect()
+{
+	static const uint8_t signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	if( ( mFileSize < 8 + 25 ) || memcmp( mFileData, signature, 8 ) )
+		return false;
+
+	// IHDR must come first
+	const uint8_t *ihdr = mFileData + 8;
+	if( ( readBigEndian32( ihdr ) != 13 ) || memcmp( ihdr + 4, "IHDR", 4 ) || ( readBigEndian32( ihdr + 21 ) != ::crc32( ::crc32( 0L, Z_NULL, 0 ), ihdr + 4, 17 ) ) )
+		return false;
+	uint32_t width = readBigEndian32( ihdr + 8 ), height = readBigEndian32( ihdr + 12 );
+	uint8_t bitDepth = ihdr[16], colorType = ihdr[17], compression = ihdr[18], filterMethod = ihdr[19], interlace = ihdr[20];
+	if( ( width == 0 ) || ( height == 0 ) || ( width > 0x7FFFFFFF ) || ( height > 0x7FFFFFFF ) || compression || filterMethod || interlace )
+		return false;
+	if( ( bitDepth != 8 ) && ( bitDepth != 16 ) )
+		return false;
+
+	int8_t channels;
+	switch( colorType ) {
+		case PNG_COLOR_TYPE_GRAY:
+			setColorModel( ImageIo::CM_GRAY );
+			setChannelOrder( ImageIo::Y );
+			channels = 1;
+		break;
+		case PNG_COLOR_TYPE_GRAY_ALPHA:
+			setColorModel( ImageIo::CM_GRAY );
+			setChannelOrder( ImageIo::YA );
+			channels = 2;
+		break;
+		case PNG_COLOR_TYPE_RGB:
+			setColorModel( ImageIo::CM_RGB );
+			setChannelOrder( ImageIo::RGB );
+			channels = 3;
+		break;
+		case PNG_COLOR_TYPE_RGB_ALPHA:
+			setColorModel( ImageIo::CM_RGB );
+			setChannelOrder( ImageIo::RGBA );
+			channels = 4;
+		break;
+		default: // palettes are left to libpng
+			return false;
+	}
+
+	mIdatChunks.clear();
+	size_t offset = 8 + 25;
+	bool ended = false;
+	while( ( ! ended ) && ( offset + 12 <= mFileSize ) ) {
+		size_t length = readBigEndian32( mFileData + offset );
+		const char *type = reinterpret_cast<const char*>( mFileData + offset + 4 );
+		if( length > mFileSize - offset - 12 )
+			return false;
+		if( ! memcmp( type, "IDAT", 4 ) )
+			mIdatChunks.push_back( make_pair( offset + 8, length ) );
+		else if( ! memcmp( type, "IEND", 4 ) )
+			ended = true;
+		else if( ! memcmp( type, "tRNS", 4 ) ) // libpng converts this to an alpha channel
+			return false;
+		else if( ( ( type[0] & 0x20 ) == 0 ) && memcmp( type, "PLTE", 4 ) ) // an unknown critical chunk
+			return false;
+		offset += length + 12;
+	}
+	if( mIdatChunks.empty() )
+		return false;
+
+	setSize( width, height );
+	setDataType( ( bitDepth == 16 ) ? ImageIo::UINT16 : ImageIo::UINT8 );
+	mPixelBytes = channels * bitDepth / 8;
+	return true;
+}
+
+void ImageSourcePng::loadDirect( ImageTargetRef target )
+{
+	// get a pointer to the ImageSource function appropriate for handling our data configuration
+	ImageSource::RowFunc func = setupRowFunc( target );
+
+	// each row is a filter type byte followed by the filtered pixels; the row before the first is all zeros
+	const size_t rowBytes = (size_t)mWidth * mPixelBytes;
+	vector<uint8_t> rowStorage( ( rowBytes + 1 ) * 2, 0 );
+	uint8_t *cur = &rowStorage[0], *prev = &rowStorage[rowBytes + 1];
+	vector<uint16_t> swapped( ( getDataType() == ImageIo::UINT16 ) ? rowBytes / 2 : 0 );
+
+	InflateStream inflater;
+	if( ! inflater.mInitialized )
+		throw ImageSourcePngException();
+	z_stream &strm = inflater.mStream;
+	size_t nextChunk = 0;
+	for( int32_t row = 0; row < mHeight; ++row ) {
+		strm.next_out = cur;
+		strm.avail_out = (uInt)( rowBytes + 1 );
+		while( strm.avail_out > 0 ) {
+			if( strm.avail_in == 0 ) {
+				if( nextChunk == mIdatChunks.size() )
+					throw ImageSourcePngException();
+				strm.next_in = const_cast<Bytef*>( mFileData + mIdatChunks[nextChunk].first );
+				strm.avail_in = (uInt)mIdatChunks[nextChunk].second;
+				++nextChunk;
+				continue;
+			}
+			int result = ::inflate( &strm, Z_NO_FLUSH );
+			if( ( result == Z_STREAM_END ) && ( strm.avail_out > 0 ) )
+				throw ImageSourcePngException();
+			else if( ( result != Z_OK ) && ( result != Z_STREAM_END ) && ( result != Z_BUF_ERROR ) )
+				throw ImageSourcePngException();
+		}
+
+		if( ! unfilterRow( cur[0], cur + 1, prev + 1, rowBytes, mPixelBytes ) )
+			throw ImageSourcePngException();
+
+		if( ! swapped.empty() ) { // PNG samples are big-endian
+			const uint8_t *samples = cur + 1;
+			for( size_t s = 0; s < swapped.size(); ++s )
+				swapped[s] = (uint16_t)( ( samples[s*2] << 8 ) | samples[s*2+1] );
+			((*this).*func)( target, row, &swapped[0] );
+		}
+		else
+			((*this).*func)( target, row, cur + 1 );
+		std::swap( cur, prev );
+	}
+}
+
 ImageSourcePng::~ImageSourcePng()
 {
 	if( mPngPtr )
@@ -165,6 +545,11 @@ ImageSourcePng::~ImageSourcePng()
 
 void ImageSourcePng::load( ImageTargetRef target )
 {
+	if( mDirect ) {
+		loadDirect( target );
+		return;
+	}
+
 	bool success = true;
 	if( setjmp( mPngPtr->jmpbuf ) ) {
 		png_destroy_read_struct( &mPngPtr, &mInfoPtr, (png_infopp)NULL );
@@ -0,0 +1,197 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ImageTargetBand.h"
+#include "cinder/CinderMath.h"
+
+#include <boost/type_traits/is_same.hpp>
+#include <algorithm>
+
+namespace cinder {
+
+namespace {
+
+template<typename T>
+ImageIo::DataType dataTypeFor()
+{
+	return ( boost::is_same<T,float>::value ) ? ImageIo::FLOAT32 : ImageIo::UINT8;
+}
+
+template<typename T>
+T fromAccumulated( float value )
+{
+	return value;
+}
+
+template<>
+uint8_t fromAccumulated<uint8_t>( float value )
+{
+	return (uint8_t)constrain<float>( value + 0.5f, 0, 255 );
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ImageTargetBandT
+template<typename T>
+ImageTargetBandT<T>::ImageTargetBandT( ImageSourceRef imageSource, int32_t bandHeight, const BandFn &bandFn )
+	: ImageTarget(), mBandFn( bandFn ), mBandStart( 0 ), mRowsFilled( 0 )
+{
+	bool alpha = imageSource->hasAlpha();
+	bandHeight = std::max<int32_t>( 1, std::min<int32_t>( bandHeight, imageSource->getHeight() ) );
+	mBand = SurfaceT<T>( imageSource->getWidth(), bandHeight, alpha, ( alpha ) ? SurfaceChannelOrder::RGBA : SurfaceChannelOrder::RGB );
+	mBand.setPremultiplied( imageSource->isPremultiplied() );
+
+	setSize( imageSource->getWidth(), imageSource->getHeight() );
+	setDataType( dataTypeFor<T>() );
+	setColorModel( ImageIo::CM_RGB );
+	setChannelOrder( ( alpha ) ? ImageIo::RGBA : ImageIo::RGB );
+}
+
+template<typename T>
+void* ImageTargetBandT<T>::getRowPointer( int32_t row )
+{
+	int32_t bandStart = row / mBand.getHeight() * mBand.getHeight();
+	if( bandStart != mBandStart ) {
+		flush();
+		mBandStart = bandStart;
+	}
+
+	mRowsFilled = std::max<int32_t>( mRowsFilled, row - mBandStart + 1 );
+	return mBand.getData( Vec2i( 0, row - mBandStart ) );
+}
+
+template<typename T>
+void ImageTargetBandT<T>::finalize()
+{
+	flush();
+}
+
+template<typename T>
+void ImageTargetBandT<T>::flush()
+{
+	if( mRowsFilled > 0 ) {
+		mBandFn( mBand.getSubSurface( Area( 0, 0, mBand.getWidth(), mRowsFilled ) ), mBandStart );
+		mRowsFilled = 0;
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ImageTargetResizeT
+template<typename T>
+ImageTargetResizeT<T>::ImageTargetResizeT( ImageSourceRef imageSource, const Vec2i &size )
+	: ImageTarget(), mSrcWidth( imageSource->getWidth() ), mSrcHeight( imageSource->getHeight() ), mPendingRow( -1 )
+{
+	bool alpha = imageSource->hasAlpha();
+	mResult = SurfaceT<T>( size.x, size.y, alpha, ( alpha ) ? SurfaceChannelOrder::RGBA : SurfaceChannelOrder::RGB );
+	mResult.setPremultiplied( imageSource->isPremultiplied() );
+	mPixelInc = mResult.getPixelInc();
+	mSrcRow.resize( mSrcWidth * mPixelInc );
+	mHorizontal.resize( size.x * mPixelInc );
+	mAccum.resize( size.x * mPixelInc, 0 );
+
+	// each destination column averages the source columns it covers, weighted by their overlap
+	const double scale = mSrcWidth / (double)size.x;
+	for( int32_t x = 0; x < size.x; ++x ) {
+		mColumnStarts.push_back( mColumnWeights.size() );
+		double start = x * scale, end = ( x + 1 ) * scale;
+		for( int32_t srcX = (int32_t)start; ( srcX < end ) && ( srcX < mSrcWidth ); ++srcX ) {
+			double overlap = std::min<double>( end, srcX + 1 ) - std::max<double>( start, srcX );
+			mColumnWeights.push_back( std::make_pair( srcX, (float)( overlap / scale ) ) );
+		}
+	}
+	mColumnStarts.push_back( mColumnWeights.size() );
+
+	setSize( mSrcWidth, mSrcHeight );
+	setDataType( dataTypeFor<T>() );
+	setColorModel( ImageIo::CM_RGB );
+	setChannelOrder( ( alpha ) ? ImageIo::RGBA : ImageIo::RGB );
+}
+
+template<typename T>
+SurfaceT<T> ImageTargetResizeT<T>::load( ImageSourceRef imageSource, const Vec2i &size )
+{
+	std::shared_ptr<ImageTargetResizeT<T> > target = create( imageSource, size );
+	imageSource->load( target );
+	target->finalize();
+	return target->getSurface();
+}
+
+template<typename T>
+void* ImageTargetResizeT<T>::getRowPointer( int32_t row )
+{
+	// the source has finished writing the previous row once it asks for the next one
+	if( ( mPendingRow >= 0 ) && ( row != mPendingRow ) )
+		accumulateRow( mPendingRow );
+
+	mPendingRow = row;
+	return &mSrcRow[0];
+}
+
+template<typename T>
+void ImageTargetResizeT<T>::finalize()
+{
+	if( mPendingRow >= 0 )
+		accumulateRow( mPendingRow );
+	mPendingRow = -1;
+}
+
+template<typename T>
+void ImageTargetResizeT<T>::accumulateRow( int32_t row )
+{
+	const int32_t dstWidth = mResult.getWidth(), dstHeight = mResult.getHeight();
+	for( int32_t x = 0; x < dstWidth; ++x ) {
+		float *horizontal = &mHorizontal[x * mPixelInc];
+		for( int32_t c = 0; c < mPixelInc; ++c )
+			horizontal[c] = 0;
+		for( size_t w = mColumnStarts[x]; w < mColumnStarts[x+1]; ++w ) {
+			const T *src = &mSrcRow[mColumnWeights[w].first * mPixelInc];
+			for( int32_t c = 0; c < mPixelInc; ++c )
+				horizontal[c] += src[c] * mColumnWeights[w].second;
+		}
+	}
+
+	// the source row covers [start,end) of the destination rows. Rows arrive in order, so only the last destination row it touches can remain incomplete
+	const double start = row * dstHeight / (double)mSrcHeight, end = ( row + 1 ) * dstHeight / (double)mSrcHeight;
+	for( int32_t dstY = (int32_t)start; ( dstY < end ) && ( dstY < dstHeight ); ++dstY ) {
+		float overlap = (float)( std::min<double>( end, dstY + 1 ) - std::max<double>( start, dstY ) );
+		for( size_t i = 0; i < mAccum.size(); ++i )
+			mAccum[i] += mHorizontal[i] * overlap;
+
+		if( (int64_t)( dstY + 1 ) * mSrcHeight <= (int64_t)( row + 1 ) * dstHeight ) {
+			T *dst = mResult.getData( Vec2i( 0, dstY ) );
+			for( size_t i = 0; i < mAccum.size(); ++i ) {
+				dst[i] = fromAccumulated<T>( mAccum[i] );
+				mAccum[i] = 0;
+			}
+		}
+	}
+}
+
+template class ImageTargetBandT<uint8_t>;
+template class ImageTargetBandT<float>;
+template class ImageTargetResizeT<uint8_t>;
+template class ImageTargetResizeT<float>;
+
+} // namespace cinder
@@ -0,0 +1,366 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ImageTargetFilePng.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/DataTarget.h"
+#include "cinder/Stream.h"
+#include "cinder/Function.h"
+#include "cinder/Thread.h"
+#include "cinder/ip/ExecutionContext.h"
+
+#include <zlib.h>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+
+using namespace std;
+
+namespace cinder {
+
+namespace { // anonymous namespace
+
+const int		PNG_COMPRESSION_LEVEL = 6;
+const size_t	PNG_DICTIONARY_SIZE = 32768;
+const size_t	PNG_IDAT_SIZE = 256 * 1024;
+
+void writeBigEndian32( uint8_t *dest, uint32_t value )
+{
+	dest[0] = (uint8_t)( value >> 24 );
+	dest[1] = (uint8_t)( value >> 16 );
+	dest[2] = (uint8_t)( value >> 8 );
+	dest[3] = (uint8_t)value;
+}
+
+void writeChunk( OStreamRef stream, const char *type, const uint8_t *data, size_t size )
+{
+	uint8_t header[8];
+	writeBigEndian32( header, (uint32_t)size );
+	memcpy( header + 4, type, 4 );
+	uLong crc = ::crc32( 0L, header + 4, 4 );
+	if( size )
+		crc = ::crc32( crc, data, (uInt)size );
+	uint8_t footer[4];
+	writeBigEndian32( footer, (uint32_t)crc );
+
+	stream->writeData( header, 8 );
+	if( size )
+		stream->writeData( data, size );
+	stream->writeData( footer, 4 );
+}
+
+inline uint8_t paethPredictor( int a, int b, int c )
+{
+	int p = a + b - c;
+	int pa = abs( p - a ), pb = abs( p - b ), pc = abs( p - c );
+	if( ( pa <= pb ) && ( pa <= pc ) )
+		return (uint8_t)a;
+	else if( pb <= pc )
+		return (uint8_t)b;
+	else
+		return (uint8_t)c;
+}
+
+// Sum of the filtered bytes as signed values, libpng's heuristic for choosing a row's filter
+inline uint32_t filterCost( const uint8_t *row, size_t size )
+{
+	uint32_t result = 0;
+	for( size_t i = 0; i < size; ++i )
+		result += (uint32_t)abs( (int)(int8_t)row[i] );
+	return result;
+}
+
+// A deflated band of filtered rows
+struct PngSegment {
+	Buffer		mData;
+	uLong		mAdler;
+	size_t		mFilteredSize;
+};
+
+/* Encodes the rows of an ImageTargetFilePng in three passes, each run across bands of rows in parallel:
+	prepare (unpremultiply and convert 16 bit samples to big-endian), filter, and deflate. */
+class PngEncoder {
+  public:
+	PngEncoder( uint8_t *data, int32_t rowBytes, int8_t pixelBytes, bool sixteenBit, bool unpremultiply, int32_t height )
+		: mFailed( false ), mData( data ), mRowBytes( rowBytes ), mHeight( height ), mFilteredStride( rowBytes + 1 ), mPixelBytes( pixelBytes ),
+			mSixteenBit( sixteenBit ), mUnpremultiply( unpremultiply )
+	{
+		mFiltered.resize( (size_t)mFilteredStride * height );
+	}
+
+	void	prepare( const Area &band );
+	void	filter( const Area &band );
+	void	deflateBand( const Area &band );
+
+	std::vector<uint8_t>				mFiltered;
+	std::map<int32_t,PngSegment>		mSegments;	// keyed by each band's first row
+	bool								mFailed;
+
+  private:
+	template<typename T>
+	void	unpremultiplyRow( T *row, int32_t width, int32_t channels );
+
+	uint8_t			*mData;
+	int32_t			mRowBytes, mHeight;
+	size_t			mFilteredStride;
+	int8_t			mPixelBytes;
+	bool			mSixteenBit, mUnpremultiply;
+	std::mutex		mMutex;
+};
+
+template<typename T>
+void PngEncoder::unpremultiplyRow( T *row, int32_t width, int32_t channels )
+{
+	const uint32_t maxValue = CHANTRAIT<T>::max();
+	for( int32_t x = 0; x < width; ++x, row += channels ) {
+		uint32_t alpha = row[channels - 1];
+		if( ( alpha == 0 ) || ( alpha == maxValue ) )
+			continue;
+		for( int32_t c = 0; c < channels - 1; ++c )
+			row[c] = (T)std::min<uint32_t>( maxValue, ( row[c] * maxValue + alpha / 2 ) / alpha );
+	}
+}
+
+void PngEncoder::prepare( const Area &band )
+{
+	int32_t sampleBytes = mSixteenBit ? 2 : 1;
+	int32_t channels = mPixelBytes / sampleBytes;
+	int32_t width = mRowBytes / mPixelBytes;
+	for( int32_t y = band.y1; y < band.y2; ++y ) {
+		uint8_t *row = mData + (size_t)y * mRowBytes;
+		if( mSixteenBit ) {
+			uint16_t *samples = reinterpret_cast<uint16_t*>( row );
+			if( mUnpremultiply )
+				unpremultiplyRow( samples, width, channels );
+			for( int32_t i = 0; i < width * channels; ++i ) { // PNG samples are big-endian
+				uint16_t sample = samples[i];
+				row[i*2] = (uint8_t)( sample >> 8 );
+				row[i*2+1] = (uint8_t)sample;
+			}
+		}
+		else if( mUnpremultiply )
+			unpremultiplyRow( row, width, channels );
+	}
+}
+
+void PngEncoder::filter( const Area &band )
+{
+	const size_t size = mRowBytes;
+	const int32_t bpp = mPixelBytes;
+	std::vector<uint8_t> zeros( size, 0 );
+	std::vector<uint8_t> candidates( size * 4 );
+	uint8_t *sub = &candidates[0], *up = sub + size, *avg = up + size, *paeth = avg + size;
+
+	for( int32_t y = band.y1; y < band.y2; ++y ) {
+		const uint8_t *cur = mData + (size_t)y * size;
+		const uint8_t *prev = ( y > 0 ) ? cur - size : &zeros[0];
+		for( int32_t i = 0; i < bpp; ++i ) {
+			sub[i] = cur[i];
+			up[i] = cur[i] - prev[i];
+			avg[i] = cur[i] - ( prev[i] >> 1 );
+			paeth[i] = cur[i] - prev[i];
+		}
+		for( size_t i = bpp; i < size; ++i ) {
+			sub[i] = cur[i] - cur[i-bpp];
+			up[i] = cur[i] - prev[i];
+			avg[i] = cur[i] - (uint8_t)( ( cur[i-bpp] + prev[i] ) >> 1 );
+			paeth[i] = cur[i] - paethPredictor( cur[i-bpp], prev[i], prev[i-bpp] );
+		}
+
+		// pick the filter type whose output has the smallest sum of absolute values
+		const uint8_t *rows[5] = { cur, sub, up, avg, paeth };
+		uint8_t best = 0;
+		uint32_t bestCost = filterCost( cur, size );
+		for( uint8_t f = 1; f < 5; ++f ) {
+			uint32_t cost = filterCost( rows[f], size );
+			if( cost < bestCost ) {
+				bestCost = cost;
+				best = f;
+			}
+		}
+
+		uint8_t *dest = &mFiltered[y * mFilteredStride];
+		dest[0] = best;
+		memcpy( dest + 1, rows[best], size );
+	}
+}
+
+void PngEncoder::deflateBand( const Area &band )
+{
+	const uint8_t *input = &mFiltered[band.y1 * mFilteredStride];
+	size_t inputSize = ( band.y2 - band.y1 ) * mFilteredStride;
+	bool first = band.y1 == 0, last = band.y2 == mHeight;
+
+	z_stream strm;
+	memset( &strm, 0, sizeof( strm ) );
+	// a raw deflate stream; the zlib header and adler32 trailer are added around the stitched segments
+	if( ::deflateInit2( &strm, PNG_COMPRESSION_LEVEL, Z_DEFLATED, -MAX_WBITS, 8, Z_FILTERED ) != Z_OK ) {
+		std::lock_guard<std::mutex> lock( mMutex );
+		mFailed = true;
+		return;
+	}
+	// prime the window with the end of the previous band, which is what a single stream would have seen
+	if( ! first ) {
+		size_t dictionarySize = std::min<size_t>( PNG_DICTIONARY_SIZE, band.y1 * mFilteredStride );
+		::deflateSetDictionary( &strm, input - dictionarySize, (uInt)dictionarySize );
+	}
+
+	// room for the zlib header in the first segment and the adler32 trailer in the last
+	size_t capacity = ::deflateBound( &strm, (uLong)inputSize ) + 64;
+	Buffer output( capacity );
+	size_t outputSize = 0;
+	if( first ) {
+		uint8_t *header = reinterpret_cast<uint8_t*>( output.getData() );
+		header[0] = 0x78; // deflate with a 32k window
+		header[1] = 0x9C; // default compression level, no dictionary, FCHECK
+		outputSize = 2;
+	}
+
+	strm.next_in = const_cast<Bytef*>( input );
+	strm.avail_in = (uInt)inputSize;
+	int flush = last ? Z_FINISH : Z_SYNC_FLUSH; // a sync flush ends the segment on a byte boundary without ending the stream
+	bool failed = false;
+	while( true ) {
+		strm.next_out = reinterpret_cast<Bytef*>( output.getData() ) + outputSize;
+		strm.avail_out = (uInt)( capacity - outputSize );
+		int result = ::deflate( &strm, flush );
+		outputSize = capacity - strm.avail_out;
+		if( ( result == Z_STREAM_ERROR ) || ( ( result == Z_BUF_ERROR ) && ( strm.avail_out != 0 ) ) ) {
+			failed = true;
+			break;
+		}
+		if( last ? ( result == Z_STREAM_END ) : ( ( strm.avail_in == 0 ) && ( strm.avail_out != 0 ) ) )
+			break;
+		capacity *= 2;
+		output.resize( capacity );
+	}
+	::deflateEnd( &strm );
+	output.setDataSize( outputSize );
+
+	PngSegment segment;
+	segment.mData = output;
+	segment.mAdler = ::adler32( ::adler32( 0L, Z_NULL, 0 ), input, (uInt)inputSize );
+	segment.mFilteredSize = inputSize;
+
+	std::lock_guard<std::mutex> lock( mMutex );
+	mSegments[band.y1] = segment;
+	mFailed = mFailed || failed;
+}
+
+} // anonymous namespace
+
+void ImageTargetFilePng::registerSelf()
+{
+	// ahead of the priority 2 platform writers
+	const int32_t PRIORITY = 1;
+
+	ImageIoRegistrar::TargetCreationFunc func = ImageTargetFilePng::createRef;
+	ImageIoRegistrar::registerTargetType( "png", func, PRIORITY, "png" );
+}
+
+ImageTargetRef ImageTargetFilePng::createRef( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const string &extensionData )
+{
+	return ImageTargetRef( new ImageTargetFilePng( dataTarget, imageSource, options, extensionData ) );
+}
+
+ImageTargetFilePng::ImageTargetFilePng( DataTargetRef dataTarget, ImageSourceRef imageSource, ImageTarget::Options options, const string & /*extensionData*/ )
+	: ImageTarget(), mDataTarget( dataTarget )
+{
+	setSize( imageSource->getWidth(), imageSource->getHeight() );
+
+	ImageIo::ColorModel cm = options.isColorModelDefault() ? imageSource->getColorModel() : options.getColorModel();
+	if( cm != ImageIo::CM_GRAY )
+		cm = ImageIo::CM_RGB;
+	setColorModel( cm );
+	bool alpha = imageSource->hasAlpha();
+	if( cm == ImageIo::CM_GRAY )
+		setChannelOrder( alpha ? ImageIo::YA : ImageIo::Y );
+	else
+		setChannelOrder( alpha ? ImageIo::RGBA : ImageIo::RGB );
+	// PNG has no float samples, so anything deeper than 8 bits is written as 16
+	setDataType( ( ( imageSource->getDataType() == ImageIo::UINT8 ) || ( imageSource->getDataType() == ImageIo::DATA_UNKNOWN ) ) ? ImageIo::UINT8 : ImageIo::UINT16 );
+	// PNG stores straight alpha
+	mPremultiplied = alpha && imageSource->isPremultiplied();
+
+	mPixelBytes = ImageIo::channelOrderNumChannels( getChannelOrder() ) * ImageIo::dataTypeBytes( getDataType() );
+	mRowBytes = mWidth * mPixelBytes;
+	mData = Buffer( (size_t)mRowBytes * mHeight );
+}
+
+void* ImageTargetFilePng::getRowPointer( int32_t row )
+{
+	return reinterpret_cast<uint8_t*>( mData.getData() ) + row * mRowBytes;
+}
+
+void ImageTargetFilePng::finalize()
+{
+	const bool sixteenBit = getDataType() == ImageIo::UINT16;
+	PngEncoder encoder( reinterpret_cast<uint8_t*>( mData.getData() ), mRowBytes, mPixelBytes, sixteenBit, mPremultiplied, mHeight );
+
+	ip::ExecutionContextRef context = ip::ExecutionContext::getDefault();
+	Area area( 0, 0, mWidth, mHeight );
+	if( sixteenBit || mPremultiplied )
+		context->run( area, std::bind( &PngEncoder::prepare, &encoder, std::_1 ) );
+	context->run( area, std::bind( &PngEncoder::filter, &encoder, std::_1 ) );
+	context->run( area, std::bind( &PngEncoder::deflateBand, &encoder, std::_1 ) );
+	if( encoder.mFailed || encoder.mSegments.empty() )
+		throw ImageIoExceptionFailedWrite();
+
+	// the stream's adler32 is the combination of the segments', in order
+	uLong adler = encoder.mSegments.begin()->second.mAdler;
+	for( std::map<int32_t,PngSegment>::const_iterator segIt = ++encoder.mSegments.begin(); segIt != encoder.mSegments.end(); ++segIt )
+		adler = ::adler32_combine( adler, segIt->second.mAdler, (z_off_t)segIt->second.mFilteredSize );
+	Buffer &lastSegment = encoder.mSegments.rbegin()->second.mData;
+	size_t lastSize = lastSegment.getDataSize();
+	if( lastSegment.getAllocatedSize() < lastSize + 4 )
+		lastSegment.resize( lastSize + 4 );
+	writeBigEndian32( reinterpret_cast<uint8_t*>( lastSegment.getData() ) + lastSize, (uint32_t)adler );
+	lastSegment.setDataSize( lastSize + 4 );
+
+	OStreamRef stream = mDataTarget->getStream();
+	static const uint8_t signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+	stream->writeData( signature, 8 );
+
+	uint8_t header[13];
+	writeBigEndian32( header, mWidth );
+	writeBigEndian32( header + 4, mHeight );
+	header[8] = sixteenBit ? 16 : 8;
+	header[9] = ( ( getColorModel() == ImageIo::CM_GRAY ) ? 0 : 2 ) | ( hasAlpha() ? 4 : 0 ); // color type
+	header[10] = 0; // deflate
+	header[11] = 0; // adaptive filtering
+	header[12] = 0; // no interlacing
+	writeChunk( stream, "IHDR", header, 13 );
+
+	for( std::map<int32_t,PngSegment>::const_iterator segIt = encoder.mSegments.begin(); segIt != encoder.mSegments.end(); ++segIt ) {
+		const uint8_t *data = reinterpret_cast<const uint8_t*>( segIt->second.mData.getData() );
+		size_t size = segIt->second.mData.getDataSize();
+		for( size_t offset = 0; offset < size; offset += PNG_IDAT_SIZE )
+			writeChunk( stream, "IDAT", data + offset, std::min( PNG_IDAT_SIZE, size - offset ) );
+	}
+
+	writeChunk( stream, "IEND", 0, 0 );
+}
+
+} // namespace cinder
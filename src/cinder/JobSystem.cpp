@@ -0,0 +1,310 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/JobSystem.h"
+#include "cinder/System.h"
+
+#include <boost/thread/tss.hpp>
+
+namespace cinder {
+
+class JobSystem::Job {
+  public:
+	Job( const std::function<void()> &fn )
+		: mFn( fn ), mNumPending( 1 ), mFinished( false )
+	{}
+
+	std::function<void()>	mFn;
+	// the following are guarded by JobSystem::mMutex
+	size_t					mNumPending; // unfinished dependencies, plus one until the job has been added
+	bool					mFinished;
+	std::vector<JobRef>		mDependents;
+};
+
+namespace {
+
+struct WorkerId {
+	const JobSystem		*mJobSystem;
+	size_t				mQueueIndex;
+};
+
+void noCleanup( WorkerId * ) {}
+
+boost::thread_specific_ptr<WorkerId>	sWorkerId( noCleanup );
+
+void callRangeFn( const std::function<void(int32_t,int32_t)> *rangeFn, int32_t begin, int32_t end )
+{
+	(*rangeFn)( begin, end );
+}
+
+void callBandFn( const std::function<void(const Area&)> *bandFn, Area band )
+{
+	(*bandFn)( band );
+}
+
+} // anonymous namespace
+
+JobSystem::JobSystem( int32_t numThreads )
+	: mNumQueued( 0 ), mNumSleeping( 0 ), mNumWaiting( 0 ), mQuit( false )
+{
+	if( numThreads <= 0 )
+		numThreads = System::getNumCores();
+
+	// a thread waiting on jobs always helps run them, so we only need numThreads - 1 workers
+	for( int32_t t = 0; t < numThreads; ++t )
+		mQueues.push_back( std::shared_ptr<Queue>( new Queue ) );
+	for( int32_t t = 1; t < numThreads; ++t )
+		mThreads.push_back( std::shared_ptr<std::thread>( new std::thread( std::bind( &JobSystem::threadFn, this, (size_t)t - 1 ) ) ) );
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mQuit = true;
+		mWorkCond.notify_all();
+	}
+
+	for( size_t t = 0; t < mThreads.size(); ++t )
+		mThreads[t]->join();
+}
+
+JobSystemRef JobSystem::getDefault()
+{
+	static JobSystemRef sDefault;
+	static std::mutex sDefaultMutex;
+
+	std::lock_guard<std::mutex> lock( sDefaultMutex );
+	if( ! sDefault )
+		sDefault = JobSystem::create();
+	return sDefault;
+}
+
+JobSystem::JobRef JobSystem::add( const std::function<void()> &fn )
+{
+	return add( fn, std::vector<JobRef>() );
+}
+
+JobSystem::JobRef JobSystem::add( const std::function<void()> &fn, const JobRef &dependency )
+{
+	return add( fn, std::vector<JobRef>( 1, dependency ) );
+}
+
+JobSystem::JobRef JobSystem::add( const std::function<void()> &fn, const std::vector<JobRef> &dependencies )
+{
+	JobRef job( new Job( fn ) );
+	if( ! dependencies.empty() ) {
+		std::lock_guard<std::mutex> lock( mMutex );
+		for( std::vector<JobRef>::const_iterator depIt = dependencies.begin(); depIt != dependencies.end(); ++depIt ) {
+			if( *depIt && ! (*depIt)->mFinished ) {
+				(*depIt)->mDependents.push_back( job );
+				++job->mNumPending;
+			}
+		}
+		if( --job->mNumPending > 0 )
+			return job;
+	}
+
+	schedule( job );
+	return job;
+}
+
+bool JobSystem::isFinished( const JobRef &job )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return job->mFinished;
+}
+
+void JobSystem::wait( const JobRef &job )
+{
+	size_t queueIndex = getQueueIndex();
+	while( true ) {
+		{
+			std::unique_lock<std::mutex> lock( mMutex );
+			if( job->mFinished )
+				return;
+			// sleep only when there's nothing to help with; a finishing job or a newly queued one wakes us
+			if( mNumQueued == 0 ) {
+				++mNumWaiting;
+				mWaitCond.wait( lock );
+				--mNumWaiting;
+				continue;
+			}
+		}
+
+		runNextJob( queueIndex );
+	}
+}
+
+void JobSystem::wait( const std::vector<JobRef> &jobs )
+{
+	for( std::vector<JobRef>::const_iterator jobIt = jobs.begin(); jobIt != jobs.end(); ++jobIt )
+		wait( *jobIt );
+}
+
+void JobSystem::parallelFor( int32_t begin, int32_t end, const std::function<void(int32_t,int32_t)> &rangeFn, int32_t grainSize )
+{
+	if( end <= begin )
+		return;
+
+	// a few chunks per thread lets idle threads steal work from threads which fall behind
+	int64_t count = (int64_t)end - begin;
+	int64_t numChunks = std::min<int64_t>( ( count + std::max<int32_t>( 1, grainSize ) - 1 ) / std::max<int32_t>( 1, grainSize ), getNumThreads() * 4 );
+	if( numChunks <= 1 ) {
+		rangeFn( begin, end );
+		return;
+	}
+
+	std::vector<JobRef> jobs;
+	jobs.reserve( (size_t)numChunks - 1 );
+	for( int64_t c = 1; c < numChunks; ++c )
+		jobs.push_back( add( std::bind( &callRangeFn, &rangeFn, (int32_t)( begin + count * c / numChunks ), (int32_t)( begin + count * ( c + 1 ) / numChunks ) ) ) );
+	rangeFn( begin, (int32_t)( begin + count / numChunks ) );
+	wait( jobs );
+}
+
+void JobSystem::parallelFor( const Area &area, const std::function<void(const Area&)> &bandFn, int32_t minRowsPerBand )
+{
+	if( ( area.getWidth() <= 0 ) || ( area.getHeight() <= 0 ) )
+		return;
+
+	int32_t numBands = std::min<int32_t>( getNumThreads(), std::max<int32_t>( 1, area.getHeight() / std::max<int32_t>( 1, minRowsPerBand ) ) );
+	if( numBands <= 1 ) {
+		bandFn( area );
+		return;
+	}
+
+	std::vector<JobRef> jobs;
+	jobs.reserve( numBands - 1 );
+	for( int32_t b = 0; b < numBands; ++b ) {
+		int32_t y1 = area.getY1() + (int32_t)( (int64_t)area.getHeight() * b / numBands );
+		int32_t y2 = area.getY1() + (int32_t)( (int64_t)area.getHeight() * ( b + 1 ) / numBands );
+		if( b < numBands - 1 )
+			jobs.push_back( add( std::bind( &callBandFn, &bandFn, Area( area.getX1(), y1, area.getX2(), y2 ) ) ) );
+		else
+			bandFn( Area( area.getX1(), y1, area.getX2(), y2 ) );
+	}
+	wait( jobs );
+}
+
+size_t JobSystem::getQueueIndex() const
+{
+	WorkerId *workerId = sWorkerId.get();
+	if( workerId && ( workerId->mJobSystem == this ) )
+		return workerId->mQueueIndex;
+	else
+		return mQueues.size() - 1;
+}
+
+void JobSystem::schedule( const JobRef &job )
+{
+	Queue &queue = *mQueues[getQueueIndex()];
+	{
+		std::lock_guard<std::mutex> lock( queue.mMutex );
+		queue.mJobs.push_back( job );
+	}
+
+	std::lock_guard<std::mutex> lock( mMutex );
+	++mNumQueued;
+	if( mNumSleeping > 0 )
+		mWorkCond.notify_one();
+	if( mNumWaiting > 0 )
+		mWaitCond.notify_all();
+}
+
+void JobSystem::release( const JobRef &job )
+{
+	std::vector<JobRef> ready;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		job->mFinished = true;
+		for( std::vector<JobRef>::iterator depIt = job->mDependents.begin(); depIt != job->mDependents.end(); ++depIt )
+			if( --(*depIt)->mNumPending == 0 )
+				ready.push_back( *depIt );
+		job->mDependents.clear();
+		if( mNumWaiting > 0 )
+			mWaitCond.notify_all();
+	}
+
+	for( std::vector<JobRef>::iterator readyIt = ready.begin(); readyIt != ready.end(); ++readyIt )
+		schedule( *readyIt );
+}
+
+bool JobSystem::runNextJob( size_t queueIndex )
+{
+	// our own queue is used last-in first-out for locality; other queues are stolen from first-in first-out
+	JobRef job;
+	for( size_t q = 0; ( q < mQueues.size() ) && ( ! job ); ++q ) {
+		Queue &queue = *mQueues[( queueIndex + q ) % mQueues.size()];
+		std::lock_guard<std::mutex> lock( queue.mMutex );
+		if( queue.mJobs.empty() )
+			continue;
+		if( ( q == 0 ) && ( queueIndex < mThreads.size() ) ) {
+			job = queue.mJobs.back();
+			queue.mJobs.pop_back();
+		}
+		else {
+			job = queue.mJobs.front();
+			queue.mJobs.pop_front();
+		}
+	}
+	if( ! job )
+		return false;
+
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		--mNumQueued;
+	}
+
+	job->mFn();
+	job->mFn = std::function<void()>(); // release anything bound to the function
+	release( job );
+	return true;
+}
+
+void JobSystem::threadFn( size_t queueIndex )
+{
+	ThreadSetup threadSetup;
+	WorkerId workerId = { this, queueIndex };
+	sWorkerId.reset( &workerId );
+
+	while( true ) {
+		if( runNextJob( queueIndex ) )
+			continue;
+
+		std::unique_lock<std::mutex> lock( mMutex );
+		while( ( ! mQuit ) && ( mNumQueued == 0 ) ) {
+			++mNumSleeping;
+			mWorkCond.wait( lock );
+			--mNumSleeping;
+		}
+		if( mQuit )
+			break;
+	}
+
+	sWorkerId.release();
+}
+
+} // namespace cinder
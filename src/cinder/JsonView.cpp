@@ -0,0 +1,694 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/JsonView.h"
+#include "cinder/Utilities.h"
+
+#include <boost/algorithm/string.hpp>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace std;
+
+namespace cinder {
+
+struct JsonView::Node {
+	uint8_t		mType;
+	bool		mIsInteger, mIsNegative;	// for numbers; mInteger holds the magnitude of integers which fit in 64 bits
+	uint32_t	mKeySize, mValueSize, mNumChildren;
+	const char	*mKey, *mValue;
+	double		mNumber;
+	uint64_t	mInteger;
+	Node		*mParent, *mFirstChild, *mLastChild, *mNext;
+};
+
+struct JsonView::Document {
+	Document() : mBlockUsed( NODES_PER_BLOCK ) {}
+	~Document()
+	{
+		for( vector<Node*>::iterator blockIt = mBlocks.begin(); blockIt != mBlocks.end(); ++blockIt )
+			delete [] *blockIt;
+	}
+
+	//! Returns a zeroed node from the current block, starting a new block when it's full
+	Node* allocate()
+	{
+		if( mBlockUsed == NODES_PER_BLOCK ) {
+			mBlocks.push_back( new Node[NODES_PER_BLOCK] );
+			mBlockUsed = 0;
+		}
+		Node *result = &mBlocks.back()[mBlockUsed++];
+		memset( result, 0, sizeof( Node ) );
+		return result;
+	}
+
+	static const size_t		NODES_PER_BLOCK = 4096;
+
+	shared_ptr<char>		mText;	// the parsed copy of the input, which the nodes point into
+	vector<Node*>			mBlocks;
+	size_t					mBlockUsed;
+	Node					*mRoot;
+};
+
+namespace {
+
+typedef JsonView::Node Node;
+
+class ParseError {
+  public:
+	ParseError( const string &message, size_t offset ) : mMessage( message ), mOffset( offset ) {}
+
+	string		mMessage;
+	size_t		mOffset;
+};
+
+// Single-pass parser which builds nodes as it reads and decodes strings in place
+class Parser {
+  public:
+	Parser( char *text, JsonView::Document *document ) : mText( text ), mP( text ), mDocument( document ) {}
+
+	Node*	parse();
+
+  private:
+	void	skipWhitespace() { while( ( *mP == ' ' ) || ( *mP == '\t' ) || ( *mP == '\n' ) || ( *mP == '\r' ) ) ++mP; }
+	void	error( const char *message ) const { throw ParseError( message, mP - mText ); }
+	void	parseString( const char **result, uint32_t *size );
+	void	parseNumber( Node *node );
+	void	parseLiteral( const char *literal, size_t length );
+	uint32_t	parseHex4();
+
+	char				*mText, *mP;
+	JsonView::Document	*mDocument;
+};
+
+Node* Parser::parse()
+{
+	Node *root = 0, *container = 0;
+	while( true ) {
+		skipWhitespace();
+		Node *node = mDocument->allocate();
+		if( container ) {
+			if( container->mType == JsonView::NODE_OBJECT ) {
+				if( *mP != '"' )
+					error( "expected a string key" );
+				parseString( &node->mKey, &node->mKeySize );
+				skipWhitespace();
+				if( *mP != ':' )
+					error( "expected ':'" );
+				++mP;
+				skipWhitespace();
+			}
+			node->mParent = container;
+			if( container->mLastChild )
+				container->mLastChild->mNext = node;
+			else
+				container->mFirstChild = node;
+			container->mLastChild = node;
+			++container->mNumChildren;
+		}
+		else
+			root = node;
+
+		bool opened = false;
+		switch( *mP ) {
+			case '{':
+			case '[': {
+				node->mType = ( *mP == '{' ) ? JsonView::NODE_OBJECT : JsonView::NODE_ARRAY;
+				char close = ( *mP == '{' ) ? '}' : ']';
+				++mP;
+				skipWhitespace();
+				if( *mP == close )
+					++mP;
+				else {
+					container = node;
+					opened = true;
+				}
+			}
+			break;
+			case '"':
+				node->mType = JsonView::NODE_STRING;
+				parseString( &node->mValue, &node->mValueSize );
+			break;
+			case 't':
+				node->mType = JsonView::NODE_BOOL;
+				node->mValue = mP;
+				node->mValueSize = 4;
+				parseLiteral( "true", 4 );
+			break;
+			case 'f':
+				node->mType = JsonView::NODE_BOOL;
+				node->mValue = mP;
+				node->mValueSize = 5;
+				parseLiteral( "false", 5 );
+			break;
+			case 'n':
+				node->mType = JsonView::NODE_NULL;
+				parseLiteral( "null", 4 );
+			break;
+			default:
+				if( ( *mP == '-' ) || ( ( *mP >= '0' ) && ( *mP <= '9' ) ) )
+					parseNumber( node );
+				else
+					error( ( *mP ) ? "unexpected character" : "unexpected end of document" );
+		}
+		if( opened )
+			continue;
+
+		// finished a value; close any containers that end here and move on to the next value
+		while( true ) {
+			skipWhitespace();
+			if( ! container ) {
+				if( *mP )
+					error( "unexpected data after the root value" );
+				return root;
+			}
+			if( *mP == ',' ) {
+				++mP;
+				break;
+			}
+			else if( ( *mP == '}' && ( container->mType == JsonView::NODE_OBJECT ) ) || ( *mP == ']' && ( container->mType == JsonView::NODE_ARRAY ) ) ) {
+				++mP;
+				container = container->mParent;
+			}
+			else
+				error( ( container->mType == JsonView::NODE_OBJECT ) ? "expected ',' or '}'" : "expected ',' or ']'" );
+		}
+	}
+}
+
+uint32_t Parser::parseHex4()
+{
+	uint32_t result = 0;
+	for( int i = 0; i < 4; ++i, ++mP ) {
+		char c = *mP;
+		result <<= 4;
+		if( ( c >= '0' ) && ( c <= '9' ) ) result |= c - '0';
+		else if( ( c >= 'a' ) && ( c <= 'f' ) ) result |= c - 'a' + 10;
+		else if( ( c >= 'A' ) && ( c <= 'F' ) ) result |= c - 'A' + 10;
+		else error( "invalid \\u escape" );
+	}
+	return result;
+}
+
+// decodes the string at mP in place and zero-terminates it; the decoded form is never longer than the escaped one
+void Parser::parseString( const char **result, uint32_t *size )
+{
+	++mP;
+	char *start = mP;
+	// fast path: most strings contain no escapes
+	while( ( *mP != '"' ) && ( *mP != '\\' ) && *mP )
+		++mP;
+	char *out = mP;
+
+	while( *mP != '"' ) {
+		if( ! *mP )
+			error( "unterminated string" );
+		if( *mP != '\\' ) {
+			*out++ = *mP++;
+			continue;
+		}
+
+		++mP;
+		switch( *mP++ ) {
+			case '"': *out++ = '"'; break;
+			case '\\': *out++ = '\\'; break;
+			case '/': *out++ = '/'; break;
+			case 'b': *out++ = '\b'; break;
+			case 'f': *out++ = '\f'; break;
+			case 'n': *out++ = '\n'; break;
+			case 'r': *out++ = '\r'; break;
+			case 't': *out++ = '\t'; break;
+			case 'u': {
+				uint32_t codePoint = parseHex4();
+				if( ( codePoint >= 0xD800 ) && ( codePoint < 0xDC00 ) && ( mP[0] == '\\' ) && ( mP[1] == 'u' ) ) { // surrogate pair
+					mP += 2;
+					uint32_t low = parseHex4();
+					if( ( low >= 0xDC00 ) && ( low < 0xE000 ) )
+						codePoint = 0x10000 + ( ( codePoint - 0xD800 ) << 10 ) + ( low - 0xDC00 );
+				}
+				if( codePoint < 0x80 )
+					*out++ = (char)codePoint;
+				else if( codePoint < 0x800 ) {
+					*out++ = (char)( 0xC0 | ( codePoint >> 6 ) );
+					*out++ = (char)( 0x80 | ( codePoint & 0x3F ) );
+				}
+				else if( codePoint < 0x10000 ) {
+					*out++ = (char)( 0xE0 | ( codePoint >> 12 ) );
+					*out++ = (char)( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) );
+					*out++ = (char)( 0x80 | ( codePoint & 0x3F ) );
+				}
+				else {
+					*out++ = (char)( 0xF0 | ( codePoint >> 18 ) );
+					*out++ = (char)( 0x80 | ( ( codePoint >> 12 ) & 0x3F ) );
+					*out++ = (char)( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) );
+					*out++ = (char)( 0x80 | ( codePoint & 0x3F ) );
+				}
+			}
+			break;
+			default:
+				--mP;
+				error( "invalid escape" );
+		}
+	}
+
+	*out = 0;
+	++mP;
+	*result = start;
+	*size = (uint32_t)( out - start );
+}
+
+void Parser::parseLiteral( const char *literal, size_t length )
+{
+	if( strncmp( mP, literal, length ) != 0 )
+		error( "invalid literal" );
+	mP += length;
+}
+
+// Parses the number at mP. When the decimal significand fits in 19 digits and the power of ten is within 10^22, the result
+// of one multiplication or division of exactly representable doubles is correctly rounded; anything else falls back to strtod()
+void Parser::parseNumber( Node *node )
+{
+	static const double sPowersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16,
+		1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	char *start = mP;
+	bool negative = ( *mP == '-' );
+	if( negative )
+		++mP;
+	if( ( *mP < '0' ) || ( *mP > '9' ) )
+		error( "expected a digit" );
+
+	uint64_t significand = 0;
+	int digits = 0, exponent = 0;
+	bool truncated = false;
+	while( ( *mP >= '0' ) && ( *mP <= '9' ) ) {
+		if( digits < 19 ) {
+			significand = significand * 10 + ( *mP - '0' );
+			if( significand )
+				++digits;
+		}
+		else {
+			++exponent;
+			truncated = true;
+		}
+		++mP;
+	}
+
+	bool isInteger = true;
+	if( *mP == '.' ) {
+		isInteger = false;
+		++mP;
+		if( ( *mP < '0' ) || ( *mP > '9' ) )
+			error( "expected a digit" );
+		while( ( *mP >= '0' ) && ( *mP <= '9' ) ) {
+			if( digits < 19 ) {
+				significand = significand * 10 + ( *mP - '0' );
+				if( significand )
+					++digits;
+				--exponent;
+			}
+			else if( *mP != '0' )
+				truncated = true;
+			++mP;
+		}
+	}
+
+	if( ( *mP == 'e' ) || ( *mP == 'E' ) ) {
+		isInteger = false;
+		++mP;
+		bool negativeExponent = ( *mP == '-' );
+		if( ( *mP == '-' ) || ( *mP == '+' ) )
+			++mP;
+		if( ( *mP < '0' ) || ( *mP > '9' ) )
+			error( "expected a digit" );
+		int explicitExponent = 0;
+		while( ( *mP >= '0' ) && ( *mP <= '9' ) ) {
+			if( explicitExponent < 100000 )
+				explicitExponent = explicitExponent * 10 + ( *mP - '0' );
+			++mP;
+		}
+		exponent += ( negativeExponent ) ? -explicitExponent : explicitExponent;
+	}
+
+	node->mType = JsonView::NODE_NUMBER;
+	node->mValue = start;
+	node->mValueSize = (uint32_t)( mP - start );
+	node->mIsNegative = negative;
+
+	if( isInteger && ( ! truncated ) ) {
+		node->mIsInteger = true;
+		node->mInteger = significand;
+		node->mNumber = ( negative ) ? -(double)significand : (double)significand;
+	}
+	else if( isInteger && ( mP - start - ( negative ? 1 : 0 ) == 20 ) && ( ! negative ) ) { // may still fit in a uint64_t
+		errno = 0;
+		unsigned long long value = strtoull( start, 0, 10 );
+		node->mIsInteger = ( errno == 0 );
+		node->mInteger = value;
+		node->mNumber = strtod( start, 0 );
+	}
+	else if( ( ! truncated ) && ( significand < ( 1ULL << 53 ) ) && ( exponent >= -22 ) && ( exponent <= 22 ) ) {
+		double value = ( exponent < 0 ) ? (double)significand / sPowersOfTen[-exponent] : (double)significand * sPowersOfTen[exponent];
+		node->mNumber = ( negative ) ? -value : value;
+	}
+	else
+		node->mNumber = strtod( start, 0 );
+}
+
+// whether a path component addresses a child by position
+bool isIndex( const string &key )
+{
+	if( key.empty() )
+		return false;
+	for( string::const_iterator c = key.begin(); c != key.end(); ++c )
+		if( ( *c < '0' ) || ( *c > '9' ) )
+			return false;
+	return true;
+}
+
+void appendTree( JsonTree *parent, const Node *node );
+
+JsonTree createTree( const Node *node )
+{
+	string key( node->mKey, node->mKeySize );
+	switch( node->mType ) {
+		case JsonView::NODE_BOOL:
+			return JsonTree( key, node->mValue[0] == 't' );
+		case JsonView::NODE_NUMBER:
+			if( node->mIsInteger && node->mIsNegative && ( node->mInteger <= (uint64_t)numeric_limits<int64_t>::max() + 1 ) )
+				return JsonTree( key, (int64_t)( 0 - node->mInteger ) );
+			else if( node->mIsInteger && ( ! node->mIsNegative ) && ( node->mInteger <= (uint64_t)numeric_limits<int64_t>::max() ) )
+				return JsonTree( key, (int64_t)node->mInteger );
+			else if( node->mIsInteger && ( ! node->mIsNegative ) )
+				return JsonTree( key, node->mInteger );
+			else
+				return JsonTree( key, node->mNumber );
+		case JsonView::NODE_STRING:
+			return JsonTree( key, string( node->mValue, node->mValueSize ) );
+		case JsonView::NODE_ARRAY: {
+			JsonTree result = JsonTree::makeArray( key );
+			for( const Node *child = node->mFirstChild; child; child = child->mNext )
+				result.pushBack( createTree( child ) );
+			return result;
+		}
+		case JsonView::NODE_OBJECT: {
+			JsonTree result = JsonTree::makeObject( key );
+			for( const Node *child = node->mFirstChild; child; child = child->mNext )
+				result.pushBack( createTree( child ) );
+			return result;
+		}
+		default: // JsonTree represents a parsed null as an empty string value
+			return JsonTree( key, string() );
+	}
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// JsonView
+JsonView::JsonView( DataSourceRef dataSource, JsonTree::ParseOptions parseOptions )
+	: mNode( 0 )
+{
+	Buffer buf = loadDataSourceBuffer( dataSource );
+	parse( static_cast<const char*>( buf.getData() ), buf.getDataSize(), parseOptions );
+}
+
+JsonView::JsonView( const std::string &jsonString, JsonTree::ParseOptions parseOptions )
+	: mNode( 0 )
+{
+	parse( jsonString.c_str(), jsonString.size(), parseOptions );
+}
+
+void JsonView::parse( const char *text, size_t size, const JsonTree::ParseOptions &parseOptions )
+{
+	mDocument = shared_ptr<Document>( new Document );
+	mDocument->mText = shared_ptr<char>( new char[size+1], checked_array_deleter<char>() );
+	memcpy( mDocument->mText.get(), text, size );
+	mDocument->mText.get()[size] = 0;
+
+	try {
+		mNode = Parser( mDocument->mText.get(), mDocument.get() ).parse();
+	}
+	catch( ParseError &error ) {
+		if( ! parseOptions.getIgnoreErrors() )
+			throw JsonTree::ExcJsonParserError( error.mMessage + " at byte " + toString( error.mOffset ) );
+		// a null root, which keeps nothing of the partial parse
+		mDocument = shared_ptr<Document>( new Document );
+		mNode = mDocument->allocate();
+		mNode->mType = NODE_NULL;
+	}
+}
+
+JsonView::NodeType JsonView::getNodeType() const
+{
+	return ( mNode ) ? (NodeType)mNode->mType : NODE_NULL;
+}
+
+StringRef JsonView::getKey() const
+{
+	return ( mNode ) ? StringRef( mNode->mKey ? mNode->mKey : "", mNode->mKeySize ) : StringRef();
+}
+
+StringRef JsonView::getValue() const
+{
+	return ( mNode && mNode->mValue ) ? StringRef( mNode->mValue, mNode->mValueSize ) : StringRef();
+}
+
+size_t JsonView::getNumChildren() const
+{
+	return ( mNode ) ? mNode->mNumChildren : 0;
+}
+
+JsonView JsonView::getChild( const std::string &relativePath, bool caseSensitive, char separator ) const
+{
+	Node *child = getNodePtr( relativePath, caseSensitive, separator );
+	if( child )
+		return JsonView( mDocument, child );
+	else
+		throw ExcChildNotFound( *this, relativePath );
+}
+
+JsonView JsonView::getChild( size_t index ) const
+{
+	Node *child = ( mNode ) ? mNode->mFirstChild : 0;
+	for( size_t i = 0; child && ( i < index ); ++i )
+		child = child->mNext;
+	if( child )
+		return JsonView( mDocument, child );
+	else
+		throw ExcChildNotFound( *this, toString( index ) );
+}
+
+// follows the same path syntax as JsonTree::getNodePtr()
+JsonView::Node* JsonView::getNodePtr( const std::string &relativePath, bool caseSensitive, char separator ) const
+{
+	string path = boost::replace_all_copy( relativePath, "[", string( 1, separator ) );
+	boost::erase_all( path, "'" );
+	boost::erase_all( path, "]" );
+
+	Node *curNode = mNode;
+	if( ! curNode )
+		return 0;
+
+	vector<string> pathComponents = split( path, separator );
+	for( vector<string>::const_iterator pathIt = pathComponents.begin(); pathIt != pathComponents.end(); ++pathIt ) {
+		Node *child = curNode->mFirstChild;
+		if( isIndex( *pathIt ) ) {
+			size_t index = atol( pathIt->c_str() );
+			for( size_t i = 0; child && ( i < index ); ++i )
+				child = child->mNext;
+		}
+		else {
+			while( child && ( ! StringRef( child->mKey ? child->mKey : "", child->mKeySize ).equals( *pathIt, caseSensitive ) ) )
+				child = child->mNext;
+		}
+
+		if( ! child )
+			return 0;
+		curNode = child;
+	}
+
+	return curNode;
+}
+
+bool JsonView::hasParent() const
+{
+	return mNode && mNode->mParent;
+}
+
+JsonView JsonView::getParent() const
+{
+	return JsonView( mDocument, ( mNode ) ? mNode->mParent : 0 );
+}
+
+std::string JsonView::getPath( char separator ) const
+{
+	string result;
+	bool prevWasArrayIndex = false;
+	for( const Node *node = mNode; node; node = node->mParent ) {
+		string nodeName( node->mKey ? node->mKey : "", node->mKeySize );
+		bool isArrayIndex = false;
+		if( nodeName.empty() && node->mParent ) {
+			size_t index = 0;
+			for( const Node *sibling = node->mParent->mFirstChild; sibling != node; sibling = sibling->mNext )
+				++index;
+			nodeName = '[' + toString( index ) + ']';
+			isArrayIndex = true;
+		}
+		if( ( ! prevWasArrayIndex ) && ( ! nodeName.empty() ) && ( node != mNode ) )
+			result = nodeName + separator + result;
+		else if( ! nodeName.empty() )
+			result = nodeName + result;
+		prevWasArrayIndex = isArrayIndex;
+	}
+	return result;
+}
+
+JsonView::ConstIter JsonView::begin() const
+{
+	return ConstIter( JsonView( mDocument, ( mNode ) ? mNode->mFirstChild : 0 ) );
+}
+
+JsonView::ConstIter JsonView::end() const
+{
+	return ConstIter();
+}
+
+JsonTree JsonView::toJsonTree() const
+{
+	return ( mNode ) ? createTree( mNode ) : JsonTree();
+}
+
+JsonView::ConstIter& JsonView::ConstIter::operator++()
+{
+	mCurrent.mNode = mCurrent.mNode->mNext;
+	return *this;
+}
+
+template<>
+bool JsonView::getValue<bool>() const
+{
+	if( isBool() )
+		return mNode->mValue[0] == 't';
+	else if( isNumber() )
+		return mNode->mNumber != 0;
+	try {
+		return getValue().as<bool>();
+	}
+	catch( boost::bad_lexical_cast & ) {
+		throw ExcNonConvertible( *this );
+	}
+}
+
+template<>
+double JsonView::getValue<double>() const
+{
+	if( isNumber() )
+		return mNode->mNumber;
+	else if( isBool() )
+		return ( mNode->mValue[0] == 't' ) ? 1 : 0;
+	try {
+		return getValue().as<double>();
+	}
+	catch( boost::bad_lexical_cast & ) {
+		throw ExcNonConvertible( *this );
+	}
+}
+
+template<>
+float JsonView::getValue<float>() const
+{
+	return (float)getValue<double>();
+}
+
+namespace {
+
+typedef enum { INTEGER_NONE, INTEGER_OK, INTEGER_OUT_OF_RANGE } IntegerResult;
+
+// converts an integer node to T after checking its range; other values go through text like JsonTree::getValue()
+template<typename T>
+IntegerResult getInteger( const Node *node, T *result )
+{
+	if( ( ! node ) || ( node->mType != JsonView::NODE_NUMBER ) || ( ! node->mIsInteger ) )
+		return INTEGER_NONE;
+
+	if( node->mIsNegative ) {
+		if( ( ! numeric_limits<T>::is_signed ) && ( node->mInteger != 0 ) )
+			return INTEGER_OUT_OF_RANGE;
+		if( numeric_limits<T>::is_signed && ( node->mInteger > (uint64_t)numeric_limits<T>::max() + 1 ) )
+			return INTEGER_OUT_OF_RANGE;
+		*result = (T)( 0 - node->mInteger );
+	}
+	else {
+		if( node->mInteger > (uint64_t)numeric_limits<T>::max() )
+			return INTEGER_OUT_OF_RANGE;
+		*result = (T)node->mInteger;
+	}
+	return INTEGER_OK;
+}
+
+} // anonymous namespace
+
+#define JSONVIEW_INTEGER_GETVALUE( T )													\
+	template<>																			\
+	T JsonView::getValue<T>() const														\
+	{																					\
+		T result;																		\
+		IntegerResult integer = getInteger( mNode, &result );							\
+		if( integer == INTEGER_OK )														\
+			return result;																\
+		else if( integer == INTEGER_OUT_OF_RANGE )										\
+			throw ExcNonConvertible( *this );											\
+		else if( isBool() )																\
+			return ( mNode->mValue[0] == 't' ) ? 1 : 0;									\
+		try {																			\
+			return getValue().as<T>();													\
+		}																				\
+		catch( boost::bad_lexical_cast & ) {											\
+			throw ExcNonConvertible( *this );											\
+		}																				\
+	}
+
+JSONVIEW_INTEGER_GETVALUE( int32_t )
+JSONVIEW_INTEGER_GETVALUE( uint32_t )
+JSONVIEW_INTEGER_GETVALUE( int64_t )
+JSONVIEW_INTEGER_GETVALUE( uint64_t )
+
+JsonView::ExcChildNotFound::ExcChildNotFound( const JsonView &node, const string &childPath ) throw()
+{
+	sprintf( mMessage, "Could not find child: %s for node: %s", childPath.c_str(), node.getPath().c_str() );
+}
+
+JsonView::ExcNonConvertible::ExcNonConvertible( const JsonView &node ) throw()
+{
+	sprintf( mMessage, "Unable to convert value for node: %s", node.getPath().c_str() );
+}
+
+} // namespace cinder
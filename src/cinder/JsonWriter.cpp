@@ -0,0 +1,390 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/JsonWriter.h"
+#include "cinder/Utilities.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+bool isWhitespace( char c )
+{
+	return ( c == ' ' ) || ( c == '\t' ) || ( c == '\n' ) || ( c == '\r' );
+}
+
+// returns the offset of the last non-whitespace byte before \a end and stores it in \a found, or returns -1 if there is none
+long findLastNonWhitespace( FILE *file, long end, char *found )
+{
+	char buffer[4096];
+	while( end > 0 ) {
+		long start = std::max<long>( 0, end - (long)sizeof( buffer ) );
+		if( ( fseek( file, start, SEEK_SET ) != 0 ) || ( fread( buffer, 1, end - start, file ) != (size_t)( end - start ) ) )
+			return -1;
+		for( long i = end - start - 1; i >= 0; --i ) {
+			if( ! isWhitespace( buffer[i] ) ) {
+				*found = buffer[i];
+				return start + i;
+			}
+		}
+		end = start;
+	}
+	return -1;
+}
+
+} // anonymous namespace
+
+JsonWriter::JsonWriter( OStreamRef stream, bool indent )
+	: mStream( stream )
+{
+	init( indent );
+}
+
+JsonWriter::JsonWriter( DataTargetRef target, bool indent )
+	: mStream( target->getStream() )
+{
+	init( indent );
+}
+
+void JsonWriter::init( bool indent )
+{
+	mIndent = indent;
+	mAfterKey = mWroteRoot = mClosed = mAppending = false;
+	mAppendEnd = 0;
+	mBuffer.reserve( FLUSH_SIZE + 1024 );
+}
+
+JsonWriter::~JsonWriter()
+{
+	try {
+		close();
+	}
+	catch( ... ) {
+	}
+}
+
+JsonWriterRef JsonWriter::appendToArray( const fs::path &path, bool indent )
+{
+	string fullPath = expandPath( path ).string();
+	FILE *file = fopen( fullPath.c_str(), "r+b" );
+	if( ! file )
+		file = fopen( fullPath.c_str(), "w+b" );
+	if( ! file )
+		throw ExcInvalidFile( path );
+
+	fseek( file, 0, SEEK_END );
+	long size = ftell( file );
+	char closing = 0, previous = 0;
+	long closingPos = findLastNonWhitespace( file, size, &closing );
+	long previousPos = ( closingPos > 0 ) ? findLastNonWhitespace( file, closingPos, &previous ) : -1;
+	if( ( closingPos >= 0 ) && ( ( closing != ']' ) || ( previousPos < 0 ) ) ) {
+		fclose( file );
+		throw ExcInvalidFile( path );
+	}
+
+	// new content starts right after the last element and overwrites the closing bracket, padded with spaces up to the old end of the file
+	fseek( file, previousPos + 1, SEEK_SET );
+	OStreamFileRef stream = OStreamFile::create( file, true );
+	stream->setFileName( path );
+	JsonWriterRef result( new JsonWriter( stream, indent ) );
+	if( closingPos >= 0 ) {
+		result->mStack.push_back( Container( false, previous != '[' ) );
+		result->mWroteRoot = true;
+		result->mAppendEnd = size;
+	}
+	else
+		result->beginArray();
+	result->mAppending = true;
+	result->flush();
+	return result;
+}
+
+void JsonWriter::beginValue()
+{
+	if( mClosed )
+		throw ExcInvalidState( "the writer has been closed" );
+	if( mStack.empty() ) {
+		if( mWroteRoot )
+			throw ExcInvalidState( "a document can only have one root value" );
+		mWroteRoot = true;
+		return;
+	}
+
+	Container &container = mStack.back();
+	if( container.mIsObject ) {
+		if( ! mAfterKey )
+			throw ExcInvalidState( "members of an object need a key" );
+		mAfterKey = false;
+	}
+	else {
+		if( container.mHasElements )
+			append( ',' );
+		container.mHasElements = true;
+		writeNewLine();
+	}
+}
+
+void JsonWriter::writeNewLine()
+{
+	if( mIndent ) {
+		append( '\n' );
+		mBuffer.append( mStack.size() * 3, ' ' );
+	}
+}
+
+JsonWriter& JsonWriter::beginObject()
+{
+	beginValue();
+	append( '{' );
+	mStack.push_back( Container( true, false ) );
+	return *this;
+}
+
+JsonWriter& JsonWriter::endObject()
+{
+	endContainer( true );
+	return *this;
+}
+
+JsonWriter& JsonWriter::beginArray()
+{
+	beginValue();
+	append( '[' );
+	mStack.push_back( Container( false, false ) );
+	return *this;
+}
+
+JsonWriter& JsonWriter::endArray()
+{
+	endContainer( false );
+	return *this;
+}
+
+void JsonWriter::endContainer( bool isObject )
+{
+	if( mStack.empty() || ( mStack.back().mIsObject != isObject ) )
+		throw ExcInvalidState( isObject ? "no object is open" : "no array is open" );
+	if( mAfterKey )
+		throw ExcInvalidState( "a key has no value" );
+
+	bool hasElements = mStack.back().mHasElements;
+	mStack.pop_back();
+	if( hasElements )
+		writeNewLine();
+	append( isObject ? '}' : ']' );
+}
+
+JsonWriter& JsonWriter::key( const std::string &key )
+{
+	if( mStack.empty() || ( ! mStack.back().mIsObject ) )
+		throw ExcInvalidState( "keys can only be written in an object" );
+	if( mAfterKey )
+		throw ExcInvalidState( "the previous key has no value" );
+
+	Container &container = mStack.back();
+	if( container.mHasElements )
+		append( ',' );
+	container.mHasElements = true;
+	writeNewLine();
+	writeString( key.data(), key.size() );
+	if( mIndent )
+		append( " : ", 3 );
+	else
+		append( ':' );
+	mAfterKey = true;
+	return *this;
+}
+
+JsonWriter& JsonWriter::value( bool value )
+{
+	beginValue();
+	if( value )
+		append( "true", 4 );
+	else
+		append( "false", 5 );
+	return *this;
+}
+
+JsonWriter& JsonWriter::value( int32_t value )
+{
+	return this->value( (int64_t)value );
+}
+
+JsonWriter& JsonWriter::value( uint32_t value )
+{
+	return this->value( (uint64_t)value );
+}
+
+JsonWriter& JsonWriter::value( int64_t value )
+{
+	beginValue();
+	char text[32];
+	int length = sprintf( text, "%lld", (long long)value );
+	append( text, length );
+	return *this;
+}
+
+JsonWriter& JsonWriter::value( uint64_t value )
+{
+	beginValue();
+	char text[32];
+	int length = sprintf( text, "%llu", (unsigned long long)value );
+	append( text, length );
+	return *this;
+}
+
+JsonWriter& JsonWriter::value( double value )
+{
+	if( ( value != value ) || ( value - value != 0 ) ) // NaN or infinite
+		return null();
+
+	beginValue();
+	// 15 significant digits are enough for most values and read better; 17 always round trip
+	char text[32];
+	int length = sprintf( text, "%.15g", value );
+	if( strtod( text, 0 ) != value )
+		length = sprintf( text, "%.17g", value );
+	append( text, length );
+	return *this;
+}
+
+JsonWriter& JsonWriter::value( const std::string &value )
+{
+	beginValue();
+	writeString( value.data(), value.size() );
+	return *this;
+}
+
+JsonWriter& JsonWriter::value( const char *value )
+{
+	beginValue();
+	writeString( value, strlen( value ) );
+	return *this;
+}
+
+JsonWriter& JsonWriter::null()
+{
+	beginValue();
+	append( "null", 4 );
+	return *this;
+}
+
+JsonWriter& JsonWriter::rawValue( const std::string &json )
+{
+	beginValue();
+	append( json.data(), json.size() );
+	return *this;
+}
+
+void JsonWriter::writeString( const char *s, size_t length )
+{
+	append( '"' );
+	const char *run = s;
+	for( size_t i = 0; i < length; ++i ) {
+		unsigned char c = s[i];
+		if( ( c >= 0x20 ) && ( c != '"' ) && ( c != '\\' ) )
+			continue;
+
+		append( run, s + i - run );
+		run = s + i + 1;
+		switch( c ) {
+			case '"': append( "\\\"", 2 ); break;
+			case '\\': append( "\\\\", 2 ); break;
+			case '\n': append( "\\n", 2 ); break;
+			case '\r': append( "\\r", 2 ); break;
+			case '\t': append( "\\t", 2 ); break;
+			case '\b': append( "\\b", 2 ); break;
+			case '\f': append( "\\f", 2 ); break;
+			default: {
+				char escape[8];
+				sprintf( escape, "\\u%04x", c );
+				append( escape, 6 );
+			}
+		}
+	}
+	append( run, s + length - run );
+	append( '"' );
+}
+
+void JsonWriter::writeBuffer()
+{
+	if( ! mBuffer.empty() ) {
+		mStream->writeData( mBuffer.data(), mBuffer.size() );
+		mBuffer.clear();
+	}
+}
+
+void JsonWriter::flush()
+{
+	writeBuffer();
+	if( mAppending && ( mStack.size() == 1 ) && ( ! mClosed ) ) {
+		// leave a complete array in the file, to be overwritten by whatever is written next
+		string closing = ( mIndent ) ? "\n]" : "]";
+		off_t end = mStream->tell() + (off_t)closing.size();
+		if( end < mAppendEnd )
+			closing.append( (size_t)( mAppendEnd - end ), ' ' );
+		mStream->writeData( closing.data(), closing.size() );
+		mStream->seekRelative( -(off_t)closing.size() );
+	}
+}
+
+void JsonWriter::close()
+{
+	if( mClosed )
+		return;
+
+	if( mAfterKey )
+		null();
+	while( ! mStack.empty() )
+		endContainer( mStack.back().mIsObject );
+	if( mIndent && mWroteRoot )
+		append( '\n' );
+	writeBuffer();
+	if( mAppending && ( mStream->tell() < mAppendEnd ) ) {
+		string padding( (size_t)( mAppendEnd - mStream->tell() ), ' ' );
+		mStream->writeData( padding.data(), padding.size() );
+	}
+	mClosed = true;
+}
+
+JsonWriter::ExcInvalidState::ExcInvalidState( const char *description ) throw()
+{
+	sprintf( mMessage, "Invalid JSON structure: %s", description );
+}
+
+JsonWriter::ExcInvalidFile::ExcInvalidFile( const fs::path &path ) throw()
+{
+	sprintf( mMessage, "Could not append to a JSON array in file: %s", path.string().c_str() );
+}
+
+} // namespace cinder
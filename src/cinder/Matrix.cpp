@@ -21,6 +21,7 @@
 */
 
 #include "cinder/Matrix.h"
+#include "cinder/ip/ExecutionContext.h"
 
 namespace cinder {
 
@@ -145,4 +146,181 @@ template Matrix44d firstFrame( const Vec3d &firstPoint, const Vec3d &secondPoint
 template Matrix44d nextFrame( const Matrix44d &prevMatrix, const Vec3d &prevPoint, const Vec3d &curPoint, Vec3d &prevTangent, Vec3d &curTangent );
 template Matrix44d lastFrame( const Matrix44d &prevMatrix, const Vec3d &prevPoint, 	const Vec3d &lastPoint );
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+// Batch transforms
+namespace {
+
+// arrays shorter than this aren't worth splitting across threads
+const size_t MIN_PARALLEL_POINTS = 16384;
+
+#if defined( CINDER_SIMD_MATH_SSE )
+// deinterleaves the 4 Vec3f's at \a p into their x, y and z components
+inline void loadPoints( const float *p, __m128 *x, __m128 *y, __m128 *z )
+{
+	const __m128 a = _mm_loadu_ps( p ), b = _mm_loadu_ps( p + 4 ), c = _mm_loadu_ps( p + 8 ); // x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+	*x = _mm_shuffle_ps( a, _mm_shuffle_ps( b, c, _MM_SHUFFLE( 1, 1, 2, 2 ) ), _MM_SHUFFLE( 2, 0, 3, 0 ) );
+	*y = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 0, 0, 1, 1 ) ), _mm_shuffle_ps( b, c, _MM_SHUFFLE( 2, 2, 3, 3 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+	*z = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 1, 1, 2, 2 ) ), c, _MM_SHUFFLE( 3, 0, 2, 0 ) );
+}
+
+inline void storePoints( float *p, __m128 x, __m128 y, __m128 z )
+{
+	_mm_storeu_ps( p, _mm_shuffle_ps( _mm_shuffle_ps( x, y, _MM_SHUFFLE( 0, 0, 0, 0 ) ), _mm_shuffle_ps( z, x, _MM_SHUFFLE( 1, 1, 0, 0 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+	_mm_storeu_ps( p + 4, _mm_shuffle_ps( _mm_shuffle_ps( y, z, _MM_SHUFFLE( 1, 1, 1, 1 ) ), _mm_shuffle_ps( x, y, _MM_SHUFFLE( 2, 2, 2, 2 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+	_mm_storeu_ps( p + 8, _mm_shuffle_ps( _mm_shuffle_ps( z, x, _MM_SHUFFLE( 3, 3, 2, 2 ) ), _mm_shuffle_ps( y, z, _MM_SHUFFLE( 3, 3, 3, 3 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+}
+
+// deinterleaves the 4 Vec2f's at \a p into their x and y components
+inline void loadPoints( const float *p, __m128 *x, __m128 *y )
+{
+	const __m128 a = _mm_loadu_ps( p ), b = _mm_loadu_ps( p + 4 );
+	*x = _mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+	*y = _mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) );
+}
+
+inline void storePoints( float *p, __m128 x, __m128 y )
+{
+	_mm_storeu_ps( p, _mm_unpacklo_ps( x, y ) );
+	_mm_storeu_ps( p + 4, _mm_unpackhi_ps( x, y ) );
+}
+
+inline __m128 divide( __m128 a, __m128 b ) { return _mm_div_ps( a, b ); }
+#elif defined( CINDER_SIMD_MATH_NEON )
+inline void loadPoints( const float *p, float32x4_t *x, float32x4_t *y, float32x4_t *z )
+{
+	const float32x4x3_t v = vld3q_f32( p );
+	*x = v.val[0]; *y = v.val[1]; *z = v.val[2];
+}
+
+inline void storePoints( float *p, float32x4_t x, float32x4_t y, float32x4_t z )
+{
+	float32x4x3_t v;
+	v.val[0] = x; v.val[1] = y; v.val[2] = z;
+	vst3q_f32( p, v );
+}
+
+inline void loadPoints( const float *p, float32x4_t *x, float32x4_t *y )
+{
+	const float32x4x2_t v = vld2q_f32( p );
+	*x = v.val[0]; *y = v.val[1];
+}
+
+inline void storePoints( float *p, float32x4_t x, float32x4_t y )
+{
+	float32x4x2_t v;
+	v.val[0] = x; v.val[1] = y;
+	vst2q_f32( p, v );
+}
+
+// ARMv7 NEON has no divide
+inline float32x4_t divide( float32x4_t a, float32x4_t b )
+{
+	float af[4], bf[4];
+	vst1q_f32( af, a );
+	vst1q_f32( bf, b );
+	for( int i = 0; i < 4; ++i )
+		af[i] /= bf[i];
+	return vld1q_f32( af );
+}
+#endif
+
+template<bool PROJECTIVE>
+void transformPoints3( const Matrix44f &matrix, const Vec3f *in, Vec3f *out, size_t count )
+{
+	size_t i = 0;
+#if defined( CINDER_SIMD_MATH )
+	using namespace detail;
+	SimdFloat4 m[16];
+	for( int e = 0; e < 16; ++e )
+		m[e] = simdSplat( matrix.m[e] );
+	for( ; i + 4 <= count; i += 4 ) {
+		SimdFloat4 x, y, z;
+		loadPoints( &in[i].x, &x, &y, &z );
+		SimdFloat4 rx = simdAdd( simdAdd( simdAdd( simdMul( m[0], x ), simdMul( m[4], y ) ), simdMul( m[ 8], z ) ), m[12] );
+		SimdFloat4 ry = simdAdd( simdAdd( simdAdd( simdMul( m[1], x ), simdMul( m[5], y ) ), simdMul( m[ 9], z ) ), m[13] );
+		SimdFloat4 rz = simdAdd( simdAdd( simdAdd( simdMul( m[2], x ), simdMul( m[6], y ) ), simdMul( m[10], z ) ), m[14] );
+		if( PROJECTIVE ) {
+			const SimdFloat4 rw = simdAdd( simdAdd( simdAdd( simdMul( m[3], x ), simdMul( m[7], y ) ), simdMul( m[11], z ) ), m[15] );
+			rx = divide( rx, rw );
+			ry = divide( ry, rw );
+			rz = divide( rz, rw );
+		}
+		storePoints( &out[i].x, rx, ry, rz );
+	}
+#endif
+	for( ; i < count; ++i )
+		out[i] = ( PROJECTIVE ) ? matrix.transformPoint( in[i] ) : matrix.transformPointAffine( in[i] );
+}
+
+void transformPoints2( const MatrixAffine2f &matrix, const Vec2f *in, Vec2f *out, size_t count )
+{
+	size_t i = 0;
+#if defined( CINDER_SIMD_MATH )
+	using namespace detail;
+	SimdFloat4 m[6];
+	for( int e = 0; e < 6; ++e )
+		m[e] = simdSplat( matrix.m[e] );
+	for( ; i + 4 <= count; i += 4 ) {
+		SimdFloat4 x, y;
+		loadPoints( &in[i].x, &x, &y );
+		storePoints( &out[i].x, simdAdd( simdAdd( simdMul( x, m[0] ), simdMul( y, m[2] ) ), m[4] ), simdAdd( simdAdd( simdMul( x, m[1] ), simdMul( y, m[3] ) ), m[5] ) );
+	}
+#endif
+	for( ; i < count; ++i )
+		out[i] = matrix.transformPoint( in[i] );
+}
+
+template<bool PROJECTIVE>
+void transformPoints3Band( const Matrix44f *matrix, const Vec3f *in, Vec3f *out, const Area &band )
+{
+	transformPoints3<PROJECTIVE>( *matrix, in + band.y1, out + band.y1, band.getHeight() );
+}
+
+void transformPoints2Band( const MatrixAffine2f *matrix, const Vec2f *in, Vec2f *out, const Area &band )
+{
+	transformPoints2( *matrix, in + band.y1, out + band.y1, band.getHeight() );
+}
+
+// calls \a bandFn for the rows of a 1 x \a count Area, on the threads of \a context when it is worthwhile
+void runInBands( size_t count, const ip::ExecutionContextRef &context, const std::function<void(const Area&)> &bandFn )
+{
+	const Area area( 0, 0, 1, (int32_t)count );
+	if( context && ( count >= MIN_PARALLEL_POINTS ) && ( context->getNumThreads() > 1 ) )
+		context->run( area, bandFn );
+	else
+		bandFn( area );
+}
+
+} // anonymous namespace
+
+void transformPoints( const Matrix44f &matrix, const Vec3f *in, Vec3f *out, size_t count )
+{
+	transformPoints3<true>( matrix, in, out, count );
+}
+
+void transformPoints( const Matrix44f &matrix, const Vec3f *in, Vec3f *out, size_t count, const ip::ExecutionContextRef &context )
+{
+	runInBands( count, context, std::bind( &transformPoints3Band<true>, &matrix, in, out, std::_1 ) );
+}
+
+void transformPointsAffine( const Matrix44f &matrix, const Vec3f *in, Vec3f *out, size_t count )
+{
+	transformPoints3<false>( matrix, in, out, count );
+}
+
+void transformPointsAffine( const Matrix44f &matrix, const Vec3f *in, Vec3f *out, size_t count, const ip::ExecutionContextRef &context )
+{
+	runInBands( count, context, std::bind( &transformPoints3Band<false>, &matrix, in, out, std::_1 ) );
+}
+
+void transformPoints( const MatrixAffine2f &matrix, const Vec2f *in, Vec2f *out, size_t count )
+{
+	transformPoints2( matrix, in, out, count );
+}
+
+void transformPoints( const MatrixAffine2f &matrix, const Vec2f *in, Vec2f *out, size_t count, const ip::ExecutionContextRef &context )
+{
+	runInBands( count, context, std::bind( &transformPoints2Band, &matrix, in, out, std::_1 ) );
+}
+
 } // namespace cinder
@@ -0,0 +1,112 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/MemoryTracker.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+
+namespace cinder {
+
+volatile bool MemoryTracker::sEnabled = false;
+
+namespace {
+
+struct CategoryCounters {
+	MemoryTracker::Stats	mStats;
+	uint64_t				mAllocationsAtUpdate;
+};
+
+CategoryCounters	sCounters[MemoryTracker::NUM_CATEGORIES];
+double				sLastUpdateSeconds = -1;
+
+std::mutex& getMutex()
+{
+	static std::mutex *sMutex = new std::mutex;
+	return *sMutex;
+}
+
+// forces the creation of the mutex during static initialization, before any thread can race to create it
+std::mutex &sMutexInit = getMutex();
+
+} // anonymous namespace
+
+MemoryTracker::Stats MemoryTracker::getStats( Category category )
+{
+	std::lock_guard<std::mutex> lock( getMutex() );
+	return sCounters[category].mStats;
+}
+
+const char* MemoryTracker::getCategoryName( Category category )
+{
+	static const char *sNames[NUM_CATEGORIES] = { "Surface", "Channel", "Buffer", "Audio", "TriMesh", "Timeline" };
+	return ( category >= 0 && category < NUM_CATEGORIES ) ? sNames[category] : "Unknown";
+}
+
+void MemoryTracker::resetPeaks()
+{
+	std::lock_guard<std::mutex> lock( getMutex() );
+	for( int c = 0; c < NUM_CATEGORIES; ++c )
+		sCounters[c].mStats.mPeakBytes = sCounters[c].mStats.mLiveBytes;
+}
+
+void MemoryTracker::update( double seconds )
+{
+	std::lock_guard<std::mutex> lock( getMutex() );
+	if( sLastUpdateSeconds < 0 || seconds < sLastUpdateSeconds ) {
+		for( int c = 0; c < NUM_CATEGORIES; ++c )
+			sCounters[c].mAllocationsAtUpdate = sCounters[c].mStats.mNumAllocations;
+		sLastUpdateSeconds = seconds;
+		return;
+	}
+
+	double elapsed = seconds - sLastUpdateSeconds;
+	if( elapsed < 1 )
+		return;
+	for( int c = 0; c < NUM_CATEGORIES; ++c ) {
+		sCounters[c].mStats.mAllocationsPerSecond = ( sCounters[c].mStats.mNumAllocations - sCounters[c].mAllocationsAtUpdate ) / elapsed;
+		sCounters[c].mAllocationsAtUpdate = sCounters[c].mStats.mNumAllocations;
+	}
+	sLastUpdateSeconds = seconds;
+}
+
+void MemoryTracker::recordAllocation( Category category, size_t bytes, uint32_t count )
+{
+	std::lock_guard<std::mutex> lock( getMutex() );
+	Stats &stats = sCounters[category].mStats;
+	stats.mLiveBytes += bytes;
+	stats.mPeakBytes = std::max( stats.mPeakBytes, stats.mLiveBytes );
+	stats.mNumAllocations += count;
+}
+
+void MemoryTracker::recordFree( Category category, size_t bytes, uint32_t count )
+{
+	std::lock_guard<std::mutex> lock( getMutex() );
+	Stats &stats = sCounters[category].mStats;
+	stats.mLiveBytes -= bytes;
+	stats.mNumFrees += count;
+}
+
+} // namespace cinder
@@ -21,142 +21,519 @@
 */
 
 #include "cinder/ObjLoader.h"
+#include "cinder/Utilities.h"
+#include "cinder/ip/ExecutionContext.h"
 
-#include <boost/lexical_cast.hpp>
-using boost::lexical_cast;
+#include <boost/unordered_map.hpp>
+#include <cstdlib>
+#include <cstring>
 #include <sstream>
 using std::ostringstream;
 
-#include <sstream>
 using namespace std;
-using boost::make_tuple;
 
 namespace cinder {
 
-ObjLoader::ObjLoader( shared_ptr<IStream> stream, bool includeUVs )
-	: mStream( stream )
+namespace {
+
+//! The attribute indices which make up a unique vertex, with \c -1 for those which aren't loaded
+struct VertexKey {
+	VertexKey( int vertexIndex, int texCoordIndex, int normalIndex ) : mVertexIndex( vertexIndex ), mTexCoordIndex( texCoordIndex ), mNormalIndex( normalIndex ) {}
+
+	bool operator==( const VertexKey &rhs ) const { return ( mVertexIndex == rhs.mVertexIndex ) && ( mTexCoordIndex == rhs.mTexCoordIndex ) && ( mNormalIndex == rhs.mNormalIndex ); }
+
+	int		mVertexIndex, mTexCoordIndex, mNormalIndex;
+};
+
+size_t hash_value( const VertexKey &key )
 {
-	parse( includeUVs );
+	size_t seed = 0;
+	boost::hash_combine( seed, key.mVertexIndex );
+	boost::hash_combine( seed, key.mTexCoordIndex );
+	boost::hash_combine( seed, key.mNormalIndex );
+	return seed;
 }
 
-ObjLoader::ObjLoader( DataSourceRef dataSource, bool includeUVs )
-	: mStream( dataSource->createStream() )
+} // anonymous namespace
+
+class ObjLoader::VertexMap : public boost::unordered_map<VertexKey,uint32_t> {
+};
+
+namespace {
+
+// Files are split into chunks of at least this many bytes, at line boundaries
+const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+inline bool isDigit( char c )
 {
-	parse( includeUVs );
+	return ( c >= '0' ) && ( c <= '9' );
 }
 
-ObjLoader::~ObjLoader()
+inline bool isSpace( char c )
 {
+	return ( c == ' ' ) || ( c == '\t' ) || ( c == '\r' );
 }
 
-void ObjLoader::parse( bool includeUVs )
+inline const char* skipSpace( const char *p, const char *end )
 {
-	Group *currentGroup;
-	mGroups.push_back( Group() );
-	currentGroup = &mGroups[mGroups.size()-1];
-	currentGroup->mBaseVertexOffset = currentGroup->mBaseTexCoordOffset = currentGroup->mBaseNormalOffset = 0;
-
-	size_t lineNumber = 0;
-	while( ! mStream->isEof() ) {
-		lineNumber++;
-		string line = mStream->readLine(), tag;
-		stringstream ss( line );
-		ss >> tag;
-		if( tag == "v" ) { // vertex
-			Vec3f v;
-			ss >> v.x >> v.y >> v.z;
-			mVertices.push_back( v );
+	while( ( p < end ) && isSpace( *p ) )
+		++p;
+	return p;
+}
+
+inline const char* skipToken( const char *p, const char *end )
+{
+	while( ( p < end ) && ( ! isSpace( *p ) ) )
+		++p;
+	return p;
+}
+
+// Parses the float at \a *p and advances \a *p past it. Mantissas of up to 19 significant digits with small exponents are converted exactly;
+// anything else, including infinities and NaNs, is handed to strtod().
+float parseFloat( const char **p, const char *end )
+{
+	static const double powersOfTen[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+	const char *start = *p, *s = *p;
+	bool negative = false;
+	if( ( s < end ) && ( ( *s == '-' ) || ( *s == '+' ) ) )
+		negative = ( *s++ == '-' );
+
+	uint64_t mantissa = 0;
+	int significantDigits = 0, exponent = 0;
+	bool anyDigits = false;
+	for( ; ( s < end ) && isDigit( *s ); ++s ) {
+		anyDigits = true;
+		if( significantDigits < 19 ) {
+			mantissa = mantissa * 10 + ( *s - '0' );
+			if( mantissa )
+				++significantDigits;
 		}
-		else if( tag == "vt" ) { // vertex texture coordinates
-			if( includeUVs ) {
-				Vec2f tex;
-				ss >> tex.x >> tex.y;
-				mTexCoords.push_back( tex );
+		else
+			++exponent;
+	}
+	if( ( s < end ) && ( *s == '.' ) ) {
+		for( ++s; ( s < end ) && isDigit( *s ); ++s ) {
+			anyDigits = true;
+			if( significantDigits < 19 ) {
+				mantissa = mantissa * 10 + ( *s - '0' );
+				if( mantissa )
+					++significantDigits;
+				--exponent;
 			}
 		}
-		else if( tag == "vn" ) { // vertex normals
-			Vec3f v;
-			ss >> v.x >> v.y >> v.z;
-			mNormals.push_back( v.normalized() );
+	}
+	if( anyDigits && ( s < end ) && ( ( *s == 'e' ) || ( *s == 'E' ) ) ) {
+		const char *e = s + 1;
+		bool negativeExponent = false;
+		if( ( e < end ) && ( ( *e == '-' ) || ( *e == '+' ) ) )
+			negativeExponent = ( *e++ == '-' );
+		if( ( e < end ) && isDigit( *e ) ) {
+			int explicitExponent = 0;
+			for( ; ( e < end ) && isDigit( *e ); ++e )
+				explicitExponent = std::min( explicitExponent * 10 + ( *e - '0' ), 100000 );
+			exponent += ( negativeExponent ) ? -explicitExponent : explicitExponent;
+			s = e;
 		}
-		else if( tag == "f" ) { // face
-			parseFace( currentGroup, line, includeUVs );
+	}
+
+	if( anyDigits && ( mantissa < ( (uint64_t)1 << 53 ) ) && ( exponent >= -22 ) && ( exponent <= 22 ) ) {
+		*p = s;
+		double result = (double)mantissa;
+		result = ( exponent < 0 ) ? result / powersOfTen[-exponent] : result * powersOfTen[exponent];
+		return (float)( ( negative ) ? -result : result );
+	}
+
+	// the slow path needs a null-terminated copy of the token
+	char token[128];
+	const size_t length = std::min<size_t>( skipToken( start, end ) - start, sizeof(token) - 1 );
+	memcpy( token, start, length );
+	token[length] = 0;
+	char *tokenEnd;
+	const double result = strtod( token, &tokenEnd );
+	*p = start + ( tokenEnd - token );
+	return (float)result;
+}
+
+// Parses the integer at \a *p and advances \a *p past it. Returns \c false if there are no digits
+bool parseInt( const char **p, const char *end, int *result )
+{
+	const char *s = *p;
+	bool negative = false;
+	if( ( s < end ) && ( ( *s == '-' ) || ( *s == '+' ) ) )
+		negative = ( *s++ == '-' );
+	if( ( s >= end ) || ( ! isDigit( *s ) ) )
+		return false;
+	int value = 0;
+	for( ; ( s < end ) && isDigit( *s ); ++s )
+		value = value * 10 + ( *s - '0' );
+	*result = ( negative ) ? -value : value;
+	*p = s;
+	return true;
+}
+
+//! The start of a group, and the number of each attribute the chunk had parsed before it
+struct GroupStart {
+	std::string		mName;
+	size_t			mFirstFace;
+	int				mNumVertices, mNumTexCoords, mNumNormals;
+};
+
+/* The attributes and faces of one chunk of the file. Positive indices are absolute, while negative ones are relative to the
+	attributes parsed so far. Those are resolved against the chunk's own counts and listed in mRelativeIndices, as corner * 3 plus
+	0, 1 or 2 for a vertex, texture coordinate or normal index, so that the counts of the preceding chunks can be added once known. */
+struct ParsedChunk {
+	vector<Vec3f>				mVertices, mNormals;
+	vector<Vec2f>				mTexCoords;
+	vector<ObjLoader::Face>		mFaces;
+	vector<int>					mVertexIndices, mTexCoordIndices, mNormalIndices;
+	vector<uint32_t>			mRelativeIndices;
+	vector<GroupStart>			mGroupStarts;
+
+	// frees the memory of every array
+	void release()
+	{
+		vector<Vec3f>().swap( mVertices );
+		vector<Vec3f>().swap( mNormals );
+		vector<Vec2f>().swap( mTexCoords );
+		vector<ObjLoader::Face>().swap( mFaces );
+		vector<int>().swap( mVertexIndices );
+		vector<int>().swap( mTexCoordIndices );
+		vector<int>().swap( mNormalIndices );
+		vector<uint32_t>().swap( mRelativeIndices );
+		vector<GroupStart>().swap( mGroupStarts );
+	}
+};
+
+inline int resolveIndex( int index, int count, uint32_t corner, int attribute, vector<uint32_t> *relativeIndices )
+{
+	if( index > 0 )
+		return index - 1;
+	relativeIndices->push_back( corner * 3 + attribute );
+	return count + index;
+}
+
+void parseFace( const char *p, const char *end, bool includeUVs, ParsedChunk *chunk )
+{
+	ObjLoader::Face face;
+	face.mFirstIndex = (uint32_t)chunk->mVertexIndices.size();
+	face.mNumVertices = 0;
+	face.mHasTexCoords = face.mHasNormals = true;
+
+	for( p = skipSpace( p, end ); p < end; p = skipSpace( p, end ) ) {
+		const uint32_t corner = (uint32_t)chunk->mVertexIndices.size();
+		int vertexIndex, texCoordIndex = 0, normalIndex = 0;
+		if( ! parseInt( &p, end, &vertexIndex ) )
+			break;
+		if( ( p < end ) && ( *p == '/' ) ) {
+			++p;
+			if( ( p < end ) && ( *p != '/' ) )
+				parseInt( &p, end, &texCoordIndex );
+			if( ( p < end ) && ( *p == '/' ) ) {
+				++p;
+				parseInt( &p, end, &normalIndex );
+			}
 		}
-		else if( tag == "g" ) { // group
-			if( ! currentGroup->mFaces.empty() )
-				mGroups.push_back( Group() );
-			currentGroup = &mGroups[mGroups.size()-1];
-			currentGroup->mBaseVertexOffset = mVertices.size();
-			currentGroup->mBaseTexCoordOffset = mTexCoords.size();
-			currentGroup->mBaseNormalOffset = mNormals.size();
-			currentGroup->mName = line.substr( line.find( ' ' ) + 1 );
+		p = skipToken( p, end );
+
+		chunk->mVertexIndices.push_back( resolveIndex( vertexIndex, (int)chunk->mVertices.size(), corner, 0, &chunk->mRelativeIndices ) );
+		if( includeUVs && ( texCoordIndex != 0 ) )
+			chunk->mTexCoordIndices.push_back( resolveIndex( texCoordIndex, (int)chunk->mTexCoords.size(), corner, 1, &chunk->mRelativeIndices ) );
+		else {
+			chunk->mTexCoordIndices.push_back( -1 );
+			face.mHasTexCoords = false;
+		}
+		if( normalIndex != 0 )
+			chunk->mNormalIndices.push_back( resolveIndex( normalIndex, (int)chunk->mNormals.size(), corner, 2, &chunk->mRelativeIndices ) );
+		else {
+			chunk->mNormalIndices.push_back( -1 );
+			face.mHasNormals = false;
+		}
+		++face.mNumVertices;
+	}
+
+	// points and lines aren't polygonal data
+	if( face.mNumVertices < 3 ) {
+		while( ( ! chunk->mRelativeIndices.empty() ) && ( chunk->mRelativeIndices.back() / 3 >= face.mFirstIndex ) )
+			chunk->mRelativeIndices.pop_back();
+		chunk->mVertexIndices.resize( face.mFirstIndex );
+		chunk->mTexCoordIndices.resize( face.mFirstIndex );
+		chunk->mNormalIndices.resize( face.mFirstIndex );
+		return;
+	}
+	chunk->mFaces.push_back( face );
+}
+
+// Parses the line starting at \a p into \a chunk and returns the start of the next line
+const char* parseLine( const char *p, const char *end, bool includeUVs, ParsedChunk *chunk )
+{
+	const char *lineEnd = reinterpret_cast<const char*>( memchr( p, '\n', end - p ) );
+	if( ! lineEnd )
+		lineEnd = end;
+	p = skipSpace( p, lineEnd );
+	const char *tagEnd = skipToken( p, lineEnd );
+	const size_t tagLength = tagEnd - p;
+
+	if( ( tagLength == 1 ) && ( p[0] == 'v' ) ) { // vertex
+		Vec3f v;
+		const char *s = tagEnd;
+		for( int c = 0; c < 3; ++c ) {
+			s = skipSpace( s, lineEnd );
+			v[c] = parseFloat( &s, lineEnd );
+		}
+		chunk->mVertices.push_back( v );
+	}
+	else if( ( tagLength == 2 ) && ( p[0] == 'v' ) && ( p[1] == 't' ) ) { // vertex texture coordinates
+		if( includeUVs ) {
+			Vec2f tex;
+			const char *s = tagEnd;
+			for( int c = 0; c < 2; ++c ) {
+				s = skipSpace( s, lineEnd );
+				tex[c] = parseFloat( &s, lineEnd );
+			}
+			chunk->mTexCoords.push_back( tex );
 		}
 	}
+	else if( ( tagLength == 2 ) && ( p[0] == 'v' ) && ( p[1] == 'n' ) ) { // vertex normals
+		Vec3f v;
+		const char *s = tagEnd;
+		for( int c = 0; c < 3; ++c ) {
+			s = skipSpace( s, lineEnd );
+			v[c] = parseFloat( &s, lineEnd );
+		}
+		chunk->mNormals.push_back( v.normalized() );
+	}
+	else if( ( tagLength == 1 ) && ( p[0] == 'f' ) ) { // face
+		parseFace( tagEnd, lineEnd, includeUVs, chunk );
+	}
+	else if( ( tagLength == 1 ) && ( p[0] == 'g' ) ) { // group
+		GroupStart group;
+		const char *nameStart = skipSpace( tagEnd, lineEnd ), *nameEnd = lineEnd;
+		while( ( nameEnd > nameStart ) && isSpace( nameEnd[-1] ) )
+			--nameEnd;
+		group.mName.assign( nameStart, nameEnd );
+		group.mFirstFace = chunk->mFaces.size();
+		group.mNumVertices = (int)chunk->mVertices.size();
+		group.mNumTexCoords = (int)chunk->mTexCoords.size();
+		group.mNumNormals = (int)chunk->mNormals.size();
+		chunk->mGroupStarts.push_back( group );
+	}
+
+	return lineEnd + 1;
+}
+
+void parseChunk( const char *p, const char *end, bool includeUVs, ParsedChunk *chunk )
+{
+	while( p < end )
+		p = parseLine( p, end, includeUVs, chunk );
 }
 
-void ObjLoader::parseFace( Group *group, const std::string &s, bool includeUVs )
+void parseChunkBand( const char *data, const vector<size_t> *chunkStarts, bool includeUVs, vector<ParsedChunk> *chunks, const Area &band )
 {
-	ObjLoader::Face result;
-	result.mNumVertices = 0;
+	for( int32_t c = band.y1; c < band.y2; ++c )
+		parseChunk( data + (*chunkStarts)[c], data + (*chunkStarts)[c+1], includeUVs, &(*chunks)[c] );
+}
 
-	size_t offset = 2; // account for "f "
-	size_t length = s.length();
-	while( offset < length ) {
-		size_t endOfTriple, firstSlashOffset, secondSlashOffset;
-	
-		// find the end of this triple "v/vt/vn"
-		endOfTriple = s.find( ' ', offset );
-		if( endOfTriple == string::npos ) endOfTriple = length;
-		firstSlashOffset = s.find( '/', offset );
-		if( firstSlashOffset != string::npos ) {
-			secondSlashOffset = s.find( '/', firstSlashOffset + 1 );
-			if( secondSlashOffset > endOfTriple ) secondSlashOffset = string::npos;
+template<typename T>
+void appendRange( vector<T> *dest, const vector<T> &src, size_t start, size_t end )
+{
+	dest->insert( dest->end(), src.begin() + start, src.begin() + end );
+}
+
+// Gathers faces into TriMeshes of at most a fixed number of vertices, sharing vertices within each, and passes each one on once it is full
+class ChunkBuilder {
+  public:
+	ChunkBuilder( const ParsedChunk &attributes, size_t maxVertices, const std::function<void(const TriMesh&)> &chunkFn, bool texCoords, bool normals )
+		: mAttributes( attributes ), mMaxVertices( std::max<size_t>( 3, maxVertices ) ), mChunkFn( chunkFn ), mTexCoords( texCoords ), mNormals( normals )
+	{}
+
+	// adds the face most recently parsed into \a faces, which must only refer to the attributes parsed so far
+	void addFace( const ParsedChunk &faces )
+	{
+		const ObjLoader::Face &face = faces.mFaces.back();
+		const int *vertexIndices = &faces.mVertexIndices[face.mFirstIndex];
+		const int *texCoordIndices = &faces.mTexCoordIndices[face.mFirstIndex];
+		const int *normalIndices = &faces.mNormalIndices[face.mFirstIndex];
+		for( int v = 0; v < face.mNumVertices; ++v ) {
+			if( ( vertexIndices[v] < 0 ) || ( vertexIndices[v] >= (int)mAttributes.mVertices.size() ) || ( texCoordIndices[v] >= (int)mAttributes.mTexCoords.size() )
+					|| ( normalIndices[v] >= (int)mAttributes.mNormals.size() ) || ( face.mHasTexCoords && ( texCoordIndices[v] < 0 ) ) || ( face.mHasNormals && ( normalIndices[v] < 0 ) ) )
+				return;
 		}
-		else
-			secondSlashOffset = string::npos;
-		
-		// process the vertex index
-		int vertexIndex = lexical_cast<int>( s.substr( offset, firstSlashOffset - offset ) );
-		if( vertexIndex < 0 )
-			result.mVertexIndices.push_back( group->mBaseVertexOffset + vertexIndex );
-		else
-			result.mVertexIndices.push_back( vertexIndex - 1 );
-			
-		// process the tex coord index
-		if( includeUVs && ( firstSlashOffset != string::npos ) ) {
-			size_t numSize = ( secondSlashOffset == string::npos ) ? ( endOfTriple - firstSlashOffset - 1 ) : secondSlashOffset - firstSlashOffset - 1;
-			if( numSize > 0 ) {
-				int texCoordIndex = lexical_cast<int>( s.substr( firstSlashOffset + 1, numSize ) );
-				if( texCoordIndex < 0 )
-					result.mTexCoordIndices.push_back( group->mBaseTexCoordOffset + texCoordIndex );
-				else
-					result.mTexCoordIndices.push_back( texCoordIndex - 1 );
-				if( group->mFaces.empty() )
-					group->mHasTexCoords = true;
+
+		Vec3f inferredNormal;
+		if( mNormals && ( ! face.mHasNormals ) ) { // we'll have to derive it from two edges
+			Vec3f edge1 = mAttributes.mVertices[vertexIndices[1]] - mAttributes.mVertices[vertexIndices[0]];
+			Vec3f edge2 = mAttributes.mVertices[vertexIndices[2]] - mAttributes.mVertices[vertexIndices[0]];
+			inferredNormal = edge1.cross( edge2 ).normalized();
+		}
+
+		// a face too large for one chunk is split into the triangles of its fan
+		if( (size_t)face.mNumVertices <= mMaxVertices ) {
+			addPolygon( face, vertexIndices, texCoordIndices, normalIndices, 0, face.mNumVertices, inferredNormal );
+		}
+		else {
+			for( int t = 0; t < face.mNumVertices - 2; ++t )
+				addPolygon( face, vertexIndices, texCoordIndices, normalIndices, t + 1, 2, inferredNormal );
+		}
+	}
+
+	// passes on the current chunk, if it has any triangles, and starts a new one
+	void flush()
+	{
+		if( mMesh.getNumIndices() > 0 )
+			mChunkFn( mMesh );
+		mMesh.clear();
+		mUniqueVerts.clear();
+	}
+
+  private:
+	// adds the fan of the face's first corner followed by the \a count corners from \a first
+	void addPolygon( const ObjLoader::Face &face, const int *vertexIndices, const int *texCoordIndices, const int *normalIndices, int first, int count, const Vec3f &inferredNormal )
+	{
+		const int numCorners = ( first > 0 ) ? count + 1 : count;
+		if( mMesh.getNumVertices() + numCorners > mMaxVertices )
+			flush();
+
+		const bool forceUnique = ( mNormals && ( ! face.mHasNormals ) ) || ( mTexCoords && ( ! face.mHasTexCoords ) );
+		mFaceIndices.clear();
+		for( int i = 0; i < numCorners; ++i ) {
+			const int v = ( first > 0 ) ? ( ( i == 0 ) ? 0 : first + i - 1 ) : i;
+			if( ! forceUnique ) {
+				const VertexKey key( vertexIndices[v], ( mTexCoords ) ? texCoordIndices[v] : -1, ( mNormals ) ? normalIndices[v] : -1 );
+				pair<boost::unordered_map<VertexKey,uint32_t>::iterator,bool> result = mUniqueVerts.insert( make_pair( key, (uint32_t)mMesh.getNumVertices() ) );
+				if( ! result.second ) {
+					mFaceIndices.push_back( result.first->second );
+					continue;
+				}
 			}
-			else
-				group->mHasTexCoords = false;
+
+			mFaceIndices.push_back( (uint32_t)mMesh.getNumVertices() );
+			mMesh.appendVertex( mAttributes.mVertices[vertexIndices[v]] );
+			if( mNormals )
+				mMesh.appendNormal( ( face.mHasNormals ) ? mAttributes.mNormals[normalIndices[v]] : inferredNormal );
+			if( mTexCoords )
+				mMesh.appendTexCoord( ( face.mHasTexCoords ) ? mAttributes.mTexCoords[texCoordIndices[v]] : Vec2f::zero() );
+		}
+
+		for( int t = 0; t < numCorners - 2; ++t )
+			mMesh.appendTriangle( mFaceIndices[0], mFaceIndices[t + 1], mFaceIndices[t + 2] );
+	}
+
+	const ParsedChunk								&mAttributes;
+	size_t											mMaxVertices;
+	std::function<void(const TriMesh&)>				mChunkFn;
+	bool											mTexCoords, mNormals;
+	TriMesh											mMesh;
+	boost::unordered_map<VertexKey,uint32_t>		mUniqueVerts;
+	vector<uint32_t>								mFaceIndices;
+};
+
+} // anonymous namespace
+
+ObjLoader::ObjLoader( shared_ptr<IStream> stream, bool includeUVs, const ip::ExecutionContextRef &context )
+{
+	Buffer buffer = loadStreamBuffer( stream );
+	parse( reinterpret_cast<const char*>( buffer.getData() ), buffer.getDataSize(), includeUVs, context );
+}
+
+ObjLoader::ObjLoader( DataSourceRef dataSource, bool includeUVs, const ip::ExecutionContextRef &context )
+{
+	Buffer buffer = loadDataSourceBuffer( dataSource );
+	parse( reinterpret_cast<const char*>( buffer.getData() ), buffer.getDataSize(), includeUVs, context );
+}
+
+ObjLoader::~ObjLoader()
+{
+}
+
+void ObjLoader::parse( const char *data, size_t size, bool includeUVs, const ip::ExecutionContextRef &context )
+{
+	// split the file into chunks at line boundaries, enough to keep every thread busy
+	size_t numChunks = 1;
+	if( context && ( context->getNumThreads() > 1 ) )
+		numChunks = std::max<size_t>( 1, std::min<size_t>( size / MIN_CHUNK_SIZE, context->getNumThreads() * 4 ) );
+	vector<size_t> chunkStarts( 1, 0 );
+	for( size_t c = 1; c < numChunks; ++c ) {
+		const size_t target = std::max( chunkStarts.back(), size * c / numChunks );
+		const char *lineEnd = reinterpret_cast<const char*>( memchr( data + target, '\n', size - target ) );
+		if( ! lineEnd )
+			break;
+		chunkStarts.push_back( lineEnd + 1 - data );
+	}
+	chunkStarts.push_back( size );
+	numChunks = chunkStarts.size() - 1;
+
+	vector<ParsedChunk> chunks( numChunks );
+	if( numChunks > 1 )
+		context->run( Area( 0, 0, 1, (int32_t)numChunks ), std::bind( &parseChunkBand, data, &chunkStarts, includeUVs, &chunks, std::_1 ) );
+	else
+		parseChunk( data, data + size, includeUVs, &chunks[0] );
+
+	// join the chunks, resolving their relative indices and splitting their faces among the groups
+	size_t totalVertices = 0, totalTexCoords = 0, totalNormals = 0;
+	for( size_t c = 0; c < numChunks; ++c ) {
+		totalVertices += chunks[c].mVertices.size();
+		totalTexCoords += chunks[c].mTexCoords.size();
+		totalNormals += chunks[c].mNormals.size();
+	}
+	mVertices.reserve( totalVertices );
+	mTexCoords.reserve( totalTexCoords );
+	mNormals.reserve( totalNormals );
+
+	mGroups.push_back( Group() );
+	mGroups.back().mBaseVertexOffset = mGroups.back().mBaseTexCoordOffset = mGroups.back().mBaseNormalOffset = 0;
+	mGroups.back().mHasTexCoords = mGroups.back().mHasNormals = false;
+	for( size_t c = 0; c < numChunks; ++c ) {
+		ParsedChunk &chunk = chunks[c];
+		const int base[3] = { (int)mVertices.size(), (int)mTexCoords.size(), (int)mNormals.size() };
+		vector<int> *indices[3] = { &chunk.mVertexIndices, &chunk.mTexCoordIndices, &chunk.mNormalIndices };
+		for( size_t r = 0; r < chunk.mRelativeIndices.size(); ++r ) {
+			const uint32_t corner = chunk.mRelativeIndices[r] / 3, attribute = chunk.mRelativeIndices[r] % 3;
+			(*indices[attribute])[corner] += base[attribute];
 		}
-		else if( group->mFaces.empty() ) // if this is the first face, let's note that this group has no tex coords
-			group->mHasTexCoords = false;
-			
-		// process the normal index
-		if( secondSlashOffset != string::npos ) {
-			int normalIndex = lexical_cast<int>( s.substr( secondSlashOffset + 1, endOfTriple - secondSlashOffset - 1 ) );
-			if( normalIndex < 0 )
-				result.mNormalIndices.push_back( group->mBaseNormalOffset + normalIndex );
-			else
-				result.mNormalIndices.push_back( normalIndex - 1 );
-			group->mHasNormals = true;
+		appendRange( &mVertices, chunk.mVertices, 0, chunk.mVertices.size() );
+		appendRange( &mTexCoords, chunk.mTexCoords, 0, chunk.mTexCoords.size() );
+		appendRange( &mNormals, chunk.mNormals, 0, chunk.mNormals.size() );
+
+		size_t face = 0;
+		for( size_t g = 0; g <= chunk.mGroupStarts.size(); ++g ) {
+			// the faces up to the next group start belong to the current group
+			const size_t groupEnd = ( g < chunk.mGroupStarts.size() ) ? chunk.mGroupStarts[g].mFirstFace : chunk.mFaces.size();
+			if( groupEnd > face ) {
+				Group &group = mGroups.back();
+				if( group.mFaces.empty() ) {
+					group.mHasTexCoords = chunk.mFaces[face].mHasTexCoords;
+					group.mHasNormals = chunk.mFaces[face].mHasNormals;
+				}
+				const uint32_t cornerStart = chunk.mFaces[face].mFirstIndex;
+				const uint32_t cornerEnd = chunk.mFaces[groupEnd-1].mFirstIndex + chunk.mFaces[groupEnd-1].mNumVertices;
+				const uint32_t offset = (uint32_t)group.mVertexIndices.size() - cornerStart;
+				for( ; face < groupEnd; ++face ) {
+					group.mFaces.push_back( chunk.mFaces[face] );
+					group.mFaces.back().mFirstIndex += offset;
+				}
+				appendRange( &group.mVertexIndices, chunk.mVertexIndices, cornerStart, cornerEnd );
+				appendRange( &group.mTexCoordIndices, chunk.mTexCoordIndices, cornerStart, cornerEnd );
+				appendRange( &group.mNormalIndices, chunk.mNormalIndices, cornerStart, cornerEnd );
+			}
+			if( g == chunk.mGroupStarts.size() )
+				break;
+
+			const GroupStart &start = chunk.mGroupStarts[g];
+			if( ! mGroups.back().mFaces.empty() ) {
+				mGroups.push_back( Group() );
+				mGroups.back().mHasTexCoords = mGroups.back().mHasNormals = false;
+			}
+			Group &group = mGroups.back();
+			group.mName = start.mName;
+			group.mBaseVertexOffset = base[0] + start.mNumVertices;
+			group.mBaseTexCoordOffset = base[1] + start.mNumTexCoords;
+			group.mBaseNormalOffset = base[2] + start.mNumNormals;
 		}
-		else if( group->mFaces.empty() ) // if this is the first face, let's note that this group has no normals
-			group->mHasNormals = false;
-		
-		offset = endOfTriple + 1;
-		result.mNumVertices++;
+
+		// free each chunk as soon as it has been joined, to limit the peak memory use
+		chunk.release();
 	}
-	
-	group->mFaces.push_back( result );
 }
 
 void ObjLoader::load( size_t groupIndex, TriMesh *destTriMesh, boost::tribool loadNormals, boost::tribool loadTexCoords, bool optimizeVertices )
@@ -176,23 +553,11 @@ void ObjLoader::load( size_t groupIndex, TriMesh *destTriMesh, boost::tribool lo
 	if( ! optimizeVertices ) {
 		loadInternalNoOptimize( mGroups[groupIndex], destTriMesh, texCoords, normals );
 	}
-	else if( normals && texCoords ) {
-		map<VertexTriple,int> uniqueVerts;
-		loadInternalNormalsTextures( mGroups[groupIndex], uniqueVerts, destTriMesh );
-	}
-	else if( normals ) {
-		map<VertexPair,int> uniqueVerts;
-		loadInternalNormals( mGroups[groupIndex], uniqueVerts, destTriMesh );
-	}
-	else if( texCoords ) {
-		map<VertexPair,int> uniqueVerts;
-		loadInternalTextures( mGroups[groupIndex], uniqueVerts, destTriMesh );
-	}
 	else {
-		map<int,int> uniqueVerts;
-		loadInternal( mGroups[groupIndex], uniqueVerts, destTriMesh );
+		VertexMap uniqueVerts;
+		loadInternal( mGroups[groupIndex], &uniqueVerts, destTriMesh, texCoords, normals );
 	}
-
+	destTriMesh->updateTrackedMemory();
 }
 
 void ObjLoader::load( TriMesh *destTriMesh, boost::tribool loadNormals, boost::tribool loadTexCoords, bool optimizeVertices )
@@ -229,206 +594,120 @@ void ObjLoader::load( TriMesh *destTriMesh, boost::tribool loadNormals, boost::t
 			loadInternalNoOptimize( *groupIt, destTriMesh, texCoords, normals );
 		}	
 	}
-	else if( normals && texCoords ) {
-		map<VertexTriple,int> uniqueVerts;
-		for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt )
-			loadInternalNormalsTextures( *groupIt, uniqueVerts, destTriMesh );
-	}
-	else if( normals ) {
-		map<VertexPair,int> uniqueVerts;
-		for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt )
-			loadInternalNormals( *groupIt, uniqueVerts, destTriMesh );
-	}
-	else if( texCoords ) {
-		map<VertexPair,int> uniqueVerts;
-		for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt )
-			loadInternalTextures( *groupIt, uniqueVerts, destTriMesh );
-	}
 	else {
-		map<int,int> uniqueVerts;
+		VertexMap uniqueVerts;
 		for( vector<Group>::const_iterator groupIt = mGroups.begin(); groupIt != mGroups.end(); ++groupIt )
-			loadInternal( *groupIt, uniqueVerts, destTriMesh );
+			loadInternal( *groupIt, &uniqueVerts, destTriMesh, texCoords, normals );
 	}
+	destTriMesh->updateTrackedMemory();
+}
+
+void ObjLoader::loadChunks( DataSourceRef dataSource, size_t maxVerticesPerChunk, const std::function<void(const TriMesh&)> &chunkFn, boost::tribool loadNormals, boost::tribool loadTexCoords )
+{
+	Buffer buffer = loadDataSourceBuffer( dataSource );
+	const char *data = reinterpret_cast<const char*>( buffer.getData() );
+	size_t size = buffer.getDataSize();
+
+	// the attributes accumulate for the whole file, as any later face may refer to them, while each face is discarded once added to a chunk
+	ParsedChunk parsed;
+	std::shared_ptr<ChunkBuilder> builder;
+	bool includeUVs = true;
+	if( ! loadTexCoords ) includeUVs = false;
+	const char *end = data + size;
+	for( const char *p = data; p < end; ) {
+		p = parseLine( p, end, includeUVs, &parsed );
+		if( parsed.mFaces.empty() )
+			continue;
+
+		if( ! builder ) { // unless specified, the first face decides whether the chunks have normals and texture coordinates
+			const bool normals = ( loadNormals ) ? true : ( ! loadNormals ) ? false : parsed.mFaces[0].mHasNormals;
+			const bool texCoords = ( loadTexCoords ) ? true : ( ! loadTexCoords ) ? false : parsed.mFaces[0].mHasTexCoords;
+			builder = std::shared_ptr<ChunkBuilder>( new ChunkBuilder( parsed, maxVerticesPerChunk, chunkFn, texCoords, normals ) );
+		}
+		builder->addFace( parsed );
+
+		parsed.mFaces.clear();
+		parsed.mVertexIndices.clear();
+		parsed.mTexCoordIndices.clear();
+		parsed.mNormalIndices.clear();
+		parsed.mRelativeIndices.clear();
+	}
+	if( builder )
+		builder->flush();
 }
 
 void ObjLoader::loadInternalNoOptimize( const Group &group, TriMesh *destTriMesh, bool texCoords, bool normals )
 {
 	size_t offset = destTriMesh->getNumVertices();
 	for( size_t f = 0; f < group.mFaces.size(); ++f ) {
+		const Face &face = group.mFaces[f];
+		const int *vertexIndices = &group.mVertexIndices[face.mFirstIndex];
 		Vec3f normal;
-		if( normals && ( ! group.mHasNormals ) ) { // we'll have to derive it from two edges
-			Vec3f edge1 = mVertices[group.mFaces[f].mVertexIndices[1]] - mVertices[group.mFaces[f].mVertexIndices[0]];
-			Vec3f edge2 = mVertices[group.mFaces[f].mVertexIndices[2]] - mVertices[group.mFaces[f].mVertexIndices[0]];
+		if( normals && ( ! face.mHasNormals ) ) { // we'll have to derive it from two edges
+			Vec3f edge1 = mVertices[vertexIndices[1]] - mVertices[vertexIndices[0]];
+			Vec3f edge2 = mVertices[vertexIndices[2]] - mVertices[vertexIndices[0]];
 			normal = edge1.cross( edge2 ).normalized();
 		}
-		for( int v = 0; v < group.mFaces[f].mNumVertices; ++v ) {
-			destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-			if( normals && group.mHasNormals )
-				destTriMesh->appendNormal( mNormals[group.mFaces[f].mNormalIndices[v]] );
-			else if( normals && ( ! group.mHasNormals ) ) { // we'll have to use the one derived from two edges
+		for( int v = 0; v < face.mNumVertices; ++v ) {
+			destTriMesh->appendVertex( mVertices[vertexIndices[v]] );
+			if( normals && face.mHasNormals )
+				destTriMesh->appendNormal( mNormals[group.mNormalIndices[face.mFirstIndex + v]] );
+			else if( normals ) // we'll have to use the one derived from two edges
 				destTriMesh->appendNormal( normal );
-			}
-			if( texCoords && group.mHasTexCoords ) {
-				Vec2f texCoord = mTexCoords[group.mFaces[f].mTexCoordIndices[v]];
+			if( texCoords && face.mHasTexCoords ) {
+				Vec2f texCoord = mTexCoords[group.mTexCoordIndices[face.mFirstIndex + v]];
 				texCoord.y = 1.0f - texCoord.y;
 				destTriMesh->appendTexCoord( texCoord );	
 			}
-			else if( texCoords && ( ! group.mHasTexCoords ) ) // we'll have to make some up
+			else if( texCoords ) // we'll have to make some up
 				destTriMesh->appendTexCoord( Vec2f::zero() );
 		}
 
-		int triangles = group.mFaces[f].mNumVertices - 2;
+		int triangles = face.mNumVertices - 2;
 		for( int t = 0; t < triangles; ++t ) {
 			destTriMesh->appendTriangle( offset + 0, offset + t + 1, offset + t + 2 );
 		}
-		offset += group.mFaces[f].mNumVertices;
+		offset += face.mNumVertices;
 	}	
 }
 
-void ObjLoader::loadInternalNormalsTextures( const Group &group, map<VertexTriple,int> &uniqueVerts, TriMesh *destTriMesh )
+void ObjLoader::loadInternal( const Group &group, VertexMap *uniqueVerts, TriMesh *destTriMesh, bool texCoords, bool normals )
 {
+	uniqueVerts->rehash( uniqueVerts->size() + group.mVertexIndices.size() );
+	vector<uint32_t> faceIndices;
 	for( size_t f = 0; f < group.mFaces.size(); ++f ) {
-		Vec3f inferredNormal;
-		bool forceUnique = false;
-		if( group.mFaces[f].mNormalIndices.empty() ) { // we'll have to derive it from two edges
-			Vec3f edge1 = mVertices[group.mFaces[f].mVertexIndices[1]] - mVertices[group.mFaces[f].mVertexIndices[0]];
-			Vec3f edge2 = mVertices[group.mFaces[f].mVertexIndices[2]] - mVertices[group.mFaces[f].mVertexIndices[0]];
-			inferredNormal = edge1.cross( edge2 ).normalized();
-			forceUnique = true;
-		}
-		
-		if( group.mFaces[f].mTexCoordIndices.empty() )
-			forceUnique = true;
-		
-		vector<int> faceIndices;
-		faceIndices.reserve( group.mFaces[f].mNumVertices );
-		for( int v = 0; v < group.mFaces[f].mNumVertices; ++v ) {
-			if( ! forceUnique ) {
-				VertexTriple triple = make_tuple( group.mFaces[f].mVertexIndices[v], group.mFaces[f].mTexCoordIndices[v], group.mFaces[f].mNormalIndices[v] );
-				pair<map<VertexTriple,int>::iterator,bool> result = uniqueVerts.insert( make_pair( triple, destTriMesh->getVertices().size() ) );
-				if( result.second ) { // we've got a new, unique vertex here, so let's append it
-					destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-					destTriMesh->appendNormal( mNormals[group.mFaces[f].mNormalIndices[v]] );
-					destTriMesh->appendTexCoord( mTexCoords[group.mFaces[f].mTexCoordIndices[v]] );
-				}
-				// the unique ID of the vertex is appended for this vert
-				faceIndices.push_back( result.first->second );
-			}
-			else { // have to force unique because this group lacks either normals or texCoords
-				faceIndices.push_back( destTriMesh->getVertices().size() );
-
-				destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-				if( ! group.mHasNormals )
-					destTriMesh->appendNormal( inferredNormal );
-				else
-					destTriMesh->appendNormal( mNormals[group.mFaces[f].mNormalIndices[v]] );
-				if( ! group.mHasTexCoords )
-					destTriMesh->appendTexCoord( Vec2f::zero() );
-				else
-					destTriMesh->appendTexCoord( mTexCoords[group.mFaces[f].mTexCoordIndices[v]] );
-			}
-		}
-
-		int triangles = faceIndices.size() - 2;
-		for( int t = 0; t < triangles; ++t ) {
-			destTriMesh->appendTriangle( faceIndices[0], faceIndices[t + 1], faceIndices[t + 2] );
-		}
-	}	
-}
+		const Face &face = group.mFaces[f];
+		const int *vertexIndices = &group.mVertexIndices[face.mFirstIndex];
+		const int *texCoordIndices = &group.mTexCoordIndices[face.mFirstIndex];
+		const int *normalIndices = &group.mNormalIndices[face.mFirstIndex];
 
-void ObjLoader::loadInternalNormals( const Group &group, map<VertexPair,int> &uniqueVerts, TriMesh *destTriMesh )
-{
-	for( size_t f = 0; f < group.mFaces.size(); ++f ) {
+		// faces which lack a requested attribute get vertices of their own, with made up texture coordinates or a normal derived from two edges
 		Vec3f inferredNormal;
-		bool forceUnique = false;
-		if( group.mFaces[f].mNormalIndices.empty() ) { // we'll have to derive it from two edges
-			Vec3f edge1 = mVertices[group.mFaces[f].mVertexIndices[1]] - mVertices[group.mFaces[f].mVertexIndices[0]];
-			Vec3f edge2 = mVertices[group.mFaces[f].mVertexIndices[2]] - mVertices[group.mFaces[f].mVertexIndices[0]];
+		if( normals && ( ! face.mHasNormals ) ) {
+			Vec3f edge1 = mVertices[vertexIndices[1]] - mVertices[vertexIndices[0]];
+			Vec3f edge2 = mVertices[vertexIndices[2]] - mVertices[vertexIndices[0]];
 			inferredNormal = edge1.cross( edge2 ).normalized();
-			forceUnique = true;
 		}
+		const bool forceUnique = ( normals && ( ! face.mHasNormals ) ) || ( texCoords && ( ! face.mHasTexCoords ) );
 		
-		vector<int> faceIndices;
-		faceIndices.reserve( group.mFaces[f].mNumVertices );
-		for( int v = 0; v < group.mFaces[f].mNumVertices; ++v ) {
+		faceIndices.clear();
+		for( int v = 0; v < face.mNumVertices; ++v ) {
 			if( ! forceUnique ) {
-				VertexPair triple = make_tuple( group.mFaces[f].mVertexIndices[v], group.mFaces[f].mNormalIndices[v] );
-				pair<map<VertexPair,int>::iterator,bool> result = uniqueVerts.insert( make_pair( triple, destTriMesh->getVertices().size() ) );
-				if( result.second ) { // we've got a new, unique vertex here, so let's append it
-					destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-					destTriMesh->appendNormal( mNormals[group.mFaces[f].mNormalIndices[v]] );
+				const VertexKey key( vertexIndices[v], ( texCoords ) ? texCoordIndices[v] : -1, ( normals ) ? normalIndices[v] : -1 );
+				pair<VertexMap::iterator,bool> result = uniqueVerts->insert( make_pair( key, (uint32_t)destTriMesh->getNumVertices() ) );
+				if( ! result.second ) { // the unique ID of the vertex is appended for this vert
+					faceIndices.push_back( result.first->second );
+					continue;
 				}
-				// the unique ID of the vertex is appended for this vert
-				faceIndices.push_back( result.first->second );
-			}
-			else { // have to force unique because this group lacks normals
-				faceIndices.push_back( destTriMesh->getVertices().size() );
-
-				destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-				if( ! group.mHasNormals )
-					destTriMesh->appendNormal( inferredNormal );
-				else
-					destTriMesh->appendNormal( mNormals[group.mFaces[f].mNormalIndices[v]] );
 			}
-		}
 
-		int triangles = faceIndices.size() - 2;
-		for( int t = 0; t < triangles; ++t ) {
-			destTriMesh->appendTriangle( faceIndices[0], faceIndices[t + 1], faceIndices[t + 2] );
-		}
-	}	
-}
-
-void ObjLoader::loadInternalTextures( const Group &group, map<VertexPair,int> &uniqueVerts, TriMesh *destTriMesh )
-{
-	for( size_t f = 0; f < group.mFaces.size(); ++f ) {
-		bool forceUnique = false;
-		if( group.mFaces[f].mTexCoordIndices.empty() )
-			forceUnique = true;
-		
-		vector<int> faceIndices;
-		faceIndices.reserve( group.mFaces[f].mNumVertices );
-		for( int v = 0; v < group.mFaces[f].mNumVertices; ++v ) {
-			if( ! forceUnique ) {
-				VertexPair triple = make_tuple( group.mFaces[f].mVertexIndices[v], group.mFaces[f].mTexCoordIndices[v] );
-				pair<map<VertexPair,int>::iterator,bool> result = uniqueVerts.insert( make_pair( triple, destTriMesh->getVertices().size() ) );
-				if( result.second ) { // we've got a new, unique vertex here, so let's append it
-					destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-					destTriMesh->appendTexCoord( mTexCoords[group.mFaces[f].mTexCoordIndices[v]] );
-				}
-				// the unique ID of the vertex is appended for this vert
-				faceIndices.push_back( result.first->second );
-			}
-			else { // have to force unique because this group lacks texCoords
-				faceIndices.push_back( destTriMesh->getVertices().size() );
-
-				destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-				if( ! group.mHasTexCoords )
-					destTriMesh->appendTexCoord( Vec2f::zero() );
-				else
-					destTriMesh->appendTexCoord( mTexCoords[group.mFaces[f].mTexCoordIndices[v]] );
-			}
-		}
-
-		int triangles = faceIndices.size() - 2;
-		for( int t = 0; t < triangles; ++t ) {
-			destTriMesh->appendTriangle( faceIndices[0], faceIndices[t + 1], faceIndices[t + 2] );
-		}
-	}	
-}
-
-void ObjLoader::loadInternal( const Group &group, map<int,int> &uniqueVerts, TriMesh *destTriMesh )
-{
-	for( size_t f = 0; f < group.mFaces.size(); ++f ) {
-		vector<int> faceIndices;
-		faceIndices.reserve( group.mFaces[f].mNumVertices );
-		for( int v = 0; v < group.mFaces[f].mNumVertices; ++v ) {
-			pair<map<int,int>::iterator,bool> result = uniqueVerts.insert( make_pair( group.mFaces[f].mVertexIndices[v], destTriMesh->getVertices().size() ) );
-			if( result.second ) { // we've got a new, unique vertex here, so let's append it
-				destTriMesh->appendVertex( mVertices[group.mFaces[f].mVertexIndices[v]] );
-			}
-			// the unique ID of the vertex is appended for this vert
-			faceIndices.push_back( result.first->second );
+			// we've got a new, unique vertex here, so let's append it
+			faceIndices.push_back( (uint32_t)destTriMesh->getNumVertices() );
+			destTriMesh->appendVertex( mVertices[vertexIndices[v]] );
+			if( normals )
+				destTriMesh->appendNormal( ( face.mHasNormals ) ? mNormals[normalIndices[v]] : inferredNormal );
+			if( texCoords )
+				destTriMesh->appendTexCoord( ( face.mHasTexCoords ) ? mTexCoords[texCoordIndices[v]] : Vec2f::zero() );
 		}
 
 		int triangles = faceIndices.size() - 2;
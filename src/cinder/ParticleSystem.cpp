@@ -0,0 +1,192 @@
+/*
+ Copyright (c) 2010, The Barbarian Group
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ParticleSystem.h"
+#include "cinder/Perlin.h"
+#include "cinder/CinderMath.h"
+
+#include <limits>
+
+namespace cinder {
+
+namespace {
+
+// positions and velocities are processed as flat arrays of floats, which the compiler vectorizes more readily than Vec3f arithmetic
+inline float* flat( Vec3f *v ) { return &v->x; }
+
+// how many positions applyFlowField() hands Perlin::dfBm() at a time
+const size_t FLOW_FIELD_BATCH = 256;
+
+void applyForceRange( Vec3f *velocities, const Vec3f &dv, size_t begin, size_t end )
+{
+	for( size_t i = begin; i < end; ++i )
+		velocities[i] += dv;
+}
+
+void applyAttractorRange( const Vec3f *positions, Vec3f *velocities, const Vec3f &center, float strengthDt, float minDistanceSquared, size_t begin, size_t end )
+{
+	for( size_t i = begin; i < end; ++i ) {
+		Vec3f delta = center - positions[i];
+		float distanceSquared = std::max( delta.lengthSquared(), minDistanceSquared );
+		velocities[i] += delta * ( strengthDt / ( distanceSquared * math<float>::sqrt( distanceSquared ) ) );
+	}
+}
+
+void applyFlowFieldRange( const Perlin *perlin, const Vec3f *positions, Vec3f *velocities, float frequency, const Vec3f &offset, float strengthDt, size_t begin, size_t end )
+{
+	Vec3f samples[FLOW_FIELD_BATCH], gradients[FLOW_FIELD_BATCH];
+	for( size_t batch = begin; batch < end; batch += FLOW_FIELD_BATCH ) {
+		const size_t count = std::min( FLOW_FIELD_BATCH, end - batch );
+		for( size_t i = 0; i < count; ++i )
+			samples[i] = positions[batch + i] * frequency + offset;
+		perlin->dfBm( samples, gradients, count );
+		for( size_t i = 0; i < count; ++i )
+			velocities[batch + i] += gradients[i] * strengthDt;
+	}
+}
+
+void scaleRange( float *velocities, float scale, size_t begin, size_t end )
+{
+	for( size_t i = begin * 3; i < end * 3; ++i )
+		velocities[i] *= scale;
+}
+
+void integrateRange( float *positions, const float *velocities, float *ages, float dt, size_t begin, size_t end )
+{
+	for( size_t i = begin * 3; i < end * 3; ++i )
+		positions[i] += velocities[i] * dt;
+	for( size_t i = begin; i < end; ++i )
+		ages[i] += dt;
+}
+
+} // anonymous namespace
+
+ParticleSystem::ParticleSystem( size_t reserve )
+	: mJobSystem( JobSystem::getDefault() ), mGrainSize( 4096 )
+{
+	mPositions.reserve( reserve );
+	mVelocities.reserve( reserve );
+	mColors.reserve( reserve );
+	mAges.reserve( reserve );
+	mLifetimes.reserve( reserve );
+}
+
+size_t ParticleSystem::emit( const Vec3f &position, const Vec3f &velocity, float lifetime, const ColorA &color )
+{
+	mPositions.push_back( position );
+	mVelocities.push_back( velocity );
+	mColors.push_back( color );
+	mAges.push_back( 0 );
+	mLifetimes.push_back( lifetime );
+	return mPositions.size() - 1;
+}
+
+size_t ParticleSystem::emit( size_t count )
+{
+	const size_t first = mPositions.size();
+	mPositions.resize( first + count, Vec3f::zero() );
+	mVelocities.resize( first + count, Vec3f::zero() );
+	mColors.resize( first + count, ColorA::white() );
+	mAges.resize( first + count, 0 );
+	mLifetimes.resize( first + count, std::numeric_limits<float>::infinity() );
+	return first;
+}
+
+void ParticleSystem::kill( size_t index )
+{
+	const size_t last = mPositions.size() - 1;
+	if( index != last ) {
+		mPositions[index] = mPositions[last];
+		mVelocities[index] = mVelocities[last];
+		mColors[index] = mColors[last];
+		mAges[index] = mAges[last];
+		mLifetimes[index] = mLifetimes[last];
+	}
+	mPositions.pop_back();
+	mVelocities.pop_back();
+	mColors.pop_back();
+	mAges.pop_back();
+	mLifetimes.pop_back();
+}
+
+size_t ParticleSystem::killExpired()
+{
+	// walk backward so that the particle moved into a killed particle's place has already been checked
+	const size_t oldSize = mPositions.size();
+	for( size_t i = oldSize; i > 0; --i ) {
+		if( mAges[i - 1] >= mLifetimes[i - 1] )
+			kill( i - 1 );
+	}
+
+	return oldSize - mPositions.size();
+}
+
+void ParticleSystem::clear()
+{
+	mPositions.clear();
+	mVelocities.clear();
+	mColors.clear();
+	mAges.clear();
+	mLifetimes.clear();
+}
+
+void ParticleSystem::parallelFor( const std::function<void(size_t,size_t)> &kernel ) const
+{
+	const size_t count = mPositions.size();
+	if( ( ! mJobSystem ) || ( count <= mGrainSize ) ) {
+		if( count )
+			kernel( 0, count );
+		return;
+	}
+
+	mJobSystem->parallelFor( 0, (int32_t)count, kernel, (int32_t)mGrainSize );
+}
+
+void ParticleSystem::applyForce( const Vec3f &acceleration, float dt )
+{
+	parallelFor( std::bind( applyForceRange, getVelocities(), acceleration * dt, std::_1, std::_2 ) );
+}
+
+void ParticleSystem::applyAttractor( const Vec3f &center, float strength, float dt, float minDistance )
+{
+	parallelFor( std::bind( applyAttractorRange, getPositions(), getVelocities(), center, strength * dt, minDistance * minDistance, std::_1, std::_2 ) );
+}
+
+void ParticleSystem::applyFlowField( const Perlin &perlin, float frequency, float strength, float dt, const Vec3f &offset )
+{
+	parallelFor( std::bind( applyFlowFieldRange, &perlin, getPositions(), getVelocities(), frequency, offset, strength * dt, std::_1, std::_2 ) );
+}
+
+void ParticleSystem::applyDamping( float damping, float dt )
+{
+	float *velocities = empty() ? 0 : flat( getVelocities() );
+	parallelFor( std::bind( scaleRange, velocities, math<float>::pow( damping, dt ), std::_1, std::_2 ) );
+}
+
+void ParticleSystem::integrate( float dt )
+{
+	float *positions = empty() ? 0 : flat( getPositions() );
+	const float *velocities = empty() ? 0 : flat( getVelocities() );
+	parallelFor( std::bind( integrateRange, positions, velocities, getAges(), dt, std::_1, std::_2 ) );
+}
+
+} // namespace cinder
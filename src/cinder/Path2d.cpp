@@ -24,6 +24,7 @@
 
 
 #include "cinder/Path2d.h"
+#include "cinder/Matrix.h"
 
 #include <algorithm>
 
@@ -143,6 +144,7 @@ void Path2d::moveTo( const Vec2f &p )
 		throw Path2dExc(); // can only moveTo as the first point
 		
 	mPoints.push_back( p );
+	mFlattenCache.reset();
 }
 
 void Path2d::lineTo( const Vec2f &p )
@@ -152,6 +154,7 @@ void Path2d::lineTo( const Vec2f &p )
 		
 	mPoints.push_back( p );
 	mSegments.push_back( LINETO );
+	mFlattenCache.reset();
 }
 
 void Path2d::quadTo( const Vec2f &p1, const Vec2f &p2 )
@@ -162,6 +165,7 @@ void Path2d::quadTo( const Vec2f &p1, const Vec2f &p2 )
 	mPoints.push_back( p1 );
 	mPoints.push_back( p2 );
 	mSegments.push_back( QUADTO );
+	mFlattenCache.reset();
 }
 
 void Path2d::curveTo( const Vec2f &p1, const Vec2f &p2, const Vec2f &p3 )
@@ -173,6 +177,7 @@ void Path2d::curveTo( const Vec2f &p1, const Vec2f &p2, const Vec2f &p3 )
 	mPoints.push_back( p2 );
 	mPoints.push_back( p3 );	
 	mSegments.push_back( CUBICTO );
+	mFlattenCache.reset();
 }
 
 void Path2d::arc( const Vec2f &center, float radius, float startRadians, float endRadians, bool forward )
@@ -345,6 +350,7 @@ void Path2d::reverse()
             std::reverse( mSegments.begin() + 1, mSegments.end() );
     }
 
+	mFlattenCache.reset();
 }
 
 void Path2d::removeSegment( size_t segment )
@@ -357,6 +363,7 @@ void Path2d::removeSegment( size_t segment )
 	mPoints.erase( mPoints.begin() + firstPoint, mPoints.begin() + firstPoint + pointCount );
 	
 	mSegments.erase( mSegments.begin() + segment );
+	mFlattenCache.reset();
 }
 
 Vec2f Path2d::getPosition( float t ) const
@@ -598,23 +605,195 @@ void Path2d::subdivideCubic( float distanceToleranceSqr, const Vec2f &p1, const
 	subdivideCubic( distanceToleranceSqr, p1234, p234, p34, p4, level + 1, result ); 
 }
 
+struct Path2d::FlattenCache {
+	float				mApproximationScale;
+	vector<Vec2f>		mPoints;
+	vector<float>		mTimes;		// parameter of each point, as accepted by getPosition()
+	vector<float>		mLengths;	// arc length from the start of the path to each point
+};
+
+namespace {
+
+const int FLATTEN_RECURSION_LIMIT = 17;
+
+// A curve is flat enough once its control points lie within the tolerance of its chord and the control polygon is barely longer than the chord.
+// The second test rejects control points which double back along the chord, where the curve would be misjudged as a single span.
+bool isFlat( const Vec2f *pts, int numPts, float distanceTolerance )
+{
+	const Vec2f &p1 = pts[0], &pn = pts[numPts-1];
+	Vec2f chord = pn - p1;
+	float chordLengthSqr = chord.lengthSquared();
+	float distanceToleranceSqr = distanceTolerance * distanceTolerance;
+	float polygonLength = 0;
+	for( int i = 1; i < numPts; ++i ) {
+		polygonLength += pts[i].distance( pts[i-1] );
+		if( i == numPts - 1 )
+			break;
+		Vec2f v = pts[i] - p1;
+		if( chordLengthSqr == 0 ) {
+			if( v.lengthSquared() > distanceToleranceSqr )
+				return false;
+		}
+		else {
+			float cross = v.x * chord.y - v.y * chord.x;
+			if( cross * cross > distanceToleranceSqr * chordLengthSqr )
+				return false;
+		}
+	}
+
+	return polygonLength - math<float>::sqrt( chordLengthSqr ) <= distanceTolerance * 0.25f;
+}
+
+// Emits the end point of every flat span of the curve in [t0,t1], tagged with its path parameter segBase + t * segScale
+void flattenBezier( const Vec2f *pts, int numPts, float distanceTolerance, float t0, float t1, float segBase, float segScale, int level, vector<Vec2f> *points, vector<float> *times )
+{
+	if( level < FLATTEN_RECURSION_LIMIT && ( ! isFlat( pts, numPts, distanceTolerance ) ) ) {
+		// split at the midpoint via de Casteljau
+		Vec2f left[4], right[4], work[4];
+		std::copy( pts, pts + numPts, work );
+		for( int i = 0; i < numPts; ++i ) {
+			left[i] = work[0];
+			right[numPts-1-i] = work[numPts-1-i];
+			for( int j = 0; j < numPts - 1 - i; ++j )
+				work[j] = ( work[j] + work[j+1] ) * 0.5f;
+		}
+		float tm = ( t0 + t1 ) * 0.5f;
+		flattenBezier( left, numPts, distanceTolerance, t0, tm, segBase, segScale, level + 1, points, times );
+		flattenBezier( right, numPts, distanceTolerance, tm, t1, segBase, segScale, level + 1, points, times );
+	}
+	else {
+		points->push_back( pts[numPts-1] );
+		times->push_back( segBase + t1 * segScale );
+	}
+}
+
+} // anonymous namespace
+
+const Path2d::FlattenCache& Path2d::getFlattenCache( float approximationScale ) const
+{
+	if( mFlattenCache && mFlattenCache->mApproximationScale == approximationScale )
+		return *mFlattenCache;
+
+	std::shared_ptr<FlattenCache> cache( new FlattenCache );
+	cache->mApproximationScale = approximationScale;
+	if( ! mSegments.empty() ) {
+		const float distanceTolerance = 0.5f / approximationScale;
+		const float segScale = 1.0f / mSegments.size();
+		cache->mPoints.push_back( mPoints[0] );
+		cache->mTimes.push_back( 0 );
+		size_t firstPoint = 0;
+		for( size_t s = 0; s < mSegments.size(); ++s ) {
+			float segBase = s * segScale;
+			switch( mSegments[s] ) {
+				case CUBICTO:
+					flattenBezier( &mPoints[firstPoint], 4, distanceTolerance, 0, 1, segBase, segScale, 0, &cache->mPoints, &cache->mTimes );
+				break;
+				case QUADTO:
+					flattenBezier( &mPoints[firstPoint], 3, distanceTolerance, 0, 1, segBase, segScale, 0, &cache->mPoints, &cache->mTimes );
+				break;
+				case LINETO:
+					cache->mPoints.push_back( mPoints[firstPoint+1] );
+					cache->mTimes.push_back( segBase + segScale );
+				break;
+				case CLOSE:
+					cache->mPoints.push_back( mPoints[0] );
+					cache->mTimes.push_back( segBase + segScale );
+				break;
+				default:
+					throw Path2dExc();
+			}
+
+			firstPoint += sSegmentTypePointCounts[mSegments[s]];
+		}
+		cache->mTimes.back() = 1.0f;
+
+		cache->mLengths.resize( cache->mPoints.size() );
+		double length = 0;
+		cache->mLengths[0] = 0;
+		for( size_t i = 1; i < cache->mPoints.size(); ++i ) {
+			length += cache->mPoints[i].distance( cache->mPoints[i-1] );
+			cache->mLengths[i] = static_cast<float>( length );
+		}
+	}
+
+	mFlattenCache = cache;
+	return *cache;
+}
+
+const vector<Vec2f>& Path2d::getSubdivided( float approximationScale ) const
+{
+	return getFlattenCache( approximationScale ).mPoints;
+}
+
+float Path2d::calcLength() const
+{
+	const FlattenCache &cache = getFlattenCache( 1.0f );
+	return cache.mLengths.empty() ? 0 : cache.mLengths.back();
+}
+
+// Returns the index of the first point at least \a distance along the path, and how far \a distance lies between it and its predecessor
+size_t Path2d::findArcLengthIndex( const FlattenCache &cache, float distance, float *fraction )
+{
+	const vector<float> &lengths = cache.mLengths;
+	if( distance <= 0 ) {
+		*fraction = 1;
+		return 0;
+	}
+	else if( distance >= lengths.back() ) {
+		*fraction = 1;
+		return lengths.size() - 1;
+	}
+
+	size_t i = std::lower_bound( lengths.begin(), lengths.end(), distance ) - lengths.begin();
+	float spanLength = lengths[i] - lengths[i-1];
+	*fraction = ( spanLength > 0 ) ? ( distance - lengths[i-1] ) / spanLength : 1;
+	return i;
+}
+
+Vec2f Path2d::calcPosition( float t ) const
+{
+	const FlattenCache &cache = getFlattenCache( 1.0f );
+	if( cache.mPoints.empty() )
+		return mPoints.empty() ? Vec2f::zero() : mPoints[0];
+
+	float fraction;
+	size_t i = findArcLengthIndex( cache, t * cache.mLengths.back(), &fraction );
+	if( i == 0 )
+		return cache.mPoints[0];
+	return cache.mPoints[i-1] + ( cache.mPoints[i] - cache.mPoints[i-1] ) * fraction;
+}
+
+float Path2d::calcNormalizedTime( float distance ) const
+{
+	const FlattenCache &cache = getFlattenCache( 1.0f );
+	if( cache.mPoints.empty() )
+		return 0;
+
+	float fraction;
+	size_t i = findArcLengthIndex( cache, distance, &fraction );
+	if( i == 0 )
+		return 0;
+	return cache.mTimes[i-1] + ( cache.mTimes[i] - cache.mTimes[i-1] ) * fraction;
+}
+
 void Path2d::scale( const Vec2f &amount, Vec2f scaleCenter )
 {
 	for( vector<Vec2f>::iterator ptIt = mPoints.begin(); ptIt != mPoints.end(); ++ptIt )
 		*ptIt = scaleCenter + Vec2f( ( ptIt->x - scaleCenter.x ) * amount.x, ( ptIt->y - scaleCenter.y ) * amount.y );
+	mFlattenCache.reset();
 }
 
 void Path2d::transform( const MatrixAffine2f &matrix )
 {
-	for( vector<Vec2f>::iterator ptIt = mPoints.begin(); ptIt != mPoints.end(); ++ptIt )
-		*ptIt = matrix.transformPoint( *ptIt );
+	if( ! mPoints.empty() )
+		transformPoints( matrix, &mPoints[0], &mPoints[0], mPoints.size() );
+	mFlattenCache.reset();
 }
 
 Path2d Path2d::transformCopy( const MatrixAffine2f &matrix ) const
 {
 	Path2d result = *this;
-	for( vector<Vec2f>::iterator ptIt = result.mPoints.begin(); ptIt != result.mPoints.end(); ++ptIt )
-		*ptIt = matrix.transformPoint( *ptIt );
+	result.transform( matrix );
 	return result;
 }
 
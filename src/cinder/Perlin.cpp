@@ -27,6 +27,14 @@
 #include "cinder/Perlin.h"
 #include "cinder/CinderMath.h"
 #include "cinder/Rand.h"
+#include "cinder/ip/ExecutionContext.h"
+#include "cinder/ip/Simd.h"
+
+#include <vector>
+
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#endif
 
 namespace cinder {
 
@@ -34,6 +42,161 @@ static inline float fade( float t ) { return t * t * t * (t * (t * 6 - 15) + 10)
 static inline float dfade( float t ) { return 30.0f * t * t * ( t * ( t - 2.0f ) + 1.0f ); }
 inline float nlerp(float t, float a, float b) { return a + t * (b - a); }
 
+namespace {
+
+// batches shorter than this aren't worth splitting across threads
+const size_t MIN_PARALLEL_POSITIONS = 4096;
+
+#if defined( CINDER_IP_SSE2 )
+// Four lane versions of noise() and dnoise(), which perform the same float operations in the same order as the scalar versions so that they return identical values.
+// The permutation lookups remain scalar.
+
+inline __m128 select( __m128 mask, __m128 a, __m128 b ) { return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) ); }
+
+inline __m128 fade4( __m128 t )
+{
+	return _mm_mul_ps( _mm_mul_ps( _mm_mul_ps( t, t ), t ), _mm_add_ps( _mm_mul_ps( t, _mm_sub_ps( _mm_mul_ps( t, _mm_set1_ps( 6 ) ), _mm_set1_ps( 15 ) ) ), _mm_set1_ps( 10 ) ) );
+}
+
+// dfade(), replacing values below 0.000001 with 1 as dnoise() does
+inline __m128 dfade4( __m128 t )
+{
+	const __m128 d = _mm_mul_ps( _mm_mul_ps( _mm_mul_ps( _mm_set1_ps( 30.0f ), t ), t ), _mm_add_ps( _mm_mul_ps( t, _mm_sub_ps( t, _mm_set1_ps( 2.0f ) ) ), _mm_set1_ps( 1.0f ) ) );
+	return select( _mm_cmplt_ps( d, _mm_set1_ps( 0.000001f ) ), _mm_set1_ps( 1.0f ), d );
+}
+
+inline __m128 nlerp4( __m128 t, __m128 a, __m128 b ) { return _mm_add_ps( a, _mm_mul_ps( t, _mm_sub_ps( b, a ) ) ); }
+
+inline __m128 floor4( __m128 x )
+{
+	const __m128 truncated = _mm_cvtepi32_ps( _mm_cvttps_epi32( x ) );
+	return _mm_sub_ps( truncated, _mm_and_ps( _mm_cmpgt_ps( truncated, x ), _mm_set1_ps( 1.0f ) ) );
+}
+
+// negates the lanes of u with bit 0 of h set and the lanes of v with bit 1 set, then sums them
+inline __m128 gradSum( __m128i h, __m128 u, __m128 v )
+{
+	const __m128 signU = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( h, _mm_set1_epi32( 1 ) ), 31 ) );
+	const __m128 signV = _mm_castsi128_ps( _mm_slli_epi32( _mm_and_si128( h, _mm_set1_epi32( 2 ) ), 30 ) );
+	return _mm_add_ps( _mm_xor_ps( u, signU ), _mm_xor_ps( v, signV ) );
+}
+
+inline __m128 grad4( const int32_t *hash, __m128 x, __m128 y )
+{
+	const __m128i h = _mm_and_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( hash ) ), _mm_set1_epi32( 15 ) );
+	const __m128 lt8 = _mm_castsi128_ps( _mm_cmplt_epi32( h, _mm_set1_epi32( 8 ) ) ), lt4 = _mm_castsi128_ps( _mm_cmplt_epi32( h, _mm_set1_epi32( 4 ) ) );
+	const __m128 is12or14 = _mm_castsi128_ps( _mm_or_si128( _mm_cmpeq_epi32( h, _mm_set1_epi32( 12 ) ), _mm_cmpeq_epi32( h, _mm_set1_epi32( 14 ) ) ) );
+	return gradSum( h, select( lt8, x, y ), select( lt4, y, _mm_and_ps( is12or14, x ) ) );
+}
+
+inline __m128 grad4( const int32_t *hash, __m128 x, __m128 y, __m128 z )
+{
+	const __m128i h = _mm_and_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( hash ) ), _mm_set1_epi32( 15 ) );
+	const __m128 lt8 = _mm_castsi128_ps( _mm_cmplt_epi32( h, _mm_set1_epi32( 8 ) ) ), lt4 = _mm_castsi128_ps( _mm_cmplt_epi32( h, _mm_set1_epi32( 4 ) ) );
+	const __m128 is12or14 = _mm_castsi128_ps( _mm_or_si128( _mm_cmpeq_epi32( h, _mm_set1_epi32( 12 ) ), _mm_cmpeq_epi32( h, _mm_set1_epi32( 14 ) ) ) );
+	return gradSum( h, select( lt8, x, y ), select( lt4, y, select( is12or14, x, z ) ) );
+}
+
+// Splits x and y into their lattice cells, wrapped to 0-255, and their fractional parts, and looks up the hashes of the cell's 4 corners as
+// hash[0] = AA, hash[4] = BA, hash[8] = AB and hash[12] = BB. dnoise( x, y ) truncates rather than floors its cells, which \a truncate reproduces.
+inline void hashCorners( const uint8_t *perms, __m128 *x, __m128 *y, bool truncate, int32_t hash[16] )
+{
+	const __m128 fx = floor4( *x ), fy = floor4( *y );
+	int32_t X[4], Y[4];
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( X ), _mm_and_si128( _mm_cvttps_epi32( truncate ? *x : fx ), _mm_set1_epi32( 255 ) ) );
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( Y ), _mm_and_si128( _mm_cvttps_epi32( truncate ? *y : fy ), _mm_set1_epi32( 255 ) ) );
+	*x = _mm_sub_ps( *x, fx );
+	*y = _mm_sub_ps( *y, fy );
+	for( int l = 0; l < 4; ++l ) {
+		const int32_t A = perms[X[l]] + Y[l], B = perms[X[l] + 1] + Y[l];
+		hash[l] = perms[perms[A]];
+		hash[4 + l] = perms[perms[B]];
+		hash[8 + l] = perms[perms[A + 1]];
+		hash[12 + l] = perms[perms[B + 1]];
+	}
+}
+
+// Splits x, y and z into their lattice cells and fractional parts, and looks up the hashes of the cell's 8 corners in the order of the gradients a through h of noise( x, y, z )
+inline void hashCorners( const uint8_t *perms, __m128 *x, __m128 *y, __m128 *z, int32_t hash[32] )
+{
+	const __m128 fx = floor4( *x ), fy = floor4( *y ), fz = floor4( *z );
+	int32_t X[4], Y[4], Z[4];
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( X ), _mm_and_si128( _mm_cvttps_epi32( fx ), _mm_set1_epi32( 255 ) ) );
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( Y ), _mm_and_si128( _mm_cvttps_epi32( fy ), _mm_set1_epi32( 255 ) ) );
+	_mm_storeu_si128( reinterpret_cast<__m128i*>( Z ), _mm_and_si128( _mm_cvttps_epi32( fz ), _mm_set1_epi32( 255 ) ) );
+	*x = _mm_sub_ps( *x, fx );
+	*y = _mm_sub_ps( *y, fy );
+	*z = _mm_sub_ps( *z, fz );
+	for( int l = 0; l < 4; ++l ) {
+		const int32_t A = perms[X[l]] + Y[l], AA = perms[A] + Z[l], AB = perms[A + 1] + Z[l];
+		const int32_t B = perms[X[l] + 1] + Y[l], BA = perms[B] + Z[l], BB = perms[B + 1] + Z[l];
+		hash[l] = perms[AA];
+		hash[4 + l] = perms[BA];
+		hash[8 + l] = perms[AB];
+		hash[12 + l] = perms[BB];
+		hash[16 + l] = perms[AA + 1];
+		hash[20 + l] = perms[BA + 1];
+		hash[24 + l] = perms[AB + 1];
+		hash[28 + l] = perms[BB + 1];
+	}
+}
+
+__m128 noise4( const uint8_t *perms, __m128 x, __m128 y )
+{
+	int32_t hash[16];
+	hashCorners( perms, &x, &y, false, hash );
+	const __m128 one = _mm_set1_ps( 1.0f ), x1 = _mm_sub_ps( x, one ), y1 = _mm_sub_ps( y, one );
+	const __m128 u = fade4( x ), v = fade4( y );
+	return nlerp4( v, nlerp4( u, grad4( hash, x, y ), grad4( hash + 4, x1, y ) ),
+						nlerp4( u, grad4( hash + 8, x, y1 ), grad4( hash + 12, x1, y1 ) ) );
+}
+
+__m128 noise4( const uint8_t *perms, __m128 x, __m128 y, __m128 z )
+{
+	int32_t hash[32];
+	hashCorners( perms, &x, &y, &z, hash );
+	const __m128 one = _mm_set1_ps( 1.0f ), x1 = _mm_sub_ps( x, one ), y1 = _mm_sub_ps( y, one ), z1 = _mm_sub_ps( z, one );
+	const __m128 u = fade4( x ), v = fade4( y ), w = fade4( z );
+	const __m128 a = grad4( hash, x, y, z ), b = grad4( hash + 4, x1, y, z ), c = grad4( hash + 8, x, y1, z ), d = grad4( hash + 12, x1, y1, z );
+	const __m128 e = grad4( hash + 16, x, y, z1 ), f = grad4( hash + 20, x1, y, z1 ), g = grad4( hash + 24, x, y1, z1 ), h = grad4( hash + 28, x1, y1, z1 );
+	return nlerp4( w, nlerp4( v, nlerp4( u, a, b ), nlerp4( u, c, d ) ),
+						nlerp4( v, nlerp4( u, e, f ), nlerp4( u, g, h ) ) );
+}
+
+void dnoise4( const uint8_t *perms, __m128 x, __m128 y, __m128 *dx, __m128 *dy )
+{
+	int32_t hash[16];
+	hashCorners( perms, &x, &y, true, hash );
+	const __m128 one = _mm_set1_ps( 1.0f ), x1 = _mm_sub_ps( x, one ), y1 = _mm_sub_ps( y, one );
+	const __m128 u = fade4( x ), v = fade4( y ), du = dfade4( x ), dv = dfade4( y );
+	const __m128 a = grad4( hash, x, y ), b = grad4( hash + 4, x1, y ), c = grad4( hash + 8, x, y1 ), d = grad4( hash + 12, x1, y1 );
+	const __m128 k1 = _mm_sub_ps( b, a ), k2 = _mm_sub_ps( c, a ), k4 = _mm_add_ps( _mm_sub_ps( _mm_sub_ps( a, b ), c ), d );
+	*dx = _mm_mul_ps( du, _mm_add_ps( k1, _mm_mul_ps( k4, v ) ) );
+	*dy = _mm_mul_ps( dv, _mm_add_ps( k2, _mm_mul_ps( k4, u ) ) );
+}
+
+void dnoise4( const uint8_t *perms, __m128 x, __m128 y, __m128 z, __m128 *dx, __m128 *dy, __m128 *dz )
+{
+	int32_t hash[32];
+	hashCorners( perms, &x, &y, &z, hash );
+	const __m128 one = _mm_set1_ps( 1.0f ), x1 = _mm_sub_ps( x, one ), y1 = _mm_sub_ps( y, one ), z1 = _mm_sub_ps( z, one );
+	const __m128 u = fade4( x ), v = fade4( y ), w = fade4( z ), du = dfade4( x ), dv = dfade4( y ), dw = dfade4( z );
+	const __m128 a = grad4( hash, x, y, z ), b = grad4( hash + 4, x1, y, z ), c = grad4( hash + 8, x, y1, z ), d = grad4( hash + 12, x1, y1, z );
+	const __m128 e = grad4( hash + 16, x, y, z1 ), f = grad4( hash + 20, x1, y, z1 ), g = grad4( hash + 24, x, y1, z1 ), h = grad4( hash + 28, x1, y1, z1 );
+	const __m128 k1 = _mm_sub_ps( b, a ), k2 = _mm_sub_ps( c, a ), k3 = _mm_sub_ps( e, a );
+	const __m128 k4 = _mm_add_ps( _mm_sub_ps( _mm_sub_ps( a, b ), c ), d );
+	const __m128 k5 = _mm_add_ps( _mm_sub_ps( _mm_sub_ps( a, c ), e ), g );
+	const __m128 k6 = _mm_add_ps( _mm_sub_ps( _mm_sub_ps( a, b ), e ), f );
+	const __m128 negA = _mm_xor_ps( a, _mm_set1_ps( -0.0f ) );
+	const __m128 k7 = _mm_add_ps( _mm_sub_ps( _mm_sub_ps( _mm_add_ps( _mm_sub_ps( _mm_add_ps( _mm_add_ps( negA, b ), c ), d ), e ), f ), g ), h );
+	*dx = _mm_mul_ps( du, _mm_add_ps( _mm_add_ps( _mm_add_ps( k1, _mm_mul_ps( k4, v ) ), _mm_mul_ps( k6, w ) ), _mm_mul_ps( _mm_mul_ps( k7, v ), w ) ) );
+	*dy = _mm_mul_ps( dv, _mm_add_ps( _mm_add_ps( _mm_add_ps( k2, _mm_mul_ps( k5, w ) ), _mm_mul_ps( k4, u ) ), _mm_mul_ps( _mm_mul_ps( k7, w ), u ) ) );
+	*dz = _mm_mul_ps( dw, _mm_add_ps( _mm_add_ps( _mm_add_ps( k3, _mm_mul_ps( k6, u ) ), _mm_mul_ps( k5, v ) ), _mm_mul_ps( _mm_mul_ps( k7, u ), v ) ) );
+}
+#endif // defined( CINDER_IP_SSE2 )
+
+} // anonymous namespace
+
 Perlin::Perlin( uint8_t aOctaves, int32_t aSeed )
 	: mOctaves( aOctaves ), mSeed( aSeed ){
 	initPermutationTable();
@@ -153,6 +316,175 @@ Vec3f Perlin::dfBm( const Vec3f &v ) const
 	return result;
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// Batch fBm
+namespace {
+
+// calls \a bandFn for the rows of a 1 x \a count Area, on the threads of \a context when it is worthwhile
+void runInBands( size_t count, const ip::ExecutionContextRef &context, const std::function<void(const Area&)> &bandFn )
+{
+	const Area area( 0, 0, 1, (int32_t)count );
+	if( context && ( count >= MIN_PARALLEL_POSITIONS ) && ( context->getNumThreads() > 1 ) )
+		context->run( area, bandFn );
+	else
+		bandFn( area );
+}
+
+} // anonymous namespace
+
+void Perlin::fBm( const Vec2f *positions, float *results, size_t count, const ip::ExecutionContextRef &context ) const
+{
+	runInBands( count, context, std::bind( &Perlin::fBmBand2, this, positions, results, std::_1 ) );
+}
+
+void Perlin::fBm( const Vec3f *positions, float *results, size_t count, const ip::ExecutionContextRef &context ) const
+{
+	runInBands( count, context, std::bind( &Perlin::fBmBand3, this, positions, results, std::_1 ) );
+}
+
+void Perlin::dfBm( const Vec2f *positions, Vec2f *results, size_t count, const ip::ExecutionContextRef &context ) const
+{
+	runInBands( count, context, std::bind( &Perlin::dfBmBand2, this, positions, results, std::_1 ) );
+}
+
+void Perlin::dfBm( const Vec3f *positions, Vec3f *results, size_t count, const ip::ExecutionContextRef &context ) const
+{
+	runInBands( count, context, std::bind( &Perlin::dfBmBand3, this, positions, results, std::_1 ) );
+}
+
+void Perlin::fBm( Channel32f *channel, const Vec2f &offset, const Vec2f &scale, const ip::ExecutionContextRef &context ) const
+{
+	const Area area = channel->getBounds();
+	if( context && ( (size_t)area.calcArea() >= MIN_PARALLEL_POSITIONS ) && ( context->getNumThreads() > 1 ) )
+		context->run( area, std::bind( &Perlin::fBmChannelBand, this, channel, offset, scale, std::_1 ) );
+	else
+		fBmChannelBand( channel, offset, scale, area );
+}
+
+void Perlin::fBmBand2( const Vec2f *positions, float *results, const Area &band ) const
+{
+	size_t i = band.y1;
+	const size_t end = band.y2;
+#if defined( CINDER_IP_SSE2 )
+	if( ip::useSse2() ) {
+		for( ; i + 4 <= end; i += 4 ) {
+			const Vec2f *p = positions + i;
+			__m128 x = _mm_setr_ps( p[0].x, p[1].x, p[2].x, p[3].x ), y = _mm_setr_ps( p[0].y, p[1].y, p[2].y, p[3].y );
+			__m128 result = _mm_setzero_ps();
+			float amp = 0.5f;
+			for( uint8_t o = 0; o < mOctaves; o++ ) {
+				result = _mm_add_ps( result, _mm_mul_ps( noise4( mPerms, x, y ), _mm_set1_ps( amp ) ) );
+				x = _mm_mul_ps( x, _mm_set1_ps( 2.0f ) ); y = _mm_mul_ps( y, _mm_set1_ps( 2.0f ) );
+				amp *= 0.5f;
+			}
+			_mm_storeu_ps( results + i, result );
+		}
+	}
+#endif
+	for( ; i < end; ++i )
+		results[i] = fBm( positions[i] );
+}
+
+void Perlin::fBmBand3( const Vec3f *positions, float *results, const Area &band ) const
+{
+	size_t i = band.y1;
+	const size_t end = band.y2;
+#if defined( CINDER_IP_SSE2 )
+	if( ip::useSse2() ) {
+		for( ; i + 4 <= end; i += 4 ) {
+			const Vec3f *p = positions + i;
+			__m128 x = _mm_setr_ps( p[0].x, p[1].x, p[2].x, p[3].x ), y = _mm_setr_ps( p[0].y, p[1].y, p[2].y, p[3].y ), z = _mm_setr_ps( p[0].z, p[1].z, p[2].z, p[3].z );
+			__m128 result = _mm_setzero_ps();
+			float amp = 0.5f;
+			for( uint8_t o = 0; o < mOctaves; o++ ) {
+				result = _mm_add_ps( result, _mm_mul_ps( noise4( mPerms, x, y, z ), _mm_set1_ps( amp ) ) );
+				x = _mm_mul_ps( x, _mm_set1_ps( 2.0f ) ); y = _mm_mul_ps( y, _mm_set1_ps( 2.0f ) ); z = _mm_mul_ps( z, _mm_set1_ps( 2.0f ) );
+				amp *= 0.5f;
+			}
+			_mm_storeu_ps( results + i, result );
+		}
+	}
+#endif
+	for( ; i < end; ++i )
+		results[i] = fBm( positions[i] );
+}
+
+void Perlin::dfBmBand2( const Vec2f *positions, Vec2f *results, const Area &band ) const
+{
+	size_t i = band.y1;
+	const size_t end = band.y2;
+#if defined( CINDER_IP_SSE2 )
+	if( ip::useSse2() ) {
+		for( ; i + 4 <= end; i += 4 ) {
+			const Vec2f *p = positions + i;
+			__m128 x = _mm_setr_ps( p[0].x, p[1].x, p[2].x, p[3].x ), y = _mm_setr_ps( p[0].y, p[1].y, p[2].y, p[3].y );
+			__m128 rx = _mm_setzero_ps(), ry = _mm_setzero_ps();
+			float amp = 0.5f;
+			for( uint8_t o = 0; o < mOctaves; o++ ) {
+				__m128 dx, dy;
+				dnoise4( mPerms, x, y, &dx, &dy );
+				rx = _mm_add_ps( rx, _mm_mul_ps( dx, _mm_set1_ps( amp ) ) ); ry = _mm_add_ps( ry, _mm_mul_ps( dy, _mm_set1_ps( amp ) ) );
+				x = _mm_mul_ps( x, _mm_set1_ps( 2.0f ) ); y = _mm_mul_ps( y, _mm_set1_ps( 2.0f ) );
+				amp *= 0.5f;
+			}
+			float xs[4], ys[4];
+			_mm_storeu_ps( xs, rx ); _mm_storeu_ps( ys, ry );
+			for( int l = 0; l < 4; ++l )
+				results[i + l] = Vec2f( xs[l], ys[l] );
+		}
+	}
+#endif
+	for( ; i < end; ++i )
+		results[i] = dfBm( positions[i] );
+}
+
+void Perlin::dfBmBand3( const Vec3f *positions, Vec3f *results, const Area &band ) const
+{
+	size_t i = band.y1;
+	const size_t end = band.y2;
+#if defined( CINDER_IP_SSE2 )
+	if( ip::useSse2() ) {
+		for( ; i + 4 <= end; i += 4 ) {
+			const Vec3f *p = positions + i;
+			__m128 x = _mm_setr_ps( p[0].x, p[1].x, p[2].x, p[3].x ), y = _mm_setr_ps( p[0].y, p[1].y, p[2].y, p[3].y ), z = _mm_setr_ps( p[0].z, p[1].z, p[2].z, p[3].z );
+			__m128 rx = _mm_setzero_ps(), ry = _mm_setzero_ps(), rz = _mm_setzero_ps();
+			float amp = 0.5f;
+			for( uint8_t o = 0; o < mOctaves; o++ ) {
+				__m128 dx, dy, dz;
+				dnoise4( mPerms, x, y, z, &dx, &dy, &dz );
+				rx = _mm_add_ps( rx, _mm_mul_ps( dx, _mm_set1_ps( amp ) ) ); ry = _mm_add_ps( ry, _mm_mul_ps( dy, _mm_set1_ps( amp ) ) ); rz = _mm_add_ps( rz, _mm_mul_ps( dz, _mm_set1_ps( amp ) ) );
+				x = _mm_mul_ps( x, _mm_set1_ps( 2.0f ) ); y = _mm_mul_ps( y, _mm_set1_ps( 2.0f ) ); z = _mm_mul_ps( z, _mm_set1_ps( 2.0f ) );
+				amp *= 0.5f;
+			}
+			float xs[4], ys[4], zs[4];
+			_mm_storeu_ps( xs, rx ); _mm_storeu_ps( ys, ry ); _mm_storeu_ps( zs, rz );
+			for( int l = 0; l < 4; ++l )
+				results[i + l] = Vec3f( xs[l], ys[l], zs[l] );
+		}
+	}
+#endif
+	for( ; i < end; ++i )
+		results[i] = dfBm( positions[i] );
+}
+
+void Perlin::fBmChannelBand( Channel32f *channel, const Vec2f &offset, const Vec2f &scale, const Area &band ) const
+{
+	const int32_t width = band.getWidth();
+	if( width <= 0 )
+		return;
+	std::vector<Vec2f> positions( width );
+	std::vector<float> values( width );
+	for( int32_t y = band.y1; y < band.y2; ++y ) {
+		for( int32_t x = 0; x < width; ++x )
+			positions[x] = Vec2f( offset.x + ( band.x1 + x ) * scale.x, offset.y + y * scale.y );
+		fBmBand2( &positions[0], &values[0], Area( 0, 0, 1, width ) );
+		float *dst = channel->getData( band.x1, y );
+		const uint8_t inc = channel->getIncrement();
+		for( int32_t x = 0; x < width; ++x, dst += inc )
+			*dst = values[x];
+	}
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 // noise
 float Perlin::noise( float x ) const
@@ -279,6 +611,145 @@ Vec3f Perlin::dnoise( float x, float y, float z ) const
 					dw * ( k3 + k6*u + k5*v + k7*u*v ) );
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// simplex
+// Adapted from Stefan Gustavson's "Simplex noise demystified", using the permutation table of noise()
+namespace {
+
+const float SIMPLEX_GRAD3[12][3] = { { 1, 1, 0 }, { -1, 1, 0 }, { 1, -1, 0 }, { -1, -1, 0 }, { 1, 0, 1 }, { -1, 0, 1 }, { 1, 0, -1 }, { -1, 0, -1 }, { 0, 1, 1 }, { 0, -1, 1 }, { 0, 1, -1 }, { 0, -1, -1 } };
+const float SIMPLEX_GRAD4[32][4] = { { 0, 1, 1, 1 }, { 0, 1, 1, -1 }, { 0, 1, -1, 1 }, { 0, 1, -1, -1 }, { 0, -1, 1, 1 }, { 0, -1, 1, -1 }, { 0, -1, -1, 1 }, { 0, -1, -1, -1 },
+									{ 1, 0, 1, 1 }, { 1, 0, 1, -1 }, { 1, 0, -1, 1 }, { 1, 0, -1, -1 }, { -1, 0, 1, 1 }, { -1, 0, 1, -1 }, { -1, 0, -1, 1 }, { -1, 0, -1, -1 },
+									{ 1, 1, 0, 1 }, { 1, 1, 0, -1 }, { 1, -1, 0, 1 }, { 1, -1, 0, -1 }, { -1, 1, 0, 1 }, { -1, 1, 0, -1 }, { -1, -1, 0, 1 }, { -1, -1, 0, -1 },
+									{ 1, 1, 1, 0 }, { 1, 1, -1, 0 }, { 1, -1, 1, 0 }, { 1, -1, -1, 0 }, { -1, 1, 1, 0 }, { -1, 1, -1, 0 }, { -1, -1, 1, 0 }, { -1, -1, -1, 0 } };
+
+// contribution of a simplex corner with squared falloff radius \a r2
+inline float simplexCorner( float r2, const float *g, float x, float y )
+{
+	float t = r2 - x * x - y * y;
+	if( t < 0 )
+		return 0;
+	t *= t;
+	return t * t * ( g[0] * x + g[1] * y );
+}
+
+inline float simplexCorner( float r2, const float *g, float x, float y, float z )
+{
+	float t = r2 - x * x - y * y - z * z;
+	if( t < 0 )
+		return 0;
+	t *= t;
+	return t * t * ( g[0] * x + g[1] * y + g[2] * z );
+}
+
+inline float simplexCorner( float r2, const float *g, float x, float y, float z, float w )
+{
+	float t = r2 - x * x - y * y - z * z - w * w;
+	if( t < 0 )
+		return 0;
+	t *= t;
+	return t * t * ( g[0] * x + g[1] * y + g[2] * z + g[3] * w );
+}
+
+inline int32_t fastFloor( float x ) { return (int32_t)floorf( x ); }
+
+} // anonymous namespace
+
+float Perlin::simplex( float x, float y ) const
+{
+	static const float F2 = 0.5f * ( math<float>::sqrt( 3.0f ) - 1.0f ), G2 = ( 3.0f - math<float>::sqrt( 3.0f ) ) / 6.0f;
+
+	// skew to find the containing simplex cell, then unskew back to find the distance from its origin
+	const float s = ( x + y ) * F2;
+	const int32_t i = fastFloor( x + s ), j = fastFloor( y + s );
+	const float t = ( i + j ) * G2;
+	const float x0 = x - ( i - t ), y0 = y - ( j - t );
+
+	// lower or upper triangle
+	const int32_t i1 = ( x0 > y0 ) ? 1 : 0, j1 = 1 - i1;
+
+	const float x1 = x0 - i1 + G2, y1 = y0 - j1 + G2;
+	const float x2 = x0 - 1 + 2 * G2, y2 = y0 - 1 + 2 * G2;
+
+	const int32_t ii = i & 255, jj = j & 255;
+	const float n0 = simplexCorner( 0.5f, SIMPLEX_GRAD3[mPerms[ii + mPerms[jj]] % 12], x0, y0 );
+	const float n1 = simplexCorner( 0.5f, SIMPLEX_GRAD3[mPerms[ii + i1 + mPerms[jj + j1]] % 12], x1, y1 );
+	const float n2 = simplexCorner( 0.5f, SIMPLEX_GRAD3[mPerms[ii + 1 + mPerms[jj + 1]] % 12], x2, y2 );
+
+	return 70 * ( n0 + n1 + n2 );
+}
+
+float Perlin::simplex( float x, float y, float z ) const
+{
+	const float F3 = 1.0f / 3.0f, G3 = 1.0f / 6.0f;
+
+	const float s = ( x + y + z ) * F3;
+	const int32_t i = fastFloor( x + s ), j = fastFloor( y + s ), k = fastFloor( z + s );
+	const float t = ( i + j + k ) * G3;
+	const float x0 = x - ( i - t ), y0 = y - ( j - t ), z0 = z - ( k - t );
+
+	// which of the 6 tetrahedra of the cell contains the point
+	int32_t i1, j1, k1, i2, j2, k2;
+	if( x0 >= y0 ) {
+		if( y0 >= z0 )		{ i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+		else if( x0 >= z0 )	{ i1 = 1; j1 = 0; k1 = 0; i2 = 1; j2 = 0; k2 = 1; }
+		else				{ i1 = 0; j1 = 0; k1 = 1; i2 = 1; j2 = 0; k2 = 1; }
+	}
+	else {
+		if( y0 < z0 )		{ i1 = 0; j1 = 0; k1 = 1; i2 = 0; j2 = 1; k2 = 1; }
+		else if( x0 < z0 )	{ i1 = 0; j1 = 1; k1 = 0; i2 = 0; j2 = 1; k2 = 1; }
+		else				{ i1 = 0; j1 = 1; k1 = 0; i2 = 1; j2 = 1; k2 = 0; }
+	}
+
+	const float x1 = x0 - i1 + G3, y1 = y0 - j1 + G3, z1 = z0 - k1 + G3;
+	const float x2 = x0 - i2 + 2 * G3, y2 = y0 - j2 + 2 * G3, z2 = z0 - k2 + 2 * G3;
+	const float x3 = x0 - 1 + 3 * G3, y3 = y0 - 1 + 3 * G3, z3 = z0 - 1 + 3 * G3;
+
+	const int32_t ii = i & 255, jj = j & 255, kk = k & 255;
+	const float n0 = simplexCorner( 0.6f, SIMPLEX_GRAD3[mPerms[ii + mPerms[jj + mPerms[kk]]] % 12], x0, y0, z0 );
+	const float n1 = simplexCorner( 0.6f, SIMPLEX_GRAD3[mPerms[ii + i1 + mPerms[jj + j1 + mPerms[kk + k1]]] % 12], x1, y1, z1 );
+	const float n2 = simplexCorner( 0.6f, SIMPLEX_GRAD3[mPerms[ii + i2 + mPerms[jj + j2 + mPerms[kk + k2]]] % 12], x2, y2, z2 );
+	const float n3 = simplexCorner( 0.6f, SIMPLEX_GRAD3[mPerms[ii + 1 + mPerms[jj + 1 + mPerms[kk + 1]]] % 12], x3, y3, z3 );
+
+	return 32 * ( n0 + n1 + n2 + n3 );
+}
+
+float Perlin::simplex( float x, float y, float z, float w ) const
+{
+	static const float F4 = ( math<float>::sqrt( 5.0f ) - 1.0f ) / 4.0f, G4 = ( 5.0f - math<float>::sqrt( 5.0f ) ) / 20.0f;
+
+	const float s = ( x + y + z + w ) * F4;
+	const int32_t i = fastFloor( x + s ), j = fastFloor( y + s ), k = fastFloor( z + s ), l = fastFloor( w + s );
+	const float t = ( i + j + k + l ) * G4;
+	const float x0 = x - ( i - t ), y0 = y - ( j - t ), z0 = z - ( k - t ), w0 = w - ( l - t );
+
+	// rank the coordinates to find which of the 24 simplices of the cell contains the point
+	int32_t rankX = 0, rankY = 0, rankZ = 0, rankW = 0;
+	if( x0 > y0 ) rankX++; else rankY++;
+	if( x0 > z0 ) rankX++; else rankZ++;
+	if( x0 > w0 ) rankX++; else rankW++;
+	if( y0 > z0 ) rankY++; else rankZ++;
+	if( y0 > w0 ) rankY++; else rankW++;
+	if( z0 > w0 ) rankZ++; else rankW++;
+
+	const int32_t i1 = rankX >= 3, j1 = rankY >= 3, k1 = rankZ >= 3, l1 = rankW >= 3;
+	const int32_t i2 = rankX >= 2, j2 = rankY >= 2, k2 = rankZ >= 2, l2 = rankW >= 2;
+	const int32_t i3 = rankX >= 1, j3 = rankY >= 1, k3 = rankZ >= 1, l3 = rankW >= 1;
+
+	const float x1 = x0 - i1 + G4, y1 = y0 - j1 + G4, z1 = z0 - k1 + G4, w1 = w0 - l1 + G4;
+	const float x2 = x0 - i2 + 2 * G4, y2 = y0 - j2 + 2 * G4, z2 = z0 - k2 + 2 * G4, w2 = w0 - l2 + 2 * G4;
+	const float x3 = x0 - i3 + 3 * G4, y3 = y0 - j3 + 3 * G4, z3 = z0 - k3 + 3 * G4, w3 = w0 - l3 + 3 * G4;
+	const float x4 = x0 - 1 + 4 * G4, y4 = y0 - 1 + 4 * G4, z4 = z0 - 1 + 4 * G4, w4 = w0 - 1 + 4 * G4;
+
+	const int32_t ii = i & 255, jj = j & 255, kk = k & 255, ll = l & 255;
+	const float n0 = simplexCorner( 0.6f, SIMPLEX_GRAD4[mPerms[ii + mPerms[jj + mPerms[kk + mPerms[ll]]]] % 32], x0, y0, z0, w0 );
+	const float n1 = simplexCorner( 0.6f, SIMPLEX_GRAD4[mPerms[ii + i1 + mPerms[jj + j1 + mPerms[kk + k1 + mPerms[ll + l1]]]] % 32], x1, y1, z1, w1 );
+	const float n2 = simplexCorner( 0.6f, SIMPLEX_GRAD4[mPerms[ii + i2 + mPerms[jj + j2 + mPerms[kk + k2 + mPerms[ll + l2]]]] % 32], x2, y2, z2, w2 );
+	const float n3 = simplexCorner( 0.6f, SIMPLEX_GRAD4[mPerms[ii + i3 + mPerms[jj + j3 + mPerms[kk + k3 + mPerms[ll + l3]]]] % 32], x3, y3, z3, w3 );
+	const float n4 = simplexCorner( 0.6f, SIMPLEX_GRAD4[mPerms[ii + 1 + mPerms[jj + 1 + mPerms[kk + 1 + mPerms[ll + 1]]]] % 32], x4, y4, z4, w4 );
+
+	return 27 * ( n0 + n1 + n2 + n3 + n4 );
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////
 // grad
 
@@ -21,6 +21,13 @@
 */
 
 #include "cinder/PolyLine.h"
+#include "cinder/Shape2d.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <queue>
+#include <set>
 
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point_xy.hpp>
@@ -230,6 +237,625 @@ std::vector<PolyLine<T> > PolyLine<T>::calcDifference( const std::vector<PolyLin
 	return convertBoostGeometryPolygons<T>( output );
 }
 
+namespace {
+// Sweep-line boolean operations after Martinez, Ogayar, Jimenez & Rueda, "A simple algorithm for Boolean operations on polygons" (2013).
+// Each polygon is interpreted with the even-odd rule, so holes need no particular orientation.
+enum SweepOp { SWEEP_UNION, SWEEP_INTERSECTION, SWEEP_XOR, SWEEP_DIFFERENCE }; // in the order of PolyLine::BooleanOp
+enum SweepEdgeType { EDGE_NORMAL, EDGE_NON_CONTRIBUTING, EDGE_SAME_TRANSITION, EDGE_DIFFERENT_TRANSITION };
+
+inline double signedArea( const Vec2d &p0, const Vec2d &p1, const Vec2d &p2 )
+{
+	return ( p0.x - p2.x ) * ( p1.y - p2.y ) - ( p1.x - p2.x ) * ( p0.y - p2.y );
+}
+
+struct SweepEvent;
+
+// Orders the segments crossing the sweep line from bottom to top
+struct SegmentLess {
+	bool operator()( const SweepEvent *e1, const SweepEvent *e2 ) const;
+};
+
+typedef std::set<SweepEvent*, SegmentLess> SweepLine;
+
+struct SweepEvent {
+	SweepEvent( const Vec2d &point, bool left, int polygon, SweepEvent *other )
+		: mPoint( point ), mLeft( left ), mPolygon( polygon ), mOther( other ), mType( EDGE_NORMAL ), mInOut( false ), mOtherInOut( false ),
+		mInResult( false ), mPrevInResult( 0 ), mLoop( std::numeric_limits<size_t>::max() )
+	{}
+
+	//! Returns whether the segment lies below \a p
+	bool	below( const Vec2d &p ) const { return mLeft ? signedArea( mPoint, mOther->mPoint, p ) > 0 : signedArea( mOther->mPoint, mPoint, p ) > 0; }
+	bool	above( const Vec2d &p ) const { return ! below( p ); }
+	bool	vertical() const { return mPoint.x == mOther->mPoint.x; }
+
+	Vec2d				mPoint;
+	bool				mLeft;
+	int					mPolygon;
+	SweepEvent			*mOther;
+	SweepEdgeType		mType;
+	bool				mInOut;			// whether the segment is an inside-outside transition of its own polygon, moving upward
+	bool				mOtherInOut;	// the same for the closest segment of the other polygon below
+	bool				mInResult;
+	SweepEvent			*mPrevInResult;	// closest segment below that is in the result
+	size_t				mLoop;			// the result loop this segment was chained into
+	SweepLine::iterator	mPosSL;
+};
+
+// Returns true if \a e1 is processed after \a e2
+struct EventLater {
+	bool operator()( const SweepEvent *e1, const SweepEvent *e2 ) const
+	{
+		if( e1->mPoint.x != e2->mPoint.x )
+			return e1->mPoint.x > e2->mPoint.x;
+		if( e1->mPoint.y != e2->mPoint.y )
+			return e1->mPoint.y > e2->mPoint.y;
+		if( e1->mLeft != e2->mLeft ) // right endpoints first
+			return e1->mLeft;
+		if( signedArea( e1->mPoint, e1->mOther->mPoint, e2->mOther->mPoint ) != 0 ) // lower segment first
+			return e1->above( e2->mOther->mPoint );
+		return e1->mPolygon > e2->mPolygon;
+	}
+};
+
+struct EventEarlier {
+	bool operator()( const SweepEvent *e1, const SweepEvent *e2 ) const { return EventLater()( e2, e1 ); }
+};
+
+bool SegmentLess::operator()( const SweepEvent *e1, const SweepEvent *e2 ) const
+{
+	if( e1 == e2 )
+		return false;
+	if( signedArea( e1->mPoint, e1->mOther->mPoint, e2->mPoint ) != 0 || signedArea( e1->mPoint, e1->mOther->mPoint, e2->mOther->mPoint ) != 0 ) {
+		if( e1->mPoint == e2->mPoint )
+			return e1->below( e2->mOther->mPoint );
+		if( e1->mPoint.x == e2->mPoint.x )
+			return e1->mPoint.y < e2->mPoint.y;
+		// compare the later segment's left endpoint against the earlier segment, falling back to its right endpoint when it lies on it
+		if( EventLater()( e1, e2 ) ) {
+			double side = signedArea( e2->mPoint, e2->mOther->mPoint, e1->mPoint );
+			if( side == 0 )
+				side = signedArea( e2->mPoint, e2->mOther->mPoint, e1->mOther->mPoint );
+			return side <= 0;
+		}
+		double side = signedArea( e1->mPoint, e1->mOther->mPoint, e2->mPoint );
+		if( side == 0 )
+			side = signedArea( e1->mPoint, e1->mOther->mPoint, e2->mOther->mPoint );
+		return side > 0;
+	}
+	// collinear; any consistent order will do
+	if( e1->mPolygon != e2->mPolygon )
+		return e1->mPolygon < e2->mPolygon;
+	if( e1->mPoint == e2->mPoint )
+		return e1 < e2;
+	return EventLater()( e1, e2 );
+}
+
+int findIntervalIntersection( double u0, double u1, double v0, double v1, double w[2] )
+{
+	if( u1 < v0 || u0 > v1 )
+		return 0;
+	if( u1 > v0 ) {
+		if( u0 < v1 ) {
+			w[0] = ( u0 < v0 ) ? v0 : u0;
+			w[1] = ( u1 > v1 ) ? v1 : u1;
+			return 2;
+		}
+		w[0] = u0;
+		return 1;
+	}
+	w[0] = u1;
+	return 1;
+}
+
+// Snaps \a p to an endpoint of either segment if it is within rounding distance of it
+Vec2d snapIntersection( const Vec2d &p, const Vec2d &a0, const Vec2d &a1, const Vec2d &b0, const Vec2d &b1 )
+{
+	const double kSnapDistanceSquared = 1e-20 * std::max( a0.distanceSquared( a1 ), b0.distanceSquared( b1 ) );
+	const Vec2d *endpoints[4] = { &a0, &a1, &b0, &b1 };
+	Vec2d result = p;
+	for( int i = 0; i < 4; ++i )
+		if( p.distanceSquared( *endpoints[i] ) < kSnapDistanceSquared )
+			result = *endpoints[i];
+	return result;
+}
+
+// Returns the number of intersections (0, 1 or 2 for overlapping segments) between segments a0-a1 and b0-b1
+int findSegmentIntersection( const Vec2d &a0, const Vec2d &a1, const Vec2d &b0, const Vec2d &b1, Vec2d *i0, Vec2d *i1 )
+{
+	const double kSqrEpsilon = 1e-7;
+	Vec2d d0 = a1 - a0, d1 = b1 - b0, e = b0 - a0;
+	double kross = d0.x * d1.y - d0.y * d1.x;
+	double sqrLen0 = d0.lengthSquared(), sqrLen1 = d1.lengthSquared();
+
+	if( kross * kross > kSqrEpsilon * sqrLen0 * sqrLen1 ) {
+		// not parallel
+		double s = ( e.x * d1.y - e.y * d1.x ) / kross;
+		if( s < 0 || s > 1 )
+			return 0;
+		double t = ( e.x * d0.y - e.y * d0.x ) / kross;
+		if( t < 0 || t > 1 )
+			return 0;
+		*i0 = snapIntersection( a0 + d0 * s, a0, a1, b0, b1 );
+		return 1;
+	}
+
+	// parallel; check whether the lines coincide
+	kross = e.x * d0.y - e.y * d0.x;
+	if( kross * kross > kSqrEpsilon * sqrLen0 * e.lengthSquared() )
+		return 0;
+
+	double s0 = d0.dot( e ) / sqrLen0, s1 = s0 + d0.dot( d1 ) / sqrLen0;
+	double w[2];
+	int result = findIntervalIntersection( 0, 1, std::min( s0, s1 ), std::max( s0, s1 ), w );
+	if( result > 0 )
+		*i0 = snapIntersection( a0 + d0 * w[0], a0, a1, b0, b1 );
+	if( result > 1 )
+		*i1 = snapIntersection( a0 + d0 * w[1], a0, a1, b0, b1 );
+	return result;
+}
+
+class BooleanSweep {
+  public:
+	BooleanSweep( SweepOp op )
+		: mOp( op )
+	{
+		mMaxX[0] = mMaxX[1] = -std::numeric_limits<double>::max();
+	}
+
+	//! Adds the contours of \a polyLines as \a polygon 0 (the subject) or 1 (the clipping polygon)
+	template<typename T>
+	void addPolygon( const std::vector<PolyLine<T> > &polyLines, int polygon )
+	{
+		std::vector<Vec2d> pts;
+		for( typename std::vector<PolyLine<T> >::const_iterator plIt = polyLines.begin(); plIt != polyLines.end(); ++plIt ) {
+			pts.clear();
+			for( typename std::vector<T>::const_iterator ptIt = plIt->begin(); ptIt != plIt->end(); ++ptIt )
+				addContourPoint( Vec2d( ptIt->x, ptIt->y ), &pts );
+			closeContour( &pts );
+			if( pts.size() < 3 )
+				continue;
+			for( size_t p = 0, prev = pts.size() - 1; p < pts.size(); prev = p++ )
+				addSegment( pts[prev], pts[p], polygon );
+		}
+	}
+
+	//! Runs the sweep, returning each outer contour (with a positive signed area) followed by its holes (with a negative signed area)
+	void run( std::vector<std::vector<Vec2d> > *result )
+	{
+		// past this point no more segments can be in the result
+		double maxX = std::numeric_limits<double>::max();
+		if( mOp == SWEEP_INTERSECTION )
+			maxX = std::min( mMaxX[0], mMaxX[1] );
+		else if( mOp == SWEEP_DIFFERENCE )
+			maxX = mMaxX[0];
+
+		// the input's events are sorted up front; only those created by dividing segments go through the heap
+		std::stable_sort( mInputEvents.begin(), mInputEvents.end(), EventEarlier() );
+		mNextInputEvent = 0;
+
+		SweepEvent *e;
+		while( ( e = popEvent() ) && e->mPoint.x <= maxX ) {
+			mSorted.push_back( e );
+
+			if( e->mLeft ) {
+				SweepLine::iterator it = e->mPosSL = mSweepLine.insert( e ).first;
+				SweepLine::iterator prev = it, next = it;
+				prev = ( it == mSweepLine.begin() ) ? mSweepLine.end() : --prev;
+				computeFields( e, prev );
+				if( ++next != mSweepLine.end() && possibleIntersection( e, *next ) == 2 ) {
+					computeFields( e, prev );
+					computeFields( *next, it );
+				}
+				if( prev != mSweepLine.end() && possibleIntersection( *prev, e ) == 2 ) {
+					SweepLine::iterator prevPrev = prev;
+					prevPrev = ( prev == mSweepLine.begin() ) ? mSweepLine.end() : --prevPrev;
+					computeFields( *prev, prevPrev );
+					computeFields( e, prev );
+				}
+				// a neighbor divided right at this point now has events that belong before this one; handle those first
+				if( ! mQueue.empty() && EventLater()( e, mQueue.top() ) ) {
+					mSweepLine.erase( it );
+					mSorted.pop_back();
+					mQueue.push( e );
+				}
+			}
+			else {
+				SweepLine::iterator it = e->mOther->mPosSL, prev = it, next = it;
+				prev = ( it == mSweepLine.begin() ) ? mSweepLine.end() : --prev;
+				++next;
+				mSweepLine.erase( it );
+				if( prev != mSweepLine.end() && next != mSweepLine.end() )
+					possibleIntersection( *prev, *next );
+			}
+		}
+
+		connectEdges( result );
+	}
+
+  private:
+	struct Edge {
+		Vec2d		mFrom, mTo;
+		SweepEvent	*mEvent;
+	};
+
+	struct Loop {
+		size_t				mBegin, mEnd;	// range of mLoopPoints
+		size_t				mFirstEdge, mParent;
+		bool				mOuter, mEmpty;
+	};
+
+	struct OutgoingLess {
+		bool operator()( const std::pair<Vec2d, size_t> &a, const std::pair<Vec2d, size_t> &b ) const
+		{
+			if( a.first.x != b.first.x )
+				return a.first.x < b.first.x;
+			if( a.first.y != b.first.y )
+				return a.first.y < b.first.y;
+			return a.second < b.second;
+		}
+	};
+
+	// Returns the next event in sweep order, or NULL once there are none left
+	SweepEvent* popEvent()
+	{
+		bool input = mNextInputEvent < mInputEvents.size();
+		if( input && ( mQueue.empty() || ! EventLater()( mInputEvents[mNextInputEvent], mQueue.top() ) ) )
+			return mInputEvents[mNextInputEvent++];
+		if( mQueue.empty() )
+			return 0;
+		SweepEvent *result = mQueue.top();
+		mQueue.pop();
+		return result;
+	}
+
+	SweepEvent* newEvent( const Vec2d &point, bool left, int polygon, SweepEvent *other )
+	{
+		mEvents.push_back( SweepEvent( point, left, polygon, other ) );
+		return &mEvents.back();
+	}
+
+	// Returns whether \a b is the tip of a zero-width spike from \a a to \a c
+	static bool isSpike( const Vec2d &a, const Vec2d &b, const Vec2d &c )
+	{
+		return signedArea( a, b, c ) == 0 && ( b - a ).dot( c - b ) <= 0;
+	}
+
+	// Appends \a p to \a pts, dropping repeated points and zero-width spikes, which would otherwise overlap edges of the same contour
+	static void addContourPoint( const Vec2d &p, std::vector<Vec2d> *pts )
+	{
+		while( pts->size() >= 2 && isSpike( (*pts)[pts->size()-2], pts->back(), p ) )
+			pts->pop_back();
+		if( pts->empty() || pts->back() != p )
+			pts->push_back( p );
+	}
+
+	// Removes the repeated points and spikes left where the end of \a pts wraps around to its start
+	static void closeContour( std::vector<Vec2d> *pts )
+	{
+		size_t first = 0;
+		while( pts->size() - first >= 3 ) {
+			size_t last = pts->size() - 1;
+			if( (*pts)[last] == (*pts)[first] || isSpike( (*pts)[last-1], (*pts)[last], (*pts)[first] ) )
+				pts->pop_back();
+			else if( isSpike( (*pts)[last], (*pts)[first], (*pts)[first+1] ) )
+				++first;
+			else
+				break;
+		}
+		pts->erase( pts->begin(), pts->begin() + first );
+	}
+
+	void addSegment( const Vec2d &a, const Vec2d &b, int polygon )
+	{
+		if( a == b )
+			return;
+		mMaxX[polygon] = std::max( mMaxX[polygon], std::max( a.x, b.x ) );
+
+		SweepEvent *e1 = newEvent( a, true, polygon, 0 );
+		SweepEvent *e2 = newEvent( b, true, polygon, e1 );
+		e1->mOther = e2;
+		if( a.x < b.x || ( a.x == b.x && a.y < b.y ) )
+			e2->mLeft = false;
+		else
+			e1->mLeft = false;
+		mInputEvents.push_back( e1 );
+		mInputEvents.push_back( e2 );
+	}
+
+	bool inResult( const SweepEvent *e ) const
+	{
+		switch( e->mType ) {
+			case EDGE_NORMAL:
+				switch( mOp ) {
+					case SWEEP_UNION: return e->mOtherInOut;
+					case SWEEP_INTERSECTION: return ! e->mOtherInOut;
+					case SWEEP_DIFFERENCE: return ( e->mPolygon == 0 ) == e->mOtherInOut;
+					default: return true;
+				}
+			case EDGE_SAME_TRANSITION: return mOp == SWEEP_UNION || mOp == SWEEP_INTERSECTION;
+			case EDGE_DIFFERENT_TRANSITION: return mOp == SWEEP_DIFFERENCE;
+			default: return false;
+		}
+	}
+
+	void computeFields( SweepEvent *e, SweepLine::iterator prev )
+	{
+		if( prev == mSweepLine.end() ) {
+			e->mInOut = false;
+			e->mOtherInOut = true;
+			e->mPrevInResult = 0;
+		}
+		else {
+			SweepEvent *p = *prev;
+			if( e->mPolygon == p->mPolygon ) {
+				e->mInOut = ! p->mInOut;
+				e->mOtherInOut = p->mOtherInOut;
+			}
+			else {
+				e->mInOut = ! p->mOtherInOut;
+				e->mOtherInOut = p->vertical() ? ! p->mInOut : p->mInOut;
+			}
+			e->mPrevInResult = ( ! inResult( p ) || p->vertical() ) ? p->mPrevInResult : p;
+		}
+		e->mInResult = inResult( e );
+	}
+
+	// Splits the segment of left event \a e at \a p
+	void divideSegment( SweepEvent *e, const Vec2d &p )
+	{
+		SweepEvent *right = newEvent( p, false, e->mPolygon, e );
+		SweepEvent *left = newEvent( p, true, e->mPolygon, e->mOther );
+		if( EventLater()( left, e->mOther ) ) { // rounding put the new left endpoint past the right one
+			e->mOther->mLeft = true;
+			left->mLeft = false;
+		}
+		e->mOther->mOther = left;
+		e->mOther = right;
+		mQueue.push( left );
+		mQueue.push( right );
+	}
+
+	// Splits the segments of \a e1 and \a e2 where they intersect; returns 2 if they overlap sharing their left endpoint
+	int possibleIntersection( SweepEvent *e1, SweepEvent *e2 )
+	{
+		Vec2d i0, i1;
+		int numIntersections = findSegmentIntersection( e1->mPoint, e1->mOther->mPoint, e2->mPoint, e2->mOther->mPoint, &i0, &i1 );
+		if( numIntersections == 0 )
+			return 0;
+		if( numIntersections == 1 && ( e1->mPoint == e2->mPoint || e1->mOther->mPoint == e2->mOther->mPoint ) )
+			return 0; // intersecting at a shared endpoint
+
+		if( numIntersections == 1 ) {
+			if( e1->mPoint != i0 && e1->mOther->mPoint != i0 )
+				divideSegment( e1, i0 );
+			if( e2->mPoint != i0 && e2->mOther->mPoint != i0 )
+				divideSegment( e2, i0 );
+			return 1;
+		}
+
+		// overlapping segments; sort their four endpoints, with NULL standing in for a shared one
+		std::vector<SweepEvent*> sorted;
+		if( e1->mPoint == e2->mPoint )
+			sorted.push_back( 0 );
+		else if( EventLater()( e1, e2 ) ) {
+			sorted.push_back( e2 );
+			sorted.push_back( e1 );
+		}
+		else {
+			sorted.push_back( e1 );
+			sorted.push_back( e2 );
+		}
+		if( e1->mOther->mPoint == e2->mOther->mPoint )
+			sorted.push_back( 0 );
+		else if( EventLater()( e1->mOther, e2->mOther ) ) {
+			sorted.push_back( e2->mOther );
+			sorted.push_back( e1->mOther );
+		}
+		else {
+			sorted.push_back( e1->mOther );
+			sorted.push_back( e2->mOther );
+		}
+
+		if( sorted.size() == 2 || ( sorted.size() == 3 && sorted[2] ) ) {
+			// equal segments, or sharing the left endpoint; within one polygon the two cancel out under the even-odd rule
+			e1->mType = EDGE_NON_CONTRIBUTING;
+			if( e1->mPolygon == e2->mPolygon )
+				e2->mType = EDGE_NON_CONTRIBUTING;
+			else
+				e2->mType = ( e1->mInOut == e2->mInOut ) ? EDGE_SAME_TRANSITION : EDGE_DIFFERENT_TRANSITION;
+			if( sorted.size() == 3 )
+				divideSegment( sorted[2]->mOther, sorted[1]->mPoint );
+			return 2;
+		}
+		if( sorted.size() == 3 ) { // sharing the right endpoint
+			divideSegment( sorted[0], sorted[1]->mPoint );
+			return 3;
+		}
+		if( sorted[0] != sorted[3]->mOther ) { // partial overlap
+			divideSegment( sorted[0], sorted[1]->mPoint );
+			divideSegment( sorted[1], sorted[2]->mPoint );
+			return 3;
+		}
+		// one segment contains the other
+		divideSegment( sorted[0], sorted[1]->mPoint );
+		divideSegment( sorted[3]->mOther, sorted[2]->mPoint );
+		return 3;
+	}
+
+	// Returns whether the region just below the result segment of left event \a e is inside the result
+	bool resultBelow( const SweepEvent *e ) const
+	{
+		if( e->mType == EDGE_SAME_TRANSITION )
+			return e->mInOut;
+		if( e->mType == EDGE_DIFFERENT_TRANSITION )
+			return ( e->mPolygon == 0 ) == e->mInOut;
+
+		bool self = e->mInOut, other = ! e->mOtherInOut;
+		bool subject = ( e->mPolygon == 0 ) ? self : other;
+		bool clipping = ( e->mPolygon == 0 ) ? other : self;
+		switch( mOp ) {
+			case SWEEP_UNION: return subject || clipping;
+			case SWEEP_INTERSECTION: return subject && clipping;
+			case SWEEP_DIFFERENCE: return subject && ! clipping;
+			default: return subject != clipping;
+		}
+	}
+
+	// Returns the unused edge leaving the end of \a edge that turns most tightly around the result, or \a start to close the loop
+	size_t nextEdge( size_t edge, size_t start, const std::vector<bool> &used ) const
+	{
+		const Vec2d &v = mEdges[edge].mTo;
+		Vec2d back = mEdges[edge].mFrom - v;
+		std::vector<std::pair<Vec2d, size_t> >::const_iterator it = std::lower_bound( mOutgoing.begin(), mOutgoing.end(), std::make_pair( v, (size_t)0 ), OutgoingLess() );
+
+		size_t result = std::numeric_limits<size_t>::max();
+		double resultAngle = std::numeric_limits<double>::max();
+		for( ; it != mOutgoing.end() && it->first == v; ++it ) {
+			if( used[it->second] && it->second != start )
+				continue;
+			// clockwise angle from the incoming edge, reversed
+			Vec2d dir = mEdges[it->second].mTo - v;
+			double angle = math<double>::atan2( dir.x * back.y - dir.y * back.x, dir.dot( back ) );
+			if( angle <= 0 )
+				angle += 2 * M_PI;
+			if( angle < resultAngle ) {
+				result = it->second;
+				resultAngle = angle;
+			}
+		}
+		return result;
+	}
+
+	// Chains the result segments into loops with the result on their left, and groups the holes after their outer contours
+	void connectEdges( std::vector<std::vector<Vec2d> > *result )
+	{
+		std::vector<SweepEvent*> events;
+		for( std::vector<SweepEvent*>::const_iterator eIt = mSorted.begin(); eIt != mSorted.end(); ++eIt )
+			if( (*eIt)->mLeft && (*eIt)->mInResult )
+				events.push_back( *eIt );
+		// segments divided by overlaps can leave the events slightly out of order
+		std::stable_sort( events.begin(), events.end(), EventEarlier() );
+
+		mEdges.resize( events.size() );
+		mOutgoing.resize( events.size() );
+		for( size_t e = 0; e < events.size(); ++e ) {
+			bool reverse = resultBelow( events[e] );
+			mEdges[e].mFrom = reverse ? events[e]->mOther->mPoint : events[e]->mPoint;
+			mEdges[e].mTo = reverse ? events[e]->mPoint : events[e]->mOther->mPoint;
+			mEdges[e].mEvent = events[e];
+			mOutgoing[e] = std::make_pair( mEdges[e].mFrom, e );
+		}
+		std::sort( mOutgoing.begin(), mOutgoing.end(), OutgoingLess() );
+
+		// since loops are started in sweep order, each one starts at its lowest leftmost edge
+		std::vector<Loop> loops;
+		std::vector<bool> used( mEdges.size(), false );
+		for( size_t start = 0; start < mEdges.size(); ++start ) {
+			if( used[start] )
+				continue;
+			loops.push_back( Loop() );
+			Loop &loop = loops.back();
+			loop.mFirstEdge = start;
+			loop.mBegin = mLoopPoints.size();
+			size_t edge = start;
+			do {
+				used[edge] = true;
+				mEdges[edge].mEvent->mLoop = loops.size() - 1;
+				mLoopPoints.push_back( mEdges[edge].mFrom );
+				edge = nextEdge( edge, start, used );
+			} while( edge != start && edge < mEdges.size() );
+
+			double area = 0;
+			loop.mEnd = mLoopPoints.size();
+			for( size_t p = loop.mBegin, prev = loop.mEnd - 1; p < loop.mEnd; prev = p++ )
+				area += mLoopPoints[prev].x * mLoopPoints[p].y - mLoopPoints[p].x * mLoopPoints[prev].y;
+			loop.mOuter = area > 0;
+			loop.mEmpty = loop.mEnd - loop.mBegin < 3 || area == 0;
+			loop.mParent = std::numeric_limits<size_t>::max();
+		}
+
+		// a hole belongs to the outer contour of the closest result segment below its first edge
+		std::vector<std::vector<size_t> > holes( loops.size() + 1 );
+		for( size_t l = 0; l < loops.size(); ++l ) {
+			if( loops[l].mOuter || loops[l].mEmpty )
+				continue;
+			const SweepEvent *below = mEdges[loops[l].mFirstEdge].mEvent->mPrevInResult;
+			if( below && below->mLoop < l )
+				loops[l].mParent = loops[below->mLoop].mOuter ? below->mLoop : loops[below->mLoop].mParent;
+			holes[std::min( loops[l].mParent, loops.size() )].push_back( l );
+		}
+
+		for( size_t l = 0; l <= loops.size(); ++l ) {
+			if( l < loops.size() ) {
+				if( ! loops[l].mOuter || loops[l].mEmpty )
+					continue;
+				result->push_back( std::vector<Vec2d>( mLoopPoints.begin() + loops[l].mBegin, mLoopPoints.begin() + loops[l].mEnd ) );
+			}
+			for( std::vector<size_t>::const_iterator hIt = holes[l].begin(); hIt != holes[l].end(); ++hIt )
+				result->push_back( std::vector<Vec2d>( mLoopPoints.begin() + loops[*hIt].mBegin, mLoopPoints.begin() + loops[*hIt].mEnd ) );
+		}
+	}
+
+	SweepOp						mOp;
+	double						mMaxX[2];
+	std::deque<SweepEvent>		mEvents;
+	std::vector<SweepEvent*>	mInputEvents;
+	size_t						mNextInputEvent;
+	std::priority_queue<SweepEvent*, std::vector<SweepEvent*>, EventLater>	mQueue;
+	SweepLine					mSweepLine;
+	std::vector<SweepEvent*>	mSorted;
+	std::vector<Edge>			mEdges;
+	std::vector<std::pair<Vec2d, size_t> >	mOutgoing;
+	std::vector<Vec2d>			mLoopPoints;
+};
+
+template<typename T>
+void calcBooleanContours( SweepOp op, const std::vector<PolyLine<T> > &a, const std::vector<PolyLine<T> > &b, std::vector<std::vector<Vec2d> > *result )
+{
+	BooleanSweep sweep( op );
+	sweep.addPolygon( a, 0 );
+	sweep.addPolygon( b, 1 );
+	sweep.run( result );
+}
+} // anonymous namespace
+
+template<typename T>
+std::vector<PolyLine<T> > PolyLine<T>::calcBoolean( BooleanOp op, const std::vector<PolyLine<T> > &a, const std::vector<PolyLine<T> > &b )
+{
+	typedef typename T::TYPE R;
+
+	std::vector<std::vector<Vec2d> > contours;
+	calcBooleanContours( (SweepOp)op, a, b, &contours );
+
+	std::vector<PolyLine<T> > result( contours.size() );
+	for( size_t c = 0; c < contours.size(); ++c ) {
+		std::vector<T> &pts = result[c].getPoints();
+		pts.reserve( contours[c].size() );
+		for( std::vector<Vec2d>::const_iterator ptIt = contours[c].begin(); ptIt != contours[c].end(); ++ptIt )
+			pts.push_back( T( (R)ptIt->x, (R)ptIt->y ) );
+		result[c].setClosed();
+	}
+
+	return result;
+}
+
+template<typename T>
+Shape2d PolyLine<T>::calcBooleanShape( BooleanOp op, const std::vector<PolyLine<T> > &a, const std::vector<PolyLine<T> > &b )
+{
+	std::vector<std::vector<Vec2d> > contours;
+	calcBooleanContours( (SweepOp)op, a, b, &contours );
+
+	Shape2d result;
+	for( std::vector<std::vector<Vec2d> >::const_iterator cIt = contours.begin(); cIt != contours.end(); ++cIt ) {
+		result.moveTo( Vec2f( (*cIt)[0] ) );
+		for( size_t p = 1; p < cIt->size(); ++p )
+			result.lineTo( Vec2f( (*cIt)[p] ) );
+		result.close();
+	}
+
+	return result;
+}
+
 template class PolyLine<Vec2f>;
 template class PolyLine<Vec2d>;
 
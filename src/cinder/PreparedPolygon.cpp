@@ -0,0 +1,174 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/PreparedPolygon.h"
+
+#include <algorithm>
+
+namespace cinder {
+
+PreparedPolygon::PreparedPolygon( const PolyLine2f &polyLine, size_t numSlabs )
+{
+	std::vector<Vec2f> edges;
+	addContour( polyLine.getPoints(), &edges );
+	build( edges, numSlabs );
+}
+
+PreparedPolygon::PreparedPolygon( const std::vector<PolyLine2f> &contours, size_t numSlabs )
+{
+	std::vector<Vec2f> edges;
+	for( std::vector<PolyLine2f>::const_iterator contourIt = contours.begin(); contourIt != contours.end(); ++contourIt )
+		addContour( contourIt->getPoints(), &edges );
+	build( edges, numSlabs );
+}
+
+PreparedPolygon::PreparedPolygon( const Path2d &path, float approximationScale, size_t numSlabs )
+{
+	std::vector<Vec2f> edges;
+	// Path2d::contains() treats paths of two points or fewer as empty, regardless of their curves
+	if( path.getNumPoints() > 2 )
+		addContour( path.subdivide( approximationScale ), &edges );
+	build( edges, numSlabs );
+}
+
+PreparedPolygon::PreparedPolygon( const Shape2d &shape, float approximationScale, size_t numSlabs )
+{
+	std::vector<Vec2f> edges;
+	for( std::vector<Path2d>::const_iterator contourIt = shape.getContours().begin(); contourIt != shape.getContours().end(); ++contourIt )
+		if( contourIt->getNumPoints() > 2 )
+			addContour( contourIt->subdivide( approximationScale ), &edges );
+	build( edges, numSlabs );
+}
+
+void PreparedPolygon::addContour( const std::vector<Vec2f> &points, std::vector<Vec2f> *edges )
+{
+	if( points.size() <= 2 )
+		return;
+	
+	for( size_t p = 0; p < points.size() - 1; ++p ) {
+		edges->push_back( points[p] );
+		edges->push_back( points[p+1] );
+	}
+	edges->push_back( points.back() );
+	edges->push_back( points.front() );
+}
+
+size_t PreparedPolygon::slabIndex( float x ) const
+{
+	// monotonic in x, so an edge registered in the slabs of its endpoints covers every x between them
+	float slab = ( x - mBounds.x1 ) * mSlabScale;
+	if( ! ( slab > 0 ) )
+		return 0;
+	return std::min<size_t>( (size_t)slab, mNumSlabs - 1 );
+}
+
+void PreparedPolygon::build( const std::vector<Vec2f> &edges, size_t numSlabs )
+{
+	mNumEdges = edges.size() / 2;
+	mBounds = ( edges.empty() ) ? Rectf( 0, 0, 0, 0 ) : Rectf( edges );
+	mNumSlabs = ( numSlabs > 0 ) ? numSlabs : std::max<size_t>( 1, std::min<size_t>( mNumEdges / 4, 4096 ) );
+	mSlabScale = ( mBounds.getWidth() > 0 ) ? mNumSlabs / mBounds.getWidth() : 0;
+	
+	// count each slab's edges, padded to a multiple of 4, then fill them in
+	std::vector<uint32_t> slabCounts( mNumSlabs, 0 );
+	for( size_t e = 0; e < mNumEdges; ++e ) {
+		const Vec2f &p0 = edges[e*2], &p1 = edges[e*2+1];
+		if( p0.x == p1.x )
+			continue; // never crossed
+		size_t first = slabIndex( std::min( p0.x, p1.x ) ), last = slabIndex( std::max( p0.x, p1.x ) );
+		for( size_t s = first; s <= last; ++s )
+			++slabCounts[s];
+	}
+	
+	mSlabStarts.resize( mNumSlabs + 1 );
+	mSlabStarts[0] = 0;
+	for( size_t s = 0; s < mNumSlabs; ++s )
+		mSlabStarts[s+1] = mSlabStarts[s] + ( ( slabCounts[s] + 3 ) & ~3 );
+	
+	// padding edges have an empty x extent, so no point crosses them
+	size_t total = mSlabStarts[mNumSlabs];
+	mMinX.assign( total, 0 );
+	mMaxX.assign( total, 0 );
+	mX0.assign( total, 0 );
+	mY0.assign( total, 0 );
+	mDx.assign( total, 1 );
+	mDy.assign( total, 0 );
+	
+	std::vector<uint32_t> slabFill( mSlabStarts.begin(), mSlabStarts.end() - 1 );
+	for( size_t e = 0; e < mNumEdges; ++e ) {
+		const Vec2f &p0 = edges[e*2], &p1 = edges[e*2+1];
+		if( p0.x == p1.x )
+			continue;
+		size_t first = slabIndex( std::min( p0.x, p1.x ) ), last = slabIndex( std::max( p0.x, p1.x ) );
+		for( size_t s = first; s <= last; ++s ) {
+			uint32_t i = slabFill[s]++;
+			mMinX[i] = std::min( p0.x, p1.x );
+			mMaxX[i] = std::max( p0.x, p1.x );
+			mX0[i] = p0.x;
+			mY0[i] = p0.y;
+			mDx[i] = p1.x - p0.x;
+			mDy[i] = p1.y - p0.y;
+		}
+	}
+}
+
+bool PreparedPolygon::contains( const Vec2f &pt ) const
+{
+	if( mNumEdges == 0 || ! ( pt.x > mBounds.x1 && pt.x <= mBounds.x2 ) )
+		return false;
+	
+	size_t slab = slabIndex( pt.x );
+	uint32_t begin = mSlabStarts[slab], end = mSlabStarts[slab+1];
+	
+	// the same test as PolyLine2f::contains(): count the edges spanning pt.x which pass below pt
+#if defined( CINDER_SIMD_MATH_SSE )
+	const __m128 px = _mm_set1_ps( pt.x ), py = _mm_set1_ps( pt.y );
+	__m128 parity = _mm_setzero_ps();
+	for( uint32_t e = begin; e < end; e += 4 ) {
+		__m128 spans = _mm_and_ps( _mm_cmplt_ps( _mm_loadu_ps( &mMinX[e] ), px ), _mm_cmple_ps( px, _mm_loadu_ps( &mMaxX[e] ) ) );
+		__m128 yAtX = _mm_add_ps( _mm_loadu_ps( &mY0[e] ), _mm_div_ps( _mm_mul_ps( _mm_loadu_ps( &mDy[e] ), _mm_sub_ps( px, _mm_loadu_ps( &mX0[e] ) ) ), _mm_loadu_ps( &mDx[e] ) ) );
+		parity = _mm_xor_ps( parity, _mm_and_ps( spans, _mm_cmpgt_ps( py, yAtX ) ) );
+	}
+	int mask = _mm_movemask_ps( parity );
+	return ( ( mask ^ ( mask >> 1 ) ^ ( mask >> 2 ) ^ ( mask >> 3 ) ) & 1 ) == 1;
+#else
+	size_t crossings = 0;
+	for( uint32_t e = begin; e < end; ++e ) {
+		if( mMinX[e] < pt.x && pt.x <= mMaxX[e] ) {
+			if( pt.y > mY0[e] + mDy[e] * ( pt.x - mX0[e] ) / mDx[e] )
+				++crossings;
+		}
+	}
+	return ( crossings & 1 ) == 1;
+#endif
+}
+
+void PreparedPolygon::contains( const Vec2f *points, size_t count, bool *results ) const
+{
+	for( size_t p = 0; p < count; ++p )
+		results[p] = contains( points[p] );
+}
+
+} // namespace cinder
@@ -0,0 +1,279 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/Profiler.h"
+#include "cinder/JsonWriter.h"
+
+#include <boost/thread/tss.hpp>
+#include <algorithm>
+#include <iomanip>
+
+namespace cinder {
+
+namespace {
+
+// samples belong to the Profiler, which outlives the threads recording them
+template<typename T>
+void noCleanup( T * ) {}
+
+} // anonymous namespace
+
+Profiler::Profiler()
+	: mTimer( true ), mEnabled( true ), mNumSamplesPerThread( 65536 ), mFrameTimes( 1024 ), mNextFrame( 0 ), mNumFrameTimes( 0 ), mFrameStart( -1 ),
+	mMemorySamples( 1024 ), mNextMemorySample( 0 ), mNumMemorySamples( 0 )
+{
+}
+
+Profiler& Profiler::get()
+{
+	// created during static initialization, before any thread can race to create it
+	static Profiler *sInstance = new Profiler;
+	return *sInstance;
+}
+
+namespace {
+// forces the creation of the Profiler during static initialization
+Profiler &sProfilerInit = Profiler::get();
+}
+
+Profiler::ThreadSamples* Profiler::getThreadSamples()
+{
+	static boost::thread_specific_ptr<ThreadSamples> sThreadSamples( noCleanup<ThreadSamples> );
+
+	ThreadSamples *result = sThreadSamples.get();
+	if( ! result ) {
+		std::shared_ptr<ThreadSamples> threadSamples( new ThreadSamples );
+		std::lock_guard<std::mutex> lock( mMutex );
+		threadSamples->mSamples.resize( mNumSamplesPerThread );
+		threadSamples->mNext = threadSamples->mCount = 0;
+		threadSamples->mThreadIndex = (uint32_t)mThreads.size();
+		mThreads.push_back( threadSamples );
+		result = threadSamples.get();
+		sThreadSamples.reset( result );
+	}
+	return result;
+}
+
+void Profiler::addSample( const char *name, double startSeconds, double endSeconds )
+{
+	ThreadSamples *threadSamples = getThreadSamples();
+	std::lock_guard<std::mutex> lock( threadSamples->mMutex );
+	if( threadSamples->mSamples.empty() )
+		return;
+	Sample &sample = threadSamples->mSamples[threadSamples->mNext];
+	sample.mName = name;
+	sample.mStart = startSeconds;
+	sample.mEnd = endSeconds;
+	threadSamples->mNext = ( threadSamples->mNext + 1 ) % threadSamples->mSamples.size();
+	threadSamples->mCount = std::min( threadSamples->mCount + 1, threadSamples->mSamples.size() );
+}
+
+void Profiler::setThreadName( const std::string &name )
+{
+	ThreadSamples *threadSamples = getThreadSamples();
+	std::lock_guard<std::mutex> lock( threadSamples->mMutex );
+	threadSamples->mThreadName = name;
+}
+
+void Profiler::setNumSamplesPerThread( size_t numSamples )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mNumSamplesPerThread = numSamples;
+	for( size_t t = 0; t < mThreads.size(); ++t ) {
+		std::lock_guard<std::mutex> threadLock( mThreads[t]->mMutex );
+		mThreads[t]->mSamples.assign( numSamples, Sample() );
+		mThreads[t]->mNext = mThreads[t]->mCount = 0;
+	}
+}
+
+void Profiler::addInitialization( const char *name, double startSeconds, double endSeconds )
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		Sample initialization = { name, startSeconds, endSeconds };
+		mInitializations.push_back( initialization );
+	}
+
+	if( mEnabled )
+		addSample( name, startSeconds, endSeconds );
+}
+
+void Profiler::writeStartupReport( std::ostream &os ) const
+{
+	std::vector<Sample> initializations;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		initializations = mInitializations;
+	}
+
+	std::ios_base::fmtflags flags = os.flags();
+	std::streamsize precision = os.precision();
+	os << std::fixed << std::setprecision( 2 );
+	for( std::vector<Sample>::const_iterator initIt = initializations.begin(); initIt != initializations.end(); ++initIt )
+		os << initIt->mName << ": " << ( initIt->mEnd - initIt->mStart ) * 1000 << "ms, from " << initIt->mStart * 1000 << "ms" << std::endl;
+	os.flags( flags );
+	os.precision( precision );
+}
+
+void Profiler::beginFrame()
+{
+	double now = getSeconds();
+	{
+		std::lock_guard<std::mutex> lock( mFrameMutex );
+		if( ( mFrameStart >= 0 ) && ( ! mFrameTimes.empty() ) ) {
+			mFrameTimes[mNextFrame] = now - mFrameStart;
+			mNextFrame = ( mNextFrame + 1 ) % mFrameTimes.size();
+			mNumFrameTimes = std::min( mNumFrameTimes + 1, mFrameTimes.size() );
+		}
+
+		if( MemoryTracker::isEnabled() && ( ! mMemorySamples.empty() ) ) {
+			MemoryTracker::update( now );
+			MemorySample &sample = mMemorySamples[mNextMemorySample];
+			sample.mTime = now;
+			for( int c = 0; c < MemoryTracker::NUM_CATEGORIES; ++c )
+				sample.mLiveBytes[c] = MemoryTracker::getStats( (MemoryTracker::Category)c ).mLiveBytes;
+			mNextMemorySample = ( mNextMemorySample + 1 ) % mMemorySamples.size();
+			mNumMemorySamples = std::min( mNumMemorySamples + 1, mMemorySamples.size() );
+		}
+	}
+
+	if( mEnabled && ( mFrameStart >= 0 ) )
+		addSample( "Frame", mFrameStart, now );
+	mFrameStart = now;
+}
+
+void Profiler::setNumFrames( size_t numFrames )
+{
+	std::lock_guard<std::mutex> lock( mFrameMutex );
+	mFrameTimes.assign( numFrames, 0 );
+	mNextFrame = mNumFrameTimes = 0;
+	mMemorySamples.resize( numFrames );
+	mNextMemorySample = mNumMemorySamples = 0;
+}
+
+size_t Profiler::getNumFrameTimes() const
+{
+	std::lock_guard<std::mutex> lock( mFrameMutex );
+	return mNumFrameTimes;
+}
+
+double Profiler::getFrameTimePercentile( double percent ) const
+{
+	std::vector<double> frameTimes;
+	{
+		std::lock_guard<std::mutex> lock( mFrameMutex );
+		frameTimes.assign( mFrameTimes.begin(), mFrameTimes.begin() + mNumFrameTimes );
+	}
+	if( frameTimes.empty() )
+		return 0;
+
+	// nearest-rank percentile
+	size_t rank = (size_t)std::max( 0.0, std::min( 1.0, percent / 100 ) * frameTimes.size() + 0.5 );
+	std::vector<double>::iterator nth = frameTimes.begin() + std::min( frameTimes.size() - 1, ( rank > 0 ) ? rank - 1 : 0 );
+	std::nth_element( frameTimes.begin(), nth, frameTimes.end() );
+	return *nth;
+}
+
+std::vector<uint32_t> Profiler::getFrameTimeHistogram( size_t numBins, double maxSeconds ) const
+{
+	std::vector<uint32_t> result( numBins, 0 );
+	if( ( numBins == 0 ) || ( maxSeconds <= 0 ) )
+		return result;
+
+	std::lock_guard<std::mutex> lock( mFrameMutex );
+	for( size_t f = 0; f < mNumFrameTimes; ++f ) {
+		size_t bin = (size_t)std::max( 0.0, mFrameTimes[f] / maxSeconds * numBins );
+		++result[std::min( bin, numBins - 1 )];
+	}
+	return result;
+}
+
+void Profiler::writeChromeTrace( const fs::path &path ) const
+{
+	writeChromeTrace( writeFile( path ) );
+}
+
+void Profiler::writeChromeTrace( DataTargetRef dataTarget ) const
+{
+	std::vector<std::shared_ptr<ThreadSamples> > threads;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		threads = mThreads;
+	}
+
+	JsonWriter writer( dataTarget );
+	writer.beginObject().key( "traceEvents" ).beginArray();
+	for( size_t t = 0; t < threads.size(); ++t ) {
+		ThreadSamples &thread = *threads[t];
+		std::lock_guard<std::mutex> lock( thread.mMutex );
+		if( ! thread.mThreadName.empty() ) {
+			writer.beginObject().key( "name" ).value( "thread_name" ).key( "ph" ).value( "M" ).key( "pid" ).value( 0 ).key( "tid" ).value( thread.mThreadIndex );
+			writer.key( "args" ).beginObject().key( "name" ).value( thread.mThreadName ).endObject();
+			writer.endObject();
+		}
+
+		// complete ("X") events, oldest first, with times in microseconds
+		size_t first = ( thread.mNext + thread.mSamples.size() - thread.mCount ) % std::max<size_t>( 1, thread.mSamples.size() );
+		for( size_t s = 0; s < thread.mCount; ++s ) {
+			const Sample &sample = thread.mSamples[( first + s ) % thread.mSamples.size()];
+			writer.beginObject().key( "name" ).value( sample.mName ).key( "ph" ).value( "X" );
+			writer.key( "ts" ).value( sample.mStart * 1e6 ).key( "dur" ).value( ( sample.mEnd - sample.mStart ) * 1e6 );
+			writer.key( "pid" ).value( 0 ).key( "tid" ).value( thread.mThreadIndex ).endObject();
+		}
+	}
+
+	// counter ("C") events of the live bytes per MemoryTracker category, oldest first
+	{
+		std::lock_guard<std::mutex> lock( mFrameMutex );
+		size_t first = ( mNextMemorySample + mMemorySamples.size() - mNumMemorySamples ) % std::max<size_t>( 1, mMemorySamples.size() );
+		for( size_t s = 0; s < mNumMemorySamples; ++s ) {
+			const MemorySample &sample = mMemorySamples[( first + s ) % mMemorySamples.size()];
+			writer.beginObject().key( "name" ).value( "Memory" ).key( "ph" ).value( "C" ).key( "ts" ).value( sample.mTime * 1e6 ).key( "pid" ).value( 0 );
+			writer.key( "args" ).beginObject();
+			for( int c = 0; c < MemoryTracker::NUM_CATEGORIES; ++c )
+				writer.key( MemoryTracker::getCategoryName( (MemoryTracker::Category)c ) ).value( sample.mLiveBytes[c] );
+			writer.endObject().endObject();
+		}
+	}
+	writer.endArray().endObject();
+	writer.close();
+}
+
+void Profiler::clear()
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		for( size_t t = 0; t < mThreads.size(); ++t ) {
+			std::lock_guard<std::mutex> threadLock( mThreads[t]->mMutex );
+			mThreads[t]->mNext = mThreads[t]->mCount = 0;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock( mFrameMutex );
+	mNextFrame = mNumFrameTimes = 0;
+	mNextMemorySample = mNumMemorySamples = 0;
+}
+
+} // namespace cinder
@@ -21,6 +21,10 @@
 */
 
 #include "cinder/Rand.h"
+#include "cinder/Area.h"
+#include "cinder/Function.h"
+#include "cinder/ip/ExecutionContext.h"
+
 #if defined( CINDER_COCOA )
 #	include <mach/mach.h>
 #	include <mach/mach_time.h>
@@ -53,4 +57,107 @@ void Rand::seed( uint32_t seedValue )
 	mBase = boost::mt19937( seedValue );
 }
 
+/////////////////////////////////////////////////////////////////////////////////////////////////
+// RandPcg
+namespace {
+
+const uint64_t PCG_MULTIPLIER = 6364136223846793005ULL;
+
+// fills shorter than this aren't worth splitting across threads
+const size_t MIN_PARALLEL_VALUES = 16384;
+
+// each band advances its own copy of the generator to the first value it owns, \a drawsPerValue values apiece
+void runInBands( RandPcg *rand, size_t count, uint64_t drawsPerValue, const ip::ExecutionContextRef &context, const std::function<void(RandPcg,const Area&)> &bandFn )
+{
+	const Area area( 0, 0, 1, (int32_t)count );
+	if( context && ( count >= MIN_PARALLEL_VALUES ) && ( context->getNumThreads() > 1 ) ) {
+		context->run( area, std::bind( bandFn, *rand, std::_1 ) );
+		rand->advance( count * drawsPerValue );
+	}
+	else
+		bandFn( *rand, area );
+}
+
+void floatsBand( float *result, float a, float b, RandPcg rand, const Area &band )
+{
+	rand.advance( band.y1 );
+	rand.nextFloats( result + band.y1, band.y2 - band.y1, a, b );
+}
+
+void vec3fsBand( Vec3f *result, RandPcg rand, const Area &band )
+{
+	rand.advance( band.y1 * 2 );
+	rand.nextVec3fs( result + band.y1, band.y2 - band.y1 );
+}
+
+void vec2fsBand( Vec2f *result, RandPcg rand, const Area &band )
+{
+	rand.advance( band.y1 );
+	rand.nextVec2fs( result + band.y1, band.y2 - band.y1 );
+}
+
+} // anonymous namespace
+
+void RandPcg::seed( uint64_t seedValue, uint64_t stream )
+{
+	mState = 0;
+	mInc = ( stream << 1u ) | 1u;
+	nextUint32();
+	mState += seedValue;
+	nextUint32();
+	mHaveNextNextGaussian = false;
+}
+
+void RandPcg::advance( uint64_t delta )
+{
+	uint64_t curMult = PCG_MULTIPLIER, curPlus = mInc;
+	uint64_t accMult = 1, accPlus = 0;
+	while( delta > 0 ) {
+		if( delta & 1 ) {
+			accMult *= curMult;
+			accPlus = accPlus * curMult + curPlus;
+		}
+		curPlus = ( curMult + 1 ) * curPlus;
+		curMult *= curMult;
+		delta >>= 1;
+	}
+	mState = accMult * mState + accPlus;
+}
+
+float RandPcg::nextGaussian()
+{
+	if( mHaveNextNextGaussian ) {
+		mHaveNextNextGaussian = false;
+		return mNextNextGaussian;
+	}
+
+	float v1, v2, s;
+	do {
+		v1 = 2.0f * nextFloat() - 1.0f;
+		v2 = 2.0f * nextFloat() - 1.0f;
+		s = v1 * v1 + v2 * v2;
+	}
+	while( s >= 1.0f || s == 0.0f );
+
+	float m = math<float>::sqrt( -2.0f * math<float>::log( s ) / s );
+	mNextNextGaussian = v2 * m;
+	mHaveNextNextGaussian = true;
+	return v1 * m;
+}
+
+void RandPcg::nextFloats( float *result, size_t count, float a, float b, const ip::ExecutionContextRef &context )
+{
+	runInBands( this, count, 1, context, std::bind( floatsBand, result, a, b, std::_1, std::_2 ) );
+}
+
+void RandPcg::nextVec3fs( Vec3f *result, size_t count, const ip::ExecutionContextRef &context )
+{
+	runInBands( this, count, 2, context, std::bind( vec3fsBand, result, std::_1, std::_2 ) );
+}
+
+void RandPcg::nextVec2fs( Vec2f *result, size_t count, const ip::ExecutionContextRef &context )
+{
+	runInBands( this, count, 1, context, std::bind( vec2fsBand, result, std::_1, std::_2 ) );
+}
+
 } // ci
\ No newline at end of file
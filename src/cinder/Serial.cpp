@@ -32,13 +32,18 @@
 #if defined( CINDER_MAC )
 	#include <termios.h>
 	#include <sys/ioctl.h>
+	#include <sys/select.h>
+	#include <errno.h>
 	#include <getopt.h>
 	#include <dirent.h>
+	#include <unistd.h>
 #elif defined( CINDER_MSW )
 	#include <setupapi.h>
 	#pragma comment(lib, "setupapi.lib")
 #endif
 
+#include <algorithm>
+#include <cstring>
 #include <map>
 using namespace std;
 
@@ -47,6 +52,47 @@ namespace cinder {
 bool							Serial::sDevicesInited = false;
 std::vector<Serial::Device>		Serial::sDevices;
 
+// State of async mode: the background thread, the ring buffer it fills and the queue of bytes it writes
+struct Serial::Async {
+	Async()
+		: mRingStart( 0 ), mRingSize( 0 ), mNumDropped( 0 ), mNumWriting( 0 ), mStop( false ), mFailed( false ), mLineDelimiter( '\n' ), mPacketSize( 0 )
+	{}
+
+	void	start( Obj *obj, size_t bufferSize );
+	void	stop( Obj *obj );
+	bool	isRunning() const { return mThread.get() != 0; }
+	void	threadFn( Obj *obj );
+	//! Passes received bytes to the callbacks or the ring buffer
+	void	receive( const uint8_t *data, size_t size );
+	//! Appends to the ring buffer, dropping the oldest bytes which don't fit. Requires mMutex.
+	void	push( const uint8_t *data, size_t size );
+	//! Removes up to \a maxSize bytes from the ring buffer. Requires mMutex.
+	size_t	pop( uint8_t *dest, size_t maxSize );
+	//! Wakes the thread to write newly queued bytes or to stop
+	void	wake();
+
+	std::mutex					mMutex;
+	std::condition_variable		mDataCond;
+	std::shared_ptr<std::thread>	mThread;
+	std::vector<uint8_t>		mRing;
+	size_t						mRingStart, mRingSize, mNumDropped;
+	std::vector<uint8_t>		mWriteQueue;
+	size_t						mNumWriting;	// bytes taken from mWriteQueue by the thread but not written yet
+	bool						mStop, mFailed;
+
+	std::function<void (const std::string&)>		mLineFn;
+	char											mLineDelimiter;
+	std::function<void (const uint8_t*, size_t)>	mPacketFn;
+	size_t											mPacketSize;
+
+	// used only by the thread
+	std::string					mLine;
+	std::vector<uint8_t>		mPacket;
+#if defined( CINDER_MAC )
+	int							mWakePipe[2];
+#endif
+};
+
 Serial::Serial( const Serial::Device &device, int baudRate )
 	: mObj( new Obj( device, baudRate ) )
 {
@@ -211,6 +257,9 @@ const std::vector<Serial::Device>& Serial::getDevices( bool forceRefresh )
 
 Serial::Obj::~Obj()
 {
+	if( mAsync )
+		mAsync->stop( this );
+
 #if defined( CINDER_MAC )
 	// restore the termios from before we opened the port
 	::tcsetattr( mFd, TCSANOW, &mSavedOptions );
@@ -228,6 +277,18 @@ const Serial::Device& Serial::getDevice() const
 
 void Serial::writeBytes( const void *data, size_t numBytes )
 {
+	if( isAsync() ) {
+		Async *async = mObj->mAsync.get();
+		{
+			lock_guard<mutex> lock( async->mMutex );
+			if( async->mFailed )
+				throw SerialExcWriteFailure();
+			async->mWriteQueue.insert( async->mWriteQueue.end(), (const uint8_t*)data, (const uint8_t*)data + numBytes );
+		}
+		async->wake();
+		return;
+	}
+
 	size_t totalBytesWritten = 0;
 	
 	while( totalBytesWritten < numBytes ) {
@@ -246,6 +307,23 @@ void Serial::writeBytes( const void *data, size_t numBytes )
 
 void Serial::readBytes( void *data, size_t numBytes )
 {
+	if( isAsync() ) {
+		Async *async = mObj->mAsync.get();
+		uint8_t *dest = reinterpret_cast<uint8_t*>( data );
+		unique_lock<mutex> lock( async->mMutex );
+		while( numBytes ) {
+			size_t bytesRead = async->pop( dest, numBytes );
+			dest += bytesRead;
+			numBytes -= bytesRead;
+			if( numBytes ) {
+				if( async->mFailed )
+					throw SerialExcReadFailure();
+				async->mDataCond.wait( lock );
+			}
+		}
+		return;
+	}
+
 	size_t totalBytesRead = 0;
 	while( totalBytesRead < numBytes ) {
 #if defined( CINDER_MAC )
@@ -266,6 +344,11 @@ void Serial::readBytes( void *data, size_t numBytes )
 
 size_t Serial::readAvailableBytes( void *data, size_t maximumBytes )
 {
+	if( isAsync() ) {
+		lock_guard<mutex> lock( mObj->mAsync->mMutex );
+		return mObj->mAsync->pop( reinterpret_cast<uint8_t*>( data ), maximumBytes );
+	}
+
 #if defined( CINDER_MAC )
 	int bytesRead = ::read( mObj->mFd, data, maximumBytes );
 #elif defined( CINDER_MSW )
@@ -339,6 +422,11 @@ void Serial::writeString( const std::string &str )
 
 size_t Serial::getNumBytesAvailable() const
 {
+	if( isAsync() ) {
+		lock_guard<mutex> lock( mObj->mAsync->mMutex );
+		return mObj->mAsync->mRingSize;
+	}
+
 	int result;
 	
 #if defined( CINDER_MAC )
@@ -357,6 +445,14 @@ size_t Serial::getNumBytesAvailable() const
 	
 void Serial::flush( bool input, bool output )
 {
+	if( isAsync() ) {
+		lock_guard<mutex> lock( mObj->mAsync->mMutex );
+		if( input )
+			mObj->mAsync->mRingStart = mObj->mAsync->mRingSize = 0;
+		if( output )
+			mObj->mAsync->mWriteQueue.clear();
+	}
+
 #if defined( CINDER_MAC )
 	int queue;
 	if( input && output )
@@ -379,4 +475,284 @@ void Serial::flush( bool input, bool output )
 #endif
 }
 
-} // namespace cinder
\ No newline at end of file
+void Serial::startAsync( size_t bufferSize )
+{
+	if( ! mObj->mAsync )
+		mObj->mAsync = shared_ptr<Async>( new Async );
+	if( ! mObj->mAsync->isRunning() )
+		mObj->mAsync->start( mObj.get(), bufferSize );
+}
+
+void Serial::stopAsync()
+{
+	if( mObj->mAsync )
+		mObj->mAsync->stop( mObj.get() );
+}
+
+bool Serial::isAsync() const
+{
+	return mObj->mAsync && mObj->mAsync->isRunning();
+}
+
+void Serial::setLineCallback( const std::function<void (const std::string&)> &lineFn, char delimiter )
+{
+	if( ! mObj->mAsync )
+		mObj->mAsync = shared_ptr<Async>( new Async );
+	lock_guard<mutex> lock( mObj->mAsync->mMutex );
+	mObj->mAsync->mLineFn = lineFn;
+	mObj->mAsync->mLineDelimiter = delimiter;
+}
+
+void Serial::setPacketCallback( size_t packetSize, const std::function<void (const uint8_t*, size_t)> &packetFn )
+{
+	if( ! mObj->mAsync )
+		mObj->mAsync = shared_ptr<Async>( new Async );
+	lock_guard<mutex> lock( mObj->mAsync->mMutex );
+	mObj->mAsync->mPacketFn = packetFn;
+	mObj->mAsync->mPacketSize = std::max<size_t>( packetSize, 1 );
+}
+
+size_t Serial::getNumBytesDropped() const
+{
+	if( ! mObj->mAsync )
+		return 0;
+	lock_guard<mutex> lock( mObj->mAsync->mMutex );
+	return mObj->mAsync->mNumDropped;
+}
+
+size_t Serial::getNumBytesQueued() const
+{
+	if( ! mObj->mAsync )
+		return 0;
+	lock_guard<mutex> lock( mObj->mAsync->mMutex );
+	return mObj->mAsync->mWriteQueue.size() + mObj->mAsync->mNumWriting;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Serial::Async
+void Serial::Async::start( Obj *obj, size_t bufferSize )
+{
+	mRing.resize( std::max<size_t>( bufferSize, 1 ) );
+	mRingStart = mRingSize = mNumDropped = mNumWriting = 0;
+	mStop = mFailed = false;
+	mLine.clear();
+	mPacket.clear();
+
+#if defined( CINDER_MAC )
+	if( ::pipe( mWakePipe ) != 0 )
+		throw SerialExc();
+	::fcntl( mWakePipe[0], F_SETFL, O_NONBLOCK );
+	::fcntl( mWakePipe[1], F_SETFL, O_NONBLOCK );
+#elif defined( CINDER_MSW )
+	// reads return as soon as any bytes arrive, or after 10 ms without any, so the thread can interleave writes
+	::COMMTIMEOUTS timeOuts( obj->mSavedTimeouts );
+	timeOuts.ReadIntervalTimeout = MAXDWORD;
+	timeOuts.ReadTotalTimeoutMultiplier = MAXDWORD;
+	timeOuts.ReadTotalTimeoutConstant = 10;
+	::SetCommTimeouts( obj->mDeviceHandle, &timeOuts );
+#endif
+
+	mThread = shared_ptr<thread>( new thread( std::bind( &Async::threadFn, this, obj ) ) );
+}
+
+void Serial::Async::stop( Obj *obj )
+{
+	if( ! mThread )
+		return;
+
+	{
+		lock_guard<mutex> lock( mMutex );
+		mStop = true;
+	}
+	wake();
+	mThread->join();
+	mThread.reset();
+
+#if defined( CINDER_MAC )
+	::close( mWakePipe[0] );
+	::close( mWakePipe[1] );
+#elif defined( CINDER_MSW )
+	// restore the timeouts of synchronous reads
+	::COMMTIMEOUTS timeOuts( obj->mSavedTimeouts );
+	timeOuts.ReadIntervalTimeout = MAXDWORD;
+	timeOuts.ReadTotalTimeoutMultiplier = 0;
+	timeOuts.ReadTotalTimeoutConstant = 0;
+	::SetCommTimeouts( obj->mDeviceHandle, &timeOuts );
+#endif
+
+	lock_guard<mutex> lock( mMutex );
+	mRingStart = mRingSize = 0;
+	mWriteQueue.clear();
+	mNumWriting = 0;
+}
+
+void Serial::Async::wake()
+{
+#if defined( CINDER_MAC )
+	char c = 0;
+	if( ::write( mWakePipe[1], &c, 1 ) < 0 ) {} // a full pipe already wakes the thread
+#endif
+}
+
+void Serial::Async::threadFn( Obj *obj )
+{
+	ThreadSetup threadSetup;
+	vector<uint8_t> readBuffer( 65536 ), writing;
+	size_t writeOffset = 0;
+	bool failed = false;
+
+	while( ! failed ) {
+		{
+			lock_guard<mutex> lock( mMutex );
+			if( writeOffset == writing.size() ) {
+				writing.clear();
+				writeOffset = 0;
+				writing.swap( mWriteQueue );
+			}
+			mNumWriting = writing.size() - writeOffset;
+			if( mStop && writing.empty() )
+				break;
+		}
+
+#if defined( CINDER_MAC )
+		::fd_set readSet, writeSet;
+		FD_ZERO( &readSet );
+		FD_ZERO( &writeSet );
+		FD_SET( obj->mFd, &readSet );
+		FD_SET( mWakePipe[0], &readSet );
+		if( ! writing.empty() )
+			FD_SET( obj->mFd, &writeSet );
+		::timeval timeout = { 0, 100000 };
+		int numReady = ::select( std::max( obj->mFd, mWakePipe[0] ) + 1, &readSet, &writeSet, 0, &timeout );
+		if( numReady < 0 ) {
+			failed = ( errno != EINTR );
+			continue;
+		}
+
+		if( FD_ISSET( mWakePipe[0], &readSet ) ) {
+			char drain[64];
+			while( ::read( mWakePipe[0], drain, sizeof( drain ) ) > 0 )
+				;
+		}
+		if( FD_ISSET( obj->mFd, &readSet ) ) {
+			ssize_t bytesRead = ::read( obj->mFd, &readBuffer[0], readBuffer.size() );
+			if( bytesRead > 0 )
+				receive( &readBuffer[0], bytesRead );
+			else if( ( bytesRead == 0 ) || ( errno != EAGAIN ) ) // the device has gone away
+				failed = true;
+		}
+		if( ( ! failed ) && FD_ISSET( obj->mFd, &writeSet ) ) {
+			ssize_t bytesWritten = ::write( obj->mFd, &writing[writeOffset], writing.size() - writeOffset );
+			if( bytesWritten > 0 )
+				writeOffset += bytesWritten;
+			else if( ( bytesWritten < 0 ) && ( errno != EAGAIN ) )
+				failed = true;
+		}
+#elif defined( CINDER_MSW )
+		if( ! writing.empty() ) {
+			::DWORD bytesWritten = 0;
+			if( ::WriteFile( obj->mDeviceHandle, &writing[writeOffset], (::DWORD)( writing.size() - writeOffset ), &bytesWritten, 0 ) )
+				writeOffset += bytesWritten;
+			else
+				failed = true;
+		}
+		::DWORD bytesRead = 0;
+		if( ! ::ReadFile( obj->mDeviceHandle, &readBuffer[0], (::DWORD)readBuffer.size(), &bytesRead, 0 ) )
+			failed = true;
+		else if( bytesRead )
+			receive( &readBuffer[0], bytesRead );
+#endif
+	}
+
+	lock_guard<mutex> lock( mMutex );
+	mFailed = failed;
+	mNumWriting = 0;
+	mDataCond.notify_all();
+}
+
+void Serial::Async::receive( const uint8_t *data, size_t size )
+{
+	std::function<void (const std::string&)> lineFn;
+	std::function<void (const uint8_t*, size_t)> packetFn;
+	char lineDelimiter;
+	size_t packetSize;
+	{
+		lock_guard<mutex> lock( mMutex );
+		if( ( ! mLineFn ) && ( ! mPacketFn ) ) {
+			push( data, size );
+			mDataCond.notify_all();
+			return;
+		}
+		lineFn = mLineFn;
+		lineDelimiter = mLineDelimiter;
+		packetFn = mPacketFn;
+		packetSize = mPacketSize;
+	}
+
+	const uint8_t *end = data + size;
+	if( lineFn ) {
+		while( data < end ) {
+			const uint8_t *delimiter = reinterpret_cast<const uint8_t*>( memchr( data, lineDelimiter, end - data ) );
+			const uint8_t *runEnd = ( delimiter ) ? delimiter : end;
+			mLine.append( reinterpret_cast<const char*>( data ), runEnd - data );
+			data = ( delimiter ) ? delimiter + 1 : end;
+			if( delimiter || ( mLine.size() >= mRing.size() ) ) {
+				lineFn( mLine );
+				mLine.clear();
+			}
+		}
+	}
+	else {
+		// whole packets are passed straight from the read buffer unless one is already partly collected
+		while( data < end ) {
+			if( mPacket.empty() && ( (size_t)( end - data ) >= packetSize ) ) {
+				packetFn( data, packetSize );
+				data += packetSize;
+				continue;
+			}
+			size_t count = std::min( packetSize - mPacket.size(), (size_t)( end - data ) );
+			mPacket.insert( mPacket.end(), data, data + count );
+			data += count;
+			if( mPacket.size() == packetSize ) {
+				packetFn( &mPacket[0], packetSize );
+				mPacket.clear();
+			}
+		}
+	}
+}
+
+void Serial::Async::push( const uint8_t *data, size_t size )
+{
+	size_t capacity = mRing.size();
+	if( size >= capacity ) {
+		mNumDropped += mRingSize + size - capacity;
+		data += size - capacity;
+		size = capacity;
+		mRingStart = mRingSize = 0;
+	}
+	else if( mRingSize + size > capacity ) {
+		size_t numDropped = mRingSize + size - capacity;
+		mNumDropped += numDropped;
+		mRingStart = ( mRingStart + numDropped ) % capacity;
+		mRingSize -= numDropped;
+	}
+
+	size_t end = ( mRingStart + mRingSize ) % capacity;
+	size_t firstSize = std::min( size, capacity - end );
+	memcpy( &mRing[end], data, firstSize );
+	memcpy( &mRing[0], data + firstSize, size - firstSize );
+	mRingSize += size;
+}
+
+size_t Serial::Async::pop( uint8_t *dest, size_t maxSize )
+{
+	size_t size = std::min( maxSize, mRingSize );
+	size_t firstSize = std::min( size, mRing.size() - mRingStart );
+	memcpy( dest, &mRing[mRingStart], firstSize );
+	memcpy( dest + firstSize, &mRing[0], size - firstSize );
+	mRingStart = ( mRingStart + size ) % mRing.size();
+	mRingSize -= size;
+	return size;
+}
+
+} // namespace cinder
@@ -23,12 +23,24 @@
 #include "cinder/Cinder.h"
 #include "cinder/Stream.h"
 #include "cinder/Utilities.h"
+#include "cinder/Thread.h"
+#include "cinder/Function.h"
 
 #include <stdio.h>
 #include <limits>
+#include <algorithm>
+#include <deque>
 #include <boost/scoped_array.hpp>
 #include <iostream>
 #include <boost/preprocessor/seq/for_each.hpp>
+
+#if defined( CINDER_MSW )
+	#include <windows.h>
+#else
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
 using std::string;
 
 namespace cinder {
@@ -56,6 +68,43 @@ void OStream::writeLittle( T t )
 #endif
 }
 
+template<typename T>
+void OStream::writeBig( const T *t, size_t count )
+{
+#ifdef BOOST_BIG_ENDIAN
+	IOWrite( t, sizeof(T) * count );
+#else
+	// swap a chunk at a time rather than value by value
+	T chunk[1024];
+	while( count ) {
+		size_t n = std::min<size_t>( count, 1024 );
+		memcpy( chunk, t, sizeof(T) * n );
+		swapEndianBlock( chunk, sizeof(T) * n );
+		IOWrite( chunk, sizeof(T) * n );
+		t += n;
+		count -= n;
+	}
+#endif
+}
+
+template<typename T>
+void OStream::writeLittle( const T *t, size_t count )
+{
+#ifdef CINDER_LITTLE_ENDIAN
+	IOWrite( t, sizeof(T) * count );
+#else
+	T chunk[1024];
+	while( count ) {
+		size_t n = std::min<size_t>( count, 1024 );
+		memcpy( chunk, t, sizeof(T) * n );
+		swapEndianBlock( chunk, sizeof(T) * n );
+		IOWrite( chunk, sizeof(T) * n );
+		t += n;
+		count -= n;
+	}
+#endif
+}
+
 //////////////////////////////////////////////////////////////////////////
 void IStream::read( std::string *s )
 {
@@ -97,6 +146,24 @@ void IStream::readLittle( T *t )
 #endif
 }
 
+template<typename T>
+void IStream::readBig( T *t, size_t count )
+{
+	IORead( t, sizeof(T) * count );
+#ifndef BOOST_BIG_ENDIAN
+	swapEndianBlock( t, sizeof(T) * count );
+#endif
+}
+
+template<typename T>
+void IStream::readLittle( T *t, size_t count )
+{
+	IORead( t, sizeof(T) * count );
+#ifndef CINDER_LITTLE_ENDIAN
+	swapEndianBlock( t, sizeof(T) * count );
+#endif
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 
 void IStream::readFixedString( char *t, size_t size, bool nullTerminate )
@@ -151,6 +218,108 @@ void OStream::writeData( const void *src, size_t size )
 	IOWrite( src, size );
 }
 
+////////////////////////////////////////////////////////////////////////////////////////
+// IStreamFile::Readahead
+// Reads one block past the stream's buffer on a background thread. Only one thread uses the FILE at a time: the stream waits for
+// the pending read before any FILE call of its own.
+struct IStreamFile::Readahead {
+	Readahead( FILE *file, size_t blockSize );
+	~Readahead();
+
+	//! Starts reading the block at \a offset
+	void	request( off_t offset );
+	//! Waits for the pending read, if any
+	void	wait();
+	//! Waits for the pending read. If it read the block at \a offset, swaps it into \a buffer and returns \c true
+	bool	take( off_t offset, std::shared_ptr<uint8_t> *buffer, size_t *size );
+
+	void	threadFn();
+
+	enum State { IDLE, PENDING, READY };
+
+	FILE						*mFile;
+	std::shared_ptr<uint8_t>	mBlock;
+	size_t						mBlockCapacity, mBlockSize;
+	off_t						mBlockOffset;
+	State						mState;
+	bool						mQuit;
+	std::mutex					mMutex;
+	std::condition_variable		mCondition;
+	std::shared_ptr<std::thread>	mThread;
+};
+
+IStreamFile::Readahead::Readahead( FILE *file, size_t blockSize )
+	: mFile( file ), mBlock( new uint8_t[blockSize], checked_array_deleter<uint8_t>() ), mBlockCapacity( blockSize ), mBlockSize( 0 ),
+	mBlockOffset( 0 ), mState( IDLE ), mQuit( false )
+{
+	mThread = std::shared_ptr<std::thread>( new std::thread( std::bind( &Readahead::threadFn, this ) ) );
+}
+
+IStreamFile::Readahead::~Readahead()
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mQuit = true;
+	}
+	mCondition.notify_all();
+	mThread->join();
+}
+
+void IStreamFile::Readahead::request( off_t offset )
+{
+	{
+		std::unique_lock<std::mutex> lock( mMutex );
+		while( mState == PENDING )
+			mCondition.wait( lock );
+		mBlockOffset = offset;
+		mState = PENDING;
+	}
+	mCondition.notify_all();
+}
+
+void IStreamFile::Readahead::wait()
+{
+	std::unique_lock<std::mutex> lock( mMutex );
+	while( mState == PENDING )
+		mCondition.wait( lock );
+}
+
+bool IStreamFile::Readahead::take( off_t offset, std::shared_ptr<uint8_t> *buffer, size_t *size )
+{
+	std::unique_lock<std::mutex> lock( mMutex );
+	while( mState == PENDING )
+		mCondition.wait( lock );
+	bool hit = ( mState == READY ) && ( mBlockOffset == offset ) && ( mBlockSize > 0 );
+	if( hit ) {
+		std::swap( mBlock, *buffer );
+		*size = mBlockSize;
+	}
+	mState = IDLE;
+	return hit;
+}
+
+void IStreamFile::Readahead::threadFn()
+{
+	std::unique_lock<std::mutex> lock( mMutex );
+	while( true ) {
+		while( ( mState != PENDING ) && ( ! mQuit ) )
+			mCondition.wait( lock );
+		if( mQuit )
+			break;
+
+		off_t offset = mBlockOffset;
+		lock.unlock();
+		size_t bytesRead = 0;
+		if( fseek( mFile, static_cast<long>( offset ), SEEK_SET ) == 0 )
+			bytesRead = fread( mBlock.get(), 1, mBlockCapacity, mFile );
+		lock.lock();
+
+		mBlockSize = bytesRead;
+		mState = READY;
+		mCondition.notify_all();
+	}
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 // IStreamFile
 IStreamFileRef IStreamFile::create( FILE *file, bool ownsFile, int32_t defaultBufferSize )
@@ -169,20 +338,52 @@ IStreamFile::IStreamFile( FILE *aFile, bool aOwnsFile, int32_t aDefaultBufferSiz
 
 IStreamFile::~IStreamFile()
 {
+	// stop the readahead thread before the file goes away
+	mReadahead.reset();
 	if( mOwnsFile )
 		fclose( mFile );
 	if( mDeleteOnDestroy && ( ! mFileName.empty() ) )
 		deleteFile( mFileName );
 }
 
+void IStreamFile::setReadahead( bool enable )
+{
+	if( enable && ( ! mReadahead ) )
+		mReadahead = std::shared_ptr<Readahead>( new Readahead( mFile, mDefaultBufferSize ) );
+	else if( ( ! enable ) && mReadahead )
+		mReadahead.reset();
+}
+
+void IStreamFile::waitForReadahead() const
+{
+	if( mReadahead )
+		mReadahead->wait();
+}
+
 size_t IStreamFile::readDataAvailable( void *dest, size_t maxSize )
 {
 	return readDataImpl( dest, maxSize );
 }
 
+void IStreamFile::fillBuffer()
+{
+	if( mReadahead && mReadahead->take( mBufferOffset, &mBuffer, &mBufferSize ) ) {
+		mBufferFileOffset = mBufferOffset;
+	}
+	else {
+		fseek( mFile, static_cast<long>( mBufferOffset ), SEEK_SET );
+		mBufferFileOffset = mBufferOffset;
+		mBufferSize = fread( mBuffer.get(), 1, mDefaultBufferSize, mFile );
+	}
+
+	// a full block suggests there is more to come
+	if( mReadahead && ( mBufferSize == mDefaultBufferSize ) )
+		mReadahead->request( mBufferFileOffset + (off_t)mBufferSize );
+}
+
 size_t IStreamFile::readDataImpl( void *t, size_t size )
 {
-	if( ( mBufferOffset >= mBufferFileOffset ) && ( mBufferOffset + static_cast<int32_t>( size ) < mBufferFileOffset + (off_t)mBufferSize ) ) { // entirely inside the buffer
+	if( ( mBufferOffset >= mBufferFileOffset ) && ( mBufferOffset + static_cast<off_t>( size ) <= mBufferFileOffset + (off_t)mBufferSize ) ) { // entirely inside the buffer
 		memcpy( t, mBuffer.get() + ( mBufferOffset - mBufferFileOffset ), size );
 		mBufferOffset += size;
 		return size;
@@ -194,23 +395,24 @@ size_t IStreamFile::readDataImpl( void *t, size_t size )
 		return amountInBuffer + readDataImpl( reinterpret_cast<uint8_t*>( t ) + amountInBuffer, size - amountInBuffer );
 	}
 	else if( size > mDefaultBufferSize ) { // entirely outside of buffer, and too big to buffer anyway
+		waitForReadahead();
 		fseek( mFile, static_cast<long>( mBufferOffset ), SEEK_SET );
 		size_t bytesRead = fread( t, 1, size, mFile );
 		mBufferOffset += bytesRead;
 		return bytesRead;
 	}
 	else { // outside the current buffer, but not too big
-		fseek( mFile, static_cast<long>( mBufferOffset ), SEEK_SET );
-		mBufferFileOffset = mBufferOffset;
-		mBufferSize = fread( mBuffer.get(), 1, mDefaultBufferSize, mFile );
-		memcpy( t, mBuffer.get(), size );
-		mBufferOffset = mBufferFileOffset + size;
-		return size;
+		fillBuffer();
+		size_t bytesRead = std::min( size, mBufferSize );
+		memcpy( t, mBuffer.get(), bytesRead );
+		mBufferOffset = mBufferFileOffset + bytesRead;
+		return bytesRead;
 	}
 }
 
 void IStreamFile::seekAbsolute( off_t absoluteOffset )
 {
+	waitForReadahead();
 	int dir = ( absoluteOffset >= 0 ) ? SEEK_SET : SEEK_END;
 	absoluteOffset = abs( absoluteOffset );
 	if( fseek( mFile, static_cast<long>( absoluteOffset ), dir ) )
@@ -220,6 +422,7 @@ void IStreamFile::seekAbsolute( off_t absoluteOffset )
 
 void IStreamFile::seekRelative( off_t relativeOffset )
 {
+	waitForReadahead();
 	if( fseek( mFile, static_cast<long>( mBufferOffset + relativeOffset ), SEEK_SET ) )
 		throw StreamExc();
 	mBufferOffset = ftell( mFile );
@@ -233,6 +436,7 @@ off_t IStreamFile::tell() const
 off_t IStreamFile::size() const
 {
 	if ( ! mSizeCached ) {
+		waitForReadahead();
 		off_t curOff = ftell( mFile );
 		fseek( mFile, 0, SEEK_END );
 		mSize = ftell( mFile );
@@ -245,6 +449,9 @@ off_t IStreamFile::size() const
 
 bool IStreamFile::isEof() const
 {
+	// the FILE's end of file flag belongs to the block read ahead rather than the buffer
+	if( mReadahead )
+		return mBufferOffset >= size();
 	return ( ( mBufferOffset >= mBufferFileOffset + (off_t)mBufferSize ) && ( static_cast<bool>( feof( mFile ) != 0 ) ) );
 }
 
@@ -257,14 +464,17 @@ void IStreamFile::IORead( void *t, size_t size )
 
 ////////////////////////////////////////////////////////////////////////////////////////
 // OStreamFile
-OStreamFileRef OStreamFile::create( FILE *file, bool ownsFile )
+OStreamFileRef OStreamFile::create( FILE *file, bool ownsFile, size_t bufferSize )
 {
-	return OStreamFileRef( new OStreamFile( file, ownsFile ) );
+	return OStreamFileRef( new OStreamFile( file, ownsFile, bufferSize ) );
 }
 
-OStreamFile::OStreamFile( FILE *aFile, bool aOwnsFile )
+OStreamFile::OStreamFile( FILE *aFile, bool aOwnsFile, size_t aBufferSize )
 	: OStream(), mFile( aFile ), mOwnsFile( aOwnsFile )
 {
+	// the C library allocates and frees the buffer along with the FILE
+	if( aBufferSize )
+		setvbuf( mFile, NULL, _IOFBF, aBufferSize );
 }
 
 OStreamFile::~OStreamFile()
@@ -300,6 +510,363 @@ void OStreamFile::IOWrite( const void *t, size_t size )
 	}
 }
 
+////////////////////////////////////////////////////////////////////////////////////////
+// OStreamFileAsync::Writer
+// Owns the file and a pool of blocks, and writes queued blocks to the file at their offsets on a background thread. Unbuffered writes
+// need whole sectors at aligned offsets in aligned memory, so blocks are allocated and sized as multiples of ALIGNMENT.
+struct OStreamFileAsync::Writer {
+	Writer( size_t blockCapacity, size_t maxBlocks, bool unbuffered );
+	~Writer();
+
+	bool		open( const fs::path &path );
+	//! Returns an empty block, waiting for one to be written if the queue is full. Returns NULL if a write has failed.
+	uint8_t*	acquire();
+	//! Queues \a size bytes of \a block to be written at \a offset, or returns the block to the pool if \a size is \c 0
+	void		submit( uint8_t *block, size_t size, off_t offset );
+	//! Waits until the queue is empty and returns whether every write succeeded
+	bool		flush();
+	bool		sync();
+	size_t		getBacklog();
+
+	void		threadFn();
+	bool		writeBlock( const uint8_t *data, size_t size, off_t offset );
+
+	static const size_t ALIGNMENT = 4096;
+
+	struct Block {
+		uint8_t		*mData;
+		size_t		mSize;
+		off_t		mOffset;
+	};
+
+	size_t						mBlockCapacity, mMaxBlocks, mNumAllocated;
+	bool						mUnbuffered;
+	std::vector<uint8_t*>		mFree;
+	std::deque<Block>			mQueue;
+	bool						mWriting, mFailed, mQuit;
+	std::mutex					mMutex;
+	std::condition_variable		mCondition;
+	std::shared_ptr<std::thread>	mThread;
+#if defined( CINDER_MSW )
+	HANDLE						mHandle, mBufferedHandle; // mBufferedHandle is mHandle unless unbuffered
+	std::wstring				mPath;
+#else
+	int							mFd;
+	bool						mDirect; // whether O_DIRECT is currently set on mFd
+#endif
+};
+
+OStreamFileAsync::Writer::Writer( size_t blockCapacity, size_t maxBlocks, bool unbuffered )
+	: mBlockCapacity( ( std::max<size_t>( blockCapacity, 1 ) + ALIGNMENT - 1 ) / ALIGNMENT * ALIGNMENT ), mMaxBlocks( std::max<size_t>( maxBlocks, 1 ) ), mNumAllocated( 0 ),
+	mUnbuffered( unbuffered ), mWriting( false ), mFailed( false ), mQuit( false )
+{
+#if defined( CINDER_MSW )
+	mHandle = mBufferedHandle = INVALID_HANDLE_VALUE;
+#else
+	mFd = -1;
+	mDirect = false;
+#endif
+}
+
+OStreamFileAsync::Writer::~Writer()
+{
+	if( mThread ) {
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			mQuit = true;
+		}
+		mCondition.notify_all();
+		mThread->join();
+	}
+
+	for( size_t i = 0; i < mFree.size(); ++i )
+		alignedFree( mFree[i] );
+	for( std::deque<Block>::iterator blockIt = mQueue.begin(); blockIt != mQueue.end(); ++blockIt )
+		alignedFree( blockIt->mData );
+
+#if defined( CINDER_MSW )
+	if( ( mBufferedHandle != INVALID_HANDLE_VALUE ) && ( mBufferedHandle != mHandle ) )
+		::CloseHandle( mBufferedHandle );
+	if( mHandle != INVALID_HANDLE_VALUE )
+		::CloseHandle( mHandle );
+#else
+	if( mFd >= 0 )
+		::close( mFd );
+#endif
+}
+
+bool OStreamFileAsync::Writer::open( const fs::path &path )
+{
+#if defined( CINDER_MSW )
+	mPath = toUtf16( path.string() );
+	// unbuffered mode opens a second, buffered handle later for writes which aren't aligned, so the file has to be shared for writing
+	mHandle = ::CreateFileW( mPath.c_str(), GENERIC_WRITE, FILE_SHARE_READ | ( mUnbuffered ? FILE_SHARE_WRITE : 0 ), NULL, CREATE_ALWAYS,
+							FILE_ATTRIBUTE_NORMAL | ( mUnbuffered ? FILE_FLAG_NO_BUFFERING : 0 ), NULL );
+	if( mHandle == INVALID_HANDLE_VALUE )
+		return false;
+	if( ! mUnbuffered )
+		mBufferedHandle = mHandle;
+#else
+	mFd = ::open( path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644 );
+	if( mFd < 0 )
+		return false;
+	#if defined( F_NOCACHE )
+	if( mUnbuffered )
+		::fcntl( mFd, F_NOCACHE, 1 );
+	#endif
+#endif
+
+	mThread = std::shared_ptr<std::thread>( new std::thread( std::bind( &Writer::threadFn, this ) ) );
+	return true;
+}
+
+uint8_t* OStreamFileAsync::Writer::acquire()
+{
+	std::unique_lock<std::mutex> lock( mMutex );
+	// one block more than the queue holds is being filled
+	while( mFree.empty() && ( mNumAllocated > mMaxBlocks ) && ( ! mFailed ) )
+		mCondition.wait( lock );
+	if( mFailed )
+		return NULL;
+
+	if( ! mFree.empty() ) {
+		uint8_t *result = mFree.back();
+		mFree.pop_back();
+		return result;
+	}
+
+	uint8_t *result = reinterpret_cast<uint8_t*>( alignedMalloc( mBlockCapacity, ALIGNMENT ) );
+	if( ! result )
+		throw StreamExcOutOfMemory();
+	++mNumAllocated;
+	return result;
+}
+
+void OStreamFileAsync::Writer::submit( uint8_t *block, size_t size, off_t offset )
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		if( size ) {
+			Block queued = { block, size, offset };
+			mQueue.push_back( queued );
+		}
+		else
+			mFree.push_back( block );
+	}
+	mCondition.notify_all();
+}
+
+bool OStreamFileAsync::Writer::flush()
+{
+	std::unique_lock<std::mutex> lock( mMutex );
+	while( ( ! mQueue.empty() || mWriting ) && ( ! mFailed ) )
+		mCondition.wait( lock );
+	return ! mFailed;
+}
+
+bool OStreamFileAsync::Writer::sync()
+{
+	if( ! flush() )
+		return false;
+#if defined( CINDER_MSW )
+	bool result = ::FlushFileBuffers( mHandle ) != 0;
+	if( mBufferedHandle != mHandle && mBufferedHandle != INVALID_HANDLE_VALUE )
+		result = ( ::FlushFileBuffers( mBufferedHandle ) != 0 ) && result;
+	return result;
+#else
+	return ::fsync( mFd ) == 0;
+#endif
+}
+
+size_t OStreamFileAsync::Writer::getBacklog()
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mQueue.size() + ( mWriting ? 1 : 0 );
+}
+
+void OStreamFileAsync::Writer::threadFn()
+{
+	std::unique_lock<std::mutex> lock( mMutex );
+	while( true ) {
+		while( mQueue.empty() && ( ! mQuit ) )
+			mCondition.wait( lock );
+		if( mQueue.empty() ) // quitting once everything queued is written
+			break;
+
+		Block block = mQueue.front();
+		mQueue.pop_front();
+		mWriting = true;
+		bool failed = mFailed;
+		lock.unlock();
+		if( ! failed )
+			failed = ! writeBlock( block.mData, block.mSize, block.mOffset );
+		lock.lock();
+
+		mFree.push_back( block.mData );
+		mWriting = false;
+		mFailed = failed;
+		mCondition.notify_all();
+	}
+}
+
+bool OStreamFileAsync::Writer::writeBlock( const uint8_t *data, size_t size, off_t offset )
+{
+	const bool aligned = ( offset % ALIGNMENT == 0 ) && ( size % ALIGNMENT == 0 );
+#if defined( CINDER_MSW )
+	HANDLE handle = mHandle;
+	if( mUnbuffered && ( ! aligned ) ) {
+		if( mBufferedHandle == INVALID_HANDLE_VALUE )
+			mBufferedHandle = ::CreateFileW( mPath.c_str(), GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+		handle = mBufferedHandle;
+		if( handle == INVALID_HANDLE_VALUE )
+			return false;
+	}
+
+	OVERLAPPED overlapped;
+	memset( &overlapped, 0, sizeof(overlapped) );
+	overlapped.Offset = static_cast<DWORD>( offset );
+	DWORD written = 0;
+	return ::WriteFile( handle, data, static_cast<DWORD>( size ), &written, &overlapped ) && ( written == size );
+#else
+	#if defined( O_DIRECT )
+	// O_DIRECT can only be toggled on Linux, and only aligned writes may use it
+	if( mUnbuffered && ( aligned != mDirect ) ) {
+		int flags = ::fcntl( mFd, F_GETFL );
+		if( ( flags != -1 ) && ( ::fcntl( mFd, F_SETFL, aligned ? ( flags | O_DIRECT ) : ( flags & ~O_DIRECT ) ) != -1 ) )
+			mDirect = aligned;
+	}
+	#endif
+	while( size ) {
+		ssize_t written = ::pwrite( mFd, data, size, offset );
+		if( written < 0 ) {
+			if( errno == EINTR )
+				continue;
+			return false;
+		}
+		data += written;
+		size -= written;
+		offset += written;
+	}
+	return true;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// OStreamFileAsync
+OStreamFileAsyncRef OStreamFileAsync::create( const fs::path &path, const Format &format )
+{
+	OStreamFileAsyncRef result( new OStreamFileAsync( format ) );
+	if( ! result->mWriter->open( expandPath( path ) ) )
+		return OStreamFileAsyncRef();
+
+	result->setFileName( path );
+	return result;
+}
+
+OStreamFileAsync::OStreamFileAsync( const Format &format )
+	: OStream(), mFormat( format ), mBlock( NULL ), mBlockSize( 0 ), mBlockOffset( 0 ), mOffset( 0 ), mEnd( 0 )
+{
+	mWriter = std::shared_ptr<Writer>( new Writer( format.getBlockSize(), format.getMaxBlocks(), format.isUnbuffered() ) );
+}
+
+OStreamFileAsync::~OStreamFileAsync()
+{
+	try {
+		close();
+	}
+	catch( ... ) {
+	}
+	if( mDeleteOnDestroy && ( ! mFileName.empty() ) )
+		deleteFile( mFileName );
+}
+
+void OStreamFileAsync::seekAbsolute( off_t absoluteOffset )
+{
+	if( absoluteOffset < 0 )
+		absoluteOffset += mEnd;
+	if( absoluteOffset < 0 )
+		throw StreamExc();
+	if( absoluteOffset == mOffset )
+		return;
+
+	submitBlock();
+	mOffset = absoluteOffset;
+}
+
+void OStreamFileAsync::seekRelative( off_t relativeOffset )
+{
+	seekAbsolute( mOffset + relativeOffset );
+}
+
+void OStreamFileAsync::IOWrite( const void *t, size_t size )
+{
+	if( ! mWriter )
+		throw StreamExc();
+
+	const uint8_t *src = reinterpret_cast<const uint8_t*>( t );
+	while( size ) {
+		if( ! mBlock ) {
+			mBlock = mWriter->acquire();
+			if( ! mBlock )
+				throw StreamExc();
+			mBlockSize = 0;
+			mBlockOffset = mOffset;
+		}
+
+		size_t n = std::min( size, mWriter->mBlockCapacity - mBlockSize );
+		memcpy( mBlock + mBlockSize, src, n );
+		mBlockSize += n;
+		mOffset += static_cast<off_t>( n );
+		src += n;
+		size -= n;
+		if( mBlockSize == mWriter->mBlockCapacity )
+			submitBlock();
+	}
+	mEnd = std::max( mEnd, mOffset );
+}
+
+void OStreamFileAsync::submitBlock()
+{
+	if( mBlock ) {
+		mWriter->submit( mBlock, mBlockSize, mBlockOffset );
+		mBlock = NULL;
+	}
+}
+
+void OStreamFileAsync::flush()
+{
+	if( ! mWriter )
+		return;
+	submitBlock();
+	if( ! mWriter->flush() )
+		throw StreamExc();
+}
+
+void OStreamFileAsync::sync()
+{
+	if( ! mWriter )
+		return;
+	submitBlock();
+	if( ! mWriter->sync() )
+		throw StreamExc();
+}
+
+void OStreamFileAsync::close()
+{
+	if( ! mWriter )
+		return;
+	submitBlock();
+	bool succeeded = mWriter->sync();
+	mWriter.reset();
+	if( ! succeeded )
+		throw StreamExc();
+}
+
+size_t OStreamFileAsync::getBacklog() const
+{
+	return mWriter ? mWriter->getBacklog() : 0;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 // IoStreamFile
 IoStreamFileRef IoStreamFile::create( FILE *file, bool ownsFile, int32_t defaultBufferSize )
@@ -477,27 +1044,48 @@ void IStreamMem::IORead( void *t, size_t size )
 	mOffset += size;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////
+// IStreamMmap
+IStreamMmapRef IStreamMmap::create( const fs::path &path )
+{
+	size_t size = 0;
+	std::shared_ptr<const void> mapping = mapFile( path, &size );
+	if( ! mapping )
+		return IStreamMmapRef();
+	return IStreamMmapRef( new IStreamMmap( mapping, size ) );
+}
+
+IStreamMmapRef IStreamMmap::create( const std::shared_ptr<const void> &mapping, size_t size )
+{
+	return IStreamMmapRef( new IStreamMmap( mapping, size ) );
+}
+
+IStreamMmap::IStreamMmap( const std::shared_ptr<const void> &mapping, size_t size )
+	: IStreamMem( mapping.get(), size ), mMapping( mapping )
+{
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 // OStreamMem
 OStreamMem::OStreamMem( size_t bufferSizeHint )
+	: mStorage( std::max<size_t>( bufferSizeHint, 1 ) ), mOffset( 0 ), mBufferSizeHint( std::max<size_t>( bufferSizeHint, 1 ) )
 {
-	mBuffer = malloc( bufferSizeHint );
-	mDataSize = bufferSizeHint;
-	mOffset = 0;
+	mBuffer = mStorage.getData();
+	mDataSize = mStorage.getAllocatedSize();
 }
 
-OStreamMem::~OStreamMem()
+void OStreamMem::reserve( size_t size )
 {
-	free( mBuffer );
+	if( size > mDataSize ) {
+		mStorage.resize( std::max( size, mDataSize * 2 ) );
+		mBuffer = mStorage.getData();
+		mDataSize = mStorage.getAllocatedSize();
+	}
 }
 
 void OStreamMem::seekAbsolute( off_t absoluteOffset )
 {
-	if( absoluteOffset >= (off_t)mDataSize ) {
-		while( (off_t)mDataSize < absoluteOffset )
-			mDataSize *= 2;
-		mBuffer = realloc( mBuffer, mDataSize );
-	}
+	reserve( (size_t)absoluteOffset );
 	mOffset = absoluteOffset;
 }
 
@@ -508,22 +1096,30 @@ void OStreamMem::seekRelative( off_t relativeOffset )
 
 void OStreamMem::IOWrite( const void *t, size_t size )
 {
-	if( mOffset + size >= mDataSize ) {
-		while( mDataSize < mOffset + size )
-			mDataSize *= 2;
-		mBuffer = realloc( mBuffer, mDataSize );
-	}
+	reserve( mOffset + size );
 	memcpy( ((uint8_t*)mBuffer) + mOffset, t, size );
 	mOffset += size;
 }
 
+Buffer OStreamMem::releaseBuffer()
+{
+	Buffer result = mStorage;
+	result.setDataSize( mOffset );
+
+	mStorage = Buffer( mBufferSizeHint );
+	mBuffer = mStorage.getData();
+	mDataSize = mStorage.getAllocatedSize();
+	mOffset = 0;
+	return result;
+}
+
 /////////////////////////////////////////////////////////////////////
 
-IStreamFileRef loadFileStream( const fs::path &path )
+IStreamFileRef loadFileStream( const fs::path &path, int32_t bufferSize )
 {
 	FILE *f = fopen( path.string().c_str(), "rb" );
 	if( f ) {
-		IStreamFileRef s = IStreamFile::create( f, true );
+		IStreamFileRef s = IStreamFile::create( f, true, bufferSize );
 		s->setFileName( path );
 		return s;
 	}
@@ -531,14 +1127,14 @@ IStreamFileRef loadFileStream( const fs::path &path )
 		return IStreamFileRef();
 }
 
-std::shared_ptr<OStreamFile> writeFileStream( const fs::path &path, bool createParents )
+std::shared_ptr<OStreamFile> writeFileStream( const fs::path &path, bool createParents, size_t bufferSize )
 {
 	if( createParents ) {
 		createDirectories( path.parent_path() );
 	}
 	FILE *f = fopen( expandPath( path ).string().c_str(), "wb" );
 	if( f ) {
-		OStreamFileRef s = OStreamFile::create( f, true );
+		OStreamFileRef s = OStreamFile::create( f, true, bufferSize );
 		s->setFileName( path );
 		return s;
 	}
@@ -546,6 +1142,14 @@ std::shared_ptr<OStreamFile> writeFileStream( const fs::path &path, bool createP
 		return std::shared_ptr<OStreamFile>();
 }
 
+OStreamFileAsyncRef writeFileStreamAsync( const fs::path &path, bool createParents, const OStreamFileAsync::Format &format )
+{
+	// createDirectories() creates the parents of the path it's given
+	if( createParents )
+		createDirectories( path );
+	return OStreamFileAsync::create( path, format );
+}
+
 IoStreamFileRef readWriteFileStream( const fs::path &path )
 {
 	FILE *f = fopen( expandPath( path ).string().c_str(), "w+b" );
@@ -591,16 +1195,10 @@ Buffer loadStreamBuffer( IStreamRef is )
 	}
 	else {
 		const size_t bufferSize = 4096;
-		size_t offset = 0;
-		Buffer result( bufferSize );
-		while( ! is->isEof() ) {
-			if( offset + bufferSize > result.getAllocatedSize() )
-				result.resize( std::max( (size_t)(result.getAllocatedSize() * 1.5f), offset + bufferSize ) );
-			size_t bytesRead = is->readDataAvailable( reinterpret_cast<uint8_t*>( result.getData() ) + offset, bufferSize );
-			offset += bytesRead;
-			result.setDataSize( offset );
-		}
-		return result;
+		BufferBuilder result( bufferSize );
+		while( ! is->isEof() )
+			result.commit( is->readDataAvailable( result.prepare( bufferSize ), bufferSize ) );
+		return result.release();
 	}
 }
 
@@ -614,7 +1212,11 @@ Buffer loadStreamBuffer( IStreamRef is )
 	template void IStream::read<T>( T *t ); \
 	template void IStream::readEndian<T>( T *t, uint8_t endian ); \
 	template void IStream::readBig<T>( T *t ); \
-	template void IStream::readLittle<T>( T *t );
+	template void IStream::readLittle<T>( T *t ); \
+	template void OStream::writeBig<T>( const T *t, size_t count ); \
+	template void OStream::writeLittle<T>( const T *t, size_t count ); \
+	template void IStream::readBig<T>( T *t, size_t count ); \
+	template void IStream::readLittle<T>( T *t, size_t count );
 
 BOOST_PP_SEQ_FOR_EACH( STREAM_PROTOTYPES, ~, (int8_t)(uint8_t)(int16_t)(uint16_t)(int32_t)(uint32_t)(float)(double) )
 
@@ -23,8 +23,14 @@
 #include "cinder/Surface.h"
 #include "cinder/ImageIo.h"
 #include "cinder/ip/Fill.h"
+#include "cinder/Utilities.h"
+#include "cinder/SurfacePool.h"
+#include "cinder/ip/ChannelShuffle.h"
 
 #include <boost/type_traits/is_same.hpp>
+#include <algorithm>
+#include <cstring>
+
 using boost::tribool;
 
 namespace cinder {
@@ -70,6 +76,7 @@ class ImageSourceSurface : public ImageSource {
 			throw; // this surface seems to be a type we've never met
 		mRowBytes = surface.getRowBytes();
 		mData = reinterpret_cast<const uint8_t*>( surface.getData() );
+		setPremultiplied( surface.isPremultiplied() );
 	}
 
 	void load( ImageTargetRef target ) {
@@ -173,9 +180,24 @@ int	SurfaceChannelOrder::getImageIoChannelOrder() const
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // SurfaceT::Obj
+// Beyond this many dirty Areas they're collapsed into their bounds, keeping markDirty() and the number of uploads cheap
+static const size_t MAX_DIRTY_AREAS = 16;
+
+// Returns whether \a a and \a b overlap or share an edge, in which case they're worth merging
+static bool dirtyAreasTouch( const Area &a, const Area &b )
+{
+	return ( a.x1 <= b.x2 ) && ( b.x1 <= a.x2 ) && ( a.y1 <= b.y2 ) && ( b.y1 <= a.y2 );
+}
+
+static Area dirtyAreasUnion( const Area &a, const Area &b )
+{
+	return Area( std::min( a.x1, b.x1 ), std::min( a.y1, b.y1 ), std::max( a.x2, b.x2 ), std::max( a.y2, b.y2 ) );
+}
+
 template<typename T>
 SurfaceT<T>::Obj::Obj( int32_t aWidth, int32_t aHeight, SurfaceChannelOrder aChannelOrder, T *aData, bool aOwnsData, int32_t aRowBytes )
-	: mWidth( aWidth ), mHeight( aHeight ), mChannelOrder( aChannelOrder ), mData( aData ), mOwnsData( aOwnsData ), mRowBytes( aRowBytes ), mIsPremultiplied( false )
+	: mWidth( aWidth ), mHeight( aHeight ), mChannelOrder( aChannelOrder ), mData( aData ), mOwnsData( aOwnsData ), mRowBytes( aRowBytes ), mIsPremultiplied( false ),
+		mTrackedMemory( MemoryTracker::SURFACE ), mParentOffset( Vec2i::zero() ), mTrackDirty( false )
 {
 	mDeallocatorFunc = NULL;
 	initChannels();
@@ -208,6 +230,39 @@ void SurfaceT<T>::Obj::setDeallocator( void(*aDeallocatorFunc)( void * ), void *
 	mDeallocatorRefcon = aDeallocatorRefcon;
 }
 
+template<typename T>
+void SurfaceT<T>::Obj::markDirty( const Area &area )
+{
+	Area dirty = area.getClipBy( Area( 0, 0, mWidth, mHeight ) );
+	if( ( dirty.getWidth() <= 0 ) || ( dirty.getHeight() <= 0 ) )
+		return;
+
+	if( mTrackDirty ) {
+		// absorb every Area the new one touches, rescanning since the union may reach Areas the original didn't
+		Area merged = dirty;
+		for( size_t i = 0; i < mDirtyAreas.size(); ) {
+			if( dirtyAreasTouch( mDirtyAreas[i], merged ) ) {
+				merged = dirtyAreasUnion( mDirtyAreas[i], merged );
+				mDirtyAreas[i] = mDirtyAreas.back();
+				mDirtyAreas.pop_back();
+				i = 0;
+			}
+			else
+				++i;
+		}
+		mDirtyAreas.push_back( merged );
+
+		if( mDirtyAreas.size() > MAX_DIRTY_AREAS ) {
+			for( size_t i = 1; i < mDirtyAreas.size(); ++i )
+				merged = dirtyAreasUnion( mDirtyAreas[i], merged );
+			mDirtyAreas.assign( 1, merged );
+		}
+	}
+
+	if( mParent )
+		mParent->markDirty( dirty + mParentOffset );
+}
+
 template<typename T>
 void SurfaceT<T>::Obj::setChannelOrder( const SurfaceChannelOrder &aChannelOrder )
 {
@@ -227,6 +282,7 @@ SurfaceT<T>::SurfaceT( int32_t aWidth, int32_t aHeight, bool alpha, SurfaceChann
 	int32_t rowBytes = aWidth * sizeof(T) * channelOrder.getPixelInc();
 	T *data = new T[aHeight * rowBytes];
 	mObj = std::shared_ptr<Obj>( new Obj( aWidth, aHeight, channelOrder, data, true, rowBytes ) );
+	mObj->mTrackedMemory.set( aHeight * rowBytes * sizeof(T) );
 }
 
 template<typename T>
@@ -234,8 +290,31 @@ SurfaceT<T>::SurfaceT( int32_t aWidth, int32_t aHeight, bool alpha, const Surfac
 {
 	SurfaceChannelOrder channelOrder = constraints.getChannelOrder( alpha );
 	int32_t rowBytes = constraints.getRowBytes( aWidth, channelOrder, sizeof(T) );
-	T *data = new T[aHeight * rowBytes];
-	mObj = std::shared_ptr<Obj>( new Obj( aWidth, aHeight, channelOrder, data, true, rowBytes ) );
+	if( constraints.getAlignment() > 0 ) {
+		T *data = reinterpret_cast<T*>( alignedMalloc( aHeight * rowBytes, constraints.getAlignment() ) );
+		mObj = std::shared_ptr<Obj>( new Obj( aWidth, aHeight, channelOrder, data, false, rowBytes ) );
+		mObj->setDeallocator( alignedFree, data );
+		mObj->mTrackedMemory.set( aHeight * rowBytes );
+	}
+	else {
+		T *data = new T[aHeight * rowBytes];
+		mObj = std::shared_ptr<Obj>( new Obj( aWidth, aHeight, channelOrder, data, true, rowBytes ) );
+		mObj->mTrackedMemory.set( aHeight * rowBytes * sizeof(T) );
+	}
+}
+
+template<typename T>
+SurfaceT<T>::SurfaceT( int32_t aWidth, int32_t aHeight, bool alpha, SurfaceChannelOrder aChannelOrder, const SurfacePoolRef &pool )
+{
+	SurfaceChannelOrder channelOrder = aChannelOrder;
+	if( channelOrder == SurfaceChannelOrder::UNSPECIFIED )
+		channelOrder = ( alpha ) ? SurfaceChannelOrder::RGBA : SurfaceChannelOrder::RGB;
+	int32_t rowBytes = aWidth * sizeof(T) * channelOrder.getPixelInc();
+	void *refcon;
+	T *data = reinterpret_cast<T*>( pool->allocate( aHeight * rowBytes, &refcon ) );
+	mObj = std::shared_ptr<Obj>( new Obj( aWidth, aHeight, channelOrder, data, false, rowBytes ) );
+	mObj->setDeallocator( SurfacePool::deallocate, refcon );
+	mObj->mTrackedMemory.set( aHeight * rowBytes );
 }
 
 template<typename T>
@@ -272,6 +351,19 @@ SurfaceT<T> SurfaceT<T>::clone( bool copyPixels ) const
 	return result;
 }
 
+template<typename T>
+SurfaceT<T> SurfaceT<T>::getSubSurface( const Area &area ) const
+{
+	Area clipped = area.getClipBy( getBounds() );
+	T *data = const_cast<T*>( getData( clipped.getUL() ) );
+	SurfaceT result;
+	result.mObj = std::shared_ptr<Obj>( new Obj( clipped.getWidth(), clipped.getHeight(), mObj->mChannelOrder, data, false, mObj->mRowBytes ) );
+	result.mObj->mIsPremultiplied = mObj->mIsPremultiplied;
+	result.mObj->mParent = mObj;
+	result.mObj->mParentOffset = clipped.getUL();
+	return result;
+}
+
 template<typename T>
 SurfaceT<T> SurfaceT<T>::clone( const Area &area, bool copyPixels ) const
 {
@@ -307,6 +399,7 @@ void SurfaceT<T>::init( ImageSourceRef imageSource, const SurfaceConstraints &co
 	T *data = new T[height * rowBytes];
 
 	mObj = std::shared_ptr<Obj>( new Obj( width, height, channelOrder, data, true, rowBytes ) );
+	mObj->mTrackedMemory.set( height * rowBytes * sizeof(T) );
 	mObj->mIsPremultiplied = imageSource->isPremultiplied();
 	
 	std::shared_ptr<ImageTargetSurface<T> > target = ImageTargetSurface<T>::createRef( this );
@@ -324,10 +417,28 @@ void SurfaceT<T>::setChannelOrder( const SurfaceChannelOrder &aChannelOrder )
 	mObj->setChannelOrder( aChannelOrder );
 }
 
+namespace {
+
+// Converts as many of the leading pixels of a row as possible with SIMD and returns how many were converted; the caller converts the remainder
+template<typename T>
+int32_t shuffleRowSimd( const ip::ChannelShuffle &shuffle, const T *src, T *dst, int32_t width )
+{
+	return 0;
+}
+
+template<>
+int32_t shuffleRowSimd<uint8_t>( const ip::ChannelShuffle &shuffle, const uint8_t *src, uint8_t *dst, int32_t width )
+{
+	return shuffle.applySimd( src, dst, width );
+}
+
+} // anonymous namespace
+
 template<typename T>
 void SurfaceT<T>::copyFrom( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &relativeOffset )
 {
 	std::pair<Area,Vec2i> srcDst = clippedSrcDst( srcSurface.getBounds(), srcArea, getBounds(), srcArea.getUL() + relativeOffset );
+	markDirty( Area( srcDst.second, srcDst.second + srcDst.first.getSize() ) );
 	
 	if( getChannelOrder() == srcSurface.getChannelOrder() )
 		copyRawSameChannelOrder( srcSurface, srcDst.first, srcDst.second );
@@ -368,11 +479,15 @@ void SurfaceT<T>::copyRawRgba( const SurfaceT<T> &srcSurface, const Area &srcAre
 	uint8_t dstAlpha = getChannelOrder().getAlphaOffset();
 	
 	int32_t width = srcArea.getWidth();
+	ip::ChannelShuffle shuffle( srcSurface.getChannelOrder(), getChannelOrder(), ip::ChannelShuffle::COPY_ALPHA );
 	
 	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
 		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
 		T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * 4 ) + ( y + absoluteOffset.y ) * getRowBytes() );
-		for( int x = 0; x < width; ++x ) {
+		int32_t x = shuffleRowSimd( shuffle, src, dst, width );
+		src += x * 4;
+		dst += x * 4;
+		for( ; x < width; ++x ) {
 			dst[dstRed] = src[srcRed];
 			dst[dstGreen] = src[srcGreen];
 			dst[dstBlue] = src[srcBlue];
@@ -399,11 +514,15 @@ void SurfaceT<T>::copyRawRgbFullAlpha( const SurfaceT<T> &srcSurface, const Area
 	uint8_t dstAlpha = getChannelOrder().getAlphaOffset();
 	
 	int32_t width = srcArea.getWidth();
+	ip::ChannelShuffle shuffle( srcSurface.getChannelOrder(), getChannelOrder(), ip::ChannelShuffle::FILL_ALPHA );
 	
 	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
-		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
+		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * srcPixelInc ) + ( srcArea.y1 + y ) * srcRowBytes );
 		T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * 4 ) + ( y + absoluteOffset.y ) * getRowBytes() );
-		for( int x = 0; x < width; ++x ) {
+		int32_t x = shuffleRowSimd( shuffle, src, dst, width );
+		src += x * srcPixelInc;
+		dst += x * 4;
+		for( ; x < width; ++x ) {
 			dst[dstRed] = src[srcRed];
 			dst[dstGreen] = src[srcGreen];
 			dst[dstBlue] = src[srcBlue];
@@ -429,11 +548,15 @@ void SurfaceT<T>::copyRawRgb( const SurfaceT<T> &srcSurface, const Area &srcArea
 	const uint8_t dstBlue = getChannelOrder().getBlueOffset();
 	
 	int32_t width = srcArea.getWidth();
+	ip::ChannelShuffle shuffle( srcSurface.getChannelOrder(), getChannelOrder(), ip::ChannelShuffle::NO_ALPHA );
 	
 	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
 		const T *src = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + srcArea.x1 * srcPixelInc ) + ( srcArea.y1 + y ) * srcRowBytes );
 		T *dst = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( getData() + absoluteOffset.x * dstPixelInc ) + ( y + absoluteOffset.y ) * getRowBytes() );
-		for( int x = 0; x < width; ++x ) {
+		int32_t x = shuffleRowSimd( shuffle, src, dst, width );
+		src += x * srcPixelInc;
+		dst += x * dstPixelInc;
+		for( ; x < width; ++x ) {
 			dst[dstRed] = src[srcRed];
 			dst[dstGreen] = src[srcGreen];
 			dst[dstBlue] = src[srcBlue];
@@ -470,6 +593,27 @@ ColorT<T> SurfaceT<T>::areaAverage( const Area &area ) const
 	return ColorT<T>( (T)(redSum / ( clipped.getWidth() * clipped.getHeight() )), (T)(greenSum / ( clipped.getWidth() * clipped.getHeight() )), (T)(blueSum / ( clipped.getWidth() * clipped.getHeight() )) );
 }
 
+template<typename T>
+void SurfaceT<T>::setDirtyTracking( bool track )
+{
+	mObj->mTrackDirty = track;
+	mObj->mDirtyAreas.clear();
+	if( track )
+		mObj->mDirtyAreas.push_back( getBounds() );
+}
+
+template<typename T>
+Area SurfaceT<T>::getDirtyBounds() const
+{
+	if( mObj->mDirtyAreas.empty() )
+		return Area( 0, 0, 0, 0 );
+
+	Area result = mObj->mDirtyAreas[0];
+	for( size_t i = 1; i < mObj->mDirtyAreas.size(); ++i )
+		result = dirtyAreasUnion( mObj->mDirtyAreas[i], result );
+	return result;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////
 // ImageTargetSurface
 template<typename T>
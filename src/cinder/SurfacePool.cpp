@@ -0,0 +1,160 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/SurfacePool.h"
+#include "cinder/Utilities.h"
+
+namespace cinder {
+
+namespace {
+
+// Passed as the deallocator refcon of a pooled Surface or Channel; keeps the pool alive for as long as the buffer is in use
+struct PooledBuffer {
+	SurfacePoolRef	mPool;
+	void			*mData;
+	size_t			mSizeClass;
+};
+
+const size_t sMinSizeClass = 4096;
+
+} // anonymous namespace
+
+SurfacePool::SurfacePool( size_t maxCachedBytes )
+	: mCachedBytes( 0 ), mMaxCachedBytes( maxCachedBytes )
+{
+}
+
+SurfacePool::~SurfacePool()
+{
+	trim( 0 );
+}
+
+size_t SurfacePool::calcSizeClass( size_t size )
+{
+	if( size <= sMinSizeClass )
+		return sMinSizeClass;
+
+	// four classes per power of two bounds the wasted space at 25%
+	size_t pow2 = sMinSizeClass;
+	while( pow2 * 2 < size )
+		pow2 *= 2;
+	size_t step = pow2 / 4;
+	return ( size + step - 1 ) / step * step;
+}
+
+void* SurfacePool::allocate( size_t size, void **resultRefcon )
+{
+	size_t sizeClass = calcSizeClass( size );
+	void *data = 0;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		std::map<size_t,std::vector<void*> >::iterator freeIt = mFreeBuffers.find( sizeClass );
+		if( ( freeIt != mFreeBuffers.end() ) && ( ! freeIt->second.empty() ) ) {
+			data = freeIt->second.back();
+			freeIt->second.pop_back();
+			mCachedBytes -= sizeClass;
+		}
+	}
+
+	if( ! data )
+		data = alignedMalloc( sizeClass, 16 );
+
+	PooledBuffer *buffer = new PooledBuffer;
+	buffer->mPool = shared_from_this();
+	buffer->mData = data;
+	buffer->mSizeClass = sizeClass;
+	*resultRefcon = buffer;
+	return data;
+}
+
+void SurfacePool::deallocate( void *refcon )
+{
+	PooledBuffer *buffer = reinterpret_cast<PooledBuffer*>( refcon );
+	buffer->mPool->release( buffer->mData, buffer->mSizeClass );
+	delete buffer;
+}
+
+void SurfacePool::release( void *data, size_t sizeClass )
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		if( mCachedBytes + sizeClass <= mMaxCachedBytes ) {
+			mFreeBuffers[sizeClass].push_back( data );
+			mCachedBytes += sizeClass;
+			return;
+		}
+	}
+
+	alignedFree( data );
+}
+
+size_t SurfacePool::getCachedBytes() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mCachedBytes;
+}
+
+size_t SurfacePool::getMaxCachedBytes() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mMaxCachedBytes;
+}
+
+void SurfacePool::setMaxCachedBytes( size_t maxCachedBytes )
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mMaxCachedBytes = maxCachedBytes;
+	}
+	trim( maxCachedBytes );
+}
+
+void SurfacePool::clear()
+{
+	trim( 0 );
+}
+
+// frees unused buffers, largest first, until no more than maxCachedBytes remain
+void SurfacePool::trim( size_t maxCachedBytes )
+{
+	std::vector<void*> toFree;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		while( ( mCachedBytes > maxCachedBytes ) && ( ! mFreeBuffers.empty() ) ) {
+			std::map<size_t,std::vector<void*> >::iterator lastIt = --mFreeBuffers.end();
+			while( ( mCachedBytes > maxCachedBytes ) && ( ! lastIt->second.empty() ) ) {
+				toFree.push_back( lastIt->second.back() );
+				lastIt->second.pop_back();
+				mCachedBytes -= lastIt->first;
+			}
+			if( lastIt->second.empty() )
+				mFreeBuffers.erase( lastIt );
+		}
+	}
+
+	for( std::vector<void*>::iterator it = toFree.begin(); it != toFree.end(); ++it )
+		alignedFree( *it );
+}
+
+} // namespace cinder
@@ -48,15 +48,18 @@
 	#pragma comment(lib, "IPHLPAPI.lib")
 	namespace cinder {
 		void cpuidwrap( int *p, unsigned int param );
+		void cpuidexwrap( int *p, unsigned int param, unsigned int subParam );
 	}
 #endif
 
 #include <string>
+#include <algorithm>
 using namespace std;
 
 namespace cinder {
 
 std::shared_ptr<System> System::sInstance;
+uint32_t System::sCpuFeatureGeneration = 1;
 
 std::shared_ptr<System> System::instance()
 {
@@ -71,13 +74,23 @@ System::System()
 {
 	for( size_t b = 0; b < TOTAL_CACHE_TYPES; ++b )
 		mCachedValues[b] = false;
+	for( size_t f = 0; f < CPU_FEATURE_COUNT; ++f )
+		mCpuFeatureDisabled[f] = false;
 		
 #if defined( CINDER_MSW )
 	int p[4];
+	cpuidwrap( p, 0 );
+	int maxLeaf = p[0];
 	cpuidwrap( p, 1 );
 	mCPUID_EBX = p[1];
 	mCPUID_ECX = p[2];
 	mCPUID_EDX = p[3];
+	// structured extended feature flags, which include AVX2, live in leaf 7 sub-leaf 0
+	mCPUID7_EBX = 0;
+	if( maxLeaf >= 7 ) {
+		cpuidexwrap( p, 7, 0 );
+		mCPUID7_EBX = p[1];
+	}
 #endif
 }
 
@@ -100,6 +113,40 @@ static std::string getSysCtlString( const std::string &key )
 	return std::string( str.get() );
 }  
 
+// Returns whether the space separated feature list \a key, such as "machdep.cpu.features", contains \a feature
+static bool sysCtlFeaturesContain( const std::string &key, const std::string &feature )
+{
+	try {
+		std::string features = " " + getSysCtlString( key ) + " ";
+		return features.find( " " + feature + " " ) != string::npos;
+	}
+	catch( SystemExcFailedQuery & ) {
+		return false;
+	}
+}
+
+// Integer queries such as "hw.l2cachesize" are 32 or 64 bits depending on the OS version and architecture
+static int64_t getSysCtlInteger( const std::string &key )
+{
+	size_t len = 0;
+	if( sysctlbyname( key.c_str(), NULL, &len, NULL, 0 ) )
+		return 0;
+	if( len == sizeof(int64_t) ) {
+		int64_t val;
+		if( sysctlbyname( key.c_str(), &val, &len, NULL, 0 ) )
+			throw SystemExcFailedQuery();
+		return val;
+	}
+	else if( len == sizeof(int32_t) ) {
+		int32_t val;
+		if( sysctlbyname( key.c_str(), &val, &len, NULL, 0 ) )
+			throw SystemExcFailedQuery();
+		return val;
+	}
+	else
+		throw SystemExcFailedQuery();
+}
+
 template<typename T>  
 static T getSysCtlValue( const std::string &key )
 {
@@ -168,6 +215,55 @@ void cpuidwrap( int * p, unsigned int param )
          }
 }
 
+void cpuidexwrap( int * p, unsigned int param, unsigned int subParam )
+{
+   __asm {
+             mov    edi, p
+             mov    eax, param
+             mov    ecx, subParam
+             cpuid
+             mov    [edi+0d],  eax
+             mov    [edi+4d],  ebx
+             mov    [edi+8d],  ecx
+             mov    [edi+12d], edx
+         }
+}
+
+// Returns the low 32 bits of extended control register \a xcr
+static unsigned int xgetbvwrap( unsigned int xcr )
+{
+   unsigned int result;
+   __asm {
+             mov    ecx, xcr
+             _emit  0x0f // xgetbv, which older assemblers don't know
+             _emit  0x01
+             _emit  0xd0
+             mov    result, eax
+         }
+   return result;
+}
+
+// AVX additionally requires that the OS saves the YMM registers on a context switch, which it signals through OSXSAVE and XCR0
+static bool osSupportsAvx( uint32_t cpuidEcx )
+{
+	if( ( cpuidEcx & ( 1 << 27 ) ) == 0 )
+		return false;
+	return ( xgetbvwrap( 0 ) & 0x6 ) == 0x6;
+}
+
+static std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> getLogicalProcessorInformation()
+{
+	DWORD len = 0;
+	::GetLogicalProcessorInformation( NULL, &len );
+	if( ::GetLastError() != ERROR_INSUFFICIENT_BUFFER )
+		throw SystemExcFailedQuery();
+	std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> result( len / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION) );
+	if( ! ::GetLogicalProcessorInformation( &result[0], &len ) )
+		throw SystemExcFailedQuery();
+	result.resize( len / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION) );
+	return result;
+}
+
 void cpuid( int whichlp, PLOGICALPROCESSORDATA p )
 {
    unsigned int i, j, mask, numbits;
@@ -280,6 +376,20 @@ bool System::hasSse3()
 	return instance()->mHasSSE3;
 }
 
+bool System::hasSsse3()
+{
+	if( ! instance()->mCachedValues[HAS_SSSE3] ) {
+#if defined( CINDER_COCOA )	
+		instance()->mHasSSSE3 = ( getSysCtlValue<int>( "hw.optional.supplementalsse3" ) == 1 );
+#else
+		instance()->mHasSSSE3 = ( instance()->mCPUID_ECX & ( 1 << 9 ) ) != 0;
+#endif
+		instance()->mCachedValues[HAS_SSSE3] = true;
+	}
+	
+	return instance()->mHasSSSE3;
+}
+
 bool System::hasSse4_1()
 {
 	if( ! instance()->mCachedValues[HAS_SSE4_1] ) {
@@ -322,6 +432,80 @@ bool System::hasX86_64()
 	return instance()->mHasX86_64;
 }
 
+bool System::hasF16c()
+{
+	if( ! instance()->mCachedValues[HAS_F16C] ) {
+#if defined( CINDER_COCOA )	
+		try {
+			instance()->mHasF16C = getSysCtlString( "machdep.cpu.features" ).find( "F16C" ) != string::npos;
+		}
+		catch( SystemExcFailedQuery & ) {
+			instance()->mHasF16C = false;
+		}
+#else
+		instance()->mHasF16C = ( instance()->mCPUID_ECX & ( 1 << 29 ) ) != 0 && hasAvx();
+#endif
+		instance()->mCachedValues[HAS_F16C] = true;
+	}
+	
+	return instance()->mHasF16C;
+}
+
+bool System::hasAvx()
+{
+	if( ! instance()->mCachedValues[HAS_AVX] ) {
+#if defined( CINDER_COCOA )	
+		instance()->mHasAVX = ( getSysCtlValue<int>( "hw.optional.avx1_0" ) == 1 ) || 
+			( sysCtlFeaturesContain( "machdep.cpu.features", "AVX1.0" ) && sysCtlFeaturesContain( "machdep.cpu.features", "OSXSAVE" ) );
+#else
+		instance()->mHasAVX = ( instance()->mCPUID_ECX & ( 1 << 28 ) ) != 0 && osSupportsAvx( instance()->mCPUID_ECX );
+#endif
+		instance()->mCachedValues[HAS_AVX] = true;
+	}
+	
+	return instance()->mHasAVX;
+}
+
+bool System::hasAvx2()
+{
+	if( ! instance()->mCachedValues[HAS_AVX2] ) {
+#if defined( CINDER_COCOA )	
+		instance()->mHasAVX2 = ( getSysCtlValue<int>( "hw.optional.avx2_0" ) == 1 ) || 
+			( sysCtlFeaturesContain( "machdep.cpu.leaf7_features", "AVX2" ) && hasAvx() );
+#else
+		instance()->mHasAVX2 = ( instance()->mCPUID7_EBX & ( 1 << 5 ) ) != 0 && hasAvx();
+#endif
+		instance()->mCachedValues[HAS_AVX2] = true;
+	}
+	
+	return instance()->mHasAVX2;
+}
+
+bool System::hasFma()
+{
+	if( ! instance()->mCachedValues[HAS_FMA] ) {
+#if defined( CINDER_COCOA )	
+		instance()->mHasFMA = ( getSysCtlValue<int>( "hw.optional.fma" ) == 1 ) || 
+			( sysCtlFeaturesContain( "machdep.cpu.features", "FMA" ) && hasAvx() );
+#else
+		instance()->mHasFMA = ( instance()->mCPUID_ECX & ( 1 << 12 ) ) != 0 && hasAvx();
+#endif
+		instance()->mCachedValues[HAS_FMA] = true;
+	}
+	
+	return instance()->mHasFMA;
+}
+
+bool System::hasNeon()
+{
+	// every ARM target we build for requires NEON, and no x86 system supports it
+#if defined( __ARM_NEON__ ) || defined( _M_ARM )
+	return true;
+#else
+	return false;
+#endif
+}
+
 int System::getNumCpus()
 {
 	if( ! instance()->mCachedValues[PHYSICAL_CPUS] ) {
@@ -378,6 +562,109 @@ int System::getNumCores()
 	return instance()->mLogicalCPUs;
 }
 
+void System::cacheCpuTopology()
+{
+	System *sys = instance().get();
+	if( sys->mCachedValues[CPU_TOPOLOGY] )
+		return;
+
+	int numLogical = getNumCores();
+	for( int level = 0; level < 3; ++level )
+		sys->mCacheSizes[level] = 0;
+	sys->mCacheLineSize = 0;
+	sys->mLogicalToPhysicalCore.assign( numLogical, 0 );
+#if defined( CINDER_COCOA )
+	sys->mCacheSizes[0] = (int)getSysCtlInteger( "hw.l1dcachesize" );
+	sys->mCacheSizes[1] = (int)getSysCtlInteger( "hw.l2cachesize" );
+	sys->mCacheSizes[2] = (int)getSysCtlInteger( "hw.l3cachesize" );
+	sys->mCacheLineSize = (int)getSysCtlInteger( "hw.cachelinesize" );
+	sys->mPhysicalCores = getSysCtlValue<int>( "hw.physicalcpu" );
+	if( sys->mPhysicalCores <= 0 )
+		sys->mPhysicalCores = numLogical;
+	// Darwin doesn't expose the mapping, but numbers the hyperthreads of a core consecutively
+	int threadsPerCore = std::max( numLogical / sys->mPhysicalCores, 1 );
+	for( int l = 0; l < numLogical; ++l )
+		sys->mLogicalToPhysicalCore[l] = std::min( l / threadsPerCore, sys->mPhysicalCores - 1 );
+#else
+	std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info = getLogicalProcessorInformation();
+	sys->mPhysicalCores = 0;
+	for( std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION>::const_iterator infoIt = info.begin(); infoIt != info.end(); ++infoIt ) {
+		if( infoIt->Relationship == RelationProcessorCore ) {
+			for( int l = 0; l < numLogical && l < (int)( sizeof(ULONG_PTR) * 8 ); ++l ) {
+				if( infoIt->ProcessorMask & ( ULONG_PTR(1) << l ) )
+					sys->mLogicalToPhysicalCore[l] = sys->mPhysicalCores;
+			}
+			++sys->mPhysicalCores;
+		}
+		else if( infoIt->Relationship == RelationCache ) {
+			const CACHE_DESCRIPTOR &cache = infoIt->Cache;
+			if( cache.Level >= 1 && cache.Level <= 3 && ( cache.Type == CacheData || cache.Type == CacheUnified ) ) {
+				sys->mCacheSizes[cache.Level - 1] = cache.Size;
+				sys->mCacheLineSize = cache.LineSize;
+			}
+		}
+	}
+	if( sys->mPhysicalCores == 0 )
+		sys->mPhysicalCores = numLogical;
+#endif
+	sys->mCachedValues[CPU_TOPOLOGY] = true;
+}
+
+int System::getNumPhysicalCores()
+{
+	cacheCpuTopology();
+	return instance()->mPhysicalCores;
+}
+
+const std::vector<int>& System::getLogicalToPhysicalCoreMap()
+{
+	cacheCpuTopology();
+	return instance()->mLogicalToPhysicalCore;
+}
+
+int System::getCacheSize( int level )
+{
+	if( level < 1 || level > 3 )
+		return 0;
+	cacheCpuTopology();
+	return instance()->mCacheSizes[level - 1];
+}
+
+int System::getCacheLineSize()
+{
+	cacheCpuTopology();
+	return instance()->mCacheLineSize;
+}
+
+bool System::hasCpuFeature( CpuFeature feature )
+{
+	if( feature < CPU_GENERIC || feature >= CPU_FEATURE_COUNT || instance()->mCpuFeatureDisabled[feature] )
+		return false;
+
+	switch( feature ) {
+		case CPU_GENERIC:	return true;
+		case CPU_SSE2:		return hasSse2();
+		case CPU_SSE3:		return hasSse3();
+		case CPU_SSSE3:		return hasSsse3();
+		case CPU_SSE4_1:	return hasSse4_1();
+		case CPU_SSE4_2:	return hasSse4_2();
+		case CPU_AVX:		return hasAvx();
+		case CPU_F16C:		return hasF16c();
+		case CPU_FMA:		return hasFma();
+		case CPU_AVX2:		return hasAvx2();
+		case CPU_NEON:		return hasNeon();
+		default:			return false;
+	}
+}
+
+void System::setCpuFeatureEnabled( CpuFeature feature, bool enable )
+{
+	if( feature <= CPU_GENERIC || feature >= CPU_FEATURE_COUNT )
+		return;
+	instance()->mCpuFeatureDisabled[feature] = ! enable;
+	++sCpuFeatureGeneration;
+}
+
 int System::getOsMajorVersion()
 {
 	if( ! instance()->mCachedValues[OS_MAJOR] ) {
@@ -24,6 +24,7 @@
 #include "cinder/ip/Fill.h"
 #include "cinder/ip/Premultiply.h"
 #include "cinder/Utilities.h"
+#include "cinder/Thread.h"
 
 #if defined( CINDER_COCOA )
 	#include "cinder/cocoa/CinderCocoa.h"
@@ -45,7 +46,9 @@
 #endif
 
 #include <boost/noncopyable.hpp>
+#include <boost/thread/tss.hpp>
 #include <limits.h>
+#include <map>
 using namespace std;
 
 static const float MAX_SIZE = 1000000.0f;
@@ -59,25 +62,32 @@ class TextManager : private boost::noncopyable
  public:
 	TextManager();
 	~TextManager();
+	//! Returns the calling thread's TextManager, since GDI and GDI+ objects can't be shared between threads
 	static TextManager*		instance();
 
 #if defined( CINDER_MAC )
 #elif defined( CINDER_MSW )
-	HDC					getDc() { return mDummyDC; }
-	Gdiplus::Graphics*	getGraphics() { return mGraphics; }
+	HDC						getDc() { return mDummyDC; }
+	Gdiplus::Graphics*		getGraphics() { return mGraphics; }
+	//! Returns \a font's GDI+ font on the first thread to use text, and a private copy of it on any other thread
+	const Gdiplus::Font*	getGdiplusFont( const Font &font );
 #endif
 
  private:
-	static TextManager	*sInstance;
-
 #if defined( CINDER_MAC )
 #elif defined( CINDER_MSW )
 	HDC					mDummyDC;
 	Gdiplus::Graphics	*mGraphics;
+	bool				mPrimary;
+	// the Fonts are retained so that their HFONTs can't be recycled while their copies are cached
+	map<HFONT,pair<Font,shared_ptr<Gdiplus::Font> > >	mThreadFonts;
 #endif
 };
 
-TextManager *TextManager::sInstance = 0;
+static boost::thread_specific_ptr<TextManager> sThreadTextManager;
+#if defined( CINDER_MSW )
+static bool sPrimaryTextManagerCreated = false;
+#endif
 
 TextManager::TextManager()
 {
@@ -85,6 +95,8 @@ TextManager::TextManager()
 #elif defined( CINDER_MSW )
 	mDummyDC = ::CreateCompatibleDC( 0 );
 	mGraphics = new Gdiplus::Graphics( mDummyDC );
+	mPrimary = ! sPrimaryTextManagerCreated;
+	sPrimaryTextManagerCreated = true;
 #endif
 }
 
@@ -92,18 +104,37 @@ TextManager::~TextManager()
 {
 #if defined( CINDER_MAC )
 #elif defined( CINDER_MSW )
+	mThreadFonts.clear();
+	delete mGraphics;
 	::DeleteDC( mDummyDC );
 #endif
 }
 
 TextManager* TextManager::instance()
 {
-	if( ! TextManager::sInstance )
-		TextManager::sInstance = new TextManager;
+	TextManager *result = sThreadTextManager.get();
+	if( ! result ) {
+		result = new TextManager;
+		sThreadTextManager.reset( result );
+	}
 		
-	return TextManager::sInstance;
+	return result;
 }
 
+#if defined( CINDER_MSW )
+const Gdiplus::Font* TextManager::getGdiplusFont( const Font &font )
+{
+	if( mPrimary )
+		return font.getGdiplusFont();
+
+	map<HFONT,pair<Font,shared_ptr<Gdiplus::Font> > >::iterator fontIt = mThreadFonts.find( font.getHfont() );
+	if( fontIt == mThreadFonts.end() )
+		fontIt = mThreadFonts.insert( make_pair( font.getHfont(), make_pair( font, shared_ptr<Gdiplus::Font>( new Gdiplus::Font( mDummyDC, font.getHfont() ) ) ) ) ).first;
+
+	return fontIt->second.second.get();
+}
+#endif
+
 ////////////////////////////////////////////////////////////////////////////////////////
 // Run
 struct Run {
@@ -133,7 +164,7 @@ class Line {
 	Line();
 	~Line();
 
-	void addRun( const Run &run ) { mRuns.push_back( run ); }
+	void addRun( const Run &run ) { mRuns.push_back( run ); mExtentsValid = false; }
 
 	void calcExtents();
 #if defined( CINDER_COCOA )
@@ -149,6 +180,7 @@ class Line {
 	float				mHeight, mWidth;
 	float				mLeadingOffset;
 	float				mDescent, mLeading, mAscent;
+	bool				mExtentsValid; // the layout is kept until another run is added
 #if defined( CINDER_COCOA )
 	CTLineRef			mCTLineRef;
 #endif
@@ -160,6 +192,7 @@ Line::Line()
 	mCTLineRef = 0;
 #endif
 	mLeadingOffset = 0;
+	mExtentsValid = false;
 }
 
 Line::~Line()
@@ -173,7 +206,13 @@ Line::~Line()
  // sets the line's mWidth, mHeight, mAscent, mDescent, mLeading
 void Line::calcExtents()
 {
+	if( mExtentsValid )
+		return;
+
 #if defined( CINDER_COCOA )
+	if( mCTLineRef != 0 )
+		::CFRelease( mCTLineRef );
+
 	CFMutableAttributedStringRef attrStr = ::CFAttributedStringCreateMutable( kCFAllocatorDefault, 0 );
 
 	// Defer internal consistency-checking and coalescing until we're done building this thing
@@ -202,7 +241,7 @@ void Line::calcExtents()
 		Gdiplus::StringFormat format;
 		format.SetAlignment( Gdiplus::StringAlignmentNear ); format.SetLineAlignment( Gdiplus::StringAlignmentNear );
 		Gdiplus::RectF sizeRect;
-		const Gdiplus::Font *font = runIt->mFont.getGdiplusFont();
+		const Gdiplus::Font *font = TextManager::instance()->getGdiplusFont( runIt->mFont );
 		TextManager::instance()->getGraphics()->MeasureString( &runIt->mWideText[0], -1, font, Gdiplus::PointF( 0, 0 ), &format, &sizeRect );
 		
 		runIt->mWidth = sizeRect.Width;
@@ -219,6 +258,7 @@ void Line::calcExtents()
 #endif
 
 	mHeight = std::max( mHeight, mAscent + mDescent + mLeading );
+	mExtentsValid = true;
 }
 
 #if defined( CINDER_COCOA )
@@ -243,7 +283,7 @@ void Line::render( Gdiplus::Graphics *graphics, float currentY, float xBorder, f
 	else if( mJustification == RIGHT )
 		currentX = maxWidth - mWidth - xBorder;
 	for( vector<Run>::const_iterator runIt = mRuns.begin(); runIt != mRuns.end(); ++runIt ) {
-		const Gdiplus::Font *font = runIt->mFont.getGdiplusFont();;
+		const Gdiplus::Font *font = TextManager::instance()->getGdiplusFont( runIt->mFont );
 		ColorA8u nativeColor( runIt->mColor );
 		Gdiplus::SolidBrush brush( Gdiplus::Color( nativeColor.a, nativeColor.r, nativeColor.g, nativeColor.b ) );
 		graphics->DrawString( &runIt->mWideText[0], -1, font, Gdiplus::PointF( currentX, currentY + (mAscent - runIt->mAscent) ), &brush );
@@ -421,6 +461,95 @@ Surface	TextLayout::render( bool useAlpha, bool premultiplied )
 }
 
 
+AsyncTextRenderRef TextLayout::renderAsync( bool useAlpha, bool premultiplied ) const
+{
+	// the copy gets its own Lines, since rendering caches each Line's extents and platform layout
+	TextLayout layout( *this );
+	for( deque<shared_ptr<Line> >::iterator lineIt = layout.mLines.begin(); lineIt != layout.mLines.end(); ++lineIt ) {
+		shared_ptr<Line> line( new Line() );
+		line->mRuns = (*lineIt)->mRuns;
+		line->mJustification = (*lineIt)->mJustification;
+		line->mLeadingOffset = (*lineIt)->mLeadingOffset;
+		*lineIt = line;
+	}
+
+	return AsyncTextRender::start( std::bind( &TextLayout::render, layout, useAlpha, premultiplied ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// AsyncTextRender
+struct AsyncTextRender::Obj {
+	Obj() : mReady( false ), mFailed( false ) {}
+
+	std::mutex				mMutex;
+	std::condition_variable	mReadyCond;
+	bool					mReady, mFailed;
+	Surface					mSurface;
+};
+
+AsyncTextRender::AsyncTextRender()
+	: mObj( new Obj )
+{
+}
+
+bool AsyncTextRender::isReady() const
+{
+	std::lock_guard<std::mutex> lock( mObj->mMutex );
+	return mObj->mReady;
+}
+
+bool AsyncTextRender::hasFailed() const
+{
+	std::lock_guard<std::mutex> lock( mObj->mMutex );
+	return mObj->mReady && mObj->mFailed;
+}
+
+void AsyncTextRender::wait() const
+{
+	std::unique_lock<std::mutex> lock( mObj->mMutex );
+	while( ! mObj->mReady )
+		mObj->mReadyCond.wait( lock );
+}
+
+Surface AsyncTextRender::getSurface() const
+{
+	std::unique_lock<std::mutex> lock( mObj->mMutex );
+	while( ! mObj->mReady )
+		mObj->mReadyCond.wait( lock );
+	return mObj->mSurface;
+}
+
+AsyncTextRenderRef AsyncTextRender::start( const std::function<Surface()> &renderFn )
+{
+	// the first thread to use text keeps sharing each Font's platform objects, later ones make their own
+	TextManager::instance();
+
+	AsyncTextRenderRef result( new AsyncTextRender );
+	std::thread renderThread( std::bind( &AsyncTextRender::threadFn, result, renderFn ) );
+	renderThread.detach();
+	return result;
+}
+
+void AsyncTextRender::threadFn( AsyncTextRenderRef result, std::function<Surface()> renderFn )
+{
+	ThreadSetup threadSetup;
+
+	Surface surface;
+	bool failed = false;
+	try {
+		surface = renderFn();
+	}
+	catch( ... ) {
+		failed = true;
+	}
+
+	std::lock_guard<std::mutex> lock( result->mObj->mMutex );
+	result->mObj->mSurface = surface;
+	result->mObj->mReady = true;
+	result->mObj->mFailed = failed;
+	result->mObj->mReadyCond.notify_all();
+}
+
 #if defined( CINDER_COCOA_TOUCH )
 Surface renderStringPow2( const string &str, const Font &font, const ColorA &color, Vec2i *actualSize, float *baselineOffset )
 {
@@ -523,29 +652,218 @@ Surface renderString( const string &str, const Font &font, const ColorA &color,
 #endif
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// TextBox
+// TextBoxLayout
+// The result of laying out a TextBox's text. It's independent of the TextBox's colors, so it's shared by every TextBox with the same text, Font, size, alignment and ligation
+class TextBoxLayout : private boost::noncopyable {
+  public:
+	TextBoxLayout( const TextBox &box );
+
+	// fills mGlyphs the first time the glyph placements are requested
+	void	measureGlyphs( const TextBox &box );
+
+	struct Key {
+		Key( const TextBox &box );
+
+		bool operator<( const Key &rhs ) const;
+
+		string				mText, mFontName;
+		float				mFontSize;
+		Vec2i				mSize;
+		TextBox::Alignment	mAlign;
+		bool				mLigate;
+	};
+
+	Vec2f							mCalculatedSize;
+	bool							mGlyphsMeasured;
+	vector<pair<uint16_t,Vec2f> >	mGlyphs;
 #if defined( CINDER_COCOA )
-void TextBox::createLines() const
+	vector<pair<shared_ptr<const __CTLine>,Vec2f> >	mLines;
+#elif defined( CINDER_MSW )
+	wstring							mWideText;
+#endif
+};
+
+TextBoxLayout::Key::Key( const TextBox &box )
+	: mText( box.getText() ), mFontName( box.getFont().getName() ), mFontSize( box.getFont().getSize() ), mSize( box.getSize() ),
+	mAlign( box.getAlignment() ), mLigate( box.getLigate() )
+{
+}
+
+bool TextBoxLayout::Key::operator<( const Key &rhs ) const
+{
+	if( mText != rhs.mText ) return mText < rhs.mText;
+	if( mFontName != rhs.mFontName ) return mFontName < rhs.mFontName;
+	if( mFontSize != rhs.mFontSize ) return mFontSize < rhs.mFontSize;
+	if( mSize.x != rhs.mSize.x ) return mSize.x < rhs.mSize.x;
+	if( mSize.y != rhs.mSize.y ) return mSize.y < rhs.mSize.y;
+	if( mAlign != rhs.mAlign ) return mAlign < rhs.mAlign;
+	return ( ! mLigate ) && rhs.mLigate;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TextBoxLayoutCache
+// Retains the most recently used TextBoxLayouts so that TextBoxes which are recreated each frame, such as gl::TextureFont's, skip the platform layout
+class TextBoxLayoutCache : private boost::noncopyable {
+  public:
+	TextBoxLayoutCache() : mMaxLayouts( 128 ), mUseCount( 0 ) {}
+	static TextBoxLayoutCache*	instance();
+
+	shared_ptr<TextBoxLayout>	find( const TextBoxLayout::Key &key );
+	void						add( const TextBoxLayout::Key &key, const shared_ptr<TextBoxLayout> &layout );
+
+	void						setMaxLayouts( size_t maxLayouts );
+	void						clear();
+
+  private:
+	struct Entry {
+		shared_ptr<TextBoxLayout>	mLayout;
+		uint32_t					mLastUsed;
+	};
+
+	static TextBoxLayoutCache		*sInstance;
+
+	std::mutex						mMutex;
+	map<TextBoxLayout::Key,Entry>	mEntries;
+	size_t							mMaxLayouts;
+	uint32_t						mUseCount;
+};
+
+TextBoxLayoutCache *TextBoxLayoutCache::sInstance = 0;
+
+TextBoxLayoutCache* TextBoxLayoutCache::instance()
+{
+	if( ! TextBoxLayoutCache::sInstance )
+		TextBoxLayoutCache::sInstance = new TextBoxLayoutCache;
+
+	return TextBoxLayoutCache::sInstance;
+}
+
+shared_ptr<TextBoxLayout> TextBoxLayoutCache::find( const TextBoxLayout::Key &key )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	map<TextBoxLayout::Key,Entry>::iterator entryIt = mEntries.find( key );
+	if( entryIt == mEntries.end() )
+		return shared_ptr<TextBoxLayout>();
+
+	entryIt->second.mLastUsed = ++mUseCount;
+	return entryIt->second.mLayout;
+}
+
+void TextBoxLayoutCache::add( const TextBoxLayout::Key &key, const shared_ptr<TextBoxLayout> &layout )
 {
-	if( ! mInvalid )
+	std::lock_guard<std::mutex> lock( mMutex );
+	if( mMaxLayouts == 0 )
 		return;
 
+	// evict the least recently used layout to make room; TextBoxes still holding it keep it alive
+	if( mEntries.size() >= mMaxLayouts ) {
+		map<TextBoxLayout::Key,Entry>::iterator oldestIt = mEntries.begin();
+		for( map<TextBoxLayout::Key,Entry>::iterator entryIt = mEntries.begin(); entryIt != mEntries.end(); ++entryIt ) {
+			if( entryIt->second.mLastUsed < oldestIt->second.mLastUsed )
+				oldestIt = entryIt;
+		}
+		mEntries.erase( oldestIt );
+	}
+
+	Entry &entry = mEntries[key];
+	entry.mLayout = layout;
+	entry.mLastUsed = ++mUseCount;
+}
+
+void TextBoxLayoutCache::clear()
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mEntries.clear();
+}
+
+void TextBoxLayoutCache::setMaxLayouts( size_t maxLayouts )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mMaxLayouts = maxLayouts;
+	while( mEntries.size() > mMaxLayouts ) {
+		map<TextBoxLayout::Key,Entry>::iterator oldestIt = mEntries.begin();
+		for( map<TextBoxLayout::Key,Entry>::iterator entryIt = mEntries.begin(); entryIt != mEntries.end(); ++entryIt ) {
+			if( entryIt->second.mLastUsed < oldestIt->second.mLastUsed )
+				oldestIt = entryIt;
+		}
+		mEntries.erase( oldestIt );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// TextBox
+TextBoxLayout& TextBox::getLayout() const
+{
+	if( mInvalid || ( ! mLayout ) ) {
+		TextBoxLayout::Key key( *this );
+		mLayout = TextBoxLayoutCache::instance()->find( key );
+		if( ! mLayout ) {
+			mLayout = shared_ptr<TextBoxLayout>( new TextBoxLayout( *this ) );
+			TextBoxLayoutCache::instance()->add( key, mLayout );
+		}
+		mInvalid = false;
+	}
+
+	return *mLayout;
+}
+
+Vec2f TextBox::measure() const
+{
+	return getLayout().mCalculatedSize;
+}
+
+const vector<pair<uint16_t,Vec2f> >& TextBox::getGlyphPlacements() const
+{
+	TextBoxLayout &layout = getLayout();
+	if( ! layout.mGlyphsMeasured )
+		layout.measureGlyphs( *this );
+
+	return layout.mGlyphs;
+}
+
+vector<pair<uint16_t,Vec2f> > TextBox::measureGlyphs() const
+{
+	return getGlyphPlacements();
+}
+
+void TextBox::setLayoutCacheSize( size_t maxLayouts )
+{
+	TextBoxLayoutCache::instance()->setMaxLayouts( maxLayouts );
+}
+
+void TextBox::clearLayoutCache()
+{
+	TextBoxLayoutCache::instance()->clear();
+}
+
+AsyncTextRenderRef TextBox::renderAsync( Vec2f offset ) const
+{
+	// create the shared layout cache here rather than racing the rendering thread to it
+	TextBoxLayoutCache::instance();
+	return AsyncTextRender::start( std::bind( &TextBox::render, *this, offset ) );
+}
+
+#if defined( CINDER_COCOA )
+TextBoxLayout::TextBoxLayout( const TextBox &box )
+	: mCalculatedSize( Vec2f::zero() ), mGlyphsMeasured( false )
+{
 	CFRange range = CFRangeMake( 0, 0 );
-	CFAttributedStringRef attrStr = cocoa::createCfAttributedString( mText, mFont, mColor, mLigate );
-	if( ! attrStr )
+	CFAttributedStringRef colorStr = cocoa::createCfAttributedString( box.getText(), box.getFont(), ColorA::white(), box.getLigate() );
+	if( ! colorStr )
 		return;
-	CTTypesetterRef typeSetter = ::CTTypesetterCreateWithAttributedString( attrStr );
-
+	// the lines take their color from the context when they're drawn, which keeps the layout independent of the TextBox's color
+	CFMutableAttributedStringRef attrStr = ::CFAttributedStringCreateMutableCopy( kCFAllocatorDefault, 0, colorStr );
+	::CFRelease( colorStr );
 	CFIndex strLength = ::CFAttributedStringGetLength( attrStr );
+	::CFAttributedStringSetAttribute( attrStr, CFRangeMake( 0, strLength ), kCTForegroundColorFromContextAttributeName, kCFBooleanTrue );
+	CTTypesetterRef typeSetter = ::CTTypesetterCreateWithAttributedString( attrStr );
 
-	double maxWidth = ( mSize.x <= 0 ) ? CGFLOAT_MAX : mSize.x;
+	double maxWidth = ( box.getSize().x <= 0 ) ? CGFLOAT_MAX : box.getSize().x;
 
 	float flush = 0;
-	if( mAlign == TextBox::CENTER ) flush = 0.5f;
-	else if( mAlign == TextBox::RIGHT ) flush = 1;
+	if( box.getAlignment() == TextBox::CENTER ) flush = 0.5f;
+	else if( box.getAlignment() == TextBox::RIGHT ) flush = 1;
 
-	mCalculatedSize = Vec2f::zero();
-	mLines.clear();
 	Vec2f lineOffset = Vec2f::zero();
 	while( range.location < strLength ) {
 		CGFloat ascent, descent, leading;
@@ -564,15 +882,10 @@ void TextBox::createLines() const
 
 	::CFRelease( attrStr );
 	::CFRelease( typeSetter );
-  
-	mInvalid = false;
 }
 
-vector<pair<uint16_t,Vec2f> > TextBox::measureGlyphs() const
+void TextBoxLayout::measureGlyphs( const TextBox &box )
 {
-	vector<pair<uint16_t,Vec2f> > result;
-
-	createLines();
 	CFRange range = CFRangeMake( 0, 0 );
 	for( vector<pair<shared_ptr<const __CTLine>,Vec2f> >::const_iterator lineIt = mLines.begin(); lineIt != mLines.end(); ++lineIt ) {
 		CFArrayRef runsArray = ::CTLineGetGlyphRuns( lineIt->first.get() );
@@ -585,25 +898,19 @@ vector<pair<uint16_t,Vec2f> > TextBox::measureGlyphs() const
 			::CTRunGetPositions( runRef, range, points );
 			::CTRunGetGlyphs( runRef, range, glyphBuffer );
 			for( size_t t = 0; t < glyphCount; ++t )			
-				result.push_back( make_pair( glyphBuffer[t], Vec2f( points[t].x, points[t].y ) + lineIt->second ) );
+				mGlyphs.push_back( make_pair( glyphBuffer[t], Vec2f( points[t].x, points[t].y ) + lineIt->second ) );
 		}
 	}
-	
-	return result;
-}
 
-Vec2f TextBox::measure() const
-{
-	createLines();
-	return mCalculatedSize;
+	mGlyphsMeasured = true;
 }
 
 Surface	TextBox::render( Vec2f offset )
 {
-	createLines();
+	const TextBoxLayout &layout = getLayout();
 	
-	float sizeX = ( mSize.x <= 0 ) ? mCalculatedSize.x : mSize.x;
-	float sizeY = ( mSize.y <= 0 ) ? mCalculatedSize.y : mSize.y;
+	float sizeX = ( mSize.x <= 0 ) ? layout.mCalculatedSize.x : mSize.x;
+	float sizeY = ( mSize.y <= 0 ) ? layout.mCalculatedSize.y : mSize.y;
 	sizeX = math<float>::ceil( sizeX );
 	sizeY = math<float>::ceil( sizeY );
 	
@@ -611,8 +918,9 @@ Surface	TextBox::render( Vec2f offset )
 	ip::fill( &result, mBackgroundColor );
 	::CGContextRef cgContext = cocoa::createCgBitmapContext( result );
 	::CGContextSetTextMatrix( cgContext, CGAffineTransformIdentity );
+	::CGContextSetRGBFillColor( cgContext, mColor.r, mColor.g, mColor.b, mColor.a );
 	
-	for( vector<pair<shared_ptr<const __CTLine>,Vec2f> >::const_iterator lineIt = mLines.begin(); lineIt != mLines.end(); ++lineIt ) {
+	for( vector<pair<shared_ptr<const __CTLine>,Vec2f> >::const_iterator lineIt = layout.mLines.begin(); lineIt != layout.mLines.end(); ++lineIt ) {
 		::CGContextSetTextPosition( cgContext, lineIt->second.x + offset.x, sizeY - lineIt->second.y + offset.y );
 		::CTLineDraw( lineIt->first.get(), cgContext );
 	}
@@ -628,94 +936,83 @@ Surface	TextBox::render( Vec2f offset )
 }
 #elif defined( CINDER_MSW )
 
-void TextBox::calculate() const
+TextBoxLayout::TextBoxLayout( const TextBox &box )
+	: mCalculatedSize( Vec2f::zero() ), mGlyphsMeasured( false )
 {
-	if( ! mInvalid )
-		return;
-
-	if( mText.empty() ) {
-		mCalculatedSize = Vec2f::zero();
+	if( box.getText().empty() )
 		return;
-	}
-	mWideText = toUtf16( mText );
+	mWideText = toUtf16( box.getText() );
 
 	Gdiplus::StringFormat format;
 	Gdiplus::StringAlignment align = Gdiplus::StringAlignmentNear;
-	if( mAlign == TextBox::CENTER ) align = Gdiplus::StringAlignmentCenter;
-	else if( mAlign == TextBox::RIGHT ) align = Gdiplus::StringAlignmentFar;
+	if( box.getAlignment() == TextBox::CENTER ) align = Gdiplus::StringAlignmentCenter;
+	else if( box.getAlignment() == TextBox::RIGHT ) align = Gdiplus::StringAlignmentFar;
 	format.SetAlignment( align ); format.SetLineAlignment( align );
-	const Gdiplus::Font *font = mFont.getGdiplusFont();
+	const Gdiplus::Font *font = TextManager::instance()->getGdiplusFont( box.getFont() );
 	Gdiplus::RectF sizeRect( 0, 0, 0, 0 ), outSize;
-	sizeRect.Width = ( mSize.x <= 0 ) ? MAX_SIZE : mSize.x;
-	sizeRect.Height = ( mSize.y <= 0 ) ? MAX_SIZE : mSize.y;
+	sizeRect.Width = ( box.getSize().x <= 0 ) ? MAX_SIZE : box.getSize().x;
+	sizeRect.Height = ( box.getSize().y <= 0 ) ? MAX_SIZE : box.getSize().y;
 	TextManager::instance()->getGraphics()->SetTextRenderingHint( Gdiplus::TextRenderingHintAntiAlias );
 	TextManager::instance()->getGraphics()->MeasureString( &mWideText[0], -1, font, sizeRect, &format, &outSize, NULL, NULL );
 
 	mCalculatedSize.x = outSize.Width;
 	mCalculatedSize.y = outSize.Height;
-
-	mInvalid = false;
 }
 
-Vec2f TextBox::measure() const
-{
-	calculate();
-	return mCalculatedSize;
-}
-
-vector<string> TextBox::calculateLineBreaks() const
+static vector<string> calculateLineBreaks( const TextBox &box )
 {
 	vector<string> result;
+	const string &text = box.getText();
+	if( text.empty() )
+		return result;
 
-	::SelectObject( Font::getGlobalDc(), mFont.getHfont() );
+	// measure every character in one call rather than each candidate line, which made wrapping long paragraphs quadratic
+	HDC dc = Font::getGlobalDc();
+	::SelectObject( dc, box.getFont().getHfont() );
+	std::wstring wideText = toUtf16( text );
+	vector<INT> extents( wideText.length() + 1, 0 );
+	SIZE size;
+	::GetTextExtentExPointW( dc, &wideText[0], (int)wideText.length(), 0, NULL, &extents[1], &size );
+
+	// extents are cumulative per UTF-16 unit; characters beyond the Basic Multilingual Plane take two
+	vector<float> charAdvances;
+	size_t nextByte = 0, unit = 0;
+	for( uint32_t c = nextCharUtf8( text.c_str(), &nextByte, text.length() ); c != 0xFFFF; c = nextCharUtf8( text.c_str(), &nextByte, text.length() ) ) {
+		size_t nextUnit = std::min( unit + ( ( c >= 0x10000 ) ? 2 : 1 ), wideText.length() );
+		charAdvances.push_back( (float)( extents[nextUnit] - extents[unit] ) );
+		unit = nextUnit;
+	}
+	if( charAdvances.empty() )
+		return result;
 
-	vector<string> strings;
 	struct LineProcessor {
 		LineProcessor( vector<string> *strings ) : mStrings( strings ) {}
 		void operator()( const char *line, size_t len ) const { mStrings->push_back( string( line, len ) ); }
 		mutable vector<string> *mStrings;
 	};
-	struct LineMeasure {
-		LineMeasure( int maxWidth, const Font &font ) : mMaxWidth( maxWidth ), mFont( font.getGdiplusFont() ) {}
-		bool operator()( const char *line, size_t len ) const {
-			if( mMaxWidth >= MAX_SIZE ) return true; // too big anyway so just return true
-			Gdiplus::StringFormat format;
-			format.SetAlignment( Gdiplus::StringAlignmentNear );
-			Gdiplus::RectF sizeRect( 0, 0, 0, 0 ), outSize;
-			sizeRect.Width = MAX_SIZE;
-			sizeRect.Height = MAX_SIZE;
-
-			std::wstring ws = toUtf16( string( line, len ) );
-			TextManager::instance()->getGraphics()->MeasureString( &ws[0], -1, mFont, sizeRect, &format, &outSize, NULL, NULL );
-			return outSize.Width <= mMaxWidth;
-		}
-
-		int					mMaxWidth;
-		const Gdiplus::Font	*mFont;
-	};
-	std::function<void(const char *,size_t)> lineFn = LineProcessor( &result );		
-	lineBreakUtf8( mText.c_str(), LineMeasure( ( mSize.x > 0 ) ? mSize.x : MAX_SIZE, mFont ), lineFn );
+	std::function<void(const char *,size_t)> lineFn = LineProcessor( &result );
+	lineBreakUtf8( text.c_str(), &charAdvances[0], ( box.getSize().x > 0 ) ? box.getSize().x : MAX_SIZE, lineFn );
 	
 	return result;
 }
 
-vector<pair<uint16_t,Vec2f> > TextBox::measureGlyphs() const
+void TextBoxLayout::measureGlyphs( const TextBox &box )
 {
-	vector<pair<uint16_t,Vec2f> > result;
-
-	if( mText.empty() )
-		return result;
+	mGlyphsMeasured = true;
+	if( box.getText().empty() )
+		return;
 
 	GCP_RESULTSW gcpResults;
 	WCHAR *glyphIndices = NULL;
 	int *dx = NULL;
 
-	::SelectObject( Font::getGlobalDc(), mFont.getHfont() );
+	const Font &boxFont = box.getFont();
+	::SelectObject( Font::getGlobalDc(), boxFont.getHfont() );
 	
-	vector<string> mLines = calculateLineBreaks();
+	vector<string> lines = calculateLineBreaks( box );
 	
 	float curY = 0;
-	for( vector<string>::const_iterator lineIt = mLines.begin(); lineIt != mLines.end(); ++lineIt ) {
+	for( vector<string>::const_iterator lineIt = lines.begin(); lineIt != lines.end(); ++lineIt ) {
 		std::wstring wideText = toUtf16( *lineIt );
 
 		gcpResults.lStructSize = sizeof (gcpResults);
@@ -743,7 +1040,11 @@ vector<pair<uint16_t,Vec2f> > TextBox::measureGlyphs() const
 
 			if( ! ::GetCharacterPlacementW( Font::getGlobalDc(), &wideText[0], wideText.length(), 0,
 							&gcpResults, GCP_DIACRITIC | GCP_LIGATE | GCP_GLYPHSHAPE | GCP_REORDER ) ) {
-				return vector<pair<uint16_t,Vec2f> >(); // failure
+				// failure
+				free( glyphIndices );
+				free( dx );
+				mGlyphs.clear();
+				return;
 			}
 
 			if( gcpResults.lpDx && gcpResults.lpGlyphs )
@@ -752,33 +1053,35 @@ vector<pair<uint16_t,Vec2f> > TextBox::measureGlyphs() const
 			// Too small a buffer, try again
 			bufferSize += bufferSize / 2;
 			if( bufferSize > INT_MAX) {
-				return vector<pair<uint16_t,Vec2f> >(); // failure
+				// failure
+				free( glyphIndices );
+				free( dx );
+				mGlyphs.clear();
+				return;
 			}
 		}
 
 		int xPos = 0;
 		for( int i = 0; i < gcpResults.nGlyphs; i++ ) {
-			result.push_back( std::make_pair( glyphIndices[i], Vec2f( xPos, curY ) ) );
+			mGlyphs.push_back( std::make_pair( glyphIndices[i], Vec2f( xPos, curY ) ) );
 			xPos += dx[i];
 		}
 
-		curY += mFont.getAscent() + mFont.getDescent();
+		curY += boxFont.getAscent() + boxFont.getDescent();
 	}
 
 	if( glyphIndices )
 		free( glyphIndices );
 	if( dx )
 		free( dx );
-
-	return result;
 }
 
 Surface	TextBox::render( Vec2f offset )
 {
-	calculate();
+	const TextBoxLayout &layout = getLayout();
 	
-	float sizeX = ( mSize.x <= 0 ) ? mCalculatedSize.x : mSize.x;
-	float sizeY = ( mSize.y <= 0 ) ? mCalculatedSize.y : mSize.y;
+	float sizeX = ( mSize.x <= 0 ) ? layout.mCalculatedSize.x : mSize.x;
+	float sizeY = ( mSize.y <= 0 ) ? layout.mCalculatedSize.y : mSize.y;
 	sizeX = math<float>::ceil( sizeX );
 	sizeY = math<float>::ceil( sizeY );
 
@@ -794,7 +1097,7 @@ Surface	TextBox::render( Vec2f offset )
 	// fill the surface with the background color
 	offscreenGraphics->Clear( Gdiplus::Color( (BYTE)(mBackgroundColor.a * 255), (BYTE)(mBackgroundColor.r * 255), 
 			(BYTE)(mBackgroundColor.g * 255), (BYTE)(mBackgroundColor.b * 255) ) );
-	const Gdiplus::Font *font = mFont.getGdiplusFont();;
+	const Gdiplus::Font *font = TextManager::instance()->getGdiplusFont( mFont );
 	ColorA8u nativeColor( mColor );
 	Gdiplus::StringFormat format;
 	Gdiplus::StringAlignment align = Gdiplus::StringAlignmentNear;
@@ -802,7 +1105,8 @@ Surface	TextBox::render( Vec2f offset )
 	else if( mAlign == TextBox::RIGHT ) align = Gdiplus::StringAlignmentFar;
 	format.SetAlignment( align  ); format.SetLineAlignment( align );
 	Gdiplus::SolidBrush brush( Gdiplus::Color( nativeColor.a, nativeColor.r, nativeColor.g, nativeColor.b ) );
-	offscreenGraphics->DrawString( &mWideText[0], -1, font, Gdiplus::RectF( offset.x, offset.y, sizeX, sizeY ), &format, &brush );
+	if( ! layout.mWideText.empty() )
+		offscreenGraphics->DrawString( layout.mWideText.c_str(), -1, font, Gdiplus::RectF( offset.x, offset.y, sizeX, sizeY ), &format, &brush );
 	
 	::GdiFlush();
 
@@ -0,0 +1,211 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/TiledImage.h"
+#include "cinder/ImageTargetBand.h"
+#include "cinder/Surface.h"
+#include "cinder/Xml.h"
+#include "cinder/Utilities.h"
+#include "cinder/ip/Pyramid.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+const char *sDescriptorName = "tiledimage.xml";
+
+/* Writes the tiles of every level from a single pass over the rows of level 0. Each level after the first collects the reduced
+	rows of the level before it into a band of one row of tiles, which is written and reduced in turn as soon as it is full. Since
+	bands start on even rows, each reduces to whole rows of the next level, which is where floor rounding drops any odd last row. */
+class PyramidWriter {
+  public:
+	PyramidWriter( const TiledImage &image )
+		: mImage( image ), mBands( image.getNumLevels() ), mBandStarts( image.getNumLevels(), 0 ), mBandRows( image.getNumLevels(), 0 )
+	{}
+
+	// receives the bands of level 0 from ImageTargetBand8u
+	void	addBand( const Surface8u &band, int32_t startRow )
+	{
+		writeBand( 0, band, startRow );
+		reduceBand( 0, band, startRow );
+	}
+
+	// writes the final partial band of each level, from the largest down so that each feeds the next before it is flushed
+	void	finish()
+	{
+		for( int32_t level = 1; level < mImage.getNumLevels(); ++level )
+			flush( level );
+	}
+
+  private:
+	void	writeBand( int32_t level, const Surface8u &band, int32_t startRow )
+	{
+		const int32_t tileRow = startRow / mImage.getTileSize();
+		const int32_t numCols = mImage.getNumTiles( level ).x;
+		for( int32_t col = 0; col < numCols; ++col ) {
+			Area area = mImage.getTileArea( level, col, tileRow );
+			Surface8u tile( const_cast<uint8_t*>( band.getData( Vec2i( area.x1, 0 ) ) ), area.getWidth(), band.getHeight(), band.getRowBytes(), band.getChannelOrder() );
+			writeImage( mImage.getTilePath( level, col, tileRow ), tile );
+		}
+	}
+
+	void	reduceBand( int32_t level, const Surface8u &band, int32_t startRow )
+	{
+		if( level + 1 >= mImage.getNumLevels() )
+			return;
+
+		// a final band of a single row reduces to nothing, unless the level is only a row tall
+		const int32_t dstStart = startRow / 2;
+		const int32_t rows = std::min( std::max( band.getHeight() / 2, 1 ), mImage.getLevelSize( level + 1 ).y - dstStart );
+		if( rows > 0 )
+			addRows( level + 1, ip::buildPyramid( band, ip::PYRAMID_BOX, 2 )[1], rows );
+	}
+
+	void	addRows( int32_t level, const Surface8u &rows, int32_t numRows )
+	{
+		const int32_t tileSize = mImage.getTileSize();
+		Surface8u &band = mBands[level];
+		if( ! band )
+			band = Surface8u( rows.getWidth(), tileSize, rows.hasAlpha(), rows.getChannelOrder() );
+
+		int32_t copied = 0;
+		while( copied < numRows ) {
+			const int32_t count = std::min( numRows - copied, tileSize - mBandRows[level] );
+			band.copyFrom( rows, Area( 0, copied, rows.getWidth(), copied + count ), Vec2i( 0, mBandRows[level] - copied ) );
+			mBandRows[level] += count;
+			copied += count;
+			if( mBandRows[level] == tileSize )
+				flush( level );
+		}
+	}
+
+	void	flush( int32_t level )
+	{
+		if( mBandRows[level] == 0 )
+			return;
+
+		Surface8u &band = mBands[level];
+		Surface8u filled( band.getData(), band.getWidth(), mBandRows[level], band.getRowBytes(), band.getChannelOrder() );
+		writeBand( level, filled, mBandStarts[level] );
+		reduceBand( level, filled, mBandStarts[level] );
+		mBandStarts[level] += mBandRows[level];
+		mBandRows[level] = 0;
+	}
+
+	const TiledImage		&mImage;
+	vector<Surface8u>		mBands;
+	vector<int32_t>			mBandStarts, mBandRows;
+};
+
+} // anonymous namespace
+
+TiledImage::TiledImage( const fs::path &directory, const Vec2i &size, int32_t tileSize, const string &extension )
+	: mDirectory( directory ), mSize( size ), mTileSize( tileSize ), mExtension( extension )
+{
+	Vec2i levelSize = size;
+	mLevelSizes.push_back( levelSize );
+	while( levelSize.x > 1 || levelSize.y > 1 ) {
+		levelSize = Vec2i( std::max( levelSize.x / 2, 1 ), std::max( levelSize.y / 2, 1 ) );
+		mLevelSizes.push_back( levelSize );
+	}
+}
+
+TiledImageRef TiledImage::load( const fs::path &directory )
+{
+	Vec2i size;
+	int32_t tileSize;
+	string extension;
+	if( ! fs::exists( directory / sDescriptorName ) )
+		throw TiledImageExc( directory, "has no tiledimage.xml" );
+	try {
+		XmlTree descriptor = XmlTree( loadFile( directory / sDescriptorName ) ).getChild( "tiledimage" );
+		size.x = descriptor.getAttributeValue<int32_t>( "width" );
+		size.y = descriptor.getAttributeValue<int32_t>( "height" );
+		tileSize = descriptor.getAttributeValue<int32_t>( "tileSize" );
+		extension = descriptor.getAttributeValue<string>( "extension" );
+	}
+	catch( ... ) {
+		throw TiledImageExc( directory, "has an unreadable tiledimage.xml" );
+	}
+
+	if( size.x <= 0 || size.y <= 0 || tileSize <= 0 || extension.empty() )
+		throw TiledImageExc( directory, "has an invalid tiledimage.xml" );
+
+	return TiledImageRef( new TiledImage( directory, size, tileSize, extension ) );
+}
+
+TiledImageRef TiledImage::write( const fs::path &directory, ImageSourceRef imageSource, int32_t tileSize, const string &extension )
+{
+	if( tileSize < 2 || ( tileSize % 2 ) != 0 )
+		throw TiledImageExc( directory, "requires an even tile size" );
+
+	TiledImageRef result( new TiledImage( directory, Vec2i( imageSource->getWidth(), imageSource->getHeight() ), tileSize, extension ) );
+
+	PyramidWriter writer( *result );
+	ImageTargetBand8uRef target = ImageTargetBand8u::create( imageSource, tileSize, std::bind( &PyramidWriter::addBand, &writer, std::_1, std::_2 ) );
+	imageSource->load( target );
+	target->finalize();
+	writer.finish();
+
+	XmlTree descriptor( "tiledimage", "" );
+	descriptor.setAttribute( "width", result->getWidth() );
+	descriptor.setAttribute( "height", result->getHeight() );
+	descriptor.setAttribute( "tileSize", tileSize );
+	descriptor.setAttribute( "extension", extension );
+	descriptor.write( writeFile( directory / sDescriptorName ) );
+
+	return result;
+}
+
+Vec2i TiledImage::getNumTiles( int32_t level ) const
+{
+	const Vec2i &levelSize = mLevelSizes[level];
+	return Vec2i( ( levelSize.x + mTileSize - 1 ) / mTileSize, ( levelSize.y + mTileSize - 1 ) / mTileSize );
+}
+
+Area TiledImage::getTileArea( int32_t level, int32_t col, int32_t row ) const
+{
+	const Vec2i &levelSize = mLevelSizes[level];
+	return Area( col * mTileSize, row * mTileSize, std::min( ( col + 1 ) * mTileSize, levelSize.x ), std::min( ( row + 1 ) * mTileSize, levelSize.y ) );
+}
+
+fs::path TiledImage::getTilePath( int32_t level, int32_t col, int32_t row ) const
+{
+	return mDirectory / toString( level ) / ( toString( col ) + "_" + toString( row ) + "." + mExtension );
+}
+
+TiledImageExc::TiledImageExc( const fs::path &directory, const string &description )
+{
+	string message = directory.string() + " " + description;
+	strncpy( mMessage, message.c_str(), sizeof(mMessage) );
+	mMessage[sizeof(mMessage) - 1] = 0;
+}
+
+} // namespace cinder
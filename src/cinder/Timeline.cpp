@@ -25,6 +25,8 @@
 #include "cinder/Timeline.h"
 
 #include <vector>
+#include <algorithm>
+#include <limits>
 
 using namespace std;
 
@@ -32,20 +34,29 @@ namespace cinder {
 
 ////////////////////////////////////////////////////////////////////////////////////////
 // Timeline
-typedef std::multimap<void*,TimelineItemRef>::iterator s_iter;
-typedef std::multimap<void*,TimelineItemRef>::const_iterator s_const_iter;
+typedef std::multimap<void*,TimelineItem*,std::less<void*>,TimelineItemPool::Allocator<std::pair<void* const,TimelineItem*> > >	TargetIndex;
+typedef TargetIndex::iterator s_iter;
+typedef TargetIndex::const_iterator s_const_iter;
+typedef std::vector<TimelineItemRef>::iterator s_item_iter;
+typedef std::vector<TimelineItemRef>::const_iterator s_item_const_iter;
+
+// a parallel Timeline with fewer eligible items than this steps everything on the calling thread
+static const size_t MIN_PARALLEL_ITEMS = 1024;
 
 Timeline::Timeline()
-	: TimelineItem( 0, 0, 0, 0 ), mDefaultAutoRemove( true ), mCurrentTime( 0 )
+	: TimelineItem( 0, 0, 0, 0 ), mDefaultAutoRemove( true ), mCurrentTime( 0 ), mParallel( false ), mParallelItemsDirty( true ), mStepReverse( false ),
+		mHasMarkedItems( false ), mIntervalIndex( false ), mIntervalIndexDirty( true ), mLastStepTime( 0 )
 {
 	mUseAbsoluteTime = true;
 }
 
 Timeline::Timeline( const Timeline &rhs )
-	: TimelineItem( rhs ), mDefaultAutoRemove( rhs.mDefaultAutoRemove ), mCurrentTime( rhs.mCurrentTime )
+	: TimelineItem( rhs ), mDefaultAutoRemove( rhs.mDefaultAutoRemove ), mCurrentTime( rhs.mCurrentTime ), mParallel( rhs.mParallel ), mParallelItemsDirty( true ),
+		mStepReverse( false ), mExecutionContext( rhs.mExecutionContext ), mHasMarkedItems( false ), mIntervalIndex( rhs.mIntervalIndex ), mIntervalIndexDirty( true ), mLastStepTime( rhs.mLastStepTime )
 {
-	for( s_const_iter iter = rhs.mItems.begin(); iter != rhs.mItems.end(); ++iter ) {
-		mItems.insert( make_pair( iter->first, iter->second->clone() ) );
+	for( vector<ItemGroup>::const_iterator groupIt = rhs.mItemGroups.begin(); groupIt != rhs.mItemGroups.end(); ++groupIt ) {
+		for( s_item_const_iter iter = groupIt->mItems.begin(); iter != groupIt->mItems.end(); ++iter )
+			storeItem( (*iter)->clone() );
 	}
 }
 
@@ -61,23 +72,188 @@ void Timeline::stepTo( float absoluteTime )
 	mCurrentTime = absoluteTime;
 	
 	eraseMarked();
+
+	if( mIntervalIndex ) {
+		stepIndexedItems( reverse );
+		mLastStepTime = mCurrentTime;
+		eraseMarked();
+		return;
+	}
+
+	bool steppedInParallel = false;
+	if( mParallel ) {
+		if( mParallelItemsDirty )
+			updateParallelItems();
+		if( ! mExecutionContext )
+			mExecutionContext = ip::ExecutionContext::getDefault();
+		if( ( mParallelItems.size() >= MIN_PARALLEL_ITEMS ) && ( mExecutionContext->getNumThreads() > 1 ) ) {
+			mStepReverse = reverse;
+			mExecutionContext->run( Area( 0, 0, 1, (int32_t)mParallelItems.size() ), std::bind( &Timeline::stepParallelItems, this, std::_1 ) );
+			steppedInParallel = true;
+		}
+	}
 	
-	// we need to cache the end(). If a tween's update() fn or similar were to manipulate
-	// the list of items by adding new ones, we'll have invalidated our iterator.
+	// we need to cache the sizes. If a tween's update() fn or similar were to manipulate
+	// the items by adding new ones, the new items shouldn't be stepped until next time.
 	// Deleted items are never removed immediately, but are marked for deletion.
-	s_iter endItem = mItems.end();
-	for( s_iter iter = mItems.begin(); iter != endItem; ++iter ) {
-		iter->second->stepTo( mCurrentTime, reverse );
-		if( iter->second->isComplete() && iter->second->getAutoRemove() )
-			iter->second->mMarkedForRemoval = true;
+	const size_t numGroups = mItemGroups.size();
+	for( size_t g = 0; g < numGroups; ++g ) {
+		const size_t numItems = mItemGroups[g].mItems.size();
+		for( size_t i = 0; i < numItems; ++i ) {
+			TimelineItem *item = mItemGroups[g].mItems[i].get();
+			if( steppedInParallel && item->mSteppedInParallel ) {
+				item->mSteppedInParallel = false;
+				continue;
+			}
+			item->stepTo( mCurrentTime, reverse );
+			if( item->isComplete() && item->getAutoRemove() ) {
+				item->mMarkedForRemoval = true;
+				mHasMarkedItems = true;
+			}
+		}
 	}
+	if( steppedInParallel )
+		mHasMarkedItems = true;
 	
+	mLastStepTime = mCurrentTime;
 	eraseMarked();	
 }
 
+void Timeline::stepParallelItems( const Area &band )
+{
+	for( int32_t i = band.getY1(); i < band.getY2(); ++i ) {
+		TimelineItem *item = mParallelItems[i];
+		// callbacks may have been added since the item became eligible; those items are left to the calling thread
+		item->mSteppedInParallel = item->canStepInParallel();
+		if( item->mSteppedInParallel ) {
+			item->stepTo( mCurrentTime, mStepReverse );
+			if( item->isComplete() && item->getAutoRemove() )
+				item->mMarkedForRemoval = true;
+		}
+	}
+}
+
+void Timeline::updateParallelItems()
+{
+	// items sharing a target have to be stepped in order, so only items with a target of their own are eligible
+	mParallelItems.clear();
+	for( vector<ItemGroup>::const_iterator groupIt = mItemGroups.begin(); groupIt != mItemGroups.end(); ++groupIt ) {
+		for( s_item_const_iter iter = groupIt->mItems.begin(); iter != groupIt->mItems.end(); ++iter ) {
+			void *target = (*iter)->mTarget;
+			(*iter)->mSteppedInParallel = false;
+			if( target && ( mTargetIndex.count( target ) == 1 ) && (*iter)->canStepInParallel() )
+				mParallelItems.push_back( iter->get() );
+		}
+	}
+
+	mParallelItemsDirty = false;
+}
+
+void Timeline::setIntervalIndex( bool enable )
+{
+	mIntervalIndex = enable;
+	mIntervalIndexDirty = true;
+	mHasMarkedItems = true;
+	mIndexedItems.clear();
+	mIndexedMaxEnds.clear();
+	mUnindexedItems.clear();
+	mPendingItems.clear();
+	// every item is stepped once, so that those the playhead has already passed are caught up with it
+	if( enable ) {
+		for( vector<ItemGroup>::const_iterator groupIt = mItemGroups.begin(); groupIt != mItemGroups.end(); ++groupIt )
+			mPendingItems.insert( mPendingItems.end(), groupIt->mItems.begin(), groupIt->mItems.end() );
+	}
+}
+
+void Timeline::updateIntervalIndex()
+{
+	mIndexedItems.clear();
+	mUnindexedItems.clear();
+	uint32_t stepOrder = 0;
+	for( vector<ItemGroup>::const_iterator groupIt = mItemGroups.begin(); groupIt != mItemGroups.end(); ++groupIt ) {
+		for( s_item_const_iter iter = groupIt->mItems.begin(); iter != groupIt->mItems.end(); ++iter ) {
+			TimelineItem *item = iter->get();
+			item->mStepOrder = stepOrder++;
+			if( isIntervalIndexed( item ) ) {
+				IndexedItem indexed = { item->getStartTime(), item->getStartTime() + item->getDuration(), item };
+				mIndexedItems.push_back( indexed );
+			}
+			else
+				mUnindexedItems.push_back( item );
+		}
+	}
+
+	std::sort( mIndexedItems.begin(), mIndexedItems.end() );
+	mIndexedMaxEnds.resize( mIndexedItems.size() );
+	buildIntervalIndex( 0, mIndexedItems.size() );
+	mIntervalIndexDirty = false;
+}
+
+float Timeline::buildIntervalIndex( size_t begin, size_t end )
+{
+	if( begin == end )
+		return -numeric_limits<float>::max();
+
+	const size_t mid = ( begin + end ) / 2;
+	const float maxEnd = std::max( mIndexedItems[mid].mEndTime, std::max( buildIntervalIndex( begin, mid ), buildIntervalIndex( mid + 1, end ) ) );
+	mIndexedMaxEnds[mid] = maxEnd;
+	return maxEnd;
+}
+
+void Timeline::queryIntervalIndex( size_t begin, size_t end, float lo, float hi )
+{
+	while( begin < end ) {
+		const size_t mid = ( begin + end ) / 2;
+		// nothing in this subtree ends late enough
+		if( mIndexedMaxEnds[mid] < lo )
+			return;
+		queryIntervalIndex( begin, mid, lo, hi );
+		// neither this item nor anything after it starts early enough
+		if( mIndexedItems[mid].mStartTime > hi )
+			return;
+		if( mIndexedItems[mid].mEndTime >= lo )
+			mStepItems.push_back( mIndexedItems[mid].mItem );
+		begin = mid + 1;
+	}
+}
+
+void Timeline::stepIndexedItems( bool reverse )
+{
+	if( mIntervalIndexDirty )
+		updateIntervalIndex();
+
+	mStepItems.clear();
+	queryIntervalIndex( 0, mIndexedItems.size(), std::min( mLastStepTime, mCurrentTime ), std::max( mLastStepTime, mCurrentTime ) );
+	mStepItems.insert( mStepItems.end(), mUnindexedItems.begin(), mUnindexedItems.end() );
+	// the pending items are held until the end of the step, as any removed meanwhile are no longer owned by the Timeline
+	vector<TimelineItemRef> pendingItems;
+	pendingItems.swap( mPendingItems );
+	for( s_item_const_iter iter = pendingItems.begin(); iter != pendingItems.end(); ++iter ) {
+		if( ! (*iter)->mMarkedForRemoval )
+			mStepItems.push_back( iter->get() );
+	}
+
+	// items are stepped in the same order as without the index, so that the latest item on a target still wins
+	std::sort( mStepItems.begin(), mStepItems.end(), stepOrderLess );
+	mStepItems.erase( std::unique( mStepItems.begin(), mStepItems.end() ), mStepItems.end() );
+
+	const size_t numItems = mStepItems.size();
+	for( size_t i = 0; i < numItems; ++i ) {
+		TimelineItem *item = mStepItems[i];
+		item->stepTo( mCurrentTime, reverse );
+		if( item->isComplete() && item->getAutoRemove() ) {
+			item->mMarkedForRemoval = true;
+			mHasMarkedItems = true;
+		}
+		// an item behind the playhead which hasn't both started and completed, as happens when it was added there or only stepped in reverse, has to be stepped again
+		else if( isIntervalIndexed( item ) && ( mCurrentTime > item->getEndTime() ) && ! ( item->mHasStarted && item->mComplete ) )
+			mPendingItems.push_back( item->thisRef() );
+	}
+}
+
 CueRef Timeline::add( std::function<void ()> action, float atTime )
 {
-	CueRef newCue( new Cue( action, atTime ) );
+	CueRef newCue( TimelineItemPool::makeRef( new Cue( action, atTime ) ) );
 	newCue->setAutoRemove( mDefaultAutoRemove );
 	insert( newCue );
 	return newCue;
@@ -85,7 +261,15 @@ CueRef Timeline::add( std::function<void ()> action, float atTime )
 
 void Timeline::clear()
 {
-	mItems.clear();	
+	mItemGroups.clear();
+	mTargetIndex.clear();
+	mParallelItems.clear();
+	mParallelItemsDirty = true;
+	mIndexedItems.clear();
+	mIndexedMaxEnds.clear();
+	mUnindexedItems.clear();
+	mPendingItems.clear();
+	mIntervalIndexDirty = true;
 }
 
 void Timeline::appendPingPong()
@@ -93,14 +277,16 @@ void Timeline::appendPingPong()
 	vector<TimelineItemRef> toAppend;
 	
 	float duration = mDuration;
-	for( s_iter iter = mItems.begin(); iter != mItems.end(); ++iter ) {
-		TimelineItemRef cloned = iter->second->cloneReverse();
-		cloned->mStartTime = duration + ( duration - ( cloned->mStartTime + cloned->mDuration ) );
-		toAppend.push_back( cloned );
+	for( vector<ItemGroup>::iterator groupIt = mItemGroups.begin(); groupIt != mItemGroups.end(); ++groupIt ) {
+		for( s_item_iter iter = groupIt->mItems.begin(); iter != groupIt->mItems.end(); ++iter ) {
+			TimelineItemRef cloned = (*iter)->cloneReverse();
+			cloned->mStartTime = duration + ( duration - ( cloned->mStartTime + cloned->mDuration ) );
+			toAppend.push_back( cloned );
+		}
 	}
 	
 	for( vector<TimelineItemRef>::const_iterator appIt = toAppend.begin(); appIt != toAppend.end(); ++appIt ) {
-		mItems.insert( make_pair( (*appIt)->mTarget, *appIt ) );
+		storeItem( *appIt );
 	}
 	
 	setDurationDirty();
@@ -117,85 +303,137 @@ void Timeline::add( TimelineItemRef item )
 {
 	item->mParent = this;
 	item->mStartTime = mCurrentTime;
-	mItems.insert( make_pair( item->mTarget, item ) );
+	storeItem( item );
 	setDurationDirty();
 }
 
 void Timeline::insert( TimelineItemRef item )
 {
 	item->mParent = this;
-	mItems.insert( make_pair( item->mTarget, item ) );
+	storeItem( item );
 	setDurationDirty();
 }
 
+void Timeline::storeItem( const TimelineItemRef &item )
+{
+	const std::type_info &type = typeid( *item );
+	vector<ItemGroup>::iterator groupIt = mItemGroups.begin();
+	while( ( groupIt != mItemGroups.end() ) && ( *groupIt->mType != type ) )
+		++groupIt;
+	if( groupIt == mItemGroups.end() ) {
+		mItemGroups.push_back( ItemGroup() );
+		groupIt = mItemGroups.end() - 1;
+		groupIt->mType = &type;
+	}
+
+	groupIt->mItems.push_back( item );
+	mTargetIndex.insert( make_pair( item->mTarget, item.get() ) );
+	mParallelItemsDirty = true;
+	mIntervalIndexDirty = true;
+	if( mIntervalIndex )
+		mPendingItems.push_back( item );
+}
+
 // remove all items which have been marked for removal
 void Timeline::eraseMarked()
 {
+	// an indexed Timeline skips the pass over every item unless something was marked
+	if( mIntervalIndex && ( ! mHasMarkedItems ) )
+		return;
+	mHasMarkedItems = false;
+
 	bool needRecalc = false;
-	for( s_iter iter = mItems.begin(); iter != mItems.end(); ) {
-		if( iter->second->mMarkedForRemoval ) {
-			mItems.erase( iter++ );
-			needRecalc = true;
+	for( vector<ItemGroup>::iterator groupIt = mItemGroups.begin(); groupIt != mItemGroups.end(); ++groupIt ) {
+		// compact the group, preserving the order of the remaining items
+		s_item_iter dest = groupIt->mItems.begin();
+		for( s_item_iter iter = groupIt->mItems.begin(); iter != groupIt->mItems.end(); ++iter ) {
+			if( (*iter)->mMarkedForRemoval ) {
+				pair<s_iter,s_iter> range = mTargetIndex.equal_range( (*iter)->mTarget );
+				for( s_iter indexIt = range.first; indexIt != range.second; ++indexIt ) {
+					if( indexIt->second == iter->get() ) {
+						mTargetIndex.erase( indexIt );
+						break;
+					}
+				}
+				needRecalc = true;
+			}
+			else {
+				if( dest != iter )
+					*dest = *iter;
+				++dest;
+			}
 		}
-		else
-			++iter;
+		groupIt->mItems.erase( dest, groupIt->mItems.end() );
 	}
 	
-	if( needRecalc )
+	if( needRecalc ) {
+		mParallelItemsDirty = true;
+		mIntervalIndexDirty = true;
 		setDurationDirty();
+	}
 }	
 
 
 float Timeline::calcDuration() const
 {
 	float duration = 0;
-	for( s_const_iter iter = mItems.begin(); iter != mItems.end(); ++iter ) {
+	for( s_const_iter iter = mTargetIndex.begin(); iter != mTargetIndex.end(); ++iter ) {
 		duration = std::max( iter->second->getEndTime(), duration );
 	}
 	
 	return duration;
 }
 
-TimelineItemRef Timeline::find( void *target )
+bool Timeline::hasActiveItems() const
 {
-	s_iter iter = mItems.begin();
-	while( iter != mItems.end() ) {
-		if( iter->second->getTarget() == target )
-			return iter->second;
-		++iter;
+	for( s_const_iter iter = mTargetIndex.begin(); iter != mTargetIndex.end(); ++iter ) {
+		// a nested Timeline is infinite, so it is only as active as its items
+		if( const Timeline *nested = dynamic_cast<const Timeline*>( iter->second ) ) {
+			if( nested->hasActiveItems() )
+				return true;
+		}
+		else if( ! iter->second->isComplete() )
+			return true;
 	}
+
+	return false;
+}
+
+TimelineItemRef Timeline::find( void *target )
+{
+	s_iter iter = mTargetIndex.find( target );
+	if( iter != mTargetIndex.end() )
+		return iter->second->thisRef();
 	
 	return TimelineItemRef(); // failed returns null tween
 }
 
 TimelineItemRef Timeline::findLast( void *target )
 {
-	s_iter result = mItems.end();
-	for( s_iter iter = mItems.begin(); iter != mItems.end(); ++iter ) {
-		if( iter->second->getTarget() == target ) {
-			if( result == mItems.end() )
-				result = iter;
-			else if( iter->second->getStartTime() > result->second->getStartTime() )
-				result = iter;
-		}
+	pair<s_iter,s_iter> range = mTargetIndex.equal_range( target );
+	s_iter result = mTargetIndex.end();
+	for( s_iter iter = range.first; iter != range.second; ++iter ) {
+		if( result == mTargetIndex.end() )
+			result = iter;
+		else if( iter->second->getStartTime() > result->second->getStartTime() )
+			result = iter;
 	}
 	
-	return (result == mItems.end() ) ? TimelineItemRef() : result->second;
+	return (result == mTargetIndex.end() ) ? TimelineItemRef() : result->second->thisRef();
 }
 
 float Timeline::findEndTimeOf( void *target, bool *found )
 {
-	s_iter result = mItems.end();
-	for( s_iter iter = mItems.begin(); iter != mItems.end(); ++iter ) {
-		if( iter->second->getTarget() == target ) {
-			if( result == mItems.end() )
-				result = iter;
-			else if( iter->second->getEndTime() > result->second->getEndTime() )
-				result = iter;
-		}
+	pair<s_iter,s_iter> range = mTargetIndex.equal_range( target );
+	s_iter result = mTargetIndex.end();
+	for( s_iter iter = range.first; iter != range.second; ++iter ) {
+		if( result == mTargetIndex.end() )
+			result = iter;
+		else if( iter->second->getEndTime() > result->second->getEndTime() )
+			result = iter;
 	}
 	
-	if( result != mItems.end() ) {
+	if( result != mTargetIndex.end() ) {
 		if( found )
 			*found = true;
 		return result->second->getEndTime();
@@ -209,9 +447,11 @@ float Timeline::findEndTimeOf( void *target, bool *found )
 
 void Timeline::remove( TimelineItemRef item )
 {
-	for( s_iter iter = mItems.begin(); iter != mItems.end(); ++iter ) {
-		if( iter->second == item ) {
+	pair<s_iter,s_iter> range = mTargetIndex.equal_range( item->mTarget );
+	for( s_iter iter = range.first; iter != range.second; ++iter ) {
+		if( iter->second == item.get() ) {
 			iter->second->mMarkedForRemoval = true;
+			mHasMarkedItems = true;
 			break;
 		}
 	}
@@ -222,9 +462,11 @@ void Timeline::removeTarget( void *target )
 	if( target == 0 )
 		return;
 		
-	pair<s_iter,s_iter> range = mItems.equal_range( target );
-	for( s_iter iter = range.first; iter != range.second; ++iter )
+	pair<s_iter,s_iter> range = mTargetIndex.equal_range( target );
+	for( s_iter iter = range.first; iter != range.second; ++iter ) {
 		iter->second->mMarkedForRemoval = true;
+		mHasMarkedItems = true;
+	}
 
 	setDurationDirty();
 }
@@ -234,7 +476,7 @@ void Timeline::cloneAndReplaceTarget( void *target, void *replacementTarget )
 	if( target == 0 )
 		return;
 
-	pair<s_iter,s_iter> range = mItems.equal_range( target );
+	pair<s_iter,s_iter> range = mTargetIndex.equal_range( target );
 
 	vector<TimelineItemRef> newItems;
 	newItems.reserve( std::distance( range.first, range.second ) );
@@ -244,7 +486,7 @@ void Timeline::cloneAndReplaceTarget( void *target, void *replacementTarget )
 	}
 
 	for( vector<TimelineItemRef>::iterator newItemIt = newItems.begin(); newItemIt != newItems.end(); ++newItemIt )
-		mItems.insert( make_pair( replacementTarget, *newItemIt ) );
+		storeItem( *newItemIt );
 
 	setDurationDirty();
 }
@@ -254,22 +496,26 @@ void Timeline::replaceTarget( void *target, void *replacementTarget )
 	if( target == 0 )
 		return;
 
-	pair<s_iter,s_iter> range = mItems.equal_range( target );
+	pair<s_iter,s_iter> range = mTargetIndex.equal_range( target );
 	for( s_iter iter = range.first; iter != range.second; ) {
 		s_iter oldIter = iter;
 		++iter;
 		oldIter->second->setTarget( replacementTarget );
-		mItems.insert( make_pair( replacementTarget, oldIter->second ) );
-		mItems.erase( oldIter );
+		mTargetIndex.insert( make_pair( replacementTarget, oldIter->second ) );
+		mTargetIndex.erase( oldIter );
 	}
+	mParallelItemsDirty = true;
 }
 
 void Timeline::reset( bool unsetStarted )
 {
 	TimelineItem::reset( unsetStarted );
 	
-	for( s_iter iter = mItems.begin(); iter != mItems.end(); ++iter )
+	for( s_iter iter = mTargetIndex.begin(); iter != mTargetIndex.end(); ++iter ) {
 		iter->second->reset( unsetStarted );
+		if( mIntervalIndex )
+			mPendingItems.push_back( iter->second->thisRef() );
+	}
 }
 
 
@@ -280,23 +526,23 @@ void Timeline::loopStart()
 
 void Timeline::reverse()
 {
-	for( s_iter iter = mItems.begin(); iter != mItems.end(); ++iter )
+	for( s_iter iter = mTargetIndex.begin(); iter != mTargetIndex.end(); ++iter )
 		iter->second->reverse();
 }
 
 TimelineItemRef Timeline::clone() const
 {
-	return TimelineItemRef( new Timeline( *this ) );
+	return TimelineItemPool::makeRef( new Timeline( *this ) );
 }
 
 TimelineItemRef Timeline::cloneReverse() const
 {
 	Timeline *result = new Timeline( *this );
-	for( s_iter iter = result->mItems.begin(); iter != result->mItems.end(); ++iter ) {
+	for( s_iter iter = result->mTargetIndex.begin(); iter != result->mTargetIndex.end(); ++iter ) {
 		iter->second->reverse();
 		iter->second->mStartTime = mDuration + ( mDuration - ( iter->second->mStartTime + iter->second->mDuration ) );		
 	}
-	return TimelineItemRef( result );
+	return TimelineItemPool::makeRef( result );
 }
 
 void Timeline::update( float absTime )
@@ -308,6 +554,10 @@ void Timeline::update( float absTime )
 void Timeline::itemTimeChanged( TimelineItem *item )
 {
 	setDurationDirty();
+	mIntervalIndexDirty = true;
+	// the playhead may already be past the item's new interval
+	if( mIntervalIndex )
+		mPendingItems.push_back( item->thisRef() );
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////
@@ -325,12 +575,12 @@ void Cue::loopStart()
 
 TimelineItemRef Cue::clone() const
 {
-	return TimelineItemRef( new Cue( *this ) );
+	return TimelineItemPool::makeRef( new Cue( *this ) );
 }
 
 TimelineItemRef Cue::cloneReverse() const
 {
-	return TimelineItemRef( new Cue( *this ) );
+	return TimelineItemPool::makeRef( new Cue( *this ) );
 }
 
 } // namespace cinder
\ No newline at end of file
@@ -25,19 +25,96 @@
 #include "cinder/TimelineItem.h"
 #include "cinder/Timeline.h"
 #include "cinder/CinderMath.h"
+#include "cinder/MemoryTracker.h"
+#include "cinder/Thread.h"
 	
 namespace cinder {
 
+////////////////////////////////////////////////////////////////////////////////////////
+// TimelineItemPool
+namespace {
+
+const size_t POOL_GRANULARITY = 16;
+const size_t POOL_NUM_CLASSES = 32; // the largest class holds 512 bytes
+const size_t POOL_SLAB_SIZE = 16 * 1024;
+
+struct FreeBlock {
+	FreeBlock	*mNext;
+};
+
+FreeBlock *sFreeLists[POOL_NUM_CLASSES];
+
+std::mutex& getPoolMutex()
+{
+	static std::mutex sMutex;
+	return sMutex;
+}
+
+} // anonymous namespace
+
+void* TimelineItemPool::allocate( size_t size )
+{
+	// items are counted individually, but only the slabs count towards live bytes, since that's what the pool holds on to
+	if( MemoryTracker::isEnabled() )
+		MemoryTracker::recordAllocation( MemoryTracker::TIMELINE, 0 );
+
+	const size_t sizeClass = ( std::max<size_t>( size, 1 ) - 1 ) / POOL_GRANULARITY;
+	if( sizeClass >= POOL_NUM_CLASSES )
+		return ::operator new( size );
+
+	std::lock_guard<std::mutex> lock( getPoolMutex() );
+	if( ! sFreeLists[sizeClass] ) {
+		// carve a new slab into blocks of this class; slabs are never returned to the heap
+		const size_t blockSize = ( sizeClass + 1 ) * POOL_GRANULARITY;
+		const size_t numBlocks = POOL_SLAB_SIZE / blockSize;
+		char *slab = static_cast<char*>( ::operator new( blockSize * numBlocks ) );
+		if( MemoryTracker::isEnabled() )
+			MemoryTracker::recordAllocation( MemoryTracker::TIMELINE, blockSize * numBlocks, 0 );
+		for( size_t b = 0; b < numBlocks; ++b ) {
+			FreeBlock *block = reinterpret_cast<FreeBlock*>( slab + b * blockSize );
+			block->mNext = sFreeLists[sizeClass];
+			sFreeLists[sizeClass] = block;
+		}
+	}
+
+	FreeBlock *result = sFreeLists[sizeClass];
+	sFreeLists[sizeClass] = result->mNext;
+	return result;
+}
+
+void TimelineItemPool::deallocate( void *ptr, size_t size )
+{
+	if( ! ptr )
+		return;
+
+	if( MemoryTracker::isEnabled() )
+		MemoryTracker::recordFree( MemoryTracker::TIMELINE, 0 );
+
+	const size_t sizeClass = ( std::max<size_t>( size, 1 ) - 1 ) / POOL_GRANULARITY;
+	if( sizeClass >= POOL_NUM_CLASSES ) {
+		::operator delete( ptr );
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock( getPoolMutex() );
+	FreeBlock *block = static_cast<FreeBlock*>( ptr );
+	block->mNext = sFreeLists[sizeClass];
+	sFreeLists[sizeClass] = block;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// TimelineItem
+
 TimelineItem::TimelineItem( class Timeline *parent )
 	: mParent( parent ), mTarget( 0 ), mStartTime( 0 ), mDirtyDuration( false ), mDuration( 0 ), mInvDuration( 0 ), mHasStarted( false ), mHasReverseStarted( false ),
-		mComplete( false ), mReverseComplete( false ), mMarkedForRemoval( false ), mAutoRemove( true ),
+		mComplete( false ), mReverseComplete( false ), mMarkedForRemoval( false ), mAutoRemove( true ), mSteppedInParallel( false ), mStepOrder( 0 ),
 		mInfinite( false ), mLoop( false ), mPingPong( false ), mLastLoopIteration( -1 ), mUseAbsoluteTime( false )
 {
 }
 
 TimelineItem::TimelineItem( Timeline *parent, void *target, float startTime, float duration )
 	: mParent( parent ), mTarget( target ), mStartTime( startTime ), mDirtyDuration( false ), mDuration( std::max( duration, 0.0f ) ), mInvDuration( duration <= 0 ? 0 : (1 / duration) ),
-		mHasStarted( false ), mHasReverseStarted( false ), mComplete( false ), mReverseComplete( false ), mMarkedForRemoval( false ), mAutoRemove( true ),
+		mHasStarted( false ), mHasReverseStarted( false ), mComplete( false ), mReverseComplete( false ), mMarkedForRemoval( false ), mAutoRemove( true ), mSteppedInParallel( false ), mStepOrder( 0 ),
 		mInfinite( false ), mLoop( false ), mPingPong( false ), mLastLoopIteration( -1 ), mUseAbsoluteTime( false )
 {
 }
@@ -45,6 +122,8 @@ TimelineItem::TimelineItem( Timeline *parent, void *target, float startTime, flo
 void TimelineItem::removeSelf()
 {
 	mMarkedForRemoval = true;
+	if( mParent )
+		mParent->remove( thisRef() );
 }
 
 void TimelineItem::stepTo( float newTime, bool reverse )
@@ -21,8 +21,17 @@
 */
 
 #include "cinder/TriMesh.h"
+#include "cinder/CinderMath.h"
+#include "cinder/Utilities.h"
+#include "cinder/ip/ExecutionContext.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <queue>
 
 using std::vector;
+using std::numeric_limits;
 
 namespace cinder {
 
@@ -35,30 +44,45 @@ void TriMesh::clear()
 	mColorsRGB.clear();
 	mColorsRGBA.clear();
 	mTexCoords.clear();
+	mTangents.clear();
 	mIndices.clear();
+	updateTrackedMemory();
 }
 
 void TriMesh::appendVertices( const Vec3f *verts, size_t num )
 {
 	for( size_t v = 0; v < num; ++v )
 		mVertices.push_back( verts[v] );
+	updateTrackedMemory();
 }
 
 void TriMesh::appendVertices( const Vec4d *verts, size_t num )
 {
 	for( size_t v = 0; v < num; ++v )
 		mVertices.push_back( Vec3f( (float)verts[v].x, (float)verts[v].y, (float)verts[v].z ) );
+	updateTrackedMemory();
 }
 
 void TriMesh::appendIndices( uint32_t *indices, size_t num )
 {
 	mIndices.insert( mIndices.end(), indices, indices + num );
+	updateTrackedMemory();
 }
 
 void TriMesh::appendNormals( const Vec4d *normals, size_t num )
 {
 	for( size_t v = 0; v < num; ++v )
 		mNormals.push_back( Vec3f( (float)normals[v].x, (float)normals[v].y, (float)normals[v].z ) );
+	updateTrackedMemory();
+}
+
+void TriMesh::updateTrackedMemory()
+{
+	if( ! MemoryTracker::isEnabled() && ! mTrackedMemory.get() )
+		return;
+
+	mTrackedMemory.set( mVertices.capacity() * sizeof(Vec3f) + mNormals.capacity() * sizeof(Vec3f) + mColorsRGB.capacity() * sizeof(Color)
+		+ mColorsRGBA.capacity() * sizeof(ColorA) + mTexCoords.capacity() * sizeof(Vec2f) + mTangents.capacity() * sizeof(Vec4f) + mIndices.capacity() * sizeof(uint32_t) );
 }
 
 void TriMesh::getTriangleVertices( size_t idx, Vec3f *a, Vec3f *b, Vec3f *c ) const
@@ -97,34 +121,1080 @@ AxisAlignedBox3f TriMesh::calcBoundingBox( const Matrix44f &transform ) const
 	if( mVertices.empty() )
 		return AxisAlignedBox3f( Vec3f::zero(), Vec3f::zero() );
 
+	// transform in chunks so that the batch transform can be used without allocating
+	const size_t CHUNK_SIZE = 256;
+	Vec3f transformed[CHUNK_SIZE];
 	Vec3f min( transform.transformPointAffine( mVertices[0] ) );
 	Vec3f max( min );
-	for( size_t i = 0; i < mVertices.size(); ++i ) {
-		Vec3f v = transform.transformPointAffine( mVertices[i] );
-
-		if( v.x < min.x )
-			min.x = v.x;
-		else if( v.x > max.x )
-			max.x = v.x;
-		if( v.y < min.y )
-			min.y = v.y;
-		else if( v.y > max.y )
-			max.y = v.y;
-		if( v.z < min.z )
-			min.z = v.z;
-		else if( v.z > max.z )
-			max.z = v.z;
+	for( size_t start = 0; start < mVertices.size(); start += CHUNK_SIZE ) {
+		const size_t count = std::min( CHUNK_SIZE, mVertices.size() - start );
+		transformPointsAffine( transform, &mVertices[start], transformed, count );
+		for( size_t i = 0; i < count; ++i ) {
+			const Vec3f &v = transformed[i];
+
+			if( v.x < min.x )
+				min.x = v.x;
+			else if( v.x > max.x )
+				max.x = v.x;
+			if( v.y < min.y )
+				min.y = v.y;
+			else if( v.y > max.y )
+				max.y = v.y;
+			if( v.z < min.z )
+				min.z = v.z;
+			else if( v.z > max.z )
+				max.z = v.z;
+		}
 	}
 
 	return AxisAlignedBox3f( min, max );
 }
 
+namespace {
+
+const size_t MIN_PARALLEL_ELEMENTS = 16384;
+
+// calls \a bandFn for the rows of a 1 x \a count Area, on the threads of \a context when it is worthwhile
+void runInBands( size_t count, const ip::ExecutionContextRef &context, const std::function<void(const Area&)> &bandFn )
+{
+	const Area area( 0, 0, 1, (int32_t)count );
+	if( context && ( count >= MIN_PARALLEL_ELEMENTS ) && ( context->getNumThreads() > 1 ) )
+		context->run( area, bandFn );
+	else
+		bandFn( area );
+}
+
+void calcBoundingBoxBand( const Vec3f *vertices, std::mutex *mutex, AxisAlignedBox3f *result, const Area &band )
+{
+	Vec3f min( vertices[band.y1] ), max( vertices[band.y1] );
+	for( int32_t i = band.y1 + 1; i < band.y2; ++i ) {
+		min.x = std::min( min.x, vertices[i].x ); max.x = std::max( max.x, vertices[i].x );
+		min.y = std::min( min.y, vertices[i].y ); max.y = std::max( max.y, vertices[i].y );
+		min.z = std::min( min.z, vertices[i].z ); max.z = std::max( max.z, vertices[i].z );
+	}
+
+	std::lock_guard<std::mutex> lock( *mutex );
+	result->include( AxisAlignedBox3f( min, max ) );
+}
+
+// Per-vertex attributes are accumulated from per-triangle values in corner order. Serially they are scattered triangle by triangle, while in parallel each
+// vertex gathers from a list of the corners which reference it, kept in the same order, so that both sum identically.
+class VertexAccumulator {
+  public:
+	VertexAccumulator( const vector<uint32_t> &indices, size_t numVertices, const ip::ExecutionContextRef &context )
+		: mIndices( indices ), mNumVertices( numVertices ), mContext( context )
+	{
+		mParallel = context && ( indices.size() >= MIN_PARALLEL_ELEMENTS ) && ( context->getNumThreads() > 1 );
+		if( ! mParallel )
+			return;
+
+		// the corners of vertex v are mCorners[mCornerStart[v]] to mCorners[mCornerStart[v+1]]
+		mCornerStart.assign( numVertices + 1, 0 );
+		for( size_t i = 0; i < indices.size(); ++i )
+			++mCornerStart[indices[i]+1];
+		for( size_t v = 0; v < numVertices; ++v )
+			mCornerStart[v+1] += mCornerStart[v];
+		mCorners.resize( indices.size() );
+		vector<uint32_t> fill( mCornerStart.begin(), mCornerStart.end() - 1 );
+		for( size_t i = 0; i < indices.size(); ++i )
+			mCorners[fill[indices[i]]++] = (uint32_t)i;
+	}
+
+	// sets \a result[v] to the sum of \a faceValues[t] for each triangle t referencing vertex v, scaled by \a cornerWeights[corner] when that is non-NULL
+	template<typename T>
+	void accumulate( const vector<T> &faceValues, const vector<float> *cornerWeights, vector<T> *result ) const
+	{
+		result->assign( mNumVertices, T::zero() );
+		if( mParallel ) {
+			const float *weights = ( cornerWeights ) ? &(*cornerWeights)[0] : NULL;
+			mContext->run( Area( 0, 0, 1, (int32_t)mNumVertices ), std::bind( &VertexAccumulator::gatherBand<T>, this, &faceValues[0], weights, &(*result)[0], std::_1 ) );
+		}
+		else {
+			for( size_t i = 0; i < mIndices.size(); ++i )
+				(*result)[mIndices[i]] += ( cornerWeights ) ? faceValues[i / 3] * (*cornerWeights)[i] : faceValues[i / 3];
+		}
+	}
+
+  private:
+	template<typename T>
+	void gatherBand( const T *faceValues, const float *cornerWeights, T *result, const Area &band ) const
+	{
+		for( int32_t v = band.y1; v < band.y2; ++v ) {
+			T sum = T::zero();
+			for( uint32_t c = mCornerStart[v]; c < mCornerStart[v+1]; ++c )
+				sum += ( cornerWeights ) ? faceValues[mCorners[c] / 3] * cornerWeights[mCorners[c]] : faceValues[mCorners[c] / 3];
+			result[v] = sum;
+		}
+	}
+
+	const vector<uint32_t>		&mIndices;
+	size_t						mNumVertices;
+	ip::ExecutionContextRef		mContext;
+	bool						mParallel;
+	vector<uint32_t>			mCornerStart, mCorners;
+};
+
+// the angle at \a a of the triangle \a a, \a b, \a c
+inline float calcCornerAngle( const Vec3f &a, const Vec3f &b, const Vec3f &c )
+{
+	const float cosAngle = ( b - a ).safeNormalized().dot( ( c - a ).safeNormalized() );
+	return math<float>::acos( constrain( cosAngle, -1.0f, 1.0f ) );
+}
+
+void calcFaceNormalsBand( const Vec3f *vertices, const uint32_t *indices, bool angleWeighted, Vec3f *faceNormals, float *cornerAngles, const Area &band )
+{
+	for( int32_t t = band.y1; t < band.y2; ++t ) {
+		const Vec3f &a = vertices[indices[t*3+0]], &b = vertices[indices[t*3+1]], &c = vertices[indices[t*3+2]];
+		const Vec3f n = ( b - a ).cross( c - a ); // length is twice the area
+		if( angleWeighted ) {
+			faceNormals[t] = n.safeNormalized();
+			cornerAngles[t*3+0] = calcCornerAngle( a, b, c );
+			cornerAngles[t*3+1] = calcCornerAngle( b, c, a );
+			cornerAngles[t*3+2] = calcCornerAngle( c, a, b );
+		}
+		else
+			faceNormals[t] = n;
+	}
+}
+
+void normalizeBand( Vec3f *normals, const Area &band )
+{
+	for( int32_t v = band.y1; v < band.y2; ++v )
+		normals[v].safeNormalize();
+}
+
+void calcFaceTangentsBand( const Vec3f *vertices, const Vec2f *texCoords, const uint32_t *indices, Vec3f *faceTangents, Vec3f *faceBitangents, const Area &band )
+{
+	for( int32_t t = band.y1; t < band.y2; ++t ) {
+		const uint32_t i0 = indices[t*3+0], i1 = indices[t*3+1], i2 = indices[t*3+2];
+		const Vec3f e1 = vertices[i1] - vertices[i0], e2 = vertices[i2] - vertices[i0];
+		const Vec2f uv1 = texCoords[i1] - texCoords[i0], uv2 = texCoords[i2] - texCoords[i0];
+		const float det = uv1.x * uv2.y - uv2.x * uv1.y;
+		if( det == 0 ) { // degenerate texture mapping contributes nothing
+			faceTangents[t] = faceBitangents[t] = Vec3f::zero();
+			continue;
+		}
+		const float r = 1.0f / det;
+		faceTangents[t] = ( e1 * uv2.y - e2 * uv1.y ) * r;
+		faceBitangents[t] = ( e2 * uv1.x - e1 * uv2.x ) * r;
+	}
+}
+
+void orthogonalizeTangentsBand( const Vec3f *normals, const Vec3f *tangents, const Vec3f *bitangents, Vec4f *result, const Area &band )
+{
+	for( int32_t v = band.y1; v < band.y2; ++v ) {
+		const Vec3f &n = normals[v], &t = tangents[v];
+		const Vec3f tangent = ( t - n * n.dot( t ) ).safeNormalized();
+		const float handedness = ( n.cross( t ).dot( bitangents[v] ) < 0 ) ? -1.0f : 1.0f;
+		result[v] = Vec4f( tangent, handedness );
+	}
+}
+
+} // anonymous namespace
+
+AxisAlignedBox3f TriMesh::calcBoundingBox( const ip::ExecutionContextRef &context ) const
+{
+	if( mVertices.empty() )
+		return AxisAlignedBox3f( Vec3f::zero(), Vec3f::zero() );
+
+	AxisAlignedBox3f result( mVertices[0], mVertices[0] );
+	std::mutex mutex;
+	runInBands( mVertices.size(), context, std::bind( &calcBoundingBoxBand, &mVertices[0], &mutex, &result, std::_1 ) );
+	return result;
+}
+
+void TriMesh::recalculateNormals( bool angleWeighted, const ip::ExecutionContextRef &context )
+{
+	const size_t numTriangles = getNumTriangles();
+	if( numTriangles == 0 ) {
+		mNormals.assign( mVertices.size(), Vec3f::zero() );
+		return;
+	}
+
+	vector<Vec3f> faceNormals( numTriangles );
+	vector<float> cornerAngles( ( angleWeighted ) ? numTriangles * 3 : 0 );
+	runInBands( numTriangles, context, std::bind( &calcFaceNormalsBand, &mVertices[0], &mIndices[0], angleWeighted, &faceNormals[0],
+				( angleWeighted ) ? &cornerAngles[0] : NULL, std::_1 ) );
+
+	VertexAccumulator accumulator( mIndices, mVertices.size(), context );
+	accumulator.accumulate( faceNormals, ( angleWeighted ) ? &cornerAngles : NULL, &mNormals );
+	runInBands( mNormals.size(), context, std::bind( &normalizeBand, &mNormals[0], std::_1 ) );
+	updateTrackedMemory();
+}
+
+void TriMesh::recalculateTangents( const ip::ExecutionContextRef &context )
+{
+	const size_t numTriangles = getNumTriangles();
+	if( ( mTexCoords.size() != mVertices.size() ) || ( numTriangles == 0 ) ) {
+		mTangents.clear();
+		return;
+	}
+	if( mNormals.size() != mVertices.size() )
+		recalculateNormals( false, context );
+
+	vector<Vec3f> faceTangents( numTriangles ), faceBitangents( numTriangles );
+	runInBands( numTriangles, context, std::bind( &calcFaceTangentsBand, &mVertices[0], &mTexCoords[0], &mIndices[0], &faceTangents[0], &faceBitangents[0], std::_1 ) );
+
+	vector<Vec3f> tangents, bitangents;
+	VertexAccumulator accumulator( mIndices, mVertices.size(), context );
+	accumulator.accumulate( faceTangents, NULL, &tangents );
+	accumulator.accumulate( faceBitangents, NULL, &bitangents );
+	mTangents.resize( mVertices.size() );
+	runInBands( mVertices.size(), context, std::bind( &orthogonalizeTangentsBand, &mNormals[0], &tangents[0], &bitangents[0], &mTangents[0], std::_1 ) );
+	updateTrackedMemory();
+}
+
+namespace {
+
+// Scoring from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+const float kCacheDecayPower = 1.5f;
+const float kLastTriScore = 0.75f;
+const float kValenceBoostScale = 2.0f;
+const float kValenceBoostPower = 0.5f;
+
+float calcVertexScore( int cachePosition, size_t remainingValence, size_t cacheSize )
+{
+	if( remainingValence == 0 )
+		return -1.0f; // no triangles left to use this vertex
+
+	float score = 0;
+	if( cachePosition >= 0 ) {
+		if( cachePosition < 3 ) // the vertices of the triangle just added score the same regardless of order
+			score = kLastTriScore;
+		else {
+			const float scaler = 1.0f / ( cacheSize - 3 );
+			score = math<float>::pow( 1.0f - ( cachePosition - 3 ) * scaler, kCacheDecayPower );
+		}
+	}
+	// boost vertices with few triangles left, so that lone triangles don't get left behind
+	score += kValenceBoostScale * math<float>::pow( (float)remainingValence, -kValenceBoostPower );
+	return score;
+}
+
+} // anonymous namespace
+
+void TriMesh::optimizeVertexCache( size_t cacheSize )
+{
+	const size_t numTriangles = getNumTriangles();
+	const size_t numVertices = getNumVertices();
+	if( ( numTriangles < 2 ) || ( cacheSize < 4 ) )
+		return;
+
+	// triangle adjacency: the triangles of vertex v are vertexTriangles[vertexTriangleStart[v]] to vertexTriangles[vertexTriangleStart[v+1]]
+	vector<size_t> valence( numVertices, 0 );
+	for( size_t i = 0; i < mIndices.size(); ++i )
+		++valence[mIndices[i]];
+	vector<size_t> vertexTriangleStart( numVertices + 1, 0 );
+	for( size_t v = 0; v < numVertices; ++v )
+		vertexTriangleStart[v+1] = vertexTriangleStart[v] + valence[v];
+	vector<size_t> vertexTriangles( mIndices.size() );
+	vector<size_t> fill( vertexTriangleStart.begin(), vertexTriangleStart.end() - 1 );
+	for( size_t t = 0; t < numTriangles; ++t )
+		for( int c = 0; c < 3; ++c )
+			vertexTriangles[fill[mIndices[t*3+c]]++] = t;
+
+	// remaining valence counts down as triangles are emitted; the adjacency lists are compacted to match
+	vector<size_t> remaining( valence );
+	vector<int> cachePosition( numVertices, -1 );
+	vector<float> vertexScore( numVertices );
+	for( size_t v = 0; v < numVertices; ++v )
+		vertexScore[v] = calcVertexScore( -1, remaining[v], cacheSize );
+	vector<float> triangleScore( numTriangles );
+	for( size_t t = 0; t < numTriangles; ++t )
+		triangleScore[t] = vertexScore[mIndices[t*3+0]] + vertexScore[mIndices[t*3+1]] + vertexScore[mIndices[t*3+2]];
+	vector<bool> emitted( numTriangles, false );
+
+	vector<uint32_t> newIndices;
+	newIndices.reserve( mIndices.size() );
+	vector<uint32_t> cache, newCache;
+	cache.reserve( cacheSize + 3 );
+	newCache.reserve( cacheSize + 3 );
+	size_t scanCursor = 0; // triangles before this have all been emitted
+
+	size_t bestTriangle = 0;
+	for( size_t t = 1; t < numTriangles; ++t )
+		if( triangleScore[t] > triangleScore[bestTriangle] )
+			bestTriangle = t;
+
+	for( size_t emittedCount = 0; emittedCount < numTriangles; ++emittedCount ) {
+		// emit the best triangle and remove it from its vertices' adjacency
+		emitted[bestTriangle] = true;
+		for( int c = 0; c < 3; ++c ) {
+			const uint32_t v = mIndices[bestTriangle*3+c];
+			newIndices.push_back( v );
+			size_t *tris = &vertexTriangles[vertexTriangleStart[v]];
+			for( size_t i = 0; i < remaining[v]; ++i ) {
+				if( tris[i] == bestTriangle ) {
+					std::swap( tris[i], tris[remaining[v]-1] );
+					break;
+				}
+			}
+			--remaining[v];
+		}
+
+		// the triangle's vertices move to the front of the LRU cache, pushing the rest back
+		newCache.clear();
+		for( int c = 0; c < 3; ++c )
+			newCache.push_back( mIndices[bestTriangle*3+c] );
+		for( size_t i = 0; i < cache.size(); ++i ) {
+			const uint32_t v = cache[i];
+			if( ( v != newCache[0] ) && ( v != newCache[1] ) && ( v != newCache[2] ) )
+				newCache.push_back( v );
+		}
+		for( size_t i = cacheSize; i < newCache.size(); ++i ) {
+			cachePosition[newCache[i]] = -1;
+			vertexScore[newCache[i]] = calcVertexScore( -1, remaining[newCache[i]], cacheSize );
+		}
+		if( newCache.size() > cacheSize )
+			newCache.resize( cacheSize );
+		cache.swap( newCache );
+
+		// rescore the cached vertices and their triangles, tracking the best candidate
+		for( size_t i = 0; i < cache.size(); ++i ) {
+			cachePosition[cache[i]] = (int)i;
+			vertexScore[cache[i]] = calcVertexScore( (int)i, remaining[cache[i]], cacheSize );
+		}
+		float bestScore = -1;
+		bestTriangle = numTriangles;
+		for( size_t i = 0; i < cache.size(); ++i ) {
+			const uint32_t v = cache[i];
+			const size_t *tris = &vertexTriangles[vertexTriangleStart[v]];
+			for( size_t j = 0; j < remaining[v]; ++j ) {
+				const size_t t = tris[j];
+				triangleScore[t] = vertexScore[mIndices[t*3+0]] + vertexScore[mIndices[t*3+1]] + vertexScore[mIndices[t*3+2]];
+				if( triangleScore[t] > bestScore ) {
+					bestScore = triangleScore[t];
+					bestTriangle = t;
+				}
+			}
+		}
+
+		// nothing adjacent to the cache is left, so fall back to the next unemitted triangle
+		if( bestTriangle == numTriangles ) {
+			while( ( scanCursor < numTriangles ) && emitted[scanCursor] )
+				++scanCursor;
+			bestTriangle = scanCursor;
+		}
+	}
+
+	mIndices.swap( newIndices );
+}
+
+void TriMesh::optimizeOverdraw( size_t cacheSize )
+{
+	const size_t numTriangles = getNumTriangles();
+	if( numTriangles < 2 )
+		return;
+
+	// Split the triangle order into clusters, following Sander et al's "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw".
+	// A cluster ends wherever every vertex of a triangle misses the cache, or where it is large enough and its own miss ratio is within
+	// kSplitThreshold of the whole mesh's, so that the extra misses caused by splitting there stay small.
+	const float kSplitThreshold = 1.05f;
+	const float meshRatio = calcCacheMissRatio( cacheSize );
+	vector<size_t> clusterStarts;
+	{
+		vector<uint32_t> fifo( cacheSize, numeric_limits<uint32_t>::max() );
+		size_t fifoHead = 0, clusterMisses = 0;
+		for( size_t t = 0; t < numTriangles; ++t ) {
+			int misses = 0;
+			for( int c = 0; c < 3; ++c ) {
+				const uint32_t v = mIndices[t*3+c];
+				if( std::find( fifo.begin(), fifo.end(), v ) == fifo.end() ) {
+					fifo[fifoHead] = v;
+					fifoHead = ( fifoHead + 1 ) % cacheSize;
+					++misses;
+				}
+			}
+			const size_t clusterSize = clusterStarts.empty() ? 0 : t - clusterStarts.back();
+			if( ( t == 0 ) || ( misses == 3 ) || ( ( clusterSize >= cacheSize * 2 ) && ( clusterMisses <= kSplitThreshold * meshRatio * clusterSize ) ) ) {
+				clusterStarts.push_back( t );
+				clusterMisses = 0;
+			}
+			clusterMisses += misses;
+		}
+	}
+	clusterStarts.push_back( numTriangles );
+	if( clusterStarts.size() <= 2 )
+		return;
+
+	// clusters whose area-weighted normal points away from the mesh's centroid are likely to occlude the others
+	Vec3f meshCentroid = Vec3f::zero();
+	for( size_t v = 0; v < mVertices.size(); ++v )
+		meshCentroid += mVertices[v];
+	meshCentroid /= (float)mVertices.size();
+
+	vector<std::pair<float,size_t> > clusterOrder;
+	for( size_t c = 0; c + 1 < clusterStarts.size(); ++c ) {
+		Vec3f centroid = Vec3f::zero(), normal = Vec3f::zero();
+		float area = 0;
+		for( size_t t = clusterStarts[c]; t < clusterStarts[c+1]; ++t ) {
+			Vec3f a, b, cc;
+			getTriangleVertices( t, &a, &b, &cc );
+			const Vec3f n = ( b - a ).cross( cc - a ); // length is twice the area
+			const float triArea = n.length();
+			normal += n;
+			centroid += ( a + b + cc ) * ( triArea / 3.0f );
+			area += triArea;
+		}
+		if( area > 0 )
+			centroid /= area;
+		clusterOrder.push_back( std::make_pair( -( centroid - meshCentroid ).dot( normal.safeNormalized() ), c ) );
+	}
+	std::stable_sort( clusterOrder.begin(), clusterOrder.end() );
+
+	vector<uint32_t> newIndices;
+	newIndices.reserve( mIndices.size() );
+	for( size_t i = 0; i < clusterOrder.size(); ++i ) {
+		const size_t c = clusterOrder[i].second;
+		newIndices.insert( newIndices.end(), mIndices.begin() + clusterStarts[c] * 3, mIndices.begin() + clusterStarts[c+1] * 3 );
+	}
+	mIndices.swap( newIndices );
+}
+
+namespace {
+
+template<typename T>
+void remapVertexAttribute( vector<T> *attribute, const vector<uint32_t> &newIndex )
+{
+	// attributes which aren't per-vertex are left alone
+	if( attribute->size() != newIndex.size() )
+		return;
+	vector<T> result( attribute->size() );
+	for( size_t v = 0; v < newIndex.size(); ++v )
+		result[newIndex[v]] = (*attribute)[v];
+	attribute->swap( result );
+}
+
+} // anonymous namespace
+
+void TriMesh::optimizeVertexFetch()
+{
+	const size_t numVertices = getNumVertices();
+	const uint32_t unassigned = numeric_limits<uint32_t>::max();
+	vector<uint32_t> newIndex( numVertices, unassigned );
+	uint32_t next = 0;
+	for( size_t i = 0; i < mIndices.size(); ++i ) {
+		if( newIndex[mIndices[i]] == unassigned )
+			newIndex[mIndices[i]] = next++;
+		mIndices[i] = newIndex[mIndices[i]];
+	}
+	for( size_t v = 0; v < numVertices; ++v )
+		if( newIndex[v] == unassigned )
+			newIndex[v] = next++;
+
+	remapVertexAttribute( &mVertices, newIndex );
+	remapVertexAttribute( &mNormals, newIndex );
+	remapVertexAttribute( &mColorsRGB, newIndex );
+	remapVertexAttribute( &mColorsRGBA, newIndex );
+	remapVertexAttribute( &mTexCoords, newIndex );
+	remapVertexAttribute( &mTangents, newIndex );
+}
+
+void TriMesh::optimize( size_t cacheSize )
+{
+	optimizeVertexCache( cacheSize );
+	optimizeOverdraw( cacheSize );
+	optimizeVertexFetch();
+}
+
+float TriMesh::calcCacheMissRatio( size_t cacheSize ) const
+{
+	if( mIndices.empty() || ( cacheSize == 0 ) )
+		return 0;
+
+	vector<uint32_t> fifo( cacheSize, numeric_limits<uint32_t>::max() );
+	size_t fifoHead = 0, misses = 0;
+	for( size_t i = 0; i < mIndices.size(); ++i ) {
+		if( std::find( fifo.begin(), fifo.end(), mIndices[i] ) == fifo.end() ) {
+			fifo[fifoHead] = mIndices[i];
+			fifoHead = ( fifoHead + 1 ) % cacheSize;
+			++misses;
+		}
+	}
+	return misses / (float)getNumTriangles();
+}
+
+namespace {
+
+// A symmetric 4x4 quadric from Garland and Heckbert's "Surface Simplification Using Quadric Error Metrics", summing the squared distances to weighted planes
+struct Quadric {
+	Quadric() : mA2( 0 ), mAb( 0 ), mAc( 0 ), mAd( 0 ), mB2( 0 ), mBc( 0 ), mBd( 0 ), mC2( 0 ), mCd( 0 ), mD2( 0 ), mWeight( 0 ) {}
+
+	//! Adds the plane \a normal . p + \a d = 0, scaling its squared distances by \a scale
+	void	addPlane( const Vec3d &normal, double d, double scale )
+	{
+		mA2 += scale * normal.x * normal.x;	mAb += scale * normal.x * normal.y;	mAc += scale * normal.x * normal.z;	mAd += scale * normal.x * d;
+		mB2 += scale * normal.y * normal.y;	mBc += scale * normal.y * normal.z;	mBd += scale * normal.y * d;
+		mC2 += scale * normal.z * normal.z;	mCd += scale * normal.z * d;
+		mD2 += scale * d * d;
+	}
+
+	void	operator+=( const Quadric &rhs )
+	{
+		mA2 += rhs.mA2; mAb += rhs.mAb; mAc += rhs.mAc; mAd += rhs.mAd; mB2 += rhs.mB2; mBc += rhs.mBc; mBd += rhs.mBd; mC2 += rhs.mC2; mCd += rhs.mCd; mD2 += rhs.mD2;
+		mWeight += rhs.mWeight;
+	}
+
+	double	eval( const Vec3f &p ) const
+	{
+		const double x = p.x, y = p.y, z = p.z;
+		return mA2 * x * x + 2 * mAb * x * y + 2 * mAc * x * z + 2 * mAd * x + mB2 * y * y + 2 * mBc * y * z + 2 * mBd * y + mC2 * z * z + 2 * mCd * z + mD2;
+	}
+
+	//! Returns the root of the area weighted mean squared distance of \a p to the triangle planes, so that the error is a distance
+	float	calcError( const Vec3f &p ) const
+	{
+		return ( mWeight > 0 ) ? (float)math<double>::sqrt( std::max( 0.0, eval( p ) ) / mWeight ) : 0;
+	}
+
+	double	mA2, mAb, mAc, mAd, mB2, mBc, mBd, mC2, mCd, mD2;
+	double	mWeight; // the total area of the triangle planes; border planes don't count
+};
+
+// border and seam edges are held in place by planes perpendicular to their triangles, weighted this much more than the triangles themselves
+const double kBorderWeight = 10.0;
+
+struct PositionLess {
+	PositionLess( const vector<Vec3f> &positions ) : mPositions( positions ) {}
+	bool operator()( uint32_t a, uint32_t b ) const
+	{
+		const Vec3f &pa = mPositions[a], &pb = mPositions[b];
+		return ( pa.x < pb.x ) || ( ( pa.x == pb.x ) && ( ( pa.y < pb.y ) || ( ( pa.y == pb.y ) && ( pa.z < pb.z ) ) ) );
+	}
+	const vector<Vec3f>	&mPositions;
+};
+
+// Simplifies by half-edge collapses: a collapse moves every vertex at one position onto the vertex it shares an edge with at a neighboring position.
+// Vertices at the same position, such as those split along seams, form a group which collapses together.
+class Simplifier {
+  public:
+	Simplifier( const vector<Vec3f> &positions, vector<uint32_t> *indices );
+
+	float	run( size_t targetNumTriangles, float maxError );
+
+  private:
+	struct Collapse {
+		float		mError;
+		uint32_t	mFrom, mTo;
+		uint32_t	mFromVersion, mToVersion;
+		// the priority_queue pops the smallest error first
+		bool operator<( const Collapse &rhs ) const { return mError > rhs.mError; }
+	};
+
+	void	pushCollapse( uint32_t from, uint32_t to );
+	void	pushCollapses( uint32_t group );
+	bool	collapse( uint32_t from, uint32_t to );
+	bool	addWedgeMapping( uint32_t from, uint32_t to );
+	int		findCorner( const uint32_t *tri, uint32_t group ) const;
+
+	vector<uint32_t>				&mIndices;
+	vector<uint32_t>				mGroups;			// the group of each vertex
+	vector<Vec3f>					mGroupPositions;
+	vector<Quadric>					mQuadrics;
+	vector<uint32_t>				mVersions;			// bumped as a group's quadric changes, invalidating its queued collapses
+	vector<char>					mCollapsed;
+	vector<vector<uint32_t> >		mGroupTriangles;	// may hold triangles which have since been removed
+	vector<char>					mTriangleAlive;
+	size_t							mNumTriangles;
+	std::priority_queue<Collapse>	mQueue;
+	vector<std::pair<uint32_t,uint32_t> >	mWedgeMap;	// scratch for collapse()
+};
+
+Simplifier::Simplifier( const vector<Vec3f> &positions, vector<uint32_t> *indices )
+	: mIndices( *indices ), mNumTriangles( 0 )
+{
+	const size_t numVertices = positions.size();
+	const size_t numTriangles = mIndices.size() / 3;
+
+	vector<uint32_t> order( numVertices );
+	for( size_t v = 0; v < numVertices; ++v )
+		order[v] = (uint32_t)v;
+	std::sort( order.begin(), order.end(), PositionLess( positions ) );
+	mGroups.resize( numVertices );
+	for( size_t i = 0; i < numVertices; ++i ) {
+		if( ( i == 0 ) || ( positions[order[i]] != positions[order[i-1]] ) )
+			mGroupPositions.push_back( positions[order[i]] );
+		mGroups[order[i]] = (uint32_t)mGroupPositions.size() - 1;
+	}
+
+	const size_t numGroups = mGroupPositions.size();
+	mQuadrics.resize( numGroups );
+	mVersions.assign( numGroups, 0 );
+	mCollapsed.assign( numGroups, 0 );
+	mGroupTriangles.resize( numGroups );
+	mTriangleAlive.assign( numTriangles, 0 );
+
+	vector<uint64_t> edges, directedEdges;
+	for( size_t t = 0; t < numTriangles; ++t ) {
+		const uint32_t *tri = &mIndices[t*3];
+		const uint32_t g0 = mGroups[tri[0]], g1 = mGroups[tri[1]], g2 = mGroups[tri[2]];
+		if( ( g0 == g1 ) || ( g1 == g2 ) || ( g2 == g0 ) ) // already degenerate
+			continue;
+		mTriangleAlive[t] = 1;
+		++mNumTriangles;
+
+		const Vec3d p0( positions[tri[0]] ), p1( positions[tri[1]] ), p2( positions[tri[2]] );
+		Vec3d normal = ( p1 - p0 ).cross( p2 - p0 );
+		const double doubleArea = normal.length();
+		Quadric quadric;
+		if( doubleArea > 0 ) {
+			normal /= doubleArea;
+			quadric.addPlane( normal, -normal.dot( p0 ), doubleArea * 0.5 );
+			quadric.mWeight = doubleArea * 0.5;
+		}
+		for( int c = 0; c < 3; ++c ) {
+			const uint32_t g = mGroups[tri[c]], gNext = mGroups[tri[(c+1)%3]];
+			mQuadrics[g] += quadric;
+			mGroupTriangles[g].push_back( (uint32_t)t );
+			edges.push_back( ( (uint64_t)std::min( g, gNext ) << 32 ) | std::max( g, gNext ) );
+			directedEdges.push_back( ( (uint64_t)tri[c] << 32 ) | tri[(c+1)%3] );
+		}
+	}
+
+	// an edge between vertices with no triangle running the other way is on a border or a seam
+	std::sort( directedEdges.begin(), directedEdges.end() );
+	for( size_t t = 0; t < numTriangles; ++t ) {
+		if( ! mTriangleAlive[t] )
+			continue;
+		const uint32_t *tri = &mIndices[t*3];
+		const Vec3d p0( positions[tri[0]] ), p1( positions[tri[1]] ), p2( positions[tri[2]] );
+		const Vec3d normal = ( p1 - p0 ).cross( p2 - p0 ).safeNormalized();
+		for( int c = 0; c < 3; ++c ) {
+			const uint32_t a = tri[c], b = tri[(c+1)%3];
+			if( std::binary_search( directedEdges.begin(), directedEdges.end(), ( (uint64_t)b << 32 ) | a ) )
+				continue;
+			const Vec3d pa( positions[a] ), edge = Vec3d( positions[b] ) - pa;
+			const Vec3d borderNormal = edge.cross( normal ).safeNormalized();
+			Quadric border;
+			border.addPlane( borderNormal, -borderNormal.dot( pa ), edge.lengthSquared() * kBorderWeight );
+			mQuadrics[mGroups[a]] += border;
+			mQuadrics[mGroups[b]] += border;
+		}
+	}
+
+	std::sort( edges.begin(), edges.end() );
+	edges.erase( std::unique( edges.begin(), edges.end() ), edges.end() );
+	for( size_t e = 0; e < edges.size(); ++e ) {
+		const uint32_t g0 = (uint32_t)( edges[e] >> 32 ), g1 = (uint32_t)( edges[e] & 0xFFFFFFFF );
+		pushCollapse( g0, g1 );
+		pushCollapse( g1, g0 );
+	}
+}
+
+void Simplifier::pushCollapse( uint32_t from, uint32_t to )
+{
+	Quadric quadric( mQuadrics[from] );
+	quadric += mQuadrics[to];
+	Collapse collapse = { quadric.calcError( mGroupPositions[to] ), from, to, mVersions[from], mVersions[to] };
+	mQueue.push( collapse );
+}
+
+void Simplifier::pushCollapses( uint32_t group )
+{
+	vector<uint32_t> neighbors;
+	const vector<uint32_t> &triangles = mGroupTriangles[group];
+	for( size_t i = 0; i < triangles.size(); ++i ) {
+		const uint32_t *tri = &mIndices[triangles[i]*3];
+		for( int c = 0; c < 3; ++c )
+			if( mGroups[tri[c]] != group )
+				neighbors.push_back( mGroups[tri[c]] );
+	}
+	std::sort( neighbors.begin(), neighbors.end() );
+	neighbors.erase( std::unique( neighbors.begin(), neighbors.end() ), neighbors.end() );
+	for( size_t n = 0; n < neighbors.size(); ++n ) {
+		pushCollapse( group, neighbors[n] );
+		pushCollapse( neighbors[n], group );
+	}
+}
+
+int Simplifier::findCorner( const uint32_t *tri, uint32_t group ) const
+{
+	for( int c = 0; c < 3; ++c )
+		if( mGroups[tri[c]] == group )
+			return c;
+	return -1;
+}
+
+bool Simplifier::addWedgeMapping( uint32_t from, uint32_t to )
+{
+	for( size_t w = 0; w < mWedgeMap.size(); ++w ) {
+		if( mWedgeMap[w].first == from )
+			return mWedgeMap[w].second == to; // a vertex which would have to split
+	}
+	mWedgeMap.push_back( std::make_pair( from, to ) );
+	return true;
+}
+
+bool Simplifier::collapse( uint32_t from, uint32_t to )
+{
+	vector<uint32_t> &triangles = mGroupTriangles[from];
+
+	// each vertex of the group follows the edge it shares with a vertex of the other group
+	mWedgeMap.clear();
+	for( size_t i = 0; i < triangles.size(); ++i ) {
+		if( ! mTriangleAlive[triangles[i]] )
+			continue;
+		const uint32_t *tri = &mIndices[triangles[i]*3];
+		const int toCorner = findCorner( tri, to );
+		if( ( toCorner >= 0 ) && ( ! addWedgeMapping( tri[findCorner( tri, from )], tri[toCorner] ) ) )
+			return false;
+	}
+
+	// a vertex with no such edge, such as one on the far side of a seam the edge crosses, would tear the mesh; so would flipping a triangle
+	const Vec3f &target = mGroupPositions[to];
+	for( size_t i = 0; i < triangles.size(); ++i ) {
+		if( ! mTriangleAlive[triangles[i]] )
+			continue;
+		const uint32_t *tri = &mIndices[triangles[i]*3];
+		if( findCorner( tri, to ) >= 0 )
+			continue;
+		const int fromCorner = findCorner( tri, from );
+		bool mapped = false;
+		for( size_t w = 0; ( w < mWedgeMap.size() ) && ( ! mapped ); ++w )
+			mapped = ( mWedgeMap[w].first == tri[fromCorner] );
+		if( ! mapped )
+			return false;
+
+		const Vec3f &p1 = mGroupPositions[mGroups[tri[(fromCorner+1)%3]]], &p2 = mGroupPositions[mGroups[tri[(fromCorner+2)%3]]];
+		const Vec3f before = ( p1 - mGroupPositions[from] ).cross( p2 - mGroupPositions[from] );
+		const Vec3f after = ( p1 - target ).cross( p2 - target );
+		if( ( before.lengthSquared() > 0 ) && ( before.dot( after ) <= 0 ) )
+			return false;
+	}
+
+	// triangles along the edge disappear and the rest move over to the other group
+	vector<uint32_t> &toTriangles = mGroupTriangles[to];
+	for( size_t i = 0; i < triangles.size(); ++i ) {
+		const uint32_t t = triangles[i];
+		if( ! mTriangleAlive[t] )
+			continue;
+		uint32_t *tri = &mIndices[t*3];
+		if( findCorner( tri, to ) >= 0 ) {
+			mTriangleAlive[t] = 0;
+			--mNumTriangles;
+			continue;
+		}
+		const int fromCorner = findCorner( tri, from );
+		for( size_t w = 0; w < mWedgeMap.size(); ++w ) {
+			if( mWedgeMap[w].first == tri[fromCorner] ) {
+				tri[fromCorner] = mWedgeMap[w].second;
+				break;
+			}
+		}
+		toTriangles.push_back( t );
+	}
+	vector<uint32_t>().swap( triangles );
+
+	size_t numAlive = 0;
+	for( size_t i = 0; i < toTriangles.size(); ++i )
+		if( mTriangleAlive[toTriangles[i]] )
+			toTriangles[numAlive++] = toTriangles[i];
+	toTriangles.resize( numAlive );
+
+	mQuadrics[to] += mQuadrics[from];
+	mCollapsed[from] = 1;
+	++mVersions[to];
+	return true;
+}
+
+float Simplifier::run( size_t targetNumTriangles, float maxError )
+{
+	float result = 0;
+	while( ( mNumTriangles > targetNumTriangles ) && ( ! mQueue.empty() ) ) {
+		const Collapse next = mQueue.top();
+		if( next.mError > maxError )
+			break;
+		mQueue.pop();
+		if( mCollapsed[next.mFrom] || mCollapsed[next.mTo] || ( mVersions[next.mFrom] != next.mFromVersion ) || ( mVersions[next.mTo] != next.mToVersion ) )
+			continue; // stale
+		if( ! collapse( next.mFrom, next.mTo ) )
+			continue;
+		result = std::max( result, next.mError );
+		pushCollapses( next.mTo );
+	}
+
+	size_t numIndices = 0;
+	for( size_t t = 0; t < mTriangleAlive.size(); ++t ) {
+		if( mTriangleAlive[t] ) {
+			for( int c = 0; c < 3; ++c )
+				mIndices[numIndices++] = mIndices[t*3+c];
+		}
+	}
+	mIndices.resize( numIndices );
+	return result;
+}
+
+template<typename T>
+void truncateVertexAttribute( vector<T> *attribute, size_t numVertices, size_t newNumVertices )
+{
+	// attributes which aren't per-vertex are left alone
+	if( attribute->size() == numVertices )
+		attribute->resize( newNumVertices );
+}
+
+} // anonymous namespace
+
+float TriMesh::calcSimplifiedIndices( std::vector<uint32_t> *indices, size_t targetNumTriangles, float maxError ) const
+{
+	if( indices->size() / 3 <= targetNumTriangles )
+		return 0;
+
+	Simplifier simplifier( mVertices, indices );
+	return simplifier.run( targetNumTriangles, maxError );
+}
+
+float TriMesh::simplify( size_t targetNumTriangles, float maxError )
+{
+	float result = calcSimplifiedIndices( &mIndices, targetNumTriangles, maxError );
+
+	// optimizeVertexFetch() moves the vertices no triangle references any more to the end
+	optimizeVertexFetch();
+	const size_t numVertices = getNumVertices();
+	size_t numReferenced = 0;
+	for( size_t i = 0; i < mIndices.size(); ++i )
+		numReferenced = std::max<size_t>( numReferenced, mIndices[i] + 1 );
+	truncateVertexAttribute( &mVertices, numVertices, numReferenced );
+	truncateVertexAttribute( &mNormals, numVertices, numReferenced );
+	truncateVertexAttribute( &mColorsRGB, numVertices, numReferenced );
+	truncateVertexAttribute( &mColorsRGBA, numVertices, numReferenced );
+	truncateVertexAttribute( &mTexCoords, numVertices, numReferenced );
+	truncateVertexAttribute( &mTangents, numVertices, numReferenced );
+	updateTrackedMemory();
+	return result;
+}
+
+namespace {
+
+// The binary format is a header of TRIMESH_HEADER_SIZE bytes followed by the vertices, normals, RGB colors, RGBA colors, texture coordinates, tangents and indices.
+// Each array starts at a multiple of TRIMESH_ALIGNMENT bytes and is stored little-endian. The older streamed format starts with its version byte, 1.
+const uint32_t	TRIMESH_VERSION = 2;
+const size_t	TRIMESH_HEADER_SIZE = 64;
+const size_t	TRIMESH_ALIGNMENT = 16;
+const int		TRIMESH_NUM_ARRAYS = 7;
+
+typedef enum { ARRAY_VERTICES, ARRAY_NORMALS, ARRAY_COLORS_RGB, ARRAY_COLORS_RGBA, ARRAY_TEX_COORDS, ARRAY_TANGENTS, ARRAY_INDICES } TriMeshArray;
+
+struct TriMeshHeader {
+	TriMeshHeader() : mFlags( 0 ), mPositionMin( Vec3f::zero() ), mPositionScale( Vec3f::zero() )
+	{
+		for( int a = 0; a < TRIMESH_NUM_ARRAYS; ++a )
+			mCounts[a] = 0;
+	}
+
+	void	write( uint8_t *dest ) const;
+	bool	read( const uint8_t *src, size_t size );
+
+	size_t	getElementSize( int array ) const;
+	// returns the offset of each array from the start of the file, and the total size of the file in offsets[TRIMESH_NUM_ARRAYS]
+	void	calcOffsets( uint64_t offsets[TRIMESH_NUM_ARRAYS + 1] ) const;
+
+	uint32_t	mFlags;
+	uint32_t	mCounts[TRIMESH_NUM_ARRAYS];
+	Vec3f		mPositionMin, mPositionScale; // quantized positions are mPositionMin + q * mPositionScale
+};
+
+void writeLe( uint8_t *dest, uint32_t value )
+{
+	for( int b = 0; b < 4; ++b )
+		dest[b] = (uint8_t)( value >> ( b * 8 ) );
+}
+
+uint32_t readLe( const uint8_t *src )
+{
+	return (uint32_t)src[0] | ( (uint32_t)src[1] << 8 ) | ( (uint32_t)src[2] << 16 ) | ( (uint32_t)src[3] << 24 );
+}
+
+void writeLe( uint8_t *dest, float value )
+{
+	uint32_t bits;
+	memcpy( &bits, &value, 4 );
+	writeLe( dest, bits );
+}
+
+float readLeFloat( const uint8_t *src )
+{
+	const uint32_t bits = readLe( src );
+	float result;
+	memcpy( &result, &bits, 4 );
+	return result;
+}
+
+void TriMeshHeader::write( uint8_t *dest ) const
+{
+	memset( dest, 0, TRIMESH_HEADER_SIZE );
+	memcpy( dest, "CITM", 4 );
+	writeLe( dest + 4, TRIMESH_VERSION );
+	writeLe( dest + 8, mFlags );
+	for( int a = 0; a < TRIMESH_NUM_ARRAYS; ++a )
+		writeLe( dest + 12 + a * 4, mCounts[a] );
+	for( int c = 0; c < 3; ++c ) {
+		writeLe( dest + 40 + c * 4, mPositionMin[c] );
+		writeLe( dest + 52 + c * 4, mPositionScale[c] );
+	}
+}
+
+bool TriMeshHeader::read( const uint8_t *src, size_t size )
+{
+	if( size < TRIMESH_HEADER_SIZE || memcmp( src, "CITM", 4 ) || readLe( src + 4 ) != TRIMESH_VERSION )
+		return false;
+	mFlags = readLe( src + 8 );
+	for( int a = 0; a < TRIMESH_NUM_ARRAYS; ++a )
+		mCounts[a] = readLe( src + 12 + a * 4 );
+	for( int c = 0; c < 3; ++c ) {
+		mPositionMin[c] = readLeFloat( src + 40 + c * 4 );
+		mPositionScale[c] = readLeFloat( src + 52 + c * 4 );
+	}
+
+	uint64_t offsets[TRIMESH_NUM_ARRAYS + 1];
+	calcOffsets( offsets );
+	return ( mFlags & ~( TriMesh::QUANTIZE_POSITIONS | TriMesh::QUANTIZE_NORMALS ) ) == 0 && offsets[TRIMESH_NUM_ARRAYS] <= size;
+}
+
+size_t TriMeshHeader::getElementSize( int array ) const
+{
+	switch( array ) {
+		case ARRAY_VERTICES: return ( mFlags & TriMesh::QUANTIZE_POSITIONS ) ? 3 * sizeof(uint16_t) : sizeof(Vec3f);
+		case ARRAY_NORMALS: return ( mFlags & TriMesh::QUANTIZE_NORMALS ) ? 2 * sizeof(int16_t) : sizeof(Vec3f);
+		case ARRAY_COLORS_RGB: return sizeof(Color);
+		case ARRAY_COLORS_RGBA: return sizeof(ColorA);
+		case ARRAY_TEX_COORDS: return sizeof(Vec2f);
+		case ARRAY_TANGENTS: return sizeof(Vec4f);
+		default: return sizeof(uint32_t);
+	}
+}
+
+void TriMeshHeader::calcOffsets( uint64_t offsets[TRIMESH_NUM_ARRAYS + 1] ) const
+{
+	offsets[0] = TRIMESH_HEADER_SIZE;
+	for( int a = 0; a < TRIMESH_NUM_ARRAYS; ++a ) {
+		const uint64_t end = offsets[a] + (uint64_t)mCounts[a] * getElementSize( a );
+		offsets[a+1] = ( end + TRIMESH_ALIGNMENT - 1 ) / TRIMESH_ALIGNMENT * TRIMESH_ALIGNMENT;
+	}
+}
+
+// Normals are quantized by projecting them onto an octahedron which is unfolded into a square, following Meyer et al's "On Floating-Point Normal Vectors".
+// Coordinates are rounded within [-32767,32767], leaving -32768 to mark zero length normals.
+const int16_t ZERO_NORMAL = -32768;
+
+inline float signNotZero( float v )
+{
+	return ( v >= 0 ) ? 1.0f : -1.0f;
+}
+
+void encodeNormal( const Vec3f &n, int16_t *result )
+{
+	const float sum = math<float>::abs( n.x ) + math<float>::abs( n.y ) + math<float>::abs( n.z );
+	if( ! ( sum > 0 ) ) {
+		result[0] = result[1] = ZERO_NORMAL;
+		return;
+	}
+	float x = n.x / sum, y = n.y / sum;
+	if( n.z < 0 ) {
+		const float foldedX = ( 1 - math<float>::abs( y ) ) * signNotZero( x );
+		y = ( 1 - math<float>::abs( x ) ) * signNotZero( y );
+		x = foldedX;
+	}
+	result[0] = (int16_t)math<float>::floor( constrain( x, -1.0f, 1.0f ) * 32767 + 0.5f );
+	result[1] = (int16_t)math<float>::floor( constrain( y, -1.0f, 1.0f ) * 32767 + 0.5f );
+}
+
+Vec3f decodeNormal( const int16_t *encoded )
+{
+	if( encoded[0] == ZERO_NORMAL )
+		return Vec3f::zero();
+	Vec3f n( std::max( encoded[0] / 32767.0f, -1.0f ), std::max( encoded[1] / 32767.0f, -1.0f ), 0 );
+	n.z = 1 - math<float>::abs( n.x ) - math<float>::abs( n.y );
+	if( n.z < 0 ) {
+		const float foldedX = ( 1 - math<float>::abs( n.y ) ) * signNotZero( n.x );
+		n.y = ( 1 - math<float>::abs( n.x ) ) * signNotZero( n.y );
+		n.x = foldedX;
+	}
+	return n.normalized();
+}
+
+// copies \a count elements of \a array from \a data into \a result
+template<typename T>
+void readArray( const uint8_t *data, const TriMeshHeader &header, const uint64_t offsets[], int array, vector<T> *result )
+{
+	result->resize( header.mCounts[array] );
+	if( ! result->empty() )
+		memcpy( static_cast<void*>( &(*result)[0] ), data + offsets[array], result->size() * sizeof(T) );
+}
+
+// writes the zeros which follow an array of \a size bytes, up to the next multiple of TRIMESH_ALIGNMENT
+void writePadding( const OStreamRef &out, size_t size )
+{
+	static const uint8_t zeros[TRIMESH_ALIGNMENT] = { 0 };
+	if( size % TRIMESH_ALIGNMENT )
+		out->writeData( zeros, TRIMESH_ALIGNMENT - size % TRIMESH_ALIGNMENT );
+}
+
+template<typename T>
+void writeArray( const OStreamRef &out, const vector<T> &array )
+{
+	if( ! array.empty() )
+		out->writeData( &array[0], array.size() * sizeof(T) );
+	writePadding( out, array.size() * sizeof(T) );
+}
+
+} // anonymous namespace
 
 void TriMesh::read( DataSourceRef dataSource )
 {
-	IStreamRef in = dataSource->createStream();
+	std::shared_ptr<const void> mapping;
+	size_t size = 0;
+	const uint8_t *data = NULL;
+	if( dataSource->isFilePath() )
+		mapping = mapFile( dataSource->getFilePath(), &size );
+	if( mapping )
+		data = reinterpret_cast<const uint8_t*>( mapping.get() );
+	else {
+		const Buffer &buffer = dataSource->getBuffer();
+		data = reinterpret_cast<const uint8_t*>( buffer.getData() );
+		size = buffer.getDataSize();
+	}
+
 	clear();
+	if( ( size >= 4 ) && ( memcmp( data, "CITM", 4 ) == 0 ) ) {
+		TriMeshHeader header;
+		if( ! header.read( data, size ) )
+			throw TriMeshExc();
+		uint64_t offsets[TRIMESH_NUM_ARRAYS + 1];
+		header.calcOffsets( offsets );
 
+		if( header.mFlags & QUANTIZE_POSITIONS ) {
+			const uint8_t *src = data + offsets[ARRAY_VERTICES];
+			mVertices.resize( header.mCounts[ARRAY_VERTICES] );
+			for( size_t v = 0; v < mVertices.size(); ++v ) {
+				uint16_t q[3];
+				memcpy( q, src + v * sizeof(q), sizeof(q) );
+				mVertices[v] = header.mPositionMin + Vec3f( q[0], q[1], q[2] ) * header.mPositionScale;
+			}
+		}
+		else
+			readArray( data, header, offsets, ARRAY_VERTICES, &mVertices );
+		if( header.mFlags & QUANTIZE_NORMALS ) {
+			const uint8_t *src = data + offsets[ARRAY_NORMALS];
+			mNormals.resize( header.mCounts[ARRAY_NORMALS] );
+			for( size_t n = 0; n < mNormals.size(); ++n ) {
+				int16_t q[2];
+				memcpy( q, src + n * sizeof(q), sizeof(q) );
+				mNormals[n] = decodeNormal( q );
+			}
+		}
+		else
+			readArray( data, header, offsets, ARRAY_NORMALS, &mNormals );
+		readArray( data, header, offsets, ARRAY_COLORS_RGB, &mColorsRGB );
+		readArray( data, header, offsets, ARRAY_COLORS_RGBA, &mColorsRGBA );
+		readArray( data, header, offsets, ARRAY_TEX_COORDS, &mTexCoords );
+		readArray( data, header, offsets, ARRAY_TANGENTS, &mTangents );
+		readArray( data, header, offsets, ARRAY_INDICES, &mIndices );
+		updateTrackedMemory();
+		return;
+	}
+
+	// the older streamed format
+	IStreamRef in = IStreamMem::create( data, size );
 	uint8_t versionNumber;
 	in->read( &versionNumber );
 	
@@ -157,35 +1227,70 @@ void TriMesh::read( DataSourceRef dataSource )
 		in->readLittle( &v );
 		mIndices.push_back( v );
 	}
+	updateTrackedMemory();
 }
 
-void TriMesh::write( DataTargetRef dataTarget ) const
+void TriMesh::write( DataTargetRef dataTarget, uint32_t quantize ) const
 {
 	OStreamRef out = dataTarget->getStream();
-	
-	const uint8_t versionNumber = 1;
-	out->write( versionNumber );
-	
-	out->writeLittle( static_cast<uint32_t>( mVertices.size() ) );
-	out->writeLittle( static_cast<uint32_t>( mNormals.size() ) );
-	out->writeLittle( static_cast<uint32_t>( mTexCoords.size() ) );
-	out->writeLittle( static_cast<uint32_t>( mIndices.size() ) );
-	
-	for( vector<Vec3f>::const_iterator it = mVertices.begin(); it != mVertices.end(); ++it ) {
-		out->writeLittle( it->x ); out->writeLittle( it->y ); out->writeLittle( it->z );
-	}
 
-	for( vector<Vec3f>::const_iterator it = mNormals.begin(); it != mNormals.end(); ++it ) {
-		out->writeLittle( it->x ); out->writeLittle( it->y ); out->writeLittle( it->z );
+	TriMeshHeader header;
+	header.mFlags = quantize & ( QUANTIZE_POSITIONS | QUANTIZE_NORMALS );
+	header.mCounts[ARRAY_VERTICES] = (uint32_t)mVertices.size();
+	header.mCounts[ARRAY_NORMALS] = (uint32_t)mNormals.size();
+	header.mCounts[ARRAY_COLORS_RGB] = (uint32_t)mColorsRGB.size();
+	header.mCounts[ARRAY_COLORS_RGBA] = (uint32_t)mColorsRGBA.size();
+	header.mCounts[ARRAY_TEX_COORDS] = (uint32_t)mTexCoords.size();
+	header.mCounts[ARRAY_TANGENTS] = (uint32_t)mTangents.size();
+	header.mCounts[ARRAY_INDICES] = (uint32_t)mIndices.size();
+	if( ( header.mFlags & QUANTIZE_POSITIONS ) && ( ! mVertices.empty() ) ) {
+		const AxisAlignedBox3f bounds = calcBoundingBox();
+		header.mPositionMin = bounds.getMin();
+		header.mPositionScale = bounds.getSize() / 65535.0f;
 	}
 
-	for( vector<Vec2f>::const_iterator it = mTexCoords.begin(); it != mTexCoords.end(); ++it ) {
-		out->writeLittle( it->x ); out->writeLittle( it->y );
+	uint8_t headerData[TRIMESH_HEADER_SIZE];
+	header.write( headerData );
+	out->writeData( headerData, TRIMESH_HEADER_SIZE );
+
+	// quantized arrays are encoded a chunk at a time
+	const size_t CHUNK_SIZE = 1024;
+	if( header.mFlags & QUANTIZE_POSITIONS ) {
+		uint16_t chunk[CHUNK_SIZE * 3];
+		for( size_t start = 0; start < mVertices.size(); start += CHUNK_SIZE ) {
+			const size_t count = std::min( CHUNK_SIZE, mVertices.size() - start );
+			for( size_t v = 0; v < count; ++v ) {
+				for( int c = 0; c < 3; ++c ) {
+					const float scale = header.mPositionScale[c];
+					const float q = ( scale > 0 ) ? ( mVertices[start + v][c] - header.mPositionMin[c] ) / scale : 0;
+					chunk[v * 3 + c] = (uint16_t)math<float>::floor( constrain( q, 0.0f, 65535.0f ) + 0.5f );
+				}
+			}
+			out->writeData( chunk, count * sizeof(uint16_t) * 3 );
+		}
+		writePadding( out, mVertices.size() * sizeof(uint16_t) * 3 );
 	}
+	else
+		writeArray( out, mVertices );
 
-	for( vector<uint32_t>::const_iterator it = mIndices.begin(); it != mIndices.end(); ++it ) {
-		out->writeLittle( *it );
+	if( header.mFlags & QUANTIZE_NORMALS ) {
+		int16_t chunk[CHUNK_SIZE * 2];
+		for( size_t start = 0; start < mNormals.size(); start += CHUNK_SIZE ) {
+			const size_t count = std::min( CHUNK_SIZE, mNormals.size() - start );
+			for( size_t n = 0; n < count; ++n )
+				encodeNormal( mNormals[start + n], &chunk[n * 2] );
+			out->writeData( chunk, count * sizeof(int16_t) * 2 );
+		}
+		writePadding( out, mNormals.size() * sizeof(int16_t) * 2 );
 	}
+	else
+		writeArray( out, mNormals );
+
+	writeArray( out, mColorsRGB );
+	writeArray( out, mColorsRGBA );
+	writeArray( out, mTexCoords );
+	writeArray( out, mTangents );
+	writeArray( out, mIndices );
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
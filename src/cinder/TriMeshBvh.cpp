@@ -0,0 +1,450 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+#include "cinder/TriMeshBvh.h"
+#include "cinder/ip/ExecutionContext.h"
+
+#include <algorithm>
+
+namespace cinder {
+
+namespace {
+
+// meshes smaller than this are always built on the calling thread
+const uint32_t	MIN_PARALLEL_TRIANGLES = 65536;
+const int		NUM_BINS = 16;
+const uint32_t	MAX_LEAF_TRIANGLES = 8;
+// the cost of visiting a node relative to intersecting one triangle, for the surface area heuristic
+const float		TRAVERSAL_COST = 1.0f;
+// below this depth nodes are split at their median rather than by the surface area heuristic, which bounds the depth of the hierarchy to MAX_SAH_DEPTH + 32
+const uint32_t	MAX_SAH_DEPTH = 64;
+// a traversal holds at most one entry per level of the hierarchy, plus one
+const int		STACK_SIZE = 128;
+
+struct Bounds {
+	Bounds() { mMin[0] = mMin[1] = mMin[2] = FLT_MAX; mMax[0] = mMax[1] = mMax[2] = -FLT_MAX; }
+
+	void include( const float *p ) {
+		for( int a = 0; a < 3; ++a ) {
+			mMin[a] = std::min( mMin[a], p[a] );
+			mMax[a] = std::max( mMax[a], p[a] );
+		}
+	}
+	void include( const Bounds &b ) {
+		for( int a = 0; a < 3; ++a ) {
+			mMin[a] = std::min( mMin[a], b.mMin[a] );
+			mMax[a] = std::max( mMax[a], b.mMax[a] );
+		}
+	}
+
+	float calcHalfArea() const {
+		if( mMin[0] > mMax[0] )
+			return 0;
+		float dx = mMax[0] - mMin[0], dy = mMax[1] - mMin[1], dz = mMax[2] - mMin[2];
+		return dx * dy + dy * dz + dz * dx;
+	}
+
+	float	mMin[3], mMax[3];
+};
+
+// whether a triangle's centroid falls in a bin below \a split along \a axis
+struct BinBelow {
+	BinBelow( int axis, int split, float minCentroid, float binScale )
+		: mAxis( axis ), mSplit( split ), mMinCentroid( minCentroid ), mBinScale( binScale )
+	{}
+
+	template<typename T>
+	bool operator()( const T &tri ) const {
+		return std::min<int>( NUM_BINS - 1, (int)( ( tri.mCentroid[mAxis] - mMinCentroid ) * mBinScale ) ) < mSplit;
+	}
+
+	int		mAxis, mSplit;
+	float	mMinCentroid, mBinScale;
+};
+
+struct CentroidLess {
+	CentroidLess( int axis ) : mAxis( axis ) {}
+
+	template<typename T>
+	bool operator()( const T &a, const T &b ) const { return a.mCentroid[mAxis] < b.mCentroid[mAxis]; }
+
+	int		mAxis;
+};
+
+// slab test of \a ray against \a node, returning the entry distance when the ray reaches it within [0,maxT)
+inline bool intersectNode( const TriMeshBvh::Node &node, const Vec3f &origin, const Vec3f &invDir, float maxT, float *entryT )
+{
+	float t1 = ( node.mMin[0] - origin.x ) * invDir.x, t2 = ( node.mMax[0] - origin.x ) * invDir.x;
+	float tMin = std::min( t1, t2 ), tMax = std::max( t1, t2 );
+	t1 = ( node.mMin[1] - origin.y ) * invDir.y; t2 = ( node.mMax[1] - origin.y ) * invDir.y;
+	tMin = std::max( tMin, std::min( t1, t2 ) ); tMax = std::min( tMax, std::max( t1, t2 ) );
+	t1 = ( node.mMin[2] - origin.z ) * invDir.z; t2 = ( node.mMax[2] - origin.z ) * invDir.z;
+	tMin = std::max( tMin, std::min( t1, t2 ) ); tMax = std::min( tMax, std::max( t1, t2 ) );
+
+	*entryT = tMin;
+	return ( tMax >= std::max( tMin, 0.0f ) ) && ( tMin < maxT );
+}
+
+inline bool overlapsNode( const TriMeshBvh::Node &node, const Vec3f &boxMin, const Vec3f &boxMax )
+{
+	return ( node.mMin[0] <= boxMax.x ) && ( node.mMax[0] >= boxMin.x )
+		&& ( node.mMin[1] <= boxMax.y ) && ( node.mMax[1] >= boxMin.y )
+		&& ( node.mMin[2] <= boxMax.z ) && ( node.mMax[2] >= boxMin.z );
+}
+
+// separating axis test of a triangle against a box, after "Fast 3D Triangle-Box Overlap Testing" by Tomas Akenine-Moller
+bool triangleOverlapsBox( const Vec3f &center, const Vec3f &halfSize, const Vec3f *tri )
+{
+	const Vec3f v[3] = { tri[0] - center, tri[1] - center, tri[2] - center };
+	const Vec3f e[3] = { v[1] - v[0], v[2] - v[1], v[0] - v[2] };
+
+	// the box's face normals
+	for( int a = 0; a < 3; ++a ) {
+		float lo = std::min( v[0][a], std::min( v[1][a], v[2][a] ) );
+		float hi = std::max( v[0][a], std::max( v[1][a], v[2][a] ) );
+		if( lo > halfSize[a] || hi < -halfSize[a] )
+			return false;
+	}
+
+	// the triangle's normal
+	Vec3f normal = e[0].cross( e[1] );
+	float r = halfSize.x * math<float>::abs( normal.x ) + halfSize.y * math<float>::abs( normal.y ) + halfSize.z * math<float>::abs( normal.z );
+	if( math<float>::abs( normal.dot( v[0] ) ) > r )
+		return false;
+
+	// the cross products of the box's axes and the triangle's edges
+	for( int i = 0; i < 3; ++i ) {
+		for( int a = 0; a < 3; ++a ) {
+			Vec3f axis = Vec3f::zero();
+			axis[(a + 1) % 3] = -e[i][(a + 2) % 3];
+			axis[(a + 2) % 3] = e[i][(a + 1) % 3];
+			float p0 = axis.dot( v[0] ), p1 = axis.dot( v[1] ), p2 = axis.dot( v[2] );
+			float radius = halfSize.x * math<float>::abs( axis.x ) + halfSize.y * math<float>::abs( axis.y ) + halfSize.z * math<float>::abs( axis.z );
+			if( std::min( p0, std::min( p1, p2 ) ) > radius || std::max( p0, std::max( p1, p2 ) ) < -radius )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+} // anonymous namespace
+
+//! a triangle being sorted into the hierarchy
+struct TriMeshBvh::BuildTriangle {
+	Bounds		mBounds;
+	float		mCentroid[3];
+	uint32_t	mIndex;
+};
+
+//! a subtree whose build has been deferred to a worker thread, and the nodes it produced
+struct TriMeshBvh::BuildTask {
+	uint32_t			mNodeIdx, mStart, mEnd, mDepth;
+	std::vector<Node>	mNodes;
+};
+
+TriMeshBvh::TriMeshBvh( const TriMesh &mesh, const ip::ExecutionContextRef &context )
+{
+	const uint32_t numTriangles = (uint32_t)mesh.getNumTriangles();
+	if( numTriangles == 0 )
+		return;
+
+	std::vector<BuildTriangle> triangles( numTriangles );
+	for( uint32_t t = 0; t < numTriangles; ++t ) {
+		Vec3f v[3];
+		mesh.getTriangleVertices( t, &v[0], &v[1], &v[2] );
+		for( int i = 0; i < 3; ++i )
+			triangles[t].mBounds.include( &v[i].x );
+		for( int a = 0; a < 3; ++a )
+			triangles[t].mCentroid[a] = ( triangles[t].mBounds.mMin[a] + triangles[t].mBounds.mMax[a] ) * 0.5f;
+		triangles[t].mIndex = t;
+	}
+
+	// at most 2n - 1 nodes, since every leaf holds at least one triangle
+	mNodes.reserve( numTriangles * 2 );
+	mNodes.resize( 1 );
+	if( context && ( numTriangles >= MIN_PARALLEL_TRIANGLES ) && ( context->getNumThreads() > 1 ) ) {
+		// split the top of the hierarchy serially until there are enough subtrees to fill every thread's bands, then build those concurrently
+		std::vector<BuildTask> deferred;
+		uint32_t maxDeferredSize = std::max<uint32_t>( 1, numTriangles / ( context->getNumThreads() * context->getMinRowsPerBand() * 2 ) );
+		build( 0, 0, numTriangles, 0, &mNodes, &triangles, &deferred, maxDeferredSize );
+		context->run( Area( 0, 0, 1, (int32_t)deferred.size() ), std::bind( &TriMeshBvh::buildBand, this, &triangles, &deferred, std::_1 ) );
+
+		// splice each subtree in, its root replacing the placeholder node and the rest appended after the current nodes
+		for( size_t t = 0; t < deferred.size(); ++t ) {
+			const std::vector<Node> &subtree = deferred[t].mNodes;
+			const uint32_t base = (uint32_t)mNodes.size() - 1;
+			for( size_t n = 0; n < subtree.size(); ++n ) {
+				Node node = subtree[n];
+				if( node.numTriangles == 0 )
+					node.offset += base;
+				if( n == 0 )
+					mNodes[deferred[t].mNodeIdx] = node;
+				else
+					mNodes.push_back( node );
+			}
+		}
+	}
+	else
+		build( 0, 0, numTriangles, 0, &mNodes, &triangles, NULL, 0 );
+
+	mVertices.resize( numTriangles * 3 );
+	mTriangleIndices.resize( numTriangles );
+	for( uint32_t t = 0; t < numTriangles; ++t ) {
+		mTriangleIndices[t] = triangles[t].mIndex;
+		mesh.getTriangleVertices( triangles[t].mIndex, &mVertices[t*3], &mVertices[t*3+1], &mVertices[t*3+2] );
+	}
+}
+
+void TriMeshBvh::buildBand( std::vector<BuildTriangle> *triangles, std::vector<BuildTask> *tasks, const Area &band ) const
+{
+	for( int32_t t = band.y1; t < band.y2; ++t ) {
+		BuildTask &task = (*tasks)[t];
+		task.mNodes.reserve( ( task.mEnd - task.mStart ) * 2 );
+		task.mNodes.resize( 1 );
+		build( 0, task.mStart, task.mEnd, task.mDepth, &task.mNodes, triangles, NULL, 0 );
+	}
+}
+
+void TriMeshBvh::build( uint32_t nodeIdx, uint32_t start, uint32_t end, uint32_t depth, std::vector<Node> *nodes, std::vector<BuildTriangle> *triangles, std::vector<BuildTask> *deferred, uint32_t maxDeferredSize ) const
+{
+	const uint32_t count = end - start;
+	if( deferred && ( count <= maxDeferredSize ) ) {
+		BuildTask task;
+		task.mNodeIdx = nodeIdx;
+		task.mStart = start;
+		task.mEnd = end;
+		task.mDepth = depth;
+		deferred->push_back( task );
+		return;
+	}
+
+	BuildTriangle *tris = &(*triangles)[0];
+	Bounds bounds, centroidBounds;
+	for( uint32_t t = start; t < end; ++t ) {
+		bounds.include( tris[t].mBounds );
+		centroidBounds.include( tris[t].mCentroid );
+	}
+	Node &node = (*nodes)[nodeIdx];
+	std::copy( bounds.mMin, bounds.mMin + 3, node.mMin );
+	std::copy( bounds.mMax, bounds.mMax + 3, node.mMax );
+	node.offset = start;
+	node.numTriangles = count;
+	if( count == 1 )
+		return;
+
+	// bin the centroids along every axis in one pass, then evaluate the surface area heuristic at each bin boundary
+	float bestCost = FLT_MAX;
+	int bestAxis = -1, bestSplit = 0;
+	if( depth < MAX_SAH_DEPTH ) {
+		float binScale[3];
+		for( int axis = 0; axis < 3; ++axis ) {
+			const float extent = centroidBounds.mMax[axis] - centroidBounds.mMin[axis];
+			binScale[axis] = ( extent > 0 ) ? ( NUM_BINS / extent ) : 0;
+		}
+		Bounds binBounds[3][NUM_BINS];
+		uint32_t binCounts[3][NUM_BINS] = { { 0 } };
+		for( uint32_t t = start; t < end; ++t ) {
+			for( int axis = 0; axis < 3; ++axis ) {
+				int bin = std::min<int>( NUM_BINS - 1, (int)( ( tris[t].mCentroid[axis] - centroidBounds.mMin[axis] ) * binScale[axis] ) );
+				binBounds[axis][bin].include( tris[t].mBounds );
+				++binCounts[axis][bin];
+			}
+		}
+
+		for( int axis = 0; axis < 3; ++axis ) {
+			if( binScale[axis] == 0 )
+				continue;
+			// sweep from the right to find the cost of everything above each boundary, then from the left
+			float rightArea[NUM_BINS];
+			uint32_t rightCount[NUM_BINS];
+			Bounds accum;
+			uint32_t accumCount = 0;
+			for( int b = NUM_BINS - 1; b > 0; --b ) {
+				accum.include( binBounds[axis][b] );
+				accumCount += binCounts[axis][b];
+				rightArea[b] = accum.calcHalfArea();
+				rightCount[b] = accumCount;
+			}
+			accum = Bounds();
+			accumCount = 0;
+			for( int b = 1; b < NUM_BINS; ++b ) {
+				accum.include( binBounds[axis][b-1] );
+				accumCount += binCounts[axis][b-1];
+				if( ( accumCount == 0 ) || ( rightCount[b] == 0 ) )
+					continue;
+				float cost = accum.calcHalfArea() * accumCount + rightArea[b] * rightCount[b];
+				if( cost < bestCost ) {
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = b;
+				}
+			}
+		}
+	}
+
+	uint32_t mid;
+	const float nodeArea = bounds.calcHalfArea();
+	if( bestAxis >= 0 ) {
+		// splitting is worthwhile when it beats testing every triangle, or required when the leaf would be too large
+		if( ( count <= MAX_LEAF_TRIANGLES ) && ( nodeArea > 0 ) && ( TRAVERSAL_COST + bestCost / nodeArea >= count ) )
+			return;
+		const float binScale = NUM_BINS / ( centroidBounds.mMax[bestAxis] - centroidBounds.mMin[bestAxis] );
+		const float minCentroid = centroidBounds.mMin[bestAxis];
+		BuildTriangle *split = std::partition( tris + start, tris + end, BinBelow( bestAxis, bestSplit, minCentroid, binScale ) );
+		mid = (uint32_t)( split - tris );
+	}
+	else {
+		// the hierarchy is too deep, or every centroid coincides; a median split still bounds the leaf size
+		if( count <= MAX_LEAF_TRIANGLES )
+			return;
+		int axis = 0;
+		for( int a = 1; a < 3; ++a ) {
+			if( centroidBounds.mMax[a] - centroidBounds.mMin[a] > centroidBounds.mMax[axis] - centroidBounds.mMin[axis] )
+				axis = a;
+		}
+		mid = start + count / 2;
+		std::nth_element( tris + start, tris + mid, tris + end, CentroidLess( axis ) );
+	}
+
+	const uint32_t children = (uint32_t)nodes->size();
+	nodes->resize( children + 2 );
+	(*nodes)[nodeIdx].offset = children;
+	(*nodes)[nodeIdx].numTriangles = 0;
+	build( children, start, mid, depth + 1, nodes, triangles, deferred, maxDeferredSize );
+	build( children + 1, mid, end, depth + 1, nodes, triangles, deferred, maxDeferredSize );
+}
+
+AxisAlignedBox3f TriMeshBvh::getBounds() const
+{
+	if( mNodes.empty() )
+		return AxisAlignedBox3f( Vec3f::zero(), Vec3f::zero() );
+	return AxisAlignedBox3f( Vec3f( mNodes[0].mMin ), Vec3f( mNodes[0].mMax ) );
+}
+
+bool TriMeshBvh::intersects( const Ray &ray, float maxDistance ) const
+{
+	if( mNodes.empty() )
+		return false;
+
+	uint32_t stack[STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while( stackSize > 0 ) {
+		const Node &node = mNodes[stack[--stackSize]];
+		float entryT;
+		if( ! intersectNode( node, ray.getOrigin(), ray.getInverseDirection(), maxDistance, &entryT ) )
+			continue;
+		if( node.numTriangles ) {
+			for( uint32_t t = node.offset; t < node.offset + node.numTriangles; ++t ) {
+				float dist;
+				if( ray.calcTriangleIntersection( mVertices[t*3], mVertices[t*3+1], mVertices[t*3+2], &dist ) && ( dist >= 0 ) && ( dist <= maxDistance ) )
+					return true;
+			}
+		}
+		else {
+			stack[stackSize++] = node.offset + 1;
+			stack[stackSize++] = node.offset;
+		}
+	}
+
+	return false;
+}
+
+bool TriMeshBvh::calcIntersection( const Ray &ray, float *resultDistance, size_t *resultTriangle ) const
+{
+	if( mNodes.empty() )
+		return false;
+
+	float bestDist = FLT_MAX;
+	uint32_t bestTriangle = 0xFFFFFFFF;
+	uint32_t stack[STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while( stackSize > 0 ) {
+		const Node &node = mNodes[stack[--stackSize]];
+		float entryT;
+		if( ! intersectNode( node, ray.getOrigin(), ray.getInverseDirection(), bestDist, &entryT ) )
+			continue;
+		if( node.numTriangles ) {
+			for( uint32_t t = node.offset; t < node.offset + node.numTriangles; ++t ) {
+				float dist;
+				if( ray.calcTriangleIntersection( mVertices[t*3], mVertices[t*3+1], mVertices[t*3+2], &dist ) && ( dist >= 0 ) && ( dist < bestDist ) ) {
+					bestDist = dist;
+					bestTriangle = t;
+				}
+			}
+		}
+		else {
+			// visit the nearer child first so that bestDist tightens before the farther one is tested
+			float leftT, rightT;
+			bool hitLeft = intersectNode( mNodes[node.offset], ray.getOrigin(), ray.getInverseDirection(), bestDist, &leftT );
+			bool hitRight = intersectNode( mNodes[node.offset + 1], ray.getOrigin(), ray.getInverseDirection(), bestDist, &rightT );
+			if( hitLeft && hitRight ) {
+				bool leftFirst = leftT <= rightT;
+				stack[stackSize++] = leftFirst ? node.offset + 1 : node.offset;
+				stack[stackSize++] = leftFirst ? node.offset : node.offset + 1;
+			}
+			else if( hitLeft )
+				stack[stackSize++] = node.offset;
+			else if( hitRight )
+				stack[stackSize++] = node.offset + 1;
+		}
+	}
+
+	if( bestTriangle == 0xFFFFFFFF )
+		return false;
+	*resultDistance = bestDist;
+	if( resultTriangle )
+		*resultTriangle = mTriangleIndices[bestTriangle];
+	return true;
+}
+
+void TriMeshBvh::findOverlapping( const AxisAlignedBox3f &box, std::vector<size_t> *resultTriangles ) const
+{
+	resultTriangles->clear();
+	if( mNodes.empty() )
+		return;
+
+	const Vec3f center = box.getCenter(), halfSize = box.getSize() * 0.5f;
+	uint32_t stack[STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while( stackSize > 0 ) {
+		const Node &node = mNodes[stack[--stackSize]];
+		if( ! overlapsNode( node, box.getMin(), box.getMax() ) )
+			continue;
+		if( node.numTriangles ) {
+			for( uint32_t t = node.offset; t < node.offset + node.numTriangles; ++t ) {
+				if( triangleOverlapsBox( center, halfSize, &mVertices[t*3] ) )
+					resultTriangles->push_back( mTriangleIndices[t] );
+			}
+		}
+		else {
+			stack[stackSize++] = node.offset + 1;
+			stack[stackSize++] = node.offset;
+		}
+	}
+}
+
+} // namespace cinder
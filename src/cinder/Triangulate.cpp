@@ -22,8 +22,11 @@
 
 #include "cinder/Triangulate.h"
 #include "cinder/Shape2d.h"
+#include "cinder/ip/ExecutionContext.h"
 #include "tesselator.h"
 
+#include <cstring>
+
 using namespace std;
 
 namespace cinder {
@@ -40,6 +43,65 @@ void stdFree( void* userData, void* ptr )
 	free( ptr );
 }
 
+namespace {
+
+void* allocatorAlloc( void *userData, unsigned int size )
+{
+	return static_cast<Triangulator::Allocator*>( userData )->allocate( size );
+}
+
+void allocatorFree( void *userData, void *ptr )
+{
+	if( ptr )
+		static_cast<Triangulator::Allocator*>( userData )->deallocate( ptr );
+}
+
+// Deletes a tesselator while keeping alive the Allocator its memory came from
+struct TessDeleter {
+	TessDeleter( const Triangulator::AllocatorRef &allocator ) : mAllocator( allocator ) {}
+	void operator()( TESStesselator *tess ) { tessDeleteTess( tess ); }
+
+	Triangulator::AllocatorRef	mAllocator;
+};
+
+// Every pool block is preceded by its size, padded to keep the block 16-byte aligned
+const size_t POOL_HEADER_SIZE = 16;
+
+} // anonymous namespace
+
+Triangulator::PoolAllocator::~PoolAllocator()
+{
+	// blocks still in use belong to a tesselator which outlives its Allocator, which TessDeleter prevents
+	for( std::map<size_t,vector<void*> >::iterator sizeIt = mFreeBlocks.begin(); sizeIt != mFreeBlocks.end(); ++sizeIt )
+		for( vector<void*>::iterator blockIt = sizeIt->second.begin(); blockIt != sizeIt->second.end(); ++blockIt )
+			free( *blockIt );
+}
+
+void* Triangulator::PoolAllocator::allocate( size_t size )
+{
+	vector<void*> &freeBlocks = mFreeBlocks[size];
+	uint8_t *block;
+	if( ! freeBlocks.empty() ) {
+		block = static_cast<uint8_t*>( freeBlocks.back() );
+		freeBlocks.pop_back();
+	}
+	else {
+		block = static_cast<uint8_t*>( malloc( size + POOL_HEADER_SIZE ) );
+		if( ! block )
+			return 0;
+		*reinterpret_cast<size_t*>( block ) = size;
+		mNumBytes += size + POOL_HEADER_SIZE;
+	}
+
+	return block + POOL_HEADER_SIZE;
+}
+
+void Triangulator::PoolAllocator::deallocate( void *ptr )
+{
+	uint8_t *block = static_cast<uint8_t*>( ptr ) - POOL_HEADER_SIZE;
+	mFreeBlocks[*reinterpret_cast<size_t*>( block )].push_back( block );
+}
+
 Triangulator::Triangulator( const Path2d &path, float approximationScale )
 {	
 	allocate();
@@ -63,20 +125,38 @@ Triangulator::Triangulator()
 	allocate();
 }
 
+Triangulator::Triangulator( const AllocatorRef &allocator )
+	: mAllocator( allocator )
+{
+	allocate();
+}
+
 void Triangulator::allocate()
 {
 	mAllocated = 0;
+	mHasContours = false;
 	
 	TESSalloc ma;
 	memset( &ma, 0, sizeof(ma) );
-	ma.memalloc = stdAlloc;
-	ma.memfree = stdFree;
-	ma.userData = (void*)&mAllocated;
+	if( mAllocator ) {
+		ma.memalloc = allocatorAlloc;
+		ma.memfree = allocatorFree;
+		ma.userData = (void*)mAllocator.get();
+	}
+	else {
+		ma.memalloc = stdAlloc;
+		ma.memfree = stdFree;
+		ma.userData = (void*)&mAllocated;
+	}
 	ma.extraVertices = 2560; // realloc not provided, allow 256 extra vertices.
 
-	mTess = shared_ptr<TESStesselator>( tessNewTess( &ma ), tessDeleteTess );
-	if( ! mTess )
+	TESStesselator *tess = tessNewTess( &ma );
+	if( ! tess )
 		throw Triangulator::Exception();
+	if( mAllocator )
+		mTess = shared_ptr<TESStesselator>( tess, TessDeleter( mAllocator ) );
+	else
+		mTess = shared_ptr<TESStesselator>( tess, tessDeleteTess );
 }
 
 void Triangulator::addShape( const Shape2d &shape, float approximationScale )
@@ -89,24 +169,275 @@ void Triangulator::addShape( const Shape2d &shape, float approximationScale )
 
 void Triangulator::addPath( const Path2d &path, float approximationScale )
 {
-	vector<Vec2f> subdivided = path.subdivide( approximationScale );
+	const vector<Vec2f> &subdivided = path.getSubdivided( approximationScale );
+	if( subdivided.empty() )
+		return;
 	tessAddContour( mTess.get(), 2, &subdivided[0], sizeof(float) * 2, subdivided.size() );
+	mHasContours = true;
 }
 
 void Triangulator::addPolyLine( const PolyLine2f &polyLine )
 {
+	if( polyLine.size() == 0 )
+		return;
 	tessAddContour( mTess.get(), 2, &polyLine.getPoints()[0], sizeof(float) * 2, polyLine.size() );
+	mHasContours = true;
 }
 
 TriMesh2d Triangulator::calcMesh( Winding winding )
 {
 	TriMesh2d result;
+	if( ! mHasContours )
+		return result;
 	
-	tessTesselate( mTess.get(), (int)winding, TESS_POLYGONS, 3, 2, 0 );
+	mHasContours = false;
+	if( ! tessTesselate( mTess.get(), (int)winding, TESS_POLYGONS, 3, 2, 0 ) ) {
+		allocate(); // a failed tesselation can leave its mesh behind, so start over with a fresh tesselator
+		return result;
+	}
 	result.appendVertices( (Vec2f*)tessGetVertices( mTess.get() ), tessGetVertexCount( mTess.get() ) );
 	result.appendIndices( (uint32_t*)( tessGetElements( mTess.get() ) ), tessGetElementCount( mTess.get() ) * 3 );
 	
 	return result;
 }
 
+void Triangulator::clear()
+{
+	// libtess2 can't discard contours short of tesselating them, so replace the tesselator instead
+	if( mHasContours )
+		allocate();
+}
+
+namespace {
+
+void addInput( Triangulator *triangulator, const Shape2d &shape, float approximationScale )
+{
+	triangulator->addShape( shape, approximationScale );
+}
+
+void addInput( Triangulator *triangulator, const PolyLine2f &polyLine, float approximationScale )
+{
+	triangulator->addPolyLine( polyLine );
+}
+
+template<typename T>
+void calcMeshesBand( const vector<T> *inputs, Triangulator::Winding winding, float approximationScale, vector<TriMesh2d> *results, const Area &band )
+{
+	Triangulator triangulator( Triangulator::AllocatorRef( new Triangulator::PoolAllocator ) );
+	for( int32_t i = band.y1; i < band.y2; ++i ) {
+		addInput( &triangulator, (*inputs)[i], approximationScale );
+		(*results)[i] = triangulator.calcMesh( winding );
+	}
+}
+
+template<typename T>
+vector<TriMesh2d> calcMeshesImpl( const vector<T> &inputs, Triangulator::Winding winding, float approximationScale, const ip::ExecutionContextRef &context )
+{
+	vector<TriMesh2d> results( inputs.size() );
+	const Area area( 0, 0, 1, (int32_t)inputs.size() );
+	if( context && ( inputs.size() > 1 ) && ( context->getNumThreads() > 1 ) )
+		context->run( area, std::bind( &calcMeshesBand<T>, &inputs, winding, approximationScale, &results, std::_1 ) );
+	else
+		calcMeshesBand<T>( &inputs, winding, approximationScale, &results, area );
+
+	return results;
+}
+
+} // anonymous namespace
+
+vector<TriMesh2d> Triangulator::calcMeshes( const vector<Shape2d> &shapes, Winding winding, float approximationScale, const ip::ExecutionContextRef &context )
+{
+	return calcMeshesImpl( shapes, winding, approximationScale, context );
+}
+
+vector<TriMesh2d> Triangulator::calcMeshes( const vector<PolyLine2f> &polyLines, Winding winding, const ip::ExecutionContextRef &context )
+{
+	return calcMeshesImpl( polyLines, winding, 1.0f, context );
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+// StrokeTriangulator
+StrokeTriangulator::StrokeTriangulator( const Path2d &path, const Format &format, float approximationScale )
+	: mFormat( format )
+{
+	addPath( path, approximationScale );
+}
+
+StrokeTriangulator::StrokeTriangulator( const Shape2d &shape, const Format &format, float approximationScale )
+	: mFormat( format )
+{
+	addShape( shape, approximationScale );
+}
+
+void StrokeTriangulator::addShape( const Shape2d &shape, float approximationScale )
+{
+	for( vector<Path2d>::const_iterator contourIt = shape.getContours().begin(); contourIt != shape.getContours().end(); ++contourIt )
+		addPath( *contourIt, approximationScale );
+}
+
+void StrokeTriangulator::addPath( const Path2d &path, float approximationScale )
+{
+	const vector<Vec2f> &points = path.getSubdivided( approximationScale );
+	if( ! points.empty() )
+		addPoints( &points[0], points.size(), path.isClosed(), approximationScale );
+}
+
+void StrokeTriangulator::addPolyLine( const PolyLine2f &polyLine, float approximationScale )
+{
+	if( polyLine.size() > 0 )
+		addPoints( &polyLine.getPoints()[0], polyLine.size(), polyLine.isClosed(), approximationScale );
+}
+
+void StrokeTriangulator::addFan( const Vec2f &center, float radius, float startRadians, float sweepRadians, float maxStepRadians )
+{
+	int steps = std::max<int>( 1, (int)math<float>::ceil( math<float>::abs( sweepRadians ) / maxStepRadians ) );
+	float stepRadians = sweepRadians / steps;
+	uint32_t centerIndex = (uint32_t)mMesh.getNumVertices();
+	mMesh.appendVertex( center );
+	for( int s = 0; s <= steps; ++s ) {
+		float radians = startRadians + s * stepRadians;
+		mMesh.appendVertex( center + radius * Vec2f( math<float>::cos( radians ), math<float>::sin( radians ) ) );
+		if( s > 0 )
+			mMesh.appendTriangle( centerIndex, centerIndex + s, centerIndex + s + 1 );
+	}
+}
+
+void StrokeTriangulator::addPoints( const Vec2f *points, size_t numPoints, bool closed, float approximationScale )
+{
+	const float halfWidth = mFormat.getWidth() * 0.5f;
+	const float epsilonSqr = 1e-12f;
+	if( halfWidth <= 0 )
+		return;
+
+	// repeated points have no direction, so drop them up front
+	vector<Vec2f> pts;
+	pts.reserve( numPoints );
+	for( size_t i = 0; i < numPoints; ++i )
+		if( pts.empty() || points[i].distanceSquared( pts.back() ) > epsilonSqr )
+			pts.push_back( points[i] );
+	if( closed && pts.size() > 1 && pts.back().distanceSquared( pts.front() ) <= epsilonSqr )
+		pts.pop_back();
+
+	// round joins and caps are flattened to within the same tolerance as Path2d's curves
+	const float tolerance = 0.5f / approximationScale;
+	const float maxStepRadians = ( tolerance < halfWidth ) ? std::min( 2 * math<float>::acos( 1 - tolerance / halfWidth ), (float)M_PI / 4 ) : (float)M_PI / 4;
+
+	if( pts.empty() )
+		return;
+	else if( pts.size() == 1 ) { // a lone point is drawn as a dot by round and square caps only
+		if( mFormat.getCap() == CAP_ROUND )
+			addFan( pts[0], halfWidth, 0, 2 * (float)M_PI, maxStepRadians );
+		else if( mFormat.getCap() == CAP_SQUARE ) {
+			uint32_t first = (uint32_t)mMesh.getNumVertices();
+			mMesh.appendVertex( pts[0] + Vec2f( -halfWidth, -halfWidth ) );
+			mMesh.appendVertex( pts[0] + Vec2f( halfWidth, -halfWidth ) );
+			mMesh.appendVertex( pts[0] + Vec2f( halfWidth, halfWidth ) );
+			mMesh.appendVertex( pts[0] + Vec2f( -halfWidth, halfWidth ) );
+			mMesh.appendTriangle( first, first + 1, first + 2 );
+			mMesh.appendTriangle( first, first + 2, first + 3 );
+		}
+		return;
+	}
+
+	const size_t numSegments = closed ? pts.size() : pts.size() - 1;
+	vector<Vec2f> dirs( numSegments ), normals( numSegments );
+	vector<float> lengths( numSegments );
+	// the four corners of each segment's quad; a joint may move the inner corners of its two segments onto their shared miter point
+	vector<Vec2f> startLeft( numSegments ), startRight( numSegments ), endLeft( numSegments ), endRight( numSegments );
+	for( size_t s = 0; s < numSegments; ++s ) {
+		const Vec2f &p0 = pts[s], &p1 = pts[(s+1) % pts.size()];
+		lengths[s] = p0.distance( p1 );
+		dirs[s] = ( p1 - p0 ) / lengths[s];
+		normals[s] = Vec2f( -dirs[s].y, dirs[s].x );
+		startLeft[s] = p0 + normals[s] * halfWidth;
+		startRight[s] = p0 - normals[s] * halfWidth;
+		endLeft[s] = p1 + normals[s] * halfWidth;
+		endRight[s] = p1 - normals[s] * halfWidth;
+	}
+
+	if( ! closed ) {
+		const size_t last = numSegments - 1;
+		if( mFormat.getCap() == CAP_SQUARE ) {
+			startLeft[0] -= dirs[0] * halfWidth;
+			startRight[0] -= dirs[0] * halfWidth;
+			endLeft[last] += dirs[last] * halfWidth;
+			endRight[last] += dirs[last] * halfWidth;
+		}
+		else if( mFormat.getCap() == CAP_ROUND ) {
+			addFan( pts[0], halfWidth, math<float>::atan2( normals[0].y, normals[0].x ), (float)M_PI, maxStepRadians );
+			addFan( pts[last+1], halfWidth, math<float>::atan2( -normals[last].y, -normals[last].x ), (float)M_PI, maxStepRadians );
+		}
+	}
+
+	// open outlines have no joint at either end
+	const size_t firstJoint = closed ? 0 : 1, endJoint = closed ? pts.size() : pts.size() - 1;
+	for( size_t j = firstJoint; j < endJoint; ++j ) {
+		const size_t a = ( j + numSegments - 1 ) % numSegments, b = j % numSegments;
+		const Vec2f &center = pts[j];
+		const float cross = dirs[a].x * dirs[b].y - dirs[a].y * dirs[b].x;
+		const float dot = dirs[a].dot( dirs[b] );
+		if( math<float>::abs( cross ) < 1e-6f && dot > 0 )
+			continue; // no turn
+
+		// the outer side of the turn, in units of the normal; left turns bulge to the right
+		const float side = ( cross > 0 ) ? -1.0f : 1.0f;
+		const Vec2f outerA = center + normals[a] * ( halfWidth * side );
+		const Vec2f outerB = center + normals[b] * ( halfWidth * side );
+		const bool canMiter = 1 + dot > 1e-4f;
+		const Vec2f miter = canMiter ? ( normals[a] + normals[b] ) / ( 1 + dot ) : Vec2f::zero();
+
+		// The inner corners meet at the miter point unless it would eat more than half of either segment, in which case the quads just overlap
+		const float innerOverlap = halfWidth * math<float>::abs( cross ) / ( 1 + dot );
+		if( canMiter && innerOverlap <= lengths[a] * 0.5f && innerOverlap <= lengths[b] * 0.5f ) {
+			const Vec2f inner = center - miter * ( halfWidth * side );
+			if( side > 0 )
+				endRight[a] = startRight[b] = inner;
+			else
+				endLeft[a] = startLeft[b] = inner;
+			uint32_t first = (uint32_t)mMesh.getNumVertices();
+			mMesh.appendVertex( inner );
+			mMesh.appendVertex( outerA );
+			mMesh.appendVertex( center );
+			mMesh.appendVertex( outerB );
+			mMesh.appendTriangle( first, first + 1, first + 2 );
+			mMesh.appendTriangle( first, first + 2, first + 3 );
+		}
+
+		// the wedge between outerA and outerB
+		Join join = mFormat.getJoin();
+		if( join == JOIN_MITER && ( ( ! canMiter ) || math<float>::sqrt( 2 / ( 1 + dot ) ) > mFormat.getMiterLimit() ) )
+			join = JOIN_BEVEL;
+		uint32_t first = (uint32_t)mMesh.getNumVertices();
+		switch( join ) {
+			case JOIN_ROUND:
+				addFan( center, halfWidth, math<float>::atan2( outerA.y - center.y, outerA.x - center.x ), -side * math<float>::acos( constrain( dot, -1.0f, 1.0f ) ), maxStepRadians );
+			break;
+			case JOIN_MITER:
+				mMesh.appendVertex( center );
+				mMesh.appendVertex( outerA );
+				mMesh.appendVertex( center + miter * ( halfWidth * side ) );
+				mMesh.appendVertex( outerB );
+				mMesh.appendTriangle( first, first + 1, first + 2 );
+				mMesh.appendTriangle( first, first + 2, first + 3 );
+			break;
+			case JOIN_BEVEL:
+				mMesh.appendVertex( center );
+				mMesh.appendVertex( outerA );
+				mMesh.appendVertex( outerB );
+				mMesh.appendTriangle( first, first + 1, first + 2 );
+			break;
+		}
+	}
+
+	for( size_t s = 0; s < numSegments; ++s ) {
+		uint32_t first = (uint32_t)mMesh.getNumVertices();
+		mMesh.appendVertex( startLeft[s] );
+		mMesh.appendVertex( startRight[s] );
+		mMesh.appendVertex( endRight[s] );
+		mMesh.appendVertex( endLeft[s] );
+		mMesh.appendTriangle( first, first + 1, first + 2 );
+		mMesh.appendTriangle( first, first + 2, first + 3 );
+	}
+}
+
 } // namespace cinder
@@ -29,7 +29,7 @@ using namespace std;
 
 namespace cinder {
 
-TweenBase::TweenBase( void *target, bool copyStartValue, float startTime, float duration, EaseFn easeFunction )
+TweenBase::TweenBase( void *target, bool copyStartValue, float startTime, float duration, const EaseFn &easeFunction )
 	: TimelineItem( 0, target, startTime, duration ), mCopyStartValue( copyStartValue ), mEaseFunction( easeFunction )
 {
 }
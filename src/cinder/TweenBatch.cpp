@@ -0,0 +1,58 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/TweenBatch.h"
+#include "cinder/ip/Simd.h"
+
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#elif defined( CINDER_IP_NEON )
+	#include <arm_neon.h>
+#endif
+
+namespace cinder { namespace detail {
+
+// The SIMD paths follow ip::setSimdEnabled(), and multiply and add separately so that they match tweenLerp() exactly
+void tweenLerpFloats( float *result, const float *start, const float *end, size_t count, float time )
+{
+	const float invTime = 1 - time;
+	size_t i = 0;
+#if defined( CINDER_IP_SSE2 )
+	if( ip::useSse2() ) {
+		const __m128 t = _mm_set1_ps( time ), invT = _mm_set1_ps( invTime );
+		for( ; i + 4 <= count; i += 4 )
+			_mm_storeu_ps( result + i, _mm_add_ps( _mm_mul_ps( _mm_loadu_ps( start + i ), invT ), _mm_mul_ps( _mm_loadu_ps( end + i ), t ) ) );
+	}
+#elif defined( CINDER_IP_NEON )
+	if( ip::useNeon() ) {
+		const float32x4_t t = vdupq_n_f32( time ), invT = vdupq_n_f32( invTime );
+		for( ; i + 4 <= count; i += 4 )
+			vst1q_f32( result + i, vaddq_f32( vmulq_f32( vld1q_f32( start + i ), invT ), vmulq_f32( vld1q_f32( end + i ), t ) ) );
+	}
+#endif
+	for( ; i < count; ++i )
+		result[i] = start[i] * invTime + end[i] * time;
+}
+
+} } // namespace cinder::detail
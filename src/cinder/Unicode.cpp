@@ -1,5 +1,9 @@
 #include "cinder/Unicode.h"
+#include <algorithm>
 #include <cstring>
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+	#include <emmintrin.h>
+#endif
 
 extern "C" {
 #include "linebreak.h"
@@ -10,14 +14,44 @@ using namespace std;
 
 namespace cinder {
 
+namespace {
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+// Returns how many of the bytes at \a str, which are at most \a maxBytes, form a run of ASCII, testing 16 at a time
+inline size_t asciiRunLength( const char *str, size_t maxBytes )
+{
+	size_t result = 0;
+	while( result + 16 <= maxBytes && _mm_movemask_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( str + result ) ) ) == 0 )
+		result += 16;
+	while( result < maxBytes && (uint8_t)str[result] < 0x80 )
+		++result;
+	return result;
+}
+#else
+inline size_t asciiRunLength( const char *str, size_t maxBytes )
+{
+	size_t result = 0;
+	while( result < maxBytes && (uint8_t)str[result] < 0x80 )
+		++result;
+	return result;
+}
+#endif
+} // anonymous namespace
+
 size_t stringLengthUtf8( const char *str, size_t lengthInBytes )
 {
 	size_t result = 0;
 	size_t nextByte = 0;
 	if( lengthInBytes == 0 )
 		lengthInBytes = strlen( str );
-	while( nextCharUtf8( (const char*)str, &nextByte, lengthInBytes ) != 0xFFFF )
+	// every ASCII byte is a character of its own, so runs of them are counted without decoding
+	for( ;; ) {
+		size_t asciiBytes = asciiRunLength( str + nextByte, lengthInBytes - nextByte );
+		result += asciiBytes;
+		nextByte += asciiBytes;
+		if( lb_get_next_char_utf8( (const utf8_t*)str, lengthInBytes, &nextByte ) == 0xFFFF )
+			break;
 		++result;
+	}
 	return result;	
 }
 
@@ -25,6 +59,8 @@ uint32_t nextCharUtf8( const char *str, size_t *inOutByte, size_t lengthInBytes
 {
 	if( lengthInBytes == 0 )
 		lengthInBytes = strlen( str );
+	if( *inOutByte < lengthInBytes && (uint8_t)str[*inOutByte] < 0x80 )
+		return (uint8_t)str[(*inOutByte)++];
 	return lb_get_next_char_utf8( (const utf8_t*)str, lengthInBytes, inOutByte );
 }
 
@@ -33,9 +69,16 @@ size_t advanceCharUtf8( const char *str, size_t numChars, size_t lengthInBytes )
 	if( lengthInBytes == 0 )
 		lengthInBytes = strlen( str );
 	size_t nextByte = 0;
-	for( size_t curChar = 0; curChar < numChars; ++curChar ) {
+	size_t curChar = 0;
+	while( curChar < numChars ) {
+		size_t asciiBytes = std::min( asciiRunLength( str + nextByte, lengthInBytes - nextByte ), numChars - curChar );
+		curChar += asciiBytes;
+		nextByte += asciiBytes;
+		if( curChar == numChars )
+			break;
 		if( lb_get_next_char_utf8( (const utf8_t*)str, lengthInBytes, &nextByte ) == 0xFFFF )
 			break;
+		++curChar;
 	}
 	
 	return nextByte;
@@ -46,6 +89,86 @@ bool shouldBreak( char code )
 {
 	return ( code == LINEBREAK_ALLOWBREAK ) || ( code == LINEBREAK_MUSTBREAK );
 }
+
+// Fills \a result with the first byte of each character of \a str, followed by the end of its last character
+void calcCharStartBytes( const char *str, size_t lengthInBytes, vector<size_t> *result )
+{
+	result->clear();
+	size_t nextByte = 0;
+	for( ;; ) {
+		size_t asciiBytes = asciiRunLength( str + nextByte, lengthInBytes - nextByte );
+		for( size_t b = 0; b < asciiBytes; ++b )
+			result->push_back( nextByte + b );
+		nextByte += asciiBytes;
+		size_t charStartByte = nextByte;
+		if( lb_get_next_char_utf8( (const utf8_t*)str, lengthInBytes, &nextByte ) == 0xFFFF )
+			break;
+		result->push_back( charStartByte );
+	}
+	result->push_back( nextByte );
+}
+
+// Fills \a result with the break status after each character, given the characters' first bytes from calcCharStartBytes()
+void calcCharBreaks( const char *str, size_t lengthInBytes, const vector<size_t> &charStartBytes, vector<char> *result )
+{
+	result->clear();
+	if( lengthInBytes == 0 )
+		return;
+	vector<char> brks( lengthInBytes );
+	set_linebreaks_utf8( (const uint8_t*)str, lengthInBytes, NULL, &brks[0] );
+	for( size_t c = 0; c + 1 < charStartBytes.size(); ++c )
+		result->push_back( brks[charStartBytes[c+1] - 1] );
+}
+
+// Greedily fills lines up to maxWidth, breaking at the last opportunity which fits. Every line gets at least one character, and spaces which would begin a line are skipped.
+void breakLines( const char *str, const size_t *charStartBytes, const char *charBreaks, const float *advances, size_t numChars, float maxWidth, vector<LineBreakerUtf8::Line> *result )
+{
+	size_t curChar = 0;
+	while( curChar < numChars ) {
+		const size_t lineStartChar = curChar;
+		size_t lineEndChar = numChars, lastBreakChar = lineStartChar;
+		float width = 0, widthAtLastBreak = 0, lineWidth = 0;
+		bool ended = false;
+		for( ; curChar < numChars; ++curChar ) {
+			if( curChar > lineStartChar && width + advances[curChar] > maxWidth ) {
+				if( lastBreakChar > lineStartChar ) {
+					lineEndChar = lastBreakChar;
+					lineWidth = widthAtLastBreak;
+				}
+				else { // there's no good breakpoint; just break where we would have
+					lineEndChar = curChar;
+					lineWidth = width;
+				}
+				ended = true;
+				break;
+			}
+			width += advances[curChar];
+			if( charBreaks[curChar] == LINEBREAK_MUSTBREAK ) {
+				lineEndChar = curChar + 1;
+				lineWidth = width;
+				ended = true;
+				break;
+			}
+			else if( charBreaks[curChar] == LINEBREAK_ALLOWBREAK ) {
+				lastBreakChar = curChar + 1;
+				widthAtLastBreak = width;
+			}
+		}
+		if( ! ended )
+			lineWidth = width;
+		
+		LineBreakerUtf8::Line line;
+		line.mStartByte = charStartBytes[lineStartChar];
+		line.mLengthInBytes = charStartBytes[lineEndChar] - line.mStartByte;
+		line.mWidth = lineWidth;
+		result->push_back( line );
+		
+		// eat any spaces we'd start on on the next line
+		curChar = lineEndChar;
+		while( curChar < numChars && str[charStartBytes[curChar]] == ' ' )
+			++curChar;
+	}
+}
 } // anonymous namespace
 
 void lineBreakUtf8( const char *line, const std::function<bool(const char *, size_t)> &measureFn, std::function<void(const char *,size_t)> lineProcessFn )
@@ -57,7 +180,9 @@ void lineBreakUtf8( const char *line, const std::function<bool(const char *, siz
 
 	// Byte-suffixed variables correspond to a byte in the UTF8 string, as opposed to the character
 	// binary search for the threshold where measureFn() returns false; emerges as curChar
-	size_t charLen = stringLengthUtf8( line, lengthInBytes );
+	vector<size_t> charStartBytes;
+	calcCharStartBytes( line, lengthInBytes, &charStartBytes );
+	size_t charLen = charStartBytes.size() - 1;
 	size_t lineStartByte = 0, lineEndByte = 0;
 	size_t lineStartChar = 0;
 	while( lineStartChar < charLen ) {
@@ -82,7 +207,7 @@ void lineBreakUtf8( const char *line, const std::function<bool(const char *, siz
 		
 			while( minChar < maxChar ) {
 				curChar = minChar + (maxChar-minChar+1)/2;
-				size_t newByte = advanceCharUtf8( line + lineStartByte, curChar, lengthInBytes );
+				size_t newByte = charStartBytes[lineStartChar + curChar] - lineStartByte;
 				if( ! measureFn( line + lineStartByte, newByte ) )
 					maxChar = curChar - 1;
 				else
@@ -95,7 +220,7 @@ void lineBreakUtf8( const char *line, const std::function<bool(const char *, siz
 		}
 
 		// find ideal place to perform the break, either at curChar or before depending on breaks
-		size_t lineEndByteAfterBreaking = lineEndByte = advanceCharUtf8( line + lineStartByte, curChar ) + lineStartByte;
+		size_t lineEndByteAfterBreaking = lineEndByte = charStartBytes[lineStartChar + curChar];
 		if( ( lineEndByteAfterBreaking < lengthInBytes ) /*&& ( ! shouldBreak( brks.get()[lineEndByteAfterBreaking] ) )*/ ) {
 			while( (lineEndByteAfterBreaking > lineStartByte) && ( ! shouldBreak( brks.get()[lineEndByteAfterBreaking-1] ) ) )
 				lineEndByteAfterBreaking--;
@@ -114,4 +239,44 @@ void lineBreakUtf8( const char *line, const std::function<bool(const char *, siz
 	}
 }
 
-}
\ No newline at end of file
+void lineBreakUtf8( const char *str, const float *charAdvances, float maxWidth, std::function<void(const char *,size_t)> lineProcessFn )
+{
+	const size_t lengthInBytes = strlen( str );
+	vector<size_t> charStartBytes;
+	calcCharStartBytes( str, lengthInBytes, &charStartBytes );
+	vector<char> charBreaks;
+	calcCharBreaks( str, lengthInBytes, charStartBytes, &charBreaks );
+	
+	vector<LineBreakerUtf8::Line> lines;
+	breakLines( str, &charStartBytes[0], charBreaks.empty() ? NULL : &charBreaks[0], charAdvances, charBreaks.size(), maxWidth, &lines );
+	for( vector<LineBreakerUtf8::Line>::const_iterator lineIt = lines.begin(); lineIt != lines.end(); ++lineIt )
+		lineProcessFn( str + lineIt->mStartByte, lineIt->mLengthInBytes );
+}
+
+LineBreakerUtf8::LineBreakerUtf8( const std::string &str, const std::vector<float> &charAdvances )
+	: mString( str )
+{
+	calcCharStartBytes( mString.c_str(), mString.size(), &mCharStartBytes );
+	calcCharBreaks( mString.c_str(), mString.size(), mCharStartBytes, &mCharBreaks );
+	mAdvances.assign( charAdvances.begin(), charAdvances.begin() + std::min( charAdvances.size(), mCharBreaks.size() ) );
+	mAdvances.resize( mCharBreaks.size(), 0 );
+}
+
+const vector<LineBreakerUtf8::Line>& LineBreakerUtf8::calcLines( float maxWidth )
+{
+	map<float,vector<Line> >::iterator cached = mCache.find( maxWidth );
+	if( cached != mCache.end() )
+		return cached->second;
+	
+	// a width which animates would otherwise grow the cache without bound
+	const size_t maxCachedWidths = 16;
+	if( mCache.size() >= maxCachedWidths )
+		mCache.clear();
+	
+	vector<Line> &result = mCache[maxWidth];
+	if( ! mAdvances.empty() )
+		breakLines( mString.c_str(), &mCharStartBytes[0], &mCharBreaks[0], &mAdvances[0], mAdvances.size(), maxWidth, &result );
+	return result;
+}
+
+}
@@ -0,0 +1,316 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/UrlCache.h"
+#include "cinder/DataTarget.h"
+#include "cinder/Utilities.h"
+
+#include <boost/algorithm/string/case_conv.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+namespace cinder {
+
+namespace {
+
+const char *INDEX_FILE_NAME = "index";
+const char *INDEX_HEADER = "UrlCache 1";
+
+// returns the time until which a response with the (lowercase) Cache-Control header \a cacheControl may be reused without revalidation
+std::time_t computeExpires( const std::string &cacheControl )
+{
+	if( cacheControl.find( "no-cache" ) != std::string::npos )
+		return 0;
+	size_t maxAge = cacheControl.find( "max-age=" );
+	if( maxAge == std::string::npos )
+		return 0;
+	return std::time( 0 ) + std::atol( cacheControl.c_str() + maxAge + 8 );
+}
+
+// tabs and newlines would corrupt the index, so values containing them aren't stored
+bool isIndexSafe( const std::string &s )
+{
+	return s.find_first_of( "\t\r\n" ) == std::string::npos;
+}
+
+} // anonymous namespace
+
+UrlCache::UrlCache( const fs::path &directory, uint64_t maxSize )
+	: mDirectory( directory ), mMaxSize( maxSize ), mSize( 0 ), mFileCounter( 0 )
+{
+	if( mDirectory.empty() )
+		mDirectory = getTemporaryDirectory() / "cinder_url_cache";
+	createDirectories( mDirectory );
+
+	readIndex();
+	evict();
+}
+
+UrlCacheRef UrlCache::getDefault()
+{
+	static UrlCacheRef sDefault;
+	static std::mutex sDefaultMutex;
+
+	std::lock_guard<std::mutex> lock( sDefaultMutex );
+	if( ! sDefault )
+		sDefault = UrlCache::create();
+	return sDefault;
+}
+
+DataSourceRef UrlCache::load( const Url &url, UrlDownloaderRef downloader )
+{
+	const std::string urlString = url.str();
+
+	Entry cached;
+	bool hasCached = find( urlString, &cached );
+	if( hasCached && ( std::time( 0 ) < cached.mExpires ) )
+		return loadFile( mDirectory / cached.mFileName );
+
+	std::vector<std::string> requestHeaders;
+	if( hasCached && ( ! cached.mETag.empty() ) )
+		requestHeaders.push_back( "If-None-Match: " + cached.mETag );
+	if( hasCached && ( ! cached.mLastModified.empty() ) )
+		requestHeaders.push_back( "If-Modified-Since: " + cached.mLastModified );
+
+	if( ! downloader )
+		downloader = UrlDownloader::getDefault();
+	UrlDownloadRef download = downloader->download( url, requestHeaders );
+	download->wait();
+
+	if( download->hasFailed() ) {
+		if( hasCached )
+			return loadFile( mDirectory / cached.mFileName );
+		throw StreamExc();
+	}
+
+	long responseCode = download->getResponseCode();
+	std::string cacheControl = boost::to_lower_copy( download->getResponseHeader( "Cache-Control" ) );
+	std::string eTag = download->getResponseHeader( "ETag" );
+	std::string lastModified = download->getResponseHeader( "Last-Modified" );
+
+	// not modified; the cached copy is good for another max-age
+	if( hasCached && ( responseCode == 304 ) ) {
+		cached.mExpires = computeExpires( cacheControl );
+		if( ( ! eTag.empty() ) && isIndexSafe( eTag ) )
+			cached.mETag = eTag;
+		if( ( ! lastModified.empty() ) && isIndexSafe( lastModified ) )
+			cached.mLastModified = lastModified;
+		store( cached );
+		return loadFile( mDirectory / cached.mFileName );
+	}
+
+	Buffer buffer = download->getBuffer();
+
+	// a response code of 0 means the backend doesn't report one, in which case the copy is kept as an offline fallback
+	bool cacheable = ( ( responseCode == 200 ) || ( responseCode == 0 ) ) && ( cacheControl.find( "no-store" ) == std::string::npos )
+		&& ( buffer.getDataSize() <= mMaxSize ) && isIndexSafe( urlString );
+	if( cacheable ) {
+		Entry entry;
+		entry.mUrl = urlString;
+		entry.mFileName = createFileName( urlString );
+		entry.mSize = buffer.getDataSize();
+		entry.mExpires = computeExpires( cacheControl );
+		if( isIndexSafe( eTag ) )
+			entry.mETag = eTag;
+		if( isIndexSafe( lastModified ) )
+			entry.mLastModified = lastModified;
+		try {
+			buffer.write( writeFile( mDirectory / entry.mFileName ) );
+			store( entry );
+		}
+		catch( ... ) { // caching is best-effort
+			removeFile( entry.mFileName );
+		}
+	}
+
+	return DataSourceBuffer::create( buffer, urlString );
+}
+
+void UrlCache::setMaxSize( uint64_t maxSize )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mMaxSize = maxSize;
+	evict();
+	writeIndex();
+}
+
+uint64_t UrlCache::getSize() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mSize;
+}
+
+void UrlCache::clear()
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	for( EntryList::const_iterator entryIt = mEntries.begin(); entryIt != mEntries.end(); ++entryIt )
+		removeFile( entryIt->mFileName );
+	mEntries.clear();
+	mEntryMap.clear();
+	mSize = 0;
+	writeIndex();
+}
+
+bool UrlCache::find( const std::string &url, Entry *entry )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	EntryMap::iterator mapIt = mEntryMap.find( url );
+	if( mapIt == mEntryMap.end() )
+		return false;
+
+	// the file may have been deleted behind our back, for example by a temporary directory cleaner
+	if( ! fs::exists( mDirectory / mapIt->second->mFileName ) ) {
+		mSize -= mapIt->second->mSize;
+		mEntries.erase( mapIt->second );
+		mEntryMap.erase( mapIt );
+		return false;
+	}
+
+	mEntries.splice( mEntries.begin(), mEntries, mapIt->second );
+	*entry = mEntries.front();
+	return true;
+}
+
+void UrlCache::store( const Entry &entry )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	EntryMap::iterator mapIt = mEntryMap.find( entry.mUrl );
+	if( mapIt != mEntryMap.end() ) {
+		if( mapIt->second->mFileName != entry.mFileName )
+			removeFile( mapIt->second->mFileName );
+		mSize -= mapIt->second->mSize;
+		mEntries.erase( mapIt->second );
+	}
+
+	mEntries.push_front( entry );
+	mEntryMap[entry.mUrl] = mEntries.begin();
+	mSize += entry.mSize;
+
+	evict();
+	writeIndex();
+}
+
+void UrlCache::evict()
+{
+	while( ( mSize > mMaxSize ) && ( ! mEntries.empty() ) ) {
+		const Entry &oldest = mEntries.back();
+		removeFile( oldest.mFileName );
+		mSize -= oldest.mSize;
+		mEntryMap.erase( oldest.mUrl );
+		mEntries.pop_back();
+	}
+}
+
+void UrlCache::removeFile( const std::string &fileName )
+{
+	// may fail while the file is still mapped on Windows; readIndex() deletes such orphans on the next run
+	boost::system::error_code ec;
+	fs::remove( mDirectory / fileName, ec );
+}
+
+std::string UrlCache::createFileName( const std::string &url )
+{
+	// 64-bit FNV-1a hash of the URL, which keeps its extension as a hint for loaders
+	uint64_t hash = 14695981039346656037ULL;
+	for( std::string::const_iterator c = url.begin(); c != url.end(); ++c )
+		hash = ( hash ^ (uint8_t)*c ) * 1099511628211ULL;
+
+	std::string path = url.substr( 0, url.find_first_of( "?#" ) );
+	std::string extension = fs::path( path.substr( path.find_last_of( '/' ) + 1 ) ).extension().string();
+	if( ( extension.size() > 8 ) || ( ! isIndexSafe( extension ) ) )
+		extension.clear();
+
+	std::lock_guard<std::mutex> lock( mMutex );
+	while( true ) {
+		std::ostringstream ss;
+		ss << std::hex << hash << "_" << mFileCounter++ << extension;
+		if( ! fs::exists( mDirectory / ss.str() ) )
+			return ss.str();
+	}
+}
+
+void UrlCache::readIndex()
+{
+	std::ifstream index( ( mDirectory / INDEX_FILE_NAME ).string().c_str() );
+	std::string line;
+	if( index && std::getline( index, line ) && ( line == INDEX_HEADER ) ) {
+		while( std::getline( index, line ) ) {
+			std::istringstream fields( line );
+			Entry entry;
+			std::string size, expires;
+			if( ! ( std::getline( fields, entry.mFileName, '\t' ) && std::getline( fields, size, '\t' ) && std::getline( fields, expires, '\t' )
+					&& std::getline( fields, entry.mETag, '\t' ) && std::getline( fields, entry.mLastModified, '\t' ) && std::getline( fields, entry.mUrl ) ) )
+				continue;
+			if( ( mEntryMap.count( entry.mUrl ) > 0 ) || ( ! fs::exists( mDirectory / entry.mFileName ) ) )
+				continue;
+			entry.mSize = fs::file_size( mDirectory / entry.mFileName );
+			entry.mExpires = (std::time_t)std::atol( expires.c_str() );
+			mEntries.push_back( entry );
+			mEntryMap[entry.mUrl] = --mEntries.end();
+			mSize += entry.mSize;
+		}
+	}
+
+	// delete files no entry refers to, left behind by failed writes or removals
+	std::set<std::string> referenced;
+	for( EntryList::const_iterator entryIt = mEntries.begin(); entryIt != mEntries.end(); ++entryIt )
+		referenced.insert( entryIt->mFileName );
+	referenced.insert( INDEX_FILE_NAME );
+	std::vector<std::string> orphans;
+	for( fs::directory_iterator fileIt( mDirectory ); fileIt != fs::directory_iterator(); ++fileIt ) {
+		std::string fileName = fileIt->path().filename().string();
+		if( fs::is_regular_file( fileIt->status() ) && ( referenced.count( fileName ) == 0 ) )
+			orphans.push_back( fileName );
+	}
+	for( std::vector<std::string>::const_iterator orphanIt = orphans.begin(); orphanIt != orphans.end(); ++orphanIt )
+		removeFile( *orphanIt );
+}
+
+void UrlCache::writeIndex() const
+{
+	// write a new index and move it over the old one, so a crash leaves either of them intact
+	fs::path tempPath = mDirectory / ( std::string( INDEX_FILE_NAME ) + ".tmp" );
+	{
+		std::ofstream index( tempPath.string().c_str() );
+		index << INDEX_HEADER << "\n";
+		for( EntryList::const_iterator entryIt = mEntries.begin(); entryIt != mEntries.end(); ++entryIt )
+			index << entryIt->mFileName << "\t" << entryIt->mSize << "\t" << (long)entryIt->mExpires << "\t" << entryIt->mETag << "\t"
+				<< entryIt->mLastModified << "\t" << entryIt->mUrl << "\n";
+		if( ! index )
+			return;
+	}
+
+	boost::system::error_code ec;
+	fs::rename( tempPath, mDirectory / INDEX_FILE_NAME, ec );
+}
+
+DataSourceRef loadUrlCached( const Url &url )
+{
+	return UrlCache::getDefault()->load( url );
+}
+
+} // namespace cinder
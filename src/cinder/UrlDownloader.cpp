@@ -0,0 +1,270 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/UrlDownloader.h"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <deque>
+#include <vector>
+
+#if ! ( defined( CINDER_MSW ) || defined( CINDER_COCOA ) )
+	#include "cinder/UrlImplCurl.h"
+#endif
+
+namespace cinder {
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// UrlDownload
+UrlDownload::UrlDownload( const Url &url, const std::string &user, const std::string &password, const std::vector<std::string> &requestHeaders, const CompletionFn &completionFn )
+	: mUrl( url ), mUser( user ), mPassword( password ), mRequestHeaders( requestHeaders ), mCompletionFn( completionFn ), mReady( false ), mFailed( false ), mCanceled( false ), mResponseCode( 0 )
+{
+}
+
+bool UrlDownload::isReady() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mReady;
+}
+
+bool UrlDownload::hasFailed() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mReady && mFailed;
+}
+
+void UrlDownload::wait() const
+{
+	std::unique_lock<std::mutex> lock( mMutex );
+	while( ! mReady )
+		mReadyCond.wait( lock );
+}
+
+Buffer UrlDownload::getBuffer() const
+{
+	wait();
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mBuffer;
+}
+
+long UrlDownload::getResponseCode() const
+{
+	wait();
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mResponseCode;
+}
+
+std::string UrlDownload::getResponseHeader( const std::string &name ) const
+{
+	wait();
+	std::lock_guard<std::mutex> lock( mMutex );
+	for( HeaderList::const_iterator headerIt = mResponseHeaders.begin(); headerIt != mResponseHeaders.end(); ++headerIt ) {
+		if( boost::iequals( headerIt->first, name ) )
+			return headerIt->second;
+	}
+	return std::string();
+}
+
+void UrlDownload::cancel()
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mCanceled = true;
+}
+
+bool UrlDownload::isCanceled() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mCanceled;
+}
+
+void UrlDownload::setResult( const Buffer &buffer, long responseCode, const HeaderList &responseHeaders, bool failed )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mBuffer = ( failed ) ? Buffer() : buffer;
+	mResponseCode = responseCode;
+	mResponseHeaders = responseHeaders;
+	mFailed = failed;
+	mReady = true;
+	mReadyCond.notify_all();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// UrlDownloaderImpl
+void UrlDownloaderImpl::complete( const UrlDownloadRef &download, const Buffer &buffer, long responseCode, const UrlDownload::HeaderList &responseHeaders, bool failed )
+{
+	download->setResult( buffer, responseCode, responseHeaders, failed );
+	if( download->mCompletionFn )
+		download->mCompletionFn( download );
+}
+
+#if defined( CINDER_MSW ) || defined( CINDER_COCOA )
+
+namespace {
+
+// Runs each download to completion through IStreamUrl on a pool of threads
+class UrlDownloaderImplStream : public UrlDownloaderImpl {
+  public:
+	UrlDownloaderImplStream( int32_t maxConcurrent )
+		: mQuit( false )
+	{
+		for( int32_t t = 0; t < std::max<int32_t>( 1, maxConcurrent ); ++t )
+			mThreads.push_back( std::shared_ptr<std::thread>( new std::thread( std::bind( &UrlDownloaderImplStream::threadFn, this ) ) ) );
+	}
+
+	~UrlDownloaderImplStream()
+	{
+		std::deque<UrlDownloadRef> abandoned;
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			mQuit = true;
+			abandoned.swap( mPending );
+		}
+		mPendingCond.notify_all();
+		for( std::vector<std::shared_ptr<std::thread> >::iterator threadIt = mThreads.begin(); threadIt != mThreads.end(); ++threadIt )
+			(*threadIt)->join();
+
+		for( std::deque<UrlDownloadRef>::iterator downloadIt = abandoned.begin(); downloadIt != abandoned.end(); ++downloadIt )
+			complete( *downloadIt, Buffer(), 0, true );
+	}
+
+	virtual void enqueue( const UrlDownloadRef &download )
+	{
+		{
+			std::lock_guard<std::mutex> lock( mMutex );
+			mPending.push_back( download );
+		}
+		mPendingCond.notify_one();
+	}
+
+	virtual size_t getNumPending() const
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		return mPending.size();
+	}
+
+  private:
+	void threadFn()
+	{
+		ThreadSetup threadSetup;
+
+		while( true ) {
+			UrlDownloadRef download;
+			{
+				std::unique_lock<std::mutex> lock( mMutex );
+				while( ( ! mQuit ) && mPending.empty() )
+					mPendingCond.wait( lock );
+				if( mQuit )
+					return;
+				download = mPending.front();
+				mPending.pop_front();
+			}
+
+			if( download->isCanceled() ) {
+				complete( download, Buffer(), 0, true );
+				continue;
+			}
+
+			try {
+				Buffer buffer = loadStreamBuffer( loadUrlStream( download->getUrl().str(), getUser( download ), getPassword( download ) ) );
+				complete( download, buffer, 0, download->isCanceled() );
+			}
+			catch( ... ) {
+				complete( download, Buffer(), 0, true );
+			}
+		}
+	}
+
+	std::vector<std::shared_ptr<std::thread> >	mThreads;
+	mutable std::mutex							mMutex;
+	std::condition_variable						mPendingCond;
+	std::deque<UrlDownloadRef>					mPending;
+	bool										mQuit;
+};
+
+} // anonymous namespace
+
+typedef UrlDownloaderImplStream		UrlDownloaderPlatformImpl;
+static const bool sPlatformSupportsHeaders = false;
+
+#else
+
+typedef UrlDownloaderImplCurl		UrlDownloaderPlatformImpl;
+static const bool sPlatformSupportsHeaders = true;
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// UrlDownloader
+UrlDownloader::UrlDownloader( int32_t maxConcurrent )
+	: mImpl( new UrlDownloaderPlatformImpl( std::max<int32_t>( 1, maxConcurrent ) ) )
+{
+}
+
+UrlDownloader::~UrlDownloader()
+{
+}
+
+UrlDownloaderRef UrlDownloader::getDefault()
+{
+	static UrlDownloaderRef sDefault;
+	static std::mutex sDefaultMutex;
+
+	std::lock_guard<std::mutex> lock( sDefaultMutex );
+	if( ! sDefault )
+		sDefault = UrlDownloader::create();
+	return sDefault;
+}
+
+UrlDownloadRef UrlDownloader::download( const Url &url, const UrlDownload::CompletionFn &completionFn )
+{
+	return download( url, "", "", completionFn );
+}
+
+UrlDownloadRef UrlDownloader::download( const Url &url, const std::string &user, const std::string &password, const UrlDownload::CompletionFn &completionFn )
+{
+	UrlDownloadRef result( new UrlDownload( url, user, password, std::vector<std::string>(), completionFn ) );
+	mImpl->enqueue( result );
+	return result;
+}
+
+UrlDownloadRef UrlDownloader::download( const Url &url, const std::vector<std::string> &requestHeaders, const UrlDownload::CompletionFn &completionFn )
+{
+	UrlDownloadRef result( new UrlDownload( url, "", "", requestHeaders, completionFn ) );
+	mImpl->enqueue( result );
+	return result;
+}
+
+bool UrlDownloader::supportsHeaders()
+{
+	return sPlatformSupportsHeaders;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Free functions
+UrlDownloadRef loadUrlAsync( const Url &url, const UrlDownload::CompletionFn &completionFn )
+{
+	return UrlDownloader::getDefault()->download( url, completionFn );
+}
+
+} // namespace cinder
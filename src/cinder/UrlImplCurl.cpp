@@ -24,6 +24,10 @@
 
 #include <curl/curl.h>
 #include <boost/noncopyable.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <algorithm>
+#include <limits>
+#include <sstream>
 
 namespace cinder {
 
@@ -65,10 +69,15 @@ CURLLib* CURLLib::instance()
 
 IStreamUrlImplCurl::IStreamUrlImplCurl( const std::string &url, const std::string &user, const std::string &password )
 	: IStreamUrlImpl( user, password ), still_running( 1 ), mSizeCached( false ), mBufferFileOffset( 0 ), mStartedRead( false ),
-	mEffectiveUrl( 0 ), mResponseCode( 0 )
+	mEffectiveUrl( 0 ), mResponseCode( 0 ), mTransferPending( false ), mTransferOffset( 0 ), mSkipBytes( 0 ), mRangeRequested( false ),
+	mCheckedRange( false ), mBlockCacheUses( 0 )
 {	
 	if( ! CURLLib::instance() )
 		throw StreamExc(); // for some reason the curl lib isn't initialized, and we're screwed
+
+	std::string scheme = url.substr( 0, url.find( ':' ) );
+	std::transform( scheme.begin(), scheme.end(), scheme.begin(), static_cast<int(*)(int)>( tolower ) );
+	mRangesSupported = ( scheme == "http" ) || ( scheme == "https" );
 	
 	mMulti = curl_multi_init();
 
@@ -103,28 +112,24 @@ size_t IStreamUrlImplCurl::writeCallback( char *buffer, size_t size, size_t nite
 	cinder::IStreamUrlImplCurl *stream = (cinder::IStreamUrlImplCurl*)userp;
 	size *= nitems;
 
-	int roomInBuffer = stream->mBufferSize - stream->mBufferedBytes;
-
-	if( (off_t)size > roomInBuffer ) {
-		// not enough space in buffer
-		int oldBufferSize = stream->mBufferSize;
-		while( stream->mBufferSize - stream->mBufferedBytes <= (off_t)size )
-			stream->mBufferSize *= 2;
-		uint8_t *newBuff = reinterpret_cast<uint8_t*>( realloc( stream->mBuffer, stream->mBufferSize ) );
-		if( ! newBuff ) { // allocation failed - just copy the bytes we can fit
-			size = stream->bufferRemaining();
-			stream->mBufferSize = oldBufferSize;
-		}
-		else {
-			// realloc suceeded increase buffer size
-			stream->mBuffer = newBuff;
-		}
+	if( ! stream->mCheckedRange )
+		stream->checkRange();
+
+	size_t skipped = 0;
+	if( stream->mSkipBytes > 0 ) {
+		skipped = (size_t)std::min<off_t>( stream->mSkipBytes, (off_t)size );
+		stream->mSkipBytes -= skipped;
+		buffer += skipped;
+		size -= skipped;
 	}
 
+	if( ! stream->reserveBuffer( (int)size ) ) // allocation failed - just copy the bytes we can fit
+		size = stream->mBufferSize - stream->mBufferedBytes;
+
 	memcpy( &stream->mBuffer[stream->mBufferedBytes], buffer, size );
 	stream->mBufferedBytes += size;
 
-	return size;
+	return skipped + size;
 }
 
 } // extern "C"
@@ -141,29 +146,161 @@ IStreamUrlImplCurl::~IStreamUrlImplCurl()
 		curl_multi_cleanup( mMulti );
 }
 
-bool IStreamUrlImplCurl::isEof() const
+bool IStreamUrlImplCurl::reserveBuffer( int bytes ) const
 {
-	return ( mBufferedBytes - mBufferOffset == 0 ) && ( ! still_running );
+	if( mBufferSize - mBufferedBytes >= bytes )
+		return true;
+
+	int newBufferSize = mBufferSize;
+	while( newBufferSize - mBufferedBytes <= bytes )
+		newBufferSize *= 2;
+	uint8_t *newBuff = reinterpret_cast<uint8_t*>( realloc( mBuffer, newBufferSize ) );
+	if( ! newBuff )
+		return false;
+
+	mBuffer = newBuff;
+	mBufferSize = newBufferSize;
+	return true;
 }
 
-void IStreamUrlImplCurl::seekRelative( off_t relativeOffset )
+void IStreamUrlImplCurl::startTransfer( off_t offset ) const
 {
-	// if this move stays inside the current buffer, we're good
-	if( ( mBufferOffset + relativeOffset >= 0 ) && ( mBufferOffset + relativeOffset < mBufferedBytes ) ) {
-		mBufferOffset += relativeOffset;
+	mTransferPending = false;
+	if( mSizeCached && ( offset >= mSize ) ) { // nothing left to request
+		still_running = 0;
 		return;
 	}
-	else if( relativeOffset < 0 ) {	// if we're moving backwards out of the buffer, we have to reset
-		throw StreamExc(); // need to implement this
+
+	mTransferOffset = offset;
+	mRangeRequested = ( offset > 0 ) && mRangesSupported;
+	mSkipBytes = mRangeRequested ? 0 : offset;
+	mCheckedRange = false;
+	if( mRangeRequested ) {
+		std::ostringstream range;
+		range << (long long)offset << "-";
+		curl_easy_setopt( mCurl, CURLOPT_RANGE, range.str().c_str() );
+	}
+	else
+		curl_easy_setopt( mCurl, CURLOPT_RANGE, (const char*)NULL );
+
+	curl_multi_remove_handle( mMulti, mCurl );
+	curl_multi_add_handle( mMulti, mCurl );
+	mStartedRead = true;
+	while( curl_multi_perform( mMulti, &still_running ) == CURLM_CALL_MULTI_PERFORM );
+}
+
+void IStreamUrlImplCurl::stopTransfer() const
+{
+	curl_multi_remove_handle( mMulti, mCurl );
+	still_running = 0;
+}
+
+void IStreamUrlImplCurl::checkRange() const
+{
+	mCheckedRange = true;
+
+	long responseCode = 0;
+	curl_easy_getinfo( mCurl, CURLINFO_RESPONSE_CODE, &responseCode );
+	if( mRangeRequested ) {
+		if( responseCode == 416 ) { // the range starts beyond the end, so the body is an error message
+			mSize = mTransferOffset;
+			mSizeCached = true;
+			mSkipBytes = std::numeric_limits<off_t>::max();
+			return;
+		}
+		else if( responseCode != 206 ) { // the server ignored the range and sent everything, so skip up to it and don't bother asking again
+			mRangeRequested = mRangesSupported = false;
+			mSkipBytes = mTransferOffset;
+		}
+	}
+
+	if( ! mSizeCached ) {
+		double contentLength = 0;
+		if( ( curl_easy_getinfo( mCurl, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &contentLength ) == CURLE_OK ) && ( contentLength > 0 ) ) {
+			mSize = (off_t)contentLength + ( mRangeRequested ? mTransferOffset : 0 );
+			mSizeCached = true;
+		}
 	}
-	else { // moving forward off the end of the buffer - keep buffering til we're in range
-		throw StreamExc(); // need to implement this		
+}
+
+void IStreamUrlImplCurl::cacheBuffered( int bytes ) const
+{
+	for( off_t block = ( mBufferFileOffset + BLOCK_SIZE - 1 ) / BLOCK_SIZE; ( block + 1 ) * BLOCK_SIZE <= mBufferFileOffset + bytes; ++block ) {
+		if( mBlockCache.find( block ) != mBlockCache.end() )
+			continue;
+
+		// evict the least recently used block
+		if( mBlockCache.size() >= MAX_CACHED_BLOCKS ) {
+			std::map<off_t,CachedBlock>::iterator oldest = mBlockCache.begin();
+			for( std::map<off_t,CachedBlock>::iterator blockIt = mBlockCache.begin(); blockIt != mBlockCache.end(); ++blockIt )
+				if( blockIt->second.mLastUse < oldest->second.mLastUse )
+					oldest = blockIt;
+			mBlockCache.erase( oldest );
+		}
+
+		CachedBlock &cached = mBlockCache[block];
+		const uint8_t *data = mBuffer + ( block * BLOCK_SIZE - mBufferFileOffset );
+		cached.mData.assign( data, data + BLOCK_SIZE );
+		cached.mLastUse = mBlockCacheUses++;
 	}
 }
 
+bool IStreamUrlImplCurl::appendCachedBlock() const
+{
+	off_t offset = mBufferFileOffset + mBufferedBytes;
+	std::map<off_t,CachedBlock>::iterator blockIt = mBlockCache.find( offset / BLOCK_SIZE );
+	if( blockIt == mBlockCache.end() )
+		return false;
+
+	int blockOffset = (int)( offset % BLOCK_SIZE );
+	int bytes = (int)blockIt->second.mData.size() - blockOffset;
+	if( ! reserveBuffer( bytes ) )
+		return false;
+
+	memcpy( &mBuffer[mBufferedBytes], &blockIt->second.mData[blockOffset], bytes );
+	mBufferedBytes += bytes;
+	blockIt->second.mLastUse = mBlockCacheUses++;
+	return true;
+}
+
+bool IStreamUrlImplCurl::isEof() const
+{
+	return ( mBufferedBytes - mBufferOffset == 0 ) && ( ! still_running ) && ( ! mTransferPending );
+}
+
+void IStreamUrlImplCurl::seekRelative( off_t relativeOffset )
+{
+	seekAbsolute( mBufferFileOffset + mBufferOffset + relativeOffset );
+}
+
 void IStreamUrlImplCurl::seekAbsolute( off_t absoluteOffset )
 {
-	seekRelative( absoluteOffset - ( mBufferFileOffset + mBufferOffset ) );
+	if( absoluteOffset < 0 )
+		throw StreamExc();
+
+	// if this move stays inside the current buffer, we're good
+	if( ( absoluteOffset >= mBufferFileOffset ) && ( absoluteOffset <= mBufferFileOffset + mBufferedBytes ) ) {
+		mBufferOffset = (int)( absoluteOffset - mBufferFileOffset );
+		return;
+	}
+
+	// a short hop forward is cheaper to read through than a new request
+	off_t skipAhead = absoluteOffset - ( mBufferFileOffset + mBufferedBytes );
+	if( ( skipAhead > 0 ) && ( skipAhead <= MAX_SKIP_AHEAD ) && still_running && ( ! mTransferPending ) ) {
+		mBufferOffset = mBufferedBytes;
+		fillBuffer( (int)skipAhead );
+		if( absoluteOffset <= mBufferFileOffset + mBufferedBytes ) {
+			mBufferOffset = (int)( absoluteOffset - mBufferFileOffset );
+			return;
+		}
+	}
+
+	// otherwise drop the buffer, keeping its complete blocks, and restart the transfer at the new offset on the next read
+	cacheBuffered( mBufferedBytes );
+	stopTransfer();
+	mBufferFileOffset = absoluteOffset;
+	mBufferOffset = mBufferedBytes = 0;
+	mTransferPending = true;
 }
 
 off_t IStreamUrlImplCurl::tell() const
@@ -183,7 +320,7 @@ off_t IStreamUrlImplCurl::size() const
 			double tempSize = 0;
 			CURLcode result = curl_easy_getinfo( mCurl, CURLINFO_CONTENT_LENGTH_DOWNLOAD, &tempSize );
 			if( ( result == CURLE_OK ) && ( tempSize > 0 ) ) {
-				mSize = (off_t)tempSize;
+				mSize = (off_t)tempSize + ( mRangeRequested ? mTransferOffset : 0 );
 				mSizeCached = true;
 			}
 			else
@@ -193,7 +330,7 @@ off_t IStreamUrlImplCurl::size() const
 			double tempSize = 0;
 			CURLcode result = curl_easy_getinfo( mCurl, CURLINFO_SIZE_DOWNLOAD, &tempSize );
 			if( ( result == CURLE_OK ) && ( tempSize > 0 ) ) {
-				mSize = (off_t)tempSize;
+				mSize = (off_t)tempSize + ( mRangeRequested ? mTransferOffset : 0 );
 				mSizeCached = true;
 			}
 			else
@@ -205,6 +342,15 @@ off_t IStreamUrlImplCurl::size() const
 
 void IStreamUrlImplCurl::fillBuffer( int wantBytes ) const
 {
+	// after a seek, serve what we can from the block cache and then request the rest from where the buffer ends
+	if( mTransferPending ) {
+		while( ( bufferRemaining() < wantBytes ) && appendCachedBlock() )
+			;
+		if( bufferRemaining() >= wantBytes )
+			return;
+		startTransfer( mBufferFileOffset + mBufferedBytes );
+	}
+
 	// first make sure we've started reading, and do so if not
 	if( ! mStartedRead ) {
 		while( curl_multi_perform( mMulti, &still_running ) == CURLM_CALL_MULTI_PERFORM );
@@ -221,9 +367,10 @@ void IStreamUrlImplCurl::fillBuffer( int wantBytes ) const
     if( ( ! still_running ) || ( bufferRemaining() >= wantBytes ) )
         return;
 
-	// if we want more bytes than will fit in the rest of the buffer, let's make some room
+	// if we want more bytes than will fit in the rest of the buffer, let's make some room, keeping the complete blocks we drop
 	if( mBufferSize - mBufferedBytes < wantBytes ) {
 		int bytesCulled = mBufferOffset;
+		cacheBuffered( bytesCulled );
 		memmove( mBuffer, &mBuffer[mBufferOffset], mBufferedBytes - bytesCulled );
 		mBufferedBytes -= bytesCulled;
 		mBufferOffset = 0;
@@ -248,6 +395,11 @@ void IStreamUrlImplCurl::fillBuffer( int wantBytes ) const
 
 		// get file descriptors from the transfers
 		curl_multi_fdset( mMulti, &fdread, &fdwrite, &fdexcep, &maxfd );
+		// no sockets yet, such as while resolving the host after a seek restarted the transfer, so poll again shortly
+		if( maxfd == -1 ) {
+			timeout.tv_sec = 0;
+			timeout.tv_usec = 100 * 1000;
+		}
 
 		int rc = select( maxfd + 1, &fdread, &fdwrite, &fdexcep, &timeout );
 
@@ -256,6 +408,8 @@ void IStreamUrlImplCurl::fillBuffer( int wantBytes ) const
 				throw StreamExc();
 			break;
 			case 0:
+				if( maxfd == -1 )
+					while( curl_multi_perform( mMulti, &still_running ) == CURLM_CALL_MULTI_PERFORM );
 			break;
 			default:
 				// timeout or readable/writable sockets
@@ -317,4 +471,251 @@ std::string	IStreamUrlImplCurl::getEffectiveUrl() const
 	return std::string( mEffectiveUrl );
 }*/
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+// UrlDownloaderImplCurl
+UrlDownloaderImplCurl::UrlDownloaderImplCurl( int32_t maxConcurrent )
+	: mMaxConcurrent( maxConcurrent ), mQuit( false )
+{
+	if( ! CURLLib::instance() )
+		throw StreamExc();
+
+	mMulti = curl_multi_init();
+	// keep one idle connection per concurrent transfer so that requests to the same host skip the TCP and TLS handshakes
+	curl_multi_setopt( mMulti, CURLMOPT_MAXCONNECTS, (long)mMaxConcurrent );
+
+	mThread = std::shared_ptr<std::thread>( new std::thread( std::bind( &UrlDownloaderImplCurl::threadFn, this ) ) );
+}
+
+UrlDownloaderImplCurl::~UrlDownloaderImplCurl()
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mQuit = true;
+	}
+	mPendingCond.notify_all();
+	mThread->join();
+
+	for( std::vector<CURL*>::iterator handleIt = mIdleHandles.begin(); handleIt != mIdleHandles.end(); ++handleIt )
+		curl_easy_cleanup( *handleIt );
+	curl_multi_cleanup( mMulti );
+}
+
+void UrlDownloaderImplCurl::enqueue( const UrlDownloadRef &download )
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mPending.push_back( download );
+	}
+	mPendingCond.notify_one();
+}
+
+size_t UrlDownloaderImplCurl::getNumPending() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mPending.size();
+}
+
+void UrlDownloaderImplCurl::threadFn()
+{
+	ThreadSetup threadSetup;
+
+	while( true ) {
+		std::vector<UrlDownloadRef> starting;
+		{
+			std::unique_lock<std::mutex> lock( mMutex );
+			while( ( ! mQuit ) && mPending.empty() && mActive.empty() )
+				mPendingCond.wait( lock );
+			if( mQuit )
+				break;
+			while( ( ! mPending.empty() ) && ( mActive.size() + starting.size() < (size_t)mMaxConcurrent ) ) {
+				starting.push_back( mPending.front() );
+				mPending.pop_front();
+			}
+		}
+
+		for( std::vector<UrlDownloadRef>::const_iterator downloadIt = starting.begin(); downloadIt != starting.end(); ++downloadIt )
+			startTransfer( *downloadIt );
+
+		// a canceled transfer may be stalled and never reach writeCallback(), so abandon it here
+		for( size_t t = mActive.size(); t > 0; --t ) {
+			if( mActive[t - 1]->mDownload->isCanceled() )
+				finishTransfer( mActive[t - 1], 0, true );
+		}
+
+		int stillRunning;
+		while( curl_multi_perform( mMulti, &stillRunning ) == CURLM_CALL_MULTI_PERFORM );
+
+		CURLMsg *msg;
+		int msgsLeft;
+		while( ( msg = curl_multi_info_read( mMulti, &msgsLeft ) ) != 0 ) {
+			if( msg->msg != CURLMSG_DONE )
+				continue;
+			char *privateData = 0;
+			curl_easy_getinfo( msg->easy_handle, CURLINFO_PRIVATE, &privateData );
+			long responseCode = 0;
+			curl_easy_getinfo( msg->easy_handle, CURLINFO_RESPONSE_CODE, &responseCode );
+			bool failed = ( msg->data.result != CURLE_OK ) || ( responseCode >= 400 );
+			finishTransfer( reinterpret_cast<Transfer*>( privateData ), responseCode, failed );
+		}
+
+		if( ! mActive.empty() )
+			waitForActivity();
+	}
+
+	// shutting down; everything unfinished fails
+	while( ! mActive.empty() )
+		finishTransfer( mActive.back(), 0, true );
+
+	std::deque<UrlDownloadRef> abandoned;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		abandoned.swap( mPending );
+	}
+	for( std::deque<UrlDownloadRef>::iterator downloadIt = abandoned.begin(); downloadIt != abandoned.end(); ++downloadIt )
+		complete( *downloadIt, Buffer(), 0, true );
+}
+
+void UrlDownloaderImplCurl::startTransfer( const UrlDownloadRef &download )
+{
+	if( download->isCanceled() ) {
+		complete( download, Buffer(), 0, true );
+		return;
+	}
+
+	Transfer *transfer = new Transfer;
+	transfer->mDownload = download;
+	transfer->mBuffer = Buffer( INITIAL_BUFFER_SIZE );
+	transfer->mSize = 0;
+	transfer->mRequestHeaders = 0;
+	if( ! mIdleHandles.empty() ) {
+		transfer->mCurl = mIdleHandles.back();
+		mIdleHandles.pop_back();
+	}
+	else
+		transfer->mCurl = curl_easy_init();
+
+	CURL *curl = transfer->mCurl;
+	curl_easy_setopt( curl, CURLOPT_URL, download->getUrl().c_str() );
+	curl_easy_setopt( curl, CURLOPT_WRITEDATA, transfer );
+	curl_easy_setopt( curl, CURLOPT_PRIVATE, transfer );
+	curl_easy_setopt( curl, CURLOPT_VERBOSE, 0L );
+	curl_easy_setopt( curl, CURLOPT_FOLLOWLOCATION, 1L );
+	curl_easy_setopt( curl, CURLOPT_NOSIGNAL, 1L ); // signals can't be used for timeouts off the main thread
+	curl_easy_setopt( curl, CURLOPT_ENCODING, "" ); // accept any compression curl supports
+	curl_easy_setopt( curl, CURLOPT_WRITEFUNCTION, UrlDownloaderImplCurl::writeCallback );
+	curl_easy_setopt( curl, CURLOPT_HEADERDATA, transfer );
+	curl_easy_setopt( curl, CURLOPT_HEADERFUNCTION, UrlDownloaderImplCurl::headerCallback );
+
+	const std::vector<std::string> &requestHeaders = getRequestHeaders( download );
+	for( std::vector<std::string>::const_iterator headerIt = requestHeaders.begin(); headerIt != requestHeaders.end(); ++headerIt )
+		transfer->mRequestHeaders = curl_slist_append( transfer->mRequestHeaders, headerIt->c_str() );
+	if( transfer->mRequestHeaders )
+		curl_easy_setopt( curl, CURLOPT_HTTPHEADER, transfer->mRequestHeaders );
+
+	const std::string &user = getUser( download ), &password = getPassword( download );
+	if( ( ! user.empty() ) || ( ! password.empty() ) ) {
+		transfer->mUserColonPassword = user + ":" + password;
+		curl_easy_setopt( curl, CURLOPT_USERPWD, transfer->mUserColonPassword.c_str() );
+		curl_easy_setopt( curl, CURLOPT_HTTPAUTH, CURLAUTH_ANY );
+	}
+
+	mActive.push_back( transfer );
+	curl_multi_add_handle( mMulti, curl );
+}
+
+void UrlDownloaderImplCurl::finishTransfer( Transfer *transfer, long responseCode, bool failed )
+{
+	curl_multi_remove_handle( mMulti, transfer->mCurl );
+	// the connection stays in the multi handle's cache, so the easy handle itself only needs its options cleared
+	curl_easy_reset( transfer->mCurl );
+	if( mIdleHandles.size() < (size_t)mMaxConcurrent )
+		mIdleHandles.push_back( transfer->mCurl );
+	else
+		curl_easy_cleanup( transfer->mCurl );
+
+	if( transfer->mRequestHeaders )
+		curl_slist_free_all( transfer->mRequestHeaders );
+
+	mActive.erase( std::find( mActive.begin(), mActive.end(), transfer ) );
+
+	transfer->mBuffer.setDataSize( transfer->mSize );
+	complete( transfer->mDownload, transfer->mBuffer, responseCode, transfer->mResponseHeaders, failed || transfer->mDownload->isCanceled() );
+	delete transfer;
+}
+
+void UrlDownloaderImplCurl::waitForActivity()
+{
+	long timeoutMs = -1;
+	curl_multi_timeout( mMulti, &timeoutMs );
+	if( ( timeoutMs < 0 ) || ( timeoutMs > MAX_WAIT_MS ) )
+		timeoutMs = MAX_WAIT_MS;
+	if( timeoutMs == 0 )
+		return;
+
+	fd_set fdread;
+	fd_set fdwrite;
+	fd_set fdexcep;
+	int maxfd = -1;
+	struct timeval timeout;
+
+	FD_ZERO( &fdread );
+	FD_ZERO( &fdwrite );
+	FD_ZERO( &fdexcep );
+
+	timeout.tv_sec = timeoutMs / 1000;
+	timeout.tv_usec = ( timeoutMs % 1000 ) * 1000;
+
+	// with no sockets yet (during name resolution for example) this is just a sleep
+	curl_multi_fdset( mMulti, &fdread, &fdwrite, &fdexcep, &maxfd );
+	select( maxfd + 1, &fdread, &fdwrite, &fdexcep, &timeout );
+}
+
+extern "C" {
+
+size_t UrlDownloaderImplCurl::writeCallback( char *buffer, size_t size, size_t nitems, void *userp )
+{
+	Transfer *transfer = reinterpret_cast<Transfer*>( userp );
+	size *= nitems;
+
+	// returning less than size aborts the transfer
+	if( transfer->mDownload->isCanceled() )
+		return 0;
+
+	if( transfer->mSize + size > transfer->mBuffer.getAllocatedSize() ) {
+		size_t newSize = transfer->mBuffer.getAllocatedSize() * 2;
+		while( newSize < transfer->mSize + size )
+			newSize *= 2;
+		transfer->mBuffer.resize( newSize );
+		if( ! transfer->mBuffer.getData() )
+			return 0;
+	}
+
+	memcpy( reinterpret_cast<uint8_t*>( transfer->mBuffer.getData() ) + transfer->mSize, buffer, size );
+	transfer->mSize += size;
+
+	return size;
+}
+
+size_t UrlDownloaderImplCurl::headerCallback( char *buffer, size_t size, size_t nitems, void *userp )
+{
+	Transfer *transfer = reinterpret_cast<Transfer*>( userp );
+	size *= nitems;
+
+	std::string line( buffer, size );
+	if( line.compare( 0, 5, "HTTP/" ) == 0 ) // a status line starts a new response, as after a redirect
+		transfer->mResponseHeaders.clear();
+	else {
+		size_t colon = line.find( ':' );
+		if( colon != std::string::npos ) {
+			std::string value = line.substr( colon + 1 );
+			boost::trim( value );
+			transfer->mResponseHeaders.push_back( std::make_pair( line.substr( 0, colon ), value ) );
+		}
+	}
+
+	return size;
+}
+
+} // extern "C"
+
 } // namespace cinder
\ No newline at end of file
@@ -41,6 +41,10 @@
 	#import <Foundation/NSFileManager.h>
 	#include <cxxabi.h>
 	#include <execinfo.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
 #else
 	#include <windows.h>
 	#include <Shlwapi.h>
@@ -48,7 +52,13 @@
 	#include "cinder/msw/StackWalker.h"
 #endif
 
+#include "cinder/ip/Simd.h"
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#endif
+
 #include <vector>
+#include <algorithm>
 #include <boost/tokenizer.hpp>
 #include <boost/algorithm/string.hpp>
 
@@ -232,6 +242,71 @@ void deleteFile( const fs::path &path )
 #endif
 }
 
+#if defined( CINDER_COCOA )
+namespace { // anonymous namespace
+struct FileUnmapper {
+	FileUnmapper( size_t size ) : mSize( size ) {}
+	void operator()( const void *address ) const { ::munmap( const_cast<void*>( address ), mSize ); }
+
+	size_t	mSize;
+};
+} // anonymous namespace
+
+std::shared_ptr<const void> mapFile( const fs::path &path, size_t *size )
+{
+	int fd = ::open( path.c_str(), O_RDONLY );
+	if( fd < 0 )
+		return std::shared_ptr<const void>();
+	struct stat st;
+	void *address = MAP_FAILED;
+	if( ( ::fstat( fd, &st ) == 0 ) && ( st.st_size > 0 ) )
+		address = ::mmap( 0, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+	::close( fd ); // the mapping holds its own reference to the file
+	if( address == MAP_FAILED )
+		return std::shared_ptr<const void>();
+
+	*size = (size_t)st.st_size;
+	return std::shared_ptr<const void>( address, FileUnmapper( (size_t)st.st_size ) );
+}
+#else
+namespace { // anonymous namespace
+struct FileUnmapper {
+	FileUnmapper( HANDLE file, HANDLE mapping ) : mFile( file ), mMapping( mapping ) {}
+	void operator()( const void *view ) const
+	{
+		::UnmapViewOfFile( view );
+		::CloseHandle( mMapping );
+		::CloseHandle( mFile );
+	}
+
+	HANDLE	mFile, mMapping;
+};
+} // anonymous namespace
+
+std::shared_ptr<const void> mapFile( const fs::path &path, size_t *size )
+{
+	HANDLE file = ::CreateFileW( toUtf16( path.string() ).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+	if( file == INVALID_HANDLE_VALUE )
+		return std::shared_ptr<const void>();
+	LARGE_INTEGER fileSize;
+	HANDLE mapping = NULL;
+	const void *view = NULL;
+	if( ::GetFileSizeEx( file, &fileSize ) && ( fileSize.QuadPart > 0 ) )
+		mapping = ::CreateFileMappingW( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	if( mapping )
+		view = ::MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	if( ! view ) {
+		if( mapping )
+			::CloseHandle( mapping );
+		::CloseHandle( file );
+		return std::shared_ptr<const void>();
+	}
+
+	*size = (size_t)fileSize.QuadPart;
+	return std::shared_ptr<const void>( view, FileUnmapper( file, mapping ) );
+}
+#endif
+
 std::vector<std::string> split( const std::string &str, char separator, bool compress )
 {
 	return split( str, string( 1, separator ), compress );
@@ -249,12 +324,11 @@ std::vector<std::string> split( const std::string &str, const std::string &separ
 
 string loadString( DataSourceRef dataSource )
 {
-	Buffer loadedBuffer( dataSource );
-	size_t dataSize = loadedBuffer.getDataSize();
-	Buffer padded( dataSize + 1 );
-	memcpy( padded.getData(), loadedBuffer.getData(), dataSize );
-	(static_cast<uint8_t*>( padded.getData() ))[dataSize] = 0;
-	return string( static_cast<const char*>( padded.getData() ) );
+	Buffer loadedBuffer = loadDataSourceBuffer( dataSource );
+	const char *data = static_cast<const char*>( loadedBuffer.getData() );
+	// the string ends at the first null, as it always has
+	const void *end = memchr( data, 0, loadedBuffer.getDataSize() );
+	return string( data, end ? static_cast<const char*>( end ) : data + loadedBuffer.getDataSize() );
 }
 
 wstring toUtf16( const string &utf8 )
@@ -443,24 +517,80 @@ double swapEndian( double val ) {
 	return s2.d;
 }
 
+namespace { // anonymous namespace
+#if defined( CINDER_IP_SSE2 )
+inline __m128i swapBytes16( __m128i v ) { return _mm_or_si128( _mm_slli_epi16( v, 8 ), _mm_srli_epi16( v, 8 ) ); }
+#endif
+
+// reverses the bytes of each of the BYTES-sized values in the block
+template<size_t BYTES>
+void swapBlock( void *blockPtr, size_t blockSizeInBytes )
+{
+	uint8_t *p = reinterpret_cast<uint8_t*>( blockPtr );
+	size_t count = blockSizeInBytes / BYTES, i = 0;
+#if defined( CINDER_IP_SSE2 )
+	// swap the bytes of each 16-bit word, then reverse the words within each value
+	if( ip::useSse2() ) {
+		for( ; i + 16 / BYTES <= count; i += 16 / BYTES ) {
+			__m128i v = swapBytes16( _mm_loadu_si128( reinterpret_cast<const __m128i*>( p + i * BYTES ) ) );
+			if( BYTES == 4 )
+				v = _mm_shufflehi_epi16( _mm_shufflelo_epi16( v, _MM_SHUFFLE( 2, 3, 0, 1 ) ), _MM_SHUFFLE( 2, 3, 0, 1 ) );
+			else if( BYTES == 8 )
+				v = _mm_shufflehi_epi16( _mm_shufflelo_epi16( v, _MM_SHUFFLE( 0, 1, 2, 3 ) ), _MM_SHUFFLE( 0, 1, 2, 3 ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( p + i * BYTES ), v );
+		}
+	}
+#endif
+	for( ; i < count; ++i )
+		std::reverse( p + i * BYTES, p + ( i + 1 ) * BYTES );
+}
+} // anonymous namespace
+
+void swapEndianBlock( int16_t *blockPtr, size_t blockSizeInBytes )
+{
+	swapBlock<2>( blockPtr, blockSizeInBytes );
+}
+
 void swapEndianBlock( uint16_t *blockPtr, size_t blockSizeInBytes )
 {
-	size_t blockSize = blockSizeInBytes / sizeof(uint16_t);
+	swapBlock<2>( blockPtr, blockSizeInBytes );
+}
 
-	for( size_t b = 0; b < blockSize; b++ ) {
-		*blockPtr = swapEndian( *blockPtr );
-		blockPtr++;
-	}
+void swapEndianBlock( int32_t *blockPtr, size_t blockSizeInBytes )
+{
+	swapBlock<4>( blockPtr, blockSizeInBytes );
+}
+
+void swapEndianBlock( uint32_t *blockPtr, size_t blockSizeInBytes )
+{
+	swapBlock<4>( blockPtr, blockSizeInBytes );
 }
 
 void swapEndianBlock( float *blockPtr, size_t blockSizeInBytes )
 {
-	size_t blockSize = blockSizeInBytes / sizeof(float);
+	swapBlock<4>( blockPtr, blockSizeInBytes );
+}
 
-	for( size_t b = 0; b < blockSize; b++ ) {
-		*(reinterpret_cast<uint32_t*>(blockPtr)) = swapEndian( *(reinterpret_cast<uint32_t*>(blockPtr)) );
-		blockPtr++;
-	}
+void swapEndianBlock( double *blockPtr, size_t blockSizeInBytes )
+{
+	swapBlock<8>( blockPtr, blockSizeInBytes );
+}
+
+void* alignedMalloc( size_t size, size_t alignment )
+{
+	// over-allocate, then store the address malloc() returned just ahead of the aligned block
+	uint8_t *raw = reinterpret_cast<uint8_t*>( malloc( size + alignment + sizeof(void*) ) );
+	if( ! raw )
+		return NULL;
+	size_t aligned = ( reinterpret_cast<size_t>( raw ) + sizeof(void*) + alignment - 1 ) & ~( alignment - 1 );
+	reinterpret_cast<void**>( aligned )[-1] = raw;
+	return reinterpret_cast<void*>( aligned );
+}
+
+void alignedFree( void *ptr )
+{
+	if( ptr )
+		free( reinterpret_cast<void**>( ptr )[-1] );
 }
 
 } // namespace cinder
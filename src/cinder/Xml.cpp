@@ -231,7 +231,7 @@ void parseItem( const rapidxml::xml_node<> &node, XmlTree *parent, XmlTree *resu
 
 void XmlTree::loadFromDataSource( DataSourceRef dataSource, XmlTree *result, const XmlTree::ParseOptions &parseOptions )
 {
-	Buffer buf = dataSource->getBuffer();
+	Buffer buf = loadDataSourceBuffer( dataSource );
 	size_t dataSize = buf.getDataSize();
 	shared_ptr<char> bufString( new char[dataSize+1], checked_array_deleter<char>() );
 	memcpy( bufString.get(), buf.getData(), buf.getDataSize() );
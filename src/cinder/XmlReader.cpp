@@ -0,0 +1,503 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/XmlReader.h"
+#include "cinder/Utilities.h"
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder {
+
+namespace {
+
+const size_t INITIAL_BUFFER_SIZE = 65536;
+
+void appendUtf8( string *result, uint32_t codePoint )
+{
+	if( codePoint < 0x80 )
+		result->push_back( (char)codePoint );
+	else if( codePoint < 0x800 ) {
+		result->push_back( (char)( 0xC0 | ( codePoint >> 6 ) ) );
+		result->push_back( (char)( 0x80 | ( codePoint & 0x3F ) ) );
+	}
+	else if( codePoint < 0x10000 ) {
+		result->push_back( (char)( 0xE0 | ( codePoint >> 12 ) ) );
+		result->push_back( (char)( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) ) );
+		result->push_back( (char)( 0x80 | ( codePoint & 0x3F ) ) );
+	}
+	else {
+		result->push_back( (char)( 0xF0 | ( codePoint >> 18 ) ) );
+		result->push_back( (char)( 0x80 | ( ( codePoint >> 12 ) & 0x3F ) ) );
+		result->push_back( (char)( 0x80 | ( ( codePoint >> 6 ) & 0x3F ) ) );
+		result->push_back( (char)( 0x80 | ( codePoint & 0x3F ) ) );
+	}
+}
+
+// replaces the predefined entities and character references in [begin,end); unknown entities are left as they are
+string decodeEntities( const char *begin, const char *end )
+{
+	string result;
+	result.reserve( end - begin );
+	while( begin < end ) {
+		const char *amp = std::find( begin, end, '&' );
+		result.append( begin, amp );
+		if( amp == end )
+			break;
+		const char *semicolon = std::find( amp, std::min( end, amp + 12 ), ';' );
+		if( ( semicolon == end ) || ( *semicolon != ';' ) ) {
+			result.push_back( '&' );
+			begin = amp + 1;
+			continue;
+		}
+
+		string entity( amp + 1, semicolon );
+		if( entity == "lt" ) result.push_back( '<' );
+		else if( entity == "gt" ) result.push_back( '>' );
+		else if( entity == "amp" ) result.push_back( '&' );
+		else if( entity == "quot" ) result.push_back( '"' );
+		else if( entity == "apos" ) result.push_back( '\'' );
+		else if( ( entity.size() > 1 ) && ( entity[0] == '#' ) ) {
+			bool hex = ( entity[1] == 'x' ) || ( entity[1] == 'X' );
+			appendUtf8( &result, (uint32_t)strtoul( entity.c_str() + ( hex ? 2 : 1 ), 0, hex ? 16 : 10 ) );
+		}
+		else
+			result.append( amp, semicolon + 1 );
+		begin = semicolon + 1;
+	}
+	return result;
+}
+
+bool isWhitespace( char c )
+{
+	return ( c == ' ' ) || ( c == '\t' ) || ( c == '\r' ) || ( c == '\n' );
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// XmlReader::Element
+bool XmlReader::Element::hasAttribute( const std::string &attrName ) const
+{
+	for( AttrList::const_iterator attrIt = mAttributes.begin(); attrIt != mAttributes.end(); ++attrIt )
+		if( attrIt->first == attrName )
+			return true;
+	return false;
+}
+
+const std::string& XmlReader::Element::operator[]( const std::string &attrName ) const
+{
+	static const string sEmpty;
+	for( AttrList::const_iterator attrIt = mAttributes.begin(); attrIt != mAttributes.end(); ++attrIt )
+		if( attrIt->first == attrName )
+			return attrIt->second;
+	return sEmpty;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// XmlReader::PathFilter
+bool XmlReader::PathFilter::matches( const std::vector<Element> &elements ) const
+{
+	if( mComponents.empty() || ( mComponents.size() != elements.size() ) )
+		return false;
+	for( size_t c = 0; c < mComponents.size(); ++c ) {
+		if( mCaseSensitive ? ( mComponents[c] != elements[c].mTag ) : ( ! boost::iequals( mComponents[c], elements[c].mTag ) ) )
+			return false;
+	}
+	return true;
+}
+
+namespace {
+
+vector<string> splitPath( const std::string &path, char separator )
+{
+	vector<string> result = split( path, separator );
+	result.erase( std::remove( result.begin(), result.end(), string() ), result.end() );
+	return result;
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// XmlReader
+XmlReader::XmlReader( IStreamRef stream )
+	: mStream( stream ), mBuffer( INITIAL_BUFFER_SIZE ), mPos( 0 ), mEnd( 0 ), mOffset( 0 ), mEof( false ), mStopped( false ), mFilterDepth( 0 )
+{
+}
+
+XmlReader::XmlReader( DataSourceRef dataSource )
+	: mStream( dataSource->createStream() ), mBuffer( INITIAL_BUFFER_SIZE ), mPos( 0 ), mEnd( 0 ), mOffset( 0 ), mEof( false ), mStopped( false ), mFilterDepth( 0 )
+{
+}
+
+XmlReader& XmlReader::filter( const std::string &path, bool caseSensitive, char separator )
+{
+	mFilter.mComponents = splitPath( path, separator );
+	mFilter.mCaseSensitive = caseSensitive;
+	return *this;
+}
+
+XmlReader& XmlReader::onElement( const std::string &path, const TreeFn &fn, bool caseSensitive, char separator )
+{
+	Collector collector;
+	collector.mFilter.mComponents = splitPath( path, separator );
+	collector.mFilter.mCaseSensitive = caseSensitive;
+	collector.mFn = fn;
+	mCollectors.push_back( collector );
+	return *this;
+}
+
+std::string XmlReader::getPath( char separator ) const
+{
+	string result;
+	for( vector<Element>::const_iterator elementIt = mElements.begin(); elementIt != mElements.end(); ++elementIt ) {
+		if( elementIt != mElements.begin() )
+			result += separator;
+		result += elementIt->mTag;
+	}
+	return result;
+}
+
+void XmlReader::parse()
+{
+	mStopped = false;
+	while( ( ! mStopped ) && ensure( 1 ) ) {
+		if( mBuffer[mPos] == '<' )
+			parseMarkup();
+		else
+			parseText();
+	}
+
+	if( ( ! mStopped ) && ( ! mElements.empty() ) )
+		throwParseError( "unexpected end of document inside <" + mElements.back().mTag + ">" );
+}
+
+// reads more of the stream into mBuffer, first moving the unread data to its front. Returns false at the end of the stream.
+bool XmlReader::fill()
+{
+	if( mEof )
+		return false;
+
+	if( mPos > 0 ) {
+		memmove( &mBuffer[0], &mBuffer[mPos], mEnd - mPos );
+		mEnd -= mPos;
+		mPos = 0;
+	}
+	if( mEnd == mBuffer.size() )
+		mBuffer.resize( mBuffer.size() * 2 );
+
+	size_t bytesRead = mStream->readDataAvailable( &mBuffer[mEnd], mBuffer.size() - mEnd );
+	mEnd += bytesRead;
+	if( bytesRead == 0 )
+		mEof = true;
+	return bytesRead > 0;
+}
+
+bool XmlReader::ensure( size_t count )
+{
+	while( mEnd - mPos < count ) {
+		if( ! fill() )
+			return false;
+	}
+	return true;
+}
+
+// returns the offset from mPos of the first occurrence of \a pattern at or after \a from, or string::npos if the stream ends first
+size_t XmlReader::find( const char *pattern, size_t from )
+{
+	size_t patternLength = strlen( pattern );
+	while( true ) {
+		if( mPos + from < mEnd ) {
+			const char *start = &mBuffer[mPos + from], *end = &mBuffer[0] + mEnd;
+			const char *found = std::search( start, end, pattern, pattern + patternLength );
+			if( found != end )
+				return found - &mBuffer[mPos];
+			// a partial match may straddle the end of the buffer
+			from = std::max( from, ( mEnd - mPos >= patternLength ) ? mEnd - mPos - patternLength + 1 : 0 );
+		}
+		if( ! fill() )
+			return string::npos;
+	}
+}
+
+// returns the offset from mPos of the '>' closing the tag at mPos, skipping over quoted attribute values
+size_t XmlReader::findTagEnd()
+{
+	size_t i = 1;
+	char quote = 0;
+	while( true ) {
+		if( mPos + i >= mEnd ) {
+			if( ! fill() )
+				return string::npos;
+			continue;
+		}
+		char c = mBuffer[mPos + i];
+		if( quote ) {
+			if( c == quote )
+				quote = 0;
+		}
+		else if( ( c == '"' ) || ( c == '\'' ) )
+			quote = c;
+		else if( c == '>' )
+			return i;
+		++i;
+	}
+}
+
+void XmlReader::skip( size_t count )
+{
+	mPos += count;
+	mOffset += count;
+}
+
+void XmlReader::throwParseError( const std::string &message ) const
+{
+	throw ExcParse( message, mOffset );
+}
+
+void XmlReader::parseText()
+{
+	size_t length = find( "<", 0 );
+	if( length == string::npos )
+		length = mEnd - mPos;
+
+	const char *begin = &mBuffer[mPos];
+	const char *firstNonWhitespace = begin;
+	while( ( firstNonWhitespace < begin + length ) && isWhitespace( *firstNonWhitespace ) )
+		++firstNonWhitespace;
+	if( ( ! mElements.empty() ) && ( firstNonWhitespace < begin + length ) ) {
+		string decoded = decodeEntities( begin, begin + length );
+		skip( length );
+		text( decoded );
+	}
+	else
+		skip( length );
+}
+
+void XmlReader::parseMarkup()
+{
+	if( ! ensure( 2 ) )
+		throwParseError( "unexpected end of document" );
+
+	char c = mBuffer[mPos + 1];
+	if( c == '?' ) { // processing instruction or XML declaration
+		size_t end = find( "?>", 2 );
+		if( end == string::npos )
+			throwParseError( "unterminated processing instruction" );
+		skip( end + 2 );
+	}
+	else if( c == '/' ) {
+		size_t end = find( ">", 2 );
+		if( end == string::npos )
+			throwParseError( "unterminated end tag" );
+		parseEndTag( end );
+	}
+	else if( c == '!' ) {
+		if( ensure( 4 ) && ( memcmp( &mBuffer[mPos], "<!--", 4 ) == 0 ) ) {
+			size_t end = find( "-->", 4 );
+			if( end == string::npos )
+				throwParseError( "unterminated comment" );
+			skip( end + 3 );
+		}
+		else if( ensure( 9 ) && ( memcmp( &mBuffer[mPos], "<![CDATA[", 9 ) == 0 ) ) {
+			size_t end = find( "]]>", 9 );
+			if( end == string::npos )
+				throwParseError( "unterminated CDATA section" );
+			string cdata( &mBuffer[mPos + 9], &mBuffer[mPos + end] );
+			skip( end + 3 );
+			if( ! mElements.empty() )
+				text( cdata );
+		}
+		else { // DOCTYPE or another declaration, which may contain an internal subset in brackets
+			size_t i = 2;
+			int brackets = 0;
+			char quote = 0;
+			while( true ) {
+				if( ( mPos + i >= mEnd ) && ( ! fill() ) )
+					throwParseError( "unterminated declaration" );
+				if( mPos + i >= mEnd )
+					continue;
+				char d = mBuffer[mPos + i];
+				if( quote ) {
+					if( d == quote )
+						quote = 0;
+				}
+				else if( ( d == '"' ) || ( d == '\'' ) )
+					quote = d;
+				else if( d == '[' )
+					++brackets;
+				else if( d == ']' )
+					--brackets;
+				else if( ( d == '>' ) && ( brackets <= 0 ) )
+					break;
+				++i;
+			}
+			skip( i + 1 );
+		}
+	}
+	else {
+		size_t end = findTagEnd();
+		if( end == string::npos )
+			throwParseError( "unterminated start tag" );
+		parseStartTag( end );
+	}
+}
+
+// parses the start tag of \a length characters at mPos, excluding its closing '>'
+void XmlReader::parseStartTag( size_t length )
+{
+	const char *p = &mBuffer[mPos + 1], *end = &mBuffer[mPos] + length;
+	bool isEmpty = ( end > p ) && ( end[-1] == '/' );
+	if( isEmpty )
+		--end;
+
+	Element element;
+	const char *nameEnd = p;
+	while( ( nameEnd < end ) && ( ! isWhitespace( *nameEnd ) ) )
+		++nameEnd;
+	element.mTag.assign( p, nameEnd );
+	if( element.mTag.empty() )
+		throwParseError( "missing element name" );
+	p = nameEnd;
+
+	while( true ) {
+		while( ( p < end ) && isWhitespace( *p ) )
+			++p;
+		if( p == end )
+			break;
+
+		const char *attrNameEnd = p;
+		while( ( attrNameEnd < end ) && ( *attrNameEnd != '=' ) && ( ! isWhitespace( *attrNameEnd ) ) )
+			++attrNameEnd;
+		string name( p, attrNameEnd );
+		p = attrNameEnd;
+		while( ( p < end ) && isWhitespace( *p ) )
+			++p;
+		if( ( p == end ) || ( *p != '=' ) )
+			throwParseError( "expected '=' after attribute " + name );
+		++p;
+		while( ( p < end ) && isWhitespace( *p ) )
+			++p;
+		if( ( p == end ) || ( ( *p != '"' ) && ( *p != '\'' ) ) )
+			throwParseError( "expected quoted value for attribute " + name );
+		const char *valueEnd = std::find( p + 1, end, *p );
+		if( valueEnd == end )
+			throwParseError( "unterminated value for attribute " + name );
+		element.mAttributes.push_back( make_pair( name, decodeEntities( p + 1, valueEnd ) ) );
+		p = valueEnd + 1;
+	}
+
+	skip( length + 1 );
+	mElements.push_back( element );
+	startElement( isEmpty );
+}
+
+// parses the end tag of \a length characters at mPos, excluding its closing '>'
+void XmlReader::parseEndTag( size_t length )
+{
+	const char *begin = &mBuffer[mPos + 2], *end = &mBuffer[mPos] + length;
+	while( ( end > begin ) && isWhitespace( end[-1] ) )
+		--end;
+	if( mElements.empty() || ( mElements.back().mTag.compare( 0, string::npos, begin, end - begin ) != 0 ) )
+		throwParseError( "unexpected end tag </" + string( begin, end ) + ">" );
+
+	skip( length + 1 );
+	endElement();
+}
+
+void XmlReader::startElement( bool isEmpty )
+{
+	const Element &element = mElements.back();
+	if( ( mFilterDepth == 0 ) && mFilter.matches( mElements ) )
+		mFilterDepth = mElements.size();
+
+	if( mStartElementFn && ( mFilter.mComponents.empty() || mFilterDepth ) )
+		mStartElementFn( element );
+
+	for( vector<Collector>::iterator collectorIt = mCollectors.begin(); collectorIt != mCollectors.end(); ++collectorIt ) {
+		XmlTree *node = 0;
+		if( collectorIt->mTree ) {
+			collectorIt->mNodes.back()->push_back( XmlTree( element.mTag, "" ) );
+			node = &collectorIt->mNodes.back()->getChildren().back();
+		}
+		else if( collectorIt->mFilter.matches( mElements ) ) {
+			collectorIt->mTree = std::shared_ptr<XmlTree>( new XmlTree( element.mTag, "" ) );
+			node = collectorIt->mTree.get();
+		}
+		else
+			continue;
+
+		for( Element::AttrList::const_iterator attrIt = element.mAttributes.begin(); attrIt != element.mAttributes.end(); ++attrIt )
+			node->setAttribute( attrIt->first, attrIt->second );
+		collectorIt->mNodes.push_back( node );
+	}
+
+	if( isEmpty )
+		endElement();
+}
+
+void XmlReader::endElement()
+{
+	if( mEndElementFn && ( mFilter.mComponents.empty() || mFilterDepth ) )
+		mEndElementFn( mElements.back() );
+
+	for( vector<Collector>::iterator collectorIt = mCollectors.begin(); collectorIt != mCollectors.end(); ++collectorIt ) {
+		if( ! collectorIt->mTree )
+			continue;
+		collectorIt->mNodes.pop_back();
+		if( collectorIt->mNodes.empty() ) {
+			std::shared_ptr<XmlTree> tree = collectorIt->mTree;
+			collectorIt->mTree.reset();
+			collectorIt->mFn( *tree );
+		}
+	}
+
+	if( mFilterDepth == mElements.size() )
+		mFilterDepth = 0;
+	mElements.pop_back();
+}
+
+void XmlReader::text( const std::string &text )
+{
+	if( mTextFn && ( mFilter.mComponents.empty() || mFilterDepth ) )
+		mTextFn( text, mElements.back() );
+
+	for( vector<Collector>::iterator collectorIt = mCollectors.begin(); collectorIt != mCollectors.end(); ++collectorIt ) {
+		if( collectorIt->mTree )
+			collectorIt->mNodes.back()->setValue( collectorIt->mNodes.back()->getValue() + text );
+	}
+}
+
+XmlReader::ExcParse::ExcParse( const std::string &message, uint64_t offset ) throw()
+{
+	sprintf( mMessage, "XML parse error at byte %llu: %.1900s", (unsigned long long)offset, message.c_str() );
+}
+
+} // namespace cinder
@@ -0,0 +1,337 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/XmlView.h"
+#include "cinder/Utilities.h"
+
+#include "rapidxml/rapidxml.hpp"
+
+#include <cstdio>
+
+using namespace std;
+
+namespace cinder {
+
+// defined in Xml.cpp
+void parseItem( const rapidxml::xml_node<> &node, XmlTree *parent, XmlTree *result, const XmlTree::ParseOptions &parseOptions );
+
+struct XmlView::Document {
+	Document( const XmlTree::ParseOptions &parseOptions ) : mParseOptions( parseOptions ) {}
+
+	shared_ptr<char>			mText;	// the parsed copy of the input, which the nodes point into
+	rapidxml::xml_document<>	mDoc;
+	XmlTree::ParseOptions		mParseOptions;
+};
+
+namespace {
+
+// whether XmlTree would create a child for \a node
+bool isVisible( const rapidxml::xml_node<> *node, const XmlTree::ParseOptions &options )
+{
+	switch( node->type() ) {
+		case rapidxml::node_element:
+		case rapidxml::node_comment:
+			return true;
+		case rapidxml::node_cdata:
+			return ! options.getCollapseCData();
+		case rapidxml::node_data:
+			return ! options.getIgnoreDataChildren();
+		default:
+			return false;
+	}
+}
+
+bool tagsMatch( const rapidxml::xml_node<> *node, const string &tag, bool caseSensitive )
+{
+	return XmlStringRef( node->name(), node->name_size() ).equals( tag, caseSensitive );
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// XmlView
+XmlView::XmlView( DataSourceRef dataSource, XmlTree::ParseOptions parseOptions )
+	: mNode( 0 )
+{
+	Buffer buf = loadDataSourceBuffer( dataSource );
+	size_t dataSize = buf.getDataSize();
+	shared_ptr<char> text( new char[dataSize+1], checked_array_deleter<char>() );
+	memcpy( text.get(), buf.getData(), dataSize );
+	text.get()[dataSize] = 0;
+	buf.reset(); // don't hold on to a second copy while parsing
+
+	mDocument = shared_ptr<Document>( new Document( parseOptions ) );
+	mDocument->mText = text;
+	parse( text.get(), parseOptions );
+}
+
+XmlView::XmlView( const std::string &xmlString, XmlTree::ParseOptions parseOptions )
+	: mNode( 0 )
+{
+	shared_ptr<char> text( new char[xmlString.size()+1], checked_array_deleter<char>() );
+	memcpy( text.get(), xmlString.c_str(), xmlString.size() + 1 );
+
+	mDocument = shared_ptr<Document>( new Document( parseOptions ) );
+	mDocument->mText = text;
+	parse( text.get(), parseOptions );
+}
+
+void XmlView::parse( char *text, const XmlTree::ParseOptions &parseOptions )
+{
+	// data nodes are only needed when they're visible as children; element values are still set without them
+	bool dataNodes = ! parseOptions.getIgnoreDataChildren();
+	if( parseOptions.getParseComments() && dataNodes )
+		mDocument->mDoc.parse<rapidxml::parse_comment_nodes | rapidxml::parse_doctype_node>( text );
+	else if( parseOptions.getParseComments() )
+		mDocument->mDoc.parse<rapidxml::parse_comment_nodes | rapidxml::parse_doctype_node | rapidxml::parse_no_data_nodes>( text );
+	else if( dataNodes )
+		mDocument->mDoc.parse<rapidxml::parse_doctype_node>( text );
+	else
+		mDocument->mDoc.parse<rapidxml::parse_doctype_node | rapidxml::parse_no_data_nodes>( text );
+	mNode = &mDocument->mDoc;
+}
+
+XmlTree::NodeType XmlView::getNodeType() const
+{
+	if( ! mNode )
+		return XmlTree::NODE_UNKNOWN;
+
+	switch( mNode->type() ) {
+		case rapidxml::node_document: return XmlTree::NODE_DOCUMENT;
+		case rapidxml::node_element: return XmlTree::NODE_ELEMENT;
+		case rapidxml::node_cdata: return XmlTree::NODE_CDATA;
+		case rapidxml::node_comment: return XmlTree::NODE_COMMENT;
+		case rapidxml::node_data: return XmlTree::NODE_DATA;
+		default: return XmlTree::NODE_UNKNOWN;
+	}
+}
+
+XmlStringRef XmlView::getTag() const
+{
+	return ( mNode ) ? XmlStringRef( mNode->name(), mNode->name_size() ) : XmlStringRef();
+}
+
+XmlStringRef XmlView::getValue() const
+{
+	if( ! mNode )
+		return XmlStringRef();
+
+	if( ( mNode->value_size() == 0 ) && ( mNode->type() == rapidxml::node_element ) && mDocument->mParseOptions.getCollapseCData() ) {
+		const rapidxml::xml_node<> *cdata = mNode->first_node();
+		while( cdata && ( cdata->type() != rapidxml::node_cdata ) )
+			cdata = cdata->next_sibling();
+		if( cdata )
+			return XmlStringRef( cdata->value(), cdata->value_size() );
+	}
+
+	return XmlStringRef( mNode->value(), mNode->value_size() );
+}
+
+bool XmlView::hasParent() const
+{
+	return mNode && mNode->parent();
+}
+
+XmlView XmlView::getParent() const
+{
+	return XmlView( mDocument, ( mNode ) ? mNode->parent() : 0 );
+}
+
+XmlView::ConstIter XmlView::find( const std::string &relativePath, bool caseSensitive, char separator ) const
+{
+	return ConstIter( *this, relativePath, caseSensitive, separator );
+}
+
+XmlView XmlView::getChild( const std::string &relativePath, bool caseSensitive, char separator ) const
+{
+	rapidxml::xml_node<> *child = getNodePtr( relativePath, caseSensitive, separator );
+	if( child )
+		return XmlView( mDocument, child );
+	else
+		throw ExcChildNotFound( *this, relativePath );
+}
+
+rapidxml::xml_node<>* XmlView::getNodePtr( const std::string &relativePath, bool caseSensitive, char separator ) const
+{
+	rapidxml::xml_node<> *curNode = mNode;
+	if( ! curNode )
+		return 0;
+
+	vector<string> pathComponents = split( relativePath, separator );
+	for( vector<string>::const_iterator pathIt = pathComponents.begin(); pathIt != pathComponents.end(); ++pathIt ) {
+		if( pathIt->empty() )
+			continue;
+		rapidxml::xml_node<> *child = curNode->first_node();
+		while( child && ! ( isVisible( child, mDocument->mParseOptions ) && tagsMatch( child, *pathIt, caseSensitive ) ) )
+			child = child->next_sibling();
+		if( ! child )
+			return 0;
+		curNode = child;
+	}
+
+	return curNode;
+}
+
+vector<XmlView::Attr> XmlView::getAttributes() const
+{
+	vector<Attr> result;
+	if( mNode ) {
+		for( rapidxml::xml_attribute<> *attr = mNode->first_attribute(); attr; attr = attr->next_attribute() )
+			result.push_back( Attr( XmlStringRef( attr->name(), attr->name_size() ), XmlStringRef( attr->value(), attr->value_size() ) ) );
+	}
+	return result;
+}
+
+bool XmlView::hasAttribute( const std::string &attrName ) const
+{
+	return mNode && ( mNode->first_attribute( attrName.c_str(), attrName.size() ) != 0 );
+}
+
+XmlView::Attr XmlView::getAttribute( const std::string &attrName ) const
+{
+	rapidxml::xml_attribute<> *attr = ( mNode ) ? mNode->first_attribute( attrName.c_str(), attrName.size() ) : 0;
+	if( ! attr )
+		throw ExcAttrNotFound( *this, attrName );
+	return Attr( XmlStringRef( attr->name(), attr->name_size() ), XmlStringRef( attr->value(), attr->value_size() ) );
+}
+
+XmlStringRef XmlView::operator[]( const std::string &attrName ) const
+{
+	rapidxml::xml_attribute<> *attr = ( mNode ) ? mNode->first_attribute( attrName.c_str(), attrName.size() ) : 0;
+	return ( attr ) ? XmlStringRef( attr->value(), attr->value_size() ) : XmlStringRef();
+}
+
+string XmlView::getPath( char separator ) const
+{
+	string result;
+
+	const rapidxml::xml_node<> *node = mNode;
+	while( node ) {
+		string nodeName( node->name(), node->name_size() );
+		if( node != mNode )
+			nodeName += separator;
+		result = nodeName + result;
+		node = node->parent();
+	}
+
+	return result;
+}
+
+XmlView::ConstIter XmlView::begin() const
+{
+	return ConstIter( *this );
+}
+
+XmlView::ConstIter XmlView::begin( const std::string &filterPath, bool caseSensitive, char separator ) const
+{
+	return ConstIter( *this, filterPath, caseSensitive, separator );
+}
+
+XmlView::ConstIter XmlView::end() const
+{
+	return ConstIter();
+}
+
+XmlTree XmlView::toXmlTree() const
+{
+	XmlTree result;
+	if( mNode ) {
+		XmlTree::NodeType type = getNodeType();
+		parseItem( *mNode, NULL, &result, mDocument->mParseOptions );
+		result.setNodeType( type ); // call this after parse - it replaces the type
+	}
+	return result;
+}
+
+XmlView::ExcChildNotFound::ExcChildNotFound( const XmlView &node, const string &childPath ) throw()
+{
+	sprintf( mMessage, "Could not find child: %s for node: %s", childPath.c_str(), node.getPath().c_str() );
+}
+
+XmlView::ExcAttrNotFound::ExcAttrNotFound( const XmlView &node, const string &attrName ) throw()
+{
+	sprintf( mMessage, "Could not find attribute: %s for node: %s", attrName.c_str(), node.getPath().c_str() );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// XmlView::ConstIter
+XmlView::ConstIter::ConstIter( const XmlView &parent )
+	: mCaseSensitive( false ), mCurrent( parent.mDocument, 0 )
+{
+	if( parent.mNode ) {
+		mStack.push_back( nextMatch( parent.mNode->first_node(), 0 ) );
+		settle();
+	}
+}
+
+XmlView::ConstIter::ConstIter( const XmlView &root, const std::string &filterPath, bool caseSensitive, char separator )
+	: mCaseSensitive( caseSensitive ), mCurrent( root.mDocument, 0 )
+{
+	mFilter = split( filterPath, separator );
+
+	// empty filter means nothing matches
+	if( root.mNode && ( ! mFilter.empty() ) ) {
+		mStack.push_back( nextMatch( root.mNode->first_node(), 0 ) );
+		settle();
+	}
+}
+
+void XmlView::ConstIter::increment()
+{
+	mStack.back() = nextMatch( mStack.back()->next_sibling(), mStack.size() - 1 );
+	settle();
+}
+
+// advances until the top of the stack is a match for the whole filter, or the stack is empty
+void XmlView::ConstIter::settle()
+{
+	size_t depth = std::max<size_t>( mFilter.size(), 1 );
+	while( ! mStack.empty() ) {
+		rapidxml::xml_node<> *node = mStack.back();
+		if( ! node ) { // exhausted this level; continue with the parent's next match
+			mStack.pop_back();
+			if( ! mStack.empty() )
+				mStack.back() = nextMatch( mStack.back()->next_sibling(), mStack.size() - 1 );
+		}
+		else if( mStack.size() < depth )
+			mStack.push_back( nextMatch( node->first_node(), mStack.size() ) );
+		else
+			break;
+	}
+
+	mCurrent.mNode = ( mStack.empty() ) ? 0 : mStack.back();
+}
+
+rapidxml::xml_node<>* XmlView::ConstIter::nextMatch( rapidxml::xml_node<> *candidate, size_t level ) const
+{
+	const XmlTree::ParseOptions &options = mCurrent.mDocument->mParseOptions;
+	for( ; candidate; candidate = candidate->next_sibling() ) {
+		if( isVisible( candidate, options ) && ( mFilter.empty() || tagsMatch( candidate, mFilter[level], mCaseSensitive ) ) )
+			return candidate;
+	}
+	return 0;
+}
+
+} // namespace cinder
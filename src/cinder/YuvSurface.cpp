@@ -0,0 +1,234 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/YuvSurface.h"
+#include "cinder/SurfacePool.h"
+#include "cinder/CinderMath.h"
+
+namespace cinder {
+
+namespace {
+
+// Kr and Kb of each ColorMatrix; Kg is what remains
+void getLumaWeights( YuvSurface::ColorMatrix colorMatrix, float *kr, float *kb )
+{
+	if( colorMatrix == YuvSurface::BT709 ) {
+		*kr = 0.2126f; *kb = 0.0722f;
+	}
+	else {
+		*kr = 0.299f; *kb = 0.114f;
+	}
+}
+
+inline uint8_t clampToByte( int32_t v )
+{
+	return ( v < 0 ) ? 0 : ( ( v > 255 ) ? 255 : (uint8_t)v );
+}
+
+} // anonymous namespace
+
+YuvSurface::Obj::Obj( int32_t width, int32_t height, Layout layout )
+	: mWidth( width ), mHeight( height ), mLayout( layout ), mColorMatrix( BT601 ), mFullRange( false ), mData( 0 ), mPoolRefcon( 0 ), mDeallocatorFunc( 0 )
+{
+}
+
+YuvSurface::Obj::~Obj()
+{
+	if( mDeallocatorFunc )
+		(*mDeallocatorFunc)( mDeallocatorRefcon );
+	if( mPoolRefcon )
+		SurfacePool::deallocate( mPoolRefcon );
+	delete [] mData;
+}
+
+YuvSurface::YuvSurface( int32_t width, int32_t height, Layout layout )
+{
+	allocate( width, height, layout, SurfacePoolRef() );
+}
+
+YuvSurface::YuvSurface( int32_t width, int32_t height, Layout layout, const SurfacePoolRef &pool )
+{
+	allocate( width, height, layout, pool );
+}
+
+YuvSurface::YuvSurface( int32_t width, int32_t height, uint8_t *yData, int32_t yRowBytes, uint8_t *cbCrData, int32_t cbCrRowBytes )
+	: mObj( new Obj( width, height, NV12 ) )
+{
+	const int32_t chromaWidth = ( width + 1 ) / 2, chromaHeight = ( height + 1 ) / 2;
+	mObj->mY = Channel8u( width, height, yRowBytes, 1, yData );
+	mObj->mCb = Channel8u( chromaWidth, chromaHeight, cbCrRowBytes, 2, cbCrData );
+	mObj->mCr = Channel8u( chromaWidth, chromaHeight, cbCrRowBytes, 2, cbCrData + 1 );
+}
+
+YuvSurface::YuvSurface( int32_t width, int32_t height, uint8_t *yData, int32_t yRowBytes, uint8_t *cbData, int32_t cbRowBytes, uint8_t *crData, int32_t crRowBytes )
+	: mObj( new Obj( width, height, I420 ) )
+{
+	const int32_t chromaWidth = ( width + 1 ) / 2, chromaHeight = ( height + 1 ) / 2;
+	mObj->mY = Channel8u( width, height, yRowBytes, 1, yData );
+	mObj->mCb = Channel8u( chromaWidth, chromaHeight, cbRowBytes, 1, cbData );
+	mObj->mCr = Channel8u( chromaWidth, chromaHeight, crRowBytes, 1, crData );
+}
+
+YuvSurface::YuvSurface( const Surface8u &surface, Layout layout, ColorMatrix colorMatrix, bool fullRange )
+{
+	allocate( surface.getWidth(), surface.getHeight(), layout, SurfacePoolRef() );
+	setColorSpace( colorMatrix, fullRange );
+	copyFrom( surface );
+}
+
+// Lays out the luma plane followed by the chroma in a single block
+void YuvSurface::allocate( int32_t width, int32_t height, Layout layout, const SurfacePoolRef &pool )
+{
+	mObj = std::shared_ptr<Obj>( new Obj( width, height, layout ) );
+
+	const int32_t chromaWidth = ( width + 1 ) / 2, chromaHeight = ( height + 1 ) / 2;
+	const size_t lumaSize = width * height, chromaSize = chromaWidth * chromaHeight;
+	uint8_t *data;
+	if( pool )
+		data = reinterpret_cast<uint8_t*>( pool->allocate( lumaSize + chromaSize * 2, &mObj->mPoolRefcon ) );
+	else
+		data = mObj->mData = new uint8_t[lumaSize + chromaSize * 2];
+
+	mObj->mY = Channel8u( width, height, width, 1, data );
+	if( layout == NV12 ) {
+		mObj->mCb = Channel8u( chromaWidth, chromaHeight, chromaWidth * 2, 2, data + lumaSize );
+		mObj->mCr = Channel8u( chromaWidth, chromaHeight, chromaWidth * 2, 2, data + lumaSize + 1 );
+	}
+	else {
+		mObj->mCb = Channel8u( chromaWidth, chromaHeight, chromaWidth, 1, data + lumaSize );
+		mObj->mCr = Channel8u( chromaWidth, chromaHeight, chromaWidth, 1, data + lumaSize + chromaSize );
+	}
+}
+
+void YuvSurface::setDeallocator( void(*aDeallocatorFunc)( void * ), void *aDeallocatorRefcon )
+{
+	mObj->mDeallocatorFunc = aDeallocatorFunc;
+	mObj->mDeallocatorRefcon = aDeallocatorRefcon;
+}
+
+void YuvSurface::getRgbConversion( ColorMatrix colorMatrix, bool fullRange, Matrix33f *resultMatrix, Vec3f *resultOffset )
+{
+	float kr, kb;
+	getLumaWeights( colorMatrix, &kr, &kb );
+	const float kg = 1 - kr - kb;
+	// video range puts black at 16 and spans 219 levels of luma and 224 of chroma
+	const float lumaScale = fullRange ? 1.0f : ( 255.0f / 219.0f );
+	const float chromaScale = fullRange ? 1.0f : ( 255.0f / 224.0f );
+	const Vec3f zero( fullRange ? 0.0f : ( 16.0f / 255.0f ), 128.0f / 255.0f, 128.0f / 255.0f );
+
+	Matrix33f &m = *resultMatrix;
+	m.at( 0, 0 ) = lumaScale;	m.at( 0, 1 ) = 0;												m.at( 0, 2 ) = 2 * ( 1 - kr ) * chromaScale;
+	m.at( 1, 0 ) = lumaScale;	m.at( 1, 1 ) = -2 * kb * ( 1 - kb ) / kg * chromaScale;	m.at( 1, 2 ) = -2 * kr * ( 1 - kr ) / kg * chromaScale;
+	m.at( 2, 0 ) = lumaScale;	m.at( 2, 1 ) = 2 * ( 1 - kb ) * chromaScale;					m.at( 2, 2 ) = 0;
+	*resultOffset = -( m * zero );
+}
+
+Surface8u YuvSurface::convertToSurface() const
+{
+	Surface8u result( getWidth(), getHeight(), false );
+	convertToSurface( &result );
+	return result;
+}
+
+void YuvSurface::convertToSurface( Surface8u *surface ) const
+{
+	if( surface->getSize() != getSize() )
+		throw YuvSurfaceExc();
+
+	Matrix33f m;
+	Vec3f offset;
+	getRgbConversion( getColorMatrix(), isFullRange(), &m, &offset );
+	// 16.16 fixed point, operating on bytes rather than normalized values
+	const int32_t ky = (int32_t)( m.at( 0, 0 ) * 65536 );
+	const int32_t krCr = (int32_t)( m.at( 0, 2 ) * 65536 ), kgCb = (int32_t)( m.at( 1, 1 ) * 65536 ), kgCr = (int32_t)( m.at( 1, 2 ) * 65536 ), kbCb = (int32_t)( m.at( 2, 1 ) * 65536 );
+	const int32_t offR = (int32_t)( offset.x * 255 * 65536 ) + 32768, offG = (int32_t)( offset.y * 255 * 65536 ) + 32768, offB = (int32_t)( offset.z * 255 * 65536 ) + 32768;
+
+	const Channel8u &yChan = getY(), &cbChan = getCb(), &crChan = getCr();
+	const uint8_t cbInc = cbChan.getIncrement(), crInc = crChan.getIncrement();
+	const uint8_t pixelInc = surface->getPixelInc();
+	const uint8_t redOff = surface->getRedOffset(), greenOff = surface->getGreenOffset(), blueOff = surface->getBlueOffset();
+	const int32_t width = getWidth(), height = getHeight();
+	for( int32_t y = 0; y < height; ++y ) {
+		const uint8_t *srcY = yChan.getData( 0, y );
+		const uint8_t *srcCb = cbChan.getData( 0, y / 2 ), *srcCr = crChan.getData( 0, y / 2 );
+		uint8_t *dst = surface->getData( Vec2i( 0, y ) );
+		for( int32_t x = 0; x < width; ++x, dst += pixelInc ) {
+			const int32_t luma = ky * srcY[x];
+			const int32_t cb = srcCb[(x/2)*cbInc], cr = srcCr[(x/2)*crInc];
+			dst[redOff] = clampToByte( ( luma + krCr * cr + offR ) >> 16 );
+			dst[greenOff] = clampToByte( ( luma + kgCb * cb + kgCr * cr + offG ) >> 16 );
+			dst[blueOff] = clampToByte( ( luma + kbCb * cb + offB ) >> 16 );
+		}
+	}
+}
+
+void YuvSurface::copyFrom( const Surface8u &surface )
+{
+	if( surface.getSize() != getSize() )
+		throw YuvSurfaceExc();
+
+	float kr, kb;
+	getLumaWeights( getColorMatrix(), &kr, &kb );
+	const float kg = 1 - kr - kb;
+	const float lumaRange = isFullRange() ? 255.0f : 219.0f, chromaRange = isFullRange() ? 255.0f : 224.0f;
+	const int32_t lumaOffset = isFullRange() ? 0 : 16;
+	// 16.16 fixed point; the luma weights are prescaled by the luma range so that bytes map directly to bytes
+	const int32_t yr = (int32_t)( kr * lumaRange / 255 * 65536 ), yg = (int32_t)( kg * lumaRange / 255 * 65536 ), yb = (int32_t)( kb * lumaRange / 255 * 65536 );
+	// Cb = ( B - Y ) / ( 2 * ( 1 - Kb ) ) and Cr = ( R - Y ) / ( 2 * ( 1 - Kr ) ), expanded in terms of R, G and B
+	const float cbScale = chromaRange / 255 / ( 2 * ( 1 - kb ) ), crScale = chromaRange / 255 / ( 2 * ( 1 - kr ) );
+	const int32_t cbr = (int32_t)( -kr * cbScale * 65536 ), cbg = (int32_t)( -kg * cbScale * 65536 ), cbb = (int32_t)( ( 1 - kb ) * cbScale * 65536 );
+	const int32_t crr = (int32_t)( ( 1 - kr ) * crScale * 65536 ), crg = (int32_t)( -kg * crScale * 65536 ), crb = (int32_t)( -kb * crScale * 65536 );
+
+	const uint8_t pixelInc = surface.getPixelInc();
+	const uint8_t redOff = surface.getRedOffset(), greenOff = surface.getGreenOffset(), blueOff = surface.getBlueOffset();
+	const int32_t width = getWidth(), height = getHeight();
+	Channel8u &yChan = getY(), &cbChan = getCb(), &crChan = getCr();
+	const uint8_t cbInc = cbChan.getIncrement(), crInc = crChan.getIncrement();
+
+	for( int32_t y = 0; y < height; ++y ) {
+		const uint8_t *src = surface.getData( Vec2i( 0, y ) );
+		uint8_t *dstY = yChan.getData( 0, y );
+		for( int32_t x = 0; x < width; ++x, src += pixelInc )
+			dstY[x] = clampToByte( lumaOffset + ( ( yr * src[redOff] + yg * src[greenOff] + yb * src[blueOff] + 32768 ) >> 16 ) );
+	}
+
+	// each chroma sample averages the (up to) 2x2 block of pixels it covers
+	for( int32_t cy = 0; cy < cbChan.getHeight(); ++cy ) {
+		const int32_t y0 = cy * 2, y1 = std::min( y0 + 1, height - 1 );
+		const uint8_t *src0 = surface.getData( Vec2i( 0, y0 ) ), *src1 = surface.getData( Vec2i( 0, y1 ) );
+		uint8_t *dstCb = cbChan.getData( 0, cy ), *dstCr = crChan.getData( 0, cy );
+		for( int32_t cx = 0; cx < cbChan.getWidth(); ++cx ) {
+			const int32_t x0 = cx * 2 * pixelInc, x1 = std::min( cx * 2 + 1, width - 1 ) * pixelInc;
+			const int32_t r = src0[x0+redOff] + src0[x1+redOff] + src1[x0+redOff] + src1[x1+redOff];
+			const int32_t g = src0[x0+greenOff] + src0[x1+greenOff] + src1[x0+greenOff] + src1[x1+greenOff];
+			const int32_t b = src0[x0+blueOff] + src0[x1+blueOff] + src1[x0+blueOff] + src1[x1+blueOff];
+			// the sums are 4x the average, which the final shift absorbs
+			dstCb[cx*cbInc] = clampToByte( 128 + ( ( cbr * r + cbg * g + cbb * b + 131072 ) >> 18 ) );
+			dstCr[cx*crInc] = clampToByte( 128 + ( ( crr * r + crg * g + crb * b + 131072 ) >> 18 ) );
+		}
+	}
+}
+
+} // namespace cinder
@@ -25,6 +25,12 @@
 #include "cinder/Camera.h"
 #include "cinder/Utilities.h"
 #include "cinder/Timeline.h"
+#include "cinder/Thread.h"
+#include "cinder/LockFreeCircularBuffer.h"
+#include "cinder/Profiler.h"
+#include "cinder/FileWatcher.h"
+
+#include <deque>
 
 #if defined( CINDER_COCOA )
 	#if defined( CINDER_MAC )
@@ -48,9 +54,83 @@ namespace cinder { namespace app {
 // Static instance of App, effectively a singleton
 App*	App::sInstance;
 
+// Functions passed to dispatchAsync(), waiting to be called on the app's thread. They normally pass through a lock-free ring; when it is full
+// they go to mOverflow instead, and keep going there until the app's thread has taken mOverflow, so that each thread's functions stay in order.
+// A null function marks the end of a frame's functions, so that functions dispatched by dispatched functions wait for the next frame.
+struct App::DispatchQueue {
+	DispatchQueue()
+		: mRing( 1024 ), mOverflowing( 0 ), mBudget( 0 ), mFrameMarkerQueued( false )
+	{}
+
+	~DispatchQueue()
+	{
+		std::function<void()> *fn;
+		while( mRing.tryPopBack( &fn ) )
+			delete fn;
+		for( std::deque<std::function<void()>*>::iterator fnIt = mOverflow.begin(); fnIt != mOverflow.end(); ++fnIt )
+			delete *fnIt;
+		for( std::deque<std::function<void()>*>::iterator fnIt = mPending.begin(); fnIt != mPending.end(); ++fnIt )
+			delete *fnIt;
+	}
+
+	void push( std::function<void()> *fn )
+	{
+		if( ( ! detail::lockFreeLoadAcquire( &mOverflowing ) ) && mRing.tryPushFront( fn ) )
+			return;
+
+		std::lock_guard<std::mutex> lock( mOverflowMutex );
+		mOverflow.push_back( fn );
+		detail::lockFreeStoreRelease( &mOverflowing, 1 );
+	}
+
+	//! Returns the next function in order, which is null for a frame marker, or false if there are none
+	bool pop( std::function<void()> **fn )
+	{
+		if( mPending.empty() ) {
+			if( mRing.tryPopBack( fn ) )
+				return true;
+			// the ring is empty, so everything in mOverflow is older than anything pushed from now on
+			std::lock_guard<std::mutex> lock( mOverflowMutex );
+			mPending.swap( mOverflow );
+			detail::lockFreeStoreRelease( &mOverflowing, 0 );
+			if( mPending.empty() )
+				return false;
+		}
+
+		*fn = mPending.front();
+		mPending.pop_front();
+		return true;
+	}
+
+	MpmcCircularBuffer<std::function<void()>*>	mRing;
+	std::mutex									mOverflowMutex;
+	std::deque<std::function<void()>*>			mOverflow;
+	volatile uint32_t							mOverflowing;
+	// used only on the app's thread
+	std::deque<std::function<void()>*>			mPending; // taken from mOverflow but not called yet
+	double										mBudget;
+	bool										mFrameMarkerQueued;
+};
+
+// Simulation thread used when Settings::enableThreadedUpdate() is in effect. mUpdateRequested is set by the app's thread to start an update()
+// and cleared by the simulation thread once it has finished.
+struct App::UpdateThread {
+	UpdateThread()
+		: mUpdateRequested( false ), mQuit( false )
+	{}
+
+	std::shared_ptr<std::thread>	mThread;
+	std::mutex						mMutex;
+	std::condition_variable			mCond;
+	bool							mUpdateRequested, mQuit;
+};
+
 App::App()
-	: mFrameCount( 0 ), mAverageFps( 0 ), mFpsSampleInterval( 1 ), mTimer( true ), mTimeline( Timeline::create() )
+	: mFrameCount( 0 ), mAverageFps( 0 ), mFpsSampleInterval( 1 ), mFixedUpdateTime( -1 ), mUpdateAlpha( 1 ), mPendingUpdateAlpha( 1 ), mPendingUpdateDuration( 0 ), mFixedFrameTime( -1 ), mLaunchSeconds( -1 ), mSetupEndSeconds( -1 ),
+	mRedrawRequested( 1 ), mTimelineActive( false ), mPendingTimelineActive( false ), mRedrawFollowUp( false ),
+	mHasCoalescedMouseMove( false ), mHasCoalescedMouseDrag( false ), mTimer( true ), mTimeline( Timeline::create() ), mDispatchQueue( new DispatchQueue )
 {
+	mFramePacer = shared_ptr<FramePacer>( new FramePacer( mTimer ) );
 	mFpsLastSampleFrame = 0;
 	mFpsLastSampleTime = 0;
 	mAssetDirectoriesInitialized = false;
@@ -58,11 +138,15 @@ App::App()
 
 App::~App()
 {
+	stopUpdateThread();
 }
 
 // Pseudo-private event handlers
 void App::privateMouseDown__( const MouseEvent &event )
 {
+	requestRedraw();
+	privateFlushCoalescedEvents__();
+
 	bool handled = false;
 	for( CallbackMgr<bool (MouseEvent)>::iterator cbIter = mCallbacksMouseDown.begin(); ( cbIter != mCallbacksMouseDown.end() ) && ( ! handled ); ++cbIter )
 		handled = (cbIter->second)( event );
@@ -72,6 +156,9 @@ void App::privateMouseDown__( const MouseEvent &event )
 
 void App::privateMouseUp__( const MouseEvent &event )
 {
+	requestRedraw();
+	privateFlushCoalescedEvents__();
+
 	bool handled = false;
 	for( CallbackMgr<bool (MouseEvent)>::iterator cbIter = mCallbacksMouseUp.begin(); ( cbIter != mCallbacksMouseUp.end() ) && ( ! handled ); ++cbIter )
 		handled = (cbIter->second)( event );
@@ -81,6 +168,9 @@ void App::privateMouseUp__( const MouseEvent &event )
 
 void App::privateMouseWheel__( const MouseEvent &event )
 {
+	requestRedraw();
+	privateFlushCoalescedEvents__();
+
 	bool handled = false;
 	for( CallbackMgr<bool (MouseEvent)>::iterator cbIter = mCallbacksMouseWheel.begin(); ( cbIter != mCallbacksMouseWheel.end() ) && ( ! handled ); ++cbIter )
 		handled = (cbIter->second)( event );
@@ -90,6 +180,15 @@ void App::privateMouseWheel__( const MouseEvent &event )
 
 void App::privateMouseMove__( const MouseEvent &event )
 {
+	requestRedraw();
+	if( getSettings().isEventCoalescingEnabled() ) {
+		if( mHasCoalescedMouseDrag )
+			privateFlushCoalescedEvents__();
+		mCoalescedMouseEvent = event;
+		mHasCoalescedMouseMove = true;
+		return;
+	}
+
 	bool handled = false;
 	for( CallbackMgr<bool (MouseEvent)>::iterator cbIter = mCallbacksMouseMove.begin(); ( cbIter != mCallbacksMouseMove.end() ) && ( ! handled ); ++cbIter )
 		handled = (cbIter->second)( event );
@@ -99,6 +198,15 @@ void App::privateMouseMove__( const MouseEvent &event )
 
 void App::privateMouseDrag__( const MouseEvent &event )
 {
+	requestRedraw();
+	if( getSettings().isEventCoalescingEnabled() ) {
+		if( mHasCoalescedMouseMove )
+			privateFlushCoalescedEvents__();
+		mCoalescedMouseEvent = event;
+		mHasCoalescedMouseDrag = true;
+		return;
+	}
+
 	bool handled = false;
 	for( CallbackMgr<bool (MouseEvent)>::iterator cbIter = mCallbacksMouseDrag.begin(); ( cbIter != mCallbacksMouseDrag.end() ) && ( ! handled ); ++cbIter )
 		handled = (cbIter->second)( event );
@@ -106,8 +214,31 @@ void App::privateMouseDrag__( const MouseEvent &event )
 		mouseDrag( event );
 }
 
+void App::privateFlushCoalescedEvents__()
+{
+	if( ! ( mHasCoalescedMouseMove || mHasCoalescedMouseDrag ) )
+		return;
+
+	// a mouse event carries absolute state, so the latest one stands for all those merged into it
+	bool drag = mHasCoalescedMouseDrag;
+	mHasCoalescedMouseMove = mHasCoalescedMouseDrag = false;
+	CallbackMgr<bool (MouseEvent)> &callbacks = ( drag ) ? mCallbacksMouseDrag : mCallbacksMouseMove;
+	bool handled = false;
+	for( CallbackMgr<bool (MouseEvent)>::iterator cbIter = callbacks.begin(); ( cbIter != callbacks.end() ) && ( ! handled ); ++cbIter )
+		handled = (cbIter->second)( mCoalescedMouseEvent );
+	if( ! handled ) {
+		if( drag )
+			mouseDrag( mCoalescedMouseEvent );
+		else
+			mouseMove( mCoalescedMouseEvent );
+	}
+}
+
 void App::privateKeyDown__( const KeyEvent &event )
 {
+	requestRedraw();
+	privateFlushCoalescedEvents__();
+
 	bool handled = false;
 	for( CallbackMgr<bool (KeyEvent)>::iterator cbIter = mCallbacksKeyDown.begin(); ( cbIter != mCallbacksKeyDown.end() ) && ( ! handled ); ++cbIter )
 		handled = (cbIter->second)( event );		
@@ -117,6 +248,9 @@ void App::privateKeyDown__( const KeyEvent &event )
 
 void App::privateKeyUp__( const KeyEvent &event )
 {
+	requestRedraw();
+	privateFlushCoalescedEvents__();
+
 	bool handled = false;
 	for( CallbackMgr<bool (KeyEvent)>::iterator cbIter = mCallbacksKeyUp.begin(); ( cbIter != mCallbacksKeyUp.end() ) && ( ! handled ); ++cbIter )
 		handled = (cbIter->second)( event );		
@@ -126,6 +260,7 @@ void App::privateKeyUp__( const KeyEvent &event )
 
 void App::privateResize__( const ResizeEvent &event )
 {
+	requestRedraw();
 	getRenderer()->defaultResize();
 
 	bool handled = false;
@@ -137,6 +272,7 @@ void App::privateResize__( const ResizeEvent &event )
 
 void App::privateFileDrop__( const FileDropEvent &event )
 {
+	requestRedraw();
 	bool handled = false;
 	for( CallbackMgr<bool (FileDropEvent)>::iterator cbIter = mCallbacksFileDrop.begin(); ( cbIter != mCallbacksFileDrop.end() ) && ( ! handled ); ++cbIter )
 		handled = (cbIter->second)( event );
@@ -146,16 +282,116 @@ void App::privateFileDrop__( const FileDropEvent &event )
 
 void App::privateSetup__()
 {
+	if( getSettings().getFixedFrameDuration() > 0 )
+		mFixedFrameTime = 0;
 	mTimeline->stepTo( getElapsedSeconds() );
+
+	Profiler &profiler = Profiler::get();
+	double setupStart = profiler.getSeconds();
+	if( mLaunchSeconds >= 0 ) {
+		profiler.addInitialization( "Static initialization", 0, mLaunchSeconds );
+		profiler.addInitialization( "Launch", mLaunchSeconds, setupStart );
+	}
 	setup();
+	mSetupEndSeconds = profiler.getSeconds();
+	profiler.addInitialization( "setup()", setupStart, mSetupEndSeconds );
+}
+
+void App::dispatchAsync( const std::function<void()> &fn )
+{
+	if( fn ) {
+		mDispatchQueue->push( new std::function<void()>( fn ) );
+		requestRedraw();
+	}
+}
+
+void App::setDispatchBudget( double seconds )
+{
+	mDispatchQueue->mBudget = std::max( 0.0, seconds );
+}
+
+double App::getDispatchBudget() const
+{
+	return mDispatchQueue->mBudget;
+}
+
+void App::requestRedraw()
+{
+	if( ! getSettings().isEventDrivenRedrawEnabled() )
+		return;
+
+	// only the first request since the frame started needs to wake the loop
+	if( detail::lockFreeCompareAndSwap( &mRedrawRequested, 0, 1 ) )
+		privateWakeUp__();
+}
+
+bool App::privateIsRedrawNeeded__() const
+{
+	if( ! getSettings().isEventDrivenRedrawEnabled() )
+		return true;
+
+	return mTimelineActive || mRedrawFollowUp || ( detail::lockFreeLoadAcquire( &mRedrawRequested ) != 0 );
 }
 
 void App::privateUpdate__()
 {
-	update();
-	mFrameCount++;
+	// anything requested from here on, including by the dispatched functions and update(), calls for the next frame
+	uint32_t redrawRequested;
+	do {
+		redrawRequested = detail::lockFreeLoadAcquire( &mRedrawRequested );
+	} while( ! detail::lockFreeCompareAndSwap( &mRedrawRequested, redrawRequested, 0 ) );
+
+	mFramePacer->beginFrame();
+	Profiler::get().beginFrame();
+	privateFlushCoalescedEvents__();
+	FileWatcher::get().update();
+
+	double frameDuration = getSettings().getFixedFrameDuration();
+	if( frameDuration > 0 )
+		mFixedFrameTime = mFrameCount * frameDuration;
+
+	// call the functions dispatched before this frame, stopping early if they exceed the budget
+	if( ! mDispatchQueue->mFrameMarkerQueued ) {
+		mDispatchQueue->push( 0 );
+		mDispatchQueue->mFrameMarkerQueued = true;
+	}
+	double deadline = mTimer.getSeconds() + mDispatchQueue->mBudget;
+	std::function<void()> *fn;
+	while( mDispatchQueue->pop( &fn ) ) {
+		if( ! fn ) {
+			mDispatchQueue->mFrameMarkerQueued = false;
+			break;
+		}
+		(*fn)();
+		delete fn;
+		if( ( mDispatchQueue->mBudget > 0 ) && ( mTimer.getSeconds() >= deadline ) )
+			break;
+	}
 
-	mTimeline->stepTo( getElapsedSeconds() );
+	if( getSettings().isThreadedUpdateEnabled() ) {
+		if( ! mUpdateThread ) {
+			mUpdateThread = shared_ptr<UpdateThread>( new UpdateThread );
+			mUpdateThread->mThread = shared_ptr<thread>( new thread( std::bind( &App::updateThreadFn, this ) ) );
+		}
+		// wait for the previous frame's update(), hand its results to draw() and start the next one, which runs while this frame draws
+		std::unique_lock<std::mutex> lock( mUpdateThread->mMutex );
+		while( mUpdateThread->mUpdateRequested )
+			mUpdateThread->mCond.wait( lock );
+		mUpdateAlpha = mPendingUpdateAlpha;
+		mFramePacer->mLastUpdateDuration = mPendingUpdateDuration;
+		mTimelineActive = mPendingTimelineActive;
+		mRedrawFollowUp = ( redrawRequested != 0 ) || mTimelineActive;
+		swapFrameState();
+		mUpdateThread->mUpdateRequested = true;
+		mUpdateThread->mCond.notify_all();
+	}
+	else {
+		stepUpdate();
+		mUpdateAlpha = mPendingUpdateAlpha;
+		mFramePacer->mLastUpdateDuration = mPendingUpdateDuration;
+		mTimelineActive = mPendingTimelineActive;
+	}
+	mFrameCount++;
 
 	double now = mTimer.getSeconds();
 	if( now > mFpsLastSampleTime + mFpsSampleInterval ) {
@@ -168,18 +404,101 @@ void App::privateUpdate__()
 	}
 }
 
+void App::stepUpdate()
+{
+	double start = mTimer.getSeconds();
+	float rate = getSettings().getFixedUpdateRate();
+	if( rate <= 0 ) {
+		update();
+		mPendingUpdateAlpha = 1;
+	}
+	else {
+		// run as many fixed-length updates as the elapsed time calls for, up to the cap; time beyond the cap is dropped
+		double interval = 1.0 / rate;
+		double now = getElapsedSeconds();
+		if( mFixedUpdateTime < 0 )
+			mFixedUpdateTime = now - interval;
+		int maxUpdates = getSettings().getMaxUpdatesPerFrame();
+		for( int u = 0; ( u < maxUpdates ) && ( mFixedUpdateTime + interval <= now ); ++u ) {
+			update();
+			mFixedUpdateTime += interval;
+		}
+		if( mFixedUpdateTime + interval <= now )
+			mFixedUpdateTime = now - std::fmod( now - mFixedUpdateTime, interval );
+		mPendingUpdateAlpha = std::min( 0.999999f, (float)( ( now - mFixedUpdateTime ) / interval ) );
+	}
+
+	mTimeline->stepTo( getElapsedSeconds() );
+	mPendingTimelineActive = mTimeline->hasActiveItems();
+	mPendingUpdateDuration = mTimer.getSeconds() - start;
+}
+
+void App::updateThreadFn()
+{
+	ThreadSetup threadSetup;
+
+	while( true ) {
+		{
+			std::unique_lock<std::mutex> lock( mUpdateThread->mMutex );
+			while( ( ! mUpdateThread->mUpdateRequested ) && ( ! mUpdateThread->mQuit ) )
+				mUpdateThread->mCond.wait( lock );
+			if( mUpdateThread->mQuit )
+				return;
+		}
+
+		stepUpdate();
+
+		std::lock_guard<std::mutex> lock( mUpdateThread->mMutex );
+		mUpdateThread->mUpdateRequested = false;
+		mUpdateThread->mCond.notify_all();
+	}
+}
+
+void App::stopUpdateThread()
+{
+	if( ! mUpdateThread )
+		return;
+
+	// let an update() in progress finish rather than abandoning it
+	{
+		std::unique_lock<std::mutex> lock( mUpdateThread->mMutex );
+		while( mUpdateThread->mUpdateRequested )
+			mUpdateThread->mCond.wait( lock );
+		mUpdateThread->mQuit = true;
+		mUpdateThread->mCond.notify_all();
+	}
+	mUpdateThread->mThread->join();
+	mUpdateThread.reset();
+}
+
 void App::privateDraw__()
 {
+	mFramePacer->beginDraw();
 	draw();
+	mFramePacer->endDraw();
+
+	if( mSetupEndSeconds >= 0 ) {
+		Profiler::get().addInitialization( "First frame", mSetupEndSeconds, Profiler::get().getSeconds() );
+		mSetupEndSeconds = -1;
+		if( getSettings().isStartupReportEnabled() )
+			Profiler::get().writeStartupReport( console() );
+	}
 }
 
 void App::privateShutdown__()
 {
+	stopUpdateThread();
 	shutdown();
 }
 	
 DataSourceRef App::loadResource( const string &macPath, int mswID, const string &mswType )
 {
+	if( App::get() ) {
+		DataSourceRef archived = App::get()->loadArchivedAsset( macPath );
+		if( archived )
+			return archived;
+	}
+
 #if defined( CINDER_COCOA )
 	return loadResource( macPath );
 #else
@@ -190,6 +509,12 @@ DataSourceRef App::loadResource( const string &macPath, int mswID, const string
 #if defined( CINDER_COCOA )
 DataSourceRef App::loadResource( const string &macPath )
 {
+	if( App::get() ) {
+		DataSourceRef archived = App::get()->loadArchivedAsset( macPath );
+		if( archived )
+			return archived;
+	}
+
 	fs::path resourcePath = App::get()->getResourcePath( macPath );
 	if( resourcePath.empty() )
 		throw ResourceLoadExc( macPath );
@@ -210,9 +535,15 @@ void App::prepareAssetLoading()
 {
 	if( ! mAssetDirectoriesInitialized ) {
 		fs::path appPath = getAppPath();
+		// an assets.pak archive is mounted ahead of the loose files of an assets directory next to it
+		bool archiveMounted = false;
 
 		// if this is Mac OS or iOS, search inside the bundle's resources, and then the bundle's root
 #if defined( CINDER_COCOA )
+		if( fs::exists( getResourcePath() / "assets.pak" ) ) {
+			mAssetArchives.push_back( AssetArchive::create( getResourcePath() / "assets.pak" ) );
+			archiveMounted = true;
+		}
 		if( fs::exists( getResourcePath() / "assets" ) && fs::is_directory( getResourcePath() / "assets" ) ) {
 			mAssetDirectories.push_back( getResourcePath() / "assets" );
 			mAssetDirectoriesInitialized = true;
@@ -232,14 +563,21 @@ void App::prepareAssetLoading()
 		}
 #endif		
 
-		// first search the local directory, then its parent, up to 5 levels up
+		// first search the local directory, then its parent, up to 5 levels up, for either an archive or a directory of assets
 		fs::path curPath = appPath;
 		for( int parentCt = 0; parentCt <= 5; ++parentCt ) {
+			fs::path curArchivePath = curPath / "assets.pak";
 			fs::path curAssetPath = curPath / "assets";
+			if( ( ! archiveMounted ) && fs::exists( curArchivePath ) && fs::is_regular_file( curArchivePath ) ) {
+				mAssetArchives.push_back( AssetArchive::create( curArchivePath ) );
+				archiveMounted = true;
+			}
 			if( fs::exists( curAssetPath ) && fs::is_directory( curAssetPath ) ) {
 				mAssetDirectories.push_back( curAssetPath );
 				break;
 			}
+			else if( archiveMounted )
+				break;
 			curPath = curPath.parent_path();
 		}
 				
@@ -260,8 +598,24 @@ fs::path App::findAssetPath( const fs::path &relativePath )
 	return fs::path();
 }
 
+DataSourceRef App::loadArchivedAsset( const fs::path &relativePath )
+{
+	prepareAssetLoading();
+	for( vector<AssetArchiveRef>::const_iterator archiveIt = mAssetArchives.begin(); archiveIt != mAssetArchives.end(); ++archiveIt ) {
+		DataSourceRef result = (*archiveIt)->load( relativePath );
+		if( result )
+			return result;
+	}
+
+	return DataSourceRef();
+}
+
 DataSourceRef App::loadAsset( const fs::path &relativePath )
 {
+	DataSourceRef archived = loadArchivedAsset( relativePath );
+	if( archived )
+		return archived;
+
 	fs::path assetPath = findAssetPath( relativePath );
 	if( ! assetPath.empty() )
 		return DataSourcePath::create( assetPath.string() );
@@ -280,6 +634,11 @@ void App::addAssetDirectory( const fs::path &dirPath )
 	mAssetDirectories.push_back( dirPath );
 }
 
+void App::addAssetArchive( const fs::path &archivePath )
+{
+	mAssetArchives.push_back( AssetArchive::create( archivePath ) );
+}
+
 #if defined( CINDER_COCOA )
 fs::path App::getResourcePath( const fs::path &rsrcRelativePath )
 {
@@ -469,6 +828,7 @@ void App::prepareLaunch()
 void App::executeLaunch( App *app, class Renderer *renderer, const char *title, int argc, char * const argv[] )
 {
 	sInstance = app;
+	app->mLaunchSeconds = Profiler::get().getSeconds();
 	app->mRenderer = shared_ptr<Renderer>( renderer );
 	app->launch( title, argc, argv );
 }
@@ -496,6 +856,15 @@ App::Settings::Settings()
     mWindowPositionY = 0;
 	mPowerManagement = false;
 	mFrameRate = 60.0f;
+	mThreadedUpdate = false;
+	mFixedUpdateRate = 0;
+	mMaxUpdatesPerFrame = 5;
+	mEventCoalescing = false;
+	mHeadless = false;
+	mFixedFrameDuration = 0;
+	mFrameLimit = 0;
+	mEventDrivenRedraw = false;
+	mStartupReport = false;
 }
 
 void App::Settings::setWindowSize( int aWindowSizeX, int aWindowSizeY )
@@ -40,6 +40,7 @@ AppBasic::AppBasic()
 	: App()
 {
 	mImpl = 0;
+	mHasCoalescedTouchesMoved = false;
 }
 
 AppBasic::~AppBasic()
@@ -316,6 +317,56 @@ const Display& AppBasic::getDisplay()
 
 #endif
 
+WindowRef AppBasic::createWindow( const Window::Format &format )
+{
+	RendererGl *sharedRenderer = dynamic_cast<RendererGl*>( getRenderer() );
+	WindowRef window( new Window( this, format, sharedRenderer ) );
+	mWindows.push_back( window );
+
+	// creating the window's context made it current
+	if( sharedRenderer )
+		sharedRenderer->makeCurrentContext();
+
+	return window;
+}
+
+void AppBasic::privateDrawWindows__()
+{
+	if( mWindows.empty() )
+		return;
+
+	for( std::vector<WindowRef>::iterator winIt = mWindows.begin(); winIt != mWindows.end(); ) {
+		if( (*winIt)->isClosed() )
+			winIt = mWindows.erase( winIt );
+		else
+			++winIt;
+	}
+
+	// iterate a copy since drawWindow() may create or close windows
+	std::vector<WindowRef> windows( mWindows );
+	for( std::vector<WindowRef>::iterator winIt = windows.begin(); winIt != windows.end(); ++winIt ) {
+		(*winIt)->getRenderer()->startDraw();
+		(*winIt)->privateUpdateSize__();
+		drawWindow( *winIt );
+		(*winIt)->getRenderer()->finishDraw();
+	}
+
+	// leave the app's context current for the next update()
+	if( RendererGl *rendererGl = dynamic_cast<RendererGl*>( getRenderer() ) )
+		rendererGl->makeCurrentContext();
+}
+
+void AppBasic::privateWakeUp__()
+{
+	if( ! mImpl )
+		return;
+#if defined( CINDER_COCOA )
+	[mImpl wakeUp];
+#elif defined( CINDER_MSW )
+	mImpl->wakeUp();
+#endif
+}
+
 void AppBasic::privateResize__( const ResizeEvent &event )
 {	
 #if defined( CINDER_MAC )
@@ -327,6 +378,9 @@ void AppBasic::privateResize__( const ResizeEvent &event )
 
 void AppBasic::privateTouchesBegan__( const TouchEvent &event )
 {
+	requestRedraw();
+	privateFlushCoalescedEvents__();
+
 	bool handled = false;
 	for( CallbackMgr<bool (TouchEvent)>::iterator cbIter = mCallbacksTouchesBegan.begin(); ( cbIter != mCallbacksTouchesBegan.end() ) && ( ! handled ); ++cbIter )
 		handled = (cbIter->second)( event );		
@@ -336,6 +390,16 @@ void AppBasic::privateTouchesBegan__( const TouchEvent &event )
 
 void AppBasic::privateTouchesMoved__( const TouchEvent &event )
 {	
+	requestRedraw();
+	if( getSettings().isEventCoalescingEnabled() ) {
+		if( mHasCoalescedTouchesMoved )
+			mCoalescedTouchesMoved.coalesce( event );
+		else
+			mCoalescedTouchesMoved = event;
+		mHasCoalescedTouchesMoved = true;
+		return;
+	}
+
 	bool handled = false;
 	for( CallbackMgr<bool (TouchEvent)>::iterator cbIter = mCallbacksTouchesMoved.begin(); ( cbIter != mCallbacksTouchesMoved.end() ) && ( ! handled ); ++cbIter )
 		handled = (cbIter->second)( event );		
@@ -345,6 +409,9 @@ void AppBasic::privateTouchesMoved__( const TouchEvent &event )
 
 void AppBasic::privateTouchesEnded__( const TouchEvent &event )
 {	
+	requestRedraw();
+	privateFlushCoalescedEvents__();
+
 	bool handled = false;
 	for( CallbackMgr<bool (TouchEvent)>::iterator cbIter = mCallbacksTouchesEnded.begin(); ( cbIter != mCallbacksTouchesEnded.end() ) && ( ! handled ); ++cbIter )
 		handled = (cbIter->second)( event );		
@@ -352,6 +419,21 @@ void AppBasic::privateTouchesEnded__( const TouchEvent &event )
 		touchesEnded( event );
 }
 
+void AppBasic::privateFlushCoalescedEvents__()
+{
+	App::privateFlushCoalescedEvents__();
+	if( ! mHasCoalescedTouchesMoved )
+		return;
+
+	mHasCoalescedTouchesMoved = false;
+	TouchEvent event( mCoalescedTouchesMoved );
+	bool handled = false;
+	for( CallbackMgr<bool (TouchEvent)>::iterator cbIter = mCallbacksTouchesMoved.begin(); ( cbIter != mCallbacksTouchesMoved.end() ) && ( ! handled ); ++cbIter )
+		handled = (cbIter->second)( event );		
+	if( ! handled )	
+		touchesMoved( event );
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 // AppBasic::Settings
 AppBasic::Settings::Settings()
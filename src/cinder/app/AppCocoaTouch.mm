@@ -125,6 +125,7 @@ AppCocoaTouch::AppCocoaTouch()
 	mState = std::shared_ptr<AppCocoaTouchState>( new AppCocoaTouchState() );
 	mState->mStartTime = ::CFAbsoluteTimeGetCurrent();
 	mLastAccel = mLastRawAccel = Vec3f::zero();
+	mHasCoalescedTouchesMoved = false;
 }
 
 void AppCocoaTouch::launch( const char *title, int argc, char * const argv[] )
@@ -222,6 +223,8 @@ void AppCocoaTouch::privatePrepareSettings__()
 
 void AppCocoaTouch::privateTouchesBegan__( const TouchEvent &event )
 {
+	privateFlushCoalescedEvents__();
+
 	bool handled = false;
 	for( CallbackMgr<bool (TouchEvent)>::iterator cbIter = mCallbacksTouchesBegan.begin(); ( cbIter != mCallbacksTouchesBegan.end() ) && ( ! handled ); ++cbIter )
 		handled = (cbIter->second)( event );		
@@ -231,6 +234,15 @@ void AppCocoaTouch::privateTouchesBegan__( const TouchEvent &event )
 
 void AppCocoaTouch::privateTouchesMoved__( const TouchEvent &event )
 {	
+	if( getSettings().isEventCoalescingEnabled() ) {
+		if( mHasCoalescedTouchesMoved )
+			mCoalescedTouchesMoved.coalesce( event );
+		else
+			mCoalescedTouchesMoved = event;
+		mHasCoalescedTouchesMoved = true;
+		return;
+	}
+
 	bool handled = false;
 	for( CallbackMgr<bool (TouchEvent)>::iterator cbIter = mCallbacksTouchesMoved.begin(); ( cbIter != mCallbacksTouchesMoved.end() ) && ( ! handled ); ++cbIter )
 		handled = (cbIter->second)( event );		
@@ -240,6 +252,8 @@ void AppCocoaTouch::privateTouchesMoved__( const TouchEvent &event )
 
 void AppCocoaTouch::privateTouchesEnded__( const TouchEvent &event )
 {	
+	privateFlushCoalescedEvents__();
+
 	bool handled = false;
 	for( CallbackMgr<bool (TouchEvent)>::iterator cbIter = mCallbacksTouchesEnded.begin(); ( cbIter != mCallbacksTouchesEnded.end() ) && ( ! handled ); ++cbIter )
 		handled = (cbIter->second)( event );		
@@ -247,6 +261,21 @@ void AppCocoaTouch::privateTouchesEnded__( const TouchEvent &event )
 		touchesEnded( event );
 }
 
+void AppCocoaTouch::privateFlushCoalescedEvents__()
+{
+	App::privateFlushCoalescedEvents__();
+	if( ! mHasCoalescedTouchesMoved )
+		return;
+
+	mHasCoalescedTouchesMoved = false;
+	TouchEvent event( mCoalescedTouchesMoved );
+	bool handled = false;
+	for( CallbackMgr<bool (TouchEvent)>::iterator cbIter = mCallbacksTouchesMoved.begin(); ( cbIter != mCallbacksTouchesMoved.end() ) && ( ! handled ); ++cbIter )
+		handled = (cbIter->second)( event );		
+	if( ! handled )	
+		touchesMoved( event );
+}
+
 void AppCocoaTouch::privateAccelerated__( const Vec3f &direction )
 {
 	Vec3f filtered = mLastAccel * (1.0f - mAccelFilterFactor) + direction * mAccelFilterFactor;
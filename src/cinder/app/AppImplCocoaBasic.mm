@@ -83,7 +83,7 @@
 	
 	mFrameRate = app->getSettings().getFrameRate();
 	[self createWindow];
-	if( app->getSettings().isFullScreen() )
+	if( app->getSettings().isFullScreen() && ( ! app->getSettings().isHeadless() ) )
 		[self enterFullScreen];
 	app->getRenderer()->makeCurrentContext();
 	app->privateSetup__();
@@ -94,7 +94,8 @@
 - (void)startAnimationTimer
 {
 	if( ( animationTimer == nil ) || ( ! [animationTimer isValid] ) ) {
-		float interval = 1.0f / mFrameRate;
+		// headless apps draw frames back-to-back; NSTimer treats an interval of 0 as its minimum
+		float interval = ( app->getSettings().isHeadless() ) ? 0.0f : 1.0f / mFrameRate;
 		animationTimer = [NSTimer	 timerWithTimeInterval:interval
 													target:self
 												  selector:@selector(timerFired:)
@@ -106,10 +107,35 @@
 	app->getRenderer()->makeCurrentContext();
 }
 
+// Restarts the animation timer stopped while waiting for a frame to be requested. Safe to call from any thread.
+- (void)wakeUp
+{
+	[self performSelectorOnMainThread:@selector(startAnimationTimer) withObject:nil waitUntilDone:NO];
+}
+
 - (void)timerFired:(NSTimer *)t
 {
+	// with event-driven redraw, stop the timer until App::requestRedraw() calls for a frame
+	if( ! app->privateIsRedrawNeeded__() ) {
+		[animationTimer invalidate];
+		animationTimer = nil;
+		return;
+	}
+
 	app->privateUpdate__();
-	[cinderView draw];	
+	if( app->getSettings().isHeadless() ) {
+		// the view isn't displayed in a hidden window
+		app->getRenderer()->startDraw();
+		app->privateDraw__();
+		app->getRenderer()->finishDraw();
+	}
+	else
+		[cinderView draw];	
+	app->privateDrawWindows__();
+
+	uint32_t frameLimit = app->getSettings().getFrameLimit();
+	if( frameLimit && ( app->getElapsedFrames() >= frameLimit ) )
+		[self quit];
 }
 
 - (void)createWindow
@@ -156,7 +182,8 @@
     mWindowPositionY = offsetY;    
 		
 	[self startAnimationTimer];
-	[win makeKeyAndOrderFront:nil];
+	if( ! app->getSettings().isHeadless() )
+		[win makeKeyAndOrderFront:nil];
 	[win setInitialFirstResponder:cinderView];
 	[win setAcceptsMouseMovedEvents:YES];
 	[win setOpaque:YES];
@@ -51,7 +51,7 @@
 
 @implementation AppImplCocoaRendererGl
 
-- (id)initWithFrame:(NSRect)frame cinderView:(NSView*)aCinderView app:(cinder::app::App*)aApp renderer:(cinder::app::RendererGl*)aRenderer
+- (id)initWithFrame:(NSRect)frame cinderView:(NSView*)aCinderView app:(cinder::app::App*)aApp renderer:(cinder::app::RendererGl*)aRenderer sharedRenderer:(AppImplCocoaRendererGl*)aSharedRenderer
 {
 //	self = [super initWithFrame:frame cinderView:aCinderView app:aApp];
 	app = aApp;
@@ -65,6 +65,12 @@
 	renderer->setAntiAliasing( aaSamples );
 
 	view = [[AppImplCocoaTransparentGlView alloc] initWithFrame:frame pixelFormat:fmt];
+	if( aSharedRenderer ) {
+		// replace the view's context with one sharing the OpenGL objects of aSharedRenderer's
+		NSOpenGLContext *context = [[NSOpenGLContext alloc] initWithFormat:fmt shareContext:[aSharedRenderer getNSOpenGLContext]];
+		[view setOpenGLContext:context];
+		[context release];
+	}
 	[cinderView addSubview:view];
 	[[view openGLContext] makeCurrentContext];
 
@@ -122,8 +128,13 @@
 
 - (void)defaultResize
 {
-	glViewport( 0, 0, app->getWindowWidth(), app->getWindowHeight() );
-	cinder::CameraPersp cam( app->getWindowWidth(), app->getWindowHeight(), 60.0f );
+	// our view isn't necessarily in the app's window, so size to its bounds
+	NSRect bounds = [view bounds];
+	int width = static_cast<int>( bounds.size.width );
+	int height = static_cast<int>( bounds.size.height );
+
+	glViewport( 0, 0, width, height );
+	cinder::CameraPersp cam( width, height, 60.0f );
 
 	glMatrixMode( GL_PROJECTION );
 	glLoadMatrixf( cam.getProjectionMatrix().m );
@@ -131,7 +142,7 @@
 	glMatrixMode( GL_MODELVIEW );
 	glLoadMatrixf( cam.getModelViewMatrix().m );
 	glScalef( 1.0f, -1.0f, 1.0f );           // invert Y axis so increasing Y goes down.
-	glTranslatef( 0.0f, (float)-app->getWindowHeight(), 0.0f );       // shift origin up to upper-left corner.
+	glTranslatef( 0.0f, (float)-height, 0.0f );       // shift origin up to upper-left corner.
 }
 
 - (BOOL)acceptsFirstResponder
@@ -94,6 +94,26 @@
 {
 }
 
+// Marks the area of the CinderView as needing display, which AppKit accumulates until the next frame displays the view
+- (void)invalidateArea:(cinder::Area)area
+{
+	[[view superview] setNeedsDisplayInRect:NSMakeRect( area.x1, area.y1, area.getWidth(), area.getHeight() )];
+}
+
+// Appends the rects AppKit has clipped the CinderView's drawing to. Only meaningful while the CinderView is being drawn.
+- (void)getAreasBeingDrawn:(std::vector<cinder::Area>*)areas
+{
+	NSView *cinderView = [view superview];
+	if( [NSView focusView] != cinderView )
+		return;
+
+	const NSRect *rects;
+	NSInteger count;
+	[cinderView getRectsBeingDrawn:&rects count:&count];
+	for( NSInteger r = 0; r < count; ++r ) // the CinderView is flipped, so these are already in window coordinates
+		areas->push_back( cinder::Area( (int32_t)floor( NSMinX( rects[r] ) ), (int32_t)floor( NSMinY( rects[r] ) ), (int32_t)ceil( NSMaxX( rects[r] ) ), (int32_t)ceil( NSMaxY( rects[r] ) ) ) );
+}
+
 - (CGContextRef)getCGContextRef
 {
 	return currentRef;
@@ -28,6 +28,7 @@
 
 #include <windowsx.h>
 #include <winuser.h>
+#include <mmsystem.h>
 
 using std::vector;
 using std::string;
@@ -45,6 +46,7 @@ AppImplMswBasic::AppImplMswBasic( AppBasic *aApp )
 {
 	mShouldQuit = false;
 	mIsDragging = false;
+	mWnd = 0;
 }
 
 void AppImplMswBasic::run()
@@ -86,21 +88,58 @@ void AppImplMswBasic::run()
 	mHasBeenInitialized = true;
 	mApp->privateResize__( ResizeEvent( Vec2i( mWindowWidth, mWindowHeight ) ) );
 
-	::ShowWindow( mWnd, SW_SHOW );
-	::SetForegroundWindow( mWnd );
-	::SetFocus( mWnd );
+	bool headless = mApp->getSettings().isHeadless();
+	if( ! headless ) {
+		::ShowWindow( mWnd, SW_SHOW );
+		::SetForegroundWindow( mWnd );
+		::SetFocus( mWnd );
+	}
+
+	// the waitable timer in sleep() is only as fine as the system timer resolution, which defaults to 15.6ms
+	::timeBeginPeriod( 1 );
 
 	// initialize our next frame time
-	mNextFrameTime = getElapsedSeconds();
+	mNextFrameTime = mApp->getFramePacer().getSeconds();
 
 	// inner loop
 	while( ! mShouldQuit ) {
+		// with event-driven redraw, block until a message or App::requestRedraw() calls for a frame
+		if( ! mApp->privateIsRedrawNeeded__() ) {
+			::WaitMessage();
+			MSG msg;
+			while( ::PeekMessage( &msg, NULL, 0, 0, PM_REMOVE ) ) {
+				::TranslateMessage( &msg );
+				::DispatchMessage( &msg );
+			}
+			// the next frame starts now rather than catching up on the time spent idle
+			mNextFrameTime = mApp->getFramePacer().getSeconds();
+			continue;
+		}
+
 		// update and draw
 		mApp->privateUpdate__();
-		::RedrawWindow( mWnd, NULL, NULL, RDW_INVALIDATE | RDW_UPDATENOW );
+		if( headless ) {
+			// a hidden window isn't sent WM_PAINT
+			mApp->getRenderer()->startDraw();
+			mApp->privateDraw__();
+			mApp->getRenderer()->finishDraw();
+		}
+		else {
+			// with partial redraw only the areas invalidated since the last frame are painted, and if there are none the frame is skipped
+			Renderer2d *renderer2d = dynamic_cast<Renderer2d*>( mApp->getRenderer() );
+			if( renderer2d && renderer2d->isPartialRedrawEnabled() )
+				::RedrawWindow( mWnd, NULL, NULL, RDW_UPDATENOW );
+			else
+				::RedrawWindow( mWnd, NULL, NULL, RDW_INVALIDATE | RDW_UPDATENOW );
+		}
+		mApp->privateDrawWindows__();
+
+		uint32_t frameLimit = mApp->getSettings().getFrameLimit();
+		if( frameLimit && ( mApp->getElapsedFrames() >= frameLimit ) )
+			quit();
 
-		// get current time in seconds
-		double currentSeconds = mApp->getElapsedSeconds();
+		// get current time in seconds; getElapsedSeconds() may be advancing by a fixed amount per frame instead
+		double currentSeconds = mApp->getFramePacer().getSeconds();
 
 		// calculate time per frame in seconds
 		double secondsPerFrame = 1.0 / mFrameRate;
@@ -115,9 +154,13 @@ void AppImplMswBasic::run()
 		// determine when next frame should be drawn
 		mNextFrameTime += secondsPerFrame;
 
-		// sleep and process messages until next frame
-		if(mNextFrameTime > currentSeconds)
-			sleep(mNextFrameTime - currentSeconds);
+		// sleep and process messages until shortly before the next frame, then spin to hit it precisely. Headless apps don't wait at all.
+		if( ( ! headless ) && ( mNextFrameTime > currentSeconds ) ) {
+			double spinStart = mNextFrameTime - mApp->getFramePacer().getSpinDuration();
+			if( spinStart > currentSeconds )
+				sleep( spinStart - currentSeconds );
+			mApp->getFramePacer().spinUntil( mNextFrameTime );
+		}
 		else {
 			MSG msg;
 			while( ::PeekMessage( &msg, NULL, 0, 0, PM_REMOVE ) ) {
@@ -127,11 +170,19 @@ void AppImplMswBasic::run()
 		}
 	}
 
+	::timeEndPeriod( 1 );
 	killWindow( mFullScreen );
 	mApp->privateShutdown__();
 	delete mApp;
 }
 
+void AppImplMswBasic::wakeUp()
+{
+	// any message ends WaitMessage() in run()
+	if( mWnd )
+		::PostMessage( mWnd, WM_NULL, 0, 0 );
+}
+
 void AppImplMswBasic::sleep( double seconds )
 {
 	// create waitable timer
@@ -29,7 +29,7 @@
 namespace cinder { namespace app {
 
 AppImplMswRendererGdi::AppImplMswRendererGdi( App *aApp, bool doubleBuffer )
-	: AppImplMswRenderer( aApp ), mDoubleBuffer( doubleBuffer ), mDoubleBufferBitmap( 0 )
+	: AppImplMswRenderer( aApp ), mPartialRedraw( false ), mDoubleBuffer( doubleBuffer ), mDoubleBufferBitmap( 0 )
 {
 }
 
@@ -39,12 +39,20 @@ void AppImplMswRendererGdi::defaultResize() const
 void AppImplMswRendererGdi::swapBuffers() const
 {
 	if( mDoubleBuffer ) {
-		::BitBlt( mPaintDc, 0, 0, mDoubleBufferBitmapSize.x, mDoubleBufferBitmapSize.y, mDoubleBufferDc, 0, 0, SRCCOPY );
+		if( mUpdateAreas.empty() )
+			::BitBlt( mPaintDc, 0, 0, mDoubleBufferBitmapSize.x, mDoubleBufferBitmapSize.y, mDoubleBufferDc, 0, 0, SRCCOPY );
+		else {
+			// the rest of the window still shows the previous frame
+			for( std::vector<Area>::const_iterator areaIt = mUpdateAreas.begin(); areaIt != mUpdateAreas.end(); ++areaIt )
+				::BitBlt( mPaintDc, areaIt->x1, areaIt->y1, areaIt->getWidth(), areaIt->getHeight(), mDoubleBufferDc, areaIt->x1, areaIt->y1, SRCCOPY );
+		}
 
 		// Always select the old bitmap back into the device context
 		::SelectObject( mDoubleBufferDc, mDoubleBufferOldBitmap );
 		::DeleteDC( mDoubleBufferDc );		
 	}
+	else if( ! mUpdateAreas.empty() )
+		::SelectClipRgn( mPaintDc, NULL ); // the window's DC is its own, so the clip region would outlive the frame
 
 	if( mApp->getsWindowsPaintEvents() )
 		::EndPaint( mWnd, &mPaintStruct );
@@ -54,6 +62,17 @@ void AppImplMswRendererGdi::swapBuffers() const
 
 void AppImplMswRendererGdi::makeCurrentContext()
 {
+	// the update region has to be read before BeginPaint() validates it
+	mUpdateAreas.clear();
+	::HRGN updateRgn = 0;
+	if( mPartialRedraw ) {
+		updateRgn = ::CreateRectRgn( 0, 0, 0, 0 );
+		if( ::GetUpdateRgn( mWnd, updateRgn, FALSE ) <= NULLREGION ) {
+			::DeleteObject( updateRgn );
+			updateRgn = 0;
+		}
+	}
+
 	if( mApp->getsWindowsPaintEvents() )
 		mPaintDc = ::BeginPaint( mWnd, &mPaintStruct );
 	else
@@ -72,9 +91,27 @@ void AppImplMswRendererGdi::makeCurrentContext()
 			
 			mDoubleBufferBitmap = ::CreateCompatibleBitmap( mPaintDc, windowSize.x, windowSize.y );
 			mDoubleBufferBitmapSize = windowSize;
+			// a new bitmap has no previous frame to keep
+			if( updateRgn ) {
+				::DeleteObject( updateRgn );
+				updateRgn = 0;
+			}
 		}
 		mDoubleBufferOldBitmap = (::HBITMAP)::SelectObject( mDoubleBufferDc, mDoubleBufferBitmap );
 	}
+
+	if( updateRgn ) {
+		::SelectClipRgn( getDc(), updateRgn );
+		::DWORD dataSize = ::GetRegionData( updateRgn, 0, NULL );
+		std::vector<uint8_t> data( dataSize );
+		::RGNDATA *rgnData = reinterpret_cast<RGNDATA*>( &data[0] );
+		if( dataSize && ::GetRegionData( updateRgn, dataSize, rgnData ) ) {
+			const ::RECT *rects = reinterpret_cast<const RECT*>( rgnData->Buffer );
+			for( ::DWORD r = 0; r < rgnData->rdh.nCount; ++r )
+				mUpdateAreas.push_back( Area( rects[r].left, rects[r].top, rects[r].right, rects[r].bottom ) );
+		}
+		::DeleteObject( updateRgn );
+	}
 }
 
 bool AppImplMswRendererGdi::initialize( HWND wnd, HDC dc )
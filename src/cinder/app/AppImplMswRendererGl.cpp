@@ -31,8 +31,8 @@ namespace cinder { namespace app {
 bool sMultisampleSupported = false;
 int sArbMultisampleFormat;
 
-AppImplMswRendererGl::AppImplMswRendererGl( App *aApp, RendererGl *aRenderer )
-	: AppImplMswRenderer( aApp ), mRenderer( aRenderer )
+AppImplMswRendererGl::AppImplMswRendererGl( App *aApp, RendererGl *aRenderer, AppImplMswRendererGl *sharedImpl )
+	: AppImplMswRenderer( aApp ), mRenderer( aRenderer ), mSharedImpl( sharedImpl )
 {
 	mPrevRC = 0;
 	mRC = 0;
@@ -52,8 +52,14 @@ void AppImplMswRendererGl::finishToggleFullScreen()
 
 void AppImplMswRendererGl::defaultResize() const
 {
-	glViewport( 0, 0, mApp->getWindowWidth(), mApp->getWindowHeight() );
-	cinder::CameraPersp cam( mApp->getWindowWidth(), mApp->getWindowHeight(), 60.0f );
+	// our window isn't necessarily the app's, so size to its client area
+	RECT clientRect;
+	::GetClientRect( mWnd, &clientRect );
+	int width = clientRect.right - clientRect.left;
+	int height = clientRect.bottom - clientRect.top;
+
+	glViewport( 0, 0, width, height );
+	cinder::CameraPersp cam( width, height, 60.0f );
 
 	glMatrixMode( GL_PROJECTION );
 	glLoadMatrixf( cam.getProjectionMatrix().m );
@@ -61,7 +67,7 @@ void AppImplMswRendererGl::defaultResize() const
 	glMatrixMode( GL_MODELVIEW );
 	glLoadMatrixf( cam.getModelViewMatrix().m );
 	glScalef( 1.0f, -1.0f, 1.0f );           // invert Y axis so increasing Y goes down.
-	glTranslatef( 0.0f, (float)-mApp->getWindowHeight(), 0.0f );       // shift origin up to upper-left corner.
+	glTranslatef( 0.0f, (float)-height, 0.0f );       // shift origin up to upper-left corner.
 }
 
 void AppImplMswRendererGl::swapBuffers() const
@@ -220,6 +226,12 @@ bool AppImplMswRendererGl::initializeInternal( HWND wnd, HDC dc )
 		return false;								
 	}
 
+	// sharing has to be established before the new context creates any objects of its own
+	if( mSharedImpl && mSharedImpl->mRC ) {
+		if( ! ::wglShareLists( mSharedImpl->mRC, mRC ) )
+			return false;
+	}
+
 	if( ! ::wglMakeCurrent( dc, mRC ) ){					// Try To Activate The Rendering Context
 		return false;								
 	}
@@ -0,0 +1,349 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/app/AssetManager.h"
+#include "cinder/app/App.h"
+#include "cinder/ImageIo.h"
+#include "cinder/ObjLoader.h"
+
+using namespace std;
+
+namespace cinder { namespace app {
+
+// Delivers a load's result to the AssetManager on the app's thread, unless the AssetManager is gone by then
+struct AssetManager::Completion {
+	void operator()() const
+	{
+		AssetManagerRef manager = mManager.lock();
+		if( manager )
+			manager->complete( mKey, mSurface, mTriMesh, mFailed );
+	}
+
+	std::weak_ptr<AssetManager>	mManager;
+	Key							mKey;
+	Surface8u					mSurface;
+	std::shared_ptr<TriMesh>	mTriMesh;
+	bool						mFailed;
+};
+
+namespace { // anonymous namespace
+
+size_t calcTriMeshSize( const TriMesh &triMesh )
+{
+	return triMesh.getVertices().size() * sizeof(Vec3f) + triMesh.getNormals().size() * sizeof(Vec3f) + triMesh.getTexCoords().size() * sizeof(Vec2f)
+		+ triMesh.getColorsRGB().size() * sizeof(Color) + triMesh.getColorsRGBA().size() * sizeof(ColorA) + triMesh.getIndices().size() * sizeof(uint32_t);
+}
+
+} // anonymous namespace
+
+AssetManagerRef AssetManager::create( size_t memoryBudget, int32_t numThreads )
+{
+	AssetManagerRef result( new AssetManager( memoryBudget, numThreads ) );
+	result->mWeakThis = result;
+	return result;
+}
+
+AssetManager::AssetManager( size_t memoryBudget, int32_t numThreads )
+	: mMemoryBudget( memoryBudget ), mMemoryUsage( 0 ), mQuit( false )
+{
+	for( int32_t t = 0; t < std::max<int32_t>( 1, numThreads ); ++t )
+		mThreads.push_back( std::shared_ptr<std::thread>( new std::thread( std::bind( &AssetManager::threadFn, this ) ) ) );
+}
+
+AssetManager::~AssetManager()
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mQuit = true;
+		mQueue.clear();
+		mRequests.clear();
+	}
+	mJobCond.notify_all();
+	for( vector<std::shared_ptr<std::thread> >::iterator threadIt = mThreads.begin(); threadIt != mThreads.end(); ++threadIt )
+		(*threadIt)->join();
+}
+
+Surface8u AssetManager::getSurface( const fs::path &path, float priority, const SurfaceFn &readyFn )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	Request *request;
+	Item *item = find( SURFACE, path, priority, &request );
+	if( item )
+		return item->mSurface;
+	if( request && readyFn )
+		request->mSurfaceFns.push_back( readyFn );
+	return Surface8u();
+}
+
+gl::Texture AssetManager::getTexture( const fs::path &path, float priority, const TextureFn &readyFn, const gl::Texture::Format &format )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	Request *request;
+	Item *item = find( TEXTURE, path, priority, &request );
+	if( item )
+		return item->mTexture;
+	if( request ) {
+		request->mFormat = format;
+		if( readyFn )
+			request->mTextureFns.push_back( readyFn );
+	}
+	return gl::Texture();
+}
+
+std::shared_ptr<TriMesh> AssetManager::getTriMesh( const fs::path &path, float priority, const TriMeshFn &readyFn )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	Request *request;
+	Item *item = find( TRIMESH, path, priority, &request );
+	if( item )
+		return item->mTriMesh;
+	if( request && readyFn )
+		request->mTriMeshFns.push_back( readyFn );
+	return std::shared_ptr<TriMesh>();
+}
+
+AssetManager::Item* AssetManager::find( Kind kind, const fs::path &path, float priority, Request **request )
+{
+	*request = 0;
+	Key key( kind, path.string() );
+	map<Key,Item>::iterator itemIt = mItems.find( key );
+	if( itemIt != mItems.end() ) {
+		mLru.splice( mLru.begin(), mLru, itemIt->second.mLruIt );
+		return &itemIt->second;
+	}
+	if( mFailed.count( key ) )
+		return 0;
+
+	map<Key,Request>::iterator requestIt = mRequests.find( key );
+	if( requestIt == mRequests.end() ) {
+		requestIt = mRequests.insert( make_pair( key, Request() ) ).first;
+		requestIt->second.mPath = path;
+		requestIt->second.mQueueIt = mQueue.insert( make_pair( priority, key ) );
+		mJobCond.notify_one();
+	}
+	else if( ( requestIt->second.mQueueIt != mQueue.end() ) && ( requestIt->second.mQueueIt->first != priority ) ) {
+		mQueue.erase( requestIt->second.mQueueIt );
+		requestIt->second.mQueueIt = mQueue.insert( make_pair( priority, key ) );
+	}
+
+	*request = &requestIt->second;
+	return 0;
+}
+
+void AssetManager::threadFn()
+{
+	ThreadSetup threadSetup;
+
+	while( true ) {
+		Key key;
+		fs::path path;
+		{
+			std::unique_lock<std::mutex> lock( mMutex );
+			while( ( ! mQuit ) && mQueue.empty() )
+				mJobCond.wait( lock );
+			if( mQuit )
+				return;
+			key = mQueue.begin()->second;
+			mQueue.erase( mQueue.begin() );
+			Request &request = mRequests[key];
+			request.mQueueIt = mQueue.end();
+			path = request.mPath;
+		}
+
+		Completion completion;
+		completion.mManager = mWeakThis;
+		completion.mKey = key;
+		completion.mFailed = false;
+		try {
+			DataSourceRef dataSource = loadFile( path );
+			if( key.first == TRIMESH ) {
+				completion.mTriMesh = std::shared_ptr<TriMesh>( new TriMesh );
+				ObjLoader( dataSource ).load( completion.mTriMesh.get() );
+			}
+			else
+				completion.mSurface = Surface8u( loadImage( dataSource ) );
+		}
+		catch( ... ) {
+			completion.mSurface.reset();
+			completion.mTriMesh.reset();
+			completion.mFailed = true;
+		}
+
+		if( App::get() )
+			App::get()->dispatchAsync( completion );
+		else
+			complete( completion.mKey, completion.mSurface, completion.mTriMesh, completion.mFailed );
+	}
+}
+
+void AssetManager::complete( const Key &key, Surface8u surface, std::shared_ptr<TriMesh> triMesh, bool failed )
+{
+	Request request;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		map<Key,Request>::iterator requestIt = mRequests.find( key );
+		if( requestIt == mRequests.end() ) // abandoned by clear() while loading
+			return;
+		request = requestIt->second;
+		if( request.mQueueIt != mQueue.end() ) // requested again after clear() while loading
+			mQueue.erase( request.mQueueIt );
+		mRequests.erase( requestIt );
+	}
+
+	// textures are created outside the lock, as uploading may take a while
+	Item item;
+	item.mSize = 0;
+	if( ! failed ) {
+		if( key.first == TEXTURE ) {
+			try {
+				item.mTexture = gl::Texture( surface, request.mFormat );
+				item.mSize = (size_t)surface.getWidth() * surface.getHeight() * 4;
+				if( request.mFormat.hasMipmapping() )
+					item.mSize += item.mSize / 3;
+			}
+			catch( ... ) {
+				failed = true;
+			}
+		}
+		else if( key.first == SURFACE ) {
+			item.mSurface = surface;
+			item.mSize = (size_t)surface.getRowBytes() * surface.getHeight();
+		}
+		else {
+			item.mTriMesh = triMesh;
+			item.mSize = calcTriMeshSize( *triMesh );
+		}
+	}
+
+	vector<Item> evicted;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		if( failed )
+			mFailed.insert( key );
+		else {
+			mLru.push_front( key );
+			item.mLruIt = mLru.begin();
+			mItems[key] = item;
+			mMemoryUsage += item.mSize;
+			evictToBudget( &key, &evicted );
+		}
+	}
+
+	for( vector<SurfaceFn>::const_iterator fnIt = request.mSurfaceFns.begin(); fnIt != request.mSurfaceFns.end(); ++fnIt )
+		(*fnIt)( item.mSurface );
+	for( vector<TextureFn>::const_iterator fnIt = request.mTextureFns.begin(); fnIt != request.mTextureFns.end(); ++fnIt )
+		(*fnIt)( item.mTexture );
+	for( vector<TriMeshFn>::const_iterator fnIt = request.mTriMeshFns.begin(); fnIt != request.mTriMeshFns.end(); ++fnIt )
+		(*fnIt)( item.mTriMesh );
+}
+
+void AssetManager::evictToBudget( const Key *keep, vector<Item> *evicted )
+{
+	while( ( mMemoryUsage > mMemoryBudget ) && ( ! mLru.empty() ) ) {
+		if( keep && ( mLru.back() == *keep ) )
+			break;
+		map<Key,Item>::iterator itemIt = mItems.find( mLru.back() );
+		mMemoryUsage -= itemIt->second.mSize;
+		evicted->push_back( itemIt->second );
+		mItems.erase( itemIt );
+		mLru.pop_back();
+	}
+}
+
+void AssetManager::cancel( const fs::path &path )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	const Kind kinds[] = { SURFACE, TEXTURE, TRIMESH };
+	for( size_t k = 0; k < 3; ++k ) {
+		map<Key,Request>::iterator requestIt = mRequests.find( Key( kinds[k], path.string() ) );
+		if( ( requestIt != mRequests.end() ) && ( requestIt->second.mQueueIt != mQueue.end() ) ) {
+			mQueue.erase( requestIt->second.mQueueIt );
+			mRequests.erase( requestIt );
+		}
+	}
+}
+
+void AssetManager::cancelAll()
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	for( Queue::const_iterator queueIt = mQueue.begin(); queueIt != mQueue.end(); ++queueIt )
+		mRequests.erase( queueIt->second );
+	mQueue.clear();
+}
+
+void AssetManager::evict( const fs::path &path )
+{
+	vector<Item> evicted;
+	std::lock_guard<std::mutex> lock( mMutex );
+	const Kind kinds[] = { SURFACE, TEXTURE, TRIMESH };
+	for( size_t k = 0; k < 3; ++k ) {
+		map<Key,Item>::iterator itemIt = mItems.find( Key( kinds[k], path.string() ) );
+		if( itemIt != mItems.end() ) {
+			mMemoryUsage -= itemIt->second.mSize;
+			mLru.erase( itemIt->second.mLruIt );
+			evicted.push_back( itemIt->second );
+			mItems.erase( itemIt );
+		}
+	}
+}
+
+void AssetManager::clear()
+{
+	map<Key,Item> evicted;
+	std::lock_guard<std::mutex> lock( mMutex );
+	evicted.swap( mItems );
+	mLru.clear();
+	mMemoryUsage = 0;
+	mQueue.clear();
+	mRequests.clear();
+	mFailed.clear();
+}
+
+void AssetManager::setMemoryBudget( size_t memoryBudget )
+{
+	vector<Item> evicted;
+	std::lock_guard<std::mutex> lock( mMutex );
+	mMemoryBudget = memoryBudget;
+	evictToBudget( 0, &evicted );
+}
+
+size_t AssetManager::getMemoryUsage() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mMemoryUsage;
+}
+
+size_t AssetManager::getNumCached() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mItems.size();
+}
+
+size_t AssetManager::getNumPending() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mRequests.size();
+}
+
+} } // namespace cinder::app
@@ -0,0 +1,151 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "cinder/app/AssetReload.h"
+#include "cinder/app/App.h"
+#include "cinder/ImageIo.h"
+
+#include <vector>
+
+namespace cinder { namespace app {
+
+namespace {
+
+fs::path findWatchedAsset( const fs::path &relativePath )
+{
+	fs::path path = getAssetPath( relativePath );
+	if( path.empty() )
+		throw AssetLoadExc( relativePath );
+	return path;
+}
+
+void reportReloadFailure( const fs::path &path, const std::exception &exc )
+{
+	console() << "Failed to reload " << path.string() << ": " << exc.what() << std::endl;
+}
+
+struct TextureReloader {
+	TextureReloader( gl::Texture *texture, const gl::Texture::Format &format ) : mTexture( texture ), mFormat( format ) {}
+
+	void operator()( const fs::path &path ) const
+	{
+		try {
+			*mTexture = gl::Texture( loadImage( path ), mFormat );
+		}
+		catch( std::exception &exc ) {
+			reportReloadFailure( path, exc );
+		}
+	}
+
+	gl::Texture			*mTexture;
+	gl::Texture::Format	mFormat;
+};
+
+struct GlslProgReloader {
+	GlslProgReloader( gl::GlslProg *glslProg, const fs::path &vertexPath, const fs::path &fragmentPath )
+		: mGlslProg( glslProg ), mVertexPath( vertexPath ), mFragmentPath( fragmentPath )
+	{}
+
+	// either stage changing requires relinking both
+	void operator()( const fs::path &path ) const
+	{
+		try {
+			*mGlslProg = gl::GlslProg( loadFile( mVertexPath ), loadFile( mFragmentPath ) );
+		}
+		catch( std::exception &exc ) {
+			reportReloadFailure( path, exc );
+		}
+	}
+
+	gl::GlslProg	*mGlslProg;
+	fs::path		mVertexPath, mFragmentPath;
+};
+
+struct SvgDocReloader {
+	SvgDocReloader( svg::DocRef *doc ) : mDoc( doc ) {}
+
+	void operator()( const fs::path &path ) const
+	{
+		try {
+			*mDoc = svg::Doc::create( path );
+		}
+		catch( std::exception &exc ) {
+			reportReloadFailure( path, exc );
+		}
+	}
+
+	svg::DocRef		*mDoc;
+};
+
+struct JsonTreeReloader {
+	JsonTreeReloader( JsonTree *jsonTree ) : mJsonTree( jsonTree ) {}
+
+	void operator()( const fs::path &path ) const
+	{
+		try {
+			*mJsonTree = JsonTree( loadFile( path ) );
+		}
+		catch( std::exception &exc ) {
+			reportReloadFailure( path, exc );
+		}
+	}
+
+	JsonTree		*mJsonTree;
+};
+
+} // anonymous namespace
+
+CallbackId watchAsset( const fs::path &relativePath, gl::Texture *texture, const gl::Texture::Format &format )
+{
+	fs::path path = findWatchedAsset( relativePath );
+	*texture = gl::Texture( loadImage( path ), format );
+	return FileWatcher::get().watch( path, TextureReloader( texture, format ) );
+}
+
+CallbackId watchAsset( const fs::path &vertexRelativePath, const fs::path &fragmentRelativePath, gl::GlslProg *glslProg )
+{
+	std::vector<fs::path> paths;
+	paths.push_back( findWatchedAsset( vertexRelativePath ) );
+	paths.push_back( findWatchedAsset( fragmentRelativePath ) );
+	*glslProg = gl::GlslProg( loadFile( paths[0] ), loadFile( paths[1] ) );
+	return FileWatcher::get().watch( paths, GlslProgReloader( glslProg, paths[0], paths[1] ) );
+}
+
+CallbackId watchAsset( const fs::path &relativePath, svg::DocRef *doc )
+{
+	fs::path path = findWatchedAsset( relativePath );
+	*doc = svg::Doc::create( path );
+	return FileWatcher::get().watch( path, SvgDocReloader( doc ) );
+}
+
+CallbackId watchAsset( const fs::path &relativePath, JsonTree *jsonTree )
+{
+	fs::path path = findWatchedAsset( relativePath );
+	*jsonTree = JsonTree( loadFile( path ) );
+	return FileWatcher::get().watch( path, JsonTreeReloader( jsonTree ) );
+}
+
+} } // namespace cinder::app
@@ -0,0 +1,201 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/app/AsyncImageLoader.h"
+#include "cinder/app/App.h"
+#include "cinder/ImageIo.h"
+
+namespace cinder { namespace app {
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AsyncSurface
+bool AsyncSurface::isReady() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mReady;
+}
+
+bool AsyncSurface::hasFailed() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mReady && mFailed;
+}
+
+void AsyncSurface::wait() const
+{
+	std::unique_lock<std::mutex> lock( mMutex );
+	while( ! mReady )
+		mReadyCond.wait( lock );
+}
+
+Surface8u AsyncSurface::getSurface() const
+{
+	wait();
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mSurface;
+}
+
+void AsyncSurface::setResult( const Surface8u &surface, bool failed )
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	mSurface = surface;
+	mFailed = failed;
+	mReady = true;
+	mReadyCond.notify_all();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AsyncImageLoader
+AsyncImageLoader::AsyncImageLoader( int32_t numThreads )
+	: mQuit( false )
+{
+	for( int32_t t = 0; t < std::max<int32_t>( 1, numThreads ); ++t )
+		mThreads.push_back( std::shared_ptr<std::thread>( new std::thread( std::bind( &AsyncImageLoader::threadFn, this ) ) ) );
+}
+
+AsyncImageLoader::~AsyncImageLoader()
+{
+	std::deque<Job> abandoned;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mQuit = true;
+		abandoned.swap( mJobs );
+	}
+	mJobCond.notify_all();
+	for( std::vector<std::shared_ptr<std::thread> >::iterator threadIt = mThreads.begin(); threadIt != mThreads.end(); ++threadIt )
+		(*threadIt)->join();
+
+	for( std::deque<Job>::iterator jobIt = abandoned.begin(); jobIt != abandoned.end(); ++jobIt )
+		jobIt->mResult->setResult( Surface8u(), true );
+}
+
+AsyncImageLoaderRef AsyncImageLoader::getDefault()
+{
+	static AsyncImageLoaderRef sDefault;
+	static std::mutex sDefaultMutex;
+
+	std::lock_guard<std::mutex> lock( sDefaultMutex );
+	if( ! sDefault )
+		sDefault = AsyncImageLoader::create();
+	return sDefault;
+}
+
+AsyncSurfaceRef AsyncImageLoader::load( const fs::path &path, const SurfaceFn &readyFn )
+{
+	Job job;
+	job.mPath = path;
+	job.mReadyFn = readyFn;
+	return enqueue( job );
+}
+
+AsyncSurfaceRef AsyncImageLoader::load( DataSourceRef dataSource, const SurfaceFn &readyFn )
+{
+	Job job;
+	job.mDataSource = dataSource;
+	job.mReadyFn = readyFn;
+	return enqueue( job );
+}
+
+size_t AsyncImageLoader::getNumPending() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	return mJobs.size();
+}
+
+AsyncSurfaceRef AsyncImageLoader::enqueue( const Job &job )
+{
+	AsyncSurfaceRef result( new AsyncSurface );
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mJobs.push_back( job );
+		mJobs.back().mResult = result;
+	}
+	mJobCond.notify_one();
+	return result;
+}
+
+void AsyncImageLoader::threadFn()
+{
+	ThreadSetup threadSetup;
+
+	while( true ) {
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock( mMutex );
+			while( ( ! mQuit ) && mJobs.empty() )
+				mJobCond.wait( lock );
+			if( mQuit )
+				return;
+			job = mJobs.front();
+			mJobs.pop_front();
+		}
+
+		try {
+			Surface8u surface( ( job.mDataSource ) ? loadImage( job.mDataSource ) : loadImage( job.mPath ) );
+			complete( job, surface, false );
+		}
+		catch( ... ) {
+			complete( job, Surface8u(), true );
+		}
+	}
+}
+
+void AsyncImageLoader::complete( const Job &job, const Surface8u &surface, bool failed )
+{
+	job.mResult->setResult( surface, failed );
+	if( job.mReadyFn ) {
+		if( App::get() )
+			App::get()->dispatchAsync( std::bind( job.mReadyFn, surface ) );
+		else
+			job.mReadyFn( surface );
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Free functions
+AsyncSurfaceRef loadImageAsync( const fs::path &path, const AsyncImageLoader::SurfaceFn &readyFn )
+{
+	return AsyncImageLoader::getDefault()->load( path, readyFn );
+}
+
+AsyncSurfaceRef loadImageAsync( DataSourceRef dataSource, const AsyncImageLoader::SurfaceFn &readyFn )
+{
+	return AsyncImageLoader::getDefault()->load( dataSource, readyFn );
+}
+
+namespace {
+
+void createTexture( Surface8u surface, std::function<void(gl::Texture)> readyFn, gl::Texture::Format format )
+{
+	readyFn( ( surface ) ? gl::Texture( surface, format ) : gl::Texture() );
+}
+
+} // anonymous namespace
+
+void loadTextureAsync( const fs::path &path, const std::function<void(gl::Texture)> &readyFn, gl::Texture::Format format )
+{
+	AsyncImageLoader::getDefault()->load( path, std::bind( createTexture, std::_1, readyFn, format ) );
+}
+
+} } // namespace cinder::app
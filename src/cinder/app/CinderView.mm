@@ -102,7 +102,12 @@
 	if( ! appSetupCalled )
 		return;
 
-	[self display];
+	// with partial redraw only the areas invalidated since the last frame are drawn, and if there are none the frame is skipped
+	cinder::app::Renderer2d *renderer2d = dynamic_cast<cinder::app::Renderer2d*>( app->getRenderer() );
+	if( renderer2d && renderer2d->isPartialRedrawEnabled() )
+		[self displayIfNeeded];
+	else
+		[self display];
 }
 
 - (void)drawRect:(NSRect)rect
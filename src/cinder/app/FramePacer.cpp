@@ -0,0 +1,166 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/app/FramePacer.h"
+#include "cinder/gl/Fence.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined( CINDER_MSW )
+	#include <windows.h>
+	#include <mmsystem.h>
+	#pragma comment( lib, "winmm.lib" )
+#else
+	#include <time.h>
+#endif
+
+namespace cinder { namespace app {
+
+FramePacer::FramePacer( const Timer &timer )
+	: mTimer( &timer ), mSpinDuration( 0.002 ), mGpuWait( false ), mNumSamples( 120 ), mFrameStart( -1 ), mDrawStart( 0 ),
+	mLastUpdateDuration( 0 ), mLastDrawDuration( 0 ), mLastGpuWaitDuration( 0 )
+{
+}
+
+void FramePacer::waitUntil( double seconds ) const
+{
+	double remaining = seconds - mTimer->getSeconds();
+	if( remaining > mSpinDuration )
+		sleep( remaining - mSpinDuration );
+	spinUntil( seconds );
+}
+
+void FramePacer::spinUntil( double seconds ) const
+{
+	while( mTimer->getSeconds() < seconds )
+		;
+}
+
+void FramePacer::sleep( double seconds )
+{
+	if( seconds <= 0 )
+		return;
+
+#if defined( CINDER_MSW )
+	// the default scheduler granularity of 15.6ms makes waitable timers useless for frame pacing
+	static bool periodSet = false;
+	static HANDLE timer = ::CreateWaitableTimer( NULL, TRUE, NULL );
+	if( ! periodSet ) {
+		::timeBeginPeriod( 1 );
+		periodSet = true;
+	}
+
+	// relative due times are negative, in units of 100 nanoseconds
+	LARGE_INTEGER dueTime;
+	dueTime.QuadPart = -(LONGLONG)( seconds * 10000000 );
+	if( ::SetWaitableTimer( timer, &dueTime, 0, NULL, NULL, FALSE ) )
+		::WaitForSingleObject( timer, INFINITE );
+#else
+	timespec duration;
+	duration.tv_sec = (time_t)seconds;
+	duration.tv_nsec = (long)( ( seconds - duration.tv_sec ) * 1e9 );
+	::nanosleep( &duration, 0 );
+#endif
+}
+
+void FramePacer::setNumSamples( size_t numFrames )
+{
+	mNumSamples = std::max<size_t>( 1, numFrames );
+	while( mFrameDurations.size() > mNumSamples )
+		mFrameDurations.pop_front();
+}
+
+double FramePacer::getLastFrameDuration() const
+{
+	return ( mFrameDurations.empty() ) ? 0 : mFrameDurations.back();
+}
+
+double FramePacer::getAverageFrameDuration() const
+{
+	if( mFrameDurations.empty() )
+		return 0;
+
+	double sum = 0;
+	for( std::deque<double>::const_iterator durIt = mFrameDurations.begin(); durIt != mFrameDurations.end(); ++durIt )
+		sum += *durIt;
+	return sum / mFrameDurations.size();
+}
+
+double FramePacer::getMinFrameDuration() const
+{
+	return ( mFrameDurations.empty() ) ? 0 : *std::min_element( mFrameDurations.begin(), mFrameDurations.end() );
+}
+
+double FramePacer::getMaxFrameDuration() const
+{
+	return ( mFrameDurations.empty() ) ? 0 : *std::max_element( mFrameDurations.begin(), mFrameDurations.end() );
+}
+
+double FramePacer::getFrameDurationDeviation() const
+{
+	if( mFrameDurations.size() < 2 )
+		return 0;
+
+	double mean = getAverageFrameDuration(), sumSquares = 0;
+	for( std::deque<double>::const_iterator durIt = mFrameDurations.begin(); durIt != mFrameDurations.end(); ++durIt )
+		sumSquares += ( *durIt - mean ) * ( *durIt - mean );
+	return std::sqrt( sumSquares / mFrameDurations.size() );
+}
+
+void FramePacer::beginFrame()
+{
+	double now = mTimer->getSeconds();
+	if( mFrameStart >= 0 ) {
+		mFrameDurations.push_back( now - mFrameStart );
+		if( mFrameDurations.size() > mNumSamples )
+			mFrameDurations.pop_front();
+	}
+	mFrameStart = now;
+
+	// waiting here, before update() samples input, keeps the CPU at most one frame ahead of the GPU
+	mLastGpuWaitDuration = 0;
+	if( mFence ) {
+		if( mGpuWait ) {
+			mFence->wait();
+			mLastGpuWaitDuration = mTimer->getSeconds() - now;
+		}
+		mFence.reset();
+	}
+}
+
+void FramePacer::beginDraw()
+{
+	mDrawStart = mTimer->getSeconds();
+}
+
+void FramePacer::endDraw()
+{
+	mLastDrawDuration = mTimer->getSeconds() - mDrawStart;
+	if( mGpuWait && gl::Fence::isSupported() )
+		mFence = gl::Fence::create();
+}
+
+} } // namespace cinder::app
@@ -42,6 +42,7 @@
 	#include "cinder/app/AppImplMswRendererGdi.h"
 #endif
 #include "cinder/ip/Flip.h"
+#include "cinder/gl/StateCache.h"
 
 
 namespace cinder { namespace app {
@@ -51,20 +52,211 @@ const int RendererGl::sAntiAliasingSamples[] = { 0, 2, 4, 6, 8, 16, 32 };
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // RendererGl
 RendererGl::RendererGl()
-	: Renderer(), mImpl( 0 )
+	: Renderer(), mImpl( 0 ), mSharedRenderer( 0 )
 {
 	mAntiAliasing = AA_MSAA_16;
+	initDynamicResolution();
 }
 
 RendererGl::RendererGl( int aAntiAliasing )
-	: Renderer(), mImpl( 0 ), mAntiAliasing( aAntiAliasing )
-{}
+	: Renderer(), mImpl( 0 ), mAntiAliasing( aAntiAliasing ), mSharedRenderer( 0 )
+{
+	initDynamicResolution();
+}
 
 void RendererGl::setAntiAliasing( int aAntiAliasing )
 {
 	mAntiAliasing = aAntiAliasing;
 }
 
+int RendererGl::getFboSamples() const
+{
+#if defined( CINDER_MAC )
+	return mAntiAliasing; // on the Mac this has been replaced by the pixel format's sample count
+#else
+	return sAntiAliasingSamples[mAntiAliasing];
+#endif
+}
+
+namespace {
+// an upscale is tried after this many frames which fit the target, doubling each time one overshoots right away
+const int	BASE_UPSCALE_DELAY = 60;
+const int	MAX_UPSCALE_DELAY = BASE_UPSCALE_DELAY * 16;
+const float	UPSCALE_STEP = 0.05f;
+} // anonymous namespace
+
+void RendererGl::initDynamicResolution()
+{
+	mTargetFrameTime = 0;
+	mMinResolutionScale = 0.5f;
+	mMaxResolutionScale = 1.0f;
+	mResolutionHysteresis = 0.1f;
+	mResolutionScale = 1.0f;
+	mSmoothedFrameTime = 0;
+	mDrawStartTime = 0;
+	mFramesWithinTarget = mFramesSinceScaleChange = 0;
+	mUpscaleDelay = BASE_UPSCALE_DELAY;
+	mLastScaleChangeWasUp = false;
+	mDynamicResolutionDrawing = false;
+	mScreenFramebuffer = 0;
+}
+
+void RendererGl::setDynamicResolution( double targetFrameTime, float minScale, float maxScale )
+{
+	mTargetFrameTime = std::max( 0.0, targetFrameTime );
+	mMaxResolutionScale = std::max( 0.01f, maxScale );
+	mMinResolutionScale = math<float>::clamp( minScale, 0.01f, mMaxResolutionScale );
+	mResolutionScale = mMaxResolutionScale;
+	mSmoothedFrameTime = 0;
+	mFramesWithinTarget = mFramesSinceScaleChange = 0;
+	mUpscaleDelay = BASE_UPSCALE_DELAY;
+	if( mTargetFrameTime <= 0 )
+		mDynamicResolutionFbo.reset();
+}
+
+Vec2i RendererGl::getDrawSize() const
+{
+	if( mDynamicResolutionDrawing )
+		return mDrawSize;
+	else
+		return Vec2i( mApp->getWindowWidth(), mApp->getWindowHeight() );
+}
+
+bool RendererGl::isDynamicResolutionSupported()
+{
+#if defined( CINDER_GLES )
+	return true;
+#else
+	static bool supported = gl::isExtensionAvailable( "GL_EXT_framebuffer_blit" );
+	return supported;
+#endif
+}
+
+void RendererGl::startDynamicResolutionDraw()
+{
+	mDrawStartTime = mApp->getFramePacer().getSeconds();
+
+#if defined( CINDER_COCOA_TOUCH )
+	// makeCurrentContext binds the layer's framebuffer and sets the viewport to its size, which exceeds the window's on Retina displays
+	GLint viewport[4];
+	glGetIntegerv( GL_VIEWPORT, viewport );
+	mScreenSize = Vec2i( viewport[2], viewport[3] );
+	glGetIntegerv( GL_FRAMEBUFFER_BINDING_OES, &mScreenFramebuffer );
+#else
+	mScreenSize = Vec2i( mApp->getWindowWidth(), mApp->getWindowHeight() );
+	mScreenFramebuffer = 0;
+#endif
+
+	// the Fbo is allocated at the largest scale, and smaller scales draw into its lower-left corner, so changing the scale never reallocates it
+	Vec2i fboSize( std::max( 1, (int)( mScreenSize.x * mMaxResolutionScale + 0.5f ) ), std::max( 1, (int)( mScreenSize.y * mMaxResolutionScale + 0.5f ) ) );
+	if( ( ! mDynamicResolutionFbo ) || ( mDynamicResolutionFbo.getSize() != fboSize ) ) {
+		gl::Fbo::Format format;
+		format.setSamples( getFboSamples() );
+		format.enableDepthBuffer( true, false );
+		mDynamicResolutionFbo = gl::Fbo( fboSize.x, fboSize.y, format );
+	}
+
+	mDrawSize.x = math<int>::clamp( (int)( mScreenSize.x * mResolutionScale + 0.5f ), 1, fboSize.x );
+	mDrawSize.y = math<int>::clamp( (int)( mScreenSize.y * mResolutionScale + 0.5f ), 1, fboSize.y );
+	mDynamicResolutionFbo.bindFramebuffer();
+	glViewport( 0, 0, mDrawSize.x, mDrawSize.y );
+	mDynamicResolutionDrawing = true;
+}
+
+void RendererGl::finishDynamicResolutionDraw()
+{
+	// the depth buffer isn't needed once the frame is drawn, which spares tile-based GPUs from writing it back
+	mDynamicResolutionFbo.invalidate( GL_DEPTH_BUFFER_BIT );
+
+#if defined( CINDER_GLES )
+	gl::StateCache::bindFramebuffer( GL_FRAMEBUFFER_OES, mScreenFramebuffer );
+	glViewport( 0, 0, mScreenSize.x, mScreenSize.y );
+	{
+		gl::BoolState depthTestState( GL_DEPTH_TEST ), blendState( GL_BLEND ), lightingState( GL_LIGHTING );
+		gl::SaveColorState colorState;
+		glDisable( GL_DEPTH_TEST );
+		glDisable( GL_BLEND );
+		glDisable( GL_LIGHTING );
+		gl::color( 1, 1, 1, 1 );
+		gl::pushMatrices();
+		// the Fbo's texture has its origin at the lower-left
+		gl::setMatricesWindow( mScreenSize, false );
+		gl::draw( mDynamicResolutionFbo.getTexture(), Area( 0, 0, mDrawSize.x, mDrawSize.y ), Rectf( 0, 0, (float)mScreenSize.x, (float)mScreenSize.y ) );
+		gl::popMatrices();
+	}
+#else
+	mDynamicResolutionFbo.resolveTextures();
+	gl::StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, mDynamicResolutionFbo.getResolveId() );
+	gl::StateCache::bindFramebuffer( GL_DRAW_FRAMEBUFFER_EXT, mScreenFramebuffer );
+	glBlitFramebufferEXT( 0, 0, mDrawSize.x, mDrawSize.y, 0, 0, mScreenSize.x, mScreenSize.y, GL_COLOR_BUFFER_BIT, GL_LINEAR );
+	gl::StateCache::bindFramebuffer( GL_FRAMEBUFFER_EXT, mScreenFramebuffer );
+	glViewport( 0, 0, mScreenSize.x, mScreenSize.y );
+#endif
+}
+
+// Called after the buffer swap with the time the frame took from startDraw(), which excludes time the app spent idle or waiting for the next frame
+void RendererGl::updateResolutionScale( double frameTime )
+{
+	mSmoothedFrameTime = ( mSmoothedFrameTime > 0 ) ? ( mSmoothedFrameTime * 0.8 + frameTime * 0.2 ) : frameTime;
+	++mFramesSinceScaleChange;
+
+	const double limit = mTargetFrameTime * ( 1 + mResolutionHysteresis );
+	if( mSmoothedFrameTime > limit ) {
+		// fill cost follows the pixel count, which is the square of the scale
+		float scale = std::max( mMinResolutionScale, mResolutionScale * (float)math<double>::sqrt( mTargetFrameTime / mSmoothedFrameTime ) );
+		if( scale < mResolutionScale ) {
+			if( mLastScaleChangeWasUp && ( mFramesSinceScaleChange < mUpscaleDelay ) )
+				mUpscaleDelay = std::min( mUpscaleDelay * 2, MAX_UPSCALE_DELAY );
+			mResolutionScale = scale;
+			mLastScaleChangeWasUp = false;
+			mFramesSinceScaleChange = 0;
+			// the frames measured so far were drawn at the previous scale
+			mSmoothedFrameTime = mTargetFrameTime;
+		}
+		mFramesWithinTarget = 0;
+	}
+	else if( frameTime <= limit ) {
+		if( ( ++mFramesWithinTarget >= mUpscaleDelay ) && ( mResolutionScale < mMaxResolutionScale ) ) {
+			// an upscale which held relaxes the delay before the next one
+			if( mLastScaleChangeWasUp && ( mFramesSinceScaleChange >= mUpscaleDelay ) )
+				mUpscaleDelay = std::max( mUpscaleDelay / 2, BASE_UPSCALE_DELAY );
+			mResolutionScale = std::min( mMaxResolutionScale, mResolutionScale + UPSCALE_STEP );
+			mLastScaleChangeWasUp = true;
+			mFramesSinceScaleChange = 0;
+			mFramesWithinTarget = 0;
+		}
+	}
+	else
+		mFramesWithinTarget = 0;
+}
+
+#if ! defined( CINDER_COCOA_TOUCH )
+bool RendererGl::isHeadless() const
+{
+	return mApp && mApp->getSettings().isHeadless();
+}
+
+void RendererGl::startHeadlessDraw()
+{
+	Vec2i size( mApp->getWindowWidth(), mApp->getWindowHeight() );
+	if( ( ! mHeadlessFbo ) || ( mHeadlessFbo.getSize() != size ) ) {
+		gl::Fbo::Format format;
+		format.setSamples( getFboSamples() );
+		mHeadlessFbo = gl::Fbo( size.x, size.y, format );
+	}
+	mHeadlessFbo.bindFramebuffer();
+}
+
+Surface RendererGl::copyHeadlessSurface( const Area &area )
+{
+	// the resolved texture's origin is at the lower-left
+	ImageSourceRef imageSource = mHeadlessFbo.getTexture();
+	Surface s( imageSource, SurfaceConstraintsDefault(), false );
+	ip::flipVertical( &s );
+	return s.clone( area );
+}
+#endif
+
 #if defined( CINDER_MAC )
 RendererGl::~RendererGl()
 {
@@ -75,7 +267,8 @@ void RendererGl::setup( App *aApp, CGRect frame, NSView *cinderView )
 {
 	mApp = aApp;
 
-	mImpl = [[AppImplCocoaRendererGl alloc] initWithFrame:NSRectFromCGRect(frame) cinderView:cinderView app:mApp renderer:this];
+	mImpl = [[AppImplCocoaRendererGl alloc] initWithFrame:NSRectFromCGRect(frame) cinderView:cinderView app:mApp renderer:this
+				sharedRenderer:( mSharedRenderer ) ? mSharedRenderer->mImpl : nil];
 	// This is necessary for Objective-C garbage collection to do the right thing
 	::CFRetain( mImpl );
 }
@@ -83,11 +276,24 @@ void RendererGl::setup( App *aApp, CGRect frame, NSView *cinderView )
 void RendererGl::startDraw()
 {
 	[mImpl makeCurrentContext];
+	mDynamicResolutionDrawing = false;
+	if( isHeadless() )
+		startHeadlessDraw();
+	else if( ( mTargetFrameTime > 0 ) && isDynamicResolutionSupported() )
+		startDynamicResolutionDraw();
 }
 
 void RendererGl::finishDraw()
 {
-	[mImpl flushBuffer];
+	if( isHeadless() )
+		gl::Fbo::unbindFramebuffer(); // nothing to present, and no vsync to wait for
+	else if( mDynamicResolutionDrawing ) {
+		finishDynamicResolutionDraw();
+		[mImpl flushBuffer];
+		updateResolutionScale( mApp->getFramePacer().getSeconds() - mDrawStartTime );
+	}
+	else
+		[mImpl flushBuffer];
 }
 
 void RendererGl::setFrameSize( int width, int height )
@@ -102,6 +308,9 @@ void RendererGl::defaultResize()
 
 Surface RendererGl::copyWindowSurface( const Area &area )
 {
+	if( isHeadless() )
+		return copyHeadlessSurface( area );
+
 	Surface s( area.getWidth(), area.getHeight(), false );
 	glFlush(); // there is some disagreement about whether this is necessary, but ideally performance-conscious users will use FBOs anyway
 	GLint oldPackAlignment;
@@ -143,11 +352,20 @@ void RendererGl::setup( App *aApp, const Area &frame, UIView *cinderView )
 void RendererGl::startDraw()
 {
 	[mImpl makeCurrentContext];
+	mDynamicResolutionDrawing = false;
+	if( mTargetFrameTime > 0 )
+		startDynamicResolutionDraw();
 }
 
 void RendererGl::finishDraw()
 {
-	[mImpl flushBuffer];
+	if( mDynamicResolutionDrawing ) {
+		finishDynamicResolutionDraw();
+		[mImpl flushBuffer];
+		updateResolutionScale( mApp->getFramePacer().getSeconds() - mDrawStartTime );
+	}
+	else
+		[mImpl flushBuffer];
 }
 
 void RendererGl::setFrameSize( int width, int height )
@@ -190,7 +408,7 @@ void RendererGl::setup( App *aApp, HWND wnd, HDC dc )
 	mWnd = wnd;
 	mApp = aApp;
 	if( ! mImpl )
-		mImpl = new AppImplMswRendererGl( mApp, this );
+		mImpl = new AppImplMswRendererGl( mApp, this, ( mSharedRenderer ) ? mSharedRenderer->mImpl : 0 );
 	mImpl->initialize( wnd, dc );
 }
 
@@ -209,14 +427,32 @@ void RendererGl::finishToggleFullScreen()
 	mImpl->finishToggleFullScreen();
 }
 
+void RendererGl::makeCurrentContext()
+{
+	mImpl->makeCurrentContext();
+}
+
 void RendererGl::startDraw()
 {
 	mImpl->makeCurrentContext();
+	mDynamicResolutionDrawing = false;
+	if( isHeadless() )
+		startHeadlessDraw();
+	else if( ( mTargetFrameTime > 0 ) && isDynamicResolutionSupported() )
+		startDynamicResolutionDraw();
 }
 
 void RendererGl::finishDraw()
 {
-	mImpl->swapBuffers();
+	if( isHeadless() )
+		gl::Fbo::unbindFramebuffer(); // nothing to present, and no vsync to wait for
+	else if( mDynamicResolutionDrawing ) {
+		finishDynamicResolutionDraw();
+		mImpl->swapBuffers();
+		updateResolutionScale( mApp->getFramePacer().getSeconds() - mDrawStartTime );
+	}
+	else
+		mImpl->swapBuffers();
 }
 
 void RendererGl::defaultResize()
@@ -226,6 +462,9 @@ void RendererGl::defaultResize()
 
 Surface	RendererGl::copyWindowSurface( const Area &area )
 {
+	if( isHeadless() )
+		return copyHeadlessSurface( area );
+
 	Surface s( area.getWidth(), area.getHeight(), false );
 	glFlush(); // there is some disagreement about whether this is necessary, but ideally performance-conscious users will use FBOs anyway
 	GLint oldPackAlignment;
@@ -243,6 +482,11 @@ Surface	RendererGl::copyWindowSurface( const Area &area )
 // Renderer2d
 #if defined( CINDER_COCOA )
 
+Renderer2d::Renderer2d()
+	: Renderer(), mImpl( 0 ), mPartialRedraw( false )
+{
+}
+
 #if defined( CINDER_MAC )
 Renderer2d::~Renderer2d()
 {
@@ -272,9 +516,34 @@ CGContextRef Renderer2d::getCgContext()
 	return [mImpl getCGContextRef];
 }
 
+void Renderer2d::enablePartialRedraw( bool enable )
+{
+#if defined( CINDER_MAC )
+	mPartialRedraw = enable;
+#endif
+}
+
+void Renderer2d::invalidate( const Area &area )
+{
+	if( ( area.getWidth() <= 0 ) || ( area.getHeight() <= 0 ) )
+		return;
+#if defined( CINDER_MAC )
+	if( mPartialRedraw )
+		[mImpl invalidateArea:area];
+#endif
+	mApp->requestRedraw();
+}
+
 void Renderer2d::startDraw()
 {
 	[mImpl makeCurrentContext];
+	mDrawAreas.clear();
+#if defined( CINDER_MAC )
+	if( mPartialRedraw )
+		[mImpl getAreasBeingDrawn:&mDrawAreas];
+#endif
+	if( mDrawAreas.empty() )
+		mDrawAreas.push_back( Area( 0, 0, mApp->getWindowWidth(), mApp->getWindowHeight() ) );
 }
 
 void Renderer2d::finishDraw()
@@ -320,7 +589,7 @@ Surface Renderer2d::copyWindowSurface( const Area &area )
 #if defined( CINDER_MSW )
 
 Renderer2d::Renderer2d( bool doubleBuffer )
-	: mDoubleBuffer( doubleBuffer )
+	: mImpl( 0 ), mDoubleBuffer( doubleBuffer ), mPartialRedraw( false )
 {
 }
 
@@ -329,9 +598,29 @@ void Renderer2d::setup( App *app, HWND wnd, HDC dc )
 	mApp = app;
 	mWnd = wnd;
 	mImpl = new AppImplMswRendererGdi( app, mDoubleBuffer );
+	mImpl->enablePartialRedraw( mPartialRedraw );
 	mImpl->initialize( wnd, dc );
 }
 
+void Renderer2d::enablePartialRedraw( bool enable )
+{
+	mPartialRedraw = enable;
+	if( mImpl )
+		mImpl->enablePartialRedraw( enable );
+}
+
+void Renderer2d::invalidate( const Area &area )
+{
+	if( ( area.getWidth() <= 0 ) || ( area.getHeight() <= 0 ) )
+		return;
+	if( mPartialRedraw ) {
+		// accumulated by the window's update region until the next WM_PAINT
+		::RECT rect = { area.x1, area.y1, area.x2, area.y2 };
+		::InvalidateRect( mWnd, &rect, FALSE );
+	}
+	mApp->requestRedraw();
+}
+
 void Renderer2d::kill()
 {
 	mImpl->kill();
@@ -355,6 +644,9 @@ void Renderer2d::finishToggleFullScreen()
 void Renderer2d::startDraw()
 {
 	mImpl->makeCurrentContext();
+	mDrawAreas = mImpl->getUpdateAreas();
+	if( mDrawAreas.empty() )
+		mDrawAreas.push_back( Area( 0, 0, mApp->getWindowWidth(), mApp->getWindowHeight() ) );
 }
 
 void Renderer2d::finishDraw()
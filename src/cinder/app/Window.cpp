@@ -0,0 +1,209 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/app/Window.h"
+#include "cinder/app/App.h"
+
+#if defined( CINDER_MAC )
+	#import <Cocoa/Cocoa.h>
+#elif defined( CINDER_MSW )
+	#include "cinder/Utilities.h"
+	#include <windows.h>
+	#undef min
+	#undef max
+#endif
+
+namespace cinder { namespace app {
+
+#if defined( CINDER_MAC )
+struct Window::Impl {
+	Impl() : mWin( nil ), mContentView( nil ) {}
+
+	NSWindow	*mWin;
+	NSView		*mContentView;
+};
+
+Window::Window( App *app, const Format &format, RendererGl *sharedRenderer )
+	: mImpl( new Impl ), mClosed( false ), mNeedsResize( true )
+{
+	mDisplay = ( format.getDisplay() ) ? format.getDisplay() : Display::getMainDisplay().get();
+	Area displayArea = mDisplay->getArea();
+	mSize = ( format.isFullScreen() ) ? displayArea.getSize() : format.getSize();
+	Vec2i pos = ( format.isFullScreen() ) ? displayArea.getUL() : ( format.isPosSpecified() ? format.getPos() : displayArea.getUL() + ( displayArea.getSize() - mSize ) / 2 );
+
+	mRenderer = std::shared_ptr<RendererGl>( new RendererGl( ( sharedRenderer ) ? sharedRenderer->getAntiAliasing() : RendererGl::AA_NONE ) );
+	mRenderer->setSharedRenderer( sharedRenderer );
+
+	// Cocoa's screen coordinates have their origin at the lower-left of the main display
+	NSRect contentRect = NSMakeRect( pos.x, Display::getMainDisplay()->getHeight() - pos.y - mSize.y, mSize.x, mSize.y );
+	unsigned int styleMask = ( format.isFullScreen() || format.isBorderless() ) ? NSBorderlessWindowMask
+			: ( NSTitledWindowMask | NSMiniaturizableWindowMask | NSResizableWindowMask );
+
+	mImpl->mWin = [[NSWindow alloc] initWithContentRect:contentRect styleMask:styleMask backing:NSBackingStoreBuffered defer:NO];
+	if( ! mImpl->mWin )
+		throw WindowExc();
+	[mImpl->mWin setReleasedWhenClosed:NO];
+	[mImpl->mWin setTitle:[NSString stringWithUTF8String:format.getTitle().c_str()]];
+	if( format.isFullScreen() )
+		[mImpl->mWin setLevel:NSMainMenuWindowLevel + 1];
+
+	mImpl->mContentView = [[NSView alloc] initWithFrame:NSMakeRect( 0, 0, mSize.x, mSize.y )];
+	[mImpl->mWin setContentView:mImpl->mContentView];
+
+	mRenderer->setup( app, NSRectToCGRect( [mImpl->mContentView bounds] ), mImpl->mContentView );
+	[mImpl->mWin orderFront:nil];
+}
+
+Window::~Window()
+{
+	[mImpl->mWin close];
+	[mImpl->mContentView release];
+	[mImpl->mWin release];
+}
+
+void Window::privateUpdateSize__()
+{
+	NSRect bounds = [mImpl->mContentView bounds];
+	Vec2i size( static_cast<int>( bounds.size.width ), static_cast<int>( bounds.size.height ) );
+	if( ( ! mNeedsResize ) && ( size == mSize ) )
+		return;
+
+	mSize = size;
+	mNeedsResize = false;
+	mRenderer->setFrameSize( mSize.x, mSize.y );
+	mRenderer->defaultResize();
+}
+
+#elif defined( CINDER_MSW )
+static const wchar_t *ADDITIONAL_WIN_CLASS_NAME = TEXT("CinderAdditionalWinClass");
+
+static LRESULT CALLBACK additionalWindowWndProc( HWND wnd, UINT uMsg, WPARAM wParam, LPARAM lParam )
+{
+	// the Window* is hidden in the window long when it's created
+	if( uMsg == WM_NCCREATE )
+		::SetWindowLongPtr( wnd, GWLP_USERDATA, (LONG_PTR)((LPCREATESTRUCT)lParam)->lpCreateParams );
+	Window *window = reinterpret_cast<Window*>( ::GetWindowLongPtr( wnd, GWLP_USERDATA ) );
+
+	if( window && ( uMsg == WM_CLOSE ) ) {
+		// the Window is destroyed by AppBasic at the start of the next frame
+		window->close();
+		return 0;
+	}
+
+	return ::DefWindowProc( wnd, uMsg, wParam, lParam );
+}
+
+struct Window::Impl {
+	Impl() : mWnd( 0 ), mDC( 0 ) {}
+
+	HWND	mWnd;
+	HDC		mDC;
+};
+
+Window::Window( App *app, const Format &format, RendererGl *sharedRenderer )
+	: mImpl( new Impl ), mClosed( false ), mNeedsResize( true )
+{
+	mDisplay = ( format.getDisplay() ) ? format.getDisplay() : Display::getMainDisplay().get();
+	Area displayArea = mDisplay->getArea();
+	mSize = ( format.isFullScreen() ) ? displayArea.getSize() : format.getSize();
+	Vec2i pos = ( format.isFullScreen() ) ? displayArea.getUL() : ( format.isPosSpecified() ? format.getPos() : displayArea.getUL() + ( displayArea.getSize() - mSize ) / 2 );
+
+	mRenderer = std::shared_ptr<RendererGl>( new RendererGl( ( sharedRenderer ) ? sharedRenderer->getAntiAliasing() : RendererGl::AA_NONE ) );
+	mRenderer->setSharedRenderer( sharedRenderer );
+
+	HINSTANCE instance = ::GetModuleHandle( NULL );
+	WNDCLASS wc;
+	if( ! ::GetClassInfo( instance, ADDITIONAL_WIN_CLASS_NAME, &wc ) ) {
+		wc.style			= CS_HREDRAW | CS_VREDRAW | CS_OWNDC;
+		wc.lpfnWndProc		= additionalWindowWndProc;
+		wc.cbClsExtra		= 0;
+		wc.cbWndExtra		= 0;
+		wc.hInstance		= instance;
+		wc.hIcon			= ::LoadIcon( NULL, IDI_WINLOGO );
+		wc.hCursor			= ::LoadCursor( NULL, IDC_ARROW );
+		wc.hbrBackground	= NULL;
+		wc.lpszMenuName		= NULL;
+		wc.lpszClassName	= ADDITIONAL_WIN_CLASS_NAME;
+		if( ! ::RegisterClass( &wc ) )
+			throw WindowExc();
+	}
+
+	DWORD windowExStyle, windowStyle;
+	if( format.isFullScreen() || format.isBorderless() ) {
+		windowExStyle = WS_EX_APPWINDOW;
+		windowStyle = WS_POPUP;
+	}
+	else {
+		windowExStyle = WS_EX_APPWINDOW | WS_EX_WINDOWEDGE;
+		windowStyle = WS_OVERLAPPEDWINDOW;
+	}
+
+	RECT windowRect;
+	windowRect.left = pos.x;
+	windowRect.right = pos.x + mSize.x;
+	windowRect.top = pos.y;
+	windowRect.bottom = pos.y + mSize.y;
+	::AdjustWindowRectEx( &windowRect, windowStyle, FALSE, windowExStyle );
+
+	std::wstring unicodeTitle = toUtf16( format.getTitle() );
+	mImpl->mWnd = ::CreateWindowEx( windowExStyle, ADDITIONAL_WIN_CLASS_NAME, unicodeTitle.c_str(), windowStyle,
+		windowRect.left, windowRect.top, windowRect.right - windowRect.left, windowRect.bottom - windowRect.top,
+		NULL, NULL, instance, reinterpret_cast<LPVOID>( this ) );
+	if( ! mImpl->mWnd )
+		throw WindowExc();
+
+	mImpl->mDC = ::GetDC( mImpl->mWnd );
+	if( ! mImpl->mDC ) {
+		::DestroyWindow( mImpl->mWnd );
+		throw WindowExc();
+	}
+
+	mRenderer->setup( app, mImpl->mWnd, mImpl->mDC );
+	::ShowWindow( mImpl->mWnd, SW_SHOWNOACTIVATE );
+}
+
+Window::~Window()
+{
+	mRenderer->kill();
+	::ReleaseDC( mImpl->mWnd, mImpl->mDC );
+	::DestroyWindow( mImpl->mWnd );
+}
+
+void Window::privateUpdateSize__()
+{
+	RECT clientRect;
+	::GetClientRect( mImpl->mWnd, &clientRect );
+	Vec2i size( clientRect.right - clientRect.left, clientRect.bottom - clientRect.top );
+	if( ( ! mNeedsResize ) && ( size == mSize ) )
+		return;
+
+	mSize = size;
+	mNeedsResize = false;
+	mRenderer->defaultResize();
+}
+
+#endif
+
+} } // namespace cinder::app
@@ -0,0 +1,366 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio/Analysis.h"
+#include "cinder/ip/Simd.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#endif
+
+namespace cinder { namespace audio {
+
+namespace {
+
+#if defined( CINDER_IP_SSE2 )
+inline float horizontalSum( __m128 v )
+{
+	v = _mm_add_ps( v, _mm_movehl_ps( v, v ) );
+	v = _mm_add_ss( v, _mm_shuffle_ps( v, v, 1 ) );
+	return _mm_cvtss_f32( v );
+}
+
+inline float horizontalMax( __m128 v )
+{
+	v = _mm_max_ps( v, _mm_movehl_ps( v, v ) );
+	v = _mm_max_ss( v, _mm_shuffle_ps( v, v, 1 ) );
+	return _mm_cvtss_f32( v );
+}
+#endif
+
+const float* channelSamples( const PcmBuffer32f &buffer, ChannelIdentifier channelId, size_t *count )
+{
+	if( buffer.isInterleaved() || ( channelId >= buffer.getChannelCount() ) ) {
+		throw InvalidChannelPcmBufferException();
+	}
+	*count = buffer.getSampleCount( channelId );
+	return buffer.getChannelData( channelId )->mData;
+}
+
+// magnitudes are compressed before the flux is taken, so that quiet passages aren't drowned out by loud ones
+const float LOG_COMPRESSION = 100.0f;
+// the intervals between onsets that are taken for beats, between 240 and 40 bpm
+const double MIN_BEAT_INTERVAL = 0.25, MAX_BEAT_INTERVAL = 1.5;
+
+} // anonymous namespace
+
+float calculateRms( const float *samples, size_t count )
+{
+	if( count == 0 ) return 0;
+
+	size_t i = 0;
+	float sum = 0;
+#if defined( CINDER_IP_SSE2 )
+	if( ip::useSse2() ) {
+		__m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+		for( ; i + 8 <= count; i += 8 ) {
+			__m128 a = _mm_loadu_ps( samples + i );
+			__m128 b = _mm_loadu_ps( samples + i + 4 );
+			acc0 = _mm_add_ps( acc0, _mm_mul_ps( a, a ) );
+			acc1 = _mm_add_ps( acc1, _mm_mul_ps( b, b ) );
+		}
+		sum = horizontalSum( _mm_add_ps( acc0, acc1 ) );
+	}
+#endif
+	for( ; i < count; ++i )
+		sum += samples[i] * samples[i];
+	return std::sqrt( sum / count );
+}
+
+float calculatePeak( const float *samples, size_t count )
+{
+	size_t i = 0;
+	float peak = 0;
+#if defined( CINDER_IP_SSE2 )
+	if( ip::useSse2() ) {
+		// clearing the sign bit gives the absolute value
+		const __m128 absMask = _mm_castsi128_ps( _mm_set1_epi32( 0x7FFFFFFF ) );
+		__m128 max0 = _mm_setzero_ps(), max1 = _mm_setzero_ps();
+		for( ; i + 8 <= count; i += 8 ) {
+			max0 = _mm_max_ps( max0, _mm_and_ps( _mm_loadu_ps( samples + i ), absMask ) );
+			max1 = _mm_max_ps( max1, _mm_and_ps( _mm_loadu_ps( samples + i + 4 ), absMask ) );
+		}
+		peak = horizontalMax( _mm_max_ps( max0, max1 ) );
+	}
+#endif
+	for( ; i < count; ++i )
+		peak = std::max( peak, std::fabs( samples[i] ) );
+	return peak;
+}
+
+float calculateSpectralFlux( const float *current, const float *previous, size_t bandCount )
+{
+	size_t i = 0;
+	float flux = 0;
+#if defined( CINDER_IP_SSE2 )
+	if( ip::useSse2() ) {
+		const __m128 zero = _mm_setzero_ps();
+		__m128 acc = zero;
+		for( ; i + 4 <= bandCount; i += 4 ) {
+			__m128 rise = _mm_sub_ps( _mm_loadu_ps( current + i ), _mm_loadu_ps( previous + i ) );
+			acc = _mm_add_ps( acc, _mm_max_ps( rise, zero ) );
+		}
+		flux = horizontalSum( acc );
+	}
+#endif
+	for( ; i < bandCount; ++i )
+		flux += std::max( current[i] - previous[i], 0.0f );
+	return flux;
+}
+
+float calculateRms( const PcmBuffer32f &buffer, ChannelIdentifier channelId )
+{
+	size_t count;
+	const float *samples = channelSamples( buffer, channelId, &count );
+	return calculateRms( samples, count );
+}
+
+float calculatePeak( const PcmBuffer32f &buffer, ChannelIdentifier channelId )
+{
+	size_t count;
+	const float *samples = channelSamples( buffer, channelId, &count );
+	return calculatePeak( samples, count );
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// MelFilterBank
+
+MelFilterBankRef MelFilterBank::create( uint16_t fftBandCount, uint32_t sampleRate, uint16_t melBandCount, float minHz, float maxHz )
+{
+	return MelFilterBankRef( new MelFilterBank( fftBandCount, sampleRate, melBandCount, minHz, maxHz ) );
+}
+
+float MelFilterBank::hzToMel( float hz )
+{
+	return 2595.0f * std::log10( 1.0f + hz / 700.0f );
+}
+
+float MelFilterBank::melToHz( float mel )
+{
+	return 700.0f * ( std::pow( 10.0f, mel / 2595.0f ) - 1.0f );
+}
+
+MelFilterBank::MelFilterBank( uint16_t fftBandCount, uint32_t sampleRate, uint16_t melBandCount, float minHz, float maxHz )
+	: mFftBandCount( fftBandCount )
+{
+	const float nyquist = sampleRate * 0.5f;
+	if( ( maxHz <= 0 ) || ( maxHz > nyquist ) )
+		maxHz = nyquist;
+	minHz = std::max( 0.0f, std::min( minHz, maxHz ) );
+
+	// FFT band i is centered on i * hzPerBand
+	const float hzPerBand = nyquist / fftBandCount;
+	const float minMel = hzToMel( minHz ), maxMel = hzToMel( maxHz );
+	const float melStep = ( maxMel - minMel ) / ( melBandCount + 1 );
+
+	mBands.resize( melBandCount );
+	for( uint16_t b = 0; b < melBandCount; b++ ) {
+		float lowHz = melToHz( minMel + b * melStep );
+		float centerHz = melToHz( minMel + ( b + 1 ) * melStep );
+		float highHz = melToHz( minMel + ( b + 2 ) * melStep );
+
+		Band &band = mBands[b];
+		band.mCenterHz = centerHz;
+		size_t first = (size_t)std::ceil( lowHz / hzPerBand );
+		size_t last = std::min( (size_t)std::floor( highHz / hzPerBand ), (size_t)fftBandCount - 1 );
+		// low bands can be narrower than an FFT band, so they get at least the one nearest their center
+		if( first > last ) {
+			first = last = std::min( (size_t)( centerHz / hzPerBand + 0.5f ), (size_t)fftBandCount - 1 );
+			band.mFirstFftBand = first;
+			band.mWeights.assign( 1, 1.0f );
+			continue;
+		}
+		band.mFirstFftBand = first;
+		band.mWeights.resize( last - first + 1 );
+		for( size_t i = first; i <= last; i++ ) {
+			float hz = i * hzPerBand;
+			float weight = ( hz <= centerHz ) ? ( hz - lowHz ) / ( centerHz - lowHz ) : ( highHz - hz ) / ( highHz - centerHz );
+			band.mWeights[i - first] = std::max( weight, 0.0f );
+		}
+	}
+}
+
+void MelFilterBank::process( const float *magnitudes, float *energiesOut ) const
+{
+	for( size_t b = 0; b < mBands.size(); b++ ) {
+		const Band &band = mBands[b];
+		const float *mags = magnitudes + band.mFirstFftBand;
+		const float *weights = &band.mWeights[0];
+		const size_t count = band.mWeights.size();
+		size_t i = 0;
+		float energy = 0;
+#if defined( CINDER_IP_SSE2 )
+		if( ip::useSse2() ) {
+			__m128 acc = _mm_setzero_ps();
+			for( ; i + 4 <= count; i += 4 ) {
+				__m128 m = _mm_loadu_ps( mags + i );
+				acc = _mm_add_ps( acc, _mm_mul_ps( _mm_mul_ps( m, m ), _mm_loadu_ps( weights + i ) ) );
+			}
+			energy = horizontalSum( acc );
+		}
+#endif
+		for( ; i < count; ++i )
+			energy += mags[i] * mags[i] * weights[i];
+		energiesOut[b] = energy;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// OnsetDetector
+
+OnsetDetectorRef OnsetDetector::create( uint32_t sampleRate, uint16_t bandCount, uint16_t hopSize, float thresholdSeconds )
+{
+	return OnsetDetectorRef( new OnsetDetector( sampleRate, bandCount, hopSize, thresholdSeconds ) );
+}
+
+OnsetDetector::OnsetDetector( uint32_t sampleRate, uint16_t bandCount, uint16_t hopSize, float thresholdSeconds )
+	: mSampleRate( sampleRate ), mThresholdMultiplier( 1.5f ), mThresholdOffset( 0.05f )
+{
+	mFft = FftProcessor::createRef( bandCount, FFT_WINDOW_HANN );
+	const size_t windowSize = (size_t)bandCount * 2;
+	mHopSize = ( hopSize > 0 ) ? std::min( (size_t)hopSize, windowSize ) : bandCount;
+	mWindow.resize( windowSize );
+	mMagnitudes.resize( bandCount );
+	mLogMagnitudes.resize( bandCount );
+	mPrevLogMagnitudes.resize( bandCount );
+	mFluxHistory.resize( std::max<size_t>( 1, (size_t)( thresholdSeconds * sampleRate / mHopSize ) ) );
+	setMinInterval( 0.05f );
+	reset();
+}
+
+void OnsetDetector::reset()
+{
+	std::fill( mWindow.begin(), mWindow.end(), 0.0f );
+	std::fill( mMagnitudes.begin(), mMagnitudes.end(), 0.0f );
+	std::fill( mPrevLogMagnitudes.begin(), mPrevLogMagnitudes.end(), 0.0f );
+	std::fill( mFluxHistory.begin(), mFluxHistory.end(), 0.0f );
+	mWindowFill = 0;
+	mWindowStartFrame = 0;
+	mFlux[0] = mFlux[1] = mFlux[2] = 0;
+	mThreshold = mPrevThreshold = 0;
+	mFluxHistoryPos = mFluxHistoryFill = 0;
+	mFluxSum = 0;
+	mLastOnset.mFrame = 0;
+	mLastOnset.mTime = 0;
+	mLastOnset.mStrength = 0;
+	mBeatInterval = 0;
+}
+
+size_t OnsetDetector::process( const float *samples, size_t count )
+{
+	size_t found = 0;
+	while( count > 0 ) {
+		size_t n = std::min( count, mWindow.size() - mWindowFill );
+		std::copy( samples, samples + n, mWindow.begin() + mWindowFill );
+		mWindowFill += n;
+		samples += n;
+		count -= n;
+
+		if( mWindowFill == mWindow.size() ) {
+			if( processHop() )
+				++found;
+			// slide the window along by a hop
+			std::copy( mWindow.begin() + mHopSize, mWindow.end(), mWindow.begin() );
+			mWindowFill -= mHopSize;
+			mWindowStartFrame += mHopSize;
+		}
+	}
+	return found;
+}
+
+size_t OnsetDetector::process( const PcmBuffer32f &buffer )
+{
+	size_t count;
+	const float *left = channelSamples( buffer, CHANNEL_FRONT_LEFT, &count );
+	if( buffer.getChannelCount() < 2 )
+		return process( left, count );
+
+	size_t rightCount;
+	const float *right = channelSamples( buffer, CHANNEL_FRONT_RIGHT, &rightCount );
+	count = std::min( count, rightCount );
+	float mono[256];
+	size_t found = 0;
+	for( size_t i = 0; i < count; i += 256 ) {
+		size_t n = std::min<size_t>( 256, count - i );
+		for( size_t j = 0; j < n; j++ )
+			mono[j] = ( left[i + j] + right[i + j] ) * 0.5f;
+		found += process( mono, n );
+	}
+	return found;
+}
+
+bool OnsetDetector::processHop()
+{
+	const size_t bandCount = mMagnitudes.size();
+	mFft->process( &mWindow[0], &mMagnitudes[0] );
+	for( size_t i = 0; i < bandCount; i++ )
+		mLogMagnitudes[i] = std::log( 1.0f + LOG_COMPRESSION * mMagnitudes[i] );
+	float flux = calculateSpectralFlux( &mLogMagnitudes[0], &mPrevLogMagnitudes[0], bandCount ) / bandCount;
+	mPrevLogMagnitudes.swap( mLogMagnitudes );
+
+	mFlux[0] = mFlux[1];
+	mFlux[1] = mFlux[2];
+	mFlux[2] = flux;
+
+	// the running mean of the flux, kept as a sum over a ring of the recent values
+	mFluxSum += flux - mFluxHistory[mFluxHistoryPos];
+	mFluxHistory[mFluxHistoryPos] = flux;
+	mFluxHistoryPos = ( mFluxHistoryPos + 1 ) % mFluxHistory.size();
+	mFluxHistoryFill = std::min( mFluxHistoryFill + 1, mFluxHistory.size() );
+	float mean = (float)std::max( mFluxSum / mFluxHistoryFill, 0.0 );
+	mPrevThreshold = mThreshold;
+	mThreshold = mean * mThresholdMultiplier + mThresholdOffset;
+
+	// the previous hop is an onset if its flux is a local maximum above the threshold it was compared to
+	if( ( mFlux[1] <= mPrevThreshold ) || ( mFlux[1] <= mFlux[0] ) || ( mFlux[1] < mFlux[2] ) )
+		return false;
+
+	Onset onset;
+	onset.mFrame = mWindowStartFrame - mHopSize + mWindow.size() / 2;
+	onset.mTime = onset.mFrame / (double)mSampleRate;
+	onset.mStrength = mFlux[1] - mPrevThreshold;
+	if( ( mLastOnset.mFrame > 0 ) && ( onset.mFrame - mLastOnset.mFrame < mMinIntervalFrames ) )
+		return false;
+
+	if( mLastOnset.mFrame > 0 ) {
+		double interval = onset.mTime - mLastOnset.mTime;
+		if( ( interval >= MIN_BEAT_INTERVAL ) && ( interval <= MAX_BEAT_INTERVAL ) )
+			mBeatInterval = ( mBeatInterval > 0 ) ? mBeatInterval * 0.8 + interval * 0.2 : interval;
+	}
+	mLastOnset = onset;
+	if( mOnsetFn )
+		mOnsetFn( onset );
+	return true;
+}
+
+float OnsetDetector::getTempo() const
+{
+	return ( mBeatInterval > 0 ) ? (float)( 60.0 / mBeatInterval ) : 0;
+}
+
+}} //namespace
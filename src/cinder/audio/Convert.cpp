@@ -0,0 +1,342 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio/Convert.h"
+#include "cinder/ip/Simd.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#endif
+
+namespace cinder { namespace audio {
+
+namespace {
+
+const float INT16_TO_FLOAT = 1.0f / 32768.0f;
+const float INT32_TO_FLOAT = 1.0f / 2147483648.0f;
+// the largest float below 2^31, as 2^31 itself overflows an int32_t
+const float FLOAT_TO_INT32_MAX = 2147483520.0f;
+
+inline int16_t floatToInt16( float value )
+{
+	float scaled = std::max( std::min( value * 32768.0f, 32767.0f ), -32768.0f );
+	return static_cast<int16_t>( scaled < 0 ? scaled - 0.5f : scaled + 0.5f );
+}
+
+inline int32_t floatToInt32( float value )
+{
+	float scaled = std::max( std::min( value * 2147483648.0f, FLOAT_TO_INT32_MAX ), -2147483648.0f );
+	return static_cast<int32_t>( scaled );
+}
+
+} // anonymous namespace
+
+void convertSamples( const int16_t *src, float *dst, size_t count )
+{
+	size_t i = 0;
+#if defined( CINDER_IP_SSE2 )
+	if( ip::useSse2() ) {
+		const __m128 scale = _mm_set1_ps( INT16_TO_FLOAT );
+		for( ; i + 8 <= count; i += 8 ) {
+			__m128i samples = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+			// sign-extend by unpacking each sample into the high half of a 32-bit lane and shifting it back down
+			__m128i lo = _mm_srai_epi32( _mm_unpacklo_epi16( samples, samples ), 16 );
+			__m128i hi = _mm_srai_epi32( _mm_unpackhi_epi16( samples, samples ), 16 );
+			_mm_storeu_ps( dst + i, _mm_mul_ps( _mm_cvtepi32_ps( lo ), scale ) );
+			_mm_storeu_ps( dst + i + 4, _mm_mul_ps( _mm_cvtepi32_ps( hi ), scale ) );
+		}
+	}
+#endif
+	for( ; i < count; ++i )
+		dst[i] = src[i] * INT16_TO_FLOAT;
+}
+
+void convertSamples( const float *src, int16_t *dst, size_t count )
+{
+	size_t i = 0;
+#if defined( CINDER_IP_SSE2 )
+	if( ip::useSse2() ) {
+		const __m128 scale = _mm_set1_ps( 32768.0f );
+		for( ; i + 8 <= count; i += 8 ) {
+			// _mm_cvtps_epi32 rounds to nearest, and _mm_packs_epi32 saturates to the int16_t range
+			__m128i lo = _mm_cvtps_epi32( _mm_mul_ps( _mm_loadu_ps( src + i ), scale ) );
+			__m128i hi = _mm_cvtps_epi32( _mm_mul_ps( _mm_loadu_ps( src + i + 4 ), scale ) );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_packs_epi32( lo, hi ) );
+		}
+	}
+#endif
+	for( ; i < count; ++i )
+		dst[i] = floatToInt16( src[i] );
+}
+
+void convertSamples( const int32_t *src, float *dst, size_t count )
+{
+	size_t i = 0;
+#if defined( CINDER_IP_SSE2 )
+	if( ip::useSse2() ) {
+		const __m128 scale = _mm_set1_ps( INT32_TO_FLOAT );
+		for( ; i + 4 <= count; i += 4 )
+			_mm_storeu_ps( dst + i, _mm_mul_ps( _mm_cvtepi32_ps( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) ) ), scale ) );
+	}
+#endif
+	for( ; i < count; ++i )
+		dst[i] = src[i] * INT32_TO_FLOAT;
+}
+
+void convertSamples( const float *src, int32_t *dst, size_t count )
+{
+	size_t i = 0;
+#if defined( CINDER_IP_SSE2 )
+	if( ip::useSse2() ) {
+		const __m128 scale = _mm_set1_ps( 2147483648.0f );
+		const __m128 maxValue = _mm_set1_ps( FLOAT_TO_INT32_MAX ), minValue = _mm_set1_ps( -2147483648.0f );
+		for( ; i + 4 <= count; i += 4 ) {
+			__m128 scaled = _mm_max_ps( _mm_min_ps( _mm_mul_ps( _mm_loadu_ps( src + i ), scale ), maxValue ), minValue );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_cvttps_epi32( scaled ) );
+		}
+	}
+#endif
+	for( ; i < count; ++i )
+		dst[i] = floatToInt32( src[i] );
+}
+
+void convertSamples( const int16_t *src, int32_t *dst, size_t count )
+{
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = static_cast<int32_t>( src[i] ) << 16;
+}
+
+void convertSamples( const int32_t *src, int16_t *dst, size_t count )
+{
+	for( size_t i = 0; i < count; ++i )
+		dst[i] = static_cast<int16_t>( src[i] >> 16 );
+}
+
+void convertSamples( const float *src, float *dst, size_t count )
+{
+	memmove( dst, src, count * sizeof(float) );
+}
+
+void convertSamples( const int16_t *src, int16_t *dst, size_t count )
+{
+	memmove( dst, src, count * sizeof(int16_t) );
+}
+
+void convertSamples( const int32_t *src, int32_t *dst, size_t count )
+{
+	memmove( dst, src, count * sizeof(int32_t) );
+}
+
+void interleave( const float * const *src, size_t channelCount, size_t frameCount, float *dst )
+{
+	if( channelCount == 2 ) {
+		const float *left = src[0], *right = src[1];
+		size_t i = 0;
+#if defined( CINDER_IP_SSE2 )
+		if( ip::useSse2() ) {
+			for( ; i + 4 <= frameCount; i += 4 ) {
+				__m128 l = _mm_loadu_ps( left + i ), r = _mm_loadu_ps( right + i );
+				_mm_storeu_ps( dst + i * 2, _mm_unpacklo_ps( l, r ) );
+				_mm_storeu_ps( dst + i * 2 + 4, _mm_unpackhi_ps( l, r ) );
+			}
+		}
+#endif
+		for( ; i < frameCount; ++i ) {
+			dst[i * 2] = left[i];
+			dst[i * 2 + 1] = right[i];
+		}
+		return;
+	}
+
+	for( size_t c = 0; c < channelCount; ++c ) {
+		const float *channel = src[c];
+		float *out = dst + c;
+		for( size_t i = 0; i < frameCount; ++i, out += channelCount )
+			*out = channel[i];
+	}
+}
+
+void deinterleave( const float *src, size_t channelCount, size_t frameCount, float * const *dst )
+{
+	if( channelCount == 2 ) {
+		float *left = dst[0], *right = dst[1];
+		size_t i = 0;
+#if defined( CINDER_IP_SSE2 )
+		if( ip::useSse2() ) {
+			for( ; i + 4 <= frameCount; i += 4 ) {
+				__m128 a = _mm_loadu_ps( src + i * 2 ), b = _mm_loadu_ps( src + i * 2 + 4 );
+				_mm_storeu_ps( left + i, _mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+				_mm_storeu_ps( right + i, _mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+			}
+		}
+#endif
+		for( ; i < frameCount; ++i ) {
+			left[i] = src[i * 2];
+			right[i] = src[i * 2 + 1];
+		}
+		return;
+	}
+
+	for( size_t c = 0; c < channelCount; ++c ) {
+		float *channel = dst[c];
+		const float *in = src + c;
+		for( size_t i = 0; i < frameCount; ++i, in += channelCount )
+			channel[i] = *in;
+	}
+}
+
+void mixChannels( const float *src, size_t srcChannelCount, float *dst, size_t dstChannelCount, size_t frameCount )
+{
+	if( srcChannelCount == dstChannelCount ) {
+		memcpy( dst, src, frameCount * srcChannelCount * sizeof(float) );
+	}
+	else if( srcChannelCount == 1 ) {
+		if( dstChannelCount == 2 ) {
+			const float *channels[2] = { src, src };
+			interleave( channels, 2, frameCount, dst );
+		}
+		else {
+			for( size_t i = 0; i < frameCount; ++i )
+				for( size_t c = 0; c < dstChannelCount; ++c )
+					dst[i * dstChannelCount + c] = src[i];
+		}
+	}
+	else if( dstChannelCount == 1 ) {
+		const float scale = 1.0f / srcChannelCount;
+		for( size_t i = 0; i < frameCount; ++i ) {
+			float sum = 0;
+			for( size_t c = 0; c < srcChannelCount; ++c )
+				sum += src[i * srcChannelCount + c];
+			dst[i] = sum * scale;
+		}
+	}
+	else {
+		const size_t copyCount = std::min( srcChannelCount, dstChannelCount );
+		for( size_t i = 0; i < frameCount; ++i ) {
+			for( size_t c = 0; c < copyCount; ++c )
+				dst[i * dstChannelCount + c] = src[i * srcChannelCount + c];
+			for( size_t c = copyCount; c < dstChannelCount; ++c )
+				dst[i * dstChannelCount + c] = 0;
+		}
+	}
+}
+
+template<typename T, typename U>
+void convertBuffer( const BufferT<T> *src, BufferT<U> *dst )
+{
+	if( src->mNumberChannels != dst->mNumberChannels )
+		throw ConvertException();
+
+	convertSamples( src->mData, dst->mData, src->mSampleCount * src->mNumberChannels );
+	dst->mSampleCount = src->mSampleCount;
+	dst->mDataByteSize = src->mSampleCount * src->mNumberChannels * sizeof(U);
+}
+
+template<typename T, typename U>
+void convertBufferList( const BufferListT<T> *src, BufferListT<U> *dst )
+{
+	if( src->mNumberBuffers == 0 || dst->mNumberBuffers == 0 )
+		throw ConvertException();
+
+	const bool srcInterleaved = src->mNumberBuffers == 1, dstInterleaved = dst->mNumberBuffers == 1;
+	const size_t srcChannels = srcInterleaved ? src->mBuffers[0].mNumberChannels : src->mNumberBuffers;
+	const size_t dstChannels = dstInterleaved ? dst->mBuffers[0].mNumberChannels : dst->mNumberBuffers;
+	const size_t frameCount = src->mBuffers[0].mSampleCount;
+	if( srcChannels == 0 || dstChannels == 0 )
+		throw ConvertException();
+
+	// matching layouts only need their samples converted
+	if( srcChannels == dstChannels && src->mNumberBuffers == dst->mNumberBuffers ) {
+		for( uint32_t b = 0; b < src->mNumberBuffers; ++b )
+			convertBuffer( &src->mBuffers[b], &dst->mBuffers[b] );
+		return;
+	}
+
+	// otherwise go through interleaved floats, a chunk at a time
+	const size_t CHUNK_SAMPLES = 2048, MAX_CHANNELS = 64;
+	const size_t maxChannels = std::max( srcChannels, dstChannels );
+	if( maxChannels > MAX_CHANNELS )
+		throw ConvertException();
+	const size_t chunkFrames = CHUNK_SAMPLES / maxChannels;
+	float interleaved[CHUNK_SAMPLES], scratch[CHUNK_SAMPLES];
+	float *channels[MAX_CHANNELS];
+
+	for( size_t start = 0; start < frameCount; start += chunkFrames ) {
+		const size_t count = std::min( chunkFrames, frameCount - start );
+
+		if( srcInterleaved ) {
+			convertSamples( src->mBuffers[0].mData + start * srcChannels, interleaved, count * srcChannels );
+		}
+		else {
+			for( size_t c = 0; c < srcChannels; ++c ) {
+				channels[c] = scratch + c * count;
+				convertSamples( src->mBuffers[c].mData + start, channels[c], count );
+			}
+			interleave( channels, srcChannels, count, interleaved );
+		}
+
+		const float *mixed = interleaved;
+		if( srcChannels != dstChannels ) {
+			mixChannels( interleaved, srcChannels, scratch, dstChannels, count );
+			mixed = scratch;
+		}
+
+		if( dstInterleaved ) {
+			convertSamples( mixed, dst->mBuffers[0].mData + start * dstChannels, count * dstChannels );
+		}
+		else {
+			float *planar = ( mixed == interleaved ) ? scratch : interleaved;
+			for( size_t c = 0; c < dstChannels; ++c )
+				channels[c] = planar + c * count;
+			deinterleave( mixed, dstChannels, count, channels );
+			for( size_t c = 0; c < dstChannels; ++c )
+				convertSamples( channels[c], dst->mBuffers[c].mData + start, count );
+		}
+	}
+
+	for( uint32_t b = 0; b < dst->mNumberBuffers; ++b ) {
+		dst->mBuffers[b].mSampleCount = frameCount;
+		dst->mBuffers[b].mDataByteSize = frameCount * ( dstInterleaved ? dstChannels : 1 ) * sizeof(U);
+	}
+}
+
+#define CONVERT_PROTOTYPES(T,U)\
+	template void convertBuffer<T,U>( const BufferT<T> *src, BufferT<U> *dst );\
+	template void convertBufferList<T,U>( const BufferListT<T> *src, BufferListT<U> *dst );
+
+CONVERT_PROTOTYPES(int16_t,float)
+CONVERT_PROTOTYPES(float,int16_t)
+CONVERT_PROTOTYPES(int32_t,float)
+CONVERT_PROTOTYPES(float,int32_t)
+CONVERT_PROTOTYPES(int16_t,int32_t)
+CONVERT_PROTOTYPES(int32_t,int16_t)
+CONVERT_PROTOTYPES(float,float)
+CONVERT_PROTOTYPES(int16_t,int16_t)
+CONVERT_PROTOTYPES(int32_t,int32_t)
+
+}} //namespace
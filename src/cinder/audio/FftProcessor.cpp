@@ -25,19 +25,71 @@
 #if defined( CINDER_MAC )
 	#include "cinder/audio/FftProcessorImplAccelerate.h"
 	typedef cinder::audio::FftProcessorImplAccelerate	FftProcessorPlatformImpl;
+#else
+	#include "cinder/audio/FftProcessorImplPortable.h"
+	typedef cinder::audio::FftProcessorImplPortable		FftProcessorPlatformImpl;
 #endif
 
+#include "cinder/CinderMath.h"
+#include "cinder/Thread.h"
+
 namespace cinder { namespace audio {
 
-std::shared_ptr<float> calculateFft( Buffer32fRef aBuffer, uint16_t aBandCount )
+namespace { // anonymous namespace
+
+void deleteFftBuffer( float * buffer )
+{
+	delete [] buffer;
+}
+
+} // anonymous namespace
+
+void fillFftWindow( FftWindow window, float *dest, size_t size )
+{
+	const double scale = ( size > 1 ) ? ( 2 * M_PI / ( size - 1 ) ) : 0;
+	for( size_t i = 0; i < size; ++i ) {
+		double phase = scale * i;
+		switch( window ) {
+			case FFT_WINDOW_HANN:
+				dest[i] = (float)( 0.5 - 0.5 * cos( phase ) );
+			break;
+			case FFT_WINDOW_HAMMING:
+				dest[i] = (float)( 0.54 - 0.46 * cos( phase ) );
+			break;
+			case FFT_WINDOW_BLACKMAN:
+				dest[i] = (float)( 0.42 - 0.5 * cos( phase ) + 0.08 * cos( 2 * phase ) );
+			break;
+			default:
+				dest[i] = 1.0f;
+		}
+	}
+}
+
+std::shared_ptr<float> calculateFft( Buffer32fRef aBuffer, uint16_t aBandCount, FftWindow window )
 {
 	if( ! aBuffer || ( aBuffer->mSampleCount < aBandCount * 2 ) ) {
 		//TODO: throw
 		return std::shared_ptr<float>();
 	}
 
-	FftProcessorRef processor = FftProcessor::createRef( aBandCount );
-	return processor->process( &( aBuffer->mData[ aBuffer->mSampleCount - ( aBandCount * 2 ) ] ) );
+	float * outData = new float[aBandCount];
+	calculateFft( aBuffer, aBandCount, outData, window );
+	return std::shared_ptr<float>( outData, deleteFftBuffer );
+}
+
+bool calculateFft( Buffer32fRef aBuffer, uint16_t aBandCount, float * magnitudesOut, FftWindow window )
+{
+	static std::mutex sProcessorMutex;
+	static FftProcessorRef sProcessor;
+
+	if( ! aBuffer || ( aBuffer->mSampleCount < aBandCount * 2 ) )
+		return false;
+
+	std::lock_guard<std::mutex> lock( sProcessorMutex );
+	if( ( ! sProcessor ) || ( sProcessor->getBandCount() != aBandCount ) || ( sProcessor->getWindow() != window ) )
+		sProcessor = FftProcessor::createRef( aBandCount, window );
+	sProcessor->process( &( aBuffer->mData[ aBuffer->mSampleCount - ( aBandCount * 2 ) ] ), magnitudesOut );
+	return true;
 }
 
 FftProcessorImpl::FftProcessorImpl( uint16_t aBandCount )
@@ -45,14 +97,63 @@ FftProcessorImpl::FftProcessorImpl( uint16_t aBandCount )
 {
 }
 
-FftProcessorRef FftProcessor::createRef( uint16_t aBandCount )
+std::shared_ptr<float> FftProcessorImpl::process( const float * inBuffer )
+{
+	float * outData = new float[mBandCount];
+	process( inBuffer, outData );
+	return std::shared_ptr<float>( outData, deleteFftBuffer );
+}
+
+FftProcessorRef FftProcessor::createRef( uint16_t aBandCount, FftWindow window )
 {
-	return FftProcessorRef( new FftProcessor( aBandCount ) );
+	return FftProcessorRef( new FftProcessor( aBandCount, window ) );
 }
 
-FftProcessor::FftProcessor( uint16_t aBandCount )
+FftProcessor::FftProcessor( uint16_t aBandCount, FftWindow window )
+	: mWindow( window )
 {
 	mImpl = std::shared_ptr<FftProcessorImpl>( new FftProcessorPlatformImpl( aBandCount ) );
+	if( mWindow != FFT_WINDOW_RECTANGULAR ) {
+		mWindowCoeffs.resize( aBandCount * 2 );
+		mWindowedBuffer.resize( aBandCount * 2 );
+		fillFftWindow( mWindow, &mWindowCoeffs[0], mWindowCoeffs.size() );
+	}
+}
+
+const float* FftProcessor::applyWindow( const float * inBuffer )
+{
+	if( mWindowCoeffs.empty() )
+		return inBuffer;
+
+	for( size_t i = 0; i < mWindowCoeffs.size(); ++i )
+		mWindowedBuffer[i] = inBuffer[i] * mWindowCoeffs[i];
+	return &mWindowedBuffer[0];
+}
+
+std::shared_ptr<float> FftProcessor::process( const float * inBuffer )
+{
+	return mImpl->process( applyWindow( inBuffer ) );
+}
+
+void FftProcessor::process( const float * inBuffer, float * magnitudesOut )
+{
+	mImpl->process( applyWindow( inBuffer ), magnitudesOut );
+}
+
+size_t FftProcessor::getNumFrames( size_t sampleCount, size_t hopSize ) const
+{
+	size_t frameSize = getBandCount() * 2;
+	if( ( sampleCount < frameSize ) || ( hopSize == 0 ) )
+		return 0;
+	return ( sampleCount - frameSize ) / hopSize + 1;
+}
+
+size_t FftProcessor::processFrames( const float * inBuffer, size_t sampleCount, size_t hopSize, float * magnitudesOut )
+{
+	size_t numFrames = getNumFrames( sampleCount, hopSize );
+	for( size_t frame = 0; frame < numFrames; ++frame )
+		process( inBuffer + frame * hopSize, magnitudesOut + frame * getBandCount() );
+	return numFrames;
 }
 
 }} //namespace
\ No newline at end of file
@@ -24,11 +24,6 @@
 
 namespace cinder { namespace audio {
 
-void deleteFftBuffer( float * buffer )
-{
-	delete [] buffer;
-}
-
 FftProcessorImplAccelerate::FftProcessorImplAccelerate( uint16_t aBandCount )
 	: FftProcessorImpl( aBandCount )
 {
@@ -51,7 +46,7 @@ FftProcessorImplAccelerate::~FftProcessorImplAccelerate()
 	vDSP_destroy_fftsetup( mFftSetup );
 }
 
-std::shared_ptr<float> FftProcessorImplAccelerate::process( const float * inData )
+void FftProcessorImplAccelerate::process( const float * inData, float * outData )
 {
 	mFftComplexBuffer.realp = (float *)memset( mFftComplexBuffer.realp, 0, mBandCount );
 	mFftComplexBuffer.imagp = (float *)memset( mFftComplexBuffer.imagp, 0, mBandCount );
@@ -59,12 +54,9 @@ std::shared_ptr<float> FftProcessorImplAccelerate::process( const float * inData
 	vDSP_ctoz( (DSPComplex *)inData, 2 * sStride, &mFftComplexBuffer, 1, mBandCount );
 	vDSP_fft_zrip( mFftSetup, &mFftComplexBuffer, 1, mLog2Size, FFT_FORWARD );
 	
-	float * outData = new float[mBandCount];
 	for( int i = 0; i < mBandCount; i++ ) {
 		outData[i] = sqrt( ( mFftComplexBuffer.realp[i] * mFftComplexBuffer.realp[i] ) + ( mFftComplexBuffer.imagp[i] * mFftComplexBuffer.imagp[i] ) );
 	}
-	
-	return std::shared_ptr<float>( outData, deleteFftBuffer );;
 }
 
 }} //namespace
\ No newline at end of file
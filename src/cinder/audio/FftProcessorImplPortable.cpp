@@ -0,0 +1,133 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/audio/FftProcessorImplPortable.h"
+#include "cinder/CinderMath.h"
+#include "cinder/ip/Simd.h"
+
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#endif
+
+namespace cinder { namespace audio {
+
+FftProcessorImplPortable::FftProcessorImplPortable( uint16_t aBandCount )
+	: FftProcessorImpl( aBandCount )
+{
+	uint32_t log2Size = 0;
+	while( ( 2u << log2Size ) <= mBandCount )
+		++log2Size;
+	mSize = 1 << log2Size;
+
+	mReal.resize( mSize );
+	mImag.resize( mSize );
+	mBitReverse.resize( mSize );
+	for( uint32_t i = 0; i < mSize; ++i ) {
+		uint32_t reversed = 0;
+		for( uint32_t bit = 0; bit < log2Size; ++bit )
+			reversed |= ( ( i >> bit ) & 1 ) << ( log2Size - 1 - bit );
+		mBitReverse[i] = reversed;
+	}
+
+	for( uint32_t stageSize = 2; stageSize <= mSize; stageSize *= 2 ) {
+		for( uint32_t j = 0; j < stageSize / 2; ++j ) {
+			double angle = -2 * M_PI * j / stageSize;
+			mStageTwiddleReal.push_back( (float)cos( angle ) );
+			mStageTwiddleImag.push_back( (float)sin( angle ) );
+		}
+	}
+
+	mTwiddleReal.resize( mSize );
+	mTwiddleImag.resize( mSize );
+	for( uint32_t k = 0; k < mSize; ++k ) {
+		double angle = -M_PI * k / mSize;
+		mTwiddleReal[k] = (float)cos( angle );
+		mTwiddleImag[k] = (float)sin( angle );
+	}
+}
+
+// In-place radix-2 decimation-in-time FFT of the bit-reversed mReal and mImag
+void FftProcessorImplPortable::transform()
+{
+	float *re = &mReal[0], *im = &mImag[0];
+	const float *stageTwiddleReal = ( mStageTwiddleReal.empty() ) ? 0 : &mStageTwiddleReal[0];
+	const float *stageTwiddleImag = ( mStageTwiddleImag.empty() ) ? 0 : &mStageTwiddleImag[0];
+
+	for( uint32_t half = 1; half < mSize; half *= 2 ) {
+		for( uint32_t start = 0; start < mSize; start += half * 2 ) {
+			float *re0 = re + start, *im0 = im + start;
+			float *re1 = re0 + half, *im1 = im0 + half;
+			uint32_t j = 0;
+#if defined( CINDER_IP_SSE2 )
+			for( ; j + 4 <= half; j += 4 ) {
+				__m128 wr = _mm_loadu_ps( stageTwiddleReal + j ), wi = _mm_loadu_ps( stageTwiddleImag + j );
+				__m128 xr = _mm_loadu_ps( re1 + j ), xi = _mm_loadu_ps( im1 + j );
+				__m128 tr = _mm_sub_ps( _mm_mul_ps( xr, wr ), _mm_mul_ps( xi, wi ) );
+				__m128 ti = _mm_add_ps( _mm_mul_ps( xr, wi ), _mm_mul_ps( xi, wr ) );
+				__m128 ar = _mm_loadu_ps( re0 + j ), ai = _mm_loadu_ps( im0 + j );
+				_mm_storeu_ps( re1 + j, _mm_sub_ps( ar, tr ) );
+				_mm_storeu_ps( im1 + j, _mm_sub_ps( ai, ti ) );
+				_mm_storeu_ps( re0 + j, _mm_add_ps( ar, tr ) );
+				_mm_storeu_ps( im0 + j, _mm_add_ps( ai, ti ) );
+			}
+#endif
+			for( ; j < half; ++j ) {
+				float tr = re1[j] * stageTwiddleReal[j] - im1[j] * stageTwiddleImag[j];
+				float ti = re1[j] * stageTwiddleImag[j] + im1[j] * stageTwiddleReal[j];
+				re1[j] = re0[j] - tr;
+				im1[j] = im0[j] - ti;
+				re0[j] += tr;
+				im0[j] += ti;
+			}
+		}
+		stageTwiddleReal += half;
+		stageTwiddleImag += half;
+	}
+}
+
+void FftProcessorImplPortable::process( const float * inData, float * outData )
+{
+	// pack the even samples as the real and the odd samples as the imaginary parts of a complex signal of half the length
+	for( uint32_t k = 0; k < mSize; ++k ) {
+		mReal[mBitReverse[k]] = inData[2 * k];
+		mImag[mBitReverse[k]] = inData[2 * k + 1];
+	}
+
+	transform();
+
+	// untangle the spectra of the even and odd samples and combine them, scaled by 2 like vDSP_fft_zrip
+	outData[0] = 2 * sqrt( ( mReal[0] + mImag[0] ) * ( mReal[0] + mImag[0] ) + ( mReal[0] - mImag[0] ) * ( mReal[0] - mImag[0] ) );
+	for( uint32_t k = 1; k < mSize; ++k ) {
+		float zr = mReal[k], zi = mImag[k], cr = mReal[mSize - k], ci = -mImag[mSize - k];
+		float evenReal = zr + cr, evenImag = zi + ci;
+		float oddReal = zi - ci, oddImag = cr - zr;
+		float real = evenReal + mTwiddleReal[k] * oddReal - mTwiddleImag[k] * oddImag;
+		float imag = evenImag + mTwiddleReal[k] * oddImag + mTwiddleImag[k] * oddReal;
+		outData[k] = sqrt( real * real + imag * imag );
+	}
+	for( uint32_t k = mSize; k < mBandCount; ++k )
+		outData[k] = 0;
+}
+
+}} //namespace
@@ -0,0 +1,516 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio/Graph.h"
+#include "cinder/audio/Callback.h"
+#include "cinder/audio/Convert.h"
+#include "cinder/ip/Simd.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#endif
+
+namespace cinder { namespace audio {
+
+namespace {
+
+// dst[i] = src[i] * ( gain + gainStep * i ). dst and src are 16-byte aligned.
+void scaleRamp( float *dst, const float *src, float gain, float gainStep, uint32_t count, bool useSse2 )
+{
+	uint32_t i = 0;
+#if defined( CINDER_IP_SSE2 )
+	if( useSse2 ) {
+		__m128 gains = _mm_add_ps( _mm_set1_ps( gain ), _mm_mul_ps( _mm_set1_ps( gainStep ), _mm_set_ps( 3, 2, 1, 0 ) ) );
+		const __m128 step4 = _mm_set1_ps( gainStep * 4 );
+		for( ; i + 4 <= count; i += 4 ) {
+			_mm_store_ps( dst + i, _mm_mul_ps( _mm_load_ps( src + i ), gains ) );
+			gains = _mm_add_ps( gains, step4 );
+		}
+	}
+#endif
+	for( ; i < count; ++i )
+		dst[i] = src[i] * ( gain + gainStep * i );
+}
+
+// dst[i] += src[i] * ( gain + gainStep * i ). dst and src are 16-byte aligned.
+void mixRamp( float *dst, const float *src, float gain, float gainStep, uint32_t count, bool useSse2 )
+{
+	uint32_t i = 0;
+#if defined( CINDER_IP_SSE2 )
+	if( useSse2 ) {
+		__m128 gains = _mm_add_ps( _mm_set1_ps( gain ), _mm_mul_ps( _mm_set1_ps( gainStep ), _mm_set_ps( 3, 2, 1, 0 ) ) );
+		const __m128 step4 = _mm_set1_ps( gainStep * 4 );
+		for( ; i + 4 <= count; i += 4 ) {
+			_mm_store_ps( dst + i, _mm_add_ps( _mm_load_ps( dst + i ), _mm_mul_ps( _mm_load_ps( src + i ), gains ) ) );
+			gains = _mm_add_ps( gains, step4 );
+		}
+	}
+#endif
+	for( ; i < count; ++i )
+		dst[i] += src[i] * ( gain + gainStep * i );
+}
+
+void silence( NodeBlock *block, uint32_t count )
+{
+	memset( block->mChannels[0], 0, count * sizeof(float) );
+	memset( block->mChannels[1], 0, count * sizeof(float) );
+}
+
+} // anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Node
+Node::Node()
+	: mStorage( Graph::BLOCK_SIZE * 2 + 4, 0 )
+{
+	// align the first channel to 16 bytes; BLOCK_SIZE keeps the second one aligned too
+	size_t misalignment = reinterpret_cast<size_t>( &mStorage[0] ) & 15;
+	mBlock.mChannels[0] = &mStorage[0] + ( misalignment ? ( 16 - misalignment ) / sizeof(float) : 0 );
+	mBlock.mChannels[1] = mBlock.mChannels[0] + Graph::BLOCK_SIZE;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Graph
+GraphRef Graph::create( uint32_t sampleRate )
+{
+	return GraphRef( new Graph( sampleRate ) );
+}
+
+Graph::Graph( uint32_t sampleRate )
+	: mSampleRate( sampleRate ), mFrame( 0 )
+{
+	mSource = createCallback( this, &Graph::render, false, sampleRate, 2 );
+}
+
+Graph::~Graph()
+{
+}
+
+void Graph::connect( const NodeRef &source, const NodeRef &dest )
+{
+	std::vector<NodeRef> &inputs = mInputs[dest.get()];
+	if( inputs.size() >= dest->getMaxInputs() )
+		throw GraphExceptionTooManyInputs();
+	if( dependsOn( source.get(), dest.get() ) )
+		throw GraphExceptionCycle();
+
+	inputs.push_back( source );
+	commit();
+}
+
+void Graph::disconnect( const NodeRef &source, const NodeRef &dest )
+{
+	InputMap::iterator inputsIt = mInputs.find( dest.get() );
+	if( inputsIt == mInputs.end() )
+		return;
+
+	std::vector<NodeRef>::iterator sourceIt = std::find( inputsIt->second.begin(), inputsIt->second.end(), source );
+	if( sourceIt != inputsIt->second.end() ) {
+		inputsIt->second.erase( sourceIt );
+		commit();
+	}
+}
+
+void Graph::disconnectInputs( const NodeRef &node )
+{
+	if( mInputs.erase( node.get() ) )
+		commit();
+}
+
+void Graph::setOutput( const NodeRef &node )
+{
+	mOutput = node;
+	commit();
+}
+
+SourceRef Graph::getSource()
+{
+	return mSource;
+}
+
+bool Graph::dependsOn( Node *node, Node *dependency ) const
+{
+	if( node == dependency )
+		return true;
+
+	InputMap::const_iterator inputsIt = mInputs.find( node );
+	if( inputsIt != mInputs.end() ) {
+		for( std::vector<NodeRef>::const_iterator inputIt = inputsIt->second.begin(); inputIt != inputsIt->second.end(); ++inputIt )
+			if( dependsOn( inputIt->get(), dependency ) )
+				return true;
+	}
+	return false;
+}
+
+void Graph::appendRenderOps( const NodeRef &node, RenderList *list, std::map<Node*,size_t> *opIndices ) const
+{
+	if( opIndices->find( node.get() ) != opIndices->end() )
+		return;
+
+	RenderOp op;
+	op.mNode = node.get();
+	op.mFirstInput = op.mNumInputs = 0;
+
+	InputMap::const_iterator inputsIt = mInputs.find( node.get() );
+	if( inputsIt != mInputs.end() ) {
+		const std::vector<NodeRef> &inputs = inputsIt->second;
+		for( std::vector<NodeRef>::const_iterator inputIt = inputs.begin(); inputIt != inputs.end(); ++inputIt )
+			appendRenderOps( *inputIt, list, opIndices );
+
+		op.mFirstInput = list->mInputs.size();
+		op.mNumInputs = inputs.size();
+		for( std::vector<NodeRef>::const_iterator inputIt = inputs.begin(); inputIt != inputs.end(); ++inputIt )
+			list->mInputs.push_back( &(*inputIt)->mBlock );
+	}
+
+	(*opIndices)[node.get()] = list->mOps.size();
+	list->mOps.push_back( op );
+	list->mNodes.push_back( node );
+}
+
+void Graph::commit()
+{
+	// back() is never the list the audio thread is rendering, so it can be rebuilt freely here. Nodes dropped from the graph
+	// stay alive in older lists until those are rebuilt in turn, by which point the audio thread has moved past them.
+	RenderList &list = mRenderLists.back();
+	list.mOps.clear();
+	list.mInputs.clear();
+	list.mNodes.clear();
+
+	if( mOutput ) {
+		std::map<Node*,size_t> opIndices;
+		appendRenderOps( mOutput, &list, &opIndices );
+	}
+
+	mRenderLists.publish();
+}
+
+void Graph::render( uint64_t inSampleOffset, uint32_t inSampleCount, BufferT<float> *ioBuffer )
+{
+	const uint32_t channelCount = ioBuffer->mNumberChannels;
+	float *data = ioBuffer->mData;
+
+	RenderContext context;
+	context.mSampleRate = mSampleRate;
+
+	for( uint32_t blockStart = 0; blockStart < inSampleCount; blockStart += BLOCK_SIZE ) {
+		mRenderLists.update();
+		const RenderList &list = mRenderLists.front();
+
+		context.mFrame = mFrame;
+		context.mFrameCount = std::min<uint32_t>( BLOCK_SIZE, inSampleCount - blockStart );
+
+		for( std::vector<RenderOp>::const_iterator opIt = list.mOps.begin(); opIt != list.mOps.end(); ++opIt ) {
+			const NodeBlock * const *inputs = opIt->mNumInputs ? &list.mInputs[opIt->mFirstInput] : 0;
+			opIt->mNode->process( context, inputs, opIt->mNumInputs, &opIt->mNode->mBlock );
+		}
+
+		float *outData = data + blockStart * channelCount;
+		if( list.mOps.empty() ) {
+			memset( outData, 0, context.mFrameCount * channelCount * sizeof(float) );
+		}
+		else {
+			const NodeBlock &block = list.mOps.back().mNode->mBlock;
+			const float *left = block.mChannels[0], *right = block.mChannels[1];
+			if( channelCount == 1 ) {
+				for( uint32_t i = 0; i < context.mFrameCount; ++i )
+					outData[i] = 0.5f * ( left[i] + right[i] );
+			}
+			else if( channelCount == 2 ) {
+				interleave( block.mChannels, 2, context.mFrameCount, outData );
+			}
+			else {
+				for( uint32_t i = 0; i < context.mFrameCount; ++i ) {
+					outData[i * channelCount] = left[i];
+					outData[i * channelCount + 1] = right[i];
+					for( uint32_t c = 2; c < channelCount; ++c )
+						outData[i * channelCount + c] = 0;
+				}
+			}
+		}
+
+		mFrame += context.mFrameCount;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// CallbackNode
+void CallbackNode::process( const RenderContext &context, const NodeBlock * const *inputs, size_t numInputs, NodeBlock *out )
+{
+	if( mRenderFn )
+		mRenderFn( context.mFrame, context.mFrameCount, out->mChannels[0], out->mChannels[1] );
+	else
+		silence( out, context.mFrameCount );
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// BufferPlayerNode
+BufferPlayerNode::BufferPlayerNode( const PcmBuffer32fRef &buffer, bool looping )
+	: mNumFrames( 0 ), mPosition( 0 ), mStartsSeen( 0 ), mStopsSeen( 0 ), mStartCount( 0 ), mStopCount( 0 ), mIsPlaying( false ), mIsLooping( looping )
+{
+	if( ! buffer || buffer->getChannelCount() == 0 )
+		return;
+
+	Buffer32fRef left = buffer->getChannelData( CHANNEL_FRONT_LEFT );
+	Buffer32fRef right = ( buffer->getChannelCount() > 1 ) ? buffer->getChannelData( CHANNEL_FRONT_RIGHT ) : left;
+	mNumFrames = std::min( left->mSampleCount, right->mSampleCount );
+	mChannels[0].assign( left->mData, left->mData + mNumFrames );
+	mChannels[1].assign( right->mData, right->mData + mNumFrames );
+}
+
+void BufferPlayerNode::process( const RenderContext &context, const NodeBlock * const *inputs, size_t numInputs, NodeBlock *out )
+{
+	// a stop() followed by a start() within one block restarts playback
+	if( mStopCount != mStopsSeen ) {
+		mStopsSeen = mStopCount;
+		mIsPlaying = false;
+	}
+	if( mStartCount != mStartsSeen ) {
+		mStartsSeen = mStartCount;
+		mPosition = 0;
+		mIsPlaying = mNumFrames > 0;
+	}
+
+	uint32_t written = 0;
+	while( mIsPlaying && written < context.mFrameCount ) {
+		uint32_t count = std::min( context.mFrameCount - written, mNumFrames - mPosition );
+		memcpy( out->mChannels[0] + written, &mChannels[0][mPosition], count * sizeof(float) );
+		memcpy( out->mChannels[1] + written, &mChannels[1][mPosition], count * sizeof(float) );
+		written += count;
+		mPosition += count;
+		if( mPosition == mNumFrames ) {
+			mPosition = 0;
+			mIsPlaying = mIsLooping;
+		}
+	}
+
+	memset( out->mChannels[0] + written, 0, ( context.mFrameCount - written ) * sizeof(float) );
+	memset( out->mChannels[1] + written, 0, ( context.mFrameCount - written ) * sizeof(float) );
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GainNode
+void GainNode::process( const RenderContext &context, const NodeBlock * const *inputs, size_t numInputs, NodeBlock *out )
+{
+	const float target = mGain;
+	if( ! numInputs ) {
+		silence( out, context.mFrameCount );
+	}
+	else {
+		const float step = ( target - mCurrentGain ) / context.mFrameCount;
+		const bool useSse2 = ip::useSse2();
+		scaleRamp( out->mChannels[0], inputs[0]->mChannels[0], mCurrentGain, step, context.mFrameCount, useSse2 );
+		scaleRamp( out->mChannels[1], inputs[0]->mChannels[1], mCurrentGain, step, context.mFrameCount, useSse2 );
+	}
+	mCurrentGain = target;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// MixerNode
+MixerNode::MixerNode( size_t maxInputs )
+	: mMaxInputs( maxInputs ), mUseSse2( ip::useSse2() )
+{
+	Strip strip;
+	strip.mGain = 1;
+	strip.mPan = 0;
+	strip.mCurrentLeft = strip.mCurrentRight = 0.70710678f;
+	mStrips.resize( maxInputs, strip );
+}
+
+void MixerNode::setInputGain( size_t index, float gain )
+{
+	if( index < mStrips.size() )
+		mStrips[index].mGain = gain;
+}
+
+float MixerNode::getInputGain( size_t index ) const
+{
+	return ( index < mStrips.size() ) ? mStrips[index].mGain : 0;
+}
+
+void MixerNode::setInputPan( size_t index, float pan )
+{
+	if( index < mStrips.size() )
+		mStrips[index].mPan = math<float>::clamp( pan, -1, 1 );
+}
+
+float MixerNode::getInputPan( size_t index ) const
+{
+	return ( index < mStrips.size() ) ? mStrips[index].mPan : 0;
+}
+
+void MixerNode::process( const RenderContext &context, const NodeBlock * const *inputs, size_t numInputs, NodeBlock *out )
+{
+	silence( out, context.mFrameCount );
+
+	const float invFrameCount = 1.0f / context.mFrameCount;
+	for( size_t i = 0; i < numInputs; ++i ) {
+		Strip &strip = mStrips[i];
+		const float gain = strip.mGain;
+		const float angle = ( strip.mPan + 1 ) * (float)M_PI * 0.25f;
+		const float targetLeft = gain * math<float>::cos( angle ), targetRight = gain * math<float>::sin( angle );
+
+		if( targetLeft != 0 || targetRight != 0 || strip.mCurrentLeft != 0 || strip.mCurrentRight != 0 ) {
+			mixRamp( out->mChannels[0], inputs[i]->mChannels[0], strip.mCurrentLeft, ( targetLeft - strip.mCurrentLeft ) * invFrameCount, context.mFrameCount, mUseSse2 );
+			mixRamp( out->mChannels[1], inputs[i]->mChannels[1], strip.mCurrentRight, ( targetRight - strip.mCurrentRight ) * invFrameCount, context.mFrameCount, mUseSse2 );
+		}
+		strip.mCurrentLeft = targetLeft;
+		strip.mCurrentRight = targetRight;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// BiquadFilterNode
+BiquadFilterNode::BiquadFilterNode( Type type, float frequency, float q )
+	: mCoefficientsSampleRate( 0 ), mB0( 1 ), mB1( 0 ), mB2( 0 ), mA1( 0 ), mA2( 0 )
+{
+	memset( mState, 0, sizeof(mState) );
+	set( type, frequency, q );
+}
+
+void BiquadFilterNode::set( Type type, float frequency, float q )
+{
+	mType = type;
+	mFrequency = frequency;
+	mQ = q;
+
+	Params &params = mParams.back();
+	params.mType = type;
+	params.mFrequency = frequency;
+	params.mQ = q;
+	mParams.publish();
+}
+
+void BiquadFilterNode::updateCoefficients( uint32_t sampleRate )
+{
+	const Params &params = mParams.front();
+	const float frequency = math<float>::clamp( params.mFrequency, 10.0f, sampleRate * 0.49f );
+	const float w0 = 2 * (float)M_PI * frequency / sampleRate;
+	const float cosW0 = math<float>::cos( w0 );
+	const float alpha = math<float>::sin( w0 ) / ( 2 * std::max( params.mQ, 0.01f ) );
+
+	float b0, b1, b2;
+	switch( params.mType ) {
+		case LOWPASS:	b0 = ( 1 - cosW0 ) / 2; b1 = 1 - cosW0; b2 = b0; break;
+		case HIGHPASS:	b0 = ( 1 + cosW0 ) / 2; b1 = -( 1 + cosW0 ); b2 = b0; break;
+		case BANDPASS:	b0 = alpha; b1 = 0; b2 = -alpha; break;
+		default:		b0 = 1; b1 = -2 * cosW0; b2 = 1; break;
+	}
+
+	const float invA0 = 1 / ( 1 + alpha );
+	mB0 = b0 * invA0;
+	mB1 = b1 * invA0;
+	mB2 = b2 * invA0;
+	mA1 = -2 * cosW0 * invA0;
+	mA2 = ( 1 - alpha ) * invA0;
+	mCoefficientsSampleRate = sampleRate;
+}
+
+void BiquadFilterNode::process( const RenderContext &context, const NodeBlock * const *inputs, size_t numInputs, NodeBlock *out )
+{
+	if( mParams.update() || mCoefficientsSampleRate != context.mSampleRate )
+		updateCoefficients( context.mSampleRate );
+
+	if( ! numInputs ) {
+		silence( out, context.mFrameCount );
+		return;
+	}
+
+	// transposed direct form II
+	for( int c = 0; c < 2; ++c ) {
+		const float *in = inputs[0]->mChannels[c];
+		float *outData = out->mChannels[c];
+		float z1 = mState[c][0], z2 = mState[c][1];
+		for( uint32_t i = 0; i < context.mFrameCount; ++i ) {
+			const float x = in[i];
+			const float y = mB0 * x + z1;
+			z1 = mB1 * x - mA1 * y + z2;
+			z2 = mB2 * x - mA2 * y;
+			outData[i] = y;
+		}
+		// flush denormals, which are very slow on x86, once the input falls silent
+		mState[c][0] = ( math<float>::abs( z1 ) < 1e-15f ) ? 0 : z1;
+		mState[c][1] = ( math<float>::abs( z2 ) < 1e-15f ) ? 0 : z2;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// AnalyzerNode
+AnalyzerNode::AnalyzerNode( uint32_t windowSize, FftWindow fftWindow )
+	: mWindowSize( windowSize ), mWritePosition( 0 ), mHistory( windowSize, 0 ), mWindows( std::vector<float>( windowSize, 0 ) ),
+		mMagnitudes( windowSize / 2, 0 ), mMagnitudesValid( false )
+{
+	mFft = FftProcessor::createRef( windowSize / 2, fftWindow );
+}
+
+bool AnalyzerNode::update()
+{
+	if( ! mWindows.update() )
+		return false;
+	mMagnitudesValid = false;
+	return true;
+}
+
+const std::vector<float>& AnalyzerNode::getMagnitudes()
+{
+	if( ! mMagnitudesValid && ! mMagnitudes.empty() ) {
+		mFft->process( &mWindows.front()[0], &mMagnitudes[0] );
+		mMagnitudesValid = true;
+	}
+	return mMagnitudes;
+}
+
+void AnalyzerNode::process( const RenderContext &context, const NodeBlock * const *inputs, size_t numInputs, NodeBlock *out )
+{
+	if( ! numInputs ) {
+		silence( out, context.mFrameCount );
+	}
+	else {
+		memcpy( out->mChannels[0], inputs[0]->mChannels[0], context.mFrameCount * sizeof(float) );
+		memcpy( out->mChannels[1], inputs[0]->mChannels[1], context.mFrameCount * sizeof(float) );
+	}
+
+	if( mHistory.empty() )
+		return;
+
+	const float *left = out->mChannels[0], *right = out->mChannels[1];
+	for( uint32_t i = 0; i < context.mFrameCount; ++i ) {
+		mHistory[mWritePosition] = 0.5f * ( left[i] + right[i] );
+		if( ++mWritePosition == mWindowSize )
+			mWritePosition = 0;
+	}
+
+	// publish the history oldest first
+	std::vector<float> &window = mWindows.back();
+	std::copy( mHistory.begin() + mWritePosition, mHistory.end(), window.begin() );
+	std::copy( mHistory.begin(), mHistory.begin() + mWritePosition, window.begin() + ( mWindowSize - mWritePosition ) );
+	mWindows.publish();
+}
+
+}} //namespace
@@ -28,17 +28,58 @@
 
 namespace cinder { namespace audio {
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////
+// InputImpl
+
+void InputImpl::enableCapture( float seconds )
+{
+	// the input callback reads mCaptureRing without locking, so it may only change while the callback isn't running
+	if( isCapturing() ) {
+		throw CaptureInputExc();
+	}
+	mCaptureSeconds = seconds;
+	mCaptureRing.reset();
+}
+
+void InputImpl::prepareCapture()
+{
+	if( ( mCaptureSeconds <= 0 ) || mCaptureRing || ( getSampleRate() == 0 ) ) return;
+	
+	mCaptureRing = std::shared_ptr<PcmCaptureRing>( new PcmCaptureRing( (uint32_t)( mCaptureSeconds * getSampleRate() ), getChannelCount() ) );
+}
+
+uint64_t InputImpl::getCapturePosition() const
+{
+	return mCaptureRing ? mCaptureRing->getWritePosition() : 0;
+}
+
+uint32_t InputImpl::readCapture( uint64_t *ioFrame, PcmBuffer32f *buffer, uint32_t *outDroppedFrames )
+{
+	if( ! mCaptureRing ) {
+		if( outDroppedFrames )
+			*outDroppedFrames = 0;
+		buffer->clear();
+		return 0;
+	}
+	return mCaptureRing->read( ioFrame, buffer, outDroppedFrames );
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////
 // Input
 
 Input::Input()
 {
-	mImpl = std::shared_ptr<InputImpl>( new InputPlatformImpl( InputDeviceRef() ) );
+	mImpl = std::shared_ptr<InputImpl>( new InputPlatformImpl( InputDeviceRef(), 0 ) );
 }
 
 Input::Input( InputDeviceRef aDevice )
 {
-	mImpl = std::shared_ptr<InputImpl>( new InputPlatformImpl( aDevice ) );
+	mImpl = std::shared_ptr<InputImpl>( new InputPlatformImpl( aDevice, 0 ) );
+}
+
+Input::Input( InputDeviceRef aDevice, uint32_t framesPerBuffer )
+{
+	mImpl = std::shared_ptr<InputImpl>( new InputPlatformImpl( aDevice, framesPerBuffer ) );
 }
 
 const std::vector<InputDeviceRef>&	Input::getDevices( bool forceRefresh )
@@ -34,8 +34,8 @@ namespace cinder { namespace audio {
 bool InputImplAudioUnit::sDevicesEnumerated = false;
 vector<InputDeviceRef> InputImplAudioUnit::sDevices;
 
-InputImplAudioUnit::InputImplAudioUnit( InputDeviceRef aDevice )
-	: InputImpl( aDevice ), mIsCapturing( false ), mDevice( aDevice ), mSampleRate( 0 ), mChannelCount( 0 ), mIsSetup( false ), mInputBuffer( 0 ), mInputBufferData( 0 ), mInputUnit( 0 )
+InputImplAudioUnit::InputImplAudioUnit( InputDeviceRef aDevice, uint32_t framesPerBuffer )
+	: InputImpl( aDevice, framesPerBuffer ), mIsCapturing( false ), mDevice( aDevice ), mSampleRate( 0 ), mChannelCount( 0 ), mFramesPerBuffer( 0 ), mIsSetup( false ), mInputBuffer( 0 ), mInputBufferData( 0 ), mInputUnit( 0 )
 {
 	//assume that if a device is provided, go ahead and do the expensive setup
 	//if device is NULL, this is presumably just a default constructor call, hold off on setup until start is called
@@ -75,6 +75,7 @@ void InputImplAudioUnit::start()
 	if( mIsCapturing ) return;
 	
 	setup();
+	prepareCapture();
 
 	OSStatus err = AudioOutputUnitStart( mInputUnit );
 	if( err != noErr ) {
@@ -100,27 +101,7 @@ PcmBuffer32fRef InputImplAudioUnit::getPcmBuffer()
 {
 	if( ! mIsCapturing ) { return PcmBuffer32fRef(); }
 	
-	mBufferMutex.lock();
-	
-	//TODO: don't just assume the data is non-interleaved
-	PcmBuffer32fRef outBuffer( new PcmBuffer32f( mCircularBuffers[0]->size(), mCircularBuffers.size(), false ) );
-	/*for( int i = 0; i < mBuffers.size(); i++ ) {
-		circular_buffer<float>::array_range ar = mBuffers[i]->array_one();
-		outBuffer->appendChannelData( ar.first, ar.second, static_cast<ChannelIdentifier>( i ) );
-		ar = mBuffers[i]->array_two();
-		outBuffer->appendChannelData( ar.first, ar.second, static_cast<ChannelIdentifier>( i ) );
-	}*/
-	
-	for( int i = 0; i < mCircularBuffers.size(); i++ ) {
-		CircularBuffer<float>::ArrayRange ar = mCircularBuffers[i]->arrayOne();
-		outBuffer->appendChannelData( ar.first, ar.second, static_cast<ChannelIdentifier>( i ) );
-		ar = mCircularBuffers[i]->arrayTwo();
-		outBuffer->appendChannelData( ar.first, ar.second, static_cast<ChannelIdentifier>( i ) );
-	}
-	
-	mBufferMutex.unlock();
-	
-	return outBuffer;
+	return mPcmBuffers->getLatest();
 }
 
 OSStatus InputImplAudioUnit::inputCallback( void *inRefCon, AudioUnitRenderActionFlags *ioActionFlags, const AudioTimeStamp *inTimeStamp, UInt32 inBusNumber, UInt32 inNumberFrames, AudioBufferList *ioData )
@@ -146,8 +127,6 @@ OSStatus InputImplAudioUnit::inputCallback( void *inRefCon, AudioUnitRenderActio
 		return noErr;
 	}
 	
-	theInput->mBufferMutex.lock();
-	
 	//copy data from the input buffer to the circular buffer
 	for( int i = 0; i < theInput->mInputBuffer->mNumberBuffers; i++ ) {
 		float * start = reinterpret_cast<float *>( theInput->mInputBuffer->mBuffers[i].mData );
@@ -158,7 +137,22 @@ OSStatus InputImplAudioUnit::inputCallback( void *inRefCon, AudioUnitRenderActio
 		//theInput->mBuffers[i]->insert( theInput->mBuffers[i]->end(), start, end );
 	}
 	
-	theInput->mBufferMutex.unlock();
+	//keep every frame for readCapture(), as the circular buffers only hold the most recent few callbacks
+	if( theInput->mCaptureRing ) {
+		theInput->mCaptureRing->write( &theInput->mCaptureChannels[0], theInput->mInputBuffer->mBuffers[0].mDataByteSize / sizeof(float) );
+	}
+	
+	//hand the recent input to the app without locking or allocating on this thread
+	//TODO: don't just assume the data is non-interleaved
+	PcmBuffer32f &outBuffer = theInput->mPcmBuffers->getLoadingBuffer();
+	outBuffer.clear();
+	for( int i = 0; i < theInput->mCircularBuffers.size(); i++ ) {
+		CircularBuffer<float>::ArrayRange ar = theInput->mCircularBuffers[i]->arrayOne();
+		outBuffer.appendChannelData( ar.first, ar.second, static_cast<ChannelIdentifier>( i ) );
+		ar = theInput->mCircularBuffers[i]->arrayTwo();
+		outBuffer.appendChannelData( ar.first, ar.second, static_cast<ChannelIdentifier>( i ) );
+	}
+	theInput->mPcmBuffers->publish();
 	
 	return noErr;
 }
@@ -257,6 +251,14 @@ void InputImplAudioUnit::setup()
 	uint32_t sampleCount;
 	param = sizeof(UInt32);
 #if defined( CINDER_MAC )
+	if( mRequestedFramesPerBuffer > 0 ) {
+		//the device may clamp the request to its supported range, so the size is read back below
+		sampleCount = mRequestedFramesPerBuffer;
+		err = AudioUnitSetProperty( mInputUnit, kAudioDevicePropertyBufferFrameSize, kAudioUnitScope_Global, 0, &sampleCount, sizeof(UInt32) );
+		if( err != noErr ) {
+			std::cout << "Error setting buffer frame size" << std::endl;
+		}
+	}
 	err = AudioUnitGetProperty( mInputUnit, kAudioDevicePropertyBufferFrameSize, kAudioUnitScope_Global, 0, &sampleCount, &param );
 	if( err != noErr ) {
 		std::cout << "Error getting buffer frame size" << std::endl;
@@ -323,6 +325,7 @@ void InputImplAudioUnit::setup()
 	
 	mSampleRate = desiredOutFormat.mSampleRate;
 	mChannelCount = desiredOutFormat.mChannelsPerFrame;
+	mFramesPerBuffer = sampleCount;
 	
 	
 	//Buffer Setup - create the buffers necessary for holding input data
@@ -344,16 +347,19 @@ void InputImplAudioUnit::setup()
 	mInputBuffer->mNumberBuffers = desiredOutFormat.mChannelsPerFrame;
 	//mBuffers.resize( mInputBuffer->mNumberBuffers );
 	mCircularBuffers.resize( mInputBuffer->mNumberBuffers );
+	mCaptureChannels.resize( mInputBuffer->mNumberBuffers );
 	for( int i = 0; i < mInputBuffer->mNumberBuffers; i++ ) {
 		mInputBuffer->mBuffers[i].mNumberChannels = 1;
 		mInputBuffer->mBuffers[i].mDataByteSize = sampleCount * desiredOutFormat.mBytesPerFrame;
 		mInputBuffer->mBuffers[i].mData = inputBufferChannels[i];
+		mCaptureChannels[i] = inputBufferChannels[i];
 		
 		//create a circular buffer for each channel
 		//mBuffers[i] = new circular_buffer<float>( sampleCount * 4 );
 		
 		mCircularBuffers[i] = new CircularBuffer<float>( sampleCount * 4 );
 	}
+	mPcmBuffers = std::shared_ptr<PcmBufferHandoff>( new PcmBufferHandoff( sampleCount * 4, mCircularBuffers.size(), false ) );
 	mIsSetup = true;
 }
 
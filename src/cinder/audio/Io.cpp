@@ -21,6 +21,8 @@
 */
 
 #include "cinder/audio/Io.h"
+#include "cinder/Profiler.h"
+#include "cinder/Thread.h"
 #include "cinder/Utilities.h"
 
 #if defined(CINDER_MSW)
@@ -117,12 +119,47 @@ std::shared_ptr<AudioBufferList> Loader::createCaBufferList( const BufferList *
 #endif
 
 ///////////////////////////////////////////////////////////////////////////////
+namespace {
+
+// pointers to navigate around static init issues, since sources are deferred during static initialization
+vector<void(*)()>& getDeferredRegistrations()
+{
+	static vector<void(*)()> *sRegistrations = new vector<void(*)()>;
+	return *sRegistrations;
+}
+
+std::recursive_mutex& getRegistrarMutex()
+{
+	static std::recursive_mutex *sMutex = new std::recursive_mutex;
+	return *sMutex;
+}
+
+} // anonymous namespace
+
+void IoRegistrar::deferRegistration( void (*registerFn)() )
+{
+	std::lock_guard<std::recursive_mutex> lock( getRegistrarMutex() );
+	getDeferredRegistrations().push_back( registerFn );
+}
+
 IoRegistrar::Inst* IoRegistrar::instance()
 {
 	static std::shared_ptr<Inst> sInst;
+	std::lock_guard<std::recursive_mutex> lock( getRegistrarMutex() );
 	if( ! sInst ) {
 		sInst = std::shared_ptr<Inst>( new IoRegistrar::Inst );
 	}
+
+	// enumerating the system's audio file types is slow, so it waits for the first load; the sources register through instance() again
+	if( ! getDeferredRegistrations().empty() ) {
+		double start = Profiler::get().getSeconds();
+		vector<void(*)()> registrations;
+		registrations.swap( getDeferredRegistrations() );
+		for( vector<void(*)()>::const_iterator regIt = registrations.begin(); regIt != registrations.end(); ++regIt )
+			(**regIt)();
+		Profiler::get().addInitialization( "Audio sources", start, Profiler::get().getSeconds() );
+	}
+
 	return sInst.get();
 }
 
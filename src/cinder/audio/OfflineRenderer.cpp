@@ -0,0 +1,453 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio/OfflineRenderer.h"
+#include "cinder/audio/Convert.h"
+#include "cinder/audio/Resampler.h"
+#include "cinder/Stream.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cinder { namespace audio {
+
+namespace {
+
+// the number of frames decoded per track, and mixed, at a time. Large enough that a job per track per block costs little.
+const uint32_t BLOCK_FRAMES = 4096;
+
+//! Asks a loader for interleaved PCM in a given format
+class TargetOffline : public Target {
+  public:
+	TargetOffline( uint32_t sampleRate, uint16_t channelCount, uint16_t bitsPerSample, DataType dataType )
+	{
+		mSampleRate = sampleRate;
+		mChannelCount = channelCount;
+		mBitsPerSample = bitsPerSample;
+		mBlockAlign = channelCount * bitsPerSample / 8;
+		mDataType = dataType;
+		mIsInterleaved = true;
+		mIsPcm = true;
+		mIsBigEndian = false;
+	}
+};
+
+//! Writes blocks of the mix to the data chunk of a WAV file
+struct WavWriter {
+	WavWriter( OStreamRef stream, uint16_t channelCount, bool floatSamples ) : mStream( stream ), mChannelCount( channelCount ), mFloatSamples( floatSamples ) {}
+
+	void	write( const float *frames, uint32_t frameCount )
+	{
+		const size_t sampleCount = frameCount * mChannelCount;
+		if( mFloatSamples ) {
+			mStream->writeLittle( frames, sampleCount );
+		}
+		else {
+			mConverted.resize( sampleCount );
+			convertSamples( frames, &mConverted[0], sampleCount );
+			mStream->writeLittle( &mConverted[0], sampleCount );
+		}
+	}
+
+	OStreamRef				mStream;
+	uint16_t				mChannelCount;
+	bool					mFloatSamples;
+	std::vector<int16_t>	mConverted;
+};
+
+} // anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// OfflineRenderer::Track
+
+//! Streams one source, converted to the renderer's format, a block at a time
+class OfflineRenderer::Track {
+  public:
+	Track( SourceRef source, uint32_t sampleRate, uint16_t channelCount, float volume );
+
+	//! Fills getOutput() with the next \a frameCount frames, padded with silence once the source has ended. Runs on a job.
+	void			render( uint32_t frameCount );
+	const float*	getOutput() const { return &mOutput[0]; }
+	double			getDuration() const { return mSource->getDuration(); }
+
+	float			mVolume;
+
+  private:
+	//! Appends the next chunk of the source to mPending. Returns \c false once the source has ended and the resampler has been flushed.
+	bool			decode();
+
+	SourceRef						mSource;
+	std::shared_ptr<TargetOffline>	mTarget;
+	LoaderRef						mLoader;
+	ResamplerRef					mResampler;
+	uint16_t						mChannelCount;
+
+	std::vector<uint8_t>			mLoadBuffer;
+	std::vector<float>				mConvertBuffer, mMixBuffer, mResampleBuffer;
+	// converted frames not yet handed out, starting at mPendingStart
+	std::vector<float>				mPending;
+	size_t							mPendingStart;
+	// output frames of the resampler's delay still to be dropped
+	size_t							mDelayFrames;
+	bool							mEnded, mFlushed;
+	std::vector<float>				mOutput;
+};
+
+OfflineRenderer::Track::Track( SourceRef source, uint32_t sampleRate, uint16_t channelCount, float volume )
+	: mVolume( volume ), mSource( source ), mChannelCount( channelCount ), mPendingStart( 0 ), mDelayFrames( 0 ), mEnded( false ), mFlushed( false ),
+	mOutput( BLOCK_FRAMES * channelCount )
+{
+	// as Sample does, ask for the source's own format, which every loader can produce, and convert from there
+	switch( source->getDataType() ) {
+		case Io::INT16:
+		case Io::INT32:
+		case Io::FLOAT32:
+			mTarget.reset( new TargetOffline( source->getSampleRate(), source->getChannelCount(), source->getBitsPerSample(), source->getDataType() ) );
+		break;
+		case Io::DATA_UNKNOWN:
+			mTarget.reset( new TargetOffline( sampleRate, channelCount, 16, Io::INT16 ) );
+		break;
+		default:
+			throw IoExceptionUnsupportedDataType();
+	}
+	const uint32_t inputRate = mTarget->getSampleRate();
+	if( ( inputRate == 0 ) || ( mTarget->getChannelCount() == 0 ) || ( mTarget->getBlockAlign() == 0 ) ) {
+		throw IoExceptionUnsupportedDataType();
+	}
+
+	mLoader = source->createLoader( mTarget.get() );
+	if( ! mLoader ) {
+		throw IoExceptionFailedLoad();
+	}
+
+	if( inputRate != sampleRate ) {
+		mResampler = Resampler::create( inputRate, sampleRate, channelCount );
+		mDelayFrames = (size_t)( ( (uint64_t)mResampler->getLatency() * sampleRate + inputRate / 2 ) / inputRate );
+		mResampleBuffer.resize( mResampler->getMaxOutputFrames( BLOCK_FRAMES ) * channelCount );
+	}
+
+	mLoadBuffer.resize( BLOCK_FRAMES * mTarget->getBlockAlign() );
+	mConvertBuffer.resize( BLOCK_FRAMES * mTarget->getChannelCount() );
+	mMixBuffer.resize( BLOCK_FRAMES * channelCount );
+}
+
+void OfflineRenderer::Track::render( uint32_t frameCount )
+{
+	const size_t sampleCount = frameCount * mChannelCount;
+	size_t written = 0;
+	while( written < sampleCount ) {
+		if( mPendingStart == mPending.size() ) {
+			mPending.clear();
+			mPendingStart = 0;
+			if( ! decode() ) {
+				break;
+			}
+			continue;
+		}
+		size_t count = std::min( sampleCount - written, mPending.size() - mPendingStart );
+		std::copy( mPending.begin() + mPendingStart, mPending.begin() + mPendingStart + count, mOutput.begin() + written );
+		mPendingStart += count;
+		written += count;
+	}
+	std::fill( mOutput.begin() + written, mOutput.begin() + sampleCount, 0.0f );
+}
+
+bool OfflineRenderer::Track::decode()
+{
+	if( mFlushed ) {
+		return false;
+	}
+
+	const uint16_t inputChannels = mTarget->getChannelCount();
+	const uint32_t inputBlockAlign = mTarget->getBlockAlign();
+	uint32_t loadedFrames = 0;
+	if( ! mEnded ) {
+		BufferGeneric buffer;
+		buffer.mData = &mLoadBuffer[0];
+		buffer.mSampleCount = BLOCK_FRAMES;
+		buffer.mDataByteSize = BLOCK_FRAMES * inputBlockAlign;
+		buffer.mNumberChannels = inputChannels;
+		BufferList bufferList;
+		bufferList.mNumberBuffers = 1;
+		bufferList.mBuffers = &buffer;
+		mLoader->loadData( &bufferList );
+
+		// the loader may have pointed the buffer at its own memory rather than filling ours
+		loadedFrames = std::min( buffer.mDataByteSize / inputBlockAlign, buffer.mSampleCount );
+		const size_t sampleCount = loadedFrames * inputChannels;
+		float *converted = ( inputChannels == mChannelCount ) ? &mMixBuffer[0] : &mConvertBuffer[0];
+		switch( mTarget->getDataType() ) {
+			case Io::INT16: convertSamples( reinterpret_cast<const int16_t*>( buffer.mData ), converted, sampleCount ); break;
+			case Io::INT32: convertSamples( reinterpret_cast<const int32_t*>( buffer.mData ), converted, sampleCount ); break;
+			default: convertSamples( reinterpret_cast<const float*>( buffer.mData ), converted, sampleCount ); break;
+		}
+		if( inputChannels != mChannelCount ) {
+			mixChannels( converted, inputChannels, &mMixBuffer[0], mChannelCount, loadedFrames );
+		}
+		mEnded = ( loadedFrames == 0 );
+	}
+
+	if( loadedFrames == 0 ) {
+		if( ! mResampler ) {
+			mFlushed = true;
+			return false;
+		}
+		// push the filter's delay line through with silence, so that the end of the sound isn't lost
+		loadedFrames = std::min( mResampler->getLatency() * 2, BLOCK_FRAMES );
+		std::fill( mMixBuffer.begin(), mMixBuffer.begin() + loadedFrames * mChannelCount, 0.0f );
+		mFlushed = true;
+	}
+
+	if( mResampler ) {
+		size_t outFrames = mResampler->process( &mMixBuffer[0], loadedFrames, &mResampleBuffer[0], mResampleBuffer.size() / mChannelCount );
+		size_t skipFrames = std::min( mDelayFrames, outFrames );
+		mDelayFrames -= skipFrames;
+		mPending.insert( mPending.end(), mResampleBuffer.begin() + skipFrames * mChannelCount, mResampleBuffer.begin() + outFrames * mChannelCount );
+	}
+	else {
+		mPending.insert( mPending.end(), mMixBuffer.begin(), mMixBuffer.begin() + loadedFrames * mChannelCount );
+	}
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// OfflineRenderer::Analyzer
+
+//! Collects the mono mix into overlapping windows and hands the spectrum of each to a SpectrumFn
+struct OfflineRenderer::Analyzer {
+	Analyzer( const FftProcessorRef &fft, const SpectrumFn &spectrumFn, size_t hopSize, uint64_t firstFrame )
+		: mFft( fft ), mSpectrumFn( spectrumFn ), mHopSize( hopSize ), mWindow( fft->getBandCount() * 2 ), mMagnitudes( fft->getBandCount() ),
+		mFilled( 0 ), mSkip( 0 ), mWindowStart( firstFrame )
+	{}
+
+	void	process( const float *samples, size_t count )
+	{
+		const size_t windowSize = mWindow.size();
+		while( count > 0 ) {
+			// a hop longer than the window skips the samples between windows
+			if( mSkip > 0 ) {
+				size_t skipped = std::min( mSkip, count );
+				mSkip -= skipped;
+				samples += skipped;
+				count -= skipped;
+				continue;
+			}
+
+			size_t copied = std::min( windowSize - mFilled, count );
+			std::copy( samples, samples + copied, mWindow.begin() + mFilled );
+			mFilled += copied;
+			samples += copied;
+			count -= copied;
+			if( mFilled < windowSize ) {
+				break;
+			}
+
+			mFft->process( &mWindow[0], &mMagnitudes[0] );
+			mSpectrumFn( mWindowStart, &mMagnitudes[0] );
+			mWindowStart += mHopSize;
+			if( mHopSize < windowSize ) {
+				std::copy( mWindow.begin() + mHopSize, mWindow.end(), mWindow.begin() );
+				mFilled = windowSize - mHopSize;
+			}
+			else {
+				mFilled = 0;
+				mSkip = mHopSize - windowSize;
+			}
+		}
+	}
+
+	FftProcessorRef		mFft;
+	SpectrumFn			mSpectrumFn;
+	size_t				mHopSize;
+	std::vector<float>	mWindow, mMagnitudes;
+	size_t				mFilled, mSkip;
+	uint64_t			mWindowStart;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// OfflineRenderer
+
+OfflineRenderer::OfflineRenderer( uint32_t sampleRate, uint16_t channelCount )
+	: mSampleRate( sampleRate ), mChannelCount( channelCount ), mJobSystem( JobSystem::getDefault() ), mFrame( 0 ), mMix( BLOCK_FRAMES * channelCount )
+{
+}
+
+size_t OfflineRenderer::addTrack( SourceRef source, float volume )
+{
+	mTracks.push_back( std::shared_ptr<Track>( new Track( source, mSampleRate, mChannelCount, volume ) ) );
+	return mTracks.size() - 1;
+}
+
+void OfflineRenderer::setTrackVolume( size_t track, float volume )
+{
+	mTracks.at( track )->mVolume = volume;
+}
+
+float OfflineRenderer::getTrackVolume( size_t track ) const
+{
+	return mTracks.at( track )->mVolume;
+}
+
+void OfflineRenderer::addAnalyzer( const FftProcessorRef &fft, const SpectrumFn &spectrumFn, size_t hopSize )
+{
+	if( hopSize == 0 ) {
+		hopSize = fft->getBandCount();
+	}
+	mAnalyzers.push_back( std::shared_ptr<Analyzer>( new Analyzer( fft, spectrumFn, hopSize, mFrame ) ) );
+}
+
+uint64_t OfflineRenderer::getNumFrames( double seconds ) const
+{
+	if( seconds > 0 ) {
+		return (uint64_t)( seconds * mSampleRate + 0.5 );
+	}
+
+	uint64_t endFrame = 0;
+	for( size_t t = 0; t < mTracks.size(); ++t ) {
+		endFrame = std::max( endFrame, (uint64_t)( mTracks[t]->getDuration() * mSampleRate + 0.5 ) );
+	}
+	return ( endFrame > mFrame ) ? endFrame - mFrame : 0;
+}
+
+uint64_t OfflineRenderer::render( double seconds )
+{
+	return render( getNumFrames( seconds ), BlockFn() );
+}
+
+uint64_t OfflineRenderer::renderWav( DataTargetRef target, double seconds, bool floatSamples )
+{
+	const uint64_t frameCount = getNumFrames( seconds );
+	const uint16_t bitsPerSample = floatSamples ? 32 : 16;
+	const uint16_t blockAlign = mChannelCount * bitsPerSample / 8;
+	// float data needs the extended fmt chunk and a fact chunk
+	const uint32_t fmtSize = floatSamples ? 18 : 16;
+	const uint32_t headerSize = 4 + ( 8 + fmtSize ) + ( floatSamples ? 12 : 0 ) + 8;
+	const uint64_t dataSize = frameCount * blockAlign;
+	if( dataSize + headerSize > 0xFFFFFFFFULL ) {
+		throw OfflineRendererExceptionWavTooLong();
+	}
+
+	OStreamRef stream = target->getStream();
+	stream->writeData( "RIFF", 4 );
+	stream->writeLittle( (uint32_t)( headerSize + dataSize ) );
+	stream->writeData( "WAVE", 4 );
+	stream->writeData( "fmt ", 4 );
+	stream->writeLittle( fmtSize );
+	stream->writeLittle( (uint16_t)( floatSamples ? 3 : 1 ) ); // WAVE_FORMAT_IEEE_FLOAT or WAVE_FORMAT_PCM
+	stream->writeLittle( (uint16_t)mChannelCount );
+	stream->writeLittle( mSampleRate );
+	stream->writeLittle( (uint32_t)( mSampleRate * blockAlign ) );
+	stream->writeLittle( blockAlign );
+	stream->writeLittle( bitsPerSample );
+	if( floatSamples ) {
+		stream->writeLittle( (uint16_t)0 );
+		stream->writeData( "fact", 4 );
+		stream->writeLittle( (uint32_t)4 );
+		stream->writeLittle( (uint32_t)frameCount );
+	}
+	stream->writeData( "data", 4 );
+	stream->writeLittle( (uint32_t)dataSize );
+
+	WavWriter writer( stream, mChannelCount, floatSamples );
+	return render( frameCount, std::bind( &WavWriter::write, &writer, std::_1, std::_2 ) );
+}
+
+uint64_t OfflineRenderer::render( uint64_t frameCount, const BlockFn &writeFn )
+{
+	// each pass renders the next block of every track on the JobSystem while this thread hands the previous mix to the consumers,
+	// then mixes the new block once the tracks are done
+	std::vector<JobSystem::JobRef> jobs;
+	uint32_t mixedFrames = 0;
+	uint64_t renderedFrames = 0;
+	while( ( renderedFrames < frameCount ) || ( mixedFrames > 0 ) ) {
+		const uint32_t blockFrames = (uint32_t)std::min<uint64_t>( BLOCK_FRAMES, frameCount - renderedFrames );
+		jobs.clear();
+		if( mJobSystem && ( blockFrames > 0 ) ) {
+			for( size_t t = 0; t < mTracks.size(); ++t ) {
+				jobs.push_back( mJobSystem->add( std::bind( &Track::render, mTracks[t].get(), blockFrames ) ) );
+			}
+		}
+
+		if( mixedFrames > 0 ) {
+			consume( mixedFrames, writeFn );
+		}
+		mixedFrames = blockFrames;
+		if( blockFrames == 0 ) {
+			continue;
+		}
+
+		if( mJobSystem ) {
+			mJobSystem->wait( jobs );
+		}
+		else {
+			for( size_t t = 0; t < mTracks.size(); ++t ) {
+				mTracks[t]->render( blockFrames );
+			}
+		}
+
+		const size_t sampleCount = blockFrames * mChannelCount;
+		float *mix = &mMix[0];
+		std::fill( mix, mix + sampleCount, 0.0f );
+		for( size_t t = 0; t < mTracks.size(); ++t ) {
+			const float *output = mTracks[t]->getOutput();
+			const float volume = mTracks[t]->mVolume;
+			for( size_t i = 0; i < sampleCount; ++i ) {
+				mix[i] += output[i] * volume;
+			}
+		}
+		renderedFrames += blockFrames;
+	}
+
+	mFrame += frameCount;
+	return frameCount;
+}
+
+void OfflineRenderer::consume( uint32_t frameCount, const BlockFn &writeFn )
+{
+	const float *mix = &mMix[0];
+	if( writeFn ) {
+		writeFn( mix, frameCount );
+	}
+	if( mBlockFn ) {
+		mBlockFn( mix, frameCount );
+	}
+
+	if( ! mAnalyzers.empty() ) {
+		mMono.resize( frameCount );
+		const float scale = 1.0f / mChannelCount;
+		for( uint32_t f = 0; f < frameCount; ++f ) {
+			float sum = 0;
+			for( uint16_t c = 0; c < mChannelCount; ++c ) {
+				sum += mix[f * mChannelCount + c];
+			}
+			mMono[f] = sum * scale;
+		}
+		for( size_t a = 0; a < mAnalyzers.size(); ++a ) {
+			mAnalyzers[a]->process( &mMono[0], frameCount );
+		}
+	}
+}
+
+}} //namespace
@@ -27,21 +27,41 @@
 	typedef cinder::audio::OutputImplAudioUnit	OutputPlatformImpl;
 #elif defined( CINDER_MSW )
 	#include "cinder/audio/OutputImplXAudio.h"
+	#include "cinder/audio/OutputImplWasapi.h"
 	typedef cinder::audio::OutputImplXAudio	OutputPlatformImpl;
 #endif
 
 
 namespace cinder { namespace audio {
 
+namespace {
+
+Output::Backend	sBackend = Output::BACKEND_DEFAULT;
+uint32_t		sBackendBufferFrames = 256;
+
+} // anonymous namespace
+
 OutputImpl::OutputImpl()
 	: mNextTrackId( 0 )
 {}
 
+void Output::setBackend( Backend backend, uint32_t bufferFrames )
+{
+	sBackend = backend;
+	sBackendBufferFrames = bufferFrames;
+}
+
 OutputImpl* Output::instance()
 {
-	static std::shared_ptr<OutputPlatformImpl> sInst;
+	static std::shared_ptr<OutputImpl> sInst;
 	if( ! sInst ) {
-		sInst = std::shared_ptr<OutputPlatformImpl>( new OutputPlatformImpl() );
+#if defined( CINDER_MSW )
+		if( sBackend != BACKEND_DEFAULT ) {
+			sInst = std::shared_ptr<OutputImpl>( new OutputImplWasapi( sBackend == BACKEND_WASAPI_EXCLUSIVE, sBackendBufferFrames ) );
+			return sInst.get();
+		}
+#endif
+		sInst = std::shared_ptr<OutputImpl>( new OutputPlatformImpl() );
 	}
 	return sInst.get();
 }
@@ -53,6 +53,9 @@ OutputImplAudioUnit::Track::Track( SourceRef source, OutputImplAudioUnit * outpu
 	if( mInputBus < 0 ) throw OutOfTracksException();
 	mTarget = TargetOutputImplAudioUnit::createRef( output );
 	mLoader = source->createLoader( mTarget.get() );
+	
+	uint32_t bufferSampleCount = 1470; //TODO: make this settable, 1470 ~= 44100(samples/sec)/30(frmaes/second)
+	mPcmBuffers = std::shared_ptr<PcmBufferHandoff>( new PcmBufferHandoff( bufferSampleCount, mTarget->getChannelCount(), mTarget->isInterleaved() ) );
 }
 
 OutputImplAudioUnit::Track::~Track() 
@@ -147,8 +150,7 @@ void OutputImplAudioUnit::Track::setTime( double aTime )
 
 PcmBuffer32fRef OutputImplAudioUnit::Track::getPcmBuffer()
 {
-	boost::mutex::scoped_lock lock( mPcmBufferMutex );
-	return mLoadedPcmBuffer;
+	return mPcmBuffers->getLatest();
 }
 
 OSStatus OutputImplAudioUnit::Track::renderCallback( void * audioTrack, AudioUnitRenderActionFlags *ioActionFlags, const AudioTimeStamp *inTimeStamp, UInt32 inBusNumber, UInt32 inNumberFrames, AudioBufferList *ioData)
@@ -188,18 +190,16 @@ OSStatus OutputImplAudioUnit::Track::renderCallback( void * audioTrack, AudioUni
 		
 	}
 	
-	//add data to the PCM buffer if it's enabled
+	//add data to the PCM buffer if it's enabled, handing full blocks to the app without locking or allocating on the render thread
 	if( theTrack->mIsPcmBuffering ) {
-		if( ! theTrack->mLoadingPcmBuffer || ( theTrack->mLoadingPcmBuffer->getSampleCount() + ( ioData->mBuffers[0].mDataByteSize / sizeof(float) ) > theTrack->mLoadingPcmBuffer->getMaxSampleCount() ) ) {
-			boost::mutex::scoped_lock lock( theTrack->mPcmBufferMutex );
-			uint32_t bufferSampleCount = 1470; //TODO: make this settable, 1470 ~= 44100(samples/sec)/30(frmaes/second)
-			theTrack->mLoadedPcmBuffer = theTrack->mLoadingPcmBuffer;
-			theTrack->mLoadingPcmBuffer = PcmBuffer32fRef( new PcmBuffer32f( bufferSampleCount, theTrack->mTarget->getChannelCount(), theTrack->mTarget->isInterleaved() ) );
+		PcmBuffer32f &loadingBuffer = theTrack->mPcmBuffers->getLoadingBuffer();
+		if( loadingBuffer.getSampleCount() + ( ioData->mBuffers[0].mDataByteSize / sizeof(float) ) > loadingBuffer.getMaxSampleCount() ) {
+			theTrack->mPcmBuffers->publish();
 		}
 		
 		for( int i = 0; i < ioData->mNumberBuffers; i++ ) {
 			//TODO: implement channel map to better deal with channel locations
-			theTrack->mLoadingPcmBuffer->appendChannelData( reinterpret_cast<float *>( ioData->mBuffers[i].mData ), ioData->mBuffers[0].mDataByteSize / sizeof(float), static_cast<ChannelIdentifier>( i ) );
+			theTrack->mPcmBuffers->getLoadingBuffer().appendChannelData( reinterpret_cast<float *>( ioData->mBuffers[i].mData ), ioData->mBuffers[0].mDataByteSize / sizeof(float), static_cast<ChannelIdentifier>( i ) );
 		}
 	 }
 	
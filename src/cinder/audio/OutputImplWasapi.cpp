@@ -0,0 +1,436 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio/OutputImplWasapi.h"
+#include "cinder/audio/Convert.h"
+#include "cinder/Function.h"
+
+#include <avrt.h>
+#include <algorithm>
+#include <cstring>
+
+#pragma comment( lib, "avrt.lib" )
+
+namespace cinder { namespace audio {
+
+namespace {
+
+// KSDATAFORMAT_SUBTYPE_PCM and KSDATAFORMAT_SUBTYPE_IEEE_FLOAT, defined here rather than linking ksguid.lib
+const GUID	SUBTYPE_PCM = { 0x00000001, 0x0000, 0x0010, { 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 } };
+const GUID	SUBTYPE_IEEE_FLOAT = { 0x00000003, 0x0000, 0x0010, { 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 } };
+
+const REFERENCE_TIME	REFTIMES_PER_SEC = 10000000;
+
+bool isFloatFormat( const WAVEFORMATEX *format )
+{
+	if( format->wFormatTag == WAVE_FORMAT_IEEE_FLOAT )
+		return true;
+	return format->wFormatTag == WAVE_FORMAT_EXTENSIBLE && reinterpret_cast<const WAVEFORMATEXTENSIBLE*>( format )->SubFormat == SUBTYPE_IEEE_FLOAT;
+}
+
+} // anonymous namespace
+
+TargetOutputImplWasapi::TargetOutputImplWasapi( const WAVEFORMATEX *aOutDescription, bool isFloat )
+	: Target()
+{
+	mSampleRate = aOutDescription->nSamplesPerSec;
+	mChannelCount = aOutDescription->nChannels;
+	mBitsPerSample = aOutDescription->wBitsPerSample;
+	mBlockAlign = aOutDescription->nBlockAlign;
+	mIsInterleaved = true;
+	mIsPcm = true;
+	mIsBigEndian = false;
+	if( isFloat ) {
+		mDataType = FLOAT32;
+	} else if( mBitsPerSample == 32 ) {
+		mDataType = INT32;
+	} else if( mBitsPerSample == 16 ) {
+		mDataType = INT16;
+	} else {
+		mDataType = DATA_UNKNOWN;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// OutputImplWasapi::Track
+OutputImplWasapi::Track::Track( SourceRef source, OutputImplWasapi *output )
+	: cinder::audio::Track(), mOutput( output ), mSource( source ), mIsPlaying( false ), mIsLooping( false ), mVolume( 1 ), mIsPcmBuffering( false )
+{
+	mTrackId = mOutput->availableTrackId();
+	mOutputChannels = mOutput->getChannelCount();
+
+	// loaders on Windows produce their source's own format; compressed sources are decoded to 16-bit PCM at the device's rate and channel count
+	WAVEFORMATEX inputFormat;
+	if( source->getDataType() == Io::DATA_UNKNOWN ) {
+		inputFormat.wFormatTag = WAVE_FORMAT_PCM;
+		inputFormat.nSamplesPerSec = mOutput->getSampleRate();
+		inputFormat.nChannels = mOutputChannels;
+		inputFormat.wBitsPerSample = 16;
+	}
+	else {
+		inputFormat.wFormatTag = source->isFloat() ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM;
+		inputFormat.nSamplesPerSec = source->getSampleRate();
+		inputFormat.nChannels = source->getChannelCount();
+		inputFormat.wBitsPerSample = source->getBitsPerSample();
+	}
+	inputFormat.nBlockAlign = inputFormat.nChannels * inputFormat.wBitsPerSample / 8;
+	inputFormat.nAvgBytesPerSec = inputFormat.nBlockAlign * inputFormat.nSamplesPerSec;
+	inputFormat.cbSize = 0;
+
+	mTarget = TargetOutputImplWasapi::createRef( &inputFormat, inputFormat.wFormatTag == WAVE_FORMAT_IEEE_FLOAT );
+	mInputDataType = mTarget->getDataType();
+	if( mInputDataType == Io::DATA_UNKNOWN || inputFormat.nChannels == 0 ) {
+		throw IoExceptionUnsupportedDataType();
+	}
+	mLoader = mSource->createLoader( mTarget.get() );
+
+	mInputRate = inputFormat.nSamplesPerSec;
+	mInputChannels = inputFormat.nChannels;
+	mInputBlockAlign = inputFormat.nBlockAlign;
+
+	const uint32_t outputFrames = mOutput->getBufferFrames();
+	if( mInputRate != mOutput->getSampleRate() ) {
+		mResampler = Resampler::create( mInputRate, mOutput->getSampleRate(), mOutputChannels );
+	}
+	mMaxInputFrames = static_cast<uint32_t>( (uint64_t)outputFrames * mInputRate / mOutput->getSampleRate() ) + 2;
+
+	// everything the render thread needs is allocated here
+	mLoadBuffer.resize( mMaxInputFrames * mInputBlockAlign );
+	mConvertBuffer.resize( mMaxInputFrames * mInputChannels );
+	mInputBuffer.resize( mMaxInputFrames * mOutputChannels );
+	mOutputBuffer.resize( outputFrames * mOutputChannels );
+	mPcmBuffers = std::shared_ptr<PcmBufferHandoff>( new PcmBufferHandoff( std::max<uint32_t>( 2500, outputFrames ), mOutputChannels, true ) );
+}
+
+uint32_t OutputImplWasapi::Track::loadInput( uint32_t frameCount )
+{
+	frameCount = std::min( frameCount, mMaxInputFrames );
+
+	BufferGeneric buffer;
+	buffer.mData = &mLoadBuffer[0];
+	buffer.mDataByteSize = frameCount * mInputBlockAlign;
+	buffer.mNumberChannels = mInputChannels;
+	buffer.mSampleCount = frameCount;
+	BufferList bufferList;
+	bufferList.mNumberBuffers = 1;
+	bufferList.mBuffers = &buffer;
+	mLoader->loadData( &bufferList );
+
+	// the loader may have pointed the buffer at its own memory rather than filling ours
+	const uint32_t loadedFrames = std::min( buffer.mDataByteSize / mInputBlockAlign, frameCount );
+	const size_t sampleCount = loadedFrames * mInputChannels;
+	float *converted = ( mInputChannels == mOutputChannels ) ? &mInputBuffer[0] : &mConvertBuffer[0];
+	switch( mInputDataType ) {
+		case Io::INT16: convertSamples( reinterpret_cast<const int16_t*>( buffer.mData ), converted, sampleCount ); break;
+		case Io::INT32: convertSamples( reinterpret_cast<const int32_t*>( buffer.mData ), converted, sampleCount ); break;
+		default: convertSamples( reinterpret_cast<const float*>( buffer.mData ), converted, sampleCount ); break;
+	}
+	if( mInputChannels != mOutputChannels ) {
+		mixChannels( converted, mInputChannels, &mInputBuffer[0], mOutputChannels, loadedFrames );
+	}
+	return loadedFrames;
+}
+
+void OutputImplWasapi::Track::render( float *mix, uint32_t frameCount )
+{
+	if( ! mIsPlaying ) {
+		return;
+	}
+
+	uint32_t renderedFrames = 0;
+	bool rewound = false;
+	while( renderedFrames < frameCount ) {
+		const uint32_t neededFrames = frameCount - renderedFrames;
+		uint32_t inputFrames = neededFrames;
+		if( mResampler ) {
+			inputFrames = static_cast<uint32_t>( (uint64_t)neededFrames * mInputRate / mOutput->getSampleRate() ) + 1;
+		}
+
+		uint32_t loadedFrames = loadInput( inputFrames );
+		if( loadedFrames == 0 ) {
+			// rewind at most once per block, so that an empty source can't spin here
+			if( mIsLooping && ! rewound ) {
+				mLoader->setSampleOffset( 0 );
+				rewound = true;
+				continue;
+			}
+			mIsPlaying = false;
+			break;
+		}
+
+		float *output = &mOutputBuffer[renderedFrames * mOutputChannels];
+		if( mResampler ) {
+			renderedFrames += static_cast<uint32_t>( mResampler->process( &mInputBuffer[0], loadedFrames, output, neededFrames ) );
+		}
+		else {
+			memcpy( output, &mInputBuffer[0], loadedFrames * mOutputChannels * sizeof(float) );
+			renderedFrames += loadedFrames;
+		}
+	}
+
+	const float volume = mVolume;
+	const size_t sampleCount = renderedFrames * mOutputChannels;
+	for( size_t i = 0; i < sampleCount; ++i ) {
+		mOutputBuffer[i] *= volume;
+		mix[i] += mOutputBuffer[i];
+	}
+
+	if( mIsPcmBuffering && renderedFrames ) {
+		// blocks are handed to the app through mPcmBuffers, without locking or allocating on this thread
+		PcmBuffer32f &loadingBuffer = mPcmBuffers->getLoadingBuffer();
+		if( loadingBuffer.getSampleCount() + renderedFrames > loadingBuffer.getMaxSampleCount() ) {
+			mPcmBuffers->publish();
+		}
+		mPcmBuffers->getLoadingBuffer().appendInterleavedData( &mOutputBuffer[0], renderedFrames );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// OutputImplWasapi
+OutputImplWasapi::OutputImplWasapi( bool exclusive, uint32_t bufferFrames )
+	: OutputImpl(), mEvent( NULL ), mIsExclusive( false ), mIsFloat( true ), mBufferFrames( 0 ), mLatency( 0 ), mVolume( 1 ), mIsRunning( false )
+{
+	msw::initializeCom();
+
+	IMMDeviceEnumerator *enumerator = NULL;
+	if( FAILED( ::CoCreateInstance( __uuidof( MMDeviceEnumerator ), NULL, CLSCTX_ALL, __uuidof( IMMDeviceEnumerator ), (void**)&enumerator ) ) ) {
+		throw OutputException();
+	}
+	std::shared_ptr<IMMDeviceEnumerator> enumeratorPtr = msw::makeComShared( enumerator );
+
+	IMMDevice *device = NULL;
+	if( FAILED( enumerator->GetDefaultAudioEndpoint( eRender, eConsole, &device ) ) ) {
+		throw OutputException();
+	}
+	mDevice = msw::makeComShared( device );
+
+	openStream( exclusive, bufferFrames );
+
+	mMixBuffer.resize( mBufferFrames * mFormat.Format.nChannels );
+	mIsRunning = true;
+	mRenderThread = std::shared_ptr<std::thread>( new std::thread( std::bind( &OutputImplWasapi::renderThreadFn, this ) ) );
+}
+
+OutputImplWasapi::~OutputImplWasapi()
+{
+	if( mRenderThread ) {
+		mIsRunning = false;
+		::SetEvent( mEvent );
+		mRenderThread->join();
+	}
+	mRenderClient.reset();
+	mClient.reset();
+	if( mEvent ) {
+		::CloseHandle( mEvent );
+	}
+}
+
+bool OutputImplWasapi::findExclusiveFormat( const WAVEFORMATEX *mixFormat )
+{
+	// exclusive mode takes the device's own formats; try float first, as that needs no conversion, then 32 and 16-bit integers
+	const WORD bitDepths[] = { 32, 32, 16 };
+	for( int i = 0; i < 3; ++i ) {
+		WAVEFORMATEXTENSIBLE format;
+		memset( &format, 0, sizeof(format) );
+		format.Format.wFormatTag = WAVE_FORMAT_EXTENSIBLE;
+		format.Format.nChannels = mixFormat->nChannels;
+		format.Format.nSamplesPerSec = mixFormat->nSamplesPerSec;
+		format.Format.wBitsPerSample = bitDepths[i];
+		format.Format.nBlockAlign = format.Format.nChannels * format.Format.wBitsPerSample / 8;
+		format.Format.nAvgBytesPerSec = format.Format.nBlockAlign * format.Format.nSamplesPerSec;
+		format.Format.cbSize = sizeof(WAVEFORMATEXTENSIBLE) - sizeof(WAVEFORMATEX);
+		format.Samples.wValidBitsPerSample = format.Format.wBitsPerSample;
+		format.dwChannelMask = ( mixFormat->wFormatTag == WAVE_FORMAT_EXTENSIBLE ) ? reinterpret_cast<const WAVEFORMATEXTENSIBLE*>( mixFormat )->dwChannelMask : 0;
+		format.SubFormat = ( i == 0 ) ? SUBTYPE_IEEE_FLOAT : SUBTYPE_PCM;
+
+		if( mClient->IsFormatSupported( AUDCLNT_SHAREMODE_EXCLUSIVE, &format.Format, NULL ) == S_OK ) {
+			mFormat = format;
+			return true;
+		}
+	}
+	return false;
+}
+
+void OutputImplWasapi::openStream( bool exclusive, uint32_t bufferFrames )
+{
+	IAudioClient *client = NULL;
+	if( FAILED( mDevice->Activate( __uuidof( IAudioClient ), CLSCTX_ALL, NULL, (void**)&client ) ) ) {
+		throw OutputException();
+	}
+	mClient = msw::makeComShared( client );
+
+	WAVEFORMATEX *mixFormat = NULL;
+	if( FAILED( mClient->GetMixFormat( &mixFormat ) ) ) {
+		throw OutputException();
+	}
+	memset( &mFormat, 0, sizeof(mFormat) );
+	memcpy( &mFormat, mixFormat, std::min<size_t>( sizeof(WAVEFORMATEX) + mixFormat->cbSize, sizeof(mFormat) ) );
+	mIsExclusive = exclusive && findExclusiveFormat( mixFormat );
+	::CoTaskMemFree( mixFormat );
+	mIsFloat = isFloatFormat( &mFormat.Format );
+
+	REFERENCE_TIME defaultPeriod = 0, minPeriod = 0;
+	mClient->GetDevicePeriod( &defaultPeriod, &minPeriod );
+	const double sampleRate = mFormat.Format.nSamplesPerSec;
+	REFERENCE_TIME period = static_cast<REFERENCE_TIME>( REFTIMES_PER_SEC * bufferFrames / sampleRate + 0.5 );
+
+	HRESULT hr;
+	if( mIsExclusive ) {
+		period = std::max( period, minPeriod );
+		hr = mClient->Initialize( AUDCLNT_SHAREMODE_EXCLUSIVE, AUDCLNT_STREAMFLAGS_EVENTCALLBACK, period, period, &mFormat.Format, NULL );
+		if( hr == AUDCLNT_E_BUFFER_SIZE_NOT_ALIGNED ) {
+			// the device wants a period of a whole number of its own blocks; it reports the nearest, with which the client must be recreated
+			UINT32 alignedFrames = 0;
+			mClient->GetBufferSize( &alignedFrames );
+			period = static_cast<REFERENCE_TIME>( REFTIMES_PER_SEC * alignedFrames / sampleRate + 0.5 );
+			client = NULL;
+			if( FAILED( mDevice->Activate( __uuidof( IAudioClient ), CLSCTX_ALL, NULL, (void**)&client ) ) ) {
+				throw OutputException();
+			}
+			mClient = msw::makeComShared( client );
+			hr = mClient->Initialize( AUDCLNT_SHAREMODE_EXCLUSIVE, AUDCLNT_STREAMFLAGS_EVENTCALLBACK, period, period, &mFormat.Format, NULL );
+		}
+	}
+	else {
+		// in shared mode the engine runs at its own period, so this only sizes the buffer
+		period = std::max( period, defaultPeriod );
+		hr = mClient->Initialize( AUDCLNT_SHAREMODE_SHARED, AUDCLNT_STREAMFLAGS_EVENTCALLBACK, period, 0, &mFormat.Format, NULL );
+	}
+	if( FAILED( hr ) ) {
+		throw OutputException();
+	}
+
+	mEvent = ::CreateEvent( NULL, FALSE, FALSE, NULL );
+	UINT32 bufferSize = 0;
+	IAudioRenderClient *renderClient = NULL;
+	if( FAILED( mClient->SetEventHandle( mEvent ) ) || FAILED( mClient->GetBufferSize( &bufferSize ) )
+		|| FAILED( mClient->GetService( __uuidof( IAudioRenderClient ), (void**)&renderClient ) ) ) {
+		throw OutputException();
+	}
+	mRenderClient = msw::makeComShared( renderClient );
+	mBufferFrames = bufferSize;
+
+	REFERENCE_TIME streamLatency = 0;
+	mClient->GetStreamLatency( &streamLatency );
+	mLatency = streamLatency / (double)REFTIMES_PER_SEC + mBufferFrames / sampleRate;
+}
+
+TrackRef OutputImplWasapi::addTrack( SourceRef aSource, bool autoplay )
+{
+	std::shared_ptr<Track> track( new Track( aSource, this ) );
+	mTracks[track->getTrackId()] = track;
+	commitTracks();
+	if( autoplay ) {
+		track->play();
+	}
+	return track;
+}
+
+void OutputImplWasapi::removeTrack( TrackId trackId )
+{
+	if( mTracks.erase( trackId ) ) {
+		commitTracks();
+	}
+}
+
+void OutputImplWasapi::commitTracks()
+{
+	// back() is never the list the render thread is mixing, so tracks removed here stay alive until it has moved past them
+	TrackList &tracks = mRenderTracks.back();
+	tracks.clear();
+	for( std::map<TrackId,std::shared_ptr<Track> >::const_iterator trackIt = mTracks.begin(); trackIt != mTracks.end(); ++trackIt ) {
+		tracks.push_back( trackIt->second );
+	}
+	mRenderTracks.publish();
+}
+
+void OutputImplWasapi::renderThreadFn()
+{
+	ThreadSetup threadSetup;
+	msw::initializeCom( COINIT_MULTITHREADED );
+
+	DWORD taskIndex = 0;
+	HANDLE task = ::AvSetMmThreadCharacteristicsW( L"Pro Audio", &taskIndex );
+
+	// start from a buffer of silence, so the first period doesn't play garbage
+	BYTE *data = NULL;
+	if( SUCCEEDED( mRenderClient->GetBuffer( mBufferFrames, &data ) ) ) {
+		mRenderClient->ReleaseBuffer( mBufferFrames, AUDCLNT_BUFFERFLAGS_SILENT );
+	}
+	mClient->Start();
+
+	const uint16_t channelCount = mFormat.Format.nChannels;
+	while( mIsRunning ) {
+		::WaitForSingleObject( mEvent, 200 );
+		if( ! mIsRunning ) {
+			break;
+		}
+
+		// an exclusive stream swaps whole buffers each period, while a shared one takes whatever the engine has consumed
+		uint32_t frameCount = mBufferFrames;
+		if( ! mIsExclusive ) {
+			UINT32 padding = 0;
+			if( FAILED( mClient->GetCurrentPadding( &padding ) ) ) {
+				continue;
+			}
+			frameCount = mBufferFrames - padding;
+		}
+		if( frameCount == 0 || FAILED( mRenderClient->GetBuffer( frameCount, &data ) ) ) {
+			continue;
+		}
+
+		mRenderTracks.update();
+		const TrackList &tracks = mRenderTracks.front();
+		const size_t sampleCount = frameCount * channelCount;
+		std::fill( mMixBuffer.begin(), mMixBuffer.begin() + sampleCount, 0.0f );
+		for( TrackList::const_iterator trackIt = tracks.begin(); trackIt != tracks.end(); ++trackIt ) {
+			(*trackIt)->render( &mMixBuffer[0], frameCount );
+		}
+
+		const float volume = mVolume;
+		if( volume != 1 ) {
+			for( size_t i = 0; i < sampleCount; ++i )
+				mMixBuffer[i] *= volume;
+		}
+
+		if( mIsFloat ) {
+			convertSamples( &mMixBuffer[0], reinterpret_cast<float*>( data ), sampleCount );
+		}
+		else if( mFormat.Format.wBitsPerSample == 32 ) {
+			convertSamples( &mMixBuffer[0], reinterpret_cast<int32_t*>( data ), sampleCount );
+		}
+		else {
+			convertSamples( &mMixBuffer[0], reinterpret_cast<int16_t*>( data ), sampleCount );
+		}
+		mRenderClient->ReleaseBuffer( frameCount, 0 );
+	}
+
+	mClient->Stop();
+	if( task ) {
+		::AvRevertMmThreadCharacteristics( task );
+	}
+}
+
+}} //namespace
@@ -97,6 +97,11 @@ OutputImplXAudio::Track::Track( SourceRef source, OutputImplXAudio * output )
 	}
 	mSamplesPerBuffer = mBufferSize / mVoiceDescription.nBlockAlign;
 
+	//TODO: make this settable, and wrap data across buffers rather than growing them to a whole XAudio buffer
+	uint32_t pcmBufferSampleCount = std::max<uint32_t>( 2500, mSamplesPerBuffer );
+	mPcmBuffers = std::shared_ptr<PcmBufferHandoff>( new PcmBufferHandoff( pcmBufferSampleCount, mVoiceDescription.nChannels, true ) );
+	mPcmConversionBuffer.resize( mSamplesPerBuffer * mVoiceDescription.nChannels );
+
 	//create buffers
 	mDecodedBuffers = new uint8_t[ OutputImplXAudio::Track::sMaxBufferCount * mBufferSize ];
 	mCurrentBuffer = 0;
@@ -159,8 +164,7 @@ float OutputImplXAudio::Track::getVolume() const
 
 PcmBuffer32fRef OutputImplXAudio::Track::getPcmBuffer()
 {
-	boost::mutex::scoped_lock( mPcmBufferMutex );
-	return mLoadedPcmBuffer;
+	return mPcmBuffers->getLatest();
 }
 
 //HRESULT OutputImplXAudio::Track::dataInputCallback( void * audioData, uint32_t dataSize, void * track, uint64_t sampleTime, uint32_t sampleDuration )
@@ -205,28 +209,21 @@ void OutputImplXAudio::Track::fillBuffer()
 		}
 
 		if( mIsPcmBuffering ) {
-			uint32_t sampleCount = buffer.mDataByteSize / mVoiceDescription.nBlockAlign;
-			if( ! mLoadingPcmBuffer || ( mLoadingPcmBuffer->getSampleCount() + sampleCount > mLoadingPcmBuffer->getMaxSampleCount() ) ) {
-				boost::mutex::scoped_lock lock( mPcmBufferMutex );
-				//TODO: make this settable, 1470 ~= 44100(samples/sec)/30(frmaes/second), also make sure the buffer isn't going to be larger than this? perhaps wrap data across buffers?
-				uint32_t bufferSampleCount = 2500;
-				if( mLoadingPcmBuffer ) {
-					mLoadedPcmBuffer = PcmBuffer32fRef();
-					mLoadedPcmBuffer = mLoadingPcmBuffer;
-				}
-				mLoadingPcmBuffer = PcmBuffer32fRef( new PcmBuffer32f( bufferSampleCount, mVoiceDescription.nChannels, true ) );
+			// blocks are handed to the app through mPcmBuffers, without locking or allocating on this thread
+			uint32_t sampleCount = std::min<uint32_t>( buffer.mDataByteSize / mVoiceDescription.nBlockAlign, mSamplesPerBuffer );
+			if( mPcmBuffers->getLoadingBuffer().getSampleCount() + sampleCount > mPcmBuffers->getLoadingBuffer().getMaxSampleCount() ) {
+				mPcmBuffers->publish();
 			}
 
-			//TODO: only do this if Voice is not Float and make this more efficient
+			//TODO: only do this if Voice is not Float
 			//TODO: right now this only supports uint16_t
-			float * copyBuffer = new float[sampleCount * buffer.mNumberChannels];
+			float * copyBuffer = &mPcmConversionBuffer[0];
 			int16_t * srcBuffer = reinterpret_cast<int16_t *>( buffer.mData );
 			for( uint32_t i = 0; i < ( sampleCount * buffer.mNumberChannels ); i++ ) {
 				//TODO: abstract this conversion
 				copyBuffer[i] = ( ( srcBuffer[i] / 32767.0f ) + 1.0f ) * 0.5f;
 			}
-			mLoadingPcmBuffer->appendInterleavedData( copyBuffer, sampleCount );
-			delete [] copyBuffer;
+			mPcmBuffers->getLoadingBuffer().appendInterleavedData( copyBuffer, sampleCount );
 		}
 		
 		mCurrentBuffer++;
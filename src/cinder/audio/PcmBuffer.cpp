@@ -21,6 +21,9 @@
 */
 
 #include "cinder/audio/PcmBuffer.h"
+#include "cinder/LockFreeCircularBuffer.h"
+
+#include <algorithm>
 
 namespace cinder { namespace audio {
 
@@ -82,7 +85,7 @@ BOOST_PP_SEQ_FOR_EACH( CREATE_BUFFERLIST_PROTOTYPES, ~, AUDIO_DATA_TYPES )
 
 template<typename T>
 PcmBufferT<T>::PcmBufferT( uint32_t aMaxSampleCount, uint16_t aChannelCount, bool isInterleaved ) 
-	: mMaxSampleCount( aMaxSampleCount ), mChannelCount( aChannelCount ), mIsInterleaved( isInterleaved )
+	: mMaxSampleCount( aMaxSampleCount ), mChannelCount( aChannelCount ), mIsInterleaved( isInterleaved ), mTrackedMemory( MemoryTracker::AUDIO )
 {
 	uint32_t bufferSize = 0;
 	uint16_t channelsPerBuffer = 0;
@@ -107,6 +110,7 @@ PcmBufferT<T>::PcmBufferT( uint32_t aMaxSampleCount, uint16_t aChannelCount, boo
 		buffer->mSampleCount = 0;
 		mBufferSampleCounts[i] = 0;
 	}
+	mTrackedMemory.set( mBufferCount * bufferSize * sizeof(T) );
 }
 
 template<typename T>
@@ -199,9 +203,190 @@ void PcmBufferT<T>::appendChannelData( T * aData, uint32_t aSampleCount, Channel
 	}
 }
 
+template<typename T>
+void PcmBufferT<T>::clear()
+{
+	for( uint16_t i = 0; i < mBufferCount; i++ ) {
+		mBuffers[i]->mSampleCount = 0;
+		mBufferSampleCounts[i] = 0;
+	}
+}
+
+template<typename T>
+void PcmBufferT<T>::copyFrom( const PcmBufferT<T> &source )
+{
+	if( ( source.mMaxSampleCount != mMaxSampleCount ) || ( source.mChannelCount != mChannelCount ) || ( source.mIsInterleaved != mIsInterleaved ) ) {
+		throw OutOfRangePcmBufferException();
+	}
+	
+	for( uint16_t i = 0; i < mBufferCount; i++ ) {
+		memcpy( mBuffers[i]->mData, source.mBuffers[i]->mData, mBuffers[i]->mDataByteSize );
+		mBuffers[i]->mSampleCount = source.mBuffers[i]->mSampleCount;
+		mBufferSampleCounts[i] = source.mBufferSampleCounts[i];
+	}
+}
+
 #define PCM_BUFFER_PROTOTYPES(r,data,T)\
 	template class PcmBufferT<T>;\
 
 BOOST_PP_SEQ_FOR_EACH( PCM_BUFFER_PROTOTYPES, ~, AUDIO_DATA_TYPES )
 
+PcmBufferHandoff::PcmBufferHandoff( uint32_t aMaxSampleCount, uint16_t aChannelCount, bool isInterleaved )
+{
+	// all three buffers are allocated up front, so that the audio thread never allocates. Each is put in place as back(), and then rotated out of the way.
+	mBuffers.back() = PcmBuffer32fRef( new PcmBuffer32f( aMaxSampleCount, aChannelCount, isInterleaved ) );
+	mBuffers.publish();
+	mBuffers.update();
+	mBuffers.back() = PcmBuffer32fRef( new PcmBuffer32f( aMaxSampleCount, aChannelCount, isInterleaved ) );
+	mBuffers.publish();
+	mBuffers.back() = PcmBuffer32fRef( new PcmBuffer32f( aMaxSampleCount, aChannelCount, isInterleaved ) );
+	mBuffers.update();
+}
+
+void PcmBufferHandoff::publish()
+{
+	mBuffers.publish();
+	mBuffers.back()->clear();
+}
+
+PcmBuffer32fRef PcmBufferHandoff::getLatest()
+{
+	if( mBuffers.update() ) {
+		const PcmBuffer32f &latest = *mBuffers.front();
+		mLatest = PcmBuffer32fRef( new PcmBuffer32f( latest.getMaxSampleCount(), latest.getChannelCount(), latest.isInterleaved() ) );
+		mLatest->copyFrom( latest );
+	}
+	return mLatest;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+// PcmCaptureRing
+
+PcmCaptureRing::PcmCaptureRing( uint32_t aFrameCapacity, uint16_t aChannelCount )
+	: mCapacity( detail::lockFreeCapacity( aFrameCapacity ) ), mChannelCount( aChannelCount ), mSequence( 0 ), mPositionLow( 0 ), mPositionHigh( 0 ), mPending( 0 )
+{
+	mMask = mCapacity - 1;
+	mData.resize( (size_t)mCapacity * mChannelCount, 0.0f );
+}
+
+void PcmCaptureRing::beginPositionUpdate()
+{
+	detail::lockFreeStoreRelease( &mSequence, mSequence + 1 );
+}
+
+void PcmCaptureRing::endPositionUpdate()
+{
+	detail::lockFreeStoreRelease( &mSequence, mSequence + 1 );
+}
+
+void PcmCaptureRing::readPosition( uint64_t *position, uint32_t *pending ) const
+{
+	int numSpins = 0;
+	while( true ) {
+		uint32_t sequence = detail::lockFreeLoadAcquire( &mSequence );
+		if( ( sequence & 1 ) == 0 ) {
+			uint32_t high = mPositionHigh;
+			uint32_t low = mPositionLow;
+			uint32_t pend = mPending;
+			detail::lockFreeFence();
+			if( detail::lockFreeLoadAcquire( &mSequence ) == sequence ) {
+				*position = ( (uint64_t)high << 32 ) | low;
+				*pending = pend;
+				return;
+			}
+		}
+		detail::lockFreeBackoff( &numSpins );
+	}
+}
+
+uint64_t PcmCaptureRing::getWritePosition() const
+{
+	uint64_t position;
+	uint32_t pending;
+	readPosition( &position, &pending );
+	return position;
+}
+
+void PcmCaptureRing::write( const float * const *channels, uint32_t frameCount )
+{
+	// only the writer changes the position, so it can read it without the lock
+	uint64_t position = ( (uint64_t)mPositionHigh << 32 ) | mPositionLow;
+	uint32_t skip = 0;
+	if( frameCount > mCapacity ) { // only the newest frames of an oversized write survive
+		skip = frameCount - mCapacity;
+		frameCount = mCapacity;
+		position += skip;
+	}
+
+	// announce the frames about to be overwritten before touching them
+	beginPositionUpdate();
+	mPositionHigh = (uint32_t)( position >> 32 );
+	mPositionLow = (uint32_t)position;
+	mPending = frameCount;
+	endPositionUpdate();
+
+	uint32_t start = (uint32_t)position & mMask;
+	uint32_t firstPart = std::min( frameCount, mCapacity - start );
+	for( uint16_t c = 0; c < mChannelCount; c++ ) {
+		float *ring = &mData[0] + (size_t)c * mCapacity;
+		const float *source = channels[c] + skip;
+		memcpy( ring + start, source, firstPart * sizeof(float) );
+		memcpy( ring, source + firstPart, ( frameCount - firstPart ) * sizeof(float) );
+	}
+
+	position += frameCount;
+	beginPositionUpdate();
+	mPositionHigh = (uint32_t)( position >> 32 );
+	mPositionLow = (uint32_t)position;
+	mPending = 0;
+	endPositionUpdate();
+}
+
+uint32_t PcmCaptureRing::read( uint64_t *ioFrame, PcmBuffer32f *buffer, uint32_t *outDroppedFrames ) const
+{
+	if( buffer->isInterleaved() ) {
+		throw InvalidChannelPcmBufferException();
+	}
+
+	const uint16_t channelCount = std::min( mChannelCount, buffer->getChannelCount() );
+	uint32_t dropped = 0, frameCount = 0;
+	while( true ) {
+		uint64_t position;
+		uint32_t pending;
+		readPosition( &position, &pending );
+
+		// a reader that fell behind restarts a little ahead of the oldest frame, so that it isn't overtaken again while copying
+		uint64_t start = *ioFrame;
+		uint64_t oldest = ( position + pending > mCapacity ) ? position + pending - mCapacity : 0;
+		if( start < oldest )
+			start = std::min( oldest + mCapacity / 8, position );
+		else if( start > position )
+			start = position;
+		frameCount = (uint32_t)std::min<uint64_t>( position - start, buffer->getMaxSampleCount() );
+
+		buffer->clear();
+		uint32_t offset = (uint32_t)start & mMask;
+		uint32_t firstPart = std::min( frameCount, mCapacity - offset );
+		for( uint16_t c = 0; c < channelCount; c++ ) {
+			float *ring = const_cast<float*>( &mData[0] ) + (size_t)c * mCapacity;
+			buffer->appendChannelData( ring + offset, firstPart, static_cast<ChannelIdentifier>( c ) );
+			buffer->appendChannelData( ring, frameCount - firstPart, static_cast<ChannelIdentifier>( c ) );
+		}
+
+		// the copy is only good if the writer didn't reach the frames meanwhile
+		readPosition( &position, &pending );
+		oldest = ( position + pending > mCapacity ) ? position + pending - mCapacity : 0;
+		if( start >= oldest ) {
+			if( start > *ioFrame )
+				dropped = (uint32_t)std::min<uint64_t>( start - *ioFrame, 0xFFFFFFFFu );
+			*ioFrame = start + frameCount;
+			break;
+		}
+	}
+
+	if( outDroppedFrames )
+		*outDroppedFrames = dropped;
+	return frameCount;
+}
+
 }} //namespace
\ No newline at end of file
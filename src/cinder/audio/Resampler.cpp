@@ -0,0 +1,190 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio/Resampler.h"
+#include "cinder/audio/Convert.h"
+#include "cinder/ip/Simd.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#endif
+
+namespace cinder { namespace audio {
+
+namespace {
+
+const uint32_t	MAX_PHASES = 2048;
+// Kaiser window shape; 8 gives roughly 80dB of stopband attenuation
+const double	KAISER_BETA = 8.0;
+// cutoff as a fraction of the lower Nyquist frequency, leaving room for the transition band
+const double	CUTOFF = 0.9;
+
+uint32_t gcd( uint32_t a, uint32_t b )
+{
+	while( b ) {
+		uint32_t t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+// zeroth order modified Bessel function of the first kind
+double besselI0( double x )
+{
+	double sum = 1, term = 1;
+	for( int k = 1; k < 32; ++k ) {
+		term *= ( x / ( 2 * k ) ) * ( x / ( 2 * k ) );
+		sum += term;
+	}
+	return sum;
+}
+
+float dotProduct( const float *a, const float *b, uint32_t count, bool useSse2 )
+{
+	uint32_t i = 0;
+	float result = 0;
+#if defined( CINDER_IP_SSE2 )
+	if( useSse2 ) {
+		__m128 sum = _mm_setzero_ps();
+		for( ; i + 4 <= count; i += 4 )
+			sum = _mm_add_ps( sum, _mm_mul_ps( _mm_loadu_ps( a + i ), _mm_loadu_ps( b + i ) ) );
+		sum = _mm_add_ps( sum, _mm_movehl_ps( sum, sum ) );
+		sum = _mm_add_ss( sum, _mm_shuffle_ps( sum, sum, 1 ) );
+		result = _mm_cvtss_f32( sum );
+	}
+#endif
+	for( ; i < count; ++i )
+		result += a[i] * b[i];
+	return result;
+}
+
+} // anonymous namespace
+
+Resampler::Resampler( uint32_t inputRate, uint32_t outputRate, uint16_t channelCount, uint32_t tapsPerPhase )
+	: mInputRate( inputRate ), mOutputRate( outputRate ), mChannelCount( std::max<uint16_t>( channelCount, 1 ) ), mUseSse2( ip::useSse2() )
+{
+	mTaps = ( std::max<uint32_t>( tapsPerPhase, 4 ) + 3 ) & ~3;
+
+	uint32_t divisor = gcd( std::max<uint32_t>( inputRate, 1 ), std::max<uint32_t>( outputRate, 1 ) );
+	mUpFactor = std::max<uint32_t>( outputRate, 1 ) / divisor;
+	mDownFactor = std::max<uint32_t>( inputRate, 1 ) / divisor;
+	if( mUpFactor > MAX_PHASES ) {
+		mDownFactor = std::max<uint32_t>( static_cast<uint32_t>( (double)mDownFactor * MAX_PHASES / mUpFactor + 0.5 ), 1 );
+		mUpFactor = MAX_PHASES;
+	}
+
+	// windowed-sinc lowpass at the upsampled rate, cutting off below the lower of the two Nyquist frequencies
+	const uint32_t length = mUpFactor * mTaps;
+	const double cutoff = CUTOFF * 0.5 / std::max( mUpFactor, mDownFactor );
+	const double center = ( length - 1 ) * 0.5;
+	const double windowScale = 1 / besselI0( KAISER_BETA );
+	std::vector<double> prototype( length );
+	double sum = 0;
+	for( uint32_t n = 0; n < length; ++n ) {
+		double x = n - center;
+		double sinc = ( x == 0 ) ? 1 : sin( 2 * M_PI * cutoff * x ) / ( 2 * M_PI * cutoff * x );
+		double r = x / ( center + 1 );
+		prototype[n] = 2 * cutoff * sinc * besselI0( KAISER_BETA * sqrt( std::max( 0.0, 1 - r * r ) ) ) * windowScale;
+		sum += prototype[n];
+	}
+
+	// split into phases, normalized so each averages to unity gain, and reversed so each lines up with the input oldest first
+	const double gain = mUpFactor / sum;
+	mCoefficients.resize( length );
+	for( uint32_t phase = 0; phase < mUpFactor; ++phase )
+		for( uint32_t k = 0; k < mTaps; ++k )
+			mCoefficients[phase * mTaps + ( mTaps - 1 - k )] = static_cast<float>( prototype[phase + k * mUpFactor] * gain );
+
+	mInput.resize( mChannelCount );
+	reset();
+}
+
+void Resampler::reset()
+{
+	mInputFrames = mTaps - 1;
+	mPosition = mTaps - 1;
+	mPhase = 0;
+	for( uint16_t c = 0; c < mChannelCount; ++c ) {
+		if( mInput[c].size() < mInputFrames )
+			mInput[c].resize( mInputFrames );
+		std::fill( mInput[c].begin(), mInput[c].begin() + mInputFrames, 0.0f );
+	}
+}
+
+size_t Resampler::getMaxOutputFrames( size_t inputFrameCount ) const
+{
+	return static_cast<size_t>( ( (uint64_t)( mInputFrames + inputFrameCount ) * mUpFactor ) / mDownFactor ) + 1;
+}
+
+size_t Resampler::process( const float *input, size_t inputFrameCount, float *output, size_t maxOutputFrames )
+{
+	// append the input, split into channels; the buffers only grow until they fit the largest block
+	if( mInput[0].size() < mInputFrames + inputFrameCount ) {
+		for( uint16_t c = 0; c < mChannelCount; ++c )
+			mInput[c].resize( mInputFrames + inputFrameCount );
+	}
+	if( mChannelCount <= 64 ) {
+		float *channels[64];
+		for( uint16_t c = 0; c < mChannelCount; ++c )
+			channels[c] = &mInput[c][mInputFrames];
+		deinterleave( input, mChannelCount, inputFrameCount, channels );
+	}
+	else {
+		for( uint16_t c = 0; c < mChannelCount; ++c )
+			for( size_t i = 0; i < inputFrameCount; ++i )
+				mInput[c][mInputFrames + i] = input[i * mChannelCount + c];
+	}
+	mInputFrames += inputFrameCount;
+
+	size_t outputFrames = 0;
+	while( outputFrames < maxOutputFrames && mPosition < mInputFrames ) {
+		const float *coefficients = &mCoefficients[mPhase * mTaps];
+		for( uint16_t c = 0; c < mChannelCount; ++c )
+			output[outputFrames * mChannelCount + c] = dotProduct( coefficients, &mInput[c][mPosition + 1 - mTaps], mTaps, mUseSse2 );
+		++outputFrames;
+
+		mPhase += mDownFactor;
+		mPosition += mPhase / mUpFactor;
+		mPhase %= mUpFactor;
+	}
+
+	// drop the input which no future output reaches
+	size_t dropCount = std::min( mPosition + 1 - mTaps, mInputFrames );
+	if( dropCount ) {
+		for( uint16_t c = 0; c < mChannelCount; ++c )
+			memmove( &mInput[c][0], &mInput[c][0] + dropCount, ( mInputFrames - dropCount ) * sizeof(float) );
+		mInputFrames -= dropCount;
+		mPosition -= dropCount;
+	}
+
+	return outputFrames;
+}
+
+}} //namespace
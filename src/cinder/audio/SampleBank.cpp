@@ -0,0 +1,338 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio/SampleBank.h"
+#include "cinder/audio/Callback.h"
+#include "cinder/audio/Convert.h"
+#include "cinder/audio/Resampler.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cinder { namespace audio {
+
+namespace {
+
+// the number of frames decoded or mixed at a time
+const uint32_t CHUNK_FRAMES = 1024;
+
+//! Asks a loader for interleaved PCM in a given format
+class TargetSample : public Target {
+  public:
+	TargetSample( uint32_t sampleRate, uint16_t channelCount, uint16_t bitsPerSample, DataType dataType )
+	{
+		mSampleRate = sampleRate;
+		mChannelCount = channelCount;
+		mBitsPerSample = bitsPerSample;
+		mBlockAlign = channelCount * bitsPerSample / 8;
+		mDataType = dataType;
+		mIsInterleaved = true;
+		mIsPcm = true;
+		mIsBigEndian = false;
+	}
+};
+
+} // anonymous namespace
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Sample
+
+SampleRef Sample::create( SourceRef source, uint32_t sampleRate, uint16_t channelCount, double maxSeconds )
+{
+	return SampleRef( new Sample( source, sampleRate, channelCount, maxSeconds ) );
+}
+
+Sample::Sample( SourceRef source, uint32_t sampleRate, uint16_t channelCount, double maxSeconds )
+	: mSampleRate( sampleRate ), mChannelCount( channelCount ), mNumFrames( 0 )
+{
+	// ask for the source's own format, which every loader can produce, and convert from there.
+	// Compressed sources are decoded to 16-bit PCM in the sample's format, as the output backends do.
+	std::shared_ptr<TargetSample> target;
+	switch( source->getDataType() ) {
+		case Io::INT16:
+		case Io::INT32:
+		case Io::FLOAT32:
+			target.reset( new TargetSample( source->getSampleRate(), source->getChannelCount(), source->getBitsPerSample(), source->getDataType() ) );
+		break;
+		case Io::DATA_UNKNOWN:
+			target.reset( new TargetSample( sampleRate, channelCount, 16, Io::INT16 ) );
+		break;
+		default:
+			throw IoExceptionUnsupportedDataType();
+	}
+	const uint32_t inputRate = target->getSampleRate();
+	const uint16_t inputChannels = target->getChannelCount();
+	const uint32_t inputBlockAlign = target->getBlockAlign();
+	if( ( inputRate == 0 ) || ( inputChannels == 0 ) || ( inputBlockAlign == 0 ) ) {
+		throw IoExceptionUnsupportedDataType();
+	}
+
+	LoaderRef loader = source->createLoader( target.get() );
+	if( ! loader ) {
+		throw IoExceptionFailedLoad();
+	}
+
+	ResamplerRef resampler;
+	if( inputRate != sampleRate ) {
+		resampler = Resampler::create( inputRate, sampleRate, channelCount );
+	}
+
+	const uint64_t maxInputFrames = (uint64_t)( maxSeconds * inputRate );
+	const double duration = std::min( source->getDuration(), maxSeconds );
+	if( duration > 0 ) {
+		mData.reserve( (size_t)( duration * sampleRate + CHUNK_FRAMES ) * channelCount );
+	}
+
+	std::vector<uint8_t> loadBuffer( CHUNK_FRAMES * inputBlockAlign );
+	std::vector<float> convertBuffer( CHUNK_FRAMES * inputChannels );
+	std::vector<float> mixBuffer( CHUNK_FRAMES * channelCount );
+	std::vector<float> resampleBuffer( resampler ? resampler->getMaxOutputFrames( CHUNK_FRAMES ) * channelCount : 0 );
+
+	uint64_t inputFrames = 0;
+	bool flushed = ! resampler;
+	while( true ) {
+		uint32_t loadedFrames = 0;
+		if( inputFrames < maxInputFrames ) {
+			BufferGeneric buffer;
+			buffer.mData = &loadBuffer[0];
+			buffer.mSampleCount = (uint32_t)std::min<uint64_t>( CHUNK_FRAMES, maxInputFrames - inputFrames );
+			buffer.mDataByteSize = buffer.mSampleCount * inputBlockAlign;
+			buffer.mNumberChannels = inputChannels;
+			BufferList bufferList;
+			bufferList.mNumberBuffers = 1;
+			bufferList.mBuffers = &buffer;
+			loader->loadData( &bufferList );
+
+			// the loader may have pointed the buffer at its own memory rather than filling ours
+			loadedFrames = std::min( buffer.mDataByteSize / inputBlockAlign, buffer.mSampleCount );
+			const size_t sampleCount = loadedFrames * inputChannels;
+			float *converted = ( inputChannels == channelCount ) ? &mixBuffer[0] : &convertBuffer[0];
+			switch( target->getDataType() ) {
+				case Io::INT16: convertSamples( reinterpret_cast<const int16_t*>( buffer.mData ), converted, sampleCount ); break;
+				case Io::INT32: convertSamples( reinterpret_cast<const int32_t*>( buffer.mData ), converted, sampleCount ); break;
+				default: convertSamples( reinterpret_cast<const float*>( buffer.mData ), converted, sampleCount ); break;
+			}
+			if( inputChannels != channelCount ) {
+				mixChannels( converted, inputChannels, &mixBuffer[0], channelCount, loadedFrames );
+			}
+			inputFrames += loadedFrames;
+		}
+
+		if( loadedFrames == 0 ) {
+			if( flushed ) {
+				break;
+			}
+			// push the filter's delay line through with silence, so that the end of the sound isn't lost
+			loadedFrames = std::min( resampler->getLatency() * 2, CHUNK_FRAMES );
+			std::fill( mixBuffer.begin(), mixBuffer.begin() + loadedFrames * channelCount, 0.0f );
+			flushed = true;
+		}
+
+		if( resampler ) {
+			size_t outFrames = resampler->process( &mixBuffer[0], loadedFrames, &resampleBuffer[0], resampleBuffer.size() / channelCount );
+			mData.insert( mData.end(), resampleBuffer.begin(), resampleBuffer.begin() + outFrames * channelCount );
+		}
+		else {
+			mData.insert( mData.end(), mixBuffer.begin(), mixBuffer.begin() + loadedFrames * channelCount );
+		}
+	}
+
+	if( resampler ) {
+		// drop the filter's delay, to the nearest frame, from the front, and cut the flushed tail back to the length of the input
+		size_t delayFrames = std::min( (size_t)( ( (uint64_t)resampler->getLatency() * sampleRate + inputRate / 2 ) / inputRate ), mData.size() / channelCount );
+		mData.erase( mData.begin(), mData.begin() + delayFrames * channelCount );
+		size_t expectedFrames = (size_t)( ( inputFrames * sampleRate + inputRate - 1 ) / inputRate );
+		if( mData.size() > expectedFrames * channelCount ) {
+			mData.resize( expectedFrames * channelCount );
+		}
+	}
+	mNumFrames = (uint32_t)( mData.size() / channelCount );
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////
+// SampleBank
+
+SampleBankRef SampleBank::create( uint32_t sampleRate, uint16_t channelCount, size_t maxVoices )
+{
+	return SampleBankRef( new SampleBank( sampleRate, channelCount, maxVoices ) );
+}
+
+SampleBank::SampleBank( uint32_t sampleRate, uint16_t channelCount, size_t maxVoices )
+	: mSampleRate( sampleRate ), mChannelCount( channelCount ), mNextVoiceId( 1 ), mCommands( std::max<size_t>( 64, maxVoices * 4 ) ),
+	mVoices( std::max<size_t>( 1, maxVoices ) ), mNumVoices( 0 ), mMixBuffer( CHUNK_FRAMES * channelCount ), mNumActiveVoices( 0 ), mNumStolenVoices( 0 )
+{
+	mSource = createCallback( this, &SampleBank::render, false, sampleRate, channelCount );
+}
+
+SampleRef SampleBank::load( SourceRef source, double maxSeconds )
+{
+	SampleRef sample = Sample::create( source, mSampleRate, mChannelCount, maxSeconds );
+	mSamples.push_back( sample );
+	return sample;
+}
+
+VoiceId SampleBank::play( const SampleRef &sample, float volume, float pan )
+{
+	if( ( sample->getSampleRate() != mSampleRate ) || ( sample->getChannelCount() != mChannelCount ) ) {
+		throw SampleBankExceptionFormat();
+	}
+	// the audio thread only sees a raw pointer, so the bank holds the reference
+	if( std::find( mSamples.begin(), mSamples.end(), sample ) == mSamples.end() ) {
+		mSamples.push_back( sample );
+	}
+
+	Command command;
+	command.mType = Command::PLAY;
+	command.mVoice = mNextVoiceId;
+	command.mSample = sample.get();
+	if( mChannelCount == 2 ) {
+		// equal-power pan, which leaves a centered voice at 1/sqrt(2) on each side
+		float angle = ( std::max( -1.0f, std::min( pan, 1.0f ) ) + 1.0f ) * 0.25f * 3.14159265f;
+		command.mGains[0] = volume * std::cos( angle );
+		command.mGains[1] = volume * std::sin( angle );
+	}
+	else {
+		command.mGains[0] = command.mGains[1] = volume;
+	}
+	if( ! mCommands.tryPush( command ) ) {
+		return 0;
+	}
+
+	VoiceId voice = mNextVoiceId++;
+	if( mNextVoiceId == 0 ) {
+		mNextVoiceId = 1;
+	}
+	return voice;
+}
+
+void SampleBank::stop( VoiceId voice )
+{
+	Command command;
+	command.mType = Command::STOP;
+	command.mVoice = voice;
+	command.mSample = 0;
+	mCommands.tryPush( command );
+}
+
+void SampleBank::stopAll()
+{
+	Command command;
+	command.mType = Command::STOP_ALL;
+	command.mVoice = 0;
+	command.mSample = 0;
+	mCommands.tryPush( command );
+}
+
+void SampleBank::handleCommands()
+{
+	Command command;
+	while( mCommands.tryPop( &command ) ) {
+		if( command.mType == Command::PLAY ) {
+			if( mNumVoices == mVoices.size() ) {
+				// steal the oldest voice
+				std::copy( mVoices.begin() + 1, mVoices.end(), mVoices.begin() );
+				--mNumVoices;
+				detail::lockFreeStoreRelease( &mNumStolenVoices, mNumStolenVoices + 1 );
+			}
+			Voice &voice = mVoices[mNumVoices++];
+			voice.mId = command.mVoice;
+			voice.mSample = command.mSample;
+			voice.mPosition = 0;
+			voice.mGains[0] = command.mGains[0];
+			voice.mGains[1] = command.mGains[1];
+		}
+		else if( command.mType == Command::STOP ) {
+			for( size_t v = 0; v < mNumVoices; ++v ) {
+				if( mVoices[v].mId == command.mVoice ) {
+					std::copy( mVoices.begin() + v + 1, mVoices.begin() + mNumVoices, mVoices.begin() + v );
+					--mNumVoices;
+					break;
+				}
+			}
+		}
+		else {
+			mNumVoices = 0;
+		}
+	}
+}
+
+void SampleBank::renderVoices( float *mix, uint32_t frameCount )
+{
+	const uint16_t channelCount = mChannelCount;
+	memset( mix, 0, frameCount * channelCount * sizeof(float) );
+
+	size_t v = 0;
+	while( v < mNumVoices ) {
+		Voice &voice = mVoices[v];
+		const uint32_t frames = std::min( frameCount, voice.mSample->getNumFrames() - voice.mPosition );
+		const float *src = voice.mSample->getData() + (size_t)voice.mPosition * channelCount;
+		if( channelCount == 2 ) {
+			const float left = voice.mGains[0], right = voice.mGains[1];
+			for( uint32_t i = 0; i < frames; ++i ) {
+				mix[i * 2] += src[i * 2] * left;
+				mix[i * 2 + 1] += src[i * 2 + 1] * right;
+			}
+		}
+		else {
+			const float gain = voice.mGains[0];
+			const size_t sampleCount = frames * channelCount;
+			for( size_t i = 0; i < sampleCount; ++i )
+				mix[i] += src[i] * gain;
+		}
+
+		voice.mPosition += frames;
+		if( voice.mPosition >= voice.mSample->getNumFrames() ) {
+			// finished voices are removed in place, which keeps the rest in the order they were started
+			std::copy( mVoices.begin() + v + 1, mVoices.begin() + mNumVoices, mVoices.begin() + v );
+			--mNumVoices;
+		}
+		else {
+			++v;
+		}
+	}
+}
+
+void SampleBank::render( uint64_t inSampleOffset, uint32_t inSampleCount, BufferT<float> *ioBuffer )
+{
+	handleCommands();
+
+	const uint32_t outChannels = ioBuffer->mNumberChannels;
+	float *data = ioBuffer->mData;
+	for( uint32_t start = 0; start < inSampleCount; start += CHUNK_FRAMES ) {
+		const uint32_t frames = std::min( CHUNK_FRAMES, inSampleCount - start );
+		float *out = data + (size_t)start * outChannels;
+		if( outChannels == mChannelCount ) {
+			renderVoices( out, frames );
+		}
+		else {
+			renderVoices( &mMixBuffer[0], frames );
+			mixChannels( &mMixBuffer[0], mChannelCount, out, outChannels, frames );
+		}
+	}
+
+	detail::lockFreeStoreRelease( &mNumActiveVoices, (uint32_t)mNumVoices );
+}
+
+}} //namespace
@@ -0,0 +1,250 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/audio/SourceStream.h"
+#include "cinder/LockFreeCircularBuffer.h"
+#include "cinder/Function.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <algorithm>
+#include <cstring>
+
+namespace cinder { namespace audio {
+
+namespace {
+
+const uint32_t	NOT_ENDED = 0xFFFFFFFF;
+
+} // anonymous namespace
+
+LoaderSourceStreamRef LoaderSourceStream::createRef( SourceStream *source, Target *target )
+{
+	return LoaderSourceStreamRef( new LoaderSourceStream( source, target ) );
+}
+
+LoaderSourceStream::LoaderSourceStream( SourceStream *source, Target *target )
+	: Loader(), mWriteFrame( 0 ), mReadFrame( 0 ), mSeekGeneration( 0 ), mDataGeneration( 0 ), mEndedGeneration( NOT_ENDED ), mDataStartFrame( 0 ),
+		mDataStartSample( 0 ), mReadGeneration( 0 ), mSampleOffset( 0 ), mSeekSample( 0 ), mCanceled( false )
+{
+	mLoader = source->mSource->createLoader( target );
+	if( ! mLoader ) {
+		throw IoExceptionFailedLoad();
+	}
+
+	// the wrapped loader produces data in the layout of target: one buffer if interleaved, otherwise one per channel
+	mBufferCount = target->isInterleaved() ? 1 : std::max<uint32_t>( target->getChannelCount(), 1 );
+	mChannelsPerBuffer = target->isInterleaved() ? target->getChannelCount() : 1;
+	mBytesPerFrame = target->getBlockAlign();
+	if( mBytesPerFrame == 0 ) {
+		mBytesPerFrame = ( target->getBitsPerSample() / 8 ) * ( target->isInterleaved() ? target->getChannelCount() : 1 );
+	}
+	if( mBytesPerFrame == 0 ) {
+		throw IoExceptionUnsupportedDataFormat();
+	}
+
+	int32_t sampleRate = target->getSampleRate() ? target->getSampleRate() : source->getSampleRate();
+	uint32_t readaheadFrames = static_cast<uint32_t>( std::max( source->getReadahead(), 0.0 ) * sampleRate );
+	mChunkFrames = std::min<uint32_t>( std::max<uint32_t>( readaheadFrames / 4, 256 ), 4096 );
+	mCapacity = std::max( readaheadFrames, mChunkFrames * 2 );
+
+	mRings.resize( mBufferCount, std::vector<uint8_t>( mCapacity * mBytesPerFrame ) );
+	mChunks.resize( mBufferCount, std::vector<uint8_t>( mChunkFrames * mBytesPerFrame ) );
+
+	mThread = std::shared_ptr<std::thread>( new std::thread( std::bind( &LoaderSourceStream::decodeThreadFn, this ) ) );
+}
+
+LoaderSourceStream::~LoaderSourceStream()
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mCanceled = true;
+	}
+	mWakeCond.notify_one();
+	mThread->join();
+}
+
+void LoaderSourceStream::setSampleOffset( uint64_t anOffset )
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mSeekSample = anOffset;
+		detail::lockFreeStoreRelease( &mSeekGeneration, mSeekGeneration + 1 );
+	}
+	mWakeCond.notify_one();
+}
+
+uint32_t LoaderSourceStream::getFreeFrames() const
+{
+	return mCapacity - ( mWriteFrame - detail::lockFreeLoadAcquire( &mReadFrame ) );
+}
+
+void LoaderSourceStream::decodeThreadFn()
+{
+	ThreadSetup threadSetup;
+
+	std::vector<BufferGeneric> buffers( mBufferCount );
+	BufferList bufferList;
+	bufferList.mNumberBuffers = mBufferCount;
+	bufferList.mBuffers = &buffers[0];
+
+	uint32_t generation = 0;
+	bool ended = false;
+	while( true ) {
+		bool seek = false;
+		uint64_t seekSample = 0;
+		{
+			std::unique_lock<std::mutex> lock( mMutex );
+			while( true ) {
+				if( mCanceled ) {
+					return;
+				}
+				if( mSeekGeneration != generation ) {
+					generation = mSeekGeneration;
+					seekSample = mSeekSample;
+					seek = true;
+					break;
+				}
+				if( ! ended && getFreeFrames() >= mChunkFrames ) {
+					break;
+				}
+				// loadData() frees space without waking this thread, as that would mean locking on the playback thread, so poll
+				mWakeCond.timed_wait( lock, boost::posix_time::milliseconds( 5 ) );
+			}
+		}
+
+		if( seek ) {
+			// data already in the ring belongs to the previous generation, and loadData() skips it once it sees the new one
+			mLoader->setSampleOffset( seekSample );
+			mDataStartSample = seekSample;
+			mDataStartFrame = mWriteFrame;
+			detail::lockFreeStoreRelease( &mDataGeneration, generation );
+			ended = false;
+			continue;
+		}
+
+		for( uint32_t i = 0; i < mBufferCount; ++i ) {
+			buffers[i].mData = &mChunks[i][0];
+			buffers[i].mDataByteSize = mChunkFrames * mBytesPerFrame;
+			buffers[i].mNumberChannels = mChannelsPerBuffer;
+			buffers[i].mSampleCount = mChunkFrames;
+		}
+		mLoader->loadData( &bufferList );
+
+		uint32_t frameCount = std::min( buffers[0].mDataByteSize / mBytesPerFrame, mChunkFrames );
+		if( frameCount == 0 ) {
+			ended = true;
+			detail::lockFreeStoreRelease( &mEndedGeneration, generation );
+			continue;
+		}
+
+		// the loader may have pointed the buffers at its own memory rather than filling ours
+		uint32_t ringStart = mWriteFrame % mCapacity;
+		uint32_t firstCount = std::min( frameCount, mCapacity - ringStart );
+		for( uint32_t i = 0; i < mBufferCount; ++i ) {
+			const uint8_t *data = reinterpret_cast<const uint8_t*>( buffers[i].mData );
+			memcpy( &mRings[i][ringStart * mBytesPerFrame], data, firstCount * mBytesPerFrame );
+			if( firstCount < frameCount ) {
+				memcpy( &mRings[i][0], data + firstCount * mBytesPerFrame, ( frameCount - firstCount ) * mBytesPerFrame );
+			}
+		}
+		detail::lockFreeStoreRelease( &mWriteFrame, mWriteFrame + frameCount );
+	}
+}
+
+void LoaderSourceStream::loadData( BufferList *ioData )
+{
+	const uint32_t requested = ioData->mBuffers[0].mSampleCount;
+
+	// after a seek, skip ahead to the data of the new generation once the I/O thread has started it. mDataStartFrame and mDataStartSample
+	// are only trusted if the generation is unchanged after reading them.
+	const uint32_t seekGeneration = detail::lockFreeLoadAcquire( &mSeekGeneration );
+	if( mReadGeneration != seekGeneration && detail::lockFreeLoadAcquire( &mDataGeneration ) == seekGeneration ) {
+		uint32_t startFrame = mDataStartFrame;
+		uint64_t startSample = mDataStartSample;
+		if( detail::lockFreeLoadAcquire( &mDataGeneration ) == seekGeneration ) {
+			mReadGeneration = seekGeneration;
+			detail::lockFreeStoreRelease( &mReadFrame, startFrame );
+			mSampleOffset = startSample;
+		}
+	}
+
+	uint32_t frameCount = 0;
+	bool ended = false;
+	if( mReadGeneration == seekGeneration ) {
+		ended = detail::lockFreeLoadAcquire( &mEndedGeneration ) == mReadGeneration;
+		frameCount = std::min( requested, detail::lockFreeLoadAcquire( &mWriteFrame ) - mReadFrame );
+	}
+
+	if( ended && frameCount == 0 ) {
+		for( uint32_t i = 0; i < ioData->mNumberBuffers; ++i ) {
+			ioData->mBuffers[i].mSampleCount = 0;
+			ioData->mBuffers[i].mDataByteSize = 0;
+		}
+		return;
+	}
+
+	// an underrun is padded with silence rather than shortening the buffer, which would stop playback
+	uint32_t ringStart = mReadFrame % mCapacity;
+	uint32_t firstCount = std::min( frameCount, mCapacity - ringStart );
+	uint32_t outputCount = ended ? frameCount : requested;
+	for( uint32_t i = 0; i < std::min<uint32_t>( ioData->mNumberBuffers, mBufferCount ); ++i ) {
+		uint8_t *data = reinterpret_cast<uint8_t*>( ioData->mBuffers[i].mData );
+		memcpy( data, &mRings[i][ringStart * mBytesPerFrame], firstCount * mBytesPerFrame );
+		if( firstCount < frameCount ) {
+			memcpy( data + firstCount * mBytesPerFrame, &mRings[i][0], ( frameCount - firstCount ) * mBytesPerFrame );
+		}
+		memset( data + frameCount * mBytesPerFrame, 0, ( outputCount - frameCount ) * mBytesPerFrame );
+		ioData->mBuffers[i].mSampleCount = outputCount;
+		ioData->mBuffers[i].mDataByteSize = outputCount * mBytesPerFrame;
+	}
+
+	detail::lockFreeStoreRelease( &mReadFrame, mReadFrame + frameCount );
+	mSampleOffset += frameCount;
+}
+
+SourceStreamRef SourceStream::createStreamRef( SourceRef source, double readaheadSeconds )
+{
+	return SourceStreamRef( new SourceStream( source, readaheadSeconds ) );
+}
+
+SourceStream::SourceStream( SourceRef source, double readaheadSeconds )
+	: Source(), mSource( source ), mReadahead( readaheadSeconds )
+{
+	mSampleRate = mSource->getSampleRate();
+	mChannelCount = mSource->getChannelCount();
+	mBitsPerSample = mSource->getBitsPerSample();
+	mBlockAlign = mSource->getBlockAlign();
+	mDataType = mSource->getDataType();
+	mIsInterleaved = mSource->isInterleaved();
+	mIsPcm = mSource->isPcm();
+	mIsBigEndian = mSource->isBigEndian();
+}
+
+SourceRef loadStream( DataSourceRef dataSource, double readaheadSeconds, std::string extension )
+{
+	return SourceStream::createRef( load( dataSource, extension ), readaheadSeconds );
+}
+
+}} //namespace
@@ -26,6 +26,7 @@
 #include "cinder/svg/Svg.h"
 #include "cinder/ip/Premultiply.h"
 #include "cinder/Text.h"
+#include "cinder/gl/TextureStreamer.h"
 
 #include <cairo.h>
 #include <cairo-svg.h>
@@ -271,6 +272,218 @@ void SurfaceImage::initCinderSurface( bool alpha, cairo_surface_t *cairoSurface
 	cairo_surface_reference( cairoSurface ); // decremented by the mCinderSurface deallocator
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// SurfaceGlTexture
+SurfaceGlTexture::SurfaceGlTexture( int32_t width, int32_t height, bool hasAlpha, int numBuffers )
+	: SurfaceBase( width, height ), mStreamer( new gl::TextureStreamer( width, height, hasAlpha, gl::Texture::Format(), numBuffers ) ), mHasAlpha( hasAlpha )
+{
+}
+
+void SurfaceGlTexture::beginFrame()
+{
+	if( mCairoSurface )
+		endFrame();
+
+	// the streamer's BGRA and BGRX rows of width * 4 bytes are exactly Cairo's little-endian ARGB32 and RGB24
+	Surface8u frame = mStreamer->map();
+	mCairoSurface = cairo_image_surface_create_for_data( frame.getData(), mHasAlpha ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_RGB24, mWidth, mHeight, frame.getRowBytes() );
+}
+
+void SurfaceGlTexture::endFrame()
+{
+	if( ! mCairoSurface )
+		return;
+
+	// finishing rather than flushing keeps any Context still holding the surface from writing into the unmapped buffer
+	cairo_surface_finish( mCairoSurface );
+	cairo_surface_destroy( mCairoSurface );
+	mCairoSurface = 0;
+	mStreamer->upload();
+}
+
+const gl::Texture& SurfaceGlTexture::getTexture() const
+{
+	return mStreamer->getTexture();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// SurfaceRecording
+SurfaceRecording::SurfaceRecording( int32_t width, int32_t height, bool hasAlpha )
+	: SurfaceBase( width, height )
+{
+	cairo_content_t content = ( hasAlpha ) ? CAIRO_CONTENT_COLOR_ALPHA : CAIRO_CONTENT_COLOR;
+	if( width > 0 && height > 0 ) {
+		cairo_rectangle_t extents = { 0, 0, width, height };
+		mCairoSurface = cairo_recording_surface_create( content, &extents );
+	}
+	else
+		mCairoSurface = cairo_recording_surface_create( content, NULL );
+}
+
+SurfaceRecording::SurfaceRecording( const SurfaceRecording &other )
+	: SurfaceBase( other )
+{
+}
+
+Rectf SurfaceRecording::calcInkExtents() const
+{
+	double x, y, width, height;
+	cairo_recording_surface_ink_extents( mCairoSurface, &x, &y, &width, &height );
+	return Rectf( (float)x, (float)y, (float)( x + width ), (float)( y + height ) );
+}
+
+namespace {
+
+void renderTiles( cairo_surface_t *recording, unsigned char *destData, cairo_format_t format, int32_t stride, const Area &bounds, int32_t tileSize, int32_t tilesWide, int32_t beginTile, int32_t endTile )
+{
+	const int32_t bytesPerPixel = 4; // both ARGB32 and RGB24
+	for( int32_t tile = beginTile; tile < endTile; ++tile ) {
+		Area tileArea( (tile % tilesWide) * tileSize, (tile / tilesWide) * tileSize, 0, 0 );
+		tileArea.x2 = std::min( tileArea.x1 + tileSize, bounds.x2 );
+		tileArea.y2 = std::min( tileArea.y1 + tileSize, bounds.y2 );
+
+		// a window onto the destination's pixels, sharing its stride
+		unsigned char *tileData = destData + tileArea.y1 * stride + tileArea.x1 * bytesPerPixel;
+		cairo_surface_t *tileSurface = cairo_image_surface_create_for_data( tileData, format, tileArea.getWidth(), tileArea.getHeight(), stride );
+		cairo_t *cr = cairo_create( tileSurface );
+		cairo_set_source_surface( cr, recording, -tileArea.x1, -tileArea.y1 );
+		cairo_set_operator( cr, CAIRO_OPERATOR_SOURCE );
+		cairo_paint( cr );
+		cairo_destroy( cr );
+		cairo_surface_flush( tileSurface );
+		cairo_surface_destroy( tileSurface );
+	}
+}
+
+} // anonymous namespace
+
+void renderTiled( const SurfaceRecording &recording, SurfaceImage *dest, int32_t tileSize, JobSystemRef jobSystem )
+{
+	if( ! jobSystem )
+		jobSystem = JobSystem::getDefault();
+	tileSize = std::max( tileSize, 16 );
+
+	dest->flush();
+	Area bounds = dest->getBounds();
+	int32_t tilesWide = ( bounds.getWidth() + tileSize - 1 ) / tileSize;
+	int32_t tilesHigh = ( bounds.getHeight() + tileSize - 1 ) / tileSize;
+	cairo_format_t format = cairo_image_surface_get_format( dest->getCairoSurface() );
+	jobSystem->parallelFor( 0, tilesWide * tilesHigh, std::bind( renderTiles, recording.getCairoSurface(), dest->getData(), format, dest->getStride(), bounds, tileSize, tilesWide, std::_1, std::_2 ) );
+	dest->markDirty();
+}
+
+SurfaceImage renderTiled( const SurfaceRecording &recording, bool hasAlpha, int32_t tileSize, JobSystemRef jobSystem )
+{
+	SurfaceImage result( recording.getWidth(), recording.getHeight(), hasAlpha );
+	renderTiled( recording, &result, tileSize, jobSystem );
+	return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Picture
+Context Picture::beginRecording( bool hasAlpha )
+{
+	mObj = std::shared_ptr<Obj>( new Obj( hasAlpha ) );
+	return Context( mObj->mRecording );
+}
+
+void Picture::endRecording()
+{
+	if( ! mObj )
+		return;
+
+	mObj->mRecording.flush();
+	mObj->mBounds = mObj->mRecording.calcInkExtents();
+	clearCache();
+}
+
+void Picture::draw( Context &ctx ) const
+{
+	if( ! mObj )
+		return;
+
+	cairo_t *cr = ctx.getCairo();
+	cairo_save( cr );
+	cairo_set_source_surface( cr, mObj->mRecording.getCairoSurface(), 0, 0 );
+	cairo_paint( cr );
+	cairo_restore( cr );
+}
+
+void Picture::drawCached( Context &ctx ) const
+{
+	if( ( ! mObj ) || ( mObj->mBounds.getWidth() <= 0 ) || ( mObj->mBounds.getHeight() <= 0 ) )
+		return;
+
+	cairo_t *cr = ctx.getCairo();
+	cairo_matrix_t m;
+	cairo_get_matrix( cr, &m );
+	double deviceScale = math<double>::sqrt( std::max( m.xx * m.xx + m.yx * m.yx, m.xy * m.xy + m.yy * m.yy ) );
+	if( deviceScale <= 0 )
+		return;
+
+	// rounding up means a rasterization is only ever minified, by less than a quarter octave
+	int32_t level = (int32_t)math<double>::ceil( math<double>::log( deviceScale ) / math<double>::log( 2.0 ) * 4 - 0.001 );
+	CachedImage cached;
+	std::map<int32_t,CachedImage>::iterator cachedIt = mObj->mCache.find( level );
+	if( cachedIt != mObj->mCache.end() ) {
+		cachedIt->second.mLastUsed = ++mObj->mUseCount;
+		cached = cachedIt->second;
+	}
+	else {
+		const Rectf &bounds = mObj->mBounds;
+		cached.mScale = math<double>::pow( 2.0, level / 4.0 );
+		cached.mImage = SurfaceImage( std::max<int32_t>( (int32_t)math<double>::ceil( bounds.getWidth() * cached.mScale ), 1 ),
+										std::max<int32_t>( (int32_t)math<double>::ceil( bounds.getHeight() * cached.mScale ), 1 ), mObj->mHasAlpha );
+		cairo_t *imageCr = cairo_create( cached.mImage.getCairoSurface() );
+		cairo_scale( imageCr, cached.mScale, cached.mScale );
+		cairo_translate( imageCr, -bounds.x1, -bounds.y1 );
+		cairo_set_source_surface( imageCr, mObj->mRecording.getCairoSurface(), 0, 0 );
+		cairo_paint( imageCr );
+		cairo_destroy( imageCr );
+		cached.mImage.flush();
+
+		if( mObj->mMaxCachedScales > 0 ) {
+			trimCache( mObj->mMaxCachedScales - 1 );
+			cached.mLastUsed = ++mObj->mUseCount;
+			mObj->mCache[level] = cached;
+		}
+	}
+
+	cairo_save( cr );
+	cairo_translate( cr, mObj->mBounds.x1, mObj->mBounds.y1 );
+	cairo_scale( cr, 1 / cached.mScale, 1 / cached.mScale );
+	cairo_set_source_surface( cr, cached.mImage.getCairoSurface(), 0, 0 );
+	cairo_paint( cr );
+	cairo_restore( cr );
+}
+
+void Picture::setMaxCachedScales( size_t maxScales )
+{
+	if( ! mObj )
+		return;
+
+	mObj->mMaxCachedScales = maxScales;
+	trimCache( maxScales );
+}
+
+void Picture::clearCache() const
+{
+	if( mObj )
+		mObj->mCache.clear();
+}
+
+void Picture::trimCache( size_t maxScales ) const
+{
+	while( mObj->mCache.size() > maxScales ) {
+		std::map<int32_t,CachedImage>::iterator oldestIt = mObj->mCache.begin();
+		for( std::map<int32_t,CachedImage>::iterator cachedIt = mObj->mCache.begin(); cachedIt != mObj->mCache.end(); ++cachedIt ) {
+			if( cachedIt->second.mLastUsed < oldestIt->second.mLastUsed )
+				oldestIt = cachedIt;
+		}
+		mObj->mCache.erase( oldestIt );
+	}
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // SurfaceSvg
 SurfaceSvg::SurfaceSvg( const fs::path &filePath, uint32_t width, uint32_t height )
@@ -0,0 +1,199 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/AsyncReadback.h"
+#include "cinder/gl/StateCache.h"
+#include "cinder/app/App.h"
+#include "cinder/ip/Flip.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace cinder { namespace gl {
+
+AsyncReadback::Obj::Obj( int numBuffers, bool alpha )
+	: mNextSlot( 0 ), mSequence( 0 ), mAlpha( alpha )
+{
+#if defined( CINDER_MAC )
+	bool supportsPbo = gl::isExtensionAvailable( "GL_ARB_pixel_buffer_object" );
+#elif defined( CINDER_MSW )
+	bool supportsPbo = GLEE_ARB_pixel_buffer_object != 0;
+#else
+	bool supportsPbo = false;
+#endif
+
+#if ! defined( CINDER_GLES )
+	if( supportsPbo ) {
+		mSlots.resize( std::max( numBuffers, 1 ) );
+		for( size_t s = 0; s < mSlots.size(); ++s )
+			mSlots[s].mBuffer = Vbo( GL_PIXEL_PACK_BUFFER_ARB );
+	}
+#endif
+}
+
+AsyncReadback::AsyncReadback( int numBuffers, bool alpha )
+	: mObj( new Obj( numBuffers, alpha ) )
+{
+}
+
+SurfaceChannelOrder AsyncReadback::getChannelOrder() const
+{
+	return mObj->mAlpha ? SurfaceChannelOrder::BGRA : SurfaceChannelOrder::BGRX;
+}
+
+void AsyncReadback::readWindow( const Area &area, Callback callback )
+{
+	read( area, app::getWindowHeight(), callback );
+}
+
+void AsyncReadback::readFbo( Fbo &fbo, Callback callback )
+{
+#if ! defined( CINDER_GLES )
+	fbo.getTexture(); // resolves a multisampled Fbo
+
+	GLint oldReadFramebuffer, oldReadBuffer;
+	glGetIntegerv( GL_READ_FRAMEBUFFER_BINDING_EXT, &oldReadFramebuffer );
+	glGetIntegerv( GL_READ_BUFFER, &oldReadBuffer );
+	StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, fbo.getResolveId() );
+	glReadBuffer( GL_COLOR_ATTACHMENT0_EXT );
+
+	read( fbo.getBounds(), fbo.getHeight(), callback );
+
+	StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, oldReadFramebuffer );
+	glReadBuffer( oldReadBuffer );
+#endif
+}
+
+void AsyncReadback::read( const Area &area, int framebufferHeight, Callback callback )
+{
+	GLint oldPackAlignment;
+	glGetIntegerv( GL_PACK_ALIGNMENT, &oldPackAlignment );
+	glPixelStorei( GL_PACK_ALIGNMENT, 4 );
+
+	if( mObj->mSlots.empty() ) {
+		Surface8u result( area.getWidth(), area.getHeight(), mObj->mAlpha, getChannelOrder() );
+#if ! defined( CINDER_GLES )
+		glPixelStorei( GL_PACK_ROW_LENGTH, result.getRowBytes() / 4 );
+#endif
+		glReadPixels( area.x1, framebufferHeight - area.y2, area.getWidth(), area.getHeight(), GL_BGRA, GL_UNSIGNED_BYTE, result.getData() );
+#if ! defined( CINDER_GLES )
+		glPixelStorei( GL_PACK_ROW_LENGTH, 0 );
+#endif
+		glPixelStorei( GL_PACK_ALIGNMENT, oldPackAlignment );
+		ip::flipVertical( &result );
+		callback( result );
+		return;
+	}
+
+#if ! defined( CINDER_GLES )
+	Slot &slot = mObj->mSlots[mObj->mNextSlot];
+	if( slot.mPending ) {
+		// the ring is full; everything behind this slot is newer, so delivering it first keeps the results in order
+		isComplete( &slot, true );
+		deliver( &slot );
+	}
+
+	// respecifying the storage means the read never waits on a previous map of this buffer
+	slot.mBuffer.bufferData( area.getWidth() * area.getHeight() * 4, NULL, GL_STREAM_READ_ARB );
+	// with a pixel pack buffer bound, the data pointer of glReadPixels is an offset into it and the copy happens asynchronously
+	glReadPixels( area.x1, framebufferHeight - area.y2, area.getWidth(), area.getHeight(), GL_BGRA, GL_UNSIGNED_BYTE, 0 );
+	slot.mBuffer.unbind();
+	glPixelStorei( GL_PACK_ALIGNMENT, oldPackAlignment );
+
+	slot.mFence = Fence::isSupported() ? Fence::create() : FenceRef();
+	slot.mPending = true;
+	slot.mArea = area;
+	slot.mCallback = callback;
+	slot.mSequence = ++mObj->mSequence;
+	mObj->mNextSlot = ( mObj->mNextSlot + 1 ) % mObj->mSlots.size();
+#endif
+}
+
+bool AsyncReadback::isComplete( Slot *slot, bool wait )
+{
+	if( ! slot->mPending )
+		return false;
+	else if( slot->mFence )
+		return ( wait ) ? slot->mFence->wait() : slot->mFence->isSignaled();
+	else // without fences, assume a read is complete once a newer one has been issued after it
+		return wait || ( slot->mSequence != mObj->mSequence );
+}
+
+void AsyncReadback::deliver( Slot *slot )
+{
+#if ! defined( CINDER_GLES )
+	int32_t width = slot->mArea.getWidth(), height = slot->mArea.getHeight();
+	Surface8u result( width, height, mObj->mAlpha, getChannelOrder() );
+	const uint8_t *data = slot->mBuffer.map( GL_READ_ONLY_ARB );
+	if( data ) {
+		// GL's rows run bottom to top
+		for( int32_t y = 0; y < height; ++y )
+			memcpy( result.getData( Vec2i( 0, height - 1 - y ) ), data + y * width * 4, width * 4 );
+		slot->mBuffer.unmap();
+	}
+	slot->mBuffer.unbind();
+
+	slot->mFence.reset();
+	slot->mPending = false;
+	Callback callback = slot->mCallback;
+	slot->mCallback = Callback();
+	if( ! data )
+		throw VboFailedMapExc();
+	callback( result );
+#endif
+}
+
+void AsyncReadback::deliverCompleted( bool wait )
+{
+	// starting at mNextSlot visits the ring oldest first
+	for( size_t i = 0; i < mObj->mSlots.size(); ++i ) {
+		Slot &slot = mObj->mSlots[( mObj->mNextSlot + i ) % mObj->mSlots.size()];
+		if( ! slot.mPending )
+			continue;
+		if( ! isComplete( &slot, wait ) )
+			break;
+		deliver( &slot );
+	}
+}
+
+void AsyncReadback::update()
+{
+	deliverCompleted( false );
+}
+
+void AsyncReadback::flush()
+{
+	deliverCompleted( true );
+}
+
+size_t AsyncReadback::getNumPending() const
+{
+	size_t result = 0;
+	for( size_t s = 0; s < mObj->mSlots.size(); ++s )
+		if( mObj->mSlots[s].mPending )
+			++result;
+	return result;
+}
+
+} } // namespace cinder::gl
@@ -0,0 +1,340 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/Batch2d.h"
+#include "cinder/gl/StateCache.h"
+#include "cinder/CinderMath.h"
+
+#include <limits>
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+Batch2d::State::State( GLenum primitive, const Texture &texture, BlendMode blendMode )
+	: mPrimitive( primitive ), mTarget( texture ? texture.getTarget() : 0 ), mTextureId( texture ? texture.getId() : 0 ), mBlendMode( blendMode )
+{
+}
+
+bool Batch2d::State::operator==( const State &rhs ) const
+{
+	return ( mPrimitive == rhs.mPrimitive ) && ( mTarget == rhs.mTarget ) && ( mTextureId == rhs.mTextureId ) && ( mBlendMode == rhs.mBlendMode );
+}
+
+bool Batch2d::State::operator<( const State &rhs ) const
+{
+	// blend mode first, as it's the most expensive to change
+	if( mBlendMode != rhs.mBlendMode )
+		return mBlendMode < rhs.mBlendMode;
+	if( mTarget != rhs.mTarget )
+		return mTarget < rhs.mTarget;
+	if( mTextureId != rhs.mTextureId )
+		return mTextureId < rhs.mTextureId;
+	return mPrimitive < rhs.mPrimitive;
+}
+
+Batch2d::Batch2d( const Format &format )
+	: mFormat( format ), mColor( 255, 255, 255, 255 ), mBlendMode( BLEND_ALPHA ), mTransform( MatrixAffine2f::identity() ), mNumVertices( 0 ), mNumDrawCalls( 0 )
+{
+}
+
+Batch2d::Bucket* Batch2d::prepare( GLenum primitive, const Texture &texture, size_t numVertices, IndexT *baseIndex )
+{
+	// indices are relative to the whole batch, so make sure they can't overflow
+	if( mNumVertices + numVertices > (size_t)numeric_limits<IndexT>::max() )
+		flush();
+
+	State state( primitive, texture, mBlendMode );
+	Bucket *bucket = 0;
+	if( mFormat.getSortByState() ) {
+		map<State,size_t>::const_iterator bucketIt = mBucketIndices.find( state );
+		if( bucketIt != mBucketIndices.end() )
+			bucket = &mBuckets[bucketIt->second];
+		else {
+			mBucketIndices[state] = mBuckets.size();
+			mBuckets.push_back( Bucket( state, texture ) );
+			bucket = &mBuckets.back();
+		}
+	}
+	else {
+		if( mBuckets.empty() || ( ! ( mBuckets.back().mState == state ) ) )
+			mBuckets.push_back( Bucket( state, texture ) );
+		bucket = &mBuckets.back();
+	}
+
+	*baseIndex = (IndexT)bucket->mVertices.size();
+	mNumVertices += numVertices;
+	return bucket;
+}
+
+void Batch2d::addVertex( Bucket *bucket, const Vec2f &position, const Vec2f &texCoord )
+{
+	Vertex vertex;
+	vertex.mPosition = mTransform.transformPoint( position );
+	vertex.mTexCoord = texCoord;
+	vertex.mColor = mColor;
+	bucket->mVertices.push_back( vertex );
+}
+
+void Batch2d::addQuad( const Texture &texture, const Rectf &destRect, const Rectf &texCoords )
+{
+	IndexT base;
+	Bucket *bucket = prepare( GL_TRIANGLES, texture, 4, &base );
+	addVertex( bucket, destRect.getUpperLeft(), texCoords.getUpperLeft() );
+	addVertex( bucket, destRect.getUpperRight(), texCoords.getUpperRight() );
+	addVertex( bucket, destRect.getLowerRight(), texCoords.getLowerRight() );
+	addVertex( bucket, destRect.getLowerLeft(), texCoords.getLowerLeft() );
+	const IndexT indices[6] = { 0, 1, 2, 2, 3, 0 };
+	for( int i = 0; i < 6; ++i )
+		bucket->mIndices.push_back( base + indices[i] );
+}
+
+void Batch2d::drawLine( const Vec2f &start, const Vec2f &end )
+{
+	IndexT base;
+	Bucket *bucket = prepare( GL_LINES, Texture(), 2, &base );
+	addVertex( bucket, start );
+	addVertex( bucket, end );
+	bucket->mIndices.push_back( base + 0 );
+	bucket->mIndices.push_back( base + 1 );
+}
+
+void Batch2d::drawSolidRect( const Rectf &rect )
+{
+	addQuad( Texture(), rect, Rectf( 0, 0, 1, 1 ) );
+}
+
+void Batch2d::drawStrokedRect( const Rectf &rect )
+{
+	IndexT base;
+	Bucket *bucket = prepare( GL_LINES, Texture(), 4, &base );
+	addVertex( bucket, rect.getUpperLeft() );
+	addVertex( bucket, rect.getUpperRight() );
+	addVertex( bucket, rect.getLowerRight() );
+	addVertex( bucket, rect.getLowerLeft() );
+	for( IndexT i = 0; i < 4; ++i ) {
+		bucket->mIndices.push_back( base + i );
+		bucket->mIndices.push_back( base + ( i + 1 ) % 4 );
+	}
+}
+
+void Batch2d::drawSolidTriangle( const Vec2f &pt1, const Vec2f &pt2, const Vec2f &pt3 )
+{
+	IndexT base;
+	Bucket *bucket = prepare( GL_TRIANGLES, Texture(), 3, &base );
+	addVertex( bucket, pt1 );
+	addVertex( bucket, pt2 );
+	addVertex( bucket, pt3 );
+	for( IndexT i = 0; i < 3; ++i )
+		bucket->mIndices.push_back( base + i );
+}
+
+void Batch2d::drawSolidCircle( const Vec2f &center, float radius, int numSegments )
+{
+	// automatically determine the number of segments from the circumference
+	if( numSegments <= 0 )
+		numSegments = (int)math<double>::floor( radius * M_PI * 2 );
+	if( numSegments < 3 ) numSegments = 3;
+
+	IndexT base;
+	Bucket *bucket = prepare( GL_TRIANGLES, Texture(), numSegments + 1, &base );
+	addVertex( bucket, center );
+	for( int s = 0; s < numSegments; ++s ) {
+		float t = s / (float)numSegments * 2.0f * 3.14159f;
+		addVertex( bucket, center + Vec2f( math<float>::cos( t ), math<float>::sin( t ) ) * radius );
+		bucket->mIndices.push_back( base );
+		bucket->mIndices.push_back( base + 1 + s );
+		bucket->mIndices.push_back( base + 1 + ( s + 1 ) % numSegments );
+	}
+}
+
+void Batch2d::drawStrokedCircle( const Vec2f &center, float radius, int numSegments )
+{
+	// automatically determine the number of segments from the circumference
+	if( numSegments <= 0 )
+		numSegments = (int)math<double>::floor( radius * M_PI * 2 );
+	if( numSegments < 2 ) numSegments = 2;
+
+	IndexT base;
+	Bucket *bucket = prepare( GL_LINES, Texture(), numSegments, &base );
+	for( int s = 0; s < numSegments; ++s ) {
+		float t = s / (float)numSegments * 2.0f * 3.14159f;
+		addVertex( bucket, center + Vec2f( math<float>::cos( t ), math<float>::sin( t ) ) * radius );
+		bucket->mIndices.push_back( base + s );
+		bucket->mIndices.push_back( base + ( s + 1 ) % numSegments );
+	}
+}
+
+void Batch2d::draw( const Texture &texture )
+{
+	draw( texture, texture.getCleanBounds(), texture.getCleanBounds() );
+}
+
+void Batch2d::draw( const Texture &texture, const Vec2f &pos )
+{
+	draw( texture, texture.getCleanBounds(), Rectf( pos.x, pos.y, pos.x + texture.getCleanWidth(), pos.y + texture.getCleanHeight() ) );
+}
+
+void Batch2d::draw( const Texture &texture, const Rectf &rect )
+{
+	draw( texture, texture.getCleanBounds(), rect );
+}
+
+void Batch2d::draw( const Texture &texture, const Area &srcArea, const Rectf &destRect )
+{
+	addQuad( texture, destRect, texture.getAreaTexCoords( srcArea ) );
+}
+
+void Batch2d::draw( const TextureAtlas::Region &region, const Rectf &destRect )
+{
+	addQuad( region.getTexture(), destRect, region.getTexCoords() );
+}
+
+void Batch2d::draw( const TextureAtlas::Region &region, const Vec2f &pos )
+{
+	draw( region, Rectf( pos.x, pos.y, pos.x + region.getWidth(), pos.y + region.getHeight() ) );
+}
+
+void Batch2d::clear()
+{
+	mBuckets.clear();
+	mBucketIndices.clear();
+	mNumVertices = 0;
+}
+
+void Batch2d::flush()
+{
+	mNumDrawCalls = 0;
+	if( mBuckets.empty() ) {
+		clear();
+		return;
+	}
+
+	// the map's order groups the buckets by state; otherwise they're drawn in the order they were started
+	vector<const Bucket*> order;
+	if( mFormat.getSortByState() ) {
+		for( map<State,size_t>::const_iterator bucketIt = mBucketIndices.begin(); bucketIt != mBucketIndices.end(); ++bucketIt )
+			order.push_back( &mBuckets[bucketIt->second] );
+	}
+	else {
+		for( vector<Bucket>::const_iterator bucketIt = mBuckets.begin(); bucketIt != mBuckets.end(); ++bucketIt )
+			order.push_back( &*bucketIt );
+	}
+
+	// concatenate the buckets into a single vertex and index buffer
+	mFlushVertices.clear();
+	mFlushIndices.clear();
+	vector<pair<size_t,size_t> > ranges; // first index, number of indices
+	for( vector<const Bucket*>::const_iterator bucketIt = order.begin(); bucketIt != order.end(); ++bucketIt ) {
+		const IndexT base = (IndexT)mFlushVertices.size();
+		ranges.push_back( make_pair( mFlushIndices.size(), (*bucketIt)->mIndices.size() ) );
+		mFlushVertices.insert( mFlushVertices.end(), (*bucketIt)->mVertices.begin(), (*bucketIt)->mVertices.end() );
+		for( vector<IndexT>::const_iterator idxIt = (*bucketIt)->mIndices.begin(); idxIt != (*bucketIt)->mIndices.end(); ++idxIt )
+			mFlushIndices.push_back( base + *idxIt );
+	}
+
+	SaveColorState saveColorState;
+	BoolState saveBlendState( GL_BLEND );
+	BoolState saveTexture2dState( GL_TEXTURE_2D );
+	SaveTextureBindState saveBindState( GL_TEXTURE_2D );
+#if ! defined( CINDER_GLES )
+	BoolState saveTextureRectangleState( GL_TEXTURE_RECTANGLE_ARB );
+#endif
+	ClientBoolState vertexArrayState( GL_VERTEX_ARRAY );
+	ClientBoolState colorArrayState( GL_COLOR_ARRAY );
+	ClientBoolState texCoordArrayState( GL_TEXTURE_COORD_ARRAY );
+	GLint oldBlendSrc, oldBlendDst;
+	glGetIntegerv( GL_BLEND_SRC, &oldBlendSrc );
+	glGetIntegerv( GL_BLEND_DST, &oldBlendDst );
+
+	const GLsizei stride = sizeof(Vertex);
+#if defined( CINDER_GLES )
+	const uint8_t *vertexData = reinterpret_cast<const uint8_t*>( &mFlushVertices[0] );
+	const uint8_t *indexData = reinterpret_cast<const uint8_t*>( &mFlushIndices[0] );
+	const GLenum indexType = GL_UNSIGNED_SHORT;
+#else
+	if( ! mVertexVbo ) {
+		mVertexVbo = Vbo( GL_ARRAY_BUFFER );
+		mIndexVbo = Vbo( GL_ELEMENT_ARRAY_BUFFER );
+	}
+	// respecifying the whole store each flush lets the driver hand back fresh memory instead of waiting on the last draw
+	mVertexVbo.bufferData( mFlushVertices.size() * sizeof(Vertex), &mFlushVertices[0], GL_STREAM_DRAW );
+	mIndexVbo.bufferData( mFlushIndices.size() * sizeof(IndexT), &mFlushIndices[0], GL_STREAM_DRAW );
+	const uint8_t *vertexData = 0;
+	const uint8_t *indexData = 0;
+	const GLenum indexType = GL_UNSIGNED_INT;
+#endif
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glEnableClientState( GL_COLOR_ARRAY );
+	glDisableClientState( GL_TEXTURE_COORD_ARRAY );
+	glVertexPointer( 2, GL_FLOAT, stride, vertexData );
+	glTexCoordPointer( 2, GL_FLOAT, stride, vertexData + sizeof(Vec2f) );
+	glColorPointer( 4, GL_UNSIGNED_BYTE, stride, vertexData + 2 * sizeof(Vec2f) );
+
+	// start untextured; each bucket enables only the target it needs
+	glDisable( GL_TEXTURE_2D );
+#if ! defined( CINDER_GLES )
+	glDisable( GL_TEXTURE_RECTANGLE_ARB );
+#endif
+	GLenum curTarget = 0;
+	int curBlendMode = -1;
+	for( size_t b = 0; b < order.size(); ++b ) {
+		const State &state = order[b]->mState;
+		if( state.mBlendMode != curBlendMode ) {
+			switch( state.mBlendMode ) {
+				case BLEND_NONE: disableAlphaBlending(); break;
+				case BLEND_ALPHA: enableAlphaBlending( false ); break;
+				case BLEND_PREMULTIPLIED: enableAlphaBlending( true ); break;
+				case BLEND_ADDITIVE: enableAdditiveBlending(); break;
+			}
+			curBlendMode = state.mBlendMode;
+		}
+		if( state.mTarget != curTarget ) {
+			if( curTarget )
+				glDisable( curTarget );
+			if( state.mTarget ) {
+				glEnable( state.mTarget );
+				glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+			}
+			else
+				glDisableClientState( GL_TEXTURE_COORD_ARRAY );
+			curTarget = state.mTarget;
+		}
+		if( state.mTarget )
+			StateCache::bindTexture( state.mTarget, state.mTextureId );
+
+		glDrawElements( state.mPrimitive, ranges[b].second, indexType, indexData + ranges[b].first * sizeof(IndexT) );
+		++mNumDrawCalls;
+	}
+
+#if ! defined( CINDER_GLES )
+	mVertexVbo.unbind();
+	mIndexVbo.unbind();
+#endif
+	StateCache::blendFunc( oldBlendSrc, oldBlendDst );
+
+	clear();
+}
+
+} } // namespace cinder::gl
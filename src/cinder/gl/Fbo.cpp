@@ -22,6 +22,8 @@ Copyright (c) 2010, The Barbarian Group
 
 #include "cinder/gl/gl.h" // must be first
 #include "cinder/gl/Fbo.h"
+#include "cinder/gl/StateCache.h"
+#include "cinder/gl/GpuMemory.h"
 
 using namespace std;
 
@@ -38,6 +40,31 @@ GLint Fbo::sMaxAttachments = -1;
 	#define GL_SUFFIX(sym) sym##EXT
 #endif
 
+namespace {
+
+#if defined( CINDER_MSW )
+// GLee predates GL_ARB_invalidate_subdata, so its entry point is loaded by hand
+typedef void (APIENTRY *InvalidateFramebufferProc)( GLenum target, GLsizei numAttachments, const GLenum *attachments );
+#endif
+
+// Hints that the contents of \a attachments of the currently bound framebuffer need not be preserved
+void invalidateBoundFramebuffer( const vector<GLenum> &attachments )
+{
+#if defined( CINDER_GLES )
+  #if defined( GL_EXT_discard_framebuffer )
+	static bool supported = gl::isExtensionAvailable( "GL_EXT_discard_framebuffer" );
+	if( supported )
+		glDiscardFramebufferEXT( GL_FRAMEBUFFER_OES, (GLsizei)attachments.size(), &attachments[0] );
+  #endif
+#elif defined( CINDER_MSW )
+	static InvalidateFramebufferProc invalidateFramebuffer = gl::isExtensionAvailable( "GL_ARB_invalidate_subdata" ) ? (InvalidateFramebufferProc)::wglGetProcAddress( "glInvalidateFramebuffer" ) : 0;
+	if( invalidateFramebuffer )
+		(*invalidateFramebuffer)( GL_FRAMEBUFFER_EXT, (GLsizei)attachments.size(), &attachments[0] );
+#endif
+}
+
+} // anonymous namespace
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // RenderBuffer::Obj
 Renderbuffer::Obj::Obj()
@@ -46,6 +73,7 @@ Renderbuffer::Obj::Obj()
 	mId = 0;
 	mInternalFormat = 0;
 	mSamples = mCoverageSamples = 0;
+	mAllocatedBytes = 0;
 }
 
 Renderbuffer::Obj::Obj( int aWidth, int aHeight, GLenum internalFormat, int msaaSamples, int coverageSamples )
@@ -78,12 +106,16 @@ Renderbuffer::Obj::Obj( int aWidth, int aHeight, GLenum internalFormat, int msaa
 	else
 #endif
 		GL_SUFFIX(glRenderbufferStorage)( GL_SUFFIX(GL_RENDERBUFFER_), mInternalFormat, mWidth, mHeight );
+
+	mAllocatedBytes = GpuMemory::getImageBytes( mInternalFormat, mWidth, mHeight ) * std::max( mSamples, 1 );
+	GpuMemory::reallocate( GpuMemory::RENDERBUFFER, 0, mAllocatedBytes );
 }
 
 Renderbuffer::Obj::~Obj()
 {
 	if( mId )
 		GL_SUFFIX(glDeleteRenderbuffers)( 1, &mId );
+	GpuMemory::reallocate( GpuMemory::RENDERBUFFER, mAllocatedBytes, 0 );
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -104,6 +136,8 @@ Fbo::Obj::Obj()
 {
 	mId = 0;
 	mResolveFramebufferId = 0;
+	mDepthNeedsResolve = false;
+	mDrawAttachment = -1;
 }
 
 Fbo::Obj::Obj( int width, int height )
@@ -111,14 +145,20 @@ Fbo::Obj::Obj( int width, int height )
 {
 	mId = 0;
 	mResolveFramebufferId = 0;
+	mDepthNeedsResolve = false;
+	mDrawAttachment = -1;
 }
 
 Fbo::Obj::~Obj()
 {
-	if( mId )
+	if( mId ) {
 		GL_SUFFIX(glDeleteFramebuffers)( 1, &mId );
-	if( mResolveFramebufferId )
+		StateCache::framebufferDeleted( mId );
+	}
+	if( mResolveFramebufferId ) {
 		GL_SUFFIX(glDeleteFramebuffers)( 1, &mResolveFramebufferId );
+		StateCache::framebufferDeleted( mResolveFramebufferId );
+	}
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -141,6 +181,7 @@ Fbo::Format::Format()
 	mDepthBuffer = true;
 	mStencilBuffer = false;
 	mMipmapping = false;
+	mAutoResolve = true;
 	mWrapS = GL_CLAMP_TO_EDGE;
 	mWrapT = GL_CLAMP_TO_EDGE;
 	mMinFilter = GL_LINEAR;
@@ -187,7 +228,7 @@ void Fbo::init()
 
 	// allocate the framebuffer itself
 	GL_SUFFIX(glGenFramebuffers)( 1, &mObj->mId );
-	GL_SUFFIX(glBindFramebuffer)( GL_SUFFIX(GL_FRAMEBUFFER_), mObj->mId );	
+	StateCache::bindFramebuffer( GL_SUFFIX(GL_FRAMEBUFFER_), mObj->mId );	
 
 	Texture::Format textureFormat;
 	textureFormat.setTarget( getTarget() );
@@ -224,22 +265,7 @@ void Fbo::init()
 		// allocate and attach depth texture
 		if( mObj->mFormat.mDepthBuffer ) {
 			if( mObj->mFormat.mDepthBufferAsTexture ) {
-	#if ! defined( CINDER_GLES )			
-				GLuint depthTextureId;
-				glGenTextures( 1, &depthTextureId );
-				glBindTexture( getTarget(), depthTextureId );
-				glTexImage2D( getTarget(), 0, getFormat().getDepthInternalFormat(), mObj->mWidth, mObj->mHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL );
-				glTexParameteri( getTarget(), GL_TEXTURE_MIN_FILTER, mObj->mFormat.mMinFilter );
-				glTexParameteri( getTarget(), GL_TEXTURE_MAG_FILTER, mObj->mFormat.mMagFilter );
-				glTexParameteri( getTarget(), GL_TEXTURE_WRAP_S, mObj->mFormat.mWrapS );
-				glTexParameteri( getTarget(), GL_TEXTURE_WRAP_T, mObj->mFormat.mWrapT );
-				glTexParameteri( getTarget(), GL_DEPTH_TEXTURE_MODE, GL_LUMINANCE );
-				mObj->mDepthTexture = Texture( getTarget(), depthTextureId, mObj->mWidth, mObj->mHeight, true );
-
-				glFramebufferTexture2DEXT( GL_FRAMEBUFFER_EXT, GL_DEPTH_ATTACHMENT_EXT, getTarget(), mObj->mDepthTexture.getId(), 0 );
-	#else
-		throw; // this should never fire in OpenGL ES
-	#endif
+				initDepthTexture();
 			}
 			else if( mObj->mFormat.mDepthBuffer ) { // implement depth buffer as RenderBuffer
 				mObj->mDepthRenderbuffer = Renderbuffer( mObj->mWidth, mObj->mHeight, mObj->mFormat.getDepthInternalFormat() );
@@ -253,8 +279,32 @@ void Fbo::init()
 		}
 	}
 	
-	mObj->mNeedsResolve = false;
-	mObj->mNeedsMipmapUpdate = false;
+	mObj->mNeedsResolve.assign( mObj->mColorTextures.size(), false );
+	mObj->mNeedsMipmapUpdate.assign( mObj->mColorTextures.size(), false );
+	mObj->mDepthNeedsResolve = false;
+}
+
+// Creates the depth texture if necessary and attaches it to the currently bound framebuffer
+void Fbo::initDepthTexture()
+{
+#if ! defined( CINDER_GLES )			
+	if( ! mObj->mDepthTexture ) {
+		GLuint depthTextureId;
+		glGenTextures( 1, &depthTextureId );
+		StateCache::bindTexture( getTarget(), depthTextureId );
+		glTexImage2D( getTarget(), 0, getFormat().getDepthInternalFormat(), mObj->mWidth, mObj->mHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL );
+		glTexParameteri( getTarget(), GL_TEXTURE_MIN_FILTER, mObj->mFormat.mMinFilter );
+		glTexParameteri( getTarget(), GL_TEXTURE_MAG_FILTER, mObj->mFormat.mMagFilter );
+		glTexParameteri( getTarget(), GL_TEXTURE_WRAP_S, mObj->mFormat.mWrapS );
+		glTexParameteri( getTarget(), GL_TEXTURE_WRAP_T, mObj->mFormat.mWrapT );
+		glTexParameteri( getTarget(), GL_DEPTH_TEXTURE_MODE, GL_LUMINANCE );
+		mObj->mDepthTexture = Texture( getTarget(), depthTextureId, mObj->mWidth, mObj->mHeight, true );
+	}
+
+	glFramebufferTexture2DEXT( GL_FRAMEBUFFER_EXT, GL_DEPTH_ATTACHMENT_EXT, getTarget(), mObj->mDepthTexture.getId(), 0 );
+#else
+	throw; // this should never fire in OpenGL ES
+#endif
 }
 
 bool Fbo::initMultisample( bool csaa )
@@ -263,7 +313,7 @@ bool Fbo::initMultisample( bool csaa )
 	return false;
 #else
 	glGenFramebuffersEXT( 1, &mObj->mResolveFramebufferId );
-	glBindFramebufferEXT( GL_FRAMEBUFFER_EXT, mObj->mResolveFramebufferId ); 
+	StateCache::bindFramebuffer( GL_FRAMEBUFFER_EXT, mObj->mResolveFramebufferId ); 
 	
 	// bind all of the color buffers to the resolve FB's attachment points
 	vector<GLenum> drawBuffers;
@@ -272,6 +322,10 @@ bool Fbo::initMultisample( bool csaa )
 		drawBuffers.push_back( GL_COLOR_ATTACHMENT0_EXT + c );
 	}
 
+	// a depth texture receives the resolved depth buffer
+	if( mObj->mFormat.mDepthBuffer && mObj->mFormat.mDepthBufferAsTexture )
+		initDepthTexture();
+
 	if( ! drawBuffers.empty() )
 		glDrawBuffers( drawBuffers.size(), &drawBuffers[0] );
 
@@ -280,7 +334,7 @@ bool Fbo::initMultisample( bool csaa )
 	if( ! checkStatus( &ignoredException ) )
 		return false;
 
-	glBindFramebufferEXT( GL_FRAMEBUFFER_EXT, mObj->mId );
+	StateCache::bindFramebuffer( GL_FRAMEBUFFER_EXT, mObj->mId );
 
 	if( mObj->mFormat.mSamples > getMaxSamples() ) {
 		mObj->mFormat.mSamples = getMaxSamples();
@@ -333,70 +387,107 @@ Fbo::Fbo( int width, int height, bool alpha, bool color, bool depth )
 
 Texture& Fbo::getTexture( int attachment )
 {
-	resolveTextures();
+	if( mObj->mFormat.mAutoResolve )
+		resolveTexture( attachment );
 	updateMipmaps( true, attachment );
 	return mObj->mColorTextures[attachment];
 }
 
 Texture& Fbo::getDepthTexture()
 {
+	if( mObj->mFormat.mAutoResolve )
+		resolveDepthTexture();
 	return mObj->mDepthTexture;
 }
 
 void Fbo::bindTexture( int textureUnit, int attachment )
 {
-	resolveTextures();
+	if( mObj->mFormat.mAutoResolve )
+		resolveTexture( attachment );
 	mObj->mColorTextures[attachment].bind( textureUnit );
 	updateMipmaps( false, attachment );
 }
 
 void Fbo::unbindTexture()
 {
-	glBindTexture( getTarget(), 0 );
+	StateCache::bindTexture( getTarget(), 0 );
 }
 
 void Fbo::bindDepthTexture( int textureUnit )
 {
+	if( mObj->mFormat.mAutoResolve )
+		resolveDepthTexture();
 	mObj->mDepthTexture.bind( textureUnit );
 }
 
 void Fbo::resolveTextures() const
 {
-	if( ! mObj->mNeedsResolve )
+	resolve( 0, mObj->mColorTextures.size(), true );
+}
+
+void Fbo::resolveTexture( int attachment ) const
+{
+	resolve( attachment, attachment + 1, false );
+}
+
+void Fbo::resolveDepthTexture() const
+{
+	resolve( 0, 0, true );
+}
+
+// Blits the color attachments in [beginAttachment, endAttachment) and optionally the depth buffer, skipping any not drawn to since their last resolve
+void Fbo::resolve( size_t beginAttachment, size_t endAttachment, bool depth ) const
+{
+	size_t firstDirty = beginAttachment;
+	while( ( firstDirty < endAttachment ) && ( ! mObj->mNeedsResolve[firstDirty] ) )
+		++firstDirty;
+	bool resolveDepth = depth && mObj->mDepthNeedsResolve;
+	if( ( firstDirty == endAttachment ) && ( ! resolveDepth ) )
 		return;
 
-#if ! defined( CINDER_GLES )		
-	// if this FBO is multisampled, resolve it, so it can be displayed
-	if ( mObj->mResolveFramebufferId ) {
-		SaveFramebufferBinding saveFboBinding;
+#if ! defined( CINDER_GLES )
+	SaveFramebufferBinding saveFboBinding;
 
-		glBindFramebufferEXT( GL_READ_FRAMEBUFFER_EXT, mObj->mId );
-		glBindFramebufferEXT( GL_DRAW_FRAMEBUFFER_EXT, mObj->mResolveFramebufferId );
-		
-		for( size_t c = 0; c < mObj->mColorTextures.size(); ++c ) {
-			glDrawBuffer( GL_COLOR_ATTACHMENT0_EXT + c );
-			glReadBuffer( GL_COLOR_ATTACHMENT0_EXT + c );
-			GLbitfield bitfield = GL_COLOR_BUFFER_BIT;
-			if( mObj->mDepthTexture )
-				bitfield |= GL_DEPTH_BUFFER_BIT;
-			glBlitFramebufferEXT( 0, 0, mObj->mWidth, mObj->mHeight, 0, 0, mObj->mWidth, mObj->mHeight, bitfield, GL_NEAREST );
-		}
+	StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, mObj->mId );
+	StateCache::bindFramebuffer( GL_DRAW_FRAMEBUFFER_EXT, mObj->mResolveFramebufferId );
+
+	// the read buffer belongs to the multisampled framebuffer and the draw buffer to the resolve framebuffer, so the draw buffers used for rendering are left untouched
+	for( size_t c = firstDirty; c < endAttachment; ++c ) {
+		if( ! mObj->mNeedsResolve[c] )
+			continue;
+		glReadBuffer( GL_COLOR_ATTACHMENT0_EXT + c );
+		glDrawBuffer( GL_COLOR_ATTACHMENT0_EXT + c );
+		glBlitFramebufferEXT( 0, 0, mObj->mWidth, mObj->mHeight, 0, 0, mObj->mWidth, mObj->mHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST );
+		mObj->mNeedsResolve[c] = false;
+	}
 
-		// restore the draw buffers to the default for the antialiased (non-resolve) framebuffer
-		vector<GLenum> drawBuffers;
-		for( size_t c = 0; c < mObj->mColorTextures.size(); ++c )
-			drawBuffers.push_back( GL_COLOR_ATTACHMENT0_EXT + c );
-		glBindFramebufferEXT( GL_FRAMEBUFFER_EXT, mObj->mId );
-		glDrawBuffers( drawBuffers.size(), &drawBuffers[0] );
+	if( resolveDepth ) {
+		glBlitFramebufferEXT( 0, 0, mObj->mWidth, mObj->mHeight, 0, 0, mObj->mWidth, mObj->mHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST );
+		mObj->mDepthNeedsResolve = false;
 	}
 #endif
+}
+
+void Fbo::invalidate( GLbitfield mask )
+{
+	vector<GLenum> attachments;
+	if( mask & GL_COLOR_BUFFER_BIT ) {
+		for( size_t c = 0; c < mObj->mColorTextures.size(); ++c )
+			attachments.push_back( GL_SUFFIX(GL_COLOR_ATTACHMENT0_) + c );
+	}
+	if( ( mask & GL_DEPTH_BUFFER_BIT ) && mObj->mFormat.mDepthBuffer )
+		attachments.push_back( GL_SUFFIX(GL_DEPTH_ATTACHMENT_) );
+	if( attachments.empty() )
+		return;
 
-	mObj->mNeedsResolve = false;
+	SaveFramebufferBinding saveFboBinding;
+	StateCache::bindFramebuffer( GL_SUFFIX(GL_FRAMEBUFFER_), mObj->mId );
+	invalidateBoundFramebuffer( attachments );
 }
 
 void Fbo::updateMipmaps( bool bindFirst, int attachment ) const
 {
-	if( ! mObj->mNeedsMipmapUpdate )
+	if( ! mObj->mNeedsMipmapUpdate[attachment] )
 		return;
 	
 	if( bindFirst ) {
@@ -408,23 +499,56 @@ void Fbo::updateMipmaps( bool bindFirst, int attachment ) const
 		GL_SUFFIX(glGenerateMipmap)( getTarget() );
 	}
 
-	mObj->mNeedsMipmapUpdate = false;
+	mObj->mNeedsMipmapUpdate[attachment] = false;
+}
+
+// Marks color attachment \a attachment, or all of them when negative, and the depth buffer as drawn to
+void Fbo::markDirty( int attachment )
+{
+	bool multisampled = mObj->mResolveFramebufferId != 0;
+	bool mipmapped = mObj->mFormat.hasMipMapping();
+	for( size_t c = 0; c < mObj->mColorTextures.size(); ++c ) {
+		if( ( attachment >= 0 ) && ( (int)c != attachment ) )
+			continue;
+		if( multisampled )
+			mObj->mNeedsResolve[c] = true;
+		if( mipmapped )
+			mObj->mNeedsMipmapUpdate[c] = true;
+	}
+	if( multisampled && mObj->mDepthTexture )
+		mObj->mDepthNeedsResolve = true;
 }
 
 void Fbo::bindFramebuffer()
 {
-	GL_SUFFIX(glBindFramebuffer)( GL_SUFFIX(GL_FRAMEBUFFER_), mObj->mId );
-	if( mObj->mResolveFramebufferId ) {
-		mObj->mNeedsResolve = true;
+	StateCache::bindFramebuffer( GL_SUFFIX(GL_FRAMEBUFFER_), mObj->mId );
+#if ! defined( CINDER_GLES )
+	if( mObj->mDrawAttachment >= 0 ) {
+		vector<GLenum> drawBuffers;
+		for( size_t c = 0; c < mObj->mColorTextures.size(); ++c )
+			drawBuffers.push_back( GL_COLOR_ATTACHMENT0_EXT + c );
+		glDrawBuffers( drawBuffers.size(), &drawBuffers[0] );
+		mObj->mDrawAttachment = -1;
 	}
-	if( mObj->mFormat.hasMipMapping() ) {
-		mObj->mNeedsMipmapUpdate = true;
+#endif
+	markDirty( -1 );
+}
+
+void Fbo::bindFramebuffer( int attachment )
+{
+	StateCache::bindFramebuffer( GL_SUFFIX(GL_FRAMEBUFFER_), mObj->mId );
+#if ! defined( CINDER_GLES )
+	if( ( mObj->mColorTextures.size() > 1 ) && ( mObj->mDrawAttachment != attachment ) ) {
+		glDrawBuffer( GL_COLOR_ATTACHMENT0_EXT + attachment );
+		mObj->mDrawAttachment = attachment;
 	}
+#endif
+	markDirty( attachment );
 }
 
 void Fbo::unbindFramebuffer()
 {
-	GL_SUFFIX(glBindFramebuffer)( GL_SUFFIX(GL_FRAMEBUFFER_), 0 );
+	StateCache::bindFramebuffer( GL_SUFFIX(GL_FRAMEBUFFER_), 0 );
 }
 
 bool Fbo::checkStatus( FboExceptionInvalidSpecification *resultExc )
@@ -500,8 +624,8 @@ void Fbo::blitTo( Fbo dst, const Area &srcArea, const Area &dstArea, GLenum filt
 {
 	SaveFramebufferBinding saveFboBinding;
 
-	glBindFramebufferEXT( GL_READ_FRAMEBUFFER_EXT, mObj->mId );
-	glBindFramebufferEXT( GL_DRAW_FRAMEBUFFER_EXT, dst.getId() );		
+	StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, mObj->mId );
+	StateCache::bindFramebuffer( GL_DRAW_FRAMEBUFFER_EXT, dst.getId() );		
 	glBlitFramebufferEXT( srcArea.getX1(), srcArea.getY1(), srcArea.getX2(), srcArea.getY2(), dstArea.getX1(), dstArea.getY1(), dstArea.getX2(), dstArea.getY2(), mask, filter );
 }
 
@@ -509,8 +633,8 @@ void Fbo::blitToScreen( const Area &srcArea, const Area &dstArea, GLenum filter,
 {
 	SaveFramebufferBinding saveFboBinding;
 
-	glBindFramebufferEXT( GL_READ_FRAMEBUFFER_EXT, mObj->mId );
-	glBindFramebufferEXT( GL_DRAW_FRAMEBUFFER_EXT, 0 );		
+	StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, mObj->mId );
+	StateCache::bindFramebuffer( GL_DRAW_FRAMEBUFFER_EXT, 0 );		
 	glBlitFramebufferEXT( srcArea.getX1(), srcArea.getY1(), srcArea.getX2(), srcArea.getY2(), dstArea.getX1(), dstArea.getY1(), dstArea.getX2(), dstArea.getY2(), mask, filter );
 }
 
@@ -518,8 +642,8 @@ void Fbo::blitFromScreen( const Area &srcArea, const Area &dstArea, GLenum filte
 {
 	SaveFramebufferBinding saveFboBinding;
 
-	glBindFramebufferEXT( GL_READ_FRAMEBUFFER_EXT, GL_NONE );
-	glBindFramebufferEXT( GL_DRAW_FRAMEBUFFER_EXT, mObj->mId );		
+	StateCache::bindFramebuffer( GL_READ_FRAMEBUFFER_EXT, GL_NONE );
+	StateCache::bindFramebuffer( GL_DRAW_FRAMEBUFFER_EXT, mObj->mId );		
 	glBlitFramebufferEXT( srcArea.getX1(), srcArea.getY1(), srcArea.getX2(), srcArea.getY2(), dstArea.getX1(), dstArea.getY1(), dstArea.getX2(), dstArea.getY2(), mask, filter );
 }
 #endif
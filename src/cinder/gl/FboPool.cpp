@@ -0,0 +1,109 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/FboPool.h"
+
+namespace cinder { namespace gl {
+
+FboPool::Key::Key( int width, int height, const Fbo::Format &format )
+{
+	int values[NUM_VALUES] = { width, height, (int)format.getTarget(), (int)format.getColorInternalFormat(), (int)format.getDepthInternalFormat(),
+		format.getSamples(), format.getCoverageSamples(), format.getNumColorBuffers(), format.hasColorBuffer(), format.hasDepthBuffer(),
+		format.hasDepthBufferTexture(), format.hasMipMapping(), format.hasAutoResolve(), (int)format.getWrapS(), (int)format.getWrapT(), (int)format.getMinFilter(), (int)format.getMagFilter() };
+	std::copy( values, values + NUM_VALUES, mValues );
+}
+
+FboPool::FboPool( uint32_t maxIdleFrames )
+	: mFrame( 0 ), mMaxIdleFrames( maxIdleFrames ), mNumCreated( 0 )
+{
+}
+
+Fbo FboPool::acquire( int width, int height, const Fbo::Format &format )
+{
+	std::vector<Entry> &entries = mEntries[Key( width, height, format )];
+	for( std::vector<Entry>::iterator entryIt = entries.begin(); entryIt != entries.end(); ++entryIt ) {
+		if( ! isInUse( *entryIt ) ) {
+			entryIt->mLastUsedFrame = mFrame;
+			return entryIt->mFbo;
+		}
+	}
+
+	entries.push_back( Entry( Fbo( width, height, format ), mFrame ) );
+	++mNumCreated;
+	return entries.back().mFbo;
+}
+
+void FboPool::nextFrame()
+{
+	++mFrame;
+	trim( mMaxIdleFrames );
+}
+
+void FboPool::clear()
+{
+	trim( 0 );
+}
+
+void FboPool::trim( uint32_t maxIdleFrames )
+{
+	for( std::map<Key,std::vector<Entry> >::iterator keyIt = mEntries.begin(); keyIt != mEntries.end(); ) {
+		std::vector<Entry> &entries = keyIt->second;
+		for( size_t e = 0; e < entries.size(); ) {
+			// an Fbo still held elsewhere is never freed, and counts as used this frame
+			if( isInUse( entries[e] ) )
+				entries[e].mLastUsedFrame = mFrame;
+			if( ( ! isInUse( entries[e] ) ) && ( mFrame - entries[e].mLastUsedFrame >= maxIdleFrames ) ) {
+				entries[e] = entries.back();
+				entries.pop_back();
+			}
+			else
+				++e;
+		}
+
+		if( entries.empty() )
+			mEntries.erase( keyIt++ );
+		else
+			++keyIt;
+	}
+}
+
+size_t FboPool::getNumFbos() const
+{
+	size_t result = 0;
+	for( std::map<Key,std::vector<Entry> >::const_iterator keyIt = mEntries.begin(); keyIt != mEntries.end(); ++keyIt )
+		result += keyIt->second.size();
+	return result;
+}
+
+size_t FboPool::getNumInUse() const
+{
+	size_t result = 0;
+	for( std::map<Key,std::vector<Entry> >::const_iterator keyIt = mEntries.begin(); keyIt != mEntries.end(); ++keyIt )
+		for( std::vector<Entry>::const_iterator entryIt = keyIt->second.begin(); entryIt != keyIt->second.end(); ++entryIt )
+			if( isInUse( *entryIt ) )
+				++result;
+	return result;
+}
+
+} } // namespace cinder::gl
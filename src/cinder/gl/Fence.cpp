@@ -0,0 +1,129 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/gl/Fence.h"
+
+namespace cinder { namespace gl {
+
+namespace {
+
+#if defined( CINDER_MSW )
+// GLee predates GL_ARB_sync, so its entry points are loaded by hand
+#define GL_SYNC_GPU_COMMANDS_COMPLETE	0x9117
+#define GL_SYNC_FLUSH_COMMANDS_BIT		0x00000001
+#define GL_TIMEOUT_EXPIRED				0x911B
+#define GL_WAIT_FAILED					0x911D
+
+typedef void* (APIENTRY *FenceSyncProc)( GLenum condition, GLbitfield flags );
+typedef GLenum (APIENTRY *ClientWaitSyncProc)( void *sync, GLbitfield flags, uint64_t timeout );
+typedef void (APIENTRY *DeleteSyncProc)( void *sync );
+
+FenceSyncProc		fenceSync = 0;
+ClientWaitSyncProc	clientWaitSync = 0;
+DeleteSyncProc		deleteSync = 0;
+#endif
+
+} // anonymous namespace
+
+bool Fence::isSupported()
+{
+	static bool supported = false, checked = false;
+	if( ! checked ) {
+#if defined( CINDER_MAC )
+		supported = gl::isExtensionAvailable( "GL_APPLE_fence" );
+#elif defined( CINDER_MSW )
+		if( gl::isExtensionAvailable( "GL_ARB_sync" ) ) {
+			fenceSync = (FenceSyncProc)::wglGetProcAddress( "glFenceSync" );
+			clientWaitSync = (ClientWaitSyncProc)::wglGetProcAddress( "glClientWaitSync" );
+			deleteSync = (DeleteSyncProc)::wglGetProcAddress( "glDeleteSync" );
+			supported = fenceSync && clientWaitSync && deleteSync;
+		}
+#endif
+		checked = true;
+	}
+	return supported;
+}
+
+Fence::Fence()
+	: mSync( 0 )
+{
+	if( ! isSupported() )
+		return;
+#if defined( CINDER_MAC )
+	GLuint fence;
+	glGenFencesAPPLE( 1, &fence );
+	glSetFenceAPPLE( fence );
+	mSync = reinterpret_cast<void*>( (size_t)fence );
+#elif defined( CINDER_MSW )
+	mSync = (*fenceSync)( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+#endif
+}
+
+Fence::~Fence()
+{
+	if( ! mSync )
+		return;
+#if defined( CINDER_MAC )
+	GLuint appleFence = (GLuint)(size_t)mSync;
+	glDeleteFencesAPPLE( 1, &appleFence );
+#elif defined( CINDER_MSW )
+	(*deleteSync)( mSync );
+#endif
+}
+
+bool Fence::isSignaled() const
+{
+	return test( false );
+}
+
+bool Fence::wait() const
+{
+	return test( true );
+}
+
+bool Fence::test( bool wait ) const
+{
+	if( ! mSync )
+		return true;
+#if defined( CINDER_MAC )
+	GLuint appleFence = (GLuint)(size_t)mSync;
+	if( wait ) {
+		glFinishFenceAPPLE( appleFence );
+		return true;
+	}
+	return glTestFenceAPPLE( appleFence ) == GL_TRUE;
+#elif defined( CINDER_MSW )
+	GLenum result;
+	do {
+		// the flush bit guarantees the fence itself reaches the GPU, otherwise an unbounded wait could never return
+		result = (*clientWaitSync)( mSync, GL_SYNC_FLUSH_COMMANDS_BIT, ( wait ) ? 100000000 : 0 );
+	} while( wait && ( result == GL_TIMEOUT_EXPIRED ) );
+	return ( result != GL_TIMEOUT_EXPIRED ) && ( result != GL_WAIT_FAILED );
+#else
+	return true;
+#endif
+}
+
+} } // namespace cinder::gl
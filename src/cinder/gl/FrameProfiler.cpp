@@ -0,0 +1,246 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/FrameProfiler.h"
+#include "cinder/gl/GpuTimer.h"
+#include "cinder/gl/GpuMemory.h"
+
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+
+namespace cinder { namespace gl {
+
+FrameProfiler::FrameProfiler( int numFramesInFlight )
+	: mCurrentFrame( 0 ), mInFrame( false ), mSegmentOpen( false ), mShowGpuMemory( false )
+{
+	mFrames.resize( std::max( numFramesInFlight, 2 ) );
+	for( size_t f = 0; f < mFrames.size(); ++f )
+		mFrames[f].mPending = false;
+}
+
+FrameProfiler::~FrameProfiler()
+{
+#if ! defined( CINDER_GLES )
+	for( size_t f = 0; f < mFrames.size(); ++f )
+		if( ! mFrames[f].mQueries.empty() )
+			glDeleteQueries( (GLsizei)mFrames[f].mQueries.size(), &mFrames[f].mQueries[0] );
+#endif
+}
+
+void FrameProfiler::beginFrame()
+{
+	if( mInFrame )
+		endFrame();
+
+	collect();
+	Frame &frame = mFrames[mCurrentFrame];
+	// if the GPU is still a whole ring behind, the oldest frame is abandoned rather than waited on
+	frame.mPending = false;
+	frame.mRecords.clear();
+	frame.mSegments.clear();
+	mStack.clear();
+	mInFrame = true;
+	mTimer.start();
+}
+
+void FrameProfiler::endFrame()
+{
+	if( ! mInFrame )
+		return;
+
+	while( ! mStack.empty() )
+		popScope();
+	endSegment();
+	mTimer.stop();
+	mInFrame = false;
+	mFrames[mCurrentFrame].mPending = true;
+	mCurrentFrame = ( mCurrentFrame + 1 ) % mFrames.size();
+	collect();
+}
+
+void FrameProfiler::pushScope( const std::string &name, bool gpu )
+{
+	if( ! mInFrame )
+		return;
+
+	Frame &frame = mFrames[mCurrentFrame];
+	Record record;
+	record.mName = name;
+	record.mDepth = (int)mStack.size();
+	record.mParent = ( mStack.empty() ) ? -1 : mStack.back();
+	record.mCpuStart = mTimer.getSeconds();
+	record.mCpuSeconds = record.mGpuSeconds = 0;
+	record.mGpu = gpu && GpuTimer::isSupported();
+	frame.mRecords.push_back( record );
+	mStack.push_back( (int)frame.mRecords.size() - 1 );
+
+	// a scope without GPU timing leaves the enclosing segment running, so its GPU work still counts towards its ancestors
+	if( record.mGpu ) {
+		endSegment();
+		beginSegment( mStack.back() );
+	}
+}
+
+void FrameProfiler::popScope()
+{
+	if( mStack.empty() )
+		return;
+
+	Frame &frame = mFrames[mCurrentFrame];
+	Record &record = frame.mRecords[mStack.back()];
+	record.mCpuSeconds = mTimer.getSeconds() - record.mCpuStart;
+	bool gpu = record.mGpu;
+	mStack.pop_back();
+
+	if( gpu ) {
+		endSegment();
+		// resume timing the nearest enclosing GPU scope
+		for( std::vector<int>::reverse_iterator stackIt = mStack.rbegin(); stackIt != mStack.rend(); ++stackIt ) {
+			if( frame.mRecords[*stackIt].mGpu ) {
+				beginSegment( *stackIt );
+				break;
+			}
+		}
+	}
+}
+
+void FrameProfiler::beginSegment( int record )
+{
+#if ! defined( CINDER_GLES )
+	Frame &frame = mFrames[mCurrentFrame];
+	if( frame.mSegments.size() == frame.mQueries.size() ) {
+		GLuint query;
+		glGenQueries( 1, &query );
+		frame.mQueries.push_back( query );
+	}
+	Segment segment;
+	segment.mRecord = record;
+	segment.mQuery = frame.mQueries[frame.mSegments.size()];
+	frame.mSegments.push_back( segment );
+	glBeginQuery( GL_TIME_ELAPSED_EXT, segment.mQuery );
+	mSegmentOpen = true;
+#endif
+}
+
+void FrameProfiler::endSegment()
+{
+#if ! defined( CINDER_GLES )
+	if( mSegmentOpen )
+		glEndQuery( GL_TIME_ELAPSED_EXT );
+#endif
+	mSegmentOpen = false;
+}
+
+void FrameProfiler::collect()
+{
+	// frames after mCurrentFrame are the oldest, up to the one most recently ended
+	for( size_t i = 0; i < mFrames.size(); ++i ) {
+		Frame &frame = mFrames[( mCurrentFrame + i ) % mFrames.size()];
+		if( ! frame.mPending )
+			continue;
+
+		std::vector<double> results( frame.mSegments.size() );
+		bool available = true;
+		for( size_t s = frame.mSegments.size(); s > 0 && available; --s )
+			available = detail::getTimeElapsedQueryResult( frame.mSegments[s - 1].mQuery, &results[s - 1] );
+		if( ! available )
+			break;
+
+		for( size_t s = 0; s < frame.mSegments.size(); ++s )
+			frame.mRecords[frame.mSegments[s].mRecord].mGpuSeconds += results[s];
+		frame.mPending = false;
+		publish( &frame );
+	}
+}
+
+void FrameProfiler::publish( Frame *frame )
+{
+	std::vector<Record> &records = frame->mRecords;
+	// children always follow their parents, so walking backwards turns exclusive GPU times into inclusive ones
+	for( size_t r = records.size(); r > 0; --r )
+		if( records[r - 1].mParent >= 0 )
+			records[records[r - 1].mParent].mGpuSeconds += records[r - 1].mGpuSeconds;
+
+	mResults.resize( records.size() );
+	mResultPaths.resize( records.size() );
+	for( size_t r = 0; r < records.size(); ++r ) {
+		Node &node = mResults[r];
+		node.mName = records[r].mName;
+		node.mDepth = records[r].mDepth;
+		node.mCpuSeconds = records[r].mCpuSeconds;
+		node.mGpuSeconds = records[r].mGpuSeconds;
+		node.mHasGpu = records[r].mGpu;
+		mResultPaths[r] = ( ( records[r].mParent >= 0 ) ? mResultPaths[records[r].mParent] + "/" : std::string() ) + node.mName;
+
+		std::map<std::string,std::string>::iterator paramIt = mParamStrings.find( mResultPaths[r] );
+		if( paramIt != mParamStrings.end() ) {
+			std::ostringstream ss;
+			ss << std::fixed << std::setprecision( 2 ) << "cpu " << node.mCpuSeconds * 1000 << " ms";
+			if( node.mHasGpu )
+				ss << ", gpu " << node.mGpuSeconds * 1000 << " ms";
+			paramIt->second = ss.str();
+		}
+	}
+}
+
+std::string FrameProfiler::getResultsString() const
+{
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision( 2 );
+	for( std::vector<Node>::const_iterator nodeIt = mResults.begin(); nodeIt != mResults.end(); ++nodeIt ) {
+		ss << std::string( nodeIt->mDepth * 2, ' ' ) << nodeIt->mName << ": cpu " << nodeIt->mCpuSeconds * 1000 << " ms";
+		if( nodeIt->mHasGpu )
+			ss << ", gpu " << nodeIt->mGpuSeconds * 1000 << " ms";
+		ss << std::endl;
+	}
+	if( mShowGpuMemory )
+		ss << GpuMemory::getSummary() << std::endl;
+	return ss.str();
+}
+
+void FrameProfiler::draw( const Vec2f &pos, const ColorA &color, Font font ) const
+{
+	std::istringstream lines( getResultsString() );
+	float lineHeight = ( font ) ? ( font.getAscent() + font.getDescent() + font.getLeading() ) : 14.0f;
+	Vec2f linePos = pos;
+	std::string line;
+	while( std::getline( lines, line ) ) {
+		gl::drawString( line, linePos, color, font );
+		linePos.y += lineHeight;
+	}
+}
+
+void FrameProfiler::addParams( params::InterfaceGl &params )
+{
+	for( size_t r = 0; r < mResults.size(); ++r ) {
+		if( mParamStrings.find( mResultPaths[r] ) != mParamStrings.end() )
+			continue;
+		std::string &value = mParamStrings[mResultPaths[r]];
+		value = "";
+		params.addParam( mResultPaths[r], &value, "label='" + std::string( mResults[r].mDepth * 2, ' ' ) + mResults[r].mName + "'", true );
+	}
+}
+
+} } // namespace cinder::gl
@@ -0,0 +1,352 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/GlslPermutations.h"
+#include "cinder/Function.h"
+
+#include <algorithm>
+
+#if defined( CINDER_MAC )
+	#include <OpenGL/OpenGL.h>
+#endif
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+std::string sourceFromDataSource( DataSourceRef source )
+{
+	Buffer buffer = source->getBuffer();
+	return std::string( reinterpret_cast<const char*>( buffer.getData() ), buffer.getDataSize() );
+}
+
+// sorting makes the key independent of the order the defines were listed in
+std::string makeKey( const GlslPermutations::Defines &defines )
+{
+	GlslPermutations::Defines sorted( defines );
+	std::sort( sorted.begin(), sorted.end() );
+	std::string result;
+	for( GlslPermutations::Defines::const_iterator defineIt = sorted.begin(); defineIt != sorted.end(); ++defineIt ) {
+		result += *defineIt;
+		result += '\n';
+	}
+	return result;
+}
+
+// Creates a context sharing objects with the current one, which a worker thread can make current. Returns false if there is no current context.
+bool createSharedContext( void **context, void **device )
+{
+#if defined( CINDER_MAC )
+	CGLContextObj current = ::CGLGetCurrentContext();
+	CGLContextObj result = 0;
+	if( ( ! current ) || ( ::CGLCreateContext( ::CGLGetPixelFormat( current ), current, &result ) != kCGLNoError ) )
+		return false;
+	*context = result;
+	*device = 0;
+	return true;
+#elif defined( CINDER_MSW )
+	HGLRC current = ::wglGetCurrentContext();
+	HDC dc = ::wglGetCurrentDC();
+	if( ! current )
+		return false;
+	HGLRC result = ::wglCreateContext( dc );
+	if( ! result )
+		return false;
+	if( ! ::wglShareLists( current, result ) ) {
+		::wglDeleteContext( result );
+		return false;
+	}
+	*context = result;
+	*device = dc;
+	return true;
+#else
+	return false;
+#endif
+}
+
+void makeContextCurrent( void *context, void *device )
+{
+#if defined( CINDER_MAC )
+	::CGLSetCurrentContext( reinterpret_cast<CGLContextObj>( context ) );
+#elif defined( CINDER_MSW )
+	::wglMakeCurrent( reinterpret_cast<HDC>( device ), reinterpret_cast<HGLRC>( context ) );
+#endif
+}
+
+void destroySharedContext( void *context )
+{
+#if defined( CINDER_MAC )
+	::CGLDestroyContext( reinterpret_cast<CGLContextObj>( context ) );
+#elif defined( CINDER_MSW )
+	::wglDeleteContext( reinterpret_cast<HGLRC>( context ) );
+#endif
+}
+
+} // anonymous namespace
+
+GlslPermutationsRef GlslPermutations::create( DataSourceRef vertexShader, DataSourceRef fragmentShader, DataSourceRef geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices )
+{
+	std::string vertexSource, fragmentSource, geometrySource;
+	if( vertexShader )
+		vertexSource = sourceFromDataSource( vertexShader );
+	if( fragmentShader )
+		fragmentSource = sourceFromDataSource( fragmentShader );
+	if( geometryShader )
+		geometrySource = sourceFromDataSource( geometryShader );
+
+	return GlslPermutationsRef( new GlslPermutations( ( vertexShader ) ? &vertexSource : 0, ( fragmentShader ) ? &fragmentSource : 0, ( geometryShader ) ? &geometrySource : 0,
+		geometryInputType, geometryOutputType, geometryOutputVertices ) );
+}
+
+GlslPermutationsRef GlslPermutations::create( const char *vertexShader, const char *fragmentShader, const char *geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices )
+{
+	std::string vertexSource( ( vertexShader ) ? vertexShader : "" ), fragmentSource( ( fragmentShader ) ? fragmentShader : "" ), geometrySource( ( geometryShader ) ? geometryShader : "" );
+	return GlslPermutationsRef( new GlslPermutations( ( vertexShader ) ? &vertexSource : 0, ( fragmentShader ) ? &fragmentSource : 0, ( geometryShader ) ? &geometrySource : 0,
+		geometryInputType, geometryOutputType, geometryOutputVertices ) );
+}
+
+GlslPermutations::GlslPermutations( const std::string *vertexShader, const std::string *fragmentShader, const std::string *geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices )
+	: mWorkerContext( 0 ), mWorkerDevice( 0 ), mWorkerBusy( false ), mShutdown( false )
+{
+	const std::string *sources[3] = { vertexShader, fragmentShader, geometryShader };
+	for( int s = 0; s < 3; ++s ) {
+		mHasSource[s] = sources[s] != 0;
+		if( sources[s] )
+			mSources[s] = *sources[s];
+	}
+	mGeometryParams[0] = geometryInputType;
+	mGeometryParams[1] = geometryOutputType;
+	mGeometryParams[2] = geometryOutputVertices;
+}
+
+GlslPermutations::~GlslPermutations()
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		mShutdown = true;
+		mWarmupQueue.clear();
+	}
+	mCompiledCond.notify_all();
+
+	if( mThread )
+		mThread->join();
+	if( mWorkerContext )
+		destroySharedContext( mWorkerContext );
+}
+
+bool GlslPermutations::supportsBackgroundCompilation()
+{
+#if defined( CINDER_MAC ) || defined( CINDER_MSW )
+	return true;
+#else
+	return false;
+#endif
+}
+
+std::string GlslPermutations::injectDefines( const std::string &source, const Defines &defines )
+{
+	std::string block;
+	for( Defines::const_iterator defineIt = defines.begin(); defineIt != defines.end(); ++defineIt )
+		block += "#define " + *defineIt + "\n";
+
+	// #version has to stay the first directive
+	size_t version = source.find( "#version" );
+	if( version == std::string::npos )
+		return block + source;
+	size_t lineEnd = source.find( '\n', version );
+	if( lineEnd == std::string::npos )
+		return source + "\n" + block;
+	return source.substr( 0, lineEnd + 1 ) + block + source.substr( lineEnd + 1 );
+}
+
+void GlslPermutations::compile( const Defines &defines, GlslProg *prog, std::shared_ptr<GlslProgCompileExc> *error ) const
+{
+	std::string sources[3];
+	for( int s = 0; s < 3; ++s )
+		if( mHasSource[s] )
+			sources[s] = injectDefines( mSources[s], defines );
+
+	try {
+		*prog = GlslProg( ( mHasSource[0] ) ? sources[0].c_str() : 0, ( mHasSource[1] ) ? sources[1].c_str() : 0, ( mHasSource[2] ) ? sources[2].c_str() : 0,
+			mGeometryParams[0], mGeometryParams[1], mGeometryParams[2] );
+	}
+	catch( GlslProgCompileExc &exc ) {
+		*error = std::shared_ptr<GlslProgCompileExc>( new GlslProgCompileExc( exc ) );
+	}
+}
+
+void GlslPermutations::store( const std::string &key, const GlslProg &prog, const std::shared_ptr<GlslProgCompileExc> &error )
+{
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		Permutation &permutation = mPermutations[key];
+		permutation.mProg = prog;
+		permutation.mError = error;
+		permutation.mState = COMPILED;
+	}
+	mCompiledCond.notify_all();
+}
+
+GlslProg GlslPermutations::get( const Defines &defines )
+{
+	const std::string key = makeKey( defines );
+	std::unique_lock<std::mutex> lock( mMutex );
+	while( true ) {
+		// references to the elements of an unordered_map survive rehashing, so this stays valid across the waits
+		Permutation &permutation = mPermutations[key];
+		if( permutation.mState == COMPILED ) {
+			if( permutation.mError )
+				throw *permutation.mError;
+			return permutation.mProg;
+		}
+		else if( permutation.mState == QUEUED ) {
+			permutation.mState = COMPILING_HERE;
+			lock.unlock();
+			GlslProg prog;
+			std::shared_ptr<GlslProgCompileExc> error;
+			compile( defines, &prog, &error );
+			store( key, prog, error );
+			lock.lock();
+		}
+		else
+			mCompiledCond.wait( lock );
+	}
+}
+
+void GlslPermutations::warmup( const std::vector<Defines> &permutations )
+{
+	bool background = false;
+	{
+		std::lock_guard<std::mutex> lock( mMutex );
+		if( ( ! mThread ) && supportsBackgroundCompilation() && createSharedContext( &mWorkerContext, &mWorkerDevice ) )
+			mThread = std::shared_ptr<std::thread>( new std::thread( std::bind( &GlslPermutations::workerThread, this ) ) );
+		background = mThread.get() != 0;
+
+		if( background ) {
+			for( vector<Defines>::const_iterator defineIt = permutations.begin(); defineIt != permutations.end(); ++defineIt ) {
+				const std::string key = makeKey( *defineIt );
+				if( mPermutations.find( key ) != mPermutations.end() )
+					continue;
+				mPermutations[key].mDefines = *defineIt;
+				mWarmupQueue.push_back( key );
+			}
+		}
+	}
+
+	if( background )
+		mCompiledCond.notify_all();
+	else {
+		for( vector<Defines>::const_iterator defineIt = permutations.begin(); defineIt != permutations.end(); ++defineIt ) {
+			try {
+				get( *defineIt );
+			}
+			catch( GlslProgCompileExc & ) { // rethrown when it is requested
+			}
+		}
+	}
+}
+
+void GlslPermutations::waitForWarmup()
+{
+	std::unique_lock<std::mutex> lock( mMutex );
+	while( ( ! mWarmupQueue.empty() ) || mWorkerBusy )
+		mCompiledCond.wait( lock );
+}
+
+void GlslPermutations::workerThread()
+{
+	ThreadSetup threadSetup;
+	makeContextCurrent( mWorkerContext, mWorkerDevice );
+
+	std::unique_lock<std::mutex> lock( mMutex );
+	while( true ) {
+		while( mWarmupQueue.empty() && ( ! mShutdown ) )
+			mCompiledCond.wait( lock );
+		if( mShutdown )
+			break;
+
+		const std::string key = mWarmupQueue.front();
+		mWarmupQueue.pop_front();
+		Permutation &permutation = mPermutations[key];
+		if( permutation.mState != QUEUED ) { // get() already took it
+			if( mWarmupQueue.empty() )
+				mCompiledCond.notify_all();
+			continue;
+		}
+		permutation.mState = COMPILING_WORKER;
+		const Defines defines = permutation.mDefines;
+		mWorkerBusy = true;
+		lock.unlock();
+
+		GlslProg prog;
+		std::shared_ptr<GlslProgCompileExc> error;
+		compile( defines, &prog, &error );
+		// the program has to be complete before another context may use it
+		glFinish();
+
+		lock.lock();
+		mWorkerBusy = false;
+		Permutation &compiled = mPermutations[key];
+		compiled.mProg = prog;
+		compiled.mError = error;
+		compiled.mState = COMPILED;
+		mCompiledCond.notify_all();
+	}
+
+	lock.unlock();
+	makeContextCurrent( 0, 0 );
+}
+
+bool GlslPermutations::isCompiled( const Defines &defines ) const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	boost::unordered_map<std::string,Permutation>::const_iterator permIt = mPermutations.find( makeKey( defines ) );
+	return ( permIt != mPermutations.end() ) && ( permIt->second.mState == COMPILED );
+}
+
+size_t GlslPermutations::getNumCompiled() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	size_t result = 0;
+	for( boost::unordered_map<std::string,Permutation>::const_iterator permIt = mPermutations.begin(); permIt != mPermutations.end(); ++permIt )
+		if( permIt->second.mState == COMPILED )
+			++result;
+	return result;
+}
+
+size_t GlslPermutations::getNumPendingWarmups() const
+{
+	std::lock_guard<std::mutex> lock( mMutex );
+	size_t result = ( mWorkerBusy ) ? 1 : 0;
+	for( deque<std::string>::const_iterator keyIt = mWarmupQueue.begin(); keyIt != mWarmupQueue.end(); ++keyIt ) {
+		boost::unordered_map<std::string,Permutation>::const_iterator permIt = mPermutations.find( *keyIt );
+		if( ( permIt != mPermutations.end() ) && ( permIt->second.mState == QUEUED ) )
+			++result;
+	}
+	return result;
+}
+
+} } // namespace cinder::gl
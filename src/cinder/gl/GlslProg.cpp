@@ -22,61 +22,189 @@
 
 #include "cinder/gl/gl.h"
 #include "cinder/gl/GlslProg.h"
+#include "cinder/gl/StateCache.h"
+
+#include <vector>
+#include <cstring>
 
 using namespace std;
 
+// GLee predates GL_ARB_uniform_buffer_object
+#if ! defined( GL_UNIFORM_BUFFER )
+	#define GL_UNIFORM_BUFFER				0x8A11
+	#define GL_UNIFORM_OFFSET				0x8A3B
+	#define GL_UNIFORM_BLOCK_DATA_SIZE		0x8A40
+	#define GL_INVALID_INDEX				0xFFFFFFFFu
+#endif
+// ...and GL_ARB_get_program_binary
+#if ! defined( GL_PROGRAM_BINARY_RETRIEVABLE_HINT )
+	#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT	0x8257
+	#define GL_PROGRAM_BINARY_LENGTH			0x8741
+	#define GL_NUM_PROGRAM_BINARY_FORMATS		0x87FE
+#endif
+
 namespace cinder { namespace gl {
 
+#if defined( CINDER_MSW )
+namespace {
+
+typedef GLuint (APIENTRY *GetUniformBlockIndexProc)( GLuint program, const GLchar *uniformBlockName );
+typedef void (APIENTRY *UniformBlockBindingProc)( GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding );
+typedef void (APIENTRY *GetActiveUniformBlockivProc)( GLuint program, GLuint uniformBlockIndex, GLenum pname, GLint *params );
+typedef void (APIENTRY *GetUniformIndicesProc)( GLuint program, GLsizei uniformCount, const GLchar **uniformNames, GLuint *uniformIndices );
+typedef void (APIENTRY *GetActiveUniformsivProc)( GLuint program, GLsizei uniformCount, const GLuint *uniformIndices, GLenum pname, GLint *params );
+
+GetUniformBlockIndexProc		glGetUniformBlockIndex = 0;
+UniformBlockBindingProc			glUniformBlockBinding = 0;
+GetActiveUniformBlockivProc		glGetActiveUniformBlockiv = 0;
+GetUniformIndicesProc			glGetUniformIndices = 0;
+GetActiveUniformsivProc			glGetActiveUniformsiv = 0;
+
+bool loadUniformBufferFunctions()
+{
+	glGetUniformBlockIndex = (GetUniformBlockIndexProc)::wglGetProcAddress( "glGetUniformBlockIndex" );
+	glUniformBlockBinding = (UniformBlockBindingProc)::wglGetProcAddress( "glUniformBlockBinding" );
+	glGetActiveUniformBlockiv = (GetActiveUniformBlockivProc)::wglGetProcAddress( "glGetActiveUniformBlockiv" );
+	glGetUniformIndices = (GetUniformIndicesProc)::wglGetProcAddress( "glGetUniformIndices" );
+	glGetActiveUniformsiv = (GetActiveUniformsivProc)::wglGetProcAddress( "glGetActiveUniformsiv" );
+	return glGetUniformBlockIndex && glUniformBlockBinding && glGetActiveUniformBlockiv && glGetUniformIndices && glGetActiveUniformsiv;
+}
+
+typedef void (APIENTRY *GetProgramBinaryProc)( GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, GLvoid *binary );
+typedef void (APIENTRY *ProgramBinaryProc)( GLuint program, GLenum binaryFormat, const GLvoid *binary, GLsizei length );
+typedef void (APIENTRY *ProgramParameteriProc)( GLuint program, GLenum pname, GLint value );
+
+GetProgramBinaryProc	glGetProgramBinary = 0;
+ProgramBinaryProc		glProgramBinary = 0;
+ProgramParameteriProc	glProgramParameteri = 0;
+
+bool loadProgramBinaryFunctions()
+{
+	glGetProgramBinary = (GetProgramBinaryProc)::wglGetProcAddress( "glGetProgramBinary" );
+	glProgramBinary = (ProgramBinaryProc)::wglGetProcAddress( "glProgramBinary" );
+	glProgramParameteri = (ProgramParameteriProc)::wglGetProcAddress( "glProgramParameteri" );
+	return glGetProgramBinary && glProgramBinary && glProgramParameteri;
+}
+
+} // anonymous namespace
+#endif
+
 GlslProg::Obj::~Obj()
 {
-	if( mHandle )
+	if( mHandle ) {
 		glDeleteProgram( (GLuint)mHandle );
+		StateCache::programDeleted( mHandle );
+	}
 }
 
 //////////////////////////////////////////////////////////////////////////
 // GlslProg
-    GlslProg::GlslProg( DataSourceRef vertexShader, DataSourceRef fragmentShader, DataSourceRef geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices)
+namespace {
+
+std::string sourceFromDataSource( DataSourceRef source )
+{
+	Buffer buffer = source->getBuffer();
+	return std::string( reinterpret_cast<const char*>( buffer.getData() ), buffer.getDataSize() );
+}
+
+// 64-bit FNV-1a, folded over each piece of the key in turn
+void hashBytes( uint64_t *hash, const void *data, size_t size )
+{
+	const uint8_t *bytes = reinterpret_cast<const uint8_t*>( data );
+	for( size_t i = 0; i < size; ++i ) {
+		*hash ^= bytes[i];
+		*hash *= 1099511628211ULL;
+	}
+}
+
+void hashString( uint64_t *hash, const char *str )
+{
+	if( str )
+		hashBytes( hash, str, strlen( str ) + 1 ); // includes the terminator so adjacent strings can't run together
+	else
+		hashBytes( hash, "", 1 );
+}
+
+fs::path& binaryCacheDirectory()
+{
+	static fs::path sDirectory;
+	return sDirectory;
+}
+
+const char BINARY_CACHE_MAGIC[4] = { 'C', 'G', 'P', 'B' };
+
+} // anonymous namespace
+
+GlslProg::GlslProg( DataSourceRef vertexShader, DataSourceRef fragmentShader, DataSourceRef geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices)
 	: mObj( shared_ptr<Obj>( new Obj ) )
 {
-	mObj->mHandle = glCreateProgram();
-	
-	if ( vertexShader )
-		loadShader( vertexShader->getBuffer(), GL_VERTEX_SHADER_ARB );
-    
+	std::string vertexSource, fragmentSource, geometrySource;
+	if( vertexShader )
+		vertexSource = sourceFromDataSource( vertexShader );
 	if( fragmentShader )
-		loadShader( fragmentShader->getBuffer(), GL_FRAGMENT_SHADER_ARB );
-    
-	if( geometryShader ) {
-		loadShader( geometryShader->getBuffer(), GL_GEOMETRY_SHADER_EXT );
-        
-        glProgramParameteriEXT(mObj->mHandle, GL_GEOMETRY_INPUT_TYPE_EXT, geometryInputType);
-        glProgramParameteriEXT(mObj->mHandle, GL_GEOMETRY_OUTPUT_TYPE_EXT, geometryOutputType);
-        glProgramParameteriEXT(mObj->mHandle, GL_GEOMETRY_VERTICES_OUT_EXT, geometryOutputVertices);
-    }
-    
-	link();
+		fragmentSource = sourceFromDataSource( fragmentShader );
+	if( geometryShader )
+		geometrySource = sourceFromDataSource( geometryShader );
+
+	initialize( ( vertexShader ) ? vertexSource.c_str() : 0, ( fragmentShader ) ? fragmentSource.c_str() : 0, ( geometryShader ) ? geometrySource.c_str() : 0,
+		geometryInputType, geometryOutputType, geometryOutputVertices );
 }
 
 GlslProg::GlslProg( const char *vertexShader, const char *fragmentShader, const char *geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices)
 	: mObj( shared_ptr<Obj>( new Obj ) )
+{
+	initialize( vertexShader, fragmentShader, geometryShader, geometryInputType, geometryOutputType, geometryOutputVertices );
+}
+
+void GlslProg::initialize( const char *vertexShader, const char *fragmentShader, const char *geometryShader, GLint geometryInputType, GLint geometryOutputType, GLint geometryOutputVertices )
 {
 	mObj->mHandle = glCreateProgram();
-	
-	if ( vertexShader )
+
+	std::string cacheKey;
+	if( ( ! binaryCacheDirectory().empty() ) && supportsProgramBinaries() ) {
+		uint64_t hash = 14695981039346656037ULL;
+		hashString( &hash, reinterpret_cast<const char*>( glGetString( GL_VENDOR ) ) );
+		hashString( &hash, reinterpret_cast<const char*>( glGetString( GL_RENDERER ) ) );
+		hashString( &hash, reinterpret_cast<const char*>( glGetString( GL_VERSION ) ) );
+		hashString( &hash, vertexShader );
+		hashString( &hash, fragmentShader );
+		hashString( &hash, geometryShader );
+		if( geometryShader ) {
+			GLint geometryParams[3] = { geometryInputType, geometryOutputType, geometryOutputVertices };
+			hashBytes( &hash, geometryParams, sizeof(geometryParams) );
+		}
+		std::ostringstream ss;
+		ss << std::hex;
+		ss.width( 16 );
+		ss.fill( '0' );
+		ss << hash;
+		cacheKey = ss.str();
+
+		if( loadBinary( cacheKey ) )
+			return;
+#if defined( CINDER_MSW )
+		glProgramParameteri( mObj->mHandle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
+#endif
+	}
+
+	if( vertexShader )
 		loadShader( vertexShader, GL_VERTEX_SHADER_ARB );
-    
+
 	if( fragmentShader )
 		loadShader( fragmentShader, GL_FRAGMENT_SHADER_ARB );
-    
+
 	if( geometryShader ) {
 		loadShader( geometryShader, GL_GEOMETRY_SHADER_EXT );
-        
-        glProgramParameteriEXT(mObj->mHandle, GL_GEOMETRY_INPUT_TYPE_EXT, geometryInputType);
-        glProgramParameteriEXT(mObj->mHandle, GL_GEOMETRY_OUTPUT_TYPE_EXT, geometryOutputType);
-        glProgramParameteriEXT(mObj->mHandle, GL_GEOMETRY_VERTICES_OUT_EXT, geometryOutputVertices);
-    }
-    
+
+		glProgramParameteriEXT( mObj->mHandle, GL_GEOMETRY_INPUT_TYPE_EXT, geometryInputType );
+		glProgramParameteriEXT( mObj->mHandle, GL_GEOMETRY_OUTPUT_TYPE_EXT, geometryOutputType );
+		glProgramParameteriEXT( mObj->mHandle, GL_GEOMETRY_VERTICES_OUT_EXT, geometryOutputVertices );
+	}
+
 	link();
+
+	if( ! cacheKey.empty() )
+		saveBinary( cacheKey );
 }
 
 void GlslProg::loadShader( Buffer shaderSourceBuffer, GLint shaderType )
@@ -111,12 +239,12 @@ void GlslProg::link()
 
 void GlslProg::bind() const
 {
-	glUseProgram( mObj->mHandle );
+	StateCache::useProgram( mObj->mHandle );
 }
 
 void GlslProg::unbind()
 {
-	glUseProgram( 0 );
+	StateCache::useProgram( 0 );
 }
 
 std::string GlslProg::getShaderLog( GLuint handle ) const
@@ -139,103 +267,167 @@ std::string GlslProg::getShaderLog( GLuint handle ) const
 
 void GlslProg::uniform( const std::string &name, int data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform1i( loc, data );
+	uniform( getUniformLocation( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec2i &data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform2i( loc, data.x, data.y );
+	uniform( getUniformLocation( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const int *data, int count )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform1iv( loc, count, data );
+	uniform( getUniformLocation( name ), data, count );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec2i *data, int count )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform2iv( loc, count, &data[0].x );
+	uniform( getUniformLocation( name ), data, count );
 }
 
 void GlslProg::uniform( const std::string &name, float data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform1f( loc, data );
+	uniform( getUniformLocation( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec2f &data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform2f( loc, data.x, data.y );
+	uniform( getUniformLocation( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec3f &data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform3f( loc, data.x, data.y, data.z );
+	uniform( getUniformLocation( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec4f &data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform4f( loc, data.x, data.y, data.z, data.w );
+	uniform( getUniformLocation( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const Color &data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform3f( loc, data.r, data.g, data.b );
+	uniform( getUniformLocation( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const ColorA &data )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform4f( loc, data.r, data.g, data.b, data.a );
+	uniform( getUniformLocation( name ), data );
 }
 
 void GlslProg::uniform( const std::string &name, const float *data, int count )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform1fv( loc, count, data );
+	uniform( getUniformLocation( name ), data, count );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec2f *data, int count )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform2fv( loc, count, &data[0].x );
+	uniform( getUniformLocation( name ), data, count );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec3f *data, int count )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform3fv( loc, count, &data[0].x );
+	uniform( getUniformLocation( name ), data, count );
 }
 
 void GlslProg::uniform( const std::string &name, const Vec4f *data, int count )
 {
-	GLint loc = getUniformLocation( name );
-	glUniform4fv( loc, count, &data[0].x );
+	uniform( getUniformLocation( name ), data, count );
 }
 
 void GlslProg::uniform( const std::string &name, const Matrix33f &data, bool transpose )
 {
-	GLint loc = getUniformLocation( name );
-	glUniformMatrix3fv( loc, 1, ( transpose ) ? GL_TRUE : GL_FALSE, data.m );
+	uniform( getUniformLocation( name ), data, transpose );
 }
 
 void GlslProg::uniform( const std::string &name, const Matrix44f &data, bool transpose )
 {
-	GLint loc = getUniformLocation( name );
-	glUniformMatrix4fv( loc, 1, ( transpose ) ? GL_TRUE : GL_FALSE, data.m );
+	uniform( getUniformLocation( name ), data, transpose );
+}
+
+void GlslProg::uniform( GLint location, int data )
+{
+	glUniform1i( location, data );
+}
+
+void GlslProg::uniform( GLint location, const Vec2i &data )
+{
+	glUniform2i( location, data.x, data.y );
+}
+
+void GlslProg::uniform( GLint location, const int *data, int count )
+{
+	glUniform1iv( location, count, data );
+}
+
+void GlslProg::uniform( GLint location, const Vec2i *data, int count )
+{
+	glUniform2iv( location, count, &data[0].x );
+}
+
+void GlslProg::uniform( GLint location, float data )
+{
+	glUniform1f( location, data );
+}
+
+void GlslProg::uniform( GLint location, const Vec2f &data )
+{
+	glUniform2f( location, data.x, data.y );
+}
+
+void GlslProg::uniform( GLint location, const Vec3f &data )
+{
+	glUniform3f( location, data.x, data.y, data.z );
+}
+
+void GlslProg::uniform( GLint location, const Vec4f &data )
+{
+	glUniform4f( location, data.x, data.y, data.z, data.w );
+}
+
+void GlslProg::uniform( GLint location, const Color &data )
+{
+	glUniform3f( location, data.r, data.g, data.b );
+}
+
+void GlslProg::uniform( GLint location, const ColorA &data )
+{
+	glUniform4f( location, data.r, data.g, data.b, data.a );
+}
+
+void GlslProg::uniform( GLint location, const float *data, int count )
+{
+	glUniform1fv( location, count, data );
+}
+
+void GlslProg::uniform( GLint location, const Vec2f *data, int count )
+{
+	glUniform2fv( location, count, &data[0].x );
+}
+
+void GlslProg::uniform( GLint location, const Vec3f *data, int count )
+{
+	glUniform3fv( location, count, &data[0].x );
+}
+
+void GlslProg::uniform( GLint location, const Vec4f *data, int count )
+{
+	glUniform4fv( location, count, &data[0].x );
+}
+
+void GlslProg::uniform( GLint location, const Matrix33f &data, bool transpose )
+{
+	glUniformMatrix3fv( location, 1, ( transpose ) ? GL_TRUE : GL_FALSE, data.m );
+}
+
+void GlslProg::uniform( GLint location, const Matrix44f &data, bool transpose )
+{
+	glUniformMatrix4fv( location, 1, ( transpose ) ? GL_TRUE : GL_FALSE, data.m );
 }
 
 GLint GlslProg::getUniformLocation( const std::string &name )
 {
-	map<string,int>::const_iterator uniformIt = mObj->mUniformLocs.find( name );
+	boost::unordered_map<string,GLint>::const_iterator uniformIt = mObj->mUniformLocs.find( name );
 	if( uniformIt == mObj->mUniformLocs.end() ) {
 		GLint loc = glGetUniformLocation( mObj->mHandle, name.c_str() );
 		mObj->mUniformLocs[name] = loc;
@@ -250,6 +442,152 @@ GLint GlslProg::getAttribLocation( const std::string &name )
 	return glGetAttribLocation( mObj->mHandle, name.c_str() );
 }
 
+bool GlslProg::supportsUniformBuffers()
+{
+	static bool supported = false, checked = false;
+	if( ! checked ) {
+#if defined( CINDER_MAC )
+		supported = gl::isExtensionAvailable( "GL_ARB_uniform_buffer_object" );
+#elif defined( CINDER_MSW )
+		supported = gl::isExtensionAvailable( "GL_ARB_uniform_buffer_object" ) && loadUniformBufferFunctions();
+#endif
+		checked = true;
+	}
+	return supported;
+}
+
+GLuint GlslProg::getUniformBlockIndex( const std::string &name )
+{
+	boost::unordered_map<string,GLuint>::const_iterator blockIt = mObj->mUniformBlockIndices.find( name );
+	if( blockIt != mObj->mUniformBlockIndices.end() )
+		return blockIt->second;
+
+	GLuint index = GL_INVALID_INDEX;
+	if( supportsUniformBuffers() )
+		index = glGetUniformBlockIndex( mObj->mHandle, name.c_str() );
+	mObj->mUniformBlockIndices[name] = index;
+	return index;
+}
+
+void GlslProg::uniformBlock( const std::string &name, GLuint bindingPoint )
+{
+	GLuint index = getUniformBlockIndex( name );
+	if( index != GL_INVALID_INDEX )
+		glUniformBlockBinding( mObj->mHandle, index, bindingPoint );
+}
+
+GLint GlslProg::getUniformBlockSize( const std::string &name )
+{
+	GLuint index = getUniformBlockIndex( name );
+	if( index == GL_INVALID_INDEX )
+		return 0;
+
+	GLint size = 0;
+	glGetActiveUniformBlockiv( mObj->mHandle, index, GL_UNIFORM_BLOCK_DATA_SIZE, &size );
+	return size;
+}
+
+GLint GlslProg::getUniformBlockOffset( const std::string &name )
+{
+	if( ! supportsUniformBuffers() )
+		return -1;
+
+	const GLchar *names[1] = { name.c_str() };
+	GLuint index = GL_INVALID_INDEX;
+	glGetUniformIndices( mObj->mHandle, 1, names, &index );
+	if( index == GL_INVALID_INDEX )
+		return -1;
+
+	GLint offset = -1;
+	glGetActiveUniformsiv( mObj->mHandle, 1, &index, GL_UNIFORM_OFFSET, &offset );
+	return offset;
+}
+
+void GlslProg::setBinaryCacheDirectory( const fs::path &directory )
+{
+	binaryCacheDirectory() = directory;
+}
+
+const fs::path& GlslProg::getBinaryCacheDirectory()
+{
+	return binaryCacheDirectory();
+}
+
+bool GlslProg::supportsProgramBinaries()
+{
+	static bool supported = false, checked = false;
+	if( ! checked ) {
+		// OS X's legacy context does not expose GL_ARB_get_program_binary
+#if defined( CINDER_MSW )
+		GLint numFormats = 0;
+		if( gl::isExtensionAvailable( "GL_ARB_get_program_binary" ) && loadProgramBinaryFunctions() ) {
+			glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats );
+			supported = numFormats > 0;
+		}
+#endif
+		checked = true;
+	}
+	return supported;
+}
+
+bool GlslProg::loadBinary( const std::string &key )
+{
+#if defined( CINDER_MSW )
+	std::ifstream file( ( binaryCacheDirectory() / ( key + ".glslbin" ) ).string().c_str(), std::ios::binary );
+	if( ! file )
+		return false;
+
+	char magic[4];
+	uint32_t binaryFormat, length;
+	file.read( magic, sizeof(magic) );
+	file.read( reinterpret_cast<char*>( &binaryFormat ), sizeof(binaryFormat) );
+	file.read( reinterpret_cast<char*>( &length ), sizeof(length) );
+	if( ( ! file ) || memcmp( magic, BINARY_CACHE_MAGIC, sizeof(magic) ) || ( length == 0 ) )
+		return false;
+	std::vector<char> binary( length );
+	file.read( &binary[0], length );
+	if( ! file )
+		return false;
+
+	// the driver rejects binaries it can no longer use, in which case the program is left unlinked and can be compiled as usual
+	glProgramBinary( mObj->mHandle, binaryFormat, &binary[0], length );
+	GLint status = GL_FALSE;
+	glGetProgramiv( mObj->mHandle, GL_LINK_STATUS, &status );
+	return status == GL_TRUE;
+#else
+	return false;
+#endif
+}
+
+void GlslProg::saveBinary( const std::string &key )
+{
+#if defined( CINDER_MSW )
+	GLint status = GL_FALSE, length = 0;
+	glGetProgramiv( mObj->mHandle, GL_LINK_STATUS, &status );
+	glGetProgramiv( mObj->mHandle, GL_PROGRAM_BINARY_LENGTH, &length );
+	if( ( status != GL_TRUE ) || ( length <= 0 ) )
+		return;
+
+	std::vector<char> binary( length );
+	GLenum binaryFormat = 0;
+	glGetProgramBinary( mObj->mHandle, length, &length, &binaryFormat, &binary[0] );
+
+	// failing to write the cache only costs a recompile next launch, so errors are ignored
+	try {
+		fs::create_directories( binaryCacheDirectory() );
+	}
+	catch( ... ) {
+		return;
+	}
+	std::ofstream file( ( binaryCacheDirectory() / ( key + ".glslbin" ) ).string().c_str(), std::ios::binary | std::ios::trunc );
+	uint32_t format32 = binaryFormat, length32 = length;
+	file.write( BINARY_CACHE_MAGIC, sizeof(BINARY_CACHE_MAGIC) );
+	file.write( reinterpret_cast<const char*>( &format32 ), sizeof(format32) );
+	file.write( reinterpret_cast<const char*>( &length32 ), sizeof(length32) );
+	file.write( &binary[0], length );
+#endif
+}
+
 //////////////////////////////////////////////////////////////////////////
 // GlslProgCompileExc
 GlslProgCompileExc::GlslProgCompileExc( const std::string &log, GLint aShaderType ) throw()
@@ -0,0 +1,228 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/gl/GpuMemory.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+struct Accounts {
+	Accounts()
+		: mTotal( 0 ), mPeak( 0 ), mBudget( 0 ), mInBudgetFn( false )
+	{
+		for( int c = 0; c < GpuMemory::NUM_CATEGORIES; ++c )
+			mBytes[c] = mObjects[c] = 0;
+	}
+
+	mutex				mMutex;
+	size_t				mBytes[GpuMemory::NUM_CATEGORIES], mObjects[GpuMemory::NUM_CATEGORIES];
+	size_t				mTotal, mPeak, mBudget;
+	GpuMemory::BudgetFn	mBudgetFn;
+	bool				mInBudgetFn;
+};
+
+Accounts& accounts()
+{
+	static Accounts sAccounts;
+	return sAccounts;
+}
+
+string formatMegabytes( size_t bytes )
+{
+	ostringstream ss;
+	ss << fixed << setprecision( 1 ) << bytes / ( 1024.0 * 1024.0 ) << " MB";
+	return ss.str();
+}
+
+} // anonymous namespace
+
+size_t GpuMemory::getAllocated( Category category )
+{
+	lock_guard<mutex> lock( accounts().mMutex );
+	return accounts().mBytes[category];
+}
+
+size_t GpuMemory::getTotalAllocated()
+{
+	lock_guard<mutex> lock( accounts().mMutex );
+	return accounts().mTotal;
+}
+
+size_t GpuMemory::getPeakAllocated()
+{
+	lock_guard<mutex> lock( accounts().mMutex );
+	return accounts().mPeak;
+}
+
+void GpuMemory::resetPeak()
+{
+	lock_guard<mutex> lock( accounts().mMutex );
+	accounts().mPeak = accounts().mTotal;
+}
+
+size_t GpuMemory::getNumObjects( Category category )
+{
+	lock_guard<mutex> lock( accounts().mMutex );
+	return accounts().mObjects[category];
+}
+
+void GpuMemory::setBudget( size_t bytes, const BudgetFn &budgetFn )
+{
+	lock_guard<mutex> lock( accounts().mMutex );
+	accounts().mBudget = bytes;
+	accounts().mBudgetFn = budgetFn;
+}
+
+size_t GpuMemory::getBudget()
+{
+	lock_guard<mutex> lock( accounts().mMutex );
+	return accounts().mBudget;
+}
+
+string GpuMemory::getSummary()
+{
+	Accounts &a = accounts();
+	lock_guard<mutex> lock( a.mMutex );
+	ostringstream ss;
+	ss << "GPU textures " << formatMegabytes( a.mBytes[TEXTURE] ) << " (" << a.mObjects[TEXTURE] << ")";
+	ss << ", buffers " << formatMegabytes( a.mBytes[BUFFER] ) << " (" << a.mObjects[BUFFER] << ")";
+	ss << ", renderbuffers " << formatMegabytes( a.mBytes[RENDERBUFFER] ) << " (" << a.mObjects[RENDERBUFFER] << ")";
+	ss << ", total " << formatMegabytes( a.mTotal );
+	if( a.mBudget )
+		ss << " of " << formatMegabytes( a.mBudget );
+	return ss.str();
+}
+
+void GpuMemory::reallocate( Category category, size_t oldBytes, size_t newBytes )
+{
+	if( oldBytes == newBytes )
+		return;
+
+	Accounts &a = accounts();
+	BudgetFn budgetFn;
+	size_t total, budget;
+	{
+		lock_guard<mutex> lock( a.mMutex );
+		a.mBytes[category] += newBytes - oldBytes;
+		a.mTotal += newBytes - oldBytes;
+		if( oldBytes == 0 )
+			++a.mObjects[category];
+		else if( newBytes == 0 )
+			--a.mObjects[category];
+		a.mPeak = std::max( a.mPeak, a.mTotal );
+
+		// the callback is made outside the lock so that it can release objects, but never from within itself
+		if( newBytes <= oldBytes || ! a.mBudget || a.mTotal <= a.mBudget || ! a.mBudgetFn || a.mInBudgetFn )
+			return;
+		budgetFn = a.mBudgetFn;
+		total = a.mTotal;
+		budget = a.mBudget;
+		a.mInBudgetFn = true;
+	}
+
+	try {
+		budgetFn( total, budget );
+	}
+	catch( ... ) {
+		lock_guard<mutex> lock( a.mMutex );
+		a.mInBudgetFn = false;
+		throw;
+	}
+	lock_guard<mutex> lock( a.mMutex );
+	a.mInBudgetFn = false;
+}
+
+size_t GpuMemory::getBitsPerPixel( GLint internalFormat )
+{
+	switch( internalFormat ) {
+		case GL_ALPHA:
+		case GL_LUMINANCE:
+#if ! defined( CINDER_GLES )
+		case GL_ALPHA8:
+		case GL_LUMINANCE8:
+		case GL_INTENSITY8:
+		case GL_STENCIL_INDEX8_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+#endif
+			return 8;
+		case GL_LUMINANCE_ALPHA:
+#if ! defined( CINDER_GLES )
+		case GL_LUMINANCE8_ALPHA8:
+		case GL_LUMINANCE16:
+		case GL_DEPTH_COMPONENT16:
+		case GL_ALPHA16F_ARB:
+		case GL_LUMINANCE16F_ARB:
+#endif
+			return 16;
+#if ! defined( CINDER_GLES )
+		case GL_LUMINANCE16_ALPHA16:
+		case GL_LUMINANCE_ALPHA16F_ARB:
+		case GL_LUMINANCE32F_ARB:
+		case GL_ALPHA32F_ARB:
+#endif
+			return 32;
+#if ! defined( CINDER_GLES )
+		case GL_RGB16:
+		case GL_RGBA16:
+		case GL_RGB16F_ARB:
+		case GL_RGBA16F_ARB:
+		case GL_LUMINANCE_ALPHA32F_ARB:
+			return 64;
+		case GL_RGB32F_ARB:
+		case GL_RGBA32F_ARB:
+			return 128;
+		case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+			return 4;
+#endif
+		default: // RGB, RGBA, their 8 bit variants, and the 24 and 32 bit depth formats
+			return 32;
+	}
+}
+
+size_t GpuMemory::getImageBytes( GLint internalFormat, int32_t width, int32_t height, bool mipmapped )
+{
+	const size_t bitsPerPixel = getBitsPerPixel( internalFormat );
+	size_t result = 0;
+	while( true ) {
+		result += ( (size_t)width * height * bitsPerPixel + 7 ) / 8;
+		if( ! mipmapped || ( width <= 1 && height <= 1 ) )
+			break;
+		width = std::max( width / 2, 1 );
+		height = std::max( height / 2, 1 );
+	}
+	return result;
+}
+
+} } // namespace cinder::gl
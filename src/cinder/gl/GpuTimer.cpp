@@ -0,0 +1,139 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/GpuTimer.h"
+
+#include <algorithm>
+
+namespace cinder { namespace gl {
+
+namespace detail {
+
+bool getTimeElapsedQueryResult( GLuint query, double *resultSeconds )
+{
+#if ! defined( CINDER_GLES )
+	GLint available = 0;
+	glGetQueryObjectiv( query, GL_QUERY_RESULT_AVAILABLE, &available );
+	if( ! available )
+		return false;
+	GLuint64EXT nanoseconds = 0;
+	glGetQueryObjectui64vEXT( query, GL_QUERY_RESULT, &nanoseconds );
+	*resultSeconds = nanoseconds / 1.0e9;
+	return true;
+#else
+	return false;
+#endif
+}
+
+} // namespace detail
+
+GpuTimer::Obj::Obj( int numQueries )
+	: mNextQuery( 0 ), mRunning( false ), mElapsedSeconds( 0 )
+{
+	mQueries.resize( std::max( numQueries, 2 ), 0 );
+	mPending.resize( mQueries.size(), false );
+#if ! defined( CINDER_GLES )
+	if( GpuTimer::isSupported() )
+		glGenQueries( (GLsizei)mQueries.size(), &mQueries[0] );
+#endif
+}
+
+GpuTimer::Obj::~Obj()
+{
+#if ! defined( CINDER_GLES )
+	if( mQueries[0] )
+		glDeleteQueries( (GLsizei)mQueries.size(), &mQueries[0] );
+#endif
+}
+
+GpuTimer::GpuTimer( int numQueries )
+	: mObj( new Obj( numQueries ) )
+{
+}
+
+bool GpuTimer::isSupported()
+{
+#if defined( CINDER_MAC )
+	static bool supported = gl::isExtensionAvailable( "GL_EXT_timer_query" );
+	return supported;
+#elif defined( CINDER_MSW )
+	return GLEE_EXT_timer_query != 0;
+#else
+	return false;
+#endif
+}
+
+void GpuTimer::begin()
+{
+	if( mObj->mRunning || ( ! mObj->mQueries[0] ) )
+		return;
+
+	collect();
+	// if the GPU is a whole ring behind, this measurement's predecessor is abandoned rather than waited on
+	mObj->mPending[mObj->mNextQuery] = false;
+#if ! defined( CINDER_GLES )
+	glBeginQuery( GL_TIME_ELAPSED_EXT, mObj->mQueries[mObj->mNextQuery] );
+#endif
+	mObj->mRunning = true;
+}
+
+void GpuTimer::end()
+{
+	if( ! mObj->mRunning )
+		return;
+
+#if ! defined( CINDER_GLES )
+	glEndQuery( GL_TIME_ELAPSED_EXT );
+#endif
+	mObj->mPending[mObj->mNextQuery] = true;
+	mObj->mNextQuery = ( mObj->mNextQuery + 1 ) % mObj->mQueries.size();
+	mObj->mRunning = false;
+}
+
+void GpuTimer::collect()
+{
+	// starting at mNextQuery visits the ring oldest first
+	for( size_t i = 0; i < mObj->mQueries.size(); ++i ) {
+		size_t q = ( mObj->mNextQuery + i ) % mObj->mQueries.size();
+		if( ! mObj->mPending[q] )
+			continue;
+		if( ! detail::getTimeElapsedQueryResult( mObj->mQueries[q], &mObj->mElapsedSeconds ) )
+			break;
+		mObj->mPending[q] = false;
+	}
+}
+
+double GpuTimer::getElapsedSeconds()
+{
+	if( ! mObj->mRunning )
+		collect();
+	return mObj->mElapsedSeconds;
+}
+
+int GpuTimer::getNumPending() const
+{
+	return (int)std::count( mObj->mPending.begin(), mObj->mPending.end(), true );
+}
+
+} } // namespace cinder::gl
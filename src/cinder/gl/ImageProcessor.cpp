@@ -0,0 +1,378 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "cinder/gl/ImageProcessor.h"
+#include "cinder/ChanTraits.h"
+
+#include <algorithm>
+
+#if ! defined( CINDER_GLES )
+
+namespace cinder { namespace gl {
+
+namespace {
+
+const char *sVertexShader =
+	"void main() {\n"
+	"	gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+	"	gl_Position = ftransform();\n"
+	"}\n";
+
+const char *sCopyShader =
+	"uniform sampler2D uTex;\n"
+	"void main() {\n"
+	"	gl_FragColor = texture2D( uTex, gl_TexCoord[0].st );\n"
+	"}\n";
+
+// luma coefficients from Rec. 709, matching CHANTRAIT<float>::grayscale()
+const char *sGrayscaleShader =
+	"uniform sampler2D uTex;\n"
+	"void main() {\n"
+	"	float luma = dot( texture2D( uTex, gl_TexCoord[0].st ).rgb, vec3( 0.2126, 0.7152, 0.0722 ) );\n"
+	"	gl_FragColor = vec4( luma, luma, luma, 1.0 );\n"
+	"}\n";
+
+const char *sThresholdShader =
+	"uniform sampler2D uTex;\n"
+	"uniform float uValue;\n"
+	"void main() {\n"
+	"	vec4 color = texture2D( uTex, gl_TexCoord[0].st );\n"
+	"	gl_FragColor = vec4( vec3( greaterThan( color.rgb, vec3( uValue ) ) ), color.a );\n"
+	"}\n";
+
+const char *sInvertShader =
+	"uniform sampler2D uTex;\n"
+	"void main() {\n"
+	"	vec4 color = texture2D( uTex, gl_TexCoord[0].st );\n"
+	"	gl_FragColor = vec4( vec3( 1.0 ) - color.rgb, color.a );\n"
+	"}\n";
+
+// the kernels of ip::edgeDetectSobel(); the outermost pixels have no neighbors on one side and are written as 0
+const char *sSobelShader =
+	"uniform sampler2D uTex;\n"
+	"uniform vec2 uTexel, uSize;\n"
+	"vec3 texel( float x, float y ) { return texture2D( uTex, gl_TexCoord[0].st + vec2( x, y ) * uTexel ).rgb; }\n"
+	"void main() {\n"
+	"	float alpha = texture2D( uTex, gl_TexCoord[0].st ).a;\n"
+	"	if( any( lessThan( gl_FragCoord.xy, vec2( 1.0 ) ) ) || any( greaterThan( gl_FragCoord.xy, uSize - vec2( 1.0 ) ) ) ) {\n"
+	"		gl_FragColor = vec4( 0.0, 0.0, 0.0, alpha );\n"
+	"		return;\n"
+	"	}\n"
+	"	vec3 ul = texel( -1.0, -1.0 ), u = texel( 0.0, -1.0 ), ur = texel( 1.0, -1.0 );\n"
+	"	vec3 l = texel( -1.0, 0.0 ), r = texel( 1.0, 0.0 );\n"
+	"	vec3 bl = texel( -1.0, 1.0 ), b = texel( 0.0, 1.0 ), br = texel( 1.0, 1.0 );\n"
+	"	vec3 sumX = -ul + ur - 2.0 * l + 2.0 * r - bl + br;\n"
+	"	vec3 sumY = ul + 2.0 * u + ur - bl - 2.0 * b - br;\n"
+	"	gl_FragColor = vec4( min( sqrt( sumX * sumX + sumY * sumY ), vec3( 1.0 ) ), alpha );\n"
+	"}\n";
+
+bool isFloatFormat( GLint internalFormat )
+{
+	switch( internalFormat ) {
+		case GL_RGBA32F_ARB: case GL_RGB32F_ARB: case GL_LUMINANCE32F_ARB: case GL_LUMINANCE_ALPHA32F_ARB: case GL_ALPHA32F_ARB:
+		case GL_RGBA16F_ARB: case GL_RGB16F_ARB: case GL_LUMINANCE16F_ARB: case GL_LUMINANCE_ALPHA16F_ARB: case GL_ALPHA16F_ARB:
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool is16BitFormat( GLint internalFormat )
+{
+	switch( internalFormat ) {
+		case GL_RGBA16: case GL_RGB16: case GL_LUMINANCE16: case GL_LUMINANCE16_ALPHA16: case GL_ALPHA16:
+			return true;
+		default:
+			return false;
+	}
+}
+
+// converts a threshold in the units of T to the normalized value the shader compares against; an integer value v
+// passes values of v + 1 and up, so the comparison is made halfway between v and v + 1 to be immune to rounding
+template<typename T>
+float normalizedThreshold( T value )
+{
+	return ( value + 0.5f ) / CHANTRAIT<T>::max();
+}
+
+template<>
+float normalizedThreshold( float value )
+{
+	return value;
+}
+
+} // anonymous namespace
+
+ImageProcessor::ImageProcessor( const FboPoolRef &pool )
+	: mFboPool( pool )
+{
+	if( ! mFboPool )
+		mFboPool = FboPool::create();
+}
+
+Fbo ImageProcessor::acquire( const Vec2i &size, const Texture &srcTexture )
+{
+	Fbo::Format format;
+	format.enableDepthBuffer( false );
+	format.setWrap( GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE );
+	format.setMinFilter( GL_LINEAR );
+	format.setMagFilter( GL_LINEAR );
+	const GLint internalFormat = srcTexture.getInternalFormat();
+	if( isFloatFormat( internalFormat ) )
+		format.setColorInternalFormat( GL_RGBA32F_ARB );
+	else if( is16BitFormat( internalFormat ) )
+		format.setColorInternalFormat( GL_RGBA16 );
+	else
+		format.setColorInternalFormat( GL_RGBA8 );
+
+	return mFboPool->acquire( size.x, size.y, format );
+}
+
+GlslProg& ImageProcessor::getShader( GlslProg *shader, const char *fragmentShader )
+{
+	if( ! *shader ) {
+		*shader = GlslProg( sVertexShader, fragmentShader );
+		// uniforms are set on the bound program
+		shader->bind();
+		shader->uniform( "uTex", 0 );
+		GlslProg::unbind();
+	}
+
+	return *shader;
+}
+
+void ImageProcessor::drawQuad( const Texture &srcTexture, const Area &srcArea, const Area &dstArea )
+{
+	const float maxU = srcTexture.getMaxU(), maxV = srcTexture.getMaxV();
+	const float s1 = srcArea.getX1() * maxU / srcTexture.getWidth(), s2 = srcArea.getX2() * maxU / srcTexture.getWidth();
+	float t1 = srcArea.getY1() * maxV / srcTexture.getHeight(), t2 = srcArea.getY2() * maxV / srcTexture.getHeight();
+	if( srcTexture.isFlipped() ) {
+		t1 = maxV - t1;
+		t2 = maxV - t2;
+	}
+
+	glBegin( GL_TRIANGLE_STRIP );
+		glTexCoord2f( s1, t1 ); glVertex2f( (float)dstArea.getX1(), (float)dstArea.getY1() );
+		glTexCoord2f( s2, t1 ); glVertex2f( (float)dstArea.getX2(), (float)dstArea.getY1() );
+		glTexCoord2f( s1, t2 ); glVertex2f( (float)dstArea.getX1(), (float)dstArea.getY2() );
+		glTexCoord2f( s2, t2 ); glVertex2f( (float)dstArea.getX2(), (float)dstArea.getY2() );
+	glEnd();
+}
+
+void ImageProcessor::runPass( GlslProg &shader, const Texture &srcTexture, Fbo *dst )
+{
+	SaveFramebufferBinding saveBinding;
+	glPushAttrib( GL_VIEWPORT_BIT | GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT );
+	pushMatrices();
+
+	dst->bindFramebuffer();
+	setViewport( dst->getBounds() );
+	// the top row of the image goes to the first row of the framebuffer, which is t = 0 in its texture
+	setMatricesWindow( dst->getSize(), false );
+	glDisable( GL_BLEND );
+	glDisable( GL_DEPTH_TEST );
+
+	// the source is sampled bilinearly so that resize() interpolates; filtering makes no difference when sampling texel centers
+	srcTexture.bind( 0 );
+	GLint minFilter, magFilter;
+	glGetTexParameteriv( srcTexture.getTarget(), GL_TEXTURE_MIN_FILTER, &minFilter );
+	glGetTexParameteriv( srcTexture.getTarget(), GL_TEXTURE_MAG_FILTER, &magFilter );
+	glTexParameteri( srcTexture.getTarget(), GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+	glTexParameteri( srcTexture.getTarget(), GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+
+	shader.bind();
+	drawQuad( srcTexture, srcTexture.getBounds(), dst->getBounds() );
+	GlslProg::unbind();
+
+	glTexParameteri( srcTexture.getTarget(), GL_TEXTURE_MIN_FILTER, minFilter );
+	glTexParameteri( srcTexture.getTarget(), GL_TEXTURE_MAG_FILTER, magFilter );
+	srcTexture.unbind( 0 );
+
+	popMatrices();
+	glPopAttrib();
+}
+
+Fbo ImageProcessor::resize( const Texture &srcTexture, const Vec2i &size )
+{
+	Fbo result = acquire( size, srcTexture );
+	resize( srcTexture, &result );
+	return result;
+}
+
+void ImageProcessor::resize( const Texture &srcTexture, Fbo *dst )
+{
+	GlslProg &shader = getShader( &mCopyShader, sCopyShader );
+	const Vec2i dstSize = dst->getSize();
+
+	// bilinear sampling only reads the 2x2 texels nearest each sample, so larger reductions are made of halving steps
+	Texture current = srcTexture;
+	Fbo intermediate;
+	Vec2i size = srcTexture.getSize();
+	while( ( size.x > dstSize.x * 2 ) || ( size.y > dstSize.y * 2 ) ) {
+		size = Vec2i( std::max( dstSize.x, ( size.x + 1 ) / 2 ), std::max( dstSize.y, ( size.y + 1 ) / 2 ) );
+		// the previous step's Fbo stays held until this step has read it
+		Fbo next = acquire( size, srcTexture );
+		runPass( shader, current, &next );
+		intermediate = next;
+		current = intermediate.getTexture();
+	}
+
+	runPass( shader, current, dst );
+}
+
+Fbo ImageProcessor::grayscale( const Texture &srcTexture )
+{
+	Fbo result = acquire( srcTexture.getSize(), srcTexture );
+	grayscale( srcTexture, &result );
+	return result;
+}
+
+void ImageProcessor::grayscale( const Texture &srcTexture, Fbo *dst )
+{
+	runPass( getShader( &mGrayscaleShader, sGrayscaleShader ), srcTexture, dst );
+}
+
+Fbo ImageProcessor::threshold( const Texture &srcTexture, float value )
+{
+	Fbo result = acquire( srcTexture.getSize(), srcTexture );
+	threshold( srcTexture, value, &result );
+	return result;
+}
+
+void ImageProcessor::threshold( const Texture &srcTexture, float value, Fbo *dst )
+{
+	GlslProg &shader = getShader( &mThresholdShader, sThresholdShader );
+	shader.bind();
+	shader.uniform( "uValue", value );
+	runPass( shader, srcTexture, dst );
+}
+
+Fbo ImageProcessor::invert( const Texture &srcTexture )
+{
+	Fbo result = acquire( srcTexture.getSize(), srcTexture );
+	invert( srcTexture, &result );
+	return result;
+}
+
+void ImageProcessor::invert( const Texture &srcTexture, Fbo *dst )
+{
+	runPass( getShader( &mInvertShader, sInvertShader ), srcTexture, dst );
+}
+
+Fbo ImageProcessor::edgeDetectSobel( const Texture &srcTexture )
+{
+	Fbo result = acquire( srcTexture.getSize(), srcTexture );
+	edgeDetectSobel( srcTexture, &result );
+	return result;
+}
+
+void ImageProcessor::edgeDetectSobel( const Texture &srcTexture, Fbo *dst )
+{
+	GlslProg &shader = getShader( &mSobelShader, sSobelShader );
+	shader.bind();
+	// a flipped texture's rows run the other way, which leaves the gradient magnitude unchanged
+	shader.uniform( "uTexel", Vec2f( srcTexture.getMaxU() / srcTexture.getWidth(), srcTexture.getMaxV() / srcTexture.getHeight() ) );
+	shader.uniform( "uSize", Vec2f( dst->getSize() ) );
+	runPass( shader, srcTexture, dst );
+}
+
+void ImageProcessor::blend( Fbo *background, const Texture &srcTexture, const Area &srcArea, const Vec2i &dstRelativeOffset, bool premultiplied )
+{
+	GlslProg &shader = getShader( &mCopyShader, sCopyShader );
+
+	SaveFramebufferBinding saveBinding;
+	glPushAttrib( GL_VIEWPORT_BIT | GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT );
+	pushMatrices();
+
+	background->bindFramebuffer();
+	setViewport( background->getBounds() );
+	setMatricesWindow( background->getSize(), false );
+	glDisable( GL_DEPTH_TEST );
+	glEnable( GL_BLEND );
+	// alpha always accumulates as src + dst * ( 1 - src ), as in ip::blend()
+	glBlendFuncSeparate( premultiplied ? GL_ONE : GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
+
+	srcTexture.bind( 0 );
+	shader.bind();
+	drawQuad( srcTexture, srcArea, srcArea + dstRelativeOffset );
+	GlslProg::unbind();
+	srcTexture.unbind( 0 );
+
+	popMatrices();
+	glPopAttrib();
+}
+
+template<typename T>
+Fbo ImageProcessor::render( const ip::PipelineT<T> &pipeline )
+{
+	typedef typename ip::PipelineT<T>::StageDesc StageDesc;
+	const std::vector<StageDesc> stages = pipeline.getStages();
+
+	Texture current;
+	Fbo result;
+	for( typename std::vector<StageDesc>::const_iterator stageIt = stages.begin(); stageIt != stages.end(); ++stageIt ) {
+		Fbo next;
+		switch( stageIt->mType ) {
+			case StageDesc::CHANNEL:
+				current = Texture( stageIt->mChannel );
+			continue;
+			case StageDesc::GRAYSCALE:
+				next = grayscale( Texture( stageIt->mSurface ) );
+			break;
+			case StageDesc::RESIZE:
+				next = resize( current, stageIt->mSize );
+			break;
+			case StageDesc::THRESHOLD:
+				next = threshold( current, normalizedThreshold( stageIt->mValue ) );
+			break;
+			case StageDesc::INVERT:
+				next = invert( current );
+			break;
+			case StageDesc::EDGE_DETECT_SOBEL:
+				next = edgeDetectSobel( current );
+			break;
+		}
+		// the previous result returns to the pool only once this stage has read it
+		result = next;
+		current = result.getTexture();
+	}
+
+	// a PipelineT with no stages beyond its Channel still renders into a pooled Fbo
+	if( ! result ) {
+		result = acquire( current.getSize(), current );
+		runPass( getShader( &mCopyShader, sCopyShader ), current, &result );
+	}
+
+	return result;
+}
+
+template Fbo ImageProcessor::render( const ip::PipelineT<uint8_t> &pipeline );
+template Fbo ImageProcessor::render( const ip::PipelineT<uint16_t> &pipeline );
+template Fbo ImageProcessor::render( const ip::PipelineT<float> &pipeline );
+
+} } // namespace cinder::gl
+
+#endif // ! defined( CINDER_GLES )
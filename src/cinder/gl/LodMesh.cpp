@@ -0,0 +1,155 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/LodMesh.h"
+#include "cinder/Camera.h"
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+// Moves each vertex to its new index and drops those from \a numUsed on. Attributes which aren't per-vertex are left alone.
+template<typename T>
+void reorderVertexAttribute( vector<T> *attribute, const vector<uint32_t> &newIndex, size_t numUsed )
+{
+	if( attribute->size() != newIndex.size() )
+		return;
+	vector<T> result( attribute->size() );
+	for( size_t v = 0; v < newIndex.size(); ++v )
+		result[newIndex[v]] = (*attribute)[v];
+	result.resize( numUsed );
+	attribute->swap( result );
+}
+
+} // anonymous namespace
+
+LodMesh::LodMesh( const TriMesh &sourceMesh, const Format &format, VboMesh::Layout layout )
+	: mBoundingSphere( Sphere::calculateBoundingSphere( sourceMesh.getVertices() ) )
+{
+	vector<vector<uint32_t> > levelIndices( 1, sourceMesh.getIndices() );
+	vector<float> levelErrors( 1, 0.0f );
+	while( levelIndices.size() < format.getMaxLevels() ) {
+		const vector<uint32_t> &previous = levelIndices.back();
+		const size_t target = (size_t)( previous.size() / 3 * format.getReduction() );
+		if( target < format.getMinTriangles() )
+			break;
+		vector<uint32_t> indices( previous );
+		const float error = sourceMesh.calcSimplifiedIndices( &indices, target, format.getMaxError() );
+		if( indices.size() >= previous.size() || indices.empty() )
+			break;
+		levelIndices.push_back( vector<uint32_t>() );
+		levelIndices.back().swap( indices );
+		// each level is simplified from the previous one, so its distance from the original is bounded by the sum of the errors
+		levelErrors.push_back( levelErrors.back() + error );
+	}
+
+	TriMesh mesh( sourceMesh );
+	if( format.getOptimize() ) {
+		// optimizeVertexCache() only needs the number of vertices, so the levels take turns in a TriMesh holding just the positions
+		TriMesh scratch;
+		scratch.getVertices() = sourceMesh.getVertices();
+		for( size_t l = 0; l < levelIndices.size(); ++l ) {
+			scratch.getIndices().swap( levelIndices[l] );
+			scratch.optimizeVertexCache();
+			scratch.getIndices().swap( levelIndices[l] );
+		}
+	}
+
+	// number the vertices coarsest level first, so that every level uses a prefix of the vertices, in the order its triangles reference them
+	const size_t numVertices = mesh.getNumVertices();
+	const uint32_t unassigned = numeric_limits<uint32_t>::max();
+	vector<uint32_t> newIndex( numVertices, unassigned );
+	vector<size_t> levelNumVertices( levelIndices.size() );
+	uint32_t next = 0;
+	for( size_t l = levelIndices.size(); l-- > 0; ) {
+		const vector<uint32_t> &indices = levelIndices[l];
+		for( size_t i = 0; i < indices.size(); ++i )
+			if( newIndex[indices[i]] == unassigned )
+				newIndex[indices[i]] = next++;
+		levelNumVertices[l] = next;
+	}
+	for( size_t v = 0; v < numVertices; ++v )
+		if( newIndex[v] == unassigned )
+			newIndex[v] = next++;
+
+	// vertices no level references are dropped
+	const size_t numUsed = levelNumVertices[0];
+	reorderVertexAttribute( &mesh.getNormals(), newIndex, numUsed );
+	reorderVertexAttribute( &mesh.getColorsRGB(), newIndex, numUsed );
+	reorderVertexAttribute( &mesh.getColorsRGBA(), newIndex, numUsed );
+	reorderVertexAttribute( &mesh.getTexCoords(), newIndex, numUsed );
+	reorderVertexAttribute( &mesh.getTangents(), newIndex, numUsed );
+	reorderVertexAttribute( &mesh.getVertices(), newIndex, numUsed );
+
+	vector<uint32_t> &indices = mesh.getIndices();
+	indices.clear();
+	for( size_t l = 0; l < levelIndices.size(); ++l ) {
+		Level level;
+		level.mStartIndex = indices.size();
+		level.mNumIndices = levelIndices[l].size();
+		level.mNumVertices = levelNumVertices[l];
+		level.mError = levelErrors[l];
+		mLevels.push_back( level );
+		for( size_t i = 0; i < levelIndices[l].size(); ++i )
+			indices.push_back( newIndex[levelIndices[l][i]] );
+	}
+
+	layout.setOptimizeTriMesh( false );
+	mVboMesh = VboMesh( mesh, layout );
+}
+
+size_t LodMesh::select( float screenRadius, float maxPixelError ) const
+{
+	const float radius = mBoundingSphere.getRadius();
+	if( radius <= 0 )
+		return mLevels.size() - 1;
+
+	size_t result = 0;
+	for( size_t l = 1; l < mLevels.size(); ++l ) {
+		if( mLevels[l].mError / radius * screenRadius > maxPixelError )
+			break;
+		result = l;
+	}
+	return result;
+}
+
+size_t LodMesh::select( const Camera &cam, const Matrix44f &transform, float screenWidth, float screenHeight, float maxPixelError ) const
+{
+	// the bounding sphere scales with the largest axis of the transform; errors scale with it, so they stay the same fraction of its radius
+	float scale = 0;
+	for( int axis = 0; axis < 3; ++axis )
+		scale = std::max( scale, transform.getColumn( axis ).xyz().length() );
+	const Sphere worldSphere( transform.transformPointAffine( mBoundingSphere.getCenter() ), mBoundingSphere.getRadius() * scale );
+	return select( cam.getScreenRadius( worldSphere, screenWidth, screenHeight ), maxPixelError );
+}
+
+void LodMesh::draw( size_t level ) const
+{
+	const Level &lod = mLevels[level];
+	gl::drawRange( mVboMesh, lod.mStartIndex, lod.mNumIndices, 0, (int)lod.mNumVertices - 1 );
+}
+
+} } // namespace cinder::gl
@@ -0,0 +1,341 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/MeshArena.h"
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+// First fit, so that ranges freed near the start of the arena are reused before the tail is split
+bool allocateRange( map<size_t,size_t> &freeRanges, size_t size, size_t *offset )
+{
+	if( size == 0 ) {
+		*offset = 0;
+		return true;
+	}
+
+	for( map<size_t,size_t>::iterator rangeIt = freeRanges.begin(); rangeIt != freeRanges.end(); ++rangeIt ) {
+		if( rangeIt->second >= size ) {
+			*offset = rangeIt->first;
+			size_t remaining = rangeIt->second - size;
+			freeRanges.erase( rangeIt );
+			if( remaining )
+				freeRanges[*offset + size] = remaining;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Merges the range with its neighbors, so that freeing everything leaves a single range again
+void freeRange( map<size_t,size_t> &freeRanges, size_t offset, size_t size )
+{
+	if( size == 0 )
+		return;
+
+	map<size_t,size_t>::iterator rangeIt = freeRanges.insert( make_pair( offset, size ) ).first;
+	map<size_t,size_t>::iterator nextIt = rangeIt;
+	++nextIt;
+	if( ( nextIt != freeRanges.end() ) && ( rangeIt->first + rangeIt->second == nextIt->first ) ) {
+		rangeIt->second += nextIt->second;
+		freeRanges.erase( nextIt );
+	}
+	if( rangeIt != freeRanges.begin() ) {
+		map<size_t,size_t>::iterator prevIt = rangeIt;
+		--prevIt;
+		if( prevIt->first + prevIt->second == rangeIt->first ) {
+			prevIt->second += rangeIt->second;
+			freeRanges.erase( rangeIt );
+		}
+	}
+}
+
+size_t sumRanges( const map<size_t,size_t> &freeRanges )
+{
+	size_t result = 0;
+	for( map<size_t,size_t>::const_iterator rangeIt = freeRanges.begin(); rangeIt != freeRanges.end(); ++rangeIt )
+		result += rangeIt->second;
+	return result;
+}
+
+} // anonymous namespace
+
+MeshArena::MeshArena( const Format &format )
+	: mFormat( format ), mNumMeshes( 0 ), mMeshIdLocation( -1 ), mDirtyBegin( format.getMaxMeshes() ), mDirtyEnd( 0 )
+{
+	// positions, then the optional attributes, then the MeshId
+	mStride = sizeof(Vec3f);
+	mNormalOffset = mStride;
+	if( mFormat.hasNormals() )
+		mStride += sizeof(Vec3f);
+	mTexCoordOffset = mStride;
+	if( mFormat.hasTexCoords() )
+		mStride += sizeof(Vec2f);
+	mColorOffset = mStride;
+	if( mFormat.hasColors() )
+		mStride += sizeof(ColorA);
+	mMeshIdOffset = mStride;
+	mStride += sizeof(float);
+
+	mVertexVbo = Vbo( GL_ARRAY_BUFFER );
+	mVertexVbo.bufferData( mStride * mFormat.getMaxVertices(), NULL, GL_STATIC_DRAW );
+	mIndexVbo = Vbo( GL_ELEMENT_ARRAY_BUFFER );
+	mIndexVbo.bufferData( sizeof(uint32_t) * mFormat.getMaxIndices(), NULL, GL_STATIC_DRAW );
+	VboMesh::unbindBuffers();
+
+	freeRange( mFreeVertices, 0, mFormat.getMaxVertices() );
+	freeRange( mFreeIndices, 0, mFormat.getMaxIndices() );
+	mTransformData.resize( mFormat.getMaxMeshes() * 16, 0 );
+}
+
+MeshArena::MeshId MeshArena::add( const TriMesh &mesh )
+{
+	if( mFreeIds.empty() && ( mMeshes.size() >= mFormat.getMaxMeshes() ) )
+		throw MeshArenaFullExc();
+
+	const size_t numVertices = mesh.getNumVertices(), numIndices = mesh.getNumIndices();
+	size_t vertexOffset, indexOffset;
+	if( ! allocateRange( mFreeVertices, numVertices, &vertexOffset ) )
+		throw MeshArenaFullExc();
+	if( ! allocateRange( mFreeIndices, numIndices, &indexOffset ) ) {
+		freeRange( mFreeVertices, vertexOffset, numVertices );
+		throw MeshArenaFullExc();
+	}
+
+	MeshId id;
+	if( mFreeIds.empty() ) {
+		id = (MeshId)mMeshes.size();
+		mMeshes.push_back( Mesh() );
+	}
+	else {
+		id = mFreeIds.back();
+		mFreeIds.pop_back();
+	}
+
+	if( numVertices ) {
+		const bool copyNormals = mFormat.hasNormals() && mesh.hasNormals();
+		const bool copyTexCoords = mFormat.hasTexCoords() && mesh.hasTexCoords();
+		const bool copyColors = mFormat.hasColors() && mesh.hasColorsRGBA();
+		vector<uint8_t> vertices( mStride * numVertices, 0 );
+		for( size_t v = 0; v < numVertices; ++v ) {
+			uint8_t *vertex = &vertices[v * mStride];
+			*reinterpret_cast<Vec3f*>( vertex ) = mesh.getVertices()[v];
+			if( copyNormals )
+				*reinterpret_cast<Vec3f*>( vertex + mNormalOffset ) = mesh.getNormals()[v];
+			if( copyTexCoords )
+				*reinterpret_cast<Vec2f*>( vertex + mTexCoordOffset ) = mesh.getTexCoords()[v];
+			if( copyColors )
+				*reinterpret_cast<ColorA*>( vertex + mColorOffset ) = mesh.getColorsRGBA()[v];
+			*reinterpret_cast<float*>( vertex + mMeshIdOffset ) = (float)id;
+		}
+		mVertexVbo.bufferSubData( mStride * vertexOffset, vertices.size(), &vertices[0] );
+	}
+
+	// rebasing the indices here lets every mesh be drawn from the same buffers without glDrawElementsBaseVertex()
+	if( numIndices ) {
+		vector<uint32_t> indices( mesh.getIndices() );
+		for( size_t i = 0; i < numIndices; ++i )
+			indices[i] += (uint32_t)vertexOffset;
+		mIndexVbo.bufferSubData( sizeof(uint32_t) * indexOffset, sizeof(uint32_t) * numIndices, &indices[0] );
+	}
+	VboMesh::unbindBuffers();
+
+	Mesh &entry = mMeshes[id];
+	entry.mInUse = entry.mVisible = true;
+	entry.mVertexOffset = vertexOffset;
+	entry.mNumVertices = numVertices;
+	entry.mIndexOffset = indexOffset;
+	entry.mNumIndices = numIndices;
+	setTransform( id, Matrix44f::identity() );
+	++mNumMeshes;
+
+	return id;
+}
+
+void MeshArena::remove( MeshId id )
+{
+	if( ! contains( id ) )
+		throw MeshArenaExc();
+
+	Mesh &entry = mMeshes[id];
+	freeRange( mFreeVertices, entry.mVertexOffset, entry.mNumVertices );
+	freeRange( mFreeIndices, entry.mIndexOffset, entry.mNumIndices );
+	entry = Mesh();
+	mFreeIds.push_back( id );
+	--mNumMeshes;
+}
+
+void MeshArena::setTransform( MeshId id, const Matrix44f &transform )
+{
+	mMeshes[id].mTransform = transform;
+	std::copy( transform.m, transform.m + 16, &mTransformData[id * 16] );
+	mDirtyBegin = std::min<size_t>( mDirtyBegin, id );
+	mDirtyEnd = std::max<size_t>( mDirtyEnd, id + 1 );
+}
+
+size_t MeshArena::getNumFreeVertices() const
+{
+	return sumRanges( mFreeVertices );
+}
+
+size_t MeshArena::getNumFreeIndices() const
+{
+	return sumRanges( mFreeIndices );
+}
+
+const Texture& MeshArena::getTransformTexture()
+{
+	if( ! mTransformTexture ) {
+		Texture::Format format;
+		format.setInternalFormat( GL_RGBA32F_ARB );
+		format.setMinFilter( GL_NEAREST );
+		format.setMagFilter( GL_NEAREST );
+		mTransformTexture = Texture( 4, (int)mFormat.getMaxMeshes(), format );
+		mDirtyBegin = 0;
+		mDirtyEnd = mFormat.getMaxMeshes();
+	}
+
+	updateTransformTexture();
+	return mTransformTexture;
+}
+
+void MeshArena::updateTransformTexture()
+{
+	if( ( ! mTransformTexture ) || ( mDirtyBegin >= mDirtyEnd ) )
+		return;
+
+	mTransformTexture.bind();
+	glTexSubImage2D( GL_TEXTURE_2D, 0, 0, (GLint)mDirtyBegin, 4, (GLsizei)( mDirtyEnd - mDirtyBegin ), GL_RGBA, GL_FLOAT, &mTransformData[mDirtyBegin * 16] );
+	mTransformTexture.unbind();
+
+	mDirtyBegin = mFormat.getMaxMeshes();
+	mDirtyEnd = 0;
+}
+
+void MeshArena::bind()
+{
+	mVertexVbo.bind();
+	mIndexVbo.bind();
+
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glVertexPointer( 3, GL_FLOAT, mStride, 0 );
+	if( mFormat.hasNormals() ) {
+		glEnableClientState( GL_NORMAL_ARRAY );
+		glNormalPointer( GL_FLOAT, mStride, (const GLvoid*)mNormalOffset );
+	}
+	if( mFormat.hasTexCoords() ) {
+		glClientActiveTexture( GL_TEXTURE0 );
+		glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+		glTexCoordPointer( 2, GL_FLOAT, mStride, (const GLvoid*)mTexCoordOffset );
+	}
+	if( mFormat.hasColors() ) {
+		glEnableClientState( GL_COLOR_ARRAY );
+		glColorPointer( 4, GL_FLOAT, mStride, (const GLvoid*)mColorOffset );
+	}
+	if( mMeshIdLocation >= 0 ) {
+		glEnableVertexAttribArray( mMeshIdLocation );
+		glVertexAttribPointer( mMeshIdLocation, 1, GL_FLOAT, GL_FALSE, mStride, (const GLvoid*)mMeshIdOffset );
+	}
+}
+
+void MeshArena::unbind()
+{
+	glDisableClientState( GL_VERTEX_ARRAY );
+	if( mFormat.hasNormals() )
+		glDisableClientState( GL_NORMAL_ARRAY );
+	if( mFormat.hasTexCoords() ) {
+		glClientActiveTexture( GL_TEXTURE0 );
+		glDisableClientState( GL_TEXTURE_COORD_ARRAY );
+	}
+	if( mFormat.hasColors() )
+		glDisableClientState( GL_COLOR_ARRAY );
+	if( mMeshIdLocation >= 0 )
+		glDisableVertexAttribArray( mMeshIdLocation );
+
+	VboMesh::unbindBuffers();
+}
+
+void MeshArena::multiDraw( const vector<GLsizei> &counts, const vector<const GLvoid*> &offsets )
+{
+	if( counts.empty() )
+		return;
+
+	updateTransformTexture();
+	bind();
+	glMultiDrawElements( GL_TRIANGLES, &counts[0], GL_UNSIGNED_INT, const_cast<const GLvoid**>( &offsets[0] ), (GLsizei)counts.size() );
+	unbind();
+}
+
+void MeshArena::draw()
+{
+	vector<GLsizei> counts;
+	vector<const GLvoid*> offsets;
+	counts.reserve( mNumMeshes );
+	offsets.reserve( mNumMeshes );
+	for( vector<Mesh>::const_iterator meshIt = mMeshes.begin(); meshIt != mMeshes.end(); ++meshIt ) {
+		if( meshIt->mInUse && meshIt->mVisible && meshIt->mNumIndices ) {
+			counts.push_back( (GLsizei)meshIt->mNumIndices );
+			offsets.push_back( (const GLvoid*)( sizeof(uint32_t) * meshIt->mIndexOffset ) );
+		}
+	}
+
+	multiDraw( counts, offsets );
+}
+
+void MeshArena::draw( const vector<MeshId> &ids )
+{
+	vector<GLsizei> counts;
+	vector<const GLvoid*> offsets;
+	counts.reserve( ids.size() );
+	offsets.reserve( ids.size() );
+	for( vector<MeshId>::const_iterator idIt = ids.begin(); idIt != ids.end(); ++idIt ) {
+		const Mesh &mesh = mMeshes[*idIt];
+		if( mesh.mInUse && mesh.mNumIndices ) {
+			counts.push_back( (GLsizei)mesh.mNumIndices );
+			offsets.push_back( (const GLvoid*)( sizeof(uint32_t) * mesh.mIndexOffset ) );
+		}
+	}
+
+	multiDraw( counts, offsets );
+}
+
+void MeshArena::drawTransformed()
+{
+	bind();
+	for( vector<Mesh>::const_iterator meshIt = mMeshes.begin(); meshIt != mMeshes.end(); ++meshIt ) {
+		if( meshIt->mInUse && meshIt->mVisible && meshIt->mNumIndices ) {
+			gl::pushModelView();
+			gl::multModelView( meshIt->mTransform );
+			glDrawElements( GL_TRIANGLES, (GLsizei)meshIt->mNumIndices, GL_UNSIGNED_INT, (const GLvoid*)( sizeof(uint32_t) * meshIt->mIndexOffset ) );
+			gl::popModelView();
+		}
+	}
+	unbind();
+}
+
+} } // namespace cinder::gl
@@ -0,0 +1,289 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/OcclusionCuller.h"
+#include "cinder/gl/StateCache.h"
+#include "cinder/Frustum.h"
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+// 12 triangles, as indices into the 8 corners where bit 0 selects max x, bit 1 max y and bit 2 max z
+const uint8_t sBoxTriangles[36] = { 0,2,1, 1,2,3,  4,5,6, 5,7,6,  0,1,4, 1,5,4,  2,6,3, 3,6,7,  0,4,2, 2,4,6,  1,3,5, 3,7,5 };
+
+bool isBitSet( const uint32_t *bits, size_t i )
+{
+	return ( bits[i / 32] & ( 1u << ( i % 32 ) ) ) != 0;
+}
+
+void setBit( uint32_t *bits, size_t i )
+{
+	bits[i / 32] |= 1u << ( i % 32 );
+}
+
+} // anonymous namespace
+
+OcclusionCuller::Obj::Obj( uint32_t visibleQueryInterval )
+	: mVisibleQueryInterval( std::max<uint32_t>( visibleQueryInterval, 1 ) ), mFrame( 0 ), mSampleThreshold( 0 ), mNumQueriesIssued( 0 ), mNearMargin( 0 )
+{
+}
+
+OcclusionCuller::Obj::~Obj()
+{
+#if ! defined( CINDER_GLES )
+	for( vector<Node>::iterator nodeIt = mNodes.begin(); nodeIt != mNodes.end(); ++nodeIt )
+		if( nodeIt->mQuery )
+			glDeleteQueries( 1, &nodeIt->mQuery );
+#endif
+}
+
+OcclusionCuller::OcclusionCuller( uint32_t visibleQueryInterval )
+	: mObj( new Obj( visibleQueryInterval ) )
+{
+}
+
+bool OcclusionCuller::isSupported()
+{
+#if defined( CINDER_MAC )
+	static bool supported = gl::isExtensionAvailable( "GL_ARB_occlusion_query" );
+	return supported;
+#elif defined( CINDER_MSW )
+	return GLEE_ARB_occlusion_query != 0;
+#else
+	return false;
+#endif
+}
+
+size_t OcclusionCuller::getNumOccluded() const
+{
+	size_t result = 0;
+	for( vector<Node>::const_iterator nodeIt = mObj->mNodes.begin(); nodeIt != mObj->mNodes.end(); ++nodeIt )
+		if( nodeIt->mOccluded )
+			++result;
+	return result;
+}
+
+void OcclusionCuller::resize( size_t count )
+{
+#if ! defined( CINDER_GLES )
+	for( size_t n = count; n < mObj->mNodes.size(); ++n )
+		if( mObj->mNodes[n].mQuery )
+			glDeleteQueries( 1, &mObj->mNodes[n].mQuery );
+#endif
+	mObj->mNodes.resize( count );
+	mObj->mPlaneCache.resize( count, 0 );
+	mObj->mFrustumVisibility.resize( ( count + 31 ) / 32 );
+}
+
+void OcclusionCuller::collect( const uint32_t *firstChild, const uint32_t *numChildren )
+{
+#if ! defined( CINDER_GLES )
+	for( size_t n = 0; n < mObj->mNodes.size(); ++n ) {
+		Node &node = mObj->mNodes[n];
+		if( ! node.mPending )
+			continue;
+		GLint available = 0;
+		glGetQueryObjectiv( node.mQuery, GL_QUERY_RESULT_AVAILABLE, &available );
+		if( ! available )
+			continue;
+
+		GLuint samples = 0;
+		glGetQueryObjectuiv( node.mQuery, GL_QUERY_RESULT, &samples );
+		node.mPending = false;
+		if( samples > mObj->mSampleThreshold ) {
+			// a box which reappears shows its whole subtree, whose older results predate it being hidden
+			if( node.mOccluded && numChildren )
+				reveal( (uint32_t)n, firstChild, numChildren );
+			node.mOccluded = false;
+		}
+		else
+			node.mOccluded = true;
+	}
+#endif
+}
+
+void OcclusionCuller::reveal( uint32_t node, const uint32_t *firstChild, const uint32_t *numChildren )
+{
+	mObj->mNodes[node].mOccluded = false;
+	for( uint32_t c = 0; c < numChildren[node]; ++c )
+		reveal( firstChild[node] + c, firstChild, numChildren );
+}
+
+void OcclusionCuller::prepare( const Camera &camera, size_t count, uint32_t *visibility )
+{
+	mObj->mQueryNodes.clear();
+	mObj->mQueryBoxes.clear();
+	std::fill( visibility, visibility + ( count + 31 ) / 32, 0 );
+
+	// the near plane clips the front of a box closer than its corners, whose query would then wrongly report it hidden
+	mObj->mEyePoint = camera.getEyePoint();
+	Vec3f nearCorners[4];
+	camera.getNearClipCoordinates( &nearCorners[0], &nearCorners[1], &nearCorners[2], &nearCorners[3] );
+	mObj->mNearMargin = 0;
+	for( int c = 0; c < 4; ++c )
+		mObj->mNearMargin = std::max( mObj->mNearMargin, nearCorners[c].distance( mObj->mEyePoint ) );
+}
+
+void OcclusionCuller::visit( uint32_t n, const AxisAlignedBox3f *boxes, const uint32_t *firstChild, const uint32_t *numChildren, uint32_t *visibility )
+{
+	if( ! isBitSet( &mObj->mFrustumVisibility[0], n ) )
+		return;
+
+	Node &node = mObj->mNodes[n];
+	const AxisAlignedBox3f &box = boxes[n];
+	const Vec3f margin( mObj->mNearMargin, mObj->mNearMargin, mObj->mNearMargin );
+	const Vec3f nearMin = box.getMin() - margin, nearMax = box.getMax() + margin;
+	const bool nearEye = ( mObj->mEyePoint.x >= nearMin.x ) && ( mObj->mEyePoint.y >= nearMin.y ) && ( mObj->mEyePoint.z >= nearMin.z )
+						&& ( mObj->mEyePoint.x <= nearMax.x ) && ( mObj->mEyePoint.y <= nearMax.y ) && ( mObj->mEyePoint.z <= nearMax.z );
+	if( nearEye ) // can't be tested, so it's visible
+		node.mOccluded = false;
+
+	if( node.mOccluded ) {
+		if( ! node.mPending ) {
+			mObj->mQueryNodes.push_back( n );
+			mObj->mQueryBoxes.push_back( box );
+		}
+		return;
+	}
+
+	setBit( visibility, n );
+	const uint32_t children = numChildren ? numChildren[n] : 0;
+	if( children == 0 ) {
+		// staggering by index spreads the retests of visible boxes evenly over the interval
+		if( ( ! node.mPending ) && ( ! nearEye ) && ( ( mObj->mFrame + n ) % mObj->mVisibleQueryInterval == 0 ) ) {
+			mObj->mQueryNodes.push_back( n );
+			mObj->mQueryBoxes.push_back( box );
+		}
+		return;
+	}
+
+	const size_t firstQuery = mObj->mQueryNodes.size();
+	size_t inView = 0, hidden = 0;
+	for( uint32_t c = 0; c < children; ++c ) {
+		uint32_t child = firstChild[n] + c;
+		visit( child, boxes, firstChild, numChildren, visibility );
+		if( isBitSet( &mObj->mFrustumVisibility[0], child ) ) {
+			++inView;
+			if( mObj->mNodes[child].mOccluded )
+				++hidden;
+		}
+	}
+
+	// one query for the parent replaces those of its children until it reappears
+	if( ( inView > 0 ) && ( hidden == inView ) && ( ! nearEye ) ) {
+		node.mOccluded = true;
+		mObj->mQueryNodes.resize( firstQuery );
+		mObj->mQueryBoxes.resize( firstQuery );
+		if( ! node.mPending ) {
+			mObj->mQueryNodes.push_back( n );
+			mObj->mQueryBoxes.push_back( box );
+		}
+	}
+}
+
+void OcclusionCuller::cull( const Camera &camera, const AxisAlignedBox3f *boxes, const uint32_t *firstChild, const uint32_t *numChildren, size_t count, uint32_t *visibility )
+{
+	resize( count );
+	collect( firstChild, numChildren );
+	prepare( camera, count, visibility );
+	if( count == 0 )
+		return;
+
+	Frustumf frustum( camera );
+	frustum.cullHierarchy( boxes, firstChild, numChildren, count, &mObj->mFrustumVisibility[0], &mObj->mPlaneCache[0] );
+	visit( 0, boxes, firstChild, numChildren, visibility );
+	++mObj->mFrame;
+}
+
+void OcclusionCuller::cull( const Camera &camera, const AxisAlignedBox3f *boxes, size_t count, uint32_t *visibility )
+{
+	resize( count );
+	collect( NULL, NULL );
+	prepare( camera, count, visibility );
+
+	Frustumf frustum( camera );
+	std::fill( mObj->mFrustumVisibility.begin(), mObj->mFrustumVisibility.end(), 0 );
+	for( size_t b = 0; b < count; ++b )
+		if( frustum.intersects( boxes[b] ) )
+			setBit( &mObj->mFrustumVisibility[0], b );
+	for( size_t b = 0; b < count; ++b )
+		visit( (uint32_t)b, boxes, NULL, NULL, visibility );
+	++mObj->mFrame;
+}
+
+void OcclusionCuller::issueQueries()
+{
+	mObj->mNumQueriesIssued = 0;
+#if ! defined( CINDER_GLES )
+	if( mObj->mQueryNodes.empty() )
+		return;
+
+	vector<Vec3f> vertices;
+	vertices.reserve( mObj->mQueryBoxes.size() * 36 );
+	for( vector<AxisAlignedBox3f>::const_iterator boxIt = mObj->mQueryBoxes.begin(); boxIt != mObj->mQueryBoxes.end(); ++boxIt ) {
+		const Vec3f &lo = boxIt->getMin(), &hi = boxIt->getMax();
+		for( int v = 0; v < 36; ++v ) {
+			uint8_t corner = sBoxTriangles[v];
+			vertices.push_back( Vec3f( ( corner & 1 ) ? hi.x : lo.x, ( corner & 2 ) ? hi.y : lo.y, ( corner & 4 ) ? hi.z : lo.z ) );
+		}
+	}
+
+	glPushAttrib( GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+	glPushClientAttrib( GL_CLIENT_VERTEX_ARRAY_BIT );
+	glDisable( GL_LIGHTING );
+	glDisable( GL_TEXTURE_2D );
+	glDisable( GL_CULL_FACE );
+	glEnable( GL_DEPTH_TEST );
+	glColorMask( GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE );
+	glDepthMask( GL_FALSE );
+
+	StateCache::bindBuffer( GL_ARRAY_BUFFER, 0 );
+	glDisableClientState( GL_NORMAL_ARRAY );
+	glDisableClientState( GL_COLOR_ARRAY );
+	glDisableClientState( GL_TEXTURE_COORD_ARRAY );
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glVertexPointer( 3, GL_FLOAT, 0, &vertices[0].x );
+
+	for( size_t q = 0; q < mObj->mQueryNodes.size(); ++q ) {
+		Node &node = mObj->mNodes[mObj->mQueryNodes[q]];
+		if( ! node.mQuery )
+			glGenQueries( 1, &node.mQuery );
+		glBeginQuery( GL_SAMPLES_PASSED, node.mQuery );
+		glDrawArrays( GL_TRIANGLES, (GLint)( q * 36 ), 36 );
+		glEndQuery( GL_SAMPLES_PASSED );
+		node.mPending = true;
+	}
+
+	glPopClientAttrib();
+	glPopAttrib();
+	mObj->mNumQueriesIssued = mObj->mQueryNodes.size();
+	mObj->mQueryNodes.clear();
+	mObj->mQueryBoxes.clear();
+#endif
+}
+
+} } // namespace cinder::gl
@@ -0,0 +1,78 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/ParticleMesh.h"
+
+namespace cinder { namespace gl {
+
+namespace {
+
+void copyParticlesRange( const Vec3f *positions, const ColorA *colors, uint8_t *dest, size_t stride, size_t positionOffset, size_t colorOffset, size_t begin, size_t end )
+{
+	uint8_t *vertex = dest + begin * stride;
+	for( size_t i = begin; i < end; ++i, vertex += stride ) {
+		*reinterpret_cast<Vec3f*>( vertex + positionOffset ) = positions[i];
+		*reinterpret_cast<ColorA*>( vertex + colorOffset ) = colors[i];
+	}
+}
+
+} // anonymous namespace
+
+ParticleMesh::ParticleMesh( size_t capacity, size_t numBuffers )
+	: mNumBuffers( numBuffers ), mNumParticles( 0 )
+{
+	allocate( std::max<size_t>( capacity, 1 ) );
+}
+
+void ParticleMesh::allocate( size_t capacity )
+{
+	VboMesh::Layout layout;
+	layout.setDynamicPositions();
+	layout.setDynamicColorsRGBA();
+	mVboMesh = VboMesh( capacity, 0, layout, GL_POINTS );
+	mVboMesh.setNumDynamicBuffers( mNumBuffers );
+}
+
+void ParticleMesh::update( const ParticleSystem &particles )
+{
+	mNumParticles = particles.size();
+	if( mNumParticles > mVboMesh.getNumVertices() )
+		allocate( std::max( mNumParticles, mVboMesh.getNumVertices() * 2 ) );
+	if( ! mNumParticles )
+		return;
+
+	VboMesh::VertexIter iter = mVboMesh.mapVertexBuffer();
+	uint8_t *data = reinterpret_cast<uint8_t*>( iter.getPointer() );
+	const size_t positionOffset = reinterpret_cast<uint8_t*>( iter.getPositionPointer() ) - data;
+	const size_t colorOffset = reinterpret_cast<uint8_t*>( iter.getColorRGBAPointer() ) - data;
+	particles.parallelFor( std::bind( copyParticlesRange, particles.getPositions(), particles.getColors(), data, iter.getStride(), positionOffset, colorOffset, std::_1, std::_2 ) );
+}
+
+void ParticleMesh::draw() const
+{
+	if( mNumParticles )
+		drawArrays( mVboMesh, 0, (GLsizei)mNumParticles );
+}
+
+} } // namespace cinder::gl
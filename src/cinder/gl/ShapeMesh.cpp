@@ -0,0 +1,104 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/ShapeMesh.h"
+#include "cinder/gl/gl.h"
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace {
+
+bool sameShape( const Shape2d &a, const Shape2d &b )
+{
+	const vector<Path2d> &contoursA = a.getContours(), &contoursB = b.getContours();
+	if( contoursA.size() != contoursB.size() )
+		return false;
+	for( size_t c = 0; c < contoursA.size(); ++c )
+		if( contoursA[c].getSegments() != contoursB[c].getSegments() || contoursA[c].getPoints() != contoursB[c].getPoints() )
+			return false;
+
+	return true;
+}
+
+} // anonymous namespace
+
+ShapeMesh::ShapeMesh( const Shape2d &shape, Triangulator::Winding winding, float approximationScale )
+	: mObj( new Obj )
+{
+	mObj->mShape = shape;
+	mObj->mStroke = false;
+	mObj->mWinding = winding;
+	mObj->mApproximationScale = approximationScale;
+	tessellate();
+}
+
+ShapeMesh::ShapeMesh( const Shape2d &shape, const StrokeTriangulator::Format &format, float approximationScale )
+	: mObj( new Obj )
+{
+	mObj->mShape = shape;
+	mObj->mStroke = true;
+	mObj->mWinding = Triangulator::WINDING_ODD;
+	mObj->mStrokeFormat = format;
+	mObj->mApproximationScale = approximationScale;
+	tessellate();
+}
+
+bool ShapeMesh::update( const Shape2d &shape )
+{
+	if( sameShape( shape, mObj->mShape ) )
+		return false;
+
+	mObj->mShape = shape;
+	tessellate();
+	return true;
+}
+
+void ShapeMesh::tessellate()
+{
+	if( mObj->mStroke )
+		mObj->mTriMesh = StrokeTriangulator( mObj->mShape, mObj->mStrokeFormat, mObj->mApproximationScale ).calcMesh();
+	else
+		mObj->mTriMesh = Triangulator( mObj->mShape, mObj->mApproximationScale ).calcMesh( mObj->mWinding );
+
+#if ! defined( CINDER_GLES )
+	if( mObj->mTriMesh.getNumIndices() > 0 )
+		mObj->mVboMesh = VboMesh( mObj->mTriMesh );
+	else
+		mObj->mVboMesh = VboMesh();
+#endif
+}
+
+void ShapeMesh::draw() const
+{
+#if ! defined( CINDER_GLES )
+	if( mObj->mVboMesh )
+		gl::draw( mObj->mVboMesh );
+#else
+	gl::draw( mObj->mTriMesh );
+#endif
+}
+
+} } // namespace cinder::gl
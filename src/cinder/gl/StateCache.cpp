@@ -0,0 +1,320 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/StateCache.h"
+#include "cinder/Thread.h"
+
+#if defined( CINDER_MAC )
+	#include <OpenGL/OpenGL.h>
+#endif
+
+#if defined( CINDER_GLES )
+	#define GL_SUFFIX(sym) sym##OES
+#else
+	#define GL_SUFFIX(sym) sym##EXT
+#endif
+
+namespace cinder { namespace gl {
+
+bool StateCache::sEnabled = false;
+
+namespace {
+
+typedef std::map<const void*,StateCache*>	CacheMap;
+
+std::mutex& cacheMutex()
+{
+	static std::mutex sMutex;
+	return sMutex;
+}
+
+CacheMap& cacheMap()
+{
+	static CacheMap sCaches;
+	return sCaches;
+}
+
+const void* currentContext()
+{
+#if defined( CINDER_MAC )
+	return ::CGLGetCurrentContext();
+#elif defined( CINDER_MSW )
+	return ::wglGetCurrentContext();
+#else
+	return 0;
+#endif
+}
+
+} // anonymous namespace
+
+StateCache::StateCache()
+	: mNumFiltered( 0 ), mNumIssued( 0 )
+{
+	reset();
+}
+
+void StateCache::reset()
+{
+	mCaps.clear();
+	mBlendSrc = mBlendDst = UNKNOWN;
+	mDepthMask = UNKNOWN;
+	mActiveTexture = UNKNOWN;
+	for( GLuint unit = 0; unit < MAX_TEXTURE_UNITS; ++unit )
+		for( int t = 0; t < 3; ++t )
+			mTextures[unit][t] = UNKNOWN;
+	mProgram = UNKNOWN;
+	mReadFramebuffer = mDrawFramebuffer = UNKNOWN;
+	mArrayBuffer = mElementArrayBuffer = UNKNOWN;
+}
+
+StateCache& StateCache::current()
+{
+	std::lock_guard<std::mutex> lock( cacheMutex() );
+	StateCache *&cache = cacheMap()[currentContext()];
+	if( ! cache )
+		cache = new StateCache;
+	return *cache;
+}
+
+void StateCache::setEnabled( bool enable )
+{
+	std::lock_guard<std::mutex> lock( cacheMutex() );
+	sEnabled = enable;
+	for( CacheMap::iterator cacheIt = cacheMap().begin(); cacheIt != cacheMap().end(); ++cacheIt )
+		cacheIt->second->reset();
+}
+
+void StateCache::invalidate()
+{
+	current().reset();
+}
+
+bool StateCache::filter( GLint *cached, GLint value )
+{
+	if( *cached == value ) {
+		++mNumFiltered;
+		return true;
+	}
+	*cached = value;
+	++mNumIssued;
+	return false;
+}
+
+GLint* StateCache::textureSlot( GLuint unit, GLenum target )
+{
+	if( unit >= MAX_TEXTURE_UNITS )
+		return 0;
+	switch( target ) {
+		case GL_TEXTURE_2D: return &mTextures[unit][0];
+#if ! defined( CINDER_GLES )
+		case GL_TEXTURE_RECTANGLE_ARB: return &mTextures[unit][1];
+		case GL_TEXTURE_CUBE_MAP: return &mTextures[unit][2];
+#endif
+		default: return 0;
+	}
+}
+
+void StateCache::enable( GLenum cap )
+{
+	if( sEnabled ) {
+		StateCache &cache = current();
+		std::map<GLenum,GLint>::iterator capIt = cache.mCaps.insert( std::make_pair( cap, UNKNOWN ) ).first;
+		if( cache.filter( &capIt->second, GL_TRUE ) )
+			return;
+	}
+	glEnable( cap );
+}
+
+void StateCache::disable( GLenum cap )
+{
+	if( sEnabled ) {
+		StateCache &cache = current();
+		std::map<GLenum,GLint>::iterator capIt = cache.mCaps.insert( std::make_pair( cap, UNKNOWN ) ).first;
+		if( cache.filter( &capIt->second, GL_FALSE ) )
+			return;
+	}
+	glDisable( cap );
+}
+
+void StateCache::blendFunc( GLenum sfactor, GLenum dfactor )
+{
+	if( sEnabled ) {
+		StateCache &cache = current();
+		if( cache.mBlendSrc == (GLint)sfactor && cache.mBlendDst == (GLint)dfactor ) {
+			++cache.mNumFiltered;
+			return;
+		}
+		cache.mBlendSrc = sfactor;
+		cache.mBlendDst = dfactor;
+		++cache.mNumIssued;
+	}
+	glBlendFunc( sfactor, dfactor );
+}
+
+void StateCache::depthMask( GLboolean flag )
+{
+	if( sEnabled ) {
+		StateCache &cache = current();
+		if( cache.filter( &cache.mDepthMask, flag ) )
+			return;
+	}
+	glDepthMask( flag );
+}
+
+void StateCache::activeTexture( GLuint textureUnit )
+{
+	if( sEnabled ) {
+		StateCache &cache = current();
+		if( cache.filter( &cache.mActiveTexture, textureUnit ) )
+			return;
+	}
+	glActiveTexture( GL_TEXTURE0 + textureUnit );
+}
+
+void StateCache::bindTexture( GLenum target, GLuint textureId )
+{
+	if( sEnabled ) {
+		StateCache &cache = current();
+		// without knowing the active unit there is no way to know which binding this replaces
+		GLint *slot = ( cache.mActiveTexture != UNKNOWN ) ? cache.textureSlot( cache.mActiveTexture, target ) : 0;
+		if( slot && cache.filter( slot, textureId ) )
+			return;
+	}
+	glBindTexture( target, textureId );
+}
+
+void StateCache::bindTexture( GLenum target, GLuint textureId, GLuint textureUnit )
+{
+	if( sEnabled ) {
+		StateCache &cache = current();
+		GLint *slot = cache.textureSlot( textureUnit, target );
+		if( slot && *slot == (GLint)textureId ) {
+			++cache.mNumFiltered;
+			return;
+		}
+	}
+	activeTexture( textureUnit );
+	bindTexture( target, textureId );
+	activeTexture( 0 );
+}
+
+void StateCache::useProgram( GLuint program )
+{
+#if ! defined( CINDER_GLES )
+	if( sEnabled ) {
+		StateCache &cache = current();
+		if( cache.filter( &cache.mProgram, program ) )
+			return;
+	}
+	glUseProgram( program );
+#endif
+}
+
+void StateCache::bindFramebuffer( GLenum target, GLuint framebuffer )
+{
+	if( sEnabled ) {
+		StateCache &cache = current();
+#if ! defined( CINDER_GLES )
+		if( target == GL_READ_FRAMEBUFFER_EXT ) {
+			if( cache.filter( &cache.mReadFramebuffer, framebuffer ) )
+				return;
+		}
+		else if( target == GL_DRAW_FRAMEBUFFER_EXT ) {
+			if( cache.filter( &cache.mDrawFramebuffer, framebuffer ) )
+				return;
+		}
+		else
+#endif
+		if( cache.mReadFramebuffer == (GLint)framebuffer && cache.mDrawFramebuffer == (GLint)framebuffer ) {
+			++cache.mNumFiltered;
+			return;
+		}
+		else {
+			cache.mReadFramebuffer = cache.mDrawFramebuffer = framebuffer;
+			++cache.mNumIssued;
+		}
+	}
+	GL_SUFFIX(glBindFramebuffer)( target, framebuffer );
+}
+
+void StateCache::bindBuffer( GLenum target, GLuint buffer )
+{
+	if( sEnabled ) {
+		StateCache &cache = current();
+		GLint *slot = 0;
+		if( target == GL_ARRAY_BUFFER )
+			slot = &cache.mArrayBuffer;
+		else if( target == GL_ELEMENT_ARRAY_BUFFER )
+			slot = &cache.mElementArrayBuffer;
+		if( slot && cache.filter( slot, buffer ) )
+			return;
+	}
+	glBindBuffer( target, buffer );
+}
+
+void StateCache::textureDeleted( GLuint textureId )
+{
+	if( ! sEnabled )
+		return;
+	// GL reverts any unit the texture was bound to back to 0
+	StateCache &cache = current();
+	for( GLuint unit = 0; unit < MAX_TEXTURE_UNITS; ++unit )
+		for( int t = 0; t < 3; ++t )
+			if( cache.mTextures[unit][t] == (GLint)textureId )
+				cache.mTextures[unit][t] = 0;
+}
+
+void StateCache::programDeleted( GLuint program )
+{
+	if( ! sEnabled )
+		return;
+	// a program in use is only flagged for deletion, so it is safest to forget it entirely
+	StateCache &cache = current();
+	if( cache.mProgram == (GLint)program )
+		cache.mProgram = UNKNOWN;
+}
+
+void StateCache::framebufferDeleted( GLuint framebuffer )
+{
+	if( ! sEnabled )
+		return;
+	StateCache &cache = current();
+	if( cache.mReadFramebuffer == (GLint)framebuffer )
+		cache.mReadFramebuffer = 0;
+	if( cache.mDrawFramebuffer == (GLint)framebuffer )
+		cache.mDrawFramebuffer = 0;
+}
+
+void StateCache::bufferDeleted( GLuint buffer )
+{
+	if( ! sEnabled )
+		return;
+	StateCache &cache = current();
+	if( cache.mArrayBuffer == (GLint)buffer )
+		cache.mArrayBuffer = 0;
+	if( cache.mElementArrayBuffer == (GLint)buffer )
+		cache.mElementArrayBuffer = 0;
+}
+
+} } // namespace cinder::gl
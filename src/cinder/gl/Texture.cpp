@@ -23,6 +23,9 @@
 #include "cinder/gl/gl.h" // has to be first
 #include "cinder/ImageIo.h"
 #include "cinder/gl/Texture.h"
+#include "cinder/gl/StateCache.h"
+#include "cinder/gl/GpuMemory.h"
+#include "cinder/ip/Half.h"
 #include <stdio.h>
 
 using namespace std;
@@ -36,6 +39,32 @@ class ImageTargetTexture;
 TextureDataExc::TextureDataExc( const std::string &log ) throw()
 { strncpy( mMessage, log.c_str(), 16000 ); }
 
+#if ! defined( CINDER_GLES )
+static bool isHalfFloatFormat( GLint internalFormat )
+{
+	switch( internalFormat ) {
+		case GL_RGBA16F_ARB:
+		case GL_RGB16F_ARB:
+		case GL_ALPHA16F_ARB:
+		case GL_INTENSITY16F_ARB:
+		case GL_LUMINANCE16F_ARB:
+		case GL_LUMINANCE_ALPHA16F_ARB:
+			return true;
+		default:
+			return false;
+	}
+}
+
+// packs the rows of floats at data, rowBytes apart, into contiguous half floats
+static vector<uint16_t> convertToHalfRows( const float *data, int32_t rowBytes, int32_t floatsPerRow, int32_t height )
+{
+	vector<uint16_t> result( floatsPerRow * height );
+	for( int32_t y = 0; y < height; ++y )
+		ip::floatToHalf( reinterpret_cast<const float*>( reinterpret_cast<const uint8_t*>( data ) + y * rowBytes ), &result[y * floatsPerRow], floatsPerRow );
+	return result;
+}
+#endif
+
 /////////////////////////////////////////////////////////////////////////////////
 // ImageTargetGLTexture
 template<typename T>
@@ -81,7 +110,15 @@ Texture::Obj::~Obj()
 
 	if( ( mTextureID > 0 ) && ( ! mDoNotDispose ) ) {
 		glDeleteTextures( 1, &mTextureID );
+		StateCache::textureDeleted( mTextureID );
 	}
+	GpuMemory::reallocate( GpuMemory::TEXTURE, mAllocatedBytes, 0 );
+}
+
+void Texture::Obj::setAllocatedBytes( size_t bytes )
+{
+	GpuMemory::reallocate( GpuMemory::TEXTURE, mAllocatedBytes, bytes );
+	mAllocatedBytes = bytes;
 }
 
 
@@ -122,6 +159,28 @@ Texture::Texture( const Surface8u &surface, Format format )
 	init( surface.getData(), surface.getRowBytes() / surface.getChannelOrder().getPixelInc(), dataFormat, type, format );	
 }
 
+Texture::Texture( const Surface16u &surface, Format format )
+	: mObj( shared_ptr<Obj>( new Obj( surface.getWidth(), surface.getHeight() ) ) )
+{
+	if( format.mInternalFormat < 0 ) {
+#if ! defined( CINDER_GLES )
+		format.mInternalFormat = surface.hasAlpha() ? GL_RGBA16 : GL_RGB16;
+#else
+		format.mInternalFormat = surface.hasAlpha() ? GL_RGBA : GL_RGB;
+#endif
+	}
+	mObj->mInternalFormat = format.mInternalFormat;
+	mObj->mTarget = format.mTarget;
+
+	GLint dataFormat;
+	GLenum type;
+	SurfaceChannelOrderToDataFormatAndType( surface.getChannelOrder(), &dataFormat, &type );
+	if( type != GL_UNSIGNED_BYTE ) // packed 8 bit orders such as ARGB have no 16 bit equivalent
+		throw TextureDataExc( "Invalid channel order" );
+
+	init( reinterpret_cast<const unsigned char*>( surface.getData() ), surface.getRowBytes() / ( surface.getPixelInc() * sizeof(uint16_t) ), dataFormat, GL_UNSIGNED_SHORT, format );
+}
+
 Texture::Texture( const Surface32f &surface, Format format )
 	: mObj( shared_ptr<Obj>( new Obj( surface.getWidth(), surface.getHeight() ) ) )
 {
@@ -144,6 +203,14 @@ Texture::Texture( const Surface32f &surface, Format format )
 	mObj->mInternalFormat = format.mInternalFormat;
 	mObj->mTarget = format.mTarget;
 
+#if ! defined( CINDER_GLES )
+	if( isHalfFloatFormat( format.mInternalFormat ) ) {
+		vector<uint16_t> halfData = convertToHalfRows( surface.getData(), surface.getRowBytes(), surface.getWidth() * surface.getPixelInc(), surface.getHeight() );
+		init( reinterpret_cast<const unsigned char*>( &halfData[0] ), surface.getWidth(), surface.hasAlpha() ? GL_RGBA : GL_RGB, GL_HALF_FLOAT_ARB, format );
+		return;
+	}
+#endif
+
 	init( surface.getData(), surface.hasAlpha()?GL_RGBA:GL_RGB, format );	
 }
 
@@ -176,6 +243,40 @@ Texture::Texture( const Channel8u &channel, Format format )
 		init( channel.getData(), channel.getRowBytes() / channel.getIncrement(), GL_LUMINANCE, GL_UNSIGNED_BYTE, format );
 }
 
+Texture::Texture( const Channel16u &channel, Format format )
+	: mObj( shared_ptr<Obj>( new Obj( channel.getWidth(), channel.getHeight() ) ) )
+{
+	if( format.mInternalFormat < 0 ) {
+#if ! defined( CINDER_GLES )
+		format.mInternalFormat = GL_LUMINANCE16;
+#else
+		format.mInternalFormat = GL_LUMINANCE;
+#endif
+	}
+
+	mObj->mInternalFormat = format.mInternalFormat;
+	mObj->mTarget = format.mTarget;
+
+	// if the data is not already contiguous, we'll need to create a block of memory that is
+	if( ( channel.getIncrement() != 1 ) || ( channel.getRowBytes() != channel.getWidth() * sizeof(uint16_t) ) ) {
+		vector<uint16_t> data( channel.getWidth() * channel.getHeight() );
+		uint16_t *dest = &data[0];
+		const int8_t inc = channel.getIncrement();
+		const int32_t width = channel.getWidth();
+		for( int y = 0; y < channel.getHeight(); ++y ) {
+			const uint16_t *src = channel.getData( 0, y );
+			for( int x = 0; x < width; ++x ) {
+				*dest++ = *src;
+				src += inc;
+			}
+		}
+	
+		init( reinterpret_cast<const unsigned char*>( &data[0] ), width, GL_LUMINANCE, GL_UNSIGNED_SHORT, format );
+	}
+	else
+		init( reinterpret_cast<const unsigned char*>( channel.getData() ), channel.getWidth(), GL_LUMINANCE, GL_UNSIGNED_SHORT, format );
+}
+
 Texture::Texture( const Channel32f &channel, Format format )
 	: mObj( shared_ptr<Obj>( new Obj( channel.getWidth(), channel.getHeight() ) ) )
 {
@@ -249,7 +350,7 @@ void Texture::init( const unsigned char *data, int unpackRowLength, GLenum dataF
 
 	glGenTextures( 1, &mObj->mTextureID );
 
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
 	glTexParameteri( mObj->mTarget, GL_TEXTURE_WRAP_S, format.mWrapS );
 	glTexParameteri( mObj->mTarget, GL_TEXTURE_WRAP_T, format.mWrapT );
 	glTexParameteri( mObj->mTarget, GL_TEXTURE_MIN_FILTER, format.mMinFilter );	
@@ -272,6 +373,7 @@ void Texture::init( const unsigned char *data, int unpackRowLength, GLenum dataF
 #if ! defined( CINDER_GLES )
 	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
 #endif	
+	mObj->setAllocatedBytes( GpuMemory::getImageBytes( mObj->mInternalFormat, mObj->mWidth, mObj->mHeight, format.mMipmapping ) );
 }
 
 void Texture::init( const float *data, GLint dataFormat, const Format &format )
@@ -280,7 +382,7 @@ void Texture::init( const float *data, GLint dataFormat, const Format &format )
 
 	glGenTextures( 1, &mObj->mTextureID );
 
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
 	glTexParameteri( mObj->mTarget, GL_TEXTURE_WRAP_S, format.mWrapS );
 	glTexParameteri( mObj->mTarget, GL_TEXTURE_WRAP_T, format.mWrapT );
 	glTexParameteri( mObj->mTarget, GL_TEXTURE_MIN_FILTER, format.mMinFilter );	
@@ -301,6 +403,7 @@ void Texture::init( const float *data, GLint dataFormat, const Format &format )
 	}
 	else
 		glTexImage2D( mObj->mTarget, 0, mObj->mInternalFormat, mObj->mWidth, mObj->mHeight, 0, GL_LUMINANCE, GL_FLOAT, 0 );  // init to black...
+	mObj->setAllocatedBytes( GpuMemory::getImageBytes( mObj->mInternalFormat, mObj->mWidth, mObj->mHeight, format.mMipmapping ) );
 }
 
 void Texture::init( ImageSourceRef imageSource, const Format &format )
@@ -379,7 +482,7 @@ void Texture::init( ImageSourceRef imageSource, const Format &format )
 	}
 
 	glGenTextures( 1, &mObj->mTextureID );
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
 
 	glTexParameteri( mObj->mTarget, GL_TEXTURE_WRAP_S, format.mWrapS );
 	glTexParameteri( mObj->mTarget, GL_TEXTURE_WRAP_T, format.mWrapT );
@@ -412,6 +515,7 @@ void Texture::init( ImageSourceRef imageSource, const Format &format )
 		imageSource->load( target );		
 		glTexImage2D( mObj->mTarget, 0, mObj->mInternalFormat, mObj->mWidth, mObj->mHeight, 0, dataFormat, GL_FLOAT, target->getData() );
 	}
+	mObj->setAllocatedBytes( GpuMemory::getImageBytes( mObj->mInternalFormat, mObj->mWidth, mObj->mHeight, format.mMipmapping ) );
 }
 
 void Texture::update( const Surface &surface )
@@ -422,7 +526,16 @@ void Texture::update( const Surface &surface )
 	if( ( surface.getWidth() != getWidth() ) || ( surface.getHeight() != getHeight() ) )
 		throw TextureDataExc( "Invalid Texture::update() surface dimensions" );
 
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
+	// a tracking Surface only needs its modified Areas uploaded
+	if( surface.isDirtyTracking() ) {
+		const std::vector<Area> &dirtyAreas = surface.getDirtyAreas();
+		for( std::vector<Area>::const_iterator areaIt = dirtyAreas.begin(); areaIt != dirtyAreas.end(); ++areaIt )
+			update( surface, *areaIt );
+		surface.clearDirty();
+		return;
+	}
+
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
 	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
 #if ! defined( CINDER_GLES )
 	glPixelStorei( GL_UNPACK_ROW_LENGTH, surface.getRowBytes() / surface.getPixelInc() );
@@ -433,6 +546,27 @@ void Texture::update( const Surface &surface )
 #endif
 }
 
+void Texture::update( const Surface16u &surface )
+{
+	GLint dataFormat;
+	GLenum type;
+	SurfaceChannelOrderToDataFormatAndType( surface.getChannelOrder(), &dataFormat, &type );
+	if( type != GL_UNSIGNED_BYTE )
+		throw TextureDataExc( "Invalid channel order" );
+	if( ( surface.getWidth() != getWidth() ) || ( surface.getHeight() != getHeight() ) )
+		throw TextureDataExc( "Invalid Texture::update() surface dimensions" );
+
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+#if ! defined( CINDER_GLES )
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, surface.getRowBytes() / ( surface.getPixelInc() * sizeof(uint16_t) ) );
+#endif
+	glTexSubImage2D( mObj->mTarget, 0, 0, 0, getWidth(), getHeight(), dataFormat, GL_UNSIGNED_SHORT, surface.getData() );
+#if ! defined( CINDER_GLES )
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+#endif
+}
+
 void Texture::update( const Surface32f &surface )
 {
 	GLint dataFormat;
@@ -441,8 +575,15 @@ void Texture::update( const Surface32f &surface )
 	if( ( surface.getWidth() != getWidth() ) || ( surface.getHeight() != getHeight() ) )
 		throw TextureDataExc( "Invalid Texture::update() surface dimensions" );
 
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
 	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+#if ! defined( CINDER_GLES )
+	if( isHalfFloatFormat( getInternalFormat() ) ) {
+		vector<uint16_t> halfData = convertToHalfRows( surface.getData(), surface.getRowBytes(), surface.getWidth() * surface.getPixelInc(), surface.getHeight() );
+		glTexSubImage2D( mObj->mTarget, 0, 0, 0, getWidth(), getHeight(), dataFormat, GL_HALF_FLOAT_ARB, &halfData[0] );
+		return;
+	}
+#endif
 #if ! defined( CINDER_GLES )
 	glPixelStorei( GL_UNPACK_ROW_LENGTH, surface.getRowBytes() / ( surface.getPixelInc() * sizeof(float)) );
 #endif
@@ -459,8 +600,98 @@ void Texture::update( const Surface &surface, const Area &area )
 	GLenum type;
 	SurfaceChannelOrderToDataFormatAndType( surface.getChannelOrder(), &dataFormat, &type );
 
-	glBindTexture( mObj->mTarget, mObj->mTextureID );	
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );	
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+#if ! defined( CINDER_GLES )
+	// rows of the Area are a whole Surface row apart
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, surface.getRowBytes() / surface.getPixelInc() );
+#endif
 	glTexSubImage2D( mObj->mTarget, 0, area.getX1(), area.getY1(), area.getWidth(), area.getHeight(), dataFormat, type, surface.getData( area.getUL() ) );
+#if ! defined( CINDER_GLES )
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+#endif
+}
+
+template<typename T>
+static void uploadMipmapLevel( GLenum target, GLint level, GLint internalFormat, const SurfaceT<T> &surface, GLenum type )
+{
+	GLint dataFormat;
+	GLenum unusedType;
+	Texture::SurfaceChannelOrderToDataFormatAndType( surface.getChannelOrder(), &dataFormat, &unusedType );
+#if ! defined( CINDER_GLES )
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, surface.getRowBytes() / ( surface.getPixelInc() * sizeof(T) ) );
+#endif
+	glTexImage2D( target, level, internalFormat, surface.getWidth(), surface.getHeight(), 0, dataFormat, type, surface.getData() );
+}
+
+template<typename T>
+static void uploadMipmapLevel( GLenum target, GLint level, GLint internalFormat, const ChannelT<T> &channel, GLenum type )
+{
+	if( channel.getIncrement() != 1 )
+		throw TextureDataExc( "Texture::updateMipmaps() requires planar Channels" );
+#if ! defined( CINDER_GLES )
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, channel.getRowBytes() / sizeof(T) );
+#endif
+	glTexImage2D( target, level, internalFormat, channel.getWidth(), channel.getHeight(), 0, GL_LUMINANCE, type, channel.getData() );
+}
+
+// Uploads each of \a levels to the mip level of its index, checking that each is the size OpenGL expects of it
+template<typename ImageT>
+static void uploadMipmaps( GLenum target, GLint internalFormat, int32_t width, int32_t height, const std::vector<ImageT> &levels, GLenum type )
+{
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+	for( size_t level = 0; level < levels.size(); ++level ) {
+		if( ( levels[level].getWidth() != width ) || ( levels[level].getHeight() != height ) )
+			throw TextureDataExc( "Invalid Texture::updateMipmaps() level dimensions" );
+		uploadMipmapLevel( target, (GLint)level, internalFormat, levels[level], type );
+		width = std::max( width / 2, 1 );
+		height = std::max( height / 2, 1 );
+	}
+#if ! defined( CINDER_GLES )
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+	if( ! levels.empty() )
+		glTexParameteri( target, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1 );
+#endif
+}
+
+// the estimated bytes of the first \a numLevels levels of a mip chain starting at \a width x \a height
+static size_t getMipChainBytes( GLint internalFormat, int32_t width, int32_t height, size_t numLevels )
+{
+	size_t result = 0;
+	for( size_t level = 0; level < numLevels; ++level ) {
+		result += GpuMemory::getImageBytes( internalFormat, width, height );
+		width = std::max( width / 2, 1 );
+		height = std::max( height / 2, 1 );
+	}
+	return result;
+}
+
+void Texture::updateMipmaps( const std::vector<Surface8u> &levels )
+{
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
+	uploadMipmaps( mObj->mTarget, getInternalFormat(), getWidth(), getHeight(), levels, GL_UNSIGNED_BYTE );
+	mObj->setAllocatedBytes( getMipChainBytes( getInternalFormat(), getWidth(), getHeight(), levels.size() ) );
+}
+
+void Texture::updateMipmaps( const std::vector<Surface32f> &levels )
+{
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
+	uploadMipmaps( mObj->mTarget, getInternalFormat(), getWidth(), getHeight(), levels, GL_FLOAT );
+	mObj->setAllocatedBytes( getMipChainBytes( getInternalFormat(), getWidth(), getHeight(), levels.size() ) );
+}
+
+void Texture::updateMipmaps( const std::vector<Channel8u> &levels )
+{
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
+	uploadMipmaps( mObj->mTarget, getInternalFormat(), getWidth(), getHeight(), levels, GL_UNSIGNED_BYTE );
+	mObj->setAllocatedBytes( getMipChainBytes( getInternalFormat(), getWidth(), getHeight(), levels.size() ) );
+}
+
+void Texture::updateMipmaps( const std::vector<Channel32f> &levels )
+{
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
+	uploadMipmaps( mObj->mTarget, getInternalFormat(), getWidth(), getHeight(), levels, GL_FLOAT );
+	mObj->setAllocatedBytes( getMipChainBytes( getInternalFormat(), getWidth(), getHeight(), levels.size() ) );
 }
 
 void Texture::update( const Channel32f &channel )
@@ -468,13 +699,13 @@ void Texture::update( const Channel32f &channel )
 	if( ( channel.getWidth() != getWidth() ) || ( channel.getHeight() != getHeight() ) )
 		throw TextureDataExc( "Invalid Texture::update() channel dimensions" );
 
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
 	glTexSubImage2D( mObj->mTarget, 0, 0, 0, getWidth(), getHeight(), GL_LUMINANCE, GL_FLOAT, channel.getData() );
 }
 
 void Texture::update( const Channel8u &channel, const Area &area )
 {
-	glBindTexture( mObj->mTarget, mObj->mTextureID );	
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );	
 	// if the data is not already contiguous, we'll need to create a block of memory that is
 	if( ( channel.getIncrement() != 1 ) || ( channel.getRowBytes() != channel.getWidth() * sizeof(uint8_t) ) ) {
 		shared_ptr<uint8_t> data( new uint8_t[area.getWidth() * area.getHeight()], checked_array_deleter<uint8_t>() );
@@ -710,7 +941,7 @@ Texture Texture::loadDds( IStreamRef ddsStream, Format format )
 		result.mObj->mHeight = height;
 		result.mObj->mInternalFormat = dataFormat;
 
-		glBindTexture( result.mObj->mTarget, result.mObj->mTextureID );
+		StateCache::bindTexture( result.mObj->mTarget, result.mObj->mTextureID );
 		glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
 
 		// load the mipmaps
@@ -728,6 +959,8 @@ Texture Texture::loadDds( IStreamRef ddsStream, Format format )
 			height >>= 1; 
 		}
 
+		result.mObj->setAllocatedBytes( offset );
+
 		if( numMipMaps > 1 ) {
 			glTexParameteri( result.mObj->mTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );	
 			glTexParameteri( result.mObj->mTarget, GL_TEXTURE_MAG_FILTER, GL_LINEAR_MIPMAP_LINEAR );			
@@ -745,6 +978,125 @@ Texture Texture::loadDds( IStreamRef ddsStream, Format format )
 }
 #endif // ! defined( CINDER_GLES )
 
+Texture Texture::loadKtx( IStreamRef ktxStream, Format format )
+{
+	typedef struct {
+		uint32_t	glType;
+		uint32_t	glTypeSize;
+		uint32_t	glFormat;
+		uint32_t	glInternalFormat;
+		uint32_t	glBaseInternalFormat;
+		uint32_t	pixelWidth;
+		uint32_t	pixelHeight;
+		uint32_t	pixelDepth;
+		uint32_t	numberOfArrayElements;
+		uint32_t	numberOfFaces;
+		uint32_t	numberOfMipmapLevels;
+		uint32_t	bytesOfKeyValueData;
+	} ktxHeader;
+
+	static const uint8_t KTX_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+	try {
+		uint8_t identifier[12];
+		ktxStream->readData( identifier, 12 );
+		if( memcmp( identifier, KTX_IDENTIFIER, 12 ) != 0 )
+			return Texture();
+
+		// the endianness field is written natively by the file's creator, which determines how everything after it is read
+		uint32_t endianness;
+		ktxStream->readLittle( &endianness );
+		uint8_t endian;
+		if( endianness == 0x04030201 )
+			endian = StreamBase::STREAM_LITTLE_ENDIAN;
+		else if( endianness == 0x01020304 )
+			endian = StreamBase::STREAM_BIG_ENDIAN;
+		else
+			return Texture();
+
+		ktxHeader header;
+		uint32_t *fields = reinterpret_cast<uint32_t*>( &header );
+		for( size_t f = 0; f < sizeof(ktxHeader) / sizeof(uint32_t); ++f )
+			ktxStream->readEndian( &fields[f], endian );
+
+		// only plain 2D textures
+		if( ( header.pixelWidth == 0 ) || ( header.pixelHeight == 0 ) || ( header.pixelDepth > 1 ) || ( header.numberOfArrayElements > 0 ) || ( header.numberOfFaces != 1 ) )
+			return Texture();
+		const bool compressed = ( header.glType == 0 );
+		const bool swapSamples = ( endian != StreamBase::getNativeEndianness() ) && ( ( header.glTypeSize == 2 ) || ( header.glTypeSize == 4 ) );
+
+		ktxStream->seekRelative( header.bytesOfKeyValueData );
+
+		GLuint texID;
+		glGenTextures( 1, &texID );
+		Texture result( format.mTarget, texID, header.pixelWidth, header.pixelHeight, false );
+		result.mObj->mInternalFormat = header.glInternalFormat;
+
+		StateCache::bindTexture( result.mObj->mTarget, result.mObj->mTextureID );
+		glTexParameteri( result.mObj->mTarget, GL_TEXTURE_WRAP_S, format.mWrapS );
+		glTexParameteri( result.mObj->mTarget, GL_TEXTURE_WRAP_T, format.mWrapT );
+		glPixelStorei( GL_UNPACK_ALIGNMENT, 4 ); // KTX rows are padded to 4 bytes
+
+		// a level count of 0 asks the loader to generate the mip chain, which is only possible for uncompressed data
+		const uint32_t numLevels = std::max<uint32_t>( header.numberOfMipmapLevels, 1 );
+		const bool generateMipmaps = ( header.numberOfMipmapLevels == 0 ) && ( ! compressed ) && format.mMipmapping;
+		if( generateMipmaps )
+			glTexParameteri( result.mObj->mTarget, GL_GENERATE_MIPMAP, GL_TRUE );
+
+		std::vector<uint8_t> levelData;
+		size_t allocatedBytes = 0;
+		uint32_t width = header.pixelWidth, height = header.pixelHeight;
+		for( uint32_t level = 0; level < numLevels; ++level ) {
+			uint32_t imageSize;
+			ktxStream->readEndian( &imageSize, endian );
+			// level data is padded to a multiple of 4 bytes
+			levelData.resize( ( imageSize + 3 ) & ~3 );
+			if( ! levelData.empty() )
+				ktxStream->readData( &levelData[0], levelData.size() );
+
+			if( swapSamples ) {
+				if( header.glTypeSize == 2 ) {
+					for( size_t i = 0; i + 1 < imageSize; i += 2 )
+						std::swap( levelData[i], levelData[i+1] );
+				}
+				else {
+					for( size_t i = 0; i + 3 < imageSize; i += 4 ) {
+						std::swap( levelData[i], levelData[i+3] );
+						std::swap( levelData[i+1], levelData[i+2] );
+					}
+				}
+			}
+
+			if( compressed )
+				glCompressedTexImage2D( result.mObj->mTarget, level, header.glInternalFormat, width, height, 0, imageSize, levelData.empty() ? 0 : &levelData[0] );
+			else
+				glTexImage2D( result.mObj->mTarget, level, header.glInternalFormat, width, height, 0, header.glFormat, header.glType, levelData.empty() ? 0 : &levelData[0] );
+			allocatedBytes += imageSize;
+
+			width = std::max<uint32_t>( width >> 1, 1 );
+			height = std::max<uint32_t>( height >> 1, 1 );
+		}
+
+		// generated levels add a third to the size of the first
+		result.mObj->setAllocatedBytes( generateMipmaps ? allocatedBytes + allocatedBytes / 3 : allocatedBytes );
+
+		if( ( numLevels > 1 ) || generateMipmaps ) {
+#if ! defined( CINDER_GLES )
+			glTexParameteri( result.mObj->mTarget, GL_TEXTURE_MAX_LEVEL, generateMipmaps ? 1000 : numLevels - 1 );
+#endif
+			glTexParameteri( result.mObj->mTarget, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+		}
+		else
+			glTexParameteri( result.mObj->mTarget, GL_TEXTURE_MIN_FILTER, ( format.mMinFilter == GL_NEAREST ) ? GL_NEAREST : GL_LINEAR );
+		glTexParameteri( result.mObj->mTarget, GL_TEXTURE_MAG_FILTER, format.mMagFilter );
+
+		return result;
+	}
+	catch( ... ) {
+		return Texture();
+	}
+}
+
 Texture	Texture::weakClone() const
 {
 	gl::Texture result = Texture( mObj->mTarget, mObj->mTextureID, mObj->mWidth, mObj->mHeight, true );
@@ -940,22 +1292,18 @@ float Texture::getMaxV() const
 
 void Texture::bind( GLuint textureUnit ) const
 {
-	glActiveTexture( GL_TEXTURE0 + textureUnit );
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
-	glActiveTexture( GL_TEXTURE0 );
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID, textureUnit );
 }
 
 void Texture::unbind( GLuint textureUnit ) const
 {
-	glActiveTexture( GL_TEXTURE0 + textureUnit );
-	glBindTexture( mObj->mTarget, 0 );
-	glActiveTexture( GL_TEXTURE0 );
+	StateCache::bindTexture( mObj->mTarget, 0, textureUnit );
 }
 
 void Texture::enableAndBind() const
 {
 	glEnable( mObj->mTarget );
-	glBindTexture( mObj->mTarget, mObj->mTextureID );
+	StateCache::bindTexture( mObj->mTarget, mObj->mTextureID );
 }
 
 void Texture::disable() const
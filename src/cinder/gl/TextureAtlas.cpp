@@ -0,0 +1,263 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/TextureAtlas.h"
+#include "cinder/gl/StateCache.h"
+#include "cinder/ip/Fill.h"
+
+#include <cstring>
+#include <limits>
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+TextureAtlas::TextureAtlas( const Format &format )
+	: mFormat( format )
+{
+}
+
+void TextureAtlas::addPage()
+{
+	// start from transparent black so that unused pixels don't contribute garbage to mipmaps
+	Surface8u blank( mFormat.getTextureWidth(), mFormat.getTextureHeight(), true, SurfaceChannelOrder::RGBA );
+	ip::fill( &blank, ColorA8u( 0, 0, 0, 0 ) );
+
+	Texture::Format textureFormat;
+	textureFormat.setInternalFormat( GL_RGBA );
+	textureFormat.enableMipmapping( mFormat.hasMipmapping() );
+	if( mFormat.hasMipmapping() )
+		textureFormat.setMinFilter( GL_LINEAR_MIPMAP_LINEAR );
+
+	mPages.push_back( Page() );
+	mPages.back().mTexture = Texture( blank, textureFormat );
+	mPages.back().mSkyline.push_back( SkylineNode( 0, 0, mFormat.getTextureWidth() ) );
+	mPages.back().mUsedPixels = 0;
+}
+
+bool TextureAtlas::fits( int32_t width, int32_t height ) const
+{
+	return ( width > 0 ) && ( height > 0 )
+		&& ( width + 2 * mFormat.getPadding() <= mFormat.getTextureWidth() ) && ( height + 2 * mFormat.getPadding() <= mFormat.getTextureHeight() );
+}
+
+// Bottom-left skyline packing: the skyline is the upper edge of the occupied space, stored as horizontal segments sorted by x.
+// The rectangle goes wherever its top edge ends up lowest, preferring the narrowest segment on ties, and the skyline is then raised beneath it.
+bool TextureAtlas::pack( Page *page, int32_t width, int32_t height, Vec2i *result )
+{
+	vector<SkylineNode> &skyline = page->mSkyline;
+	const int32_t pageWidth = mFormat.getTextureWidth(), pageHeight = mFormat.getTextureHeight();
+
+	size_t bestIndex = skyline.size();
+	int32_t bestBottom = numeric_limits<int32_t>::max(), bestWidth = numeric_limits<int32_t>::max();
+	for( size_t i = 0; i < skyline.size(); ++i ) {
+		const int32_t x = skyline[i].mX;
+		if( x + width > pageWidth )
+			break;
+		// the rectangle rests on the highest segment it spans
+		int32_t y = 0;
+		int32_t widthLeft = width;
+		for( size_t j = i; widthLeft > 0; ++j ) {
+			y = std::max( y, skyline[j].mY );
+			widthLeft -= skyline[j].mWidth;
+		}
+		if( y + height > pageHeight )
+			continue;
+		if( ( y + height < bestBottom ) || ( ( y + height == bestBottom ) && ( skyline[i].mWidth < bestWidth ) ) ) {
+			bestIndex = i;
+			bestBottom = y + height;
+			bestWidth = skyline[i].mWidth;
+			*result = Vec2i( x, y );
+		}
+	}
+
+	if( bestIndex == skyline.size() )
+		return false;
+
+	// insert the new segment and trim the ones it now covers
+	skyline.insert( skyline.begin() + bestIndex, SkylineNode( result->x, bestBottom, width ) );
+	for( size_t i = bestIndex + 1; i < skyline.size(); ) {
+		const int32_t newEdge = skyline[i-1].mX + skyline[i-1].mWidth;
+		if( skyline[i].mX >= newEdge )
+			break;
+		const int32_t shrink = newEdge - skyline[i].mX;
+		skyline[i].mX += shrink;
+		skyline[i].mWidth -= shrink;
+		if( skyline[i].mWidth <= 0 )
+			skyline.erase( skyline.begin() + i );
+		else
+			break;
+	}
+
+	// merge neighboring segments at the same height
+	for( size_t i = 0; i + 1 < skyline.size(); ) {
+		if( skyline[i].mY == skyline[i+1].mY ) {
+			skyline[i].mWidth += skyline[i+1].mWidth;
+			skyline.erase( skyline.begin() + i + 1 );
+		}
+		else
+			++i;
+	}
+
+	page->mUsedPixels += (int64_t)width * height;
+	return true;
+}
+
+TextureAtlas::Region TextureAtlas::add( const Surface8u &surface )
+{
+	if( ! fits( surface.getWidth(), surface.getHeight() ) )
+		throw TextureDataExc( "TextureAtlas::add() surface is larger than a page" );
+
+	const int32_t padding = mFormat.getPadding();
+	const int32_t paddedWidth = surface.getWidth() + 2 * padding, paddedHeight = surface.getHeight() + 2 * padding;
+
+	// first fit across the existing pages, so earlier pages keep filling their gaps
+	size_t pageIndex = 0;
+	Vec2i paddedOrigin;
+	for( ; pageIndex < mPages.size(); ++pageIndex ) {
+		if( pack( &mPages[pageIndex], paddedWidth, paddedHeight, &paddedOrigin ) )
+			break;
+	}
+	if( pageIndex == mPages.size() ) {
+		addPage();
+		pack( &mPages.back(), paddedWidth, paddedHeight, &paddedOrigin );
+	}
+
+	// build the padded image, replicating the edge pixels outward
+	Surface8u padded( paddedWidth, paddedHeight, true, SurfaceChannelOrder::RGBA );
+	if( ! surface.hasAlpha() )
+		ip::fill( &padded, ColorA8u( 0, 0, 0, 255 ) );
+	padded.copyFrom( surface, surface.getBounds(), Vec2i( padding, padding ) );
+	if( padding > 0 ) {
+		const int32_t rowBytes = padded.getRowBytes();
+		uint8_t *data = padded.getData();
+		for( int32_t y = padding; y < paddedHeight - padding; ++y ) {
+			uint32_t *row = reinterpret_cast<uint32_t*>( data + y * rowBytes );
+			for( int32_t x = 0; x < padding; ++x ) {
+				row[x] = row[padding];
+				row[paddedWidth - 1 - x] = row[paddedWidth - 1 - padding];
+			}
+		}
+		for( int32_t y = 0; y < padding; ++y ) {
+			memcpy( data + y * rowBytes, data + padding * rowBytes, paddedWidth * 4 );
+			memcpy( data + ( paddedHeight - 1 - y ) * rowBytes, data + ( paddedHeight - 1 - padding ) * rowBytes, paddedWidth * 4 );
+		}
+	}
+
+	const Texture &texture = mPages[pageIndex].mTexture;
+	SaveTextureBindState saveBindState( texture.getTarget() );
+	StateCache::bindTexture( texture.getTarget(), texture.getId() );
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+#if ! defined( CINDER_GLES )
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, padded.getRowBytes() / 4 );
+#endif
+	glTexSubImage2D( texture.getTarget(), 0, paddedOrigin.x, paddedOrigin.y, paddedWidth, paddedHeight, GL_RGBA, GL_UNSIGNED_BYTE, padded.getData() );
+#if ! defined( CINDER_GLES )
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+#endif
+
+	Vec2i origin = paddedOrigin + Vec2i( padding, padding );
+	return Region( texture, pageIndex, Area( origin, origin + surface.getSize() ) );
+}
+
+float TextureAtlas::getOccupancy() const
+{
+	if( mPages.empty() )
+		return 0;
+
+	int64_t used = 0;
+	for( vector<Page>::const_iterator pageIt = mPages.begin(); pageIt != mPages.end(); ++pageIt )
+		used += pageIt->mUsedPixels;
+	return used / (float)( (int64_t)mFormat.getTextureWidth() * mFormat.getTextureHeight() * mPages.size() );
+}
+
+void TextureAtlas::draw( const vector<Region> &regions, const vector<Rectf> &destRects ) const
+{
+	assert( regions.size() == destRects.size() );
+	if( regions.empty() )
+		return;
+
+	SaveTextureBindState saveBindState( GL_TEXTURE_2D );
+	BoolState saveEnabledState( GL_TEXTURE_2D );
+	ClientBoolState vertexArrayState( GL_VERTEX_ARRAY );
+	ClientBoolState texCoordArrayState( GL_TEXTURE_COORD_ARRAY );
+	gl::enable( GL_TEXTURE_2D );
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+
+	// one pass per distinct Texture, in order of first appearance
+	vector<bool> drawn( regions.size(), false );
+	vector<float> verts, texCoords;
+#if defined( CINDER_GLES )
+	vector<uint16_t> indices;
+	GLenum indexType = GL_UNSIGNED_SHORT;
+#else
+	vector<uint32_t> indices;
+	GLenum indexType = GL_UNSIGNED_INT;
+#endif
+	for( size_t first = 0; first < regions.size(); ++first ) {
+		if( drawn[first] || ( ! regions[first] ) )
+			continue;
+		const Texture &curTex = regions[first].getTexture();
+		verts.clear(); texCoords.clear(); indices.clear();
+		for( size_t r = first; r < regions.size(); ++r ) {
+			if( drawn[r] || ( ! regions[r] ) || ( regions[r].getTexture().getId() != curTex.getId() ) )
+				continue;
+			drawn[r] = true;
+			const Rectf &destRect = destRects[r];
+			const Rectf &srcCoords = regions[r].getTexCoords();
+			const size_t curIdx = verts.size() / 2;
+
+			verts.push_back( destRect.getX2() ); verts.push_back( destRect.getY1() );
+			verts.push_back( destRect.getX1() ); verts.push_back( destRect.getY1() );
+			verts.push_back( destRect.getX2() ); verts.push_back( destRect.getY2() );
+			verts.push_back( destRect.getX1() ); verts.push_back( destRect.getY2() );
+
+			texCoords.push_back( srcCoords.getX2() ); texCoords.push_back( srcCoords.getY1() );
+			texCoords.push_back( srcCoords.getX1() ); texCoords.push_back( srcCoords.getY1() );
+			texCoords.push_back( srcCoords.getX2() ); texCoords.push_back( srcCoords.getY2() );
+			texCoords.push_back( srcCoords.getX1() ); texCoords.push_back( srcCoords.getY2() );
+
+			indices.push_back( curIdx + 0 ); indices.push_back( curIdx + 1 ); indices.push_back( curIdx + 2 );
+			indices.push_back( curIdx + 2 ); indices.push_back( curIdx + 1 ); indices.push_back( curIdx + 3 );
+		}
+
+		curTex.bind();
+		glVertexPointer( 2, GL_FLOAT, 0, &verts[0] );
+		glTexCoordPointer( 2, GL_FLOAT, 0, &texCoords[0] );
+		glDrawElements( GL_TRIANGLES, indices.size(), indexType, &indices[0] );
+	}
+}
+
+void draw( const TextureAtlas::Region &region, const Rectf &destRect )
+{
+	draw( region.getTexture(), region.getArea(), destRect );
+}
+
+void draw( const TextureAtlas::Region &region, const Vec2f &pos )
+{
+	draw( region.getTexture(), region.getArea(), Rectf( pos.x, pos.y, pos.x + region.getWidth(), pos.y + region.getHeight() ) );
+}
+
+} } // namespace cinder::gl
@@ -35,19 +35,61 @@
 	#endif
 #endif
 
+#include "cinder/Buffer.h"
+#include "cinder/Stream.h"
+
 #include <set>
+#include <limits>
+#include <sstream>
+#include <cstdio>
 
 using namespace std;
 
 namespace cinder { namespace gl {
 
-#if defined( CINDER_COCOA )
 TextureFont::TextureFont( const Font &font, const string &supportedChars, const TextureFont::Format &format )
-	: mFont( font ), mFormat( format )
+	: mFont( font ), mFormat( format ), mCurrentDynamicTexture( 0 ), mUseCount( 0 ), mNumEvictions( 0 )
 {
+	// a dynamic TextureFont rasterizes each glyph the first time it's drawn instead
+	if( mFormat.isDynamic() )
+		return;
+
+#if ! defined( CINDER_GLES )
+	if( ! mFormat.getCacheDirectory().empty() ) {
+		string cacheKey = getCacheKey( supportedChars );
+		// FNV-1a, which unlike boost::hash is the same from one run and build to the next
+		uint64_t hash = 14695981039346656037ULL;
+		for( string::const_iterator keyIt = cacheKey.begin(); keyIt != cacheKey.end(); ++keyIt )
+			hash = ( hash ^ (uint8_t)*keyIt ) * 1099511628211ULL;
+		char fileName[64];
+		sprintf( fileName, "TextureFont_%016llx.cache", (unsigned long long)hash );
+		fs::path cachePath = mFormat.getCacheDirectory() / fileName;
+
+		if( loadCache( cachePath, cacheKey ) )
+			return;
+		bakeGlyphs( supportedChars );
+		saveCache( cachePath, cacheKey );
+		return;
+	}
+#endif
+
+	bakeGlyphs( supportedChars );
+}
+
+#if defined( CINDER_COCOA )
+void TextureFont::bakeGlyphs( const string &supportedChars )
+{
+	const Font &font = mFont;
+
 	// get the glyph indices we'll need
 	vector<Font::Glyph>	tempGlyphs = font.getGlyphs( supportedChars );
 	set<Font::Glyph> glyphs( tempGlyphs.begin(), tempGlyphs.end() );
+	// distance fields need room to spread around each glyph, so they're packed one at a time
+	if( mFormat.isSignedDistanceField() ) {
+		for( set<Font::Glyph>::const_iterator glyphIt = glyphs.begin(); glyphIt != glyphs.end(); ++glyphIt )
+			addGlyph( *glyphIt );
+		return;
+	}
 	// determine the max glyph extents
 	Vec2f glyphExtents = Vec2f::zero();
 	for( set<Font::Glyph>::const_iterator glyphIt = glyphs.begin(); glyphIt != glyphs.end(); ++glyphIt ) {
@@ -134,6 +176,45 @@ TextureFont::TextureFont( const Font &font, const string &supportedChars, const
 	::CGContextRelease( cgContext );
 }
 
+bool TextureFont::rasterizeGlyph( Font::Glyph glyph, vector<uint8_t> *lumAlpha, Vec2i *size, Vec2f *originOffset ) const
+{
+	Rectf bb = mFont.getGlyphBoundingBox( glyph );
+	// the same margins the constructor leaves around each glyph of its grid
+	*size = Vec2i( (int32_t)ceil( bb.getWidth() ) + 3, (int32_t)ceil( bb.getHeight() ) + 2 );
+	originOffset->x = floor(bb.x1) - 1;
+	originOffset->y = -(bb.getHeight()-1)-ceil( bb.y1+0.5f );
+
+	Surface surface( size->x, size->y, true );
+	ip::fill( &surface, ColorA8u( 0, 0, 0, 0 ) );
+	::CGContextRef cgContext = cocoa::createCgBitmapContext( surface );
+	::CGContextSetRGBFillColor( cgContext, 1, 1, 1, 1 );
+	::CGContextSetFont( cgContext, mFont.getCgFontRef() );
+	::CGContextSetFontSize( cgContext, mFont.getSize() );
+	::CGContextSetTextMatrix( cgContext, CGAffineTransformIdentity );
+	CGGlyph renderGlyph = glyph;
+	CGPoint renderPosition;
+	renderPosition.x = - floor(bb.x1) + 1;
+	renderPosition.y = surface.getHeight() - ceil( bb.getHeight() ) - ceil(bb.y1+0.5f);
+	::CGContextShowGlyphsAtPositions( cgContext, &renderGlyph, &renderPosition, 1 );
+	::CGContextRelease( cgContext );
+
+	if( ! mFormat.getPremultiply() )
+		ip::unpremultiply( &surface );
+
+	lumAlpha->resize( size->x * size->y * 2 );
+	Surface8u::ConstIter iter( surface, surface.getBounds() );
+	size_t offset = 0;
+	while( iter.line() ) {
+		while( iter.pixel() ) {
+			(*lumAlpha)[offset+0] = iter.r();
+			(*lumAlpha)[offset+1] = iter.a();
+			offset += 2;
+		}
+	}
+
+	return true;
+}
+
 #elif defined( CINDER_MSW )
 
 set<Font::Glyph> getNecessaryGlyphs( const Font &font, const string &supportedChars )
@@ -189,11 +270,19 @@ set<Font::Glyph> getNecessaryGlyphs( const Font &font, const string &supportedCh
 	return result;
 }
 
-TextureFont::TextureFont( const Font &font, const string &utf8Chars, const Format &format )
-	: mFont( font ), mFormat( format )
+void TextureFont::bakeGlyphs( const string &utf8Chars )
 {
+	const Font &font = mFont;
+	const Format &format = mFormat;
+
 	// get the glyph indices we'll need
 	set<Font::Glyph> glyphs = getNecessaryGlyphs( font, utf8Chars );
+	// distance fields need room to spread around each glyph, so they're packed one at a time
+	if( mFormat.isSignedDistanceField() ) {
+		for( set<Font::Glyph>::const_iterator glyphIt = glyphs.begin(); glyphIt != glyphs.end(); ++glyphIt )
+			addGlyph( *glyphIt );
+		return;
+	}
 	// determine the max glyph extents
 	Vec2i glyphExtents = Vec2f::zero();
 	for( set<Font::Glyph>::const_iterator glyphIt = glyphs.begin(); glyphIt != glyphs.end(); ++glyphIt ) {
@@ -282,10 +371,433 @@ TextureFont::TextureFont( const Font &font, const string &utf8Chars, const Forma
 
 	delete [] pBuff;
 }
+
+bool TextureFont::rasterizeGlyph( Font::Glyph glyph, vector<uint8_t> *lumAlpha, Vec2i *size, Vec2f *originOffset ) const
+{
+	::SelectObject( Font::getGlobalDc(), mFont.getHfont() );
+
+	GLYPHMETRICS gm = { 0, };
+	MAT2 identityMatrix = { {0,1},{0,0},{0,0},{0,1} };
+	DWORD dwBuffSize = ::GetGlyphOutline( Font::getGlobalDc(), glyph, GGO_GRAY8_BITMAP | GGO_GLYPH_INDEX, &gm, 0, NULL, &identityMatrix );
+	if( ( dwBuffSize == 0 ) || ( dwBuffSize == GDI_ERROR ) )
+		return false;
+	vector<BYTE> buffer( dwBuffSize );
+	if( ::GetGlyphOutline( Font::getGlobalDc(), glyph, GGO_GRAY8_BITMAP | GGO_GLYPH_INDEX, &gm, dwBuffSize, &buffer[0], &identityMatrix ) == GDI_ERROR )
+		return false;
+
+	// without the whole character set to measure, the ascent stands in for the tallest glyph the constructor aligns to
+	*size = Vec2i( gm.gmBlackBoxX, gm.gmBlackBoxY );
+	*originOffset = Vec2f( gm.gmptGlyphOrigin.x, ceil( mFont.getAscent() ) - gm.gmptGlyphOrigin.y );
+
+	int32_t alignedRowBytes = ( gm.gmBlackBoxX & 3 ) ? ( gm.gmBlackBoxX + 4 - ( gm.gmBlackBoxX & 3 ) ) : gm.gmBlackBoxX;
+	lumAlpha->resize( size->x * size->y * 2 );
+	for( int32_t y = 0; y < size->y; ++y ) {
+		for( int32_t x = 0; x < size->x; ++x ) {
+			// convert 6bit to 8bit gray, which is the coverage; unpremultiplied its luminance is white wherever it's covered
+			uint8_t gray = ((uint32_t)buffer[y * alignedRowBytes + x]) * 255 / 64;
+			uint8_t *dst = &(*lumAlpha)[( y * size->x + x ) * 2];
+			dst[0] = ( mFormat.getPremultiply() || ( gray == 0 ) ) ? gray : 255;
+			dst[1] = gray;
+		}
+	}
+
+	return true;
+}
 #endif
 
+namespace {
+
+void uploadGlyph( const gl::Texture &texture, const Vec2i &position, const Vec2i &size, const uint8_t *lumAlpha )
+{
+	SaveTextureBindState saveBindState( texture.getTarget() );
+	texture.bind();
+	GLint oldAlignment;
+	glGetIntegerv( GL_UNPACK_ALIGNMENT, &oldAlignment );
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+	glTexSubImage2D( texture.getTarget(), 0, position.x, position.y, size.x, size.y, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, lumAlpha );
+	glPixelStorei( GL_UNPACK_ALIGNMENT, oldAlignment );
+}
+
+// The exact 1D squared distance transform of Felzenszwalb and Huttenlocher, applied in place to the \a n values of \a f which are \a stride apart
+void distanceTransform1d( float *f, int32_t n, int32_t stride, vector<float> *d, vector<int32_t> *v, vector<float> *z )
+{
+	const float inf = numeric_limits<float>::max();
+	int32_t k = 0;
+	(*v)[0] = 0;
+	(*z)[0] = -inf;
+	(*z)[1] = inf;
+	for( int32_t q = 1; q < n; ++q ) {
+		float s = ( ( f[q*stride] + q * q ) - ( f[(*v)[k]*stride] + (*v)[k] * (*v)[k] ) ) / ( 2 * q - 2 * (*v)[k] );
+		while( s <= (*z)[k] ) {
+			--k;
+			s = ( ( f[q*stride] + q * q ) - ( f[(*v)[k]*stride] + (*v)[k] * (*v)[k] ) ) / ( 2 * q - 2 * (*v)[k] );
+		}
+		++k;
+		(*v)[k] = q;
+		(*z)[k] = s;
+		(*z)[k+1] = inf;
+	}
+	k = 0;
+	for( int32_t q = 0; q < n; ++q ) {
+		while( (*z)[k+1] < q )
+			++k;
+		(*d)[q] = ( q - (*v)[k] ) * ( q - (*v)[k] ) + f[(*v)[k]*stride];
+	}
+	for( int32_t q = 0; q < n; ++q )
+		f[q*stride] = (*d)[q];
+}
+
+// Replaces \a field, which is 0 at feature pixels and huge elsewhere, with the squared distance of each pixel to the nearest feature
+void distanceTransform2d( vector<float> *field, int32_t width, int32_t height )
+{
+	const int32_t n = std::max( width, height );
+	vector<float> d( n ), z( n + 1 );
+	vector<int32_t> v( n );
+	for( int32_t x = 0; x < width; ++x )
+		distanceTransform1d( &(*field)[x], height, width, &d, &v, &z );
+	for( int32_t y = 0; y < height; ++y )
+		distanceTransform1d( &(*field)[y * width], width, 1, &d, &v, &z );
+}
+
+// Replaces the coverage of \a lumAlpha with a signed distance field which grows it by \a spread on every side. An alpha of one half is the glyph's edge.
+void makeDistanceField( vector<uint8_t> *lumAlpha, Vec2i *size, int32_t spread )
+{
+	const int32_t width = size->x + 2 * spread, height = size->y + 2 * spread;
+	const float far = 1e20f;
+	vector<float> coverage( width * height, 0 ), outside( width * height ), inside( width * height );
+	for( int32_t y = 0; y < size->y; ++y ) {
+		for( int32_t x = 0; x < size->x; ++x )
+			coverage[( y + spread ) * width + x + spread] = (*lumAlpha)[( y * size->x + x ) * 2 + 1] / 255.0f;
+	}
+	for( size_t i = 0; i < coverage.size(); ++i ) {
+		outside[i] = ( coverage[i] >= 0.5f ) ? 0 : far;
+		inside[i] = ( coverage[i] >= 0.5f ) ? far : 0;
+	}
+	distanceTransform2d( &outside, width, height );
+	distanceTransform2d( &inside, width, height );
+
+	lumAlpha->resize( width * height * 2 );
+	for( int32_t i = 0; i < width * height; ++i ) {
+		// distances are between pixel centers, so the edge lies half a pixel from each side of it; partially covered pixels place it within themselves
+		float dist;
+		if( ( coverage[i] > 0 ) && ( coverage[i] < 1 ) )
+			dist = 0.5f - coverage[i];
+		else if( coverage[i] >= 0.5f )
+			dist = 0.5f - math<float>::sqrt( inside[i] );
+		else
+			dist = math<float>::sqrt( outside[i] ) - 0.5f;
+		float value = 0.5f - dist / ( 2 * spread );
+		(*lumAlpha)[i * 2 + 0] = 255;
+		(*lumAlpha)[i * 2 + 1] = (uint8_t)( math<float>::clamp( value, 0, 1 ) * 255 + 0.5f );
+	}
+	*size = Vec2i( width, height );
+}
+
+} // anonymous namespace
+
+size_t TextureFont::allocateGlyph( const Vec2i &size, Vec2i *position ) const
+{
+	const int32_t textureWidth = mFormat.getTextureWidth(), textureHeight = mFormat.getTextureHeight();
+	// a pixel of padding on the right and bottom keeps neighbors from bleeding in when filtering
+	const int32_t width = size.x + 1, height = size.y + 1;
+	if( ( width > textureWidth ) || ( height > textureHeight ) )
+		return NO_TEXTURE;
+
+	// glyphs are packed in shelves, and only the most recently started texture has room left
+	if( ! mDynamicTextures.empty() ) {
+		DynamicTexture &dynTex = mDynamicTextures[mCurrentDynamicTexture];
+		if( dynTex.mShelfX + width > textureWidth ) {
+			dynTex.mShelfX = 0;
+			dynTex.mShelfY += dynTex.mShelfHeight;
+			dynTex.mShelfHeight = 0;
+		}
+		if( dynTex.mShelfY + height <= textureHeight ) {
+			*position = Vec2i( dynTex.mShelfX, dynTex.mShelfY );
+			dynTex.mShelfX += width;
+			dynTex.mShelfHeight = std::max( dynTex.mShelfHeight, height );
+			dynTex.mLastUsed = mUseCount;
+			return mCurrentDynamicTexture;
+		}
+	}
+
+	vector<uint8_t> empty( textureWidth * textureHeight * 2, 0 );
+	if( ( mTextures.size() < mFormat.getMaxTextures() ) || ( ! mFormat.isDynamic() ) ) {
+		gl::Texture::Format textureFormat = gl::Texture::Format();
+		textureFormat.setInternalFormat( GL_LUMINANCE_ALPHA );
+		mTextures.push_back( gl::Texture( &empty[0], GL_LUMINANCE_ALPHA, textureWidth, textureHeight, textureFormat ) );
+		mDynamicTextures.push_back( DynamicTexture() );
+		mCurrentDynamicTexture = mTextures.size() - 1;
+	}
+	else {
+		// evict the least recently drawn texture, forgetting its glyphs and clearing it so stale pixels can't bleed into new neighbors
+		size_t lru = 0;
+		for( size_t t = 1; t < mDynamicTextures.size(); ++t ) {
+			if( mDynamicTextures[t].mLastUsed < mDynamicTextures[lru].mLastUsed )
+				lru = t;
+		}
+		for( boost::unordered_map<Font::Glyph, GlyphInfo>::iterator glyphIt = mGlyphMap.begin(); glyphIt != mGlyphMap.end(); ) {
+			if( glyphIt->second.mTextureIndex == lru )
+				glyphIt = mGlyphMap.erase( glyphIt );
+			else
+				++glyphIt;
+		}
+		uploadGlyph( mTextures[lru], Vec2i::zero(), Vec2i( textureWidth, textureHeight ), &empty[0] );
+		mDynamicTextures[lru] = DynamicTexture();
+		mCurrentDynamicTexture = lru;
+		++mNumEvictions;
+	}
+
+	DynamicTexture &dynTex = mDynamicTextures[mCurrentDynamicTexture];
+	*position = Vec2i::zero();
+	dynTex.mShelfX = width;
+	dynTex.mShelfHeight = height;
+	dynTex.mLastUsed = mUseCount;
+	return mCurrentDynamicTexture;
+}
+
+const TextureFont::GlyphInfo* TextureFont::findGlyph( Font::Glyph glyph ) const
+{
+	boost::unordered_map<Font::Glyph, GlyphInfo>::const_iterator glyphInfoIt = mGlyphMap.find( glyph );
+	if( glyphInfoIt != mGlyphMap.end() )
+		return ( glyphInfoIt->second.mTextureIndex == NO_TEXTURE ) ? 0 : &glyphInfoIt->second;
+	if( ! mFormat.isDynamic() )
+		return 0;
+
+	const GlyphInfo &result = addGlyph( glyph );
+	return ( result.mTextureIndex == NO_TEXTURE ) ? 0 : &result;
+}
+
+TextureFont::GlyphInfo& TextureFont::addGlyph( Font::Glyph glyph ) const
+{
+	GlyphInfo newInfo;
+	newInfo.mTextureIndex = NO_TEXTURE;
+	newInfo.mOriginOffset = Vec2f::zero();
+	newInfo.mTexCoords = Area( 0, 0, 0, 0 );
+	vector<uint8_t> lumAlpha;
+	Vec2i size, position;
+	if( rasterizeGlyph( glyph, &lumAlpha, &size, &newInfo.mOriginOffset ) ) {
+		if( mFormat.isSignedDistanceField() ) {
+			const int32_t spread = mFormat.getDistanceFieldSpread();
+			makeDistanceField( &lumAlpha, &size, spread );
+			newInfo.mOriginOffset -= Vec2f( (float)spread, (float)spread );
+		}
+		size_t textureIndex = allocateGlyph( size, &position );
+		if( textureIndex != NO_TEXTURE ) {
+			uploadGlyph( mTextures[textureIndex], position, size, &lumAlpha[0] );
+			newInfo.mTextureIndex = (uint8_t)textureIndex;
+			newInfo.mTexCoords = Area( position, position + size );
+		}
+	}
+
+	GlyphInfo &result = mGlyphMap[glyph];
+	result = newInfo;
+	return result;
+}
+
+#if ! defined( CINDER_GLES )
+namespace {
+// identifies a TextureFont cache file; bump the version whenever its layout or the rasterization changes
+const uint32_t CACHE_MAGIC = 0x46544943; // "CITF"
+const uint32_t CACHE_VERSION = 1;
+} // anonymous namespace
+
+string TextureFont::getCacheKey( const string &supportedChars ) const
+{
+	stringstream ss;
+#if defined( CINDER_COCOA )
+	ss << "cocoa";
+#else
+	ss << "msw";
+#endif
+	ss << "|" << mFont.getName() << "|" << mFont.getSize() << "|" << mFormat.getTextureWidth() << "x" << mFormat.getTextureHeight()
+		<< "|" << mFormat.getPremultiply() << mFormat.hasMipmapping() << mFormat.isSignedDistanceField() << "|" << mFormat.getDistanceFieldSpread()
+		<< "|" << supportedChars;
+	return ss.str();
+}
+
+bool TextureFont::loadCache( const fs::path &path, const string &cacheKey )
+{
+	if( ! fs::exists( path ) )
+		return false;
+
+	try {
+		IStreamFileRef stream = loadFileStream( path );
+		if( ! stream )
+			return false;
+		uint32_t magic, version;
+		stream->readLittle( &magic );
+		stream->readLittle( &version );
+		if( ( magic != CACHE_MAGIC ) || ( version != CACHE_VERSION ) )
+			return false;
+		string key;
+		stream->read( &key );
+		if( key != cacheKey )
+			return false;
+
+		int32_t width, height;
+		uint32_t numTextures;
+		uint8_t compressed;
+		stream->readLittle( &width );
+		stream->readLittle( &height );
+		stream->readLittle( &numTextures );
+		stream->read( &compressed );
+		const size_t textureBytes = width * height * 2;
+		gl::Texture::Format textureFormat = gl::Texture::Format();
+		textureFormat.enableMipmapping( mFormat.hasMipmapping() && ( ! mFormat.isSignedDistanceField() ) );
+		textureFormat.setInternalFormat( GL_LUMINANCE_ALPHA );
+		vector<gl::Texture> textures;
+		for( uint32_t t = 0; t < numTextures; ++t ) {
+			uint32_t storedBytes;
+			stream->readLittle( &storedBytes );
+			Buffer pixels( storedBytes );
+			stream->readData( pixels.getData(), storedBytes );
+			if( compressed )
+				pixels = decompressBuffer( pixels );
+			if( pixels.getDataSize() != textureBytes )
+				return false;
+			textures.push_back( gl::Texture( reinterpret_cast<const uint8_t*>( pixels.getData() ), GL_LUMINANCE_ALPHA, width, height, textureFormat ) );
+			if( textureFormat.hasMipmapping() )
+				textures.back().setMinFilter( GL_LINEAR_MIPMAP_LINEAR );
+		}
+
+		uint32_t numGlyphs;
+		stream->readLittle( &numGlyphs );
+		boost::unordered_map<Font::Glyph, GlyphInfo> glyphMap;
+		for( uint32_t g = 0; g < numGlyphs; ++g ) {
+			Font::Glyph glyph;
+			GlyphInfo info;
+			stream->readLittle( &glyph );
+			stream->read( &info.mTextureIndex );
+			stream->readLittle( &info.mTexCoords.x1 );
+			stream->readLittle( &info.mTexCoords.y1 );
+			stream->readLittle( &info.mTexCoords.x2 );
+			stream->readLittle( &info.mTexCoords.y2 );
+			stream->readLittle( &info.mOriginOffset.x );
+			stream->readLittle( &info.mOriginOffset.y );
+			if( ( info.mTextureIndex != NO_TEXTURE ) && ( info.mTextureIndex >= textures.size() ) )
+				return false;
+			glyphMap[glyph] = info;
+		}
+
+		mTextures.swap( textures );
+		mGlyphMap.swap( glyphMap );
+		return true;
+	}
+	catch( ... ) { // a truncated or unreadable cache is simply rebuilt
+		return false;
+	}
+}
+
+void TextureFont::saveCache( const fs::path &path, const string &cacheKey ) const
+{
+	try {
+		OStreamFileRef stream = writeFileStream( path, true );
+		if( ! stream )
+			return;
+		stream->writeLittle( CACHE_MAGIC );
+		stream->writeLittle( CACHE_VERSION );
+		stream->write( cacheKey );
+
+		const int32_t width = mFormat.getTextureWidth(), height = mFormat.getTextureHeight();
+		stream->writeLittle( width );
+		stream->writeLittle( height );
+		stream->writeLittle( (uint32_t)mTextures.size() );
+		stream->write( (uint8_t)( mFormat.getCompressCache() ? 1 : 0 ) );
+		Buffer pixels( width * height * 2 );
+		for( vector<gl::Texture>::const_iterator textureIt = mTextures.begin(); textureIt != mTextures.end(); ++textureIt ) {
+			SaveTextureBindState saveBindState( textureIt->getTarget() );
+			textureIt->bind();
+			GLint oldAlignment;
+			glGetIntegerv( GL_PACK_ALIGNMENT, &oldAlignment );
+			glPixelStorei( GL_PACK_ALIGNMENT, 1 );
+			glGetTexImage( textureIt->getTarget(), 0, GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, pixels.getData() );
+			glPixelStorei( GL_PACK_ALIGNMENT, oldAlignment );
+
+			Buffer stored = mFormat.getCompressCache() ? compressBuffer( pixels ) : pixels;
+			stream->writeLittle( (uint32_t)stored.getDataSize() );
+			stream->writeData( stored.getData(), stored.getDataSize() );
+		}
+
+		stream->writeLittle( (uint32_t)mGlyphMap.size() );
+		for( boost::unordered_map<Font::Glyph, GlyphInfo>::const_iterator glyphIt = mGlyphMap.begin(); glyphIt != mGlyphMap.end(); ++glyphIt ) {
+			stream->writeLittle( glyphIt->first );
+			stream->write( glyphIt->second.mTextureIndex );
+			stream->writeLittle( glyphIt->second.mTexCoords.x1 );
+			stream->writeLittle( glyphIt->second.mTexCoords.y1 );
+			stream->writeLittle( glyphIt->second.mTexCoords.x2 );
+			stream->writeLittle( glyphIt->second.mTexCoords.y2 );
+			stream->writeLittle( glyphIt->second.mOriginOffset.x );
+			stream->writeLittle( glyphIt->second.mOriginOffset.y );
+		}
+	}
+	catch( ... ) { // the cache only saves time, so failing to write it is harmless
+	}
+}
+#endif
+
+#if ! defined( CINDER_GLES )
+const GlslProg& TextureFont::getSignedDistanceFieldShader() const
+{
+	if( ! mSdfShader ) {
+		static const char *vertexShader =
+			"void main() {\n"
+			"	gl_FrontColor = gl_Color;\n"
+			"	gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+			"	gl_Position = ftransform();\n"
+			"}\n";
+		// the edge is where the field crosses one half, antialiased across the width of a screen pixel
+		static const char *fragmentShader =
+			"uniform sampler2D uDistanceField;\n"
+			"void main() {\n"
+			"	float dist = texture2D( uDistanceField, gl_TexCoord[0].st ).a;\n"
+			"	float width = fwidth( dist ) * 0.7;\n"
+			"	float coverage = smoothstep( 0.5 - width, 0.5 + width, dist );\n"
+			"#ifdef PREMULTIPLIED\n"
+			"	gl_FragColor = gl_Color * coverage;\n"
+			"#else\n"
+			"	gl_FragColor = vec4( gl_Color.rgb, gl_Color.a * coverage );\n"
+			"#endif\n"
+			"}\n";
+		string fragment = string( mFormat.getPremultiply() ? "#define PREMULTIPLIED\n" : "" ) + fragmentShader;
+		mSdfShader = GlslProg( vertexShader, fragment.c_str() );
+		mSdfShader.bind();
+		mSdfShader.uniform( "uDistanceField", 0 );
+		GlslProg::unbind();
+	}
+
+	return mSdfShader;
+}
+
+bool TextureFont::bindSignedDistanceFieldShader() const
+{
+	if( ! mFormat.isSignedDistanceField() )
+		return false;
+	GLint program;
+	glGetIntegerv( GL_CURRENT_PROGRAM, &program );
+	if( program != 0 )
+		return false;
+
+	getSignedDistanceFieldShader().bind();
+	return true;
+}
+#endif
+
+void TextureFont::prepareGlyphs( const vector<pair<uint16_t,Vec2f> > &glyphMeasures ) const
+{
+	if( ! mFormat.isDynamic() )
+		return;
+
+	++mUseCount;
+	for( vector<pair<uint16_t,Vec2f> >::const_iterator glyphIt = glyphMeasures.begin(); glyphIt != glyphMeasures.end(); ++glyphIt ) {
+		const GlyphInfo *glyphInfo = findGlyph( glyphIt->first );
+		if( glyphInfo )
+			mDynamicTextures[glyphInfo->mTextureIndex].mLastUsed = mUseCount;
+	}
+}
+
 void TextureFont::drawGlyphs( const vector<pair<uint16_t,Vec2f> > &glyphMeasures, const Vec2f &baselineIn, const DrawOptions &options, const std::vector<ColorA8u> &colors )
 {
+	prepareGlyphs( glyphMeasures );
 	if( mTextures.empty() )
 		return;
 
@@ -298,6 +810,9 @@ void TextureFont::drawGlyphs( const vector<pair<uint16_t,Vec2f> > &glyphMeasures
 	ClientBoolState colorArrayState( GL_COLOR_ARRAY );
 	ClientBoolState texCoordArrayState( GL_TEXTURE_COORD_ARRAY );	
 	gl::enable( mTextures[0].getTarget() );
+#if ! defined( CINDER_GLES )
+	const bool unbindShader = bindSignedDistanceFieldShader();
+#endif
 
 	Vec2f baseline = baselineIn;
 
@@ -371,10 +886,15 @@ void TextureFont::drawGlyphs( const vector<pair<uint16_t,Vec2f> > &glyphMeasures
 			glColorPointer( 4, GL_UNSIGNED_BYTE, 0, &vertColors[0] );
 		glDrawElements( GL_TRIANGLES, indices.size(), indexType, &indices[0] );
 	}
+#if ! defined( CINDER_GLES )
+	if( unbindShader )
+		GlslProg::unbind();
+#endif
 }
 
 void TextureFont::drawGlyphs( const std::vector<std::pair<uint16_t,Vec2f> > &glyphMeasures, const Rectf &clip, Vec2f offset, const DrawOptions &options, const std::vector<ColorA8u> &colors )
 {
+	prepareGlyphs( glyphMeasures );
 	if( mTextures.empty() )
 		return;
 
@@ -387,6 +907,9 @@ void TextureFont::drawGlyphs( const std::vector<std::pair<uint16_t,Vec2f> > &gly
 	ClientBoolState colorArrayState( GL_COLOR_ARRAY );
 	ClientBoolState texCoordArrayState( GL_TEXTURE_COORD_ARRAY );	
 	gl::enable( mTextures[0].getTarget() );
+#if ! defined( CINDER_GLES )
+	const bool unbindShader = bindSignedDistanceFieldShader();
+#endif
 	const float scale = options.getScale();
 	glEnableClientState( GL_VERTEX_ARRAY );
 	if ( colors.empty() )
@@ -477,26 +1000,30 @@ void TextureFont::drawGlyphs( const std::vector<std::pair<uint16_t,Vec2f> > &gly
 			glColorPointer( 4, GL_UNSIGNED_BYTE, 0, &vertColors[0] );
 		glDrawElements( GL_TRIANGLES, indices.size(), indexType, &indices[0] );
 	}
+#if ! defined( CINDER_GLES )
+	if( unbindShader )
+		GlslProg::unbind();
+#endif
 }
 
 void TextureFont::drawString( const std::string &str, const Vec2f &baseline, const DrawOptions &options )
 {
 	TextBox tbox = TextBox().font( mFont ).text( str ).size( TextBox::GROW, TextBox::GROW ).ligate( options.getLigate() );
-	vector<pair<uint16_t,Vec2f> > glyphMeasures = tbox.measureGlyphs();
+	const vector<pair<uint16_t,Vec2f> > &glyphMeasures = tbox.getGlyphPlacements();
 	drawGlyphs( glyphMeasures, baseline, options );
 }
 
 void TextureFont::drawString( const std::string &str, const Rectf &fitRect, const Vec2f &offset, const DrawOptions &options )
 {
 	TextBox tbox = TextBox().font( mFont ).text( str ).size( TextBox::GROW, fitRect.getHeight() ).ligate( options.getLigate() );
-	vector<pair<uint16_t,Vec2f> > glyphMeasures = tbox.measureGlyphs();
+	const vector<pair<uint16_t,Vec2f> > &glyphMeasures = tbox.getGlyphPlacements();
 	drawGlyphs( glyphMeasures, fitRect, fitRect.getUpperLeft() + offset, options );	
 }
 
 void TextureFont::drawStringWrapped( const std::string &str, const Rectf &fitRect, const Vec2f &offset, const DrawOptions &options )
 {
 	TextBox tbox = TextBox().font( mFont ).text( str ).size( fitRect.getWidth(), fitRect.getHeight() ).ligate( options.getLigate() );
-	vector<pair<uint16_t,Vec2f> > glyphMeasures = tbox.measureGlyphs();
+	const vector<pair<uint16_t,Vec2f> > &glyphMeasures = tbox.getGlyphPlacements();
 	drawGlyphs( glyphMeasures, fitRect.getUpperLeft() + offset, options );
 }
 
@@ -506,12 +1033,12 @@ Vec2f TextureFont::measureString( const std::string &str, const DrawOptions &opt
 #if defined( CINDER_COCOA )
 	return tbox.measure();
 #else
-	vector<pair<uint16_t,Vec2f> > glyphMeasures = tbox.measureGlyphs();
+	const vector<pair<uint16_t,Vec2f> > &glyphMeasures = tbox.getGlyphPlacements();
 	if( ! glyphMeasures.empty() ) {
 		Vec2f result = glyphMeasures.back().second;
-		boost::unordered_map<Font::Glyph, GlyphInfo>::const_iterator glyphInfoIt = mGlyphMap.find( glyphMeasures.back().first );
-		if( glyphInfoIt != mGlyphMap.end() )
-			result += glyphInfoIt->second.mOriginOffset + glyphInfoIt->second.mTexCoords.getSize();
+		const GlyphInfo *glyphInfo = findGlyph( glyphMeasures.back().first );
+		if( glyphInfo )
+			result += glyphInfo->mOriginOffset + glyphInfo->mTexCoords.getSize();
 		return result;
 	}
 	else {
@@ -0,0 +1,328 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/TextureFontBatch.h"
+#include "cinder/gl/gl.h"
+#include "cinder/Text.h"
+
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+bool TextureFontBatch::String::isLayoutEqual( const String &rhs ) const
+{
+	return ( mText == rhs.mText ) && ( mFit == rhs.mFit ) && ( ( ! mFit ) || ( ( mFitRect.getUpperLeft() == rhs.mFitRect.getUpperLeft() ) && ( mFitRect.getLowerRight() == rhs.mFitRect.getLowerRight() ) ) ) && ( mPosition == rhs.mPosition )
+		&& ( mOptions.getClipHorizontal() == rhs.mOptions.getClipHorizontal() ) && ( mOptions.getClipVertical() == rhs.mOptions.getClipVertical() )
+		&& ( mOptions.getPixelSnap() == rhs.mOptions.getPixelSnap() ) && ( mOptions.getLigate() == rhs.mOptions.getLigate() )
+		&& ( mOptions.getScale() == rhs.mOptions.getScale() );
+}
+
+TextureFontBatch::TextureFontBatch( const TextureFontRef &font )
+	: mFont( font ), mColor( 255, 255, 255, 255 ), mTransform( MatrixAffine2f::identity() ), mNumAdded( 0 ), mNumEvictions( font->getNumEvictions() ), mNumLaidOut( 0 ), mNumDrawCalls( 0 )
+{
+}
+
+void TextureFontBatch::drawString( const std::string &str, const Vec2f &baseline, const TextureFont::DrawOptions &options )
+{
+	String s;
+	s.mText = str;
+	s.mPosition = baseline;
+	s.mOptions = options;
+	add( s );
+}
+
+void TextureFontBatch::drawString( const std::string &str, const Rectf &fitRect, const Vec2f &offset, const TextureFont::DrawOptions &options )
+{
+	String s;
+	s.mText = str;
+	s.mFit = true;
+	s.mFitRect = fitRect;
+	s.mPosition = offset;
+	s.mOptions = options;
+	add( s );
+}
+
+void TextureFontBatch::add( const String &str )
+{
+	if( mNumAdded < mStrings.size() ) {
+		// reuse the layout of the string drawn in this position at the last flush() when it still applies
+		String &kept = mStrings[mNumAdded];
+		if( ! kept.isLayoutEqual( str ) ) {
+			kept.mText = str.mText;
+			kept.mFit = str.mFit;
+			kept.mFitRect = str.mFitRect;
+			kept.mPosition = str.mPosition;
+			kept.mOptions = str.mOptions;
+			kept.mLayoutChanged = true;
+		}
+		if( ( kept.mColor != mColor ) || ( ! ( kept.mTransform == mTransform ) ) ) {
+			kept.mColor = mColor;
+			kept.mTransform = mTransform;
+			kept.mVerticesChanged = true;
+		}
+	}
+	else {
+		mStrings.push_back( str );
+		mStrings.back().mColor = mColor;
+		mStrings.back().mTransform = mTransform;
+	}
+	++mNumAdded;
+}
+
+// Places the glyphs of \a str the way TextureFont::drawGlyphs() does
+void TextureFontBatch::layout( String *str ) const
+{
+	const TextureFont &font = *mFont;
+	const TextureFont::DrawOptions &options = str->mOptions;
+	const float scale = options.getScale();
+
+	TextBox tbox = TextBox().font( font.mFont ).text( str->mText ).ligate( options.getLigate() );
+	if( str->mFit )
+		tbox.size( TextBox::GROW, str->mFitRect.getHeight() );
+	else
+		tbox.size( TextBox::GROW, TextBox::GROW );
+	const vector<pair<uint16_t,Vec2f> > &glyphMeasures = tbox.getGlyphPlacements();
+
+	Vec2f offset = str->mFit ? ( str->mFitRect.getUpperLeft() + str->mPosition ) : str->mPosition;
+	if( options.getPixelSnap() )
+		offset = Vec2f( floor( offset.x ), floor( offset.y ) );
+	if( ! str->mFit )
+		offset.y -= font.mFont.getAscent() * scale;
+
+	str->mPageQuads.assign( font.mTextures.size(), vector<Quad>() );
+	for( vector<pair<uint16_t,Vec2f> >::const_iterator glyphIt = glyphMeasures.begin(); glyphIt != glyphMeasures.end(); ++glyphIt ) {
+		// rasterizes the glyph first if the font is dynamic
+		const TextureFont::GlyphInfo *glyphInfoPtr = font.findGlyph( glyphIt->first );
+		if( ! glyphInfoPtr )
+			continue;
+
+		const TextureFont::GlyphInfo &glyphInfo = *glyphInfoPtr;
+		const gl::Texture &curTex = font.mTextures[glyphInfo.mTextureIndex];
+		Rectf srcTexCoords = curTex.getAreaTexCoords( glyphInfo.mTexCoords );
+		Rectf destRect( glyphInfo.mTexCoords );
+		destRect -= destRect.getUpperLeft();
+		destRect.scale( scale );
+		destRect += glyphIt->second * scale;
+		destRect += Vec2f( floor( glyphInfo.mOriginOffset.x + 0.5f ), floor( glyphInfo.mOriginOffset.y ) ) * scale;
+		destRect += offset;
+		if( options.getPixelSnap() )
+			destRect -= Vec2f( destRect.x1 - floor( destRect.x1 ), destRect.y1 - floor( destRect.y1 ) );
+
+		Quad quad;
+		quad.mDestRect = destRect;
+		quad.mTexCoords = srcTexCoords;
+		if( str->mFit ) {
+			const Rectf &clip = str->mFitRect;
+			Rectf clipped( destRect );
+			if( options.getClipHorizontal() ) {
+				clipped.x1 = std::max( destRect.x1, clip.x1 );
+				clipped.x2 = std::min( destRect.x2, clip.x2 );
+			}
+			if( options.getClipVertical() ) {
+				clipped.y1 = std::max( destRect.y1, clip.y1 );
+				clipped.y2 = std::min( destRect.y2, clip.y2 );
+			}
+
+			if( clipped.x1 >= clipped.x2 || clipped.y1 >= clipped.y2 )
+				continue;
+
+			Vec2f coordScale( 1 / (float)destRect.getWidth() / curTex.getWidth() * glyphInfo.mTexCoords.getWidth(),
+				1 / (float)destRect.getHeight() / curTex.getHeight() * glyphInfo.mTexCoords.getHeight() );
+			quad.mTexCoords.x1 = srcTexCoords.x1 + ( clipped.x1 - destRect.x1 ) * coordScale.x;
+			quad.mTexCoords.x2 = quad.mTexCoords.x1 + ( clipped.x2 - clipped.x1 ) * coordScale.x;
+			quad.mTexCoords.y1 = srcTexCoords.y1 + ( clipped.y1 - destRect.y1 ) * coordScale.y;
+			quad.mTexCoords.y2 = quad.mTexCoords.y1 + ( clipped.y2 - clipped.y1 ) * coordScale.y;
+			quad.mDestRect = clipped;
+		}
+
+		if( glyphInfo.mTextureIndex >= str->mPageQuads.size() ) // a texture the dynamic font has just created
+			str->mPageQuads.resize( glyphInfo.mTextureIndex + 1 );
+		str->mPageQuads[glyphInfo.mTextureIndex].push_back( quad );
+	}
+}
+
+void TextureFontBatch::updateVertices( String *str ) const
+{
+	str->mPageVertices.resize( str->mPageQuads.size() );
+	for( size_t p = 0; p < str->mPageQuads.size(); ++p ) {
+		const vector<Quad> &quads = str->mPageQuads[p];
+		vector<Vertex> &verts = str->mPageVertices[p];
+		verts.resize( quads.size() * 6 );
+		for( size_t q = 0; q < quads.size(); ++q ) {
+			const Rectf &dest = quads[q].mDestRect;
+			const Rectf &tex = quads[q].mTexCoords;
+			// the corners in the order drawGlyphs() indexes them, as two triangles
+			const Vec2f corners[4] = { Vec2f( dest.x2, dest.y1 ), Vec2f( dest.x1, dest.y1 ), Vec2f( dest.x2, dest.y2 ), Vec2f( dest.x1, dest.y2 ) };
+			const Vec2f texCoords[4] = { Vec2f( tex.x2, tex.y1 ), Vec2f( tex.x1, tex.y1 ), Vec2f( tex.x2, tex.y2 ), Vec2f( tex.x1, tex.y2 ) };
+			const int order[6] = { 0, 1, 2, 2, 1, 3 };
+			for( int v = 0; v < 6; ++v ) {
+				Vertex &vert = verts[q * 6 + v];
+				vert.mPosition = str->mTransform.transformPoint( corners[order[v]] );
+				vert.mTexCoord = texCoords[order[v]];
+				vert.mColor = str->mColor;
+			}
+		}
+	}
+}
+
+void TextureFontBatch::flush()
+{
+	mNumDrawCalls = 0;
+	mNumLaidOut = 0;
+	mStrings.resize( mNumAdded );
+	mNumAdded = 0;
+
+	if( mFont->mFormat.isDynamic() ) {
+		// the textures drawn last time are in use, so that laying out new strings evicts others first
+		++mFont->mUseCount;
+		for( size_t p = 0; p < mPages.size(); ++p ) {
+			if( ! mPages[p].mVertices.empty() )
+				mFont->mDynamicTextures[p].mLastUsed = mFont->mUseCount;
+		}
+	}
+
+	// an eviction invalidates the glyphs of every string; when laying out evicts, the strings laid out before it need another pass
+	for( int pass = 0; pass < 2; ++pass ) {
+		const uint32_t numEvictions = mFont->getNumEvictions();
+		if( numEvictions != mNumEvictions ) {
+			for( vector<String>::iterator strIt = mStrings.begin(); strIt != mStrings.end(); ++strIt )
+				strIt->mLayoutChanged = true;
+			mNumEvictions = numEvictions;
+		}
+		for( vector<String>::iterator strIt = mStrings.begin(); strIt != mStrings.end(); ++strIt ) {
+			if( strIt->mLayoutChanged ) {
+				layout( &*strIt );
+				strIt->mLayoutChanged = false;
+				strIt->mVerticesChanged = true;
+				++mNumLaidOut;
+			}
+		}
+		if( mFont->getNumEvictions() == mNumEvictions )
+			break;
+	}
+
+	// a dynamic font may have gained textures since a string was laid out
+	const size_t numPages = mFont->mTextures.size();
+	mPages.resize( numPages );
+	for( vector<String>::iterator strIt = mStrings.begin(); strIt != mStrings.end(); ++strIt ) {
+		strIt->mPageQuads.resize( numPages );
+		if( strIt->mVerticesChanged )
+			updateVertices( &*strIt );
+		strIt->mPageOffsets.resize( numPages, numeric_limits<size_t>::max() );
+	}
+
+	// copy into each page only the strings which changed or moved, and upload only that range
+	for( size_t p = 0; p < numPages; ++p ) {
+		Page &page = mPages[p];
+		size_t offset = 0;
+		size_t dirtyBegin = numeric_limits<size_t>::max(), dirtyEnd = 0;
+		for( vector<String>::iterator strIt = mStrings.begin(); strIt != mStrings.end(); ++strIt ) {
+			const vector<Vertex> &verts = strIt->mPageVertices[p];
+			if( strIt->mVerticesChanged || ( strIt->mPageOffsets[p] != offset ) ) {
+				if( page.mVertices.size() < offset + verts.size() )
+					page.mVertices.resize( offset + verts.size() );
+				if( ! verts.empty() )
+					std::copy( verts.begin(), verts.end(), page.mVertices.begin() + offset );
+				dirtyBegin = std::min( dirtyBegin, offset );
+				dirtyEnd = std::max( dirtyEnd, offset + verts.size() );
+				strIt->mPageOffsets[p] = offset;
+			}
+			offset += verts.size();
+		}
+		page.mVertices.resize( offset );
+
+#if ! defined( CINDER_GLES )
+		if( offset == 0 )
+			continue;
+		if( ! page.mVbo )
+			page.mVbo = Vbo( GL_ARRAY_BUFFER );
+		if( offset > page.mVboSize ) {
+			page.mVbo.bufferData( offset * sizeof(Vertex), &page.mVertices[0], GL_DYNAMIC_DRAW );
+			page.mVboSize = offset;
+		}
+		else if( dirtyBegin < dirtyEnd )
+			page.mVbo.bufferSubData( dirtyBegin * sizeof(Vertex), ( dirtyEnd - dirtyBegin ) * sizeof(Vertex), &page.mVertices[dirtyBegin] );
+#endif
+	}
+
+	for( vector<String>::iterator strIt = mStrings.begin(); strIt != mStrings.end(); ++strIt )
+		strIt->mVerticesChanged = false;
+
+	if( numPages == 0 )
+		return;
+
+	const GLenum target = mFont->mTextures[0].getTarget();
+	SaveTextureBindState saveBindState( target );
+	BoolState saveEnabledState( target );
+	ClientBoolState vertexArrayState( GL_VERTEX_ARRAY );
+	ClientBoolState colorArrayState( GL_COLOR_ARRAY );
+	ClientBoolState texCoordArrayState( GL_TEXTURE_COORD_ARRAY );
+	gl::enable( target );
+	glEnableClientState( GL_VERTEX_ARRAY );
+	glEnableClientState( GL_COLOR_ARRAY );
+	glEnableClientState( GL_TEXTURE_COORD_ARRAY );
+#if ! defined( CINDER_GLES )
+	const bool unbindShader = mFont->bindSignedDistanceFieldShader();
+#endif
+
+	const GLsizei stride = sizeof(Vertex);
+	Vbo *boundVbo = 0;
+	for( size_t p = 0; p < numPages; ++p ) {
+		Page &page = mPages[p];
+		if( page.mVertices.empty() )
+			continue;
+
+		mFont->mTextures[p].bind();
+#if defined( CINDER_GLES )
+		const uint8_t *vertexData = reinterpret_cast<const uint8_t*>( &page.mVertices[0] );
+#else
+		page.mVbo.bind();
+		boundVbo = &page.mVbo;
+		const uint8_t *vertexData = 0;
+#endif
+		glVertexPointer( 2, GL_FLOAT, stride, vertexData );
+		glTexCoordPointer( 2, GL_FLOAT, stride, vertexData + sizeof(Vec2f) );
+		glColorPointer( 4, GL_UNSIGNED_BYTE, stride, vertexData + 2 * sizeof(Vec2f) );
+		glDrawArrays( GL_TRIANGLES, 0, page.mVertices.size() );
+		++mNumDrawCalls;
+	}
+
+	if( boundVbo )
+		boundVbo->unbind();
+#if ! defined( CINDER_GLES )
+	if( unbindShader )
+		GlslProg::unbind();
+#endif
+}
+
+void TextureFontBatch::clear()
+{
+	mStrings.clear();
+	mNumAdded = 0;
+}
+
+} } // namespace cinder::gl
@@ -0,0 +1,126 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/TextureStreamer.h"
+#include "cinder/gl/StateCache.h"
+
+#include <algorithm>
+
+namespace cinder { namespace gl {
+
+TextureStreamer::Obj::Obj( int width, int height, bool alpha, Texture::Format format, int numBuffers )
+	: mNextBuffer( 0 ), mRowBytes( width * 4 ), mAlpha( alpha ), mMapped( false )
+{
+	if( format.getInternalFormat() == -1 )
+		format.setInternalFormat( alpha ? GL_RGBA : GL_RGB );
+	mTexture = Texture( width, height, format );
+
+#if defined( CINDER_MAC )
+	bool supportsPbo = gl::isExtensionAvailable( "GL_ARB_pixel_buffer_object" );
+#elif defined( CINDER_MSW )
+	bool supportsPbo = GLEE_ARB_pixel_buffer_object != 0;
+#else
+	bool supportsPbo = false;
+#endif
+
+#if ! defined( CINDER_GLES )
+	if( supportsPbo ) {
+		for( int b = 0; b < std::max( numBuffers, 1 ); ++b ) {
+			mBuffers.push_back( Vbo( GL_PIXEL_UNPACK_BUFFER_ARB ) );
+			mBuffers.back().bufferData( mRowBytes * height, NULL, GL_STREAM_DRAW_ARB );
+			mBuffers.back().unbind();
+		}
+	}
+#endif
+	if( mBuffers.empty() )
+		mClientSurface = Surface8u( width, height, alpha, alpha ? SurfaceChannelOrder::BGRA : SurfaceChannelOrder::BGRX );
+}
+
+TextureStreamer::TextureStreamer( int width, int height, bool alpha, Texture::Format format, int numBuffers )
+	: mObj( new Obj( width, height, alpha, format, numBuffers ) )
+{
+}
+
+SurfaceChannelOrder TextureStreamer::getChannelOrder() const
+{
+	return mObj->mAlpha ? SurfaceChannelOrder::BGRA : SurfaceChannelOrder::BGRX;
+}
+
+Surface8u TextureStreamer::map()
+{
+	if( mObj->mMapped )
+		throw TextureDataExc( "TextureStreamer::map() called again before upload()" );
+
+	if( mObj->mBuffers.empty() ) {
+		mObj->mMapped = true;
+		return mObj->mClientSurface;
+	}
+
+#if ! defined( CINDER_GLES )
+	Vbo &buffer = mObj->mBuffers[mObj->mNextBuffer];
+	// respecifying the storage orphans the previous contents, so mapping never waits on an upload still in flight
+	buffer.bufferData( mObj->mRowBytes * mObj->mTexture.getHeight(), NULL, GL_STREAM_DRAW_ARB );
+	uint8_t *data = buffer.map( GL_WRITE_ONLY_ARB );
+	buffer.unbind();
+	if( ! data )
+		throw VboFailedMapExc();
+	mObj->mMapped = true;
+	return Surface8u( data, mObj->mTexture.getWidth(), mObj->mTexture.getHeight(), mObj->mRowBytes, getChannelOrder() );
+#else
+	return Surface8u();
+#endif
+}
+
+void TextureStreamer::upload()
+{
+	if( ! mObj->mMapped )
+		return;
+	mObj->mMapped = false;
+
+	if( mObj->mBuffers.empty() ) {
+		mObj->mTexture.update( mObj->mClientSurface );
+		return;
+	}
+
+#if ! defined( CINDER_GLES )
+	Vbo &buffer = mObj->mBuffers[mObj->mNextBuffer];
+	buffer.unmap();
+	// with a pixel unpack buffer bound, the data pointer of glTexSubImage2D is an offset into it and the copy happens asynchronously
+	StateCache::bindTexture( mObj->mTexture.getTarget(), mObj->mTexture.getId() );
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+	glTexSubImage2D( mObj->mTexture.getTarget(), 0, 0, 0, mObj->mTexture.getWidth(), mObj->mTexture.getHeight(), GL_BGRA, GL_UNSIGNED_BYTE, 0 );
+	buffer.unbind();
+
+	mObj->mNextBuffer = ( mObj->mNextBuffer + 1 ) % mObj->mBuffers.size();
+#endif
+}
+
+void TextureStreamer::update( const Surface8u &surface )
+{
+	Surface8u frame = map();
+	frame.copyFrom( surface, surface.getBounds() );
+	upload();
+}
+
+} } // namespace cinder::gl
@@ -45,9 +45,11 @@ TileRender::TileRender( int32_t imageWidth, int32_t imageHeight, int32_t tileWid
 bool TileRender::nextTile()
 {
 	if( mCurrentTile >= mNumTilesX * mNumTilesY ) {
-		// suck the pixels out of the final tile
-		mSurface.copyFrom( app::copyWindowSurface( Area( 0, app::getWindowHeight() - mCurrentArea.getHeight(), mCurrentArea.getWidth(), app::getWindowHeight() ) ), 
-			Area( 0, 0, mCurrentArea.getWidth(), mCurrentArea.getHeight() ), mCurrentArea.getUL() );
+		// suck the pixels out of the final tile, then wait for everything still in flight
+		readCurrentTile();
+		mReadback.flush();
+		mComposer->finish();
+		mComposer.reset();
 		// all done
 		gl::setViewport( mSavedViewport );
 		mCurrentTile = -1;
@@ -57,12 +59,16 @@ bool TileRender::nextTile()
 	if( mCurrentTile == -1 ) { // first tile of this frame
 		mSavedViewport = gl::getViewport();
 		mCurrentTile = 0;
-		mSurface = Surface( mImageWidth, mImageHeight, false );
+		mSurface = ( mTileCallback ) ? Surface() : Surface( mImageWidth, mImageHeight, false );
+		// two buffers let one tile transfer while the next renders
+		if( ! mReadback )
+			mReadback = AsyncReadback( 2 );
+		mComposer = std::shared_ptr<Composer>( new Composer( mSurface, mTileCallback ) );
 	}
 	else {
-		// suck the pixels out of the previous tile
-		mSurface.copyFrom( app::copyWindowSurface( Area( 0, app::getWindowHeight() - mCurrentArea.getHeight(), mCurrentArea.getWidth(), app::getWindowHeight() ) ), 
-			Area( 0, 0, mCurrentArea.getWidth(), mCurrentArea.getHeight() ), mCurrentArea.getUL() );
+		// start pulling the pixels out of the previous tile, and hand off any earlier tile which has arrived
+		readCurrentTile();
+		mReadback.update();
 	}
 	
 	int tileX = mCurrentTile % mNumTilesX;
@@ -81,6 +87,57 @@ bool TileRender::nextTile()
 	return true;
 }
 
+void TileRender::readCurrentTile()
+{
+	mReadback.readWindow( Area( 0, app::getWindowHeight() - mCurrentArea.getHeight(), mCurrentArea.getWidth(), app::getWindowHeight() ),
+		std::bind( &Composer::queue, mComposer, std::_1, mCurrentArea ) );
+}
+
+TileRender::Composer::Composer( const Surface &surface, const TileCallback &callback )
+	: mSurface( surface ), mCallback( callback ), mTiles( 4 )
+{
+	mThread = std::shared_ptr<std::thread>( new std::thread( std::bind( &Composer::run, this ) ) );
+}
+
+TileRender::Composer::~Composer()
+{
+	if( mThread ) {
+		mTiles.cancel();
+		mThread->join();
+	}
+}
+
+void TileRender::Composer::queue( const Surface8u &pixels, const Area &area )
+{
+	Tile tile;
+	tile.mPixels = pixels;
+	tile.mArea = area;
+	mTiles.pushFront( tile );
+}
+
+void TileRender::Composer::finish()
+{
+	// an empty tile tells the worker to stop once it has composed everything ahead of it
+	queue( Surface8u(), Area() );
+	mThread->join();
+	mThread.reset();
+}
+
+void TileRender::Composer::run()
+{
+	ThreadSetup threadSetup;
+	while( true ) {
+		Tile tile;
+		mTiles.popBack( &tile );
+		if( ! tile.mPixels )
+			break;
+		if( mCallback )
+			mCallback( tile.mPixels, tile.mArea );
+		else
+			mSurface.copyFrom( tile.mPixels, tile.mPixels.getBounds(), tile.mArea.getUL() );
+	}
+}
+
 void TileRender::setMatricesWindowPersp( int screenWidth, int screenHeight, float fovDegrees, float nearPlane, float farPlane )
 {
 	CameraPersp cam( screenWidth, screenHeight, fovDegrees, nearPlane, farPlane );
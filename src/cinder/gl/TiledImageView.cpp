@@ -0,0 +1,268 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/gl/TiledImageView.h"
+#include "cinder/gl/StateCache.h"
+#include "cinder/CinderMath.h"
+#include "cinder/ip/Fill.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+TiledImageView::TiledImageView( const TiledImageRef &image, const Format &format )
+	: mImage( image ), mFormat( format ), mLoader( format.getLoader() ), mFrame( 0 )
+{
+	if( ! mLoader )
+		mLoader = app::AsyncImageLoader::getDefault();
+
+	// a pixel of padding around each tile keeps its neighbors on the page from bleeding into it when filtering
+	mSlotStride = mImage->getTileSize() + 2;
+	mFormat.pageSize( std::max( mFormat.getPageSize(), mSlotStride ) );
+	mSlotsPerRow = mFormat.getPageSize() / mSlotStride;
+	const size_t pageBytes = (size_t)mFormat.getPageSize() * mFormat.getPageSize() * 4;
+	mCapacity = std::max<size_t>( mFormat.getCacheBytes() / pageBytes, 1 ) * mSlotsPerRow * mSlotsPerRow;
+}
+
+void TiledImageView::draw( const Area &srcArea, const Rectf &destRect )
+{
+	++mFrame;
+	uploadReady();
+
+	const Area visible = srcArea.getClipBy( Area( Vec2i::zero(), mImage->getSize() ) );
+	if( visible.getWidth() <= 0 || visible.getHeight() <= 0 )
+		return;
+
+	// choose the level whose pixels are closest to the size they are drawn at, favoring detail
+	const float scale = std::max( math<float>::abs( destRect.getWidth() / srcArea.getWidth() ), math<float>::abs( destRect.getHeight() / srcArea.getHeight() ) );
+	const int32_t topLevel = mImage->getNumLevels() - 1;
+	int32_t level = (int32_t)math<float>::floor( math<float>::log( 1 / scale ) / math<float>::log( 2.0f ) + mFormat.getLodBias() );
+	level = constrain( level, 0, topLevel );
+
+	// the single tile of the top level is the fallback of last resort, so it is always kept resident
+	request( topLevel, 0, 0 );
+	map<uint64_t,size_t>::const_iterator topIt = mResident.find( tileKey( topLevel, 0, 0 ) );
+	if( topIt != mResident.end() )
+		touch( topIt->second );
+
+	const int32_t tileSize = mImage->getTileSize();
+	const Area levelVisible = getLevelArea( visible, 0, level );
+	const int32_t col1 = levelVisible.x1 / tileSize, col2 = ( levelVisible.x2 - 1 ) / tileSize;
+	const int32_t row1 = levelVisible.y1 / tileSize, row2 = ( levelVisible.y2 - 1 ) / tileSize;
+	const Vec2f center( ( levelVisible.x1 + levelVisible.x2 ) * 0.5f, ( levelVisible.y1 + levelVisible.y2 ) * 0.5f );
+
+	// stand in for the missing tiles from coarser levels first, so that the coarser pixels never cover finer ones
+	vector<pair<float,pair<int32_t,int32_t> > > missing;
+	for( int32_t row = row1; row <= row2; ++row ) {
+		for( int32_t col = col1; col <= col2; ++col ) {
+			if( mResident.find( tileKey( level, col, row ) ) != mResident.end() )
+				continue;
+			const Area tileArea = mImage->getTileArea( level, col, row );
+			drawFallback( tileArea.getClipBy( levelVisible ), level, srcArea, destRect );
+			const Vec2f tileCenter( ( tileArea.x1 + tileArea.x2 ) * 0.5f, ( tileArea.y1 + tileArea.y2 ) * 0.5f );
+			missing.push_back( make_pair( tileCenter.distanceSquared( center ), make_pair( col, row ) ) );
+		}
+	}
+
+	for( int32_t row = row1; row <= row2; ++row ) {
+		for( int32_t col = col1; col <= col2; ++col ) {
+			map<uint64_t,size_t>::const_iterator residentIt = mResident.find( tileKey( level, col, row ) );
+			if( residentIt == mResident.end() )
+				continue;
+			const Area tileArea = mImage->getTileArea( level, col, row );
+			touch( residentIt->second );
+			drawTile( mSlots[residentIt->second], tileArea, tileArea.getClipBy( levelVisible ), level, srcArea, destRect );
+		}
+	}
+
+	sort( missing.begin(), missing.end() );
+	for( vector<pair<float,pair<int32_t,int32_t> > >::const_iterator missingIt = missing.begin(); missingIt != missing.end(); ++missingIt )
+		request( level, missingIt->second.first, missingIt->second.second );
+}
+
+void TiledImageView::drawFallback( const Area &levelArea, int32_t level, const Area &srcArea, const Rectf &destRect )
+{
+	const int32_t tileSize = mImage->getTileSize();
+	for( int32_t parent = level + 1; parent < mImage->getNumLevels(); ++parent ) {
+		// rounding can spread the area across neighboring tiles of the parent, all of which must be resident
+		const Area parentArea = getLevelArea( levelArea, level, parent );
+		const int32_t col1 = parentArea.x1 / tileSize, col2 = ( parentArea.x2 - 1 ) / tileSize;
+		const int32_t row1 = parentArea.y1 / tileSize, row2 = ( parentArea.y2 - 1 ) / tileSize;
+		bool complete = true;
+		for( int32_t row = row1; row <= row2 && complete; ++row )
+			for( int32_t col = col1; col <= col2 && complete; ++col )
+				complete = mResident.find( tileKey( parent, col, row ) ) != mResident.end();
+		if( ! complete )
+			continue;
+
+		for( int32_t row = row1; row <= row2; ++row ) {
+			for( int32_t col = col1; col <= col2; ++col ) {
+				const size_t slot = mResident[tileKey( parent, col, row )];
+				const Area tileArea = mImage->getTileArea( parent, col, row );
+				touch( slot );
+				drawTile( mSlots[slot], tileArea, tileArea.getClipBy( parentArea ), parent, srcArea, destRect );
+			}
+		}
+		return;
+	}
+}
+
+void TiledImageView::drawTile( const Slot &slot, const Area &tileArea, const Area &levelArea, int32_t level, const Area &srcArea, const Rectf &destRect )
+{
+	if( levelArea.getWidth() <= 0 || levelArea.getHeight() <= 0 )
+		return;
+
+	const Vec2i offset = slot.mArea.getUL() - tileArea.getUL();
+	gl::draw( mPages[slot.mPage], Area( levelArea.getUL() + offset, levelArea.getLR() + offset ), getDestRect( levelArea, level, srcArea, destRect ) );
+}
+
+Area TiledImageView::getLevelArea( const Area &levelArea, int32_t fromLevel, int32_t toLevel ) const
+{
+	// rounds outward, so that the result covers all of levelArea
+	const Vec2i &fromSize = mImage->getLevelSize( fromLevel ), &toSize = mImage->getLevelSize( toLevel );
+	return Area( (int32_t)( (int64_t)levelArea.x1 * toSize.x / fromSize.x ), (int32_t)( (int64_t)levelArea.y1 * toSize.y / fromSize.y ),
+				(int32_t)( ( (int64_t)levelArea.x2 * toSize.x + fromSize.x - 1 ) / fromSize.x ), (int32_t)( ( (int64_t)levelArea.y2 * toSize.y + fromSize.y - 1 ) / fromSize.y ) );
+}
+
+Rectf TiledImageView::getDestRect( const Area &levelArea, int32_t level, const Area &srcArea, const Rectf &destRect ) const
+{
+	const Vec2i &levelSize = mImage->getLevelSize( level );
+	const float toImageX = mImage->getWidth() / (float)levelSize.x, toImageY = mImage->getHeight() / (float)levelSize.y;
+	const float scaleX = destRect.getWidth() / srcArea.getWidth(), scaleY = destRect.getHeight() / srcArea.getHeight();
+	return Rectf( destRect.x1 + ( levelArea.x1 * toImageX - srcArea.x1 ) * scaleX, destRect.y1 + ( levelArea.y1 * toImageY - srcArea.y1 ) * scaleY,
+				destRect.x1 + ( levelArea.x2 * toImageX - srcArea.x1 ) * scaleX, destRect.y1 + ( levelArea.y2 * toImageY - srcArea.y1 ) * scaleY );
+}
+
+void TiledImageView::request( int32_t level, int32_t col, int32_t row )
+{
+	const uint64_t key = tileKey( level, col, row );
+	if( mPending.size() >= mFormat.getMaxPendingLoads() || mResident.count( key ) || mPending.count( key ) || mFailed.count( key ) )
+		return;
+
+	mPending[key] = mLoader->load( mImage->getTilePath( level, col, row ) );
+}
+
+void TiledImageView::uploadReady()
+{
+	size_t uploads = 0;
+	map<uint64_t,app::AsyncSurfaceRef>::iterator pendingIt = mPending.begin();
+	while( pendingIt != mPending.end() && uploads < mFormat.getMaxUploadsPerDraw() ) {
+		if( ! pendingIt->second->isReady() ) {
+			++pendingIt;
+			continue;
+		}
+
+		if( pendingIt->second->hasFailed() )
+			mFailed.insert( pendingIt->first );
+		else {
+			upload( pendingIt->first, pendingIt->second->getSurface() );
+			++uploads;
+		}
+		mPending.erase( pendingIt++ );
+	}
+}
+
+void TiledImageView::upload( uint64_t key, const Surface8u &surface )
+{
+	const int32_t slotIndex = acquireSlot();
+	if( slotIndex < 0 ) // every resident tile is still in view; the tile is requested again once it can be made room for
+		return;
+
+	// build the padded image, replicating the edge pixels outward
+	const int32_t paddedWidth = surface.getWidth() + 2, paddedHeight = surface.getHeight() + 2;
+	Surface8u padded( paddedWidth, paddedHeight, true, SurfaceChannelOrder::RGBA );
+	if( ! surface.hasAlpha() )
+		ip::fill( &padded, ColorA8u( 0, 0, 0, 255 ) );
+	padded.copyFrom( surface, surface.getBounds(), Vec2i( 1, 1 ) );
+	const int32_t rowBytes = padded.getRowBytes();
+	uint8_t *data = padded.getData();
+	for( int32_t y = 1; y < paddedHeight - 1; ++y ) {
+		uint32_t *row = reinterpret_cast<uint32_t*>( data + y * rowBytes );
+		row[0] = row[1];
+		row[paddedWidth - 1] = row[paddedWidth - 2];
+	}
+	memcpy( data, data + rowBytes, paddedWidth * 4 );
+	memcpy( data + ( paddedHeight - 1 ) * rowBytes, data + ( paddedHeight - 2 ) * rowBytes, paddedWidth * 4 );
+
+	Slot &slot = mSlots[slotIndex];
+	const Texture &texture = mPages[slot.mPage];
+	SaveTextureBindState saveBindState( texture.getTarget() );
+	StateCache::bindTexture( texture.getTarget(), texture.getId() );
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+#if ! defined( CINDER_GLES )
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, rowBytes / 4 );
+#endif
+	glTexSubImage2D( texture.getTarget(), 0, slot.mOrigin.x, slot.mOrigin.y, paddedWidth, paddedHeight, GL_RGBA, GL_UNSIGNED_BYTE, data );
+#if ! defined( CINDER_GLES )
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+#endif
+
+	slot.mKey = key;
+	slot.mArea = Area( slot.mOrigin + Vec2i( 1, 1 ), slot.mOrigin + Vec2i( 1, 1 ) + surface.getSize() );
+	mResident[key] = slotIndex;
+	touch( slotIndex );
+}
+
+int32_t TiledImageView::acquireSlot()
+{
+	const size_t slotsPerPage = mSlotsPerRow * mSlotsPerRow;
+	if( mSlots.size() < mCapacity ) {
+		const size_t index = mSlots.size();
+		if( index % slotsPerPage == 0 ) {
+			Texture::Format textureFormat;
+			textureFormat.setInternalFormat( GL_RGBA );
+			textureFormat.setWrap( GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE );
+			mPages.push_back( Texture( mFormat.getPageSize(), mFormat.getPageSize(), textureFormat ) );
+		}
+
+		const int32_t pageSlot = (int32_t)( index % slotsPerPage );
+		Slot slot;
+		slot.mPage = index / slotsPerPage;
+		slot.mOrigin = Vec2i( pageSlot % mSlotsPerRow, pageSlot / mSlotsPerRow ) * mSlotStride;
+		slot.mLastDrawn = 0;
+		mLru.push_back( index );
+		slot.mLruPosition = --mLru.end();
+		mSlots.push_back( slot );
+		return (int32_t)index;
+	}
+
+	// evict the least recently drawn tile, unless it was drawn as recently as the last frame
+	const size_t index = mLru.back();
+	if( mSlots[index].mLastDrawn + 1 >= mFrame )
+		return -1;
+	mResident.erase( mSlots[index].mKey );
+	return (int32_t)index;
+}
+
+void TiledImageView::touch( size_t slot )
+{
+	mSlots[slot].mLastDrawn = mFrame;
+	mLru.splice( mLru.begin(), mLru, mSlots[slot].mLruPosition );
+}
+
+} } // namespace cinder::gl
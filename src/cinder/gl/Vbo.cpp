@@ -21,19 +21,101 @@
 */
 
 #include "cinder/gl/Vbo.h"
+#include "cinder/gl/StateCache.h"
+#include "cinder/gl/GpuMemory.h"
+#include "cinder/ip/Half.h"
+#include "cinder/CinderMath.h"
 #include <sstream>
 
 using namespace std;
 
 namespace cinder { namespace gl {
 
+namespace {
+
+void vertexAttribDivisor( GLuint index, GLuint divisor )
+{
+	// GLee exposes the ARB_instanced_arrays entry point without its suffix
+#if defined( CINDER_MSW )
+	glVertexAttribDivisor( index, divisor );
+#else
+	glVertexAttribDivisorARB( index, divisor );
+#endif
+}
+
+int attributeNumComponents( int attribute )
+{
+	switch( attribute ) {
+		case VboMesh::ATTR_COLORS_RGBA:
+			return 4;
+		case VboMesh::ATTR_TEXCOORDS2D_0: case VboMesh::ATTR_TEXCOORDS2D_1: case VboMesh::ATTR_TEXCOORDS2D_2: case VboMesh::ATTR_TEXCOORDS2D_3:
+			return 2;
+		default:
+			return 3;
+	}
+}
+
+bool isAttributeTypeSupported( int attribute, GLenum type )
+{
+	if( ( type == GL_FLOAT ) || ( type == GL_HALF_FLOAT_ARB ) )
+		return true;
+	else if( type == GL_BYTE ) // normalized by glNormalPointer()
+		return attribute == VboMesh::ATTR_NORMALS;
+	else if( type == GL_UNSIGNED_BYTE ) // normalized by glColorPointer()
+		return ( attribute == VboMesh::ATTR_COLORS_RGB ) || ( attribute == VboMesh::ATTR_COLORS_RGBA );
+	else
+		return false;
+}
+
+// Each element is padded to a multiple of 4 bytes, so that every attribute of an interleaved vertex stays aligned
+size_t attributeSize( GLenum type, int numComponents )
+{
+	size_t componentSize = ( type == GL_HALF_FLOAT_ARB ) ? 2 : ( ( type == GL_BYTE ) || ( type == GL_UNSIGNED_BYTE ) ) ? 1 : 4;
+	return ( componentSize * numComponents + 3 ) & ~3;
+}
+
+GLenum attributeType( const VboMesh::Layout &layout, int buffer, int attribute )
+{
+	return ( buffer == VboMesh::STATIC_BUFFER ) ? layout.getStaticType( attribute ) : GL_FLOAT;
+}
+
+size_t staticAttributeSize( const VboMesh::Layout &layout, int attribute )
+{
+	return attributeSize( layout.getStaticType( attribute ), attributeNumComponents( attribute ) );
+}
+
+// Converts \a numComponents floats to \a type at \a dst, returning the number of bytes written including the padding
+size_t writeAttribute( uint8_t *dst, const float *src, int numComponents, GLenum type )
+{
+	const size_t size = attributeSize( type, numComponents );
+	if( type == GL_FLOAT )
+		memcpy( dst, src, size );
+	else {
+		memset( dst, 0, size );
+		if( type == GL_HALF_FLOAT_ARB )
+			ip::floatToHalf( src, reinterpret_cast<uint16_t*>( dst ), numComponents );
+		else if( type == GL_BYTE ) {
+			for( int c = 0; c < numComponents; ++c )
+				reinterpret_cast<int8_t*>( dst )[c] = static_cast<int8_t>( math<float>::floor( math<float>::clamp( src[c], -1, 1 ) * 127 + 0.5f ) );
+		}
+		else {
+			for( int c = 0; c < numComponents; ++c )
+				dst[c] = static_cast<uint8_t>( math<float>::clamp( src[c], 0, 1 ) * 255 + 0.5f );
+		}
+	}
+
+	return size;
+}
+
+} // anonymous namespace
+
 //enum { CUSTOM_ATTR_FLOAT, CUSTOM_ATTR_FLOAT2, CUSTOM_ATTR_FLOAT3, CUSTOM_ATTR_FLOAT4, TOTAL_CUSTOM_ATTR_TYPES };
 int		VboMesh::Layout::sCustomAttrSizes[TOTAL_CUSTOM_ATTR_TYPES] = { 4, 8, 12, 16 };
 GLint	VboMesh::Layout::sCustomAttrNumComponents[TOTAL_CUSTOM_ATTR_TYPES] = { 1, 2, 3, 4 };
 GLenum	VboMesh::Layout::sCustomAttrTypes[TOTAL_CUSTOM_ATTR_TYPES] = { GL_FLOAT, GL_FLOAT, GL_FLOAT, GL_FLOAT };
 
 Vbo::Obj::Obj( GLenum aTarget )
-	: mTarget( aTarget )
+	: mTarget( aTarget ), mAllocatedBytes( 0 )
 {
 	glGenBuffers( 1, &mId );
 }
@@ -41,6 +123,8 @@ Vbo::Obj::Obj( GLenum aTarget )
 Vbo::Obj::~Obj()
 {
 	glDeleteBuffers( 1, &mId );
+	StateCache::bufferDeleted( mId );
+	GpuMemory::reallocate( GpuMemory::BUFFER, mAllocatedBytes, 0 );
 }
 
 Vbo::Vbo( GLenum aTarget )
@@ -50,18 +134,30 @@ Vbo::Vbo( GLenum aTarget )
 
 void Vbo::bind()
 {
-	glBindBuffer( mObj->mTarget, mObj->mId );
+	StateCache::bindBuffer( mObj->mTarget, mObj->mId );
 }
 
 void Vbo::unbind()
 {
-	glBindBuffer( mObj->mTarget, 0 );
+	StateCache::bindBuffer( mObj->mTarget, 0 );
+}
+
+void Vbo::bindBase( GLuint index )
+{
+	glBindBufferBase( mObj->mTarget, index, mObj->mId );
+}
+
+void Vbo::bindRange( GLuint index, ptrdiff_t offset, size_t size )
+{
+	glBindBufferRange( mObj->mTarget, index, mObj->mId, offset, size );
 }
 
 void Vbo::bufferData( size_t size, const void *data, GLenum usage )
 {
 	bind();
 	glBufferDataARB( mObj->mTarget, size, data, usage );
+	GpuMemory::reallocate( GpuMemory::BUFFER, mObj->mAllocatedBytes, size );
+	mObj->mAllocatedBytes = size;
 }
 
 void Vbo::bufferSubData( ptrdiff_t offset, size_t size, const void *data )
@@ -104,9 +200,17 @@ bool VboMesh::Layout::hasDynamicTexCoords() const
 }
 
 
-VboMesh::VboMesh( const TriMesh &triMesh, Layout layout )
+VboMesh::VboMesh( const TriMesh &sourceMesh, Layout layout )
 	: mObj( shared_ptr<Obj>( new Obj ) )
 {
+	TriMesh optimizedMesh;
+	if( layout.getOptimizeTriMesh() ) {
+		optimizedMesh = sourceMesh;
+		optimizedMesh.optimize();
+	}
+	const TriMesh &triMesh = layout.getOptimizeTriMesh() ? optimizedMesh : sourceMesh;
+
+	mObj->mLayout = layout;
 	if( layout.isDefaults() ) { // we need to start by preparing our layout
 		if( triMesh.hasNormals() )
 			mObj->mLayout.setStaticNormals();
@@ -119,17 +223,17 @@ VboMesh::VboMesh( const TriMesh &triMesh, Layout layout )
 		mObj->mLayout.setStaticIndices();
 		mObj->mLayout.setStaticPositions();
 	}
-	else
-		mObj->mLayout = layout;
 
 	mObj->mPrimitiveType = GL_TRIANGLES;
 	mObj->mNumIndices = triMesh.getNumIndices();
 	mObj->mNumVertices = triMesh.getNumVertices();
+	if( ( layout.getOptimizeTriMesh() || ( layout.getIndexType() == GL_UNSIGNED_SHORT ) ) && ( mObj->mNumVertices <= 65536 ) )
+		mObj->mIndexType = GL_UNSIGNED_SHORT;
 
 	initializeBuffers( false );
 			
 	// upload the indices
-	getIndexVbo().bufferData( sizeof(uint32_t) * triMesh.getNumIndices(), &(triMesh.getIndices()[0]), (mObj->mLayout.hasStaticIndices()) ? GL_STATIC_DRAW : GL_STREAM_DRAW );
+	bufferIndices( triMesh.getIndices() );
 	
 	// upload the verts
 	for( int buffer = STATIC_BUFFER; buffer <= DYNAMIC_BUFFER; ++buffer ) {
@@ -143,28 +247,21 @@ VboMesh::VboMesh( const TriMesh &triMesh, Layout layout )
 		bool copyColorRGB = ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticColorsRGB() : mObj->mLayout.hasDynamicColorsRGB() ) && triMesh.hasColorsRGB();
 		bool copyColorRGBA = ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticColorsRGBA() : mObj->mLayout.hasDynamicColorsRGBA() ) && triMesh.hasColorsRGBA();
 		bool copyTexCoord2D = ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticTexCoords2d() : mObj->mLayout.hasDynamicTexCoords2d() ) && triMesh.hasTexCoords();
+		const GLenum positionType = attributeType( mObj->mLayout, buffer, ATTR_POSITIONS ), normalType = attributeType( mObj->mLayout, buffer, ATTR_NORMALS );
+		const GLenum colorRGBType = attributeType( mObj->mLayout, buffer, ATTR_COLORS_RGB ), colorRGBAType = attributeType( mObj->mLayout, buffer, ATTR_COLORS_RGBA );
+		const GLenum texCoordType = attributeType( mObj->mLayout, buffer, ATTR_TEXCOORDS2D_0 );
 		
 		for( size_t v = 0; v < mObj->mNumVertices; ++v ) {
-			if( copyPosition ) {
-				*(reinterpret_cast<Vec3f*>(ptr)) = triMesh.getVertices()[v];
-				ptr += sizeof( Vec3f );
-			}
-			if( copyNormal ) {
-				*(reinterpret_cast<Vec3f*>(ptr)) = triMesh.getNormals()[v];
-				ptr += sizeof( Vec3f );
-			}
-			if( copyColorRGB ) {
-				*(reinterpret_cast<Color*>(ptr)) = triMesh.getColorsRGB()[v];
-				ptr += sizeof( Color );
-			}
-			if( copyColorRGBA ) {
-				*(reinterpret_cast<ColorA*>(ptr)) = triMesh.getColorsRGBA()[v];
-				ptr += sizeof( Color );
-			}
-			if( copyTexCoord2D ) {
-				*(reinterpret_cast<Vec2f*>(ptr)) = triMesh.getTexCoords()[v];
-				ptr += sizeof( Vec2f );
-			}
+			if( copyPosition )
+				ptr += writeAttribute( ptr, &triMesh.getVertices()[v].x, 3, positionType );
+			if( copyNormal )
+				ptr += writeAttribute( ptr, &triMesh.getNormals()[v].x, 3, normalType );
+			if( copyColorRGB )
+				ptr += writeAttribute( ptr, &triMesh.getColorsRGB()[v].r, 3, colorRGBType );
+			if( copyColorRGBA )
+				ptr += writeAttribute( ptr, &triMesh.getColorsRGBA()[v].r, 4, colorRGBAType );
+			if( copyTexCoord2D )
+				ptr += writeAttribute( ptr, &triMesh.getTexCoords()[v].x, 2, texCoordType );
 		}
 		
 		mObj->mBuffers[buffer].unmap();
@@ -176,6 +273,7 @@ VboMesh::VboMesh( const TriMesh &triMesh, Layout layout )
 VboMesh::VboMesh( const TriMesh2d &triMesh, Layout layout )
 	: mObj( shared_ptr<Obj>( new Obj ) )
 {
+	mObj->mLayout = layout;
 	if( layout.isDefaults() ) { // we need to start by preparing our layout
 		if( triMesh.hasColorsRgb() )
 			mObj->mLayout.setStaticColorsRGB();
@@ -186,17 +284,17 @@ VboMesh::VboMesh( const TriMesh2d &triMesh, Layout layout )
 		mObj->mLayout.setStaticIndices();
 		mObj->mLayout.setStaticPositions();
 	}
-	else
-		mObj->mLayout = layout;
 
 	mObj->mPrimitiveType = GL_TRIANGLES;
 	mObj->mNumIndices = triMesh.getNumIndices();
 	mObj->mNumVertices = triMesh.getNumVertices();
+	if( ( layout.getIndexType() == GL_UNSIGNED_SHORT ) && ( mObj->mNumVertices <= 65536 ) )
+		mObj->mIndexType = GL_UNSIGNED_SHORT;
 
 	initializeBuffers( false );
 			
-	// upload the indices
-	getIndexVbo().bufferData( sizeof(uint32_t) * triMesh.getNumIndices(), &(triMesh.getIndices()[0]), (mObj->mLayout.hasStaticIndices()) ? GL_STATIC_DRAW : GL_STREAM_DRAW );
+	// upload the indices; TriMesh2d stores them as size_t, which is wider than the index buffer's on 64-bit targets
+	bufferIndices( std::vector<uint32_t>( triMesh.getIndices().begin(), triMesh.getIndices().end() ) );
 	
 	// upload the verts
 	for( int buffer = STATIC_BUFFER; buffer <= DYNAMIC_BUFFER; ++buffer ) {
@@ -209,25 +307,22 @@ VboMesh::VboMesh( const TriMesh2d &triMesh, Layout layout )
 		bool copyColorRGB = ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticColorsRGB() : mObj->mLayout.hasDynamicColorsRGB() ) && triMesh.hasColorsRgb();
 		bool copyColorRGBA = ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticColorsRGBA() : mObj->mLayout.hasDynamicColorsRGBA() ) && triMesh.hasColorsRgba();
 		bool copyTexCoord2D = ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticTexCoords2d() : mObj->mLayout.hasDynamicTexCoords2d() ) && triMesh.hasTexCoords();
+		const GLenum positionType = attributeType( mObj->mLayout, buffer, ATTR_POSITIONS );
+		const GLenum colorRGBType = attributeType( mObj->mLayout, buffer, ATTR_COLORS_RGB ), colorRGBAType = attributeType( mObj->mLayout, buffer, ATTR_COLORS_RGBA );
+		const GLenum texCoordType = attributeType( mObj->mLayout, buffer, ATTR_TEXCOORDS2D_0 );
 		
 		for( size_t v = 0; v < mObj->mNumVertices; ++v ) {
 			if( copyPosition ) {
 				const Vec2f &p = triMesh.getVertices()[v];
-				*(reinterpret_cast<Vec3f*>(ptr)) = Vec3f( p.x, p.y, 0 );
-				ptr += sizeof( Vec3f );
-			}
-			if( copyColorRGB ) {
-				*(reinterpret_cast<Color*>(ptr)) = triMesh.getColorsRGB()[v];
-				ptr += sizeof( Color );
-			}
-			if( copyColorRGBA ) {
-				*(reinterpret_cast<ColorA*>(ptr)) = triMesh.getColorsRGBA()[v];
-				ptr += sizeof( Color );
-			}
-			if( copyTexCoord2D ) {
-				*(reinterpret_cast<Vec2f*>(ptr)) = triMesh.getTexCoords()[v];
-				ptr += sizeof( Vec2f );
+				Vec3f position( p.x, p.y, 0 );
+				ptr += writeAttribute( ptr, &position.x, 3, positionType );
 			}
+			if( copyColorRGB )
+				ptr += writeAttribute( ptr, &triMesh.getColorsRGB()[v].r, 3, colorRGBType );
+			if( copyColorRGBA )
+				ptr += writeAttribute( ptr, &triMesh.getColorsRGBA()[v].r, 4, colorRGBAType );
+			if( copyTexCoord2D )
+				ptr += writeAttribute( ptr, &triMesh.getTexCoords()[v].x, 2, texCoordType );
 		}
 		
 		mObj->mBuffers[buffer].unmap();
@@ -243,12 +338,13 @@ VboMesh::VboMesh( size_t numVertices, size_t numIndices, Layout layout, GLenum p
 	mObj->mPrimitiveType = primitiveType;
 	mObj->mNumIndices = numIndices;
 	mObj->mNumVertices = numVertices;
+	mObj->mIndexType = layout.getIndexType();
 
-	initializeBuffers( true );
+	initializeBuffers( ! layout.getInterleavedStatic() );
 	
 	// allocate buffer for indices
 	if( mObj->mLayout.hasIndices() )
-		mObj->mBuffers[INDEX_BUFFER].bufferData( sizeof(uint32_t) * mObj->mNumIndices, NULL, (mObj->mLayout.hasStaticIndices()) ? GL_STATIC_DRAW : GL_STREAM_DRAW );
+		mObj->mBuffers[INDEX_BUFFER].bufferData( getIndexSize() * mObj->mNumIndices, NULL, (mObj->mLayout.hasStaticIndices()) ? GL_STATIC_DRAW : GL_STREAM_DRAW );
 	
 	unbindBuffers();	
 }
@@ -260,6 +356,7 @@ VboMesh::VboMesh( size_t numVertices, size_t numIndices, Layout layout, GLenum p
 	mObj->mPrimitiveType = primitiveType;
 	mObj->mNumIndices = numIndices;
 	mObj->mNumVertices = numVertices;
+	mObj->mIndexType = layout.getIndexType();
 
 	if( indexBuffer ) {
 		mObj->mBuffers[INDEX_BUFFER] = *indexBuffer;
@@ -277,7 +374,7 @@ VboMesh::VboMesh( size_t numVertices, size_t numIndices, Layout layout, GLenum p
 			throw VboInvalidTargetExc();		
 	}
 	
-	initializeBuffers( true );
+	initializeBuffers( ! layout.getInterleavedStatic() );
 	unbindBuffers();
 }
 
@@ -287,6 +384,12 @@ void VboMesh::initializeBuffers( bool staticDataPlanar )
 	bool hasStaticBuffer = mObj->mLayout.hasStaticPositions() || mObj->mLayout.hasStaticNormals() || mObj->mLayout.hasStaticColorsRGB() || mObj->mLayout.hasStaticColorsRGBA() || mObj->mLayout.hasStaticTexCoords() || ( ! mObj->mLayout.mCustomStatic.empty() );
 	bool hasDynamicBuffer = mObj->mLayout.hasDynamicPositions() || mObj->mLayout.hasDynamicNormals() || mObj->mLayout.hasDynamicColorsRGB() || mObj->mLayout.hasDynamicColorsRGBA() || mObj->mLayout.hasDynamicTexCoords() || ( ! mObj->mLayout.mCustomDynamic.empty() );
 
+	if( ( mObj->mIndexType != GL_UNSIGNED_INT ) && ( mObj->mIndexType != GL_UNSIGNED_SHORT ) )
+		throw VboInvalidTypeExc();
+	for( int a = ATTR_POSITIONS; a < ATTR_TOTAL; ++a )
+		if( ( mObj->mLayout.mAttributes[a] == STATIC ) && ( ! isAttributeTypeSupported( a, mObj->mLayout.getStaticType( a ) ) ) )
+			throw VboInvalidTypeExc();
+
 	if( ( mObj->mLayout.hasStaticIndices() || mObj->mLayout.hasDynamicIndices() ) && ( ! mObj->mBuffers[INDEX_BUFFER] ) )
 		mObj->mBuffers[INDEX_BUFFER] = Vbo( GL_ELEMENT_ARRAY_BUFFER );
 
@@ -301,32 +404,32 @@ void VboMesh::initializeBuffers( bool staticDataPlanar )
 
 		if( mObj->mLayout.hasStaticPositions() ) {
 			mObj->mPositionOffset = offset;
-			offset += sizeof(GLfloat) * 3 * mObj->mNumVertices;
+			offset += staticAttributeSize( mObj->mLayout, ATTR_POSITIONS ) * mObj->mNumVertices;
 		}
 		
 		if( mObj->mLayout.hasStaticNormals() ) {
 			mObj->mNormalOffset = offset;
-			offset += sizeof(GLfloat) * 3 * mObj->mNumVertices;
+			offset += staticAttributeSize( mObj->mLayout, ATTR_NORMALS ) * mObj->mNumVertices;
 		}
 
 		if( mObj->mLayout.hasStaticColorsRGB() ) {
 			mObj->mColorRGBOffset = offset;
-			offset += sizeof(GLfloat) * 3 * mObj->mNumVertices;
+			offset += staticAttributeSize( mObj->mLayout, ATTR_COLORS_RGB ) * mObj->mNumVertices;
 		}
 
 		if( mObj->mLayout.hasStaticColorsRGBA() ) {
 			mObj->mColorRGBAOffset = offset;
-			offset += sizeof(GLfloat) * 4 * mObj->mNumVertices;
+			offset += staticAttributeSize( mObj->mLayout, ATTR_COLORS_RGBA ) * mObj->mNumVertices;
 		}
 		
 		for( size_t t = 0; t <= ATTR_MAX_TEXTURE_UNIT; ++t ) {
 			if( mObj->mLayout.hasStaticTexCoords2d( t ) ) {
 				mObj->mTexCoordOffset[t] = offset;
-				offset += sizeof(GLfloat) * 2 * mObj->mNumVertices;
+				offset += staticAttributeSize( mObj->mLayout, ATTR_TEXCOORDS2D_0 + t ) * mObj->mNumVertices;
 			}
 			else if( mObj->mLayout.hasStaticTexCoords3d( t ) ) {
 				mObj->mTexCoordOffset[t] = offset;
-				offset += sizeof(GLfloat) * 3 * mObj->mNumVertices;
+				offset += staticAttributeSize( mObj->mLayout, ATTR_TEXCOORDS3D_0 + t ) * mObj->mNumVertices;
 			}
 		}
 
@@ -349,31 +452,31 @@ void VboMesh::initializeBuffers( bool staticDataPlanar )
 
 		if( mObj->mLayout.hasStaticPositions() ) {
 			mObj->mPositionOffset = offset;
-			offset += sizeof(GLfloat) * 3;
+			offset += staticAttributeSize( mObj->mLayout, ATTR_POSITIONS );
 		}
 		
 		if( mObj->mLayout.hasStaticNormals() ) {
 			mObj->mNormalOffset = offset;
-			offset += sizeof(GLfloat) * 3;
+			offset += staticAttributeSize( mObj->mLayout, ATTR_NORMALS );
 		}
 
 		if( mObj->mLayout.hasStaticColorsRGB() ) {
 			mObj->mColorRGBOffset = offset;
-			offset += sizeof(GLfloat) * 3;
+			offset += staticAttributeSize( mObj->mLayout, ATTR_COLORS_RGB );
 		}
 		else if( mObj->mLayout.hasStaticColorsRGBA() ) {
 			mObj->mColorRGBAOffset = offset;
-			offset += sizeof(GLfloat) * 4;
+			offset += staticAttributeSize( mObj->mLayout, ATTR_COLORS_RGBA );
 		}
 		
 		for( size_t t = 0; t <= ATTR_MAX_TEXTURE_UNIT; ++t ) {
 			if( mObj->mLayout.hasStaticTexCoords2d( t ) ) {
 				mObj->mTexCoordOffset[t] = offset;
-				offset += sizeof(GLfloat) * 2;
+				offset += staticAttributeSize( mObj->mLayout, ATTR_TEXCOORDS2D_0 + t );
 			}
 			else if( mObj->mLayout.hasStaticTexCoords3d( t ) ) {
 				mObj->mTexCoordOffset[t] = offset;
-				offset += sizeof(GLfloat) * 3;
+				offset += staticAttributeSize( mObj->mLayout, ATTR_TEXCOORDS3D_0 + t );
 			}
 		}
 
@@ -441,11 +544,25 @@ void VboMesh::initializeBuffers( bool staticDataPlanar )
 		mObj->mDynamicStride = 0;
 	}
 
+	mObj->mInstanceStride = 0;
+	mObj->mNumInstances = 0;
+	if( mObj->mLayout.hasInstanceAttributes() ) {
+		if( ! mObj->mBuffers[INSTANCE_BUFFER] )
+			mObj->mBuffers[INSTANCE_BUFFER] = Vbo( GL_ARRAY_BUFFER );
+
+		for( size_t c = 0; c < mObj->mLayout.mCustomInstance.size(); ++c ) {
+			mObj->mLayout.mCustomInstance[c].second = mObj->mInstanceStride;
+			mObj->mInstanceStride += VboMesh::Layout::sCustomAttrSizes[mObj->mLayout.mCustomInstance[c].first];
+		}
+	}
+
 	// initialize all the custom attribute locations
 	if( ! mObj->mLayout.mCustomStatic.empty() )
 		mObj->mCustomStaticLocations = vector<GLint>( mObj->mLayout.mCustomStatic.size(), -1 );
 	if( ! mObj->mLayout.mCustomDynamic.empty() )
 		mObj->mCustomDynamicLocations = vector<GLint>( mObj->mLayout.mCustomDynamic.size(), -1 );
+	if( ! mObj->mLayout.mCustomInstance.empty() )
+		mObj->mCustomInstanceLocations = vector<GLint>( mObj->mLayout.mCustomInstance.size(), -1 );
 }
 
 void VboMesh::enableClientStates() const
@@ -481,6 +598,12 @@ void VboMesh::enableClientStates() const
 			throw;
 		glEnableVertexAttribArray( mObj->mCustomDynamicLocations[a] );
 	}
+
+	for( size_t a = 0; a < mObj->mCustomInstanceLocations.size(); ++a ) {
+		if( mObj->mCustomInstanceLocations[a] < 0 )
+			throw VboExc();
+		glEnableVertexAttribArray( mObj->mCustomInstanceLocations[a] );
+	}
 }
 
 void VboMesh::disableClientStates() const
@@ -506,6 +629,14 @@ void VboMesh::disableClientStates() const
 			throw;
 		glDisableVertexAttribArray( mObj->mCustomDynamicLocations[a] );
 	}
+
+	// the divisor is attribute state rather than buffer state, so it has to be reset for whoever uses the location next
+	for( size_t a = 0; a < mObj->mCustomInstanceLocations.size(); ++a ) {
+		if( mObj->mCustomInstanceLocations[a] < 0 )
+			throw VboExc();
+		vertexAttribDivisor( mObj->mCustomInstanceLocations[a], 0 );
+		glDisableVertexAttribArray( mObj->mCustomInstanceLocations[a] );
+	}
 }
 
 void VboMesh::bindAllData() const
@@ -521,27 +652,27 @@ void VboMesh::bindAllData() const
 		uint8_t stride = ( buffer == STATIC_BUFFER ) ? mObj->mStaticStride : mObj->mDynamicStride;
 		
 		if( ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticNormals() : mObj->mLayout.hasDynamicNormals() ) )
-			glNormalPointer( GL_FLOAT, stride, ( const GLvoid *)mObj->mNormalOffset );
+			glNormalPointer( attributeType( mObj->mLayout, buffer, ATTR_NORMALS ), stride, ( const GLvoid *)mObj->mNormalOffset );
 
 		if( ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticColorsRGB() : mObj->mLayout.hasDynamicColorsRGB() ) )
-			glColorPointer( 3, GL_FLOAT, stride, ( const GLvoid *)mObj->mColorRGBOffset );
+			glColorPointer( 3, attributeType( mObj->mLayout, buffer, ATTR_COLORS_RGB ), stride, ( const GLvoid *)mObj->mColorRGBOffset );
 		else if( ( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticColorsRGBA() : mObj->mLayout.hasDynamicColorsRGBA() ) )
-			glColorPointer( 4, GL_FLOAT, stride, ( const GLvoid *)mObj->mColorRGBAOffset );
+			glColorPointer( 4, attributeType( mObj->mLayout, buffer, ATTR_COLORS_RGBA ), stride, ( const GLvoid *)mObj->mColorRGBAOffset );
 
 
 		for( size_t t = 0; t <= ATTR_MAX_TEXTURE_UNIT; ++t ) {
 			if( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticTexCoords2d( t ) : mObj->mLayout.hasDynamicTexCoords2d( t ) ) {
 				glClientActiveTexture( GL_TEXTURE0 + t );
-				glTexCoordPointer( 2, GL_FLOAT, stride, (const GLvoid *)mObj->mTexCoordOffset[t] );
+				glTexCoordPointer( 2, attributeType( mObj->mLayout, buffer, ATTR_TEXCOORDS2D_0 + t ), stride, (const GLvoid *)mObj->mTexCoordOffset[t] );
 			}
 			else if( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticTexCoords3d( t ) : mObj->mLayout.hasDynamicTexCoords3d( t ) ) {
 				glClientActiveTexture( GL_TEXTURE0 + t );
-				glTexCoordPointer( 3, GL_FLOAT, stride, (const GLvoid *)mObj->mTexCoordOffset[t] );
+				glTexCoordPointer( 3, attributeType( mObj->mLayout, buffer, ATTR_TEXCOORDS3D_0 + t ), stride, (const GLvoid *)mObj->mTexCoordOffset[t] );
 			}
 		}	
 
 		if( ( buffer == STATIC_BUFFER ) ? mObj->mLayout.hasStaticPositions() : mObj->mLayout.hasDynamicPositions() )
-			glVertexPointer( 3, GL_FLOAT, stride, (const GLvoid*)mObj->mPositionOffset );
+			glVertexPointer( 3, attributeType( mObj->mLayout, buffer, ATTR_POSITIONS ), stride, (const GLvoid*)mObj->mPositionOffset );
 	}
 
 	for( int buffer = STATIC_BUFFER; buffer <= DYNAMIC_BUFFER; ++buffer ) {
@@ -561,6 +692,16 @@ void VboMesh::bindAllData() const
 			glVertexAttribPointer( locations[a], Layout::sCustomAttrNumComponents[attributes[a].first], Layout::sCustomAttrTypes[attributes[a].first], GL_FALSE, stride, offset );
 		}	
 	}
+
+	if( mObj->mLayout.hasInstanceAttributes() ) {
+		mObj->mBuffers[INSTANCE_BUFFER].bind();
+		const vector<pair<VboMesh::Layout::CustomAttr,size_t> > &attributes( mObj->mLayout.mCustomInstance );
+		for( size_t a = 0; a < attributes.size(); ++a ) {
+			const GLvoid *offset = reinterpret_cast<const GLvoid*>( attributes[a].second );
+			glVertexAttribPointer( mObj->mCustomInstanceLocations[a], Layout::sCustomAttrNumComponents[attributes[a].first], Layout::sCustomAttrTypes[attributes[a].first], GL_FALSE, mObj->mInstanceStride, offset );
+			vertexAttribDivisor( mObj->mCustomInstanceLocations[a], 1 );
+		}
+	}
 }
 
 void VboMesh::bindIndexBuffer() const
@@ -570,13 +711,62 @@ void VboMesh::bindIndexBuffer() const
 
 void VboMesh::unbindBuffers()
 {
-	glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
-	glBindBuffer( GL_ARRAY_BUFFER, 0 );
+	StateCache::bindBuffer( GL_ELEMENT_ARRAY_BUFFER, 0 );
+	StateCache::bindBuffer( GL_ARRAY_BUFFER, 0 );
 }
 
 void VboMesh::bufferIndices( const std::vector<uint32_t> &indices )
 {
-	mObj->mBuffers[INDEX_BUFFER].bufferData( sizeof(uint32_t) * indices.size(), &(indices[0]), (mObj->mLayout.hasStaticIndices()) ? GL_STATIC_DRAW : GL_STREAM_DRAW );
+	if( mObj->mIndexType == GL_UNSIGNED_SHORT ) {
+		vector<uint16_t> shortIndices( indices.begin(), indices.end() );
+		mObj->mBuffers[INDEX_BUFFER].bufferData( sizeof(uint16_t) * shortIndices.size(), &(shortIndices[0]), (mObj->mLayout.hasStaticIndices()) ? GL_STATIC_DRAW : GL_STREAM_DRAW );
+	}
+	else
+		mObj->mBuffers[INDEX_BUFFER].bufferData( sizeof(uint32_t) * indices.size(), &(indices[0]), (mObj->mLayout.hasStaticIndices()) ? GL_STATIC_DRAW : GL_STREAM_DRAW );
+}
+
+void VboMesh::bufferIndices( const std::vector<uint16_t> &indices )
+{
+	if( mObj->mIndexType == GL_UNSIGNED_INT ) {
+		vector<uint32_t> intIndices( indices.begin(), indices.end() );
+		mObj->mBuffers[INDEX_BUFFER].bufferData( sizeof(uint32_t) * intIndices.size(), &(intIndices[0]), (mObj->mLayout.hasStaticIndices()) ? GL_STATIC_DRAW : GL_STREAM_DRAW );
+	}
+	else
+		mObj->mBuffers[INDEX_BUFFER].bufferData( sizeof(uint16_t) * indices.size(), &(indices[0]), (mObj->mLayout.hasStaticIndices()) ? GL_STATIC_DRAW : GL_STREAM_DRAW );
+}
+
+void VboMesh::bufferAttribute( int attribute, size_t offset, const float *data, size_t count )
+{
+	int buffer;
+	if( mObj->mLayout.mAttributes[attribute] == DYNAMIC )
+		buffer = DYNAMIC_BUFFER;
+	else if( mObj->mLayout.mAttributes[attribute] == STATIC )
+		buffer = STATIC_BUFFER;
+	else
+		throw VboExc();
+
+	const int numComponents = attributeNumComponents( attribute );
+	const GLenum type = attributeType( mObj->mLayout, buffer, attribute );
+	const size_t size = attributeSize( type, numComponents );
+	const size_t stride = ( buffer == STATIC_BUFFER ) ? mObj->mStaticStride : mObj->mDynamicStride;
+	Vbo &vbo = mObj->mBuffers[buffer];
+
+	if( ( stride == 0 ) && ( type == GL_FLOAT ) ) // planar data which needs no conversion
+		vbo.bufferSubData( offset, size * count, data );
+	else if( stride == 0 ) { // planar data
+		vector<uint8_t> converted( size * count );
+		for( size_t v = 0; v < count; ++v )
+			writeAttribute( &converted[v * size], &data[v * numComponents], numComponents, type );
+		vbo.bufferSubData( offset, converted.size(), &converted[0] );
+	}
+	else { // interleaved data; a write-only mapping preserves the other attributes between ours
+		uint8_t *ptr = vbo.map( GL_WRITE_ONLY );
+		if( ! ptr )
+			throw VboFailedMapExc();
+		for( size_t v = 0; v < count; ++v )
+			writeAttribute( ptr + offset + v * stride, &data[v * numComponents], numComponents, type );
+		vbo.unmap();
+	}
 }
 
 void VboMesh::bufferPositions( const std::vector<Vec3f> &positions )
@@ -586,120 +776,82 @@ void VboMesh::bufferPositions( const std::vector<Vec3f> &positions )
 
 void VboMesh::bufferPositions( const Vec3f *positions, size_t count )
 {
-	if( mObj->mLayout.hasDynamicPositions() ) {
-		if( mObj->mDynamicStride == 0 )
-			getDynamicVbo().bufferSubData( mObj->mPositionOffset, sizeof(Vec3f) * count, positions );
-		else
-			throw;
-	}
-	else if( mObj->mLayout.hasStaticPositions() ) {
-		if( mObj->mStaticStride == 0 ) { // planar data
-			getStaticVbo().bufferSubData( mObj->mPositionOffset, sizeof(Vec3f) * count, positions );
-		}
-		else
-			throw;
-	}
-	else
-		throw;
+	bufferAttribute( ATTR_POSITIONS, mObj->mPositionOffset, &positions[0].x, count );
 }
 
 void VboMesh::bufferNormals( const std::vector<Vec3f> &normals )
 {
-	if( mObj->mLayout.hasDynamicNormals() ) {
-		if( mObj->mDynamicStride == 0 )
-			getDynamicVbo().bufferSubData( mObj->mNormalOffset, sizeof(Vec3f) * normals.size(), &(normals[0]) );
-		else
-			throw;
-	}
-	else if( mObj->mLayout.hasStaticNormals() ) {
-		if( mObj->mStaticStride == 0 ) { // planar data
-			getStaticVbo().bufferSubData( mObj->mNormalOffset, sizeof(Vec3f) * normals.size(), &(normals[0]) );
-		}
-		else
-			throw;
-	}
-	else
-		throw;
+	bufferAttribute( ATTR_NORMALS, mObj->mNormalOffset, &normals[0].x, normals.size() );
 }
 
 void VboMesh::bufferTexCoords2d( size_t unit, const std::vector<Vec2f> &texCoords )
 {
-	if( mObj->mLayout.hasDynamicTexCoords2d() ) {
-		if( mObj->mDynamicStride == 0 )
-			getDynamicVbo().bufferSubData( mObj->mTexCoordOffset[unit], sizeof(Vec2f) * texCoords.size(), &(texCoords[0]) );
-		else
-			throw;
-	}
-	else if( mObj->mLayout.hasStaticTexCoords2d() ) {
-		if( mObj->mStaticStride == 0 ) { // planar data
-			getStaticVbo().bufferSubData( mObj->mTexCoordOffset[unit], sizeof(Vec2f) * texCoords.size(), &(texCoords[0]) );
-		}
-		else
-			throw;
-	}
-	else
-		throw;
+	bufferAttribute( ATTR_TEXCOORDS2D_0 + unit, mObj->mTexCoordOffset[unit], &texCoords[0].x, texCoords.size() );
 }
 
 void VboMesh::bufferTexCoords3d( size_t unit, const std::vector<Vec3f> &texCoords )
 {
-	if( mObj->mLayout.hasDynamicTexCoords3d() ) {
-		if( mObj->mDynamicStride == 0 )
-			getDynamicVbo().bufferSubData( mObj->mTexCoordOffset[unit], sizeof(Vec3f) * texCoords.size(), &(texCoords[0]) );
-		else
-			throw;
-	}
-	else if( mObj->mLayout.hasStaticTexCoords3d() ) {
-		if( mObj->mStaticStride == 0 ) { // planar data
-			getStaticVbo().bufferSubData( mObj->mTexCoordOffset[unit], sizeof(Vec3f) * texCoords.size(), &(texCoords[0]) );
-		}
-		else
-			throw;
-	}
-	else
-		throw;
+	bufferAttribute( ATTR_TEXCOORDS3D_0 + unit, mObj->mTexCoordOffset[unit], &texCoords[0].x, texCoords.size() );
 }
 	
 void VboMesh::bufferColorsRGB( const std::vector<Color> &colors )
 {
-	if( mObj->mLayout.hasDynamicColorsRGB() ) {
-		if( mObj->mDynamicStride == 0 )
-			getDynamicVbo().bufferSubData( mObj->mColorRGBOffset, sizeof(Color) * colors.size(), &(colors[0]) );
-		else
-			throw;
-	}
-	else if( mObj->mLayout.hasStaticColorsRGB() ) {
-		if( mObj->mStaticStride == 0 ) { // planar data
-			getStaticVbo().bufferSubData( mObj->mColorRGBOffset, sizeof(Color) * colors.size(), &(colors[0]) );
-		}
-		else
-			throw;
-	}
-	else
-		throw;
+	bufferAttribute( ATTR_COLORS_RGB, mObj->mColorRGBOffset, &colors[0].r, colors.size() );
 }
 
 void VboMesh::bufferColorsRGBA( const std::vector<ColorA> &colors )
 {
-	if( mObj->mLayout.hasDynamicColorsRGBA() ) {
-		if( mObj->mDynamicStride == 0 )
-			getDynamicVbo().bufferSubData( mObj->mColorRGBAOffset, sizeof(ColorA) * colors.size(), &(colors[0]) );
-		else
-			throw;
-	}
-	else if( mObj->mLayout.hasStaticColorsRGBA() ) {
-		if( mObj->mStaticStride == 0 ) { // planar data
-			getStaticVbo().bufferSubData( mObj->mColorRGBAOffset, sizeof(ColorA) * colors.size(), &(colors[0]) );
-		}
-		else
-			throw;
+	bufferAttribute( ATTR_COLORS_RGBA, mObj->mColorRGBAOffset, &colors[0].r, colors.size() );
+}
+
+void VboMesh::bufferInstanceData( const void *data, size_t numInstances, GLenum usage )
+{
+	if( ! mObj->mLayout.hasInstanceAttributes() )
+		throw VboExc();
+
+	// respecifying the whole store rather than using bufferSubData() avoids waiting on draws still reading the previous data
+	mObj->mBuffers[INSTANCE_BUFFER].bufferData( mObj->mInstanceStride * numInstances, data, usage );
+	mObj->mBuffers[INSTANCE_BUFFER].unbind();
+	mObj->mNumInstances = numInstances;
+}
+
+bool VboMesh::supportsInstancing()
+{
+#if defined( CINDER_MAC )
+	static bool supported = gl::isExtensionAvailable( "GL_ARB_instanced_arrays" ) && gl::isExtensionAvailable( "GL_ARB_draw_instanced" );
+#elif defined( CINDER_MSW )
+	static bool supported = GLEE_ARB_instanced_arrays && GLEE_ARB_draw_instanced;
+#else
+	static bool supported = false;
+#endif
+	return supported;
+}
+
+void VboMesh::setNumDynamicBuffers( size_t numBuffers )
+{
+	if( ! mObj->mBuffers[DYNAMIC_BUFFER] )
+		throw VboExc();
+
+	mObj->mDynamicBuffers.clear();
+	mObj->mCurrentDynamicBuffer = 0;
+	if( numBuffers <= 1 )
+		return;
+
+	mObj->mDynamicBuffers.push_back( mObj->mBuffers[DYNAMIC_BUFFER] );
+	while( mObj->mDynamicBuffers.size() < numBuffers ) {
+		mObj->mDynamicBuffers.push_back( Vbo( GL_ARRAY_BUFFER ) );
+		mObj->mDynamicBuffers.back().bufferData( mObj->mDynamicStride * mObj->mNumVertices, NULL, GL_STREAM_DRAW );
 	}
-	else
-		throw;
+	mObj->mDynamicBuffers.back().unbind();
 }
 
 VboMesh::VertexIter	VboMesh::mapVertexBuffer()
 {
+	// advance the ring; bindAllData() always draws from whichever buffer was mapped last
+	if( ! mObj->mDynamicBuffers.empty() ) {
+		mObj->mCurrentDynamicBuffer = ( mObj->mCurrentDynamicBuffer + 1 ) % mObj->mDynamicBuffers.size();
+		mObj->mBuffers[DYNAMIC_BUFFER] = mObj->mDynamicBuffers[mObj->mCurrentDynamicBuffer];
+	}
 	return VertexIter( *this );
 }
 
@@ -739,13 +891,27 @@ VboMesh::VertexIter::VertexIter( const VboMesh &mesh )
 VboMesh::VertexIter::Obj::Obj( const VboMesh &mesh )
 	: mVbo( mesh.getDynamicVbo() )
 { 	
-	// Buffer NULL data to tell the driver we don't care about what's in there (See NVIDIA's "Using Vertex Buffer Objects" whitepaper)
+	const size_t size = mesh.mObj->mDynamicStride * mesh.mObj->mNumVertices;
 	mVbo.bind();
-	//mVbo.bufferData( mesh.mObj->mDynamicStride * mesh.mObj->mNumVertices, NULL, GL_STREAM_DRAW );
-	glBufferDataARB( GL_ARRAY_BUFFER, mesh.mObj->mDynamicStride * mesh.mObj->mNumVertices, NULL, GL_STREAM_DRAW );
-	//mData = mVbo.map( GL_WRITE_ONLY );
-	mData = reinterpret_cast<uint8_t*>( glMapBuffer( GL_ARRAY_BUFFER, GL_WRITE_ONLY ) );
-	mDataEnd = mData + mesh.mObj->mDynamicStride * mesh.getNumVertices();
+	if( mesh.mObj->mDynamicBuffers.empty() ) {
+		// Buffer NULL data to tell the driver we don't care about what's in there (See NVIDIA's "Using Vertex Buffer Objects" whitepaper)
+		//mVbo.bufferData( mesh.mObj->mDynamicStride * mesh.mObj->mNumVertices, NULL, GL_STREAM_DRAW );
+		glBufferDataARB( GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW );
+		//mData = mVbo.map( GL_WRITE_ONLY );
+		mData = reinterpret_cast<uint8_t*>( glMapBuffer( GL_ARRAY_BUFFER, GL_WRITE_ONLY ) );
+	}
+	else {
+		// the GPU finished with this buffer of the ring frames ago, so there's nothing to synchronize with
+#if defined( CINDER_MSW )
+		if( GLEE_ARB_map_buffer_range )
+			mData = reinterpret_cast<uint8_t*>( glMapBufferRange( GL_ARRAY_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT ) );
+		else
+#endif
+			mData = reinterpret_cast<uint8_t*>( glMapBuffer( GL_ARRAY_BUFFER, GL_WRITE_ONLY ) );
+	}
+	if( ! mData )
+		throw VboFailedMapExc();
+	mDataEnd = mData + size;
 }
 
 VboMesh::VertexIter::Obj::~Obj()
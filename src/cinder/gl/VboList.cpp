@@ -0,0 +1,449 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/gl/VboList.h"
+#include "cinder/TriMesh.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+using namespace std;
+
+namespace cinder { namespace gl {
+
+namespace detail {
+bool sVboListRecording = false;
+} // namespace detail
+
+namespace {
+
+// What is being recorded between VboList::newList() and VboList::endList(). Only one VboList records at a time, as only one display list could be compiled at a time.
+struct Recording {
+	const void		*mOwner;
+	TriMesh			mMeshes[VboList::TOTAL_PRIMITIVES];
+	bool			mHasNormals, mHasColors, mHasTexCoords;
+
+	// the current values, given to vertices which don't specify their own
+	Vec3f			mNormal;
+	ColorA			mColor;
+	Vec2f			mTexCoord;
+
+	Matrix44f		mStartModelView, mInverseStartModelView;
+
+	// the primitive between gl::begin() and gl::end()
+	bool			mInPrimitive;
+	GLenum			mPrimitiveMode;
+	bool			mPrimitiveTransformed;
+	Matrix44f		mPrimitiveTransform;
+	TriMesh			mPrimitive;
+};
+
+Recording *sRecording = 0;
+
+// Returns false if the MODELVIEW matrix is unchanged since newList(), and otherwise sets \a transform to the change
+bool getTransform( Matrix44f *transform )
+{
+	Matrix44f modelView = gl::getModelView();
+	if( memcmp( modelView.m, sRecording->mStartModelView.m, sizeof(modelView.m) ) == 0 )
+		return false;
+	*transform = sRecording->mInverseStartModelView * modelView;
+	return true;
+}
+
+void transformVertices( TriMesh *vertices, const Matrix44f &transform )
+{
+	Matrix44f normalMatrix = transform.inverted().transposed();
+	for( size_t v = 0; v < vertices->getNumVertices(); ++v ) {
+		vertices->getVertices()[v] = transform.transformPointAffine( vertices->getVertices()[v] );
+		vertices->getNormals()[v] = normalMatrix.transformVec( vertices->getNormals()[v] ).safeNormalized();
+	}
+}
+
+// Appends the vertices of \a staged named by \a order, which are in the order \a mode draws them, to the recorded triangles, lines or points
+void addPrimitive( GLenum mode, const TriMesh &staged, const vector<uint32_t> &order )
+{
+	// positions into order of the vertices of each triangle, line or point
+	vector<uint32_t> refs;
+	size_t n = order.size();
+	int target;
+	switch( mode ) {
+		case GL_POINTS:
+			target = VboList::POINTS;
+			for( size_t i = 0; i < n; ++i )
+				refs.push_back( i );
+		break;
+		case GL_LINES:
+			target = VboList::LINES;
+			for( size_t i = 0; i + 1 < n; i += 2 ) {
+				refs.push_back( i ); refs.push_back( i + 1 );
+			}
+		break;
+		case GL_LINE_STRIP:
+		case GL_LINE_LOOP:
+			target = VboList::LINES;
+			for( size_t i = 0; i + 1 < n; ++i ) {
+				refs.push_back( i ); refs.push_back( i + 1 );
+			}
+			if( ( mode == GL_LINE_LOOP ) && ( n > 2 ) ) {
+				refs.push_back( n - 1 ); refs.push_back( 0 );
+			}
+		break;
+		case GL_TRIANGLES:
+			target = VboList::TRIANGLES;
+			for( size_t i = 0; i + 2 < n; i += 3 ) {
+				refs.push_back( i ); refs.push_back( i + 1 ); refs.push_back( i + 2 );
+			}
+		break;
+		case GL_TRIANGLE_STRIP:
+			target = VboList::TRIANGLES;
+			for( size_t i = 0; i + 2 < n; ++i ) { // every other triangle is flipped to keep the winding consistent
+				refs.push_back( ( i & 1 ) ? i + 1 : i ); refs.push_back( ( i & 1 ) ? i : i + 1 ); refs.push_back( i + 2 );
+			}
+		break;
+		case GL_TRIANGLE_FAN:
+#if ! defined( CINDER_GLES )
+		case GL_POLYGON:
+#endif
+			target = VboList::TRIANGLES;
+			for( size_t i = 1; i + 1 < n; ++i ) {
+				refs.push_back( 0 ); refs.push_back( i ); refs.push_back( i + 1 );
+			}
+		break;
+#if ! defined( CINDER_GLES )
+		case GL_QUADS:
+			target = VboList::TRIANGLES;
+			for( size_t i = 0; i + 3 < n; i += 4 ) {
+				refs.push_back( i ); refs.push_back( i + 1 ); refs.push_back( i + 2 );
+				refs.push_back( i ); refs.push_back( i + 2 ); refs.push_back( i + 3 );
+			}
+		break;
+		case GL_QUAD_STRIP:
+			target = VboList::TRIANGLES;
+			for( size_t i = 0; i + 3 < n; i += 2 ) {
+				refs.push_back( i ); refs.push_back( i + 1 ); refs.push_back( i + 3 );
+				refs.push_back( i ); refs.push_back( i + 3 ); refs.push_back( i + 2 );
+			}
+		break;
+#endif
+		default:
+			return;
+	}
+
+	// copy each staged vertex once, however many primitives share it
+	TriMesh &mesh = sRecording->mMeshes[target];
+	vector<uint32_t> remap( staged.getNumVertices(), numeric_limits<uint32_t>::max() );
+	for( size_t r = 0; r < refs.size(); ++r ) {
+		uint32_t v = order[refs[r]];
+		if( remap[v] == numeric_limits<uint32_t>::max() ) {
+			remap[v] = (uint32_t)mesh.getNumVertices();
+			mesh.appendVertex( staged.getVertices()[v] );
+			mesh.appendNormal( staged.getNormals()[v] );
+			mesh.appendColorRGBA( staged.getColorsRGBA()[v] );
+			mesh.appendTexCoord( staged.getTexCoords()[v] );
+		}
+		mesh.getIndices().push_back( remap[v] );
+	}
+}
+
+// One of the client arrays a gl::draw*() helper has set up, read back through glGet so that the helpers need no changes beyond their draw call
+struct ClientArray {
+	ClientArray( GLenum array, GLenum sizeQuery, GLenum typeQuery, GLenum strideQuery, GLenum pointerQuery )
+		: mData( 0 )
+	{
+		mEnabled = glIsEnabled( array ) != GL_FALSE;
+		if( ! mEnabled )
+			return;
+		mSize = 3;
+		if( sizeQuery )
+			glGetIntegerv( sizeQuery, &mSize );
+		GLint type, stride;
+		glGetIntegerv( typeQuery, &type );
+		glGetIntegerv( strideQuery, &stride );
+		mType = type;
+		GLvoid *data;
+		glGetPointerv( pointerQuery, &data );
+		mData = reinterpret_cast<const uint8_t*>( data );
+
+		switch( mType ) {
+			case GL_UNSIGNED_BYTE: mComponentBytes = 1; break;
+			case GL_SHORT: mComponentBytes = 2; break;
+#if ! defined( CINDER_GLES )
+			case GL_INT: mComponentBytes = 4; break;
+			case GL_DOUBLE: mComponentBytes = 8; break;
+#endif
+			default: mComponentBytes = 4; break;
+		}
+		mStride = ( stride > 0 ) ? stride : mSize * mComponentBytes;
+	}
+
+	bool	isEnabled() const { return mEnabled && mData; }
+
+	// Reads the components of element \a index into \a result, leaving the rest of its 4 values untouched. Unsigned bytes are normalized as colors are.
+	void	read( size_t index, float *result ) const
+	{
+		const uint8_t *element = mData + index * mStride;
+		for( GLint c = 0; c < mSize; ++c ) {
+			switch( mType ) {
+				case GL_UNSIGNED_BYTE: result[c] = element[c] / 255.0f; break;
+				case GL_SHORT: result[c] = reinterpret_cast<const GLshort*>( element )[c]; break;
+#if ! defined( CINDER_GLES )
+				case GL_INT: result[c] = (float)reinterpret_cast<const GLint*>( element )[c]; break;
+				case GL_DOUBLE: result[c] = (float)reinterpret_cast<const GLdouble*>( element )[c]; break;
+#endif
+				default: result[c] = reinterpret_cast<const GLfloat*>( element )[c]; break;
+			}
+		}
+	}
+
+	bool			mEnabled;
+	GLint			mSize, mStride, mComponentBytes;
+	GLenum			mType;
+	const uint8_t	*mData;
+};
+
+// Copies vertices [first, first + count) of the enabled client arrays into the end of \a staged
+void stageClientArrays( size_t first, size_t count, TriMesh *staged )
+{
+	ClientArray positions( GL_VERTEX_ARRAY, GL_VERTEX_ARRAY_SIZE, GL_VERTEX_ARRAY_TYPE, GL_VERTEX_ARRAY_STRIDE, GL_VERTEX_ARRAY_POINTER );
+	ClientArray normals( GL_NORMAL_ARRAY, 0, GL_NORMAL_ARRAY_TYPE, GL_NORMAL_ARRAY_STRIDE, GL_NORMAL_ARRAY_POINTER );
+	ClientArray colors( GL_COLOR_ARRAY, GL_COLOR_ARRAY_SIZE, GL_COLOR_ARRAY_TYPE, GL_COLOR_ARRAY_STRIDE, GL_COLOR_ARRAY_POINTER );
+	ClientArray texCoords( GL_TEXTURE_COORD_ARRAY, GL_TEXTURE_COORD_ARRAY_SIZE, GL_TEXTURE_COORD_ARRAY_TYPE, GL_TEXTURE_COORD_ARRAY_STRIDE, GL_TEXTURE_COORD_ARRAY_POINTER );
+	if( ! positions.isEnabled() )
+		return;
+	sRecording->mHasNormals = sRecording->mHasNormals || normals.isEnabled();
+	sRecording->mHasColors = sRecording->mHasColors || colors.isEnabled();
+	sRecording->mHasTexCoords = sRecording->mHasTexCoords || texCoords.isEnabled();
+
+	for( size_t v = first; v < first + count; ++v ) {
+		float position[4] = { 0, 0, 0, 1 };
+		positions.read( v, position );
+		staged->appendVertex( Vec3f( position[0], position[1], position[2] ) );
+
+		Vec3f normal = sRecording->mNormal;
+		if( normals.isEnabled() )
+			normals.read( v, &normal.x );
+		staged->appendNormal( normal );
+
+		ColorA color = sRecording->mColor;
+		if( colors.isEnabled() ) {
+			color.a = 1;
+			colors.read( v, &color.r );
+		}
+		staged->appendColorRGBA( color );
+
+		float texCoord[4] = { sRecording->mTexCoord.x, sRecording->mTexCoord.y, 0, 1 };
+		if( texCoords.isEnabled() )
+			texCoords.read( v, texCoord );
+		staged->appendTexCoord( Vec2f( texCoord[0], texCoord[1] ) );
+	}
+}
+
+void drawMesh( const VboMesh &mesh, GLenum mode )
+{
+	mesh.enableClientStates();
+	mesh.bindAllData();
+	glDrawElements( mode, mesh.getNumIndices(), mesh.getIndexType(), 0 );
+	VboMesh::unbindBuffers();
+	mesh.disableClientStates();
+}
+
+} // anonymous namespace
+
+namespace detail {
+
+void vboListBegin( GLenum mode )
+{
+	sRecording->mInPrimitive = true;
+	sRecording->mPrimitiveMode = mode;
+	sRecording->mPrimitiveTransformed = getTransform( &sRecording->mPrimitiveTransform );
+	sRecording->mPrimitive.clear();
+}
+
+void vboListEnd()
+{
+	if( ! sRecording->mInPrimitive )
+		return;
+	sRecording->mInPrimitive = false;
+	if( sRecording->mPrimitiveTransformed )
+		transformVertices( &sRecording->mPrimitive, sRecording->mPrimitiveTransform );
+	vector<uint32_t> order( sRecording->mPrimitive.getNumVertices() );
+	for( size_t v = 0; v < order.size(); ++v )
+		order[v] = v;
+	addPrimitive( sRecording->mPrimitiveMode, sRecording->mPrimitive, order );
+}
+
+void vboListVertex( float x, float y, float z )
+{
+	if( ! sRecording->mInPrimitive )
+		return;
+	sRecording->mPrimitive.appendVertex( Vec3f( x, y, z ) );
+	sRecording->mPrimitive.appendNormal( sRecording->mNormal );
+	sRecording->mPrimitive.appendColorRGBA( sRecording->mColor );
+	sRecording->mPrimitive.appendTexCoord( sRecording->mTexCoord );
+}
+
+void vboListTexCoord( float x, float y )
+{
+	sRecording->mTexCoord = Vec2f( x, y );
+	sRecording->mHasTexCoords = true;
+}
+
+void vboListColor( float r, float g, float b, float a )
+{
+	sRecording->mColor = ColorA( r, g, b, a );
+	sRecording->mHasColors = true;
+}
+
+void vboListDrawArrays( GLenum mode, GLint first, GLsizei count )
+{
+	if( count <= 0 )
+		return;
+	TriMesh staged;
+	stageClientArrays( first, count, &staged );
+	Matrix44f transform;
+	if( getTransform( &transform ) )
+		transformVertices( &staged, transform );
+	vector<uint32_t> order( staged.getNumVertices() );
+	for( size_t v = 0; v < order.size(); ++v )
+		order[v] = v;
+	addPrimitive( mode, staged, order );
+}
+
+void vboListDrawElements( GLenum mode, GLsizei count, GLenum type, const GLvoid *indices )
+{
+	if( count <= 0 )
+		return;
+	vector<uint32_t> order( count );
+	for( GLsizei i = 0; i < count; ++i ) {
+		if( type == GL_UNSIGNED_BYTE )
+			order[i] = reinterpret_cast<const GLubyte*>( indices )[i];
+		else if( type == GL_UNSIGNED_SHORT )
+			order[i] = reinterpret_cast<const GLushort*>( indices )[i];
+		else
+			order[i] = reinterpret_cast<const GLuint*>( indices )[i];
+	}
+
+	// only the range of vertices the indices refer to is staged
+	uint32_t minIndex = *min_element( order.begin(), order.end() );
+	uint32_t maxIndex = *max_element( order.begin(), order.end() );
+	for( GLsizei i = 0; i < count; ++i )
+		order[i] -= minIndex;
+	TriMesh staged;
+	stageClientArrays( minIndex, maxIndex - minIndex + 1, &staged );
+	if( staged.getNumVertices() == 0 )
+		return;
+	Matrix44f transform;
+	if( getTransform( &transform ) )
+		transformVertices( &staged, transform );
+	addPrimitive( mode, staged, order );
+}
+
+} // namespace detail
+
+VboList::Obj::~Obj()
+{
+	// a VboList destroyed while recording stops the recording, as only its Obj could end it
+	if( sRecording && ( sRecording->mOwner == this ) ) {
+		delete sRecording;
+		sRecording = 0;
+		detail::sVboListRecording = false;
+	}
+}
+
+void VboList::newList()
+{
+	if( ! mObj )
+		mObj = shared_ptr<Obj>( new Obj );
+	for( int p = 0; p < TOTAL_PRIMITIVES; ++p )
+		mObj->mMeshes[p].reset();
+
+	if( ! sRecording )
+		sRecording = new Recording;
+	sRecording->mOwner = mObj.get();
+	for( int p = 0; p < TOTAL_PRIMITIVES; ++p )
+		sRecording->mMeshes[p].clear();
+	sRecording->mHasNormals = sRecording->mHasColors = sRecording->mHasTexCoords = false;
+	sRecording->mInPrimitive = false;
+
+	GLfloat current[4];
+	glGetFloatv( GL_CURRENT_NORMAL, current );
+	sRecording->mNormal = Vec3f( current[0], current[1], current[2] );
+	glGetFloatv( GL_CURRENT_COLOR, current );
+	sRecording->mColor = ColorA( current[0], current[1], current[2], current[3] );
+	glGetFloatv( GL_CURRENT_TEXTURE_COORDS, current );
+	sRecording->mTexCoord = Vec2f( current[0], current[1] );
+
+	sRecording->mStartModelView = gl::getModelView();
+	sRecording->mInverseStartModelView = sRecording->mStartModelView.inverted();
+	detail::sVboListRecording = true;
+}
+
+void VboList::endList()
+{
+	if( ! isRecording() )
+		return;
+	detail::sVboListRecording = false;
+
+	for( int p = 0; p < TOTAL_PRIMITIVES; ++p ) {
+		TriMesh &mesh = sRecording->mMeshes[p];
+		if( mesh.getNumIndices() == 0 )
+			continue;
+		// attributes which nothing set are left out, so that the current normal, color or texture coordinate applies when drawn
+		if( ! sRecording->mHasNormals )
+			mesh.getNormals().clear();
+		if( ! sRecording->mHasColors )
+			mesh.getColorsRGBA().clear();
+		if( ! sRecording->mHasTexCoords )
+			mesh.getTexCoords().clear();
+		mObj->mMeshes[p] = VboMesh( mesh );
+	}
+
+	delete sRecording;
+	sRecording = 0;
+}
+
+bool VboList::isRecording() const
+{
+	return mObj && sRecording && ( sRecording->mOwner == mObj.get() );
+}
+
+void VboList::draw() const
+{
+	if( mObj->mMaterial )
+		mObj->mMaterial->apply();
+
+	glMatrixMode( GL_MODELVIEW );
+	glPushMatrix();
+		gl::multModelView( mObj->mModelMatrix );
+		if( mObj->mMeshes[TRIANGLES] )
+			drawMesh( mObj->mMeshes[TRIANGLES], GL_TRIANGLES );
+		if( mObj->mMeshes[LINES] )
+			drawMesh( mObj->mMeshes[LINES], GL_LINES );
+		if( mObj->mMeshes[POINTS] )
+			drawMesh( mObj->mMeshes[POINTS], GL_POINTS );
+	glPopMatrix();
+}
+
+} } // namespace cinder::gl
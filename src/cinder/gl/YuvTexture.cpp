@@ -0,0 +1,181 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/gl/YuvTexture.h"
+
+#include <vector>
+
+namespace cinder { namespace gl {
+
+YuvTexture::Obj::Obj( int32_t width, int32_t height, YuvSurface::Layout layout )
+	: mWidth( width ), mHeight( height ), mLayout( layout ), mColorMatrix( YuvSurface::BT601 ), mFullRange( false )
+{
+	Texture::Format format;
+	format.setTarget( GL_TEXTURE_2D );
+	format.setWrap( GL_CLAMP_TO_EDGE, GL_CLAMP_TO_EDGE );
+	format.setInternalFormat( GL_LUMINANCE );
+	mLuma = Texture( 0, GL_LUMINANCE, width, height, format );
+
+	const int32_t chromaWidth = ( width + 1 ) / 2, chromaHeight = ( height + 1 ) / 2;
+	if( layout == YuvSurface::NV12 ) {
+		format.setInternalFormat( GL_LUMINANCE_ALPHA );
+		mChroma[0] = Texture( 0, GL_LUMINANCE_ALPHA, chromaWidth, chromaHeight, format );
+	}
+	else {
+		mChroma[0] = Texture( 0, GL_LUMINANCE, chromaWidth, chromaHeight, format );
+		mChroma[1] = Texture( 0, GL_LUMINANCE, chromaWidth, chromaHeight, format );
+	}
+}
+
+YuvTexture::YuvTexture( int32_t width, int32_t height, YuvSurface::Layout layout )
+	: mObj( new Obj( width, height, layout ) )
+{
+}
+
+YuvTexture::YuvTexture( const YuvSurface &yuvSurface )
+	: mObj( new Obj( yuvSurface.getWidth(), yuvSurface.getHeight(), yuvSurface.getLayout() ) )
+{
+	update( yuvSurface );
+}
+
+void YuvTexture::update( const YuvSurface &yuvSurface )
+{
+	if( ( yuvSurface.getWidth() != getWidth() ) || ( yuvSurface.getHeight() != getHeight() ) || ( yuvSurface.getLayout() != getLayout() ) )
+		throw TextureDataExc( "Invalid YuvTexture::update() YuvSurface dimensions or layout" );
+
+	uploadPlane( mObj->mLuma, yuvSurface.getY(), GL_LUMINANCE );
+	if( getLayout() == YuvSurface::NV12 ) {
+		// the interleaved Cb and Cr pairs are uploaded as two-component texels, starting from Cb
+		const Channel8u &cb = yuvSurface.getCb();
+		uploadPlane( mObj->mChroma[0], Channel8u( cb.getWidth(), cb.getHeight(), cb.getRowBytes(), 1, const_cast<uint8_t*>( cb.getData() ) ), GL_LUMINANCE_ALPHA );
+	}
+	else {
+		uploadPlane( mObj->mChroma[0], yuvSurface.getCb(), GL_LUMINANCE );
+		uploadPlane( mObj->mChroma[1], yuvSurface.getCr(), GL_LUMINANCE );
+	}
+
+	mObj->mColorMatrix = yuvSurface.getColorMatrix();
+	mObj->mFullRange = yuvSurface.isFullRange();
+}
+
+// Uploads \a plane, whose texels are \a dataFormat, into \a texture. The plane's increment is ignored; for GL_LUMINANCE_ALPHA each texel is two bytes.
+void YuvTexture::uploadPlane( const Texture &texture, const Channel8u &plane, GLenum dataFormat )
+{
+	const int32_t texelBytes = ( dataFormat == GL_LUMINANCE_ALPHA ) ? 2 : 1;
+	texture.bind();
+	glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+#if ! defined( CINDER_GLES )
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, plane.getRowBytes() / texelBytes );
+	glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0, plane.getWidth(), plane.getHeight(), dataFormat, GL_UNSIGNED_BYTE, plane.getData() );
+	glPixelStorei( GL_UNPACK_ROW_LENGTH, 0 );
+#else
+	// without GL_UNPACK_ROW_LENGTH padded rows have to go up one at a time
+	if( plane.getRowBytes() == plane.getWidth() * texelBytes )
+		glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0, plane.getWidth(), plane.getHeight(), dataFormat, GL_UNSIGNED_BYTE, plane.getData() );
+	else {
+		for( int32_t y = 0; y < plane.getHeight(); ++y )
+			glTexSubImage2D( GL_TEXTURE_2D, 0, 0, y, plane.getWidth(), 1, dataFormat, GL_UNSIGNED_BYTE, plane.getData( 0, y ) );
+	}
+#endif
+}
+
+#if ! defined( CINDER_GLES )
+const GlslProg& YuvTexture::getShader() const
+{
+	if( ! mObj->mShader ) {
+		static const char *vertexShader =
+			"void main() {\n"
+			"	gl_FrontColor = gl_Color;\n"
+			"	gl_TexCoord[0] = gl_MultiTexCoord0;\n"
+			"	gl_Position = ftransform();\n"
+			"}\n";
+		// the chroma textures are half resolution, so the same coordinates address all of the planes
+		static const char *fragmentShader =
+			"uniform sampler2D uY, uCb, uCr;\n"
+			"uniform mat3 uYuvToRgb;\n"
+			"uniform vec3 uOffset;\n"
+			"void main() {\n"
+			"	vec2 st = gl_TexCoord[0].st;\n"
+			"	float y = texture2D( uY, st ).r;\n"
+			"#ifdef NV12\n"
+			"	vec2 cbCr = texture2D( uCb, st ).ra;\n"
+			"#else\n"
+			"	vec2 cbCr = vec2( texture2D( uCb, st ).r, texture2D( uCr, st ).r );\n"
+			"#endif\n"
+			"	gl_FragColor = gl_Color * vec4( clamp( uYuvToRgb * vec3( y, cbCr ) + uOffset, 0.0, 1.0 ), 1.0 );\n"
+			"}\n";
+		std::string fragment = std::string( ( getLayout() == YuvSurface::NV12 ) ? "#define NV12\n" : "" ) + fragmentShader;
+		mObj->mShader = GlslProg( vertexShader, fragment.c_str() );
+	}
+
+	return mObj->mShader;
+}
+
+void YuvTexture::bind( GLuint firstTextureUnit ) const
+{
+	Matrix33f yuvToRgb;
+	Vec3f offset;
+	YuvSurface::getRgbConversion( mObj->mColorMatrix, mObj->mFullRange, &yuvToRgb, &offset );
+
+	const GlslProg &shader = getShader();
+	shader.bind();
+	// GlslProg::bind() is const but uniform() isn't
+	GlslProg &mutableShader = mObj->mShader;
+	mutableShader.uniform( "uY", (int)firstTextureUnit );
+	mutableShader.uniform( "uCb", (int)firstTextureUnit + 1 );
+	if( getLayout() == YuvSurface::I420 )
+		mutableShader.uniform( "uCr", (int)firstTextureUnit + 2 );
+	mutableShader.uniform( "uYuvToRgb", yuvToRgb );
+	mutableShader.uniform( "uOffset", offset );
+
+	mObj->mLuma.bind( firstTextureUnit );
+	mObj->mChroma[0].bind( firstTextureUnit + 1 );
+	if( getLayout() == YuvSurface::I420 )
+		mObj->mChroma[1].bind( firstTextureUnit + 2 );
+}
+
+void YuvTexture::unbind( GLuint firstTextureUnit ) const
+{
+	if( getLayout() == YuvSurface::I420 )
+		mObj->mChroma[1].unbind( firstTextureUnit + 2 );
+	mObj->mChroma[0].unbind( firstTextureUnit + 1 );
+	mObj->mLuma.unbind( firstTextureUnit );
+	GlslProg::unbind();
+}
+
+void draw( const YuvTexture &texture, const Rectf &rect )
+{
+	texture.bind();
+	drawSolidRect( rect );
+	texture.unbind();
+}
+
+void draw( const YuvTexture &texture, const Vec2f &pos )
+{
+	draw( texture, Rectf( texture.getBounds() ) + pos );
+}
+#endif
+
+} } // namespace cinder::gl
@@ -25,6 +25,7 @@
 
 #include "cinder/gl/gl.h"
 #include "cinder/gl/Vbo.h"
+#include "cinder/gl/StateCache.h"
 #include "cinder/CinderMath.h"
 #include "cinder/Vector.h"
 #include "cinder/Camera.h"
@@ -219,7 +220,7 @@ void clear( const ColorA &color, bool clearDepthBuffer )
 {
 	glClearColor( color.r, color.g, color.b, color.a );
 	if( clearDepthBuffer ) {
-		glDepthMask( GL_TRUE );
+		StateCache::depthMask( GL_TRUE );
 		glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 	}
 	else
@@ -421,22 +422,22 @@ void rotate( const Quatf &quat )
 
 void enableAlphaBlending( bool premultiplied )
 {
-	glEnable( GL_BLEND );
+	StateCache::enable( GL_BLEND );
 	if( ! premultiplied )
-		glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+		StateCache::blendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
 	else
-		glBlendFunc( GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
+		StateCache::blendFunc( GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
 }
 
 void disableAlphaBlending()
 {
-	glDisable( GL_BLEND );
+	StateCache::disable( GL_BLEND );
 }
 
 void enableAdditiveBlending()
 {
-	glEnable( GL_BLEND );
-	glBlendFunc( GL_SRC_ALPHA, GL_ONE );	
+	StateCache::enable( GL_BLEND );
+	StateCache::blendFunc( GL_SRC_ALPHA, GL_ONE );	
 }
 
 void enableAlphaTest( float value, int func )
@@ -464,27 +465,43 @@ void disableWireframe()
 
 void disableDepthRead()
 {
-	glDisable( GL_DEPTH_TEST );
+	StateCache::disable( GL_DEPTH_TEST );
 }
 
 void enableDepthRead( bool enable )
 {
-	if( enable )
-		glEnable( GL_DEPTH_TEST );
-	else
-		glDisable( GL_DEPTH_TEST );
+	StateCache::enable( GL_DEPTH_TEST, enable );
 }
 
 void enableDepthWrite( bool enable )
 {
-	glDepthMask( (enable) ? GL_TRUE : GL_FALSE );
+	StateCache::depthMask( (enable) ? GL_TRUE : GL_FALSE );
 }
 
 void disableDepthWrite()
 {
-	glDepthMask( GL_FALSE );
+	StateCache::depthMask( GL_FALSE );
+}
+
+namespace {
+// The draw helpers below submit through these so that a recording gl::VboList captures them instead
+inline void drawClientArrays( GLenum mode, GLint first, GLsizei count )
+{
+	if( detail::sVboListRecording )
+		detail::vboListDrawArrays( mode, first, count );
+	else
+		glDrawArrays( mode, first, count );
 }
 
+inline void drawClientElements( GLenum mode, GLsizei count, GLenum type, const GLvoid *indices )
+{
+	if( detail::sVboListRecording )
+		detail::vboListDrawElements( mode, count, type, indices );
+	else
+		glDrawElements( mode, count, type, indices );
+}
+} // anonymous namespace
+
 void drawLine( const Vec2f &start, const Vec2f &end )
 {
 	float lineVerts[2*2];
@@ -492,7 +509,7 @@ void drawLine( const Vec2f &start, const Vec2f &end )
 	glVertexPointer( 2, GL_FLOAT, 0, lineVerts );
 	lineVerts[0] = start.x; lineVerts[1] = start.y;
 	lineVerts[2] = end.x; lineVerts[3] = end.y;
-	glDrawArrays( GL_LINES, 0, 2 );
+	drawClientArrays( GL_LINES, 0, 2 );
 	glDisableClientState( GL_VERTEX_ARRAY );
 }
 
@@ -503,7 +520,7 @@ void drawLine( const Vec3f &start, const Vec3f &end )
 	glVertexPointer( 3, GL_FLOAT, 0, lineVerts );
 	lineVerts[0] = start.x; lineVerts[1] = start.y; lineVerts[2] = start.z;
 	lineVerts[3] = end.x; lineVerts[4] = end.y; lineVerts[5] = end.z; 
-	glDrawArrays( GL_LINES, 0, 2 );
+	drawClientArrays( GL_LINES, 0, 2 );
 	glDisableClientState( GL_VERTEX_ARRAY );
 }
 
@@ -563,7 +580,7 @@ void drawCubeImpl( const Vec3f &c, const Vec3f &size, bool drawColors )
 	glEnableClientState( GL_VERTEX_ARRAY );	 
 	glVertexPointer( 3, GL_FLOAT, 0, vertices );
 
-	glDrawElements( GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, elements );
+	drawClientElements( GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, elements );
 
 	glDisableClientState( GL_VERTEX_ARRAY );
 	glDisableClientState( GL_TEXTURE_COORD_ARRAY );	 
@@ -647,7 +664,7 @@ void drawSphere( const Vec3f &center, float radius, int segments )
 			texCoords[i*2*2+2] = 0.999f - i / (float)segments; texCoords[i*2*2+3] = 0.999f - 2 * ( j + 1 ) / (float)segments;
 			verts[i*3*2+3] = p.x; verts[i*3*2+4] = p.y; verts[i*3*2+5] = p.z;
 		}
-		glDrawArrays( GL_TRIANGLE_STRIP, 0, (segments + 1)*2 );
+		drawClientArrays( GL_TRIANGLE_STRIP, 0, (segments + 1)*2 );
 	}
 
 	glDisableClientState( GL_VERTEX_ARRAY );
@@ -682,7 +699,7 @@ void drawSolidCircle( const Vec2f &center, float radius, int numSegments )
 	}
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, verts );
-	glDrawArrays( GL_TRIANGLE_FAN, 0, numSegments + 2 );
+	drawClientArrays( GL_TRIANGLE_FAN, 0, numSegments + 2 );
 	glDisableClientState( GL_VERTEX_ARRAY );
 	delete [] verts;
 }
@@ -703,7 +720,7 @@ void drawStrokedCircle( const Vec2f &center, float radius, int numSegments )
 	}
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, verts );
-	glDrawArrays( GL_LINE_LOOP, 0, numSegments );
+	drawClientArrays( GL_LINE_LOOP, 0, numSegments );
 	glDisableClientState( GL_VERTEX_ARRAY );
 	delete [] verts;
 }
@@ -726,7 +743,7 @@ void drawSolidEllipse( const Vec2f &center, float radiusX, float radiusY, int nu
 	}
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, verts );
-	glDrawArrays( GL_TRIANGLE_FAN, 0, numSegments + 2 );
+	drawClientArrays( GL_TRIANGLE_FAN, 0, numSegments + 2 );
 	glDisableClientState( GL_VERTEX_ARRAY );
 	delete [] verts;
 }
@@ -747,7 +764,7 @@ void drawStrokedEllipse( const Vec2f &center, float radiusX, float radiusY, int
 	}
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, verts );
-	glDrawArrays( GL_LINE_LOOP, 0, numSegments );
+	drawClientArrays( GL_LINE_LOOP, 0, numSegments );
 	glDisableClientState( GL_VERTEX_ARRAY );
 	delete [] verts;
 }
@@ -769,7 +786,7 @@ void drawSolidRect( const Rectf &rect, bool textureRectangle )
 	verts[3*2+0] = rect.getX1(); texCoords[3*2+0] = ( textureRectangle ) ? rect.getX1() : 0;
 	verts[3*2+1] = rect.getY2(); texCoords[3*2+1] = ( textureRectangle ) ? rect.getY2() : 1;
 
-	glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+	drawClientArrays( GL_TRIANGLE_STRIP, 0, 4 );
 
 	glDisableClientState( GL_VERTEX_ARRAY );
 	glDisableClientState( GL_TEXTURE_COORD_ARRAY );	
@@ -784,7 +801,7 @@ void drawStrokedRect( const Rectf &rect )
 	verts[6] = rect.getX1();	verts[7] = rect.getY2();
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, verts );
-	glDrawArrays( GL_LINE_LOOP, 0, 4 );
+	drawClientArrays( GL_LINE_LOOP, 0, 4 );
 	glDisableClientState( GL_VERTEX_ARRAY );
 }
 
@@ -821,7 +838,7 @@ void drawSolidRoundedRect( const Rectf &r, float cornerRadius, int numSegmentsPe
 	verts[tri*2+1] = r.y2 - cornerRadius;
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, verts );
-	glDrawArrays( GL_TRIANGLE_FAN, 0, (numSegmentsPerCorner+1) * 4 + 2 );
+	drawClientArrays( GL_TRIANGLE_FAN, 0, (numSegmentsPerCorner+1) * 4 + 2 );
 	glDisableClientState( GL_VERTEX_ARRAY );
 	delete [] verts;
 }
@@ -852,18 +869,18 @@ void drawStrokedRoundedRect( const Rectf &r, float cornerRadius, int numSegments
 	}
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, verts );
-	glDrawArrays( GL_LINE_LOOP, 0, tri );
+	drawClientArrays( GL_LINE_LOOP, 0, tri );
 	glDisableClientState( GL_VERTEX_ARRAY );
 	delete [] verts;
 }
 
 void drawCoordinateFrame( float axisLength, float headLength, float headRadius )
 {
-	glColor4ub( 255, 0, 0, 255 );
+	color( ColorA8u( 255, 0, 0, 255 ) );
 	drawVector( Vec3f::zero(), Vec3f::xAxis() * axisLength, headLength, headRadius );
-	glColor4ub( 0, 255, 0, 255 );
+	color( ColorA8u( 0, 255, 0, 255 ) );
 	drawVector( Vec3f::zero(), Vec3f::yAxis() * axisLength, headLength, headRadius );
-	glColor4ub( 0, 0, 255, 255 );
+	color( ColorA8u( 0, 0, 255, 255 ) );
 	drawVector( Vec3f::zero(), Vec3f::zAxis() * axisLength, headLength, headRadius );
 }
 
@@ -876,7 +893,7 @@ void drawVector( const Vec3f &start, const Vec3f &end, float headLength, float h
 	glVertexPointer( 3, GL_FLOAT, 0, lineVerts );
 	lineVerts[0] = start.x; lineVerts[1] = start.y; lineVerts[2] = start.z;
 	lineVerts[3] = end.x; lineVerts[4] = end.y; lineVerts[5] = end.z;	
-	glDrawArrays( GL_LINES, 0, 2 );
+	drawClientArrays( GL_LINES, 0, 2 );
 	
 	// Draw the cone
 	Vec3f axis = ( end - start ).normalized();
@@ -891,7 +908,7 @@ void drawVector( const Vec3f &start, const Vec3f &end, float headLength, float h
 		coneVerts[s+1] = Vec3f( end + left * headRadius * math<float>::cos( t * 2 * 3.14159f )
 			+ up * headRadius * math<float>::sin( t * 2 * 3.14159f ) );
 	}
-	glDrawArrays( GL_TRIANGLE_FAN, 0, NUM_SEGMENTS+2 );
+	drawClientArrays( GL_TRIANGLE_FAN, 0, NUM_SEGMENTS+2 );
 
 	// draw the cap
 	glVertexPointer( 3, GL_FLOAT, 0, &coneVerts[0].x );
@@ -901,7 +918,7 @@ void drawVector( const Vec3f &start, const Vec3f &end, float headLength, float h
 		coneVerts[s+1] = Vec3f( end - left * headRadius * math<float>::cos( t * 2 * 3.14159f )
 			+ up * headRadius * math<float>::sin( t * 2 * 3.14159f ) );
 	}
-	glDrawArrays( GL_TRIANGLE_FAN, 0, NUM_SEGMENTS+2 );
+	drawClientArrays( GL_TRIANGLE_FAN, 0, NUM_SEGMENTS+2 );
 
 	glDisableClientState( GL_VERTEX_ARRAY );
 }
@@ -931,7 +948,7 @@ void drawFrustum( const Camera &cam )
 	vertex[5] = nearBottomRight;
 	vertex[6] = cam.getEyePoint();
 	vertex[7] = nearBottomLeft;
-	glDrawArrays( GL_LINES, 0, 8 );
+	drawClientArrays( GL_LINES, 0, 8 );
 
 #if ! defined( CINDER_GLES )
 	glDisable( GL_LINE_STIPPLE );
@@ -944,20 +961,20 @@ void drawFrustum( const Camera &cam )
 	vertex[5] = nearBottomRight;
 	vertex[6] = farBottomLeft;
 	vertex[7] = nearBottomLeft;
-	glDrawArrays( GL_LINES, 0, 8 );
+	drawClientArrays( GL_LINES, 0, 8 );
 
 	glLineWidth( 2.0f );
 	vertex[0] = nearTopLeft;
 	vertex[1] = nearTopRight;
 	vertex[2] = nearBottomRight;
 	vertex[3] = nearBottomLeft;
-	glDrawArrays( GL_LINE_LOOP, 0, 4 );
+	drawClientArrays( GL_LINE_LOOP, 0, 4 );
 
 	vertex[0] = farTopLeft;
 	vertex[1] = farTopRight;
 	vertex[2] = farBottomRight;
 	vertex[3] = farBottomLeft;
-	glDrawArrays( GL_LINE_LOOP, 0, 4 );
+	drawClientArrays( GL_LINE_LOOP, 0, 4 );
 	
 	glLineWidth( 1.0f );
 	glDisableClientState( GL_VERTEX_ARRAY );
@@ -1008,7 +1025,7 @@ void drawTorus( float outterRadius, float innerRadius, int longitudeSegments, in
 			indices[j*2+0] = i + 1 + longitudeSegments * j;
 			indices[j*2+1] = i + longitudeSegments * j;
 		}
-		glDrawElements( GL_TRIANGLE_STRIP, (latitudeSegments)*2, GL_UNSIGNED_SHORT, indices );
+		drawClientElements( GL_TRIANGLE_STRIP, (latitudeSegments)*2, GL_UNSIGNED_SHORT, indices );
 	}
 
 	glDisableClientState( GL_VERTEX_ARRAY );
@@ -1068,7 +1085,7 @@ void drawCylinder( float base, float top, float height, int slices, int stacks )
 			indices[j*2+0] = i + 0 + j * stacks;
 			indices[j*2+1] = i + 1 + j * stacks;
 		}
-		glDrawElements( GL_TRIANGLE_STRIP, (slices)*2, GL_UNSIGNED_SHORT, indices );
+		drawClientElements( GL_TRIANGLE_STRIP, (slices)*2, GL_UNSIGNED_SHORT, indices );
 	}
 
 	glDisableClientState( GL_NORMAL_ARRAY );
@@ -1085,7 +1102,7 @@ void draw( const PolyLine<Vec2f> &polyLine )
 {
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, &(polyLine.getPoints()[0]) );
-	glDrawArrays( ( polyLine.isClosed() ) ? GL_LINE_LOOP : GL_LINE_STRIP, 0, polyLine.size() );
+	drawClientArrays( ( polyLine.isClosed() ) ? GL_LINE_LOOP : GL_LINE_STRIP, 0, polyLine.size() );
 	glDisableClientState( GL_VERTEX_ARRAY );
 }
 
@@ -1093,7 +1110,7 @@ void draw( const PolyLine<Vec3f> &polyLine )
 {
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 3, GL_FLOAT, 0, &(polyLine.getPoints()[0]) );
-	glDrawArrays( ( polyLine.isClosed() ) ? GL_LINE_LOOP : GL_LINE_STRIP, 0, polyLine.size() );
+	drawClientArrays( ( polyLine.isClosed() ) ? GL_LINE_LOOP : GL_LINE_STRIP, 0, polyLine.size() );
 	glDisableClientState( GL_VERTEX_ARRAY );
 }
 
@@ -1101,10 +1118,10 @@ void draw( const Path2d &path2d, float approximationScale )
 {
 	if( path2d.getNumSegments() == 0 )
 		return;
-	std::vector<Vec2f> points = path2d.subdivide( approximationScale );
+	const std::vector<Vec2f> &points = path2d.getSubdivided( approximationScale );
 	glEnableClientState( GL_VERTEX_ARRAY );
 	glVertexPointer( 2, GL_FLOAT, 0, &(points[0]) );
-	glDrawArrays( GL_LINE_STRIP, 0, points.size() );
+	drawClientArrays( GL_LINE_STRIP, 0, points.size() );
 	glDisableClientState( GL_VERTEX_ARRAY );	
 }
 
@@ -1114,9 +1131,9 @@ void draw( const Shape2d &shape2d, float approximationScale )
 	for( std::vector<Path2d>::const_iterator contourIt = shape2d.getContours().begin(); contourIt != shape2d.getContours().end(); ++contourIt ) {
 		if( contourIt->getNumSegments() == 0 )
 			continue;
-		std::vector<Vec2f> points = contourIt->subdivide( approximationScale );
+		const std::vector<Vec2f> &points = contourIt->getSubdivided( approximationScale );
 		glVertexPointer( 2, GL_FLOAT, 0, &(points[0]) );
-		glDrawArrays( GL_LINE_STRIP, 0, points.size() );
+		drawClientArrays( GL_LINE_STRIP, 0, points.size() );
 	}
 	glDisableClientState( GL_VERTEX_ARRAY );	
 }
@@ -1170,10 +1187,10 @@ void draw( const TriMesh2d &mesh )
 	for ( size_t i = 0; i < mesh.getIndices().size(); i++ ) {
 		indices[ i ] = static_cast<GLushort>( mesh.getIndices()[ i ] );
 	}
-	glDrawElements( GL_TRIANGLES, mesh.getIndices().size(), GL_UNSIGNED_SHORT, (const GLvoid*)indices );
+	drawClientElements( GL_TRIANGLES, mesh.getIndices().size(), GL_UNSIGNED_SHORT, (const GLvoid*)indices );
 	delete [] indices;
 #else
-	glDrawElements( GL_TRIANGLES, mesh.getNumIndices(), GL_UNSIGNED_INT, &(mesh.getIndices()[0]) );
+	drawClientElements( GL_TRIANGLES, mesh.getNumIndices(), GL_UNSIGNED_INT, &(mesh.getIndices()[0]) );
 #endif
 
 	glDisableClientState( GL_VERTEX_ARRAY );
@@ -1216,7 +1233,7 @@ void drawRange( const TriMesh2d &mesh, size_t startTriangle, size_t triangleCoun
 	for ( size_t i = 0; i < max; i++ ) {
 		indices[ i ] = static_cast<GLushort>( mesh.getIndices()[ i ] );
 	}
-	glDrawElements( GL_TRIANGLES, count, GL_UNSIGNED_SHORT, (const GLvoid*)( indices + start ) );
+	drawClientElements( GL_TRIANGLES, count, GL_UNSIGNED_SHORT, (const GLvoid*)( indices + start ) );
 	delete [] indices;
 #else
 	glDrawRangeElements( GL_TRIANGLES, 0, mesh.getNumVertices(), triangleCount * 3, GL_UNSIGNED_INT, &(mesh.getIndices()[startTriangle*3]) );
@@ -1263,10 +1280,10 @@ void draw( const TriMesh &mesh )
 	for ( size_t i = 0; i < mesh.getIndices().size(); i++ ) {
 		indices[ i ] = static_cast<GLushort>( mesh.getIndices()[ i ] );
 	}
-	glDrawElements( GL_TRIANGLES, mesh.getIndices().size(), GL_UNSIGNED_SHORT, (const GLvoid*)indices );
+	drawClientElements( GL_TRIANGLES, mesh.getIndices().size(), GL_UNSIGNED_SHORT, (const GLvoid*)indices );
 	delete [] indices;
 #else
-	glDrawElements( GL_TRIANGLES, mesh.getNumIndices(), GL_UNSIGNED_INT, &(mesh.getIndices()[0]) );
+	drawClientElements( GL_TRIANGLES, mesh.getNumIndices(), GL_UNSIGNED_INT, &(mesh.getIndices()[0]) );
 #endif
 
 	glDisableClientState( GL_VERTEX_ARRAY );
@@ -1314,7 +1331,7 @@ void drawRange( const TriMesh &mesh, size_t startTriangle, size_t triangleCount
 	for ( size_t i = 0; i < max; i++ ) {
 		indices[ i ] = static_cast<GLushort>( mesh.getIndices()[ i ] );
 	}
-	glDrawElements( GL_TRIANGLES, count, GL_UNSIGNED_SHORT, (const GLvoid*)( indices + start ) );
+	drawClientElements( GL_TRIANGLES, count, GL_UNSIGNED_SHORT, (const GLvoid*)( indices + start ) );
 	delete [] indices;
 #else
 	glDrawRangeElements( GL_TRIANGLES, 0, mesh.getNumVertices(), triangleCount * 3, GL_UNSIGNED_INT, &(mesh.getIndices()[startTriangle*3]) );
@@ -1346,7 +1363,7 @@ void drawRange( const VboMesh &vbo, size_t startIndex, size_t indexCount, int ve
 	vbo.enableClientStates();
 	vbo.bindAllData();
 	
-	glDrawRangeElements( vbo.getPrimitiveType(), vertexStart, vertexEnd, indexCount, GL_UNSIGNED_INT, (GLvoid*)( sizeof(uint32_t) * startIndex ) );
+	glDrawRangeElements( vbo.getPrimitiveType(), vertexStart, vertexEnd, indexCount, vbo.getIndexType(), (GLvoid*)( vbo.getIndexSize() * startIndex ) );
 	
 	gl::VboMesh::unbindBuffers();
 	vbo.disableClientStates();
@@ -1361,6 +1378,19 @@ void drawArrays( const VboMesh &vbo, GLint first, GLsizei count )
 	gl::VboMesh::unbindBuffers();
 	vbo.disableClientStates();
 }
+
+void drawInstanced( const VboMesh &vbo, size_t instanceCount )
+{
+	vbo.enableClientStates();
+	vbo.bindAllData();
+	if( vbo.getNumIndices() > 0 )
+		glDrawElementsInstancedARB( vbo.getPrimitiveType(), vbo.getNumIndices(), vbo.getIndexType(), 0, instanceCount );
+	else
+		glDrawArraysInstancedARB( vbo.getPrimitiveType(), 0, vbo.getNumVertices(), instanceCount );
+
+	gl::VboMesh::unbindBuffers();
+	vbo.disableClientStates();
+}
 #endif
 
 
@@ -1381,7 +1411,7 @@ void drawBillboard( const Vec3f &pos, const Vec2f &scale, float rotationDegrees,
 	verts[2] = pos + bbRight * ( 0.5f * scale.x * cosA - 0.5f * sinA * scale.y ) + bbUp * ( 0.5f * scale.x * sinA + 0.5f * cosA * scale.y );
 	verts[3] = pos + bbRight * ( 0.5f * scale.x * cosA - -0.5f * sinA * scale.y ) + bbUp * ( 0.5f * scale.x * sinA + -0.5f * cosA * scale.y );
 
-	glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+	drawClientArrays( GL_TRIANGLE_STRIP, 0, 4 );
 
 	glDisableClientState( GL_VERTEX_ARRAY );
 	glDisableClientState( GL_TEXTURE_COORD_ARRAY );	
@@ -1428,7 +1458,7 @@ void draw( const Texture &texture, const Area &srcArea, const Rectf &destRect )
 	texCoords[2*2+0] = srcCoords.getX2(); texCoords[2*2+1] = srcCoords.getY2();	
 	texCoords[3*2+0] = srcCoords.getX1(); texCoords[3*2+1] = srcCoords.getY2();	
 
-	glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+	drawClientArrays( GL_TRIANGLE_STRIP, 0, 4 );
 }
 
 namespace {
@@ -1500,7 +1530,7 @@ SaveTextureBindState::SaveTextureBindState( GLint target )
 
 SaveTextureBindState::~SaveTextureBindState()
 {
-	glBindTexture( mTarget, mOldID );
+	StateCache::bindTexture( mTarget, mOldID );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1566,9 +1596,9 @@ SaveFramebufferBinding::SaveFramebufferBinding()
 SaveFramebufferBinding::~SaveFramebufferBinding()
 {
 #if defined( CINDER_GLES )
-	glBindFramebufferOES( GL_FRAMEBUFFER_OES, mOldValue );
+	StateCache::bindFramebuffer( GL_FRAMEBUFFER_OES, mOldValue );
 #else
-	glBindFramebufferEXT( GL_FRAMEBUFFER_EXT, mOldValue );
+	StateCache::bindFramebuffer( GL_FRAMEBUFFER_EXT, mOldValue );
 #endif
 }
 
@@ -23,11 +23,131 @@
 
 #include "cinder/ip/Blend.h"
 #include "cinder/ip/Fill.h"
+#include "cinder/ip/Simd.h"
+
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#elif defined( CINDER_IP_NEON )
+	#include <arm_neon.h>
+#endif
 
 using namespace std;
 
 namespace cinder { namespace ip {
 
+namespace {
+
+#if defined( CINDER_IP_SSE2 )
+// exact floor( t / 255 ) for 16 bit lanes with t <= 255 * 255
+inline __m128i div255_epu16( __m128i t )
+{
+	return _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( t, _mm_set1_epi16( 1 ) ), _mm_srli_epi16( t, 8 ) ), 8 );
+}
+
+// Blends 4 premultiplied pixels over 4 premultiplied (DSTALPHA) or opaque pixels per iteration, matching the scalar path bit for bit.
+// ALPHA is the byte offset of the alpha (or unused) channel within a pixel. Returns the number of pixels processed.
+template<bool DSTALPHA, int ALPHA>
+int32_t blendRowPremult_sse2( const uint8_t *src, uint8_t *dst, int32_t width )
+{
+	int16_t alphaMaskWords[8];
+	for( int i = 0; i < 8; ++i )
+		alphaMaskWords[i] = ( i % 4 == ALPHA ) ? -1 : 0;
+	const __m128i alphaMask16 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( alphaMaskWords ) );
+	const __m128i alphaMask8 = _mm_set1_epi32( 0xFF << ( ALPHA * 8 ) );
+	const __m128i max16 = _mm_set1_epi16( 255 );
+	const __m128i zero = _mm_setzero_si128();
+
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4, src += 16, dst += 16 ) {
+		__m128i srcPixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) );
+		__m128i dstPixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( dst ) );
+		__m128i result[2];
+		for( int half = 0; half < 2; ++half ) {
+			__m128i s = half ? _mm_unpackhi_epi8( srcPixels, zero ) : _mm_unpacklo_epi8( srcPixels, zero );
+			__m128i d = half ? _mm_unpackhi_epi8( dstPixels, zero ) : _mm_unpacklo_epi8( dstPixels, zero );
+			__m128i invAlphaS = _mm_sub_epi16( max16, _mm_shufflehi_epi16( _mm_shufflelo_epi16( s, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) ), _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) ) );
+			// Cr = Cs + (1-αs)×Cd
+			__m128i color = div255_epu16( _mm_mullo_epi16( invAlphaS, d ) );
+			if( DSTALPHA ) {
+				// αr = 1 – [(1–αd)×(1–αs)]
+				__m128i alpha = _mm_sub_epi16( max16, div255_epu16( _mm_mullo_epi16( invAlphaS, _mm_sub_epi16( max16, d ) ) ) );
+				color = _mm_or_si128( _mm_andnot_si128( alphaMask16, color ), _mm_and_si128( alphaMask16, alpha ) );
+			}
+			result[half] = color;
+		}
+		// the color add wraps like the scalar path's store to uint8_t
+		__m128i blended = _mm_add_epi8( _mm_packus_epi16( result[0], result[1] ), _mm_andnot_si128( alphaMask8, srcPixels ) );
+		if( DSTALPHA ) {
+			// pixels whose resulting alpha is 0 keep their previous color
+			__m128i transparent = _mm_cmpeq_epi32( _mm_and_si128( blended, alphaMask8 ), zero );
+			blended = _mm_or_si128( _mm_and_si128( transparent, dstPixels ), _mm_andnot_si128( transparent, blended ) );
+		}
+		else // the unused channel is left untouched
+			blended = _mm_or_si128( _mm_andnot_si128( alphaMask8, blended ), _mm_and_si128( alphaMask8, dstPixels ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst ), blended );
+	}
+
+	return x;
+}
+#elif defined( CINDER_IP_NEON )
+// exact floor( t / 255 ) for 16 bit lanes with t <= 255 * 255
+inline uint8x8_t div255_u16( uint16x8_t t )
+{
+	return vmovn_u16( vshrq_n_u16( vaddq_u16( vaddq_u16( t, vdupq_n_u16( 1 ) ), vshrq_n_u16( t, 8 ) ), 8 ) );
+}
+
+// Blends 8 premultiplied pixels over 8 premultiplied (DSTALPHA) or opaque pixels per iteration, matching the scalar path bit for bit.
+// Returns the number of pixels processed.
+template<bool DSTALPHA>
+int32_t blendRowPremult_neon( const uint8_t *src, uint8_t *dst, int32_t width, uint8_t alphaOffset )
+{
+	int32_t x = 0;
+	for( ; x + 8 <= width; x += 8, src += 32, dst += 32 ) {
+		uint8x8x4_t s = vld4_u8( src );
+		uint8x8x4_t d = vld4_u8( dst );
+		uint8x8_t invAlphaS = vmvn_u8( s.val[alphaOffset] );
+		uint8x8_t transparent = vdup_n_u8( 0 );
+		if( DSTALPHA ) {
+			uint8x8_t alpha = vmvn_u8( div255_u16( vmull_u8( invAlphaS, vmvn_u8( d.val[alphaOffset] ) ) ) );
+			transparent = vceq_u8( alpha, vdup_n_u8( 0 ) );
+			d.val[alphaOffset] = alpha;
+		}
+		for( int c = 0; c < 4; ++c ) {
+			if( c == alphaOffset )
+				continue;
+			uint8x8_t color = vadd_u8( s.val[c], div255_u16( vmull_u8( invAlphaS, d.val[c] ) ) );
+			// pixels whose resulting alpha is 0 keep their previous color
+			d.val[c] = vbsl_u8( transparent, d.val[c], color );
+		}
+		vst4_u8( dst, d );
+	}
+
+	return x;
+}
+#endif
+
+// Runs the SIMD premultiplied blend over the start of a row when possible, returning the number of pixels handled
+template<bool DSTALPHA>
+inline int32_t blendRowPremultSimd( const uint8_t *src, uint8_t *dst, int32_t width, uint8_t alphaOffset )
+{
+#if defined( CINDER_IP_SSE2 )
+	if( useSse2() ) {
+		switch( alphaOffset ) {
+			case 0: return blendRowPremult_sse2<DSTALPHA,0>( src, dst, width );
+			case 1: return blendRowPremult_sse2<DSTALPHA,1>( src, dst, width );
+			case 2: return blendRowPremult_sse2<DSTALPHA,2>( src, dst, width );
+			case 3: return blendRowPremult_sse2<DSTALPHA,3>( src, dst, width );
+		}
+	}
+#elif defined( CINDER_IP_NEON )
+	if( useNeon() )
+		return blendRowPremult_neon<DSTALPHA>( src, dst, width, alphaOffset );
+#endif
+	return 0;
+}
+
+} // anonymous namespace
+
 /*	
 	   αr = 1 – [(1–αd)×(1–αs)] = αd+αs–(αd×αs)
 	αr×Cr =  [(1–αs)×αd×Cd]+[(1–αd)×αs×Cs]+[αd×αs×B(Cd,Cs)]			Unpremult * Unpremult
@@ -57,14 +177,24 @@ void blendImpl_u8( Surface8u *background, const Surface8u &foreground, const Are
 		Vec2i relativeOffset = absOffset - srcArea.getUL();
 		background->copyFrom( foreground, srcArea, relativeOffset );
 		if( DSTALPHA )
-			ip::fill( &background->getChannelAlpha(), (uint8_t)255 );
+			ip::fill( &background->getChannelAlpha(), (uint8_t)255, Area( absOffset, absOffset + srcArea.getSize() ) );
 		return;
 	}
+
+	// premult over premult (or over no alpha) has SIMD implementations when both surfaces share a 4 channel layout
+	const bool simdRows = SRCPREMULT && ( DSTPREMULT || ! DSTALPHA ) && srcInc == 4 && dstInc == 4
+							&& sR == dR && sG == dG && sB == dB && ( ( ! DSTALPHA ) || sA == dA );
 	
 	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
-		const uint8_t *src = reinterpret_cast<const uint8_t*>( reinterpret_cast<const uint8_t*>( foreground.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
-		uint8_t *dst = reinterpret_cast<uint8_t*>( reinterpret_cast<uint8_t*>( background->getData() + absOffset.x * 4 ) + ( y + absOffset.y ) * dstRowBytes );
-		for( int32_t x = 0; x < width; ++x ) {
+		const uint8_t *src = reinterpret_cast<const uint8_t*>( reinterpret_cast<const uint8_t*>( foreground.getData() + srcArea.x1 * srcInc ) + ( srcArea.y1 + y ) * srcRowBytes );
+		uint8_t *dst = reinterpret_cast<uint8_t*>( reinterpret_cast<uint8_t*>( background->getData() + absOffset.x * dstInc ) + ( y + absOffset.y ) * dstRowBytes );
+		int32_t x = 0;
+		if( simdRows ) {
+			x = blendRowPremultSimd<DSTALPHA>( src, dst, width, sA );
+			src += x * srcInc;
+			dst += x * dstInc;
+		}
+		for( ; x < width; ++x ) {
 			const uint8_t alphaS = (SRCALPHA) ? src[sA] : 255;
 			const uint8_t invAlphaS = (SRCALPHA) ? CHANTRAIT<uint8_t>::inverse(src[sA]) : 0;
 			const uint8_t alphaD = (DSTALPHA) ? dst[dA] : CHANTRAIT<uint8_t>::max();
@@ -131,13 +261,13 @@ void blendImpl_float( Surface32f *background, const Surface32f &foreground, cons
 		Vec2i relativeOffset = absOffset - srcArea.getUL();
 		background->copyFrom( foreground, srcArea, relativeOffset );
 		if( DSTALPHA )
-			ip::fill( &background->getChannelAlpha(), 1.0f );
+			ip::fill( &background->getChannelAlpha(), 1.0f, Area( absOffset, absOffset + srcArea.getSize() ) );
 		return;
 	}
 	
 	for( int32_t y = 0; y < srcArea.getHeight(); ++y ) {
-		const float *src = reinterpret_cast<const float*>( reinterpret_cast<const uint8_t*>( foreground.getData() + srcArea.x1 * 4 ) + ( srcArea.y1 + y ) * srcRowBytes );
-		float *dst = reinterpret_cast<float*>( reinterpret_cast<uint8_t*>( background->getData() + absOffset.x * 4 ) + ( y + absOffset.y ) * dstRowBytes );
+		const float *src = reinterpret_cast<const float*>( reinterpret_cast<const uint8_t*>( foreground.getData() + srcArea.x1 * srcInc ) + ( srcArea.y1 + y ) * srcRowBytes );
+		float *dst = reinterpret_cast<float*>( reinterpret_cast<uint8_t*>( background->getData() + absOffset.x * dstInc ) + ( y + absOffset.y ) * dstRowBytes );
 		for( int32_t x = 0; x < width; ++x ) {
 			const float alphaS = (SRCALPHA) ? src[sA] : 1;
 			const float invAlphaS = (SRCALPHA) ? CHANTRAIT<float>::inverse(src[sA]) : 0;
@@ -185,54 +315,90 @@ void blendImpl_float( Surface32f *background, const Surface32f &foreground, cons
 	}
 }
 
-void blend( Surface8u *background, const Surface8u &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset )
+typedef void (*BlendFn_u8)( Surface8u*, const Surface8u&, const Area&, Vec2i );
+typedef void (*BlendFn_float)( Surface32f*, const Surface32f&, const Area&, Vec2i );
+
+BlendFn_u8 selectBlendImpl( const Surface8u &background, const Surface8u &foreground )
 {
-	pair<Area,Vec2i> srcDst = clippedSrcDst( foreground.getBounds(), srcArea, background->getBounds(), srcArea.getUL() + dstRelativeOffset );	
-	if( background->hasAlpha() ) {
-		if( background->isPremultiplied() ) {
+	if( background.hasAlpha() ) {
+		if( background.isPremultiplied() ) {
 			if( foreground.isPremultiplied() )
-				blendImpl_u8<true, true, true>( background, foreground, srcDst.first, srcDst.second );
+				return &blendImpl_u8<true, true, true>;
 			else
-				blendImpl_u8<true, true, false>( background, foreground, srcDst.first, srcDst.second );
+				return &blendImpl_u8<true, true, false>;
 		}
 		else { // background unpremult
 			if( foreground.isPremultiplied() )
-				blendImpl_u8<true, false, true>( background, foreground, srcDst.first, srcDst.second );
+				return &blendImpl_u8<true, false, true>;
 			else
-				blendImpl_u8<true, false, false>( background, foreground, srcDst.first, srcDst.second );
+				return &blendImpl_u8<true, false, false>;
 		}
 	}
 	else { // background no alpha
 		if( foreground.isPremultiplied() )
-			blendImpl_u8<false, false, true>( background, foreground, srcDst.first, srcDst.second );
+			return &blendImpl_u8<false, false, true>;
 		else
-			blendImpl_u8<false, false, false>( background, foreground, srcDst.first, srcDst.second );	
+			return &blendImpl_u8<false, false, false>;
 	}
 }
 
-void blend( Surface32f *background, const Surface32f &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset )
+BlendFn_float selectBlendImpl( const Surface32f &background, const Surface32f &foreground )
 {
-	pair<Area,Vec2i> srcDst = clippedSrcDst( foreground.getBounds(), srcArea, background->getBounds(), srcArea.getUL() + dstRelativeOffset );
-	if( background->hasAlpha() ) {
-		if( background->isPremultiplied() ) {
+	if( background.hasAlpha() ) {
+		if( background.isPremultiplied() ) {
 			if( foreground.isPremultiplied() )
-				blendImpl_float<true, true, true>( background, foreground, srcDst.first, srcDst.second );
+				return &blendImpl_float<true, true, true>;
 			else
-				blendImpl_float<true, true, false>( background, foreground, srcDst.first, srcDst.second );
+				return &blendImpl_float<true, true, false>;
 		}
 		else {
 			if( foreground.isPremultiplied() )
-				blendImpl_float<true, false, true>( background, foreground, srcDst.first, srcDst.second );
+				return &blendImpl_float<true, false, true>;
 			else
-				blendImpl_float<true, false, false>( background, foreground, srcDst.first, srcDst.second );
+				return &blendImpl_float<true, false, false>;
 		}
 	}
 	else { // background no alpha
 		if( foreground.isPremultiplied() )
-			blendImpl_float<false, false, true>( background, foreground, srcDst.first, srcDst.second );
+			return &blendImpl_float<false, false, true>;
 		else
-			blendImpl_float<false, false, false>( background, foreground, srcDst.first, srcDst.second );	
+			return &blendImpl_float<false, false, false>;
 	}
 }
 
+// blends the rows of \a band, a subset of \a srcArea, which maps to the destination at \a absOffset
+template<typename SURFACET, typename BLENDFN>
+void blendBand( BLENDFN blendFn, SURFACET *background, const SURFACET *foreground, const Area &srcArea, const Vec2i &absOffset, const Area &band )
+{
+	(*blendFn)( background, *foreground, band, absOffset + ( band.getUL() - srcArea.getUL() ) );
+}
+
+void blend( Surface8u *background, const Surface8u &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset )
+{
+	pair<Area,Vec2i> srcDst = clippedSrcDst( foreground.getBounds(), srcArea, background->getBounds(), srcArea.getUL() + dstRelativeOffset );
+	background->markDirty( Area( srcDst.second, srcDst.second + srcDst.first.getSize() ) );
+	(*selectBlendImpl( *background, foreground ))( background, foreground, srcDst.first, srcDst.second );
+}
+
+void blend( Surface32f *background, const Surface32f &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset )
+{
+	pair<Area,Vec2i> srcDst = clippedSrcDst( foreground.getBounds(), srcArea, background->getBounds(), srcArea.getUL() + dstRelativeOffset );
+	background->markDirty( Area( srcDst.second, srcDst.second + srcDst.first.getSize() ) );
+	(*selectBlendImpl( *background, foreground ))( background, foreground, srcDst.first, srcDst.second );
+}
+
+void blend( Surface8u *background, const Surface8u &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset, const ExecutionContextRef &context )
+{
+	pair<Area,Vec2i> srcDst = clippedSrcDst( foreground.getBounds(), srcArea, background->getBounds(), srcArea.getUL() + dstRelativeOffset );
+	background->markDirty( Area( srcDst.second, srcDst.second + srcDst.first.getSize() ) );
+	context->run( srcDst.first, std::bind( &blendBand<Surface8u,BlendFn_u8>, selectBlendImpl( *background, foreground ), background, &foreground, srcDst.first, srcDst.second, std::_1 ) );
+}
+
+void blend( Surface32f *background, const Surface32f &foreground, const Area &srcArea, const Vec2i &dstRelativeOffset, const ExecutionContextRef &context )
+{
+	pair<Area,Vec2i> srcDst = clippedSrcDst( foreground.getBounds(), srcArea, background->getBounds(), srcArea.getUL() + dstRelativeOffset );
+	background->markDirty( Area( srcDst.second, srcDst.second + srcDst.first.getSize() ) );
+	context->run( srcDst.first, std::bind( &blendBand<Surface32f,BlendFn_float>, selectBlendImpl( *background, foreground ), background, &foreground, srcDst.first, srcDst.second, std::_1 ) );
+}
+
 } } // namespace cinder::ip
\ No newline at end of file
@@ -0,0 +1,185 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Blur.h"
+#include "cinder/ip/IntegralImage.h"
+
+#include <vector>
+#include <math.h>
+
+namespace cinder { namespace ip {
+
+template<typename T>
+struct BLURTRAIT {
+};
+
+template<>
+struct BLURTRAIT<uint8_t> {
+	typedef uint32_t SUMT;
+	static uint8_t average( SUMT sum, uint32_t count ) { return static_cast<uint8_t>( ( sum + count / 2 ) / count ); }
+};
+
+template<>
+struct BLURTRAIT<uint16_t> {
+	typedef uint64_t SUMT;	// 32 bits overflow past 65536 maximal pixels
+	static uint16_t average( SUMT sum, uint32_t count ) { return static_cast<uint16_t>( ( sum + count / 2 ) / count ); }
+};
+
+template<>
+struct BLURTRAIT<float> {
+	typedef double SUMT;	// float sums lose too much precision over a whole image
+	static float average( SUMT sum, uint32_t count ) { return static_cast<float>( sum / count ); }
+};
+
+// blurs srcChannel into dstChannel using integralImage, which must hold srcChannel.getWidth() * srcChannel.getHeight() values, as scratch
+template<typename T>
+void boxBlurImpl( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, int32_t radius, typename BLURTRAIT<T>::SUMT *integralImage )
+{
+	typedef typename BLURTRAIT<T>::SUMT SUMT;
+
+	const int32_t imageWidth = srcChannel.getWidth(), imageHeight = srcChannel.getHeight();
+	const int32_t width = std::min( imageWidth, dstChannel->getWidth() ), height = std::min( imageHeight, dstChannel->getHeight() );
+	const uint8_t dstInc = dstChannel->getIncrement();
+
+	if( radius <= 0 ) {
+		if( &srcChannel != dstChannel )
+			dstChannel->copyFrom( srcChannel, Area( 0, 0, width, height ) );
+		return;
+	}
+
+	// the whole table is built before the first write, which makes in-place blurs safe
+	calculateIntegralImage( srcChannel, integralImage );
+
+	for( int32_t y = 0; y < height; ++y ) {
+		const int32_t y1 = std::max( 0, y - radius ), y2 = std::min( imageHeight - 1, y + radius );
+		T *dst = dstChannel->getData( 0, y );
+		for( int32_t x = 0; x < width; ++x ) {
+			const int32_t x1 = std::max( 0, x - radius ), x2 = std::min( imageWidth - 1, x + radius );
+			const uint32_t count = ( x2 - x1 + 1 ) * ( y2 - y1 + 1 );
+			*dst = BLURTRAIT<T>::average( integralImageSum( integralImage, imageWidth, x1, y1, x2, y2 ), count );
+			dst += dstInc;
+		}
+	}
+}
+
+// Box radii whose successive application best approximates a Gaussian of standard deviation sigma, after "Fast Almost-Gaussian Filtering" by Kovesi
+void gaussianBoxRadii( float sigma, int32_t numBoxes, int32_t *radii )
+{
+	const float idealWidth = sqrt( 12 * sigma * sigma / numBoxes + 1 );
+	int32_t lowerWidth = (int32_t)floor( idealWidth );
+	if( lowerWidth % 2 == 0 )
+		lowerWidth--;
+	const int32_t upperWidth = lowerWidth + 2;
+	const float idealLower = ( 12 * sigma * sigma - numBoxes * lowerWidth * lowerWidth - 4 * numBoxes * lowerWidth - 3 * numBoxes ) / ( -4.0f * lowerWidth - 4 );
+	const int32_t numLower = (int32_t)floor( idealLower + 0.5f );
+	for( int32_t i = 0; i < numBoxes; ++i )
+		radii[i] = ( ( i < numLower ) ? lowerWidth : upperWidth ) / 2;
+}
+
+template<typename T>
+void gaussianBlurImpl( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, float sigma, typename BLURTRAIT<T>::SUMT *integralImage )
+{
+	int32_t radii[3];
+	gaussianBoxRadii( sigma, 3, radii );
+
+	boxBlurImpl( srcChannel, dstChannel, radii[0], integralImage );
+	boxBlurImpl( *dstChannel, dstChannel, radii[1], integralImage );
+	boxBlurImpl( *dstChannel, dstChannel, radii[2], integralImage );
+}
+
+template<typename T>
+void boxBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, int32_t radius )
+{
+	std::vector<typename BLURTRAIT<T>::SUMT> integralImage( srcChannel.getWidth() * srcChannel.getHeight() );
+	boxBlurImpl( srcChannel, dstChannel, radius, &integralImage[0] );
+}
+
+template<typename T>
+void boxBlur( ChannelT<T> *channel, int32_t radius )
+{
+	boxBlur( *channel, channel, radius );
+}
+
+template<typename T>
+void boxBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, int32_t radius )
+{
+	dstSurface->markDirty();
+	std::vector<typename BLURTRAIT<T>::SUMT> integralImage( srcSurface.getWidth() * srcSurface.getHeight() );
+	boxBlurImpl( srcSurface.getChannelRed(), &dstSurface->getChannelRed(), radius, &integralImage[0] );
+	boxBlurImpl( srcSurface.getChannelGreen(), &dstSurface->getChannelGreen(), radius, &integralImage[0] );
+	boxBlurImpl( srcSurface.getChannelBlue(), &dstSurface->getChannelBlue(), radius, &integralImage[0] );
+	if( srcSurface.hasAlpha() && dstSurface->hasAlpha() )
+		boxBlurImpl( srcSurface.getChannelAlpha(), &dstSurface->getChannelAlpha(), radius, &integralImage[0] );
+}
+
+template<typename T>
+void boxBlur( SurfaceT<T> *surface, int32_t radius )
+{
+	boxBlur( *surface, surface, radius );
+}
+
+template<typename T>
+void gaussianBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, float sigma )
+{
+	std::vector<typename BLURTRAIT<T>::SUMT> integralImage( srcChannel.getWidth() * srcChannel.getHeight() );
+	gaussianBlurImpl( srcChannel, dstChannel, sigma, &integralImage[0] );
+}
+
+template<typename T>
+void gaussianBlur( ChannelT<T> *channel, float sigma )
+{
+	gaussianBlur( *channel, channel, sigma );
+}
+
+template<typename T>
+void gaussianBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, float sigma )
+{
+	dstSurface->markDirty();
+	std::vector<typename BLURTRAIT<T>::SUMT> integralImage( srcSurface.getWidth() * srcSurface.getHeight() );
+	gaussianBlurImpl( srcSurface.getChannelRed(), &dstSurface->getChannelRed(), sigma, &integralImage[0] );
+	gaussianBlurImpl( srcSurface.getChannelGreen(), &dstSurface->getChannelGreen(), sigma, &integralImage[0] );
+	gaussianBlurImpl( srcSurface.getChannelBlue(), &dstSurface->getChannelBlue(), sigma, &integralImage[0] );
+	if( srcSurface.hasAlpha() && dstSurface->hasAlpha() )
+		gaussianBlurImpl( srcSurface.getChannelAlpha(), &dstSurface->getChannelAlpha(), sigma, &integralImage[0] );
+}
+
+template<typename T>
+void gaussianBlur( SurfaceT<T> *surface, float sigma )
+{
+	gaussianBlur( *surface, surface, sigma );
+}
+
+#define blur_PROTOTYPES(r,data,T)\
+	template void boxBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, int32_t radius ); \
+	template void boxBlur( ChannelT<T> *channel, int32_t radius ); \
+	template void boxBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, int32_t radius ); \
+	template void boxBlur( SurfaceT<T> *surface, int32_t radius ); \
+	template void gaussianBlur( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, float sigma ); \
+	template void gaussianBlur( ChannelT<T> *channel, float sigma ); \
+	template void gaussianBlur( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, float sigma ); \
+	template void gaussianBlur( SurfaceT<T> *surface, float sigma );
+
+BOOST_PP_SEQ_FOR_EACH( blur_PROTOTYPES, ~, CHANNEL_TYPES )
+
+} } // namespace cinder::ip
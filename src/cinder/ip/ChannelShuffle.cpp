@@ -0,0 +1,250 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/ip/ChannelShuffle.h"
+#include "cinder/ip/Simd.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined( CINDER_IP_SSSE3 )
+	#include <tmmintrin.h>
+#elif defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#elif defined( CINDER_IP_NEON )
+	#include <arm_neon.h>
+#endif
+
+namespace cinder { namespace ip {
+
+namespace {
+
+#if defined( CINDER_IP_SSE2 )
+inline int32_t loadU32( const uint8_t *ptr )
+{
+	int32_t result;
+	memcpy( &result, ptr, 4 );
+	return result;
+}
+
+inline void storeU32( uint8_t *ptr, int32_t value )
+{
+	memcpy( ptr, &value, 4 );
+}
+#endif
+
+} // anonymous namespace
+
+ChannelShuffle::ChannelShuffle( int32_t srcPixelInc, int32_t dstPixelInc )
+{
+	init( srcPixelInc, dstPixelInc );
+}
+
+ChannelShuffle::ChannelShuffle( const SurfaceChannelOrder &srcOrder, const SurfaceChannelOrder &dstOrder, AlphaMode alphaMode )
+{
+	init( srcOrder.getPixelInc(), dstOrder.getPixelInc() );
+	copy( dstOrder.getRedOffset(), srcOrder.getRedOffset() );
+	copy( dstOrder.getGreenOffset(), srcOrder.getGreenOffset() );
+	copy( dstOrder.getBlueOffset(), srcOrder.getBlueOffset() );
+	if( alphaMode == COPY_ALPHA )
+		copy( dstOrder.getAlphaOffset(), srcOrder.getAlphaOffset() );
+	else if( alphaMode == FILL_ALPHA )
+		fill( dstOrder.getAlphaOffset() );
+}
+
+void ChannelShuffle::init( int32_t srcPixelInc, int32_t dstPixelInc )
+{
+	mSrcInc = srcPixelInc;
+	mDstInc = dstPixelInc;
+	mPixelsPerStep = std::min( 16 / mSrcInc, 16 / mDstInc );
+	// each step reads and writes 16 bytes, which must lie within the row
+	mMinPixels = std::max( ( 16 + mSrcInc - 1 ) / mSrcInc, ( 16 + mDstInc - 1 ) / mDstInc );
+	memset( mSrcOffsets, KEEP, 4 );
+	memset( mShuffle, 0x80, 16 );
+	memset( mKeep, 0xFF, 16 );
+	memset( mFill, 0, 16 );
+}
+
+void ChannelShuffle::copy( int32_t dstOffset, int32_t srcOffset )
+{
+	mSrcOffsets[dstOffset] = (int8_t)srcOffset;
+	for( int32_t p = 0; p < mPixelsPerStep; ++p ) {
+		mShuffle[p * mDstInc + dstOffset] = (uint8_t)( p * mSrcInc + srcOffset );
+		mKeep[p * mDstInc + dstOffset] = 0;
+		mFill[p * mDstInc + dstOffset] = 0;
+	}
+}
+
+void ChannelShuffle::fill( int32_t dstOffset )
+{
+	mSrcOffsets[dstOffset] = FILL;
+	for( int32_t p = 0; p < mPixelsPerStep; ++p ) {
+		mShuffle[p * mDstInc + dstOffset] = 0x80;
+		mKeep[p * mDstInc + dstOffset] = 0;
+		mFill[p * mDstInc + dstOffset] = 0xFF;
+	}
+}
+
+void ChannelShuffle::apply( const uint8_t *src, uint8_t *dst, int32_t width ) const
+{
+	int32_t x = applySimd( src, dst, width );
+	src += x * mSrcInc;
+	dst += x * mDstInc;
+	for( ; x < width; ++x ) {
+		for( int32_t b = 0; b < mDstInc; ++b ) {
+			if( mSrcOffsets[b] >= 0 )
+				dst[b] = src[mSrcOffsets[b]];
+			else if( mSrcOffsets[b] == FILL )
+				dst[b] = 0xFF;
+		}
+		src += mSrcInc;
+		dst += mDstInc;
+	}
+}
+
+int32_t ChannelShuffle::applySimd( const uint8_t *src, uint8_t *dst, int32_t width ) const
+{
+#if defined( CINDER_IP_SSSE3 )
+	if( useSsse3() )
+		return applySsse3( src, dst, width );
+#endif
+#if defined( CINDER_IP_SSE2 )
+	if( useSse2() )
+		return applySse2( src, dst, width );
+#elif defined( CINDER_IP_NEON )
+	if( useNeon() )
+		return applyNeon( src, dst, width );
+#endif
+	return 0;
+}
+
+#if defined( CINDER_IP_SSSE3 )
+int32_t ChannelShuffle::applySsse3( const uint8_t *src, uint8_t *dst, int32_t width ) const
+{
+	const __m128i indices = _mm_loadu_si128( reinterpret_cast<const __m128i*>( mShuffle ) );
+	const __m128i keep = _mm_loadu_si128( reinterpret_cast<const __m128i*>( mKeep ) );
+	const __m128i fill = _mm_loadu_si128( reinterpret_cast<const __m128i*>( mFill ) );
+	const int32_t srcStep = mPixelsPerStep * mSrcInc, dstStep = mPixelsPerStep * mDstInc;
+	int32_t x = 0;
+	for( ; x + mMinPixels <= width; x += mPixelsPerStep, src += srcStep, dst += dstStep ) {
+		__m128i result = _mm_shuffle_epi8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) ), indices );
+		result = _mm_or_si128( result, _mm_and_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( dst ) ), keep ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dst ), _mm_or_si128( result, fill ) );
+	}
+	return x;
+}
+#endif
+
+#if defined( CINDER_IP_SSE2 )
+// SSE2 lacks a byte shuffle, so four source pixels are spread across the 32 bit lanes of a register and each destination byte is shifted
+// into place within its lane. 3 byte destination pixels are written as overlapping 32 bit stores, so they can't preserve any bytes.
+int32_t ChannelShuffle::applySse2( const uint8_t *src, uint8_t *dst, int32_t width ) const
+{
+	if( mDstInc < 3 )
+		return 0;
+
+	// destination bytes which aren't copied from the source use an empty mask
+	__m128i srcShifts[4], dstShifts[4], byteMasks[4];
+	int32_t laneKeep = 0, laneFill = 0;
+	for( int32_t b = 0; b < 4; ++b ) {
+		const bool copied = ( b < mDstInc ) && ( mSrcOffsets[b] >= 0 );
+		srcShifts[b] = _mm_cvtsi32_si128( copied ? mSrcOffsets[b] * 8 : 0 );
+		dstShifts[b] = _mm_cvtsi32_si128( b * 8 );
+		byteMasks[b] = _mm_set1_epi32( copied ? 0xFF : 0 );
+		if( ( b < mDstInc ) && ( mSrcOffsets[b] == KEEP ) )
+			laneKeep |= 0xFF << ( b * 8 );
+		else if( ( b < mDstInc ) && ( mSrcOffsets[b] == FILL ) )
+			laneFill |= 0xFF << ( b * 8 );
+	}
+	if( ( mDstInc == 3 ) && laneKeep )
+		return 0;
+	const __m128i keep = _mm_set1_epi32( laneKeep ), fill = _mm_set1_epi32( laneFill );
+
+	// 3 byte pixels are read and written 4 bytes at a time, so the step needs one pixel beyond it
+	const int32_t minPixels = ( ( mSrcInc == 3 ) || ( mDstInc == 3 ) ) ? 5 : 4;
+	const int32_t srcStep = 4 * mSrcInc, dstStep = 4 * mDstInc;
+	int32_t x = 0;
+	for( ; x + minPixels <= width; x += 4, src += srcStep, dst += dstStep ) {
+		__m128i pixels;
+		switch( mSrcInc ) {
+			case 1:
+				pixels = _mm_cvtsi32_si128( loadU32( src ) );
+				pixels = _mm_unpacklo_epi8( pixels, pixels );
+				pixels = _mm_unpacklo_epi16( pixels, pixels );
+			break;
+			case 2:
+				pixels = _mm_loadl_epi64( reinterpret_cast<const __m128i*>( src ) );
+				pixels = _mm_unpacklo_epi16( pixels, pixels );
+			break;
+			case 3:
+				pixels = _mm_setr_epi32( loadU32( src ), loadU32( src + 3 ), loadU32( src + 6 ), loadU32( src + 9 ) );
+			break;
+			default:
+				pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src ) );
+		}
+
+		__m128i result = fill;
+		if( laneKeep )
+			result = _mm_or_si128( result, _mm_and_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( dst ) ), keep ) );
+		result = _mm_or_si128( result, _mm_sll_epi32( _mm_and_si128( _mm_srl_epi32( pixels, srcShifts[0] ), byteMasks[0] ), dstShifts[0] ) );
+		result = _mm_or_si128( result, _mm_sll_epi32( _mm_and_si128( _mm_srl_epi32( pixels, srcShifts[1] ), byteMasks[1] ), dstShifts[1] ) );
+		result = _mm_or_si128( result, _mm_sll_epi32( _mm_and_si128( _mm_srl_epi32( pixels, srcShifts[2] ), byteMasks[2] ), dstShifts[2] ) );
+		result = _mm_or_si128( result, _mm_sll_epi32( _mm_and_si128( _mm_srl_epi32( pixels, srcShifts[3] ), byteMasks[3] ), dstShifts[3] ) );
+
+		if( mDstInc == 4 )
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( dst ), result );
+		else {
+			// each store's fourth byte is overwritten by the next one, and the last one's by the following step or the scalar remainder
+			storeU32( dst, _mm_cvtsi128_si32( result ) );
+			storeU32( dst + 3, _mm_cvtsi128_si32( _mm_srli_si128( result, 4 ) ) );
+			storeU32( dst + 6, _mm_cvtsi128_si32( _mm_srli_si128( result, 8 ) ) );
+			storeU32( dst + 9, _mm_cvtsi128_si32( _mm_srli_si128( result, 12 ) ) );
+		}
+	}
+	return x;
+}
+#endif
+
+#if defined( CINDER_IP_NEON )
+int32_t ChannelShuffle::applyNeon( const uint8_t *src, uint8_t *dst, int32_t width ) const
+{
+	// vtbl produces zero for the out of range 0x80 indices, just like pshufb
+	const uint8x8_t indicesLo = vld1_u8( mShuffle ), indicesHi = vld1_u8( mShuffle + 8 );
+	const uint8x16_t keep = vld1q_u8( mKeep ), fill = vld1q_u8( mFill );
+	const int32_t srcStep = mPixelsPerStep * mSrcInc, dstStep = mPixelsPerStep * mDstInc;
+	int32_t x = 0;
+	for( ; x + mMinPixels <= width; x += mPixelsPerStep, src += srcStep, dst += dstStep ) {
+		uint8x8x2_t table;
+		table.val[0] = vld1_u8( src );
+		table.val[1] = vld1_u8( src + 8 );
+		uint8x16_t result = vcombine_u8( vtbl2_u8( table, indicesLo ), vtbl2_u8( table, indicesHi ) );
+		result = vorrq_u8( result, vandq_u8( vld1q_u8( dst ), keep ) );
+		vst1q_u8( dst, vorrq_u8( result, fill ) );
+	}
+	return x;
+}
+#endif
+
+} } // namespace cinder::ip
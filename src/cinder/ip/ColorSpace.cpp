@@ -0,0 +1,456 @@
+/*
+ Copyright (c) 2010, The Barbarian Group
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+    * Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+    * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/ip/ColorSpace.h"
+#include "cinder/ip/Simd.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/CinderMath.h"
+
+#include <boost/preprocessor/seq/for_each.hpp>
+
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#endif
+
+namespace cinder { namespace ip {
+
+float srgbToLinear( float v )
+{
+	return ( v <= 0.04045f ) ? ( v / 12.92f ) : math<float>::pow( ( v + 0.055f ) / 1.055f, 2.4f );
+}
+
+float linearToSrgb( float v )
+{
+	return ( v <= 0.0031308f ) ? ( v * 12.92f ) : ( 1.055f * math<float>::pow( v, 1.0f / 2.4f ) - 0.055f );
+}
+
+namespace {
+
+// Converts a channel value from [0,1], rounding to the nearest integer value
+template<typename T>
+inline T fromUnit( float v );
+template<>
+inline uint8_t fromUnit<uint8_t>( float v ) { return static_cast<uint8_t>( math<float>::clamp( v, 0, 1 ) * 255 + 0.5f ); }
+template<>
+inline uint16_t fromUnit<uint16_t>( float v ) { return static_cast<uint16_t>( math<float>::clamp( v, 0, 1 ) * 65535 + 0.5f ); }
+template<>
+inline float fromUnit<float>( float v ) { return v; }
+
+#if defined( CINDER_IP_SSE2 )
+inline __m128 select_ps( __m128 mask, __m128 a, __m128 b )
+{
+	return _mm_or_ps( _mm_and_ps( mask, a ), _mm_andnot_ps( mask, b ) );
+}
+#endif
+
+// Each conversion converts one pixel's components in place, and with SSE2 four pixels' worth at once, one vector per component
+struct RgbToHsvOp {
+	void apply( float &r, float &g, float &b ) const
+	{
+		Vec3f hsv = rgbToHSV( Colorf( r, g, b ) );
+		r = hsv.x;
+		g = hsv.y;
+		b = hsv.z;
+	}
+
+#if defined( CINDER_IP_SSE2 )
+	static const bool SIMD = true;
+	void apply( __m128 &r, __m128 &g, __m128 &b ) const
+	{
+		const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps( 1 );
+		__m128 maxc = _mm_max_ps( r, _mm_max_ps( g, b ) );
+		__m128 range = _mm_sub_ps( maxc, _mm_min_ps( r, _mm_min_ps( g, b ) ) );
+		// gray pixels have no hue, and black ones no saturation
+		__m128 hasHue = _mm_cmpgt_ps( range, zero );
+		__m128 invRange = _mm_div_ps( one, select_ps( hasHue, range, one ) );
+		__m128 hueR = _mm_mul_ps( _mm_sub_ps( g, b ), invRange );
+		__m128 hueG = _mm_add_ps( _mm_set1_ps( 2 ), _mm_mul_ps( _mm_sub_ps( b, r ), invRange ) );
+		__m128 hueB = _mm_add_ps( _mm_set1_ps( 4 ), _mm_mul_ps( _mm_sub_ps( r, g ), invRange ) );
+		__m128 hue = select_ps( _mm_cmpeq_ps( r, maxc ), hueR, select_ps( _mm_cmpeq_ps( g, maxc ), hueG, hueB ) );
+		hue = _mm_mul_ps( hue, _mm_set1_ps( 1 / 6.0f ) );
+		hue = _mm_add_ps( hue, _mm_and_ps( _mm_cmplt_ps( hue, zero ), one ) );
+		__m128 positive = _mm_cmpgt_ps( maxc, zero );
+		r = _mm_and_ps( hasHue, hue );
+		g = _mm_and_ps( positive, _mm_div_ps( range, select_ps( positive, maxc, one ) ) );
+		b = maxc;
+	}
+#else
+	static const bool SIMD = false;
+#endif
+};
+
+struct HsvToRgbOp {
+	void apply( float &h, float &s, float &v ) const
+	{
+		Colorf rgb = hsvToRGB( Vec3f( h, s, v ) );
+		h = rgb.r;
+		s = rgb.g;
+		v = rgb.b;
+	}
+
+#if defined( CINDER_IP_SSE2 )
+	static const bool SIMD = true;
+	// each component is v - v * s * clamp( min( k, 4 - k ), 0, 1 ), where k = ( n + 6h ) mod 6 and n is 5, 3 and 1 for red, green and blue,
+	// which matches the six sectors of hsvToRGB() without branching
+	static __m128 component( float n, __m128 hue6, __m128 vs, __m128 v )
+	{
+		const __m128 six = _mm_set1_ps( 6 );
+		__m128 k = _mm_add_ps( _mm_set1_ps( n ), hue6 );
+		k = _mm_sub_ps( k, _mm_and_ps( _mm_cmpge_ps( k, six ), six ) );
+		__m128 ramp = _mm_min_ps( _mm_max_ps( _mm_min_ps( k, _mm_sub_ps( _mm_set1_ps( 4 ), k ) ), _mm_setzero_ps() ), _mm_set1_ps( 1 ) );
+		return _mm_sub_ps( v, _mm_mul_ps( vs, ramp ) );
+	}
+
+	void apply( __m128 &h, __m128 &s, __m128 &v ) const
+	{
+		// a hue of 1 wraps around to 0
+		__m128 hue6 = _mm_mul_ps( h, _mm_set1_ps( 6 ) );
+		hue6 = _mm_andnot_ps( _mm_cmpge_ps( hue6, _mm_set1_ps( 6 ) ), hue6 );
+		__m128 vs = _mm_mul_ps( v, s );
+		h = component( 5, hue6, vs, v );
+		s = component( 3, hue6, vs, v );
+		v = component( 1, hue6, vs, v );
+	}
+#else
+	static const bool SIMD = false;
+#endif
+};
+
+// rgb' = m * rgb + offset
+struct AffineOp {
+	AffineOp( const Matrix33f &m, const Vec3f &offset )
+	{
+		for( int row = 0; row < 3; ++row ) {
+			for( int col = 0; col < 3; ++col )
+				mM[row][col] = m.at( row, col );
+			mOffset[row] = offset[row];
+		}
+	}
+
+	void apply( float &r, float &g, float &b ) const
+	{
+		float x = r, y = g, z = b;
+		r = mM[0][0] * x + mM[0][1] * y + mM[0][2] * z + mOffset[0];
+		g = mM[1][0] * x + mM[1][1] * y + mM[1][2] * z + mOffset[1];
+		b = mM[2][0] * x + mM[2][1] * y + mM[2][2] * z + mOffset[2];
+	}
+
+#if defined( CINDER_IP_SSE2 )
+	static const bool SIMD = true;
+	void apply( __m128 &r, __m128 &g, __m128 &b ) const
+	{
+		__m128 x = r, y = g, z = b;
+		__m128 *result[3] = { &r, &g, &b };
+		for( int row = 0; row < 3; ++row )
+			*result[row] = _mm_add_ps( _mm_add_ps( _mm_mul_ps( _mm_set1_ps( mM[row][0] ), x ), _mm_mul_ps( _mm_set1_ps( mM[row][1] ), y ) ),
+										_mm_add_ps( _mm_mul_ps( _mm_set1_ps( mM[row][2] ), z ), _mm_set1_ps( mOffset[row] ) ) );
+	}
+#else
+	static const bool SIMD = false;
+#endif
+
+	float	mM[3][3], mOffset[3];
+};
+
+// pow() has no SIMD equivalent here, and 8 bit Surfaces use sSrgbTables instead
+struct SrgbToLinearOp {
+	static const bool SIMD = false;
+	void apply( float &r, float &g, float &b ) const { r = srgbToLinear( r ); g = srgbToLinear( g ); b = srgbToLinear( b ); }
+#if defined( CINDER_IP_SSE2 )
+	void apply( __m128 &, __m128 &, __m128 & ) const {}
+#endif
+};
+
+struct LinearToSrgbOp {
+	static const bool SIMD = false;
+	void apply( float &r, float &g, float &b ) const { r = linearToSrgb( r ); g = linearToSrgb( g ); b = linearToSrgb( b ); }
+#if defined( CINDER_IP_SSE2 )
+	void apply( __m128 &, __m128 &, __m128 & ) const {}
+#endif
+};
+
+// sRGB decoding and encoding of every 8 bit value
+struct SrgbTables {
+	SrgbTables()
+	{
+		for( int v = 0; v < 256; ++v ) {
+			mToLinear[v] = fromUnit<uint8_t>( srgbToLinear( v / 255.0f ) );
+			mToSrgb[v] = fromUnit<uint8_t>( linearToSrgb( v / 255.0f ) );
+		}
+	}
+
+	uint8_t		mToLinear[256], mToSrgb[256];
+};
+
+const SrgbTables sSrgbTables;
+
+#if defined( CINDER_IP_SSE2 )
+// Converts 4 pixels of 4 bytes per iteration, each held in a 32 bit lane so that any channel order unpacks with a shift. Returns the number of pixels processed.
+template<typename Op>
+int32_t convertRow_sse2( uint8_t *data, int32_t width, uint8_t redOffset, uint8_t greenOffset, uint8_t blueOffset, const Op &op )
+{
+	const __m128i shifts[3] = { _mm_cvtsi32_si128( redOffset * 8 ), _mm_cvtsi32_si128( greenOffset * 8 ), _mm_cvtsi32_si128( blueOffset * 8 ) };
+	const __m128i byteMask = _mm_set1_epi32( 0xFF );
+	const __m128i keepMask = _mm_set1_epi32( ~( ( 0xFF << ( redOffset * 8 ) ) | ( 0xFF << ( greenOffset * 8 ) ) | ( 0xFF << ( blueOffset * 8 ) ) ) );
+	const __m128 toUnit = _mm_set1_ps( 1 / 255.0f ), fromUnit = _mm_set1_ps( 255 ), zero = _mm_setzero_ps(), one = _mm_set1_ps( 1 );
+
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4, data += 16 ) {
+		__m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data ) );
+		__m128 c[3];
+		for( int i = 0; i < 3; ++i )
+			c[i] = _mm_mul_ps( _mm_cvtepi32_ps( _mm_and_si128( _mm_srl_epi32( pixels, shifts[i] ), byteMask ) ), toUnit );
+		op.apply( c[0], c[1], c[2] );
+		__m128i result = _mm_and_si128( pixels, keepMask );
+		for( int i = 0; i < 3; ++i ) {
+			__m128i v = _mm_cvtps_epi32( _mm_mul_ps( _mm_min_ps( _mm_max_ps( c[i], zero ), one ), fromUnit ) );
+			result = _mm_or_si128( result, _mm_sll_epi32( v, shifts[i] ) );
+		}
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( data ), result );
+	}
+
+	return x;
+}
+
+// Converts 4 pixels of 4 floats per iteration, transposed so that each vector holds one channel. Returns the number of pixels processed.
+template<typename Op>
+int32_t convertRow_sse2( float *data, int32_t width, uint8_t redOffset, uint8_t greenOffset, uint8_t blueOffset, const Op &op )
+{
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4, data += 16 ) {
+		__m128 c[4] = { _mm_loadu_ps( data ), _mm_loadu_ps( data + 4 ), _mm_loadu_ps( data + 8 ), _mm_loadu_ps( data + 12 ) };
+		_MM_TRANSPOSE4_PS( c[0], c[1], c[2], c[3] );
+		op.apply( c[redOffset], c[greenOffset], c[blueOffset] );
+		_MM_TRANSPOSE4_PS( c[0], c[1], c[2], c[3] );
+		for( int p = 0; p < 4; ++p )
+			_mm_storeu_ps( data + p * 4, c[p] );
+	}
+
+	return x;
+}
+#endif
+
+// Runs the SIMD conversion over the start of a row when possible, returning the number of pixels handled
+template<typename T, typename Op>
+inline int32_t convertRowSimd( T *data, int32_t width, uint8_t pixelInc, uint8_t redOffset, uint8_t greenOffset, uint8_t blueOffset, const Op &op )
+{
+#if defined( CINDER_IP_SSE2 )
+	if( Op::SIMD && ( pixelInc == 4 ) && useSse2() )
+		return convertRow_sse2( data, width, redOffset, greenOffset, blueOffset, op );
+#endif
+	return 0;
+}
+
+template<typename Op>
+inline int32_t convertRowSimd( uint16_t * /*data*/, int32_t /*width*/, uint8_t /*pixelInc*/, uint8_t /*redOffset*/, uint8_t /*greenOffset*/, uint8_t /*blueOffset*/, const Op &/*op*/ )
+{
+	return 0;
+}
+
+template<typename T, typename Op>
+void convertImpl( SurfaceT<T> *surface, const Op &op, const Area &area )
+{
+	int32_t rowBytes = surface->getRowBytes();
+	uint8_t pixelInc = surface->getPixelInc();
+	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset();
+	for( int32_t y = area.getY1(); y < area.getY2(); ++y ) {
+		T *dstPtr = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( surface->getData() + area.getX1() * pixelInc ) + y * rowBytes );
+		int32_t x = convertRowSimd( dstPtr, area.getWidth(), pixelInc, redOffset, greenOffset, blueOffset, op );
+		dstPtr += x * pixelInc;
+		for( ; x < area.getWidth(); ++x ) {
+			float r = CHANTRAIT<float>::convert( dstPtr[redOffset] ), g = CHANTRAIT<float>::convert( dstPtr[greenOffset] ), b = CHANTRAIT<float>::convert( dstPtr[blueOffset] );
+			op.apply( r, g, b );
+			dstPtr[redOffset] = fromUnit<T>( r );
+			dstPtr[greenOffset] = fromUnit<T>( g );
+			dstPtr[blueOffset] = fromUnit<T>( b );
+			dstPtr += pixelInc;
+		}
+	}
+}
+
+void lookupImpl( SurfaceT<uint8_t> *surface, const uint8_t *table, const Area &area )
+{
+	int32_t rowBytes = surface->getRowBytes();
+	uint8_t pixelInc = surface->getPixelInc();
+	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset();
+	for( int32_t y = area.getY1(); y < area.getY2(); ++y ) {
+		uint8_t *dstPtr = surface->getData() + area.getX1() * pixelInc + y * rowBytes;
+		for( int32_t x = 0; x < area.getWidth(); ++x ) {
+			dstPtr[redOffset] = table[dstPtr[redOffset]];
+			dstPtr[greenOffset] = table[dstPtr[greenOffset]];
+			dstPtr[blueOffset] = table[dstPtr[blueOffset]];
+			dstPtr += pixelInc;
+		}
+	}
+}
+
+template<typename T, typename Op>
+void convert( SurfaceT<T> *surface, const Op &op, const ExecutionContextRef &context )
+{
+	void (*bandFn)( SurfaceT<T>*, const Op&, const Area& ) = &convertImpl<T,Op>;
+	surface->markDirty();
+	if( context )
+		context->run( surface->getBounds(), std::bind( bandFn, surface, op, std::_1 ) );
+	else
+		convertImpl( surface, op, surface->getBounds() );
+}
+
+void lookup( SurfaceT<uint8_t> *surface, const uint8_t *table, const ExecutionContextRef &context )
+{
+	surface->markDirty();
+	if( context )
+		context->run( surface->getBounds(), std::bind( &lookupImpl, surface, table, std::_1 ) );
+	else
+		lookupImpl( surface, table, surface->getBounds() );
+}
+
+AffineOp yCbCrToRgbOp( YuvSurface::ColorMatrix colorMatrix, bool fullRange )
+{
+	Matrix33f m;
+	Vec3f offset;
+	YuvSurface::getRgbConversion( colorMatrix, fullRange, &m, &offset );
+	return AffineOp( m, offset );
+}
+
+AffineOp rgbToYCbCrOp( YuvSurface::ColorMatrix colorMatrix, bool fullRange )
+{
+	Matrix33f m;
+	Vec3f offset;
+	YuvSurface::getRgbConversion( colorMatrix, fullRange, &m, &offset );
+	Matrix33f inverse = m.inverted();
+	return AffineOp( inverse, -( inverse * offset ) );
+}
+
+template<typename T>
+void srgbToLinearImpl( SurfaceT<T> *surface, const ExecutionContextRef &context )
+{
+	convert( surface, SrgbToLinearOp(), context );
+}
+
+void srgbToLinearImpl( SurfaceT<uint8_t> *surface, const ExecutionContextRef &context )
+{
+	lookup( surface, sSrgbTables.mToLinear, context );
+}
+
+template<typename T>
+void linearToSrgbImpl( SurfaceT<T> *surface, const ExecutionContextRef &context )
+{
+	convert( surface, LinearToSrgbOp(), context );
+}
+
+void linearToSrgbImpl( SurfaceT<uint8_t> *surface, const ExecutionContextRef &context )
+{
+	lookup( surface, sSrgbTables.mToSrgb, context );
+}
+
+} // anonymous namespace
+
+template<typename T>
+void rgbToHsv( SurfaceT<T> *surface )
+{
+	convert( surface, RgbToHsvOp(), ExecutionContextRef() );
+}
+
+template<typename T>
+void rgbToHsv( SurfaceT<T> *surface, const ExecutionContextRef &context )
+{
+	convert( surface, RgbToHsvOp(), context );
+}
+
+template<typename T>
+void hsvToRgb( SurfaceT<T> *surface )
+{
+	convert( surface, HsvToRgbOp(), ExecutionContextRef() );
+}
+
+template<typename T>
+void hsvToRgb( SurfaceT<T> *surface, const ExecutionContextRef &context )
+{
+	convert( surface, HsvToRgbOp(), context );
+}
+
+template<typename T>
+void rgbToYCbCr( SurfaceT<T> *surface, YuvSurface::ColorMatrix colorMatrix, bool fullRange )
+{
+	convert( surface, rgbToYCbCrOp( colorMatrix, fullRange ), ExecutionContextRef() );
+}
+
+template<typename T>
+void rgbToYCbCr( SurfaceT<T> *surface, const ExecutionContextRef &context, YuvSurface::ColorMatrix colorMatrix, bool fullRange )
+{
+	convert( surface, rgbToYCbCrOp( colorMatrix, fullRange ), context );
+}
+
+template<typename T>
+void yCbCrToRgb( SurfaceT<T> *surface, YuvSurface::ColorMatrix colorMatrix, bool fullRange )
+{
+	convert( surface, yCbCrToRgbOp( colorMatrix, fullRange ), ExecutionContextRef() );
+}
+
+template<typename T>
+void yCbCrToRgb( SurfaceT<T> *surface, const ExecutionContextRef &context, YuvSurface::ColorMatrix colorMatrix, bool fullRange )
+{
+	convert( surface, yCbCrToRgbOp( colorMatrix, fullRange ), context );
+}
+
+template<typename T>
+void srgbToLinear( SurfaceT<T> *surface )
+{
+	srgbToLinearImpl( surface, ExecutionContextRef() );
+}
+
+template<typename T>
+void srgbToLinear( SurfaceT<T> *surface, const ExecutionContextRef &context )
+{
+	srgbToLinearImpl( surface, context );
+}
+
+template<typename T>
+void linearToSrgb( SurfaceT<T> *surface )
+{
+	linearToSrgbImpl( surface, ExecutionContextRef() );
+}
+
+template<typename T>
+void linearToSrgb( SurfaceT<T> *surface, const ExecutionContextRef &context )
+{
+	linearToSrgbImpl( surface, context );
+}
+
+#define colorspace_PROTOTYPES(r,data,T)\
+	template void rgbToHsv( SurfaceT<T> *surface ); \
+	template void rgbToHsv( SurfaceT<T> *surface, const ExecutionContextRef &context ); \
+	template void hsvToRgb( SurfaceT<T> *surface ); \
+	template void hsvToRgb( SurfaceT<T> *surface, const ExecutionContextRef &context ); \
+	template void rgbToYCbCr( SurfaceT<T> *surface, YuvSurface::ColorMatrix colorMatrix, bool fullRange ); \
+	template void rgbToYCbCr( SurfaceT<T> *surface, const ExecutionContextRef &context, YuvSurface::ColorMatrix colorMatrix, bool fullRange ); \
+	template void yCbCrToRgb( SurfaceT<T> *surface, YuvSurface::ColorMatrix colorMatrix, bool fullRange ); \
+	template void yCbCrToRgb( SurfaceT<T> *surface, const ExecutionContextRef &context, YuvSurface::ColorMatrix colorMatrix, bool fullRange ); \
+	template void srgbToLinear( SurfaceT<T> *surface ); \
+	template void srgbToLinear( SurfaceT<T> *surface, const ExecutionContextRef &context ); \
+	template void linearToSrgb( SurfaceT<T> *surface ); \
+	template void linearToSrgb( SurfaceT<T> *surface, const ExecutionContextRef &context );
+
+BOOST_PP_SEQ_FOR_EACH( colorspace_PROTOTYPES, ~, CHANNEL_TYPES )
+
+} } // namespace cinder::ip
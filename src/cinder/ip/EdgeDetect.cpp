@@ -32,38 +32,55 @@ namespace cinder { namespace ip {
 // -1  0  1    -1 -2 -1
 // NOTE: this leaves garbage in the top and bottom rows, as well as the left and right columns
 
+// processes the rows of \a band which lie inside the already clipped \a area, writing to \a dstChannel displaced by \a dstOffset
 template<typename T>
-void edgeDetectSobel( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel )
+void edgeDetectSobelImpl( const ChannelT<T> *srcChannel, const Area &area, const Vec2i &dstOffset, ChannelT<T> *dstChannel, const Area &band )
 {
-	std::pair<Area,Vec2i> srcDst = clippedSrcDst( srcChannel.getBounds(), srcArea, dstChannel->getBounds(), dstLT );
-	const Area &area( srcDst.first );
-	const Vec2i &dstOffset( srcDst.second );
 	typename CHANTRAIT<T>::Sum sumX, sumY;
 
-	int32_t srcRowBytes = srcChannel.getRowBytes();
-	int8_t srcPixelBytes = srcChannel.getIncrement() * sizeof(T);
+	int32_t srcRowBytes = srcChannel->getRowBytes();
+	int8_t srcPixelBytes = srcChannel->getIncrement() * sizeof(T);
 	int8_t dstPixelBytes = dstChannel->getIncrement() * sizeof(T);
 	const T maxValue = CHANTRAIT<T>::max();
-	for( int32_t y = 1; y < area.getHeight() - 1; ++y ) {
-		const uint8_t *srcLine = reinterpret_cast<const uint8_t*>( srcChannel.getData( area.getX1() + 1, area.getY1() + y ) );
+	// the kernel needs a neighbor on each side, so the outermost rows and columns of the area are skipped
+	const int32_t startY = std::max( band.getY1(), area.getY1() + 1 );
+	const int32_t endY = std::min( band.getY2(), area.getY2() - 1 );
+	for( int32_t y = startY; y < endY; ++y ) {
+		const uint8_t *srcLine = reinterpret_cast<const uint8_t*>( srcChannel->getData( area.getX1() + 1, y ) );
 		uint8_t *dstLine = reinterpret_cast<uint8_t*>( dstChannel->getData( dstOffset.x + area.getX1() + 1, dstOffset.y + y ) );
 		for( int32_t x = area.getX1() + 1; x < area.getX2() - 1; ++x ) {
 //			sumX = -srcLine[-srcRowPixels-srcPixelStride] + srcLine[-srcRowPixels+srcPixelStride] - 2 * srcLine[-srcPixelStride] + 2 * srcLine[srcPixelStride] - srcLine[srcRowPixels-srcPixelStride] + srcLine[srcRowPixels+srcPixelStride];
 			sumX = -*(T*)(srcLine-srcRowBytes-srcPixelBytes) + *(T*)(srcLine-srcRowBytes+srcPixelBytes) - 2 * *(T*)(srcLine-srcPixelBytes) + 2 * *(T*)(srcLine+srcPixelBytes) - *(T*)(srcLine+srcRowBytes-srcPixelBytes) + *(T*)(srcLine+srcRowBytes+srcPixelBytes);
 //			sumY = srcLine[-srcRowPixels-srcPixelStride] + 2 * srcLine[-srcRowPixels] + srcLine[-srcRowPixels + srcPixelStride]				- srcLine[srcRowPixels-srcPixelStride] - 2 * srcLine[srcRowPixels] - srcLine[srcRowPixels+srcPixelStride];
-			sumY = *(T*)(srcLine-srcRowBytes-srcPixelBytes) + 2 * *(T*)(srcLine-srcRowBytes) + *(T*)(srcLine-srcRowBytes+srcPixelBytes) - *(T*)(srcLine+srcRowBytes-srcPixelBytes) - 2 * *(T*)(srcLine+srcPixelBytes) - *(T*)(srcLine+srcRowBytes+srcPixelBytes);
+			sumY = *(T*)(srcLine-srcRowBytes-srcPixelBytes) + 2 * *(T*)(srcLine-srcRowBytes) + *(T*)(srcLine-srcRowBytes+srcPixelBytes) - *(T*)(srcLine+srcRowBytes-srcPixelBytes) - 2 * *(T*)(srcLine+srcRowBytes) - *(T*)(srcLine+srcRowBytes+srcPixelBytes);
 			sumX = static_cast<typename CHANTRAIT<T>::Sum>( math<float>::sqrt( float( sumX * sumX + sumY * sumY ) ) );
 			if( sumX > maxValue ) sumX = maxValue;
-			*dstLine = static_cast<uint8_t>( sumX );
+			*reinterpret_cast<T*>( dstLine ) = static_cast<T>( sumX );
 			dstLine += dstPixelBytes;
 			srcLine += srcPixelBytes;
 		}
 	}
 }
 
+template<typename T>
+void edgeDetectSobel( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel )
+{
+	std::pair<Area,Vec2i> srcDst = clippedSrcDst( srcChannel.getBounds(), srcArea, dstChannel->getBounds(), dstLT );
+	edgeDetectSobelImpl( &srcChannel, srcDst.first, srcDst.second - srcDst.first.getUL(), dstChannel, srcDst.first );
+}
+
+template<typename T>
+void edgeDetectSobel( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel, const ExecutionContextRef &context )
+{
+	std::pair<Area,Vec2i> srcDst = clippedSrcDst( srcChannel.getBounds(), srcArea, dstChannel->getBounds(), dstLT );
+	context->run( srcDst.first, std::bind( &edgeDetectSobelImpl<T>, &srcChannel, srcDst.first, srcDst.second - srcDst.first.getUL(), dstChannel, std::_1 ) );
+}
+
 template<typename T>
 void edgeDetectSobel( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstLT, SurfaceT<T> *dstSurface )
 {
+	std::pair<Area,Vec2i> srcDst = clippedSrcDst( srcSurface.getBounds(), srcArea, dstSurface->getBounds(), dstLT );
+	dstSurface->markDirty( Area( srcDst.second, srcDst.second + srcDst.first.getSize() ) );
 	edgeDetectSobel( srcSurface.getChannelRed(), srcArea, dstLT, &dstSurface->getChannelRed() );
 	edgeDetectSobel( srcSurface.getChannelGreen(), srcArea, dstLT, &dstSurface->getChannelGreen() );
 	edgeDetectSobel( srcSurface.getChannelBlue(), srcArea, dstLT, &dstSurface->getChannelBlue() );
@@ -71,6 +88,18 @@ void edgeDetectSobel( const SurfaceT<T> &srcSurface, const Area &srcArea, const
 		edgeDetectSobel( srcSurface.getChannelAlpha(), srcArea, dstLT, &dstSurface->getChannelAlpha() );
 }
 
+template<typename T>
+void edgeDetectSobel( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstLT, SurfaceT<T> *dstSurface, const ExecutionContextRef &context )
+{
+	std::pair<Area,Vec2i> srcDst = clippedSrcDst( srcSurface.getBounds(), srcArea, dstSurface->getBounds(), dstLT );
+	dstSurface->markDirty( Area( srcDst.second, srcDst.second + srcDst.first.getSize() ) );
+	edgeDetectSobel( srcSurface.getChannelRed(), srcArea, dstLT, &dstSurface->getChannelRed(), context );
+	edgeDetectSobel( srcSurface.getChannelGreen(), srcArea, dstLT, &dstSurface->getChannelGreen(), context );
+	edgeDetectSobel( srcSurface.getChannelBlue(), srcArea, dstLT, &dstSurface->getChannelBlue(), context );
+	if( srcSurface.hasAlpha() && dstSurface->hasAlpha() )
+		edgeDetectSobel( srcSurface.getChannelAlpha(), srcArea, dstLT, &dstSurface->getChannelAlpha(), context );
+}
+
 template<typename T>
 void edgeDetectSobel( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel )
 {
@@ -88,7 +117,9 @@ void edgeDetectSobel( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSuface )
 	template void edgeDetectSobel( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel ); \
 	template void edgeDetectSobel( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstLT, SurfaceT<T> *dstSurface ); \
 	template void edgeDetectSobel( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel );	\
-	template void edgeDetectSobel( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );	
+	template void edgeDetectSobel( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );	\
+	template void edgeDetectSobel( const ChannelT<T> &srcChannel, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel, const ExecutionContextRef &context ); \
+	template void edgeDetectSobel( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstLT, SurfaceT<T> *dstSurface, const ExecutionContextRef &context );
 
 BOOST_PP_SEQ_FOR_EACH( edgeDetect_PROTOTYPES, ~, CHANNEL_TYPES )
 
@@ -75,6 +75,7 @@ template<typename T, typename Y>
 void fill( SurfaceT<T> *surface, const ColorT<Y> &color )
 {
 	ColorT<T> nativeColor( color );
+	surface->markDirty();
 	fill_impl( surface, nativeColor, surface->getBounds() );
 }
 
@@ -82,6 +83,7 @@ template<typename T, typename Y>
 void fill( SurfaceT<T> *surface, const ColorT<Y> &color, const Area &area )
 {
 	ColorT<T> nativeColor( color );
+	surface->markDirty( area );
 	fill_impl( surface, nativeColor, area );
 }
 
@@ -89,6 +91,7 @@ template<typename T, typename Y>
 void fill( SurfaceT<T> *surface, const ColorAT<Y> &color )
 {
 	ColorAT<T> nativeColor( color );
+	surface->markDirty();
 	fill_impl( surface, nativeColor, surface->getBounds() );
 }
 
@@ -96,6 +99,7 @@ template<typename T, typename Y>
 void fill( SurfaceT<T> *surface, const ColorAT<Y> &color, const Area &area )
 {
 	ColorAT<T> nativeColor( color );
+	surface->markDirty( area );
 	fill_impl( surface, nativeColor, area );
 }
 
@@ -121,21 +125,57 @@ void fill( ChannelT<T> *channel, T value )
 	fill( channel, value, channel->getBounds() );
 }
 
+template<typename T, typename Y>
+void fill( SurfaceT<T> *surface, const ColorT<Y> &color, const Area &area, const ExecutionContextRef &context )
+{
+	surface->markDirty( area );
+	void (*bandFn)( SurfaceT<T>*, const ColorT<T>&, const Area& ) = &fill_impl<T>;
+	context->run( area.getClipBy( surface->getBounds() ), std::bind( bandFn, surface, ColorT<T>( color ), std::_1 ) );
+}
+
+template<typename T, typename Y>
+void fill( SurfaceT<T> *surface, const ColorAT<Y> &color, const Area &area, const ExecutionContextRef &context )
+{
+	// if no alpha we'll fail over the to alpha-less fill
+	if( ! surface->hasAlpha() ) {
+		fill( surface, ColorT<Y>( color.r, color.g, color.b ), area, context );
+		return;
+	}
+
+	surface->markDirty( area );
+	void (*bandFn)( SurfaceT<T>*, const ColorAT<T>&, const Area& ) = &fill_impl<T>;
+	context->run( area.getClipBy( surface->getBounds() ), std::bind( bandFn, surface, ColorAT<T>( color ), std::_1 ) );
+}
+
+template<typename T>
+void fill( ChannelT<T> *channel, T value, const Area &area, const ExecutionContextRef &context )
+{
+	void (*bandFn)( ChannelT<T>*, T, const Area& ) = &fill<T>;
+	context->run( area.getClipBy( channel->getBounds() ), std::bind( bandFn, channel, value, std::_1 ) );
+}
+
 #define fill_PROTOTYPES(r,data,T)\
 	template void fill<T,uint8_t>( SurfaceT<T> *surface, const ColorT<uint8_t> &color, const Area &area ); \
 	template void fill<T,uint8_t>( SurfaceT<T> *surface, const ColorT<uint8_t> &color ); \
 	template void fill<T,uint8_t>( SurfaceT<T> *surface, const ColorAT<uint8_t> &color, const Area &area ); \
 	template void fill<T,uint8_t>( SurfaceT<T> *surface, const ColorAT<uint8_t> &color ); \
+	template void fill<T,uint8_t>( SurfaceT<T> *surface, const ColorT<uint8_t> &color, const Area &area, const ExecutionContextRef &context ); \
+	template void fill<T,uint8_t>( SurfaceT<T> *surface, const ColorAT<uint8_t> &color, const Area &area, const ExecutionContextRef &context ); \
 	template void fill<T,uint16_t>( SurfaceT<T> *surface, const ColorT<uint16_t> &color, const Area &area ); \
 	template void fill<T,uint16_t>( SurfaceT<T> *surface, const ColorT<uint16_t> &color ); \
 	template void fill<T,uint16_t>( SurfaceT<T> *surface, const ColorAT<uint16_t> &color, const Area &area ); \
 	template void fill<T,uint16_t>( SurfaceT<T> *surface, const ColorAT<uint16_t> &color ); \
+	template void fill<T,uint16_t>( SurfaceT<T> *surface, const ColorT<uint16_t> &color, const Area &area, const ExecutionContextRef &context ); \
+	template void fill<T,uint16_t>( SurfaceT<T> *surface, const ColorAT<uint16_t> &color, const Area &area, const ExecutionContextRef &context ); \
 	template void fill<T,float>( SurfaceT<T> *surface, const ColorT<float> &color, const Area &area ); \
 	template void fill<T,float>( SurfaceT<T> *surface, const ColorT<float> &color ); \
 	template void fill<T,float>( SurfaceT<T> *surface, const ColorAT<float> &color, const Area &area ); \
 	template void fill<T,float>( SurfaceT<T> *surface, const ColorAT<float> &color ); \
+	template void fill<T,float>( SurfaceT<T> *surface, const ColorT<float> &color, const Area &area, const ExecutionContextRef &context ); \
+	template void fill<T,float>( SurfaceT<T> *surface, const ColorAT<float> &color, const Area &area, const ExecutionContextRef &context ); \
 	template void fill<T>( ChannelT<T> *channel, const T value, const Area &area ); \
-	template void fill<T>( ChannelT<T> *channel, const T value );
+	template void fill<T>( ChannelT<T> *channel, const T value ); \
+	template void fill<T>( ChannelT<T> *channel, const T value, const Area &area, const ExecutionContextRef &context );
 
 BOOST_PP_SEQ_FOR_EACH( fill_PROTOTYPES, ~, (uint8_t)(uint16_t)(float) )
 
@@ -27,8 +27,10 @@ namespace cinder { namespace ip {
 template<typename T>
 void flipVertical( SurfaceT<T> *surface )
 {
-	int32_t rowBytes = surface->getRowBytes();
+	// copy only the pixels of each row; the row bytes of a sub-Surface span pixels outside of it
+	int32_t rowBytes = surface->getWidth() * surface->getPixelInc() * sizeof(T);
 	uint8_t *buffer = new uint8_t[rowBytes];
+	surface->markDirty();
 	
 	int32_t lastRow = surface->getHeight() - 1;
 	int32_t halfHeight = surface->getHeight() / 2;
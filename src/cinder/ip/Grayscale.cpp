@@ -26,17 +26,15 @@
 namespace cinder { namespace ip {
 
 template<typename T>
-void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface )
+void grayscaleImpl( const SurfaceT<T> *srcSurface, SurfaceT<T> *dstSurface, const Area &area )
 {
-	Area area = srcSurface.getBounds().getClipBy( dstSurface->getBounds() );
-
-	int8_t srcPixelInc = srcSurface.getPixelInc();
-	uint8_t srcRedOffset = srcSurface.getRedOffset(), srcGreenOffset = srcSurface.getGreenOffset(), srcBlueOffset = srcSurface.getBlueOffset();
+	int8_t srcPixelInc = srcSurface->getPixelInc();
+	uint8_t srcRedOffset = srcSurface->getRedOffset(), srcGreenOffset = srcSurface->getGreenOffset(), srcBlueOffset = srcSurface->getBlueOffset();
 	uint8_t dstRedOffset = dstSurface->getRedOffset(), dstGreenOffset = dstSurface->getGreenOffset(), dstBlueOffset = dstSurface->getBlueOffset();	
 	int8_t dstPixelInc = dstSurface->getPixelInc();
-	for( int32_t y = 0; y < area.getHeight(); ++y ) {
+	for( int32_t y = area.getY1(); y < area.getY2(); ++y ) {
 		T *dstPtr = dstSurface->getData( Vec2i( area.getX1(), y ) );
-		const T *srcPtr = srcSurface.getData( Vec2i( area.getX1(), y ) );
+		const T *srcPtr = srcSurface->getData( Vec2i( area.getX1(), y ) );
 		for( int32_t x = area.getX1(); x < area.getX2(); ++x ) {
 			T gray = CHANTRAIT<T>::grayscale( srcPtr[srcRedOffset], srcPtr[srcGreenOffset], srcPtr[srcBlueOffset] );
 			dstPtr[dstRedOffset] = gray;
@@ -49,16 +47,14 @@ void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface )
 }
 
 template<typename T>
-void grayscale( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel )
+void grayscaleImpl( const SurfaceT<T> *srcSurface, ChannelT<T> *dstChannel, const Area &area )
 {
-	Area area = srcSurface.getBounds().getClipBy( dstChannel->getBounds() );
-
-	int8_t srcPixelInc = srcSurface.getPixelInc();
-	uint8_t srcRedOffset = srcSurface.getRedOffset(), srcGreenOffset = srcSurface.getGreenOffset(), srcBlueOffset = srcSurface.getBlueOffset();
+	int8_t srcPixelInc = srcSurface->getPixelInc();
+	uint8_t srcRedOffset = srcSurface->getRedOffset(), srcGreenOffset = srcSurface->getGreenOffset(), srcBlueOffset = srcSurface->getBlueOffset();
 	int8_t dstPixelInc = dstChannel->getIncrement();
-	for( int32_t y = 0; y < area.getHeight(); ++y ) {
+	for( int32_t y = area.getY1(); y < area.getY2(); ++y ) {
 		T *dstPtr = dstChannel->getData( Vec2i( area.getX1(), y ) );
-		const T *srcPtr = srcSurface.getData( Vec2i( area.getX1(), y ) );
+		const T *srcPtr = srcSurface->getData( Vec2i( area.getX1(), y ) );
 		for( int32_t x = area.getX1(); x < area.getX2(); ++x ) {
 			*dstPtr = CHANTRAIT<T>::grayscale( srcPtr[srcRedOffset], srcPtr[srcGreenOffset], srcPtr[srcBlueOffset] );
 			dstPtr += dstPixelInc;
@@ -68,17 +64,15 @@ void grayscale( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel )
 }
 
 template<>
-void grayscale( const Surface8u &srcSurface, Channel8u *dstChannel )
+void grayscaleImpl( const Surface8u *srcSurface, Channel8u *dstChannel, const Area &area )
 {
-	Area area = srcSurface.getBounds().getClipBy( dstChannel->getBounds() );
-
-	int8_t srcPixelInc = srcSurface.getPixelInc();
-	uint8_t srcRedOffset = srcSurface.getRedOffset(), srcGreenOffset = srcSurface.getGreenOffset(), srcBlueOffset = srcSurface.getBlueOffset();
+	int8_t srcPixelInc = srcSurface->getPixelInc();
+	uint8_t srcRedOffset = srcSurface->getRedOffset(), srcGreenOffset = srcSurface->getGreenOffset(), srcBlueOffset = srcSurface->getBlueOffset();
 	int8_t dstPixelInc = dstChannel->getIncrement();
 	const uint8_t redWeight = 74, greenWeight = 147, blueWeight = 35;
-	for( int32_t y = 0; y < area.getHeight(); ++y ) {
+	for( int32_t y = area.getY1(); y < area.getY2(); ++y ) {
 		uint8_t *dstPtr = dstChannel->getData( Vec2i( area.getX1(), y ) );
-		const uint8_t *srcPtr = srcSurface.getData( Vec2i( area.getX1(), y ) );
+		const uint8_t *srcPtr = srcSurface->getData( Vec2i( area.getX1(), y ) );
 		for( int32_t x = area.getX1(); x < area.getX2(); ++x ) {
 			uint32_t sum = srcPtr[srcRedOffset] * redWeight + srcPtr[srcGreenOffset] * greenWeight + srcPtr[srcBlueOffset] * blueWeight;
 			*dstPtr = static_cast<uint8_t>( sum >> 8 );
@@ -88,10 +82,42 @@ void grayscale( const Surface8u &srcSurface, Channel8u *dstChannel )
 	}
 }
 
+template<typename T>
+void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface )
+{
+	dstSurface->markDirty( srcSurface.getBounds() );
+	grayscaleImpl( &srcSurface, dstSurface, srcSurface.getBounds().getClipBy( dstSurface->getBounds() ) );
+}
+
+template<typename T>
+void grayscale( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel )
+{
+	grayscaleImpl( &srcSurface, dstChannel, srcSurface.getBounds().getClipBy( dstChannel->getBounds() ) );
+}
+
+template<typename T>
+void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const ExecutionContextRef &context )
+{
+	void (*bandFn)( const SurfaceT<T>*, SurfaceT<T>*, const Area& ) = &grayscaleImpl<T>;
+	dstSurface->markDirty( srcSurface.getBounds() );
+	context->run( srcSurface.getBounds().getClipBy( dstSurface->getBounds() ), std::bind( bandFn, &srcSurface, dstSurface, std::_1 ) );
+}
+
+template<typename T>
+void grayscale( const SurfaceT<T> &srcSurface, ChannelT<T> *dstChannel, const ExecutionContextRef &context )
+{
+	void (*bandFn)( const SurfaceT<T>*, ChannelT<T>*, const Area& ) = &grayscaleImpl<T>;
+	context->run( srcSurface.getBounds().getClipBy( dstChannel->getBounds() ), std::bind( bandFn, &srcSurface, dstChannel, std::_1 ) );
+}
+
 #define grayscale_PROTOTYPES(r,data,T)\
-	template void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface );
+	template void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface ); \
+	template void grayscale( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const ExecutionContextRef &context );
 	
+template void grayscale( const SurfaceT<uint8_t> &srcSurface, ChannelT<uint8_t> *dstChannel );
 template void grayscale( const SurfaceT<float> &srcSurface, ChannelT<float> *dstChannel );
+template void grayscale( const SurfaceT<uint8_t> &srcSurface, ChannelT<uint8_t> *dstChannel, const ExecutionContextRef &context );
+template void grayscale( const SurfaceT<float> &srcSurface, ChannelT<float> *dstChannel, const ExecutionContextRef &context );
 
 BOOST_PP_SEQ_FOR_EACH( grayscale_PROTOTYPES, ~, CHANNEL_TYPES )
 
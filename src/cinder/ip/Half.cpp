@@ -0,0 +1,137 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/ip/Half.h"
+#include "cinder/ip/Simd.h"
+
+#include <cstring>
+
+#if defined( CINDER_IP_F16C )
+	#include <immintrin.h>
+#elif defined( CINDER_IP_NEON_FP16 )
+	#include <arm_neon.h>
+#endif
+
+namespace cinder { namespace ip {
+
+uint16_t floatToHalf( float value )
+{
+	uint32_t bits;
+	memcpy( &bits, &value, sizeof(bits) );
+	uint16_t sign = (uint16_t)( ( bits >> 16 ) & 0x8000 );
+	uint32_t absBits = bits & 0x7FFFFFFF;
+
+	if( absBits > 0x7F800000 ) // NaN, quieted and keeping what fits of its payload, as F16C does
+		return sign | 0x7E00 | (uint16_t)( ( absBits & 0x7FFFFF ) >> 13 );
+	else if( absBits == 0x7F800000 )
+		return sign | 0x7C00;
+	else if( absBits >= 0x477FF000 ) // 65520 and up round to infinity
+		return sign | 0x7C00;
+	else if( absBits >= 0x38800000 ) { // normal halves: rebias the exponent and round away 13 bits of mantissa
+		uint32_t result = ( absBits - 0x38000000 ) >> 13;
+		uint32_t remainder = absBits & 0x1FFF;
+		if( ( remainder > 0x1000 ) || ( ( remainder == 0x1000 ) && ( result & 1 ) ) )
+			++result; // a carry out of the mantissa correctly increments the exponent
+		return sign | (uint16_t)result;
+	}
+	else if( absBits > 0x33000000 ) { // subnormal halves, in units of 2^-24
+		uint32_t mantissa = ( absBits & 0x7FFFFF ) | 0x800000;
+		uint32_t shift = 126 - ( absBits >> 23 );
+		uint32_t result = mantissa >> shift;
+		uint32_t remainder = mantissa & ( ( 1u << shift ) - 1 ), halfway = 1u << ( shift - 1 );
+		if( ( remainder > halfway ) || ( ( remainder == halfway ) && ( result & 1 ) ) )
+			++result;
+		return sign | (uint16_t)result;
+	}
+	else // 2^-25 and below round to zero
+		return sign;
+}
+
+float halfToFloat( uint16_t value )
+{
+	uint32_t sign = (uint32_t)( value & 0x8000 ) << 16;
+	uint32_t exponent = ( value >> 10 ) & 0x1F, mantissa = value & 0x3FF;
+	uint32_t bits;
+	if( exponent == 0x1F ) // infinity, or NaN which is quieted
+		bits = sign | 0x7F800000 | ( mantissa << 13 ) | ( mantissa ? 0x400000 : 0 );
+	else if( exponent != 0 )
+		bits = sign | ( ( exponent + 112 ) << 23 ) | ( mantissa << 13 );
+	else if( mantissa == 0 )
+		bits = sign;
+	else { // subnormal halves are normal floats
+		exponent = 113;
+		while( ! ( mantissa & 0x400 ) ) {
+			mantissa <<= 1;
+			--exponent;
+		}
+		bits = sign | ( exponent << 23 ) | ( ( mantissa & 0x3FF ) << 13 );
+	}
+
+	float result;
+	memcpy( &result, &bits, sizeof(result) );
+	return result;
+}
+
+void floatToHalf( const float *src, uint16_t *dst, size_t count )
+{
+	size_t i = 0;
+#if defined( CINDER_IP_F16C )
+	if( useF16c() ) {
+		for( ; i + 8 <= count; i += 8 ) {
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( dst + i ), _mm_unpacklo_epi64( _mm_cvtps_ph( _mm_loadu_ps( src + i ), 0 ), _mm_cvtps_ph( _mm_loadu_ps( src + i + 4 ), 0 ) ) );
+		}
+	}
+#elif defined( CINDER_IP_NEON_FP16 )
+	if( useNeon() ) {
+		for( ; i + 4 <= count; i += 4 )
+			vst1_u16( dst + i, vreinterpret_u16_f16( vcvt_f16_f32( vld1q_f32( src + i ) ) ) );
+	}
+#endif
+	for( ; i < count; ++i )
+		dst[i] = floatToHalf( src[i] );
+}
+
+void halfToFloat( const uint16_t *src, float *dst, size_t count )
+{
+	size_t i = 0;
+#if defined( CINDER_IP_F16C )
+	if( useF16c() ) {
+		for( ; i + 8 <= count; i += 8 ) {
+			__m128i halves = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+			_mm_storeu_ps( dst + i, _mm_cvtph_ps( halves ) );
+			_mm_storeu_ps( dst + i + 4, _mm_cvtph_ps( _mm_unpackhi_epi64( halves, halves ) ) );
+		}
+	}
+#elif defined( CINDER_IP_NEON_FP16 )
+	if( useNeon() ) {
+		for( ; i + 4 <= count; i += 4 )
+			vst1q_f32( dst + i, vcvt_f32_f16( vreinterpret_f16_u16( vld1_u16( src + i ) ) ) );
+	}
+#endif
+	for( ; i < count; ++i )
+		dst[i] = halfToFloat( src[i] );
+}
+
+} } // namespace cinder::ip
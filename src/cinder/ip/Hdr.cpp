@@ -30,24 +30,11 @@ namespace cinder { namespace ip {
 
 void hdrNormalize( Surface32f *surface )
 {
-	// first take histogram to find the minimum and maximum values present
-	float minVal = *(surface->getDataRed( Vec2i::zero() )), maxVal = *(surface->getDataRed( Vec2i::zero() ));
-
-	const int8_t pixelInc = surface->getPixelInc();
-	const uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset();
-	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
-		const float *srcPtr = surface->getData( Vec2i( 0, y ) );
-		for( int32_t x = 0; x < surface->getWidth(); ++x ) {
-			minVal = std::min( minVal, srcPtr[redOffset] );
-			maxVal = std::max( maxVal, srcPtr[redOffset] );
-			minVal = std::min( minVal, srcPtr[greenOffset] );
-			maxVal = std::max( maxVal, srcPtr[greenOffset] );
-			minVal = std::min( minVal, srcPtr[blueOffset] );
-			maxVal = std::max( maxVal, srcPtr[blueOffset] );
-
-			srcPtr += pixelInc;
-		}
-	}
+	// first find the minimum and maximum values present
+	ColorAf minColor, maxColor;
+	getMinMax( *surface, &minColor, &maxColor );
+	const float minVal = std::min( std::min( minColor.r, minColor.g ), minColor.b );
+	const float maxVal = std::max( std::max( maxColor.r, maxColor.g ), maxColor.b );
 	
 	// if min==max then we should just fill with black
 	if( minVal == maxVal ) {
@@ -55,6 +42,9 @@ void hdrNormalize( Surface32f *surface )
 		return;
 	}
 	
+	surface->markDirty();
+	const int8_t pixelInc = surface->getPixelInc();
+	const uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset();
 	float scale = 1.0f / ( maxVal - minVal );
 	for( int32_t y = 0; y < surface->getHeight(); ++y ) {
 		float *dstPtr = surface->getData( Vec2i( 0, y ) );
@@ -89,18 +79,4 @@ void hdrNormalize( Channel32f *channel )
 	}
 }
 
-void getMinMax( const Channel32f &channel, float *resultMin, float *resultMax )
-{
-	float minVal = *(channel.getData( Vec2i::zero() )), maxVal = *(channel.getData( Vec2i::zero() ));
-	Channel32f::ConstIter iter = channel.getIter();
-	while( iter.line() ) {
-		while( iter.pixel() ) {
-			minVal = std::min( minVal, iter.v() );
-			maxVal = std::max( maxVal, iter.v() );
-		}
-	}
-	*resultMin = minVal;
-	*resultMax = maxVal;
-}
-
 } } // namespace cinder::ip
@@ -0,0 +1,90 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/IntegralImage.h"
+
+namespace cinder { namespace ip {
+
+template<typename T, typename SUMT>
+void calculateIntegralImage( const ChannelT<T> &channel, SUMT *integralImage )
+{
+	int32_t imageWidth = channel.getWidth(), imageHeight = channel.getHeight();
+	uint8_t srcInc = channel.getIncrement();
+	for( int32_t j = 0; j < imageHeight; j++ ) {
+		// reset this row sum
+		SUMT sum = 0;
+		const T *src = channel.getData( 0, j );
+		SUMT *dst = integralImage + j * imageWidth;
+		const SUMT *above = dst - imageWidth;
+
+		for( int32_t i = 0; i < imageWidth; i++ ) {
+			sum += src[i*srcInc];
+			if( j == 0 )
+				dst[i] = sum;
+			else
+				dst[i] = above[i] + sum;
+		}
+	}
+}
+
+template<typename T, typename SUMT>
+void updateIntegralImage( const ChannelT<T> &channel, SUMT *integralImage, const Area &dirtyArea )
+{
+	Area area = dirtyArea.getClipBy( channel.getBounds() );
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 )
+		return;
+
+	int32_t imageWidth = channel.getWidth(), imageHeight = channel.getHeight();
+	uint8_t srcInc = channel.getIncrement();
+	const int32_t x1 = area.getX1();
+	for( int32_t j = area.getY1(); j < imageHeight; j++ ) {
+		SUMT *dst = integralImage + j * imageWidth;
+		const SUMT *above = dst - imageWidth;
+		// the row sum left of x1 is unchanged and recoverable from the table itself
+		SUMT sum = 0;
+		if( x1 > 0 )
+			sum = ( j == 0 ) ? dst[x1 - 1] : ( dst[x1 - 1] - above[x1 - 1] );
+		const T *src = channel.getData( x1, j );
+
+		for( int32_t i = x1; i < imageWidth; i++ ) {
+			sum += *src;
+			src += srcInc;
+			if( j == 0 )
+				dst[i] = sum;
+			else
+				dst[i] = above[i] + sum;
+		}
+	}
+}
+
+#define integralImage_PROTOTYPES(T,SUMT)\
+	template void calculateIntegralImage( const ChannelT<T> &channel, SUMT *integralImage ); \
+	template void updateIntegralImage( const ChannelT<T> &channel, SUMT *integralImage, const Area &dirtyArea );
+
+integralImage_PROTOTYPES( uint8_t, uint32_t )
+integralImage_PROTOTYPES( uint16_t, uint64_t )
+integralImage_PROTOTYPES( float, float )
+integralImage_PROTOTYPES( float, double )
+
+} } // namespace cinder::ip
@@ -0,0 +1,435 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/ip/Pipeline.h"
+#include "cinder/ip/Resize.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/CinderMath.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace cinder { namespace ip {
+
+// Produces the rows of a stage for one band. The last \a window rows returned stay valid, and the point-wise stages fused
+// into the cursor are applied to each row as it is produced.
+template<typename T>
+class RowCursor {
+  public:
+	RowCursor( int32_t width, int32_t window )
+		: mWidth( width ), mWindow( std::max<int32_t>( 1, window ) ), mRows( std::max<int32_t>( 1, width ) * mWindow ), mRowIndices( mWindow, -1 ), mRowPtrs( mWindow, (const T*)0 )
+	{}
+	virtual ~RowCursor() {}
+
+	void	setPointStages( const std::vector<const PipelineStage<T>*> &pointStages ) { mPointStages = pointStages; }
+
+	const T*	getRow( int32_t y )
+	{
+		const int32_t slot = y % mWindow;
+		if( mRowIndices[slot] != y ) {
+			T *buffer = &mRows[slot * mWidth];
+			const T *row = produceRow( y, buffer );
+			// the first point-wise stage reads from wherever the row was produced, so even an unbuffered source row is only touched once
+			for( size_t s = 0; s < mPointStages.size(); ++s ) {
+				mPointStages[s]->applyRow( row, buffer, mWidth );
+				row = buffer;
+			}
+			mRowIndices[slot] = y;
+			mRowPtrs[slot] = row;
+		}
+		return mRowPtrs[slot];
+	}
+
+	// adapts getRow() for ResizerT::resizeRow()
+	static const T*	getRowFn( RowCursor<T> *cursor, int32_t y ) { return cursor->getRow( y ); }
+
+  protected:
+	//! Produces row \a y into \a buffer, or returns a pointer to it elsewhere when it is already in memory
+	virtual const T*	produceRow( int32_t y, T *buffer ) = 0;
+
+	int32_t									mWidth, mWindow;
+	std::vector<T>							mRows;
+	std::vector<int32_t>					mRowIndices;
+	std::vector<const T*>					mRowPtrs;
+	std::vector<const PipelineStage<T>*>	mPointStages;
+};
+
+// One node of a PipelineT. Stages are immutable once built and shared between PipelineTs, so one stage may be rendered by several threads at once.
+template<typename T>
+class PipelineStage {
+  public:
+	PipelineStage( const std::shared_ptr<PipelineStage<T> > &input, const Vec2i &size ) : mInput( input ), mSize( size ) {}
+	virtual ~PipelineStage() {}
+
+	const std::shared_ptr<PipelineStage<T> >&	getInput() const { return mInput; }
+	const Vec2i&								getSize() const { return mSize; }
+
+	//! Point-wise stages are fused into the cursor of the stage before them rather than getting a cursor of their own
+	virtual bool	isPointwise() const { return false; }
+	//! Applies a point-wise stage to \a width values of \a src, writing them to \a dst, which may equal \a src
+	virtual void	applyRow( const T * /*src*/, T * /*dst*/, int32_t /*width*/ ) const {}
+	//! Returns how many consecutive input rows the stage reads at once
+	virtual int32_t	getInputWindow() const { return 1; }
+	//! Creates the per band state which produces the stage's rows from \a input, keeping \a window rows valid at once
+	virtual RowCursor<T>*	createCursor( RowCursor<T> * /*input*/, int32_t /*window*/ ) const { return 0; }
+	//! Fills in the stage's type and parameters for PipelineT::getStages()
+	virtual void	describe( typename PipelineT<T>::StageDesc *desc ) const = 0;
+
+  protected:
+	std::shared_ptr<PipelineStage<T> >	mInput;
+	Vec2i								mSize;
+};
+
+namespace {
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ChannelSource
+template<typename T>
+class ChannelSourceCursor : public RowCursor<T> {
+  public:
+	ChannelSourceCursor( const ChannelT<T> *channel, int32_t window ) : RowCursor<T>( channel->getWidth(), window ), mChannel( channel ) {}
+
+  protected:
+	virtual const T*	produceRow( int32_t y, T *buffer )
+	{
+		const T *src = mChannel->getData( 0, y );
+		if( mChannel->isPlanar() )
+			return src;
+		const int8_t inc = mChannel->getIncrement();
+		for( int32_t x = 0; x < this->mWidth; ++x, src += inc )
+			buffer[x] = *src;
+		return buffer;
+	}
+
+	const ChannelT<T>	*mChannel;
+};
+
+template<typename T>
+class ChannelSource : public PipelineStage<T> {
+  public:
+	ChannelSource( const ChannelT<T> &channel ) : PipelineStage<T>( std::shared_ptr<PipelineStage<T> >(), channel.getSize() ), mChannel( channel ) {}
+
+	virtual RowCursor<T>*	createCursor( RowCursor<T> * /*input*/, int32_t window ) const { return new ChannelSourceCursor<T>( &mChannel, window ); }
+
+	virtual void			describe( typename PipelineT<T>::StageDesc *desc ) const { desc->mType = PipelineT<T>::StageDesc::CHANNEL; desc->mChannel = mChannel; }
+
+  protected:
+	ChannelT<T>		mChannel;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GrayscaleSource
+template<typename T>
+inline T grayscaleValue( T r, T g, T b )
+{
+	return CHANTRAIT<T>::grayscale( r, g, b );
+}
+
+// ip::grayscale() weighs 8 bit channels differently from CHANTRAIT<uint8_t>::grayscale()
+template<>
+inline uint8_t grayscaleValue<uint8_t>( uint8_t r, uint8_t g, uint8_t b )
+{
+	return static_cast<uint8_t>( ( r * 74 + g * 147 + b * 35 ) >> 8 );
+}
+
+template<typename T>
+class GrayscaleSourceCursor : public RowCursor<T> {
+  public:
+	GrayscaleSourceCursor( const SurfaceT<T> *surface, int32_t window ) : RowCursor<T>( surface->getWidth(), window ), mSurface( surface ) {}
+
+  protected:
+	virtual const T*	produceRow( int32_t y, T *buffer )
+	{
+		const int8_t pixelInc = mSurface->getPixelInc();
+		const uint8_t redOffset = mSurface->getRedOffset(), greenOffset = mSurface->getGreenOffset(), blueOffset = mSurface->getBlueOffset();
+		const T *src = mSurface->getData( Vec2i( 0, y ) );
+		for( int32_t x = 0; x < this->mWidth; ++x, src += pixelInc )
+			buffer[x] = grayscaleValue<T>( src[redOffset], src[greenOffset], src[blueOffset] );
+		return buffer;
+	}
+
+	const SurfaceT<T>	*mSurface;
+};
+
+template<typename T>
+class GrayscaleSource : public PipelineStage<T> {
+  public:
+	GrayscaleSource( const SurfaceT<T> &surface ) : PipelineStage<T>( std::shared_ptr<PipelineStage<T> >(), surface.getSize() ), mSurface( surface ) {}
+
+	virtual RowCursor<T>*	createCursor( RowCursor<T> * /*input*/, int32_t window ) const { return new GrayscaleSourceCursor<T>( &mSurface, window ); }
+
+	virtual void			describe( typename PipelineT<T>::StageDesc *desc ) const { desc->mType = PipelineT<T>::StageDesc::GRAYSCALE; desc->mSurface = mSurface; }
+
+  protected:
+	SurfaceT<T>		mSurface;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ResizeStage
+template<typename T>
+class ResizeCursor : public RowCursor<T> {
+  public:
+	ResizeCursor( const ResizerT<T> *resizer, RowCursor<T> *input, int32_t window )
+		: RowCursor<T>( resizer->getDstSize().x, window ), mResizer( resizer ), mCache( resizer->createRowCache() ),
+		mSrcRows( std::bind( &RowCursor<T>::getRowFn, input, std::_1 ) )
+	{}
+
+  protected:
+	virtual const T*	produceRow( int32_t y, T *buffer )
+	{
+		mResizer->resizeRow( y, mSrcRows, buffer, mCache.get() );
+		return buffer;
+	}
+
+	const ResizerT<T>						*mResizer;
+	std::shared_ptr<ResizeRowCache<T> >		mCache;
+	std::function<const T*(int32_t)>		mSrcRows;
+};
+
+template<typename T>
+class ResizeStage : public PipelineStage<T> {
+  public:
+	ResizeStage( const std::shared_ptr<PipelineStage<T> > &input, const Vec2i &size, const FilterBase &filter )
+		: PipelineStage<T>( input, size ), mResizer( input->getSize(), size, filter )
+	{}
+
+	virtual RowCursor<T>*	createCursor( RowCursor<T> *input, int32_t window ) const { return new ResizeCursor<T>( &mResizer, input, window ); }
+
+	virtual void			describe( typename PipelineT<T>::StageDesc *desc ) const { desc->mType = PipelineT<T>::StageDesc::RESIZE; }
+
+  protected:
+	ResizerT<T>		mResizer;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Point-wise stages
+template<typename T>
+class ThresholdStage : public PipelineStage<T> {
+  public:
+	ThresholdStage( const std::shared_ptr<PipelineStage<T> > &input, T value ) : PipelineStage<T>( input, input->getSize() ), mValue( value ) {}
+
+	virtual bool	isPointwise() const { return true; }
+	virtual void	applyRow( const T *src, T *dst, int32_t width ) const
+	{
+		const T maxValue = CHANTRAIT<T>::max();
+		for( int32_t x = 0; x < width; ++x )
+			dst[x] = ( src[x] > mValue ) ? maxValue : 0;
+	}
+
+	virtual void	describe( typename PipelineT<T>::StageDesc *desc ) const { desc->mType = PipelineT<T>::StageDesc::THRESHOLD; desc->mValue = mValue; }
+
+  protected:
+	T		mValue;
+};
+
+template<typename T>
+class InvertStage : public PipelineStage<T> {
+  public:
+	InvertStage( const std::shared_ptr<PipelineStage<T> > &input ) : PipelineStage<T>( input, input->getSize() ) {}
+
+	virtual bool	isPointwise() const { return true; }
+	virtual void	applyRow( const T *src, T *dst, int32_t width ) const
+	{
+		for( int32_t x = 0; x < width; ++x )
+			dst[x] = CHANTRAIT<T>::inverse( src[x] );
+	}
+	virtual void	describe( typename PipelineT<T>::StageDesc *desc ) const { desc->mType = PipelineT<T>::StageDesc::INVERT; }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// EdgeDetectSobelStage
+template<typename T>
+class EdgeDetectSobelCursor : public RowCursor<T> {
+  public:
+	EdgeDetectSobelCursor( RowCursor<T> *input, int32_t width, int32_t height, int32_t window )
+		: RowCursor<T>( width, window ), mInput( input ), mHeight( height )
+	{}
+
+  protected:
+	// the same arithmetic as ip::edgeDetectSobel(), so the interior matches it exactly
+	virtual const T*	produceRow( int32_t y, T *buffer )
+	{
+		const int32_t width = this->mWidth;
+		if( ( y == 0 ) || ( y >= mHeight - 1 ) || ( width < 3 ) ) {
+			std::fill( buffer, buffer + width, T( 0 ) );
+			return buffer;
+		}
+
+		const T *above = mInput->getRow( y - 1 ), *line = mInput->getRow( y ), *below = mInput->getRow( y + 1 );
+		const T maxValue = CHANTRAIT<T>::max();
+		typename CHANTRAIT<T>::Sum sumX, sumY;
+		buffer[0] = buffer[width - 1] = 0;
+		for( int32_t x = 1; x < width - 1; ++x ) {
+			sumX = -above[x-1] + above[x+1] - 2 * line[x-1] + 2 * line[x+1] - below[x-1] + below[x+1];
+			sumY = above[x-1] + 2 * above[x] + above[x+1] - below[x-1] - 2 * below[x] - below[x+1];
+			sumX = static_cast<typename CHANTRAIT<T>::Sum>( math<float>::sqrt( float( sumX * sumX + sumY * sumY ) ) );
+			if( sumX > maxValue ) sumX = maxValue;
+			buffer[x] = static_cast<T>( sumX );
+		}
+		return buffer;
+	}
+
+	RowCursor<T>	*mInput;
+	int32_t			mHeight;
+};
+
+template<typename T>
+class EdgeDetectSobelStage : public PipelineStage<T> {
+  public:
+	EdgeDetectSobelStage( const std::shared_ptr<PipelineStage<T> > &input ) : PipelineStage<T>( input, input->getSize() ) {}
+
+	virtual int32_t			getInputWindow() const { return 3; }
+	virtual RowCursor<T>*	createCursor( RowCursor<T> *input, int32_t window ) const { return new EdgeDetectSobelCursor<T>( input, this->mSize.x, this->mSize.y, window ); }
+	virtual void			describe( typename PipelineT<T>::StageDesc *desc ) const { desc->mType = PipelineT<T>::StageDesc::EDGE_DETECT_SOBEL; }
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// builds the cursors for \a stage and everything before it, returning the cursor of the last stage which isn't point-wise
+template<typename T>
+RowCursor<T>* buildCursors( const PipelineStage<T> *stage, int32_t window, std::vector<std::shared_ptr<RowCursor<T> > > *cursors )
+{
+	std::vector<const PipelineStage<T>*> pointStages;
+	while( stage->isPointwise() ) {
+		pointStages.push_back( stage );
+		stage = stage->getInput().get();
+	}
+	std::reverse( pointStages.begin(), pointStages.end() );
+
+	RowCursor<T> *input = stage->getInput() ? buildCursors( stage->getInput().get(), stage->getInputWindow(), cursors ) : 0;
+	std::shared_ptr<RowCursor<T> > cursor( stage->createCursor( input, window ) );
+	cursor->setPointStages( pointStages );
+	cursors->push_back( cursor );
+	return cursor.get();
+}
+
+template<typename T>
+void renderBand( const PipelineStage<T> *stage, ChannelT<T> *dstChannel, const Area &area )
+{
+	std::vector<std::shared_ptr<RowCursor<T> > > cursors;
+	RowCursor<T> *cursor = buildCursors( stage, 1, &cursors );
+
+	const int8_t dstInc = dstChannel->getIncrement();
+	const int32_t width = dstChannel->getWidth();
+	for( int32_t y = area.getY1(); y < area.getY2(); ++y ) {
+		const T *src = cursor->getRow( y );
+		T *dst = dstChannel->getData( 0, y );
+		if( dstInc == 1 )
+			memcpy( dst, src, width * sizeof(T) );
+		else {
+			for( int32_t x = 0; x < width; ++x, dst += dstInc )
+				*dst = src[x];
+		}
+	}
+}
+
+} // anonymous namespace
+
+template<typename T>
+PipelineT<T>::PipelineT( const ChannelT<T> &srcChannel )
+	: mStage( new ChannelSource<T>( srcChannel ) )
+{
+}
+
+template<typename T>
+PipelineT<T>::PipelineT( const SurfaceT<T> &srcSurface )
+	: mStage( new GrayscaleSource<T>( srcSurface ) )
+{
+}
+
+template<typename T>
+PipelineT<T> PipelineT<T>::resize( const Vec2i &size, const FilterBase &filter ) const
+{
+	return PipelineT<T>( std::shared_ptr<PipelineStage<T> >( new ResizeStage<T>( mStage, size, filter ) ) );
+}
+
+template<typename T>
+PipelineT<T> PipelineT<T>::threshold( T value ) const
+{
+	return PipelineT<T>( std::shared_ptr<PipelineStage<T> >( new ThresholdStage<T>( mStage, value ) ) );
+}
+
+template<typename T>
+PipelineT<T> PipelineT<T>::invert() const
+{
+	return PipelineT<T>( std::shared_ptr<PipelineStage<T> >( new InvertStage<T>( mStage ) ) );
+}
+
+template<typename T>
+PipelineT<T> PipelineT<T>::edgeDetectSobel() const
+{
+	return PipelineT<T>( std::shared_ptr<PipelineStage<T> >( new EdgeDetectSobelStage<T>( mStage ) ) );
+}
+
+template<typename T>
+Vec2i PipelineT<T>::getSize() const
+{
+	return mStage->getSize();
+}
+
+template<typename T>
+std::vector<typename PipelineT<T>::StageDesc> PipelineT<T>::getStages() const
+{
+	std::vector<StageDesc> result;
+	for( const PipelineStage<T> *stage = mStage.get(); stage; stage = stage->getInput().get() ) {
+		StageDesc desc;
+		desc.mSize = stage->getSize();
+		desc.mValue = 0;
+		stage->describe( &desc );
+		result.push_back( desc );
+	}
+	
+	std::reverse( result.begin(), result.end() );
+	return result;
+}
+
+template<typename T>
+ChannelT<T> PipelineT<T>::render( const ExecutionContextRef &context ) const
+{
+	ChannelT<T> result( mStage->getSize().x, mStage->getSize().y );
+	render( &result, context );
+	return result;
+}
+
+template<typename T>
+void PipelineT<T>::render( ChannelT<T> *dstChannel, const ExecutionContextRef &context ) const
+{
+	if( dstChannel->getSize() != mStage->getSize() )
+		throw PipelineExcSizeMismatch();
+
+	const Area area( Vec2i::zero(), mStage->getSize() );
+	void (*bandFn)( const PipelineStage<T>*, ChannelT<T>*, const Area& ) = &renderBand<T>;
+	if( context )
+		context->run( area, std::bind( bandFn, mStage.get(), dstChannel, std::_1 ) );
+	else if( ( area.getWidth() > 0 ) && ( area.getHeight() > 0 ) )
+		(*bandFn)( mStage.get(), dstChannel, area );
+}
+
+#define pipeline_PROTOTYPES(r,data,T)\
+	template class PipelineT<T>;
+
+BOOST_PP_SEQ_FOR_EACH( pipeline_PROTOTYPES, ~, CHANNEL_TYPES )
+
+} } // namespace cinder::ip
@@ -21,27 +21,218 @@
 */
 
 #include "cinder/ip/Premultiply.h"
+#include "cinder/ip/Simd.h"
 #include "cinder/ChanTraits.h"
 
+#include <cstring>
+
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#elif defined( CINDER_IP_NEON )
+	#include <arm_neon.h>
+#endif
+
 namespace cinder { namespace ip {
 
-// this is a candidate for sse2
-template<typename T>
-void premultiply( SurfaceT<T> *surface )
+namespace {
+
+// 255 / alpha for every 8 bit alpha; 1 for an alpha of 0, which leaves the pixel untouched like the scalar path
+struct UnpremultiplyTable {
+	UnpremultiplyTable()
+	{
+		mInvAlpha[0] = 1.0f;
+		for( int a = 1; a < 256; ++a )
+			mInvAlpha[a] = 255.0f / a;
+	}
+
+	float	mInvAlpha[256];
+};
+
+const UnpremultiplyTable sUnpremultiplyTable;
+// added before truncating so that c * 255 / a lands on the same integer as the scalar divide
+const float sUnpremultiplyBias = 0.001f;
+
+#if defined( CINDER_IP_SSE2 )
+// exact floor( t / 255 ) for 16 bit lanes with t <= 255 * 255
+inline __m128i div255_epu16( __m128i t )
 {
-	const Area clippedArea = surface->getBounds();
+	return _mm_srli_epi16( _mm_add_epi16( _mm_add_epi16( t, _mm_set1_epi16( 1 ) ), _mm_srli_epi16( t, 8 ) ), 8 );
+}
 
-	if( ! surface->hasAlpha() )
-		return;
+// Premultiplies 4 RGBA pixels per iteration; ALPHA is the byte offset of alpha within a pixel. Returns the number of pixels processed.
+template<int ALPHA>
+int32_t premultiplyRow_sse2( uint8_t *data, int32_t width )
+{
+	// multiply the color lanes by alpha and the alpha lane by 255, which leaves it unchanged
+	int16_t colorMaskWords[8], alphaLaneWords[8];
+	for( int i = 0; i < 8; ++i ) {
+		colorMaskWords[i] = ( i % 4 == ALPHA ) ? 0 : -1;
+		alphaLaneWords[i] = ( i % 4 == ALPHA ) ? 255 : 0;
+	}
+	const __m128i colorMask = _mm_loadu_si128( reinterpret_cast<const __m128i*>( colorMaskWords ) );
+	const __m128i alphaLane = _mm_loadu_si128( reinterpret_cast<const __m128i*>( alphaLaneWords ) );
+	const __m128i zero = _mm_setzero_si128();
 
-	surface->setPremultiplied( true );
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4, data += 16 ) {
+		__m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data ) );
+		__m128i lo = _mm_unpacklo_epi8( pixels, zero );
+		__m128i hi = _mm_unpackhi_epi8( pixels, zero );
+		__m128i alphaLo = _mm_shufflehi_epi16( _mm_shufflelo_epi16( lo, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) ), _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) );
+		__m128i alphaHi = _mm_shufflehi_epi16( _mm_shufflelo_epi16( hi, _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) ), _MM_SHUFFLE( ALPHA, ALPHA, ALPHA, ALPHA ) );
+		alphaLo = _mm_or_si128( _mm_and_si128( alphaLo, colorMask ), alphaLane );
+		alphaHi = _mm_or_si128( _mm_and_si128( alphaHi, colorMask ), alphaLane );
+		lo = div255_epu16( _mm_mullo_epi16( lo, alphaLo ) );
+		hi = div255_epu16( _mm_mullo_epi16( hi, alphaHi ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( data ), _mm_packus_epi16( lo, hi ) );
+	}
+
+	return x;
+}
+
+// Unpremultiplies 4 RGBA pixels per iteration in single precision float. Returns the number of pixels processed.
+int32_t unpremultiplyRow_sse2( uint8_t *data, int32_t width, uint8_t alphaOffset )
+{
+	float colorMaskFloats[4], alphaLaneFloats[4];
+	for( int i = 0; i < 4; ++i ) {
+		uint32_t mask = ( i == alphaOffset ) ? 0 : 0xFFFFFFFF;
+		memcpy( &colorMaskFloats[i], &mask, sizeof(float) );
+		alphaLaneFloats[i] = ( i == alphaOffset ) ? 1.0f : 0.0f;
+	}
+	const __m128 colorMask = _mm_loadu_ps( colorMaskFloats );
+	const __m128 alphaLane = _mm_loadu_ps( alphaLaneFloats );
+	const __m128 bias = _mm_set1_ps( sUnpremultiplyBias );
+	const __m128i zero = _mm_setzero_si128();
+
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4, data += 16 ) {
+		__m128i pixels = _mm_loadu_si128( reinterpret_cast<const __m128i*>( data ) );
+		__m128i lo = _mm_unpacklo_epi8( pixels, zero );
+		__m128i hi = _mm_unpackhi_epi8( pixels, zero );
+		__m128i words[4] = { _mm_unpacklo_epi16( lo, zero ), _mm_unpackhi_epi16( lo, zero ), _mm_unpacklo_epi16( hi, zero ), _mm_unpackhi_epi16( hi, zero ) };
+		for( int p = 0; p < 4; ++p ) {
+			__m128 invAlpha = _mm_or_ps( _mm_and_ps( _mm_set1_ps( sUnpremultiplyTable.mInvAlpha[data[p * 4 + alphaOffset]] ), colorMask ), alphaLane );
+			__m128 result = _mm_add_ps( _mm_mul_ps( _mm_cvtepi32_ps( words[p] ), invAlpha ), bias );
+			words[p] = _mm_cvttps_epi32( result );
+		}
+		// invalid pixels whose color exceeds alpha saturate to 255 here where the scalar path wraps
+		lo = _mm_packs_epi32( words[0], words[1] );
+		hi = _mm_packs_epi32( words[2], words[3] );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( data ), _mm_packus_epi16( lo, hi ) );
+	}
+
+	return x;
+}
+#elif defined( CINDER_IP_NEON )
+// exact floor( t / 255 ) for 16 bit lanes with t <= 255 * 255
+inline uint8x8_t div255_u16( uint16x8_t t )
+{
+	return vmovn_u16( vshrq_n_u16( vaddq_u16( vaddq_u16( t, vdupq_n_u16( 1 ) ), vshrq_n_u16( t, 8 ) ), 8 ) );
+}
+
+// Premultiplies 8 RGBA pixels per iteration. Returns the number of pixels processed.
+int32_t premultiplyRow_neon( uint8_t *data, int32_t width, uint8_t alphaOffset )
+{
+	int32_t x = 0;
+	for( ; x + 8 <= width; x += 8, data += 32 ) {
+		uint8x8x4_t pixels = vld4_u8( data );
+		uint8x8_t alpha = pixels.val[alphaOffset];
+		for( int c = 0; c < 4; ++c ) {
+			if( c != alphaOffset )
+				pixels.val[c] = div255_u16( vmull_u8( pixels.val[c], alpha ) );
+		}
+		vst4_u8( data, pixels );
+	}
+
+	return x;
+}
+
+// Unpremultiplies 8 RGBA pixels per iteration in single precision float. Returns the number of pixels processed.
+int32_t unpremultiplyRow_neon( uint8_t *data, int32_t width, uint8_t alphaOffset )
+{
+	const float32x4_t bias = vdupq_n_f32( sUnpremultiplyBias );
+	int32_t x = 0;
+	for( ; x + 8 <= width; x += 8, data += 32 ) {
+		float invAlpha[8];
+		for( int p = 0; p < 8; ++p )
+			invAlpha[p] = sUnpremultiplyTable.mInvAlpha[data[p * 4 + alphaOffset]];
+		float32x4_t invAlphaLo = vld1q_f32( invAlpha ), invAlphaHi = vld1q_f32( invAlpha + 4 );
 
+		uint8x8x4_t pixels = vld4_u8( data );
+		for( int c = 0; c < 4; ++c ) {
+			if( c == alphaOffset )
+				continue;
+			uint16x8_t color = vmovl_u8( pixels.val[c] );
+			float32x4_t lo = vmlaq_f32( bias, vcvtq_f32_u32( vmovl_u16( vget_low_u16( color ) ) ), invAlphaLo );
+			float32x4_t hi = vmlaq_f32( bias, vcvtq_f32_u32( vmovl_u16( vget_high_u16( color ) ) ), invAlphaHi );
+			pixels.val[c] = vqmovn_u16( vcombine_u16( vqmovn_u32( vcvtq_u32_f32( lo ) ), vqmovn_u32( vcvtq_u32_f32( hi ) ) ) );
+		}
+		vst4_u8( data, pixels );
+	}
+
+	return x;
+}
+#endif
+
+// Runs the SIMD premultiply over the start of a row when possible, returning the number of pixels handled
+inline int32_t premultiplyRowSimd( uint8_t *data, int32_t width, uint8_t pixelInc, uint8_t alphaOffset )
+{
+	if( pixelInc != 4 )
+		return 0;
+#if defined( CINDER_IP_SSE2 )
+	if( useSse2() ) {
+		switch( alphaOffset ) {
+			case 0: return premultiplyRow_sse2<0>( data, width );
+			case 1: return premultiplyRow_sse2<1>( data, width );
+			case 2: return premultiplyRow_sse2<2>( data, width );
+			case 3: return premultiplyRow_sse2<3>( data, width );
+		}
+	}
+#elif defined( CINDER_IP_NEON )
+	if( useNeon() )
+		return premultiplyRow_neon( data, width, alphaOffset );
+#endif
+	return 0;
+}
+
+inline int32_t premultiplyRowSimd( uint16_t * /*data*/, int32_t /*width*/, uint8_t /*pixelInc*/, uint8_t /*alphaOffset*/ )
+{
+	return 0;
+}
+
+inline int32_t premultiplyRowSimd( float * /*data*/, int32_t /*width*/, uint8_t /*pixelInc*/, uint8_t /*alphaOffset*/ )
+{
+	return 0;
+}
+
+// Runs the SIMD unpremultiply over the start of a row when possible, returning the number of pixels handled
+inline int32_t unpremultiplyRowSimd( uint8_t *data, int32_t width, uint8_t pixelInc, uint8_t alphaOffset )
+{
+	if( pixelInc != 4 )
+		return 0;
+#if defined( CINDER_IP_SSE2 )
+	if( useSse2() )
+		return unpremultiplyRow_sse2( data, width, alphaOffset );
+#elif defined( CINDER_IP_NEON )
+	if( useNeon() )
+		return unpremultiplyRow_neon( data, width, alphaOffset );
+#endif
+	return 0;
+}
+
+} // anonymous namespace
+
+template<typename T>
+void premultiplyImpl( SurfaceT<T> *surface, const Area &clippedArea )
+{
 	int32_t rowBytes = surface->getRowBytes();
 	uint8_t pixelInc = surface->getPixelInc();
 	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
 	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
 		T *dstPtr = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes );
-		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
+		int32_t x = premultiplyRowSimd( dstPtr, clippedArea.getWidth(), pixelInc, alphaOffset );
+		dstPtr += x * pixelInc;
+		for( ; x < clippedArea.getWidth(); ++x ) {
 			// The basic formula for unpremultiplication is to divide by the alpha
 			T alpha = dstPtr[alphaOffset];
 			
@@ -53,23 +244,16 @@ void premultiply( SurfaceT<T> *surface )
 	}
 }
 
-// this is a candidate for sse2
-template<>
-void unpremultiply<uint8_t>( SurfaceT<uint8_t> *surface )
+void unpremultiplyImpl( SurfaceT<uint8_t> *surface, const Area &clippedArea )
 {
-	const Area clippedArea = surface->getBounds();
-
-	if( ! surface->hasAlpha() )
-		return;
-
-	surface->setPremultiplied( false );
-
 	int32_t rowBytes = surface->getRowBytes();
 	uint8_t pixelInc = surface->getPixelInc();
 	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
 	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
 		uint8_t *dstPtr = reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes;
-		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
+		int32_t x = unpremultiplyRowSimd( dstPtr, clippedArea.getWidth(), pixelInc, alphaOffset );
+		dstPtr += x * pixelInc;
+		for( ; x < clippedArea.getWidth(); ++x ) {
 			// The basic formula for unpremultiplication is to divide by the alpha
 			// which in 8bit pixel arithmetic is to multiply by 255 and divide by the alpha
 			uint8_t alpha = dstPtr[alphaOffset];
@@ -83,16 +267,27 @@ void unpremultiply<uint8_t>( SurfaceT<uint8_t> *surface )
 	}	
 }
 
-template<>
-void unpremultiply<float>( SurfaceT<float> *surface )
+void unpremultiplyImpl( SurfaceT<uint16_t> *surface, const Area &clippedArea )
 {
-	const Area clippedArea = surface->getBounds();
-
-	if( ! surface->hasAlpha() )
-		return;
-
-	surface->setPremultiplied( false );
+	int32_t rowBytes = surface->getRowBytes();
+	uint8_t pixelInc = surface->getPixelInc();
+	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
+	for( int32_t y = clippedArea.getY1(); y < clippedArea.getY2(); ++y ) {
+		uint16_t *dstPtr = reinterpret_cast<uint16_t*>( reinterpret_cast<uint8_t*>( surface->getData() + clippedArea.getX1() * pixelInc ) + y * rowBytes );
+		for( int32_t x = 0; x < clippedArea.getWidth(); ++x ) {
+			uint32_t alpha = dstPtr[alphaOffset];
+			if( alpha ) {
+				dstPtr[redOffset] = (uint16_t)std::min<uint32_t>( dstPtr[redOffset] * 65535u / alpha, 65535 );
+				dstPtr[greenOffset] = (uint16_t)std::min<uint32_t>( dstPtr[greenOffset] * 65535u / alpha, 65535 );
+				dstPtr[blueOffset] = (uint16_t)std::min<uint32_t>( dstPtr[blueOffset] * 65535u / alpha, 65535 );
+			}
+			dstPtr += pixelInc;
+		}
+	}	
+}
 
+void unpremultiplyImpl( SurfaceT<float> *surface, const Area &clippedArea )
+{
 	int32_t rowBytes = surface->getRowBytes();
 	uint8_t pixelInc = surface->getPixelInc();
 	uint8_t redOffset = surface->getRedOffset(), greenOffset = surface->getGreenOffset(), blueOffset = surface->getBlueOffset(), alphaOffset = surface->getAlphaOffset();
@@ -111,12 +306,63 @@ void unpremultiply<float>( SurfaceT<float> *surface )
 	}	
 }
 
+template<typename T>
+void premultiply( SurfaceT<T> *surface )
+{
+	if( ! surface->hasAlpha() )
+		return;
+
+	surface->setPremultiplied( true );
+	surface->markDirty();
+	premultiplyImpl( surface, surface->getBounds() );
+}
+
+template<typename T>
+void unpremultiply( SurfaceT<T> *surface )
+{
+	if( ! surface->hasAlpha() )
+		return;
+
+	surface->setPremultiplied( false );
+	surface->markDirty();
+	unpremultiplyImpl( surface, surface->getBounds() );
+}
+
+template<typename T>
+void premultiply( SurfaceT<T> *surface, const ExecutionContextRef &context )
+{
+	if( ! surface->hasAlpha() )
+		return;
+
+	surface->setPremultiplied( true );
+	surface->markDirty();
+	context->run( surface->getBounds(), std::bind( &premultiplyImpl<T>, surface, std::_1 ) );
+}
+
+template<typename T>
+void unpremultiply( SurfaceT<T> *surface, const ExecutionContextRef &context )
+{
+	if( ! surface->hasAlpha() )
+		return;
 
+	surface->setPremultiplied( false );
+	surface->markDirty();
+	void (*bandFn)( SurfaceT<T>*, const Area& ) = &unpremultiplyImpl;
+	context->run( surface->getBounds(), std::bind( bandFn, surface, std::_1 ) );
+}
 
 #define premult_PROTOTYPES(r,data,T)\
-	template void premultiply( SurfaceT<T> *Surface );
+	template void premultiply( SurfaceT<T> *Surface ); \
+	template void premultiply( SurfaceT<T> *Surface, const ExecutionContextRef &context );
 
 BOOST_PP_SEQ_FOR_EACH( premult_PROTOTYPES, ~, CHANNEL_TYPES )
+
+template void unpremultiply( SurfaceT<uint8_t> *surface );
+template void unpremultiply( SurfaceT<uint16_t> *surface );
+template void unpremultiply( SurfaceT<float> *surface );
+template void unpremultiply( SurfaceT<uint8_t> *surface, const ExecutionContextRef &context );
+template void unpremultiply( SurfaceT<uint16_t> *surface, const ExecutionContextRef &context );
+template void unpremultiply( SurfaceT<float> *surface, const ExecutionContextRef &context );
 	
 
 } } // namespace cinder::ip
@@ -0,0 +1,307 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+
+#include "cinder/ip/Pyramid.h"
+#include "cinder/ip/Simd.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/Utilities.h"
+
+#include <algorithm>
+#include <vector>
+
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#endif
+
+namespace cinder { namespace ip {
+
+namespace {
+
+// The pixels of one level: mComponents values per pixel, mIncrement values apart. A non-planar source Channel has 1 component and an increment above 1.
+template<typename T>
+struct LevelLayout {
+	LevelLayout( const T *data, int32_t width, int32_t height, int32_t rowBytes, int32_t increment, int32_t components )
+		: mData( data ), mWidth( width ), mHeight( height ), mRowBytes( rowBytes ), mIncrement( increment ), mComponents( components )
+	{}
+
+	const T*	getRow( int32_t y ) const { return reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( mData ) + y * mRowBytes ); }
+	T*			getRow( int32_t y ) { return const_cast<T*>( reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( mData ) + y * mRowBytes ) ); }
+
+	const T		*mData;
+	int32_t		mWidth, mHeight, mRowBytes, mIncrement, mComponents;
+};
+
+inline uint8_t average4( uint8_t a0, uint8_t a1, uint8_t b0, uint8_t b1 ) { return ( a0 + a1 + b0 + b1 + 2 ) >> 2; }
+inline uint16_t average4( uint16_t a0, uint16_t a1, uint16_t b0, uint16_t b1 ) { return ( (uint32_t)a0 + a1 + b0 + b1 + 2 ) >> 2; }
+// the sums are ordered to match the SSE2 path exactly
+inline float average4( float a0, float a1, float b0, float b1 ) { return ( ( a0 + b0 ) + ( a1 + b1 ) ) * 0.25f; }
+
+// Reduces the leading pixels of a row of 1 or 4 interleaved components with SIMD and returns how many destination pixels were written; the caller writes the remainder
+template<typename T>
+int32_t boxRowSimd( const T * /*a*/, const T * /*b*/, T * /*dst*/, int32_t /*components*/, int32_t /*dstWidth*/ )
+{
+	return 0;
+}
+
+#if defined( CINDER_IP_SSE2 )
+template<>
+int32_t boxRowSimd<uint8_t>( const uint8_t *a, const uint8_t *b, uint8_t *dst, int32_t components, int32_t dstWidth )
+{
+	if( ! useSse2() )
+		return 0;
+
+	const __m128i zero = _mm_setzero_si128(), two16 = _mm_set1_epi16( 2 ), two32 = _mm_set1_epi32( 2 ), ones = _mm_set1_epi16( 1 );
+	int32_t x = 0;
+	if( components == 1 ) {
+		// 16 source columns become 8 destination columns; horizontal pairs are summed by pmaddwd
+		for( ; x + 8 <= dstWidth; x += 8, a += 16, b += 16, dst += 8 ) {
+			const __m128i rowA = _mm_loadu_si128( reinterpret_cast<const __m128i*>( a ) ), rowB = _mm_loadu_si128( reinterpret_cast<const __m128i*>( b ) );
+			const __m128i lo = _mm_add_epi16( _mm_unpacklo_epi8( rowA, zero ), _mm_unpacklo_epi8( rowB, zero ) );
+			const __m128i hi = _mm_add_epi16( _mm_unpackhi_epi8( rowA, zero ), _mm_unpackhi_epi8( rowB, zero ) );
+			const __m128i sumsLo = _mm_srli_epi32( _mm_add_epi32( _mm_madd_epi16( lo, ones ), two32 ), 2 );
+			const __m128i sumsHi = _mm_srli_epi32( _mm_add_epi32( _mm_madd_epi16( hi, ones ), two32 ), 2 );
+			_mm_storel_epi64( reinterpret_cast<__m128i*>( dst ), _mm_packus_epi16( _mm_packs_epi32( sumsLo, sumsHi ), zero ) );
+		}
+	}
+	else if( components == 4 ) {
+		// 4 source pixels become 2 destination pixels, each the sum of the two 64 bit halves of a register of 16 bit vertical sums
+		for( ; x + 2 <= dstWidth; x += 2, a += 16, b += 16, dst += 8 ) {
+			const __m128i rowA = _mm_loadu_si128( reinterpret_cast<const __m128i*>( a ) ), rowB = _mm_loadu_si128( reinterpret_cast<const __m128i*>( b ) );
+			const __m128i lo = _mm_add_epi16( _mm_unpacklo_epi8( rowA, zero ), _mm_unpacklo_epi8( rowB, zero ) );
+			const __m128i hi = _mm_add_epi16( _mm_unpackhi_epi8( rowA, zero ), _mm_unpackhi_epi8( rowB, zero ) );
+			__m128i sums = _mm_add_epi16( _mm_unpacklo_epi64( lo, hi ), _mm_unpackhi_epi64( lo, hi ) );
+			sums = _mm_srli_epi16( _mm_add_epi16( sums, two16 ), 2 );
+			_mm_storel_epi64( reinterpret_cast<__m128i*>( dst ), _mm_packus_epi16( sums, zero ) );
+		}
+	}
+	return x;
+}
+
+template<>
+int32_t boxRowSimd<float>( const float *a, const float *b, float *dst, int32_t components, int32_t dstWidth )
+{
+	if( ! useSse2() )
+		return 0;
+
+	const __m128 quarter = _mm_set1_ps( 0.25f );
+	int32_t x = 0;
+	if( components == 1 ) {
+		for( ; x + 4 <= dstWidth; x += 4, a += 8, b += 8, dst += 4 ) {
+			const __m128 sums0 = _mm_add_ps( _mm_loadu_ps( a ), _mm_loadu_ps( b ) ), sums1 = _mm_add_ps( _mm_loadu_ps( a + 4 ), _mm_loadu_ps( b + 4 ) );
+			const __m128 even = _mm_shuffle_ps( sums0, sums1, _MM_SHUFFLE( 2, 0, 2, 0 ) ), odd = _mm_shuffle_ps( sums0, sums1, _MM_SHUFFLE( 3, 1, 3, 1 ) );
+			_mm_storeu_ps( dst, _mm_mul_ps( _mm_add_ps( even, odd ), quarter ) );
+		}
+	}
+	else if( components == 4 ) {
+		for( ; x < dstWidth; ++x, a += 8, b += 8, dst += 4 ) {
+			const __m128 left = _mm_add_ps( _mm_loadu_ps( a ), _mm_loadu_ps( b ) ), right = _mm_add_ps( _mm_loadu_ps( a + 4 ), _mm_loadu_ps( b + 4 ) );
+			_mm_storeu_ps( dst, _mm_mul_ps( _mm_add_ps( left, right ), quarter ) );
+		}
+	}
+	return x;
+}
+#endif
+
+// Writes the rows of \a band of \a dst, each pixel the average of a 2x2 block of \a src. As the sizes round down, the last column or row of an odd
+// size is dropped, while a source only 1 pixel wide or high is averaged with itself.
+template<typename T>
+void reduceBox( const LevelLayout<T> *src, LevelLayout<T> *dst, const Area &band )
+{
+	const int32_t components = dst->mComponents, srcInc = src->mIncrement, dstInc = dst->mIncrement;
+	// SIMD needs every source pixel of the row, packed
+	const bool simd = ( srcInc == components ) && ( dstInc == components ) && ( src->mWidth >= dst->mWidth * 2 );
+	for( int32_t y = band.getY1(); y < band.getY2(); ++y ) {
+		const T *a = src->getRow( std::min( y * 2, src->mHeight - 1 ) ), *b = src->getRow( std::min( y * 2 + 1, src->mHeight - 1 ) );
+		T *dstRow = dst->getRow( y );
+		int32_t x = simd ? boxRowSimd( a, b, dstRow, components, dst->mWidth ) : 0;
+		for( ; x < dst->mWidth; ++x ) {
+			const int32_t x0 = x * 2 * srcInc, x1 = std::min( x * 2 + 1, src->mWidth - 1 ) * srcInc;
+			for( int32_t c = 0; c < components; ++c )
+				dstRow[x * dstInc + c] = average4( a[x0 + c], a[x1 + c], b[x0 + c], b[x1 + c] );
+		}
+	}
+}
+
+template<typename T> struct GaussianTrait { typedef int32_t SumT; static T normalize( int32_t sum ) { return static_cast<T>( ( sum + 32 ) >> 6 ); } };
+template<> struct GaussianTrait<float> { typedef float SumT; static float normalize( float sum ) { return sum * ( 1.0f / 64 ); } };
+
+// Writes the rows of \a band of \a dst, each pixel the ( 1 3 3 1 ) weighted sum of the 4x4 source pixels centered on its 2x2 block, clamped at the edges
+template<typename T>
+void reduceGaussian( const LevelLayout<T> *src, LevelLayout<T> *dst, const Area &band )
+{
+	typedef typename GaussianTrait<T>::SumT SumT;
+	const int32_t components = dst->mComponents, srcInc = src->mIncrement, dstInc = dst->mIncrement;
+	std::vector<SumT> column( src->mWidth * components );
+	for( int32_t y = band.getY1(); y < band.getY2(); ++y ) {
+		const T *rows[4];
+		for( int32_t r = 0; r < 4; ++r )
+			rows[r] = src->getRow( std::max( 0, std::min( y * 2 - 1 + r, src->mHeight - 1 ) ) );
+		// the vertical pass weights each source column once, then the horizontal pass reads the columns around each destination pixel
+		for( int32_t x = 0; x < src->mWidth; ++x ) {
+			for( int32_t c = 0; c < components; ++c ) {
+				const int32_t offset = x * srcInc + c;
+				column[x * components + c] = (SumT)rows[0][offset] + (SumT)rows[1][offset] * 3 + (SumT)rows[2][offset] * 3 + (SumT)rows[3][offset];
+			}
+		}
+
+		T *dstRow = dst->getRow( y );
+		for( int32_t x = 0; x < dst->mWidth; ++x ) {
+			const int32_t x0 = std::max( 0, x * 2 - 1 ) * components, x1 = std::min( x * 2, src->mWidth - 1 ) * components;
+			const int32_t x2 = std::min( x * 2 + 1, src->mWidth - 1 ) * components, x3 = std::min( x * 2 + 2, src->mWidth - 1 ) * components;
+			for( int32_t c = 0; c < components; ++c )
+				dstRow[x * dstInc + c] = GaussianTrait<T>::normalize( column[x0 + c] + column[x1 + c] * 3 + column[x2 + c] * 3 + column[x3 + c] );
+		}
+	}
+}
+
+template<typename T>
+void reduceLevel( const LevelLayout<T> &src, LevelLayout<T> *dst, PyramidFilter filter, const ExecutionContextRef &context )
+{
+	void (*bandFn)( const LevelLayout<T>*, LevelLayout<T>*, const Area& ) = ( filter == PYRAMID_GAUSSIAN ) ? &reduceGaussian<T> : &reduceBox<T>;
+	const Area area( 0, 0, dst->mWidth, dst->mHeight );
+	if( context )
+		context->run( area, std::bind( bandFn, &src, dst, std::_1 ) );
+	else
+		(*bandFn)( &src, dst, area );
+}
+
+// Each level holds one of these as its deallocator refcon, so the shared block is freed along with the last level
+void releaseLevel( void *refcon )
+{
+	delete reinterpret_cast<std::shared_ptr<void>*>( refcon );
+}
+
+// Allocates the levels after the first, each \a components values per pixel, and returns them in \a layouts. Level 0's layout is \a base.
+template<typename T>
+std::shared_ptr<void> allocateLevels( const LevelLayout<T> &base, int32_t maxLevels, std::vector<LevelLayout<T> > *layouts )
+{
+	int32_t numLevels = getNumPyramidLevels( Vec2i( base.mWidth, base.mHeight ) );
+	if( maxLevels > 0 )
+		numLevels = std::min( numLevels, maxLevels );
+
+	// every level starts on a 16 byte boundary
+	layouts->push_back( base );
+	size_t totalBytes = 0;
+	std::vector<size_t> offsets;
+	int32_t width = base.mWidth, height = base.mHeight;
+	for( int32_t level = 1; level < numLevels; ++level ) {
+		width = std::max( 1, width / 2 );
+		height = std::max( 1, height / 2 );
+		const int32_t rowBytes = width * base.mComponents * sizeof(T);
+		offsets.push_back( totalBytes );
+		layouts->push_back( LevelLayout<T>( 0, width, height, rowBytes, base.mComponents, base.mComponents ) );
+		totalBytes += ( rowBytes * height + 15 ) & ~15;
+	}
+
+	std::shared_ptr<void> block( totalBytes ? alignedMalloc( totalBytes, 16 ) : 0, alignedFree );
+	for( size_t level = 1; level < layouts->size(); ++level )
+		(*layouts)[level].mData = reinterpret_cast<const T*>( reinterpret_cast<uint8_t*>( block.get() ) + offsets[level - 1] );
+	return block;
+}
+
+template<typename T>
+std::vector<ChannelT<T> > buildPyramidImpl( const ChannelT<T> &channel, PyramidFilter filter, int32_t maxLevels, const ExecutionContextRef &context )
+{
+	std::vector<LevelLayout<T> > layouts;
+	std::shared_ptr<void> block = allocateLevels( LevelLayout<T>( channel.getData(), channel.getWidth(), channel.getHeight(), channel.getRowBytes(), channel.getIncrement(), 1 ), maxLevels, &layouts );
+
+	std::vector<ChannelT<T> > result;
+	result.push_back( channel );
+	for( size_t level = 1; level < layouts.size(); ++level ) {
+		reduceLevel( layouts[level - 1], &layouts[level], filter, context );
+		LevelLayout<T> &layout = layouts[level];
+		ChannelT<T> levelChannel( layout.mWidth, layout.mHeight, layout.mRowBytes, 1, layout.getRow( 0 ) );
+		levelChannel.setDeallocator( releaseLevel, new std::shared_ptr<void>( block ) );
+		result.push_back( levelChannel );
+	}
+
+	return result;
+}
+
+template<typename T>
+std::vector<SurfaceT<T> > buildPyramidImpl( const SurfaceT<T> &surface, PyramidFilter filter, int32_t maxLevels, const ExecutionContextRef &context )
+{
+	const int32_t pixelInc = surface.getPixelInc();
+	std::vector<LevelLayout<T> > layouts;
+	std::shared_ptr<void> block = allocateLevels( LevelLayout<T>( surface.getData(), surface.getWidth(), surface.getHeight(), surface.getRowBytes(), pixelInc, pixelInc ), maxLevels, &layouts );
+
+	std::vector<SurfaceT<T> > result;
+	result.push_back( surface );
+	for( size_t level = 1; level < layouts.size(); ++level ) {
+		reduceLevel( layouts[level - 1], &layouts[level], filter, context );
+		LevelLayout<T> &layout = layouts[level];
+		SurfaceT<T> levelSurface( layout.getRow( 0 ), layout.mWidth, layout.mHeight, layout.mRowBytes, surface.getChannelOrder() );
+		levelSurface.setPremultiplied( surface.isPremultiplied() );
+		levelSurface.setDeallocator( releaseLevel, new std::shared_ptr<void>( block ) );
+		result.push_back( levelSurface );
+	}
+
+	return result;
+}
+
+} // anonymous namespace
+
+int32_t getNumPyramidLevels( const Vec2i &size )
+{
+	int32_t numLevels = 1;
+	for( int32_t extent = std::max( size.x, size.y ); extent > 1; extent /= 2 )
+		++numLevels;
+	return numLevels;
+}
+
+template<typename T>
+std::vector<ChannelT<T> > buildPyramid( const ChannelT<T> &channel, PyramidFilter filter, int32_t maxLevels )
+{
+	return buildPyramidImpl( channel, filter, maxLevels, ExecutionContextRef() );
+}
+
+template<typename T>
+std::vector<ChannelT<T> > buildPyramid( const ChannelT<T> &channel, PyramidFilter filter, int32_t maxLevels, const ExecutionContextRef &context )
+{
+	return buildPyramidImpl( channel, filter, maxLevels, context );
+}
+
+template<typename T>
+std::vector<SurfaceT<T> > buildPyramid( const SurfaceT<T> &surface, PyramidFilter filter, int32_t maxLevels )
+{
+	return buildPyramidImpl( surface, filter, maxLevels, ExecutionContextRef() );
+}
+
+template<typename T>
+std::vector<SurfaceT<T> > buildPyramid( const SurfaceT<T> &surface, PyramidFilter filter, int32_t maxLevels, const ExecutionContextRef &context )
+{
+	return buildPyramidImpl( surface, filter, maxLevels, context );
+}
+
+#define pyramid_PROTOTYPES(r,data,T)\
+	template std::vector<ChannelT<T> > buildPyramid( const ChannelT<T> &channel, PyramidFilter filter, int32_t maxLevels ); \
+	template std::vector<ChannelT<T> > buildPyramid( const ChannelT<T> &channel, PyramidFilter filter, int32_t maxLevels, const ExecutionContextRef &context ); \
+	template std::vector<SurfaceT<T> > buildPyramid( const SurfaceT<T> &surface, PyramidFilter filter, int32_t maxLevels ); \
+	template std::vector<SurfaceT<T> > buildPyramid( const SurfaceT<T> &surface, PyramidFilter filter, int32_t maxLevels, const ExecutionContextRef &context );
+
+BOOST_PP_SEQ_FOR_EACH( pyramid_PROTOTYPES, ~, CHANNEL_TYPES )
+
+} } // namespace cinder::ip
@@ -25,6 +25,11 @@
 #include "cinder/Filter.h"
 #include "cinder/Rect.h"
 #include "cinder/ChanTraits.h"
+#include "cinder/ip/Simd.h"
+
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#endif
 
 #include <math.h>
 #include <vector>
@@ -68,6 +73,17 @@ struct SCALETRAIT<float> {
 
 const float SCALETRAIT<float>::WEIGHTONE = 1.0f;
 
+// 16 bit samples would overflow the 8 bit path's fixed point, so they're filtered in floating point and rounded at the end
+template<>
+struct SCALETRAIT<uint16_t> {
+	typedef float SUMT;
+	static const float WEIGHTONE;		// filter weight of one
+	static float ACCUMTOCHANNEL( const float in ) { return std::min( std::max( in + 0.5f, 0.0f ), 65535.0f ); }
+	static float CHANNELTOBUFFER( const float in ) { return in; }
+};
+
+const float SCALETRAIT<uint16_t>::WEIGHTONE = 1.0f;
+
 // the mapping from discrete dest coordinates b to continuous source coordinates:
 #define MAP(b, scale, offset)  (((b)+(offset))/(scale))
 
@@ -96,13 +112,9 @@ template<typename T, typename WT>
 void makeWeightTable( int32_t b, float cen, const FilterBase &filter, const FilterParams *params, int32_t len, bool trimzeros, WeightTable<WT> *wtab );
 
 template<typename AT, typename T>
-void scanlineShiftAccumToChannel( AT *accum, int32_t x1, int32_t y, int32_t width, ChannelT<T> *channel )
+void scanlineShiftAccumToRow( AT *accum, T *dst, int8_t pixelStride, int32_t width )
 {
 	AT result;
-	T *dst;
-
-	dst = channel->getData( x1, y );
-	int8_t pixelStride = channel->getIncrement();
 
 	for( int32_t i = 0; i < width; i++ ) {
 		result = SCALETRAIT<T>::ACCUMTOCHANNEL( *accum++ );
@@ -111,17 +123,20 @@ void scanlineShiftAccumToChannel( AT *accum, int32_t x1, int32_t y, int32_t widt
 	}
 }
 
+template<typename AT, typename T>
+void scanlineShiftAccumToChannel( AT *accum, int32_t x1, int32_t y, int32_t width, ChannelT<T> *channel )
+{
+	scanlineShiftAccumToRow( accum, channel->getData( x1, y ), channel->getIncrement(), width );
+}
+
 template<typename T, typename WT, typename AT>
-void scanlineFilterChannelToBuffer( WeightTable<WT> *weights, int32_t x, int32_t y, const ChannelT<T> &channel, AT *lineBuffer, int32_t width )
+void scanlineFilterRowToBuffer( WeightTable<WT> *weights, const T *srcLine, int8_t pixelStride, AT *lineBuffer, int32_t width )
 {
 	int32_t b, af;
 	AT sum;
 	AT *wp;
-	const T *srcLine, *src;
-
-	srcLine = channel.getData( x, y );
+	const T *src;
 
-	int8_t pixelStride = channel.getIncrement();
 	for ( b = 0; b < width; b++ ) {
 		if( std::numeric_limits<AT>::is_integer )
 			sum = 1 << 7;
@@ -138,26 +153,46 @@ void scanlineFilterChannelToBuffer( WeightTable<WT> *weights, int32_t x, int32_t
 	}	
 }
 
-// assumes channels are of same dimensions
+template<typename T, typename WT, typename AT>
+void scanlineFilterChannelToBuffer( WeightTable<WT> *weights, int32_t x, int32_t y, const ChannelT<T> &channel, AT *lineBuffer, int32_t width )
+{
+	scanlineFilterRowToBuffer( weights, channel.getData( x, y ), channel.getIncrement(), lineBuffer, width );
+}
+
+// The source to destination mapping and the horizontal and vertical filter weights shared by every destination row
+template<typename T>
+struct ResampleParams {
+	typedef typename SCALETRAIT<T>::SUMT SUMT;
+
+	ResampleParams( const Area &srcBounds, const Area &srcArea, const Area &dstBounds, const Area &dstArea, const FilterBase &filter );
+	~ResampleParams();
+
+	bool isEmpty() const { return ( srcWidth <= 0 ) || ( dstWidth <= 0 ) || ( srcHeight <= 0 ) || ( dstHeight <= 0 ); }
+
+	Rectf				clippedSrcRect;
+	Area				clippedDstArea;
+	FilterParams		filterParamsX, filterParamsY;
+	Mapping				m;
+	int32_t				dstWidth, dstHeight, srcWidth, srcHeight;
+	int32_t				srcOffsetX, srcOffsetY;
+	WeightTable<SUMT>	*xWeights, *yWeights;
+	SUMT				*xWeightBuffer, *yWeightBuffer;
+	// whether every weight and every horizontally filtered value fits in 16 bits, as the SSE2 fixed point paths require
+	bool				fitsInt16;
+};
+
 template<typename T>
-void resample( const vector<const ChannelT<T>*> &srcChannels, const FilterBase &filter, const Area &srcArea, const Area &dstArea, const vector<ChannelT<T>*> &dstChannels )
+ResampleParams<T>::ResampleParams( const Area &srcBounds, const Area &srcArea, const Area &dstBounds, const Area &dstArea, const FilterBase &aFilter )
+	: xWeights( 0 ), yWeights( 0 ), xWeightBuffer( 0 ), yWeightBuffer( 0 ), fitsInt16( false )
 {
-	Rectf clippedSrcRect;
-	Area clippedDstArea;
-	getClippedScaledRects( srcChannels[0]->getBounds(), Rectf( srcArea ), dstChannels[0]->getBounds(), dstArea, &clippedSrcRect, &clippedDstArea );
-	
-	if ( ( clippedSrcRect.getWidth() <= 0 ) || ( clippedDstArea.getWidth() <= 0 ) 
-		|| ( clippedSrcRect.getHeight() <= 0 ) || ( clippedDstArea.getHeight() <= 0 ) )
+	getClippedScaledRects( srcBounds, Rectf( srcArea ), dstBounds, dstArea, &clippedSrcRect, &clippedDstArea );
+	dstWidth = (int32_t)clippedDstArea.getWidth(); dstHeight = (int32_t)clippedDstArea.getHeight();
+	srcWidth = (int32_t)clippedSrcRect.getWidth(); srcHeight = (int32_t)clippedSrcRect.getHeight();
+	srcOffsetX = static_cast<int32_t>( floor( clippedSrcRect.getX1() ) );
+	srcOffsetY = static_cast<int32_t>( floor( clippedSrcRect.getY1() ) );
+
+	if( isEmpty() )
 		return;
-	
-	FilterParams filterParamsX, filterParamsY;
-	Mapping m;
-	std::shared_ptr<typename SCALETRAIT<T>::SUMT> accum;
-	int32_t dstWidth = (int32_t)clippedDstArea.getWidth(), dstHeight = (int32_t)clippedDstArea.getHeight();
-	int32_t srcWidth = (int32_t)clippedSrcRect.getWidth(), srcHeight = (int32_t)clippedSrcRect.getHeight();
-	int32_t srcOffsetX = static_cast<int32_t>( floor( clippedSrcRect.getX1() ) );
-	int32_t srcOffsetY = static_cast<int32_t>( floor( clippedSrcRect.getY1() ) );
-	vector<pair<int32_t,std::shared_ptr<typename SCALETRAIT<T>::SUMT> > > linesBuffer;
 
 	m.sx = dstWidth / (float)srcWidth;
 	m.sy = dstHeight / (float)srcHeight;
@@ -167,53 +202,262 @@ void resample( const vector<const ChannelT<T>*> &srcChannels, const FilterBase &
 	m.uy = clippedDstArea.getY1() - m.sy * ( clippedSrcRect.getY1()- 0.5f ) - m.ty;
 
 	filterParamsX.scale = std::max( 1.0f, 1.0f / m.sx );
-	filterParamsX.supp = std::max( 0.5f, filterParamsX.scale * filter.getSupport() );
+	filterParamsX.supp = std::max( 0.5f, filterParamsX.scale * aFilter.getSupport() );
 	filterParamsX.width = (int32_t)ceil( 2.0f * filterParamsX.supp );
 
 	filterParamsY.scale = std::max( 1.0f, 1.0f / m.sy );
-	filterParamsY.supp = std::max( 0.5f, filterParamsY.scale * filter.getSupport() );
+	filterParamsY.supp = std::max( 0.5f, filterParamsY.scale * aFilter.getSupport() );
 	filterParamsY.width = (int32_t)ceil( 2.0f * filterParamsY.supp );
 
-	for( int32_t i = 0; i < filterParamsY.width; i++ )
-		linesBuffer.push_back( std::make_pair( -1, std::shared_ptr<typename SCALETRAIT<T>::SUMT>( new typename SCALETRAIT<T>::SUMT[dstWidth], checked_array_deleter<typename SCALETRAIT<T>::SUMT>() ) ) );
+	xWeights = (WeightTable<SUMT>*)malloc( sizeof(WeightTable<SUMT>) * dstWidth );
+	xWeightBuffer = (SUMT*)malloc( sizeof(SUMT) * dstWidth * filterParamsX.width );
 
-	WeightTable<typename SCALETRAIT<T>::SUMT> *xWeights, yWeights;
-	typename SCALETRAIT<T>::SUMT *xWeightBuffer, *xWeightPtr;
-	xWeights = (WeightTable<typename SCALETRAIT<T>::SUMT>*)malloc( sizeof(WeightTable<int32_t>) * dstWidth );
-	xWeightBuffer = (typename SCALETRAIT<T>::SUMT*)malloc( sizeof(typename SCALETRAIT<T>::SUMT) * dstWidth * filterParamsX.width );
-	yWeights.weight = (typename SCALETRAIT<T>::SUMT*)malloc( sizeof(typename SCALETRAIT<T>::SUMT) * filterParamsY.width );
-	accum = std::shared_ptr<typename SCALETRAIT<T>::SUMT>( new typename SCALETRAIT<T>::SUMT[dstWidth], checked_array_deleter<typename SCALETRAIT<T>::SUMT>() );
-
-	xWeightPtr = xWeightBuffer;
+	SUMT *xWeightPtr = xWeightBuffer;
 	for ( int32_t bx = 0; bx < dstWidth; bx++, xWeightPtr += filterParamsX.width ) {
 		xWeights[bx].weight = xWeightPtr;
-		makeWeightTable<T,typename SCALETRAIT<T>::SUMT>( bx, MAP(bx, m.sx, m.ux), filter, &filterParamsX, srcWidth, true, &xWeights[bx] );
+		makeWeightTable<T,SUMT>( bx, MAP(bx, m.sx, m.ux), aFilter, &filterParamsX, srcWidth, true, &xWeights[bx] );
+	}
+
+	yWeights = (WeightTable<SUMT>*)malloc( sizeof(WeightTable<SUMT>) * dstHeight );
+	yWeightBuffer = (SUMT*)malloc( sizeof(SUMT) * dstHeight * filterParamsY.width );
+
+	SUMT *yWeightPtr = yWeightBuffer;
+	for ( int32_t by = 0; by < dstHeight; by++, yWeightPtr += filterParamsY.width ) {
+		yWeights[by].weight = yWeightPtr;
+		makeWeightTable<T,SUMT>( by, MAP(by, m.sy, m.uy), aFilter, &filterParamsY, srcHeight, false, &yWeights[by] );
+	}
+
+	if( std::numeric_limits<SUMT>::is_integer ) {
+		fitsInt16 = true;
+		for( int32_t bx = 0; bx < dstWidth; ++bx ) {
+			SUMT absSum = 0;
+			for( int32_t i = 0; i < xWeights[bx].end - xWeights[bx].start; ++i ) {
+				SUMT w = xWeights[bx].weight[i];
+				fitsInt16 = fitsInt16 && ( w >= -32768 ) && ( w <= 32767 );
+				absSum += ( w < 0 ) ? -w : w;
+			}
+			// the largest magnitude the horizontal pass can produce for 8 bit input after CHANNELTOBUFFER
+			fitsInt16 = fitsInt16 && ( absSum * 255 / 256 + 1 <= 32767 );
+		}
+		for( int32_t by = 0; by < dstHeight; ++by ) {
+			for( int32_t i = 0; i < yWeights[by].end - yWeights[by].start; ++i )
+				fitsInt16 = fitsInt16 && ( yWeights[by].weight[i] >= -32768 ) && ( yWeights[by].weight[i] <= 32767 );
+		}
 	}
+}
+
+template<typename T>
+ResampleParams<T>::~ResampleParams()
+{
+	free( xWeights );
+	free( xWeightBuffer );
+	free( yWeights );
+	free( yWeightBuffer );
+}
+
+// resamples the destination rows [rows.y1,rows.y2) relative to params->clippedDstArea. Safe to call concurrently for disjoint rows.
+template<typename T>
+void resampleRows( const ResampleParams<T> *params, const vector<const ChannelT<T>*> *srcChannels, const vector<ChannelT<T>*> *dstChannels, const Area &rows )
+{
+	typedef typename SCALETRAIT<T>::SUMT SUMT;
+	const int32_t dstWidth = params->dstWidth;
+	const int32_t lineBufferCount = params->filterParamsY.width;
 
-	for( size_t chan = 0; chan < srcChannels.size(); ++chan ) {
-		for ( int32_t dstY = 0; dstY < dstHeight; ++dstY ) {     // loop over dest scanlines
-			// prepare a weight table for dest y position by
-			makeWeightTable<T,typename SCALETRAIT<T>::SUMT>( dstY, MAP(dstY, m.sy, m.uy), filter, &filterParamsY, srcHeight, false, &yWeights );
+	vector<pair<int32_t,std::shared_ptr<SUMT> > > linesBuffer;
+	for( int32_t i = 0; i < lineBufferCount; i++ )
+		linesBuffer.push_back( std::make_pair( -1, std::shared_ptr<SUMT>( new SUMT[dstWidth], checked_array_deleter<SUMT>() ) ) );
 
-			memset( accum.get(), 0, sizeof(int32_t) * dstWidth );
+	std::shared_ptr<SUMT> accum( new SUMT[dstWidth], checked_array_deleter<SUMT>() );
+
+	for( size_t chan = 0; chan < srcChannels->size(); ++chan ) {
+		for( int32_t i = 0; i < lineBufferCount; i++ )
+			linesBuffer[i].first = -1;
+		for ( int32_t dstY = rows.getY1(); dstY < rows.getY2(); ++dstY ) {     // loop over dest scanlines
+			const WeightTable<SUMT> &yWeights = params->yWeights[dstY];
+			memset( accum.get(), 0, sizeof(SUMT) * dstWidth );
 
 			// loop over source scanlines that influence this dest scanline
 			for ( int32_t ayf = yWeights.start; ayf < yWeights.end; ayf++ ) {
-				typename SCALETRAIT<T>::SUMT *line = linesBuffer[ayf % filterParamsY.width].second.get();
-				if( linesBuffer[ayf % filterParamsY.width].first != ayf ) {
-					scanlineFilterChannelToBuffer( xWeights, srcOffsetX, srcOffsetY + ayf, *(srcChannels[chan]), line, dstWidth );
-					linesBuffer[ayf % filterParamsY.width].first = ayf;
+				SUMT *line = linesBuffer[ayf % lineBufferCount].second.get();
+				if( linesBuffer[ayf % lineBufferCount].first != ayf ) {
+					scanlineFilterChannelToBuffer( params->xWeights, params->srcOffsetX, params->srcOffsetY + ayf, *((*srcChannels)[chan]), line, dstWidth );
+					linesBuffer[ayf % lineBufferCount].first = ayf;
 				}
-				scanlineAccumulate<typename SCALETRAIT<T>::SUMT,typename SCALETRAIT<T>::SUMT>( yWeights.weight[ayf - yWeights.start], line, dstWidth, accum.get() );
+				scanlineAccumulate<SUMT,SUMT>( yWeights.weight[ayf - yWeights.start], line, dstWidth, accum.get() );
 			}
 
-			scanlineShiftAccumToChannel( accum.get(), clippedDstArea.getX1(), clippedDstArea.getY1() + dstY, dstWidth, dstChannels[chan] );
+			scanlineShiftAccumToChannel( accum.get(), params->clippedDstArea.getX1(), params->clippedDstArea.getY1() + dstY, dstWidth, (*dstChannels)[chan] );
 		}
 	}
+}
 
-	free( xWeights );
-	free( xWeightBuffer );
-	free( yWeights.weight );
+// horizontally filters one source row of interleaved PIXELINC channel pixels into lineBuffer
+template<typename T, int PIXELINC>
+void scanlineFilterInterleavedToBuffer( const ResampleParams<T> *params, const T *srcLine, typename SCALETRAIT<T>::SUMT *lineBuffer )
+{
+	typedef typename SCALETRAIT<T>::SUMT SUMT;
+	const SUMT sumInit = ( std::numeric_limits<SUMT>::is_integer ) ? ( 1 << 7 ) : 0;
+	const WeightTable<SUMT> *xWeights = params->xWeights;
+	SUMT sum[PIXELINC];
+	for( int32_t b = 0; b < params->dstWidth; ++b, ++xWeights ) {
+		for( int c = 0; c < PIXELINC; ++c )
+			sum[c] = sumInit;
+		const T *src = srcLine + xWeights->start * PIXELINC;
+		const SUMT *wp = xWeights->weight;
+		for( int32_t af = xWeights->start; af < xWeights->end; ++af, src += PIXELINC ) {
+			const SUMT w = *wp++;
+			for( int c = 0; c < PIXELINC; ++c )
+				sum[c] += w * src[c];
+		}
+		for( int c = 0; c < PIXELINC; ++c )
+			*lineBuffer++ = SCALETRAIT<T>::CHANNELTOBUFFER( sum[c] );
+	}
+}
+
+#if defined( CINDER_IP_SSE2 )
+// SSE2 version of scanlineFilterInterleavedToBuffer for 4 channel 8 bit pixels, two filter taps per _mm_madd_epi16
+void scanlineFilterInterleavedToBuffer_sse2( const ResampleParams<uint8_t> *params, const uint8_t *srcLine, int32_t *lineBuffer )
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i sumInit = _mm_set1_epi32( 1 << 7 );
+	const WeightTable<int32_t> *xWeights = params->xWeights;
+	for( int32_t b = 0; b < params->dstWidth; ++b, ++xWeights, lineBuffer += 4 ) {
+		__m128i sum = sumInit;
+		const uint8_t *src = srcLine + xWeights->start * 4;
+		const int32_t *wp = xWeights->weight;
+		int32_t af = xWeights->start;
+		for( ; af + 2 <= xWeights->end; af += 2, src += 8, wp += 2 ) {
+			// interleave the channels of two pixels as c0 c0' c1 c1' ... to pair them with weights w w'
+			__m128i pixels = _mm_unpacklo_epi8( _mm_loadl_epi64( reinterpret_cast<const __m128i*>( src ) ), zero );
+			__m128i pairs = _mm_unpacklo_epi16( pixels, _mm_srli_si128( pixels, 8 ) );
+			__m128i weights = _mm_set1_epi32( static_cast<int32_t>( ( static_cast<uint32_t>( wp[0] ) & 0xFFFF ) | ( static_cast<uint32_t>( wp[1] ) << 16 ) ) );
+			sum = _mm_add_epi32( sum, _mm_madd_epi16( pairs, weights ) );
+		}
+		if( af < xWeights->end ) {
+			int32_t pixel;
+			memcpy( &pixel, src, 4 );
+			__m128i channels = _mm_unpacklo_epi16( _mm_unpacklo_epi8( _mm_cvtsi32_si128( pixel ), zero ), zero );
+			sum = _mm_add_epi32( sum, _mm_madd_epi16( channels, _mm_set1_epi32( wp[0] & 0xFFFF ) ) );
+		}
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( lineBuffer ), _mm_srai_epi32( sum, 8 ) );
+	}
+}
+
+// SSE2 version of scanlineAccumulate; each 32 bit line value must fit in 16 bits, so its high half is a sign extension that _mm_madd_epi16 multiplies by 0
+void scanlineAccumulate_sse2( int32_t weight, const int32_t *lineBuffer, int32_t width, int32_t *accum )
+{
+	const __m128i weights = _mm_set1_epi32( weight & 0xFFFF );
+	int32_t x = 0;
+	for( ; x + 4 <= width; x += 4 ) {
+		__m128i line = _mm_loadu_si128( reinterpret_cast<const __m128i*>( lineBuffer + x ) );
+		__m128i sum = _mm_loadu_si128( reinterpret_cast<const __m128i*>( accum + x ) );
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( accum + x ), _mm_add_epi32( sum, _mm_madd_epi16( line, weights ) ) );
+	}
+	for( ; x < width; ++x )
+		accum[x] += lineBuffer[x] * weight;
+}
+#endif
+
+// selects the fastest available implementations of the interleaved horizontal and vertical passes
+template<typename T, int PIXELINC>
+struct InterleavedPasses {
+	typedef typename SCALETRAIT<T>::SUMT SUMT;
+	static void filter( const ResampleParams<T> *params, const T *srcLine, SUMT *lineBuffer ) { scanlineFilterInterleavedToBuffer<T,PIXELINC>( params, srcLine, lineBuffer ); }
+	static void accumulate( const ResampleParams<T> * /*params*/, SUMT weight, const SUMT *lineBuffer, int32_t width, SUMT *accum ) { scanlineAccumulate<SUMT,SUMT>( weight, const_cast<SUMT*>( lineBuffer ), width, accum ); }
+};
+
+#if defined( CINDER_IP_SSE2 )
+template<>
+struct InterleavedPasses<uint8_t,4> {
+	static void filter( const ResampleParams<uint8_t> *params, const uint8_t *srcLine, int32_t *lineBuffer )
+	{
+		if( params->fitsInt16 && useSse2() )
+			scanlineFilterInterleavedToBuffer_sse2( params, srcLine, lineBuffer );
+		else
+			scanlineFilterInterleavedToBuffer<uint8_t,4>( params, srcLine, lineBuffer );
+	}
+
+	static void accumulate( const ResampleParams<uint8_t> *params, int32_t weight, const int32_t *lineBuffer, int32_t width, int32_t *accum )
+	{
+		if( params->fitsInt16 && useSse2() )
+			scanlineAccumulate_sse2( weight, lineBuffer, width, accum );
+		else
+			scanlineAccumulate<int32_t,int32_t>( weight, const_cast<int32_t*>( lineBuffer ), width, accum );
+	}
+};
+#endif
+
+// resamples the destination rows [rows.y1,rows.y2) of every interleaved channel of a pair of Surfaces sharing a channel layout at once,
+// which reads each source pixel a single time rather than once per channel. Safe to call concurrently for disjoint rows.
+template<typename T, int PIXELINC>
+void resampleRowsInterleaved( const ResampleParams<T> *params, const SurfaceT<T> *srcSurface, SurfaceT<T> *dstSurface, const Area &rows )
+{
+	typedef typename SCALETRAIT<T>::SUMT SUMT;
+	const int32_t dstWidth = params->dstWidth;
+	const int32_t lineBufferCount = params->filterParamsY.width;
+	const int32_t lineWidth = dstWidth * PIXELINC;
+
+	vector<pair<int32_t,std::shared_ptr<SUMT> > > linesBuffer;
+	for( int32_t i = 0; i < lineBufferCount; i++ )
+		linesBuffer.push_back( std::make_pair( -1, std::shared_ptr<SUMT>( new SUMT[lineWidth], checked_array_deleter<SUMT>() ) ) );
+
+	std::shared_ptr<SUMT> accum( new SUMT[lineWidth], checked_array_deleter<SUMT>() );
+
+	for ( int32_t dstY = rows.getY1(); dstY < rows.getY2(); ++dstY ) {
+		const WeightTable<SUMT> &yWeights = params->yWeights[dstY];
+		memset( accum.get(), 0, sizeof(SUMT) * lineWidth );
+
+		for ( int32_t ayf = yWeights.start; ayf < yWeights.end; ayf++ ) {
+			SUMT *line = linesBuffer[ayf % lineBufferCount].second.get();
+			if( linesBuffer[ayf % lineBufferCount].first != ayf ) {
+				InterleavedPasses<T,PIXELINC>::filter( params, srcSurface->getData( Vec2i( params->srcOffsetX, params->srcOffsetY + ayf ) ), line );
+				linesBuffer[ayf % lineBufferCount].first = ayf;
+			}
+			InterleavedPasses<T,PIXELINC>::accumulate( params, yWeights.weight[ayf - yWeights.start], line, lineWidth, accum.get() );
+		}
+
+		T *dst = dstSurface->getData( Vec2i( params->clippedDstArea.getX1(), params->clippedDstArea.getY1() + dstY ) );
+		const SUMT *acc = accum.get();
+		for( int32_t i = 0; i < lineWidth; ++i )
+			dst[i] = static_cast<T>( SCALETRAIT<T>::ACCUMTOCHANNEL( acc[i] ) );
+	}
+}
+
+template<typename T>
+void resample( const ResampleParams<T> &params, const vector<const ChannelT<T>*> &srcChannels, const vector<ChannelT<T>*> &dstChannels, const ExecutionContextRef &context )
+{
+	if( params.isEmpty() )
+		return;
+
+	Area rows( 0, 0, params.dstWidth, params.dstHeight );
+	if( context )
+		context->run( rows, std::bind( &resampleRows<T>, &params, &srcChannels, &dstChannels, std::_1 ) );
+	else
+		resampleRows( &params, &srcChannels, &dstChannels, rows );
+}
+
+// assumes channels are of same dimensions
+template<typename T>
+void resample( const vector<const ChannelT<T>*> &srcChannels, const FilterBase &filter, const Area &srcArea, const Area &dstArea, const vector<ChannelT<T>*> &dstChannels, const ExecutionContextRef &context = ExecutionContextRef() )
+{
+	ResampleParams<T> params( srcChannels[0]->getBounds(), srcArea, dstChannels[0]->getBounds(), dstArea, filter );
+	resample( params, srcChannels, dstChannels, context );
+}
+
+// collects the color channels of a pair of Surfaces, plus alpha when both have it
+template<typename T>
+void getResampleChannels( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, vector<const ChannelT<T>*> *srcChannels, vector<ChannelT<T>*> *dstChannels )
+{
+	srcChannels->push_back( &srcSurface.getChannelRed() );
+	dstChannels->push_back( &dstSurface->getChannelRed() );
+	srcChannels->push_back( &srcSurface.getChannelGreen() );
+	dstChannels->push_back( &dstSurface->getChannelGreen() );
+	srcChannels->push_back( &srcSurface.getChannelBlue() );
+	dstChannels->push_back( &dstSurface->getChannelBlue() );
+	if ( srcSurface.hasAlpha() && dstSurface->hasAlpha() ) {
+		srcChannels->push_back( &srcSurface.getChannelAlpha() );
+		dstChannels->push_back( &dstSurface->getChannelAlpha() );	
+	}
 }
 
 template<typename LT, typename AT>
@@ -308,26 +552,29 @@ void makeWeightTable( int32_t b, float cen, const FilterBase &filter, const Filt
 
 template<typename T>
 void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter )
+{
+	resize( srcSurface, srcArea, dstSurface, dstArea, filter, ExecutionContextRef() );
+}
+
+template<typename T>
+void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter, const ExecutionContextRef &context )
 {
 	vector<const ChannelT<T>*> srcChannels;
 	vector<ChannelT<T>*> dstChannels;
+	getResampleChannels( srcSurface, dstSurface, &srcChannels, &dstChannels );
+	dstSurface->markDirty( dstArea );
 
-	srcChannels.push_back( &srcSurface.getChannelRed() );
-	dstChannels.push_back( &dstSurface->getChannelRed() );
-	srcChannels.push_back( &srcSurface.getChannelGreen() );
-	dstChannels.push_back( &dstSurface->getChannelGreen() );
-	srcChannels.push_back( &srcSurface.getChannelBlue() );
-	dstChannels.push_back( &dstSurface->getChannelBlue() );
-	if ( srcSurface.hasAlpha() && dstSurface->hasAlpha() ) {
-		srcChannels.push_back( &srcSurface.getChannelAlpha() );
-		dstChannels.push_back( &dstSurface->getChannelAlpha() );	
-	}
-
-	resample( srcChannels, filter, srcArea, dstArea, dstChannels );
+	resample( srcChannels, filter, srcArea, dstArea, dstChannels, context );
 }
 
 template<typename T>
 void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter )
+{
+	resize( srcChannel, srcArea, dstChannel, dstArea, filter, ExecutionContextRef() );
+}
+
+template<typename T>
+void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter, const ExecutionContextRef &context )
 {
 	vector<const ChannelT<T>*> srcChannels;
 	vector<ChannelT<T>*> dstChannels;
@@ -335,7 +582,7 @@ void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *ds
 	srcChannels.push_back( &srcChannel );
 	dstChannels.push_back( dstChannel );
 	
-	resample( srcChannels, filter, srcArea, dstArea, dstChannels );
+	resample( srcChannels, filter, srcArea, dstArea, dstChannels, context );
 }
 
 template<typename T>
@@ -358,12 +605,108 @@ void resize( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const Filte
 	resize( srcChannel, srcChannel.getBounds(), dstChannel, dstChannel->getBounds(), filter );
 }
 
+template<typename T>
+ResizerT<T>::ResizerT( const Vec2i &srcSize, const Vec2i &dstSize, const FilterBase &filter )
+	: mSrcSize( srcSize ), mDstSize( dstSize )
+{
+	Area srcBounds( Vec2i::zero(), srcSize ), dstBounds( Vec2i::zero(), dstSize );
+	mParams = std::shared_ptr<ResampleParams<T> >( new ResampleParams<T>( srcBounds, srcBounds, dstBounds, dstBounds, filter ) );
+}
+
+template<typename T>
+void ResizerT<T>::resize( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const ExecutionContextRef &context ) const
+{
+	if( ( srcSurface.getSize() != mSrcSize ) || ( dstSurface->getSize() != mDstSize ) )
+		throw ResizerExcSizeMismatch();
+	dstSurface->markDirty();
+
+	// identical layouts can be filtered a whole pixel at a time
+	if( srcSurface.getChannelOrder().getCode() == dstSurface->getChannelOrder().getCode() ) {
+		if( mParams->isEmpty() )
+			return;
+		void (*rowsFn)( const ResampleParams<T>*, const SurfaceT<T>*, SurfaceT<T>*, const Area& ) = ( srcSurface.getPixelInc() == 4 ) ? &resampleRowsInterleaved<T,4> : &resampleRowsInterleaved<T,3>;
+		Area rows( 0, 0, mParams->dstWidth, mParams->dstHeight );
+		if( context )
+			context->run( rows, std::bind( rowsFn, mParams.get(), &srcSurface, dstSurface, std::_1 ) );
+		else
+			(*rowsFn)( mParams.get(), &srcSurface, dstSurface, rows );
+		return;
+	}
+
+	vector<const ChannelT<T>*> srcChannels;
+	vector<ChannelT<T>*> dstChannels;
+	getResampleChannels( srcSurface, dstSurface, &srcChannels, &dstChannels );
+
+	resample( *mParams, srcChannels, dstChannels, context );
+}
+
+template<typename T>
+void ResizerT<T>::resize( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const ExecutionContextRef &context ) const
+{
+	if( ( srcChannel.getSize() != mSrcSize ) || ( dstChannel->getSize() != mDstSize ) )
+		throw ResizerExcSizeMismatch();
+
+	vector<const ChannelT<T>*> srcChannels;
+	vector<ChannelT<T>*> dstChannels;
+	srcChannels.push_back( &srcChannel );
+	dstChannels.push_back( dstChannel );
+
+	resample( *mParams, srcChannels, dstChannels, context );
+}
+
+// the horizontally filtered source rows which ResizerT::resizeRow() keeps between calls, as resampleRows() does for a band
+template<typename T>
+struct ResizeRowCache {
+	typedef typename SCALETRAIT<T>::SUMT SUMT;
+
+	ResizeRowCache( int32_t numLines, int32_t width )
+		: mLineRows( numLines, -1 ), mLines( numLines * width ), mAccum( width )
+	{}
+
+	vector<int32_t>		mLineRows;
+	vector<SUMT>		mLines, mAccum;
+};
+
+template<typename T>
+std::shared_ptr<ResizeRowCache<T> > ResizerT<T>::createRowCache() const
+{
+	return std::shared_ptr<ResizeRowCache<T> >( new ResizeRowCache<T>( mParams->filterParamsY.width, std::max<int32_t>( 1, mParams->dstWidth ) ) );
+}
+
+template<typename T>
+void ResizerT<T>::resizeRow( int32_t dstY, const std::function<const T*(int32_t)> &srcRows, T *dstRow, ResizeRowCache<T> *cache ) const
+{
+	typedef typename SCALETRAIT<T>::SUMT SUMT;
+	if( mParams->isEmpty() )
+		return;
+
+	const int32_t dstWidth = mParams->dstWidth;
+	const int32_t lineCount = mParams->filterParamsY.width;
+	const WeightTable<SUMT> &yWeights = mParams->yWeights[dstY];
+	SUMT *accum = &cache->mAccum[0];
+	memset( accum, 0, sizeof(SUMT) * dstWidth );
+
+	for( int32_t ayf = yWeights.start; ayf < yWeights.end; ayf++ ) {
+		SUMT *line = &cache->mLines[( ayf % lineCount ) * dstWidth];
+		if( cache->mLineRows[ayf % lineCount] != ayf ) {
+			scanlineFilterRowToBuffer( mParams->xWeights, srcRows( mParams->srcOffsetY + ayf ) + mParams->srcOffsetX, 1, line, dstWidth );
+			cache->mLineRows[ayf % lineCount] = ayf;
+		}
+		scanlineAccumulate<SUMT,SUMT>( yWeights.weight[ayf - yWeights.start], line, dstWidth, accum );
+	}
+
+	scanlineShiftAccumToRow( accum, dstRow, 1, dstWidth );
+}
+
 #define resize_PROTOTYPES(r,data,T)\
 	template void resize( const SurfaceT<T> &srcSurface, SurfaceT<T> *dstSurface, const FilterBase &filter ); \
 	template void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter ); \
 	template void resize( const ChannelT<T> &srcChannel, ChannelT<T> *dstChannel, const FilterBase &filter ); \
 	template SurfaceT<T> resizeCopy( const SurfaceT<T> &srcSurface, const Area &srcArea, const Vec2i &dstSize, const FilterBase &filter ); \
-	template void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter );
+	template void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter ); \
+	template void resize( const SurfaceT<T> &srcSurface, const Area &srcArea, SurfaceT<T> *dstSurface, const Area &dstArea, const FilterBase &filter, const ExecutionContextRef &context ); \
+	template void resize( const ChannelT<T> &srcChannel, const Area &srcArea, ChannelT<T> *dstChannel, const Area &dstArea, const FilterBase &filter, const ExecutionContextRef &context ); \
+	template class ResizerT<T>;
 
 BOOST_PP_SEQ_FOR_EACH( resize_PROTOTYPES, ~, CHANNEL_TYPES )
 
@@ -0,0 +1,78 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/ip/Simd.h"
+#include "cinder/System.h"
+
+namespace cinder { namespace ip {
+
+static bool sSimdEnabled = true;
+
+void setSimdEnabled( bool enable )
+{
+	sSimdEnabled = enable;
+}
+
+bool isSimdEnabled()
+{
+	return sSimdEnabled;
+}
+
+bool useSse2()
+{
+#if defined( CINDER_IP_SSE2 )
+	return sSimdEnabled && System::hasCpuFeature( System::CPU_SSE2 );
+#else
+	return false;
+#endif
+}
+
+bool useSsse3()
+{
+#if defined( CINDER_IP_SSSE3 )
+	return sSimdEnabled && System::hasCpuFeature( System::CPU_SSSE3 );
+#else
+	return false;
+#endif
+}
+
+bool useF16c()
+{
+#if defined( CINDER_IP_F16C )
+	return sSimdEnabled && System::hasCpuFeature( System::CPU_F16C );
+#else
+	return false;
+#endif
+}
+
+bool useNeon()
+{
+#if defined( CINDER_IP_NEON )
+	return sSimdEnabled && System::hasCpuFeature( System::CPU_NEON );
+#else
+	return false;
+#endif
+}
+
+} } // namespace cinder::ip
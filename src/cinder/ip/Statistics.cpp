@@ -0,0 +1,791 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#include "cinder/ip/Statistics.h"
+#include "cinder/ip/Simd.h"
+#include "cinder/ChanTraits.h"
+#include "cinder/Thread.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#if defined( CINDER_IP_SSE2 )
+	#include <emmintrin.h>
+#endif
+
+namespace cinder { namespace ip {
+
+namespace {
+
+template<typename T> struct StatTrait { typedef uint64_t SumT; };
+template<> struct StatTrait<float> { typedef double SumT; };
+
+// The rows of a Channel or Surface as the kernels below see them. A packed view holds mCount adjacent values per row and sorts them into
+// four lanes by their index modulo 4, which for a row of 4-channel pixels is their channel. A strided view holds mCount values mInc apart in a single lane.
+template<typename T>
+struct RowView {
+	RowView( const T *data, int32_t rowBytes, int32_t count, int8_t inc )
+		: mData( reinterpret_cast<const uint8_t*>( data ) ), mRowBytes( rowBytes ), mCount( count ), mInc( inc )
+	{}
+
+	const T*	getRow( int32_t y ) const { return reinterpret_cast<const T*>( mData + y * mRowBytes ); }
+	bool		isPacked() const { return mInc == 0; }
+
+	const uint8_t	*mData;
+	int32_t			mRowBytes, mCount;
+	int8_t			mInc;
+};
+
+template<typename T>
+RowView<T> channelView( const ChannelT<T> &channel )
+{
+	return RowView<T>( channel.getData(), channel.getRowBytes(), channel.getWidth(), channel.isPlanar() ? 0 : channel.getIncrement() );
+}
+
+// runs \a bandFn over the rows of \a area, in parallel when there is a \a context
+void runRows( const Area &area, const std::function<void(const Area&)> &bandFn, const ExecutionContextRef &context )
+{
+	if( context )
+		context->run( area, bandFn );
+	else if( ( area.getWidth() > 0 ) && ( area.getHeight() > 0 ) )
+		bandFn( area );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// min / max
+template<typename T>
+void minMaxPackedScalar( const T *src, int32_t count, T *mn, T *mx )
+{
+	for( int32_t i = 0; i < count; ++i ) {
+		mn[i & 3] = std::min( mn[i & 3], src[i] );
+		mx[i & 3] = std::max( mx[i & 3], src[i] );
+	}
+}
+
+template<typename T>
+void minMaxPacked( const T *src, int32_t count, T *mn, T *mx )
+{
+	minMaxPackedScalar( src, count, mn, mx );
+}
+
+#if defined( CINDER_IP_SSE2 )
+template<>
+void minMaxPacked<float>( const float *src, int32_t count, float *mn, float *mx )
+{
+	int32_t i = 0;
+	if( useSse2() ) {
+		__m128 vMin = _mm_loadu_ps( mn ), vMax = _mm_loadu_ps( mx );
+		for( ; i + 4 <= count; i += 4 ) {
+			__m128 v = _mm_loadu_ps( src + i );
+			// minps( v, m ) is ( v < m ) ? v : m, exactly std::min( m, v ) including its handling of NaNs
+			vMin = _mm_min_ps( v, vMin );
+			vMax = _mm_max_ps( v, vMax );
+		}
+		_mm_storeu_ps( mn, vMin );
+		_mm_storeu_ps( mx, vMax );
+	}
+	minMaxPackedScalar( src + i, count - i, mn, mx );
+}
+
+template<>
+void minMaxPacked<uint8_t>( const uint8_t *src, int32_t count, uint8_t *mn, uint8_t *mx )
+{
+	int32_t i = 0;
+	if( useSse2() && ( count >= 16 ) ) {
+		int32_t mn4, mx4;
+		memcpy( &mn4, mn, 4 );
+		memcpy( &mx4, mx, 4 );
+		__m128i vMin = _mm_set1_epi32( mn4 ), vMax = _mm_set1_epi32( mx4 );
+		for( ; i + 16 <= count; i += 16 ) {
+			__m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+			vMin = _mm_min_epu8( vMin, v );
+			vMax = _mm_max_epu8( vMax, v );
+		}
+		// fold the 16 byte lanes onto the 4 lanes they repeat
+		vMin = _mm_min_epu8( vMin, _mm_srli_si128( vMin, 8 ) );
+		vMin = _mm_min_epu8( vMin, _mm_srli_si128( vMin, 4 ) );
+		vMax = _mm_max_epu8( vMax, _mm_srli_si128( vMax, 8 ) );
+		vMax = _mm_max_epu8( vMax, _mm_srli_si128( vMax, 4 ) );
+		mn4 = _mm_cvtsi128_si32( vMin );
+		mx4 = _mm_cvtsi128_si32( vMax );
+		memcpy( mn, &mn4, 4 );
+		memcpy( mx, &mx4, 4 );
+	}
+	minMaxPackedScalar( src + i, count - i, mn, mx );
+}
+
+template<>
+void minMaxPacked<uint16_t>( const uint16_t *src, int32_t count, uint16_t *mn, uint16_t *mx )
+{
+	int32_t i = 0;
+	if( useSse2() && ( count >= 8 ) ) {
+		// SSE2 only compares signed 16 bit values, so flip the sign bit on the way in and out
+		const __m128i bias = _mm_set1_epi16( (short)0x8000 );
+		__m128i vMin = _mm_xor_si128( _mm_set_epi16( mn[3], mn[2], mn[1], mn[0], mn[3], mn[2], mn[1], mn[0] ), bias );
+		__m128i vMax = _mm_xor_si128( _mm_set_epi16( mx[3], mx[2], mx[1], mx[0], mx[3], mx[2], mx[1], mx[0] ), bias );
+		for( ; i + 8 <= count; i += 8 ) {
+			__m128i v = _mm_xor_si128( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) ), bias );
+			vMin = _mm_min_epi16( vMin, v );
+			vMax = _mm_max_epi16( vMax, v );
+		}
+		vMin = _mm_xor_si128( _mm_min_epi16( vMin, _mm_srli_si128( vMin, 8 ) ), bias );
+		vMax = _mm_xor_si128( _mm_max_epi16( vMax, _mm_srli_si128( vMax, 8 ) ), bias );
+		_mm_storel_epi64( reinterpret_cast<__m128i*>( mn ), vMin );
+		_mm_storel_epi64( reinterpret_cast<__m128i*>( mx ), vMax );
+	}
+	minMaxPackedScalar( src + i, count - i, mn, mx );
+}
+#endif // defined( CINDER_IP_SSE2 )
+
+template<typename T>
+void minMaxStrided( const T *src, int32_t count, int8_t inc, T *mn, T *mx )
+{
+	for( int32_t i = 0; i < count; ++i, src += inc ) {
+		*mn = std::min( *mn, *src );
+		*mx = std::max( *mx, *src );
+	}
+}
+
+// each row starts from \a init and lands in 4 lanes of \a rowMins and \a rowMaxs
+template<typename T>
+void minMaxBand( const RowView<T> *view, const T *init, T *rowMins, T *rowMaxs, const Area &area )
+{
+	for( int32_t y = area.getY1(); y < area.getY2(); ++y ) {
+		T *mn = rowMins + y * 4, *mx = rowMaxs + y * 4;
+		std::copy( init, init + 4, mn );
+		std::copy( init, init + 4, mx );
+		if( view->isPacked() )
+			minMaxPacked( view->getRow( y ), view->mCount, mn, mx );
+		else
+			minMaxStrided( view->getRow( y ), view->mCount, view->mInc, mn, mx );
+	}
+}
+
+// fills the 4 lanes of \a resultMin and \a resultMax, each starting from \a init
+template<typename T>
+void minMaxLanes( const RowView<T> &view, int32_t height, const T *init, T *resultMin, T *resultMax, const ExecutionContextRef &context )
+{
+	std::vector<T> rowMins( height * 4 ), rowMaxs( height * 4 );
+	void (*bandFn)( const RowView<T>*, const T*, T*, T*, const Area& ) = &minMaxBand<T>;
+	runRows( Area( 0, 0, 1, height ), std::bind( bandFn, &view, init, &rowMins[0], &rowMaxs[0], std::_1 ), context );
+
+	std::copy( init, init + 4, resultMin );
+	std::copy( init, init + 4, resultMax );
+	for( int32_t y = 0; y < height; ++y ) {
+		for( int l = 0; l < 4; ++l ) {
+			resultMin[l] = std::min( resultMin[l], rowMins[y * 4 + l] );
+			resultMax[l] = std::max( resultMax[l], rowMaxs[y * 4 + l] );
+		}
+	}
+}
+
+template<typename T>
+void getMinMaxImpl( const ChannelT<T> &channel, T *resultMin, T *resultMax, const ExecutionContextRef &context )
+{
+	if( ( channel.getWidth() <= 0 ) || ( channel.getHeight() <= 0 ) ) {
+		*resultMin = *resultMax = 0;
+		return;
+	}
+
+	const T first = *channel.getData();
+	const T init[4] = { first, first, first, first };
+	T mn[4], mx[4];
+	minMaxLanes( channelView( channel ), channel.getHeight(), init, mn, mx, context );
+	if( channel.isPlanar() ) {
+		for( int l = 1; l < 4; ++l ) {
+			mn[0] = std::min( mn[0], mn[l] );
+			mx[0] = std::max( mx[0], mx[l] );
+		}
+	}
+	*resultMin = mn[0];
+	*resultMax = mx[0];
+}
+
+template<typename T>
+void getMinMaxImpl( const SurfaceT<T> &surface, ColorAT<T> *resultMin, ColorAT<T> *resultMax, const ExecutionContextRef &context )
+{
+	const uint8_t offsets[4] = { surface.getRedOffset(), surface.getGreenOffset(), surface.getBlueOffset(), surface.hasAlpha() ? surface.getAlphaOffset() : (uint8_t)0 };
+	const int numChannels = surface.hasAlpha() ? 4 : 3;
+	T mn[4], mx[4];
+	std::fill( mn, mn + 4, T( 0 ) );
+	std::fill( mx, mx + 4, T( 0 ) );
+
+	if( ( surface.getWidth() > 0 ) && ( surface.getHeight() > 0 ) ) {
+		const T *data = surface.getData();
+		if( surface.getPixelInc() == 4 ) {
+			// every lane of a packed view of the whole row is one channel
+			T laneMin[4], laneMax[4];
+			minMaxLanes( RowView<T>( data, surface.getRowBytes(), surface.getWidth() * 4, 0 ), surface.getHeight(), data, laneMin, laneMax, context );
+			for( int c = 0; c < numChannels; ++c ) {
+				mn[c] = laneMin[offsets[c]];
+				mx[c] = laneMax[offsets[c]];
+			}
+		}
+		else {
+			for( int c = 0; c < numChannels; ++c ) {
+				const T first = data[offsets[c]];
+				const T init[4] = { first, first, first, first };
+				T laneMin[4], laneMax[4];
+				minMaxLanes( RowView<T>( data + offsets[c], surface.getRowBytes(), surface.getWidth(), surface.getPixelInc() ), surface.getHeight(), init, laneMin, laneMax, context );
+				mn[c] = laneMin[0];
+				mx[c] = laneMax[0];
+			}
+		}
+	}
+
+	if( ! surface.hasAlpha() )
+		mn[3] = mx[3] = CHANTRAIT<T>::max();
+	*resultMin = ColorAT<T>( mn[0], mn[1], mn[2], mn[3] );
+	*resultMax = ColorAT<T>( mx[0], mx[1], mx[2], mx[3] );
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// sums. Integer values are summed exactly along with their squares, which is all a variance needs. Floats are summed in double
+// precision, and their variance takes a second pass over the squared deviations from the mean.
+template<typename T>
+void sumPackedScalar( const T *src, int32_t count, uint64_t *sum, uint64_t *sumSq )
+{
+	for( int32_t i = 0; i < count; ++i )
+		sum[i & 3] += src[i];
+	if( sumSq ) {
+		for( int32_t i = 0; i < count; ++i )
+			sumSq[i & 3] += (uint64_t)src[i] * src[i];
+	}
+}
+
+void sumPackedScalar( const float *src, int32_t count, double *sum, double * /*sumSq*/ )
+{
+	for( int32_t i = 0; i < count; ++i )
+		sum[i & 3] += src[i];
+}
+
+template<typename T>
+void sumPacked( const T *src, int32_t count, typename StatTrait<T>::SumT *sum, typename StatTrait<T>::SumT *sumSq )
+{
+	sumPackedScalar( src, count, sum, sumSq );
+}
+
+#if defined( CINDER_IP_SSE2 )
+template<>
+void sumPacked<float>( const float *src, int32_t count, double *sum, double *sumSq )
+{
+	int32_t i = 0;
+	if( useSse2() ) {
+		__m128d s01 = _mm_loadu_pd( sum ), s23 = _mm_loadu_pd( sum + 2 );
+		for( ; i + 4 <= count; i += 4 ) {
+			__m128 v = _mm_loadu_ps( src + i );
+			s01 = _mm_add_pd( s01, _mm_cvtps_pd( v ) );
+			s23 = _mm_add_pd( s23, _mm_cvtps_pd( _mm_movehl_ps( v, v ) ) );
+		}
+		_mm_storeu_pd( sum, s01 );
+		_mm_storeu_pd( sum + 2, s23 );
+	}
+	sumPackedScalar( src + i, count - i, sum, sumSq );
+}
+
+template<>
+void sumPacked<uint8_t>( const uint8_t *src, int32_t count, uint64_t *sum, uint64_t *sumSq )
+{
+	int32_t i = 0;
+	if( useSse2() ) {
+		const __m128i zero = _mm_setzero_si128();
+		const int32_t end = count & ~15;
+		if( ! sumSq ) {
+			// without squares the lanes are only ever added together, so psadbw can sum 8 bytes at a time into lane 0
+			__m128i s = zero;
+			for( ; i < end; i += 16 )
+				s = _mm_add_epi64( s, _mm_sad_epu8( _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) ), zero ) );
+			uint64_t s2[2];
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( s2 ), s );
+			sum[0] += s2[0] + s2[1];
+		}
+		while( i < end ) {
+			// 32 bit lanes add at most 4 * 255 * 255 per iteration, so they are flushed before they could overflow
+			const int32_t blockEnd = std::min<int32_t>( end, i + 8192 * 16 );
+			__m128i s = zero, q = zero;
+			for( ; i < blockEnd; i += 16 ) {
+				__m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+				__m128i lo = _mm_unpacklo_epi8( v, zero ), hi = _mm_unpackhi_epi8( v, zero );
+				__m128i w = _mm_add_epi16( lo, hi );
+				s = _mm_add_epi32( s, _mm_add_epi32( _mm_unpacklo_epi16( w, zero ), _mm_unpackhi_epi16( w, zero ) ) );
+				__m128i qLo = _mm_mullo_epi16( lo, lo ), qHi = _mm_mullo_epi16( hi, hi );
+				q = _mm_add_epi32( q, _mm_add_epi32( _mm_add_epi32( _mm_unpacklo_epi16( qLo, zero ), _mm_unpackhi_epi16( qLo, zero ) ),
+													 _mm_add_epi32( _mm_unpacklo_epi16( qHi, zero ), _mm_unpackhi_epi16( qHi, zero ) ) ) );
+			}
+			uint32_t s4[4], q4[4];
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( s4 ), s );
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( q4 ), q );
+			for( int l = 0; l < 4; ++l ) {
+				sum[l] += s4[l];
+				sumSq[l] += q4[l];
+			}
+		}
+	}
+	sumPackedScalar( src + i, count - i, sum, sumSq );
+}
+
+template<>
+void sumPacked<uint16_t>( const uint16_t *src, int32_t count, uint64_t *sum, uint64_t *sumSq )
+{
+	int32_t i = 0;
+	if( useSse2() ) {
+		const __m128i zero = _mm_setzero_si128();
+		const int32_t end = count & ~7;
+		while( i < end ) {
+			// 32 bit sums add at most 2 * 65535 per iteration; the squares need 64 bits straight away
+			const int32_t blockEnd = std::min<int32_t>( end, i + 16384 * 8 );
+			__m128i s = zero, q01 = zero, q23 = zero;
+			for( ; i < blockEnd; i += 8 ) {
+				__m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+				s = _mm_add_epi32( s, _mm_add_epi32( _mm_unpacklo_epi16( v, zero ), _mm_unpackhi_epi16( v, zero ) ) );
+				if( sumSq ) {
+					__m128i pLo = _mm_mullo_epi16( v, v ), pHi = _mm_mulhi_epu16( v, v );
+					__m128i p0123 = _mm_unpacklo_epi16( pLo, pHi ), p4567 = _mm_unpackhi_epi16( pLo, pHi );
+					q01 = _mm_add_epi64( q01, _mm_add_epi64( _mm_unpacklo_epi32( p0123, zero ), _mm_unpacklo_epi32( p4567, zero ) ) );
+					q23 = _mm_add_epi64( q23, _mm_add_epi64( _mm_unpackhi_epi32( p0123, zero ), _mm_unpackhi_epi32( p4567, zero ) ) );
+				}
+			}
+			uint32_t s4[4];
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( s4 ), s );
+			for( int l = 0; l < 4; ++l )
+				sum[l] += s4[l];
+			if( sumSq ) {
+				uint64_t q4[4];
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( q4 ), q01 );
+				_mm_storeu_si128( reinterpret_cast<__m128i*>( q4 + 2 ), q23 );
+				for( int l = 0; l < 4; ++l )
+					sumSq[l] += q4[l];
+			}
+		}
+	}
+	sumPackedScalar( src + i, count - i, sum, sumSq );
+}
+#endif // defined( CINDER_IP_SSE2 )
+
+template<typename T>
+void sumStrided( const T *src, int32_t count, int8_t inc, uint64_t *sum, uint64_t *sumSq )
+{
+	for( int32_t i = 0; i < count; ++i, src += inc ) {
+		*sum += *src;
+		if( sumSq )
+			*sumSq += (uint64_t)*src * *src;
+	}
+}
+
+void sumStrided( const float *src, int32_t count, int8_t inc, double *sum, double * /*sumSq*/ )
+{
+	for( int32_t i = 0; i < count; ++i, src += inc )
+		*sum += *src;
+}
+
+template<typename T>
+void sumBand( const RowView<T> *view, typename StatTrait<T>::SumT *rowSums, typename StatTrait<T>::SumT *rowSumSqs, const Area &area )
+{
+	for( int32_t y = area.getY1(); y < area.getY2(); ++y ) {
+		typename StatTrait<T>::SumT *sumSq = rowSumSqs ? ( rowSumSqs + y * 4 ) : 0;
+		if( view->isPacked() )
+			sumPacked( view->getRow( y ), view->mCount, rowSums + y * 4, sumSq );
+		else
+			sumStrided( view->getRow( y ), view->mCount, view->mInc, rowSums + y * 4, sumSq );
+	}
+}
+
+// squared deviations of floats from the \a mean of their lane
+void devPackedScalar( const float *src, int32_t count, const double *mean, double *dev )
+{
+	for( int32_t i = 0; i < count; ++i ) {
+		double d = src[i] - mean[i & 3];
+		dev[i & 3] += d * d;
+	}
+}
+
+void devPacked( const float *src, int32_t count, const double *mean, double *dev )
+{
+	int32_t i = 0;
+#if defined( CINDER_IP_SSE2 )
+	if( useSse2() ) {
+		const __m128d m01 = _mm_loadu_pd( mean ), m23 = _mm_loadu_pd( mean + 2 );
+		__m128d d01 = _mm_loadu_pd( dev ), d23 = _mm_loadu_pd( dev + 2 );
+		for( ; i + 4 <= count; i += 4 ) {
+			__m128 v = _mm_loadu_ps( src + i );
+			__m128d a = _mm_sub_pd( _mm_cvtps_pd( v ), m01 ), b = _mm_sub_pd( _mm_cvtps_pd( _mm_movehl_ps( v, v ) ), m23 );
+			d01 = _mm_add_pd( d01, _mm_mul_pd( a, a ) );
+			d23 = _mm_add_pd( d23, _mm_mul_pd( b, b ) );
+		}
+		_mm_storeu_pd( dev, d01 );
+		_mm_storeu_pd( dev + 2, d23 );
+	}
+#endif
+	devPackedScalar( src + i, count - i, mean, dev );
+}
+
+void devBand( const RowView<float> *view, const double *mean, double *rowDevs, const Area &area )
+{
+	for( int32_t y = area.getY1(); y < area.getY2(); ++y ) {
+		double *dev = rowDevs + y * 4;
+		if( view->isPacked() )
+			devPacked( view->getRow( y ), view->mCount, mean, dev );
+		else {
+			const float *src = view->getRow( y );
+			for( int32_t i = 0; i < view->mCount; ++i, src += view->mInc ) {
+				double d = *src - mean[0];
+				*dev += d * d;
+			}
+		}
+	}
+}
+
+// adds up the rows of \a rowValues top to bottom into 4 lanes
+template<typename SumT>
+void sumRows( const std::vector<SumT> &rowValues, int32_t height, SumT *result )
+{
+	std::fill( result, result + 4, SumT( 0 ) );
+	for( int32_t y = 0; y < height; ++y )
+		for( int l = 0; l < 4; ++l )
+			result[l] += rowValues[y * 4 + l];
+}
+
+// a packed Channel adds its lanes together, whereas the lanes of a Surface are its channels
+template<typename SumT>
+void mergeLanes( SumT *lanes )
+{
+	lanes[0] = ( lanes[0] + lanes[1] ) + ( lanes[2] + lanes[3] );
+}
+
+template<typename T>
+void sumLanes( const RowView<T> &view, int32_t height, typename StatTrait<T>::SumT *resultSum, typename StatTrait<T>::SumT *resultSumSq, const ExecutionContextRef &context )
+{
+	typedef typename StatTrait<T>::SumT SumT;
+	std::vector<SumT> rowSums( height * 4, SumT( 0 ) ), rowSumSqs( resultSumSq ? height * 4 : 0, SumT( 0 ) );
+	void (*bandFn)( const RowView<T>*, SumT*, SumT*, const Area& ) = &sumBand<T>;
+	runRows( Area( 0, 0, 1, height ), std::bind( bandFn, &view, &rowSums[0], resultSumSq ? &rowSumSqs[0] : (SumT*)0, std::_1 ), context );
+	sumRows( rowSums, height, resultSum );
+	if( resultSumSq )
+		sumRows( rowSumSqs, height, resultSumSq );
+}
+
+// fills the lanes of \a mean and \a variance; \a numValues is the number of values per lane, or in total when \a merge is set
+template<typename T>
+void meanVarianceLanes( const RowView<T> &view, int32_t height, bool merge, double numValues, double *mean, double *variance, const ExecutionContextRef &context )
+{
+	uint64_t sum[4], sumSq[4];
+	sumLanes( view, height, sum, sumSq, context );
+	if( merge ) {
+		mergeLanes( sum );
+		mergeLanes( sumSq );
+	}
+	for( int l = 0; l < ( merge ? 1 : 4 ); ++l ) {
+		mean[l] = sum[l] / numValues;
+		variance[l] = std::max( 0.0, sumSq[l] / numValues - mean[l] * mean[l] );
+	}
+}
+
+void meanVarianceLanes( const RowView<float> &view, int32_t height, bool merge, double numValues, double *mean, double *variance, const ExecutionContextRef &context )
+{
+	double sum[4];
+	sumLanes( view, height, sum, (double*)0, context );
+	if( merge ) {
+		mergeLanes( sum );
+		std::fill( mean, mean + 4, sum[0] / numValues );
+	}
+	else {
+		for( int l = 0; l < 4; ++l )
+			mean[l] = sum[l] / numValues;
+	}
+
+	std::vector<double> rowDevs( height * 4, 0.0 );
+	runRows( Area( 0, 0, 1, height ), std::bind( &devBand, &view, mean, &rowDevs[0], std::_1 ), context );
+	double dev[4];
+	sumRows( rowDevs, height, dev );
+	if( merge )
+		mergeLanes( dev );
+	for( int l = 0; l < ( merge ? 1 : 4 ); ++l )
+		variance[l] = dev[l] / numValues;
+}
+
+template<typename T>
+void getMeanVarianceImpl( const ChannelT<T> &channel, double *resultMean, double *resultVariance, const ExecutionContextRef &context )
+{
+	double mean[4] = { 0, 0, 0, 0 }, variance[4] = { 0, 0, 0, 0 };
+	if( ( channel.getWidth() > 0 ) && ( channel.getHeight() > 0 ) )
+		meanVarianceLanes( channelView( channel ), channel.getHeight(), channel.isPlanar(), (double)channel.getWidth() * channel.getHeight(), mean, variance, context );
+	if( resultMean )
+		*resultMean = mean[0];
+	if( resultVariance )
+		*resultVariance = variance[0];
+}
+
+template<typename T>
+void getMeanVarianceImpl( const SurfaceT<T> &surface, ColorAf *resultMean, ColorAf *resultVariance, const ExecutionContextRef &context )
+{
+	const uint8_t offsets[4] = { surface.getRedOffset(), surface.getGreenOffset(), surface.getBlueOffset(), surface.hasAlpha() ? surface.getAlphaOffset() : (uint8_t)0 };
+	const int numChannels = surface.hasAlpha() ? 4 : 3;
+	double mean[4] = { 0, 0, 0, 0 }, variance[4] = { 0, 0, 0, 0 };
+
+	if( ( surface.getWidth() > 0 ) && ( surface.getHeight() > 0 ) ) {
+		const T *data = surface.getData();
+		const double numPixels = (double)surface.getWidth() * surface.getHeight();
+		if( surface.getPixelInc() == 4 ) {
+			double laneMean[4], laneVariance[4];
+			meanVarianceLanes( RowView<T>( data, surface.getRowBytes(), surface.getWidth() * 4, 0 ), surface.getHeight(), false, numPixels, laneMean, laneVariance, context );
+			for( int c = 0; c < numChannels; ++c ) {
+				mean[c] = laneMean[offsets[c]];
+				variance[c] = laneVariance[offsets[c]];
+			}
+		}
+		else {
+			for( int c = 0; c < numChannels; ++c ) {
+				double laneMean[4], laneVariance[4];
+				meanVarianceLanes( RowView<T>( data + offsets[c], surface.getRowBytes(), surface.getWidth(), surface.getPixelInc() ), surface.getHeight(), true, numPixels, laneMean, laneVariance, context );
+				mean[c] = laneMean[0];
+				variance[c] = laneVariance[0];
+			}
+		}
+	}
+
+	if( resultMean )
+		*resultMean = ColorAf( (float)mean[0], (float)mean[1], (float)mean[2], (float)mean[3] );
+	if( resultVariance )
+		*resultVariance = ColorAf( (float)variance[0], (float)variance[1], (float)variance[2], (float)variance[3] );
+}
+
+template<typename T>
+double getSumImpl( const ChannelT<T> &channel, const ExecutionContextRef &context )
+{
+	if( ( channel.getWidth() <= 0 ) || ( channel.getHeight() <= 0 ) )
+		return 0;
+
+	typename StatTrait<T>::SumT sum[4];
+	sumLanes( channelView( channel ), channel.getHeight(), sum, (typename StatTrait<T>::SumT*)0, context );
+	if( channel.isPlanar() )
+		mergeLanes( sum );
+	return (double)sum[0];
+}
+
+/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// histograms. HistogramBins<T> maps a value to its bin, or to -1 when it lies outside of the histogram's range
+template<typename T>
+class HistogramBins;
+
+template<>
+class HistogramBins<uint8_t> {
+  public:
+	HistogramBins( int32_t numBins, uint8_t minValue, uint8_t maxValue )
+	{
+		for( int v = 0; v < 256; ++v )
+			mBins[v] = ( ( v < minValue ) || ( v > maxValue ) ) ? -1 : (int32_t)( (int64_t)( v - minValue ) * numBins / ( maxValue - minValue + 1 ) );
+	}
+
+	int32_t operator()( uint8_t v ) const { return mBins[v]; }
+
+  private:
+	int32_t		mBins[256];
+};
+
+template<>
+class HistogramBins<uint16_t> {
+  public:
+	HistogramBins( int32_t numBins, uint16_t minValue, uint16_t maxValue )
+		: mNumBins( numBins ), mMin( minValue ), mMax( maxValue ), mRange( (int64_t)maxValue - minValue + 1 )
+	{}
+
+	int32_t operator()( uint16_t v ) const { return ( ( v < mMin ) || ( v > mMax ) ) ? -1 : (int32_t)( ( v - mMin ) * mNumBins / mRange ); }
+
+  private:
+	int64_t		mNumBins;
+	uint16_t	mMin, mMax;
+	int64_t		mRange;
+};
+
+template<>
+class HistogramBins<float> {
+  public:
+	HistogramBins( int32_t numBins, float minValue, float maxValue )
+		: mMin( minValue ), mMax( maxValue ), mScale( ( maxValue > minValue ) ? numBins / ( maxValue - minValue ) : 0 ), mLastBin( numBins - 1 )
+	{}
+
+	// maxValue itself scales to numBins, which belongs to the last bin
+	int32_t operator()( float v ) const { return ( ( v >= mMin ) && ( v <= mMax ) ) ? std::min( (int32_t)( ( v - mMin ) * mScale ), mLastBin ) : -1; }
+
+	float		mMin, mMax, mScale;
+	int32_t		mLastBin;
+};
+
+template<typename T>
+void histogramRow( const HistogramBins<T> &bins, const T *src, int32_t count, int8_t inc, uint32_t *result )
+{
+	for( int32_t i = 0; i < count; ++i, src += inc ) {
+		int32_t bin = bins( *src );
+		if( bin >= 0 )
+			++result[bin];
+	}
+}
+
+#if defined( CINDER_IP_SSE2 )
+template<>
+void histogramRow<float>( const HistogramBins<float> &bins, const float *src, int32_t count, int8_t inc, uint32_t *result )
+{
+	int32_t i = 0;
+	if( ( inc == 1 ) && useSse2() ) {
+		const __m128 minValue = _mm_set1_ps( bins.mMin ), maxValue = _mm_set1_ps( bins.mMax ), scale = _mm_set1_ps( bins.mScale );
+		const __m128 lastBin = _mm_set1_ps( (float)bins.mLastBin );
+		int32_t idx[4];
+		for( ; i + 4 <= count; i += 4 ) {
+			__m128 v = _mm_loadu_ps( src + i );
+			int inRange = _mm_movemask_ps( _mm_and_ps( _mm_cmpge_ps( v, minValue ), _mm_cmple_ps( v, maxValue ) ) );
+			if( ! inRange )
+				continue;
+			// clamping before truncating matches clamping the truncated bin, as both are monotonic
+			_mm_storeu_si128( reinterpret_cast<__m128i*>( idx ), _mm_cvttps_epi32( _mm_min_ps( _mm_mul_ps( _mm_sub_ps( v, minValue ), scale ), lastBin ) ) );
+			for( int l = 0; l < 4; ++l )
+				if( inRange & ( 1 << l ) )
+					++result[idx[l]];
+		}
+	}
+	for( ; i < count; ++i ) {
+		int32_t bin = bins( src[i * inc] );
+		if( bin >= 0 )
+			++result[bin];
+	}
+}
+#endif
+
+template<typename T>
+void histogramBand( const ChannelT<T> *channel, const HistogramBins<T> *bins, int32_t numBins, uint32_t *resultBins, std::mutex *mutex, const Area &area )
+{
+	std::vector<uint32_t> bandBins( numBins, 0 );
+	for( int32_t y = area.getY1(); y < area.getY2(); ++y )
+		histogramRow( *bins, channel->getData( 0, y ), channel->getWidth(), channel->getIncrement(), &bandBins[0] );
+
+	std::lock_guard<std::mutex> lock( *mutex );
+	for( int32_t b = 0; b < numBins; ++b )
+		resultBins[b] += bandBins[b];
+}
+
+template<typename T>
+void calculateHistogramImpl( const ChannelT<T> &channel, int32_t numBins, T minValue, T maxValue, uint32_t *resultBins, const ExecutionContextRef &context )
+{
+	if( numBins <= 0 )
+		return;
+	std::fill( resultBins, resultBins + numBins, 0 );
+
+	const HistogramBins<T> bins( numBins, minValue, maxValue );
+	std::mutex mutex;
+	void (*bandFn)( const ChannelT<T>*, const HistogramBins<T>*, int32_t, uint32_t*, std::mutex*, const Area& ) = &histogramBand<T>;
+	runRows( channel.getBounds(), std::bind( bandFn, &channel, &bins, numBins, resultBins, &mutex, std::_1 ), context );
+}
+
+} // anonymous namespace
+
+template<typename T>
+void getMinMax( const ChannelT<T> &channel, T *resultMin, T *resultMax )
+{
+	getMinMaxImpl( channel, resultMin, resultMax, ExecutionContextRef() );
+}
+
+template<typename T>
+void getMinMax( const ChannelT<T> &channel, T *resultMin, T *resultMax, const ExecutionContextRef &context )
+{
+	getMinMaxImpl( channel, resultMin, resultMax, context );
+}
+
+template<typename T>
+void getMinMax( const SurfaceT<T> &surface, ColorAT<T> *resultMin, ColorAT<T> *resultMax )
+{
+	getMinMaxImpl( surface, resultMin, resultMax, ExecutionContextRef() );
+}
+
+template<typename T>
+void getMinMax( const SurfaceT<T> &surface, ColorAT<T> *resultMin, ColorAT<T> *resultMax, const ExecutionContextRef &context )
+{
+	getMinMaxImpl( surface, resultMin, resultMax, context );
+}
+
+template<typename T>
+double getSum( const ChannelT<T> &channel )
+{
+	return getSumImpl( channel, ExecutionContextRef() );
+}
+
+template<typename T>
+double getSum( const ChannelT<T> &channel, const ExecutionContextRef &context )
+{
+	return getSumImpl( channel, context );
+}
+
+template<typename T>
+void getMeanVariance( const ChannelT<T> &channel, double *resultMean, double *resultVariance )
+{
+	getMeanVarianceImpl( channel, resultMean, resultVariance, ExecutionContextRef() );
+}
+
+template<typename T>
+void getMeanVariance( const ChannelT<T> &channel, double *resultMean, double *resultVariance, const ExecutionContextRef &context )
+{
+	getMeanVarianceImpl( channel, resultMean, resultVariance, context );
+}
+
+template<typename T>
+void getMeanVariance( const SurfaceT<T> &surface, ColorAf *resultMean, ColorAf *resultVariance )
+{
+	getMeanVarianceImpl( surface, resultMean, resultVariance, ExecutionContextRef() );
+}
+
+template<typename T>
+void getMeanVariance( const SurfaceT<T> &surface, ColorAf *resultMean, ColorAf *resultVariance, const ExecutionContextRef &context )
+{
+	getMeanVarianceImpl( surface, resultMean, resultVariance, context );
+}
+
+template<typename T>
+void calculateHistogram( const ChannelT<T> &channel, int32_t numBins, T minValue, T maxValue, uint32_t *resultBins )
+{
+	calculateHistogramImpl( channel, numBins, minValue, maxValue, resultBins, ExecutionContextRef() );
+}
+
+template<typename T>
+void calculateHistogram( const ChannelT<T> &channel, int32_t numBins, T minValue, T maxValue, uint32_t *resultBins, const ExecutionContextRef &context )
+{
+	calculateHistogramImpl( channel, numBins, minValue, maxValue, resultBins, context );
+}
+
+#define statistics_PROTOTYPES(r,data,T)\
+	template void getMinMax( const ChannelT<T> &channel, T *resultMin, T *resultMax );\
+	template void getMinMax( const ChannelT<T> &channel, T *resultMin, T *resultMax, const ExecutionContextRef &context );\
+	template void getMinMax( const SurfaceT<T> &surface, ColorAT<T> *resultMin, ColorAT<T> *resultMax );\
+	template void getMinMax( const SurfaceT<T> &surface, ColorAT<T> *resultMin, ColorAT<T> *resultMax, const ExecutionContextRef &context );\
+	template double getSum( const ChannelT<T> &channel );\
+	template double getSum( const ChannelT<T> &channel, const ExecutionContextRef &context );\
+	template void getMeanVariance( const ChannelT<T> &channel, double *resultMean, double *resultVariance );\
+	template void getMeanVariance( const ChannelT<T> &channel, double *resultMean, double *resultVariance, const ExecutionContextRef &context );\
+	template void getMeanVariance( const SurfaceT<T> &surface, ColorAf *resultMean, ColorAf *resultVariance );\
+	template void getMeanVariance( const SurfaceT<T> &surface, ColorAf *resultMean, ColorAf *resultVariance, const ExecutionContextRef &context );\
+	template void calculateHistogram( const ChannelT<T> &channel, int32_t numBins, T minValue, T maxValue, uint32_t *resultBins );\
+	template void calculateHistogram( const ChannelT<T> &channel, int32_t numBins, T minValue, T maxValue, uint32_t *resultBins, const ExecutionContextRef &context );
+
+BOOST_PP_SEQ_FOR_EACH( statistics_PROTOTYPES, ~, CHANNEL_TYPES )
+
+} } // namespace cinder::ip
@@ -21,6 +21,7 @@
 */
 
 #include "cinder/ip/Threshold.h"
+#include "cinder/ip/IntegralImage.h"
 #include "cinder/ChanTraits.h"
 
 #include <stdlib.h>
@@ -46,23 +47,20 @@ void thresholdImpl( SurfaceT<T> *surface, T value, const Area &area )
 	}	
 }
 
+// processes the already clipped \a area of \a srcSurface, writing to \a dstSurface displaced by \a dstOffset
 template<typename T>
-void thresholdImpl( const SurfaceT<T> &srcSurface, T value, const Area &srcArea, const Vec2i &dstLT, SurfaceT<T> *dstSurface )
+void thresholdImpl( const SurfaceT<T> *srcSurface, T value, const Vec2i &dstOffset, SurfaceT<T> *dstSurface, const Area &area )
 {
-	std::pair<Area,Vec2i> srcDst = clippedSrcDst( srcSurface.getBounds(), srcArea, dstSurface->getBounds(), dstLT );
-	const Area &area( srcDst.first );
-	const Vec2i &dstOffset( srcDst.second );
-
-	int32_t srcRowBytes = srcSurface.getRowBytes();
-	int8_t srcPixelInc = srcSurface.getPixelInc();
-	uint8_t srcRedOffset = srcSurface.getRedOffset(), srcGreenOffset = srcSurface.getGreenOffset(), srcBlueOffset = srcSurface.getBlueOffset();
+	int32_t srcRowBytes = srcSurface->getRowBytes();
+	int8_t srcPixelInc = srcSurface->getPixelInc();
+	uint8_t srcRedOffset = srcSurface->getRedOffset(), srcGreenOffset = srcSurface->getGreenOffset(), srcBlueOffset = srcSurface->getBlueOffset();
 	int32_t dstRowBytes = dstSurface->getRowBytes();
 	int8_t dstPixelInc = dstSurface->getPixelInc();
 	uint8_t dstRedOffset = dstSurface->getRedOffset(), dstGreenOffset = dstSurface->getGreenOffset(), dstBlueOffset = dstSurface->getBlueOffset();
 	const T maxValue = CHANTRAIT<T>::max();
-	for( int32_t y = 0; y < area.getHeight(); ++y ) {
+	for( int32_t y = area.getY1(); y < area.getY2(); ++y ) {
 		T *dstPtr = reinterpret_cast<T*>( reinterpret_cast<uint8_t*>( dstSurface->getData() + ( dstOffset.x + area.getX1() ) * dstPixelInc ) + ( y + dstOffset.y ) * dstRowBytes );
-		const T *srcPtr = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface.getData() + area.getX1() * srcPixelInc ) + ( y + area.getY1() ) * srcRowBytes );
+		const T *srcPtr = reinterpret_cast<const T*>( reinterpret_cast<const uint8_t*>( srcSurface->getData() + area.getX1() * srcPixelInc ) + y * srcRowBytes );
 		for( int32_t x = area.getX1(); x < area.getX2(); ++x ) {
 			dstPtr[dstRedOffset] = ( srcPtr[srcRedOffset] > value ) ? maxValue : 0;
 			dstPtr[dstGreenOffset] = ( srcPtr[srcGreenOffset] > value ) ? maxValue : 0;
@@ -73,19 +71,16 @@ void thresholdImpl( const SurfaceT<T> &srcSurface, T value, const Area &srcArea,
 	}
 }
 
+// processes the already clipped \a area of \a srcChannel, writing to \a dstChannel displaced by \a dstOffset
 template<typename T>
-void thresholdImpl( const ChannelT<T> &srcChannel, T value, const Area &srcArea, const Vec2i &dstLT, ChannelT<T> *dstChannel )
+void thresholdImpl( const ChannelT<T> *srcChannel, T value, const Vec2i &dstOffset, ChannelT<T> *dstChannel, const Area &area )
 {
-	std::pair<Area,Vec2i> srcDst = clippedSrcDst( srcChannel.getBounds(), srcArea, dstChannel->getBounds(), dstLT );
-	const Area &area( srcDst.first );
-	const Vec2i &dstOffset( srcDst.second );
-
-	int8_t srcInc = srcChannel.getIncrement();
+	int8_t srcInc = srcChannel->getIncrement();
 	int8_t dstInc = dstChannel->getIncrement();
 	const T maxValue = CHANTRAIT<T>::max();
-	for( int32_t y = 0; y < area.getHeight(); ++y ) {
+	for( int32_t y = area.getY1(); y < area.getY2(); ++y ) {
 		T *dstPtr = dstChannel->getData( Vec2i( area.getX1(), y ) + dstOffset );
-		const T *srcPtr = srcChannel.getData( Vec2i( area.getX1(), y ) );
+		const T *srcPtr = srcChannel->getData( Vec2i( area.getX1(), y ) );
 		for( int32_t x = area.getX1(); x < area.getX2(); ++x ) {
 			*dstPtr = ( *srcPtr > value ) ? maxValue : 0;
 			dstPtr += dstInc;
@@ -97,29 +92,59 @@ void thresholdImpl( const ChannelT<T> &srcChannel, T value, const Area &srcArea,
 template<typename T>
 void threshold( SurfaceT<T> *surface, T value, const Area &area )
 {
+	surface->markDirty( area );
 	thresholdImpl( surface, value, area );
 }
 
 template<typename T>
 void threshold( SurfaceT<T> *surface, T value )
 {
+	surface->markDirty();
 	thresholdImpl( surface, value, surface->getBounds() );
 }
 
 template<typename T>
 void threshold( const SurfaceT<T> &surface, T value, SurfaceT<T> *dstSurface )
 {
-	thresholdImpl( surface, value, surface.getBounds(), Vec2i::zero(), dstSurface );
+	std::pair<Area,Vec2i> srcDst = clippedSrcDst( surface.getBounds(), surface.getBounds(), dstSurface->getBounds(), Vec2i::zero() );
+	dstSurface->markDirty( Area( srcDst.second, srcDst.second + srcDst.first.getSize() ) );
+	thresholdImpl( &surface, value, srcDst.second - srcDst.first.getUL(), dstSurface, srcDst.first );
 }
 
 template<typename T>
 void threshold( const ChannelT<T> &srcChannel, T value, ChannelT<T> *dstChannel )
 {
-	thresholdImpl( srcChannel, value, srcChannel.getBounds(), Vec2i::zero(), dstChannel );
+	std::pair<Area,Vec2i> srcDst = clippedSrcDst( srcChannel.getBounds(), srcChannel.getBounds(), dstChannel->getBounds(), Vec2i::zero() );
+	thresholdImpl( &srcChannel, value, srcDst.second - srcDst.first.getUL(), dstChannel, srcDst.first );
 }
 
 template<typename T>
-void calculateAdaptiveThreshold( const ChannelT<T> *srcChannel, typename CHANTRAIT<T>::Accum *integralImage, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel )
+void threshold( SurfaceT<T> *surface, T value, const Area &area, const ExecutionContextRef &context )
+{
+	void (*bandFn)( SurfaceT<T>*, T, const Area& ) = &thresholdImpl<T>;
+	surface->markDirty( area );
+	context->run( area.getClipBy( surface->getBounds() ), std::bind( bandFn, surface, value, std::_1 ) );
+}
+
+template<typename T>
+void threshold( const SurfaceT<T> &surface, T value, SurfaceT<T> *dstSurface, const ExecutionContextRef &context )
+{
+	std::pair<Area,Vec2i> srcDst = clippedSrcDst( surface.getBounds(), surface.getBounds(), dstSurface->getBounds(), Vec2i::zero() );
+	dstSurface->markDirty( Area( srcDst.second, srcDst.second + srcDst.first.getSize() ) );
+	void (*bandFn)( const SurfaceT<T>*, T, const Vec2i&, SurfaceT<T>*, const Area& ) = &thresholdImpl<T>;
+	context->run( srcDst.first, std::bind( bandFn, &surface, value, srcDst.second - srcDst.first.getUL(), dstSurface, std::_1 ) );
+}
+
+template<typename T>
+void threshold( const ChannelT<T> &srcChannel, T value, ChannelT<T> *dstChannel, const ExecutionContextRef &context )
+{
+	std::pair<Area,Vec2i> srcDst = clippedSrcDst( srcChannel.getBounds(), srcChannel.getBounds(), dstChannel->getBounds(), Vec2i::zero() );
+	void (*bandFn)( const ChannelT<T>*, T, const Vec2i&, ChannelT<T>*, const Area& ) = &thresholdImpl<T>;
+	context->run( srcDst.first, std::bind( bandFn, &srcChannel, value, srcDst.second - srcDst.first.getUL(), dstChannel, std::_1 ) );
+}
+
+template<typename T>
+void calculateAdaptiveThreshold( const ChannelT<T> *srcChannel, typename CHANTRAIT<T>::Accum *integralImage, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel, const Area &area )
 {
 	typedef typename CHANTRAIT<T>::Accum SUMT; 
 
@@ -134,12 +159,12 @@ void calculateAdaptiveThreshold( const ChannelT<T> *srcChannel, typename CHANTRA
 	const T maxValue = CHANTRAIT<T>::max();
 
 	// perform thresholding
-	for( int32_t j = 0; j < imageHeight; j++ ) {
-		T *dstLine = dstChannel->getData( 0, j );
+	for( int32_t j = area.getY1(); j < area.getY2(); j++ ) {
+		T *dstLine = dstChannel->getData( area.getX1(), j );
 		T *dst = dstLine;
-		const T *srcLine = srcChannel->getData( 0, j );
+		const T *srcLine = srcChannel->getData( area.getX1(), j );
 		const T *src = srcLine;
-		for( int32_t i = 0; i< imageWidth; i++ ) {
+		for( int32_t i = area.getX1(); i < area.getX2(); i++ ) {
 
 			// set the SxS region
 			int32_t x1 = i - s2, x2 = i + s2;
@@ -167,7 +192,7 @@ void calculateAdaptiveThreshold( const ChannelT<T> *srcChannel, typename CHANTRA
 }
 
 template<typename T>
-void calculateAdaptiveThresholdZero( const ChannelT<T> *srcChannel, typename CHANTRAIT<T>::Accum *integralImage, int32_t windowSize, ChannelT<T> *dstChannel )
+void calculateAdaptiveThresholdZero( const ChannelT<T> *srcChannel, typename CHANTRAIT<T>::Accum *integralImage, int32_t windowSize, ChannelT<T> *dstChannel, const Area &area )
 {
 	typedef typename CHANTRAIT<T>::Accum SUMT; 
 
@@ -178,12 +203,12 @@ void calculateAdaptiveThresholdZero( const ChannelT<T> *srcChannel, typename CHA
 	uint8_t dstInc = dstChannel->getIncrement();
 
 	// perform thresholding
-	for( int32_t j = 0; j < imageHeight; j++ ) {
-		T *dstLine = dstChannel->getData( 0, j );
+	for( int32_t j = area.getY1(); j < area.getY2(); j++ ) {
+		T *dstLine = dstChannel->getData( area.getX1(), j );
 		T *dst = dstLine;
-		const T *srcLine = srcChannel->getData( 0, j );
+		const T *srcLine = srcChannel->getData( area.getX1(), j );
 		const T *src = srcLine;
-		for( int32_t i = 0; i< imageWidth; i++ ) {
+		for( int32_t i = area.getX1(); i < area.getX2(); i++ ) {
 
 			// set the SxS region
 			int32_t x1 = i - s2, x2 = i + s2;
@@ -214,43 +239,6 @@ void calculateAdaptiveThresholdZero( const ChannelT<T> *srcChannel, typename CHA
 
 }
 
-template<typename T>
-void calculateIntegralImage( const ChannelT<T> &channel, typename CHANTRAIT<T>::Accum *integralImage )
-{
-	int32_t imageWidth = channel.getWidth(), imageHeight = channel.getHeight();
-	int32_t srcRowBytes = channel.getRowBytes();
-	uint8_t srcInc = channel.getIncrement();
-	const T *src = channel.getData();
-	/*for( int32_t i = 0; i < imageWidth; i++ ) {
-		// reset this column sum
-		typename CHANTRAIT<T>::Accum sum = 0;
-
-		for( int32_t j = 0; j < imageHeight; j++ ) {
-			uint32_t index = j * imageWidth + i;
-
-			sum += src[j*srcRowBytes+i*srcInc];
-			if( i == 0 )
-				integralImage[index] = sum;
-			else
-				integralImage[index] = integralImage[index-1] + sum;
-		}
-	}*/
-	for( int32_t j = 0; j < imageHeight; j++ ) {
-		// reset this column sum
-		typename CHANTRAIT<T>::Accum sum = 0;
-
-		for( int32_t i = 0; i < imageWidth; i++ ) {		
-			uint32_t index = j * imageWidth + i;
-
-			sum += src[j*srcRowBytes+i*srcInc];
-			if( j == 0 )
-				integralImage[index] = sum;
-			else
-				integralImage[index] = integralImage[index-imageWidth] + sum;
-		}
-	}
-}
-
 template<typename T>
 void adaptiveThreshold( const ChannelT<T> &srcChannel, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel )
 {
@@ -264,7 +252,7 @@ void adaptiveThreshold( const ChannelT<T> &srcChannel, int32_t windowSize, float
 	integralImage = (SUMT*)malloc( imageWidth * imageHeight * sizeof( typename CHANTRAIT<T>::Accum ) );
 	calculateIntegralImage( srcChannel, integralImage );
 	
-	calculateAdaptiveThreshold( &srcChannel, integralImage, windowSize, percentageDelta, dstChannel );
+	calculateAdaptiveThreshold( &srcChannel, integralImage, windowSize, percentageDelta, dstChannel, srcChannel.getBounds() );
 
 	free( integralImage );	
 }
@@ -282,7 +270,7 @@ void adaptiveThreshold( ChannelT<T> *channel, int32_t windowSize, float percenta
 	integralImage = (SUMT*)malloc( imageWidth * imageHeight * sizeof( typename CHANTRAIT<T>::Accum ) );
 	calculateIntegralImage( *channel, integralImage );
 
-	calculateAdaptiveThreshold( channel, integralImage, windowSize, percentageDelta, channel );
+	calculateAdaptiveThreshold( channel, integralImage, windowSize, percentageDelta, channel, channel->getBounds() );
 
 	free( integralImage );	
 }
@@ -300,7 +288,7 @@ void adaptiveThresholdZero( ChannelT<T> *channel, int32_t windowSize )
 	integralImage = (SUMT*)malloc( imageWidth * imageHeight * sizeof( typename CHANTRAIT<T>::Accum ) );
 	calculateIntegralImage( *channel, integralImage );
 	
-	calculateAdaptiveThresholdZero( channel, integralImage, windowSize, channel );
+	calculateAdaptiveThresholdZero( channel, integralImage, windowSize, channel, channel->getBounds() );
 
 	free( integralImage );	
 }
@@ -318,7 +306,7 @@ void adaptiveThresholdZero( const ChannelT<T> &srcChannel, int32_t windowSize, C
 	integralImage = (SUMT*)malloc( imageWidth * imageHeight * sizeof( typename CHANTRAIT<T>::Accum ) );
 	calculateIntegralImage( srcChannel, integralImage );
 	
-	calculateAdaptiveThresholdZero( &srcChannel, integralImage, windowSize, dstChannel );
+	calculateAdaptiveThresholdZero( &srcChannel, integralImage, windowSize, dstChannel, srcChannel.getBounds() );
 
 	free( integralImage );	
 }
@@ -347,12 +335,39 @@ AdaptiveThresholdT<T>::AdaptiveThresholdT( ChannelT<T> *channel )
 
 template<typename T>
 void AdaptiveThresholdT<T>::calculate( int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel ) {
+	calculate( windowSize, percentageDelta, dstChannel, mObj->mChannel->getBounds() );
+}
+
+template<typename T>
+void AdaptiveThresholdT<T>::calculate( int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel, const Area &dirtyArea ) {
+	// a pixel's result depends on the source inside its window, so the results within windowSize / 2 of dirtyArea may change
+	const int32_t s2 = windowSize / 2;
+	Area area( dirtyArea.getX1() - s2, dirtyArea.getY1() - s2, dirtyArea.getX2() + s2, dirtyArea.getY2() + s2 );
+	area.clipBy( mObj->mChannel->getBounds() );
+	area.clipBy( dstChannel->getBounds() );
+	if( area.getWidth() <= 0 || area.getHeight() <= 0 )
+		return;
+
 	if( percentageDelta < 0.0001f ) {
-		calculateAdaptiveThresholdZero( mObj->mChannel, mObj->mIntegralImage, windowSize, dstChannel );
+		calculateAdaptiveThresholdZero( mObj->mChannel, mObj->mIntegralImage, windowSize, dstChannel, area );
 	} else {
-		calculateAdaptiveThreshold( mObj->mChannel, mObj->mIntegralImage, windowSize, percentageDelta, dstChannel );
+		calculateAdaptiveThreshold( mObj->mChannel, mObj->mIntegralImage, windowSize, percentageDelta, dstChannel, area );
 	}
-	
+}
+
+template<typename T>
+void AdaptiveThresholdT<T>::update( const Area &dirtyArea ) {
+	updateIntegralImage( *mObj->mChannel, mObj->mIntegralImage, dirtyArea );
+}
+
+template<typename T>
+void AdaptiveThresholdT<T>::update( ChannelT<T> *channel, const Area &dirtyArea ) {
+	if( ( channel->getWidth() != mObj->mImageWidth ) || ( channel->getHeight() != mObj->mImageHeight ) )
+		throw AdaptiveThresholdExcSizeMismatch();
+
+	mObj->mChannel = channel;
+	mObj->mIncrement = channel->getIncrement();
+	updateIntegralImage( *channel, mObj->mIntegralImage, dirtyArea );
 }
 
 template class AdaptiveThresholdT<uint8_t>;
@@ -363,6 +378,9 @@ template class AdaptiveThresholdT<float>;
 	template void threshold( SurfaceT<T> *surface, T value, const Area &area ); \
 	template void threshold( const SurfaceT<T> &srcSurface, T value, SurfaceT<T> *dstSurface );\
 	template void threshold( const ChannelT<T> &srcChannel, T value, ChannelT<T> *dstChannel );\
+	template void threshold( SurfaceT<T> *surface, T value, const Area &area, const ExecutionContextRef &context ); \
+	template void threshold( const SurfaceT<T> &srcSurface, T value, SurfaceT<T> *dstSurface, const ExecutionContextRef &context );\
+	template void threshold( const ChannelT<T> &srcChannel, T value, ChannelT<T> *dstChannel, const ExecutionContextRef &context );\
 	template void adaptiveThreshold( const ChannelT<T> &srcChannel, int32_t windowSize, float percentageDelta, ChannelT<T> *dstChannel ); \
 	template void adaptiveThreshold( ChannelT<T> *channel, int32_t windowSize, float percentageDelta ); \
 	template void adaptiveThresholdZero( ChannelT<T> *channel, int32_t windowSize ); \
@@ -22,10 +22,13 @@
 
 #include "cinder/app/App.h"
 #include "cinder/params/Params.h"
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Fbo.h"
 
 #include "AntTweakBar.h"
 
 #include <boost/assign/list_of.hpp>
+#include <cstring>
 
 using namespace std;
 
@@ -66,6 +69,99 @@ namespace {
 #undef SYNONYM
 #undef HOMONYM
 
+// A parameter whose value the draw cache compares against a snapshot
+struct Watch {
+	Watch( TwBar *bar, const std::string &name, const void *param, int type, bool readOnly )
+		: mBar( bar ), mName( name ), mParam( param ), mIsString( type == TW_TYPE_STDSTRING ), mReadOnly( readOnly )
+	{
+		switch( type ) {
+			case TW_TYPE_BOOLCPP: mSnapshot.resize( sizeof(bool) ); break;
+			case TW_TYPE_FLOAT: mSnapshot.resize( sizeof(float) ); break;
+			case TW_TYPE_DOUBLE: mSnapshot.resize( sizeof(double) ); break;
+			case TW_TYPE_DIR3F: mSnapshot.resize( sizeof(Vec3f) ); break;
+			case TW_TYPE_QUAT4F: mSnapshot.resize( sizeof(Quatf) ); break;
+			case TW_TYPE_COLOR3F: mSnapshot.resize( sizeof(Color) ); break;
+			case TW_TYPE_COLOR4F: mSnapshot.resize( sizeof(ColorA) ); break;
+			default: mSnapshot.resize( sizeof(int32_t) ); break; // TW_TYPE_INT32 and enums
+		}
+		update();
+	}
+
+	//! Returns whether the value differs from the snapshot, updating the snapshot if so
+	bool update()
+	{
+		if( mIsString ) {
+			const std::string &value = *static_cast<const std::string*>( mParam );
+			if( value == mStringSnapshot )
+				return false;
+			mStringSnapshot = value;
+		}
+		else {
+			if( memcmp( &mSnapshot[0], mParam, mSnapshot.size() ) == 0 )
+				return false;
+			memcpy( &mSnapshot[0], mParam, mSnapshot.size() );
+		}
+		return true;
+	}
+
+	TwBar					*mBar;
+	std::string				mName;
+	const void				*mParam;
+	bool					mIsString, mReadOnly;
+	std::vector<uint8_t>	mSnapshot;
+	std::string				mStringSnapshot;
+};
+
+struct DrawCache {
+	DrawCache() : mEnabled( false ), mDirty( true ), mReadOnlyInterval( 0.2 ), mLastReadOnlyCheck( -1 ), mLastInput( -1 ) {}
+
+	bool				mEnabled, mDirty;
+	double				mReadOnlyInterval, mLastReadOnlyCheck, mLastInput;
+	std::vector<Watch>	mWatches;
+	gl::Fbo				mFbo;
+};
+
+DrawCache& getDrawCache()
+{
+	// never destroyed, as the Fbo would outlive the GL context
+	static DrawCache *sDrawCache = new DrawCache;
+	return *sDrawCache;
+}
+
+// hover highlights, popups and the like follow input, so the cache redraws for a while after any
+const double sInputRedrawSeconds = 1.0;
+
+//! Notes input which AntTweakBar \a handled, returning \a handled
+bool noteInput( bool handled )
+{
+	if( handled )
+		getDrawCache().mLastInput = app::App::get()->getElapsedSeconds();
+	return handled;
+}
+
+void invalidate()
+{
+	getDrawCache().mDirty = true;
+}
+
+void removeWatches( TwBar *bar, const char *name )
+{
+	std::vector<Watch> &watches = getDrawCache().mWatches;
+	for( std::vector<Watch>::iterator watchIt = watches.begin(); watchIt != watches.end(); ) {
+		if( watchIt->mBar == bar && ( ! name || watchIt->mName == name ) )
+			watchIt = watches.erase( watchIt );
+		else
+			++watchIt;
+	}
+	invalidate();
+}
+
+void deleteBar( TwBar *bar )
+{
+	removeWatches( bar, NULL );
+	TwDeleteBar( bar );
+}
+
 bool mouseDown( app::MouseEvent event )
 {
 	TwMouseButtonID button;
@@ -75,7 +171,7 @@ bool mouseDown( app::MouseEvent event )
 		button = TW_MOUSE_RIGHT;
 	else
 		button = TW_MOUSE_MIDDLE;
-	return TwMouseButton( TW_MOUSE_PRESSED, button ) != 0;
+	return noteInput( TwMouseButton( TW_MOUSE_PRESSED, button ) != 0 );
 }
 
 bool mouseUp( app::MouseEvent event )
@@ -87,19 +183,19 @@ bool mouseUp( app::MouseEvent event )
 		button = TW_MOUSE_RIGHT;
 	else
 		button = TW_MOUSE_MIDDLE;
-	return TwMouseButton( TW_MOUSE_RELEASED, button ) != 0;
+	return noteInput( TwMouseButton( TW_MOUSE_RELEASED, button ) != 0 );
 }
 
 bool mouseWheel( app::MouseEvent event )
 {
 	static float sWheelPos = 0;
 	sWheelPos += event.getWheelIncrement();
-	return TwMouseWheel( (int)(sWheelPos) ) != 0;
+	return noteInput( TwMouseWheel( (int)(sWheelPos) ) != 0 );
 }
 
 bool mouseMove( app::MouseEvent event )
 {
-	return TwMouseMotion( event.getX(), event.getY() ) != 0;
+	return noteInput( TwMouseMotion( event.getX(), event.getY() ) != 0 );
 }
 
 bool keyDown( app::KeyEvent event )
@@ -111,16 +207,17 @@ bool keyDown( app::KeyEvent event )
 		kmod |= TW_KMOD_CTRL;
 	if( event.isAltDown() )
 		kmod |= TW_KMOD_ALT;
-	return TwKeyPressed(
+	return noteInput( TwKeyPressed(
             (specialKeys.count( event.getCode() ) > 0)
                 ? specialKeys[event.getCode()]
                 : event.getChar(),
-            kmod ) != 0;
+            kmod ) != 0 );
 }
 
 bool resize( app::ResizeEvent event )
 {
 	TwWindowSize( event.getWidth(), event.getHeight() );
+	invalidate();
 	return false;
 }
 
@@ -164,29 +261,112 @@ void initAntGl()
 InterfaceGl::InterfaceGl( const std::string &title, const Vec2i &size, const ColorA color )
 {
 	initAntGl();
-	mBar = std::shared_ptr<TwBar>( TwNewBar( title.c_str() ), TwDeleteBar );
+	mBar = std::shared_ptr<TwBar>( TwNewBar( title.c_str() ), deleteBar );
 	char optionsStr[1024];
 	sprintf( optionsStr, "`%s` size='%d %d' color='%d %d %d' alpha=%d", title.c_str(), size.x, size.y, (int)(color.r * 255), (int)(color.g * 255), (int)(color.b * 255), (int)(color.a * 255) );
 	TwDefine( optionsStr );
 	
 	TwCopyStdStringToClientFunc( implStdStringToClient );
+	invalidate();
 }
 
 void InterfaceGl::draw()
 {
-	TwDraw();
+	DrawCache &cache = getDrawCache();
+	if( ! cache.mEnabled ) {
+		TwDraw();
+		return;
+	}
+
+	double now = app::App::get()->getElapsedSeconds();
+	bool checkReadOnly = ( now - cache.mLastReadOnlyCheck >= cache.mReadOnlyInterval ) || ( now < cache.mLastReadOnlyCheck );
+	if( checkReadOnly )
+		cache.mLastReadOnlyCheck = now;
+	for( std::vector<Watch>::iterator watchIt = cache.mWatches.begin(); watchIt != cache.mWatches.end(); ++watchIt ) {
+		if( ( checkReadOnly || ! watchIt->mReadOnly ) && watchIt->update() ) {
+			// AntTweakBar otherwise rereads values only at its own refresh interval, which could leave the change out of the cache
+			TwRefreshBar( watchIt->mBar );
+			cache.mDirty = true;
+		}
+	}
+	if( cache.mLastInput >= 0 && now - cache.mLastInput < sInputRedrawSeconds )
+		cache.mDirty = true;
+
+	Vec2i size = app::getWindowSize();
+	if( ! cache.mFbo || cache.mFbo.getSize() != size ) {
+		gl::Fbo::Format format;
+		format.enableDepthBuffer( false );
+		cache.mFbo = gl::Fbo( size.x, size.y, format );
+		cache.mFbo.getTexture().setFlipped();
+		cache.mDirty = true;
+	}
+
+	if( cache.mDirty ) {
+		gl::SaveFramebufferBinding saveFramebuffer;
+		cache.mFbo.bindFramebuffer();
+		glPushAttrib( GL_COLOR_BUFFER_BIT | GL_VIEWPORT_BIT );
+		gl::setViewport( cache.mFbo.getBounds() );
+		glClearColor( 0, 0, 0, 0 );
+		glClear( GL_COLOR_BUFFER_BIT );
+		TwDraw();
+		glPopAttrib();
+		cache.mDirty = false;
+	}
+
+	// the bars were blended over transparent black, which leaves their colors premultiplied
+	glPushAttrib( GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_CURRENT_BIT );
+	gl::pushMatrices();
+	gl::setMatricesWindow( size );
+	glDisable( GL_DEPTH_TEST );
+	glEnable( GL_BLEND );
+	glBlendFunc( GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
+	glColor4f( 1, 1, 1, 1 );
+	gl::draw( cache.mFbo.getTexture(), Rectf( 0, 0, (float)size.x, (float)size.y ) );
+	gl::popMatrices();
+	glPopAttrib();
+}
+
+void InterfaceGl::enableDrawCache( bool enable )
+{
+	DrawCache &cache = getDrawCache();
+	cache.mEnabled = enable;
+	cache.mDirty = true;
+	if( ! enable )
+		cache.mFbo.reset();
+}
+
+bool InterfaceGl::isDrawCacheEnabled()
+{
+	return getDrawCache().mEnabled;
+}
+
+void InterfaceGl::invalidateDrawCache()
+{
+	invalidate();
+}
+
+void InterfaceGl::setReadOnlyRefreshInterval( double seconds )
+{
+	getDrawCache().mReadOnlyInterval = seconds;
+}
+
+double InterfaceGl::getReadOnlyRefreshInterval()
+{
+	return getDrawCache().mReadOnlyInterval;
 }
 
 void InterfaceGl::show( bool visible )
 {
 	int32_t visibleInt = ( visible ) ? 1 : 0;
 	TwSetParam( mBar.get(), NULL, "visible", TW_PARAM_INT32, 1, &visibleInt );
+	invalidate();
 }
 
 void InterfaceGl::hide()
 {
 	int32_t visibleInt = 0;
 	TwSetParam( mBar.get(), NULL, "visible", TW_PARAM_INT32, 1, &visibleInt );
+	invalidate();
 }
 
 bool InterfaceGl::isVisible() const
@@ -202,6 +382,8 @@ void InterfaceGl::implAddParam( const std::string &name, void *param, int type,
 		TwAddVarRO( mBar.get(), name.c_str(), (TwType)type, param, optionsStr.c_str() );
 	else
 		TwAddVarRW( mBar.get(), name.c_str(), (TwType)type, param, optionsStr.c_str() );
+	getDrawCache().mWatches.push_back( Watch( mBar.get(), name, param, type, readOnly ) );
+	invalidate();
 }
 
 void InterfaceGl::addParam( const std::string &name, bool *param, const std::string &optionsStr, bool readOnly )
@@ -263,6 +445,8 @@ void InterfaceGl::addParam( const std::string &name, const std::vector<std::stri
 		TwAddVarRO( mBar.get(), name.c_str(), evType, param, optionsStr.c_str() );
 	else
 		TwAddVarRW( mBar.get(), name.c_str(), evType, param, optionsStr.c_str() );
+	getDrawCache().mWatches.push_back( Watch( mBar.get(), name, param, TW_TYPE_INT32, readOnly ) );
+	invalidate();
 		
 	delete [] ev;
 }
@@ -270,11 +454,13 @@ void InterfaceGl::addParam( const std::string &name, const std::vector<std::stri
 void InterfaceGl::addSeparator( const std::string &name, const std::string &optionsStr )
 {
 	TwAddSeparator( mBar.get(), name.c_str(), optionsStr.c_str() );
+	invalidate();
 }
 
 void InterfaceGl::addText( const std::string &name, const std::string &optionsStr )
 {
 	TwAddButton( mBar.get(), name.c_str(), NULL, NULL, optionsStr.c_str() );
+	invalidate();
 }
 
 namespace { // anonymous namespace
@@ -290,11 +476,13 @@ void InterfaceGl::addButton( const std::string &name, const std::function<void (
 	std::shared_ptr<std::function<void ()> > callbackPtr( new std::function<void ()>( callback ) );
 	mButtonCallbacks.push_back( callbackPtr );
 	TwAddButton( mBar.get(), name.c_str(), implButtonCallback, (void*)callbackPtr.get(), optionsStr.c_str() );
+	invalidate();
 }
 
 void InterfaceGl::removeParam( const std::string &name )
 {
 	TwRemoveVar( mBar.get(), name.c_str() );
+	removeWatches( mBar.get(), name.c_str() );
 }
 
 void InterfaceGl::setOptions( const std::string &name, const std::string &optionsStr )
@@ -304,6 +492,7 @@ void InterfaceGl::setOptions( const std::string &name, const std::string &option
 		target += "/`" + name + "`";
 
 	TwDefine( ( target + " " + optionsStr ).c_str() );
+	invalidate();
 }
 
 } } // namespace cinder::params
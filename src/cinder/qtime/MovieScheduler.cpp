@@ -0,0 +1,332 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+
+#if ! defined( __LP64__ )
+
+#include "cinder/qtime/MovieScheduler.h"
+#include "cinder/qtime/QuickTimeUtils.h"
+#include "cinder/Utilities.h"
+
+#include <cmath>
+
+#if defined( CINDER_MAC )
+	#include <QuickTime/QuickTime.h>
+	#include <CoreVideo/CoreVideo.h>
+#else
+	#pragma push_macro( "__STDC_CONSTANT_MACROS" )
+	#pragma push_macro( "_STDINT_H" )
+		#undef __STDC_CONSTANT_MACROS
+		#if _MSC_VER >= 1600 // VC10 or greater
+			#define _STDINT_H
+		#endif
+		#include <QTML.h>
+		#include <CVPixelBuffer.h>
+		#include <ImageCompression.h>
+		#include <Movies.h>
+	#pragma pop_macro( "_STDINT_H" )
+	#pragma pop_macro( "__STDC_CONSTANT_MACROS" )
+#endif
+
+namespace cinder { namespace qtime {
+
+MovieScheduler::Entry::Entry( const MovieSurface &movie, bool loop, uint32_t prefetchFrames )
+	: mMovie( movie ), mLoop( loop ), mWorkerEpoch( 0xFFFFFFFF ), mNextTime( 0 ), mAttached( false ), mNumWorkerDropped( 0 ),
+	mReady( prefetchFrames ), mHasPending( false ), mNumDropped( 0 )
+{
+	mDuration = movie.getDuration();
+	float frameRate = movie.getFramerate();
+	mFrameDuration = ( frameRate > 0 ) ? ( 1.0 / frameRate ) : ( 1 / 30.0 );
+}
+
+MovieScheduler::MovieScheduler( uint32_t numThreads, uint32_t prefetchFrames )
+	: mPrefetchFrames( std::max<uint32_t>( prefetchFrames, 1 ) ), mQuit( false ), mTimer( false ), mClockOffset( 0 ), mEpoch( 0 )
+{
+	if( numThreads == 0 )
+		numThreads = std::min<uint32_t>( std::max<uint32_t>( std::thread::hardware_concurrency(), 1 ), 4 );
+
+	for( uint32_t t = 0; t < numThreads; ++t )
+		mWorkers.push_back( std::shared_ptr<Worker>( new Worker ) );
+
+	startWorkers();
+}
+
+MovieScheduler::~MovieScheduler()
+{
+	stopWorkers();
+	reclaimMovies();
+}
+
+size_t MovieScheduler::addMovie( const MovieSurface &movie, bool loop )
+{
+	std::shared_ptr<Entry> entry( new Entry( movie, loop, mPrefetchFrames ) );
+
+	// QuickTime requires a Movie to be attached to the thread which tasks it; the worker attaches it on its next pass
+	::DetachMovieFromCurrentThread( entry->mMovie.getObj()->mMovie );
+
+	Worker *worker = mWorkers.front().get();
+	for( std::vector<std::shared_ptr<Worker> >::const_iterator workerIt = mWorkers.begin(); workerIt != mWorkers.end(); ++workerIt ) {
+		if( (*workerIt)->mEntries.size() < worker->mEntries.size() )
+			worker = workerIt->get();
+	}
+
+	worker->mMutex.lock();
+		worker->mEntries.push_back( entry );
+	worker->mMutex.unlock();
+
+	mMovies.push_back( entry );
+	return mMovies.size() - 1;
+}
+
+void MovieScheduler::clear()
+{
+	stopWorkers();
+	reclaimMovies();
+	startWorkers();
+}
+
+void MovieScheduler::startWorkers()
+{
+	mQuit = false;
+	for( std::vector<std::shared_ptr<Worker> >::iterator workerIt = mWorkers.begin(); workerIt != mWorkers.end(); ++workerIt )
+		(*workerIt)->mThread = std::shared_ptr<std::thread>( new std::thread( std::bind( &MovieScheduler::workerThreadFn, this, workerIt->get() ) ) );
+}
+
+void MovieScheduler::stopWorkers()
+{
+	mQuit = true;
+	for( std::vector<std::shared_ptr<Worker> >::iterator workerIt = mWorkers.begin(); workerIt != mWorkers.end(); ++workerIt ) {
+		if( (*workerIt)->mThread ) {
+			(*workerIt)->mThread->join();
+			(*workerIt)->mThread.reset();
+		}
+	}
+}
+
+// the workers have detached their movies by now, so hand them all back to this thread
+void MovieScheduler::reclaimMovies()
+{
+	for( std::vector<std::shared_ptr<Entry> >::iterator entryIt = mMovies.begin(); entryIt != mMovies.end(); ++entryIt )
+		::AttachMovieToCurrentThread( (*entryIt)->mMovie.getObj()->mMovie );
+
+	for( std::vector<std::shared_ptr<Worker> >::iterator workerIt = mWorkers.begin(); workerIt != mWorkers.end(); ++workerIt )
+		(*workerIt)->mEntries.clear();
+	mMovies.clear();
+}
+
+void MovieScheduler::workerThreadFn( Worker *worker )
+{
+	ThreadSetup threadSetup;
+	::EnterMoviesOnThread( 0 );
+
+	while( ! mQuit ) {
+		double clock;
+		uint32_t epoch;
+		getClock( &clock, &epoch );
+
+		bool busy = false;
+		worker->mMutex.lock();
+			for( std::vector<std::shared_ptr<Entry> >::iterator entryIt = worker->mEntries.begin(); entryIt != worker->mEntries.end(); ++entryIt ) {
+				if( ! (*entryIt)->mAttached ) {
+					::AttachMovieToCurrentThread( (*entryIt)->mMovie.getObj()->mMovie );
+					(*entryIt)->mAttached = true;
+				}
+				busy = serviceEntry( entryIt->get(), epoch, clock ) || busy;
+			}
+		worker->mMutex.unlock();
+
+		// every movie is a full prefetch ahead of the clock
+		if( ! busy )
+			ci::sleep( 1.0f );
+	}
+
+	worker->mMutex.lock();
+		for( std::vector<std::shared_ptr<Entry> >::iterator entryIt = worker->mEntries.begin(); entryIt != worker->mEntries.end(); ++entryIt ) {
+			if( (*entryIt)->mAttached ) {
+				::DetachMovieFromCurrentThread( (*entryIt)->mMovie.getObj()->mMovie );
+				(*entryIt)->mAttached = false;
+			}
+		}
+	worker->mMutex.unlock();
+
+	::ExitMoviesOnThread();
+}
+
+// decodes the next frame of \a entry if it's within the prefetch window; returns whether any work was done
+bool MovieScheduler::serviceEntry( Entry *entry, uint32_t epoch, double clock )
+{
+	MovieBase::Obj *obj = entry->mMovie.getObj();
+	if( ! obj->mVisualContext )
+		return false;
+
+	if( entry->mWorkerEpoch != epoch ) {
+		entry->mWorkerEpoch = epoch;
+		entry->mNextTime = clock;
+	}
+
+	// frames the clock has already passed are skipped rather than decoded late
+	if( entry->mNextTime + entry->mFrameDuration <= clock ) {
+		uint32_t numLate = (uint32_t)( ( clock - entry->mNextTime ) / entry->mFrameDuration );
+		entry->mNumWorkerDropped += numLate;
+		entry->mNextTime += numLate * entry->mFrameDuration;
+	}
+
+	if( ( ! entry->mLoop ) && ( entry->mNextTime >= entry->mDuration ) )
+		return false;
+	if( ( entry->mNextTime > clock + mPrefetchFrames * entry->mFrameDuration ) || ( ! entry->mReady.isNotFull() ) )
+		return false;
+
+	double movieTime = entry->mNextTime;
+	if( entry->mLoop && ( entry->mDuration > 0 ) ) {
+		movieTime = fmod( movieTime, (double)entry->mDuration );
+		if( movieTime < 0 )
+			movieTime += entry->mDuration;
+	}
+	else if( movieTime < 0 )
+		movieTime = 0;
+
+	Frame frame;
+	frame.mEpoch = epoch;
+	frame.mTime = entry->mNextTime;
+
+	obj->lock();
+		::SetMovieTimeValue( obj->mMovie, (TimeValue)( movieTime * ::GetMovieTimeScale( obj->mMovie ) ) );
+		::MoviesTask( obj->mMovie, 0 );
+		::QTVisualContextTask( obj->mVisualContext );
+		CVImageBufferRef image = NULL;
+		if( ( ::QTVisualContextCopyImageForTime( obj->mVisualContext, kCFAllocatorDefault, NULL, &image ) == noErr ) && image )
+			frame.mSurface = convertCVPixelBufferToSurface( reinterpret_cast<CVPixelBufferRef>( image ) );
+	obj->unlock();
+
+	entry->mNextTime += entry->mFrameDuration;
+
+	// only this thread pushes, so the space checked above is still free; a frame without a new image leaves the previous one showing
+	if( frame.mSurface )
+		entry->mReady.tryPushFront( frame );
+
+	return true;
+}
+
+void MovieScheduler::update()
+{
+	double clock;
+	uint32_t epoch;
+	getClock( &clock, &epoch );
+
+	for( std::vector<std::shared_ptr<Entry> >::iterator entryIt = mMovies.begin(); entryIt != mMovies.end(); ++entryIt ) {
+		Entry *entry = entryIt->get();
+
+		// take the latest frame which is due, holding on to the first which isn't
+		Frame due;
+		bool hasDue = false;
+		while( true ) {
+			if( ! entry->mHasPending ) {
+				if( ! entry->mReady.tryPopBack( &entry->mPending ) )
+					break;
+				entry->mHasPending = true;
+			}
+
+			if( entry->mPending.mEpoch == epoch ) {
+				if( entry->mPending.mTime > clock )
+					break;
+				if( hasDue )
+					++entry->mNumDropped;
+				due = entry->mPending;
+				hasDue = true;
+			}
+
+			entry->mPending = Frame();
+			entry->mHasPending = false;
+		}
+
+		if( hasDue ) {
+			entry->mSurface = due.mSurface;
+			if( ! entry->mTextureCache ) {
+				gl::Texture::Format format;
+				format.setTargetRect();
+				entry->mTextureCache = gl::TextureCache( due.mSurface, format );
+			}
+			entry->mTexture = entry->mTextureCache.cache( due.mSurface );
+		}
+	}
+}
+
+uint32_t MovieScheduler::getNumDroppedFrames() const
+{
+	uint32_t result = 0;
+	for( std::vector<std::shared_ptr<Entry> >::const_iterator entryIt = mMovies.begin(); entryIt != mMovies.end(); ++entryIt )
+		result += (*entryIt)->mNumDropped + (*entryIt)->mNumWorkerDropped;
+
+	return result;
+}
+
+void MovieScheduler::play()
+{
+	std::lock_guard<std::mutex> lock( mClockMutex );
+	if( mTimer.isStopped() )
+		mTimer.start();
+}
+
+void MovieScheduler::stop()
+{
+	std::lock_guard<std::mutex> lock( mClockMutex );
+	if( ! mTimer.isStopped() ) {
+		mClockOffset += mTimer.getSeconds();
+		mTimer.stop();
+	}
+}
+
+bool MovieScheduler::isPlaying() const
+{
+	std::lock_guard<std::mutex> lock( mClockMutex );
+	return ! mTimer.isStopped();
+}
+
+double MovieScheduler::getTime() const
+{
+	double result;
+	uint32_t epoch;
+	getClock( &result, &epoch );
+	return result;
+}
+
+void MovieScheduler::seekToTime( double seconds )
+{
+	std::lock_guard<std::mutex> lock( mClockMutex );
+	mClockOffset = seconds;
+	if( ! mTimer.isStopped() )
+		mTimer.start();
+	++mEpoch;
+}
+
+void MovieScheduler::getClock( double *resultTime, uint32_t *resultEpoch ) const
+{
+	std::lock_guard<std::mutex> lock( mClockMutex );
+	*resultTime = mClockOffset + ( mTimer.isStopped() ? 0 : mTimer.getSeconds() );
+	*resultEpoch = mEpoch;
+}
+
+} } // namespace cinder::qtime
+
+#endif // ! defined( __LP64__ )
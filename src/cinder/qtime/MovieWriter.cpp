@@ -78,7 +78,7 @@ MovieWriter::Format::Format( uint32_t codec, float quality )
 }
 
 MovieWriter::Format::Format( const ICMCompressionSessionOptionsRef options, uint32_t codec, float quality, float frameRate, bool enableMultiPass )
-	: mCodec( codec ), mEnableMultiPass( enableMultiPass )
+	: mCodec( codec ), mEnableMultiPass( enableMultiPass ), mAsyncQueueSize( 0 )
 {
 	::ICMCompressionSessionOptionsCreateCopy( NULL, options, &mOptions );
 	setQuality( quality );
@@ -88,7 +88,7 @@ MovieWriter::Format::Format( const ICMCompressionSessionOptionsRef options, uint
 }
 
 MovieWriter::Format::Format( const Format &format )
-	: mCodec( format.mCodec ), mTimeBase( format.mTimeBase ), mDefaultTime( format.mDefaultTime ), mGamma( format.mGamma ), mEnableMultiPass( format.mEnableMultiPass ), mQualityFloat( format.mQualityFloat )
+	: mCodec( format.mCodec ), mTimeBase( format.mTimeBase ), mDefaultTime( format.mDefaultTime ), mGamma( format.mGamma ), mEnableMultiPass( format.mEnableMultiPass ), mQualityFloat( format.mQualityFloat ), mAsyncQueueSize( format.mAsyncQueueSize )
 {
 	::ICMCompressionSessionOptionsCreateCopy( NULL, format.mOptions, &mOptions );
 }
@@ -106,6 +106,7 @@ void MovieWriter::Format::initDefaults()
 	mDefaultTime = 1 / 30.0f;
 	mGamma = PLATFORM_DEFAULT_GAMMA;
 	mEnableMultiPass = false;
+	mAsyncQueueSize = 0;
 
 	enableTemporal( true );
 	enableReordering( true );
@@ -181,6 +182,7 @@ const MovieWriter::Format& MovieWriter::Format::operator=( const Format &format
 	mDefaultTime = format.mDefaultTime;
 	mGamma = format.mGamma;
 	mEnableMultiPass = format.mEnableMultiPass;
+	mAsyncQueueSize = format.mAsyncQueueSize;
 
 	return *this;
 }
@@ -199,7 +201,7 @@ MovieWriter::Obj::~Obj()
 }
 
 MovieWriter::Obj::Obj( const fs::path &path, int32_t width, int32_t height, const Format &format )
-	: mPath( path ), mWidth( width ), mHeight( height ), mFormat( format ), mFinished( false )
+	: mPath( path ), mWidth( width ), mHeight( height ), mFormat( format ), mFinished( false ), mEncodeFailed( false )
 {	
     OSErr       err = noErr;
     Handle      dataRef;
@@ -241,6 +243,12 @@ MovieWriter::Obj::Obj( const fs::path &path, int32_t width, int32_t height, cons
 
 	mCurrentTimeValue = 0;
 	mNumFrames = 0;
+	mNumFramesAdded = 0;
+
+	// sized to hold a few frames of the movie's dimensions
+	mSurfacePool = SurfacePool::create( std::max<size_t>( 4, mFormat.mAsyncQueueSize + 2 ) * width * height * 4 );
+	if( mFormat.mAsyncQueueSize > 0 )
+		startEncodeThread();
 }
 	
 void MovieWriter::Obj::addFrame( const ImageSourceRef &imageSource, float duration )
@@ -248,6 +256,79 @@ void MovieWriter::Obj::addFrame( const ImageSourceRef &imageSource, float durati
 	if( mFinished )
 		throw MovieWriterExcAlreadyFinished();
 
+	if( ! mQueue ) {
+		encodeFrame( imageSource, duration );
+		++mNumFramesAdded;
+	}
+	else {
+		// the ImageSource may not outlive this call, so it's decoded into a pooled Surface here and converted for the codec on the encode thread
+		Surface8u surface( imageSource->getWidth(), imageSource->getHeight(), imageSource->hasAlpha(), SurfaceChannelOrder::ARGB, mSurfacePool );
+		imageSource->load( (ImageTargetRef)surface );
+		addFrame( surface, duration );
+	}
+}
+
+void MovieWriter::Obj::addFrame( const Surface8u &surface, float duration )
+{
+	if( mFinished )
+		throw MovieWriterExcAlreadyFinished();
+	if( mEncodeFailed )
+		throw MovieWriterExcFrameEncode();
+
+	if( ! mQueue )
+		encodeFrame( (ImageSourceRef)surface, duration );
+	else // blocks only when the encode thread has fallen a full queue behind
+		mQueue->pushFront( std::make_pair( surface, duration ) );
+	++mNumFramesAdded;
+}
+
+void MovieWriter::Obj::startEncodeThread()
+{
+	mQueue = std::shared_ptr<ConcurrentCircularBuffer<std::pair<Surface8u,float> > >( new ConcurrentCircularBuffer<std::pair<Surface8u,float> >( mFormat.mAsyncQueueSize ) );
+	// QuickTime requires a Movie to be attached to the thread which adds media to it
+	::DetachMovieFromCurrentThread( mMovie );
+	mEncodeThread = std::shared_ptr<std::thread>( new std::thread( std::bind( &MovieWriter::Obj::encodeThreadFn, this ) ) );
+}
+
+void MovieWriter::Obj::stopEncodeThread()
+{
+	if( ! mEncodeThread )
+		return;
+
+	mQueue->pushFront( std::make_pair( Surface8u(), 0.0f ) );
+	mEncodeThread->join();
+	mEncodeThread.reset();
+	::AttachMovieToCurrentThread( mMovie );
+}
+
+void MovieWriter::Obj::encodeThreadFn()
+{
+	ThreadSetup threadSetup;
+	::EnterMoviesOnThread( 0 );
+	::AttachMovieToCurrentThread( mMovie );
+
+	while( true ) {
+		std::pair<Surface8u,float> frame;
+		mQueue->popBack( &frame );
+		if( ! frame.first )
+			break;
+		// after a failure the remaining frames are drained without encoding so that addFrame() can't block forever
+		if( mEncodeFailed )
+			continue;
+		try {
+			encodeFrame( (ImageSourceRef)frame.first, frame.second );
+		}
+		catch( ... ) {
+			mEncodeFailed = true;
+		}
+	}
+
+	::DetachMovieFromCurrentThread( mMovie );
+	::ExitMoviesOnThread();
+}
+
+void MovieWriter::Obj::encodeFrame( const ImageSourceRef &imageSource, float duration )
+{
 	if( duration <= 0 )
 		duration = mFormat.mDefaultTime;
 
@@ -282,7 +363,7 @@ void MovieWriter::Obj::addFrame( const ImageSourceRef &imageSource, float durati
 	::CVPixelBufferRelease( pixelBuffer );
 
 	if( err )
-		MovieWriterExcFrameEncode();
+		throw MovieWriterExcFrameEncode();
 }
 
 extern "C" {
@@ -427,6 +508,8 @@ void MovieWriter::Obj::finish()
 	if( mFinished )
 		return;
 
+	stopEncodeThread();
+
 	::ICMCompressionSessionCompleteFrames( mCompressionSession, true, 0, 0 );
 
 	mFinished = true; // set this in case of throw, otherwise we could loop forever
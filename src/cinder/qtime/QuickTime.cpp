@@ -26,8 +26,10 @@
 #include "cinder/qtime/QuickTime.h"
 #include "cinder/qtime/QuickTimeUtils.h"
 #include "cinder/Cinder.h"
+#include "cinder/Profiler.h"
 #include "cinder/Utilities.h"
 
+#include <algorithm>
 #include <sstream>
 
 #if defined( CINDER_MAC )
@@ -62,6 +64,9 @@ namespace cinder { namespace qtime {
 
 static GWorldPtr sDefaultGWorld;
 
+// how many samples the frame index advances by each time the movie updates, so that it's built over the first few seconds without stalling any one frame
+static const size_t FRAME_INDEX_STEPS_PER_UPDATE = 32;
+
 ::Movie openMovieFromUrl( const	Url &url );
 ::Movie openMovieFromPath( const fs::path &path );
 
@@ -71,7 +76,8 @@ void startQuickTime()
 	
 	if( initialized )
 		return;
-		
+
+	double start = Profiler::get().getSeconds();
 #if defined( CINDER_MSW )	
 	::InitializeQTML( 0L );
 #endif	
@@ -83,6 +89,7 @@ void startQuickTime()
 	boundsRect.left = boundsRect.top = 0;
 	boundsRect.right = boundsRect.bottom = 4;
 	::QTNewGWorld( &sDefaultGWorld, k24BGRPixelFormat, &boundsRect, NULL, NULL, 0 );
+	Profiler::get().addInitialization( "QuickTime", start, Profiler::get().getSeconds() );
 }
 
 float MovieBase::getPixelAspectRatio() const
@@ -174,6 +181,11 @@ void MovieBase::init()
 	getObj()->mFFTData = NULL;
 	getObj()->mFFTNumChannels = getObj()->mFFTNumBandLevels = 0;
 	getObj()->mVisualContext = 0;
+	getObj()->mFrameIndexTime = getObj()->mKeyframeIndexTime = 0;
+	getObj()->mFrameIndexComplete = false;
+	getObj()->mFrameCacheSize = 16;
+	getObj()->mPendingTime = -1;
+	getObj()->mCachedFrameNew = false;
 
 	::Rect bounds;	
 	::GetMovieNaturalBoundsRect( getObj()->mMovie, &bounds );
@@ -197,6 +209,9 @@ MovieBase::Obj::Obj()
 MovieBase::Obj::~Obj()
 {
 	lock();
+		for( size_t i = 0; i < mFrameCache.size(); ++i )
+			::CVBufferRelease( mFrameCache[i].second );
+
 		if( mVisualContext ) {
 			::SetMovieVisualContext( mMovie, NULL );
 			::QTVisualContextRelease( (QTVisualContextRef)mVisualContext );
@@ -295,38 +310,259 @@ bool MovieBase::hasAudio() const
 
 float MovieBase::getCurrentTime() const
 {
-	return ::GetMovieTime( getObj()->mMovie, NULL ) / (float)::GetMovieTimeScale( getObj()->mMovie );
+	return getPlayheadTime() / (float)::GetMovieTimeScale( getObj()->mMovie );
 }
 
 void MovieBase::seekToTime( float seconds )
 {
-	::SetMovieTimeValue( getObj()->mMovie, ::TimeValue( seconds * ::GetMovieTimeScale( getObj()->mMovie ) ) );
+	getObj()->lock();
+		seekToMovieTime( ::TimeValue( seconds * ::GetMovieTimeScale( getObj()->mMovie ) ), false );
+	getObj()->unlock();
 }
 
 void MovieBase::seekToFrame( int frame )
 {
-	long        frameCount = 0;
-	TimeValue   curMovieTime = 0, lastGoodTime = 0;
-	
-	OSType types[] = { VisualMediaCharacteristic };
-	while( ( frameCount < frame ) && ( curMovieTime >= 0 ) ) {
-		::GetMovieNextInterestingTime( getObj()->mMovie, nextTimeStep, 1, types, curMovieTime, fixed1, &curMovieTime, NULL );
-		frameCount++;
-		if( curMovieTime >= 0 )
-			lastGoodTime = curMovieTime;
-	}
-	::SetMovieTimeValue( getObj()->mMovie, lastGoodTime );
-	::MoviesTask( getObj()->mMovie, 0 );
+	getObj()->lock();
+		// find the frame, indexing as far as it if need be, which is no more work than stepping to it used to be
+		indexFrames( 0 );
+		while( ( ! getObj()->mFrameIndexComplete ) && ( getObj()->mFrameTimes.size() <= (size_t)std::max( frame, 0 ) ) )
+			indexFrames( 256 );
+		const int32_t indexed = math<int32_t>::clamp( frame, 0, (int32_t)getObj()->mFrameTimes.size() - 1 );
+
+		// a frame shortly before the current one is most likely a step in reverse playback or scrubbing, which the cache is filled for
+		const int32_t current = findFrame( getPlayheadTime(), false );
+		const bool fillCache = ( current >= 0 ) && ( indexed < current ) && ( indexed > current - (int32_t)getObj()->mFrameCacheSize );
+		seekToIndexedFrame( indexed, fillCache );
+	getObj()->unlock();
 }
 
 void MovieBase::seekToStart()
 {
-	::GoToBeginningOfMovie( getObj()->mMovie );
+	getObj()->lock();
+		getObj()->mPendingTime = -1;
+		::GoToBeginningOfMovie( getObj()->mMovie );
+	getObj()->unlock();
 }
 
 void MovieBase::seekToEnd()
 {
-	::GoToEndOfMovie( getObj()->mMovie );
+	getObj()->lock();
+		getObj()->mPendingTime = -1;
+		::GoToEndOfMovie( getObj()->mMovie );
+	getObj()->unlock();
+}
+
+void MovieBase::setFrameCacheSize( size_t frames )
+{
+	getObj()->lock();
+		getObj()->mFrameCacheSize = frames;
+		trimFrameCache( frames );
+	getObj()->unlock();
+}
+
+int32_t MovieBase::findKeyframe( int32_t frame )
+{
+	getObj()->lock();
+		int32_t result = findKeyframeLocked( frame );
+	getObj()->unlock();
+
+	return result;
+}
+
+// Advances the frame and keyframe index by up to \a maxSteps samples each. The first call records frame 0 at time 0 and the first keyframe.
+void MovieBase::indexFrames( size_t maxSteps )
+{
+	Obj *obj = getObj();
+	if( obj->mFrameIndexComplete )
+		return;
+
+	OSType types[] = { VisualMediaCharacteristic };
+	const TimeValue duration = ::GetMovieDuration( obj->mMovie );
+	if( obj->mFrameTimes.empty() )
+		obj->mFrameTimes.push_back( 0 );
+	if( obj->mKeyframeTimes.empty() && ( obj->mKeyframeIndexTime >= 0 ) ) {
+		TimeValue first;
+		::GetMovieNextInterestingTime( obj->mMovie, nextTimeSyncSample + nextTimeEdgeOK, 1, types, 0, fixed1, &first, NULL );
+		if( first >= 0 )
+			obj->mKeyframeTimes.push_back( first );
+		obj->mKeyframeIndexTime = first;
+	}
+
+	for( size_t step = 0; step < maxSteps; ++step ) {
+		if( obj->mFrameIndexTime >= 0 ) {
+			TimeValue next;
+			::GetMovieNextInterestingTime( obj->mMovie, nextTimeStep, 1, types, obj->mFrameIndexTime, fixed1, &next, NULL );
+			if( next >= duration ) // there's an extra time step at the end of the movie
+				next = -1;
+			if( next >= 0 )
+				obj->mFrameTimes.push_back( next );
+			obj->mFrameIndexTime = next;
+		}
+		if( obj->mKeyframeIndexTime >= 0 ) {
+			TimeValue next;
+			::GetMovieNextInterestingTime( obj->mMovie, nextTimeSyncSample, 1, types, obj->mKeyframeIndexTime, fixed1, &next, NULL );
+			if( next >= duration )
+				next = -1;
+			if( next >= 0 )
+				obj->mKeyframeTimes.push_back( next );
+			obj->mKeyframeIndexTime = next;
+		}
+		if( ( obj->mFrameIndexTime < 0 ) && ( obj->mKeyframeIndexTime < 0 ) )
+			break;
+	}
+
+	obj->mFrameIndexComplete = ( obj->mFrameIndexTime < 0 ) && ( obj->mKeyframeIndexTime < 0 );
+}
+
+// Returns the frame showing at \a time, or -1 if \a time lies beyond the index and \a extendIndex is false
+int32_t MovieBase::findFrame( TimeValue time, bool extendIndex )
+{
+	Obj *obj = getObj();
+	while( extendIndex && ( obj->mFrameIndexTime >= 0 ) && ( obj->mFrameTimes.empty() || ( obj->mFrameTimes.back() <= time ) ) )
+		indexFrames( 256 );
+	if( obj->mFrameTimes.empty() || ( ( obj->mFrameIndexTime >= 0 ) && ( obj->mFrameTimes.back() <= time ) ) )
+		return -1;
+
+	std::vector<TimeValue>::const_iterator frameIt = std::upper_bound( obj->mFrameTimes.begin(), obj->mFrameTimes.end(), time );
+	return std::max<int32_t>( 0, (int32_t)( frameIt - obj->mFrameTimes.begin() ) - 1 );
+}
+
+int32_t MovieBase::findKeyframeLocked( int32_t frame )
+{
+	Obj *obj = getObj();
+	while( ( ! obj->mFrameIndexComplete ) && ( obj->mFrameTimes.size() <= (size_t)std::max( frame, 0 ) ) )
+		indexFrames( 256 );
+	if( obj->mFrameTimes.empty() )
+		return 0;
+	frame = math<int32_t>::clamp( frame, 0, (int32_t)obj->mFrameTimes.size() - 1 );
+
+	const TimeValue frameTime = obj->mFrameTimes[frame];
+	while( ( obj->mKeyframeIndexTime >= 0 ) && ( obj->mKeyframeTimes.empty() || ( obj->mKeyframeTimes.back() <= frameTime ) ) )
+		indexFrames( 256 );
+	std::vector<TimeValue>::const_iterator keyIt = std::upper_bound( obj->mKeyframeTimes.begin(), obj->mKeyframeTimes.end(), frameTime );
+	if( keyIt == obj->mKeyframeTimes.begin() ) // every frame is a keyframe in movies without sync samples
+		return frame;
+
+	return findFrame( *( keyIt - 1 ), false );
+}
+
+// The movie's time, or the time of a frame shown from the cache which hasn't been applied to the movie yet
+TimeValue MovieBase::getPlayheadTime() const
+{
+	if( getObj()->mPendingTime >= 0 )
+		return getObj()->mPendingTime;
+	else
+		return ::GetMovieTime( getObj()->mMovie, NULL );
+}
+
+// Sets the time of a frame shown from the cache on the movie, which decodes it again, before anything that depends on the movie's own time
+void MovieBase::applyPendingTime()
+{
+	if( getObj()->mPendingTime >= 0 ) {
+		::SetMovieTimeValue( getObj()->mMovie, getObj()->mPendingTime );
+		getObj()->mPendingTime = -1;
+	}
+}
+
+void MovieBase::seekToMovieTime( TimeValue time, bool task )
+{
+	// the cache only serves a stopped movie, and only times the index already covers, so that seeking never waits on the index
+	if( getObj()->mFrameCacheSize && ( ::GetMovieRate( getObj()->mMovie ) == 0 ) ) {
+		const int32_t frame = findFrame( time, false );
+		if( ( frame >= 0 ) && showCachedFrame( getObj()->mFrameTimes[frame] ) ) {
+			getObj()->mPendingTime = time;
+			return;
+		}
+	}
+
+	getObj()->mPendingTime = -1;
+	::SetMovieTimeValue( getObj()->mMovie, time );
+	if( task )
+		::MoviesTask( getObj()->mMovie, 0 );
+}
+
+void MovieBase::seekToIndexedFrame( int32_t frame, bool fillCache )
+{
+	Obj *obj = getObj();
+	const TimeValue time = obj->mFrameTimes[frame];
+	if( obj->mFrameCacheSize && ( ::GetMovieRate( obj->mMovie ) == 0 ) ) {
+		if( showCachedFrame( time ) ) {
+			obj->mPendingTime = time;
+			return;
+		}
+
+		// Decoding has to start from the keyframe regardless, so decode forward from as far back as the cache holds
+		// and keep every frame on the way, which the following steps backward are then served from
+		if( fillCache && obj->mVisualContext ) {
+			const int32_t first = std::max( findKeyframeLocked( frame ), frame - (int32_t)obj->mFrameCacheSize + 1 );
+			for( int32_t f = first; f < frame; ++f ) {
+				::SetMovieTimeValue( obj->mMovie, obj->mFrameTimes[f] );
+				::MoviesTask( obj->mMovie, 0 );
+				::QTVisualContextTask( (QTVisualContextRef)obj->mVisualContext );
+				CVImageBufferRef imageRef = NULL;
+				if( ::QTVisualContextIsNewImageAvailable( (QTVisualContextRef)obj->mVisualContext, nil ) )
+					::QTVisualContextCopyImageForTime( (QTVisualContextRef)obj->mVisualContext, kCFAllocatorDefault, NULL, &imageRef );
+				if( imageRef ) {
+					cacheFrame( obj->mFrameTimes[f], imageRef );
+					::CVBufferRelease( imageRef );
+				}
+			}
+		}
+	}
+
+	// the target frame itself is decoded as usual and cached by updateFrame()
+	obj->mPendingTime = -1;
+	::SetMovieTimeValue( obj->mMovie, time );
+	::MoviesTask( obj->mMovie, 0 );
+}
+
+// Shows the cached frame starting at \a frameTime, if there is one, the same way updateFrame() shows a newly decoded frame
+bool MovieBase::showCachedFrame( TimeValue frameTime )
+{
+	Obj *obj = getObj();
+	for( size_t i = 0; i < obj->mFrameCache.size(); ++i ) {
+		if( obj->mFrameCache[i].first == frameTime ) {
+			std::pair<TimeValue,CVImageBufferRef> entry = obj->mFrameCache[i];
+			obj->mFrameCache.erase( obj->mFrameCache.begin() + i );
+			obj->mFrameCache.push_back( entry );
+
+			obj->releaseFrame();
+			obj->newFrame( (CVImageBufferRef)::CVBufferRetain( entry.second ) );
+			obj->mCachedFrameNew = true;
+			if( obj->mNewFrameCallback )
+				(*obj->mNewFrameCallback)( frameTime, obj->mNewFrameCallbackRefcon );
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void MovieBase::cacheFrame( TimeValue frameTime, CVImageBufferRef image )
+{
+	Obj *obj = getObj();
+	if( ! obj->mFrameCacheSize )
+		return;
+	for( size_t i = 0; i < obj->mFrameCache.size(); ++i ) {
+		if( obj->mFrameCache[i].first == frameTime )
+			return;
+	}
+
+	trimFrameCache( obj->mFrameCacheSize - 1 );
+	obj->mFrameCache.push_back( std::make_pair( frameTime, (CVImageBufferRef)::CVBufferRetain( image ) ) );
+}
+
+// Releases the least recently shown frames until at most \a frames are cached
+void MovieBase::trimFrameCache( size_t frames )
+{
+	Obj *obj = getObj();
+	if( obj->mFrameCache.size() <= frames )
+		return;
+
+	const size_t excess = obj->mFrameCache.size() - frames;
+	for( size_t i = 0; i < excess; ++i )
+		::CVBufferRelease( obj->mFrameCache[i].second );
+	obj->mFrameCache.erase( obj->mFrameCache.begin(), obj->mFrameCache.begin() + excess );
 }
 
 void MovieBase::setActiveSegment( float startTime, float duration )
@@ -342,6 +578,7 @@ void MovieBase::setActiveSegment( float startTime, float duration )
 		::SetTimeBaseFlags( timeBase, flags );
 		
 		::SetMovieActiveSegment( getObj()->mMovie, ::TimeValue( startTime * ::GetMovieTimeScale( getObj()->mMovie ) ), ::TimeValue( duration * ::GetMovieTimeScale( getObj()->mMovie ) ) );
+		getObj()->mPendingTime = -1;
 		::SetMovieTimeValue( getObj()->mMovie, ::TimeValue( startTime * ::GetMovieTimeScale( getObj()->mMovie ) ) );
 
 		::SetTimeBaseFlags( timeBase, oldFlags );
@@ -416,6 +653,16 @@ TimeValue MovieBase::getStartTimeOfFirstSample() const
 
 void MovieBase::stepForward()
 {
+	getObj()->lock();
+		const int32_t frame = findFrame( getPlayheadTime(), true );
+		if( frame >= 0 ) {
+			if( frame + 1 < (int32_t)getObj()->mFrameTimes.size() ) // otherwise we hit the end
+				seekToIndexedFrame( frame + 1, false );
+			getObj()->unlock();
+			return;
+		}
+	getObj()->unlock();
+
 	TimeValue curMovieTime;
 	
 	TimeValue oldTime = ::GetMovieTime( getObj()->mMovie, NULL );
@@ -430,6 +677,16 @@ void MovieBase::stepForward()
 
 void MovieBase::stepBackward()
 {
+	getObj()->lock();
+		const int32_t frame = findFrame( getPlayheadTime(), true );
+		if( frame >= 0 ) {
+			if( frame > 0 ) // otherwise we hit the beginning
+				seekToIndexedFrame( frame - 1, true );
+			getObj()->unlock();
+			return;
+		}
+	getObj()->unlock();
+
 	TimeValue curMovieTime;
 	
 	TimeValue oldTime = ::GetMovieTime( getObj()->mMovie, NULL );
@@ -444,7 +701,10 @@ void MovieBase::stepBackward()
 
 void MovieBase::setRate( float rate )
 {
-	::SetMovieRate( getObj()->mMovie, floatToFixed( rate ) );
+	getObj()->lock();
+		applyPendingTime();
+		::SetMovieRate( getObj()->mMovie, floatToFixed( rate ) );
+	getObj()->unlock();
 }
 
 bool MovieBase::checkNewFrame()
@@ -452,7 +712,12 @@ bool MovieBase::checkNewFrame()
 	bool result;
 	
 	getObj()->lock();
-		if( (QTVisualContextRef)getObj()->mVisualContext ) {
+		indexFrames( FRAME_INDEX_STEPS_PER_UPDATE );
+		if( getObj()->mCachedFrameNew ) {
+			getObj()->mCachedFrameNew = false;
+			result = true;
+		}
+		else if( (QTVisualContextRef)getObj()->mVisualContext ) {
 			::MoviesTask( getObj()->mMovie, 0 );	
 			::QTVisualContextTask( (QTVisualContextRef)getObj()->mVisualContext );
 			result = ::QTVisualContextIsNewImageAvailable( (QTVisualContextRef)getObj()->mVisualContext, nil );
@@ -469,6 +734,7 @@ void MovieBase::updateFrame()
 {
 	getObj()->lock();
 
+	indexFrames( FRAME_INDEX_STEPS_PER_UPDATE );
 	::MoviesTask( getObj()->mMovie, 0 );
 	if( (QTVisualContextRef)getObj()->mVisualContext ) {
 		::QTVisualContextTask( (QTVisualContextRef)getObj()->mVisualContext );
@@ -478,8 +744,15 @@ void MovieBase::updateFrame()
 			CVImageBufferRef newImageRef = NULL;
 			long tv = ::GetMovieTime( getObj()->mMovie, NULL );
 			OSStatus err = ::QTVisualContextCopyImageForTime( (QTVisualContextRef)getObj()->mVisualContext, kCFAllocatorDefault, NULL, &newImageRef );
-			if( ( err == noErr ) && newImageRef )
+			if( ( err == noErr ) && newImageRef ) {
+				// keep frames decoded while stopped for seeking back to them; newFrame() takes over our reference, so retain ours first
+				if( getObj()->mFrameCacheSize && ( ::GetMovieRate( getObj()->mMovie ) == 0 ) ) {
+					const int32_t frame = findFrame( tv, false );
+					if( frame >= 0 )
+						cacheFrame( getObj()->mFrameTimes[frame], newImageRef );
+				}
 				getObj()->newFrame( newImageRef );
+			}
 
 			if( getObj()->mNewFrameCallback && newImageRef ) {
 				
@@ -626,7 +899,10 @@ bool MovieBase::isDone() const
 
 void MovieBase::play()
 {
-	::StartMovie( getObj()->mMovie );
+	getObj()->lock();
+		applyPendingTime();
+		::StartMovie( getObj()->mMovie );
+	getObj()->unlock();
 }
 
 void MovieBase::stop()
@@ -717,6 +993,82 @@ Surface MovieSurface::getSurface()
 	return result;
 }
 
+/////////////////////////////////////////////////////////////////////////////////
+// MovieYuv
+
+MovieYuv::Obj::~Obj()
+{
+	// see note on prepareForDestruction()
+	prepareForDestruction();
+}
+
+MovieYuv::MovieYuv( const fs::path &path )
+	: MovieBase(), mObj( new Obj() )
+{
+	MovieBase::initFromPath( path );
+	allocateVisualContext();
+}
+
+MovieYuv::MovieYuv( const MovieLoader &loader )
+	: MovieBase(), mObj( new Obj() )
+{
+	MovieBase::initFromLoader( loader );
+	allocateVisualContext();
+}
+
+MovieYuv::MovieYuv( const void *data, size_t dataSize, const std::string &fileNameHint, const std::string &mimeTypeHint )
+	: MovieBase(), mObj( new Obj() )
+{
+	MovieBase::initFromMemory( data, dataSize, fileNameHint, mimeTypeHint );
+	allocateVisualContext();
+}
+
+MovieYuv::MovieYuv( DataSourceRef dataSource, const std::string mimeTypeHint )
+	: MovieBase(), mObj( new Obj() )
+{
+	MovieBase::initFromDataSource( dataSource, mimeTypeHint );
+	allocateVisualContext();
+}
+
+void MovieYuv::allocateVisualContext()
+{
+	if( ! hasVisuals() )
+		return;
+
+	CFMutableDictionaryRef visualContextOptions = initQTVisualContextOptionsForFormat( getObj()->mWidth, getObj()->mHeight, kYUV420PixelFormat );
+	OSStatus status = ::QTPixelBufferContextCreate( kCFAllocatorDefault, visualContextOptions, &(getObj()->mVisualContext) );
+
+	if( status == noErr )
+		::SetMovieVisualContext( getObj()->mMovie, getObj()->mVisualContext );
+	else
+		getObj()->mVisualContext = 0;
+}
+
+void MovieYuv::Obj::newFrame( CVImageBufferRef cvImage )
+{
+	CVPixelBufferRef imgRef = reinterpret_cast<CVPixelBufferRef>( cvImage );
+	if( imgRef )
+		mYuvSurface = convertCVPixelBufferToYuvSurface( imgRef );
+	else
+		mYuvSurface.reset();
+}
+
+void MovieYuv::Obj::releaseFrame()
+{
+	mYuvSurface.reset();
+}
+
+YuvSurface MovieYuv::getYuvSurface()
+{
+	updateFrame();
+	
+	mObj->lock();
+		YuvSurface result = mObj->mYuvSurface;
+	mObj->unlock();
+	
+	return result;
+}
+
 /////////////////////////////////////////////////////////////////////////////////
 // MovieGl
 MovieGl::Obj::Obj()
@@ -92,12 +92,17 @@ void dictionarySetPixelBufferOpenGLCompatibility( CFMutableDictionaryRef dict )
 }
 
 bool dictionarySetPixelBufferOptions( unsigned int width, unsigned int height, bool alpha, CFMutableDictionaryRef *pixelBufferOptions )
+{
+	return dictionarySetPixelBufferOptionsForFormat( width, height, ( alpha ) ? k32BGRAPixelFormat : k24RGBPixelFormat, pixelBufferOptions );
+}
+
+bool dictionarySetPixelBufferOptionsForFormat( unsigned int width, unsigned int height, OSType pixelFormat, CFMutableDictionaryRef *pixelBufferOptions )
 {
 	bool setPixelBufferOptions = false;
     CFMutableDictionaryRef  pixelBufferDict = CFDictionaryCreateMutable( kCFAllocatorDefault, 0, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks );
 
     if ( pixelBufferDict != NULL ) {
-		if ( dictionarySetPixelBufferPixelFormatType( alpha, pixelBufferDict ) ) {
+		if ( dictionarySetValue( pixelBufferDict, kCVPixelBufferPixelFormatTypeKey, pixelFormat ) ) {
 			if ( dictionarySetPixelBufferSize( width, height, pixelBufferDict ) ) {
 				if ( dictionarySetPixelBufferBytesPerRowAlignment( pixelBufferDict ) ) {
 					dictionarySetPixelBufferOpenGLCompatibility( pixelBufferDict );
@@ -112,11 +117,16 @@ bool dictionarySetPixelBufferOptions( unsigned int width, unsigned int height, b
 }
 
 CFMutableDictionaryRef initQTVisualContextOptions( int width, int height, bool alpha )
+{
+	return initQTVisualContextOptionsForFormat( width, height, ( alpha ) ? k32BGRAPixelFormat : k24RGBPixelFormat );
+}
+
+CFMutableDictionaryRef initQTVisualContextOptionsForFormat( int width, int height, OSType pixelFormat )
 {
 	CFMutableDictionaryRef  visualContextOptions = NULL;
     CFMutableDictionaryRef  pixelBufferOptions   = NULL;
 												   
-	bool  setPixelBufferOptions = dictionarySetPixelBufferOptions( width, height, alpha, &pixelBufferOptions );
+	bool  setPixelBufferOptions = dictionarySetPixelBufferOptionsForFormat( width, height, pixelFormat, &pixelBufferOptions );
 	
 	if( pixelBufferOptions != NULL ) {
 		if( setPixelBufferOptions ) {
@@ -423,6 +433,17 @@ Surface8u convertCVPixelBufferToSurface( CVPixelBufferRef pixelBufferRef )
 	return result;
 }
 
+YuvSurface convertCVPixelBufferToYuvSurface( CVPixelBufferRef pixelBufferRef )
+{
+	CVPixelBufferLockBaseAddress( pixelBufferRef, 0 );
+	YuvSurface result( CVPixelBufferGetWidth( pixelBufferRef ), CVPixelBufferGetHeight( pixelBufferRef ),
+						reinterpret_cast<uint8_t*>( CVPixelBufferGetBaseAddressOfPlane( pixelBufferRef, 0 ) ), CVPixelBufferGetBytesPerRowOfPlane( pixelBufferRef, 0 ),
+						reinterpret_cast<uint8_t*>( CVPixelBufferGetBaseAddressOfPlane( pixelBufferRef, 1 ) ), CVPixelBufferGetBytesPerRowOfPlane( pixelBufferRef, 1 ),
+						reinterpret_cast<uint8_t*>( CVPixelBufferGetBaseAddressOfPlane( pixelBufferRef, 2 ) ), CVPixelBufferGetBytesPerRowOfPlane( pixelBufferRef, 2 ) );
+	result.setDeallocator( CVPixelBufferDealloc, pixelBufferRef );
+	return result;
+}
+
 #endif // ! defined( __LP64__ )
 
 ///////////////////////////////////////////////////////////////////////////////////////////////
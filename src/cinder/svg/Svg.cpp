@@ -96,43 +96,69 @@ bool isNumeric( char c )
 	return ( c >= '0' && c <= '9' ) || c == '.' || c == '-' || c == 'e' || c == 'E' || c == '+';
 }
 
+// Parses a number in place, without copying it out for atof(). Follows SVG's grammar, where "1.5.5" is two numbers and "10-5" is two numbers.
 float parseFloat( const char **sInOut )
 {
-	char temp[256];
-	size_t i = 0;
+	static const double sPowersOf10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
 	const char *s = *sInOut;
 	while( *s && (isspace(*s) || *s == ',') )
 		s++;
-	if( ! s )
-		throw PathParseExc();
-	if( isNumeric( *s ) ) {
-		while( *s == '-' || *s == '+' ) {
-			if( i < sizeof(temp) )
-				temp[i++] = *s;
-			s++;
+	if( ! isNumeric( *s ) )
+		throw FloatParseExc();
+
+	bool negative = false;
+	while( *s == '-' || *s == '+' ) {
+		negative = ( *s == '-' );
+		s++;
+	}
+
+	// mantissa digits beyond what a double holds exactly only shift the exponent
+	uint64_t mantissa = 0;
+	int exponent = 0, numDigits = 0;
+	bool sawDigits = false;
+	for( ; *s >= '0' && *s <= '9'; ++s ) {
+		sawDigits = true;
+		if( numDigits < 18 ) { mantissa = mantissa * 10 + ( *s - '0' ); if( mantissa ) ++numDigits; }
+		else ++exponent;
+	}
+	if( *s == '.' ) {
+		for( ++s; *s >= '0' && *s <= '9'; ++s ) {
+			sawDigits = true;
+			if( numDigits < 18 ) { mantissa = mantissa * 10 + ( *s - '0' ); if( mantissa ) ++numDigits; --exponent; }
 		}
-		bool parsingExponent = false;
-		bool seenDecimal = false;
-		while( *s && ( parsingExponent || (*s != '-' && *s != '+')) && isNumeric(*s) ) {
-			if( *s == '.' && seenDecimal )
-				break;
-			else if( *s == '.' )
-				seenDecimal = true;
-			if( i < sizeof(temp) )
-				temp[i++] = *s;
-			if( *s == 'e' || *s == 'E' )
-				parsingExponent = true;
-			else
-				parsingExponent = false;
+	}
+	// a stray '.' or 'e' reads as zero, as it did through atof(), but is consumed so that callers make progress
+	if( ! sawDigits ) {
+		while( *s == '.' || *s == 'e' || *s == 'E' )
 			s++;
-		}
-		temp[i] = 0;
-		float result = (float)atof( temp );
 		*sInOut = s;
-		return result;
+		return 0;
 	}
-	else
-		throw FloatParseExc();
+	if( *s == 'e' || *s == 'E' ) {
+		const char *e = s + 1;
+		bool negativeExponent = false;
+		if( *e == '-' || *e == '+' )
+			negativeExponent = ( *e++ == '-' );
+		// an 'e' without digits isn't part of the number
+		if( *e >= '0' && *e <= '9' ) {
+			int explicitExponent = 0;
+			for( ; *e >= '0' && *e <= '9'; ++e )
+				explicitExponent = std::min( explicitExponent * 10 + ( *e - '0' ), 1000 );
+			exponent += ( negativeExponent ) ? -explicitExponent : explicitExponent;
+			s = e;
+		}
+	}
+
+	double result = (double)mantissa;
+	if( mantissa && exponent ) {
+		int absExponent = std::abs( exponent );
+		double scale = ( absExponent <= 22 ) ? sPowersOf10[absExponent] : pow( 10.0, (double)absExponent );
+		result = ( exponent < 0 ) ? result / scale : result * scale;
+	}
+
+	*sInOut = s;
+	return (float)( ( negative ) ? -result : result );
 }
 
 // parses float from comma-separated parenthetical list
@@ -326,11 +352,12 @@ Style::Style()
 	clear();
 }
 
-Style::Style( const XmlTree &xml, const Node *parent )
+Style::Style( const XmlView &xml, const Node *parent )
 {
 	clear();
 
-	for( list<XmlTree::Attr>::const_iterator attIt = xml.getAttributes().begin(); attIt != xml.getAttributes().end(); ++attIt ) {
+	vector<XmlView::Attr> attributes = xml.getAttributes();
+	for( vector<XmlView::Attr>::const_iterator attIt = attributes.begin(); attIt != attributes.end(); ++attIt ) {
 		if( attIt->getName() == "style" )
 			parseStyleAttribute( attIt->getValue(), parent );
 		else
@@ -655,8 +682,8 @@ Value Value::parse( const std::string &s )
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Node
-Node::Node( const Node *parent, const XmlTree &xml )
-	: mParent( parent ), mStyle( xml, this ), mBoundingBoxCached( false )
+Node::Node( const Node *parent, const XmlView &xml )
+	: mParent( parent ), mStyle( xml, this ), mBoundingBoxCached( false ), mRevision( 0 )
 {
 	mSpecifiesTransform = false;
 	mId = xml["id"];
@@ -680,6 +707,18 @@ Doc* Node::getDoc() const
 		return 0;
 }
 
+void Node::invalidate()
+{
+	++mRevision;
+	// cached bounding boxes of this node and its ancestors are stale now
+	for( const Node *node = this; node; node = node->mParent )
+		node->mBoundingBoxCached = false;
+
+	Doc *doc = getDoc();
+	if( doc )
+		++doc->mDocRevision;
+}
+
 string Node::getDomPath() const
 {
 	string result = mId;
@@ -1060,13 +1099,13 @@ MatrixAffine2f Node::getTransformAbsolute() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Gradient
-Gradient::Gradient( const Node *parent, const XmlTree &xml )
+Gradient::Gradient( const Node *parent, const XmlView &xml )
 	: Node( parent, xml ), mUseObjectBoundingBox( true ), mSpecifiesTransform( false )
 {
 	parse( parent, xml );
 }
 
-void Gradient::parse( const Node *parent, const XmlTree &xml )
+void Gradient::parse( const Node *parent, const XmlView &xml )
 {
 	if( xml.hasAttribute( "xlink:href" ) ) {
 		string ref = xml.getAttributeValue<string>( "xlink:href" );
@@ -1080,7 +1119,7 @@ void Gradient::parse( const Node *parent, const XmlTree &xml )
 			}
 		}
 	}
-	for( XmlTree::ConstIter stopsIt = xml.begin( "stop" ); stopsIt != xml.end(); ++stopsIt ) {
+	for( XmlView::ConstIter stopsIt = xml.begin( "stop" ); stopsIt != xml.end(); ++stopsIt ) {
 		mStops.push_back( Stop( parent, *stopsIt ) );
 	}
 	if( xml.hasAttribute( "gradientUnits" ) )
@@ -1103,7 +1142,7 @@ void Gradient::copyAttributesFrom( const Gradient &rhs )
 	}
 }
 
-Gradient::Stop::Stop( const Node *parent, const XmlTree &xml )
+Gradient::Stop::Stop( const Node *parent, const XmlView &xml )
 	: mOffset( 0 ), mSpecifiesColor( false ), mSpecifiesOpacity( false )
 {
 	if( xml.hasAttribute( "offset" ) )
@@ -1146,13 +1185,13 @@ Paint Gradient::asPaint() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // LinearGradient
-LinearGradient::LinearGradient( const Node *parent, const XmlTree &xml )
+LinearGradient::LinearGradient( const Node *parent, const XmlView &xml )
 	: Gradient( parent, xml )
 {
 	parse( xml );
 }
 
-void LinearGradient::parse( const XmlTree &xml )
+void LinearGradient::parse( const XmlView &xml )
 {
 	mCoords0.x = xml.getAttributeValue( "x1", 0.0f );
 	mCoords0.y = xml.getAttributeValue( "y1", 0.0f );
@@ -1169,13 +1208,13 @@ Paint LinearGradient::asPaint() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // RadialGradient
-RadialGradient::RadialGradient( const Node *parent, const XmlTree &xml )
+RadialGradient::RadialGradient( const Node *parent, const XmlView &xml )
 	: Gradient( parent, xml )
 {
 	parse( xml );
 }
 
-void RadialGradient::parse( const XmlTree &xml )
+void RadialGradient::parse( const XmlView &xml )
 {
 	mCoords0.x = xml.getAttributeValue( "cx", 0.5f );
 	mCoords0.y = xml.getAttributeValue( "cy", 0.5f );
@@ -1194,7 +1233,7 @@ Paint RadialGradient::asPaint() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Circle
-Circle::Circle( const Node *parent, const XmlTree &xml )
+Circle::Circle( const Node *parent, const XmlView &xml )
 	: Node( parent, xml )
 {
 	mCenter.x = xml.getAttributeValue( "cx", 0.0f );
@@ -1216,7 +1255,7 @@ Shape2d Circle::getShape() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Ellipse
-Ellipse::Ellipse( const Node *parent, const XmlTree &xml )
+Ellipse::Ellipse( const Node *parent, const XmlView &xml )
 	: Node( parent, xml )
 {
 	mCenter.x = xml.getAttributeValue( "cx", 0.0f );
@@ -1319,42 +1358,6 @@ void ellipticalArc( Shape2d &path, float x1, float y1, float x2, float y2, float
     }
 }
 
-static const char* getNextPathItem(const char* s, char it[64] )
-{
-	int i = 0;
-	it[0] = '\0';
-	// Skip white spaces and commas
-	while( *s && (isspace(*s) || *s == ',') )
-		s++;
-	if( ! *s )
-		return s;
-	if( isNumeric(*s) ) {
-		while( *s == '-' || *s == '+' ) {
-			if( i < 63 )
-				it[i++] = *s;
-			s++;
-		}
-		bool parsingExponent = false;
-		while( *s && ( parsingExponent || (*s != '-' && *s != '+')) && isNumeric(*s) ) {
-			if( i < 63 )
-				it[i++] = *s;
-			if( *s == 'e' || *s == 'E' )
-				parsingExponent = true;
-			else
-				parsingExponent = false;
-			s++;
-		}
-		it[i] = '\0';
-	}
-	else {
-		it[0] = *s++;
-		it[1] = '\0';
-		return s;
-	}
-
-	return s;
-}
-
 char readNextCommand( const char **sInOut )
 {
 	const char *s = *sInOut;
@@ -1380,9 +1383,8 @@ bool nextItemIsFloat( const char *s )
 	return isNumeric( *s );
 }
 
-Shape2d parsePath( const std::string &p )
+Shape2d parsePath( const char *s )
 {
-	const char* s = p.c_str();
 	Vec2f v0, v1, v2;
 	Vec2f lastPoint = Vec2f::zero(), lastPoint2 = Vec2f::zero();
 
@@ -1541,12 +1543,13 @@ Shape2d parsePath( const std::string &p )
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Path
-Path::Path( const Node *parent, const XmlTree &xml )
+Path::Path( const Node *parent, const XmlView &xml )
 	: Node( parent, xml )
 {
-	std::string p = xml.getAttributeValue<string>( "d", "" );
+	// XmlView's strings are zero-terminated, so the path data is parsed where it lies
+	XmlStringRef p = xml["d"];
 	if( ! p.empty() ) {
-		mPath = parsePath( p );
+		mPath = parsePath( p.data() );
 	}
 }
 
@@ -1564,7 +1567,7 @@ void Path::renderSelf( Renderer &renderer ) const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Line
-Line::Line( const Node *parent, const XmlTree &xml )
+Line::Line( const Node *parent, const XmlView &xml )
 	: Node( parent, xml )
 {
 	mPoint1.x = xml.getAttributeValue<float>( "x1", 0 );
@@ -1588,7 +1591,7 @@ Shape2d	Line::getShape() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Rect
-Rect::Rect( const Node *parent, const XmlTree &xml )
+Rect::Rect( const Node *parent, const XmlView &xml )
 	: Node( parent, xml )
 {
 	float width = 0, height = 0;
@@ -1628,32 +1631,25 @@ Shape2d	Rect::getShape() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Polygon
-vector<Vec2f> parsePointList( const std::string &p )
+vector<Vec2f> parsePointList( const char *s )
 {
 	vector<Vec2f> result;
-	
-	if( ! p.empty() ) {
-		char item[64];
-		const char *s = p.c_str();
-		bool odd = false;
-		float lastVal;
-		while( *s ) {
-			s = getNextPathItem( s, item );
-			if( ! odd )
-				lastVal = (float)atof( item );
-			else
-				result.push_back( Vec2f( lastVal, (float)atof( item ) ) );
-			odd = ! odd;
-		}
+	while( nextItemIsFloat( s ) ) {
+		Vec2f pt;
+		pt.x = parseFloat( &s );
+		if( ! nextItemIsFloat( s ) )
+			break;
+		pt.y = parseFloat( &s );
+		result.push_back( pt );
 	}
 
 	return result;
 }
 
-Polygon::Polygon( const Node *parent, const XmlTree &xml )
+Polygon::Polygon( const Node *parent, const XmlView &xml )
 	: Node( parent, xml )
 {
-	mPolyLine = PolyLine2f( parsePointList( xml.getAttributeValue<string>( "points", "" ) ) );
+	mPolyLine = PolyLine2f( parsePointList( xml["points"].data() ) );
 	mPolyLine.setClosed( true );
 }
 
@@ -1680,10 +1676,10 @@ Shape2d	Polygon::getShape() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Polyline
-Polyline::Polyline( const Node *parent, const XmlTree &xml )
+Polyline::Polyline( const Node *parent, const XmlView &xml )
 	: Node( parent, xml )
 {
-	mPolyLine = PolyLine2f( parsePointList( xml.getAttributeValue<string>( "points", "" ) ) );
+	mPolyLine = PolyLine2f( parsePointList( xml["points"].data() ) );
 	mPolyLine.setClosed( false );
 }
 
@@ -1708,7 +1704,7 @@ Shape2d	Polyline::getShape() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Group
-Group::Group( const Node *parent, const XmlTree &xml )
+Group::Group( const Node *parent, const XmlView &xml )
 	: Node( parent, xml )
 {
 	parse( xml );
@@ -1720,9 +1716,9 @@ Group::~Group()
 		delete *childIt;
 }
 
-void Group::parse( const XmlTree &xml )
+void Group::parse( const XmlView &xml )
 {
-	for( XmlTree::ConstIter treeIt = xml.begin(); treeIt != xml.end(); ++treeIt ) {
+	for( XmlView::ConstIter treeIt = xml.begin(); treeIt != xml.end(); ++treeIt ) {
 		if( treeIt->getTag() == "g" )
 			mChildren.push_back( new Group( this, *treeIt ) );
 		else if( treeIt->getTag() == "path" )
@@ -1887,13 +1883,13 @@ Rectf Group::calcBoundingBox() const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Use
-Use::Use( const Node *parent, const XmlTree &xml )
+Use::Use( const Node *parent, const XmlView &xml )
 	: Node( parent, xml ), mReferenced( 0 )
 {
 	parse( xml );
 }
 
-void Use::parse( const XmlTree &xml )
+void Use::parse( const XmlView &xml )
 {
 	if( xml.hasAttribute( "xlink:href" ) ) {
 		string ref = xml.getAttributeValue<string>( "xlink:href" );
@@ -1920,7 +1916,7 @@ void Use::renderSelf( Renderer &renderer ) const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Image
-Image::Image( const Node *parent, const XmlTree &xml )
+Image::Image( const Node *parent, const XmlView &xml )
 	: Node( parent, xml )
 {
 	mRect.x1 = xml.getAttributeValue<float>( "x", 0 );
@@ -1970,10 +1966,10 @@ void Image::renderSelf( Renderer &renderer ) const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // Text
-Text::Text( const Node *parent, const XmlTree &xml )
+Text::Text( const Node *parent, const XmlView &xml )
 	: Node( parent, xml ), mAttributes( xml )
 {
-	for( XmlTree::ConstIter treeIt = xml.begin(); treeIt != xml.end(); ++treeIt ) {
+	for( XmlView::ConstIter treeIt = xml.begin(); treeIt != xml.end(); ++treeIt ) {
 		if( treeIt->getTag() == "" ) { // data!
 			mSpans.push_back( TextSpanRef( new TextSpan( this, treeIt->getValue() ) ) );
 		}
@@ -2026,10 +2022,10 @@ void Text::renderSelf( Renderer &renderer ) const
 
 ////////////////////////////////////////////////////////////////////////////////////
 // TextSpan
-TextSpan::TextSpan( const Node *parent, const XmlTree &xml )
+TextSpan::TextSpan( const Node *parent, const XmlView &xml )
 	: Node( parent, xml ), mAttributes( xml ), mIgnoreAttributes( false )
 {
-	for( XmlTree::ConstIter treeIt = xml.begin(); treeIt != xml.end(); ++treeIt ) {
+	for( XmlView::ConstIter treeIt = xml.begin(); treeIt != xml.end(); ++treeIt ) {
 		if( treeIt->getTag() == "" ) { // data!
 			mSpans.push_back( TextSpanRef( new TextSpan( this, treeIt->getValue() ) ) );
 		}
@@ -2115,7 +2111,7 @@ Shape2d TextSpan::getShape() const
 #endif
 
 // TextSpan::Atributes
-TextSpan::Attributes::Attributes( const XmlTree &xml )
+TextSpan::Attributes::Attributes( const XmlView &xml )
 {
 	if( xml.hasAttribute( "x" ) )
 		mX = readValueList( xml["x"], false );
@@ -2188,13 +2184,13 @@ void TextSpan::Attributes::finishRender( Renderer &renderer ) const
 ////////////////////////////////////////////////////////////////////////////////////
 // Doc
 Doc::Doc( const fs::path &filePath )
-	: Group( 0 )
+	: Group( 0 ), mDocRevision( 0 ), mHitIndexValid( false ), mHitIndexRevision( 0 )
 {
 	loadDoc( loadFile( filePath ), filePath );
 }
 
 Doc::Doc( DataSourceRef dataSource, const fs::path &filePath )
-	: Group( 0 )
+	: Group( 0 ), mDocRevision( 0 ), mHitIndexValid( false ), mHitIndexRevision( 0 )
 {
 	fs::path relativePath = filePath;
 	if( filePath.empty() )
@@ -2225,9 +2221,9 @@ void Doc::loadDoc( DataSourceRef source, fs::path filePath )
 {
 	if( ! filePath.empty() )
 		mFilePath = filePath.parent_path();
-	mXmlTree = shared_ptr<XmlTree>( new XmlTree( source, XmlTree::ParseOptions().ignoreDataChildren( false ) ) );
-
-	const XmlTree &xml( mXmlTree->getChild( "svg" ) );
+	// every value is copied or parsed out of the XML while building the Node tree, so the document only lives as long as loadDoc()
+	XmlView doc( source, XmlTree::ParseOptions().ignoreDataChildren( false ) );
+	XmlView xml( doc.getChild( "svg" ) );
 
 	if( xml.hasAttribute( "viewBox" ) ) {
 		string vbox = xml.getAttributeValue<string>( "viewBox" );
@@ -2295,9 +2291,157 @@ shared_ptr<Surface8u> Doc::loadImage( fs::path relativePath )
 		return shared_ptr<Surface8u>();
 }
 
+namespace {
+// orders HitEntries along an axis by the centers of their bounds
+struct HitEntryCenterLess {
+	HitEntryCenterLess( int axis ) : mAxis( axis ) {}
+	template<typename T>
+	bool operator()( const T &a, const T &b ) const
+	{
+		return ( mAxis == 0 ) ? ( a.mBounds.x1 + a.mBounds.x2 < b.mBounds.x1 + b.mBounds.x2 ) : ( a.mBounds.y1 + a.mBounds.y2 < b.mBounds.y1 + b.mBounds.y2 );
+	}
+	int mAxis;
+};
+} // anonymous namespace
+
+void Doc::collectHitEntries( const Group *group, const MatrixAffine2f &transform, const MatrixAffine2f &inverse )
+{
+	// mirrors Group::nodeUnderPoint(), which only descends into plain Groups
+	for( list<Node*>::const_iterator nodeIt = group->getChildren().begin(); nodeIt != group->getChildren().end(); ++nodeIt ) {
+		MatrixAffine2f childTransform = transform, childInverse = inverse;
+		if( (*nodeIt)->specifiesTransform() ) {
+			childTransform = transform * (*nodeIt)->getTransform();
+			childInverse = (*nodeIt)->getTransformInverse() * inverse;
+		}
+		if( typeid(**nodeIt) == typeid(svg::Group) )
+			collectHitEntries( static_cast<const Group*>( *nodeIt ), childTransform, childInverse );
+		else {
+			HitEntry entry;
+			entry.mNode = *nodeIt;
+			entry.mBounds = (*nodeIt)->getBoundingBox().transformCopy( childTransform );
+			entry.mInverse = childInverse;
+			entry.mOrder = (uint32_t)mHitEntries.size();
+			mHitEntries.push_back( entry );
+		}
+	}
+}
+
+int32_t Doc::buildHitBvh( uint32_t first, uint32_t count )
+{
+	const uint32_t maxLeafSize = 4;
+	
+	HitBvhNode node;
+	node.mBounds = mHitEntries[first].mBounds;
+	for( uint32_t e = first + 1; e < first + count; ++e )
+		node.mBounds.include( mHitEntries[e].mBounds );
+	node.mFirst = first;
+	node.mCount = count;
+	node.mLeft = node.mRight = -1;
+	
+	int32_t index = (int32_t)mHitBvh.size();
+	mHitBvh.push_back( node );
+	if( count <= maxLeafSize )
+		return index;
+	
+	// split at the median along the longer side
+	int axis = ( node.mBounds.getWidth() >= node.mBounds.getHeight() ) ? 0 : 1;
+	std::vector<HitEntry>::iterator begin = mHitEntries.begin() + first;
+	std::nth_element( begin, begin + count / 2, begin + count, HitEntryCenterLess( axis ) );
+	int32_t left = buildHitBvh( first, count / 2 );
+	int32_t right = buildHitBvh( first + count / 2, count - count / 2 );
+	mHitBvh[index].mLeft = left;
+	mHitBvh[index].mRight = right;
+	return index;
+}
+
+void Doc::updateHitIndex()
+{
+	if( mHitIndexValid && mHitIndexRevision == mDocRevision )
+		return;
+	
+	mHitEntries.clear();
+	mHitBvh.clear();
+	MatrixAffine2f transform = MatrixAffine2f::identity(), inverse = MatrixAffine2f::identity();
+	if( mSpecifiesTransform ) {
+		transform = mTransform;
+		inverse = mTransform.invertCopy();
+	}
+	collectHitEntries( this, transform, inverse );
+	if( ! mHitEntries.empty() )
+		buildHitBvh( 0, (uint32_t)mHitEntries.size() );
+	// the build reorders the entries, so queries find them by mOrder through this
+	mHitEntryByOrder.resize( mHitEntries.size() );
+	for( uint32_t e = 0; e < mHitEntries.size(); ++e )
+		mHitEntryByOrder[mHitEntries[e].mOrder] = e;
+	
+	mHitIndexValid = true;
+	mHitIndexRevision = mDocRevision;
+}
+
 Node* Doc::nodeUnderPoint( const Vec2f &pt )
 {
-	return Group::nodeUnderPoint( pt, MatrixAffine2f::identity() );
+	updateHitIndex();
+	if( mHitBvh.empty() )
+		return NULL;
+	
+	mHitCandidates.clear();
+	int32_t stack[64];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while( stackSize > 0 ) {
+		const HitBvhNode &node = mHitBvh[stack[--stackSize]];
+		if( ! node.mBounds.contains( pt ) )
+			continue;
+		if( node.mLeft < 0 ) {
+			for( uint32_t e = node.mFirst; e < node.mFirst + node.mCount; ++e )
+				if( mHitEntries[e].mBounds.contains( pt ) )
+					mHitCandidates.push_back( mHitEntries[e].mOrder );
+		}
+		else {
+			stack[stackSize++] = node.mLeft;
+			stack[stackSize++] = node.mRight;
+		}
+	}
+	
+	// test the candidates from the top down, as the tree walk would
+	std::sort( mHitCandidates.begin(), mHitCandidates.end(), std::greater<uint32_t>() );
+	for( std::vector<uint32_t>::const_iterator orderIt = mHitCandidates.begin(); orderIt != mHitCandidates.end(); ++orderIt ) {
+		const HitEntry &entry = mHitEntries[mHitEntryByOrder[*orderIt]];
+		if( entry.mNode->containsPoint( entry.mInverse * pt ) )
+			return entry.mNode;
+	}
+	
+	return NULL;
+}
+
+void Doc::nodesInRect( const Rectf &rect, std::vector<Node*> *result )
+{
+	updateHitIndex();
+	if( mHitBvh.empty() )
+		return;
+	
+	mHitCandidates.clear();
+	int32_t stack[64];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while( stackSize > 0 ) {
+		const HitBvhNode &node = mHitBvh[stack[--stackSize]];
+		if( ! node.mBounds.intersects( rect ) )
+			continue;
+		if( node.mLeft < 0 ) {
+			for( uint32_t e = node.mFirst; e < node.mFirst + node.mCount; ++e )
+				if( mHitEntries[e].mBounds.intersects( rect ) )
+					mHitCandidates.push_back( mHitEntries[e].mOrder );
+		}
+		else {
+			stack[stackSize++] = node.mLeft;
+			stack[stackSize++] = node.mRight;
+		}
+	}
+	
+	std::sort( mHitCandidates.begin(), mHitCandidates.end() );
+	for( std::vector<uint32_t>::const_iterator orderIt = mHitCandidates.begin(); orderIt != mHitCandidates.end(); ++orderIt )
+		result->push_back( mHitEntries[mHitEntryByOrder[*orderIt]].mNode );
 }
 
 void Doc::renderSelf( Renderer &renderer ) const
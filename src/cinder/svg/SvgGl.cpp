@@ -0,0 +1,249 @@
+/*
+ Copyright (c) 2012, The Cinder Project
+ All rights reserved.
+ 
+ This code is designed for use with the Cinder C++ library, http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+	* Redistributions of source code must retain the above copyright notice, this list of conditions and
+	the following disclaimer.
+	* Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+	the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "cinder/svg/SvgGl.h"
+
+using namespace std;
+
+namespace cinder {
+
+// Accumulates the fills and strokes of a document into one TriMesh2d, in document space and in drawing order.
+// Tessellations are looked up in the previous bake's cache by node and moved into the new one, so nodes which weren't rendered are dropped.
+class SvgMeshGl::Builder : public svg::Renderer {
+  public:
+	Builder( TriMesh2d *result, float approximationScale, NodeCacheMap *oldCache, NodeCacheMap *newCache )
+		: svg::Renderer(), mResult( result ), mApproximationScale( approximationScale ), mOldCache( oldCache ), mNewCache( newCache )
+	{
+		mMatrixStack.push_back( MatrixAffine2f::identity() );
+		mFillStack.push_back( svg::Paint( Color::black() ) );
+		mStrokeStack.push_back( svg::Paint() );
+		mFillOpacityStack.push_back( 1.0f );
+		mStrokeOpacityStack.push_back( 1.0f );
+		mStrokeWidthStack.push_back( 1.0f );
+		mFillRuleStack.push_back( svg::FILL_RULE_NONZERO );
+		mLineCapStack.push_back( svg::LINE_CAP_BUTT );
+		mLineJoinStack.push_back( svg::LINE_JOIN_MITER );
+	}
+
+	void	drawPath( const svg::Path &path ) { addShape( path, path.getShape2d() ); }
+	void	drawPolygon( const svg::Polygon &polygon ) { addShape( polygon, polygon.getShape() ); }
+	void	drawPolyline( const svg::Polyline &polyline ) { addShape( polyline, polyline.getShape() ); }
+	void	drawLine( const svg::Line &line ) { addShape( line, line.getShape() ); }
+	void	drawRect( const svg::Rect &rect ) { addShape( rect, rect.getShape() ); }
+	void	drawEllipse( const svg::Ellipse &ellipse ) { addShape( ellipse, ellipse.getShape() ); }
+	void	drawCircle( const svg::Circle &circle ) {
+		const NodeCache *cache = findCache( circle );
+		if( cache ) {
+			appendCache( *cache );
+			return;
+		}
+		// Circle's shape is an unclosed arc; closing it joins its stroke's ends
+		Shape2d shape = circle.getShape();
+		if( shape.getNumContours() > 0 && ! shape.getContour( 0 ).isClosed() )
+			shape.close();
+		addShape( circle, shape );
+	}
+
+	void	pushMatrix( const MatrixAffine2f &m ) { mMatrixStack.push_back( mMatrixStack.back() * m ); }
+	void	popMatrix() { mMatrixStack.pop_back(); }
+	void	pushFill( const svg::Paint &paint ) { mFillStack.push_back( paint ); }
+	void	popFill() { mFillStack.pop_back(); }
+	void	pushStroke( const svg::Paint &paint ) { mStrokeStack.push_back( paint ); }
+	void	popStroke() { mStrokeStack.pop_back(); }
+	void	pushFillOpacity( float opacity ) { mFillOpacityStack.push_back( opacity ); }
+	void	popFillOpacity() { mFillOpacityStack.pop_back(); }
+	void	pushStrokeOpacity( float opacity ) { mStrokeOpacityStack.push_back( opacity ); }
+	void	popStrokeOpacity() { mStrokeOpacityStack.pop_back(); }
+	void	pushStrokeWidth( float width ) { mStrokeWidthStack.push_back( width ); }
+	void	popStrokeWidth() { mStrokeWidthStack.pop_back(); }
+	void	pushFillRule( svg::FillRule rule ) { mFillRuleStack.push_back( rule ); }
+	void	popFillRule() { mFillRuleStack.pop_back(); }
+	void	pushLineCap( svg::LineCap lineCap ) { mLineCapStack.push_back( lineCap ); }
+	void	popLineCap() { mLineCapStack.pop_back(); }
+	void	pushLineJoin( svg::LineJoin lineJoin ) { mLineJoinStack.push_back( lineJoin ); }
+	void	popLineJoin() { mLineJoinStack.pop_back(); }
+
+  protected:
+	void	addShape( const svg::Node &node, const Shape2d &shape )
+	{
+		const NodeCache *cached = findCache( node );
+		if( cached ) {
+			appendCache( *cached );
+			return;
+		}
+
+		NodeCache cache = makeKey( node );
+		if( cache.mFilled )
+			cache.mFill = Triangulator( shape, cache.mApproximationScale ).calcMesh( (Triangulator::Winding)cache.mWinding );
+		if( cache.mStroked ) {
+			StrokeTriangulator::Format format;
+			format.width( cache.mStrokeWidth ).cap( (StrokeTriangulator::Cap)cache.mStrokeCap ).join( (StrokeTriangulator::Join)cache.mStrokeJoin );
+			cache.mStroke = StrokeTriangulator( shape, format, cache.mApproximationScale ).calcMesh();
+		}
+		appendCache( (*mNewCache)[&node] = cache );
+	}
+
+	// Returns the tessellation parameters \a node would be drawn with under the current state
+	NodeCache	makeKey( const svg::Node &node ) const
+	{
+		// tessellate in the shape's own space, finely enough for however much the current transform scales it
+		const MatrixAffine2f &m = mMatrixStack.back();
+		float scale = math<float>::sqrt( math<float>::abs( m.m00 * m.m11 - m.m01 * m.m10 ) );
+
+		NodeCache key;
+		key.mRevision = node.getRevision();
+		key.mApproximationScale = mApproximationScale * std::max( scale, 0.0001f );
+		key.mFilled = ! mFillStack.back().isNone();
+		key.mStroked = ! mStrokeStack.back().isNone();
+		key.mWinding = ( mFillRuleStack.back() == svg::FILL_RULE_NONZERO ) ? Triangulator::WINDING_NONZERO : Triangulator::WINDING_ODD;
+		key.mStrokeWidth = mStrokeWidthStack.back();
+		switch( mLineCapStack.back() ) {
+			case svg::LINE_CAP_ROUND: key.mStrokeCap = StrokeTriangulator::CAP_ROUND; break;
+			case svg::LINE_CAP_SQUARE: key.mStrokeCap = StrokeTriangulator::CAP_SQUARE; break;
+			default: key.mStrokeCap = StrokeTriangulator::CAP_BUTT;
+		}
+		switch( mLineJoinStack.back() ) {
+			case svg::LINE_JOIN_ROUND: key.mStrokeJoin = StrokeTriangulator::JOIN_ROUND; break;
+			case svg::LINE_JOIN_BEVEL: key.mStrokeJoin = StrokeTriangulator::JOIN_BEVEL; break;
+			default: key.mStrokeJoin = StrokeTriangulator::JOIN_MITER;
+		}
+		return key;
+	}
+
+	// Returns the cached tessellation of \a node if it is still valid, moving it into the new cache, or NULL
+	const NodeCache*	findCache( const svg::Node &node )
+	{
+		NodeCacheMap::iterator oldIt = mOldCache->find( &node );
+		if( oldIt == mOldCache->end() )
+			return 0;
+
+		const NodeCache &old = oldIt->second;
+		NodeCache key = makeKey( node );
+		// the scale only matters to within a few percent; an animated transform shouldn't force a re-tessellation every frame
+		bool valid = old.mRevision == key.mRevision && old.mFilled == key.mFilled && old.mStroked == key.mStroked
+			&& math<float>::abs( old.mApproximationScale - key.mApproximationScale ) <= key.mApproximationScale * 0.05f
+			&& ( ! key.mFilled || old.mWinding == key.mWinding )
+			&& ( ! key.mStroked || ( old.mStrokeWidth == key.mStrokeWidth && old.mStrokeCap == key.mStrokeCap && old.mStrokeJoin == key.mStrokeJoin ) );
+		if( ! valid )
+			return 0;
+
+		NodeCache &result = (*mNewCache)[&node];
+		std::swap( result, oldIt->second );
+		return &result;
+	}
+
+	void	appendCache( const NodeCache &cache )
+	{
+		if( cache.mFilled ) {
+			ColorA color( mFillStack.back().getColor() ); color.a = mFillOpacityStack.back();
+			appendMesh( cache.mFill, color );
+		}
+		if( cache.mStroked ) {
+			ColorA color( mStrokeStack.back().getColor() ); color.a = mStrokeOpacityStack.back();
+			appendMesh( cache.mStroke, color );
+		}
+	}
+
+	void	appendMesh( const TriMesh2d &mesh, const ColorA &color )
+	{
+		const MatrixAffine2f &m = mMatrixStack.back();
+		size_t first = mResult->getNumVertices();
+		for( vector<Vec2f>::const_iterator vertIt = mesh.getVertices().begin(); vertIt != mesh.getVertices().end(); ++vertIt ) {
+			mResult->appendVertex( m.transformPoint( *vertIt ) );
+			mResult->appendColorRgba( color );
+		}
+		const vector<size_t> &indices = mesh.getIndices();
+		for( size_t i = 0; i + 2 < indices.size(); i += 3 )
+			mResult->appendTriangle( first + indices[i], first + indices[i+1], first + indices[i+2] );
+	}
+
+	TriMesh2d						*mResult;
+	float							mApproximationScale;
+	NodeCacheMap					*mOldCache, *mNewCache;
+
+	vector<MatrixAffine2f>			mMatrixStack;
+	vector<svg::Paint>				mFillStack, mStrokeStack;
+	vector<float>					mFillOpacityStack, mStrokeOpacityStack;
+	vector<float>					mStrokeWidthStack;
+	vector<svg::FillRule>			mFillRuleStack;
+	vector<svg::LineCap>			mLineCapStack;
+	vector<svg::LineJoin>			mLineJoinStack;
+};
+
+
+SvgMeshGl::SvgMeshGl( const svg::Doc &doc, float approximationScale )
+	: mObj( new Obj( approximationScale ) )
+{
+	mObj->bake( doc );
+}
+
+bool SvgMeshGl::update( const svg::Doc &doc )
+{
+	if( mObj->mDoc == &doc && mObj->mDocRevision == doc.getDocRevision() )
+		return false;
+
+	mObj->bake( doc );
+	return true;
+}
+
+void SvgMeshGl::setApproximationScale( float approximationScale )
+{
+	mObj->mApproximationScale = approximationScale;
+	mObj->mNodeCache.clear();
+	mObj->mDoc = 0;
+}
+
+void SvgMeshGl::Obj::bake( const svg::Doc &doc )
+{
+	// a different document may reuse the addresses of the last one's nodes
+	if( mDoc != &doc )
+		mNodeCache.clear();
+
+	NodeCacheMap newCache;
+	mTriMesh.clear();
+	Builder builder( &mTriMesh, mApproximationScale, &mNodeCache, &newCache );
+	doc.render( builder );
+	mNodeCache.swap( newCache );
+	mDoc = &doc;
+	mDocRevision = doc.getDocRevision();
+
+#if ! defined( CINDER_GLES )
+	if( mTriMesh.getNumIndices() > 0 )
+		mVboMesh = gl::VboMesh( mTriMesh );
+	else
+		mVboMesh = gl::VboMesh();
+#endif
+}
+
+void SvgMeshGl::draw() const
+{
+#if ! defined( CINDER_GLES )
+	if( mObj->mVboMesh )
+		gl::draw( mObj->mVboMesh );
+#else
+	gl::draw( mObj->mTriMesh );
+#endif
+}
+
+} // namespace cinder
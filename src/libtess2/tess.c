@@ -505,6 +505,7 @@ TESStesselator* tessNewTess( TESSalloc* alloc )
 	tess->bmax[1] = 0;
 
 	tess->windingRule = TESS_WINDING_ODD;
+	tess->outOfMemory = 0;
 
 	tess->callCombine = &noCombine;
 
@@ -117,6 +117,8 @@ public:
 		bufferSetup 		= false;
 		newFrame			= false;
 		latestBufferLength 	= 0;
+		frameCallback		= NULL;
+		frameCallbackRefcon	= NULL;
 		
 		hEvent = CreateEvent(NULL, true, false, NULL);
 	}
@@ -163,6 +165,18 @@ public:
     //This method is meant to have less overhead
 	//------------------------------------------------
     STDMETHODIMP SampleCB(double Time, IMediaSample *pSample){
+    	//the frame callback sees every frame, even while the last one is still waiting on getPixels()
+    	EnterCriticalSection(&critSection);
+    		void (*callback)(unsigned char *, int, void *) = frameCallback;
+    		void * callbackRefcon = frameCallbackRefcon;
+    	LeaveCriticalSection(&critSection);
+    	if(callback && bufferSetup){
+    		unsigned char * samplePixels = NULL;
+    		if(pSample->GetPointer(&samplePixels) == S_OK && pSample->GetActualDataLength() == numBytes){
+    			callback(samplePixels, numBytes, callbackRefcon);
+    		}
+    	}
+    	
     	if(WaitForSingleObject(hEvent, 0) == WAIT_OBJECT_0) return S_OK;
  
     	HRESULT hr = pSample->GetPointer(&ptrBuffer);  
@@ -196,6 +210,8 @@ public:
 	int numBytes;
 	bool newFrame;
 	bool bufferSetup;
+	void (*frameCallback)(unsigned char * pixels, int numBytes, void * refcon);
+	void * frameCallbackRefcon;
 	unsigned char * pixels;
 	unsigned char * ptrBuffer;
 	CRITICAL_SECTION critSection;
@@ -248,6 +264,7 @@ videoDevice::videoDevice(){
 		 sizeSet			= false;
 		 setupStarted		= false;
 		 specificFormat		= false;
+		 specificSubtype	= false;
 		 autoReconnect		= false;
 		 requestedFrameTime = -1;
 		 
@@ -641,6 +658,34 @@ void videoInput::setIdealFramerate(int deviceNumber, int idealFramerate){
 }
 
 
+// ---------------------------------------------------------------------- 
+// Set the media subtype to try first - no guarantee you will get this
+//                                            
+// ---------------------------------------------------------------------- 
+
+void videoInput::setRequestedMediaSubtype(int deviceNumber, GUID mediatype){
+	if(deviceNumber >= VI_MAX_CAMERAS || VDList[deviceNumber]->readyToCapture) return;
+
+	VDList[deviceNumber]->videoType = mediatype;
+	VDList[deviceNumber]->specificSubtype = true;
+}
+
+
+// ---------------------------------------------------------------------- 
+// Set a function to receive every frame as it arrives
+//                                            
+// ---------------------------------------------------------------------- 
+
+void videoInput::setFrameCallback(int deviceNumber, void (*callback)(unsigned char * pixels, int numBytes, void * refcon), void * refcon){
+	if(deviceNumber >= VI_MAX_CAMERAS) return;
+
+	EnterCriticalSection(&VDList[deviceNumber]->sgCallback->critSection);
+		VDList[deviceNumber]->sgCallback->frameCallback			= callback;
+		VDList[deviceNumber]->sgCallback->frameCallbackRefcon	= refcon;
+	LeaveCriticalSection(&VDList[deviceNumber]->sgCallback->critSection);
+}
+
+
 // ---------------------------------------------------------------------- 
 // Set the requested framerate - no guarantee you will get this
 //                                            
@@ -985,6 +1030,43 @@ bool videoInput::getPixels(int id, unsigned char * dstBuffer, bool flipRedAndBlu
 }
 
 
+// ----------------------------------------------------------------------
+// Copies a region into a supplied buffer
+// ---------------------------------------------------------------------- 
+
+bool videoInput::getPixels(int id, unsigned char * dstBuffer, int x, int y, int w, int h){
+
+	if(!isDeviceSetup(id)) return false;
+	if(x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > VDList[id]->width || y + h > VDList[id]->height) return false;
+
+	bool success = false;
+	if(bCallback){
+		DWORD result = WaitForSingleObject(VDList[id]->sgCallback->hEvent, 1000);
+		if( result != WAIT_OBJECT_0) return false;
+
+		EnterCriticalSection(&VDList[id]->sgCallback->critSection);
+			processPixelsRegion(VDList[id]->sgCallback->pixels, dstBuffer, VDList[id]->width, VDList[id]->height, x, y, w, h);
+			VDList[id]->sgCallback->newFrame = false;
+		LeaveCriticalSection(&VDList[id]->sgCallback->critSection);
+
+		ResetEvent(VDList[id]->sgCallback->hEvent);
+		success = true;
+	}
+	else{
+		long bufferSize = VDList[id]->videoSize;
+		HRESULT hr = VDList[id]->pGrabber->GetCurrentBuffer(&bufferSize, (long *)VDList[id]->pBuffer);
+		if(hr==S_OK && bufferSize == VDList[id]->videoSize){
+			processPixelsRegion((unsigned char *)VDList[id]->pBuffer, dstBuffer, VDList[id]->width, VDList[id]->height, x, y, w, h);
+			success = true;
+		}else{
+			if(verbose)printf("ERROR: GetPixels() - Unable to grab frame for device %i\n", id);
+		}
+	}
+
+	return success;
+}
+
+
 // ----------------------------------------------------------------------
 // Returns a buffer
 // ---------------------------------------------------------------------- 
@@ -1622,6 +1704,17 @@ void videoInput::processPixels(unsigned char * src, unsigned char * dst, int wid
 }
 
 
+//------------------------------------------------------------------------------------------
+//copies the w by h region at x, y of the top-down image from the bottom-up BGR src, leaving the rest untouched
+void videoInput::processPixelsRegion(unsigned char * src, unsigned char * dst, int width, int height, int x, int y, int w, int h){
+	int widthInBytes = width * 3;
+	int regionInBytes = w * 3;
+	for(int row = 0; row < h; row++){
+		memcpy(dst + row * regionInBytes, src + (height - 1 - (y + row)) * widthInBytes + x * 3, regionInBytes);
+	}
+}
+
+
 //------------------------------------------------------------------------------------------
 void videoInput::getMediaSubtypeAsString(GUID type, char * typeAsString){
 	static const int maxStr = 8;
@@ -1644,6 +1737,7 @@ void videoInput::getMediaSubtypeAsString(GUID type, char * typeAsString){
 	else if(type == MEDIASUBTYPE_Y800) 	strncpy(tmpStr, "Y800", maxStr);  
 	else if(type == MEDIASUBTYPE_Y8)   	strncpy(tmpStr, "Y8", maxStr);  
 	else if(type == MEDIASUBTYPE_GREY) 	strncpy(tmpStr, "GREY", maxStr);  
+	else if(type == MEDIASUBTYPE_MJPG) 	strncpy(tmpStr, "MJPG", maxStr);
 	else strncpy(tmpStr, "OTHER", maxStr);
 
 	memcpy(typeAsString, tmpStr, sizeof(char)*8);
@@ -1906,7 +2000,17 @@ int videoInput::start(int deviceID, videoDevice *VD){
 		if(verbose)	printf("SETUP: Default Format is set to %i by %i \n", currentWidth, currentHeight);
 		
 		char guidStr[8];
-		for(int i = 0; i < VI_NUM_TYPES; i++){
+		if( VD->specificSubtype ){
+			getMediaSubtypeAsString(VD->videoType, guidStr);
+
+			if(verbose)printf("SETUP: trying requested format %s @ %i by %i\n", guidStr, VD->tryWidth, VD->tryHeight);
+			if( setSizeAndSubtype(VD, VD->tryWidth, VD->tryHeight, VD->videoType) ){
+				VD->setSize(VD->tryWidth, VD->tryHeight);
+				foundSize = true;
+			}
+		}
+
+		for(int i = 0; i < VI_NUM_TYPES && !foundSize; i++){
 			
 			getMediaSubtypeAsString(mediaSubtypes[i], guidStr);
 
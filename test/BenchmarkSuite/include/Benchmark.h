@@ -0,0 +1,130 @@
+#pragma once
+
+#include "cinder/Cinder.h"
+#include "cinder/Function.h"
+#include "cinder/JsonWriter.h"
+#include "cinder/Timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+//! Timing statistics of a single benchmark. Times are in seconds per iteration.
+struct BenchmarkResult {
+	std::string		mName;
+	size_t			mIterations;
+	double			mMean, mMedian, mMin, mMax, mStdDev;
+	//! Amount of work done per iteration, such as pixels or queries, used to report throughput. \c 0 if unknown.
+	double			mItemsPerIteration;
+};
+
+/** Runs benchmarks repeatably: each one is warmed up, then run until both a minimum number of iterations and a minimum time have passed.
+	The per iteration times are summarized by their mean, median, minimum, maximum and standard deviation.
+	Compare medians between runs, since they are the least affected by the occasional preempted iteration. **/
+class BenchmarkRunner {
+  public:
+	BenchmarkRunner()
+		: mWarmupIterations( 2 ), mMinIterations( 10 ), mMaxIterations( 10000 ), mMinSeconds( 0.25 )
+	{}
+
+	//! Sets the number of untimed iterations run before timing starts. Defaults to \c 2
+	void	setWarmupIterations( size_t iterations ) { mWarmupIterations = iterations; }
+	//! Sets the minimum number of timed iterations. Defaults to \c 10
+	void	setMinIterations( size_t iterations ) { mMinIterations = iterations; mMaxIterations = std::max( mMaxIterations, iterations ); }
+	//! Sets the minimum total time spent in timed iterations. Defaults to \c 0.25 seconds
+	void	setMinSeconds( double seconds ) { mMinSeconds = seconds; }
+	//! Restricts run() to benchmarks whose name contains \a filter. An empty filter runs everything.
+	void	setFilter( const std::string &filter ) { mFilter = filter; }
+	//! Returns whether the benchmark named \a name passes the filter. Use it to skip expensive preparation.
+	bool	isSelected( const std::string &name ) const { return mFilter.empty() || name.find( mFilter ) != std::string::npos; }
+
+	/** Times \a fn as the benchmark \a name, unless it is filtered out. \a itemsPerIteration is reported as throughput.
+		\a prepare, if given, is called before every iteration, warmup included, and isn't timed. Returns the result, or NULL if filtered out. **/
+	const BenchmarkResult*	run( const std::string &name, const std::function<void()> &fn, double itemsPerIteration = 0, const std::function<void()> &prepare = std::function<void()>() )
+	{
+		if( ! isSelected( name ) )
+			return NULL;
+
+		for( size_t i = 0; i < mWarmupIterations; ++i ) {
+			if( prepare )
+				prepare();
+			fn();
+		}
+
+		std::vector<double> times;
+		double total = 0;
+		ci::Timer timer;
+		while( ( times.size() < mMinIterations || total < mMinSeconds ) && times.size() < mMaxIterations ) {
+			if( prepare )
+				prepare();
+			timer.start();
+			fn();
+			timer.stop();
+			times.push_back( timer.getSeconds() );
+			total += times.back();
+		}
+
+		BenchmarkResult result;
+		result.mName = name;
+		result.mIterations = times.size();
+		result.mItemsPerIteration = itemsPerIteration;
+		result.mMean = total / times.size();
+		double variance = 0;
+		for( size_t i = 0; i < times.size(); ++i )
+			variance += ( times[i] - result.mMean ) * ( times[i] - result.mMean );
+		result.mStdDev = std::sqrt( variance / times.size() );
+		std::sort( times.begin(), times.end() );
+		result.mMin = times.front();
+		result.mMax = times.back();
+		result.mMedian = ( times.size() % 2 ) ? times[times.size() / 2] : ( times[times.size() / 2 - 1] + times[times.size() / 2] ) / 2;
+
+		mResults.push_back( result );
+		return &mResults.back();
+	}
+
+	//! Returns the results of every benchmark run so far, in order
+	const std::vector<BenchmarkResult>&	getResults() const { return mResults; }
+
+	//! Writes a one line summary of \a result to \a os
+	static void		print( std::ostream &os, const BenchmarkResult &result )
+	{
+		os << result.mName << ": median " << result.mMedian * 1000 << "ms, mean " << result.mMean * 1000 << "ms +/- " << result.mStdDev * 1000
+			<< "ms, min " << result.mMin * 1000 << "ms (" << result.mIterations << " iterations)";
+		if( result.mItemsPerIteration > 0 && result.mMedian > 0 )
+			os << ", " << result.mItemsPerIteration / result.mMedian / 1e6 << "M items/s";
+		os << std::endl;
+	}
+
+	//! Writes every result to \a path as a JSON object holding \a info, which describes the machine and build, and an array of results
+	void			writeJson( const ci::fs::path &path, const std::map<std::string,std::string> &info ) const
+	{
+		ci::JsonWriter writer( ci::writeFile( path ), true );
+		writer.beginObject();
+		for( std::map<std::string,std::string>::const_iterator infoIt = info.begin(); infoIt != info.end(); ++infoIt )
+			writer.key( infoIt->first ).value( infoIt->second );
+		writer.key( "results" ).beginArray();
+		for( std::vector<BenchmarkResult>::const_iterator resultIt = mResults.begin(); resultIt != mResults.end(); ++resultIt ) {
+			writer.beginObject();
+			writer.key( "name" ).value( resultIt->mName );
+			writer.key( "iterations" ).value( (uint64_t)resultIt->mIterations );
+			writer.key( "median" ).value( resultIt->mMedian );
+			writer.key( "mean" ).value( resultIt->mMean );
+			writer.key( "min" ).value( resultIt->mMin );
+			writer.key( "max" ).value( resultIt->mMax );
+			writer.key( "stddev" ).value( resultIt->mStdDev );
+			writer.key( "itemsPerIteration" ).value( resultIt->mItemsPerIteration );
+			writer.endObject();
+		}
+		writer.endArray();
+		writer.endObject();
+	}
+
+  private:
+	size_t							mWarmupIterations, mMinIterations, mMaxIterations;
+	double							mMinSeconds;
+	std::string						mFilter;
+	std::vector<BenchmarkResult>	mResults;
+};
@@ -0,0 +1,444 @@
+#include "cinder/app/AppBasic.h"
+#include "cinder/gl/gl.h"
+#include "cinder/gl/Texture.h"
+#include "cinder/gl/Vbo.h"
+#include "cinder/Surface.h"
+#include "cinder/Rand.h"
+#include "cinder/Perlin.h"
+#include "cinder/KdTree.h"
+#include "cinder/ObjLoader.h"
+#include "cinder/TriMesh.h"
+#include "cinder/Json.h"
+#include "cinder/Xml.h"
+#include "cinder/Timeline.h"
+#include "cinder/ImageIo.h"
+#include "cinder/System.h"
+#include "cinder/Utilities.h"
+#include "cinder/ip/Resize.h"
+#include "cinder/ip/Threshold.h"
+#include "cinder/ip/Blend.h"
+#include "cinder/ip/Premultiply.h"
+
+#include "Benchmark.h"
+
+#include <ctime>
+#include <sstream>
+
+using namespace ci;
+using namespace ci::app;
+using namespace std;
+
+/* Times a fixed set of Cinder operations so performance regressions can be tracked between builds and machines.
+	Every benchmark prints a summary to the console and the results are written as JSON, by default to BenchmarkSuite.json in the documents directory.
+	Command line arguments:
+		--filter <text>		only runs the benchmarks whose name contains <text>, such as "ip." or "Timeline"
+		--json <path>		writes the results to <path>
+		--seconds <s>		minimum time spent timing each benchmark, 0.25 by default
+	The app quits once the results are written, so it can be run from a script. */
+class BenchmarkSuiteApp : public AppBasic {
+  public:
+	void setup();
+	void update();
+	void draw();
+
+	void		parseArgs();
+	void		report( const BenchmarkResult *result );
+	void		writeResults();
+
+	void		benchmarkSurface();
+	void		benchmarkImageProcessing();
+	void		benchmarkImageIo();
+	void		benchmarkObjLoader();
+	void		benchmarkParsing();
+	void		benchmarkTimeline();
+	void		benchmarkKdTree();
+	void		benchmarkPerlin();
+	void		benchmarkGl();
+
+	BenchmarkRunner		mRunner;
+	fs::path			mJsonPath;
+};
+
+static Surface8u createTestSurface( int32_t width, int32_t height, bool alpha, const SurfaceChannelOrder &order )
+{
+	// smooth gradients plus a little noise compress like photographs rather than like noise or flat color
+	Surface8u result( width, height, alpha, order );
+	Surface8u::Iter iter = result.getIter();
+	while( iter.line() ) {
+		while( iter.pixel() ) {
+			iter.r() = ( iter.x() * 255 / width + Rand::randInt( 8 ) ) & 0xFF;
+			iter.g() = ( iter.y() * 255 / height + Rand::randInt( 8 ) ) & 0xFF;
+			iter.b() = ( ( iter.x() + iter.y() ) * 127 / ( width + height ) + Rand::randInt( 8 ) ) & 0xFF;
+			if( alpha )
+				iter.a() = Rand::randInt( 256 );
+		}
+	}
+	return result;
+}
+
+// Operations are wrapped in free functions so they can be bound without resolving overloads
+static void copySurface( Surface8u *dst, const Surface8u *src )
+{
+	dst->copyFrom( *src, src->getBounds() );
+}
+
+static void resizeSurface( const Surface8u *src, Surface8u *dst )
+{
+	ip::resize( *src, dst );
+}
+
+static void thresholdSurface( const Surface8u *src, Surface8u *dst )
+{
+	ip::threshold( *src, (uint8_t)128, dst );
+}
+
+static void blendSurface( Surface8u *background, const Surface8u *foreground )
+{
+	ip::blend( background, *foreground );
+}
+
+static void resetSurface( Surface8u *surface, const Surface8u *original )
+{
+	surface->copyFrom( *original, original->getBounds() );
+}
+
+static void writeImageToMemory( const Surface8u *surface, const string *extension )
+{
+	writeImage( DataTargetStream::createRef( OStreamMem::create( 1 << 20 ) ), *surface, ImageTarget::Options(), *extension );
+}
+
+static void loadImageFromMemory( const Buffer *buffer, const string *extension )
+{
+	Surface8u surface( loadImage( DataSourceBuffer::create( *buffer ), ImageSource::Options(), *extension ) );
+}
+
+static void loadObj( const Buffer *buffer )
+{
+	ObjLoader loader( DataSourceBuffer::create( *buffer ) );
+	TriMesh mesh;
+	loader.load( &mesh );
+}
+
+static void parseJson( const string *json )
+{
+	JsonTree tree( *json );
+}
+
+static void parseXml( const string *xml )
+{
+	XmlTree tree( *xml );
+}
+
+static void stepTimeline( Timeline *timeline, float *time, float duration )
+{
+	// scrubs forwards through the whole timeline, wrapping around at the end
+	*time += 1 / 60.0f;
+	if( *time > duration )
+		*time = 0;
+	timeline->stepTo( *time );
+}
+
+static void buildKdTree( KdTree<Vec3f> *tree, const vector<Vec3f> *points )
+{
+	tree->initialize( *points );
+}
+
+static void findNearest( const KdTree<Vec3f> *tree, const vector<Vec3f> *queries )
+{
+	float result[3];
+	uint32_t resultIndex;
+	for( vector<Vec3f>::const_iterator queryIt = queries->begin(); queryIt != queries->end(); ++queryIt )
+		tree->findNearest( &queryIt->x, result, &resultIndex );
+}
+
+static void findKNearest( const KdTree<Vec3f> *tree, const vector<Vec3f> *queries, uint32_t k )
+{
+	vector<uint32_t> resultIndices;
+	for( vector<Vec3f>::const_iterator queryIt = queries->begin(); queryIt != queries->end(); ++queryIt )
+		tree->findKNearest( &queryIt->x, k, &resultIndices );
+}
+
+static volatile float sPerlinSink;
+
+static void sampleFbm( const Perlin *perlin, int size )
+{
+	float sum = 0;
+	for( int y = 0; y < size; ++y )
+		for( int x = 0; x < size; ++x )
+			sum += perlin->fBm( Vec3f( x * 0.01f, y * 0.01f, 0.5f ) );
+	sPerlinSink = sum;
+}
+
+static void updateTexture( gl::Texture *texture, const Surface8u *surface )
+{
+	texture->update( *surface );
+	glFinish();
+}
+
+static void updateVbo( gl::Vbo *vbo, const vector<uint8_t> *data )
+{
+	vbo->bind();
+	vbo->bufferSubData( 0, data->size(), &(*data)[0] );
+	vbo->unbind();
+	glFinish();
+}
+
+void BenchmarkSuiteApp::parseArgs()
+{
+	mJsonPath = getDocumentsDirectory() / "BenchmarkSuite.json";
+	const vector<string> &args = getArgs();
+	for( size_t a = 1; a + 1 < args.size(); ++a ) {
+		if( args[a] == "--filter" )
+			mRunner.setFilter( args[++a] );
+		else if( args[a] == "--json" )
+			mJsonPath = args[++a];
+		else if( args[a] == "--seconds" )
+			mRunner.setMinSeconds( fromString<double>( args[++a] ) );
+	}
+}
+
+void BenchmarkSuiteApp::report( const BenchmarkResult *result )
+{
+	if( result )
+		BenchmarkRunner::print( console(), *result );
+}
+
+void BenchmarkSuiteApp::benchmarkSurface()
+{
+	Surface8u rgba = createTestSurface( 2048, 1024, true, SurfaceChannelOrder::RGBA );
+	Surface8u rgbaCopy( rgba.getWidth(), rgba.getHeight(), true, SurfaceChannelOrder::RGBA );
+	Surface8u bgr( rgba.getWidth(), rgba.getHeight(), false, SurfaceChannelOrder::BGR );
+	Surface8u argb( rgba.getWidth(), rgba.getHeight(), true, SurfaceChannelOrder::ARGB );
+	double pixels = rgba.getWidth() * rgba.getHeight();
+
+	report( mRunner.run( "Surface.copyFrom RGBA to RGBA", std::bind( &copySurface, &rgbaCopy, &rgba ), pixels ) );
+	report( mRunner.run( "Surface.copyFrom RGBA to BGR", std::bind( &copySurface, &bgr, &rgba ), pixels ) );
+	report( mRunner.run( "Surface.copyFrom RGBA to ARGB", std::bind( &copySurface, &argb, &rgba ), pixels ) );
+}
+
+void BenchmarkSuiteApp::benchmarkImageProcessing()
+{
+	Surface8u source = createTestSurface( 2048, 1024, true, SurfaceChannelOrder::RGBA );
+	Surface8u half( source.getWidth() / 2, source.getHeight() / 2, true, SurfaceChannelOrder::RGBA );
+	Surface8u thresholded( source.getWidth(), source.getHeight(), true, SurfaceChannelOrder::RGBA );
+	double pixels = source.getWidth() * source.getHeight();
+
+	report( mRunner.run( "ip.resize RGBA 2048x1024 to 1024x512", std::bind( &resizeSurface, &source, &half ), pixels ) );
+	report( mRunner.run( "ip.threshold RGBA", std::bind( &thresholdSurface, &source, &thresholded ), pixels ) );
+
+	Surface8u foreground = source.clone();
+	ip::premultiply( &foreground );
+	Surface8u background = createTestSurface( source.getWidth(), source.getHeight(), true, SurfaceChannelOrder::RGBA );
+	Surface8u original = background.clone();
+	report( mRunner.run( "ip.blend RGBA", std::bind( &blendSurface, &background, &foreground ), pixels, std::bind( &resetSurface, &background, &original ) ) );
+}
+
+void BenchmarkSuiteApp::benchmarkImageIo()
+{
+	Surface8u surface = createTestSurface( 1024, 1024, false, SurfaceChannelOrder::RGB );
+	double pixels = surface.getWidth() * surface.getHeight();
+	const char *extensions[] = { "png", "jpg", "tif" };
+	for( size_t e = 0; e < sizeof(extensions) / sizeof(extensions[0]); ++e ) {
+		string extension = extensions[e];
+		string writeName = "writeImage " + extension, loadName = "loadImage " + extension;
+		if( ! mRunner.isSelected( writeName ) && ! mRunner.isSelected( loadName ) )
+			continue;
+		try {
+			OStreamMemRef stream = OStreamMem::create( 1 << 20 );
+			writeImage( DataTargetStream::createRef( stream ), surface, ImageTarget::Options(), extension );
+			Buffer encoded( (size_t)stream->tell() );
+			memcpy( encoded.getData(), stream->getBuffer(), encoded.getDataSize() );
+
+			report( mRunner.run( writeName, std::bind( &writeImageToMemory, &surface, &extension ), pixels ) );
+			report( mRunner.run( loadName, std::bind( &loadImageFromMemory, &encoded, &extension ), pixels ) );
+		}
+		catch( std::exception &exc ) {
+			console() << extension << " is not supported on this platform, skipping: " << exc.what() << std::endl;
+		}
+	}
+}
+
+void BenchmarkSuiteApp::benchmarkObjLoader()
+{
+	if( ! mRunner.isSelected( "ObjLoader" ) )
+		return;
+
+	// a UV sphere, with every vertex shared between 4 faces like a typical exported mesh
+	const int rings = 256, segments = 512;
+	ostringstream obj;
+	for( int r = 0; r <= rings; ++r ) {
+		float theta = r * (float)M_PI / rings;
+		for( int s = 0; s <= segments; ++s ) {
+			float phi = s * 2 * (float)M_PI / segments;
+			Vec3f n( math<float>::sin( theta ) * math<float>::cos( phi ), math<float>::cos( theta ), math<float>::sin( theta ) * math<float>::sin( phi ) );
+			obj << "v " << n.x << " " << n.y << " " << n.z << "\n";
+			obj << "vt " << s / (float)segments << " " << r / (float)rings << "\n";
+			obj << "vn " << n.x << " " << n.y << " " << n.z << "\n";
+		}
+	}
+	for( int r = 0; r < rings; ++r ) {
+		for( int s = 0; s < segments; ++s ) {
+			int i0 = r * ( segments + 1 ) + s + 1, i1 = i0 + 1, i2 = i0 + segments + 2, i3 = i0 + segments + 1;
+			obj << "f " << i0 << "/" << i0 << "/" << i0 << " " << i1 << "/" << i1 << "/" << i1 << " " << i2 << "/" << i2 << "/" << i2 << " " << i3 << "/" << i3 << "/" << i3 << "\n";
+		}
+	}
+	string objString = obj.str();
+	Buffer buffer( objString.size() );
+	memcpy( buffer.getData(), objString.c_str(), objString.size() );
+
+	report( mRunner.run( "ObjLoader sphere", std::bind( &loadObj, &buffer ), rings * segments ) );
+}
+
+void BenchmarkSuiteApp::benchmarkParsing()
+{
+	const int numRecords = 20000;
+	if( mRunner.isSelected( "JsonTree" ) ) {
+		ostringstream json;
+		json << "{\"records\":[";
+		for( int i = 0; i < numRecords; ++i ) {
+			json << ( i ? "," : "" ) << "{\"id\":" << i << ",\"name\":\"record " << i << "\",\"value\":" << Rand::randFloat()
+				<< ",\"enabled\":" << ( i % 2 ? "true" : "false" ) << ",\"position\":[" << Rand::randFloat() << "," << Rand::randFloat() << "," << Rand::randFloat() << "]}";
+		}
+		json << "]}";
+		string jsonString = json.str();
+		report( mRunner.run( "JsonTree parse", std::bind( &parseJson, &jsonString ), numRecords ) );
+	}
+
+	if( mRunner.isSelected( "XmlTree" ) ) {
+		ostringstream xml;
+		xml << "<records>";
+		for( int i = 0; i < numRecords; ++i ) {
+			xml << "<record id=\"" << i << "\" enabled=\"" << ( i % 2 ? "true" : "false" ) << "\"><name>record " << i << "</name><value>" << Rand::randFloat()
+				<< "</value><position x=\"" << Rand::randFloat() << "\" y=\"" << Rand::randFloat() << "\" z=\"" << Rand::randFloat() << "\"/></record>";
+		}
+		xml << "</records>";
+		string xmlString = xml.str();
+		report( mRunner.run( "XmlTree parse", std::bind( &parseXml, &xmlString ), numRecords ) );
+	}
+}
+
+void BenchmarkSuiteApp::benchmarkTimeline()
+{
+	const int counts[] = { 1000, 10000, 50000 };
+	for( size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c ) {
+		for( int indexed = 0; indexed < 2; ++indexed ) {
+			ostringstream name;
+			name << "Timeline stepTo " << counts[c] << " tweens" << ( indexed ? " indexed" : "" );
+			if( ! mRunner.isSelected( name.str() ) )
+				continue;
+
+			// short tweens staggered across a minute, so only a few are active at any time
+			const float duration = 60;
+			TimelineRef timeline = Timeline::create();
+			timeline->setIntervalIndex( indexed != 0 );
+			vector<Anim<float> > anims( counts[c] );
+			for( int i = 0; i < counts[c]; ++i )
+				timeline->apply( &anims[i], 0.0f, 1.0f, 0.5f ).delay( Rand::randFloat( duration ) ).autoRemove( false );
+			float time = 0;
+			report( mRunner.run( name.str(), std::bind( &stepTimeline, timeline.get(), &time, duration ), counts[c] ) );
+		}
+	}
+}
+
+void BenchmarkSuiteApp::benchmarkKdTree()
+{
+	if( ! mRunner.isSelected( "KdTree" ) )
+		return;
+
+	const int numPoints = 100000, numQueries = 10000;
+	vector<Vec3f> points, queries;
+	for( int i = 0; i < numPoints; ++i )
+		points.push_back( Vec3f( Rand::randFloat(), Rand::randFloat(), Rand::randFloat() ) );
+	for( int i = 0; i < numQueries; ++i )
+		queries.push_back( Vec3f( Rand::randFloat(), Rand::randFloat(), Rand::randFloat() ) );
+
+	KdTree<Vec3f> tree;
+	report( mRunner.run( "KdTree build 100k points", std::bind( &buildKdTree, &tree, &points ), numPoints ) );
+	tree.initialize( points );
+	report( mRunner.run( "KdTree findNearest", std::bind( &findNearest, &tree, &queries ), numQueries ) );
+	report( mRunner.run( "KdTree findKNearest k=8", std::bind( &findKNearest, &tree, &queries, 8 ), numQueries ) );
+}
+
+void BenchmarkSuiteApp::benchmarkPerlin()
+{
+	const int size = 256;
+	Perlin perlin( 4, 1234 );
+	report( mRunner.run( "Perlin fBm 3d 4 octaves", std::bind( &sampleFbm, &perlin, size ), size * size ) );
+}
+
+void BenchmarkSuiteApp::benchmarkGl()
+{
+	if( mRunner.isSelected( "gl.Texture" ) ) {
+		Surface8u surface = createTestSurface( 2048, 2048, true, SurfaceChannelOrder::RGBA );
+		gl::Texture texture( surface );
+		report( mRunner.run( "gl.Texture update RGBA 2048x2048", std::bind( &updateTexture, &texture, &surface ), surface.getWidth() * surface.getHeight() ) );
+	}
+
+	if( mRunner.isSelected( "gl.Vbo" ) ) {
+		vector<uint8_t> data( 16 << 20 );
+		for( size_t i = 0; i < data.size(); ++i )
+			data[i] = (uint8_t)i;
+		gl::Vbo vbo( GL_ARRAY_BUFFER );
+		vbo.bind();
+		vbo.bufferData( data.size(), NULL, GL_DYNAMIC_DRAW );
+		vbo.unbind();
+		report( mRunner.run( "gl.Vbo bufferSubData 16MB", std::bind( &updateVbo, &vbo, &data ), (double)data.size() ) );
+	}
+}
+
+void BenchmarkSuiteApp::writeResults()
+{
+	map<string,string> info;
+	time_t now = time( NULL );
+	char date[64];
+	strftime( date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime( &now ) );
+	info["date"] = date;
+#if defined( NDEBUG )
+	info["build"] = "release";
+#else
+	info["build"] = "debug";
+#endif
+	info["logicalCores"] = toString( System::getNumCores() );
+	info["physicalCores"] = toString( System::getNumPhysicalCores() );
+	info["l2CacheSize"] = toString( System::getCacheSize( 2 ) );
+	info["sse4_2"] = System::hasSse4_2() ? "true" : "false";
+	info["avx2"] = System::hasAvx2() ? "true" : "false";
+	info["neon"] = System::hasNeon() ? "true" : "false";
+	info["renderer"] = (const char*)glGetString( GL_RENDERER );
+
+	mRunner.writeJson( mJsonPath, info );
+	console() << "Wrote " << mRunner.getResults().size() << " results to " << mJsonPath.string() << std::endl;
+}
+
+void BenchmarkSuiteApp::setup()
+{
+	parseArgs();
+	// the same random data on every run
+	Rand::randSeed( 1 );
+
+	benchmarkSurface();
+	benchmarkImageProcessing();
+	benchmarkImageIo();
+	benchmarkObjLoader();
+	benchmarkParsing();
+	benchmarkTimeline();
+	benchmarkKdTree();
+	benchmarkPerlin();
+	benchmarkGl();
+
+	writeResults();
+}
+
+void BenchmarkSuiteApp::update()
+{
+	quit();
+}
+
+void BenchmarkSuiteApp::draw()
+{
+	// clear out the window with black
+	gl::clear( Color( 0, 0, 0 ) );
+}
+
+
+CINDER_APP_BASIC( BenchmarkSuiteApp, RendererGl )
@@ -0,0 +1,103 @@
+#include "cinder/app/AppBasic.h"
+#include "cinder/gl/gl.h"
+#include "cinder/Surface.h"
+#include "cinder/Rand.h"
+#include "cinder/Timer.h"
+#include "cinder/ip/Premultiply.h"
+#include "cinder/ip/Blend.h"
+#include "cinder/ip/Simd.h"
+
+using namespace ci;
+using namespace ci::app;
+using namespace std;
+
+// Times the scalar and SIMD paths of the 8 bit premultiply, unpremultiply, blend and channel order conversion against each other and verifies they match
+class SimdBenchmarkApp : public AppBasic {
+  public:
+	void setup();
+	void draw();
+
+	void		randomize( Surface8u *surface );
+	bool		matches( const Surface8u &a, const Surface8u &b );
+	void		benchmark( const SurfaceChannelOrder &order, const std::string &name );
+};
+
+void SimdBenchmarkApp::randomize( Surface8u *surface )
+{
+	Surface8u::Iter iter = surface->getIter();
+	while( iter.line() ) {
+		while( iter.pixel() ) {
+			iter.a() = Rand::randInt( 256 );
+			iter.r() = Rand::randInt( 256 );
+			iter.g() = Rand::randInt( 256 );
+			iter.b() = Rand::randInt( 256 );
+		}
+	}
+}
+
+bool SimdBenchmarkApp::matches( const Surface8u &a, const Surface8u &b )
+{
+	for( int32_t y = 0; y < a.getHeight(); ++y ) {
+		if( memcmp( a.getData( Vec2i( 0, y ) ), b.getData( Vec2i( 0, y ) ), a.getWidth() * a.getPixelInc() ) )
+			return false;
+	}
+	return true;
+}
+
+void SimdBenchmarkApp::benchmark( const SurfaceChannelOrder &order, const std::string &name )
+{
+	const int iterations = 20;
+	// an odd width exercises the scalar tail of each row
+	Surface8u source( 2047, 1024, true, order );
+	Surface8u foreground( source.getWidth(), source.getHeight(), true, order );
+	randomize( &source );
+	randomize( &foreground );
+	ip::premultiply( &foreground );
+
+	double times[2][4] = { { 0 } };
+	Surface8u results[2], converted[2];
+	for( int simd = 0; simd < 2; ++simd ) {
+		ip::setSimdEnabled( simd != 0 );
+		for( int i = 0; i < iterations; ++i ) {
+			Surface8u surface = source.clone();
+			Timer timer( true );
+			ip::premultiply( &surface );
+			times[simd][0] += timer.getSeconds();
+			timer.start();
+			ip::blend( &surface, foreground );
+			times[simd][1] += timer.getSeconds();
+			timer.start();
+			ip::unpremultiply( &surface );
+			times[simd][2] += timer.getSeconds();
+			results[simd] = surface;
+			converted[simd] = Surface8u( surface.getWidth(), surface.getHeight(), false, SurfaceChannelOrder::BGR );
+			timer.start();
+			converted[simd].copyFrom( surface, surface.getBounds() );
+			times[simd][3] += timer.getSeconds();
+		}
+	}
+	ip::setSimdEnabled( true );
+
+	bool match = matches( results[0], results[1] ) && matches( converted[0], converted[1] );
+	console() << name << ( match ? " (results match)" : " (RESULTS DIFFER)" ) << std::endl;
+	const char *ops[4] = { "premultiply", "blend", "unpremultiply", "copyFrom to BGR" };
+	for( int op = 0; op < 4; ++op )
+		console() << "  " << ops[op] << ": scalar " << times[0][op] * 1000 / iterations << "ms, simd " << times[1][op] * 1000 / iterations
+					<< "ms, " << times[0][op] / times[1][op] << "x" << std::endl;
+}
+
+void SimdBenchmarkApp::setup()
+{
+	benchmark( SurfaceChannelOrder::RGBA, "RGBA" );
+	benchmark( SurfaceChannelOrder::BGRA, "BGRA" );
+	benchmark( SurfaceChannelOrder::ARGB, "ARGB" );
+}
+
+void SimdBenchmarkApp::draw()
+{
+	// clear out the window with black
+	gl::clear( Color( 0, 0, 0 ) );
+}
+
+
+CINDER_APP_BASIC( SimdBenchmarkApp, RendererGl )